@@ -0,0 +1,246 @@
+//------------------------------------------------------------------------------------------------------------------------------------------
+// A fast 128-bit non-cryptographic content hash, modelled on XXH3
+//------------------------------------------------------------------------------------------------------------------------------------------
+#include "ContentHash.h"
+
+#include "Endian.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+#if defined(_MSC_VER) && defined(_M_X64)
+    #include <intrin.h>
+#endif
+
+// Prime numbers used for mixing (the same ones used by the xxHash family of hashes)
+static constexpr uint64_t PRIME32_1 = 0x9E3779B1u;
+static constexpr uint64_t PRIME32_2 = 0x85EBCA77u;
+static constexpr uint64_t PRIME32_3 = 0xC2B2AE3Du;
+static constexpr uint64_t PRIME64_1 = 0x9E3779B185EBCA87ull;
+static constexpr uint64_t PRIME64_2 = 0xC2B2AE3D27D4EB4Full;
+static constexpr uint64_t PRIME64_3 = 0x165667B19E3779F9ull;
+static constexpr uint64_t PRIME64_4 = 0x85EBCA77C2B2AE63ull;
+static constexpr uint64_t PRIME64_5 = 0x27D4EB2F165667C5ull;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Generates the table of secret keys that input data is combined with.
+// Each stripe in a block uses a window of 'NUM_LANES' keys which slides along by one key per stripe, like the secret in XXH3.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static constexpr uint32_t NUM_SECRET_KEYS = ContentHasher::NUM_LANES + ContentHasher::STRIPES_PER_BLOCK;
+
+static constexpr std::array<uint64_t, NUM_SECRET_KEYS> makeSecretKeys() noexcept {
+    // Uses the 'SplitMix64' generator to produce well mixed keys
+    std::array<uint64_t, NUM_SECRET_KEYS> keys = {};
+    uint64_t state = PRIME64_3;
+
+    for (uint64_t& key : keys) {
+        state += 0x9E3779B97F4A7C15ull;
+        uint64_t z = state;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        key = z ^ (z >> 31);
+    }
+
+    return keys;
+}
+
+static constexpr std::array<uint64_t, NUM_SECRET_KEYS> SECRET_KEYS = makeSecretKeys();
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Reads a little endian 64-bit word from possibly unaligned memory
+//------------------------------------------------------------------------------------------------------------------------------------------
+static inline uint64_t readU64(const std::byte* const pData) noexcept {
+    uint64_t value;
+    std::memcpy(&value, pData, sizeof(value));
+    return Endian::littleToHost(value);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Does a full 64x64 -> 128-bit multiply and folds the result down to 64 bits by XORing the high and low halves
+//------------------------------------------------------------------------------------------------------------------------------------------
+static inline uint64_t mulFold64(const uint64_t a, const uint64_t b) noexcept {
+    #if defined(__SIZEOF_INT128__)
+        __extension__ typedef unsigned __int128 uint128_t;     // Note: '__extension__' avoids pedantic warnings about '__int128'
+        const uint128_t product = (uint128_t) a * b;
+        return (uint64_t) product ^ (uint64_t)(product >> 64);
+    #elif defined(_MSC_VER) && defined(_M_X64)
+        uint64_t productHi;
+        const uint64_t productLo = _umul128(a, b, &productHi);
+        return productLo ^ productHi;
+    #else
+        const uint64_t aLo = a & 0xFFFFFFFFu;
+        const uint64_t aHi = a >> 32;
+        const uint64_t bLo = b & 0xFFFFFFFFu;
+        const uint64_t bHi = b >> 32;
+        const uint64_t loLo = aLo * bLo;
+        const uint64_t hiLo = aHi * bLo;
+        const uint64_t loHi = aLo * bHi;
+        const uint64_t hiHi = aHi * bHi;
+        const uint64_t cross = (loLo >> 32) + (hiLo & 0xFFFFFFFFu) + loHi;
+        const uint64_t productHi = (hiLo >> 32) + (cross >> 32) + hiHi;
+        const uint64_t productLo = (cross << 32) | (loLo & 0xFFFFFFFFu);
+        return productLo ^ productHi;
+    #endif
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Final mixing step for a 64-bit hash: makes every bit of the input affect every bit of the output
+//------------------------------------------------------------------------------------------------------------------------------------------
+static inline uint64_t avalanche(uint64_t hash) noexcept {
+    hash ^= hash >> 37;
+    hash *= 0x165667919E3779F9ull;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Mixes a single 64-byte stripe of data into the accumulators, using the secret keys for the given stripe index within the block
+//------------------------------------------------------------------------------------------------------------------------------------------
+static inline void accumulateStripe(uint64_t (&acc)[ContentHasher::NUM_LANES], const std::byte* const pStripe, const uint32_t stripeIdx) noexcept {
+    const uint64_t* const pKeys = SECRET_KEYS.data() + stripeIdx;
+
+    for (uint32_t lane = 0; lane < ContentHasher::NUM_LANES; ++lane) {
+        const uint64_t data = readU64(pStripe + lane * sizeof(uint64_t));
+        const uint64_t dataKey = data ^ pKeys[lane];
+        acc[lane ^ 1] += data;
+        acc[lane] += (dataKey & 0xFFFFFFFFu) * (dataKey >> 32);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Scrambles the accumulators at the end of each block, so that bits from the top of the accumulators don't get lost over time
+//------------------------------------------------------------------------------------------------------------------------------------------
+static inline void scrambleAccumulators(uint64_t (&acc)[ContentHasher::NUM_LANES]) noexcept {
+    const uint64_t* const pKeys = SECRET_KEYS.data() + ContentHasher::STRIPES_PER_BLOCK;
+
+    for (uint32_t lane = 0; lane < ContentHasher::NUM_LANES; ++lane) {
+        uint64_t a = acc[lane];
+        a ^= a >> 47;
+        a ^= pKeys[lane];
+        a *= PRIME32_1;
+        acc[lane] = a;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Folds the accumulators down to a 64-bit hash, using the secret keys starting at the given index
+//------------------------------------------------------------------------------------------------------------------------------------------
+static uint64_t mergeAccumulators(const uint64_t (&acc)[ContentHasher::NUM_LANES], const uint32_t keyIdx, const uint64_t start) noexcept {
+    uint64_t hash = start;
+
+    for (uint32_t lane = 0; lane < ContentHasher::NUM_LANES; lane += 2) {
+        hash += mulFold64(acc[lane] ^ SECRET_KEYS[keyIdx + lane], acc[lane + 1] ^ SECRET_KEYS[keyIdx + lane + 1]);
+    }
+
+    return avalanche(hash);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Convenience function: hashes a single block of data in one go
+//------------------------------------------------------------------------------------------------------------------------------------------
+ContentHash ContentHasher::hash(const void* const pData, const size_t dataSize, const uint64_t seed) noexcept {
+    ContentHasher hasher(seed);
+    hasher.add(pData, dataSize);
+    return hasher.getHash();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Creates a hasher with no data added, using the specified seed
+//------------------------------------------------------------------------------------------------------------------------------------------
+ContentHasher::ContentHasher(const uint64_t seed) noexcept {
+    reset(seed);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Clears all data added to the hash and starts a new hash with the specified seed
+//------------------------------------------------------------------------------------------------------------------------------------------
+void ContentHasher::reset(const uint64_t seed) noexcept {
+    mAcc[0] = PRIME32_3 + seed;
+    mAcc[1] = PRIME64_1 - seed;
+    mAcc[2] = PRIME64_2 + seed;
+    mAcc[3] = PRIME64_3 - seed;
+    mAcc[4] = PRIME64_4 + seed;
+    mAcc[5] = PRIME32_2 - seed;
+    mAcc[6] = PRIME64_5 + seed;
+    mAcc[7] = PRIME32_1 - seed;
+    mSeed = seed;
+    mTotalSize = 0;
+    mStripeIdx = 0;
+    mNumBufferedBytes = 0;
+    std::memset(mBuffer, 0, sizeof(mBuffer));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Adds the specified data to the hash
+//------------------------------------------------------------------------------------------------------------------------------------------
+void ContentHasher::add(const void* const pData, const size_t dataSize) noexcept {
+    const std::byte* pBytes = (const std::byte*) pData;
+    size_t bytesLeft = dataSize;
+    mTotalSize += dataSize;
+
+    // Complete any partial stripe waiting in the buffer first
+    if (mNumBufferedBytes > 0) {
+        const size_t bytesToBuffer = std::min<size_t>(STRIPE_SIZE - mNumBufferedBytes, bytesLeft);
+        std::memcpy(mBuffer + mNumBufferedBytes, pBytes, bytesToBuffer);
+        mNumBufferedBytes += (uint32_t) bytesToBuffer;
+        pBytes += bytesToBuffer;
+        bytesLeft -= bytesToBuffer;
+
+        if (mNumBufferedBytes < STRIPE_SIZE)
+            return;
+
+        consumeStripes(mBuffer, 1);
+        mNumBufferedBytes = 0;
+    }
+
+    // Consume whole stripes directly from the input and buffer whatever is left over
+    const size_t numWholeStripes = bytesLeft / STRIPE_SIZE;
+    consumeStripes(pBytes, numWholeStripes);
+    pBytes += numWholeStripes * STRIPE_SIZE;
+    bytesLeft -= numWholeStripes * STRIPE_SIZE;
+
+    if (bytesLeft > 0) {
+        std::memcpy(mBuffer, pBytes, bytesLeft);
+        mNumBufferedBytes = (uint32_t) bytesLeft;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Returns the hash of all data added so far.
+// More data can still be added afterwards, and the hash retrieved again.
+//------------------------------------------------------------------------------------------------------------------------------------------
+ContentHash ContentHasher::getHash() const noexcept {
+    // Mix in the last partial stripe (if any) using a copy of the accumulators, padding the stripe out with zeros.
+    // Note that the total data size is mixed in below, so padded data never hashes the same as the same data with actual zeros on the end.
+    uint64_t acc[NUM_LANES];
+    std::memcpy(acc, mAcc, sizeof(acc));
+
+    if (mNumBufferedBytes > 0) {
+        std::byte lastStripe[STRIPE_SIZE] = {};
+        std::memcpy(lastStripe, mBuffer, mNumBufferedBytes);
+        accumulateStripe(acc, lastStripe, mStripeIdx);
+    }
+
+    // Fold the accumulators down into the two 64-bit halves of the hash, using different keys and starting values for each half
+    ContentHash hash;
+    hash.word1 = mergeAccumulators(acc, 3, mTotalSize * PRIME64_1 + mSeed);
+    hash.word2 = mergeAccumulators(acc, 11, (~(mTotalSize * PRIME64_2)) ^ mSeed);
+    return hash;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Mixes the given number of whole stripes into the accumulators, scrambling them at the end of each block
+//------------------------------------------------------------------------------------------------------------------------------------------
+void ContentHasher::consumeStripes(const std::byte* pData, size_t numStripes) noexcept {
+    while (numStripes > 0) {
+        accumulateStripe(mAcc, pData, mStripeIdx);
+        pData += STRIPE_SIZE;
+        --numStripes;
+
+        if (++mStripeIdx >= STRIPES_PER_BLOCK) {
+            scrambleAccumulators(mAcc);
+            mStripeIdx = 0;
+        }
+    }
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// A 128-bit hash of some content, as computed by 'ContentHasher'
+//------------------------------------------------------------------------------------------------------------------------------------------
+struct ContentHash {
+    uint64_t    word1;      // Bits 0-63 of the hash
+    uint64_t    word2;      // Bits 64-127 of the hash
+
+    inline constexpr bool operator == (const ContentHash& other) const noexcept {
+        return ((word1 == other.word1) && (word2 == other.word2));
+    }
+
+    inline constexpr bool operator != (const ContentHash& other) const noexcept {
+        return (!(*this == other));
+    }
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Computes a fast 128-bit non-cryptographic hash of content such as lump data, for use as cache keys and for quick comparisons.
+// The design follows XXH3: the data is consumed in 64-byte stripes across 8 independent 64-bit accumulators using 32x32 -> 64-bit multiplies,
+// which the compiler can vectorize, and the accumulators are scrambled after every 1 KiB block and folded down into 128 bits at the end.
+//
+// Data can be added in pieces: the result is the same as hashing all of the data in one go.
+// The results are NOT compatible with the real XXH3 algorithm, and should not be used where security matters.
+// The hash values are stable across runs and platforms however, so they can be saved to disk.
+//------------------------------------------------------------------------------------------------------------------------------------------
+class ContentHasher {
+public:
+    static constexpr uint32_t STRIPE_SIZE = 64;
+    static constexpr uint32_t NUM_LANES = 8;
+    static constexpr uint32_t STRIPES_PER_BLOCK = 16;
+
+    static ContentHash hash(const void* const pData, const size_t dataSize, const uint64_t seed = 0) noexcept;
+
+    ContentHasher(const uint64_t seed = 0) noexcept;
+
+    void reset(const uint64_t seed = 0) noexcept;
+    void add(const void* const pData, const size_t dataSize) noexcept;
+    ContentHash getHash() const noexcept;
+
+    // Helper: adds the bytes of a plain value to the hash
+    template <class T>
+    inline void addValue(const T& value) noexcept {
+        static_assert(std::is_trivially_copyable_v<T>);
+        add(&value, sizeof(T));
+    }
+
+    inline uint64_t getTotalSize() const noexcept { return mTotalSize; }
+
+private:
+    void consumeStripes(const std::byte* pData, size_t numStripes) noexcept;
+
+    uint64_t    mAcc[NUM_LANES];            // The accumulators for each lane
+    uint64_t    mSeed;                      // Seed the hash was started with
+    uint64_t    mTotalSize;                 // Total number of bytes added to the hash
+    uint32_t    mStripeIdx;                 // Index of the next stripe within the current block
+    uint32_t    mNumBufferedBytes;          // How many bytes of a partial stripe are waiting in the buffer
+    std::byte   mBuffer[STRIPE_SIZE];       // Holds a partial stripe until there is enough data to consume it
+};
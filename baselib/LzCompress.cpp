@@ -0,0 +1,217 @@
+#include "LzCompress.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+BEGIN_NAMESPACE(LzCompress)
+
+static constexpr uint32_t   MIN_MATCH       = 4;        // Minimum length of a match: the match length stored is relative to this
+static constexpr size_t     LAST_LITERALS   = 5;        // The last 5 bytes of the input are always literals (LZ4 block format rule)
+static constexpr size_t     MF_LIMIT        = 12;       // A match can't start within this many bytes of the end of the input (LZ4 block format rule)
+static constexpr size_t     MAX_OFFSET      = 65535;    // Maximum distance back a match can be
+static constexpr uint32_t   HASH_BITS       = 14;       // Number of bits in the hash for the table of previous positions
+static constexpr uint32_t   RUN_MASK        = 15;       // Mask for the literal and match lengths in a sequence token
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Helper: reads 4 bytes of input which are used to find matches
+//------------------------------------------------------------------------------------------------------------------------------------------
+static inline uint32_t readU32(const uint8_t* const pBytes) noexcept {
+    uint32_t value;
+    std::memcpy(&value, pBytes, sizeof(value));
+    return value;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Helper: hashes 4 bytes of input to an index in the table of previous positions
+//------------------------------------------------------------------------------------------------------------------------------------------
+static inline uint32_t hashU32(const uint32_t value) noexcept {
+    return (value * 2654435761u) >> (32 - HASH_BITS);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Helper: writes the overflow part of a literal or match length which doesn't fit in a sequence token, as a series of bytes
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void writeLength(std::vector<std::byte>& output, size_t length) noexcept {
+    while (length >= 255) {
+        output.push_back(std::byte(255));
+        length -= 255;
+    }
+
+    output.push_back((std::byte) length);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Helper: writes a sequence of literals followed by a match, or just literals if it's the last sequence ('matchLen' of '0')
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void writeSequence(
+    std::vector<std::byte>& output,
+    const uint8_t* const pLiterals,
+    const size_t numLiterals,
+    const size_t matchOffset,
+    const size_t matchLen
+) noexcept {
+    const size_t matchLenCode = (matchLen > 0) ? matchLen - MIN_MATCH : 0;
+    const uint32_t token = (uint32_t)((std::min<size_t>(numLiterals, RUN_MASK) << 4) | std::min<size_t>(matchLenCode, RUN_MASK));
+    output.push_back((std::byte) token);
+
+    if (numLiterals >= RUN_MASK) {
+        writeLength(output, numLiterals - RUN_MASK);
+    }
+
+    output.insert(output.end(), (const std::byte*) pLiterals, (const std::byte*) pLiterals + numLiterals);
+
+    if (matchLen > 0) {
+        output.push_back((std::byte)(matchOffset & 0xFF));
+        output.push_back((std::byte)(matchOffset >> 8));
+
+        if (matchLenCode >= RUN_MASK) {
+            writeLength(output, matchLenCode - RUN_MASK);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Helper: reads the overflow part of a literal or match length and adds it to the given length.
+// Returns 'false' if the input ends before the length does.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool readLength(const uint8_t*& pInput, const uint8_t* const pInputEnd, size_t& length) noexcept {
+    uint32_t lengthByte;
+
+    do {
+        if (pInput >= pInputEnd)
+            return false;
+
+        lengthByte = *pInput++;
+        length += lengthByte;
+    } while (lengthByte == 255);
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Returns the largest size that compressing the given number of bytes could produce (for incompressible data)
+//------------------------------------------------------------------------------------------------------------------------------------------
+size_t getMaxCompressedSize(const size_t srcSize) noexcept {
+    return srcSize + srcSize / 255 + 16;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Compresses the given bytes and saves the result to the given output vector, replacing its contents
+//------------------------------------------------------------------------------------------------------------------------------------------
+void compress(const void* const pSrc, const size_t srcSize, std::vector<std::byte>& output) noexcept {
+    const uint8_t* const pSrcBytes = (const uint8_t*) pSrc;
+    output.clear();
+    output.reserve(getMaxCompressedSize(srcSize));
+
+    size_t anchor = 0;  // Start of the literals which have not been output yet
+
+    if (srcSize > MF_LIMIT) {
+        // Table of the last position (plus '1', so '0' means none) where each hash of 4 bytes was seen
+        std::unique_ptr<uint32_t[]> pPrevPositions = std::make_unique<uint32_t[]>((size_t) 1 << HASH_BITS);
+
+        const size_t matchEnd = srcSize - LAST_LITERALS;
+        const size_t lastMatchStart = srcSize - MF_LIMIT;
+        size_t pos = 0;
+
+        while (pos < lastMatchStart) {
+            // See if the 4 bytes at this position were seen recently
+            const uint32_t seq = readU32(pSrcBytes + pos);
+            uint32_t& prevPosEntry = pPrevPositions[hashU32(seq)];
+            size_t matchPos = prevPosEntry;
+            prevPosEntry = (uint32_t)(pos + 1);
+
+            if ((matchPos == 0) || (pos - (matchPos - 1) > MAX_OFFSET) || (readU32(pSrcBytes + matchPos - 1) != seq)) {
+                ++pos;
+                continue;
+            }
+
+            matchPos -= 1;
+
+            // Extend the match backwards into any pending literals and then forwards as far as possible
+            while ((pos > anchor) && (matchPos > 0) && (pSrcBytes[pos - 1] == pSrcBytes[matchPos - 1])) {
+                --pos;
+                --matchPos;
+            }
+
+            size_t matchLen = MIN_MATCH;
+
+            while ((pos + matchLen < matchEnd) && (pSrcBytes[pos + matchLen] == pSrcBytes[matchPos + matchLen])) {
+                ++matchLen;
+            }
+
+            writeSequence(output, pSrcBytes + anchor, pos - anchor, pos - matchPos, matchLen);
+            pos += matchLen;
+            anchor = pos;
+        }
+    }
+
+    // The remaining bytes are output as literals
+    writeSequence(output, pSrcBytes + anchor, srcSize - anchor, 0, 0);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Decompresses the given compressed bytes to the given output buffer, which must be exactly the size of the original data.
+// Returns 'false' if the compressed data is malformed or does not decompress to exactly the size expected.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool decompress(const void* const pSrc, const size_t srcSize, void* const pDst, const size_t dstSize) noexcept {
+    const uint8_t* pInput = (const uint8_t*) pSrc;
+    const uint8_t* const pInputEnd = pInput + srcSize;
+    uint8_t* const pOutputStart = (uint8_t*) pDst;
+    uint8_t* pOutput = pOutputStart;
+    uint8_t* const pOutputEnd = pOutput + dstSize;
+
+    while (true) {
+        // Read the token for the next sequence and the literals
+        if (pInput >= pInputEnd)
+            return false;
+
+        const uint32_t token = *pInput++;
+        size_t numLiterals = token >> 4;
+
+        if ((numLiterals == RUN_MASK) && (!readLength(pInput, pInputEnd, numLiterals)))
+            return false;
+
+        if ((numLiterals > (size_t)(pInputEnd - pInput)) || (numLiterals > (size_t)(pOutputEnd - pOutput)))
+            return false;
+
+        std::memcpy(pOutput, pInput, numLiterals);
+        pInput += numLiterals;
+        pOutput += numLiterals;
+
+        // The last sequence has no match and ends the input
+        if (pInput == pInputEnd)
+            return (pOutput == pOutputEnd);
+
+        // Read the match and copy it: note that the match can overlap the output, so copy a byte at a time
+        if (pInputEnd - pInput < 2)
+            return false;
+
+        const size_t matchOffset = (size_t) pInput[0] | ((size_t) pInput[1] << 8);
+        pInput += 2;
+
+        if ((matchOffset == 0) || (matchOffset > (size_t)(pOutput - pOutputStart)))
+            return false;
+
+        size_t matchLen = token & RUN_MASK;
+
+        if ((matchLen == RUN_MASK) && (!readLength(pInput, pInputEnd, matchLen)))
+            return false;
+
+        matchLen += MIN_MATCH;
+
+        if (matchLen > (size_t)(pOutputEnd - pOutput))
+            return false;
+
+        const uint8_t* pMatch = pOutput - matchOffset;
+
+        for (size_t i = 0; i < matchLen; ++i) {
+            pOutput[i] = pMatch[i];
+        }
+
+        pOutput += matchLen;
+    }
+}
+
+END_NAMESPACE(LzCompress)
@@ -0,0 +1,19 @@
+#pragma once
+
+#include "Macros.h"
+
+#include <cstddef>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// A small and fast byte oriented LZ77 compressor for data written to disk at runtime, such as save files.
+// The compressed data uses the LZ4 block format, so it can be inspected with standard LZ4 tools if needed.
+// Compression is greedy with a single hash table probe per position: the emphasis is on speed rather than ratio.
+//------------------------------------------------------------------------------------------------------------------------------------------
+BEGIN_NAMESPACE(LzCompress)
+
+size_t getMaxCompressedSize(const size_t srcSize) noexcept;
+void compress(const void* const pSrc, const size_t srcSize, std::vector<std::byte>& output) noexcept;
+bool decompress(const void* const pSrc, const size_t srcSize, void* const pDst, const size_t dstSize) noexcept;
+
+END_NAMESPACE(LzCompress)
@@ -0,0 +1,124 @@
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Utility for mapping files on disk into memory
+//------------------------------------------------------------------------------------------------------------------------------------------
+#include "MappedFile.h"
+
+#include "Asserts.h"
+
+#if _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <Windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Creates a mapped file object with no file mapped
+//------------------------------------------------------------------------------------------------------------------------------------------
+MappedFile::MappedFile() noexcept
+    : mpData(nullptr)
+    , mSize(0)
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Move the file mapping from one object to another
+//------------------------------------------------------------------------------------------------------------------------------------------
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : mpData(other.mpData)
+    , mSize(other.mSize)
+{
+    other.mpData = nullptr;
+    other.mSize = 0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Automatically unmaps the file to cleanup
+//------------------------------------------------------------------------------------------------------------------------------------------
+MappedFile::~MappedFile() noexcept {
+    close();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tries to map the entire contents of the specified file into memory and returns 'true' on success.
+// Empty files cannot be mapped and will fail to open. If a file is currently mapped then it is unmapped first.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool MappedFile::open(const char* const filePath) noexcept {
+    ASSERT(filePath);
+    close();
+
+    #if _WIN32
+        const HANDLE hFile = CreateFileA(filePath, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+        if (hFile == INVALID_HANDLE_VALUE)
+            return false;
+
+        LARGE_INTEGER fileSize = {};
+
+        if ((!GetFileSizeEx(hFile, &fileSize)) || (fileSize.QuadPart <= 0)) {
+            CloseHandle(hFile);
+            return false;
+        }
+
+        // Note: the view keeps the mapping alive, so the file and mapping handles can be closed immediately after mapping
+        const HANDLE hMapping = CreateFileMappingA(hFile, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+        CloseHandle(hFile);
+
+        if (!hMapping)
+            return false;
+
+        void* const pView = MapViewOfFile(hMapping, FILE_MAP_COPY, 0, 0, 0);
+        CloseHandle(hMapping);
+
+        if (!pView)
+            return false;
+
+        mpData = (std::byte*) pView;
+        mSize = (size_t) fileSize.QuadPart;
+    #else
+        const int fd = ::open(filePath, O_RDONLY);
+
+        if (fd < 0)
+            return false;
+
+        struct stat fileInfo = {};
+
+        if ((fstat(fd, &fileInfo) != 0) || (fileInfo.st_size <= 0)) {
+            ::close(fd);
+            return false;
+        }
+
+        // Note: the mapping remains valid after the file descriptor is closed
+        void* const pView = mmap(nullptr, (size_t) fileInfo.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+
+        if (pView == MAP_FAILED)
+            return false;
+
+        mpData = (std::byte*) pView;
+        mSize = (size_t) fileInfo.st_size;
+    #endif
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Unmaps the currently mapped file, if any
+//------------------------------------------------------------------------------------------------------------------------------------------
+void MappedFile::close() noexcept {
+    if (!mpData)
+        return;
+
+    #if _WIN32
+        UnmapViewOfFile(mpData);
+    #else
+        munmap(mpData, mSize);
+    #endif
+
+    mpData = nullptr;
+    mSize = 0;
+}
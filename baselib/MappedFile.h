@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Provides a read only view of an entire file on disk by mapping the file into memory.
+// The view is mapped copy-on-write, so the memory may be modified without affecting the file on disk.
+//------------------------------------------------------------------------------------------------------------------------------------------
+class MappedFile {
+public:
+    MappedFile() noexcept;
+    MappedFile(MappedFile&& other) noexcept;
+    ~MappedFile() noexcept;
+
+    bool open(const char* const filePath) noexcept;
+    void close() noexcept;
+
+    inline bool isOpen() const noexcept { return (mpData != nullptr); }
+    inline std::byte* getData() const noexcept { return mpData; }
+    inline size_t getSize() const noexcept { return mSize; }
+
+private:
+    MappedFile(const MappedFile& other) = delete;
+    MappedFile& operator = (const MappedFile& other) = delete;
+    MappedFile& operator = (MappedFile&& other) = delete;
+
+    std::byte*  mpData;     // The start of the mapped file data or 'nullptr' if no file is mapped
+    size_t      mSize;      // The size of the mapped file data in bytes
+};
@@ -4,9 +4,15 @@
 #
 # Usage:
 #   python run_demo_tests.py <demoset|all> <psydoom_path> <demos_dir>
+#   python run_demo_tests.py dir <psydoom_path> <demos_dir> <cue_file>
+#
+# The 'dir' mode verifies every '.LMP' demo in the given directory which has a matching '.result.json' file, using the given .cue file.
+# Demos are verified in parallel with one PsyDoom process per CPU core, since the engine state is global and can't be shared.
 ############################################################################################################################################
+import glob
 import multiprocessing
 import os
+import re
 import subprocess
 import sys
 import time
@@ -75,7 +81,22 @@ demosets = {
     },
 }
 
-# This function executes the demo in a worker process
+# Builds a demoset from all the demos in the given directory that have a matching expected result file
+def make_dir_demoset(demos_dir, cue_file):
+    tests = []
+
+    for demo_path in sorted(glob.glob(os.path.join(demos_dir, "*.LMP"))):
+        demo_file = os.path.basename(demo_path)
+        result_file = os.path.splitext(demo_file)[0] + ".result.json"
+
+        if os.path.isfile(os.path.join(demos_dir, result_file)):
+            tests.append([ demo_file, result_file ])
+        else:
+            print("Skipping demo with no expected result file: {0:s}".format(demo_path))
+
+    return { "cue_file" : cue_file, "tests" : tests }
+
+# This function executes the demo in a worker process and returns whether it passed
 def run_demo(psydoom_path, cue_file_path, demos_dir, demo_and_result):
     # Show what demo we are about to run
     demo_path = os.path.join(demos_dir, demo_and_result[0])
@@ -83,73 +104,87 @@ def run_demo(psydoom_path, cue_file_path, demos_dir, demo_and_result):
 
     # Execute the demo using PsyDoom in headless mode and verify the result.
     # PsyDoom will return '0' if the demo was successful.
-    result = subprocess.call(
+    start_time = time.time()
+    process = subprocess.run(
         [psydoom_path, "-cue", cue_file_path, "-headless", "-playdemo", demo_path, "-checkresult", result_path],
         shell=False,
-        stdout=subprocess.PIPE,     # Hide output
-        stderr=subprocess.PIPE      # Hide output
+        stdout=subprocess.PIPE,     # Hide output (but capture it to get the tick count)
+        stderr=subprocess.PIPE,     # Hide output
+        universal_newlines=True
     )
+    time_taken = max(time.time() - start_time, 1e-6)
+
+    # Figure out the simulation throughput from the number of demo ticks that PsyDoom reports were played
+    ticks_match = re.search(r"Demo ticks played: (\d+)", process.stdout)
+    ticks_info = "{0:.0f} ticks/sec".format(int(ticks_match.group(1)) / time_taken) if ticks_match else "unknown ticks/sec"
 
     # If the test failed (error code != 0) then inform the user.
     # Otherwise print that the test succeeded
-    if result == 0:
-        print("Test passed: {0:s}".format(demo_path))
+    if process.returncode == 0:
+        print("Test passed: {0:s} ({1:.2f} seconds, {2:s})".format(demo_path, time_taken, ticks_info), flush=True)
+        return True
     else:
-        print("[TEST FAIL] Unexpected demo result!: {0:s}".format(demo_path))
-        sys.exit(1)
+        print("[TEST FAIL] Unexpected demo result!: {0:s} ({1:.2f} seconds, {2:s})".format(demo_path, time_taken, ticks_info), flush=True)
+        return False
 
 # High level script logic
 def main():
     # Verify program args
-    if len(sys.argv) != 4:
+    dir_mode = (len(sys.argv) == 5) and (sys.argv[1] == "dir")
+
+    if (len(sys.argv) != 4) and (not dir_mode):
         print("Usage: python run_demo_tests.py <demoset|all> <psydoom_path> <demos_dir>")
+        print("       python run_demo_tests.py dir <psydoom_path> <demos_dir> <cue_file>")
         sys.exit(1)
 
     psydoom_path = sys.argv[2]
     demos_dir = sys.argv[3]
 
-    # Verify demoset argument is okay or 'all' is specified
-    demoset_arg = sys.argv[1]
-    single_demoset = demosets.get(demoset_arg)
+    if dir_mode:
+        run_demosets = [ make_dir_demoset(demos_dir, sys.argv[4]) ]
+    else:
+        # Verify demoset argument is okay or 'all' is specified
+        demoset_arg = sys.argv[1]
+        single_demoset = demosets.get(demoset_arg)
 
-    if not single_demoset and demoset_arg != "all":
-        print("Invalid demoset '{0:s}'!".format(demoset_arg))
-        sys.exit(1)
+        if not single_demoset and demoset_arg != "all":
+            print("Invalid demoset '{0:s}'!".format(demoset_arg))
+            sys.exit(1)
 
-    if single_demoset:
-        run_demosets = [ single_demoset ]
-    else:
-        run_demosets = demosets.values()
+        if single_demoset:
+            run_demosets = [ single_demoset ]
+        else:
+            run_demosets = demosets.values()
 
-    # Start running the demos and verify they match the expected results
-    all_tests_passed = True
+    # Start running the demos and verify they match the expected results.
+    # Use one worker process per CPU core, so that heavy demo corpora don't oversubscribe the machine.
     start_time = time.time()
-    jobs = []
+    job_args = []
 
     for demoset in run_demosets:
         for demo_and_result in demoset["tests"]:
-            job = multiprocessing.Process(
-                target=run_demo,
-                args=(psydoom_path, demoset["cue_file"], demos_dir, demo_and_result)
-            )
-            job.start()
-            jobs.append(job)
-
-    for job in jobs:
-        job.join()
-        if job.exitcode != 0:
-            all_tests_passed = False
+            job_args.append((psydoom_path, demoset["cue_file"], demos_dir, demo_and_result))
+
+    with multiprocessing.Pool(processes=multiprocessing.cpu_count()) as pool:
+        results = pool.starmap(run_demo, job_args)
+
+    all_tests_passed = all(results)
+    num_passed = sum(1 for passed in results if passed)
 
     # Print the overall result
     if all_tests_passed:
-        print("All tests executed successfully!")
+        print("All tests executed successfully! ({0:d} demos)".format(len(results)))
     else:
-        print("Some tests FAILED! Overall result is FAIL!")
+        print("Some tests FAILED! {0:d} of {1:d} demos passed. Overall result is FAIL!".format(num_passed, len(results)))
 
     # Print time taken
     time_taken = time.time() - start_time
     print("Time taken: {0:f} seconds".format(time_taken))
 
+    # Return a non zero exit code on failure so this can be used in CI
+    if not all_tests_passed:
+        sys.exit(1)
+
 # This is required for correct parallelism on Windows.
 # See: https://stackoverflow.com/questions/18204782/runtimeerror-on-windows-trying-python-multiprocessing
 if __name__ == '__main__':
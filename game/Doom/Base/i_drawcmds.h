@@ -46,3 +46,46 @@ inline void I_AddPrim(const FLOORROW_FT& row) noexcept {
 inline void I_AddPrim(const WALLCOL_GT& col) noexcept {
     LIBGPU_CmdDispatch::submit(col);
 }
+
+inline void I_AddPrim(const WALLCOL_F& col) noexcept {
+    LIBGPU_CmdDispatch::submit(col);
+}
+
+// Submits a group of sprites which all share the same CLUT and primitive flags (shading, semi-transparency etc.) in one go
+inline void I_AddPrims(const SPRT* const pSprites, const uint32_t numSprites) noexcept {
+    LIBGPU_CmdDispatch::submit(pSprites, numSprites);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Collects sprites which all share the same CLUT and primitive flags and submits them in groups via 'I_AddPrims'.
+// This is useful for drawing things made up of many small sprites, like text, since most of the GPU state only needs to be setup once
+// for each group. The sprites are drawn in the order they are added; any still pending are submitted on 'flush' or destruction.
+//------------------------------------------------------------------------------------------------------------------------------------------
+class I_SpriteBatcher {
+public:
+    static constexpr uint32_t MAX_SPRITES = 64;
+
+    inline I_SpriteBatcher() noexcept : mNumSprites(0) {}
+    inline ~I_SpriteBatcher() noexcept { flush(); }
+
+    I_SpriteBatcher(const I_SpriteBatcher& other) = delete;
+    I_SpriteBatcher& operator = (const I_SpriteBatcher& other) = delete;
+
+    inline void add(const SPRT& sprite) noexcept {
+        if (mNumSprites >= MAX_SPRITES) {
+            flush();
+        }
+
+        mSprites[mNumSprites] = sprite;
+        mNumSprites++;
+    }
+
+    inline void flush() noexcept {
+        I_AddPrims(mSprites, mNumSprites);
+        mNumSprites = 0;
+    }
+
+private:
+    uint32_t    mNumSprites;
+    SPRT        mSprites[MAX_SPRITES];
+};
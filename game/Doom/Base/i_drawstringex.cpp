@@ -96,10 +96,12 @@ static int32_t DetermineLineWidth(const char* const str, const uint32_t numChars
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Draws a single line of text using the big font and the specified sprite primitive.
+// Makes the glyph sprites for a single line of text using the big font and the specified sprite primitive, and adds them to the given sink.
+// The sink can be anything with an 'add(const SPRT&)' method, such as an 'I_SpriteBatcher'.
 // The current draw mode and most shared draw state of the sprite primitive is expected to have been setup prior to calling.
 //------------------------------------------------------------------------------------------------------------------------------------------
-static void DrawStringLine_BigFont(const DrawStringLine& line, const DrawStringParams& params, SPRT& spritePrim) noexcept {
+template <class GlyphSinkT>
+static void DrawStringLine_BigFont(const DrawStringLine& line, const DrawStringParams& params, SPRT& spritePrim, GlyphSinkT& glyphSink) noexcept {
     int32_t curX = line.posX;
 
     for (uint32_t i = 0; i < line.length; ++i) {
@@ -129,7 +131,7 @@ static void DrawStringLine_BigFont(const DrawStringLine& line, const DrawStringP
         LIBGPU_setXY0(spritePrim, (int16_t) curX, (int16_t)(line.posY + yAdjust));
         LIBGPU_setUV0(spritePrim, fontchar.u, fontchar.v);
         LIBGPU_setWH(spritePrim, fontchar.w, fontchar.h);
-        I_AddPrim(spritePrim);
+        glyphSink.add(spritePrim);
 
         // Move past the drawn character
         curX += fontchar.w;
@@ -137,10 +139,12 @@ static void DrawStringLine_BigFont(const DrawStringLine& line, const DrawStringP
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Draws a single line of text using the small font and the specified sprite primitive.
+// Makes the glyph sprites for a single line of text using the small font and the specified sprite primitive, and adds them to the given sink.
+// The sink can be anything with an 'add(const SPRT&)' method, such as an 'I_SpriteBatcher'.
 // The current draw mode and most shared draw state of the sprite primitive is expected to have been setup prior to calling.
 //------------------------------------------------------------------------------------------------------------------------------------------
-void DrawStringLine_SmallFont(const DrawStringLine& line, const DrawStringParams& params, SPRT& spritePrim) noexcept {
+template <class GlyphSinkT>
+static void DrawStringLine_SmallFont(const DrawStringLine& line, const DrawStringParams& params, SPRT& spritePrim, GlyphSinkT& glyphSink) noexcept {
     spritePrim.y0 = (int16_t) line.posY;
     int32_t curX = line.posX;
 
@@ -174,7 +178,7 @@ void DrawStringLine_SmallFont(const DrawStringLine& line, const DrawStringParams
             // Populate and submit the draw primitive
             spritePrim.x0 = (int16_t) curX;
             LIBGPU_setUV0(spritePrim, (uint8_t) texU, (uint8_t) texV);
-            I_AddPrim(spritePrim);
+            glyphSink.add(spritePrim);
         }
 
         curX += SMALL_FONT_SIZE;
@@ -276,27 +280,31 @@ void I_DrawStringEx_LayoutText(
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Performs the actual drawing after layout has been done.
-// Assumes all the strings references generated during layout are still valid.
+// Sets the draw mode for drawing text with the specified parameters
 //------------------------------------------------------------------------------------------------------------------------------------------
-void I_DrawStringEx_PostLayoutDraw(const DrawStringParams& params) noexcept {
+static void SetTextDrawMode(const DrawStringParams& params) noexcept {
     // Set the draw mode to remove the current texture window (set it to the max size).
     // Also set the current texture page to that of the STATUS graphic.
-    {
-        DR_MODE drawModePrim = {};
-        const SRECT texWindow = { (int16_t) gTex_STATUS.texPageCoordX, (int16_t) gTex_STATUS.texPageCoordY, 256, 256 };
-        
-        LIBGPU_SetDrawMode(
-            drawModePrim,
-            false,
-            false,
-            gTex_STATUS.texPageId | LIBGPU_GetTPageSemiTransBits(params.semiTransMode),
-            &texWindow
-        );
-
-        I_AddPrim(drawModePrim);
-    }
+    DR_MODE drawModePrim = {};
+    const SRECT texWindow = { (int16_t) gTex_STATUS.texPageCoordX, (int16_t) gTex_STATUS.texPageCoordY, 256, 256 };
+
+    LIBGPU_SetDrawMode(
+        drawModePrim,
+        false,
+        false,
+        gTex_STATUS.texPageId | LIBGPU_GetTPageSemiTransBits(params.semiTransMode),
+        &texWindow
+    );
+
+    I_AddPrim(drawModePrim);
+}
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Makes the glyph sprites for all the lines of text laid out by 'I_DrawStringEx_LayoutText' and adds them to the given sink.
+// The sink can be anything with an 'add(const SPRT&)' method, such as an 'I_SpriteBatcher'.
+//------------------------------------------------------------------------------------------------------------------------------------------
+template <class GlyphSinkT>
+static void MakeLaidOutTextGlyphs(const DrawStringParams& params, GlyphSinkT& glyphSink) noexcept {
     // Some basic setup of the sprite primitive for all characters
     SPRT spritePrim = {};
     LIBGPU_SetSprt(spritePrim);
@@ -314,16 +322,67 @@ void I_DrawStringEx_PostLayoutDraw(const DrawStringParams& params) noexcept {
 
     if (params.bUseSmallFont) {
         for (int32_t i = 0; i < metrics.numLines; ++i) {
-            DrawStringLine_SmallFont(gDrawStringEx_lines[i], params, spritePrim);
+            DrawStringLine_SmallFont(gDrawStringEx_lines[i], params, spritePrim, glyphSink);
         }
     }
     else {
         for (int32_t i = 0; i < metrics.numLines; ++i) {
-            DrawStringLine_BigFont(gDrawStringEx_lines[i], params, spritePrim);
+            DrawStringLine_BigFont(gDrawStringEx_lines[i], params, spritePrim, glyphSink);
         }
     }
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Performs the actual drawing after layout has been done.
+// Assumes all the strings references generated during layout are still valid.
+// The glyphs are submitted in groups rather than one at a time, since they all share the same texture page, CLUT and style.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void I_DrawStringEx_PostLayoutDraw(const DrawStringParams& params) noexcept {
+    SetTextDrawMode(params);
+
+    I_SpriteBatcher spriteBatcher;
+    MakeLaidOutTextGlyphs(params, spriteBatcher);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Removes all text from a text batch and sets the style settings that will be used for any text added to it
+//------------------------------------------------------------------------------------------------------------------------------------------
+void I_DrawStringBatch_Clear(DrawStringBatch& batch, const DrawStringParams& params) noexcept {
+    batch.params = params;
+    batch.glyphs.clear();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Lays out the given string in the same way as 'I_DrawStringEx' and adds the glyph sprites for it to the text batch.
+// Note: this overwrites the layout results ('gDrawStringEx_lines' and 'gDrawStringEx_metrics') of any previous 'I_DrawStringEx' call.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void I_DrawStringBatch_Add(DrawStringBatch& batch, const int32_t x, const int32_t y, const char* const str) noexcept {
+    // Adds glyph sprites onto the end of the batch
+    struct BatchGlyphSink {
+        std::vector<SPRT>& glyphs;
+
+        inline void add(const SPRT& sprite) noexcept {
+            glyphs.push_back(sprite);
+        }
+    };
+
+    BatchGlyphSink glyphSink = { batch.glyphs };
+    I_DrawStringEx_LayoutText(x, y, batch.params, str);
+    MakeLaidOutTextGlyphs(batch.params, glyphSink);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Draws all of the text in a text batch in one go.
+// The batch can be drawn again on later frames as many times as required, without having to re-do the text layout.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void I_DrawStringBatch(const DrawStringBatch& batch) noexcept {
+    if (batch.glyphs.empty())
+        return;
+
+    SetTextDrawMode(batch.params);
+    I_AddPrims(batch.glyphs.data(), (uint32_t) batch.glyphs.size());
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Counts the number of lines ("\n") in the specified string to be drawn.
 // Useful for layout purposes.
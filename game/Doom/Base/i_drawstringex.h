@@ -2,6 +2,12 @@
 
 #include <cstdint>
 
+#if PSYDOOM_MODS
+    #include "PsyQ/LIBGPU.h"
+
+    #include <vector>
+#endif
+
 #if PSYDOOM_MODS
     // Text positioning/anchor mode for the x or y axis when using PsyDoom's new 'I_DrawStringEx()' function.
     enum class DrawStringAnchorMode : uint8_t {
@@ -65,4 +71,16 @@
     void I_DrawStringEx_PostLayoutDraw(const DrawStringParams& params) noexcept;
     int32_t I_DrawStringEx_CountNumLines(const char* const str) noexcept;
 
+    // A batch of text which is all drawn using the same font and style settings, and therefore the same texture page and CLUT.
+    // Text added to the batch is laid out immediately and saved as glyph sprites, which 'I_DrawStringBatch' then draws in one go.
+    // Keeping a batch around and drawing it again on later frames also saves re-doing the layout for text that hasn't changed.
+    struct DrawStringBatch {
+        DrawStringParams    params;     // Style settings for all text in the batch
+        std::vector<SPRT>   glyphs;     // Sprites for all the glyphs in the batch, in drawing order
+    };
+
+    void I_DrawStringBatch_Clear(DrawStringBatch& batch, const DrawStringParams& params) noexcept;
+    void I_DrawStringBatch_Add(DrawStringBatch& batch, const int32_t x, const int32_t y, const char* const str) noexcept;
+    void I_DrawStringBatch(const DrawStringBatch& batch) noexcept;
+
 #endif  // #if PSYDOOM_MODS
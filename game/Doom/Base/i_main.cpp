@@ -10,18 +10,25 @@
 #include "Doom/Renderer/r_data.h"
 #include "Doom/UI/errormenu_main.h"
 #include "FatalErrors.h"
+#include "Finally.h"
 #include "i_drawcmds.h"
 #include "i_texcache.h"
+#include "PsyDoom/Config/Config.h"
 #include "PsyDoom/Controls.h"
 #include "PsyDoom/DemoPlayer.h"
+#include "PsyDoom/FrameProfiler.h"
 #include "PsyDoom/Game.h"
 #include "PsyDoom/Input.h"
 #include "PsyDoom/MapHash.h"
+#include "PsyDoom/NetStats.h"
 #include "PsyDoom/Network.h"
 #include "PsyDoom/PlayerPrefs.h"
 #include "PsyDoom/ProgArgs.h"
 #include "PsyDoom/PsxPadButtons.h"
 #include "PsyDoom/PsxVm.h"
+#include "PsyDoom/ScriptingEngine.h"
+#include "PsyDoom/SoakTest.h"
+#include "PsyDoom/TimeDemo.h"
 #include "PsyDoom/Utils.h"
 #include "PsyDoom/Video.h"
 #include "PsyDoom/Vulkan/VDrawing.h"
@@ -43,6 +50,15 @@
     static std::chrono::steady_clock::time_point gAppStartTime;
 #endif
 
+// PsyDoom: these are not declared in the 'i_main' and 'Utils' headers to avoid exposing the <chrono> library
+#if PSYDOOM_MODS
+    std::chrono::steady_clock::time_point I_GetVBlankTimepoint(const int32_t vblankIdx) noexcept;
+
+    namespace Utils {
+        void sleepUntil(const std::chrono::steady_clock::time_point wakeTime, const bool bPowerSaver) noexcept;
+    }
+#endif
+
 // Video vblank timers: track the total amount, last total and current elapsed amount
 uint32_t gTotalVBlanks;
 uint32_t gLastTotalVBlanks;
@@ -123,11 +139,20 @@ texture_t gTex_CONNECT;
 
     // The current network protocol version.
     // Should be incremented whenever the data format being transmitted changes, or when updates might cause differences in game behavior.
-    static constexpr int32_t NET_PROTOCOL_VERSION = 32;
+    static constexpr int32_t NET_PROTOCOL_VERSION = 37;
+
+    // Game error checking values for the most recent network updates, indexed by update number (wrapping).
+    // Have to store these because packets are sent ahead of time and always contain the error checking value from 'NET_MAX_INPUT_DELAY'
+    // updates before the tick they are for, which is a point in time both players are guaranteed to have reached when sending.
+    static constexpr uint32_t NET_ERROR_CHECK_HISTORY_LEN = NET_MAX_INPUT_DELAY + 1;
+    static uint32_t gNetErrorCheckHistory[NET_ERROR_CHECK_HISTORY_LEN];
+
+    // How many network updates have been done and how many tick packets have been sent to the other player in this session
+    static uint32_t gNetNumUpdates;
+    static uint32_t gNetNumPacketsSent;
 
-    // Previous game error checking value when we last sent to the other player.
-    // Have to store this because we always send 1 packet ahead for the next frame.
-    static uint32_t gNetPrevErrorCheck;
+    // The input delay (in ticks) we are trying to switch to: the input delay changes at most by one tick per network update
+    static int32_t gNetTargetInputDelay;
 
     // Flag set to true upon connection and cleared the first call to 'I_NetUpdate'.
     // Lets us know when we are sending the first update packet of the session.
@@ -555,6 +580,28 @@ int16_t  I_GetCenteredDrawPos_Y(texture_t& tex) noexcept {
 
 #endif  // #if PSYDOOM_MODS
 
+#if PSYDOOM_MODS
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom helper: swaps the framebuffers and displays the new front buffer immediately, without waiting for any vblanks to elapse.
+// Used for one-off frames such as loading plaques, where there is no game timing to keep and any waiting just holds up the caller.
+// Note: the elapsed vblank counters are left alone so the next normal frame's timing is unaffected.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void I_PresentWithoutPacing() noexcept {
+    LIBGPU_DrawSync(0);
+
+    gCurDispBufferIdx ^= 1;
+    LIBGPU_PutDrawEnv(gDrawEnvs[gCurDispBufferIdx]);
+    LIBGPU_PutDispEnv(gDispEnvs[gCurDispBufferIdx]);
+
+    // When doing a benchmark with '-nopresent' skip displaying, same as 'I_DrawPresent'
+    const bool bSkipDisplay = (ProgArgs::gbNoPresent && (Video::gBackendType != Video::BackendType::Vulkan));
+
+    if (!bSkipDisplay) {
+        Video::displayFramebuffer();
+    }
+}
+#endif  // #if PSYDOOM_MODS
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Copies the front buffer to the back buffer, draws a loading plaque over it and presents it to the screen.
 // Useful for drawing a loading message before doing a long running load or connect operation.
@@ -589,10 +636,16 @@ void I_DrawLoadingPlaque(texture_t& tex, const int16_t xpos, const int16_t ypos,
 
     I_CacheTex(tex);
 
-    // Draw and present the plaque
+    // Draw and present the plaque.
+    // PsyDoom: present without the frame pacing done by 'I_DrawPresent', since loading work is waiting on this and nothing is animating.
     I_DrawSprite(tex.texPageId, clutId, xpos, ypos, tex.texPageCoordX, tex.texPageCoordY, tex.width, tex.height);
     I_SubmitGpuCmds();
-    I_DrawPresent();
+
+    #if PSYDOOM_MODS
+        I_PresentWithoutPacing();
+    #else
+        I_DrawPresent();
+    #endif
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -602,11 +655,40 @@ void I_IncDrawnFrameCount() noexcept {
     gNumFramesDrawn++;
 }
 
+#if PSYDOOM_MODS
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: waits for a short while, in the direction of the specified vblank, while keeping the app responsive.
+// This replaces the original busy wait on the vblank counter: rather than spinning with thread yields the thread sleeps for most of the wait
+// and only spins for the last fraction of a millisecond, so the next frame still starts on time. Each wait is capped to a millisecond or so
+// in order to keep platform updates (input polling, sound etc.) happening at their usual rate; the caller should check the vblank count again
+// afterwards and repeat until the required number of vblanks have elapsed.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void I_WaitTowardsVBlank(const int32_t vblankIdx) noexcept {
+    Utils::doPlatformUpdates();
+
+    // When the vblank will happen, taking into account the time adjustment for networked games (see 'I_GetTotalVBlanks')
+    const std::chrono::milliseconds netTimeAdjust = std::chrono::milliseconds((gNetGame != gt_single) ? gNetTimeAdjustMs : 0);
+    const std::chrono::steady_clock::time_point vblankTime = I_GetVBlankTimepoint(vblankIdx) - netTimeAdjust;
+
+    // When paused or outside of a level (menus, intermission etc.) precise timing doesn't matter much, so optionally save some CPU.
+    // Input polling is also less important in these cases, so the wait can be a bit longer.
+    const bool bPowerSaver = (Config::gbFrameLimiterPowerSaver && (gbGamePaused || (!gbIsLevelDataCached)));
+    const std::chrono::milliseconds maxWaitTime = std::chrono::milliseconds((bPowerSaver) ? 4 : 1);
+    const std::chrono::steady_clock::time_point wakeTime = std::min(vblankTime, std::chrono::steady_clock::now() + maxWaitTime);
+    Utils::sleepUntil(wakeTime, bPowerSaver);
+}
+#endif  // #if PSYDOOM_MODS
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Swaps the draw and display framebuffers, causing the current frame being rendered to be displayed onscreen.
 // Also does framerate limiting to 30 Hz and updates the elapsed vblank count, which feeds the game's timing system.
 //------------------------------------------------------------------------------------------------------------------------------------------
 void I_DrawPresent() noexcept {
+    // PsyDoom: let the frame profiler know when the frame has ended (if compiled in), no matter how we exit this function
+    #if PSYDOOM_FRAME_PROFILER
+        const auto profilerEndFrame = finally([]() noexcept { FrameProfiler::endFrame(); });
+    #endif
+
     // Finish up all in-flight drawing commands
     LIBGPU_DrawSync(0);
 
@@ -619,9 +701,18 @@ void I_DrawPresent() noexcept {
     LIBGPU_PutDrawEnv(gDrawEnvs[gCurDispBufferIdx]);
     LIBGPU_PutDispEnv(gDispEnvs[gCurDispBufferIdx]);
 
-    // PsyDoom: copy the PSX framebuffer to the display
+    // PsyDoom: copy the PSX framebuffer to the display.
+    // When doing a timedemo benchmark with '-nopresent' skip this step, unless the Vulkan renderer is being used.
+    // The Vulkan renderer must always 'display' the framebuffer because that is what causes the frame to actually be drawn.
     #if PSYDOOM_MODS
-        Video::displayFramebuffer();
+        const bool bSkipDisplay = (ProgArgs::gbNoPresent && (Video::gBackendType != Video::BackendType::Vulkan));
+
+        if (!bSkipDisplay) {
+            Video::displayFramebuffer();
+        }
+
+        // PsyDoom: the frame has been handed off for display, so use some of the idle time before the next frame to collect script garbage
+        ScriptingEngine::doIdleGC();
     #endif
 
     // How many vblanks there are in a demo tick
@@ -631,6 +722,18 @@ void I_DrawPresent() noexcept {
         const int32_t demoTickVBlanks = VBLANKS_PER_TIC;
     #endif
 
+    // PsyDoom: if doing a timedemo or soak benchmark then don't wait for any time to elapse, just advance by 1 demo tick and continue on.
+    // Still do platform updates however so that the window stays responsive.
+    #if PSYDOOM_MODS
+        if (TimeDemo::isActive() || SoakTest::isActive()) {
+            Utils::doPlatformUpdates();
+            gTotalVBlanks += demoTickVBlanks;
+            gElapsedVBlanks = demoTickVBlanks;
+            gLastTotalVBlanks = gTotalVBlanks;
+            return;
+        }
+    #endif
+
     // Continously poll and wait until the required number of vblanks have elapsed before continuing
     while (true) {
         // PsyDoom: use 'I_GetTotalVBlanks' because it can adjust time in networked games
@@ -671,10 +774,9 @@ void I_DrawPresent() noexcept {
         if (gElapsedVBlanks >= 2)
             break;
 
-        // PsyDoom: do platform updates (sound, window etc.) and yield some cpu since we are waiting for a bit
+        // PsyDoom: do platform updates (sound, window etc.) and sleep for a bit since we are waiting
         #if PSYDOOM_MODS
-            Utils::doPlatformUpdates();
-            Utils::threadYield();
+            I_WaitTowardsVBlank((int32_t) gLastTotalVBlanks + 2);
         #endif
     }
 
@@ -683,10 +785,9 @@ void I_DrawPresent() noexcept {
     // Probably done so the simulation remains consistent!
     if (Game::gSettings.bUseDemoTimings) {
         while (gElapsedVBlanks < (uint32_t) demoTickVBlanks) {
-            // PsyDoom: do platform updates (sound, window etc.) and yield some cpu since we are waiting for a bit
+            // PsyDoom: do platform updates (sound, window etc.) and sleep for a bit since we are waiting
             #if PSYDOOM_MODS
-                Utils::doPlatformUpdates();
-                Utils::threadYield();
+                I_WaitTowardsVBlank((int32_t) gLastTotalVBlanks + demoTickVBlanks);
             #endif
 
             // PsyDoom: use 'I_GetTotalVBlanks' because it can adjust time in networked games
@@ -755,7 +856,11 @@ void I_NetSetup() noexcept {
     gCurPlayerIndex = (bIsPlayer1) ? 0 : 1;
 
     // Clear these value initially and set whether the game is being demo recorded based on the settings of this peer
-    gNetPrevErrorCheck = {};
+    std::fill(std::begin(gNetErrorCheckHistory), std::end(gNetErrorCheckHistory), 0);
+    gNetNumUpdates = 0;
+    gNetNumPacketsSent = 0;
+    gNetTargetInputDelay = (ProgArgs::gNetInputDelay > 0) ? std::min(ProgArgs::gNetInputDelay, NET_MAX_INPUT_DELAY) : 1;
+    gNumNextTickInputs = 0;
     gNetTimeAdjustMs = 0;
     gLastInputPacketDelayMs = 0;
     gbNetIsGameBeingRecorded = ProgArgs::gbRecordDemos;
@@ -765,6 +870,7 @@ void I_NetSetup() noexcept {
     outPkt.protocolVersion = NET_PROTOCOL_VERSION;
     outPkt.gameId = Game::gConstants.netGameId;
     outPkt.bIsDemoRecording = ProgArgs::gbRecordDemos;
+    outPkt.bWantsUdpTransport = ProgArgs::gbNetUseUdp;
 
     if (gCurPlayerIndex == 0) {
         outPkt.startGameType = gStartGameType;
@@ -826,6 +932,15 @@ void I_NetSetup() noexcept {
         Game::gSettings = settings;
     }
 
+    // If both players want it then switch over to sending tick updates via UDP instead of TCP
+    if (outPkt.bWantsUdpTransport && inPkt.bWantsUdpTransport) {
+        if (!Network::beginUdpTransport()) {
+            RunNetErrorMenu_FailedToConnect();
+            gbDidAbortGame = true;
+            return;
+        }
+    }
+
     // One last check to see if the network connection was killed.
     // This will happen if an error occurred, and if this is the case then we should abort the connection attempt:
     if (!Network::isConnected()) {
@@ -838,8 +953,78 @@ void I_NetSetup() noexcept {
     gbDidAbortGame = false;
     gbNetIsFirstNetUpdate = true;
 
-    // Start requesting tick packets
+    // Start requesting tick packets and measuring network telemetry
     Network::requestTickPackets();
+    NetStats::init();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: get the error checking value that should be in the tick packet with the specified index.
+// This is for the game state 'NET_MAX_INPUT_DELAY' updates before the update the packet is for (or the first update, early on).
+//------------------------------------------------------------------------------------------------------------------------------------------
+static uint32_t I_NetGetErrorCheckForPacket(const uint32_t packetIdx) noexcept {
+    const uint32_t updateIdx = (packetIdx > (uint32_t) NET_MAX_INPUT_DELAY) ? packetIdx - NET_MAX_INPUT_DELAY : 0;
+    return gNetErrorCheckHistory[updateIdx % NET_ERROR_CHECK_HISTORY_LEN];
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: sends the next tick packet in a networked game, containing the specified inputs and elapsed vblank count for this player
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void I_NetSendTickPacket(const TickInputs& inputs, const int32_t elapsedVBlanks) noexcept {
+    // Makeup the output packet including error detection bits and network telemetry
+    NetPacket_Tick outPkt = {};
+    outPkt.errorCheck = I_NetGetErrorCheckForPacket(gNetNumPacketsSent);
+    outPkt.elapsedVBlanks = elapsedVBlanks;
+    outPkt.inputs = inputs;
+    outPkt.lastPacketDelayMs = gLastInputPacketDelayMs;
+    NetStats::stampOutgoingPacket(outPkt);
+
+    // Endian correct the output packet and send it
+    outPkt.endianCorrect();
+    Network::sendTickPacket(outPkt);
+    gNetNumPacketsSent++;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: tells if the given local tick inputs can be discarded without the player noticing, in order to reduce the input delay.
+// This is true if they contain no turning and no one-off actions, since otherwise turning would be lost or button presses missed.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool I_NetCanDropTickInputs(const TickInputs& inputs) noexcept {
+    return (
+        (inputs.getAnalogTurn() == 0) &&
+        (inputs.directSwitchToWeapon == 0) &&
+        (inputs.psxMouseDx == 0) &&
+        (inputs.psxMouseDy == 0) &&
+        (inputs.lookPitch == 0) &&
+        (!inputs.fPrevWeapon()) &&
+        (!inputs.fNextWeapon()) &&
+        (!inputs.fTogglePause()) &&
+        (!inputs.fToggleMap()) &&
+        (!inputs.fRespawn()) &&
+        (inputs._flags4.bits == 0) &&
+        (inputs._flags5.bits == 0)
+    );
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: makes the extra tick inputs to insert after the given local tick inputs, in order to increase the input delay.
+// Movement and other held buttons carry on as before, but turning and one-off actions are not repeated.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static TickInputs I_NetMakeFillerTickInputs(const TickInputs& inputs) noexcept {
+    TickInputs filler = inputs;
+    filler.setAnalogTurn(0);
+    filler.directSwitchToWeapon = 0;
+    filler.psxMouseDx = 0;
+    filler.psxMouseDy = 0;
+    filler.lookPitch = 0;
+    filler.fPrevWeapon() = false;
+    filler.fNextWeapon() = false;
+    filler.fTogglePause() = false;
+    filler.fToggleMap() = false;
+    filler.fRespawn() = false;
+    filler._flags4 = {};
+    filler._flags5 = {};
+    return filler;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -876,27 +1061,28 @@ bool I_NetUpdate() noexcept {
         }
     }
 
-    // If it's the very first network update for this session send a dummy packet with no inputs to the other player.
-    // This kick starts the sequence of always sending one packet ahead on both ends and helps to reduce lag.
+    // Save the error checking value for this update, since it will be sent in a later packet
+    gNetErrorCheckHistory[gNetNumUpdates % NET_ERROR_CHECK_HISTORY_LEN] = errorCheck;
+
+    // If it's the very first network update for this session send dummy packets with no inputs to the other player, one for each tick of
+    // input delay. This kick starts the sequence of always sending packets ahead on both ends and helps to reduce lag.
     if (gbNetIsFirstNetUpdate) {
-        // Populate and send the output packet
-        NetPacket_Tick outPkt = {};
-        outPkt.errorCheck = Endian::hostToLittle(errorCheck);
-        outPkt.inputs.reset();
-        Network::sendTickPacket(outPkt);
-
-        // Make sure these are set correctly for what we expect
-        gNextTickInputs.reset();
-        gNextPlayerElapsedVBlanks = 0;
-        gNetPrevErrorCheck = errorCheck;
+        TickInputs dummyInputs;
+        dummyInputs.reset();
+
+        for (gNumNextTickInputs = 0; gNumNextTickInputs < gNetTargetInputDelay; ++gNumNextTickInputs) {
+            I_NetSendTickPacket(dummyInputs, 0);
+            gNextTickInputs[gNumNextTickInputs] = dummyInputs;
+            gNextPlayerElapsedVBlanks[gNumNextTickInputs] = 0;
+        }
     }
 
     // No longer the first network update
     gbNetIsFirstNetUpdate = false;
 
-    // For networked games the current inputs become the ones we send to the other player as our NEXT move.
-    // The next inputs we said we'd previously use become the CURRENT move. 
-    // Inputs are sent 1 frame ahead of when they are used to help combat network latency, and we also do the same for elapsed vblanks.
+    // For networked games the current inputs become the ones we send to the other player as our LAST queued move.
+    // The first of the queued inputs we said we'd previously use become the CURRENT move.
+    // Inputs are sent 'input delay' frames ahead of when they are used to help combat network latency, and we also do the same for elapsed vblanks.
     // 
     // HOWEVER, in spite of all this (using the previous instead of the current move) we preserve the current effective view angle because
     // you are now allowed to turn at any time outside of the regular 30 Hz update loop for the player.
@@ -905,26 +1091,44 @@ bool I_NetUpdate() noexcept {
         // The only situation where this should not be the case is if the game is paused and some of the uncommitted turning is being held onto for the next tick.
         ASSERT((gPlayerUncommittedTurning == 0) || (gbGamePaused));
         const angle_t playerAngle = (bInGame) ? gPlayers[gCurPlayerIndex].mo->angle : 0;
-        gPlayerNextTickViewAngle = playerAngle + gTickInputs[gCurPlayerIndex].getAnalogTurn() + gNextTickInputs.getAnalogTurn();
+        gPlayerNextTickViewAngle = playerAngle + gTickInputs[gCurPlayerIndex].getAnalogTurn();
+
+        for (int32_t i = 0; i < gNumNextTickInputs; ++i) {
+            gPlayerNextTickViewAngle += gNextTickInputs[i].getAnalogTurn();
+        }
     }
 
-    std::swap(gTickInputs[gCurPlayerIndex], gNextTickInputs);
-    std::swap(gPlayersElapsedVBlanks[gCurPlayerIndex], gNextPlayerElapsedVBlanks);
+    const TickInputs newTickInputs = gTickInputs[gCurPlayerIndex];
+    const int32_t newElapsedVBlanks = gPlayersElapsedVBlanks[gCurPlayerIndex];
 
-    // Makeup the output packet including error detection bits
-    NetPacket_Tick outPkt = {};
-    outPkt.errorCheck = errorCheck;
-    outPkt.elapsedVBlanks = gNextPlayerElapsedVBlanks;
-    outPkt.inputs = gNextTickInputs;
-    outPkt.lastPacketDelayMs = gLastInputPacketDelayMs;
+    ASSERT(gNumNextTickInputs > 0);
+    gTickInputs[gCurPlayerIndex] = gNextTickInputs[0];
+    gPlayersElapsedVBlanks[gCurPlayerIndex] = gNextPlayerElapsedVBlanks[0];
+    gNumNextTickInputs--;
 
-    // Endian correct the output packet and send it
-    outPkt.errorCheck = Endian::hostToLittle(outPkt.errorCheck);
-    outPkt.elapsedVBlanks = Endian::hostToLittle(outPkt.elapsedVBlanks);
-    outPkt.inputs.endianCorrect();
-    outPkt.lastPacketDelayMs = Endian::hostToLittle(outPkt.lastPacketDelayMs);
+    for (int32_t i = 0; i < gNumNextTickInputs; ++i) {
+        gNextTickInputs[i] = gNextTickInputs[i + 1];
+        gNextPlayerElapsedVBlanks[i] = gNextPlayerElapsedVBlanks[i + 1];
+    }
 
-    Network::sendTickPacket(outPkt);
+    // Queue up and send the new inputs, unless decreasing the input delay: in that case the new inputs are just discarded instead.
+    // If increasing the input delay then queue up and send some extra filler inputs afterwards.
+    const auto queueAndSendTickInputs = [](const TickInputs& inputs, const int32_t elapsedVBlanks) noexcept {
+        gNextTickInputs[gNumNextTickInputs] = inputs;
+        gNextPlayerElapsedVBlanks[gNumNextTickInputs] = elapsedVBlanks;
+        gNumNextTickInputs++;
+        I_NetSendTickPacket(inputs, elapsedVBlanks);
+    };
+
+    const bool bDecreaseInputDelay = ((gNetTargetInputDelay <= gNumNextTickInputs) && (gNumNextTickInputs > 0) && I_NetCanDropTickInputs(newTickInputs));
+
+    if (!bDecreaseInputDelay) {
+        queueAndSendTickInputs(newTickInputs, newElapsedVBlanks);
+
+        if (gNetTargetInputDelay > gNumNextTickInputs) {
+            queueAndSendTickInputs(I_NetMakeFillerTickInputs(newTickInputs), newElapsedVBlanks);
+        }
+    }
 
     // Receive the same packet from the opposite end and see how much it was delayed.
     // Ideally it should be sitting in the packet queue ready to go, a full frame before when we need it.
@@ -939,19 +1143,20 @@ bool I_NetUpdate() noexcept {
     const int64_t packetAgeMs = std::chrono::duration_cast<std::chrono::milliseconds>(now - inPktRecvTime).count();
     gLastInputPacketDelayMs = std::max(MAX_PACKET_DELAY_MS - (int32_t) packetAgeMs, 0);
 
-    // Endian correct the input packet before we use it
-    inPkt.errorCheck = Endian::littleToHost(inPkt.errorCheck);
-    inPkt.elapsedVBlanks = Endian::littleToHost(inPkt.elapsedVBlanks);
-    inPkt.inputs.endianCorrect();
-    inPkt.lastPacketDelayMs = Endian::littleToHost(inPkt.lastPacketDelayMs);
+    // Endian correct the input packet before we use it and update network telemetry
+    inPkt.endianCorrect();
+    NetStats::onIncomingPacket(inPkt, inPktRecvTime);
 
     // See if the packet we received from the other player is what we expect; if it isn't then show a 'network error' message.
     // Note: we only check the 'errorCheck' field while in game.
     const bool bNetworkError = (
         (!Network::isConnected()) ||
-        (gbIsLevelDataCached && (gNetPrevErrorCheck != inPkt.errorCheck))
+        (gbIsLevelDataCached && (I_NetGetErrorCheckForPacket(gNetNumUpdates) != inPkt.errorCheck))
     );
 
+    // The packet for this update has been consumed, so move onto the next update (even if there was an error)
+    gNetNumUpdates++;
+
     if (bNetworkError) {
         // Uses the current image as the basis for the next frame; copy the presented framebuffer to the drawing framebuffer:
         LIBGPU_DrawSync(0);
@@ -991,8 +1196,10 @@ bool I_NetUpdate() noexcept {
             gOldTickInputs[i] = {};
         }
 
-        gNextTickInputs = {};
-        gNextPlayerElapsedVBlanks = 0;
+        for (int32_t i = 0; i < gNumNextTickInputs; ++i) {
+            gNextTickInputs[i] = {};
+            gNextPlayerElapsedVBlanks[i] = 0;
+        }
 
         // PsyDoom: wait for 2 seconds so the network error can be displayed.
         // When done clear the screen so the 'loading' message displays clearly and not overlapped with the 'network error' message:
@@ -1019,16 +1226,19 @@ bool I_NetUpdate() noexcept {
         gNetTimeAdjustMs += adjustMs;
     }
 
-    // No network error occured, save the error checking value for verification of the other player's game state next time around.
-    // Also request more tick packets to be ready for next time we want them.
-    gNetPrevErrorCheck = errorCheck;
+    // Adaptive input delay: once any previous change has taken effect, decide whether the input delay needs to change again
+    if ((ProgArgs::gNetInputDelay <= 0) && (gNumNextTickInputs == gNetTargetInputDelay)) {
+        gNetTargetInputDelay = NetStats::getAdaptiveInputDelay(gNumNextTickInputs);
+    }
+
+    // No network error occured: request more tick packets to be ready for next time we want them
     Network::requestTickPackets();
     return false;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Used to do a synchronization handshake between the two players over the serial cable.
-// Now does nothing since the underlying transport protocol (TCP) guarantees reliability and packet ordering.
+// Now does nothing since the underlying transport (TCP, or UDP with acknowledgements and resends) guarantees reliability and packet ordering.
 // PsyDoom: this function has been rewritten, for the original version see the 'Old' folder.
 //------------------------------------------------------------------------------------------------------------------------------------------
 void I_NetHandshake() noexcept {}
@@ -95,18 +95,50 @@ const fontchar_t gBigFontChars[NUM_BIG_FONT_CHARS] = {
     { 192, 243,  13,  13 }  // z - 65
 };
 
+#if PSYDOOM_MODS
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom helper: makes the sprites for drawing a number using the large font at the specified pixel location, without drawing them.
+// The sprites copy the CLUT and shading settings of the given template sprite and are written to the given array, which must have room for
+// at least 'I_MAX_NUMBER_SPRITES'. Returns how many sprites were made. The texture page for the 'STATUS' texture must be set to draw them.
+//------------------------------------------------------------------------------------------------------------------------------------------
+uint32_t I_MakeNumberSprites(const int32_t x, const int32_t y, const int32_t value, const SPRT& templateSprite, SPRT* const pSprites) noexcept {
+    SPRT spritePrim = templateSprite;
+    spritePrim.y0 = (int16_t) y;            // Always on the same row
+    spritePrim.v0 = 195;                    // Digits are all on the same line in VRAM
+    LIBGPU_setWH(spritePrim, 11, 16);       // Digits are always this size
+
+    // Make the sprites for the digits, starting with the least significant and moving backwards across the screen.
+    // Work with unsigned while doing this, so that the most negative number can be handled.
+    const bool bNegativeVal = (value < 0);
+    uint32_t valueAbs = (bNegativeVal) ? 0u - (uint32_t) value : (uint32_t) value;
+    uint32_t numSprites = 0;
+    int32_t curX = x;
+
+    do {
+        spritePrim.x0 = (int16_t) curX;
+        spritePrim.u0 = gBigFontChars[BIG_FONT_DIGITS + valueAbs % 10].u;
+        pSprites[numSprites++] = spritePrim;
+
+        valueAbs /= 10;
+        curX -= 11;
+    } while (valueAbs > 0);
+
+    // Add the minus symbol if the value was negative
+    if (bNegativeVal) {
+        spritePrim.x0 = (int16_t) curX;
+        spritePrim.u0 = gBigFontChars[BIG_FONT_MINUS].u;
+        pSprites[numSprites++] = spritePrim;
+    }
+
+    return numSprites;
+}
+#endif  // #if PSYDOOM_MODS
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Draw a number using the large font at the specified pixel location
 //------------------------------------------------------------------------------------------------------------------------------------------
 void I_DrawNumber(const int32_t x, const int32_t y, const int32_t value) noexcept {
-    // Basic setup of the drawing primitive.
-    // PsyDoom: use local instead of scratchpad draw primitives; compiler can optimize better, and removes reliance on global state
-    #if PSYDOOM_MODS
-        SPRT spritePrim = {};
-    #else
-        SPRT& spritePrim = *(SPRT*) LIBETC_getScratchAddr(128);
-    #endif
-
+    // PsyDoom: the sprites for the number are now made by 'I_MakeNumberSprites' so that other code (the status bar) can also cache them
     #if PSYDOOM_MODS
         // Set these primitive properties prior to drawing rather than allowing them to be undefined as in the original code.
         // Also use local instead of scratchpad draw primitives; compiler can optimize better, and removes reliance on global state
@@ -122,62 +154,73 @@ void I_DrawNumber(const int32_t x, const int32_t y, const int32_t value) noexcep
             I_AddPrim(drawModePrim);
         }
 
-        LIBGPU_SetSprt(spritePrim);
-        LIBGPU_SetShadeTex(spritePrim, true);
-        spritePrim.clut = Game::getTexClut_STATUS();
-    #endif
+        SPRT templateSprite = {};
+        LIBGPU_SetSprt(templateSprite);
+        LIBGPU_SetShadeTex(templateSprite, true);
+        templateSprite.clut = Game::getTexClut_STATUS();
 
-    spritePrim.y0 = (int16_t) y;            // Always on the same row
-    spritePrim.v0 = 195;                    // Digits are all on the same line in VRAM
-    LIBGPU_setWH(spritePrim, 11, 16);       // Digits are always this size
+        SPRT sprites[I_MAX_NUMBER_SPRITES];
+        const uint32_t numSprites = I_MakeNumberSprites(x, y, value, templateSprite, sprites);
 
-    // Work with unsigned while we are printing, until the end
-    bool bNegativeVal;
-    uint32_t valueAbs;
+        for (uint32_t i = 0; i < numSprites; ++i) {
+            I_AddPrim(sprites[i]);
+        }
+    #else
+        // Basic setup of the drawing primitive
+        SPRT& spritePrim = *(SPRT*) LIBETC_getScratchAddr(128);
 
-    if (value >= 0) {
-        bNegativeVal = false;
-        valueAbs = value;
-    } else {
-        bNegativeVal = true;
-        valueAbs = -value;
-    }
+        spritePrim.y0 = (int16_t) y;            // Always on the same row
+        spritePrim.v0 = 195;                    // Digits are all on the same line in VRAM
+        LIBGPU_setWH(spritePrim, 11, 16);       // Digits are always this size
 
-    // Figure out what digits to print
-    constexpr uint32_t MAX_DIGITS = 16;
-    int32_t digits[MAX_DIGITS];
-    uint32_t digitIdx = 0;
+        // Work with unsigned while we are printing, until the end
+        bool bNegativeVal;
+        uint32_t valueAbs;
 
-    while (digitIdx < MAX_DIGITS) {
-        digits[digitIdx] = valueAbs % 10;
-        valueAbs /= 10;
+        if (value >= 0) {
+            bNegativeVal = false;
+            valueAbs = value;
+        } else {
+            bNegativeVal = true;
+            valueAbs = -value;
+        }
 
-        if (valueAbs <= 0)
-            break;
+        // Figure out what digits to print
+        constexpr uint32_t MAX_DIGITS = 16;
+        int32_t digits[MAX_DIGITS];
+        uint32_t digitIdx = 0;
 
-        ++digitIdx;
-    }
+        while (digitIdx < MAX_DIGITS) {
+            digits[digitIdx] = valueAbs % 10;
+            valueAbs /= 10;
 
-    // Print the digits, starting with the least significant and move backwards across the screen
-    const uint32_t numDigits = digitIdx + 1;
-    int32_t curX = x;
+            if (valueAbs <= 0)
+                break;
 
-    for (digitIdx = 0; digitIdx < numDigits; ++digitIdx) {
-        const int32_t digit = digits[digitIdx];
+            ++digitIdx;
+        }
 
-        spritePrim.x0 = (int16_t) curX;
-        spritePrim.u0 = gBigFontChars[BIG_FONT_DIGITS + digit].u;
-        I_AddPrim(spritePrim);
+        // Print the digits, starting with the least significant and move backwards across the screen
+        const uint32_t numDigits = digitIdx + 1;
+        int32_t curX = x;
 
-        curX -= 11;
-    }
+        for (digitIdx = 0; digitIdx < numDigits; ++digitIdx) {
+            const int32_t digit = digits[digitIdx];
 
-    // Print the minus symbol if the value was negative
-    if (bNegativeVal) {
-        spritePrim.x0 = (int16_t) curX;
-        spritePrim.u0 = gBigFontChars[BIG_FONT_MINUS].u;
-        I_AddPrim(spritePrim);
-    }
+            spritePrim.x0 = (int16_t) curX;
+            spritePrim.u0 = gBigFontChars[BIG_FONT_DIGITS + digit].u;
+            I_AddPrim(spritePrim);
+
+            curX -= 11;
+        }
+
+        // Print the minus symbol if the value was negative
+        if (bNegativeVal) {
+            spritePrim.x0 = (int16_t) curX;
+            spritePrim.u0 = gBigFontChars[BIG_FONT_MINUS].u;
+            I_AddPrim(spritePrim);
+        }
+    #endif
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -506,7 +549,12 @@ void I_DrawString(const int32_t x, const int32_t y, const char* const str) noexc
     // Decide on starting x position: can either be so the string is centered in the screen, or just the value verbatim
     int32_t curX = (x != -1) ? x : I_GetStringXPosToCenter(str);
 
-    // Draw all the characters in the string
+    // Draw all the characters in the string.
+    // PsyDoom: submit the characters in groups rather than one at a time, since they all share the same CLUT and draw settings.
+    #if PSYDOOM_MODS
+        I_SpriteBatcher spriteBatcher;
+    #endif
+
     const char* pCurChar = str;
 
     for (char c = *pCurChar; c != 0; ++pCurChar, c = *pCurChar) {
@@ -548,7 +596,11 @@ void I_DrawString(const int32_t x, const int32_t y, const char* const str) noexc
         LIBGPU_setUV0(spritePrim, fontchar.u, fontchar.v);
         LIBGPU_setWH(spritePrim, fontchar.w, fontchar.h);
 
-        I_AddPrim(spritePrim);
+        #if PSYDOOM_MODS
+            spriteBatcher.add(spritePrim);
+        #else
+            I_AddPrim(spritePrim);
+        #endif
 
         // Move past the drawn character
         curX += fontchar.w;
@@ -2,6 +2,8 @@
 
 #include <cstdint>
 
+struct SPRT;
+
 // Definition for a big font character: where it is on the 'STATUS' texture atlas and it's size
 struct fontchar_t {
     std::uint8_t u;
@@ -33,6 +35,13 @@ static constexpr int32_t SMALL_FONT_V_MIN = 168;
 static constexpr int32_t BIG_FONT_LINE_HEIGHT = 16;
 static constexpr int32_t BIG_FONT_WHITESPACE_CHAR_WIDTH = 6;
 
+#if PSYDOOM_MODS
+    // The maximum number of sprites needed to draw a number: 10 digits plus a minus sign
+    static constexpr uint32_t I_MAX_NUMBER_SPRITES = 11;
+
+    uint32_t I_MakeNumberSprites(const int32_t x, const int32_t y, const int32_t value, const SPRT& templateSprite, SPRT* const pSprites) noexcept;
+#endif
+
 void I_DrawNumber(const int32_t x, const int32_t y, const int32_t value) noexcept;
 
 #if PSYDOOM_MODS
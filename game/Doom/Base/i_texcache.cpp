@@ -54,7 +54,10 @@
 #include "Gpu.h"
 #include "i_drawcmds.h"
 #include "i_main.h"
+#include "i_misc.h"
 #include "PsyDoom/Config/Config.h"
+#include "PsyDoom/Game.h"
+#include "PsyDoom/JobSystem.h"
 #include "PsyDoom/PsxVm.h"
 #include "PsyDoom/TexturePatcher.h"
 #include "PsyDoom/Video.h"
@@ -116,6 +119,28 @@ static uint32_t gTCacheFillCellY;
 // If loose packing is used, when we reach the end of the current texture cache row we skip past this height and don't try to fill in any gaps.
 static uint32_t gTCacheLoosePackRowH;
 
+// Statistics about texture cache usage, displayed by the VRAM viewer to help with tuning VRAM size:
+static uint32_t gTCacheNumHits;             // Number of texture cache requests for a texture that was already in the cache
+static uint32_t gTCacheNumMisses;           // Number of texture cache requests for a texture that had to be uploaded
+static uint32_t gTCacheNumEvictions;        // Number of textures evicted from the cache to make room for another texture
+static uint64_t gTCacheUploadBytes;         // Total number of bytes of texture data uploaded to VRAM
+
+#if PSYDOOM_LIMIT_REMOVING
+    // Holds the data for one texture being cached by 'I_CacheTexBatch'.
+    // If the texture is compressed then this holds a copy of the compressed data, and the decompressed data once decompressed.
+    struct batchtex_t {
+        std::vector<std::byte>  compressedData;
+        std::vector<std::byte>  decodedData;
+    };
+
+    static std::vector<batchtex_t> gBatchTextures;
+#endif
+
+// Composited PC format textures (a texture lump header followed by the pixels), indexed by PC texture index.
+// PC textures are only composited from their patches the first time they are needed, and the result is kept in the zone as a 'PU_CACHE'
+// block so that re-caching a texture after it's evicted from VRAM doesn't require compositing it again. The zone nulls entries it purges.
+static std::vector<void*> gpPCTexComposites;
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Checks to see if the texture can be placed on the given page at the current fill location.
 // Returns 'false' if this action is not possible due to other textures that are currently occupying the cells.
@@ -168,6 +193,7 @@ static bool TC_PrepFillLocationCells(tcachepage_t& texPage, const texture_t& tex
 
             // The cell is not empty but we can evict the texture, do that now:
             I_RemoveTexCacheEntry(*pOccupyTex);
+            ++gTCacheNumEvictions;
         }
     }
 
@@ -214,6 +240,187 @@ static bool TC_MoveToPageFillLocation(const texture_t& tex, const bool bLoosePac
     return false;
 }
 
+#if PSYDOOM_LIMIT_REMOVING
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Best fit packing: tries to find the top-most, then left-most area of completely free cells in the given page that can hold the texture.
+// If found then the texture cache fill location is moved there and 'true' is returned; no textures are evicted by this search.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool TC_MoveToPageFreeFitLocation(const uint32_t pageIdx, const texture_t& tex) noexcept {
+    const tcachepage_t& texPage = gTCachePages[pageIdx];
+    const uint32_t texW16 = tex.width16;
+    const uint32_t texH16 = tex.height16;
+
+    ASSERT(texW16 <= TCACHE_CELLS_X);
+    ASSERT(texH16 <= TCACHE_CELLS_Y);
+
+    // For every cell compute how many consecutive free cells there are starting at the cell and going right
+    uint8_t freeRunW[TCACHE_CELLS_Y][TCACHE_CELLS_X + 1];
+    static_assert(TCACHE_CELLS_X <= UINT8_MAX);
+
+    for (uint32_t y = 0; y < TCACHE_CELLS_Y; ++y) {
+        freeRunW[y][TCACHE_CELLS_X] = 0;
+
+        for (uint32_t x = TCACHE_CELLS_X; x > 0; --x) {
+            freeRunW[y][x - 1] = (texPage.cells[y][x - 1]) ? 0 : (uint8_t)(freeRunW[y][x] + 1);
+        }
+    }
+
+    // Search for the first location where all the rows covered by the texture have a long enough run of free cells
+    for (uint32_t y = 0; y + texH16 <= TCACHE_CELLS_Y; ++y) {
+        for (uint32_t x = 0; x + texW16 <= TCACHE_CELLS_X;) {
+            // Find the shortest free run among all the rows the texture would cover.
+            // If it's not long enough then we can skip past the blocking cell on that row, as no location before it can work.
+            uint32_t minRunW = TCACHE_CELLS_X;
+
+            for (uint32_t rowY = y; rowY < y + texH16; ++rowY) {
+                minRunW = std::min<uint32_t>(minRunW, freeRunW[rowY][x]);
+
+                if (minRunW < texW16)
+                    break;
+            }
+
+            if (minRunW >= texW16) {
+                gTCacheFillPage = pageIdx;
+                gTCacheFillCellX = x;
+                gTCacheFillCellY = y;
+                gTCacheLoosePackRowH = texH16;
+                return true;
+            }
+
+            x += minRunW + 1;
+        }
+    }
+
+    return false;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Best fit packing: tries to find an area of free cells in any texture page that can hold the texture, starting with the current page.
+// If found then the texture cache fill location is moved there and 'true' is returned; no textures are evicted by this search.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool TC_MoveToFreeFitLocation(const texture_t& tex) noexcept {
+    const uint32_t numTCachePages = (uint32_t) gTCachePages.size();
+
+    for (uint32_t pageOffset = 0; pageOffset < numTCachePages; ++pageOffset) {
+        if (TC_MoveToPageFreeFitLocation((gTCacheFillPage + pageOffset) % numTCachePages, tex))
+            return true;
+    }
+
+    return false;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Best fit packing: finds the location in the given page where the texture could be placed by evicting only the least recently used
+// textures. Returns the most recent frame that any texture which would be evicted was used in, plus 1 ('0' if no textures are evicted).
+// If no location is possible because of locked textures, or textures used in the current frame, then 'UINT32_MAX' is returned.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static uint32_t TC_FindPageLruFitLocation(const uint32_t pageIdx, const texture_t& tex, uint32_t& cellXOut, uint32_t& cellYOut) noexcept {
+    const tcachepage_t& texPage = gTCachePages[pageIdx];
+    const uint32_t texW16 = tex.width16;
+    const uint32_t texH16 = tex.height16;
+
+    // Compute the cost of evicting each cell: '0' if free, or the frame the occupying texture was last used plus 1 if it can be evicted.
+    // Also compute the maximum cost over the width of the texture, for each cell going right.
+    uint32_t rowMaxCost[TCACHE_CELLS_Y][TCACHE_CELLS_X];
+
+    for (uint32_t y = 0; y < TCACHE_CELLS_Y; ++y) {
+        uint32_t cellCost[TCACHE_CELLS_X];
+
+        for (uint32_t x = 0; x < TCACHE_CELLS_X; ++x) {
+            const texture_t* const pTex = texPage.cells[y][x];
+
+            if (!pTex) {
+                cellCost[x] = 0;
+            } else if (pTex->bIsLocked || (pTex->uploadFrameNum == gNumFramesDrawn)) {
+                cellCost[x] = UINT32_MAX;
+            } else {
+                cellCost[x] = std::min<uint32_t>(pTex->uploadFrameNum, UINT32_MAX - 2) + 1;
+            }
+        }
+
+        for (uint32_t x = 0; x + texW16 <= TCACHE_CELLS_X; ++x) {
+            uint32_t maxCost = 0;
+
+            for (uint32_t i = 0; i < texW16; ++i) {
+                maxCost = std::max(maxCost, cellCost[x + i]);
+            }
+
+            rowMaxCost[y][x] = maxCost;
+        }
+    }
+
+    // Find the location with the lowest maximum cost over the entire area of the texture
+    uint32_t bestCost = UINT32_MAX;
+
+    for (uint32_t y = 0; y + texH16 <= TCACHE_CELLS_Y; ++y) {
+        for (uint32_t x = 0; x + texW16 <= TCACHE_CELLS_X; ++x) {
+            uint32_t maxCost = 0;
+
+            for (uint32_t i = 0; (i < texH16) && (maxCost < bestCost); ++i) {
+                maxCost = std::max(maxCost, rowMaxCost[y + i][x]);
+            }
+
+            if (maxCost < bestCost) {
+                bestCost = maxCost;
+                cellXOut = x;
+                cellYOut = y;
+            }
+        }
+    }
+
+    return bestCost;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Best fit packing: moves the fill location to wherever the texture can be placed by evicting only the least recently used textures,
+// searching all texture pages. Evicts the textures in the way and returns 'true' if successful.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool TC_MoveToLruFitLocation(const texture_t& tex) noexcept {
+    const uint32_t numTCachePages = (uint32_t) gTCachePages.size();
+    uint32_t bestCost = UINT32_MAX;
+    uint32_t bestPageIdx = 0;
+    uint32_t bestCellX = 0;
+    uint32_t bestCellY = 0;
+
+    for (uint32_t pageOffset = 0; pageOffset < numTCachePages; ++pageOffset) {
+        const uint32_t pageIdx = (gTCacheFillPage + pageOffset) % numTCachePages;
+        uint32_t cellX = 0;
+        uint32_t cellY = 0;
+        const uint32_t cost = TC_FindPageLruFitLocation(pageIdx, tex, cellX, cellY);
+
+        if (cost < bestCost) {
+            bestCost = cost;
+            bestPageIdx = pageIdx;
+            bestCellX = cellX;
+            bestCellY = cellY;
+        }
+    }
+
+    if (bestCost == UINT32_MAX)
+        return false;
+
+    // Evict all the textures in the way and move the fill location to where the texture will go
+    tcachepage_t& texPage = gTCachePages[bestPageIdx];
+
+    for (uint32_t y = bestCellY; y < bestCellY + tex.height16; ++y) {
+        for (uint32_t x = bestCellX; x < bestCellX + tex.width16; ++x) {
+            texture_t* const pOccupyTex = texPage.cells[y][x];
+
+            if (pOccupyTex) {
+                I_RemoveTexCacheEntry(*pOccupyTex);
+                ++gTCacheNumEvictions;
+            }
+        }
+    }
+
+    gTCacheFillPage = bestPageIdx;
+    gTCacheFillCellX = bestCellX;
+    gTCacheFillCellY = bestCellY;
+    gTCacheLoosePackRowH = tex.height16;
+    return true;
+}
+#endif  // #if PSYDOOM_LIMIT_REMOVING
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Moves to a fill location in the texture cache where the specified texture can be placed.
 // Returns 'false' on failure to find such a location and issues a warning.
@@ -230,6 +437,16 @@ static bool TC_MoveToFillLocation(const texture_t& tex) noexcept {
     // cache are not overwritten but if we find ourselves looking for room we switch to tighter (more exhaustive) packing for later pages.
     const uint32_t numTCachePages = (uint32_t) gTCachePages.size();
 
+    // Limit removing: if best fit packing is enabled then try to place the texture in an area of free cells first.
+    // If that fails then evict the least recently used textures to make room, at cell granularity.
+    // Only if both fail does the usual fill logic proceed, though it is unlikely to find a location either.
+    #if PSYDOOM_LIMIT_REMOVING
+        if (Config::gbTexCacheBestFitPacking) {
+            if (TC_MoveToFreeFitLocation(tex) || TC_MoveToLruFitLocation(tex))
+                return true;
+        }
+    #endif
+
     #if PSYDOOM_LIMIT_REMOVING
         bool bUseLoosePacking = gbAllowLoosePacking;
     #else
@@ -340,30 +557,45 @@ static void TC_FillCacheCells(tcachepage_t& texPage, texture_t& tex) noexcept {
 static texdata_t TC_CacheTexData(const texture_t& tex) {
     // NEW: Handle PC Virtual Textures (Phase 1C)
     if (tex.lumpNum & 0x8000) {
+        WadCompat::WadCompatibilityLayer& compatLayer = WadCompat::getCompatLayer();
         const int32_t pcIdx = tex.lumpNum & 0x7FFF;
-        
-        const int32_t w = WadCompat::getCompatLayer().getTextureWidth(pcIdx);
-        const int32_t h = WadCompat::getCompatLayer().getTextureHeight(pcIdx);
+
+        const int32_t w = compatLayer.getTextureWidth(pcIdx);
+        const int32_t h = compatLayer.getTextureHeight(pcIdx);
         const int32_t texSize = sizeof(texlump_header_t) + (w * h);
 
-        #if PSYDOOM_LIMIT_REMOVING
-            gTmpBuffer.ensureSize(texSize);
-            std::byte* pBuf = gTmpBuffer.bytes();
-        #else
-            if (texSize > TMP_BUFFER_SIZE) {
-                I_Error("TC_CacheTexData: PC Texture too big (%d)", texSize);
+        // Discard all composited textures if the set of PC textures has changed
+        const size_t numPCTextures = (size_t) std::max(compatLayer.getTextureCount(), compatLayer.getNumPCTextures());
+
+        if (gpPCTexComposites.size() != numPCTextures) {
+            for (void* const pComposite : gpPCTexComposites) {
+                if (pComposite) {
+                    Z_Free2(*gpMainMemZone, pComposite);
+                }
             }
-            std::byte* pBuf = gTmpBuffer;
-        #endif
-        
-        texlump_header_t* pHeader = reinterpret_cast<texlump_header_t*>(pBuf);
-        pHeader->offsetX = 0;
-        pHeader->offsetY = 0;
-        pHeader->width = (int16_t)w;
-        pHeader->height = (int16_t)h;
-        
-        WadCompat::getCompatLayer().generateTexturePixels(pcIdx, (uint8_t*)(pBuf + sizeof(texlump_header_t)));
-        return { pBuf, static_cast<size_t>(texSize) };
+
+            gpPCTexComposites.clear();
+            gpPCTexComposites.resize(numPCTextures, nullptr);
+        }
+
+        // Composite the texture if it isn't already cached
+        ASSERT((size_t) pcIdx < gpPCTexComposites.size());
+        void*& pComposite = gpPCTexComposites[pcIdx];
+
+        if (!pComposite) {
+            Z_Malloc(*gpMainMemZone, texSize, PU_CACHE, &pComposite);
+            std::byte* const pBuf = (std::byte*) pComposite;
+
+            texlump_header_t* pHeader = reinterpret_cast<texlump_header_t*>(pBuf);
+            pHeader->offsetX = 0;
+            pHeader->offsetY = 0;
+            pHeader->width = (int16_t)w;
+            pHeader->height = (int16_t)h;
+
+            compatLayer.generateTexturePixels(pcIdx, (uint8_t*)(pBuf + sizeof(texlump_header_t)));
+        }
+
+        return { (std::byte*) pComposite, static_cast<size_t>(texSize) };
     }
 
     // Make sure the texture's lump is loaded and get the bytes
@@ -417,6 +649,8 @@ static void TC_UploadTexToVram(texture_t& tex, const texdata_t& texData, const t
     const uint16_t tpageV = texPage.vramY;
 
     if (texData.size >= expectedTexSize) {
+        gTCacheUploadBytes += expectedTexSize - sizeof(texlump_header_t);
+
         // Upload the texture to VRAM at the current fill location.
         // PsyDoom limit removing: allow for sprites with an non-even width to be uploaded using a new variant of 'LoadImage'.
         // The new variant automatically pads the sprite to be an even width by inserting a transparent pixel at the end of each row.
@@ -521,6 +755,16 @@ void I_InitTexCache() noexcept {
     #endif
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Get the running totals for texture cache usage since startup
+//------------------------------------------------------------------------------------------------------------------------------------------
+void I_GetTexCacheStats(texcachestats_t& statsOut) noexcept {
+    statsOut.numHits = gTCacheNumHits;
+    statsOut.numMisses = gTCacheNumMisses;
+    statsOut.numEvictions = gTCacheNumEvictions;
+    statsOut.numUploadBytes = gTCacheUploadBytes;
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Return how many texture cache pages there are
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -636,19 +880,11 @@ void I_RemoveTexCacheEntry(texture_t& tex) noexcept {
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Upload the specified texture into VRAM if it's not already resident.
-// If there's no more room for textures in VRAM for this frame then the game will die with an error.
+// Adds the given texture to the cache using the given (loaded and decompressed) texture data, and uploads it into VRAM.
+// The texture is expected to not be already in the cache.
 //------------------------------------------------------------------------------------------------------------------------------------------
-void I_CacheTex(texture_t& tex) noexcept {
-    // Update which frame the texture was added to the cache in, for tracking texture cache overflows
-    tex.uploadFrameNum = gNumFramesDrawn;
-
-    // If the texture is already in the cache then there is nothing else to do
-    if (tex.bIsCached)
-        return;
-
-    // Load the texture data and update the dimensions of the texture from the data header
-    const texdata_t texData = TC_CacheTexData(tex);
+static void TC_CacheTexWithData(texture_t& tex, const texdata_t& texData) noexcept {
+    // Update the dimensions of the texture from the data header
     R_UpdateTexMetricsFromData(tex, texData.pBytes, (int32_t) texData.size);
 
     // PsyDoom: patch this texture with bug fixes, if applicable
@@ -672,6 +908,101 @@ void I_CacheTex(texture_t& tex) noexcept {
     gTCacheFillCellX += tex.width16;
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Upload the specified texture into VRAM if it's not already resident.
+// If there's no more room for textures in VRAM for this frame then the game will die with an error.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void I_CacheTex(texture_t& tex) noexcept {
+    // Update which frame the texture was added to the cache in, for tracking texture cache overflows
+    tex.uploadFrameNum = gNumFramesDrawn;
+
+    // If the texture is already in the cache then there is nothing else to do
+    if (tex.bIsCached) {
+        ++gTCacheNumHits;
+        return;
+    }
+
+    // Load the texture data and add the texture to the cache
+    ++gTCacheNumMisses;
+    const texdata_t texData = TC_CacheTexData(tex);
+    TC_CacheTexWithData(tex, texData);
+}
+
+#if PSYDOOM_LIMIT_REMOVING
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Job function for 'I_CacheTexBatch': decompresses the compressed data for one texture in the batch
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void TC_DecodeBatchTex(const uint32_t jobIdx, [[maybe_unused]] void* const pUserData) noexcept {
+    batchtex_t& batchTex = gBatchTextures[jobIdx];
+
+    if (batchTex.compressedData.empty())
+        return;
+
+    batchTex.decodedData.resize(getDecodedSize(batchTex.compressedData.data()));
+    decode(batchTex.compressedData.data(), batchTex.decodedData.data());
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Uploads the specified list of textures into VRAM, in order, if they are not already resident.
+// The result is exactly the same as calling 'I_CacheTex' on each texture in turn, except that:
+//  (1) Compressed textures are all decompressed upfront and in parallel using the job system.
+//  (2) The VRAM updates for all the textures are pushed to the Vulkan renderer in one go at the end, coalescing adjacent updates.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void I_CacheTexBatch(texture_t* const* const ppTextures, const uint32_t numTextures) noexcept {
+    // Gather a copy of the compressed data for all the textures to be decompressed.
+    // Note: copying the data because loading one texture lump might evict another one previously loaded, if zone memory is tight.
+    gBatchTextures.resize(numTextures);
+
+    for (uint32_t texIdx = 0; texIdx < numTextures; ++texIdx) {
+        texture_t& tex = *ppTextures[texIdx];
+        batchtex_t& batchTex = gBatchTextures[texIdx];
+        batchTex.compressedData.clear();
+        batchTex.decodedData.clear();
+
+        // Note: PC format virtual textures have no lump to decompress, their data is generated on demand instead
+        if (tex.bIsCached || (tex.lumpNum & 0x8000))
+            continue;
+
+        const WadLump& texLump = W_CacheLumpNum(tex.lumpNum, PU_CACHE, false);
+
+        if (!texLump.bIsUncompressed) {
+            const std::byte* const pCompressedBytes = (const std::byte*) texLump.pCachedData;
+            batchTex.compressedData.assign(pCompressedBytes, pCompressedBytes + W_RawLumpLength(tex.lumpNum));
+        }
+    }
+
+    // Decompress everything in parallel
+    JobSystem::runJobs(numTextures, TC_DecodeBatchTex, nullptr);
+
+    // Add all of the textures to the cache in order, batching up all of the VRAM uploads
+    LIBGPU_BeginLoadImageBatch();
+
+    for (uint32_t texIdx = 0; texIdx < numTextures; ++texIdx) {
+        texture_t& tex = *ppTextures[texIdx];
+        tex.uploadFrameNum = gNumFramesDrawn;
+
+        if (tex.bIsCached) {
+            ++gTCacheNumHits;
+            continue;
+        }
+
+        ++gTCacheNumMisses;
+        batchtex_t& batchTex = gBatchTextures[texIdx];
+
+        if (!batchTex.decodedData.empty()) {
+            TC_CacheTexWithData(tex, { batchTex.decodedData.data(), batchTex.decodedData.size() });
+        } else {
+            TC_CacheTexWithData(tex, TC_CacheTexData(tex));
+        }
+    }
+
+    LIBGPU_EndLoadImageBatch();
+
+    // Free up the memory used by the batch
+    gBatchTextures.clear();
+}
+#endif  // #if PSYDOOM_LIMIT_REMOVING
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Evicts all textures in the texture cache which are not locked.
 // Also resets the next position that we will populate the cache at.
@@ -790,6 +1121,24 @@ void I_VramViewerDraw(const uint32_t texPageIdx) noexcept {
         LIBGPU_setXY2(linePrim, texLx, texBy, texLx, texTy);
         I_AddPrim(linePrim);
     }
+
+    // Draw the texture cache statistics at the bottom of the screen
+    {
+        char statsStr[128];
+        std::snprintf(
+            statsStr,
+            C_ARRAY_SIZE(statsStr),
+            "PAGE %u/%u HIT %u MISS %u EVICT %u UP %uK",
+            texPageIdx + 1,
+            (uint32_t) gTCachePages.size(),
+            gTCacheNumHits,
+            gTCacheNumMisses,
+            gTCacheNumEvictions,
+            (uint32_t)(gTCacheUploadBytes / 1024)
+        );
+
+        I_DrawStringSmall(2, by - 10, statsStr, Game::getTexClut_STATUS(), 128, 128, 128, false, true);
+    }
 }
 
 #endif  // #if PSYDOOM_MODS
@@ -29,7 +29,16 @@ static constexpr uint32_t NUM_TCACHE_PAGE_CELLS = TCACHE_CELLS_X * TCACHE_CELLS_
         size_t      size;
     };
 
+    // Running totals for texture cache usage since startup
+    struct texcachestats_t {
+        uint32_t    numHits;            // Number of requests for a texture that was already in the cache
+        uint32_t    numMisses;          // Number of requests for a texture that had to be uploaded
+        uint32_t    numEvictions;       // Number of textures evicted from the cache to make room for another texture
+        uint64_t    numUploadBytes;     // Total number of bytes of texture data uploaded to VRAM
+    };
+
     void I_InitTexCache() noexcept;
+    void I_GetTexCacheStats(texcachestats_t& statsOut) noexcept;
     uint32_t I_GetNumTexCachePages() noexcept;
     uint32_t I_GetCurTexCacheFillPage() noexcept;
     void I_SetTexCacheFillPage(const uint32_t pageIdx) noexcept;
@@ -40,6 +49,7 @@ static constexpr uint32_t NUM_TCACHE_PAGE_CELLS = TCACHE_CELLS_X * TCACHE_CELLS_
     #if PSYDOOM_LIMIT_REMOVING
         void I_TexCacheUseLoosePacking(const bool bUseLoosePacking) noexcept;
         void I_LockAllWallAndFloorTextures(const bool bLock) noexcept;
+        void I_CacheTexBatch(texture_t* const* const ppTextures, const uint32_t numTextures) noexcept;
     #else
         void I_LockTexCachePage(const uint32_t pageIdx) noexcept;
         void I_UnlockAllTexCachePages() noexcept;
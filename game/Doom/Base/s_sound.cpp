@@ -10,6 +10,7 @@
 #include "i_main.h"
 #include "m_fixed.h"
 #include "PsyDoom/Config/Config.h"
+#include "PsyDoom/DemoPlayer.h"
 #include "PsyDoom/DiscInfo.h"
 #include "PsyDoom/Game.h"
 #include "PsyDoom/IsoFileSys.h"
@@ -488,8 +489,8 @@ static void I_StartSound(const queued_sound_t& sound) noexcept {
 // Queuing allows us to de-duplicate the same sound playing on the same frame multiple times.
 //------------------------------------------------------------------------------------------------------------------------------------------
 static void I_QueueSound(mobj_t* const pOrigin, const sfxenum_t soundId) noexcept {
-    // Ignore this command in headless mode
-    if (ProgArgs::gbHeadlessMode)
+    // Ignore this command in headless mode or while seeking through a demo
+    if (ProgArgs::gbHeadlessMode || DemoPlayer::isFastForwarding())
         return;
 
     // Ignore the request if the sound sequence number is invalid
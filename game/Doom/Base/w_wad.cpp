@@ -8,12 +8,18 @@
 
 #include "Doom/cdmaptbl.h"
 #include "i_main.h"
+#include "PsyDoom/Config/Config.h"
 #include "PsyDoom/Game.h"
+#include "PsyDoom/JobSystem.h"
 #include "PsyDoom/ModMgr.h"
 #include "PsyDoom/wad_compat.h"
 #include "PsyDoom/WadList.h"
+#include "PsyDoom/WadUtils.h"
 #include "z_zone.h"
 
+#include <cstring>
+#include <vector>
+
 // A flag set to true once data for the current map has been loaded.
 // Has very little purpose anymore in PsyDoom; was originally used to ensure the game was not loading resources on-the-fly off the CD-ROM.
 // In PsyDoom however on-the-fly resource loading is allowed, so this flag's purpose is diminished.
@@ -27,6 +33,25 @@ static WadList gMainWadList;
 // This is only used to load level data, and nothing else.
 static WadFile gMapWad;
 
+// Holds the data for one lump of the currently open map WAD, read up front when the map WAD is opened
+struct PrefetchedMapLump {
+    std::vector<std::byte>  data;               // The lump data: decompressed if 'bIsDecompressed' is set, otherwise the raw lump data
+    bool                    bIsCompressed;      // True if the lump is stored compressed in the WAD file
+    bool                    bIsDecompressed;    // True if the data held is decompressed (always true if the lump is not compressed)
+    bool                    bIsConverted;       // True if 'convertedData' holds the lump converted by the WAD compatibility layer
+    std::vector<std::byte>  convertedData;      // The lump converted to the PSX format, only used for maps which need conversion (PC maps)
+};
+
+// All lumps in the currently open map WAD, prefetched into memory.
+// All of the file IO for a map is done in one go, and compressed lumps are then decompressed in parallel using the job system.
+// This means that level setup just copies in the ready made lump data rather than reading and decompressing each lump serially.
+static std::vector<PrefetchedMapLump> gPrefetchedMapLumps;
+
+// Which map WAD the prefetched lumps are for.
+// The prefetched lumps are retained after the map WAD is closed, so that restarting the same level can skip all of the file IO and
+// decompression. They are only discarded once a different map WAD is opened, or when the WAD system is shut down.
+static CdFileId gPrefetchedMapFileId;
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Initializes the WAD file management system.
 // Opens up the main WAD files and verifies they are valid.
@@ -48,6 +73,11 @@ void W_Init() noexcept {
     }
 
     gMainWadList.finalize();
+
+    // Serve decompressed lumps from the persistent on-disk cache, if one is configured
+    if (!Config::gLumpCacheDir.empty()) {
+        gMainWadList.openLumpCaches(Config::gLumpCacheDir.c_str());
+    }
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -55,6 +85,9 @@ void W_Init() noexcept {
 //------------------------------------------------------------------------------------------------------------------------------------------
 void W_Shutdown() noexcept {
     gMapWad.close();
+    gPrefetchedMapLumps.clear();
+    gPrefetchedMapLumps.shrink_to_fit();
+    gPrefetchedMapFileId = {};
     gMainWadList.clear();
     gbIsLevelDataCached = false;
 }
@@ -145,20 +178,127 @@ const WadLump& W_CacheLumpName(const WadLumpName lumpName, const int16_t allocTa
     return W_CacheLumpNum(W_GetNumForName(lumpName), allocTag, bDecompress);
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Job function: decompresses one prefetched map lump, if the lump is compressed
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void W_DecompressPrefetchedMapLump(const uint32_t jobIdx, [[maybe_unused]] void* const pUserData) noexcept {
+    PrefetchedMapLump& prefetchedLump = gPrefetchedMapLumps[jobIdx];
+
+    if (prefetchedLump.bIsDecompressed)
+        return;
+
+    const WadLump& lump = gMapWad.getLump((int32_t) jobIdx);
+    std::vector<std::byte> decompressedData((size_t) lump.uncompressedSize);
+    WadUtils::decompressLump(prefetchedLump.data.data(), decompressedData.data());
+    prefetchedLump.data = std::move(decompressedData);
+    prefetchedLump.bIsDecompressed = true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Reads all lumps in the currently open map WAD into memory in one go, then decompresses the compressed lumps in parallel.
+// The file IO is done on the calling thread since the file reader is not thread safe; the decompression does not touch the zone heap
+// or any other shared state, so can safely be done on worker threads.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void W_PrefetchMapLumps() noexcept {
+    const int32_t numLumps = gMapWad.getNumLumps();
+    gPrefetchedMapLumps.clear();
+    gPrefetchedMapLumps.resize((size_t) numLumps);
+
+    for (int32_t lumpIdx = 0; lumpIdx < numLumps; ++lumpIdx) {
+        PrefetchedMapLump& prefetchedLump = gPrefetchedMapLumps[lumpIdx];
+        prefetchedLump.bIsCompressed = ((uint8_t) gMapWad.getLumpName(lumpIdx).chars[0] & 0x80u);
+        prefetchedLump.bIsDecompressed = (!prefetchedLump.bIsCompressed);
+        prefetchedLump.data.resize((size_t) gMapWad.getRawSize(lumpIdx));
+        gMapWad.readLump(lumpIdx, prefetchedLump.data.data(), false);
+        ASSERT((!prefetchedLump.bIsCompressed) || (WadUtils::getDecompressedLumpSize(prefetchedLump.data.data()) == gMapWad.getLump(lumpIdx).uncompressedSize));
+    }
+
+    JobSystem::runJobs((uint32_t) numLumps, W_DecompressPrefetchedMapLump, nullptr);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Job function: converts one prefetched map lump to the PSX format using the WAD compatibility layer.
+// The lumps must all be decompressed before this is done.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void W_ConvertPrefetchedMapLump(const uint32_t jobIdx, [[maybe_unused]] void* const pUserData) noexcept {
+    PrefetchedMapLump& prefetchedLump = gPrefetchedMapLumps[jobIdx];
+
+    if (prefetchedLump.bIsConverted)
+        return;
+
+    ASSERT(prefetchedLump.bIsDecompressed);
+    WadCompat::WadCompatibilityLayer& compatLayer = WadCompat::getCompatLayer();
+    const WadLumpName name = gMapWad.getLumpName((int32_t) jobIdx);
+    const int32_t srcSize = (int32_t) prefetchedLump.data.size();
+    const int32_t destSize = compatLayer.getConvertedSize(name.chars, srcSize);
+
+    prefetchedLump.convertedData.resize((size_t) destSize);
+    compatLayer.convertMapLump(name.chars, prefetchedLump.data.data(), srcSize, prefetchedLump.convertedData.data(), destSize);
+    prefetchedLump.bIsConverted = true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// If the currently open map WAD needs format conversion then converts all of the prefetched map lumps up front, in parallel.
+// Each lump's conversion only depends on its own data and the texture registry, so the lumps can be converted independently.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void W_ConvertPrefetchedMapLumps() noexcept {
+    if (WadCompat::getCompatLayer().needsConversion()) {
+        JobSystem::runJobs((uint32_t) gPrefetchedMapLumps.size(), W_ConvertPrefetchedMapLump, nullptr);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Reads the specified map lump (prior to any format conversion) into the given buffer.
+// Uses the prefetched copy of the lump if available, otherwise reads the lump from the map WAD.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void W_ReadMapLumpData(const int32_t lumpIdx, void* const pDest, const bool bDecompress) noexcept {
+    if ((lumpIdx >= 0) && ((size_t) lumpIdx < gPrefetchedMapLumps.size())) {
+        const PrefetchedMapLump& prefetchedLump = gPrefetchedMapLumps[lumpIdx];
+
+        // Note: if raw compressed data is wanted then it's no longer held, since it was decompressed.
+        // In that (unused) case just read the lump from the WAD file again.
+        if ((!prefetchedLump.bIsCompressed) || bDecompress) {
+            std::memcpy(pDest, prefetchedLump.data.data(), prefetchedLump.data.size());
+            return;
+        }
+    }
+
+    gMapWad.readLump(lumpIdx, pDest, bDecompress);
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Open the specified map wad file for reading.
 // Note: if a map WAD is already opened then it will be closed by this operation.
+//
+// If 'bReuseRetainedLumps' is set and the lumps retained from the last time a map WAD was opened are for this same file, then those are
+// used instead of reading and decompressing all of the map lumps again. This should only be requested when restarting the current level,
+// since it assumes the file has not changed on disk in the meantime.
 //------------------------------------------------------------------------------------------------------------------------------------------
-void W_OpenMapWad(const CdFileId fileId) noexcept {
+void W_OpenMapWad(const CdFileId fileId, const bool bReuseRetainedLumps) noexcept {
     gMapWad.open(fileId);
 
     /* Detect WAD format and initialize compatibility layer */
     const WadCompat::WadFormatInfo info = WadCompat::WadCompatibilityLayer::detectWadFormat(gMapWad);
     WadCompat::getCompatLayer().beginMapConversion(gMapWad, info.format);
+
+    // Read all of the map lumps upfront and decompress them in parallel, unless we can just reuse the retained copies of them
+    const bool bCanReuseLumps = (
+        bReuseRetainedLumps &&
+        (gPrefetchedMapFileId == fileId) &&
+        (gPrefetchedMapLumps.size() == (size_t) gMapWad.getNumLumps())
+    );
+
+    if (!bCanReuseLumps) {
+        W_PrefetchMapLumps();
+        gPrefetchedMapFileId = fileId;
+    }
+
+    W_ConvertPrefetchedMapLumps();
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Closes the currently open map WAD, if any
+// Closes the currently open map WAD, if any.
+// Note: the prefetched map lumps are retained so that they can be reused if the level is restarted.
 //------------------------------------------------------------------------------------------------------------------------------------------
 void W_CloseMapWad() noexcept {
     WadCompat::getCompatLayer().endMapConversion();
@@ -211,10 +351,20 @@ int32_t W_RawMapLumpLength(const int32_t lumpIdx) noexcept {
 void W_ReadMapLump(const int32_t lumpIdx, void* const pDest, const bool bDecompress) noexcept {
     /* If no conversion needed, fast path */
     if (!WadCompat::getCompatLayer().needsConversion()) {
-        gMapWad.readLump(lumpIdx, pDest, bDecompress);
+        W_ReadMapLumpData(lumpIdx, pDest, bDecompress);
         return;
     }
 
+    // Use the copy of the lump converted when the map WAD was opened, if available
+    if (bDecompress && (lumpIdx >= 0) && ((size_t) lumpIdx < gPrefetchedMapLumps.size())) {
+        const PrefetchedMapLump& prefetchedLump = gPrefetchedMapLumps[lumpIdx];
+
+        if (prefetchedLump.bIsConverted) {
+            std::memcpy(pDest, prefetchedLump.convertedData.data(), prefetchedLump.convertedData.size());
+            return;
+        }
+    }
+
     /* Allocate temp buffer for raw PC data */
     const WadLump& lump = gMapWad.getLump(lumpIdx);
     const int32_t rawSize = lump.uncompressedSize;
@@ -225,7 +375,7 @@ void W_ReadMapLump(const int32_t lumpIdx, void* const pDest, const bool bDecompr
         I_Error("W_ReadMapLump: Failed to alloc temp buffer for conversion");
     }
 
-    gMapWad.readLump(lumpIdx, pTemp, bDecompress);
+    W_ReadMapLumpData(lumpIdx, pTemp, bDecompress);
     
     const WadLumpName name = gMapWad.getLumpName(lumpIdx);
     const int32_t destSize = WadCompat::getCompatLayer().getConvertedSize(name.chars, rawSize);
@@ -241,6 +391,23 @@ void W_ReadMapLump(const int32_t lumpIdx, void* const pDest, const bool bDecompr
     Z_Free2(*gpMainMemZone, pTemp);
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Returns the decompressed data for the requested lump index from the currently open map WAD, if it's already held in memory.
+// This allows map lumps to be parsed in place, without copying them into another buffer first.
+// Returns 'nullptr' if the data is not available, or if it must be converted (PC format maps) before it can be used.
+// The returned pointer is valid until the next map WAD is opened.
+//------------------------------------------------------------------------------------------------------------------------------------------
+const std::byte* W_GetMapLumpData(const int32_t lumpIdx) noexcept {
+    if (WadCompat::getCompatLayer().needsConversion())
+        return nullptr;
+
+    if ((lumpIdx < 0) || ((size_t) lumpIdx >= gPrefetchedMapLumps.size()))
+        return nullptr;
+
+    const PrefetchedMapLump& prefetchedLump = gPrefetchedMapLumps[lumpIdx];
+    return (prefetchedLump.bIsDecompressed) ? prefetchedLump.data.data() : nullptr;
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // These functions have been relocated to the new WAD handling code.
 // Keeping these calls here however so previous code using them can still work without changes.
@@ -36,13 +36,14 @@ int32_t W_RawLumpLength(const int32_t lumpIdx) noexcept;
 void W_ReadLump(const int32_t lumpIdx, void* const pDest, const bool bDecompress) noexcept;
 const WadLump& W_CacheLumpNum(const int32_t lumpIdx, const int16_t allocTag, const bool bDecompress) noexcept;
 const WadLump& W_CacheLumpName(const WadLumpName lumpName, const int16_t allocTag, const bool bDecompress) noexcept;
-void W_OpenMapWad(const CdFileId fileId) noexcept;
+void W_OpenMapWad(const CdFileId fileId, const bool bReuseRetainedLumps = false) noexcept;
 void W_CloseMapWad() noexcept;
 int32_t W_MapCheckNumForName(const WadLumpName lumpName) noexcept;
 int32_t W_MapGetNumForName(const WadLumpName lumpName) noexcept;
 int32_t W_MapLumpLength(const int32_t lumpIdx) noexcept;
 int32_t W_RawMapLumpLength(const int32_t lumpIdx) noexcept;
 void W_ReadMapLump(const int32_t lumpIdx, void* const pDest, const bool bDecompress) noexcept;
+const std::byte* W_GetMapLumpData(const int32_t lumpIdx) noexcept;
 void decode(const void* pSrc, void* pDst) noexcept;
 uint32_t getDecodedSize(const void* const pSrc) noexcept;
 
@@ -1,12 +1,16 @@
 #include "z_zone.h"
 
+#include "Asserts.h"
 #include "Doom/psx_main.h"
 #include "EngineLimits.h"
 #include "i_main.h"
 #include "PsyDoom/Config/Config.h"
 
+#include <algorithm>
 #include <cstring>
 #include <memory>
+#include <new>
+#include <vector>
 
 // The minimum size that a memory block must be
 static constexpr int32_t MINFRAGMENT = 64;
@@ -17,6 +21,15 @@ static constexpr size_t MEMZONE_HEADER_SIZE = offsetof(memzone_t, blocklist);
 // PsyDoom: the entire heap memory used by the game
 static std::unique_ptr<std::byte[]> gZoneHeap;
 
+// PsyDoom limit removing: extra chunks of memory that the main memory zone has grown by.
+// Each chunk begins with a 'fence' block which is always in use and not owned by anything, so that blocks are never merged across chunks.
+#if PSYDOOM_LIMIT_REMOVING
+    static constexpr int16_t ZONECHUNKID = 0x1D4B;
+    static constexpr int32_t ZONE_CHUNK_FENCE_SIZE = (int32_t) sizeof(memblock_t);
+
+    static std::vector<std::unique_ptr<std::byte[]>> gZoneHeapChunks;
+#endif
+
 // The main (and only) memory zone used by PSX DOOM
 memzone_t* gpMainMemZone;
 
@@ -36,8 +49,142 @@ void Z_Init() noexcept {
 
     gZoneHeap.reset(new std::byte[heapSize]);                   // Allocate the native heap for the application
     gpMainMemZone = Z_InitZone(gZoneHeap.get(), heapSize);      // Setup and save the main memory zone (the only zone)
+
+    // Limit removing: the main memory zone grows on demand instead of running out
+    #if PSYDOOM_LIMIT_REMOVING
+        gZoneHeapChunks.clear();
+        gpMainMemZone->growChunkSize = Z_HEAP_CHUNK_SIZE;
+    #endif
 }
 
+#if PSYDOOM_LIMIT_REMOVING
+
+#if PSYDOOM_ZONE_BINNED_ALLOC
+    static void Z_AddToFreeBin(memzone_t& zone, memblock_t& block) noexcept;
+    static void Z_RemoveFromFreeBin(memzone_t& zone, memblock_t& block) noexcept;
+#endif
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom limit removing: tells if the given block is the fence block at the start of an extra chunk of zone memory
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool Z_IsChunkFence(const memblock_t& block) noexcept {
+    return (block.id == ZONECHUNKID);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom limit removing: grows the given zone by enough whole chunks to hold a free block of at least the given size.
+// The new free block is added at the end of the block list and returned, or null is returned if the zone could not be grown.
+// Note: only the main memory zone can grow, since the chunks it owns are tracked globally.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static memblock_t* Z_AddZoneChunk(memzone_t& zone, const int32_t minFreeBlockSize) noexcept {
+    if (zone.growChunkSize <= 0)
+        return nullptr;
+
+    ASSERT(&zone == gpMainMemZone);
+
+    // Figure out how big the chunk needs to be and allocate it
+    const int64_t minChunkSize = (int64_t) minFreeBlockSize + ZONE_CHUNK_FENCE_SIZE;
+    const int64_t chunkSize = ((minChunkSize + zone.growChunkSize - 1) / zone.growChunkSize) * zone.growChunkSize;
+
+    if ((int64_t) zone.size + chunkSize > INT32_MAX)
+        return nullptr;
+
+    std::byte* const pChunk = new (std::nothrow) std::byte[(size_t) chunkSize];
+
+    if (!pChunk)
+        return nullptr;
+
+    gZoneHeapChunks.emplace_back(pChunk);
+
+    // Find the current last block in the zone
+    #if PSYDOOM_ZONE_BINNED_ALLOC
+        memblock_t& lastBlock = *zone.pLastBlock;
+    #else
+        memblock_t* pLastBlock = &zone.blocklist;
+
+        while (pLastBlock->next) {
+            pLastBlock = pLastBlock->next;
+        }
+
+        memblock_t& lastBlock = *pLastBlock;
+    #endif
+
+    // Setup the fence and the free block that follows it, then link them onto the end of the block list
+    memblock_t& fence = (memblock_t&) *pChunk;
+    memblock_t& freeBlock = (memblock_t&) *(pChunk + ZONE_CHUNK_FENCE_SIZE);
+
+    fence = {};
+    fence.size = ZONE_CHUNK_FENCE_SIZE;
+    fence.user = (void**) 1;
+    fence.id = ZONECHUNKID;
+    fence.lockframe = -1;
+    fence.prev = &lastBlock;
+    fence.next = &freeBlock;
+
+    freeBlock = {};
+    freeBlock.size = (int32_t)(chunkSize - ZONE_CHUNK_FENCE_SIZE);
+    freeBlock.lockframe = -1;
+    freeBlock.prev = &fence;
+
+    lastBlock.next = &fence;
+
+    #if PSYDOOM_ZONE_BINNED_ALLOC
+        zone.pLastBlock = &freeBlock;
+        Z_AddToFreeBin(zone, freeBlock);
+    #endif
+
+    zone.size += (int32_t) chunkSize;
+    zone.peakSize = std::max(zone.peakSize, zone.size);
+    zone.stats.numChunksAdded++;
+    return &freeBlock;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom limit removing: releases any extra chunks of memory that the given zone grew by which no longer contain any used blocks.
+// Free blocks must have already been merged, so that an empty chunk consists of just the fence followed by a single free block.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void Z_ReleaseEmptyChunks(memzone_t& zone) noexcept {
+    if (zone.growChunkSize <= 0)
+        return;
+
+    for (auto chunkIter = gZoneHeapChunks.begin(); chunkIter != gZoneHeapChunks.end();) {
+        memblock_t& fence = (memblock_t&) *chunkIter->get();
+        memblock_t& block = *fence.next;
+        const bool bChunkEmpty = ((!block.user) && ((!block.next) || Z_IsChunkFence(*block.next)));
+
+        if (!bChunkEmpty) {
+            ++chunkIter;
+            continue;
+        }
+
+        // Unlink the chunk's blocks from the zone and free the memory
+        #if PSYDOOM_ZONE_BINNED_ALLOC
+            Z_RemoveFromFreeBin(zone, block);
+
+            if (zone.pLastBlock == &block) {
+                zone.pLastBlock = fence.prev;
+            }
+        #endif
+
+        fence.prev->next = block.next;
+
+        if (block.next) {
+            block.next->prev = fence.prev;
+        }
+
+        zone.size -= fence.size + block.size;
+        zone.stats.numChunksReleased++;
+        chunkIter = gZoneHeapChunks.erase(chunkIter);
+    }
+
+    zone.rover = &zone.blocklist;
+}
+
+#endif  // #if PSYDOOM_LIMIT_REMOVING
+
+// PsyDoom: if the binned allocator is enabled then it provides its own versions of most of the zone functions (see the end of this file)
+#if !PSYDOOM_ZONE_BINNED_ALLOC
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Sets up the given block of memory as a memory zone
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -55,6 +202,12 @@ memzone_t* Z_InitZone(void* const pBase, const int32_t size) noexcept {
     // It was not serving any useful purpose anyway so probably doesn't matter? Just initialize here though for good measure:
     #if PSYDOOM_MODS
         pZone->blocklist.lockframe = -1;
+        pZone->stats = {};
+    #endif
+
+    #if PSYDOOM_LIMIT_REMOVING
+        pZone->growChunkSize = 0;
+        pZone->peakSize = size;
     #endif
 
     pZone->blocklist.next = nullptr;
@@ -80,7 +233,17 @@ void* Z_Malloc(memzone_t& zone, const int32_t size, const int16_t tag, void** co
     memblock_t* pBase = zone.rover;
     memblock_t* const pStart = pBase;
 
+    // PsyDoom limit removing: also count how many times the search wraps around to the beginning of the block list.
+    // The start block might get merged into another free block, so two wraps is the only reliable sign that every block has been searched.
+    #if PSYDOOM_LIMIT_REMOVING
+        int32_t numWraps = 0;
+    #endif
+
     while (pBase->user || (pBase->size < allocSize)) {
+        #if PSYDOOM_MODS
+            zone.stats.numBlocksVisited++;
+        #endif
+
         // Set the rover to the next block if the current is free, so we can merge free blocks:
         memblock_t* const pRover = (pBase->user) ? pBase : pBase->next;
 
@@ -98,11 +261,29 @@ void* Z_Malloc(memzone_t& zone, const int32_t size, const int16_t tag, void** co
                 if (!pBase) {
                 block_list_begin:
                     pBase = &zone.blocklist;
+
+                    #if PSYDOOM_LIMIT_REMOVING
+                        ++numWraps;
+                    #endif
                 }
 
                 // If we have wrapped around back to where we started then we're out of RAM.
                 // In this case we have searched all blocks for one big enough and not found one :(
-                if (pBase == pStart) {
+                #if PSYDOOM_LIMIT_REMOVING
+                    const bool bSearchedAllBlocks = ((pBase == pStart) || (numWraps >= 2));
+                #else
+                    const bool bSearchedAllBlocks = (pBase == pStart);
+                #endif
+
+                if (bSearchedAllBlocks) {
+                    // PsyDoom limit removing: grow the zone instead if possible, the new free block will be big enough
+                    #if PSYDOOM_LIMIT_REMOVING
+                        if (memblock_t* const pNewBlock = Z_AddZoneChunk(zone, allocSize)) {
+                            pBase = pNewBlock;
+                            continue;
+                        }
+                    #endif
+
                     Z_DumpHeap();
                     I_Error("Z_Malloc: failed allocation on %i", allocSize);
                 }
@@ -111,6 +292,11 @@ void* Z_Malloc(memzone_t& zone, const int32_t size, const int16_t tag, void** co
             }
 
             // Chuck out this block!
+            #if PSYDOOM_MODS
+                zone.stats.numPurges++;
+                zone.stats.numCachePurges += (pRover->tag == PU_CACHE) ? 1 : 0;
+            #endif
+
             Z_Free2(*gpMainMemZone, &pRover[1]);
         }
 
@@ -166,6 +352,10 @@ void* Z_Malloc(memzone_t& zone, const int32_t size, const int16_t tag, void** co
     pBase->tag = tag;
     pBase->id = ZONEID;
 
+    #if PSYDOOM_MODS
+        zone.stats.numMallocs++;
+    #endif
+
     // Move along the rover to the next block and return the usable memory allocated (past the allocated block header)
     zone.rover = (pBase->next) ? pBase->next : &zone.blocklist;
     return &pBase[1];
@@ -192,6 +382,10 @@ void* Z_EndMalloc(memzone_t& zone, const int32_t size, const int16_t tag, void**
     }
 
     while (pBase->user || (pBase->size < allocSize)) {
+        #if PSYDOOM_MODS
+            zone.stats.numBlocksVisited++;
+        #endif
+
         // Set the rover to the previous block if the current is free, so we can merge free blocks:
         memblock_t* pRover;
 
@@ -201,7 +395,15 @@ void* Z_EndMalloc(memzone_t& zone, const int32_t size, const int16_t tag, void**
             pRover = pBase->prev;
 
             // Have we gone past the start? If so then we have failed...
+            // PsyDoom limit removing: grow the zone instead if possible, the new free block at the end will be big enough.
             if (!pRover) {
+                #if PSYDOOM_LIMIT_REMOVING
+                    if (memblock_t* const pNewBlock = Z_AddZoneChunk(zone, allocSize)) {
+                        pBase = pNewBlock;
+                        continue;
+                    }
+                #endif
+
                 I_Error("Z_Malloc: failed allocation on %i", allocSize);
             }
         }
@@ -214,7 +416,15 @@ void* Z_EndMalloc(memzone_t& zone, const int32_t size, const int16_t tag, void**
 
                 // If we have wrapped around back to the start of the zone then we're out of RAM.
                 // In this case we have searched all blocks for one big enough and not found one :(
+                // PsyDoom limit removing: grow the zone instead if possible.
                 if (!pBase) {
+                    #if PSYDOOM_LIMIT_REMOVING
+                        pBase = Z_AddZoneChunk(zone, allocSize);
+
+                        if (pBase)
+                            continue;
+                    #endif
+
                     I_Error("Z_Malloc: failed allocation on %i", allocSize);
                 }
 
@@ -222,6 +432,11 @@ void* Z_EndMalloc(memzone_t& zone, const int32_t size, const int16_t tag, void**
             }
 
             // Chuck out this block!
+            #if PSYDOOM_MODS
+                zone.stats.numPurges++;
+                zone.stats.numCachePurges += (pRover->tag == PU_CACHE) ? 1 : 0;
+            #endif
+
             Z_Free2(*gpMainMemZone, &pRover[1]);
         }
 
@@ -276,6 +491,10 @@ void* Z_EndMalloc(memzone_t& zone, const int32_t size, const int16_t tag, void**
     pBase->id = ZONEID;
     pBase->tag = tag;
 
+    #if PSYDOOM_MODS
+        zone.stats.numMallocs++;
+    #endif
+
     // Set the rover for the zone and return the usable memory allocated (past the allocated block header)
     zone.rover = &zone.blocklist;
     return (void*) &pBase[1];
@@ -303,14 +522,26 @@ void Z_Free2([[maybe_unused]] memzone_t& zone, void* const ptr) noexcept {
     block.user = nullptr;
     block.tag = 0;
     block.id = 0;
+
+    #if PSYDOOM_MODS
+        zone.stats.numFrees++;
+    #endif
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Free memory blocks that have one or more of the given tag bits
 //------------------------------------------------------------------------------------------------------------------------------------------
 void Z_FreeTags(memzone_t& zone, const int16_t tagBits) noexcept {
+    #if PSYDOOM_MODS
+        zone.stats.numFreeTagsCalls++;
+    #endif
+
     // Free each block if it is in use and matches one of the given tags
     for (memblock_t* pBlock = &zone.blocklist; pBlock; pBlock = pBlock->next) {
+        #if PSYDOOM_MODS
+            zone.stats.numBlocksVisited++;
+        #endif
+
         if (pBlock->user) {
             if ((pBlock->tag & tagBits) != 0) {
                 Z_Free2(zone, &pBlock[1]);
@@ -324,6 +555,10 @@ void Z_FreeTags(memzone_t& zone, const int16_t tagBits) noexcept {
     for (memblock_t* pBlock = &zone.blocklist; pBlock; pBlock = pNextBlock) {
         pNextBlock = pBlock->next;
 
+        #if PSYDOOM_MODS
+            zone.stats.numBlocksVisited++;
+        #endif
+
         // See if there are two adjacent free blocks
         if ((!pBlock->user) && pNextBlock && (!pNextBlock->user)) {
             // Merge the two blocks together
@@ -348,6 +583,13 @@ void Z_FreeTags(memzone_t& zone, const int16_t tagBits) noexcept {
         }
     }
 
+    // PsyDoom limit removing: when level memory is freed also give back any extra chunks of memory that are no longer needed
+    #if PSYDOOM_LIMIT_REMOVING
+        if (tagBits & PU_LEVEL) {
+            Z_ReleaseEmptyChunks(zone);
+        }
+    #endif
+
     // Reset the rover back to the start of the heap
     zone.rover = &zone.blocklist;
 }
@@ -357,15 +599,28 @@ void Z_FreeTags(memzone_t& zone, const int16_t tagBits) noexcept {
 // If any sanity checks fail, then a fatal error is emitted.
 //------------------------------------------------------------------------------------------------------------------------------------------
 void Z_CheckHeap(const memzone_t& zone) noexcept {
+    // PsyDoom limit removing: the zone might be split across multiple chunks of memory, so total up the block sizes to get the zone size
+    #if PSYDOOM_LIMIT_REMOVING
+        int32_t totalBlocksSize = 0;
+    #endif
+
     // Sanity check all blocks in the heap
     for (const memblock_t* pBlock = &zone.blocklist; pBlock; pBlock = pBlock->next) {
+        #if PSYDOOM_LIMIT_REMOVING
+            totalBlocksSize += pBlock->size;
+        #endif
+
         // If we have reached the end of the block list, make sure we haven't 'lost' any heap memory.
         // Computed size for all the blocks should match the zone size:
         if (!pBlock->next) {
-            const std::byte* const pZoneStartByte = (const std::byte*) &zone;
-            const std::byte* const pBlockStartByte = (const std::byte*) pBlock;
-            const std::byte* const pBlockEndByte = pBlockStartByte + pBlock->size;
-            const int32_t actualZoneSize = (int32_t)(pBlockEndByte - pZoneStartByte);
+            #if PSYDOOM_LIMIT_REMOVING
+                const int32_t actualZoneSize = totalBlocksSize + (int32_t) MEMZONE_HEADER_SIZE;
+            #else
+                const std::byte* const pZoneStartByte = (const std::byte*) &zone;
+                const std::byte* const pBlockStartByte = (const std::byte*) pBlock;
+                const std::byte* const pBlockEndByte = pBlockStartByte + pBlock->size;
+                const int32_t actualZoneSize = (int32_t)(pBlockEndByte - pZoneStartByte);
+            #endif
 
             if (actualZoneSize != zone.size) {
                 I_Error("Z_CheckHeap: zone size changed\n");
@@ -374,10 +629,17 @@ void Z_CheckHeap(const memzone_t& zone) noexcept {
             continue;
         }
 
-        // The next block after this block should touch the current block
+        // The next block after this block should touch the current block.
+        // PsyDoom limit removing: except where the next block is the start of another chunk of memory.
         const memblock_t* const pNextBlock = (const memblock_t*)((const std::byte*) pBlock + pBlock->size);
 
-        if (pNextBlock != pBlock->next) {
+        #if PSYDOOM_LIMIT_REMOVING
+            const bool bNextBlockTouches = ((pNextBlock == pBlock->next) || Z_IsChunkFence(*pBlock->next));
+        #else
+            const bool bNextBlockTouches = (pNextBlock == pBlock->next);
+        #endif
+
+        if (!bNextBlockTouches) {
             I_Error("Z_CheckHeap: block size does not touch the next block\n");
         }
 
@@ -410,6 +672,8 @@ void Z_ChangeTag(void* const ptr, const int16_t tagBits) noexcept {
     block.tag = (int16_t) tagBits;
 }
 
+#endif  // #if !PSYDOOM_ZONE_BINNED_ALLOC
+
 #if PSYDOOM_MODS
 //------------------------------------------------------------------------------------------------------------------------------------------
 // PsyDoom addition: clear or set the 'user' field for an already allocated memory block.
@@ -423,7 +687,12 @@ void Z_SetUser(void* const ptr, void** const ppUser) noexcept {
         I_Error("Z_SetUser: pointer has incorrect ZONEID");
     }
 
-    block.user = ppUser;
+    // The binned allocator relies on a null user to identify free blocks, so use the 'no owner' value instead for a used block
+    #if PSYDOOM_ZONE_BINNED_ALLOC
+        block.user = (ppUser) ? ppUser : (void**) 1;
+    #else
+        block.user = ppUser;
+    #endif
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -436,6 +705,7 @@ void* Z_ZeroedMalloc(memzone_t& zone, const int32_t size, const int16_t tag, voi
 }
 #endif  // #if PSYDOOM_MODS
 
+#if !PSYDOOM_ZONE_BINNED_ALLOC
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Counts and returns the number of free bytes in the given memory zone
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -450,9 +720,590 @@ int32_t Z_FreeMemory(memzone_t& zone) noexcept {
 
     return bytesFree;
 }
+#endif  // #if !PSYDOOM_ZONE_BINNED_ALLOC
+
+#if PSYDOOM_MODS
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom addition: get the heap statistics category for a block tag
+//------------------------------------------------------------------------------------------------------------------------------------------
+int32_t Z_GetHeapStatsTagIdx(const int16_t tag) noexcept {
+    for (int32_t tagIdx = 0; tagIdx < NUM_ZONE_STATS_TAGS - 1; ++tagIdx) {
+        if (tag == (1 << tagIdx))
+            return tagIdx;
+    }
+
+    return NUM_ZONE_STATS_TAGS - 1;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom addition: get the name of a heap statistics tag category
+//------------------------------------------------------------------------------------------------------------------------------------------
+const char* Z_GetHeapStatsTagName(const int32_t tagIdx) noexcept {
+    static constexpr const char* TAG_NAMES[NUM_ZONE_STATS_TAGS] = {
+        "STATIC", "LEVEL", "LEVSPEC", "ANIMATION", "PURGELEVEL", "CACHE", "OTHER"
+    };
+
+    return ((tagIdx >= 0) && (tagIdx < NUM_ZONE_STATS_TAGS)) ? TAG_NAMES[tagIdx] : "UNKNOWN";
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom addition: walks all the blocks in the given zone to take a snapshot of how the memory in it is being used.
+// Intended for debugging and sizing the heap: the cost of this is proportional to the number of blocks in the zone.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void Z_GetHeapStats(const memzone_t& zone, zoneheapstats_t& stats) noexcept {
+    stats = {};
+    stats.totalBytes = zone.size;
+
+    for (const memblock_t* pBlock = &zone.blocklist; pBlock; pBlock = pBlock->next) {
+        // Limit removing: the fence blocks at the start of extra chunks of memory are not used by anything, so are not counted
+        #if PSYDOOM_LIMIT_REMOVING
+            if (Z_IsChunkFence(*pBlock))
+                continue;
+        #endif
+
+        if (pBlock->user) {
+            const int32_t tagIdx = Z_GetHeapStatsTagIdx(pBlock->tag);
+            stats.usedBytes[tagIdx] += pBlock->size;
+            stats.numUsedBlocks[tagIdx]++;
+        } else {
+            stats.freeBytes += pBlock->size;
+            stats.numFreeBlocks++;
+            stats.largestFreeBlock = std::max(stats.largestFreeBlock, pBlock->size);
+        }
+    }
+
+    stats.fragmentation = (stats.freeBytes > 0) ? 1.0f - (float) stats.largestFreeBlock / (float) stats.freeBytes : 0.0f;
+}
+#endif  // #if PSYDOOM_MODS
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // This function is empty in PSX DOOM - probably compiled out of the release build.
 // If you want this functionality you could take a look at the Linux DOOM source.
 //------------------------------------------------------------------------------------------------------------------------------------------
 void Z_DumpHeap() noexcept {}
+
+#if PSYDOOM_ZONE_BINNED_ALLOC
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom binned allocator.
+//
+// This is an optional replacement for the original first fit zone allocator, which on large maps with lots of level thinkers and cached
+// lumps can end up walking thousands of memory blocks for each allocation and call to 'Z_FreeTags'. The zone memory layout, block tags,
+// user pointers and purging of purgable blocks all work the same as before; the difference is in how blocks are found:
+//
+//  (1) Free blocks are kept in size class bins (several bins per power of two size) so that a free block big enough for an allocation
+//      can be found without walking the heap. Adjacent free blocks are merged immediately when freed, instead of lazily on allocation.
+//  (2) Used blocks are kept in a list for their tag, so 'Z_FreeTags' only needs to visit the blocks that it frees. Purgable blocks are
+//      evicted oldest first from their tag list whenever an allocation cannot otherwise be satisfied.
+//
+// Note: because block placement differs from the original allocator, heap layouts won't match exactly with the original game.
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Get the size class bin that a free block of the given size should be stored in
+//------------------------------------------------------------------------------------------------------------------------------------------
+static int32_t Z_GetBinForSize(const int32_t size) noexcept {
+    const uint32_t usize = (uint32_t) size;
+    int32_t pow2 = 0;
+
+    while ((usize >> (pow2 + 1)) != 0) {
+        ++pow2;
+    }
+
+    // Sizes that are too small to be split into sub bins just go in the first bin for their power of two
+    if (pow2 < ZONE_BINS_PER_POW2_LOG2)
+        return pow2 * ZONE_BINS_PER_POW2;
+
+    const int32_t subBin = (int32_t)(usize >> (pow2 - ZONE_BINS_PER_POW2_LOG2)) & (ZONE_BINS_PER_POW2 - 1);
+    return pow2 * ZONE_BINS_PER_POW2 + subBin;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Get the minimum size of a free block stored in the given size class bin
+//------------------------------------------------------------------------------------------------------------------------------------------
+static int64_t Z_GetBinMinSize(const int32_t bin) noexcept {
+    const int32_t pow2 = bin / ZONE_BINS_PER_POW2;
+    const int32_t subBin = bin % ZONE_BINS_PER_POW2;
+
+    if (pow2 < ZONE_BINS_PER_POW2_LOG2)
+        return (int64_t) 1 << pow2;
+
+    return ((int64_t) 1 << pow2) + ((int64_t) subBin << (pow2 - ZONE_BINS_PER_POW2_LOG2));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Get the tag list that a used block with the given tag should be stored in
+//------------------------------------------------------------------------------------------------------------------------------------------
+static int32_t Z_GetTagListForTag(const int16_t tag) noexcept {
+    for (int32_t listIdx = 0; listIdx < NUM_ZONE_TAG_LISTS - 1; ++listIdx) {
+        if (tag == (1 << listIdx))
+            return listIdx;
+    }
+
+    return NUM_ZONE_TAG_LISTS - 1;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Add or remove a free block to/from it's size class bin
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void Z_AddToFreeBin(memzone_t& zone, memblock_t& block) noexcept {
+    memblock_t*& pBinHead = zone.freeBins[Z_GetBinForSize(block.size)];
+
+    block.listPrev = nullptr;
+    block.listNext = pBinHead;
+
+    if (pBinHead) {
+        pBinHead->listPrev = &block;
+    }
+
+    pBinHead = &block;
+    zone.bytesFree += block.size;
+}
+
+static void Z_RemoveFromFreeBin(memzone_t& zone, memblock_t& block) noexcept {
+    if (block.listPrev) {
+        block.listPrev->listNext = block.listNext;
+    } else {
+        zone.freeBins[Z_GetBinForSize(block.size)] = block.listNext;
+    }
+
+    if (block.listNext) {
+        block.listNext->listPrev = block.listPrev;
+    }
+
+    block.listNext = nullptr;
+    block.listPrev = nullptr;
+    zone.bytesFree -= block.size;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Add or remove a used block to/from the end of it's tag list
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void Z_AddToTagList(memzone_t& zone, memblock_t& block) noexcept {
+    const int32_t listIdx = Z_GetTagListForTag(block.tag);
+    memblock_t*& pListTail = zone.tagListTails[listIdx];
+
+    block.listPrev = pListTail;
+    block.listNext = nullptr;
+
+    if (pListTail) {
+        pListTail->listNext = &block;
+    } else {
+        zone.tagListHeads[listIdx] = &block;
+    }
+
+    pListTail = &block;
+}
+
+static void Z_RemoveFromTagList(memzone_t& zone, memblock_t& block) noexcept {
+    const int32_t listIdx = Z_GetTagListForTag(block.tag);
+
+    if (block.listPrev) {
+        block.listPrev->listNext = block.listNext;
+    } else {
+        zone.tagListHeads[listIdx] = block.listNext;
+    }
+
+    if (block.listNext) {
+        block.listNext->listPrev = block.listPrev;
+    } else {
+        zone.tagListTails[listIdx] = block.listPrev;
+    }
+
+    block.listNext = nullptr;
+    block.listPrev = nullptr;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Merges the block following the given block into it. Neither block should be in a free bin or tag list.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void Z_MergeWithNextBlock(memzone_t& zone, memblock_t& block) noexcept {
+    memblock_t& nextBlock = *block.next;
+    block.size += nextBlock.size;
+    block.next = nextBlock.next;
+
+    if (nextBlock.next) {
+        nextBlock.next->prev = &block;
+    } else {
+        zone.pLastBlock = &block;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Frees the given used block, merging it with any adjacent free blocks.
+// Returns the free block that the memory ended up in.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static memblock_t& Z_FreeBlock(memzone_t& zone, memblock_t& block) noexcept {
+    Z_RemoveFromTagList(zone, block);
+
+    // Clear the pointer field referencing the memory block too.
+    // Treat very small addresses as not pointers also:
+    if (block.user > (void*) 0x100) {
+        *block.user = nullptr;
+    }
+
+    block.user = nullptr;
+    block.tag = 0;
+    block.id = 0;
+    zone.stats.numFrees++;
+
+    // Merge with the free blocks before and after this one, if there are any
+    memblock_t* pFreeBlock = &block;
+
+    if (block.next && (!block.next->user)) {
+        Z_RemoveFromFreeBin(zone, *block.next);
+        Z_MergeWithNextBlock(zone, block);
+    }
+
+    if (block.prev && (!block.prev->user)) {
+        pFreeBlock = block.prev;
+        Z_RemoveFromFreeBin(zone, *pFreeBlock);
+        Z_MergeWithNextBlock(zone, *pFreeBlock);
+    }
+
+    Z_AddToFreeBin(zone, *pFreeBlock);
+    return *pFreeBlock;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tries to find a free block which is at least the given size, returning null if none is found
+//------------------------------------------------------------------------------------------------------------------------------------------
+static memblock_t* Z_FindFreeBlock(memzone_t& zone, const int32_t allocSize) noexcept {
+    // Firstly look for the smallest non empty bin where every block is guaranteed to be big enough.
+    // Since there are a fixed number of bins this search is constant time.
+    const int32_t sizeBin = Z_GetBinForSize(allocSize);
+    const int32_t firstFitBin = (Z_GetBinMinSize(sizeBin) < allocSize) ? sizeBin + 1 : sizeBin;
+
+    for (int32_t bin = firstFitBin; bin < NUM_ZONE_BINS; ++bin) {
+        if (zone.freeBins[bin]) {
+            zone.stats.numBlocksVisited++;
+            return zone.freeBins[bin];
+        }
+    }
+
+    // Otherwise some blocks in the bin for the allocation size might still be big enough: try those
+    for (memblock_t* pBlock = zone.freeBins[sizeBin]; pBlock; pBlock = pBlock->listNext) {
+        zone.stats.numBlocksVisited++;
+
+        if (pBlock->size >= allocSize)
+            return pBlock;
+    }
+
+    return nullptr;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Finds the oldest purgable block in the zone, returning null if there are none
+//------------------------------------------------------------------------------------------------------------------------------------------
+static memblock_t* Z_FindPurgableBlock(memzone_t& zone) noexcept {
+    // Check the lists for single bit tags which are purgable first, since every block in those lists can be evicted
+    for (int32_t listIdx = 0; listIdx < NUM_ZONE_TAG_LISTS - 1; ++listIdx) {
+        if (((1 << listIdx) >= PU_PURGELEVEL) && zone.tagListHeads[listIdx]) {
+            zone.stats.numBlocksVisited++;
+            return zone.tagListHeads[listIdx];
+        }
+    }
+
+    // Otherwise search the list containing all other tag values for a purgable block
+    for (memblock_t* pBlock = zone.tagListHeads[NUM_ZONE_TAG_LISTS - 1]; pBlock; pBlock = pBlock->listNext) {
+        zone.stats.numBlocksVisited++;
+
+        if (pBlock->tag >= PU_PURGELEVEL)
+            return pBlock;
+    }
+
+    return nullptr;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Allocates a block of the given size (including header) within the zone, purging purgable blocks if required to make room.
+// If 'bAtEnd' is set then the used memory is taken from the end of the free block rather than the start.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void* Z_BinnedMalloc(
+    memzone_t& zone,
+    const int32_t allocSize,
+    const int16_t tag,
+    void** const ppUser,
+    const bool bAtEnd
+) noexcept {
+    // For allocations at the end of the heap use the last block if possible, otherwise use whatever free block is available
+    memblock_t* pFreeBlock = nullptr;
+
+    if (bAtEnd && (!zone.pLastBlock->user) && (zone.pLastBlock->size >= allocSize)) {
+        pFreeBlock = zone.pLastBlock;
+    } else {
+        pFreeBlock = Z_FindFreeBlock(zone, allocSize);
+    }
+
+    // If there is no free block big enough then evict purgable blocks until there is
+    while (!pFreeBlock) {
+        memblock_t* const pPurgeBlock = Z_FindPurgableBlock(zone);
+
+        if (!pPurgeBlock) {
+            // PsyDoom limit removing: grow the zone instead if possible, the new free block will be big enough
+            #if PSYDOOM_LIMIT_REMOVING
+                pFreeBlock = Z_AddZoneChunk(zone, allocSize);
+
+                if (pFreeBlock)
+                    break;
+            #endif
+
+            Z_DumpHeap();
+            I_Error("Z_Malloc: failed allocation on %i", allocSize);
+        }
+
+        zone.stats.numPurges++;
+        zone.stats.numCachePurges += (pPurgeBlock->tag == PU_CACHE) ? 1 : 0;
+        memblock_t& mergedBlock = Z_FreeBlock(zone, *pPurgeBlock);
+
+        if (mergedBlock.size >= allocSize) {
+            pFreeBlock = &mergedBlock;
+        }
+    }
+
+    // If there are enough free bytes left over then split off a new free block.
+    // The new free block goes after the allocation normally, or before it when allocating at the end of the heap.
+    Z_RemoveFromFreeBin(zone, *pFreeBlock);
+
+    const int32_t numUnusedBytes = pFreeBlock->size - allocSize;
+    memblock_t* pBase = pFreeBlock;
+
+    if (numUnusedBytes > MINFRAGMENT) {
+        memblock_t& newBlock = (memblock_t&) *((std::byte*) pFreeBlock + ((bAtEnd) ? numUnusedBytes : allocSize));
+        newBlock.prev = pFreeBlock;
+        newBlock.next = pFreeBlock->next;
+
+        if (pFreeBlock->next) {
+            pFreeBlock->next->prev = &newBlock;
+        } else {
+            zone.pLastBlock = &newBlock;
+        }
+
+        pFreeBlock->next = &newBlock;
+
+        if (bAtEnd) {
+            pFreeBlock->size = numUnusedBytes;
+            newBlock.size = allocSize;
+            pBase = &newBlock;
+            Z_AddToFreeBin(zone, *pFreeBlock);
+        } else {
+            pFreeBlock->size = allocSize;
+            newBlock.size = numUnusedBytes;
+            newBlock.user = nullptr;
+            newBlock.tag = 0;
+            newBlock.id = 0;
+            Z_AddToFreeBin(zone, newBlock);
+        }
+    }
+
+    // Setup the links on the memory block back to the pointer referencing it.
+    // Also populate the pointer referencing it (if given):
+    if (ppUser) {
+        pBase->user = ppUser;
+        *ppUser = &pBase[1];
+    } else {
+        if (tag >= PU_PURGELEVEL) {
+            I_Error("Z_Malloc: an owner is required for purgable blocks");
+        }
+
+        // Non purgable blocks without any owner are assigned a pointer value of '1'
+        pBase->user = (void**) 1;
+    }
+
+    // Set the tag and id for the block, add it to it's tag list and return the usable memory allocated (past the allocated block header)
+    pBase->tag = tag;
+    pBase->id = ZONEID;
+    pBase->lockframe = -1;
+    Z_AddToTagList(zone, *pBase);
+
+    zone.stats.numMallocs++;
+    return &pBase[1];
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Gets the real size to allocate for a requested allocation: have to add room for a memblock and also 8-byte align
+//------------------------------------------------------------------------------------------------------------------------------------------
+static int32_t Z_GetAllocSize(const int32_t size) noexcept {
+    return (size + sizeof(memblock_t) + sizeof(void*) - 1) & (int32_t)(0xFFFFFFFF - (sizeof(void*) - 1));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Binned allocator version: sets up the given block of memory as a memory zone
+//------------------------------------------------------------------------------------------------------------------------------------------
+memzone_t* Z_InitZone(void* const pBase, const int32_t size) noexcept {
+    memzone_t* const pZone = (memzone_t*) pBase;
+    std::memset(pZone, 0, sizeof(memzone_t));
+
+    pZone->size = size;
+    pZone->rover = &pZone->blocklist;
+    pZone->pLastBlock = &pZone->blocklist;
+    pZone->blocklist.size = size - MEMZONE_HEADER_SIZE;
+    pZone->blocklist.lockframe = -1;
+
+    #if PSYDOOM_LIMIT_REMOVING
+        pZone->peakSize = size;
+    #endif
+
+    Z_AddToFreeBin(*pZone, pZone->blocklist);
+    return pZone;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Binned allocator version: allocate a block of memory in the given memory zone with the given purgability tags
+//------------------------------------------------------------------------------------------------------------------------------------------
+void* Z_Malloc(memzone_t& zone, const int32_t size, const int16_t tag, void** const ppUser) noexcept {
+    return Z_BinnedMalloc(zone, Z_GetAllocSize(size), tag, ppUser, false);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Binned allocator version: allocate a block of memory as close as possible to the end of the heap
+//------------------------------------------------------------------------------------------------------------------------------------------
+void* Z_EndMalloc(memzone_t& zone, const int32_t size, const int16_t tag, void** const ppUser) noexcept {
+    return Z_BinnedMalloc(zone, Z_GetAllocSize(size), tag, ppUser, true);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Binned allocator version: free the given block of memory
+//------------------------------------------------------------------------------------------------------------------------------------------
+void Z_Free2(memzone_t& zone, void* const ptr) noexcept {
+    memblock_t& block = ((memblock_t*) ptr)[-1];
+
+    if (block.id != ZONEID) {
+        I_Error("Z_Free: freed a pointer without ZONEID");
+    }
+
+    Z_FreeBlock(zone, block);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Binned allocator version: free memory blocks that have one or more of the given tag bits.
+// Only the tag lists which can contain matching blocks are visited.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void Z_FreeTags(memzone_t& zone, const int16_t tagBits) noexcept {
+    zone.stats.numFreeTagsCalls++;
+
+    for (int32_t listIdx = 0; listIdx < NUM_ZONE_TAG_LISTS; ++listIdx) {
+        const bool bIsMiscTagList = (listIdx == NUM_ZONE_TAG_LISTS - 1);
+
+        if ((!bIsMiscTagList) && ((tagBits & (1 << listIdx)) == 0))
+            continue;
+
+        // Note: freeing a block only merges free blocks, so the next used block in the list is unaffected
+        memblock_t* pNextBlock;
+
+        for (memblock_t* pBlock = zone.tagListHeads[listIdx]; pBlock; pBlock = pNextBlock) {
+            pNextBlock = pBlock->listNext;
+            zone.stats.numBlocksVisited++;
+
+            if ((pBlock->tag & tagBits) != 0) {
+                Z_FreeBlock(zone, *pBlock);
+            }
+        }
+    }
+
+    // Limit removing: when level memory is freed also give back any extra chunks of memory that are no longer needed
+    #if PSYDOOM_LIMIT_REMOVING
+        if (tagBits & PU_LEVEL) {
+            Z_ReleaseEmptyChunks(zone);
+        }
+    #endif
+
+    zone.rover = &zone.blocklist;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Binned allocator version: performs basic sanity checks for the integrity of the heap.
+// Also verifies that the free byte count and last block pointer are consistent with the list of blocks.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void Z_CheckHeap(const memzone_t& zone) noexcept {
+    int32_t bytesFree = 0;
+
+    #if PSYDOOM_LIMIT_REMOVING
+        int32_t totalBlocksSize = 0;
+    #endif
+
+    for (const memblock_t* pBlock = &zone.blocklist; pBlock; pBlock = pBlock->next) {
+        #if PSYDOOM_LIMIT_REMOVING
+            totalBlocksSize += pBlock->size;
+        #endif
+
+        if (!pBlock->user) {
+            bytesFree += pBlock->size;
+
+            if (pBlock->next && (!pBlock->next->user)) {
+                I_Error("Z_CheckHeap: two adjacent free blocks\n");
+            }
+        }
+
+        if (!pBlock->next) {
+            #if PSYDOOM_LIMIT_REMOVING
+                const int32_t actualZoneSize = totalBlocksSize + (int32_t) MEMZONE_HEADER_SIZE;
+            #else
+                const std::byte* const pZoneStartByte = (const std::byte*) &zone;
+                const std::byte* const pBlockStartByte = (const std::byte*) pBlock;
+                const std::byte* const pBlockEndByte = pBlockStartByte + pBlock->size;
+                const int32_t actualZoneSize = (int32_t)(pBlockEndByte - pZoneStartByte);
+            #endif
+
+            if (actualZoneSize != zone.size) {
+                I_Error("Z_CheckHeap: zone size changed\n");
+            }
+
+            if (pBlock != zone.pLastBlock) {
+                I_Error("Z_CheckHeap: last block is incorrect\n");
+            }
+
+            continue;
+        }
+
+        // Limit removing: blocks don't touch where the next block is the start of another chunk of memory
+        const memblock_t* const pNextBlock = (const memblock_t*)((const std::byte*) pBlock + pBlock->size);
+
+        #if PSYDOOM_LIMIT_REMOVING
+            const bool bNextBlockTouches = ((pNextBlock == pBlock->next) || Z_IsChunkFence(*pBlock->next));
+        #else
+            const bool bNextBlockTouches = (pNextBlock == pBlock->next);
+        #endif
+
+        if (!bNextBlockTouches) {
+            I_Error("Z_CheckHeap: block size does not touch the next block\n");
+        }
+
+        if (pBlock->next->prev != pBlock) {
+            I_Error("Z_CheckHeap: next block doesn't have proper back link\n");
+        }
+    }
+
+    if (bytesFree != zone.bytesFree) {
+        I_Error("Z_CheckHeap: free byte count is incorrect\n");
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Binned allocator version: update the tags for a given block of memory, moving it to the appropriate tag list.
+// Note: assumes the block is in the main memory zone, since there is no zone parameter for this function.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void Z_ChangeTag(void* const ptr, const int16_t tagBits) noexcept {
+    memblock_t& block = ((memblock_t*) ptr)[-1];
+
+    if (block.id != ZONEID) {
+        I_Error("Z_ChangeTag: freed a pointer without ZONEID");
+    }
+
+    if (tagBits >= PU_PURGELEVEL) {
+        if (block.user < (void*) 0x100) {
+            I_Error("Z_ChangeTag: an owner is required for purgable blocks");
+        }
+    }
+
+    Z_RemoveFromTagList(*gpMainMemZone, block);
+    block.tag = (int16_t) tagBits;
+    Z_AddToTagList(*gpMainMemZone, block);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Binned allocator version: returns the number of free bytes in the given memory zone
+//------------------------------------------------------------------------------------------------------------------------------------------
+int32_t Z_FreeMemory(memzone_t& zone) noexcept {
+    return zone.bytesFree;
+}
+#endif  // #if PSYDOOM_ZONE_BINNED_ALLOC
@@ -18,6 +18,17 @@ static constexpr int16_t PU_CACHE       = 0x20;     // Used to temporarily cache
 // All blocks must have this id
 static constexpr int16_t ZONEID = 0x1D4A;
 
+#if PSYDOOM_ZONE_BINNED_ALLOC
+    // PsyDoom binned allocator: how many size class bins there are for free blocks, and how many bins each power of two size is split into
+    static constexpr int32_t ZONE_BINS_PER_POW2_LOG2 = 2;
+    static constexpr int32_t ZONE_BINS_PER_POW2 = 1 << ZONE_BINS_PER_POW2_LOG2;
+    static constexpr int32_t NUM_ZONE_BINS = 32 * ZONE_BINS_PER_POW2;
+
+    // PsyDoom binned allocator: how many lists of used blocks there are.
+    // Each single bit tag (PU_STATIC to PU_CACHE) gets its own list and the last list is for all other tag values.
+    static constexpr int32_t NUM_ZONE_TAG_LISTS = 7;
+#endif
+
 // Holds details on a block of memory
 struct memblock_t {
     int32_t         size;           // Including the header and possibly tiny fragments
@@ -27,12 +38,68 @@ struct memblock_t {
     int32_t         lockframe;      // Don't purge on this frame
     memblock_t*     next;
     memblock_t*     prev;
+
+    // PsyDoom binned allocator: links for the size class bin (free blocks) or tag list (used blocks) that this block belongs to
+    #if PSYDOOM_ZONE_BINNED_ALLOC
+        memblock_t*     listNext;
+        memblock_t*     listPrev;
+    #endif
 };
 
+#if PSYDOOM_MODS
+// PsyDoom: counters for a memory zone, useful for measuring how much work the allocator is doing
+struct zonestats_t {
+    uint32_t    numMallocs;             // Number of blocks allocated
+    uint32_t    numFrees;               // Number of blocks freed (explicitly, via 'Z_FreeTags' or by purging)
+    uint32_t    numPurges;              // Number of purgable blocks which were evicted to make room for an allocation
+    uint32_t    numCachePurges;         // How many of the purged blocks were 'PU_CACHE' blocks
+    uint32_t    numFreeTagsCalls;       // Number of calls to 'Z_FreeTags'
+    uint64_t    numBlocksVisited;       // Number of blocks examined while allocating or freeing by tag: a measure of the work done
+    uint32_t    numChunksAdded;         // Limit removing: number of extra chunks of memory the zone was grown by
+    uint32_t    numChunksReleased;      // Limit removing: number of extra chunks of memory released after becoming completely free
+};
+
+// PsyDoom: how many tag categories heap statistics are gathered for.
+// Each single bit tag (PU_STATIC to PU_CACHE) gets its own category and the last category is for all other tag values.
+static constexpr int32_t NUM_ZONE_STATS_TAGS = 7;
+
+// PsyDoom: a snapshot of how the memory in a zone is being used, as computed by 'Z_GetHeapStats'.
+// All sizes include the headers of the memory blocks.
+struct zoneheapstats_t {
+    int32_t     totalBytes;                             // Total size of the zone
+    int32_t     usedBytes[NUM_ZONE_STATS_TAGS];         // Bytes in use by blocks in each tag category
+    int32_t     numUsedBlocks[NUM_ZONE_STATS_TAGS];     // Number of used blocks in each tag category
+    int32_t     freeBytes;                              // Total size of all free blocks
+    int32_t     numFreeBlocks;                          // Number of free blocks
+    int32_t     largestFreeBlock;                       // Size of the largest free block: the biggest allocation possible without purging
+    float       fragmentation;                          // '1 - largestFreeBlock / freeBytes': '0' if all free memory is in one block
+};
+#endif
+
 // Info for a memory allocation zone
 struct memzone_t {
     int32_t         size;           // Total bytes malloced, including header
     memblock_t*     rover;
+
+    #if PSYDOOM_MODS
+        zonestats_t     stats;
+    #endif
+
+    // PsyDoom limit removing: the zone can grow on demand by adding extra chunks of memory, which are released again once entirely free
+    #if PSYDOOM_LIMIT_REMOVING
+        int32_t         growChunkSize;      // The zone grows in multiples of this many bytes, or can't grow at all if '0'
+        int32_t         peakSize;           // High-water mark: the biggest the zone has ever been (in bytes, including header)
+    #endif
+
+    // PsyDoom binned allocator: free blocks in each size class, used blocks for each tag list and other book-keeping
+    #if PSYDOOM_ZONE_BINNED_ALLOC
+        int32_t         bytesFree;                              // Total size of all free blocks in the zone
+        memblock_t*     pLastBlock;                             // The block at the very end of the heap
+        memblock_t*     freeBins[NUM_ZONE_BINS];                // Head of the free list for each size class
+        memblock_t*     tagListHeads[NUM_ZONE_TAG_LISTS];       // Head of each tag list (the oldest block)
+        memblock_t*     tagListTails[NUM_ZONE_TAG_LISTS];       // Tail of each tag list (the newest block)
+    #endif
+
     memblock_t      blocklist;      // Start / end cap for linked list
 };
 
@@ -50,6 +117,9 @@ void Z_ChangeTag(void* const ptr, const int16_t tagBits) noexcept;
 #if PSYDOOM_MODS
     void Z_SetUser(void* const ptr, void** const ppUser) noexcept;
     void* Z_ZeroedMalloc(memzone_t& zone, const int32_t size, const int16_t tag, void** const ppUser) noexcept;
+    int32_t Z_GetHeapStatsTagIdx(const int16_t tag) noexcept;
+    const char* Z_GetHeapStatsTagName(const int32_t tagIdx) noexcept;
+    void Z_GetHeapStats(const memzone_t& zone, zoneheapstats_t& stats) noexcept;
 #endif
 
 int32_t Z_FreeMemory(memzone_t& zone) noexcept;
@@ -99,7 +99,16 @@ static constexpr int16_t MTF_BLEND_MODE_BIT2    = 0x80;     // PSX DOOM: 1 of 2
 
 // If this flag is set for a BSP node child in a wad then it means the child is a subsector.
 // This flag should be removed when retrieving the actual subsector number.
-static constexpr uint32_t NF_SUBSECTOR = 0x8000;
+//
+// PsyDoom limit removing: at runtime ('node_t') the flag is moved to the top bit of the 32-bit child number, so that maps in the extended
+// map format can have more than 32,768 nodes or subsectors. 'MAPNF_SUBSECTOR' is the flag used by normal format WADs in that case.
+#if PSYDOOM_LIMIT_REMOVING
+    static constexpr uint32_t MAPNF_SUBSECTOR = 0x8000;
+    static constexpr uint32_t MAPNF_SUBSECTOR_EXT = 0x80000000;     // Same flag but for the extended map format
+    static constexpr uint32_t NF_SUBSECTOR = MAPNF_SUBSECTOR_EXT;
+#else
+    static constexpr uint32_t NF_SUBSECTOR = 0x8000;
+#endif
 
 // Header for a block of memory in a memory blocks file.
 // The data for the block immediately follows this header in the blocks file.
@@ -267,6 +276,66 @@ struct mapleafedge_t {
 
 static_assert(sizeof(mapleafedge_t) == 4);
 
+#if PSYDOOM_LIMIT_REMOVING
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom limit removing: structures for the extended map format.
+//
+// The extended format is used by map WADs which contain an (empty) 'EXTMAP32' marker lump. It widens all indices referring to other
+// map data to 32-bits, so that levels with more than 32,768 vertices, lines, sides, segs, subsectors or nodes are possible.
+// Only the 'LINEDEFS', 'SSECTORS', 'NODES', 'SEGS' and 'LEAFS' lumps change format; all other lumps are the same as normal.
+// Leafs keep the same 'mapleaf_t' header but use the wider 'mapleafedge_ext_t' for their edges.
+//------------------------------------------------------------------------------------------------------------------------------------------
+struct maplinedef_ext_t {
+    int32_t     vertex1;        // Index of the 1st vertex in the line
+    int32_t     vertex2;        // Index of the 2nd vertex in the line
+    int16_t     flags;          // A combination of 'ML_XXX' line flags
+    int16_t     special;        // Line special action (switch, trigger etc.)
+    int16_t     tag;            // Target for the line special action (if applicable)
+    int16_t     _padding;       // Unused, should be '0'
+    int32_t     sidenum[2];     // If -1 then the line is 1 sided
+};
+
+static_assert(sizeof(maplinedef_ext_t) == 24);
+
+struct mapsubsector_ext_t {
+    int32_t     numsegs;        // How many segs this subsector has
+    int32_t     firstseg;       // Index of the first seg this subsector has (all are stored sequentially)
+};
+
+static_assert(sizeof(mapsubsector_ext_t) == 8);
+
+// Note: this is a compact encoding which keeps the 16-bit integer coordinates of 'mapnode_t', only the child numbers are widened
+struct mapnode_ext_t {
+    int16_t     x;              // The partition line: 1st point in integer coords (x & y)
+    int16_t     y;
+    int16_t     dx;             // The partition line: vector from the 1st point to the end point in integer coords (x & y)
+    int16_t     dy;
+    int16_t     bbox[2][4];     // Bounding box for both child nodes
+    uint32_t    children[2];    // When 'MAPNF_SUBSECTOR_EXT' is set then it means it's a subsector number
+};
+
+static_assert(sizeof(mapnode_ext_t) == 32);
+
+struct mapseg_ext_t {
+    int32_t     vertex1;        // Index of the 1st vertex in the line segment
+    int32_t     vertex2;        // Index of the 2nd vertex in the line segment
+    int32_t     linedef;        // Index of the line that the segment belongs to
+    int16_t     angle;          // Precomputed angle for the line segment direction
+    int16_t     side;           // '0' or '1': which side of the line the seg is on. Always '0' for one sided lines.
+    int16_t     offset;         // Horizontal offset for the line segment's texture
+    int16_t     _padding;       // Unused, should be '0'
+};
+
+static_assert(sizeof(mapseg_ext_t) == 20);
+
+struct mapleafedge_ext_t {
+    int32_t     vertexnum;      // 1st vertex in the edge; 2nd vertex is found in the following leaf edge
+    int32_t     segnum;         // Index of the seg the leaf edge belongs to, or '-1' if none
+};
+
+static_assert(sizeof(mapleafedge_ext_t) == 8);
+#endif  // #if PSYDOOM_LIMIT_REMOVING
+
 // Describes the type, position, angle and flags of a thing in a WAD
 struct mapthing_t {
     int16_t     x;          // Integer position: x
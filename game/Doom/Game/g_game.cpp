@@ -31,9 +31,12 @@
 #include "PsyDoom/Game.h"
 #include "PsyDoom/Input.h"
 #include "PsyDoom/MapInfo/MapInfo.h"
+#include "PsyDoom/Overlay/AchievementMgr.h"
 #include "PsyDoom/ProgArgs.h"
+#include "PsyDoom/RewindBuffer.h"
 #include "PsyDoom/SaveAndLoad.h"
 #include "PsyDoom/Utils.h"
+#include "PsyDoom/ZoneStats.h"
 #include "Wess/wessapi.h"
 
 // Helper global holding the result of executing a gameloop via 'MiniLoop'.
@@ -148,6 +151,11 @@ void G_DoLoadLevel() noexcept {
     P_SetupLevel(gGameMap, gGameSkill);
     Z_CheckHeap(*gpMainMemZone);
 
+    // PsyDoom: any rewind history is for the previous map
+    #if PSYDOOM_MODS
+        RewindBuffer::clear();
+    #endif
+
     // No action set upon starting a level
     gGameAction = ga_nothing;
 
@@ -406,9 +414,10 @@ void G_DoReborn(const int32_t playerIdx) noexcept {
 void G_CompleteLevel() noexcept {
     gGameAction = ga_completed;
 
-    // PsyDoom: mark the level as done
+    // PsyDoom: mark the level as done and let achievements know
     #if PSYDOOM_MODS
         gbDidCompleteLevel = true;
+        AchievementManager::Get().RaiseEvent(AchievementEventType::LevelExit, gGameMap);
     #endif
 }
 
@@ -495,11 +504,13 @@ void G_InitNew(const skill_t skill, const int32_t mapNum, const gametype_t gameT
         }
     #endif
 
-    // Clear the empty map object and assign to both players initially.
+    // Clear the empty map object and assign to all players initially.
     // This is used for network consistency checks:
     D_memset(&gEmptyMobj, std::byte(0), sizeof(mobj_t));
-    gPlayers[0].mo = &gEmptyMobj;
-    gPlayers[1].mo = &gEmptyMobj;
+
+    for (player_t& player : gPlayers) {
+        player.mo = &gEmptyMobj;
+    }
 
     // Set some player status flags and controls stuff
     gbPlayerInGame[0] = true;
@@ -565,17 +576,25 @@ void G_RunGame() noexcept {
 
         #if PSYDOOM_MODS
             if (gGameAction != ga_restart) {
-                if (ProgArgs::gbRecordDemos && (!bLoadedSaveGame)) {
+                // When recording multi-map demos the current demo continues on this map, unless a save was loaded
+                if (DemoRecorder::isRecording()) {
+                    if (bLoadedSaveGame) {
+                        DemoRecorder::end();
+                    } else {
+                        DemoRecorder::beginNextMap();
+                    }
+                }
+                else if (ProgArgs::gbRecordDemos && (!bLoadedSaveGame)) {
                     DemoRecorder::begin();
-                    gbDemoRecording = true;
                     gStatusBar.message = "Recording started.";
                     gStatusBar.messageTicsLeft = 30;
                 }
 
+                gbDemoRecording = DemoRecorder::isRecording();
                 MiniLoop(P_Start, P_Stop, P_Ticker, P_Drawer);
                 gbDemoRecording = false;
 
-                if (DemoRecorder::isRecording()) {
+                if (DemoRecorder::isRecording() && (!ProgArgs::gbRecordMultiMapDemos)) {
                     DemoRecorder::end();
                 }
             }
@@ -587,6 +606,11 @@ void G_RunGame() noexcept {
             MiniLoop(P_Start, P_Stop, P_Ticker, P_Drawer);
         #endif
 
+        // PsyDoom: record main memory heap statistics for the level just ended, while level data is still in memory (if enabled)
+        #if PSYDOOM_MODS
+            ZoneStats::onLevelExit();
+        #endif
+
         // PsyDoom: if app quit was requested then exit immediately
         if (Input::isQuitRequested())
             break;
@@ -615,8 +639,11 @@ void G_RunGame() noexcept {
         // Cleanup after the level is done.
         // Texture cache: unlock everything except UI assets and other reserved areas of VRAM.
         // In limit removing mode also ensure we are using tight packing of VRAM.
+        //
+        // PsyDoom limit removing: wall and floor textures are kept locked through the intermission and finale, since the next map will
+        // often use many of the same textures. When the next map loads only the textures it doesn't reference are evicted.
+        // If the game is being exited instead then everything is unlocked (see below).
         #if PSYDOOM_LIMIT_REMOVING
-            I_LockAllWallAndFloorTextures(false);
             I_TexCacheUseLoosePacking(false);
         #else
             I_UnlockAllTexCachePages();
@@ -697,6 +724,11 @@ void G_RunGame() noexcept {
         const bool bSkipFinale = (pCluster) ? pCluster->bSkipFinale : true;
 
         if (!bSkipFinale) {
+            // PsyDoom limit removing: free up VRAM for the finale since the next map (if any) is usually in a different episode
+            #if PSYDOOM_LIMIT_REMOVING
+                I_LockAllWallAndFloorTextures(false);
+            #endif
+
             const bool bDoFinaleWithCast = (pCluster) ? pCluster->bEnableCast : false;
 
             if (bDoFinaleWithCast) {
@@ -729,6 +761,18 @@ void G_RunGame() noexcept {
             gGameMap = gNextMap;
         }
     }
+
+    // PsyDoom: end the multi-map demo being recorded (if any) now that the game is over
+    #if PSYDOOM_MODS
+        if (DemoRecorder::isRecording()) {
+            DemoRecorder::end();
+        }
+    #endif
+
+    // PsyDoom limit removing: no longer need to keep the textures for the last map played resident
+    #if PSYDOOM_LIMIT_REMOVING
+        I_LockAllWallAndFloorTextures(false);
+    #endif
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -765,8 +809,38 @@ gameaction_t G_PlayDemoPtr() noexcept {
         return G_AbortDemoPlayback();
     }
 
-    // Run the demo
-    const gameaction_t exitAction = MiniLoop(P_Start, P_Stop, P_Ticker, P_Drawer);
+    // Run the demo, going onto the next map each time the demo continues on another map (multi-map demos).
+    // Note that intermissions and finales are skipped between maps, since the demo contains no inputs for those.
+    gameaction_t exitAction = MiniLoop(P_Start, P_Stop, P_Ticker, P_Drawer);
+
+    while (DemoPlayer::isAtMapChange() && (!Input::isQuitRequested())) {
+        // Cleanup after the previous map the same way 'G_RunGame' does
+        #if PSYDOOM_LIMIT_REMOVING
+            I_TexCacheUseLoosePacking(false);
+        #else
+            I_UnlockAllTexCachePages();
+            I_LockTexCachePage(0);
+        #endif
+
+        Z_FreeTags(*gpMainMemZone, PU_ANIMATION);
+
+        // Load the next map and continue playback
+        if (!DemoPlayer::onBeforeNextMapLoad()) {
+            exitAction = ga_exit;
+            break;
+        }
+
+        G_DoLoadLevel();
+
+        if (!DemoPlayer::onAfterNextMapLoad()) {
+            P_Stop(ga_exit);
+            exitAction = ga_exit;
+            break;
+        }
+
+        exitAction = MiniLoop(P_Start, P_Stop, P_Ticker, P_Drawer);
+    }
+
     gbDemoPlayback = false;
 
     // Playback is now done
@@ -21,6 +21,10 @@
 
 #include <algorithm>
 
+#if PSYDOOM_MODS
+    #include <vector>
+#endif
+
 static constexpr fixed_t STOPSPEED  = 0x1000;   // Speed under which to stop a thing fully
 static constexpr fixed_t FRICTION   = 0xD200;   // Friction amount to apply (note: 0xD240 in Jaguar Doom)
 
@@ -44,26 +48,70 @@ static bool PB_CheckPosition() noexcept;
 static bool PB_BlockLinesIterator(const int32_t x, const int32_t y) noexcept;
 static bool PB_BlockThingsIterator(const int32_t x, const int32_t y) noexcept;
 
+#if PSYDOOM_MODS
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: tells if 'P_MobjThinker' would do nothing for the given map object.
+// This is the case when the thing is not moving, is resting on the floor and is in a state which lasts forever.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static inline bool PB_IsMobjIdle(const mobj_t& mobj) noexcept {
+    return (
+        ((mobj.momx | mobj.momy | mobj.momz) == 0) &&
+        (mobj.z == mobj.floorz) &&
+        (mobj.tics == -1)
+    );
+}
+#endif
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Does movement and state ticking for all map objects except players
 //------------------------------------------------------------------------------------------------------------------------------------------
 void P_RunMobjBase() noexcept {
-    gpBaseThing = gMobjHead.next;
+    #if PSYDOOM_MODS
+        // PsyDoom: do this in two passes. The first pass is a tight loop over the hot fields of every thing which clears latecalls and gathers
+        // the things which actually have work to do. The second pass then runs the full movement and collision logic for only those things, in
+        // the same order as before. This produces exactly the same results as doing everything in one pass, since whether a thing is idle only
+        // depends on its own fields - and these are only ever modified by its own thinker during this phase. Things are never added or removed
+        // from the global list here either, since that is deferred to the 'latecall' phase.
+        static std::vector<mobj_t*> activeMobjs;
+        activeMobjs.clear();
 
-    // Run through all the map objects
-    while (gpBaseThing != &gMobjHead) {
-        mobj_t& mobj = *gpBaseThing;
+        for (mobj_t* pMobj = gMobjHead.next; pMobj != &gMobjHead; pMobj = pMobj->next) {
+            mobj_t& mobj = *pMobj;
+
+            if (mobj.player)
+                continue;
 
-        // Only run the think logic if it's not the player.
-        if (!mobj.player) {
-            // Note: clear the latecall here to signify (initially) no mobj action to execute during the 'latecall' phase.
-            // The think function might set an action though, typically for a state transition or sometimes a missile explosion etc.
             mobj.latecall = nullptr;
-            P_MobjThinker(mobj);
+
+            if (!PB_IsMobjIdle(mobj)) {
+                activeMobjs.push_back(pMobj);
+            }
         }
 
-        gpBaseThing = mobj.next;
-    }
+        for (mobj_t* const pMobj : activeMobjs) {
+            gpBaseThing = pMobj;
+            P_MobjThinker(*pMobj);
+        }
+
+        gpBaseThing = &gMobjHead;
+    #else
+        gpBaseThing = gMobjHead.next;
+
+        // Run through all the map objects
+        while (gpBaseThing != &gMobjHead) {
+            mobj_t& mobj = *gpBaseThing;
+
+            // Only run the think logic if it's not the player.
+            if (!mobj.player) {
+                // Note: clear the latecall here to signify (initially) no mobj action to execute during the 'latecall' phase.
+                // The think function might set an action though, typically for a state transition or sometimes a missile explosion etc.
+                mobj.latecall = nullptr;
+                P_MobjThinker(mobj);
+            }
+
+            gpBaseThing = mobj.next;
+        }
+    #endif
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -373,6 +421,11 @@ static bool PB_TryMove(const fixed_t tryX, const fixed_t tryY) noexcept {
 // Very similar to 'P_UnsetThingPosition' except the thing is always unlinked from sectors and thing flags are read from a global.
 //------------------------------------------------------------------------------------------------------------------------------------------
 static void PB_UnsetThingPosition(mobj_t& thing) noexcept {
+    // PsyDoom: unlink the thing from the sectors that it touches
+    #if PSYDOOM_MODS
+        P_UnlinkTouchingSectors(thing);
+    #endif
+
     // Remove the thing from sector thing lists
     if (thing.snext) {
         thing.snext->sprev = thing.sprev;
@@ -386,6 +439,11 @@ static void PB_UnsetThingPosition(mobj_t& thing) noexcept {
 
     // Remove the thing from the blockmap, if it is added to the blockmap
     if ((gTestFlags & MF_NOBLOCKMAP) == 0) {
+        // PsyDoom: remove the thing from the packed list of things for the blockmap cell too
+        #if PSYDOOM_MODS
+            P_RemoveBlockThing(thing);
+        #endif
+
         if (thing.bnext) {
             thing.bnext->bprev = thing.bprev;
         }
@@ -452,12 +510,22 @@ static void PB_SetThingPosition(mobj_t& mobj) noexcept {
             }
 
             blockmapList = &mobj;
+
+            // PsyDoom: add the thing to the packed list of things for the blockmap cell too
+            #if PSYDOOM_MODS
+                P_AddBlockThing(mobj, bmapX + bmapY * gBlockmapWidth);
+            #endif
         } else {
             // Thing is outside the blockmap
             mobj.bprev = nullptr;
             mobj.bnext = nullptr;
         }
     }
+
+    // PsyDoom: link the thing to the sectors that it touches
+    #if PSYDOOM_MODS
+        P_LinkTouchingSectors(mobj);
+    #endif
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -721,25 +789,59 @@ static bool PB_CheckThing(mobj_t& mobj) noexcept {
 // Returns 'false' if there is a definite collision, 'true' otherwise.
 //------------------------------------------------------------------------------------------------------------------------------------------
 static bool PB_BlockLinesIterator(const int32_t x, const int32_t y) noexcept {
-    // Get the line list for this blockmap cell
-    const int16_t* pLineNum = (int16_t*)(gpBlockmapLump + gpBlockmap[y * gBlockmapWidth + x]);
+    // PsyDoom: use the packed line lists to skip lines with bounding boxes outside the test box, without touching the lines.
+    // These lines would be rejected by 'PB_BoxCrossLine' anyway, no matter how many times they are tested.
+    #if PSYDOOM_MODS
+        const blocklines_t& blockLines = gBlockLines;
+        const int32_t cellIdx = y * gBlockmapWidth + x;
+        const uint32_t endIdx = blockLines.cellStart[cellIdx + 1];
 
-    // Visit all lines in the cell, checking for intersection and potential collision.
-    // Stop when there is a definite collision.
-    line_t* const pLines = gpLines;
+        const fixed_t testTop = gTestBBox[BOXTOP];
+        const fixed_t testBottom = gTestBBox[BOXBOTTOM];
+        const fixed_t testLeft = gTestBBox[BOXLEFT];
+        const fixed_t testRight = gTestBBox[BOXRIGHT];
 
-    for (; *pLineNum != -1; ++pLineNum) {
-        line_t& line = pLines[*pLineNum];
+        for (uint32_t i = blockLines.cellStart[cellIdx]; i < endIdx; ++i) {
+            const bool bTestBBOutsideLineBB = (
+                (testTop <= blockLines.bboxBottom[i]) ||
+                (testBottom >= blockLines.bboxTop[i]) ||
+                (testLeft >= blockLines.bboxRight[i]) ||
+                (testRight <= blockLines.bboxLeft[i])
+            );
 
-        // Only check the line if not already checked this test
-        if (line.validcount != gValidCount) {
-            line.validcount = gValidCount;
+            if (bTestBBOutsideLineBB)
+                continue;
 
-            // If it's collided with and definitely blocking then stop
-            if (PB_BoxCrossLine(line) && (!PB_CheckLine(line)))
-                return false;
+            line_t& line = gpLines[blockLines.lineNum[i]];
+
+            if (line.validcount != gValidCount) {
+                line.validcount = gValidCount;
+
+                if (PB_BoxCrossLine(line) && (!PB_CheckLine(line)))
+                    return false;
+            }
         }
-    }
+    #else
+        // Get the line list for this blockmap cell
+        const int16_t* pLineNum = (int16_t*)(gpBlockmapLump + gpBlockmap[y * gBlockmapWidth + x]);
+
+        // Visit all lines in the cell, checking for intersection and potential collision.
+        // Stop when there is a definite collision.
+        line_t* const pLines = gpLines;
+
+        for (; *pLineNum != -1; ++pLineNum) {
+            line_t& line = pLines[*pLineNum];
+
+            // Only check the line if not already checked this test
+            if (line.validcount != gValidCount) {
+                line.validcount = gValidCount;
+
+                // If it's collided with and definitely blocking then stop
+                if (PB_BoxCrossLine(line) && (!PB_CheckLine(line)))
+                    return false;
+            }
+        }
+    #endif
 
     return true;
 }
@@ -749,14 +851,28 @@ static bool PB_BlockLinesIterator(const int32_t x, const int32_t y) noexcept {
 // Stops when a collision is detected and returns 'false', otherwise returns 'true' for no collision.
 //------------------------------------------------------------------------------------------------------------------------------------------
 static bool PB_BlockThingsIterator(const int32_t x, const int32_t y) noexcept {
-    mobj_t* pmobj = gppBlockLinks[x + y * gBlockmapWidth];
+    // PsyDoom: use the packed list of things for the cell to skip things which are definitely out of range without touching them.
+    // 'PB_CheckThing' does nothing for those things, and it never links or unlinks things so it is safe to iterate the list here.
+    #if PSYDOOM_MODS
+        const std::vector<blockthing_t>& blockThings = P_GetBlockThings(x, y);
+        const fixed_t baseThingRadius = gpBaseThing->radius;
 
-    while (pmobj) {
-        if (!PB_CheckThing(*pmobj))
-            return false;
+        for (size_t i = blockThings.size(); i > 0; --i) {
+            const blockthing_t& thing = blockThings[i - 1];
 
-        pmobj = pmobj->bnext;
-    }
+            if (P_IsBlockThingInRange(thing, gTestX, gTestY, baseThingRadius) && (!PB_CheckThing(*thing.pMobj)))
+                return false;
+        }
+    #else
+        mobj_t* pmobj = gppBlockLinks[x + y * gBlockmapWidth];
+
+        while (pmobj) {
+            if (!PB_CheckThing(*pmobj))
+                return false;
+
+            pmobj = pmobj->bnext;
+        }
+    #endif
 
     return true;
 }
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "Doom/Base/i_main.h"
+#include "Doom/Renderer/r_local.h"
+#include "p_setup.h"
+#include "p_shoot.h"
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: a BSP tree traversal shared by sight checking and shooting (hitscan and autoaim), which were originally separate copies of the
+// same code. Visits the subsectors in the given BSP tree half-space which the line from the given start point to the end point may pass
+// through, in front to back order starting from the start point. The visitor is called for each subsector and returns 'false' to stop the
+// traversal early, in which case this function also returns 'false'. Returns 'true' if all relevant subsectors were visited.
+//
+// The traversal itself holds no state outside of its parameters, so it is re-entrant and may be used from multiple threads at once
+// (provided the visitor is also safe to use in that way). Templating on the visitor allows the per subsector logic to be inlined.
+//------------------------------------------------------------------------------------------------------------------------------------------
+template <class SubsecVisitorT>
+static inline bool P_TraceBSPNode(
+    const int32_t nodeNum,
+    const fixed_t startX,
+    const fixed_t startY,
+    const fixed_t endX,
+    const fixed_t endY,
+    const SubsecVisitorT& visitor
+) noexcept {
+    // Is this bsp node actually a subsector? (leaf node) If so then visit that:
+    if (nodeNum & NF_SUBSECTOR) {
+        const int32_t subsecNum = nodeNum & (~NF_SUBSECTOR);
+
+        if (subsecNum < gNumSubsectors) {
+            return visitor(gpSubsectors[subsecNum]);
+        } else {
+            I_Error("P_TraceBSPNode: ss %i with numss = %i", subsecNum, gNumSubsectors);    // Bad subsector number!
+            return false;
+        }
+    }
+
+    // See what side of the bsp split the start point is on: will visit that half-space first
+    const node_t& bspNode = gpBspNodes[nodeNum];
+    const int32_t sideNum = PA_DivlineSide(startX, startY, bspNode.line);
+
+    if (!P_TraceBSPNode(bspNode.children[sideNum], startX, startY, endX, endY, visitor))
+        return false;
+
+    // If the end point is in the same half-space we just visited then we are done
+    if (sideNum == PA_DivlineSide(endX, endY, bspNode.line))
+        return true;
+
+    // Failing that visit the opposite side of the BSP split
+    return P_TraceBSPNode(bspNode.children[sideNum ^ 1], startX, startY, endX, endY, visitor);
+}
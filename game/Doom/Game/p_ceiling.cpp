@@ -10,6 +10,7 @@
 #include "p_spec.h"
 #include "p_tick.h"
 #include "PsyDoom/ScriptingEngine.h"
+#include "PsyDoom/ThinkerPool.h"
 
 #include <cmath>
 
@@ -293,7 +294,11 @@ bool EV_DoCeiling(line_t& line, const ceiling_e ceilingType) noexcept {
 
         // Create the door thinker, link to it's sector and populate its state/settings
         bActivatedACeiling = true;
-        ceiling_t& ceiling = *(ceiling_t*) Z_Malloc(*gpMainMemZone, sizeof(ceiling_t), PU_LEVSPEC, nullptr);
+        #if PSYDOOM_MODS
+            ceiling_t& ceiling = ThinkerPool::alloc<ceiling_t>(PU_LEVSPEC);
+        #else
+            ceiling_t& ceiling = *(ceiling_t*) Z_Malloc(*gpMainMemZone, sizeof(ceiling_t), PU_LEVSPEC, nullptr);
+        #endif
 
         #if PSYDOOM_MODS
             ceiling = {};   // PsyDoom: zero-init all fields, including ones unused by this function
@@ -364,7 +369,11 @@ bool EV_DoCustomCeiling(sector_t& sector, const CustomCeilingDef& ceilDef) noexc
         return false;
 
     // Alloc the crusher, zero-init and set it up as a thinker for the sector
-    ceiling_t& ceiling = *(ceiling_t*) Z_Malloc(*gpMainMemZone, sizeof(ceiling_t), PU_LEVSPEC, nullptr);
+    #if PSYDOOM_MODS
+        ceiling_t& ceiling = ThinkerPool::alloc<ceiling_t>(PU_LEVSPEC);
+    #else
+        ceiling_t& ceiling = *(ceiling_t*) Z_Malloc(*gpMainMemZone, sizeof(ceiling_t), PU_LEVSPEC, nullptr);
+    #endif
     ceiling = {};
     P_AddThinker(ceiling.thinker);
     sector.specialdata = &ceiling;
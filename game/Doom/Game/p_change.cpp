@@ -9,11 +9,13 @@
 #include "Doom/UI/st_main.h"
 #include "g_game.h"
 #include "info.h"
+#include "p_flowfield.h"
 #include "p_inter.h"
 #include "p_map.h"
 #include "p_maputl.h"
 #include "p_mobj.h"
 #include "p_move.h"
+#include "p_pspr.h"
 #include "PsyDoom/Config/Config.h"
 #include "PsyDoom/Game.h"
 
@@ -176,10 +178,26 @@ bool P_ChangeSector(sector_t& sector, const bool bCrunch) noexcept {
         gPlayers[i].lastsoundsector = nullptr;
     }
 
+    // PsyDoom: doors opening or closing may change how sound propagates (invalidating cached noise alert results) and where monsters can walk
+    #if PSYDOOM_MODS
+        P_UpdateSectorSoundPropagation(sector);
+        P_UpdateSectorFlowFields(sector);
+    #endif
+
     // Initially everything fits in the sector and save whether to crush for the blockmap iterator
     gbNofit = false;
     gbCrushChange = bCrunch;
 
+    // PsyDoom: if allowed by the game settings then only visit the things which are actually touching the sector.
+    // This is much faster than the original blockmap search but visits things in a different order, and skips things which are nearby but not
+    // touching the sector. Since that can affect gameplay it can't be used for classic demos, or for demos recorded before it was introduced.
+    #if PSYDOOM_MODS
+        if (Game::gSettings.bUseTouchingThingLists) {
+            P_SectorTouchingThingsIterator(sector, PIT_ChangeSector);
+            return gbNofit;
+        }
+    #endif
+
     // Clip the heights of all things in the updated sector and crush things where appropriate.
     // Note that this crude test may pull in things in other sectors, which could be included in the results also. Generally that's okay however!
     const int32_t bmapLx = sector.blockbox[BOXLEFT];
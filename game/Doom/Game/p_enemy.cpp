@@ -12,6 +12,7 @@
 #include "info.h"
 #include "p_doors.h"
 #include "p_floor.h"
+#include "p_flowfield.h"
 #include "p_inter.h"
 #include "p_local.h"
 #include "p_map.h"
@@ -37,6 +38,10 @@ static constexpr angle_t TRACEANGLE = 0xC000000;        // How much Revenant mis
 static constexpr angle_t FATSPREAD  = ANG90 / 8;        // Angle adjustment increment for the Mancubus when attacking; varies it's shoot direction in multiples of this constant
 static constexpr fixed_t SKULLSPEED = 40 * FRACUNIT;    // Speed that lost souls fly at
 
+#if PSYDOOM_MODS
+    static constexpr int32_t MONSTER_AI_LOD_INTERVAL = 4;   // PsyDoom: monster AI LOD - dormant monsters do their chase and look logic once for every this many updates
+#endif
+
 // Monster movement speed multiplier for the 8 movement directions: x & y
 constexpr static fixed_t gMoveXSpeed[8] = { FRACUNIT, 47000, 0, -47000, -FRACUNIT, -47000, 0, 47000 };
 constexpr static fixed_t gMoveYSpeed[8] = { 0, 47000, FRACUNIT, 47000, 0, -47000, -FRACUNIT, -47000 };
@@ -193,17 +198,16 @@ bool P_CheckMissileRange(mobj_t& attacker) noexcept {
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Try to move the specified actor in it's current movement direction.
+// Try to move the specified actor in it's current movement direction by the given (integer) amount.
 // For floating monsters also attempt to do up/down movement if appropriate, and if a move is blocked try to open doors.
 // Returns 'true' if the move was considered a success.
 //------------------------------------------------------------------------------------------------------------------------------------------
-bool P_Move(mobj_t& actor) noexcept {
+static bool P_MoveBy(mobj_t& actor, const int32_t moveSpeed) noexcept {
     // Move is unsuccessful if there is no direction
     if (actor.movedir == DI_NODIR)
         return false;
 
     // Decide on where the actor will move to and try to move there
-    const fixed_t moveSpeed = actor.info->speed;
     const fixed_t tryX = actor.x + moveSpeed * gMoveXSpeed[actor.movedir];
     const fixed_t tryY = actor.y + moveSpeed * gMoveYSpeed[actor.movedir];
 
@@ -275,6 +279,43 @@ bool P_Move(mobj_t& actor) noexcept {
     return false;
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Try to move the specified actor in it's current movement direction, at the speed defined for it's type.
+// Returns 'true' if the move was considered a success.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool P_Move(mobj_t& actor) noexcept {
+    return P_MoveBy(actor, actor.info->speed);
+}
+
+#if PSYDOOM_MODS
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: monster AI LOD - does the movement for several 'P_Move' calls in one go, for a dormant monster catching up on deferred updates.
+// The total distance is split into substeps no bigger than the actor's radius, so thin walls and other things can't be skipped over.
+// Returns 'false' if the move was blocked, in which case any remaining movement is abandoned.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool P_MoveMultiple(mobj_t& actor, const int32_t numMoves) noexcept {
+    if (numMoves <= 1)
+        return P_Move(actor);
+
+    const int32_t totalDist = actor.info->speed * numMoves;
+    const int32_t maxSubstepDist = std::max(d_fixed_to_int(actor.radius), 1);
+    const int32_t numSubsteps = (totalDist + maxSubstepDist - 1) / maxSubstepDist;
+
+    for (int32_t substepIdx = 0; substepIdx < numSubsteps; ++substepIdx) {
+        const int32_t substepDist = (totalDist * (substepIdx + 1)) / numSubsteps - (totalDist * substepIdx) / numSubsteps;
+
+        if (!P_MoveBy(actor, substepDist))
+            return false;
+
+        // If the move only 'succeeded' by floating up or down or by using a door then the actor didn't actually go anywhere: stop here
+        if ((actor.flags & MF_INFLOAT) || (actor.movedir == DI_NODIR))
+            break;
+    }
+
+    return true;
+}
+#endif  // #if PSYDOOM_MODS
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Try to move the specified actor in it's current movement direction.
 // For floating monsters also attempt to do up/down movement if appropriate, and if a move is blocked try to open doors.
@@ -301,6 +342,21 @@ void P_NewChaseDir(mobj_t& actor) noexcept {
         return;
     }
 
+    // PsyDoom: monsters using flow field pathing try the direction suggested by the target player's flow field first.
+    // Usually this succeeds, in which case only one trial move is needed. Otherwise fall back to the normal logic below.
+    #if PSYDOOM_MODS
+        if ((actor.flags & MF_FLOWFIELD) && (gExtCameraTicsLeft <= 0)) {
+            const dirtype_t flowDir = P_GetFlowFieldDir(actor, *pTarget);
+
+            if (flowDir != DI_NODIR) {
+                actor.movedir = flowDir;
+
+                if (P_TryWalk(actor))
+                    return;
+            }
+        }
+    #endif
+
     // Save the current movement direction and it's opposite for comparisons
     const dirtype_t oldMoveDir = actor.movedir;
     const dirtype_t turnaroundDir = gOppositeDir[oldMoveDir];
@@ -474,10 +530,83 @@ bool P_LookForPlayers(mobj_t& actor, const bool bAllAround) noexcept {
     return true;
 }
 
+#if PSYDOOM_MODS
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: monster AI LOD - tells if the given monster is dormant and can have it's AI updates done at a reduced rate.
+// A monster is dormant if it could not see it's target at the last sight check and it is further than the LOD distance from all players.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool P_IsMonsterDormant(const mobj_t& actor) noexcept {
+    const int32_t lodDist = Game::gSettings.monsterAiLodDist;
+
+    if ((lodDist <= 0) || (actor.flags & MF_SEETARGET))
+        return false;
+
+    const fixed_t lodDistFrac = d_int_to_fixed(lodDist);
+
+    for (int32_t playerIdx = 0; playerIdx < MAXPLAYERS; ++playerIdx) {
+        if (!gbPlayerInGame[playerIdx])
+            continue;
+
+        const mobj_t* const pPlayerMobj = gPlayers[playerIdx].mo;
+
+        if (pPlayerMobj && (P_AproxDistance(pPlayerMobj->x - actor.x, pPlayerMobj->y - actor.y) < lodDistFrac))
+            return false;
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: monster AI LOD - called at the start of an AI update.
+// Returns how many updates worth of work to do now, including previously deferred ones, or '0' if this update is to be deferred.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static int32_t P_BeginMonsterAiUpdate(mobj_t& actor) noexcept {
+    if (Game::gSettings.monsterAiLodDist <= 0)
+        return 1;
+
+    if ((actor.lodcount + 1 < MONSTER_AI_LOD_INTERVAL) && P_IsMonsterDormant(actor)) {
+        actor.lodcount++;
+        return 0;
+    }
+
+    const int32_t numUpdates = actor.lodcount + 1;
+    actor.lodcount = 0;
+    return numUpdates;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: monster AI LOD - tells if the sight check normally done before the monster's next state change can be skipped.
+// This is possible when the next state does a chase or look update which will be deferred because the monster is dormant.
+// For dormant monsters the 'MF_SEETARGET' flag is already clear so it will just remain that way until the next sight check.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool P_CanSkipMonsterSightCheck(const mobj_t& actor) noexcept {
+    if ((Game::gSettings.monsterAiLodDist <= 0) || (actor.lodcount + 1 >= MONSTER_AI_LOD_INTERVAL) || (!actor.state))
+        return false;
+
+    const statenum_t nextStateNum = actor.state->nextstate;
+
+    if (nextStateNum == S_NULL)
+        return false;
+
+    const statefn_mobj_t nextAction = gStates[nextStateNum].action.mobjFn;
+
+    if ((nextAction != &A_Chase) && (nextAction != &A_Look))
+        return false;
+
+    return P_IsMonsterDormant(actor);
+}
+#endif  // #if PSYDOOM_MODS
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // An enemy state that runs until the enemy has seen a player, or until a player has made noise to alert the enemy
 //------------------------------------------------------------------------------------------------------------------------------------------
 void A_Look(mobj_t& actor) noexcept {
+    // PsyDoom: monster AI LOD - count deferred updates so that dormant monsters only do sight checks every so often.
+    // The rest of the look logic is cheap so always do it, so that dormant monsters still react promptly to noise.
+    #if PSYDOOM_MODS
+        P_BeginMonsterAiUpdate(actor);
+    #endif
+
     // Unless the monster has found a target then it can't proceed to the 'see' state:
     if (!P_LookForPlayers(actor, false)) {
         // Not chasing anything currently
@@ -498,6 +627,11 @@ void A_Look(mobj_t& actor) noexcept {
         actor.target = pNoiseMaker;
     }
 
+    // PsyDoom: monster AI LOD - don't let updates deferred while looking carry over to chasing
+    #if PSYDOOM_MODS
+        actor.lodcount = 0;
+    #endif
+
     // Play the see sound for the monster
     if (actor.info->seesound != sfx_None) {
         // Vary some sounds played randomly (imps and former humans):
@@ -536,26 +670,39 @@ void A_Look(mobj_t& actor) noexcept {
 // towards the current move direction, tries to look for targets (if the current one is lost) and does active sounds among other things...
 //------------------------------------------------------------------------------------------------------------------------------------------
 void A_Chase(mobj_t& actor) noexcept {
-    // Reduce time left until attack is allowed or when a new target can be acquired
-    if (actor.reactiontime != 0) {
-        actor.reactiontime--;
-    }
+    // PsyDoom: monster AI LOD - dormant monsters only do the chase logic every so often, catching up on the deferred updates when they do.
+    // Timers, turning and movement are accumulated for all of the deferred updates, while attack and target checks are only done once.
+    #if PSYDOOM_MODS
+        const int32_t numChaseUpdates = P_BeginMonsterAiUpdate(actor);
 
-    if (actor.threshold != 0) {
-        actor.threshold--;
-    }
+        if (numChaseUpdates <= 0)
+            return;
+    #else
+        constexpr int32_t numChaseUpdates = 1;
+    #endif
+
+    for (int32_t updateIdx = 0; updateIdx < numChaseUpdates; ++updateIdx) {
+        // Reduce time left until attack is allowed or when a new target can be acquired
+        if (actor.reactiontime != 0) {
+            actor.reactiontime--;
+        }
 
-    // Turn towards the movement direction (in 45 degree increments) if required
-    if (actor.movedir < DI_NODIR) {
-        // Mask the actor angle to increments of 45 degrees and see if we need to adjust to point in the direction we want
-        actor.angle &= 0xE0000000;
-        const angle_t desiredAngle = actor.movedir * ANG45;
-        const int32_t angleDelta = (int32_t)(actor.angle - desiredAngle);   // N.B: must make signed for comparison below!
+        if (actor.threshold != 0) {
+            actor.threshold--;
+        }
 
-        if (angleDelta > 0) {
-            actor.angle -= ANG45;
-        } else if (angleDelta < 0) {
-            actor.angle += ANG45;
+        // Turn towards the movement direction (in 45 degree increments) if required
+        if (actor.movedir < DI_NODIR) {
+            // Mask the actor angle to increments of 45 degrees and see if we need to adjust to point in the direction we want
+            actor.angle &= 0xE0000000;
+            const angle_t desiredAngle = actor.movedir * ANG45;
+            const int32_t angleDelta = (int32_t)(actor.angle - desiredAngle);   // N.B: must make signed for comparison below!
+
+            if (angleDelta > 0) {
+                actor.angle -= ANG45;
+            } else if (angleDelta < 0) {
+                actor.angle += ANG45;
+            }
         }
     }
 
@@ -610,7 +757,7 @@ void A_Chase(mobj_t& actor) noexcept {
 
     // See if it's time to move in a different direction.
     // Change direction every so often, or if the monster becomes blocked:
-    actor.movecount--;
+    actor.movecount -= numChaseUpdates;
 
     #if PSYDOOM_MODS
         // PsyDoom: compatibility hack for when demos from the 'GEC Master Edition' (Beta 4 or later) are being played.
@@ -621,7 +768,13 @@ void A_Chase(mobj_t& actor) noexcept {
         }
     #endif
 
-    if ((actor.movecount < 0) || (!P_Move(actor))) {
+    #if PSYDOOM_MODS
+        const bool bNewChaseDir = ((actor.movecount < 0) || (!P_MoveMultiple(actor, numChaseUpdates)));
+    #else
+        const bool bNewChaseDir = ((actor.movecount < 0) || (!P_Move(actor)));
+    #endif
+
+    if (bNewChaseDir) {
         P_NewChaseDir(actor);
     }
 
@@ -1568,9 +1721,15 @@ void A_VileChase(mobj_t& actor) noexcept {
 
                 // Put the thing being raised into the raising state, make taller again, restore health, flags and clear target.
                 // Note: PSX Doom blending flags need to be preserved however!
+                // PsyDoom: the flow field pathing opt-in flag (which is not part of the map object's type info) must be preserved too.
                 mobjinfo_t& raiseObjInfo = *raiseMobj.info;
                 P_SetMobjState(raiseMobj, raiseObjInfo.raisestate);
-                const uint32_t flagsToPreserve = raiseMobj.flags & MF_ALL_BLEND_FLAGS;
+
+                #if PSYDOOM_MODS
+                    const uint32_t flagsToPreserve = raiseMobj.flags & (MF_ALL_BLEND_FLAGS | MF_FLOWFIELD);
+                #else
+                    const uint32_t flagsToPreserve = raiseMobj.flags & MF_ALL_BLEND_FLAGS;
+                #endif
 
                 raiseMobj.height = d_lshift<2>(raiseMobj.height);
                 raiseMobj.flags = raiseObjInfo.flags | flagsToPreserve;
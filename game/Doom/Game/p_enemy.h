@@ -8,6 +8,11 @@ bool P_Move(mobj_t& actor) noexcept;
 bool P_TryWalk(mobj_t& actor) noexcept;
 void P_NewChaseDir(mobj_t& actor) noexcept;
 bool P_LookForPlayers(mobj_t& actor, const bool bAllAround) noexcept;
+
+#if PSYDOOM_MODS
+    bool P_CanSkipMonsterSightCheck(const mobj_t& actor) noexcept;
+#endif
+
 void A_Look(mobj_t& actor) noexcept;
 void A_Chase(mobj_t& actor) noexcept;
 void A_FaceTarget(mobj_t& actor) noexcept;
@@ -15,6 +15,7 @@
 #include "PsyDoom/Config/Config.h"
 #include "PsyDoom/Game.h"
 #include "PsyDoom/ScriptingEngine.h"
+#include "PsyDoom/ThinkerPool.h"
 
 #include <algorithm>
 
@@ -310,7 +311,11 @@ bool EV_DoFloor(line_t& line, const floor_e floorType) noexcept {
 
         // Found a sector which will be affected by this floor special: create a thinker and link to the sector
         bActivatedAMover = true;
-        floormove_t& floor = *(floormove_t*) Z_Malloc(*gpMainMemZone, sizeof(floormove_t), PU_LEVSPEC, nullptr);
+        #if PSYDOOM_MODS
+            floormove_t& floor = ThinkerPool::alloc<floormove_t>(PU_LEVSPEC);
+        #else
+            floormove_t& floor = *(floormove_t*) Z_Malloc(*gpMainMemZone, sizeof(floormove_t), PU_LEVSPEC, nullptr);
+        #endif
 
         #if PSYDOOM_MODS
             floor = {};   // PsyDoom: zero-init all fields, including ones unused by this function
@@ -494,7 +499,11 @@ bool EV_BuildStairs(line_t& line, const stair_e stairType) noexcept {
 
         // Found a stairs sector which will be affected by this floor special: create a thinker for the first step and link to the sector
         bActivatedAMover = true;
-        floormove_t& firstFloor = *(floormove_t*) Z_Malloc(*gpMainMemZone, sizeof(floormove_t), PU_LEVSPEC, nullptr);
+        #if PSYDOOM_MODS
+            floormove_t& firstFloor = ThinkerPool::alloc<floormove_t>(PU_LEVSPEC);
+        #else
+            floormove_t& firstFloor = *(floormove_t*) Z_Malloc(*gpMainMemZone, sizeof(floormove_t), PU_LEVSPEC, nullptr);
+        #endif
 
         #if PSYDOOM_MODS
             firstFloor = {};   // PsyDoom: zero-init all fields, including ones unused by this function
@@ -561,7 +570,11 @@ bool EV_BuildStairs(line_t& line, const stair_e stairType) noexcept {
                     continue;
 
                 // Create a thinker for this step's floor mover, link to the sector and populate it's settings
-                floormove_t& floor = *(floormove_t*) Z_Malloc(*gpMainMemZone, sizeof(floormove_t), PU_LEVSPEC, nullptr);
+                #if PSYDOOM_MODS
+                    floormove_t& floor = ThinkerPool::alloc<floormove_t>(PU_LEVSPEC);
+                #else
+                    floormove_t& floor = *(floormove_t*) Z_Malloc(*gpMainMemZone, sizeof(floormove_t), PU_LEVSPEC, nullptr);
+                #endif
 
                 #if PSYDOOM_MODS
                     floor = {};   // PsyDoom: zero-init all fields, including ones unused by this function
@@ -604,7 +617,11 @@ bool EV_DoCustomFloor(sector_t& sector, const CustomFloorDef& floorDef) noexcept
         return false;
 
     // Allocate the floor mover, zero initialize and set as the sector thinker
-    floormove_t& floor = *(floormove_t*) Z_Malloc(*gpMainMemZone, sizeof(floormove_t), PU_LEVSPEC, nullptr);
+    #if PSYDOOM_MODS
+        floormove_t& floor = ThinkerPool::alloc<floormove_t>(PU_LEVSPEC);
+    #else
+        floormove_t& floor = *(floormove_t*) Z_Malloc(*gpMainMemZone, sizeof(floormove_t), PU_LEVSPEC, nullptr);
+    #endif
     floor = {};
     sector.specialdata = &floor;
 
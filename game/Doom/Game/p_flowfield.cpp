@@ -0,0 +1,391 @@
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: shared flow fields for monster pathing.
+//
+// For each player a field of distances (in blockmap cell steps) to the player's blockmap cell is kept, computed with a breadth first
+// search over the blockmap grid. Walking monsters which are opted into flow field pathing (via 'MF_FLOWFIELD') can then choose a chase
+// direction with a single lookup, instead of making several trial moves towards their target. This also lets them find their way around
+// walls and other obstacles which would normally leave them stuck.
+//
+// Two neighboring cells are connected if the line between the cell centers does not cross any lines that monsters can't walk across.
+// Line passability is re-evaluated as sector heights change (doors, lifts etc.) and only the cell connections around lines which changed
+// are recomputed. The distance fields are rebuilt lazily when a monster queries them, if the player or the cell connections changed.
+//------------------------------------------------------------------------------------------------------------------------------------------
+#include "p_flowfield.h"
+
+#if PSYDOOM_MODS
+
+#include "Doom/Renderer/r_local.h"
+#include "doomdata.h"
+#include "g_game.h"
+#include "info.h"
+#include "p_local.h"
+#include "p_maputl.h"
+#include "p_setup.h"
+#include "PsyDoom/Game.h"
+
+#include <algorithm>
+#include <vector>
+
+// The minimum opening height and the maximum floor step between two sectors for monsters to be regarded as able to walk between them
+static constexpr fixed_t FLOW_MIN_OPENING = 56 * FRACUNIT;
+static constexpr fixed_t FLOW_MAX_STEP = 24 * FRACUNIT;
+
+// Flow field distance for cells which the player's cell can't be reached from
+static constexpr uint16_t FLOW_DIST_UNREACHABLE = UINT16_MAX;
+
+// Blockmap cell offsets for each of the 8 movement directions
+static constexpr int32_t gFlowDirCellDx[8] = { 1, 1, 0, -1, -1, -1,  0,  1 };
+static constexpr int32_t gFlowDirCellDy[8] = { 0, 1, 1,  1,  0, -1, -1, -1 };
+
+// Distances to a player's blockmap cell, and what they were computed against
+struct flowfield_t {
+    std::vector<uint16_t>   cellDists;      // Distance in cell steps from each blockmap cell to the player's cell
+    int32_t                 srcCellIdx;     // The player's cell when the distances were computed, or '-1' if not computed
+    uint32_t                generation;     // The value of 'gFlowGeneration' when the distances were computed
+};
+
+static std::vector<uint8_t>     gLineFlowPassable;      // Whether each line can currently be walked across by monsters
+static std::vector<uint8_t>     gFlowCellExits;         // For each blockmap cell a bit mask of the directions that lead to a connected neighbor cell
+static std::vector<int32_t>     gFlowQueue;             // Breadth first search queue: kept around to avoid allocations
+static flowfield_t              gFlowFields[MAXPLAYERS];
+static uint32_t                 gFlowGeneration;        // Incremented whenever the connections between cells might have changed
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tells if monsters can walk across the given line
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool P_IsLineFlowPassable(const line_t& line) noexcept {
+    if ((!line.backsector) || (line.flags & (ML_BLOCKING | ML_BLOCKMONSTERS)))
+        return false;
+
+    const sector_t& frontSec = *line.frontsector;
+    const sector_t& backSec = *line.backsector;
+    const fixed_t frontFloorH = frontSec.floorheight;
+    const fixed_t backFloorH = backSec.floorheight;
+    const fixed_t openTop = std::min<fixed_t>(frontSec.ceilingheight, backSec.ceilingheight);
+    const fixed_t openBottom = std::max(frontFloorH, backFloorH);
+
+    return ((openTop - openBottom >= FLOW_MIN_OPENING) && (std::abs(frontFloorH - backFloorH) <= FLOW_MAX_STEP));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Get the world position of the center of the given blockmap cell
+//------------------------------------------------------------------------------------------------------------------------------------------
+static fixed_t P_GetFlowCellCenterX(const int32_t cellX) noexcept {
+    return gBlockmapOriginX + cellX * MAPBLOCKSIZE + MAPBLOCKSIZE / 2;
+}
+
+static fixed_t P_GetFlowCellCenterY(const int32_t cellY) noexcept {
+    return gBlockmapOriginY + cellY * MAPBLOCKSIZE + MAPBLOCKSIZE / 2;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tells if the given line segment crosses any line in the specified blockmap cell which monsters can't walk across
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool P_DoesFlowSegCrossBlockingLine(const int32_t cellX, const int32_t cellY, const divline_t& seg) noexcept {
+    if ((cellX < 0) || (cellY < 0) || (cellX >= gBlockmapWidth) || (cellY >= gBlockmapHeight))
+        return false;
+
+    const fixed_t segLx = std::min(seg.x, seg.x + seg.dx);
+    const fixed_t segRx = std::max(seg.x, seg.x + seg.dx);
+    const fixed_t segBy = std::min(seg.y, seg.y + seg.dy);
+    const fixed_t segTy = std::max(seg.y, seg.y + seg.dy);
+
+    const blocklines_t& blockLines = gBlockLines;
+    const int32_t cellIdx = cellX + cellY * gBlockmapWidth;
+    const uint32_t endIdx = blockLines.cellStart[cellIdx + 1];
+
+    for (uint32_t i = blockLines.cellStart[cellIdx]; i < endIdx; ++i) {
+        // Ignore lines which can be walked across or which can't overlap the segment
+        const int32_t lineNum = blockLines.lineNum[i];
+
+        if (gLineFlowPassable[lineNum])
+            continue;
+
+        const bool bBBoxOverlaps = (
+            (blockLines.bboxLeft[i] <= segRx) &&
+            (blockLines.bboxRight[i] >= segLx) &&
+            (blockLines.bboxBottom[i] <= segTy) &&
+            (blockLines.bboxTop[i] >= segBy)
+        );
+
+        if (!bBBoxOverlaps)
+            continue;
+
+        // The segment and line cross if the ends of each are on opposite sides of the other
+        const line_t& line = gpLines[lineNum];
+        const int32_t v1Side = P_PointOnDivlineSide(line.vertex1->x, line.vertex1->y, seg);
+        const int32_t v2Side = P_PointOnDivlineSide(line.vertex2->x, line.vertex2->y, seg);
+
+        if (v1Side == v2Side)
+            continue;
+
+        const int32_t p1Side = P_PointOnLineSide(seg.x, seg.y, line);
+        const int32_t p2Side = P_PointOnLineSide(seg.x + seg.dx, seg.y + seg.dy, line);
+
+        if (p1Side != p2Side)
+            return true;
+    }
+
+    return false;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tells if monsters can walk from the given blockmap cell to it's neighbor in the specified direction.
+// Diagonal moves also require the moves along both axes to be possible, so that monsters don't try to cut corners.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool P_IsFlowCellEdgeOpen(const int32_t cellX, const int32_t cellY, const int32_t dir) noexcept {
+    const int32_t nextCellX = cellX + gFlowDirCellDx[dir];
+    const int32_t nextCellY = cellY + gFlowDirCellDy[dir];
+
+    if ((nextCellX < 0) || (nextCellY < 0) || (nextCellX >= gBlockmapWidth) || (nextCellY >= gBlockmapHeight))
+        return false;
+
+    const fixed_t x1 = P_GetFlowCellCenterX(cellX);
+    const fixed_t y1 = P_GetFlowCellCenterY(cellY);
+    const divline_t seg = { x1, y1, P_GetFlowCellCenterX(nextCellX) - x1, P_GetFlowCellCenterY(nextCellY) - y1 };
+
+    if (P_DoesFlowSegCrossBlockingLine(cellX, cellY, seg) || P_DoesFlowSegCrossBlockingLine(nextCellX, nextCellY, seg))
+        return false;
+
+    const bool bDiagonal = (dir & 1);
+
+    if (bDiagonal) {
+        if (P_DoesFlowSegCrossBlockingLine(nextCellX, cellY, seg) || P_DoesFlowSegCrossBlockingLine(cellX, nextCellY, seg))
+            return false;
+
+        const int32_t horzDir = (gFlowDirCellDx[dir] > 0) ? DI_EAST : DI_WEST;
+        const int32_t vertDir = (gFlowDirCellDy[dir] > 0) ? DI_NORTH : DI_SOUTH;
+
+        if ((!P_IsFlowCellEdgeOpen(cellX, cellY, horzDir)) || (!P_IsFlowCellEdgeOpen(cellX, cellY, vertDir)))
+            return false;
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Recomputes the connections to neighbors for all blockmap cells in the given (inclusive) range of cells.
+// Each connection is checked from one side only (the cell in the range) and saved for both of the cells that it links.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void P_UpdateFlowCellExits(const int32_t cellLx, const int32_t cellBy, const int32_t cellRx, const int32_t cellTy) noexcept {
+    constexpr int32_t FORWARD_DIRS[4] = { DI_EAST, DI_NORTHEAST, DI_NORTH, DI_NORTHWEST };
+
+    const int32_t lx = std::max(cellLx, 0);
+    const int32_t by = std::max(cellBy, 0);
+    const int32_t rx = std::min(cellRx, gBlockmapWidth - 1);
+    const int32_t ty = std::min(cellTy, gBlockmapHeight - 1);
+
+    for (int32_t cellY = by; cellY <= ty; ++cellY) {
+        for (int32_t cellX = lx; cellX <= rx; ++cellX) {
+            const int32_t cellIdx = cellX + cellY * gBlockmapWidth;
+
+            for (const int32_t dir : FORWARD_DIRS) {
+                const int32_t nextCellX = cellX + gFlowDirCellDx[dir];
+                const int32_t nextCellY = cellY + gFlowDirCellDy[dir];
+
+                if ((nextCellX < 0) || (nextCellX >= gBlockmapWidth) || (nextCellY >= gBlockmapHeight))
+                    continue;
+
+                const int32_t nextCellIdx = nextCellX + nextCellY * gBlockmapWidth;
+                const uint8_t dirBit = (uint8_t)(1u << dir);
+                const uint8_t oppositeDirBit = (uint8_t)(1u << ((dir + 4) & 7));
+
+                if (P_IsFlowCellEdgeOpen(cellX, cellY, dir)) {
+                    gFlowCellExits[cellIdx] |= dirBit;
+                    gFlowCellExits[nextCellIdx] |= oppositeDirBit;
+                } else {
+                    gFlowCellExits[cellIdx] &= (uint8_t) ~dirBit;
+                    gFlowCellExits[nextCellIdx] &= (uint8_t) ~oppositeDirBit;
+                }
+            }
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Get the blockmap cell index for the given world position, or '-1' if the position is outside the blockmap
+//------------------------------------------------------------------------------------------------------------------------------------------
+static int32_t P_GetFlowCellIdx(const fixed_t x, const fixed_t y) noexcept {
+    const int32_t cellX = d_rshift<MAPBLOCKSHIFT>(x - gBlockmapOriginX);
+    const int32_t cellY = d_rshift<MAPBLOCKSHIFT>(y - gBlockmapOriginY);
+
+    if ((cellX < 0) || (cellY < 0) || (cellX >= gBlockmapWidth) || (cellY >= gBlockmapHeight))
+        return -1;
+
+    return cellX + cellY * gBlockmapWidth;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Recomputes the distances from every blockmap cell to the specified cell for the given flow field
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void P_RebuildFlowField(flowfield_t& field, const int32_t srcCellIdx) noexcept {
+    std::vector<uint16_t>& cellDists = field.cellDists;
+    cellDists.assign(gFlowCellExits.size(), FLOW_DIST_UNREACHABLE);
+    field.srcCellIdx = srcCellIdx;
+    field.generation = gFlowGeneration;
+
+    gFlowQueue.clear();
+    gFlowQueue.push_back(srcCellIdx);
+    cellDists[srcCellIdx] = 0;
+
+    for (size_t queueIdx = 0; queueIdx < gFlowQueue.size(); ++queueIdx) {
+        const int32_t cellIdx = gFlowQueue[queueIdx];
+        const uint8_t cellExits = gFlowCellExits[cellIdx];
+        const uint16_t nextDist = (uint16_t) std::min(cellDists[cellIdx] + 1, FLOW_DIST_UNREACHABLE - 1);
+
+        for (int32_t dir = 0; dir < 8; ++dir) {
+            if ((cellExits & (1u << dir)) == 0)
+                continue;
+
+            const int32_t nextCellIdx = cellIdx + gFlowDirCellDx[dir] + gFlowDirCellDy[dir] * gBlockmapWidth;
+
+            if (cellDists[nextCellIdx] == FLOW_DIST_UNREACHABLE) {
+                cellDists[nextCellIdx] = nextDist;
+                gFlowQueue.push_back(nextCellIdx);
+            }
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Initializes line passability and the connections between blockmap cells for flow field pathing, and invalidates all flow fields.
+// Does nothing (other than freeing memory) if flow field pathing is not enabled by the game settings.
+// Must be called once the level has loaded and whenever the level state is restored wholesale (loading a save).
+//------------------------------------------------------------------------------------------------------------------------------------------
+void P_InitFlowFields() noexcept {
+    gLineFlowPassable.clear();
+    gFlowCellExits.clear();
+    gFlowQueue.clear();
+
+    for (flowfield_t& field : gFlowFields) {
+        field.cellDists.clear();
+        field.srcCellIdx = -1;
+    }
+
+    gFlowGeneration++;
+
+    if (!Game::gSettings.bUseMonsterFlowFields)
+        return;
+
+    gLineFlowPassable.reserve((size_t) gNumLines);
+
+    for (int32_t lineIdx = 0; lineIdx < gNumLines; ++lineIdx) {
+        gLineFlowPassable.push_back(P_IsLineFlowPassable(gpLines[lineIdx]));
+    }
+
+    gFlowCellExits.assign((size_t) gBlockmapWidth * (size_t) gBlockmapHeight, 0);
+    P_UpdateFlowCellExits(0, 0, gBlockmapWidth - 1, gBlockmapHeight - 1);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Should be called whenever something affecting whether monsters can walk across a line changes, such as its blocking flags.
+// If the line has become passable (or is no longer passable) then recomputes the connections between blockmap cells around it.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void P_UpdateLineFlowFields(const line_t& line) noexcept {
+    if (gLineFlowPassable.empty())
+        return;
+
+    const int32_t lineIdx = (int32_t)(&line - gpLines);
+    const uint8_t bPassable = P_IsLineFlowPassable(line);
+
+    if (gLineFlowPassable[lineIdx] == bPassable)
+        return;
+
+    gLineFlowPassable[lineIdx] = bPassable;
+    gFlowGeneration++;
+
+    // Any connection which could cross the line starts within 1 cell of the cells it occupies
+    const int32_t cellLx = d_rshift<MAPBLOCKSHIFT>(line.bbox[BOXLEFT] - gBlockmapOriginX) - 1;
+    const int32_t cellRx = d_rshift<MAPBLOCKSHIFT>(line.bbox[BOXRIGHT] - gBlockmapOriginX) + 1;
+    const int32_t cellBy = d_rshift<MAPBLOCKSHIFT>(line.bbox[BOXBOTTOM] - gBlockmapOriginY) - 1;
+    const int32_t cellTy = d_rshift<MAPBLOCKSHIFT>(line.bbox[BOXTOP] - gBlockmapOriginY) + 1;
+    P_UpdateFlowCellExits(cellLx, cellBy, cellRx, cellTy);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Should be called whenever the floor or ceiling height of a sector changes.
+// Recomputes the connections between blockmap cells around any of the sector's lines which monsters can now (or can no longer) walk across.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void P_UpdateSectorFlowFields(const sector_t& sector) noexcept {
+    if (gLineFlowPassable.empty())
+        return;
+
+    for (int32_t i = 0; i < sector.linecount; ++i) {
+        P_UpdateLineFlowFields(*sector.lines[i]);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tells if the given map object type should use flow field pathing (when it's enabled by the game settings).
+// Only regular sized walking monsters are opted in, since the connections between cells assume typical openings and steps.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool P_IsFlowFieldMonsterType(const mobjinfo_t& info) noexcept {
+    return (
+        (info.flags & MF_COUNTKILL) &&
+        ((info.flags & MF_FLOAT) == 0) &&
+        (info.seestate != S_NULL) &&
+        (info.radius <= 64 * FRACUNIT)
+    );
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Get the direction that the given actor should move in to get closer to it's target, according to the target player's flow field.
+// Returns 'DI_NODIR' if the target is not a player, if there is no better cell to move to or if flow fields are not enabled.
+// When several neighbor cells are equally close to the target then the one closest to the direction of the target is chosen.
+//------------------------------------------------------------------------------------------------------------------------------------------
+dirtype_t P_GetFlowFieldDir(const mobj_t& actor, const mobj_t& target) noexcept {
+    if (gFlowCellExits.empty() || (!target.player))
+        return DI_NODIR;
+
+    const int32_t playerIdx = (int32_t)(target.player - gPlayers);
+
+    if ((playerIdx < 0) || (playerIdx >= MAXPLAYERS))
+        return DI_NODIR;
+
+    // If the actor is in the same cell as the target, or off the blockmap, then just let it go straight for the target
+    const int32_t tgtCellIdx = P_GetFlowCellIdx(target.x, target.y);
+    const int32_t actorCellIdx = P_GetFlowCellIdx(actor.x, actor.y);
+
+    if ((tgtCellIdx < 0) || (actorCellIdx < 0) || (tgtCellIdx == actorCellIdx))
+        return DI_NODIR;
+
+    // Update the distances for the player if they are out of date
+    flowfield_t& field = gFlowFields[playerIdx];
+
+    if ((field.srcCellIdx != tgtCellIdx) || (field.generation != gFlowGeneration)) {
+        P_RebuildFlowField(field, tgtCellIdx);
+    }
+
+    const uint16_t curDist = field.cellDists[actorCellIdx];
+
+    if (curDist == FLOW_DIST_UNREACHABLE)
+        return DI_NODIR;
+
+    // Pick the connected neighbor cell which is closest to the target
+    const int64_t tgtDx = d_fixed_to_int(target.x - actor.x);
+    const int64_t tgtDy = d_fixed_to_int(target.y - actor.y);
+    const uint8_t cellExits = gFlowCellExits[actorCellIdx];
+
+    dirtype_t bestDir = DI_NODIR;
+    uint16_t bestDist = curDist;
+    int64_t bestAlignment = INT64_MIN;
+
+    for (int32_t dir = 0; dir < 8; ++dir) {
+        if ((cellExits & (1u << dir)) == 0)
+            continue;
+
+        const int32_t nextCellIdx = actorCellIdx + gFlowDirCellDx[dir] + gFlowDirCellDy[dir] * gBlockmapWidth;
+        const uint16_t nextDist = field.cellDists[nextCellIdx];
+        const int64_t alignment = tgtDx * gFlowDirCellDx[dir] + tgtDy * gFlowDirCellDy[dir];
+
+        if ((nextDist < bestDist) || ((nextDist == bestDist) && (bestDir != DI_NODIR) && (alignment > bestAlignment))) {
+            bestDir = (dirtype_t) dir;
+            bestDist = nextDist;
+            bestAlignment = alignment;
+        }
+    }
+
+    return bestDir;
+}
+
+#endif  // #if PSYDOOM_MODS
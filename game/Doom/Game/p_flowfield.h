@@ -0,0 +1,16 @@
+#pragma once
+
+#if PSYDOOM_MODS
+
+#include "Doom/doomdef.h"
+
+struct line_t;
+struct sector_t;
+
+void P_InitFlowFields() noexcept;
+void P_UpdateLineFlowFields(const line_t& line) noexcept;
+void P_UpdateSectorFlowFields(const sector_t& sector) noexcept;
+bool P_IsFlowFieldMonsterType(const mobjinfo_t& info) noexcept;
+dirtype_t P_GetFlowFieldDir(const mobj_t& actor, const mobj_t& target) noexcept;
+
+#endif  // #if PSYDOOM_MODS
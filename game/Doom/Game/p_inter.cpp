@@ -675,6 +675,13 @@ void P_TouchSpecialThing(mobj_t& special, mobj_t& toucher) noexcept {
         player.itemcount++;
     }
 
+    // PsyDoom: let achievements know if the local player picked up something
+    #if PSYDOOM_MODS
+        if (&player == &gPlayers[gCurPlayerIndex]) {
+            AchievementManager::Get().RaiseEvent(AchievementEventType::Pickup, special.info->doomednum);
+        }
+    #endif
+
     // Remove the item on pickup and increase the bonus flash amount and play the pickup sound
     P_RemoveMobj(special);
     player.bonuscount += BONUSADD;
@@ -859,16 +866,6 @@ void P_KillMobj(mobj_t* const pKiller, mobj_t& target) noexcept {
         gPlayers[0].killcount += 1;
     }
 
-#if PSYDOOM_MODS
-    // PsyDoom: Achievement hooks
-    if (pKillerPlayer) {
-        AchievementManager::Get().Unlock("FIRST_BLOOD");
-        if (target.type == MT_CYBORG) {
-            AchievementManager::Get().Unlock("CYBER_KILL");
-        }
-    }
-#endif
-
 #if PSYDOOM_MODS
     else if ((gNetGame == gt_coop) && (target.flags & MF_COUNTKILL)) {
         // PsyDoom: in co-op firstly try and credit the kill towards the player which is being targeted by the monster.
@@ -884,6 +881,13 @@ void P_KillMobj(mobj_t* const pKiller, mobj_t& target) noexcept {
     }
 #endif
 
+    // PsyDoom: let achievements know if the local player killed something
+    #if PSYDOOM_MODS
+        if (pKillerPlayer && (pKillerPlayer == &gPlayers[gCurPlayerIndex])) {
+            AchievementManager::Get().RaiseEvent(AchievementEventType::Kill, target.info->doomednum);
+        }
+    #endif
+
     // Player specific death logic
     bool bDoGibbing = false;
 
@@ -921,7 +925,13 @@ void P_KillMobj(mobj_t* const pKiller, mobj_t& target) noexcept {
             const int32_t dmFragLimit = Game::gSettings.dmFragLimit;
 
             if ((gNetGame == gt_deathmatch) && (dmFragLimit > 0)) {
-                if ((gPlayers[0].frags >= dmFragLimit) || (gPlayers[1].frags >= dmFragLimit)) {
+                bool bHitFragLimit = false;
+
+                for (const player_t& player : gPlayers) {
+                    bHitFragLimit |= (player.frags >= dmFragLimit);
+                }
+
+                if (bHitFragLimit) {
                     G_ExitLevel();
                 }
             }
@@ -32,13 +32,18 @@ fixed_t     gTryMoveX;          // Try move: position we're attempting to move t
 fixed_t     gTryMoveY;          // Try move: position we're attempting to move to (Y)
 bool        gbCheckPosOnly;     // Try move: if 'true' then check if the position is valid to move to only, don't actually move there
 
-static mobj_t*      gpBombSource;       // Radius attacks: the thing responsible for the explosion (player, monster)
-static mobj_t*      gpBombSpot;         // Radius attacks: the object exploding and it's position (barrel, missile etc.)
-static int32_t      gBombDamage;        // Radius attacks: how much damage the explosion does before falloff
-static divline_t    gUseLine;           // The 'use' line being cast from the player towards walls; we try to activate walls that it hits
-static fixed_t      gUseBBox[4];        // The bounding box for the 'use' line being cast from the player
-static line_t*      gpCloseLine;        // The closest wall line currently being used
-static fixed_t      gCloseDist;         // Fractional distance along the use line to the closest wall line being used
+// PsyDoom: the state private to this module, grouped together so it can later become part of a per-simulation context
+struct MapModuleState {
+    mobj_t*     pBombSource;    // Radius attacks: the thing responsible for the explosion (player, monster)
+    mobj_t*     pBombSpot;      // Radius attacks: the object exploding and it's position (barrel, missile etc.)
+    int32_t     bombDamage;     // Radius attacks: how much damage the explosion does before falloff
+    divline_t   useLine;        // The 'use' line being cast from the player towards walls; we try to activate walls that it hits
+    fixed_t     useBBox[4];     // The bounding box for the 'use' line being cast from the player
+    line_t*     pCloseLine;     // The closest wall line currently being used
+    fixed_t     closeDist;      // Fractional distance along the use line to the closest wall line being used
+};
+
+static MapModuleState gMapState;
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Test if the given x/y position can be moved to for the given map object and return 'true' if the move is allowed
@@ -129,10 +134,10 @@ static fixed_t P_InterceptVector(divline_t& line1, divline_t& line2) noexcept {
 static bool PIT_UseLines(line_t& line) noexcept {
     // If the 'use' bounding box doesn't cross the line then ignore the line and early out
     const bool noBBoxOverlap = (
-        (gUseBBox[BOXTOP] <= line.bbox[BOXBOTTOM]) ||
-        (gUseBBox[BOXBOTTOM] >= line.bbox[BOXTOP]) ||
-        (gUseBBox[BOXLEFT] >= line.bbox[BOXRIGHT]) ||
-        (gUseBBox[BOXRIGHT] <= line.bbox[BOXLEFT])
+        (gMapState.useBBox[BOXTOP] <= line.bbox[BOXBOTTOM]) ||
+        (gMapState.useBBox[BOXBOTTOM] >= line.bbox[BOXTOP]) ||
+        (gMapState.useBBox[BOXLEFT] >= line.bbox[BOXRIGHT]) ||
+        (gMapState.useBBox[BOXRIGHT] <= line.bbox[BOXLEFT])
     );
 
     if (noBBoxOverlap)
@@ -141,13 +146,13 @@ static bool PIT_UseLines(line_t& line) noexcept {
     // Intersect the two lines and bail out if there is no intersection
     divline_t divline;
     P_MakeDivline(line, divline);
-    const fixed_t intersectFrac = P_InterceptVector(gUseLine, divline);
+    const fixed_t intersectFrac = P_InterceptVector(gMapState.useLine, divline);
 
     if (intersectFrac < 0)  // No intersection, or intersection before the start of the use line
         return true;
 
     // If the intersection isn't closer than the current closest use line intersection then ignore also
-    if (intersectFrac > gCloseDist)
+    if (intersectFrac > gMapState.closeDist)
         return true;
 
     // PsyDoom: apply a fix to make line activation logic more reliable and prevent exploits of using switches and doors through walls (if enabled).
@@ -158,7 +163,7 @@ static bool PIT_UseLines(line_t& line) noexcept {
         if (Game::gSettings.bFixLineActivation) {
             // Does the 'use line' intersection actually fall along the linedef line?
             // Perform the opposite intersection test to find out and ignore the line if not...
-            const fixed_t intersectFrac2 = P_InterceptVector(divline, gUseLine);
+            const fixed_t intersectFrac2 = P_InterceptVector(divline, gMapState.useLine);
 
             if ((intersectFrac2 < 0) || (intersectFrac2 > FRACUNIT))
                 return true;
@@ -174,8 +179,8 @@ static bool PIT_UseLines(line_t& line) noexcept {
     }
 
     // This is the new closest line, save - along with the intersection fraction along the use line
-    gpCloseLine = &line;
-    gCloseDist = intersectFrac;
+    gMapState.pCloseLine = &line;
+    gMapState.closeDist = intersectFrac;
     return true;
 }
 
@@ -186,7 +191,7 @@ void P_UseLines(player_t& player) noexcept {
     // Figure out the start point and vector for the use line
     mobj_t& mobj = *player.mo;
 
-    divline_t& useline = gUseLine;
+    divline_t& useline = gMapState.useLine;
     useline.x = mobj.x;
     useline.y = mobj.y;
 
@@ -196,24 +201,24 @@ void P_UseLines(player_t& player) noexcept {
 
     // Figure out the bounding box for the use line
     if (useline.dx > 0) {
-        gUseBBox[BOXLEFT] = useline.x;
-        gUseBBox[BOXRIGHT] = useline.x + useline.dx;
+        gMapState.useBBox[BOXLEFT] = useline.x;
+        gMapState.useBBox[BOXRIGHT] = useline.x + useline.dx;
     } else {
-        gUseBBox[BOXLEFT] = useline.x + useline.dx;
-        gUseBBox[BOXRIGHT] = useline.x;
+        gMapState.useBBox[BOXLEFT] = useline.x + useline.dx;
+        gMapState.useBBox[BOXRIGHT] = useline.x;
     }
 
     if (useline.dy > 0) {
-        gUseBBox[BOXTOP] = useline.y + useline.dy;
-        gUseBBox[BOXBOTTOM] = useline.y;
+        gMapState.useBBox[BOXTOP] = useline.y + useline.dy;
+        gMapState.useBBox[BOXBOTTOM] = useline.y;
     } else {
-        gUseBBox[BOXTOP] = useline.y;
-        gUseBBox[BOXBOTTOM] = useline.y + useline.dy;
+        gMapState.useBBox[BOXTOP] = useline.y;
+        gMapState.useBBox[BOXBOTTOM] = useline.y + useline.dy;
     }
 
     // Initially no wall is hit and the closest thing is at fraction 1.0 (end of the line)
-    gCloseDist = FRACUNIT;
-    gpCloseLine = nullptr;
+    gMapState.closeDist = FRACUNIT;
+    gMapState.pCloseLine = nullptr;
 
     // Now doing new checks
     gValidCount++;
@@ -221,15 +226,15 @@ void P_UseLines(player_t& player) noexcept {
     // Compute the blockmap extents to check for use lines.
     // PsyDoom: ensure these are always within a valid range to prevent undefined behavior at map edges.
     #if PSYDOOM_MODS && PSYDOOM_FIX_UB
-        const int32_t bmapTy = std::min(d_rshift<MAPBLOCKSHIFT>(gUseBBox[BOXTOP] - gBlockmapOriginY), gBlockmapHeight - 1);
-        const int32_t bmapBy = std::max(d_rshift<MAPBLOCKSHIFT>(gUseBBox[BOXBOTTOM] - gBlockmapOriginY), 0);
-        const int32_t bmapLx = std::max(d_rshift<MAPBLOCKSHIFT>(gUseBBox[BOXLEFT] - gBlockmapOriginX), 0);
-        const int32_t bmapRx = std::min(d_rshift<MAPBLOCKSHIFT>(gUseBBox[BOXRIGHT] - gBlockmapOriginX), gBlockmapWidth - 1);
+        const int32_t bmapTy = std::min(d_rshift<MAPBLOCKSHIFT>(gMapState.useBBox[BOXTOP] - gBlockmapOriginY), gBlockmapHeight - 1);
+        const int32_t bmapBy = std::max(d_rshift<MAPBLOCKSHIFT>(gMapState.useBBox[BOXBOTTOM] - gBlockmapOriginY), 0);
+        const int32_t bmapLx = std::max(d_rshift<MAPBLOCKSHIFT>(gMapState.useBBox[BOXLEFT] - gBlockmapOriginX), 0);
+        const int32_t bmapRx = std::min(d_rshift<MAPBLOCKSHIFT>(gMapState.useBBox[BOXRIGHT] - gBlockmapOriginX), gBlockmapWidth - 1);
     #else
-        const int32_t bmapTy = d_rshift<MAPBLOCKSHIFT>(gUseBBox[BOXTOP] - gBlockmapOriginY);
-        const int32_t bmapBy = d_rshift<MAPBLOCKSHIFT>(gUseBBox[BOXBOTTOM] - gBlockmapOriginY);
-        const int32_t bmapLx = d_rshift<MAPBLOCKSHIFT>(gUseBBox[BOXLEFT] - gBlockmapOriginX);
-        const int32_t bmapRx = d_rshift<MAPBLOCKSHIFT>(gUseBBox[BOXRIGHT] - gBlockmapOriginX);
+        const int32_t bmapTy = d_rshift<MAPBLOCKSHIFT>(gMapState.useBBox[BOXTOP] - gBlockmapOriginY);
+        const int32_t bmapBy = d_rshift<MAPBLOCKSHIFT>(gMapState.useBBox[BOXBOTTOM] - gBlockmapOriginY);
+        const int32_t bmapLx = d_rshift<MAPBLOCKSHIFT>(gMapState.useBBox[BOXLEFT] - gBlockmapOriginX);
+        const int32_t bmapRx = d_rshift<MAPBLOCKSHIFT>(gMapState.useBBox[BOXRIGHT] - gBlockmapOriginX);
 
         ASSERT(bmapLx >= 0);
         ASSERT(bmapBy >= 0);
@@ -246,7 +251,7 @@ void P_UseLines(player_t& player) noexcept {
 
     // Try to use the closest line (if any).
     // If the line has no special then play the grunting noise.
-    line_t* const pClosestLine = gpCloseLine;
+    line_t* const pClosestLine = gMapState.pCloseLine;
 
     if (!pClosestLine)
         return;
@@ -272,7 +277,7 @@ static bool PIT_RadiusAttack(mobj_t& mobj) noexcept {
         return true;
 
     // Get a distance estimate to the source of the blast
-    mobj_t& bombSpot = *gpBombSpot;
+    mobj_t& bombSpot = *gMapState.pBombSpot;
 
     const fixed_t dx = std::abs(mobj.x - bombSpot.x);
     const fixed_t dy = std::abs(mobj.y - bombSpot.y);
@@ -282,8 +287,8 @@ static bool PIT_RadiusAttack(mobj_t& mobj) noexcept {
     const int32_t damageFade = std::max(d_fixed_to_int(approxDist - mobj.radius), 0);
 
     // Apply the actual damage if > 0 and if the thing has a line of sight to the explosion
-    const int32_t bombBaseDamage = gBombDamage;
-    mobj_t* pBombSource = gpBombSource;
+    const int32_t bombBaseDamage = gMapState.bombDamage;
+    mobj_t* pBombSource = gMapState.pBombSource;
 
     if ((bombBaseDamage > damageFade) && P_CheckSight(mobj, bombSpot)) {
         P_DamageMobj(mobj, &bombSpot, pBombSource, bombBaseDamage - damageFade);
@@ -320,12 +325,19 @@ void P_RadiusAttack(mobj_t& bombSpot, mobj_t* const pSource, const int32_t damag
     #endif
 
     // Save bomb properties globally and apply the blast damage (where possible) to things within the blockmap search range
-    gpBombSpot = &bombSpot;
-    gpBombSource = pSource;
-    gBombDamage = damage;
+    gMapState.pBombSpot = &bombSpot;
+    gMapState.pBombSource = pSource;
+    gMapState.bombDamage = damage;
 
     for (int32_t y = bmapBy; y <= bmapTy; ++y) {
         for (int32_t x = bmapLx; x <= bmapRx; ++x) {
+            // PsyDoom: skip cells where everything is definitely too far away to be damaged, without visiting each thing.
+            // Note: 'PIT_RadiusAttack' can link and unlink things (by killing them), so the cell's linked list must still be used after that.
+            #if PSYDOOM_MODS
+                if (!P_BlockHasThingsInRange(x, y, bombSpot.x, bombSpot.y, blastDist))
+                    continue;
+            #endif
+
             P_BlockThingsIterator(x, y, PIT_RadiusAttack);
         }
     }
@@ -9,11 +9,33 @@
 
 #include <algorithm>
 
+#if PSYDOOM_MODS
+    #include <deque>
+#endif
+
 fixed_t gOpenBottom;    // Line opening (floor/ceiling gap) info: bottom Z value of the opening
 fixed_t gOpenTop;       // Line opening (floor/ceiling gap) info: top Z value of the opening
 fixed_t gOpenRange;     // Line opening (floor/ceiling gap) info: Z size of the opening
 fixed_t gLowFloor;      // Line opening (floor/ceiling gap) info: the lowest (front/back sector) floor of the opening
 
+#if PSYDOOM_MODS
+    // PsyDoom: a packed copy of the line lists for every blockmap cell, with line bounding boxes
+    blocklines_t gBlockLines;
+
+    // PsyDoom: a packed list of things for each blockmap cell, kept in sync with the 'gppBlockLinks' linked lists.
+    // Things are stored in the reverse order to the linked list (most recently linked last) so that adding a thing is just an append.
+    static std::vector<std::vector<blockthing_t>> gBlockThings;
+
+    // PsyDoom: storage for all nodes linking things to the sectors they touch, and the list of free nodes (linked via 'pMobjNext').
+    // A deque is used so that node addresses remain stable as more nodes are allocated.
+    static std::deque<touchnode_t>  gTouchNodes;
+    static touchnode_t*             gpFreeTouchNodes;
+
+    // PsyDoom: incremented whenever a thing is linked to or unlinked from the sectors it touches.
+    // Used to detect when the list of things touching a sector changes during iteration.
+    static uint32_t gTouchNodeChangeCount;
+#endif
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Gives a cheap approximate/estimated length for the given vector
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -133,6 +155,11 @@ void P_LineOpening(const line_t& line) noexcept {
 // Unlinks the given thing from sector thing lists and the blockmap
 //------------------------------------------------------------------------------------------------------------------------------------------
 void P_UnsetThingPosition(mobj_t& thing) noexcept {
+    // PsyDoom: unlink the thing from the sectors that it touches
+    #if PSYDOOM_MODS
+        P_UnlinkTouchingSectors(thing);
+    #endif
+
     // Does this thing get assigned to sector thing lists?
     // If so remove it from the sector thing list.
     if ((thing.flags & MF_NOSECTOR) == 0) {
@@ -150,6 +177,11 @@ void P_UnsetThingPosition(mobj_t& thing) noexcept {
     // Does this thing get added to the blockmap?
     // If so remove it from the blockmap.
     if ((thing.flags & MF_NOBLOCKMAP) == 0) {
+        // PsyDoom: remove the thing from the packed list of things for the blockmap cell too
+        #if PSYDOOM_MODS
+            P_RemoveBlockThing(thing);
+        #endif
+
         if (thing.bnext) {
             thing.bnext->bprev = thing.bprev;
         }
@@ -216,11 +248,21 @@ void P_SetThingPosition(mobj_t& mobj) noexcept {
             }
 
             blockList = &mobj;
+
+            // PsyDoom: add the thing to the packed list of things for the blockmap cell too
+            #if PSYDOOM_MODS
+                P_AddBlockThing(mobj, blockY * gBlockmapWidth + blockX);
+            #endif
         } else {
             mobj.bprev = nullptr;
             mobj.bnext = nullptr;
         }
     }
+
+    // PsyDoom: link the thing to the sectors that it touches
+    #if PSYDOOM_MODS
+        P_LinkTouchingSectors(mobj);
+    #endif
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -281,3 +323,316 @@ bool P_BlockThingsIterator(const int32_t x, const int32_t y, bool (*pFunc)(mobj_
 
     return true;
 }
+
+#if PSYDOOM_MODS
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: builds the packed copy of the line lists and line bounding boxes for every blockmap cell.
+// Must be called once the blockmap and lines for the level have been loaded.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void P_InitBlockLines() noexcept {
+    blocklines_t& blockLines = gBlockLines;
+    blockLines.cellStart.clear();
+    blockLines.lineNum.clear();
+    blockLines.bboxTop.clear();
+    blockLines.bboxBottom.clear();
+    blockLines.bboxLeft.clear();
+    blockLines.bboxRight.clear();
+
+    const int32_t numCells = gBlockmapWidth * gBlockmapHeight;
+    blockLines.cellStart.reserve((size_t) numCells + 1);
+
+    for (int32_t cellIdx = 0; cellIdx < numCells; ++cellIdx) {
+        blockLines.cellStart.push_back((uint32_t) blockLines.lineNum.size());
+
+        for (const int16_t* pLineNum = (int16_t*)(gpBlockmapLump + gpBlockmap[cellIdx]); *pLineNum != -1; ++pLineNum) {
+            const line_t& line = gpLines[*pLineNum];
+            blockLines.lineNum.push_back(*pLineNum);
+            blockLines.bboxTop.push_back(line.bbox[BOXTOP]);
+            blockLines.bboxBottom.push_back(line.bbox[BOXBOTTOM]);
+            blockLines.bboxLeft.push_back(line.bbox[BOXLEFT]);
+            blockLines.bboxRight.push_back(line.bbox[BOXRIGHT]);
+        }
+    }
+
+    blockLines.cellStart.push_back((uint32_t) blockLines.lineNum.size());
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: clears the packed lists of things for all blockmap cells and sizes them for the current blockmap.
+// Should be called whenever the blockmap thing linked lists are reset.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void P_InitBlockThings() noexcept {
+    for (std::vector<blockthing_t>& blockThings : gBlockThings) {
+        blockThings.clear();
+    }
+
+    gBlockThings.resize((size_t) gBlockmapWidth * (size_t) gBlockmapHeight);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: adds the given thing to the packed list of things for the specified blockmap cell.
+// Should be called whenever the thing is linked into the blockmap cell's linked list of things.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void P_AddBlockThing(mobj_t& mobj, const int32_t blockIdx) noexcept {
+    gBlockThings[blockIdx].push_back({ &mobj, mobj.x, mobj.y, mobj.radius });
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: removes the given thing from the packed list of things for the blockmap cell it is in, if it is in the list.
+// Should be called whenever the thing is unlinked from the blockmap, before its position changes.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void P_RemoveBlockThing(mobj_t& mobj) noexcept {
+    const int32_t blockX = d_rshift<MAPBLOCKSHIFT>(mobj.x - gBlockmapOriginX);
+    const int32_t blockY = d_rshift<MAPBLOCKSHIFT>(mobj.y - gBlockmapOriginY);
+
+    if ((blockX < 0) || (blockY < 0) || (blockX >= gBlockmapWidth) || (blockY >= gBlockmapHeight))
+        return;
+
+    // Search from the end since recently linked things are more likely to move again soon
+    std::vector<blockthing_t>& blockThings = gBlockThings[blockX + blockY * gBlockmapWidth];
+
+    for (size_t i = blockThings.size(); i > 0; --i) {
+        if (blockThings[i - 1].pMobj == &mobj) {
+            blockThings.erase(blockThings.begin() + (i - 1));
+            return;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: returns the packed list of things for the specified blockmap cell, which must be in range.
+// Things must be visited in reverse order (from the end of the list) to match the order of the cell's linked list of things.
+// The list must NOT be modified (by linking or unlinking things) while it is being iterated.
+//------------------------------------------------------------------------------------------------------------------------------------------
+const std::vector<blockthing_t>& P_GetBlockThings(const int32_t x, const int32_t y) noexcept {
+    return gBlockThings[x + y * gBlockmapWidth];
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: tells if any thing in the specified blockmap cell might be within range of a point, as per 'P_IsBlockThingInRange'.
+// If this returns 'false' then all things in the cell are definitely out of range and the cell can be skipped.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool P_BlockHasThingsInRange(
+    const int32_t x,
+    const int32_t y,
+    const fixed_t rangeX,
+    const fixed_t rangeY,
+    const fixed_t range
+) noexcept {
+    if ((x < 0) || (y < 0) || (x >= gBlockmapWidth) || (y >= gBlockmapHeight))
+        return false;
+
+    for (const blockthing_t& thing : gBlockThings[x + y * gBlockmapWidth]) {
+        if (P_IsBlockThingInRange(thing, rangeX, rangeY, range))
+            return true;
+    }
+
+    return false;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: frees all nodes linking things to the sectors they touch.
+// Should be called whenever the level is reset, before any things are linked into it.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void P_InitTouchNodes() noexcept {
+    gTouchNodes.clear();
+    gpFreeTouchNodes = nullptr;
+    gTouchNodeChangeCount = 0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: tells if the given bounding box crosses the given line, i.e has corners on both sides of the line
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool P_BoxCrossesLine(const fixed_t bbox[4], const line_t& line) noexcept {
+    const int32_t side = P_PointOnLineSide(bbox[BOXLEFT], bbox[BOXTOP], line);
+
+    return (
+        (P_PointOnLineSide(bbox[BOXRIGHT], bbox[BOXTOP], line) != side) ||
+        (P_PointOnLineSide(bbox[BOXLEFT], bbox[BOXBOTTOM], line) != side) ||
+        (P_PointOnLineSide(bbox[BOXRIGHT], bbox[BOXBOTTOM], line) != side)
+    );
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: links the given thing to the specified sector that it touches, if it is not already linked to the sector
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void P_AddTouchNode(mobj_t& mobj, sector_t& sector) noexcept {
+    for (touchnode_t* pNode = mobj.touchsectors; pNode; pNode = pNode->pMobjNext) {
+        if (pNode->pSector == &sector)
+            return;
+    }
+
+    // Get a free node or allocate a new one
+    touchnode_t* pNode = gpFreeTouchNodes;
+
+    if (pNode) {
+        gpFreeTouchNodes = pNode->pMobjNext;
+    } else {
+        pNode = &gTouchNodes.emplace_back();
+    }
+
+    // Add the node to the front of the thing's and sector's lists
+    pNode->pMobj = &mobj;
+    pNode->pSector = &sector;
+    pNode->pMobjNext = mobj.touchsectors;
+    pNode->pSectorPrev = nullptr;
+    pNode->pSectorNext = sector.touchthings;
+
+    if (sector.touchthings) {
+        sector.touchthings->pSectorPrev = pNode;
+    }
+
+    sector.touchthings = pNode;
+    mobj.touchsectors = pNode;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: links the given thing to all of the sectors that it touches, as determined by its current position and radius.
+// The thing must not already be linked to any sectors and must be in a subsector.
+// Only things which are added to the blockmap are linked, since those are the only things that are affected by moving sectors.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void P_LinkTouchingSectors(mobj_t& mobj) noexcept {
+    ASSERT(!mobj.touchsectors);
+
+    if (mobj.flags & MF_NOBLOCKMAP)
+        return;
+
+    // The thing always touches the sector that it is in
+    P_AddTouchNode(mobj, *mobj.subsector->sector);
+
+    // Get the bounding box for the thing and the range of blockmap cells it covers
+    fixed_t bbox[4];
+    bbox[BOXTOP] = mobj.y + mobj.radius;
+    bbox[BOXBOTTOM] = mobj.y - mobj.radius;
+    bbox[BOXLEFT] = mobj.x - mobj.radius;
+    bbox[BOXRIGHT] = mobj.x + mobj.radius;
+
+    const int32_t bmapLx = std::max(d_rshift<MAPBLOCKSHIFT>(bbox[BOXLEFT] - gBlockmapOriginX), 0);
+    const int32_t bmapRx = std::min(d_rshift<MAPBLOCKSHIFT>(bbox[BOXRIGHT] - gBlockmapOriginX), gBlockmapWidth - 1);
+    const int32_t bmapBy = std::max(d_rshift<MAPBLOCKSHIFT>(bbox[BOXBOTTOM] - gBlockmapOriginY), 0);
+    const int32_t bmapTy = std::min(d_rshift<MAPBLOCKSHIFT>(bbox[BOXTOP] - gBlockmapOriginY), gBlockmapHeight - 1);
+
+    // Add the sectors on both sides of every line which the bounding box crosses.
+    // Note: lines can appear in more than one blockmap cell but that's fine, since sectors are only ever linked once.
+    const blocklines_t& blockLines = gBlockLines;
+
+    for (int32_t y = bmapBy; y <= bmapTy; ++y) {
+        for (int32_t x = bmapLx; x <= bmapRx; ++x) {
+            const int32_t cellIdx = x + y * gBlockmapWidth;
+            const uint32_t cellEnd = blockLines.cellStart[cellIdx + 1];
+
+            for (uint32_t i = blockLines.cellStart[cellIdx]; i < cellEnd; ++i) {
+                // Quick rejection using the packed line bounding box: boxes which just touch the line are not counted as crossing it
+                const bool bBBoxOverlaps = (
+                    (bbox[BOXRIGHT] > blockLines.bboxLeft[i]) &&
+                    (bbox[BOXLEFT] < blockLines.bboxRight[i]) &&
+                    (bbox[BOXTOP] > blockLines.bboxBottom[i]) &&
+                    (bbox[BOXBOTTOM] < blockLines.bboxTop[i])
+                );
+
+                if (!bBBoxOverlaps)
+                    continue;
+
+                line_t& line = gpLines[blockLines.lineNum[i]];
+
+                if (!P_BoxCrossesLine(bbox, line))
+                    continue;
+
+                P_AddTouchNode(mobj, *line.frontsector);
+
+                if (line.backsector) {
+                    P_AddTouchNode(mobj, *line.backsector);
+                }
+            }
+        }
+    }
+
+    gTouchNodeChangeCount++;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: unlinks the given thing from all of the sectors that it touches (if any)
+//------------------------------------------------------------------------------------------------------------------------------------------
+void P_UnlinkTouchingSectors(mobj_t& mobj) noexcept {
+    touchnode_t* pNode = mobj.touchsectors;
+
+    if (!pNode)
+        return;
+
+    while (pNode) {
+        touchnode_t* const pNextNode = pNode->pMobjNext;
+
+        // Remove from the sector's list of things
+        if (pNode->pSectorNext) {
+            pNode->pSectorNext->pSectorPrev = pNode->pSectorPrev;
+        }
+
+        if (pNode->pSectorPrev) {
+            pNode->pSectorPrev->pSectorNext = pNode->pSectorNext;
+        } else {
+            pNode->pSector->touchthings = pNode->pSectorNext;
+        }
+
+        // Return the node to the free list
+        pNode->pMobjNext = gpFreeTouchNodes;
+        gpFreeTouchNodes = pNode;
+        pNode = pNextNode;
+    }
+
+    mobj.touchsectors = nullptr;
+    gTouchNodeChangeCount++;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: visit all things touching the specified sector, calling the given function for each thing.
+// The called function can abort iteration by returning 'false'. This function returns 'false' if iteration was aborted.
+//
+// The called function is allowed to link and unlink things (including removing the thing being visited).
+// If that happens then iteration restarts from the beginning of the sector's list, skipping over things which were already visited.
+// Each thing is visited at most once.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool P_SectorTouchingThingsIterator(sector_t& sector, bool (*pFunc)(mobj_t&)) noexcept {
+    // Things visited so far by all active calls to this function.
+    // Each call only uses the entries from where the list was when it started, so that recursive calls are fine.
+    static std::vector<mobj_t*> visitedThings;
+    const size_t visitedBeg = visitedThings.size();
+
+    bool bRestarted = false;
+    bool bContinue = true;
+
+    for (touchnode_t* pNode = sector.touchthings; pNode;) {
+        mobj_t& mobj = *pNode->pMobj;
+
+        // Unless iteration has restarted, none of the remaining things in the list can have been visited
+        if (bRestarted) {
+            const auto visitedIter = std::find(visitedThings.begin() + visitedBeg, visitedThings.end(), &mobj);
+
+            if (visitedIter != visitedThings.end()) {
+                pNode = pNode->pSectorNext;
+                continue;
+            }
+        }
+
+        visitedThings.push_back(&mobj);
+
+        // Call the function and stop if requested
+        const uint32_t oldChangeCount = gTouchNodeChangeCount;
+
+        if (!pFunc(mobj)) {
+            bContinue = false;
+            break;
+        }
+
+        // If the lists changed then the current node might not exist anymore: restart from the beginning of the list if that is the case
+        if (gTouchNodeChangeCount == oldChangeCount) {
+            pNode = pNode->pSectorNext;
+        } else {
+            pNode = sector.touchthings;
+            bRestarted = true;
+        }
+    }
+
+    visitedThings.resize(visitedBeg);
+    return bContinue;
+}
+#endif  // #if PSYDOOM_MODS
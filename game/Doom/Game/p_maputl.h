@@ -2,9 +2,15 @@
 
 #include "Doom/doomdef.h"
 
+#if PSYDOOM_MODS
+    #include <cstdlib>
+    #include <vector>
+#endif
+
 struct divline_t;
 struct line_t;
 struct mobj_t;
+struct sector_t;
 
 extern fixed_t gOpenBottom;
 extern fixed_t gOpenTop;
@@ -20,3 +26,63 @@ void P_UnsetThingPosition(mobj_t& thing) noexcept;
 void P_SetThingPosition(mobj_t& thing) noexcept;
 bool P_BlockLinesIterator(const int32_t x, const int32_t y, bool (*pFunc)(line_t&)) noexcept;
 bool P_BlockThingsIterator(const int32_t x, const int32_t y, bool (*pFunc)(mobj_t&)) noexcept;
+
+#if PSYDOOM_MODS
+    // PsyDoom: an entry in the packed list of things for a blockmap cell.
+    // Holds a copy of the thing's position and radius, so that things can be culled by distance without touching the thing itself.
+    // Note: the radius can be larger than the actual radius of the thing (if it shrinks while linked), but never smaller.
+    struct blockthing_t {
+        mobj_t*     pMobj;
+        fixed_t     x;
+        fixed_t     y;
+        fixed_t     radius;
+    };
+
+    // PsyDoom: a packed copy of the line lists for every blockmap cell along with the bounding box of each line, in structure of arrays form.
+    // Allows lines to be culled by bounding box without touching the actual line (which is comparatively large and scattered in memory).
+    // The lines for blockmap cell 'i' are found in the range 'cellStart[i]' to 'cellStart[i + 1]' (exclusive) of the other arrays.
+    // Lines appear in exactly the same order as in the original blockmap lump, including any duplicate entries.
+    struct blocklines_t {
+        std::vector<uint32_t>   cellStart;
+        std::vector<int32_t>    lineNum;
+        std::vector<fixed_t>    bboxTop;
+        std::vector<fixed_t>    bboxBottom;
+        std::vector<fixed_t>    bboxLeft;
+        std::vector<fixed_t>    bboxRight;
+    };
+
+    // PsyDoom: links a thing to one of the sectors that it touches (i.e that its bounding box overlaps).
+    // Each node is part of two intrusive lists: the list of sectors touched by the thing and the list of things touching the sector.
+    struct touchnode_t {
+        mobj_t*         pMobj;          // The thing touching the sector
+        sector_t*       pSector;        // The sector touched by the thing
+        touchnode_t*    pMobjNext;      // Next sector touched by the same thing
+        touchnode_t*    pSectorPrev;    // Previous thing touching the same sector
+        touchnode_t*    pSectorNext;    // Next thing touching the same sector
+    };
+
+    extern blocklines_t gBlockLines;
+
+    void P_InitBlockLines() noexcept;
+    void P_InitBlockThings() noexcept;
+    void P_AddBlockThing(mobj_t& mobj, const int32_t blockIdx) noexcept;
+    void P_RemoveBlockThing(mobj_t& mobj) noexcept;
+    const std::vector<blockthing_t>& P_GetBlockThings(const int32_t x, const int32_t y) noexcept;
+    bool P_BlockHasThingsInRange(const int32_t x, const int32_t y, const fixed_t rangeX, const fixed_t rangeY, const fixed_t range) noexcept;
+    void P_InitTouchNodes() noexcept;
+    void P_LinkTouchingSectors(mobj_t& mobj) noexcept;
+    void P_UnlinkTouchingSectors(mobj_t& mobj) noexcept;
+    bool P_SectorTouchingThingsIterator(sector_t& sector, bool (*pFunc)(mobj_t&)) noexcept;
+
+    //------------------------------------------------------------------------------------------------------------------------------------------
+    // PsyDoom: tells if the given blockmap thing might be within the specified range of a point on both axes, taking into account the thing's
+    // radius. Things which this returns 'false' for are definitely not in range: they satisfy this test used throughout the game code:
+    //      (std::abs(mobj.x - rangeX) >= mobj.radius + range) || (std::abs(mobj.y - rangeY) >= mobj.radius + range)
+    //------------------------------------------------------------------------------------------------------------------------------------------
+    inline bool P_IsBlockThingInRange(const blockthing_t& thing, const fixed_t rangeX, const fixed_t rangeY, const fixed_t range) noexcept {
+        const fixed_t totalRange = thing.radius + range;
+        const fixed_t dx = std::abs(thing.x - rangeX);
+        const fixed_t dy = std::abs(thing.y - rangeY);
+        return ((dx < totalRange) && (dy < totalRange));
+    }
+#endif
@@ -15,6 +15,7 @@
 #include "g_game.h"
 #include "info.h"
 #include "p_enemy.h"
+#include "p_flowfield.h"
 #include "p_local.h"
 #include "p_map.h"
 #include "p_maputl.h"
@@ -24,6 +25,7 @@
 #include "p_setup.h"
 #include "p_tick.h"
 #include "PsyDoom/Game.h"
+#include "PsyDoom/ThinkerPool.h"
 
 #include <algorithm>
 #include <cstdio>
@@ -68,9 +70,10 @@ void P_RemoveMobj(mobj_t& mobj) noexcept {
     #if PSYDOOM_MODS
         P_WeakReferencedDestroyed(mobj);    // PsyDoom: weak references to this object are now nulled
         mobj.~mobj_t();                     // PsyDoom: destroy C++ weak pointers
+        ThinkerPool::dealloc(&mobj);
+    #else
+        Z_Free2(*gpMainMemZone, &mobj);
     #endif
-
-    Z_Free2(*gpMainMemZone, &mobj);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -144,6 +147,9 @@ void P_RespawnSpecials() noexcept {
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Sets the state for the given map object.
 // Returns 'true' if the map object is still present and hasn't been removed - it's removed if the state switch is to 'S_NULL'.
+//
+// Note: unlike PC Doom, this does NOT loop through zero tic states - only a single state is entered and the action function (if any) is
+// called once. Zero tic states are instead handled naturally by 'P_MobjThinker' on the next tick, so there are no state chains to collapse.
 //------------------------------------------------------------------------------------------------------------------------------------------
 bool P_SetMobjState(mobj_t& mobj, const statenum_t stateNum) noexcept {
     // Remove the map object if the state is null
@@ -206,7 +212,11 @@ void P_ExplodeMissile(mobj_t& mobj) noexcept {
 //------------------------------------------------------------------------------------------------------------------------------------------
 mobj_t* P_SpawnMobj(const fixed_t x, const fixed_t y, const fixed_t z, const mobjtype_t type) noexcept {
     // Alloc and zero initialize the map object
-    mobj_t& mobj = *(mobj_t*) Z_Malloc(*gpMainMemZone, sizeof(mobj_t), PU_LEVEL, nullptr);
+    #if PSYDOOM_MODS
+        mobj_t& mobj = ThinkerPool::alloc<mobj_t>(PU_LEVEL);
+    #else
+        mobj_t& mobj = *(mobj_t*) Z_Malloc(*gpMainMemZone, sizeof(mobj_t), PU_LEVEL, nullptr);
+    #endif
     D_memset(&mobj, std::byte(0), sizeof(mobj_t));
 
     #if PSYDOOM_MODS
@@ -225,6 +235,13 @@ mobj_t* P_SpawnMobj(const fixed_t x, const fixed_t y, const fixed_t z, const mob
     mobj.health = info.spawnhealth;
     mobj.reactiontime = info.reactiontime;
 
+    // PsyDoom: opt regular walking monsters into flow field pathing, if enabled
+    #if PSYDOOM_MODS
+        if (Game::gSettings.bUseMonsterFlowFields && P_IsFlowFieldMonsterType(info)) {
+            mobj.flags |= MF_FLOWFIELD;
+        }
+    #endif
+
     // Set initial state and state related stuff.
     // Note: can't set state with P_SetMobjState, because actions can't be called yet (thing not fully initialized).
     state_t& state = gStates[info.spawnstate];
@@ -187,6 +187,11 @@ static int32_t PM_PointOnLineSide(const fixed_t x, const fixed_t y, const line_t
 // Very similar to 'P_UnsetThingPosition' except the thing is always unlinked from sectors.
 //------------------------------------------------------------------------------------------------------------------------------------------
 static void PM_UnsetThingPosition(mobj_t& thing) noexcept {
+    // PsyDoom: unlink the thing from the sectors that it touches
+    #if PSYDOOM_MODS
+        P_UnlinkTouchingSectors(thing);
+    #endif
+
     // Remove the thing from sector thing lists
     if (thing.snext) {
         thing.snext->sprev = thing.sprev;
@@ -201,6 +206,11 @@ static void PM_UnsetThingPosition(mobj_t& thing) noexcept {
     // Does this thing get added to the blockmap?
     // If so remove it from the blockmap.
     if ((thing.flags & MF_NOBLOCKMAP) == 0) {
+        // PsyDoom: remove the thing from the packed list of things for the blockmap cell too
+        #if PSYDOOM_MODS
+            P_RemoveBlockThing(thing);
+        #endif
+
         if (thing.bnext) {
             thing.bnext->bprev = thing.bprev;
         }
@@ -267,11 +277,21 @@ static void PM_SetThingPosition(mobj_t& mobj) noexcept {
             }
 
             blockList = &mobj;
+
+            // PsyDoom: add the thing to the packed list of things for the blockmap cell too
+            #if PSYDOOM_MODS
+                P_AddBlockThing(mobj, blockY * gBlockmapWidth + blockX);
+            #endif
         } else {
             mobj.bprev = nullptr;
             mobj.bnext = nullptr;
         }
     }
+
+    // PsyDoom: link the thing to the sectors that it touches
+    #if PSYDOOM_MODS
+        P_LinkTouchingSectors(mobj);
+    #endif
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -603,25 +623,59 @@ static bool PIT_CheckThing(mobj_t& mobj) noexcept {
 // Returns 'false' if there is a definite collision, 'true' otherwise.
 //------------------------------------------------------------------------------------------------------------------------------------------
 static bool PM_BlockLinesIterator(const int32_t x, const int32_t y) noexcept {
-    // Get the line list for this blockmap cell
-    const int16_t* pLineNum = (int16_t*)(gpBlockmapLump + gpBlockmap[y * gBlockmapWidth + x]);
+    // PsyDoom: use the packed line lists to skip lines with bounding boxes outside the test box, without touching the lines.
+    // These lines would be rejected by 'PM_BoxCrossLine' anyway, no matter how many times they are tested.
+    #if PSYDOOM_MODS
+        const blocklines_t& blockLines = gBlockLines;
+        const int32_t cellIdx = y * gBlockmapWidth + x;
+        const uint32_t endIdx = blockLines.cellStart[cellIdx + 1];
 
-    // Visit all lines in the cell, checking for intersection and potential collision.
-    // Stop when there is a definite collision.
-    line_t* const pLines = gpLines;
+        const fixed_t testTop = gTestTmBBox[BOXTOP];
+        const fixed_t testBottom = gTestTmBBox[BOXBOTTOM];
+        const fixed_t testLeft = gTestTmBBox[BOXLEFT];
+        const fixed_t testRight = gTestTmBBox[BOXRIGHT];
 
-    for (; *pLineNum != -1; ++pLineNum) {
-        line_t& line = pLines[*pLineNum];
+        for (uint32_t i = blockLines.cellStart[cellIdx]; i < endIdx; ++i) {
+            const bool bTestBBOutsideLineBB = (
+                (testTop <= blockLines.bboxBottom[i]) ||
+                (testBottom >= blockLines.bboxTop[i]) ||
+                (testLeft >= blockLines.bboxRight[i]) ||
+                (testRight <= blockLines.bboxLeft[i])
+            );
 
-        // Only check the line if not already checked this test
-        if (line.validcount != gValidCount) {
-            line.validcount = gValidCount;
+            if (bTestBBOutsideLineBB)
+                continue;
 
-            // If it's collided with and definitely blocking then stop
-            if (PM_BoxCrossLine(line) && (!PIT_CheckLine(line)))
-                return false;
+            line_t& line = gpLines[blockLines.lineNum[i]];
+
+            if (line.validcount != gValidCount) {
+                line.validcount = gValidCount;
+
+                if (PM_BoxCrossLine(line) && (!PIT_CheckLine(line)))
+                    return false;
+            }
         }
-    }
+    #else
+        // Get the line list for this blockmap cell
+        const int16_t* pLineNum = (int16_t*)(gpBlockmapLump + gpBlockmap[y * gBlockmapWidth + x]);
+
+        // Visit all lines in the cell, checking for intersection and potential collision.
+        // Stop when there is a definite collision.
+        line_t* const pLines = gpLines;
+
+        for (; *pLineNum != -1; ++pLineNum) {
+            line_t& line = pLines[*pLineNum];
+
+            // Only check the line if not already checked this test
+            if (line.validcount != gValidCount) {
+                line.validcount = gValidCount;
+
+                // If it's collided with and definitely blocking then stop
+                if (PM_BoxCrossLine(line) && (!PIT_CheckLine(line)))
+                    return false;
+            }
+        }
+    #endif
 
     return true;
 }
@@ -631,10 +685,24 @@ static bool PM_BlockLinesIterator(const int32_t x, const int32_t y) noexcept {
 // In some cases the thing collided with is saved in 'gpMoveThing' for futher interactions like pickups and damaging.
 //------------------------------------------------------------------------------------------------------------------------------------------
 static bool PM_BlockThingsIterator(const int32_t x, const int32_t y) noexcept {
-    for (mobj_t* pmobj = gppBlockLinks[x + y * gBlockmapWidth]; pmobj; pmobj = pmobj->bnext) {
-        if (!PIT_CheckThing(*pmobj))
-            return false;
-    }
+    // PsyDoom: use the packed list of things for the cell to skip things which are definitely out of range without touching them.
+    // 'PIT_CheckThing' does nothing for those things, and it never links or unlinks things so it is safe to iterate the list here.
+    #if PSYDOOM_MODS
+        const std::vector<blockthing_t>& blockThings = P_GetBlockThings(x, y);
+        const fixed_t moverRadius = gpTryMoveThing->radius;
+
+        for (size_t i = blockThings.size(); i > 0; --i) {
+            const blockthing_t& thing = blockThings[i - 1];
+
+            if (P_IsBlockThingInRange(thing, gTryMoveX, gTryMoveY, moverRadius) && (!PIT_CheckThing(*thing.pMobj)))
+                return false;
+        }
+    #else
+        for (mobj_t* pmobj = gppBlockLinks[x + y * gBlockmapWidth]; pmobj; pmobj = pmobj->bnext) {
+            if (!PIT_CheckThing(*pmobj))
+                return false;
+        }
+    #endif
 
     return true;
 }
@@ -17,10 +17,15 @@
 #include "p_local.h"
 #include "p_map.h"
 #include "p_mobj.h"
+#include "p_setup.h"
 #include "p_tick.h"
 #include "PsyDoom/Config/Config.h"
 #include "PsyDoom/Game.h"
 
+#if PSYDOOM_MODS
+    #include <vector>
+#endif
+
 const weaponinfo_t gWeaponInfo[NUMWEAPONS] = {
     {   // Fist
         am_noammo,              // ammo
@@ -109,6 +114,64 @@ static fixed_t  gBulletSlope;                   // Vertical aiming slope for sho
 // How many unsimulated player sprite vblanks there are
 int32_t gTicRemainder[MAXPLAYERS];
 
+#if PSYDOOM_MODS
+    // PsyDoom: the cached result of flood filling sound from a particular sector.
+    // Holds every sector reached by the flood and the final 'soundtraversed' value it was given.
+    struct soundflood_t {
+        sector_t*       pSector;
+        int32_t         soundTraversed;
+    };
+
+    struct soundfloodcache_t {
+        sector_t*                   pOrigin;        // Sector the flood started in or 'nullptr' if the cache entry is unused
+        uint32_t                    generation;     // Value of 'gSoundGeneration' when the flood was done; the entry is stale if it doesn't match
+        std::vector<soundflood_t>   sectors;        // Sectors reached by the flood
+    };
+
+    // PsyDoom: how many sound flood results to cache and the cached results
+    static constexpr uint32_t NUM_SOUND_FLOOD_CACHE_ENTRIES = 8;
+
+    static soundfloodcache_t    gSoundFloodCache[NUM_SOUND_FLOOD_CACHE_ENTRIES];
+    static uint32_t             gNextSoundFloodCacheEntry;
+
+    // PsyDoom: the current state of every line with regard to sound propagation, as per 'P_GetLineSoundState'.
+    // Whenever the state of a line changes (a door opens or closes etc.) the sound generation is incremented, invalidating all cached floods.
+    static std::vector<uint8_t>     gLineSoundState;
+    static uint32_t                 gSoundGeneration;
+
+    // PsyDoom: if set then 'P_RecursiveSound' records each sector reached by the flood into this list
+    static std::vector<soundflood_t>* gpRecordSoundFlood;
+#endif
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tells if sound can travel through the opening between the two given sectors of a two-sided line
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool P_CanSoundPassBetween(const sector_t& frontSector, const sector_t& backSector) noexcept {
+    // If the sector is a closed door then sound can't pass through it.
+    // PsyDoom: this logic is bugged - won't work on closed 'window' doors like the small one in E1M3, fix:
+    #if PSYDOOM_MODS
+        const bool bFixSoundPropagation = Game::gSettings.bFixSoundPropagation;
+    #else
+        constexpr bool bFixSoundPropagation = false;
+    #endif
+
+    if (bFixSoundPropagation) {
+        // Fixed logic: only allow sound to pass if there is an opening or air gap between the sectors
+        const fixed_t openingTop = std::min(frontSector.ceilingheight, backSector.ceilingheight);
+        const fixed_t openingBot = std::max(frontSector.floorheight, backSector.floorheight);
+        return (openingTop > openingBot);
+    } else {
+        // Original logic, which fails on certain kinds of closed doors and allows sound through when it shouldn't...
+        if (frontSector.floorheight >= backSector.ceilingheight)
+            return false;
+
+        if (frontSector.ceilingheight <= backSector.floorheight)
+            return false;
+
+        return true;
+    }
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Recursively flood fill sound starting from the given sector to other neighboring sectors considered valid for sound transfer.
 // Aside from closed doors, walls etc. stopping sound propagation sound will also be stopped after two sets of 'ML_SOUNDBLOCK' 
@@ -121,6 +184,13 @@ static void P_RecursiveSound(sector_t& sector, const bool bStopOnSoundBlock) noe
     if ((sector.validcount == gValidCount) && (sector.soundtraversed <= soundTraversed))
         return;
 
+    // PsyDoom: record the sector if it's the first time reaching it and a sound flood is being recorded
+    #if PSYDOOM_MODS
+        if (gpRecordSoundFlood && (sector.validcount != gValidCount)) {
+            gpRecordSoundFlood->push_back({ &sector, soundTraversed });
+        }
+    #endif
+
     // Flood fill this sector and save the thing that made noise and whether sound was blocked
     sector.validcount = gValidCount;
     sector.soundtraversed = soundTraversed;
@@ -137,29 +207,9 @@ static void P_RecursiveSound(sector_t& sector, const bool bStopOnSoundBlock) noe
 
         sector_t& frontSector = *line.frontsector;
 
-        // If the sector is a closed door then sound can't pass through it.
-        // PsyDoom: this logic is bugged - won't work on closed 'window' doors like the small one in E1M3, fix:
-        #if PSYDOOM_MODS
-            const bool bFixSoundPropagation = Game::gSettings.bFixSoundPropagation;
-        #else
-            constexpr bool bFixSoundPropagation = false;
-        #endif
-
-        if (bFixSoundPropagation) {
-            // Fixed logic: only allow sound to pass if there is an opening or air gap between the sectors
-            const fixed_t openingTop = std::min(frontSector.ceilingheight, pBackSector->ceilingheight);
-            const fixed_t openingBot = std::max(frontSector.floorheight, pBackSector->floorheight);
-            
-            if (openingTop <= openingBot)
-                continue;
-        } else {
-            // Original logic, which fails on certain kinds of closed doors and allows sound through when it shouldn't...
-            if (frontSector.floorheight >= pBackSector->ceilingheight)
-                continue;
-
-            if (frontSector.ceilingheight <= pBackSector->floorheight)
-                continue;
-        }
+        // If the sector is a closed door then sound can't pass through it
+        if (!P_CanSoundPassBetween(frontSector, *pBackSector))
+            continue;
 
         // Need to recurse into the sector on the opposite side of this sector's line
         sector_t& checkSector = (&frontSector == &sector) ? *pBackSector : frontSector;
@@ -175,6 +225,129 @@ static void P_RecursiveSound(sector_t& sector, const bool bStopOnSoundBlock) noe
     }
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Flood fills sound starting from the given sector, with the given thing being the one which made the noise.
+// PsyDoom: replays the cached result of a previous flood from the same sector if nothing affecting sound propagation changed since.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void P_FloodSound(sector_t& origin, mobj_t& noiseMaker) noexcept {
+    gValidCount++;
+    gpSoundTarget = &noiseMaker;
+
+    #if PSYDOOM_MODS
+        // Can't cache anything if the line states haven't been initialized for the level
+        if (gLineSoundState.empty()) {
+            P_RecursiveSound(origin, false);
+            return;
+        }
+
+        // Is there a cached result for this sector? If so then just replay it, otherwise reuse the stale entry for the sector (if any):
+        soundfloodcache_t* pCacheEntry = nullptr;
+
+        for (soundfloodcache_t& cacheEntry : gSoundFloodCache) {
+            if (cacheEntry.pOrigin != &origin)
+                continue;
+
+            if (cacheEntry.generation == gSoundGeneration) {
+                for (const soundflood_t& flood : cacheEntry.sectors) {
+                    sector_t& sector = *flood.pSector;
+                    sector.validcount = gValidCount;
+                    sector.soundtraversed = flood.soundTraversed;
+                    sector.soundtarget = &noiseMaker;
+                }
+
+                return;
+            }
+
+            pCacheEntry = &cacheEntry;
+            break;
+        }
+
+        // Not cached: do the flood and record the result, evicting the oldest cache entry if required
+        if (!pCacheEntry) {
+            pCacheEntry = &gSoundFloodCache[gNextSoundFloodCacheEntry];
+            gNextSoundFloodCacheEntry = (gNextSoundFloodCacheEntry + 1) % NUM_SOUND_FLOOD_CACHE_ENTRIES;
+        }
+
+        pCacheEntry->pOrigin = &origin;
+        pCacheEntry->generation = gSoundGeneration;
+        pCacheEntry->sectors.clear();
+
+        gpRecordSoundFlood = &pCacheEntry->sectors;
+        P_RecursiveSound(origin, false);
+        gpRecordSoundFlood = nullptr;
+
+        // Sectors can be flooded multiple times (if later reached without passing a sound block) so save the final sound traversed values
+        for (soundflood_t& flood : pCacheEntry->sectors) {
+            flood.soundTraversed = flood.pSector->soundtraversed;
+        }
+    #else
+        P_RecursiveSound(origin, false);
+    #endif
+}
+
+#if PSYDOOM_MODS
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: get the state of a line with regard to sound propagation: whether sound can pass through it and whether it is a sound block line
+//------------------------------------------------------------------------------------------------------------------------------------------
+static uint8_t P_GetLineSoundState(const line_t& line) noexcept {
+    if (!line.backsector)
+        return 0;
+
+    const uint8_t bCanPass = P_CanSoundPassBetween(*line.frontsector, *line.backsector);
+    const uint8_t bSoundBlock = ((line.flags & ML_SOUNDBLOCK) != 0);
+    return (uint8_t)(bCanPass | (bSoundBlock << 1));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: initializes the sound propagation state of all lines and clears all cached sound floods.
+// Must be called once the level has loaded and whenever the level state is restored wholesale (loading a save).
+//------------------------------------------------------------------------------------------------------------------------------------------
+void P_InitSoundPropagation() noexcept {
+    gLineSoundState.clear();
+    gLineSoundState.reserve((size_t) gNumLines);
+
+    for (int32_t lineIdx = 0; lineIdx < gNumLines; ++lineIdx) {
+        gLineSoundState.push_back(P_GetLineSoundState(gpLines[lineIdx]));
+    }
+
+    for (soundfloodcache_t& cacheEntry : gSoundFloodCache) {
+        cacheEntry.pOrigin = nullptr;
+        cacheEntry.sectors.clear();
+    }
+
+    gNextSoundFloodCacheEntry = 0;
+    gSoundGeneration++;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: should be called whenever the flags of a line change.
+// Invalidates all cached sound floods if the line's sound propagation state changed.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void P_UpdateLineSoundPropagation(const line_t& line) noexcept {
+    const int32_t lineIdx = (int32_t)(&line - gpLines);
+
+    if ((lineIdx < 0) || ((size_t) lineIdx >= gLineSoundState.size()))
+        return;
+
+    const uint8_t newState = P_GetLineSoundState(line);
+
+    if (gLineSoundState[lineIdx] != newState) {
+        gLineSoundState[lineIdx] = newState;
+        gSoundGeneration++;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: should be called whenever the floor or ceiling height of a sector changes.
+// Invalidates all cached sound floods if the state of any of the sector's lines changed (doors opening or closing etc.).
+//------------------------------------------------------------------------------------------------------------------------------------------
+void P_UpdateSectorSoundPropagation(const sector_t& sector) noexcept {
+    for (int32_t lineIdx = 0; lineIdx < sector.linecount; ++lineIdx) {
+        P_UpdateLineSoundPropagation(*sector.lines[lineIdx]);
+    }
+}
+#endif  // #if PSYDOOM_MODS
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Called after using weapons: make noise to alert sleeping monsters of the given player
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -187,11 +360,9 @@ static void P_NoiseAlert(player_t& player) noexcept {
         return;
 
     player.lastsoundsector = &curSector;
-    gValidCount++;
-    gpSoundTarget = &playerMobj;
 
     // Recursively flood fill sectors with sound
-    P_RecursiveSound(curSector, false);
+    P_FloodSound(curSector, playerMobj);
 }
 
 #if PSYDOOM_MODS
@@ -200,9 +371,7 @@ static void P_NoiseAlert(player_t& player) noexcept {
 // Intended to be called from scripts, can be used to do scripted monster alerting.
 //------------------------------------------------------------------------------------------------------------------------------------------
 void P_NoiseAlertToMobj(mobj_t& noiseMaker) noexcept {
-    gValidCount++;
-    gpSoundTarget = &noiseMaker;
-    P_RecursiveSound(*noiseMaker.subsector->sector, false);
+    P_FloodSound(*noiseMaker.subsector->sector, noiseMaker);
 }
 #endif
 
@@ -4,8 +4,13 @@
 
 extern int32_t gTicRemainder[MAXPLAYERS];
 
+struct line_t;
+
 #if PSYDOOM_MODS
     void P_NoiseAlertToMobj(mobj_t& noiseMaker) noexcept;
+    void P_InitSoundPropagation() noexcept;
+    void P_UpdateLineSoundPropagation(const line_t& line) noexcept;
+    void P_UpdateSectorSoundPropagation(const sector_t& sector) noexcept;
 #endif
 
 void P_SetPsprite(player_t& player, const int32_t spriteIdx, const statenum_t stateNum) noexcept;
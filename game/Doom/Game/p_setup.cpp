@@ -17,14 +17,18 @@
 #include "doomdata.h"
 #include "g_game.h"
 #include "info.h"
+#include "p_change.h"
 #include "p_doors.h"
 #include "p_enemy.h"
 #include "p_firesky.h"
 #include "p_floor.h"
+#include "p_flowfield.h"
 #include "p_inter.h"
 #include "p_local.h"
 #include "p_maputl.h"
 #include "p_mobj.h"
+#include "p_pspr.h"
+#include "p_sight.h"
 #include "p_spec.h"
 #include "p_switch.h"
 #include "p_tick.h"
@@ -39,6 +43,8 @@
 #include "PsyDoom/MobjSpritePrecacher.h"
 #include "PsyDoom/ModMgr.h"
 #include "PsyDoom/ScriptingEngine.h"
+#include "PsyDoom/ThinkerPool.h"
+#include "PsyDoom/wad_compat.h"
 
 #include <algorithm>
 #include <cstdio>
@@ -115,6 +121,11 @@ mapthing_t*     gpDeathmatchP;                                  // Points past t
 // Is the map being loaded a Final Doom format map?
 static bool gbLoadingFinalDoomMap;
 
+// PsyDoom limit removing: is the map being loaded in the extended (32-bit index) map format?
+#if PSYDOOM_LIMIT_REMOVING
+    static bool gbLoadingExtendedMap;
+#endif
+
 // Function to update the fire sky.
 // Set when the map has a fire sky, otherwise null.
 void (*gUpdateFireSkyFunc)(texture_t& skyTex) = nullptr;
@@ -199,39 +210,52 @@ static void P_ActivateAllBossSpecials() noexcept {
 }
 #endif  // #if PSYDOOM_MODS
 
+#if PSYDOOM_LIMIT_REMOVING
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom limit removing helper: returns the decoded data for the specified map lump, which is 'lumpSize' bytes in size.
+// Where possible the data is parsed in place from the map lumps already loaded into memory, with no copying. Otherwise the lump is read
+// into the temporary buffer. The returned data is only valid until the temporary buffer is next used or the next map WAD is opened.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static const std::byte* P_GetMapLumpData(const int32_t lumpNum, const int32_t lumpSize) noexcept {
+    if (const std::byte* const pLumpData = W_GetMapLumpData(lumpNum))
+        return pLumpData;
+
+    gTmpBuffer.ensureSize(lumpSize);
+    W_ReadMapLump(lumpNum, gTmpBuffer.bytes(), true);
+    return gTmpBuffer.bytes();
+}
+#endif
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Load map vertex data from the specified map lump number
 //------------------------------------------------------------------------------------------------------------------------------------------
 static void P_LoadVertexes(const int32_t lumpNum) noexcept {
-    // Sanity check the vertices lump is not too big.
-    // PsyDoom: if limit removing, just ensure the buffer is big enough instead - any size of data is allowed.
+    // Sanity check the vertices lump is not too big and read it into a temp buffer from the map WAD.
+    // PsyDoom: if limit removing then any size of data is allowed, and the lump is parsed in place where possible.
     const int32_t lumpSize = W_MapLumpLength(lumpNum);
 
     #if PSYDOOM_LIMIT_REMOVING
-        gTmpBuffer.ensureSize(lumpSize);
-        std::byte* const pTmpBufferBytes = gTmpBuffer.bytes();
+        const std::byte* const pLumpBytes = P_GetMapLumpData(lumpNum, lumpSize);
     #else
         if (lumpSize > TMP_BUFFER_SIZE) {
             I_Error("P_LoadVertexes: lump > 64K");
         }
 
-        std::byte* const pTmpBufferBytes = gTmpBuffer;
+        std::byte* const pLumpBytes = gTmpBuffer;
+        W_ReadMapLump(lumpNum, pLumpBytes, true);
     #endif
 
     // Alloc the runtime vertex array
     gNumVertexes = lumpSize / sizeof(mapvertex_t);
     gpVertexes = (vertex_t*) Z_Malloc(*gpMainMemZone, gNumVertexes * sizeof(vertex_t), PU_LEVEL, nullptr);
 
-    // Read the WAD vertexes into the temp buffer from the map WAD
-    W_ReadMapLump(lumpNum, pTmpBufferBytes, true);
-
     // PsyDoom: add to the hash for the map
     #if PSYDOOM_MODS
-        MapHash::addData(pTmpBufferBytes, lumpSize);
+        MapHash::addData(pLumpBytes, lumpSize);
     #endif
 
     // Convert the vertexes to the renderer runtime format
-    const mapvertex_t* pSrcVertex = (const mapvertex_t*) pTmpBufferBytes;
+    const mapvertex_t* pSrcVertex = (const mapvertex_t*) pLumpBytes;
     vertex_t* pDstVertex = gpVertexes;
 
     for (int32_t vertexIdx = 0; vertexIdx < gNumVertexes; ++vertexIdx) {
@@ -247,123 +271,162 @@ static void P_LoadVertexes(const int32_t lumpNum) noexcept {
 // Load line segments from the specified map lump number
 //------------------------------------------------------------------------------------------------------------------------------------------
 static void P_LoadSegs(const int32_t lumpNum) noexcept {
-    // Sanity check the segs lump is not too big.
-    // PsyDoom: if limit removing, just ensure the buffer is big enough instead - any size of data is allowed.
+    // Sanity check the segs lump is not too big and read it into a temp buffer from the map WAD.
+    // PsyDoom: if limit removing then any size of data is allowed, and the lump is parsed in place where possible.
     const int32_t lumpSize = W_MapLumpLength(lumpNum);
 
     #if PSYDOOM_LIMIT_REMOVING
-        gTmpBuffer.ensureSize(lumpSize);
-        std::byte* const pTmpBufferBytes = gTmpBuffer.bytes();
+        const std::byte* const pLumpBytes = P_GetMapLumpData(lumpNum, lumpSize);
     #else
         if (lumpSize > TMP_BUFFER_SIZE) {
             I_Error("P_LoadSegs: lump > 64K");
         }
 
-        std::byte* const pTmpBufferBytes = gTmpBuffer;
+        std::byte* const pLumpBytes = gTmpBuffer;
+        W_ReadMapLump(lumpNum, pLumpBytes, true);
+    #endif
+
+    // Alloc ram for the runtime segs and zero initialize.
+    // PsyDoom limit removing: segs might be in the extended map format.
+    #if PSYDOOM_LIMIT_REMOVING
+        gNumSegs = lumpSize / ((gbLoadingExtendedMap) ? sizeof(mapseg_ext_t) : sizeof(mapseg_t));
+    #else
+        gNumSegs = lumpSize / sizeof(mapseg_t);
     #endif
 
-    // Alloc ram for the runtime segs and zero initialize
-    gNumSegs = lumpSize / sizeof(mapseg_t);
     gpSegs = (seg_t*) Z_Malloc(*gpMainMemZone, gNumSegs * sizeof(seg_t), PU_LEVEL, nullptr);
     D_memset(gpSegs, std::byte(0), gNumSegs * sizeof(seg_t));
 
-    // Read the map lump containing the segs into a temp buffer from the map WAD
-    W_ReadMapLump(lumpNum, pTmpBufferBytes, true);
-
     // PsyDoom: add to the hash for the map
     #if PSYDOOM_MODS
-        MapHash::addData(pTmpBufferBytes, lumpSize);
+        MapHash::addData(pLumpBytes, lumpSize);
     #endif
 
     // Process the WAD segs and convert them into runtime segs
-    const mapseg_t* pSrcSeg = (const mapseg_t*) pTmpBufferBytes;
-    seg_t* pDstSeg = gpSegs;
-
-    for (int32_t segIdx = 0; segIdx < gNumSegs; ++segIdx) {
-        // Store basic seg properties
-        pDstSeg->vertex1 = &gpVertexes[Endian::littleToHost(pSrcSeg->vertex1)];
-        pDstSeg->vertex2 = &gpVertexes[Endian::littleToHost(pSrcSeg->vertex2)];
-        pDstSeg->angle = (angle_t) d_int_to_fixed(pSrcSeg->angle);                  // Weird, but it is what it is...
-        pDstSeg->offset = d_int_to_fixed(Endian::littleToHost(pSrcSeg->offset));
-
-        // Figure out seg line and side
-        line_t& linedef = gpLines[Endian::littleToHost(pSrcSeg->linedef)];
-        pDstSeg->linedef = &linedef;
-
-        const int32_t sideNum = linedef.sidenum[Endian::littleToHost(pSrcSeg->side)];
-        side_t& side = gpSides[sideNum];
-        pDstSeg->sidedef = &side;
-
-        // Set front and backsector reference
-        pDstSeg->frontsector = side.sector;
-
-        if (linedef.flags & ML_TWOSIDED) {
-            const int32_t backSideNum = linedef.sidenum[Endian::littleToHost(pSrcSeg->side) ^ 1];
-            side_t& backSide = gpSides[backSideNum];
-            pDstSeg->backsector = backSide.sector;
-        } else {
-            pDstSeg->backsector = nullptr;
-        }
+    auto processWadSegs = [&](auto pWadSegs) noexcept {
+        const auto* pSrcSeg = pWadSegs;
+        seg_t* pDstSeg = gpSegs;
+
+        for (int32_t segIdx = 0; segIdx < gNumSegs; ++segIdx) {
+            // Store basic seg properties
+            pDstSeg->vertex1 = &gpVertexes[Endian::littleToHost(pSrcSeg->vertex1)];
+            pDstSeg->vertex2 = &gpVertexes[Endian::littleToHost(pSrcSeg->vertex2)];
+            pDstSeg->angle = (angle_t) d_int_to_fixed(pSrcSeg->angle);                  // Weird, but it is what it is...
+            pDstSeg->offset = d_int_to_fixed(Endian::littleToHost(pSrcSeg->offset));
+
+            // Figure out seg line and side
+            line_t& linedef = gpLines[Endian::littleToHost(pSrcSeg->linedef)];
+            pDstSeg->linedef = &linedef;
+
+            const int32_t sideNum = linedef.sidenum[Endian::littleToHost(pSrcSeg->side)];
+            side_t& side = gpSides[sideNum];
+            pDstSeg->sidedef = &side;
+
+            // Set front and backsector reference
+            pDstSeg->frontsector = side.sector;
+
+            if (linedef.flags & ML_TWOSIDED) {
+                const int32_t backSideNum = linedef.sidenum[Endian::littleToHost(pSrcSeg->side) ^ 1];
+                side_t& backSide = gpSides[backSideNum];
+                pDstSeg->backsector = backSide.sector;
+            } else {
+                pDstSeg->backsector = nullptr;
+            }
 
-        // Take this opportunity to compute line fineangle if the seg is pointing in the same direction
-        if (linedef.vertex1 == pDstSeg->vertex1) {
-            linedef.fineangle = pDstSeg->angle >> ANGLETOFINESHIFT;
+            // Take this opportunity to compute line fineangle if the seg is pointing in the same direction
+            if (linedef.vertex1 == pDstSeg->vertex1) {
+                linedef.fineangle = pDstSeg->angle >> ANGLETOFINESHIFT;
+            }
+
+            ++pSrcSeg;
+            ++pDstSeg;
         }
+    };
 
-        ++pSrcSeg;
-        ++pDstSeg;
-    }
+    #if PSYDOOM_LIMIT_REMOVING
+        if (gbLoadingExtendedMap) {
+            processWadSegs((const mapseg_ext_t*) pLumpBytes);
+        } else {
+            processWadSegs((const mapseg_t*) pLumpBytes);
+        }
+    #else
+        processWadSegs((const mapseg_t*) pLumpBytes);
+    #endif
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Load map subsectors using data from the specified map lump number
 //------------------------------------------------------------------------------------------------------------------------------------------
 static void P_LoadSubSectors(const int32_t lumpNum) noexcept {
-    // Sanity check the subsectors lump is not too big.
-    // PsyDoom: if limit removing, just ensure the buffer is big enough instead - any size of data is allowed.
+    // Sanity check the subsectors lump is not too big and read it into a temp buffer from the map WAD.
+    // PsyDoom: if limit removing then any size of data is allowed, and the lump is parsed in place where possible.
     const int32_t lumpSize = W_MapLumpLength(lumpNum);
 
     #if PSYDOOM_LIMIT_REMOVING
-        gTmpBuffer.ensureSize(lumpSize);
-        std::byte* const pTmpBufferBytes = gTmpBuffer.bytes();
+        const std::byte* const pLumpBytes = P_GetMapLumpData(lumpNum, lumpSize);
     #else
         if (lumpSize > TMP_BUFFER_SIZE) {
             I_Error("P_LoadSubsectors: lump > 64K");
         }
 
-        std::byte* const pTmpBufferBytes = gTmpBuffer;
+        std::byte* const pLumpBytes = gTmpBuffer;
+        W_ReadMapLump(lumpNum, pLumpBytes, true);
+    #endif
+
+    // Alloc ram for the runtime subsectors and zero initialize.
+    // PsyDoom limit removing: subsectors might be in the extended map format.
+    #if PSYDOOM_LIMIT_REMOVING
+        gNumSubsectors = lumpSize / ((gbLoadingExtendedMap) ? sizeof(mapsubsector_ext_t) : sizeof(mapsubsector_t));
+    #else
+        gNumSubsectors = lumpSize / sizeof(mapsubsector_t);
     #endif
 
-    // Alloc ram for the runtime subsectors and zero initialize
-    gNumSubsectors = lumpSize / sizeof(mapsubsector_t);
     gpSubsectors = (subsector_t*) Z_Malloc(*gpMainMemZone, gNumSubsectors * sizeof(subsector_t), PU_LEVEL, nullptr);
     D_memset(gpSubsectors, std::byte(0), gNumSubsectors * sizeof(subsector_t));
 
-    // Read the map lump containing the subsectors into a temp buffer from the map WAD
-    W_ReadMapLump(lumpNum, pTmpBufferBytes, true);
-
     // PsyDoom: add to the hash for the map
     #if PSYDOOM_MODS
-        MapHash::addData(pTmpBufferBytes, lumpSize);
+        MapHash::addData(pLumpBytes, lumpSize);
     #endif
 
     // Process the WAD subsectors and convert them into runtime subsectors
-    const mapsubsector_t* pSrcSubsec = (const mapsubsector_t*) pTmpBufferBytes;
-    subsector_t* pDstSubsec = gpSubsectors;
+    auto processWadSubsectors = [&](auto pWadSubsecs) noexcept {
+        const auto* pSrcSubsec = pWadSubsecs;
+        subsector_t* pDstSubsec = gpSubsectors;
 
-    for (int32_t subsectorIdx = 0; subsectorIdx < gNumSubsectors; ++subsectorIdx) {
-        pDstSubsec->numsegs = Endian::littleToHost(pSrcSubsec->numsegs);
-        pDstSubsec->firstseg = Endian::littleToHost(pSrcSubsec->firstseg);
-        pDstSubsec->numLeafEdges = 0;
-        pDstSubsec->firstLeafEdge = 0;
+        for (int32_t subsectorIdx = 0; subsectorIdx < gNumSubsectors; ++subsectorIdx) {
+            const int32_t numSegs = Endian::littleToHost(pSrcSubsec->numsegs);
 
-        #if PSYDOOM_MODS
-            pDstSubsec->vkDrawSubsecIdx = -1;   // Initialize as 'not drawn' for new the Vulkan renderer
-        #endif
+            // PsyDoom limit removing: the seg count for a single subsector must still fit in 16-bits
+            #if PSYDOOM_LIMIT_REMOVING
+                if ((numSegs < 0) || (numSegs > INT16_MAX)) {
+                    I_Error("P_LoadSubsectors: bad seg count %d for ss %d!", numSegs, subsectorIdx);
+                }
+            #endif
 
-        ++pSrcSubsec;
-        ++pDstSubsec;
-    }
+            pDstSubsec->numsegs = (int16_t) numSegs;
+            pDstSubsec->firstseg = Endian::littleToHost(pSrcSubsec->firstseg);
+            pDstSubsec->numLeafEdges = 0;
+            pDstSubsec->firstLeafEdge = 0;
+
+            #if PSYDOOM_MODS
+                pDstSubsec->vkDrawSubsecIdx = -1;   // Initialize as 'not drawn' for new the Vulkan renderer
+            #endif
+
+            ++pSrcSubsec;
+            ++pDstSubsec;
+        }
+    };
+
+    #if PSYDOOM_LIMIT_REMOVING
+        if (gbLoadingExtendedMap) {
+            processWadSubsectors((const mapsubsector_ext_t*) pLumpBytes);
+        } else {
+            processWadSubsectors((const mapsubsector_t*) pLumpBytes);
+        }
+    #else
+        processWadSubsectors((const mapsubsector_t*) pLumpBytes);
+    #endif
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -587,56 +650,87 @@ static void P_LoadSectors(const int32_t lumpNum) noexcept {
 // Load map bsp nodes from the specified map lump number
 //------------------------------------------------------------------------------------------------------------------------------------------
 static void P_LoadNodes(const int32_t lumpNum) noexcept {
-    // Sanity check the nodes lump is not too big.
-    // PsyDoom: if limit removing, just ensure the buffer is big enough instead - any size of data is allowed.
+    // Sanity check the nodes lump is not too big and read it into a temp buffer from the map WAD.
+    // PsyDoom: if limit removing then any size of data is allowed, and the lump is parsed in place where possible.
     const int32_t lumpSize = W_MapLumpLength(lumpNum);
 
     #if PSYDOOM_LIMIT_REMOVING
-        gTmpBuffer.ensureSize(lumpSize);
-        std::byte* const pTmpBufferBytes = gTmpBuffer.bytes();
+        const std::byte* const pLumpBytes = P_GetMapLumpData(lumpNum, lumpSize);
     #else
         if (lumpSize > TMP_BUFFER_SIZE) {
             I_Error("P_LoadNodes: lump > 64K");
         }
 
-        std::byte* const pTmpBufferBytes = gTmpBuffer;
+        std::byte* const pLumpBytes = gTmpBuffer;
+        W_ReadMapLump(lumpNum, pLumpBytes, true);
     #endif
 
-    // Alloc ram for the runtime nodes
-    gNumBspNodes = lumpSize / sizeof(mapnode_t);
-    gpBspNodes = (node_t*) Z_Malloc(*gpMainMemZone, gNumBspNodes * sizeof(node_t), PU_LEVEL, nullptr);
+    // Alloc ram for the runtime nodes.
+    // PsyDoom limit removing: nodes might be in the extended map format.
+    #if PSYDOOM_LIMIT_REMOVING
+        gNumBspNodes = lumpSize / ((gbLoadingExtendedMap) ? sizeof(mapnode_ext_t) : sizeof(mapnode_t));
+    #else
+        gNumBspNodes = lumpSize / sizeof(mapnode_t);
+    #endif
 
-    // Read the map lump containing the nodes into a temp buffer from the map WAD
-    W_ReadMapLump(lumpNum, pTmpBufferBytes, true);
+    gpBspNodes = (node_t*) Z_Malloc(*gpMainMemZone, gNumBspNodes * sizeof(node_t), PU_LEVEL, nullptr);
 
     // PsyDoom: add to the hash for the map
     #if PSYDOOM_MODS
-        MapHash::addData(pTmpBufferBytes, lumpSize);
+        MapHash::addData(pLumpBytes, lumpSize);
     #endif
 
     // Process the WAD nodes and convert them into runtime nodes.
     // The format for nodes on the PSX appears identical to PC.
-    const mapnode_t* pSrcNode = (const mapnode_t*) pTmpBufferBytes;
-    node_t* pDstNode = gpBspNodes;
+    auto processWadNodes = [&](auto pWadNodes, [[maybe_unused]] const uint32_t wadSubsecFlag) noexcept {
+        const auto* pSrcNode = pWadNodes;
+        node_t* pDstNode = gpBspNodes;
+
+        for (int32_t nodeIdx = 0; nodeIdx < gNumBspNodes; ++nodeIdx) {
+            pDstNode->line.x = d_int_to_fixed(Endian::littleToHost(pSrcNode->x));
+            pDstNode->line.y = d_int_to_fixed(Endian::littleToHost(pSrcNode->y));
+            pDstNode->line.dx = d_int_to_fixed(Endian::littleToHost(pSrcNode->dx));
+            pDstNode->line.dy = d_int_to_fixed(Endian::littleToHost(pSrcNode->dy));
+
+            for (int32_t childIdx = 0; childIdx < 2; ++childIdx) {
+                // PsyDoom limit removing: the subsector flag is in a different bit for runtime nodes, so move it
+                #if PSYDOOM_LIMIT_REMOVING
+                    uint32_t childNum = Endian::littleToHost(pSrcNode->children[childIdx]);
 
-    for (int32_t nodeIdx = 0; nodeIdx < gNumBspNodes; ++nodeIdx) {
-        pDstNode->line.x = d_int_to_fixed(Endian::littleToHost(pSrcNode->x));
-        pDstNode->line.y = d_int_to_fixed(Endian::littleToHost(pSrcNode->y));
-        pDstNode->line.dx = d_int_to_fixed(Endian::littleToHost(pSrcNode->dx));
-        pDstNode->line.dy = d_int_to_fixed(Endian::littleToHost(pSrcNode->dy));
+                    if (childNum & wadSubsecFlag) {
+                        childNum = (childNum & (~wadSubsecFlag)) | NF_SUBSECTOR;
+                    }
 
-        for (int32_t childIdx = 0; childIdx < 2; ++childIdx) {
-            pDstNode->children[childIdx] = Endian::littleToHost(pSrcNode->children[childIdx]);
+                    pDstNode->children[childIdx] = (int32_t) childNum;
+                #else
+                    pDstNode->children[childIdx] = Endian::littleToHost(pSrcNode->children[childIdx]);
+                #endif
 
-            for (int32_t coordIdx = 0; coordIdx < 4; ++coordIdx) {
-                const fixed_t coord = d_int_to_fixed(Endian::littleToHost(pSrcNode->bbox[childIdx][coordIdx]));
-                pDstNode->bbox[childIdx][coordIdx] = coord;
+                for (int32_t coordIdx = 0; coordIdx < 4; ++coordIdx) {
+                    const fixed_t coord = d_int_to_fixed(Endian::littleToHost(pSrcNode->bbox[childIdx][coordIdx]));
+                    pDstNode->bbox[childIdx][coordIdx] = coord;
+                }
             }
+
+            ++pSrcNode;
+            ++pDstNode;
+        }
+    };
+
+    #if PSYDOOM_LIMIT_REMOVING
+        if (gbLoadingExtendedMap) {
+            processWadNodes((const mapnode_ext_t*) pLumpBytes, MAPNF_SUBSECTOR_EXT);
+        } else {
+            processWadNodes((const mapnode_t*) pLumpBytes, MAPNF_SUBSECTOR);
         }
+    #else
+        processWadNodes((const mapnode_t*) pLumpBytes, NF_SUBSECTOR);
+    #endif
 
-        ++pSrcNode;
-        ++pDstNode;
-    }
+    // PsyDoom: build the grid used to speed up finding which subsector a point is in
+    #if PSYDOOM_MODS
+        R_InitSubsectorLookup();
+    #endif
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -696,106 +790,121 @@ static void P_LoadThings(const int32_t lumpNum) noexcept {
 // Load linedefs from the specified map lump number
 //------------------------------------------------------------------------------------------------------------------------------------------
 static void P_LoadLineDefs(const int32_t lumpNum) noexcept {
-    // Sanity check the linedefs lump is not too big.
-    // PsyDoom: if limit removing, just ensure the buffer is big enough instead - any size of data is allowed.
+    // Sanity check the linedefs lump is not too big and read it into a temp buffer from the map WAD.
+    // PsyDoom: if limit removing then any size of data is allowed, and the lump is parsed in place where possible.
     const int32_t lumpSize = W_MapLumpLength(lumpNum);
 
     #if PSYDOOM_LIMIT_REMOVING
-        gTmpBuffer.ensureSize(lumpSize);
-        std::byte* const pTmpBufferBytes = gTmpBuffer.bytes();
+        const std::byte* const pLumpBytes = P_GetMapLumpData(lumpNum, lumpSize);
     #else
         if (lumpSize > TMP_BUFFER_SIZE) {
             I_Error("P_LoadLineDefs: lump > 64K");
         }
 
-        std::byte* const pTmpBufferBytes = gTmpBuffer;
+        std::byte* const pLumpBytes = gTmpBuffer;
+        W_ReadMapLump(lumpNum, pLumpBytes, true);
+    #endif
+
+    // Alloc ram for the runtime linedefs and zero initialize.
+    // PsyDoom limit removing: linedefs might be in the extended map format.
+    #if PSYDOOM_LIMIT_REMOVING
+        gNumLines = lumpSize / ((gbLoadingExtendedMap) ? sizeof(maplinedef_ext_t) : sizeof(maplinedef_t));
+    #else
+        gNumLines = lumpSize / sizeof(maplinedef_t);
     #endif
 
-    // Alloc ram for the runtime linedefs and zero initialize
-    gNumLines = lumpSize / sizeof(maplinedef_t);
     gpLines = (line_t*) Z_Malloc(*gpMainMemZone, gNumLines * sizeof(line_t), PU_LEVEL, nullptr);
     D_memset(gpLines, std::byte(0), gNumLines * sizeof(line_t));
 
-    // Read the map lump containing the sidedefs into a temp buffer from the map WAD
-    W_ReadMapLump(lumpNum, pTmpBufferBytes, true);
-
     // PsyDoom: add to the hash for the map
     #if PSYDOOM_MODS
-        MapHash::addData(pTmpBufferBytes, lumpSize);
+        MapHash::addData(pLumpBytes, lumpSize);
     #endif
 
     // Process the WAD linedefs and convert them into runtime linedefs
-    const maplinedef_t* pSrcLine = (maplinedef_t*) pTmpBufferBytes;
-    line_t* pDstLine = gpLines;
-
-    for (int32_t lineIdx = 0; lineIdx < gNumLines; ++lineIdx) {
-        // Save some basic line properties
-        pDstLine->flags = Endian::littleToHost(pSrcLine->flags);
-        pDstLine->special = Endian::littleToHost(pSrcLine->special);
-        pDstLine->tag = Endian::littleToHost(pSrcLine->tag);
-
-        // Save line vertices, delta coordinates and slope type
-        vertex_t& vertex1 = gpVertexes[Endian::littleToHost(pSrcLine->vertex1)];
-        vertex_t& vertex2 = gpVertexes[Endian::littleToHost(pSrcLine->vertex2)];
-
-        pDstLine->vertex1 = &vertex1;
-        pDstLine->vertex2 = &vertex2;
-        pDstLine->dx = vertex2.x - vertex1.x;
-        pDstLine->dy = vertex2.y - vertex1.y;
-
-        if (pDstLine->dx == 0) {
-            pDstLine->slopetype = slopetype_t::ST_VERTICAL;
-        } else if (pDstLine->dy == 0) {
-            pDstLine->slopetype = slopetype_t::ST_HORIZONTAL;
-        } else {
-            if (FixedDiv(pDstLine->dy, pDstLine->dx) > 0) {
-                pDstLine->slopetype = slopetype_t::ST_POSITIVE;
+    auto processWadLinedefs = [&](auto pWadLines) noexcept {
+        const auto* pSrcLine = pWadLines;
+        line_t* pDstLine = gpLines;
+
+        for (int32_t lineIdx = 0; lineIdx < gNumLines; ++lineIdx) {
+            // Save some basic line properties
+            pDstLine->flags = Endian::littleToHost(pSrcLine->flags);
+            pDstLine->special = Endian::littleToHost(pSrcLine->special);
+            pDstLine->tag = Endian::littleToHost(pSrcLine->tag);
+
+            // Save line vertices, delta coordinates and slope type
+            vertex_t& vertex1 = gpVertexes[Endian::littleToHost(pSrcLine->vertex1)];
+            vertex_t& vertex2 = gpVertexes[Endian::littleToHost(pSrcLine->vertex2)];
+
+            pDstLine->vertex1 = &vertex1;
+            pDstLine->vertex2 = &vertex2;
+            pDstLine->dx = vertex2.x - vertex1.x;
+            pDstLine->dy = vertex2.y - vertex1.y;
+
+            if (pDstLine->dx == 0) {
+                pDstLine->slopetype = slopetype_t::ST_VERTICAL;
+            } else if (pDstLine->dy == 0) {
+                pDstLine->slopetype = slopetype_t::ST_HORIZONTAL;
             } else {
-                pDstLine->slopetype = slopetype_t::ST_NEGATIVE;
+                if (FixedDiv(pDstLine->dy, pDstLine->dx) > 0) {
+                    pDstLine->slopetype = slopetype_t::ST_POSITIVE;
+                } else {
+                    pDstLine->slopetype = slopetype_t::ST_NEGATIVE;
+                }
             }
-        }
 
-        // Save line bounding box
-        if (vertex1.x < vertex2.x) {
-            pDstLine->bbox[BOXLEFT] = vertex1.x;
-            pDstLine->bbox[BOXRIGHT] = vertex2.x;
-        } else {
-            pDstLine->bbox[BOXLEFT] = vertex2.x;
-            pDstLine->bbox[BOXRIGHT] = vertex1.x;
-        }
+            // Save line bounding box
+            if (vertex1.x < vertex2.x) {
+                pDstLine->bbox[BOXLEFT] = vertex1.x;
+                pDstLine->bbox[BOXRIGHT] = vertex2.x;
+            } else {
+                pDstLine->bbox[BOXLEFT] = vertex2.x;
+                pDstLine->bbox[BOXRIGHT] = vertex1.x;
+            }
 
-        if (vertex1.y < vertex2.y) {
-            pDstLine->bbox[BOXBOTTOM] = vertex1.y;
-            pDstLine->bbox[BOXTOP] = vertex2.y;
-        } else {
-            pDstLine->bbox[BOXBOTTOM] = vertex2.y;
-            pDstLine->bbox[BOXTOP] = vertex1.y;
-        }
+            if (vertex1.y < vertex2.y) {
+                pDstLine->bbox[BOXBOTTOM] = vertex1.y;
+                pDstLine->bbox[BOXTOP] = vertex2.y;
+            } else {
+                pDstLine->bbox[BOXBOTTOM] = vertex2.y;
+                pDstLine->bbox[BOXTOP] = vertex1.y;
+            }
 
-        // Save side numbers and sector references
-        const int32_t sidenum1 = Endian::littleToHost(pSrcLine->sidenum[0]);
-        const int32_t sidenum2 = Endian::littleToHost(pSrcLine->sidenum[1]);
+            // Save side numbers and sector references
+            const int32_t sidenum1 = Endian::littleToHost(pSrcLine->sidenum[0]);
+            const int32_t sidenum2 = Endian::littleToHost(pSrcLine->sidenum[1]);
 
-        pDstLine->sidenum[0] = sidenum1;
-        pDstLine->sidenum[1] = sidenum2;
+            pDstLine->sidenum[0] = sidenum1;
+            pDstLine->sidenum[1] = sidenum2;
 
-        if (sidenum1 != -1) {
-            side_t& side = gpSides[sidenum1];
-            pDstLine->frontsector = side.sector;
-        } else {
-            pDstLine->frontsector = nullptr;
+            if (sidenum1 != -1) {
+                side_t& side = gpSides[sidenum1];
+                pDstLine->frontsector = side.sector;
+            } else {
+                pDstLine->frontsector = nullptr;
+            }
+
+            if (sidenum2 != -1) {
+                side_t& side = gpSides[sidenum2];
+                pDstLine->backsector = side.sector;
+            } else {
+                pDstLine->backsector = nullptr;
+            }
+
+            ++pSrcLine;
+            ++pDstLine;
         }
+    };
 
-        if (sidenum2 != -1) {
-            side_t& side = gpSides[sidenum2];
-            pDstLine->backsector = side.sector;
+    #if PSYDOOM_LIMIT_REMOVING
+        if (gbLoadingExtendedMap) {
+            processWadLinedefs((const maplinedef_ext_t*) pLumpBytes);
         } else {
-            pDstLine->backsector = nullptr;
+            processWadLinedefs((const maplinedef_t*) pLumpBytes);
         }
-
-        ++pSrcLine;
-        ++pDstLine;
-    }
+    #else
+        processWadLinedefs((const maplinedef_t*) pLumpBytes);
+    #endif
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -964,6 +1073,12 @@ static void P_LoadBlockMap(const int32_t lumpNum) noexcept {
     const int32_t blockLinksSize = blockmapHeader.width * blockmapHeader.height * (int32_t) sizeof(gppBlockLinks[0]);
     gppBlockLinks = (mobj_t**) Z_Malloc(*gpMainMemZone, blockLinksSize, PU_LEVEL, nullptr);
     D_memset(gppBlockLinks, std::byte(0), blockLinksSize);
+
+    // PsyDoom: reset the packed lists of things for each blockmap cell (used for fast culling) and the sector touching thing lists also
+    #if PSYDOOM_MODS
+        P_InitBlockThings();
+        P_InitTouchNodes();
+    #endif
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -984,29 +1099,34 @@ static void P_LoadRejectMap(const int32_t lumpNum) noexcept {
 // Load leafs from the specified map lump number
 //------------------------------------------------------------------------------------------------------------------------------------------
 static void P_LoadLeafs(const int32_t lumpNum) noexcept {
-    // Sanity check the leafs lump is not too big.
-    // PsyDoom: if limit removing, just ensure the buffer is big enough instead - any size of data is allowed.
+    // Sanity check the leafs lump is not too big and read the map lump containing the leaf edges into a temp buffer from the map WAD.
+    // PsyDoom: if limit removing then any size of data is allowed, and the lump is parsed in place where possible.
     const int32_t lumpSize = W_MapLumpLength(lumpNum);
 
     #if PSYDOOM_LIMIT_REMOVING
-        gTmpBuffer.ensureSize(lumpSize);
-        std::byte* const pTmpBufferBytes = gTmpBuffer.bytes();
+        const std::byte* const pLumpBytes = P_GetMapLumpData(lumpNum, lumpSize);
     #else
         if (lumpSize > TMP_BUFFER_SIZE) {
             I_Error("P_LoadLeafs: lump > 64K");
         }
 
-        std::byte* const pTmpBufferBytes = gTmpBuffer;
+        std::byte* const pLumpBytes = gTmpBuffer;
+        W_ReadMapLump(lumpNum, pLumpBytes, true);
     #endif
 
-    // Read the map lump containing the leaf edges into a temp buffer from the map WAD
-    W_ReadMapLump(lumpNum, pTmpBufferBytes, true);
-    const std::byte* const pLumpBeg = pTmpBufferBytes;
-    const std::byte* const pLumpEnd = pTmpBufferBytes + lumpSize;
+    const std::byte* const pLumpBeg = pLumpBytes;
+    const std::byte* const pLumpEnd = pLumpBytes + lumpSize;
 
     // PsyDoom: add to the hash for the map
     #if PSYDOOM_MODS
-        MapHash::addData(pTmpBufferBytes, lumpSize);
+        MapHash::addData(pLumpBytes, lumpSize);
+    #endif
+
+    // PsyDoom limit removing: leaf edges might be in the extended map format
+    #if PSYDOOM_LIMIT_REMOVING
+        const size_t wadLeafEdgeSize = (gbLoadingExtendedMap) ? sizeof(mapleafedge_ext_t) : sizeof(mapleafedge_t);
+    #else
+        constexpr size_t wadLeafEdgeSize = sizeof(mapleafedge_t);
     #endif
 
     // Determine the number of leafs in the lump.
@@ -1022,7 +1142,7 @@ static void P_LoadLeafs(const int32_t lumpNum) noexcept {
         ++numLeafs;
 
         // Skip past the leaf edges and include them in the leaf edge count
-        pLumpByte += leaf.numedges * sizeof(mapleafedge_t);
+        pLumpByte += leaf.numedges * wadLeafEdgeSize;
         totalLeafEdges += leaf.numedges;
     }
 
@@ -1036,7 +1156,7 @@ static void P_LoadLeafs(const int32_t lumpNum) noexcept {
     // Convert WAD leaf edges to runtime leaf edges and link them in with other map data structures
     gTotalNumLeafEdges = 0;
 
-    const std::byte* pLumpByte = pTmpBufferBytes;
+    const std::byte* pLumpByte = pLumpBytes;
     subsector_t* pSubsec = gpSubsectors;
     leafedge_t* pDstEdge = gpLeafEdges;
 
@@ -1048,16 +1168,31 @@ static void P_LoadLeafs(const int32_t lumpNum) noexcept {
 
         // Save leaf info on the subsector
         pSubsec->numLeafEdges = leaf.numedges;
-        pSubsec->firstLeafEdge = (int16_t) gTotalNumLeafEdges;
+        pSubsec->firstLeafEdge = (decltype(pSubsec->firstLeafEdge)) gTotalNumLeafEdges;
 
         // Process the edges in the leaf
         for (int32_t edgeIdx = 0; edgeIdx < pSubsec->numLeafEdges; ++edgeIdx) {
-            // Convert edge data to host endian and move past it
-            mapleafedge_t srcEdge = *(const mapleafedge_t*) pLumpByte;
-            srcEdge.segnum = Endian::littleToHost(srcEdge.segnum);
-            srcEdge.vertexnum = Endian::littleToHost(srcEdge.vertexnum);
+            // Convert edge data to host endian and move past it.
+            // PsyDoom limit removing: edges might be in the extended map format.
+            #if PSYDOOM_LIMIT_REMOVING
+                mapleafedge_ext_t srcEdge;
+
+                if (gbLoadingExtendedMap) {
+                    srcEdge = *(const mapleafedge_ext_t*) pLumpByte;
+                    srcEdge.segnum = Endian::littleToHost(srcEdge.segnum);
+                    srcEdge.vertexnum = Endian::littleToHost(srcEdge.vertexnum);
+                } else {
+                    const mapleafedge_t wadEdge = *(const mapleafedge_t*) pLumpByte;
+                    srcEdge.segnum = Endian::littleToHost(wadEdge.segnum);
+                    srcEdge.vertexnum = Endian::littleToHost(wadEdge.vertexnum);
+                }
+            #else
+                mapleafedge_t srcEdge = *(const mapleafedge_t*) pLumpByte;
+                srcEdge.segnum = Endian::littleToHost(srcEdge.segnum);
+                srcEdge.vertexnum = Endian::littleToHost(srcEdge.vertexnum);
+            #endif
 
-            pLumpByte += sizeof(mapleafedge_t);
+            pLumpByte += wadLeafEdgeSize;
 
             // Set leaf vertex reference
             if (srcEdge.vertexnum >= gNumVertexes) {
@@ -1563,6 +1698,7 @@ static void P_Init() noexcept {
 
     // Load animated wall and flat textures into RAM so they are ready when needed.
     // These will be uploaded dynamically into VRAM at runtime, as the engine animates the flat or wall texture.
+    // PsyDoom limit removing: all animation frames are uploaded and locked in VRAM here instead, since there is plenty of room.
     P_InitPicAnims();
 }
 
@@ -1574,12 +1710,18 @@ void P_SetupLevel(const int32_t mapNum, [[maybe_unused]] const skill_t skill) no
     // Cleanup of memory and resetting the RNG before we start
     Z_FreeTags(*gpMainMemZone, PU_CACHE | PU_LEVSPEC| PU_LEVEL);
 
+    #if PSYDOOM_MODS
+        ThinkerPool::reset();   // PsyDoom: map objects and thinkers from the previous level are also gone
+        P_ClearSectorIndexes(); // PsyDoom: don't use the sector indexes for the previous level while loading this one
+    #endif
+
     if (!gbIsLevelBeingRestarted) {
         // Texture cache: unlock everything except UI assets and other reserved areas of VRAM.
         // In limit removing mode also ensure we are using tight packing of VRAM.
+        // PsyDoom limit removing: wall and floor textures stay locked for now, so that any the new map shares with the previous map
+        // survive the purge below. The ones that the new map doesn't use are evicted by 'P_LoadMapTextures' instead.
         #if PSYDOOM_MODS
             #if PSYDOOM_LIMIT_REMOVING
-                I_LockAllWallAndFloorTextures(false);
                 I_TexCacheUseLoosePacking(false);
             #else
                 I_UnlockAllTexCachePages();
@@ -1626,6 +1768,10 @@ void P_SetupLevel(const int32_t mapNum, [[maybe_unused]] const skill_t skill) no
     gThinkerCap.prev = &gThinkerCap;
     gThinkerCap.next = &gThinkerCap;
 
+    #if PSYDOOM_MODS
+        P_ClearSegregatedThinkers();
+    #endif
+
     gMobjHead.next = &gMobjHead;
     gMobjHead.prev = &gMobjHead;
 
@@ -1667,12 +1813,22 @@ void P_SetupLevel(const int32_t mapNum, [[maybe_unused]] const skill_t skill) no
 
     // Open the map wad.
     // PsyDoom: this no longer returns a data pointer with the new WAD code.
+    // PsyDoom: when restarting the level also reuse the already loaded and decompressed map lumps from the last time the map was loaded.
     #if PSYDOOM_MODS
-        W_OpenMapWad(mapWadFile);
+        W_OpenMapWad(mapWadFile, gbIsLevelBeingRestarted);
     #else
         void* const pMapWadFileData = W_OpenMapWad(mapWadFile);
     #endif
 
+    // PsyDoom: is the map in the extended (32-bit index) map format? This is only supported by limit removing builds.
+    #if PSYDOOM_LIMIT_REMOVING
+        gbLoadingExtendedMap = WadCompat::getCompatLayer().isExtendedMapFormat();
+    #elif PSYDOOM_MODS
+        if (WadCompat::getCompatLayer().isExtendedMapFormat()) {
+            I_Error("P_SetupLevel: extended format maps need a limit removing build!");
+        }
+    #endif
+
     // PsyDoom: don't use this lump relative indexing anymore, just search for the lump names we want.
     // This also allows more flexibility where the 'MAP01' etc. markers in the map WAD can just be ignored - map files can be renamed more easily.
     #if !PSYDOOM_MODS
@@ -1726,8 +1882,13 @@ void P_SetupLevel(const int32_t mapNum, [[maybe_unused]] const skill_t skill) no
     #endif
 
     // Build sector line lists etc.
+    // PsyDoom: also build the packed line lists for each blockmap cell.
     P_GroupLines();
 
+    #if PSYDOOM_MODS
+        P_InitBlockLines();
+    #endif
+
     // Load and spawn map things; also initialize the next deathmatch start
     gpDeathmatchP = &gDeathmatchStarts[0];
 
@@ -1737,6 +1898,10 @@ void P_SetupLevel(const int32_t mapNum, [[maybe_unused]] const skill_t skill) no
         ScriptingEngine::init();                        // PsyDoom: initialize the scripting engine if the map has Lua scripted actions
         MapHash::finalize();                            // PsyDoom: compute the final map hash
         MapPatcher::applyPatches();                     // PsyDoom: apply any patches to original map data that are relevant at this point, once all things have been loaded
+        P_InitSightRegions();                           // PsyDoom: precompute which sectors can never see each other, now that map geometry is final
+        P_InitSectorIndexes();                          // PsyDoom: precompute the sectors for each tag and the sectors surrounding each sector
+        P_InitSoundPropagation();                       // PsyDoom: record which lines sound can currently pass through, for caching noise alerts
+        P_InitFlowFields();                             // PsyDoom: connect up blockmap cells for monster flow field pathing (if enabled)
 
         // PsyDoom: forcing open boss triggered doors etc. if appropriate:
         const bool bIsDeathmatch = (gNetGame == gt_deathmatch);
@@ -1757,7 +1922,10 @@ void P_SetupLevel(const int32_t mapNum, [[maybe_unused]] const skill_t skill) no
     // PsyDoom: the WAD manager is now responsible for freeing up resources used by the map WAD.
     P_SpawnSpecials();
 
+    // PsyDoom: monitor the current map file for changes if appropriate.
+    // This is done while the map WAD is still open, so the initial contents of the map can be recorded.
     #if PSYDOOM_MODS
+        DevMapAutoReloader::init(mapWadFile);
         W_CloseMapWad();
     #else
         Z_Free2(*gpMainMemZone, pMapWadFileData);
@@ -1788,10 +1956,17 @@ void P_SetupLevel(const int32_t mapNum, [[maybe_unused]] const skill_t skill) no
         MobjSpritePrecacher::doPrecaching();
     #endif
 
-    // Check there is enough heap space left in order to run the level
+    // Check there is enough heap space left in order to run the level.
+    // PsyDoom limit removing: this check is skipped if the heap can grow, since it will do so on demand during gameplay.
     const int32_t freeMemForGameplay = Z_FreeMemory(*gpMainMemZone);
 
-    if (freeMemForGameplay < MIN_REQ_HEAP_SPACE_FOR_GAMEPLAY) {
+    #if PSYDOOM_LIMIT_REMOVING
+        const bool bCanGrowHeap = (gpMainMemZone->growChunkSize > 0);
+    #else
+        constexpr bool bCanGrowHeap = false;
+    #endif
+
+    if ((freeMemForGameplay < MIN_REQ_HEAP_SPACE_FOR_GAMEPLAY) && (!bCanGrowHeap)) {
         Z_DumpHeap();
         I_Error("P_SetupLevel: not enough free memory %d", freeMemForGameplay);
     }
@@ -1871,10 +2046,6 @@ void P_SetupLevel(const int32_t mapNum, [[maybe_unused]] const skill_t skill) no
         #endif
     }
 
-    // PsyDoom: monitor the current map file for changes if appropriate
-    #if PSYDOOM_MODS
-        DevMapAutoReloader::init(mapWadFile);
-    #endif
 }
 
 #if PSYDOOM_MODS
@@ -1943,6 +2114,30 @@ static void P_FlagMapTexturesForLoading() noexcept {
     }
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom limit removing addition: unlocks all wall and floor textures and evicts any still in VRAM from the previous map which are not
+// requested by the map being loaded. Textures which the new map shares with the previous one stay where they are and don't need reloading.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void P_EvictUnusedMapTextures() noexcept {
+    for (int32_t texIdx = 0; texIdx < gNumTexLumps; ++texIdx) {
+        texture_t& tex = gpTextures[texIdx];
+        tex.bIsLocked = false;
+
+        if (tex.bIsCached && (!gCacheTextureSet.isAdded((uint32_t) texIdx))) {
+            I_RemoveTexCacheEntry(tex);
+        }
+    }
+
+    for (int32_t flatIdx = 0; flatIdx < gNumFlatLumps; ++flatIdx) {
+        texture_t& tex = gpFlatTextures[flatIdx];
+        tex.bIsLocked = false;
+
+        if (tex.bIsCached && (!gCacheFlatTextureSet.isAdded((uint32_t) flatIdx))) {
+            I_RemoveTexCacheEntry(tex);
+        }
+    }
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // PsyDoom limit removing addition: loads previously all requested map textures.
 // The textures are sorted and loaded based on their height, with the tallest textures going first.
@@ -1956,6 +2151,10 @@ static void P_LoadMapTextures() noexcept {
     // assumed to be always 64x64. Because of this, retrieving (on-demand) the size info by caching the texture's lump is required.
     // Hopefully with PsyDoom's larger heap this data will not be evicted before we go to actually cache the texture into VRAM, so it won't
     // be a duplicated loading operation.
+    //
+    // Textures which are still resident from the previous map already have up to date size info and will be skipped when caching.
+    P_EvictUnusedMapTextures();
+
     gLoadTextureList.clear();
     gLoadTextureList.reserve((size_t)(gCacheFlatTextureSet.size() + gCacheTextureSet.size()));
 
@@ -1963,7 +2162,10 @@ static void P_LoadMapTextures() noexcept {
         [](const uint64_t idx) noexcept {
             texture_t& tex = gpTextures[idx];
             gLoadTextureList.push_back(&tex);
-            P_CacheAndUpdateTexSizeInfo(tex, tex.lumpNum);
+
+            if (!tex.bIsCached) {
+                P_CacheAndUpdateTexSizeInfo(tex, tex.lumpNum);
+            }
         }
     );
 
@@ -1971,7 +2173,10 @@ static void P_LoadMapTextures() noexcept {
         [](const uint64_t idx) noexcept {
             texture_t& tex = gpFlatTextures[idx];
             gLoadTextureList.push_back(&tex);
-            P_CacheAndUpdateTexSizeInfo(tex, tex.lumpNum);
+
+            if (!tex.bIsCached) {
+                P_CacheAndUpdateTexSizeInfo(tex, tex.lumpNum);
+            }
         }
     );
 
@@ -1989,13 +2194,28 @@ static void P_LoadMapTextures() noexcept {
         }
     );
 
-    // Cache all of the textures, starting at the beginning of available VRAM
+    // Cache all of the textures, starting at the beginning of available VRAM.
+    // Cache them all as one batch, so that texture decompression can be done in parallel and VRAM uploads coalesced.
     I_SetTexCacheFillPage(0);
-    uint32_t maxTexturePage = 1;
+    I_CacheTexBatch(gLoadTextureList.data(), (uint32_t) gLoadTextureList.size());
+
+    // If the textures kept from the previous map left VRAM too fragmented for everything to fit then start over from an empty cache.
+    // This way sharing textures between maps never causes an overflow that loading the map from scratch would avoid.
+    const bool bAllTexturesCached = std::all_of(
+        gLoadTextureList.begin(),
+        gLoadTextureList.end(),
+        [](const texture_t* const pTex) noexcept { return pTex->bIsCached; }
+    );
+
+    if (!bAllTexturesCached) {
+        for (texture_t* const pTex : gLoadTextureList) {
+            if (pTex->bIsCached) {
+                I_RemoveTexCacheEntry(*pTex);
+            }
+        }
 
-    for (texture_t* pTex : gLoadTextureList) {
-        I_CacheTex(*pTex);
-        maxTexturePage = std::max(maxTexturePage, I_GetCurTexCacheFillPage());
+        I_SetTexCacheFillPage(0);
+        I_CacheTexBatch(gLoadTextureList.data(), (uint32_t) gLoadTextureList.size());
     }
 
     // Ensure all wall and floor textures are locked.
@@ -2075,3 +2295,167 @@ static void P_CacheMapTexturesWithWidth(const int32_t width) noexcept {
     }
 }
 #endif  // #if !PSYDOOM_LIMIT_REMOVING
+
+#if PSYDOOM_MODS
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom addition: used by the developer map auto-reloader to apply edits to the sectors and/or sidedefs of the current map in place,
+// without reloading the level and while keeping all game state. The map WAD for the level must be open when this is called.
+//
+// Only edits which don't change the structure of the level or which specials were spawned are applied in place: sector heights, flats,
+// colors, light levels and flags and sidedef textures and offsets. If anything else was changed (sector counts, tags, specials, skies or
+// which sector a side belongs to), or a new texture cannot be loaded, then nothing is modified and 'false' is returned.
+// In that case the level must be fully reloaded instead.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool P_HotReloadSectorsAndSides(const bool bReloadSectors, const bool bReloadSides) noexcept {
+    // Loading sectors and sides replaces the global lists and adds to the map hash, so remember the current state for restoring.
+    // The newly loaded lists are only used to pick out the edited values, which are then copied into the lists already in use.
+    sector_t* const pCurSectors = gpSectors;
+    side_t* const pCurSides = gpSides;
+    const int32_t curNumSectors = gNumSectors;
+    const int32_t curNumSides = gNumSides;
+    texture_t* const pCurSkyTexture = gpSkyTexture;
+    const int32_t curMapDataSize = MapHash::gDataSize;
+
+    sector_t* pNewSectors = nullptr;
+    side_t* pNewSides = nullptr;
+    int32_t newNumSectors = curNumSectors;
+    int32_t newNumSides = curNumSides;
+    texture_t* pNewSkyTexture = pCurSkyTexture;
+
+    if (bReloadSectors) {
+        P_LoadSectors(W_MapGetNumForName("SECTORS"));
+        pNewSectors = gpSectors;
+        newNumSectors = gNumSectors;
+        pNewSkyTexture = gpSkyTexture;
+        gpSectors = pCurSectors;
+        gNumSectors = curNumSectors;
+        gpSkyTexture = pCurSkyTexture;
+    }
+
+    if (bReloadSides) {
+        P_LoadSideDefs(W_MapGetNumForName("SIDEDEFS"));     // Note: sector references point into the sector list already in use
+        pNewSides = gpSides;
+        newNumSides = gNumSides;
+        gpSides = pCurSides;
+        gNumSides = curNumSides;
+    }
+
+    MapHash::gDataSize = curMapDataSize;
+
+    // Check that all of the edits can be applied in place
+    const auto isValidTexNum = [](const int32_t texNum, const int32_t numTex) noexcept {
+        return ((texNum >= 0) && (texNum < numTex));
+    };
+
+    std::vector<texture_t*> texToCache;
+    bool bCanApplyInPlace = ((newNumSectors == curNumSectors) && (newNumSides == curNumSides) && (pNewSkyTexture == pCurSkyTexture));
+
+    for (int32_t secIdx = 0; bCanApplyInPlace && pNewSectors && (secIdx < newNumSectors); ++secIdx) {
+        const sector_t& curSec = pCurSectors[secIdx];
+        const sector_t& newSec = pNewSectors[secIdx];
+        bCanApplyInPlace = ((newSec.special == curSec.special) && (newSec.tag == curSec.tag));
+
+        if (isValidTexNum(newSec.floorpic, gNumFlatLumps) && (!gpFlatTextures[newSec.floorpic].isCached())) {
+            texToCache.push_back(&gpFlatTextures[newSec.floorpic]);
+        }
+
+        if (isValidTexNum(newSec.ceilingpic, gNumFlatLumps) && (!gpFlatTextures[newSec.ceilingpic].isCached())) {
+            texToCache.push_back(&gpFlatTextures[newSec.ceilingpic]);
+        }
+    }
+
+    for (int32_t sideIdx = 0; bCanApplyInPlace && pNewSides && (sideIdx < newNumSides); ++sideIdx) {
+        const side_t& newSide = pNewSides[sideIdx];
+        bCanApplyInPlace = (newSide.sector == pCurSides[sideIdx].sector);
+
+        for (const int32_t texNum : { newSide.toptexture, newSide.midtexture, newSide.bottomtexture }) {
+            if (isValidTexNum(texNum, gNumTexLumps) && (!gpTextures[texNum].isCached())) {
+                texToCache.push_back(&gpTextures[texNum]);
+            }
+        }
+    }
+
+    // If not limit removing then VRAM is arranged once at level start, and there is no room to add new textures afterwards
+    #if !PSYDOOM_LIMIT_REMOVING
+        bCanApplyInPlace = (bCanApplyInPlace && texToCache.empty());
+    #endif
+
+    // Apply the edits if possible: load any new textures first
+    if (bCanApplyInPlace) {
+        #if PSYDOOM_LIMIT_REMOVING
+            if (!texToCache.empty()) {
+                std::sort(texToCache.begin(), texToCache.end());
+                texToCache.erase(std::unique(texToCache.begin(), texToCache.end()), texToCache.end());
+
+                for (texture_t* const pTex : texToCache) {
+                    P_CacheAndUpdateTexSizeInfo(*pTex, pTex->lumpNum);
+
+                    if ((pTex >= gpTextures) && (pTex < gpTextures + gNumTexLumps)) {
+                        gCacheTextureSet.add((uint32_t)(pTex - gpTextures));
+                    } else {
+                        gCacheFlatTextureSet.add((uint32_t)(pTex - gpFlatTextures));
+                    }
+                }
+
+                I_CacheTexBatch(texToCache.data(), (uint32_t) texToCache.size());
+                I_LockAllWallAndFloorTextures(true);
+            }
+        #endif
+
+        for (int32_t secIdx = 0; pNewSectors && (secIdx < newNumSectors); ++secIdx) {
+            sector_t& sec = pCurSectors[secIdx];
+            const sector_t& newSec = pNewSectors[secIdx];
+            const bool bHeightsChanged = (
+                (sec.floorheight.value != newSec.floorheight.value) ||
+                (sec.ceilingheight.value != newSec.ceilingheight.value)
+            );
+
+            sec.floorheight = newSec.floorheight.value;
+            sec.ceilingheight = newSec.ceilingheight.value;
+            sec.floorpic = newSec.floorpic;
+            sec.ceilingpic = newSec.ceilingpic;
+            sec.colorid = newSec.colorid;
+            sec.ceilColorid = newSec.ceilColorid;
+            sec.lightlevel = newSec.lightlevel;
+            sec.flags = newSec.flags;
+
+            // Refit things in the sector to the new heights (without crushing) and don't interpolate the change
+            if (bHeightsChanged) {
+                P_ChangeSector(sec, false);
+            }
+
+            R_SnapSectorInterpolation(sec);
+        }
+
+        for (int32_t sideIdx = 0; pNewSides && (sideIdx < newNumSides); ++sideIdx) {
+            side_t& side = pCurSides[sideIdx];
+            const side_t& newSide = pNewSides[sideIdx];
+
+            side.textureoffset = newSide.textureoffset.value;
+            side.rowoffset = newSide.rowoffset.value;
+            side.toptexture = newSide.toptexture;
+            side.midtexture = newSide.midtexture;
+            side.bottomtexture = newSide.bottomtexture;
+            R_SnapSideInterpolation(side);
+        }
+
+        // Sector heights affect which lines sound and sight can pass through, so refresh the precomputed state for those
+        if (pNewSectors) {
+            P_InitSightRegions();
+            P_InitSoundPropagation();
+            P_InitFlowFields();
+        }
+    }
+
+    // Cleanup the newly loaded lists now that we are done with them
+    if (pNewSides) {
+        Z_Free2(*gpMainMemZone, pNewSides);
+    }
+
+    if (pNewSectors) {
+        Z_Free2(*gpMainMemZone, pNewSectors);
+    }
+
+    return bCanApplyInPlace;
+}
+#endif  // #if PSYDOOM_MODS
@@ -59,4 +59,5 @@ void P_SetupLevel(const int32_t mapNum, const skill_t skill) noexcept;
 
 #if PSYDOOM_MODS
     void P_AddPlayerStart(const mapthing_t& mapThing) noexcept;
+    bool P_HotReloadSectorsAndSides(const bool bReloadSectors, const bool bReloadSides) noexcept;
 #endif
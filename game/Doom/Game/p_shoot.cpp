@@ -6,6 +6,7 @@
 #include "Doom/Renderer/r_local.h"
 #include "Doom/Renderer/r_main.h"
 #include "doomdata.h"
+#include "p_bsptrace.h"
 #include "p_map.h"
 #include "p_setup.h"
 
@@ -444,31 +445,38 @@ int32_t PA_DivlineSide(const fixed_t x, const fixed_t y, const divline_t& line)
 // Returns 'true' if the shooting sight line is unobstructed.
 //------------------------------------------------------------------------------------------------------------------------------------------
 bool PA_CrossBSPNode(const int32_t nodeNum) noexcept {
-    // Is this bsp node actually a subsector? (leaf node) If so then do sight checks against that:
-    if (nodeNum & NF_SUBSECTOR) {
-        const int32_t subsecNum = nodeNum & (~NF_SUBSECTOR);
-
-        if (subsecNum < gNumSubsectors) {
-            return PA_CrossSubsector(gpSubsectors[subsecNum]);
-        } else {
-            I_Error("PA_CrossSubsector: ss %i with numss = %i", subsecNum, gNumSubsectors);     // Bad subsector number!
-            return false;
+    // PsyDoom: use the BSP traversal shared with sight checking (which inlines the per subsector checks)
+    #if PSYDOOM_MODS
+        return P_TraceBSPNode(nodeNum, gShootDiv.x, gShootDiv.y, gShootX2, gShootY2, [](subsector_t& subsec) noexcept {
+            return PA_CrossSubsector(subsec);
+        });
+    #else
+        // Is this bsp node actually a subsector? (leaf node) If so then do sight checks against that:
+        if (nodeNum & NF_SUBSECTOR) {
+            const int32_t subsecNum = nodeNum & (~NF_SUBSECTOR);
+
+            if (subsecNum < gNumSubsectors) {
+                return PA_CrossSubsector(gpSubsectors[subsecNum]);
+            } else {
+                I_Error("PA_CrossSubsector: ss %i with numss = %i", subsecNum, gNumSubsectors);     // Bad subsector number!
+                return false;
+            }
         }
-    }
 
-    // See what side of the bsp split the point is on: will check to see if the sight line is blocked by that half-space first
-    node_t& bspNode = gpBspNodes[nodeNum];
-    const int32_t sideNum = PA_DivlineSide(gShootDiv.x, gShootDiv.y, bspNode.line);
+        // See what side of the bsp split the point is on: will check to see if the sight line is blocked by that half-space first
+        node_t& bspNode = gpBspNodes[nodeNum];
+        const int32_t sideNum = PA_DivlineSide(gShootDiv.x, gShootDiv.y, bspNode.line);
 
-    // If the sight line cannot cross the closest half-space then we are done: sight is obstructed
-    if (!PA_CrossBSPNode(bspNode.children[sideNum]))
-        return false;
+        // If the sight line cannot cross the closest half-space then we are done: sight is obstructed
+        if (!PA_CrossBSPNode(bspNode.children[sideNum]))
+            return false;
 
-    // Check to see what side of the bsp split the end point for sight checking is on.
-    // If it's in the same half-space we just raycasted against then we are done - sight is unobstructed.
-    if (sideNum == PA_DivlineSide(gShootX2, gShootY2, bspNode.line))
-        return true;
+        // Check to see what side of the bsp split the end point for sight checking is on.
+        // If it's in the same half-space we just raycasted against then we are done - sight is unobstructed.
+        if (sideNum == PA_DivlineSide(gShootX2, gShootY2, bspNode.line))
+            return true;
 
-    // Failing that recurse into the opposite side of the BSP split and raycast against that, returning the result
-    return PA_CrossBSPNode(bspNode.children[sideNum ^ 1]);
+        // Failing that recurse into the opposite side of the BSP split and raycast against that, returning the result
+        return PA_CrossBSPNode(bspNode.children[sideNum ^ 1]);
+    #endif
 }
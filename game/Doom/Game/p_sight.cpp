@@ -7,46 +7,375 @@
 #include "doomdata.h"
 #include "g_game.h"
 #include "info.h"
+#include "p_bsptrace.h"
+#include "p_enemy.h"
 #include "p_setup.h"
 #include "p_shoot.h"
 #include "p_tick.h"
+#include "PsyDoom/FrameProfiler.h"
 #include "PsyDoom/Game.h"
+#include "PsyDoom/JobSystem.h"
 
 #include <algorithm>
 
-static fixed_t      gSightZStart;       // Z position of thing looking
-static fixed_t      gTopSlope;          // Maximum/top unblocked viewing slope (clipped against upper walls)
-static fixed_t      gBottomSlope;       // Minimum/bottom unblocked viewing slope (clipped against lower walls)
-static divline_t    gSTrace;            // The start point and vector for sight checking
-static fixed_t      gT2x;               // End point for sight checking: x
-static fixed_t      gT2y;               // End point for sight checking: y
-static int32_t      gT1xs;              // Sight line start, whole coords: x
-static int32_t      gT1ys;              // Sight line start, whole coords: y
-static int32_t      gT2xs;              // Sight line end, whole coords: x
-static int32_t      gT2ys;              // Sight line end, whole coords: y
+#if PSYDOOM_MODS
+    #include <vector>
+#endif
+
+// PsyDoom: the sight line state is thread local so that sight checks can be done in parallel by job system worker threads
+#if PSYDOOM_MODS
+    static thread_local fixed_t     gSightZStart;           // Z position of thing looking
+    static thread_local fixed_t     gTopSlope;              // Maximum/top unblocked viewing slope (clipped against upper walls)
+    static thread_local fixed_t     gBottomSlope;           // Minimum/bottom unblocked viewing slope (clipped against lower walls)
+    static thread_local divline_t   gSTrace;                // The start point and vector for sight checking
+    static thread_local fixed_t     gT2x;                   // End point for sight checking: x
+    static thread_local fixed_t     gT2y;                   // End point for sight checking: y
+    static thread_local int32_t     gT1xs;                  // Sight line start, whole coords: x
+    static thread_local int32_t     gT1ys;                  // Sight line start, whole coords: y
+    static thread_local int32_t     gT2xs;                  // Sight line end, whole coords: x
+    static thread_local int32_t     gT2ys;                  // Sight line end, whole coords: y
+    static thread_local bool        gbParallelSightCheck;   // True if this thread is doing a sight check in parallel with other threads
+#else
+    static fixed_t      gSightZStart;       // Z position of thing looking
+    static fixed_t      gTopSlope;          // Maximum/top unblocked viewing slope (clipped against upper walls)
+    static fixed_t      gBottomSlope;       // Minimum/bottom unblocked viewing slope (clipped against lower walls)
+    static divline_t    gSTrace;            // The start point and vector for sight checking
+    static fixed_t      gT2x;               // End point for sight checking: x
+    static fixed_t      gT2y;               // End point for sight checking: y
+    static int32_t      gT1xs;              // Sight line start, whole coords: x
+    static int32_t      gT1ys;              // Sight line start, whole coords: y
+    static int32_t      gT2xs;              // Sight line end, whole coords: x
+    static int32_t      gT2ys;              // Sight line end, whole coords: y
+#endif
+
+#if PSYDOOM_MODS
+    // PsyDoom: a 'sight region' number for each sector.
+    // Two sectors are in the same region if it is possible to get from one to the other by crossing only two-sided lines (regardless of
+    // sector heights). A sight line can never cross a one-sided line, so sectors in different regions can never see each other. This is
+    // used as a supplement to the reject map, since PSX maps don't ship with a usable one.
+    static std::vector<uint32_t> gSectorSightRegions;
+
+    // PsyDoom: all of the inputs to a BSP sight line traversal
+    struct sightline_t {
+        fixed_t     startX;
+        fixed_t     startY;
+        fixed_t     endX;
+        fixed_t     endY;
+        fixed_t     sightZStart;
+        fixed_t     topSlope;
+        fixed_t     bottomSlope;
+    };
+
+    // PsyDoom: an entry in the memo of recent sight check results.
+    // Stores the inputs to a BSP sight line traversal, and the result for those inputs.
+    struct sightmemo_t {
+        sightline_t     line;
+        uint32_t        epoch;      // Entry is only valid if this matches 'gSightMemoEpoch'
+        bool            bResult;
+    };
+
+    // PsyDoom: a sight check to be done in parallel with others by the job system, and the result of the check
+    struct sightjob_t {
+        mobj_t*         pMobj;          // The thing looking at its target
+        sightline_t     line;
+        sightmemo_t*    pMemoEntry;     // Where to save the result of the sight check in the memo
+        bool            bResult;
+    };
+
+    // PsyDoom: a memo of recent sight check results, used by 'P_CheckSights' so that monster and target pairs which haven't moved don't need
+    // to redo the BSP traversal every tic. Since sector heights are the only level geometry that can change, the memo is invalidated whenever
+    // any sector floor or ceiling height differs from the snapshot taken in 'gSightMemoSectorHeights'.
+    static constexpr uint32_t SIGHT_MEMO_SIZE = 256;
+
+    static sightmemo_t              gSightMemo[SIGHT_MEMO_SIZE];
+    static uint32_t                 gSightMemoEpoch;
+    static std::vector<fixed_t>     gSightMemoSectorHeights;    // Floor and ceiling height for each sector, when the memo was last validated
+    static bool                     gbSightMemoLosFix;          // Value of the line of sight overflow fix setting when the memo was last validated
+    static bool                     gbUseSightMemo;             // True if 'P_CheckSight' should use the memo (only while the level geometry is known to be static)
+
+    // PsyDoom: sight checks waiting to be done in parallel
+    static std::vector<sightjob_t> gSightJobs;
+#endif
+
+#if PSYDOOM_MODS
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: get the root of the union-find tree that the given sector region belongs to, flattening the tree while going
+//------------------------------------------------------------------------------------------------------------------------------------------
+static uint32_t P_GetSightRegionRoot(uint32_t region) noexcept {
+    while (gSectorSightRegions[region] != region) {
+        const uint32_t parent = gSectorSightRegions[region];
+        gSectorSightRegions[region] = gSectorSightRegions[parent];
+        region = parent;
+    }
+
+    return region;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: builds the sight region for every sector in the level, which is used to early out of sight checks between sectors which can
+// never see each other. Also invalidates the memo of sight check results. Should be called once all level geometry has been loaded.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void P_InitSightRegions() noexcept {
+    // To begin with each sector is in its own region
+    gSectorSightRegions.resize((size_t) gNumSectors);
+
+    for (int32_t secIdx = 0; secIdx < gNumSectors; ++secIdx) {
+        gSectorSightRegions[secIdx] = (uint32_t) secIdx;
+    }
+
+    // Join the regions for the sectors on either side of every two-sided line
+    for (int32_t lineIdx = 0; lineIdx < gNumLines; ++lineIdx) {
+        const line_t& line = gpLines[lineIdx];
+
+        if (!line.backsector)
+            continue;
+
+        const uint32_t region1 = P_GetSightRegionRoot((uint32_t)(line.frontsector - gpSectors));
+        const uint32_t region2 = P_GetSightRegionRoot((uint32_t)(line.backsector - gpSectors));
+        gSectorSightRegions[std::max(region1, region2)] = std::min(region1, region2);
+    }
+
+    // Flatten so that every sector references the root of its region directly
+    for (int32_t secIdx = 0; secIdx < gNumSectors; ++secIdx) {
+        gSectorSightRegions[secIdx] = P_GetSightRegionRoot((uint32_t) secIdx);
+    }
+
+    // Any previous sight check results are now meaningless
+    gSightMemoSectorHeights.clear();
+    gSightMemoEpoch++;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: invalidates the memo of sight check results if any sector heights (or the relevant game settings) have changed since the memo
+// was last validated.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void P_ValidateSightMemo() noexcept {
+    const size_t numHeights = (size_t) gNumSectors * 2;
+    bool bGeometryChanged = (gSightMemoSectorHeights.size() != numHeights);
+
+    if (bGeometryChanged) {
+        gSightMemoSectorHeights.resize(numHeights);
+    }
+
+    for (int32_t secIdx = 0; secIdx < gNumSectors; ++secIdx) {
+        const sector_t& sector = gpSectors[secIdx];
+        fixed_t* const pHeights = &gSightMemoSectorHeights[(size_t) secIdx * 2];
+
+        if ((pHeights[0] != sector.floorheight) || (pHeights[1] != sector.ceilingheight)) {
+            pHeights[0] = sector.floorheight;
+            pHeights[1] = sector.ceilingheight;
+            bGeometryChanged = true;
+        }
+    }
+
+    const bool bLosFix = Game::gSettings.bUseLineOfSightOverflowFix;
+
+    if (bLosFix != gbSightMemoLosFix) {
+        gbSightMemoLosFix = bLosFix;
+        bGeometryChanged = true;
+    }
+
+    if (bGeometryChanged) {
+        gSightMemoEpoch++;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: saves the current sight line inputs to the given struct
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void PS_SaveSightLine(sightline_t& line) noexcept {
+    line.startX = gSTrace.x;
+    line.startY = gSTrace.y;
+    line.endX = gT2x;
+    line.endY = gT2y;
+    line.sightZStart = gSightZStart;
+    line.topSlope = gTopSlope;
+    line.bottomSlope = gBottomSlope;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: makes the given sight line inputs current, computing all of the derived values used by the BSP traversal
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void PS_LoadSightLine(const sightline_t& line) noexcept {
+    gSTrace.x = line.startX;
+    gSTrace.y = line.startY;
+    gSTrace.dx = line.endX - line.startX;
+    gSTrace.dy = line.endY - line.startY;
+    gT2x = line.endX;
+    gT2y = line.endY;
+    gT1xs = d_fixed_to_int(gSTrace.x);
+    gT1ys = d_fixed_to_int(gSTrace.y);
+    gT2xs = d_fixed_to_int(gT2x);
+    gT2ys = d_fixed_to_int(gT2y);
+    gSightZStart = line.sightZStart;
+    gTopSlope = line.topSlope;
+    gBottomSlope = line.bottomSlope;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: get the sight memo entry to use for the given sight line inputs
+//------------------------------------------------------------------------------------------------------------------------------------------
+static sightmemo_t& P_GetSightMemoEntry(const sightline_t& line) noexcept {
+    uint32_t hash = (uint32_t) line.startX;
+    hash = hash * 31 + (uint32_t) line.startY;
+    hash = hash * 31 + (uint32_t) line.endX;
+    hash = hash * 31 + (uint32_t) line.endY;
+    hash = hash * 31 + (uint32_t) line.sightZStart;
+    hash = hash * 31 + (uint32_t) line.topSlope;
+    hash = hash * 31 + (uint32_t) line.bottomSlope;
+    hash ^= hash >> 16;
+    hash *= 0x45D9F3Bu;
+    hash ^= hash >> 16;
+    return gSightMemo[hash & (SIGHT_MEMO_SIZE - 1)];
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: tells if the given sight memo entry holds the result for the given sight line inputs
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool P_SightMemoEntryMatches(const sightmemo_t& entry, const sightline_t& line) noexcept {
+    return (
+        (entry.epoch == gSightMemoEpoch) &&
+        (entry.line.startX == line.startX) &&
+        (entry.line.startY == line.startY) &&
+        (entry.line.endX == line.endX) &&
+        (entry.line.endY == line.endY) &&
+        (entry.line.sightZStart == line.sightZStart) &&
+        (entry.line.topSlope == line.topSlope) &&
+        (entry.line.bottomSlope == line.bottomSlope)
+    );
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: saves the result of a sight check for the given sight line inputs to the memo entry
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void P_SetSightMemoEntry(sightmemo_t& entry, const sightline_t& line, const bool bResult) noexcept {
+    entry.line = line;
+    entry.epoch = gSightMemoEpoch;
+    entry.bResult = bResult;
+}
+#endif  // #if PSYDOOM_MODS
+
+static bool PS_SetupSightLine(mobj_t& mobj1, mobj_t& mobj2) noexcept;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tells if the given map object is a type that does sight checking against its target
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool P_DoesSightChecks(const mobj_t& mobj) noexcept {
+    // Must be killable (enemy) to do sight checking.
+    //
+    // PsyDoom: extend the sight check to types that include a 'see state' (except the player) in order to allow the reimplemented 'Icon Of Sin' boss to spot the player.
+    // This doesn't cause any demo de-sync against original game demos so I've made this update non-optional.
+    #if PSYDOOM_MODS
+        const bool bHasSeeState = (mobj.info->seestate != S_NULL);
+        const bool bIsNotPlayer = (mobj.type != MT_PLAYER);
+        return ((mobj.flags & MF_COUNTKILL) || (bHasSeeState && bIsNotPlayer));
+    #else
+        return (mobj.flags & MF_COUNTKILL);
+    #endif
+}
+
+#if PSYDOOM_MODS
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: job system function which does one of the queued parallel sight checks
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void P_DoSightJob(const uint32_t jobIdx, [[maybe_unused]] void* const pUserData) noexcept {
+    sightjob_t& job = gSightJobs[jobIdx];
+    PS_LoadSightLine(job.line);
+    gbParallelSightCheck = true;
+    job.bResult = PS_CrossBSPNode(gNumBspNodes - 1);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: a version of 'P_CheckSights' which spreads the BSP traversals for the sight checks across the job system's worker threads.
+//
+// The work is split into 3 phases, so that the outcome is exactly the same as doing everything serially:
+//  (1) Serially figure out which sight checks are needed and setup the sight lines for them, resolving trivial cases immediately.
+//  (2) Do the BSP traversals for all remaining sight checks in parallel. These only read level geometry, which can't change here.
+//  (3) Serially apply the results of the traversals, in map object order.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void P_CheckSightsInParallel() noexcept {
+    gSightJobs.clear();
+
+    for (mobj_t* pmobj = gMobjHead.next; pmobj != &gMobjHead; pmobj = pmobj->next) {
+        if ((!P_DoesSightChecks(*pmobj)) || (pmobj->tics != 1))
+            continue;
+
+        // Dormant monsters only do sight checks every so often when the monster AI LOD setting is enabled
+        if (P_CanSkipMonsterSightCheck(*pmobj))
+            continue;
+
+        mobj_t* const pMobjTarget = pmobj->target;
+
+        if ((!pMobjTarget) || (!PS_SetupSightLine(*pmobj, *pMobjTarget))) {
+            pmobj->flags &= (~MF_SEETARGET);
+            continue;
+        }
+
+        // Use the result of an identical sight check if possible, otherwise queue up the sight check
+        sightline_t sightLine;
+        PS_SaveSightLine(sightLine);
+        sightmemo_t& memoEntry = P_GetSightMemoEntry(sightLine);
+
+        if (P_SightMemoEntryMatches(memoEntry, sightLine)) {
+            if (memoEntry.bResult) {
+                pmobj->flags |= MF_SEETARGET;
+            } else {
+                pmobj->flags &= (~MF_SEETARGET);
+            }
+        } else {
+            gSightJobs.push_back({ pmobj, sightLine, &memoEntry, false });
+        }
+    }
+
+    // Do all of the queued sight checks, then apply the results.
+    // Note that jobs can run on this thread too, so the parallel sight check flag must be cleared again afterwards.
+    JobSystem::runJobs((uint32_t) gSightJobs.size(), P_DoSightJob, nullptr);
+    gbParallelSightCheck = false;
+
+    for (sightjob_t& job : gSightJobs) {
+        P_SetSightMemoEntry(*job.pMemoEntry, job.line, job.bResult);
+
+        if (job.bResult) {
+            job.pMobj->flags |= MF_SEETARGET;
+        } else {
+            job.pMobj->flags &= (~MF_SEETARGET);
+        }
+    }
+}
+#endif  // #if PSYDOOM_MODS
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Updates target visibility checking for all map objects that are due an update
 //------------------------------------------------------------------------------------------------------------------------------------------
 void P_CheckSights() noexcept {
-    for (mobj_t* pmobj = gMobjHead.next; pmobj != &gMobjHead; pmobj = pmobj->next) {
-        // Must be killable (enemy) to do sight checking.
-        //
-        // PsyDoom: extend the sight check to types that include a 'see state' (except the player) in order to allow the reimplemented 'Icon Of Sin' boss to spot the player.
-        // This doesn't cause any demo de-sync against original game demos so I've made this update non-optional.
-        #if PSYDOOM_MODS
-            const bool bHasSeeState = (pmobj->info->seestate != S_NULL);
-            const bool bIsNotPlayer = (pmobj->type != MT_PLAYER);
-            const bool bCheckSight = ((pmobj->flags & MF_COUNTKILL) || (bHasSeeState && bIsNotPlayer));
-        #else
-            const bool bCheckSight = (pmobj->flags & MF_COUNTKILL);
-        #endif
+    PROFILE_SCOPE(CheckSights);
 
-        if (!bCheckSight)
+    // PsyDoom: level geometry can't change during this loop, so sight check results can be reused from the memo (once validated).
+    // PsyDoom: if there are job system worker threads then do the sight checks in parallel.
+    #if PSYDOOM_MODS
+        P_ValidateSightMemo();
+
+        if (JobSystem::getNumWorkerThreads() > 0) {
+            P_CheckSightsInParallel();
+            return;
+        }
+
+        gbUseSightMemo = true;
+    #endif
+
+    for (mobj_t* pmobj = gMobjHead.next; pmobj != &gMobjHead; pmobj = pmobj->next) {
+        // Must be a type which does sight checks
+        if (!P_DoesSightChecks(*pmobj))
             continue;
 
         // Must be about to change states for up-to-date sight info to be useful
         if (pmobj->tics == 1) {
+            // PsyDoom: dormant monsters only do sight checks every so often when the monster AI LOD setting is enabled
+            #if PSYDOOM_MODS
+                if (P_CanSkipMonsterSightCheck(*pmobj))
+                    continue;
+            #endif
+
             // See if we can see the target - if any.
             // Add or remove the visibility flag based on this:
             mobj_t* const pMobjTarget = pmobj->target;
@@ -58,12 +387,58 @@ void P_CheckSights() noexcept {
             }
         }
     }
+
+    #if PSYDOOM_MODS
+        gbUseSightMemo = false;
+    #endif
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Tells if 'mobj1' can see 'mobj2'. Returns 'true' if that is the case.
 //------------------------------------------------------------------------------------------------------------------------------------------
 bool P_CheckSight(mobj_t& mobj1, mobj_t& mobj2) noexcept {
+    // Setup the sight line and early out if the two things can't possibly see each other
+    if (!PS_SetupSightLine(mobj1, mobj2))
+        return false;
+
+    // PsyDoom: reuse the result of an identical sight check if possible.
+    // The outcome of the BSP traversal depends only on the sight line inputs and the (unchanged) level geometry.
+    #if PSYDOOM_MODS
+        sightline_t sightLine;
+        sightmemo_t* pMemoEntry = nullptr;
+
+        if (gbUseSightMemo) {
+            PS_SaveSightLine(sightLine);
+            pMemoEntry = &P_GetSightMemoEntry(sightLine);
+
+            if (P_SightMemoEntryMatches(*pMemoEntry, sightLine))
+                return pMemoEntry->bResult;
+        }
+    #endif
+
+    // Doing a new raycast so update the visitation mark which tells us if stuff has already been processed
+    gValidCount++;
+
+    // Do a raycast against the BSP tree and return if sight is unobstructed.
+    // Also narrows the vertical sight range with each lower and upper wall encountered.
+    #if PSYDOOM_MODS
+        const bool bCanSee = PS_CrossBSPNode(gNumBspNodes - 1);
+
+        if (pMemoEntry) {
+            P_SetSightMemoEntry(*pMemoEntry, sightLine, bCanSee);
+        }
+
+        return bCanSee;
+    #else
+        return PS_CrossBSPNode(gNumBspNodes - 1);
+    #endif
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Sets up the sight line and vertical sight range for a sight check from 'mobj1' to 'mobj2'.
+// Returns 'false' if no sight check is needed because 'mobj1' definitely cannot see 'mobj2'.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool PS_SetupSightLine(mobj_t& mobj1, mobj_t& mobj2) noexcept {
     // PsyDoom: if the target is a player, not a 'Voodoo doll' and has the 'notarget' cheat on then it cannot be seen.
     // PsyDoom: if the external camera is active then don't allow anything to be sighted.
     #if PSYDOOM_MODS
@@ -87,6 +462,12 @@ bool P_CheckSight(mobj_t& mobj1, mobj_t& mobj2) noexcept {
     if ((gpRejectMatrix[rejectMapByte] & (1 << rejectMapBit)) != 0)
         return false;
 
+    // PsyDoom: sectors in different sight regions are sealed off from each other by one-sided lines and can never see each other
+    #if PSYDOOM_MODS
+        if (gSectorSightRegions[secnum1] != gSectorSightRegions[secnum2])
+            return false;
+    #endif
+
     // Store the start and end points of the sight line.
     // Note that the coordinates are truncated to be on odd integer coordinates.
     // Not sure why this is done, or what it's trying to avoid - it's in the 3DO and Jag Doom sources but not explained.
@@ -113,13 +494,7 @@ bool P_CheckSight(mobj_t& mobj1, mobj_t& mobj2) noexcept {
     // Figure out the initial top and bottom slopes for the the vertical sight range
     gTopSlope = mobj2.z + mobj2.height - sightZStart;
     gBottomSlope = mobj2.z - sightZStart;
-
-    // Doing a new raycast so update the visitation mark which tells us if stuff has already been processed
-    gValidCount++;
-
-    // Do a raycast against the BSP tree and return if sight is unobstructed.
-    // Also narrows the vertical sight range with each lower and upper wall encountered.
-    return PS_CrossBSPNode(gNumBspNodes - 1);
+    return true;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -181,13 +556,23 @@ static bool PS_CrossSubsector(subsector_t& subsec) noexcept {
         seg_t& seg = pSegs[segIdx];
         line_t& line = *seg.linedef;
 
-        // Skip past this seg's line if we've already done it this sight check.
-        // Multiple segs might reference the same line, so this saves redundant work:
-        if (line.validcount == gValidCount)
-            continue;
+        // PsyDoom: lines are not marked as done during parallel sight checks, since the marks are shared by all threads.
+        // Checking the same line again is redundant but harmless - it has exactly the same outcome as the first time.
+        #if PSYDOOM_MODS
+            const bool bUseValidCount = (!gbParallelSightCheck);
+        #else
+            constexpr bool bUseValidCount = true;
+        #endif
 
-        // Don't check the line again until the next sight check
-        line.validcount = gValidCount;
+        if (bUseValidCount) {
+            // Skip past this seg's line if we've already done it this sight check.
+            // Multiple segs might reference the same line, so this saves redundant work:
+            if (line.validcount == gValidCount)
+                continue;
+
+            // Don't check the line again until the next sight check
+            line.validcount = gValidCount;
+        }
 
         // If the sight line does not intersect along the actual line points then ignore.
         // Not sure where the magics here came from, probably through hacking/experimentation?
@@ -274,31 +659,38 @@ static bool PS_CrossSubsector(subsector_t& subsec) noexcept {
 // Returns 'true' if the sight line is unobstructed.
 //------------------------------------------------------------------------------------------------------------------------------------------
 bool PS_CrossBSPNode(const int32_t nodeNum) noexcept {
-    // Is this bsp node actually a subsector? (leaf node) If so then do sight checks against that:
-    if (nodeNum & NF_SUBSECTOR) {
-        const int32_t subsecNum = nodeNum & (~NF_SUBSECTOR);
-
-        if (subsecNum < gNumSubsectors) {
-            return PS_CrossSubsector(gpSubsectors[subsecNum]);
-        } else {
-            I_Error("PS_CrossSubsector: ss %i with numss = %i", subsecNum, gNumSubsectors);     // Bad subsector number!
-            return false;
+    // PsyDoom: use the BSP traversal shared with shooting (which inlines the per subsector checks)
+    #if PSYDOOM_MODS
+        return P_TraceBSPNode(nodeNum, gSTrace.x, gSTrace.y, gT2x, gT2y, [](subsector_t& subsec) noexcept {
+            return PS_CrossSubsector(subsec);
+        });
+    #else
+        // Is this bsp node actually a subsector? (leaf node) If so then do sight checks against that:
+        if (nodeNum & NF_SUBSECTOR) {
+            const int32_t subsecNum = nodeNum & (~NF_SUBSECTOR);
+
+            if (subsecNum < gNumSubsectors) {
+                return PS_CrossSubsector(gpSubsectors[subsecNum]);
+            } else {
+                I_Error("PS_CrossSubsector: ss %i with numss = %i", subsecNum, gNumSubsectors);     // Bad subsector number!
+                return false;
+            }
         }
-    }
 
-    // See what side of the bsp split the point is on: will check to see if the sight line is blocked by that half-space first
-    node_t& bspNode = gpBspNodes[nodeNum];
-    const int32_t sideNum = PA_DivlineSide(gSTrace.x, gSTrace.y, bspNode.line);
+        // See what side of the bsp split the point is on: will check to see if the sight line is blocked by that half-space first
+        node_t& bspNode = gpBspNodes[nodeNum];
+        const int32_t sideNum = PA_DivlineSide(gSTrace.x, gSTrace.y, bspNode.line);
 
-    // If the sight line cannot cross the closest half-space then we are done: sight is obstructed
-    if (!PS_CrossBSPNode(bspNode.children[sideNum]))
-        return false;
+        // If the sight line cannot cross the closest half-space then we are done: sight is obstructed
+        if (!PS_CrossBSPNode(bspNode.children[sideNum]))
+            return false;
 
-    // Check to see what side of the bsp split the end point for sight checking is on.
-    // If it's in the same half-space we just raycasted against then we are done - sight is unobstructed.
-    if (sideNum == PA_DivlineSide(gT2x, gT2y, bspNode.line))
-        return true;
+        // Check to see what side of the bsp split the end point for sight checking is on.
+        // If it's in the same half-space we just raycasted against then we are done - sight is unobstructed.
+        if (sideNum == PA_DivlineSide(gT2x, gT2y, bspNode.line))
+            return true;
 
-    // Failing that recurse into the opposite side of the BSP split and raycast against that, returning the result
-    return PS_CrossBSPNode(bspNode.children[sideNum ^ 1]);
+        // Failing that recurse into the opposite side of the BSP split and raycast against that, returning the result
+        return PS_CrossBSPNode(bspNode.children[sideNum ^ 1]);
+    #endif
 }
@@ -5,6 +5,7 @@
 #include "Doom/Renderer/r_main.h"
 #include "doomdata.h"
 #include "p_local.h"
+#include "p_maputl.h"
 #include "p_setup.h"
 #include "PsyDoom/Game.h"
 
@@ -188,19 +189,46 @@ static fixed_t P_CompletableFrac(const fixed_t dx, const fixed_t dy) noexcept {
     // Collide the movement line against all lines found in these cells.
     for (int32_t bmapX = bmapLx; bmapX <= bmapRx; ++bmapX) {
         for (int32_t bmapY = bmapBy; bmapY <= bmapTy; ++bmapY) {
-            // Get where the line numbers list for this blockmap cell starts in the blockmap
-            int16_t* pLineNum = (int16_t*) gpBlockmapLump + gpBlockmap[bmapX + bmapY * gBlockmapWidth];
+            // PsyDoom: use the packed line lists to skip lines with bounding boxes outside the movement box, without touching the lines.
+            // These lines would be ignored by 'SL_CheckLine' anyway, no matter how many times they are tested.
+            #if PSYDOOM_MODS
+                const blocklines_t& blockLines = gBlockLines;
+                const int32_t cellIdx = bmapX + bmapY * gBlockmapWidth;
+                const uint32_t endIdx = blockLines.cellStart[cellIdx + 1];
+
+                for (uint32_t i = blockLines.cellStart[cellIdx]; i < endIdx; ++i) {
+                    const bool bNoBBOverlap = (
+                        (gEndBox[BOXTOP] < blockLines.bboxBottom[i]) ||
+                        (gEndBox[BOXBOTTOM] > blockLines.bboxTop[i]) ||
+                        (gEndBox[BOXLEFT] > blockLines.bboxRight[i]) ||
+                        (gEndBox[BOXRIGHT] < blockLines.bboxLeft[i])
+                    );
+
+                    if (bNoBBOverlap)
+                        continue;
 
-            // Collide against all of the lines in this cell
-            for (; *pLineNum != -1; ++pLineNum) {
-                line_t& line = gpLines[*pLineNum];
+                    line_t& line = gpLines[blockLines.lineNum[i]];
 
-                // Only collide against this line if we didn't already do it
-                if (line.validcount != gValidCount) {
-                    line.validcount = gValidCount;
-                    SL_CheckLine(line);
+                    if (line.validcount != gValidCount) {
+                        line.validcount = gValidCount;
+                        SL_CheckLine(line);
+                    }
                 }
-            }
+            #else
+                // Get where the line numbers list for this blockmap cell starts in the blockmap
+                int16_t* pLineNum = (int16_t*) gpBlockmapLump + gpBlockmap[bmapX + bmapY * gBlockmapWidth];
+
+                // Collide against all of the lines in this cell
+                for (; *pLineNum != -1; ++pLineNum) {
+                    line_t& line = gpLines[*pLineNum];
+
+                    // Only collide against this line if we didn't already do it
+                    if (line.validcount != gValidCount) {
+                        line.validcount = gValidCount;
+                        SL_CheckLine(line);
+                    }
+                }
+            #endif
         }
     }
 
@@ -2,6 +2,7 @@
 
 #include "Asserts.h"
 #include "Doom/Base/i_main.h"
+#include "Doom/Base/i_texcache.h"
 #include "Doom/Base/m_random.h"
 #include "Doom/Base/s_sound.h"
 #include "Doom/Base/sounds.h"
@@ -28,9 +29,12 @@
 #include "PsyDoom/Config/Config.h"
 #include "PsyDoom/Game.h"
 #include "PsyDoom/MapInfo/GecMapInfo.h"
+#include "PsyDoom/Overlay/AchievementMgr.h"
 #include "PsyDoom/ParserTokenizer.h"
 #include "PsyDoom/ScriptingEngine.h"
+#include "PsyDoom/ThinkerPool.h"
 
+#include <algorithm>
 #include <cstdlib>
 #include <memory>
 #include <string>
@@ -72,6 +76,33 @@ static const animdef_t gBaseAnimDefs[BASE_NUM_ANIMS_FDOOM] = {
     #define gAnimDefs gBaseAnimDefs
 #endif
 
+#if PSYDOOM_MODS
+    // PsyDoom: indexes built once the level has loaded to speed up finding sectors by tag and finding the sectors surrounding a sector.
+    //
+    //  (1) Every sector sorted by tag and then sector index, so the next sector with a given tag can be found via a binary search.
+    //  (2) For each sector, the lines which can lead to a neighbouring sector (ones with a back sector) and the sector on the other side.
+    //      Since line flags can be changed by scripts the two-sided flag for each line is still checked when these are used.
+    //
+    // Both indexes are empty when they are not built, in which case the sector and line lists are searched instead.
+    struct sectortag_t {
+        int32_t     tag;
+        int32_t     sectorIdx;
+
+        inline bool operator < (const sectortag_t& other) const noexcept {
+            return ((tag < other.tag) || ((tag == other.tag) && (sectorIdx < other.sectorIdx)));
+        }
+    };
+
+    struct sectorneighbour_t {
+        line_t*     pLine;          // The line leading to the neighbouring sector
+        sector_t*   pSector;        // The sector on the other side of the line
+    };
+
+    static std::vector<sectortag_t>         gSectorsByTag;
+    static std::vector<sectorneighbour_t>   gSectorNeighbours;
+    static std::vector<int32_t>             gSectorNeighboursBeg;   // Index of the first neighbour for each sector, plus an end index
+#endif
+
 card_t      gMapBlueKeyType;        // What type of blue key the map uses (if map has a blue key)
 card_t      gMapRedKeyType;         // What type of red key the map uses (if map has a red key)
 card_t      gMapYellowKeyType;      // What type of yellow key the map uses (if map has a yellow key)
@@ -88,6 +119,11 @@ int32_t     gMapBossSpecialFlags;   // PSX addition: What types of boss specials
 // Points to the end of the list of animated textures
 static anim_t* gpLastAnim;
 
+// PsyDoom limit removing: a temporary list of all animation frames to be made resident in VRAM by 'P_InitPicAnims'
+#if PSYDOOM_LIMIT_REMOVING
+    static std::vector<texture_t*> gResidentAnimTextures;
+#endif
+
 // PsyDoom: can now have as many scrolling lines as we want
 #if PSYDOOM_LIMIT_REMOVING
     static std::vector<line_t*> gpLineSpecialList;      // A list of scrolling lines for the level
@@ -250,6 +286,7 @@ void P_SetAnimsToBasePic() noexcept {
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Caches into RAM the textures for all animated flats and textures.
 // Also sets up the spot in VRAM where these animations will go - they occupy the same spot as the base animation frame.
+// PsyDoom limit removing: each frame now gets its own locked spot in VRAM instead, so animating never requires re-uploading textures.
 //------------------------------------------------------------------------------------------------------------------------------------------
 void P_InitPicAnims() noexcept {
     // PsyDoom: the list of anims and anim defs is now dynamic
@@ -301,10 +338,14 @@ void P_InitPicAnims() noexcept {
                     W_CacheLumpNum(gFirstTexLumpNum + picNum, PU_ANIMATION, false);
                 #endif
 
-                dstTex.texPageCoordX = basetex.texPageCoordX;
-                dstTex.texPageCoordY = basetex.texPageCoordY;
-                dstTex.texPageId = basetex.texPageId;
-                dstTex.ppTexCacheEntries = basetex.ppTexCacheEntries;
+                #if PSYDOOM_LIMIT_REMOVING
+                    gResidentAnimTextures.push_back(&dstTex);
+                #else
+                    dstTex.texPageCoordX = basetex.texPageCoordX;
+                    dstTex.texPageCoordY = basetex.texPageCoordY;
+                    dstTex.texPageId = basetex.texPageId;
+                    dstTex.ppTexCacheEntries = basetex.ppTexCacheEntries;
+                #endif
             }
         } else {
             // Determine the lump range for the animation
@@ -335,10 +376,14 @@ void P_InitPicAnims() noexcept {
                     W_CacheLumpNum(gFirstFlatLumpNum + picNum, PU_ANIMATION, false);
                 #endif
 
-                dstTex.texPageCoordX = basetex.texPageCoordX;
-                dstTex.texPageCoordY = basetex.texPageCoordY;
-                dstTex.texPageId = basetex.texPageId;
-                dstTex.ppTexCacheEntries = basetex.ppTexCacheEntries;
+                #if PSYDOOM_LIMIT_REMOVING
+                    gResidentAnimTextures.push_back(&dstTex);
+                #else
+                    dstTex.texPageCoordX = basetex.texPageCoordX;
+                    dstTex.texPageCoordY = basetex.texPageCoordY;
+                    dstTex.texPageId = basetex.texPageId;
+                    dstTex.ppTexCacheEntries = basetex.ppTexCacheEntries;
+                #endif
             }
         }
 
@@ -350,6 +395,18 @@ void P_InitPicAnims() noexcept {
 
         gpLastAnim++;
     }
+
+    // PsyDoom limit removing: give every frame of each animation its own spot in VRAM and lock them all there for the level.
+    // With all frames resident the animation only needs to change the texture translation index, and never has to re-upload anything.
+    #if PSYDOOM_LIMIT_REMOVING
+        I_CacheTexBatch(gResidentAnimTextures.data(), (uint32_t) gResidentAnimTextures.size());
+
+        for (texture_t* const pTex : gResidentAnimTextures) {
+            pTex->bIsLocked = pTex->bIsCached;
+        }
+
+        gResidentAnimTextures.clear();
+    #endif
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -385,20 +442,119 @@ sector_t* getNextSector(line_t& line, sector_t& sector) noexcept {
     return (&sector == pFrontSec) ? line.backsector : pFrontSec;
 }
 
+#if PSYDOOM_MODS
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Return the lowest floor height for sectors surrounding the given sector, and including the input sector itself
+// PsyDoom: builds the indexes used to find sectors by tag and the sectors surrounding a sector.
+// Should be called once all level geometry has been loaded and patched.
 //------------------------------------------------------------------------------------------------------------------------------------------
-fixed_t P_FindLowestFloorSurrounding(sector_t& sector) noexcept {
-    fixed_t lowestFloor = sector.floorheight;
+void P_InitSectorIndexes() noexcept {
+    // Sort all the sectors by tag
+    gSectorsByTag.clear();
+    gSectorsByTag.reserve((size_t) gNumSectors);
+
+    for (int32_t secIdx = 0; secIdx < gNumSectors; ++secIdx) {
+        gSectorsByTag.push_back({ gpSectors[secIdx].tag, secIdx });
+    }
+
+    std::sort(gSectorsByTag.begin(), gSectorsByTag.end());
+
+    // Gather the potential neighbours for each sector, in line order
+    gSectorNeighbours.clear();
+    gSectorNeighboursBeg.clear();
+    gSectorNeighboursBeg.reserve((size_t) gNumSectors + 1);
+
+    for (int32_t secIdx = 0; secIdx < gNumSectors; ++secIdx) {
+        sector_t& sector = gpSectors[secIdx];
+        gSectorNeighboursBeg.push_back((int32_t) gSectorNeighbours.size());
+
+        for (int32_t lineIdx = 0; lineIdx < sector.linecount; ++lineIdx) {
+            line_t& line = *sector.lines[lineIdx];
+
+            // Note: same logic as 'getNextSector' except for the two-sided flag check, since that can change
+            if (line.backsector) {
+                sector_t* const pOtherSector = (&sector == line.frontsector) ? line.backsector : line.frontsector;
+                gSectorNeighbours.push_back({ &line, pOtherSector });
+            }
+        }
+    }
+
+    gSectorNeighboursBeg.push_back((int32_t) gSectorNeighbours.size());
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: clears the sector indexes so they are not used until rebuilt; should be called before a new level's geometry is loaded
+//------------------------------------------------------------------------------------------------------------------------------------------
+void P_ClearSectorIndexes() noexcept {
+    gSectorsByTag.clear();
+    gSectorNeighbours.clear();
+    gSectorNeighboursBeg.clear();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: changes the tag for a sector and updates the index of sectors by tag to match
+//------------------------------------------------------------------------------------------------------------------------------------------
+void P_SetSectorTag(sector_t& sector, const int32_t tag) noexcept {
+    const int32_t secIdx = (int32_t)(&sector - gpSectors);
+    const bool bIndexed = ((secIdx >= 0) && (secIdx < gNumSectors) && (gSectorsByTag.size() == (size_t) gNumSectors));
+
+    if (bIndexed && (sector.tag != tag)) {
+        const auto oldEntryIter = std::lower_bound(gSectorsByTag.begin(), gSectorsByTag.end(), sectortag_t{ sector.tag, secIdx });
+        ASSERT((oldEntryIter != gSectorsByTag.end()) && (oldEntryIter->sectorIdx == secIdx));
+        gSectorsByTag.erase(oldEntryIter);
+
+        const sectortag_t newEntry = { tag, secIdx };
+        gSectorsByTag.insert(std::lower_bound(gSectorsByTag.begin(), gSectorsByTag.end(), newEntry), newEntry);
+    }
+
+    sector.tag = tag;
+}
+#endif  // #if PSYDOOM_MODS
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Helper: invokes the given function for every sector surrounding the given sector (the sector on the other side of each two-sided line).
+// Note that the same surrounding sector may be visited more than once if it shares multiple lines with the sector.
+// PsyDoom: uses the precomputed neighbours list if available, so one-sided lines don't need to be visited.
+//------------------------------------------------------------------------------------------------------------------------------------------
+template <class T>
+static inline void P_ForEachSurroundingSector(sector_t& sector, const T& func) noexcept {
+    #if PSYDOOM_MODS
+        const int32_t secIdx = (int32_t)(&sector - gpSectors);
+
+        if ((secIdx >= 0) && ((size_t) secIdx + 1 < gSectorNeighboursBeg.size())) {
+            const sectorneighbour_t* const pBeg = gSectorNeighbours.data() + gSectorNeighboursBeg[secIdx];
+            const sectorneighbour_t* const pEnd = gSectorNeighbours.data() + gSectorNeighboursBeg[secIdx + 1];
+
+            for (const sectorneighbour_t* pNeighbour = pBeg; pNeighbour < pEnd; ++pNeighbour) {
+                if (pNeighbour->pLine->flags & ML_TWOSIDED) {
+                    func(*pNeighbour->pSector);
+                }
+            }
+
+            return;
+        }
+    #endif
 
     for (int32_t lineIdx = 0; lineIdx < sector.linecount; ++lineIdx) {
         line_t& line = *sector.lines[lineIdx];
         sector_t* const pNextSector = getNextSector(line, sector);
 
-        if (pNextSector && (pNextSector->floorheight < lowestFloor)) {
-            lowestFloor = pNextSector->floorheight;
+        if (pNextSector) {
+            func(*pNextSector);
         }
     }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Return the lowest floor height for sectors surrounding the given sector, and including the input sector itself
+//------------------------------------------------------------------------------------------------------------------------------------------
+fixed_t P_FindLowestFloorSurrounding(sector_t& sector) noexcept {
+    fixed_t lowestFloor = sector.floorheight;
+
+    P_ForEachSurroundingSector(sector, [&](const sector_t& nextSector) noexcept {
+        if (nextSector.floorheight < lowestFloor) {
+            lowestFloor = nextSector.floorheight;
+        }
+    });
 
     return lowestFloor;
 }
@@ -410,14 +566,11 @@ fixed_t P_FindLowestFloorSurrounding(sector_t& sector) noexcept {
 fixed_t P_FindHighestFloorSurrounding(sector_t& sector) noexcept {
     fixed_t highestFloor = -500 * FRACUNIT;
 
-    for (int32_t lineIdx = 0; lineIdx < sector.linecount; ++lineIdx) {
-        line_t& line = *sector.lines[lineIdx];
-        sector_t* const pNextSector = getNextSector(line, sector);
-
-        if (pNextSector && (pNextSector->floorheight > highestFloor)) {
-            highestFloor = pNextSector->floorheight;
+    P_ForEachSurroundingSector(sector, [&](const sector_t& nextSector) noexcept {
+        if (nextSector.floorheight > highestFloor) {
+            highestFloor = nextSector.floorheight;
         }
-    }
+    });
 
     return highestFloor;
 }
@@ -447,19 +600,13 @@ fixed_t P_FindNextHighestFloor(sector_t& sector, const fixed_t baseHeight) noexc
     #if PSYDOOM_MODS && PSYDOOM_FIX_UB
         fixed_t nextHighestFloor = INT32_MAX;
 
-        for (int32_t lineIdx = 0; lineIdx < sector.linecount; ++lineIdx) {
-            line_t& line = *sector.lines[lineIdx];
-            sector_t* const pNextSector = getNextSector(line, sector);
-
-            if (!pNextSector)
-                continue;
-
-            const fixed_t floorH = pNextSector->floorheight;
+        P_ForEachSurroundingSector(sector, [&](const sector_t& nextSector) noexcept {
+            const fixed_t floorH = nextSector.floorheight;
 
             if ((floorH > baseHeight) && (floorH < nextHighestFloor)) {
                 nextHighestFloor = floorH;
             }
-        }
+        });
 
         // If there is no next highest floor return the input height rather than something undefined
         return (nextHighestFloor != INT32_MAX) ? nextHighestFloor : baseHeight;
@@ -498,14 +645,11 @@ fixed_t P_FindNextHighestFloor(sector_t& sector, const fixed_t baseHeight) noexc
 fixed_t P_FindLowestCeilingSurrounding(sector_t& sector) noexcept {
     fixed_t lowestHeight = INT32_MAX;
 
-    for (int32_t lineIdx = 0; lineIdx < sector.linecount; ++lineIdx) {
-        line_t& line = *sector.lines[lineIdx];
-        sector_t* const pNextSector = getNextSector(line, sector);
-
-        if (pNextSector && (pNextSector->ceilingheight < lowestHeight)) {
-            lowestHeight = pNextSector->ceilingheight;
+    P_ForEachSurroundingSector(sector, [&](const sector_t& nextSector) noexcept {
+        if (nextSector.ceilingheight < lowestHeight) {
+            lowestHeight = nextSector.ceilingheight;
         }
-    }
+    });
 
     return lowestHeight;
 }
@@ -517,14 +661,11 @@ fixed_t P_FindLowestCeilingSurrounding(sector_t& sector) noexcept {
 fixed_t P_FindHighestCeilingSurrounding(sector_t& sector) noexcept {
     fixed_t highestHeight = 0;
 
-    for (int32_t lineIdx = 0; lineIdx < sector.linecount; ++lineIdx) {
-        line_t& line = *sector.lines[lineIdx];
-        sector_t* const pNextSector = getNextSector(line, sector);
-
-        if (pNextSector && (pNextSector->ceilingheight > highestHeight)) {
-            highestHeight = pNextSector->ceilingheight;
+    P_ForEachSurroundingSector(sector, [&](const sector_t& nextSector) noexcept {
+        if (nextSector.ceilingheight > highestHeight) {
+            highestHeight = nextSector.ceilingheight;
         }
-    }
+    });
 
     return highestHeight;
 }
@@ -535,19 +676,47 @@ fixed_t P_FindHighestCeilingSurrounding(sector_t& sector) noexcept {
 // Returns the index of the next matching sector found, or '-1' if there was no next matching sector.
 //------------------------------------------------------------------------------------------------------------------------------------------
 int32_t P_FindSectorFromLineTag(line_t& line, const int32_t searchStart) noexcept {
-    const int32_t lineTag = line.tag;
-    sector_t* const pSectors = gpSectors;
-    const int32_t numSectors = gNumSectors;
+    #if PSYDOOM_MODS
+        return P_FindSectorFromTag(line.tag, searchStart);
+    #else
+        const int32_t lineTag = line.tag;
+        sector_t* const pSectors = gpSectors;
+        const int32_t numSectors = gNumSectors;
+
+        for (int32_t sectorIdx = searchStart + 1; sectorIdx < numSectors; ++sectorIdx) {
+            sector_t& sector = pSectors[sectorIdx];
 
-    for (int32_t sectorIdx = searchStart + 1; sectorIdx < numSectors; ++sectorIdx) {
-        sector_t& sector = pSectors[sectorIdx];
+            if (sector.tag == lineTag)
+                return sectorIdx;
+        }
+
+        return -1;
+    #endif
+}
+
+#if PSYDOOM_MODS
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: find the next sector in the global sectors list with the given tag, starting the search at the given index + 1.
+// Returns the index of the next matching sector found, or '-1' if there was no next matching sector.
+// Uses the index of sectors by tag if it is built, otherwise searches the sectors list.
+//------------------------------------------------------------------------------------------------------------------------------------------
+int32_t P_FindSectorFromTag(const int32_t tag, const int32_t searchStart) noexcept {
+    if (gSectorsByTag.size() == (size_t) gNumSectors) {
+        const sectortag_t searchEntry = { tag, std::max(searchStart + 1, 0) };
+        const auto iter = std::lower_bound(gSectorsByTag.begin(), gSectorsByTag.end(), searchEntry);
+        return ((iter != gSectorsByTag.end()) && (iter->tag == tag)) ? iter->sectorIdx : -1;
+    }
+
+    const int32_t numSectors = gNumSectors;
 
-        if (sector.tag == lineTag)
+    for (int32_t sectorIdx = std::max(searchStart + 1, 0); sectorIdx < numSectors; ++sectorIdx) {
+        if (gpSectors[sectorIdx].tag == tag)
             return sectorIdx;
     }
 
     return -1;
 }
+#endif  // #if PSYDOOM_MODS
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Find the minimum light level in the sectors surrounding the given sector which is less than the given max light level.
@@ -556,14 +725,11 @@ int32_t P_FindSectorFromLineTag(line_t& line, const int32_t searchStart) noexcep
 int32_t P_FindMinSurroundingLight(sector_t& sector, const int32_t maxLightLevel) noexcept {
     int32_t minLightLevel = maxLightLevel;
 
-    for (int32_t lineIdx = 0; lineIdx < sector.linecount; ++lineIdx) {
-        line_t& line = *sector.lines[lineIdx];
-        sector_t* const pNextSector = getNextSector(line, sector);
-
-        if (pNextSector && (pNextSector->lightlevel < minLightLevel)) {
-            minLightLevel = pNextSector->lightlevel;
+    P_ForEachSurroundingSector(sector, [&](const sector_t& nextSector) noexcept {
+        if (nextSector.lightlevel < minLightLevel) {
+            minLightLevel = nextSector.lightlevel;
         }
-    }
+    });
 
     return minLightLevel;
 }
@@ -1242,6 +1408,13 @@ void P_PlayerInSpecialSector(player_t& player) noexcept {
         case 9: {
             player.secretcount += 1;
             sector.special = 0;         // Consume the special so it's only counted once!
+
+            // PsyDoom: let achievements know if the local player found a secret
+            #if PSYDOOM_MODS
+                if (&player == &gPlayers[gCurPlayerIndex]) {
+                    AchievementManager::Get().RaiseEvent(AchievementEventType::Secret, gGameMap);
+                }
+            #endif
         }   break;
 
     // PsyDoom: add support for the PC E1M8 style exit.
@@ -1304,12 +1477,19 @@ void P_UpdateSpecials() noexcept {
 
         // Update the texture translation table and mark the texture as needing uploading to the cache.
         // For animated flats and walls only the current frame is kept in VRAM, to save on precious VRAM space.
+        // PsyDoom limit removing: all frames are kept resident in VRAM, so only the translation needs to change.
         if (pAnim->istexture) {
             gpTextureTranslation[pAnim->basepic] = pAnim->current;
-            gpTextures[pAnim->current].uploadFrameNum = TEX_INVALID_UPLOAD_FRAME_NUM;
+
+            #if !PSYDOOM_LIMIT_REMOVING
+                gpTextures[pAnim->current].uploadFrameNum = TEX_INVALID_UPLOAD_FRAME_NUM;
+            #endif
         } else {
             gpFlatTranslation[pAnim->basepic] = pAnim->current;
-            gpFlatTextures[pAnim->current].uploadFrameNum = TEX_INVALID_UPLOAD_FRAME_NUM;
+
+            #if !PSYDOOM_LIMIT_REMOVING
+                gpFlatTextures[pAnim->current].uploadFrameNum = TEX_INVALID_UPLOAD_FRAME_NUM;
+            #endif
         }
     }
 
@@ -1471,7 +1651,11 @@ bool EV_DoDonut(line_t& line) noexcept {
             // This raises the floor to the height of the back sector we just found and changes the texture to that.
             // This is normally used to raise slime and change the slime texture.
             {
-                floormove_t& floorMove = *(floormove_t*) Z_Malloc(*gpMainMemZone, sizeof(floormove_t), PU_LEVSPEC, nullptr);
+                #if PSYDOOM_MODS
+                    floormove_t& floorMove = ThinkerPool::alloc<floormove_t>(PU_LEVSPEC);
+                #else
+                    floormove_t& floorMove = *(floormove_t*) Z_Malloc(*gpMainMemZone, sizeof(floormove_t), PU_LEVSPEC, nullptr);
+                #endif
 
                 #if PSYDOOM_MODS
                     floorMove = {};     // PsyDoom: zero-init all fields to be safe
@@ -1494,7 +1678,11 @@ bool EV_DoDonut(line_t& line) noexcept {
             // Create the mover for the inner part or the 'hole' of the donut.
             // This sector just lowers down to the height of the back sector we just found.
             {
-                floormove_t& floorMove = *(floormove_t*) Z_Malloc(*gpMainMemZone, sizeof(floormove_t), PU_LEVSPEC, nullptr);
+                #if PSYDOOM_MODS
+                    floormove_t& floorMove = ThinkerPool::alloc<floormove_t>(PU_LEVSPEC);
+                #else
+                    floormove_t& floorMove = *(floormove_t*) Z_Malloc(*gpMainMemZone, sizeof(floormove_t), PU_LEVSPEC, nullptr);
+                #endif
 
                 #if PSYDOOM_MODS
                     floorMove = {};     // PsyDoom: zero-init all fields to be safe
@@ -1524,7 +1712,11 @@ bool EV_DoDonut(line_t& line) noexcept {
 // Schedule an action to be invoked after the specified number of tics
 //------------------------------------------------------------------------------------------------------------------------------------------
 static void P_ScheduleDelayedAction(const int32_t delayTics, const delayed_actionfn_t actionFunc) noexcept {
-    delayaction_t& delayed = *(delayaction_t*) Z_Malloc(*gpMainMemZone, sizeof(delayaction_t), PU_LEVSPEC, nullptr);
+    #if PSYDOOM_MODS
+        delayaction_t& delayed = ThinkerPool::alloc<delayaction_t>(PU_LEVSPEC);
+    #else
+        delayaction_t& delayed = *(delayaction_t*) Z_Malloc(*gpMainMemZone, sizeof(delayaction_t), PU_LEVSPEC, nullptr);
+    #endif
     P_AddThinker(delayed.thinker);
 
     delayed.thinker.function = (think_t) &T_DelayedAction;
@@ -47,6 +47,10 @@ extern int32_t  gMapBossSpecialFlags;
 #if PSYDOOM_MODS
     void P_InitAnimDefs() noexcept;
     void P_SetAnimsToBasePic() noexcept;
+    void P_InitSectorIndexes() noexcept;
+    void P_ClearSectorIndexes() noexcept;
+    void P_SetSectorTag(sector_t& sector, const int32_t tag) noexcept;
+    int32_t P_FindSectorFromTag(const int32_t tag, const int32_t searchStart) noexcept;
 #endif
 
 void P_InitPicAnims() noexcept;
@@ -10,6 +10,7 @@
 #include "Doom/Base/z_zone.h"
 #include "Doom/d_main.h"
 #include "Doom/psx_main.h"
+#include "Doom/Renderer/r_local.h"
 #include "Doom/Renderer/r_main.h"
 #include "Doom/RendererVk/rv_data.h"
 #include "Doom/RendererVk/rv_main.h"
@@ -20,27 +21,37 @@
 #include "g_game.h"
 #include "info.h"
 #include "p_base.h"
+#include "p_lights.h"
 #include "p_local.h"
 #include "p_mobj.h"
+#include "p_setup.h"
 #include "p_sight.h"
 #include "p_spec.h"
 #include "p_user.h"
 #include "PsyDoom/Cheats.h"
 #include "PsyDoom/Config/Config.h"
+#include "PsyDoom/Overlay/AchievementMgr.h"
 #include "PsyDoom/Overlay/OverlayMain.h"
 #include "PsyDoom/Controls.h"
 #include "PsyDoom/DemoPlayer.h"
 #include "PsyDoom/DemoResult.h"
 #include "PsyDoom/DevMapAutoReloader.h"
+#include "PsyDoom/FrameProfiler.h"
 #include "PsyDoom/Game.h"
 #include "PsyDoom/i_modern_input.h"
 #include "PsyDoom/Input.h"
 #include "PsyDoom/MapInfo/MapInfo.h"
+#include "PsyDoom/MobjSpritePrecacher.h"
 #include "PsyDoom/PlayerPrefs.h"
 #include "PsyDoom/ProgArgs.h"
 #include "PsyDoom/PsxPadButtons.h"
+#include "PsyDoom/RewindBuffer.h"
 #include "PsyDoom/SaveAndLoad.h"
 #include "PsyDoom/ScriptingEngine.h"
+#include "PsyDoom/SoakTest.h"
+#include "PsyDoom/ThinkerPool.h"
+#include "PsyDoom/TimeDemo.h"
+#include "PsyDoom/Utils.h"
 #include "PsyDoom/Video.h"
 #include "PsyQ/LIBGPU.h"
 #include "Wess/psxcd.h"
@@ -99,7 +110,8 @@ int32_t     gTicConOnPause;                         // What 1 vblank tick we pau
 #if PSYDOOM_MODS
     TickInputs  gTickInputs[MAXPLAYERS];        // Current tick inputs for the current 30 Hz tick
     TickInputs  gOldTickInputs[MAXPLAYERS];     // Previous tick inputs for the last 30 Hz tick
-    TickInputs  gNextTickInputs;                // Network games only: what inputs we told the other player we will use next; sent ahead of time to reduce lag
+    TickInputs  gNextTickInputs[NET_MAX_INPUT_DELAY];   // Network games only: inputs we told the other player we will use next (in order); sent ahead of time to reduce lag
+    int32_t     gNumNextTickInputs;                     // Network games only: how many entries in 'gNextTickInputs' are in use (the current input delay in ticks)
     uint32_t    gTicButtons;                    // Currently PSX pad buttons for this player
     uint32_t    gOldTicButtons;                 // Previously pressed PSX buttons for this player
     bool        gbIgnoreCurrentAttack;          // A flag set to prevent accidental firing on returning to the game - causes attack to be ignored until the key is released
@@ -114,6 +126,23 @@ int32_t     gTicConOnPause;                         // What 1 vblank tick we pau
 static uint16_t     gCheatSequenceBtns[CHEAT_SEQ_LEN];      // Cheat sequence buttons inputted by the player
 static int32_t      gNumActiveThinkers;                     // Stat tracking count, no use other than that
 
+#if PSYDOOM_MODS
+    // PsyDoom: a list of thinkers with the same think function which have been moved out of the main thinkers list.
+    // This allows the thinkers to be updated in a tight loop with a direct function call. See 'P_SegregateThinkers' for more details.
+    struct ThinkerBucket {
+        think_t                     function;
+        std::vector<thinker_t*>     thinkers;
+    };
+
+    static ThinkerBucket gThinkerBuckets[] = {
+        { (think_t) &T_Glow,            {} },
+        { (think_t) &T_StrobeFlash,     {} },
+    };
+
+    static bool                     gbSegregateThinkersPending;     // If set then try to move thinkers into buckets on the next thinkers update
+    static std::vector<uint8_t>     gSectorLightThinkerCounts;      // Used during segregation: how many light thinkers affect each sector
+#endif
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Add a thinker to the linked list of thinkers
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -132,18 +161,185 @@ void P_RemoveThinker(thinker_t& thinker) noexcept {
     thinker.function = (think_t)(intptr_t) -1;
 }
 
+#if PSYDOOM_MODS
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: if the given thinker is a light thinker then returns the sector it affects, otherwise returns null
+//------------------------------------------------------------------------------------------------------------------------------------------
+static sector_t* P_GetLightThinkerSector(thinker_t& thinker) noexcept {
+    const think_t function = thinker.function;
+
+    if (function == (think_t) &T_FireFlicker)
+        return reinterpret_cast<fireflicker_t&>(thinker).sector;
+
+    if (function == (think_t) &T_LightFlash)
+        return reinterpret_cast<lightflash_t&>(thinker).sector;
+
+    if (function == (think_t) &T_StrobeFlash)
+        return reinterpret_cast<strobe_t&>(thinker).sector;
+
+    if (function == (think_t) &T_Glow)
+        return reinterpret_cast<glow_t&>(thinker).sector;
+
+    return nullptr;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: moves thinkers which can safely be updated out of order from the main thinkers list into buckets of their own type.
+//
+// The main thinkers list must be updated in order for demos to stay in sync, since many thinkers use the random number generator
+// (flickering lights, or movers crushing things for example) and the order determines which random numbers each thinker gets.
+// Glowing and strobing lights however don't use random numbers and only read and write the light level of their own sector,
+// so they can be updated before all other thinkers without changing the outcome - provided that:
+//
+//  (1) No other light thinker affects the same sector. If another light thinker is added for the sector later on, then it's fine
+//      since it would have come after the bucketed light in the main thinkers list anyway.
+//  (2) The map has no scripts, since scripted actions executed by thinkers might read sector light levels.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void P_SegregateThinkers() noexcept {
+    gbSegregateThinkersPending = false;
+
+    if (ScriptingEngine::isActive())
+        return;
+
+    // Count how many light thinkers affect each sector, including ones previously moved to buckets
+    gSectorLightThinkerCounts.clear();
+    gSectorLightThinkerCounts.resize(gNumSectors);
+
+    const auto countLightThinker = [](thinker_t& thinker) noexcept {
+        if (sector_t* const pSector = P_GetLightThinkerSector(thinker)) {
+            uint8_t& count = gSectorLightThinkerCounts[pSector - gpSectors];
+            count = (uint8_t) std::min(count + 1, 255);
+        }
+    };
+
+    for (thinker_t* pThinker = gThinkerCap.next; pThinker != &gThinkerCap; pThinker = pThinker->next) {
+        countLightThinker(*pThinker);
+    }
+
+    for (ThinkerBucket& bucket : gThinkerBuckets) {
+        for (thinker_t* const pThinker : bucket.thinkers) {
+            countLightThinker(*pThinker);
+        }
+    }
+
+    // Move all the thinkers that can be bucketed into their buckets, preserving the relative order of the thinkers
+    thinker_t* pNextThinker;
+
+    for (thinker_t* pThinker = gThinkerCap.next; pThinker != &gThinkerCap; pThinker = pNextThinker) {
+        pNextThinker = pThinker->next;
+
+        for (ThinkerBucket& bucket : gThinkerBuckets) {
+            if (pThinker->function != bucket.function)
+                continue;
+
+            if (gSectorLightThinkerCounts[P_GetLightThinkerSector(*pThinker) - gpSectors] == 1) {
+                pThinker->next->prev = pThinker->prev;
+                pThinker->prev->next = pThinker->next;
+                bucket.thinkers.push_back(pThinker);
+            }
+
+            break;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: runs all the thinkers in the given bucket with a direct call to the think function.
+// Also removes any thinkers which are marked for removal.
+//------------------------------------------------------------------------------------------------------------------------------------------
+template <class ThinkerT, void (*ThinkFn)(ThinkerT&) noexcept>
+static void P_RunThinkerBucket(ThinkerBucket& bucket) noexcept {
+    bool bRemovedThinkers = false;
+
+    for (thinker_t*& pThinker : bucket.thinkers) {
+        if (pThinker->function == bucket.function) {
+            ThinkFn(reinterpret_cast<ThinkerT&>(*pThinker));
+        }
+        else if ((intptr_t) pThinker->function == (intptr_t) -1) {
+            ThinkerPool::dealloc(pThinker);
+            pThinker = nullptr;
+            bRemovedThinkers = true;
+            continue;
+        }
+
+        gNumActiveThinkers++;
+    }
+
+    if (bRemovedThinkers) {
+        bucket.thinkers.erase(std::remove(bucket.thinkers.begin(), bucket.thinkers.end(), nullptr), bucket.thinkers.end());
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: returns the thinkers with the specified think function which have been moved out of the main thinkers list.
+// Any code which searches the main thinkers list for thinkers of a particular type should search this list also.
+//------------------------------------------------------------------------------------------------------------------------------------------
+const std::vector<thinker_t*>& P_GetSegregatedThinkers(const think_t function) noexcept {
+    for (const ThinkerBucket& bucket : gThinkerBuckets) {
+        if (bucket.function == function)
+            return bucket.thinkers;
+    }
+
+    static const std::vector<thinker_t*> EMPTY_LIST;
+    return EMPTY_LIST;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: moves all thinkers in buckets back to the end of the main thinkers list
+//------------------------------------------------------------------------------------------------------------------------------------------
+void P_UnsegregateThinkers() noexcept {
+    for (ThinkerBucket& bucket : gThinkerBuckets) {
+        for (thinker_t* const pThinker : bucket.thinkers) {
+            P_AddThinker(*pThinker);
+        }
+
+        bucket.thinkers.clear();
+    }
+
+    gbSegregateThinkersPending = true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: forgets about all thinkers in buckets without freeing them; should be called when level memory is purged
+//------------------------------------------------------------------------------------------------------------------------------------------
+void P_ClearSegregatedThinkers() noexcept {
+    for (ThinkerBucket& bucket : gThinkerBuckets) {
+        bucket.thinkers.clear();
+    }
+
+    gbSegregateThinkersPending = true;
+}
+#endif  // #if PSYDOOM_MODS
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Execute think logic for all thinkers
 //------------------------------------------------------------------------------------------------------------------------------------------
 void P_RunThinkers() noexcept {
+    PROFILE_SCOPE(RunThinkers);
     gNumActiveThinkers = 0;
 
+    // PsyDoom: run thinkers which have been moved into buckets of their own type first.
+    // This is safe to do because these thinkers can be updated in any order relative to other thinkers.
+    #if PSYDOOM_MODS
+        if (gbSegregateThinkersPending) {
+            P_SegregateThinkers();
+        }
+
+        P_RunThinkerBucket<glow_t, T_Glow>(gThinkerBuckets[0]);
+        P_RunThinkerBucket<strobe_t, T_StrobeFlash>(gThinkerBuckets[1]);
+    #endif
+
     for (thinker_t* pThinker = gThinkerCap.next; pThinker != &gThinkerCap; pThinker = pThinker->next) {
         if ((intptr_t) pThinker->function == (intptr_t) -1) {
             // Time to remove this thinker, it's function has been zapped
             pThinker->next->prev = pThinker->prev;
             pThinker->prev->next = pThinker->next;
-            Z_Free2(*gpMainMemZone, pThinker);
+
+            #if PSYDOOM_MODS
+                ThinkerPool::dealloc(pThinker);
+            #else
+                Z_Free2(*gpMainMemZone, pThinker);
+            #endif
         } else {
             // Run the thinker if it has a think function and increment the active count stat
             if (pThinker->function) {
@@ -661,6 +857,7 @@ void P_CheckCheats() noexcept {
 // High level tick/update logic for main gameplay
 //------------------------------------------------------------------------------------------------------------------------------------------
 gameaction_t P_Ticker() noexcept {
+    PROFILE_SCOPE(Ticker);
     gGameAction = ga_nothing;
 
     #if PSYDOOM_MODS
@@ -736,9 +933,11 @@ gameaction_t P_Ticker() noexcept {
         P_RespawnSpecials();
         ST_Ticker();
 
-        // PsyDoom: allow the developer map auto-reloader to do it's thing and trigger a map reload if required
+        // PsyDoom: allow the developer map auto-reloader to do it's thing and trigger a map reload if required.
+        // Also stream in any sprites needed by things which have woken up or come near a player (if sprite streaming is enabled).
         #if PSYDOOM_MODS
             DevMapAutoReloader::update();
+            MobjSpritePrecacher::update();
         #endif
     }
 
@@ -785,6 +984,9 @@ gameaction_t P_Ticker() noexcept {
 
             gbDoQuicksave = false;
             gbDoQuickload = false;
+
+            // PsyDoom: record the game state for the developer rewind feature, or rewind if requested
+            RewindBuffer::update();
         }
     #endif
 
@@ -795,15 +997,24 @@ gameaction_t P_Ticker() noexcept {
 // Does all drawing for main gameplay
 //------------------------------------------------------------------------------------------------------------------------------------------
 void P_Drawer() noexcept {
-    // PsyDoom: no drawing in headless mode, but do advance the elapsed time.
+    // PsyDoom: no drawing in headless mode or while seeking through a demo, but do advance the elapsed time.
     // Keep the framerate at the appropriate amount (for PAL or NTSC mode) for consistent demo playback.
+    // When seeking still do platform updates however so that the window stays responsive.
     #if PSYDOOM_MODS
-        if (ProgArgs::gbHeadlessMode) {
+        const bool bDemoFastForward = DemoPlayer::isFastForwarding();
+
+        if (ProgArgs::gbHeadlessMode || bDemoFastForward) {
             const int32_t demoTickVBlanks = (Game::gSettings.bUsePalTimings) ? 3 : VBLANKS_PER_TIC;
 
+            if (bDemoFastForward && (!ProgArgs::gbHeadlessMode)) {
+                Utils::doPlatformUpdates();
+            }
+
             gTotalVBlanks += demoTickVBlanks;
             gLastTotalVBlanks = gTotalVBlanks;
             gElapsedVBlanks = demoTickVBlanks;
+            TimeDemo::onFrameDone();
+            SoakTest::onFrameDone();
             return;
         }
     #endif
@@ -847,6 +1058,8 @@ void P_Drawer() noexcept {
     // Was previously done at the start of 'R_RenderPlayerView', before any world drawing was done.
     #if PSYDOOM_MODS
         I_DrawPresent();
+        TimeDemo::onFrameDone();
+        SoakTest::onFrameDone();
     #endif
 }
 
@@ -905,12 +1118,15 @@ void P_Start() noexcept {
     // PsyDoom: start the level timer and auto save if requested
     #if PSYDOOM_MODS
         Game::startLevelTimer();
-        AchievementManager::Get().Unlock("DOOM_GUY");
+        AchievementManager::Get().RaiseEvent(AchievementEventType::LevelStart, gGameMap);
 
         if (gLevelTimerStartElapsedUsecs != 0) {
             Game::setLevelElapsedTimeMicrosecs(gLevelTimerStartElapsedUsecs);
         }
 
+        // PsyDoom: start timing demo playback if doing a timedemo benchmark
+        TimeDemo::onPlaybackStart();
+
         if (gbAutoSaveOnLevelStart) {
             gbAutoSaveOnLevelStart = false;
             SaveGameForSlot(SaveFileSlot::AUTOSAVE, SaveGameContext::Autosave);
@@ -945,6 +1161,9 @@ void P_Stop([[maybe_unused]] const gameaction_t exitAction) noexcept {
                 gbCheckDemoResultFailed = true;
             }
         }
+
+        // Print timedemo benchmark results if we were timing playback
+        TimeDemo::onPlaybackEnd();
     #endif
 
     // Stop all sounds and music.
@@ -2,6 +2,8 @@
 
 #include "Doom/doomdef.h"
 
+#include <vector>
+
 typedef uint32_t padbuttons_t;
 
 // How many 1 vblank ticks between menu movements - allow roughly 4 a second. This figure can be reset however
@@ -56,7 +58,8 @@ extern int32_t      gTicConOnPause;
 #if PSYDOOM_MODS
     extern TickInputs   gTickInputs[MAXPLAYERS];
     extern TickInputs   gOldTickInputs[MAXPLAYERS];
-    extern TickInputs   gNextTickInputs;
+    extern TickInputs   gNextTickInputs[NET_MAX_INPUT_DELAY];
+    extern int32_t      gNumNextTickInputs;
     extern uint32_t     gTicButtons;
     extern uint32_t     gOldTicButtons;
     extern bool         gbIgnoreCurrentAttack;
@@ -82,4 +85,7 @@ fixed_t P_GetGravity() noexcept;
 #if PSYDOOM_MODS
     void P_GatherTickInputs(TickInputs& inputs) noexcept;
     void P_PsxButtonsToTickInputs(const padbuttons_t buttons, const padbuttons_t* const pControlBindings, TickInputs& inputs) noexcept;
+    const std::vector<thinker_t*>& P_GetSegregatedThinkers(const think_t function) noexcept;
+    void P_UnsegregateThinkers() noexcept;
+    void P_ClearSegregatedThinkers() noexcept;
 #endif
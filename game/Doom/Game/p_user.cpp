@@ -1181,6 +1181,7 @@ void P_PlayerDoTurning() noexcept {
     // and it should NOT be added back in. If inputs are updated here then any new events received might be consumed prior
     // to rendering, because we consume used input events once the game tick is processed. The rule of thumb is that no
     // event polling should be done WHILE game logic is being processed. Inputs should only be updated BEFORE the tick starts.
+    // The one exception is 'Input::latchMouseMovements' (see below), which only takes mouse motion events from the queue.
     //
     const bool bCanTurn = (
         (!gbDemoPlayback) &&
@@ -1257,8 +1258,13 @@ void P_PlayerDoTurning() noexcept {
             gPlayerUncommittedTurning -= (angle_t) d_lshift<TURN_TO_ANGLE_SHIFT>(turnAmt);
         }
 
-        // Do turning from the mouse and consume the movements after we have counted them
+        // Do turning from the mouse and consume the movements after we have counted them.
+        // If enabled, pick up any mouse movement that has arrived since inputs were updated first, to reduce latency.
         {
+            if (Config::gbLateLatchMouseInput) {
+                Input::latchMouseMovements();
+            }
+
             const float axis = -Input::getMouseXMovement();
             const float turnSpeed = Config::gMouseTurnSpeed * PlayerPrefs::getTurnSpeedMultiplier();
             const fixed_t turnAmt = (fixed_t)(turnSpeed * axis);
@@ -1279,21 +1285,24 @@ void P_PlayerDoTurning() noexcept {
 void P_UncommitTurningTickInputs() noexcept {
     TickInputs& tickInputs = gTickInputs[gCurPlayerIndex];
 
-    // Note: for networked games we need to consider inputs for the next frame too
+    // Note: for networked games we need to consider inputs for the next frames too (up to the input delay)
     if (gNetGame == gt_single) {
         gPlayerUncommittedTurning += tickInputs.getAnalogTurn();
         tickInputs.setAnalogTurn(0);
     } else {
-        TickInputs& nextTickInputs = gNextTickInputs;
         gPlayerUncommittedTurning += tickInputs.getAnalogTurn();
-        gPlayerUncommittedTurning += nextTickInputs.getAnalogTurn();
         gPlayerNextTickViewAngle -= tickInputs.getAnalogTurn();         // Don't double count, remove the turning from this since it's already in there
-        gPlayerNextTickViewAngle -= nextTickInputs.getAnalogTurn();
 
-        // Note: even though it's REALLY bad practice to modify the inputs we said we'd do in the next frame, all peers understand that when
+        // Note: even though it's REALLY bad practice to modify the inputs we said we'd do in the next frames, all peers understand that when
         // the game is paused tick inputs are essentially discarded. So wiping the inputs in this way is ok to do in this limited situation:
         tickInputs.setAnalogTurn(0);
-        nextTickInputs.setAnalogTurn(0);
+
+        for (int32_t i = 0; i < gNumNextTickInputs; ++i) {
+            TickInputs& nextTickInputs = gNextTickInputs[i];
+            gPlayerUncommittedTurning += nextTickInputs.getAnalogTurn();
+            gPlayerNextTickViewAngle -= nextTickInputs.getAnalogTurn();
+            nextTickInputs.setAnalogTurn(0);
+        }
     }
 }
 #endif  // #if PSYDOOM_MODS
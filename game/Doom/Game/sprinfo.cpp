@@ -11,6 +11,7 @@
 
 #include "Doom/Base/i_main.h"
 #include "Doom/Base/w_wad.h"
+#include "Doom/Renderer/r_data.h"
 #include "SmallString.h"
 
 #include <algorithm>
@@ -283,6 +284,18 @@ static void populateSpriteFrameList() noexcept {
     }
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Resolves the sprite texture for every lump used by each sprite frame and viewing angle.
+// Expects the sprite textures to have been created already (see 'R_InitData') and the lumps for each frame to have been determined.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void resolveSpriteFrameTextures() noexcept {
+    for (spriteframe_t& frame : gSpriteFrames) {
+        for (int32_t i = 0; i < 8; ++i) {
+            frame.pTex[i] = R_FindTexForLump((int32_t) frame.lump[i]);
+        }
+    }
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Sorts the built-in sprite definitions first in the sprite list, and according to the order of the 'gBaseSprNames' list.
 // Following that any new (user-mod) sprite definitions are sorted according to name.
@@ -357,6 +370,7 @@ void P_InitSprites() noexcept {
 
     // Fill in the lump and rotation info for all sprites then sort the list of sprite definitions
     populateSpriteFrameList();
+    resolveSpriteFrameTextures();
     sortSpriteDefs();
 
     // Check whether extended enemy sprites are present (Arch-vile etc.)
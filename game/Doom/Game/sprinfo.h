@@ -2,11 +2,19 @@
 
 #include "info.h"
 
+struct texture_t;
+
 // Holds information for a sprite frame
 struct spriteframe_t {
     uint32_t    rotate;     // When '0' or 'false' 'lump[0]' should be used for all angles
     uint32_t    lump[8];    // The lump number to use for viewing angles 0-7
     uint8_t     flip[8];    // Whether to flip horizontally viewing angles 0-7, non zero if flip
+
+    // PsyDoom: the sprite texture for each of the lumps above, resolved up front so renderers don't need to look it up for each sprite drawn.
+    // Will be 'nullptr' if there is no sprite texture for the lump.
+    #if PSYDOOM_MODS
+        texture_t*  pTex[8];
+    #endif
 };
 
 // Holds information for a sequence of sprite frames
@@ -351,11 +351,6 @@ void R_Subsector(const int32_t subsecNum) noexcept {
         gppEndDrawSubsector++;
     #endif
 
-    // PsyDoom: update the heights that the sector will render at
-    #if PSYDOOM_MODS
-        R_UpdateSectorDrawHeights(*subsec.sector);
-    #endif
-
     // Do draw preparation on all of the segs in the subsector.
     // This figures out what areas of the screen they occlude, updates transformed vertex positions, and more...
     seg_t* pSeg = &gpSegs[subsec.firstseg];
@@ -609,9 +604,8 @@ void R_AddLine(seg_t& seg) noexcept {
         bool bSegFullyOccludes;
 
         if (pBackSec) {
-            // PsyDoom: update the sector draw heights before we compare and use those heights for comparison
+            // PsyDoom: use the sector draw heights for comparison (updated for all sectors at the start of the frame)
             #if PSYDOOM_MODS
-                R_UpdateSectorDrawHeights(*pBackSec);
                 const fixed_t frontFloorH = frontSec.floorDrawH;
                 const fixed_t frontCeilH = frontSec.ceilingDrawH;
                 const fixed_t backFloorH = pBackSec->floorDrawH;
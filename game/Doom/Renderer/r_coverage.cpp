@@ -0,0 +1,279 @@
+#include "r_coverage.h"
+
+#if PSYDOOM_MODS
+
+#include "Asserts.h"
+#include "Doom/doomdef.h"
+#include "PsyDoom/Config/Config.h"
+#include "r_data.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+// An opaque wall column or flat row recorded for the current subsector, to be added to the coverage once the subsector is done.
+// All coordinates are inclusive and clipped to the 3D view.
+struct covcol_t {
+    int16_t     x;
+    int16_t     ty;
+    int16_t     by;
+};
+
+struct covrow_t {
+    int16_t     y;
+    int16_t     lx;
+    int16_t     rx;
+};
+
+// The size of a coverage snapshot: the 'top' and 'bottom' bounds for each screen column
+static constexpr int32_t COV_SNAPSHOT_SIZE = SCREEN_W * 2;
+
+// What coverage culling is currently doing
+RCoverageMode gRCoverageMode = RCoverageMode::Off;
+
+// The coverage being recorded for each screen column: rows '[0, top)' and '[bottom, VIEW_3D_H)' are covered.
+// The first 'SCREEN_W' entries are the 'top' bounds and the next 'SCREEN_W' entries are the 'bottom' bounds.
+static uint8_t gCovRecordBounds[COV_SNAPSHOT_SIZE];
+
+// The coverage of everything in front of each draw subsector, and the snapshot being tested against (if culling)
+static std::vector<uint8_t>     gCovSnapshots;
+static const uint8_t*           gpCovTestBounds;
+
+// Opaque wall columns and flat rows recorded for the current subsector
+static std::vector<covcol_t>    gCovPendingCols;
+static std::vector<covrow_t>    gCovPendingRows;
+
+// Which palette indexes are opaque in the palette used by the 3D view this frame
+static uint64_t gCovPalOpaqueIdxMask[4];
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Add the given opaque wall column to the coverage being recorded, if it extends the top or bottom covered range of its screen column
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void R_CovAddWallCol(const covcol_t& col) noexcept {
+    uint8_t& top = gCovRecordBounds[col.x];
+    uint8_t& bot = gCovRecordBounds[SCREEN_W + col.x];
+
+    if (col.ty <= top) {
+        top = (uint8_t) std::max<int32_t>(top, col.by + 1);
+    }
+
+    if (col.by + 1 >= bot) {
+        bot = (uint8_t) std::min<int32_t>(bot, col.ty);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Begins coverage culling for the frame if enabled, returning 'true' if so.
+// If coverage culling is enabled the caller should then do the coverage 'record' pass for all the draw subsectors, front to back.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool R_CovBeginFrame(const int32_t numDrawSubsecs) noexcept {
+    gRCoverageMode = RCoverageMode::Off;
+
+    if ((!Config::gbClassicCoverageCulling) || (numDrawSubsecs <= 0))
+        return false;
+
+    // Figure out which palette indexes are opaque in the palette used for the 3D view.
+    // If the palette is not known for some reason then nothing is treated as opaque - so nothing gets culled.
+    std::memset(gCovPalOpaqueIdxMask, 0, sizeof(gCovPalOpaqueIdxMask));
+
+    for (uint32_t palIdx = 0; palIdx < MAXPALETTES; ++palIdx) {
+        if (gPaletteClutIds[palIdx] == g3dViewPaletteClutId) {
+            std::memcpy(gCovPalOpaqueIdxMask, gPaletteOpaqueIdxMasks[palIdx], sizeof(gCovPalOpaqueIdxMask));
+            break;
+        }
+    }
+
+    // Initially nothing is covered and there is no coverage for any subsector
+    std::memset(gCovRecordBounds, 0, SCREEN_W);
+    std::memset(gCovRecordBounds + SCREEN_W, VIEW_3D_H, SCREEN_W);
+
+    gCovSnapshots.resize((size_t) numDrawSubsecs * COV_SNAPSHOT_SIZE);
+    gpCovTestBounds = nullptr;
+    gCovPendingCols.clear();
+    gCovPendingRows.clear();
+
+    gRCoverageMode = RCoverageMode::Record;
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Ends the coverage 'record' pass and begins the normal back to front draw, where hidden primitives are skipped
+//------------------------------------------------------------------------------------------------------------------------------------------
+void R_CovBeginCullPass() noexcept {
+    ASSERT(gRCoverageMode == RCoverageMode::Record);
+    gRCoverageMode = RCoverageMode::Cull;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Ends coverage culling for the frame (if it was being done)
+//------------------------------------------------------------------------------------------------------------------------------------------
+void R_CovEndFrame() noexcept {
+    gRCoverageMode = RCoverageMode::Off;
+    gpCovTestBounds = nullptr;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Must be called before drawing (or recording) each draw subsector, with the index of the subsector in the draw subsectors list.
+// If recording, saves the coverage of everything in front of the subsector; if culling, makes that coverage the one to test against.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void R_CovBeginSubsector(const int32_t drawSubsecIdx) noexcept {
+    if (gRCoverageMode == RCoverageMode::Off)
+        return;
+
+    ASSERT((drawSubsecIdx >= 0) && ((size_t) drawSubsecIdx * COV_SNAPSHOT_SIZE < gCovSnapshots.size()));
+    uint8_t* const pSnapshot = gCovSnapshots.data() + (size_t) drawSubsecIdx * COV_SNAPSHOT_SIZE;
+
+    if (gRCoverageMode == RCoverageMode::Record) {
+        std::memcpy(pSnapshot, gCovRecordBounds, COV_SNAPSHOT_SIZE);
+    } else {
+        gpCovTestBounds = pSnapshot;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Must be called after recording each draw subsector: adds the opaque walls and flats of the subsector to the coverage being recorded.
+// Flat rows are added top to bottom and then bottom to top, so that the rows of a flat grow the top and bottom covered ranges one row at a
+// time. Walls are added both before and after the flat rows since they may either connect to the flat rows or to the edges of the screen.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void R_CovEndSubsector() noexcept {
+    if (gRCoverageMode != RCoverageMode::Record)
+        return;
+
+    for (const covcol_t& col : gCovPendingCols) {
+        R_CovAddWallCol(col);
+    }
+
+    for (const covrow_t& row : gCovPendingRows) {
+        for (int32_t x = row.lx; x <= row.rx; ++x) {
+            uint8_t& top = gCovRecordBounds[x];
+
+            if (row.y == top) {
+                top = (uint8_t)(row.y + 1);
+            }
+        }
+    }
+
+    for (auto iter = gCovPendingRows.rbegin(); iter != gCovPendingRows.rend(); ++iter) {
+        const covrow_t& row = *iter;
+
+        for (int32_t x = row.lx; x <= row.rx; ++x) {
+            uint8_t& bot = gCovRecordBounds[SCREEN_W + x];
+
+            if (row.y + 1 == bot) {
+                bot = (uint8_t) row.y;
+            }
+        }
+    }
+
+    for (const covcol_t& col : gCovPendingCols) {
+        R_CovAddWallCol(col);
+    }
+
+    gCovPendingCols.clear();
+    gCovPendingRows.clear();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tells if the given wall or flat texture can be a coverage occluder: i.e if it is currently in VRAM, and if it is guaranteed that it will
+// never produce a transparent pixel with the 3D view palette for this frame. The texture must be a power of two sized so that the texture
+// window used to draw it samples only texels which are within the texture.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool R_CovIsTexOpaque(const texture_t& tex) noexcept {
+    if ((!tex.bHasTexelPalIdxMask) || (tex.uploadFrameNum == TEX_INVALID_UPLOAD_FRAME_NUM))
+        return false;
+
+    const auto isValidTexWinSize = [](const int32_t size) noexcept {
+        return ((size >= 8) && (size <= 256) && ((size & (size - 1)) == 0));
+    };
+
+    if ((!isValidTexWinSize(tex.width)) || (!isValidTexWinSize(tex.height)))
+        return false;
+
+    for (int32_t i = 0; i < 4; ++i) {
+        if ((tex.texelPalIdxMask[i] & (~gCovPalOpaqueIdxMask[i])) != 0)
+            return false;
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// If recording then note the given wall column if it is an occluder, and return 'false' (don't draw).
+// If culling then return 'false' only if the wall column is completely covered by what is in front of the current subsector.
+// The rasterization rules here mirror the GPU's: the column spans rows '[min(y1, y2), max(y1, y2) - 1]', clipped to the draw area.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool R_CovRecordOrTestWallCol(const int32_t x, const int32_t y1, const int32_t y2, const bool bOccluder) noexcept {
+    const bool bRecord = (gRCoverageMode == RCoverageMode::Record);
+
+    // Figure out which rows will actually be drawn, if any.
+    // The column is always considered visible if it reaches outside of the 3D view, or draws nothing either way.
+    const int32_t minY = std::min(y1, y2);
+    const int32_t maxY = std::max(y1, y2);
+    const int32_t ty = std::max(minY, 0);
+    const int32_t by = std::min(maxY - 1, SCREEN_H - 1);
+
+    if ((maxY - minY >= 512) || (x < 0) || (x >= SCREEN_W) || (ty > by))
+        return (!bRecord);
+
+    if (bRecord) {
+        if (bOccluder && (ty < VIEW_3D_H)) {
+            gCovPendingCols.push_back({ (int16_t) x, (int16_t) ty, (int16_t) std::min(by, VIEW_3D_H - 1) });
+        }
+
+        return false;
+    }
+
+    if (by >= VIEW_3D_H)
+        return true;
+
+    // Visible unless all of the rows are within the covered range at the top or bottom of the screen
+    ASSERT(gpCovTestBounds);
+    const int32_t top = gpCovTestBounds[x];
+    const int32_t bot = gpCovTestBounds[SCREEN_W + x];
+    const bool bHidden = ((top >= bot) || (by < top) || (ty >= bot));
+    return (!bHidden);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// If recording then note the given flat row if it is an occluder, and return 'false' (don't draw).
+// If culling then return 'false' only if the flat row is completely covered by what is in front of the current subsector.
+// The rasterization rules here mirror the GPU's: the row spans columns '[min(x1, x2), max(x1, x2) - 1]', clipped to the draw area.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool R_CovRecordOrTestFloorRow(const int32_t x1, const int32_t x2, const int32_t y, const bool bOccluder) noexcept {
+    const bool bRecord = (gRCoverageMode == RCoverageMode::Record);
+
+    // Figure out which columns will actually be drawn, if any.
+    // The row is always considered visible if it is outside of the 3D view, or draws nothing either way.
+    const int32_t minX = std::min(x1, x2);
+    const int32_t maxX = std::max(x1, x2);
+    const int32_t lx = std::max(minX, 0);
+    const int32_t rx = std::min(maxX - 1, SCREEN_W - 1);
+
+    if ((maxX - minX >= 1024) || (y < 0) || (y >= SCREEN_H) || (lx > rx))
+        return (!bRecord);
+
+    if (bRecord) {
+        if (bOccluder && (y < VIEW_3D_H)) {
+            gCovPendingRows.push_back({ (int16_t) y, (int16_t) lx, (int16_t) rx });
+        }
+
+        return false;
+    }
+
+    if (y >= VIEW_3D_H)
+        return true;
+
+    // Visible if any of the pixels in the row are not covered
+    ASSERT(gpCovTestBounds);
+    const uint8_t* const pTop = gpCovTestBounds;
+    const uint8_t* const pBot = gpCovTestBounds + SCREEN_W;
+
+    for (int32_t x = lx; x <= rx; ++x) {
+        if ((pTop[x] < pBot[x]) && (y >= pTop[x]) && (y < pBot[x]))
+            return true;
+    }
+
+    return false;
+}
+
+#endif  // #if PSYDOOM_MODS
@@ -0,0 +1,57 @@
+#pragma once
+
+#if PSYDOOM_MODS
+
+#include <cstdint>
+
+struct texture_t;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom addition: optional coverage culling for the classic renderer.
+//
+// The classic renderer draws subsectors back to front, which means that a lot of wall columns and flat rows get completely drawn over by
+// what is in front of them. When coverage culling is enabled the subsectors are first visited front to back in a 'record' pass which draws
+// nothing, and only notes which parts of each screen column are covered by fully opaque walls and flats. A snapshot of this coverage is
+// saved on entry to each subsector. The normal back to front draw then follows and skips any wall column or flat row which is entirely
+// within the coverage for everything in front of its subsector. Since whole primitives are only ever skipped (never clipped) and only when
+// everything they draw gets overwritten, the final image is identical to what it would be without coverage culling.
+//
+// Coverage for each screen column is tracked as a covered range starting at the top of the screen and a covered range starting at the
+// bottom of the screen: occluders which do not extend one of these ranges are ignored, which is conservative but always correct.
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+// What coverage culling is currently doing
+enum class RCoverageMode : uint8_t {
+    Off,        // Not doing coverage culling: everything is drawn
+    Record,     // Recording the coverage of opaque walls and flats, front to back: nothing is drawn
+    Cull        // Drawing back to front and skipping primitives that will be completely drawn over
+};
+
+extern RCoverageMode gRCoverageMode;
+
+bool R_CovBeginFrame(const int32_t numDrawSubsecs) noexcept;
+void R_CovBeginCullPass() noexcept;
+void R_CovEndFrame() noexcept;
+void R_CovBeginSubsector(const int32_t drawSubsecIdx) noexcept;
+void R_CovEndSubsector() noexcept;
+bool R_CovIsTexOpaque(const texture_t& tex) noexcept;
+bool R_CovRecordOrTestWallCol(const int32_t x, const int32_t y1, const int32_t y2, const bool bOccluder) noexcept;
+bool R_CovRecordOrTestFloorRow(const int32_t x1, const int32_t x2, const int32_t y, const bool bOccluder) noexcept;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Checks whether a wall column primitive with the given coordinates should be drawn.
+// If recording coverage then the column is noted as an occluder (if specified) and is not drawn.
+//------------------------------------------------------------------------------------------------------------------------------------------
+inline bool R_CovCheckWallCol(const int32_t x, const int32_t y1, const int32_t y2, const bool bOccluder) noexcept {
+    return (gRCoverageMode == RCoverageMode::Off) ? true : R_CovRecordOrTestWallCol(x, y1, y2, bOccluder);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Checks whether a floor row primitive with the given coordinates should be drawn.
+// If recording coverage then the row is noted as an occluder (if specified) and is not drawn.
+//------------------------------------------------------------------------------------------------------------------------------------------
+inline bool R_CovCheckFloorRow(const int32_t x1, const int32_t x2, const int32_t y, const bool bOccluder) noexcept {
+    return (gRCoverageMode == RCoverageMode::Off) ? true : R_CovRecordOrTestFloorRow(x1, x2, y, bOccluder);
+}
+
+#endif  // #if PSYDOOM_MODS
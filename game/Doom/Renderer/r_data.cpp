@@ -31,6 +31,11 @@ light_t*    gpLightsLump;
 uint16_t    gPaletteClutIds[MAXPALETTES];       // CLUT ids for all of the game's palettes. These are all held in VRAM.
 uint16_t    g3dViewPaletteClutId;               // Currently active in-game palette. Changes as effects are applied in the game.
 
+#if PSYDOOM_MODS
+    // PsyDoom: for each palette, a bit mask of which color indexes are not fully transparent (color value is not '0')
+    uint64_t gPaletteOpaqueIdxMasks[MAXPALETTES][4];
+#endif
+
 // Lump counts
 int32_t     gNumTexLumps;
 int32_t     gNumFlatLumps;
@@ -94,6 +99,20 @@ uint16_t R_UploadPalette(const palette_t& palette, const uint32_t palIdx) noexce
     dstVramRect.w = 256;
     dstVramRect.h = 1;
 
+    // PsyDoom: remember which colors in the palette are not transparent
+    #if PSYDOOM_MODS
+    {
+        uint64_t* const pOpaqueIdxMask = gPaletteOpaqueIdxMasks[palIdx];
+        std::memset(pOpaqueIdxMask, 0, sizeof(gPaletteOpaqueIdxMasks[palIdx]));
+
+        for (uint32_t colorIdx = 0; colorIdx < 256; ++colorIdx) {
+            if (palette.colors[colorIdx] != 0) {
+                pOpaqueIdxMask[colorIdx / 64] |= uint64_t(1) << (colorIdx % 64);
+            }
+        }
+    }
+    #endif
+
     // Upload the palette to VRAM and return the CLUT id for this location
     LIBGPU_LoadImage(dstVramRect, (const uint16_t*) palette.colors);
     return LIBGPU_GetClut(dstVramRect.x, dstVramRect.y);
@@ -443,6 +462,13 @@ texture_t& R_GetTexForLump(const int32_t lumpIdx) noexcept {
     return *pTex;
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom helper: same as 'R_GetTexForLump' except 'nullptr' is returned if the lump index is not for a sprite, wall or flat texture
+//------------------------------------------------------------------------------------------------------------------------------------------
+texture_t* R_FindTexForLump(const int32_t lumpIdx) noexcept {
+    return ((lumpIdx >= 0) && (lumpIdx < gLumpToTexListSize)) ? gpLumpToTex[lumpIdx] : nullptr;
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // PsyDoom helper: given a flat number returns number of the flat that overrides it and which has the same lump name (if any).
 // If there are no overrides then the input flat number is simply returned.
@@ -621,4 +647,28 @@ void R_UpdateTexMetricsFromData(texture_t& tex, const void* const pTexData, cons
     tex.width16 = (uint8_t)((tex.width + 15) / 16);
     tex.height16 = (uint8_t)((tex.height + 15) / 16);
 }
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom addition: records which palette indexes are used by the texels of the given 8-bit texture.
+// Expects the texture metrics to be up-to-date and the texture data given to include the header, as with 'R_UpdateTexMetricsFromData'.
+// If there is not enough data for all of the texels then the mask is flagged as not being known.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void R_UpdateTexPalIdxMaskFromData(texture_t& tex, const void* const pTexData, const int32_t texDataSize) noexcept {
+    std::memset(tex.texelPalIdxMask, 0, sizeof(tex.texelPalIdxMask));
+    tex.bHasTexelPalIdxMask = false;
+
+    const int32_t numTexels = (int32_t) tex.width * (int32_t) tex.height;
+
+    if ((numTexels <= 0) || (texDataSize - (int32_t) sizeof(texlump_header_t) < numTexels))
+        return;
+
+    const uint8_t* const pTexels = (const uint8_t*) pTexData + sizeof(texlump_header_t);
+
+    for (int32_t i = 0; i < numTexels; ++i) {
+        const uint8_t colorIdx = pTexels[i];
+        tex.texelPalIdxMask[colorIdx / 64] |= uint64_t(1) << (colorIdx % 64);
+    }
+
+    tex.bHasTexelPalIdxMask = true;
+}
 #endif
@@ -86,6 +86,11 @@ struct texture_t {
     #if PSYDOOM_MODS
         uint32_t        uploadFrameNum;         // What frame the texture was added to the texture cache, used to detect texture cache overflows
         texture_t**     ppTexCacheEntries;      // Points to the top left cell in the texture cache where this texture is placed.
+
+        // PsyDoom: which palette indexes the texels of the texture use (8-bit textures only), if known.
+        // Used by the classic renderer's coverage culling to tell whether the texture can ever produce transparent pixels.
+        uint64_t        texelPalIdxMask[4];
+        bool            bHasTexelPalIdxMask;
     #else
         uint16_t        _pad1;                  // Unused
         texture_t**     ppTexCacheEntries;      // Points to the top left cell in the texture cache where this texture is placed.
@@ -130,6 +135,10 @@ extern int32_t*     gpFlatTranslation;
 extern light_t*     gpLightsLump;
 extern uint16_t     gPaletteClutIds[MAXPALETTES];
 extern uint16_t     g3dViewPaletteClutId;
+
+#if PSYDOOM_MODS
+    extern uint64_t gPaletteOpaqueIdxMasks[MAXPALETTES][4];
+#endif
 extern int32_t      gNumTexLumps;
 extern int32_t      gNumFlatLumps;
 extern int32_t      gNumSpriteLumps;
@@ -151,6 +160,7 @@ uint16_t R_UploadPalette(const palette_t& palette, const uint32_t palIdx) noexce
     int32_t R_TextureNumForName(const char* const name, const bool bMustExist = false) noexcept;
     int32_t R_FlatNumForName(const char* const name, const bool bMustExist = false) noexcept;
     texture_t& R_GetTexForLump(const int32_t lumpIdx) noexcept;
+    texture_t* R_FindTexForLump(const int32_t lumpIdx) noexcept;
     int32_t R_GetOverrideFlatNum(const int32_t origFlatNum) noexcept;
     int32_t R_GetOverrideTexNum(const int32_t origTexNum) noexcept;
     uint16_t R_GetPaletteClutId(const uint32_t paletteNum) noexcept;
@@ -164,4 +174,5 @@ SRECT getTextureVramRect(const texture_t& tex) noexcept;
 
 #if PSYDOOM_MODS
     void R_UpdateTexMetricsFromData(texture_t& tex, const void* const pTexData, const int32_t texDataSize) noexcept;
+    void R_UpdateTexPalIdxMaskFromData(texture_t& tex, const void* const pTexData, const int32_t texDataSize) noexcept;
 #endif
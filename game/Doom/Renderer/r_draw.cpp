@@ -6,6 +6,7 @@
 #include "PsyDoom/Config/Config.h"
 #include "PsyQ/LIBETC.h"
 #include "PsyQ/LIBGTE.h"
+#include "r_coverage.h"
 #include "r_local.h"
 #include "r_main.h"
 #include "r_plane.h"
@@ -15,6 +16,15 @@
 
 #include <vector>
 
+// PsyDoom: use SSE2 to classify leaf points against the view frustrum planes, 4 points at a time, where available.
+// SSE2 is always available on 64-bit x86 and is enabled by most 32-bit x86 builds.
+#if PSYDOOM_MODS && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2)))
+    #define R_DRAW_USE_SSE2 1
+    #include <emmintrin.h>
+#else
+    #define R_DRAW_USE_SSE2 0
+#endif
+
 // The maximum number of new vertices that can be added to leafs by clipping operations.
 // If we happen to emit more than this then engine will fail with an error.
 // PsyDoom: this static limit no longer applies in the limit removing engine.
@@ -86,6 +96,10 @@ void R_DrawSubsector(subsector_t& subsec) noexcept {
     // Cache the entire leaf for the subsector to the scratchpad.
     // Also transform any leaf vertices that were not yet transformed up until this point.
     // PsyDoom: we no longer use the scratchpad anymore, but the logic remains mostly the same.
+    #if PSYDOOM_MODS
+        bool bNeedsFrontZClip = false;
+    #endif
+
     {
         const leafedge_t* pSrcEdge = gpLeafEdges + subsec.firstLeafEdge;
 
@@ -127,6 +141,11 @@ void R_DrawSubsector(subsector_t& subsec) noexcept {
                 vert.frameUpdated = gNumFramesDrawn;
             }
 
+            // PsyDoom: check if the leaf needs front plane clipping while caching it, rather than in a separate pass afterwards
+            #if PSYDOOM_MODS
+                bNeedsFrontZClip |= (vert.viewy <= NEAR_CLIP_DIST + 1);
+            #endif
+
             #if !PSYDOOM_LIMIT_REMOVING
                 ++pDstEdge;
             #endif
@@ -154,29 +173,29 @@ void R_DrawSubsector(subsector_t& subsec) noexcept {
 
     gNumNewClipVerts = 0;
 
-    // Clip the leaf against the front plane if required
-    {
-        #if PSYDOOM_LIMIT_REMOVING
-            leafedge_t* pEdge = leaf1.edges.data();
-        #else
-            leafedge_t* pEdge = leaf1.edges;
-        #endif
-
-        for (int32_t edgeIdx = 0; edgeIdx < subsec.numLeafEdges; ++edgeIdx, ++pEdge) {
-            if (pEdge->vertex->viewy <= NEAR_CLIP_DIST + 1) {
-                R_FrontZClip(pLeafs[curLeafIdx], pLeafs[curLeafIdx ^ 1]);
-                curLeafIdx ^= 1;
-
-                // PsyDoom: abort here in limit removing builds if we've clipped away the subsector to less than a triangle.
-                // This avoids invalid access of 'drawleaf.edges[0]' below when the edge list is empty.
-                #if PSYDOOM_LIMIT_REMOVING
-                    if (pLeafs[curLeafIdx].edges.size() < 3)
-                        return;
-                #endif
+    // Clip the leaf against the front plane if required.
+    // PsyDoom: whether this is needed was already determined when caching the leaf.
+    #if !PSYDOOM_MODS
+        bool bNeedsFrontZClip = false;
 
+        for (int32_t edgeIdx = 0; edgeIdx < subsec.numLeafEdges; ++edgeIdx) {
+            if (leaf1.edges[edgeIdx].vertex->viewy <= NEAR_CLIP_DIST + 1) {
+                bNeedsFrontZClip = true;
                 break;
             }
         }
+    #endif
+
+    if (bNeedsFrontZClip) {
+        R_FrontZClip(pLeafs[curLeafIdx], pLeafs[curLeafIdx ^ 1]);
+        curLeafIdx ^= 1;
+
+        // PsyDoom: abort here in limit removing builds if we've clipped away the subsector to less than a triangle.
+        // This avoids invalid access of 'drawleaf.edges[0]' below when the edge list is empty.
+        #if PSYDOOM_LIMIT_REMOVING
+            if (pLeafs[curLeafIdx].edges.size() < 3)
+                return;
+        #endif
     }
 
     // Check to see what side of the left view frustrum plane the leaf's points are on.
@@ -226,8 +245,9 @@ void R_DrawSubsector(subsector_t& subsec) noexcept {
 
     // PsyDoom limit removing Classic renderer extension.
     // Draw sky walls for leaf edges with associated segs where appropriate if the 'sky leak fix' is enabled.
+    // Sky walls are never coverage occluders, so skip them when just recording coverage.
     #if PSYDOOM_LIMIT_REMOVING
-        if (Config::gbSkyLeakFix) {
+        if (Config::gbSkyLeakFix && (gRCoverageMode != RCoverageMode::Record)) {
             leafedge_t* pEdge = drawleaf.edges.data();
             const int32_t numEdges = (int32_t) drawleaf.edges.size() - 1;   // N.B: last edge is a dummy one for fast wraparound!
 
@@ -284,8 +304,15 @@ void R_DrawSubsector(subsector_t& subsec) noexcept {
         R_DrawSubsectorFlat(drawleaf, true);
     }
 
-    // Draw all sprites in the subsector
-    R_DrawSubsectorSprites(subsec);
+    // Draw all sprites in the subsector.
+    // PsyDoom: sprites are never coverage occluders, so skip them when just recording coverage.
+    #if PSYDOOM_MODS
+        if (gRCoverageMode != RCoverageMode::Record) {
+            R_DrawSubsectorSprites(subsec);
+        }
+    #else
+        R_DrawSubsectorSprites(subsec);
+    #endif
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -457,6 +484,80 @@ void R_FrontZClip(const leaf_t& inLeaf, leaf_t& outLeaf) noexcept {
     #endif
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Helper for 'R_CheckLeafSide': stores whether each of the given leaf edge points are on the outside of the left or right view frustrum plane.
+// Returns the number of points that are on the outside. This version processes one point at a time.
+//------------------------------------------------------------------------------------------------------------------------------------------
+template <bool bRightViewPlane, class PointFlagT>
+static int32_t R_ClassifyLeafPoints_Scalar(const leafedge_t* const pEdges, const int32_t numEdges, PointFlagT* const pbPointsOnOutside) noexcept {
+    int32_t numPointsOutside = 0;
+
+    for (int32_t edgeIdx = 0; edgeIdx < numEdges; ++edgeIdx) {
+        const vertex_t& vert = *pEdges[edgeIdx].vertex;
+        const bool bOutside = (bRightViewPlane) ? (vert.viewx > vert.viewy) : (-vert.viewx > vert.viewy);
+        pbPointsOnOutside[edgeIdx] = (PointFlagT) bOutside;
+        numPointsOutside += (bOutside) ? 1 : 0;
+    }
+
+    return numPointsOutside;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Helper for 'R_CheckLeafSide': same as 'R_ClassifyLeafPoints_Scalar' but uses SIMD to classify 4 points at a time, where available.
+// The results are exactly the same as the scalar version.
+//------------------------------------------------------------------------------------------------------------------------------------------
+template <bool bRightViewPlane, class PointFlagT>
+static int32_t R_ClassifyLeafPoints(const leafedge_t* const pEdges, const int32_t numEdges, PointFlagT* const pbPointsOnOutside) noexcept {
+    int32_t edgeIdx = 0;
+    int32_t numPointsOutside = 0;
+
+    #if R_DRAW_USE_SSE2
+        // How many bits are set in each 4-bit plane side mask
+        constexpr int32_t MASK_BIT_COUNTS[16] = { 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 };
+
+        for (; edgeIdx + 4 <= numEdges; edgeIdx += 4) {
+            // Gather the view x/y values for the next 4 points
+            const vertex_t& vert1 = *pEdges[edgeIdx + 0].vertex;
+            const vertex_t& vert2 = *pEdges[edgeIdx + 1].vertex;
+            const vertex_t& vert3 = *pEdges[edgeIdx + 2].vertex;
+            const vertex_t& vert4 = *pEdges[edgeIdx + 3].vertex;
+
+            const __m128i viewX = _mm_setr_epi32(vert1.viewx, vert2.viewx, vert3.viewx, vert4.viewx);
+            const __m128i viewY = _mm_setr_epi32(vert1.viewy, vert2.viewy, vert3.viewy, vert4.viewy);
+
+            // Compare all 4 points against the plane and get a bit mask of the points on the outside
+            const __m128i testX = (bRightViewPlane) ? viewX : _mm_sub_epi32(_mm_setzero_si128(), viewX);
+            const int32_t outsideMask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(testX, viewY)));
+
+            pbPointsOnOutside[edgeIdx + 0] = (PointFlagT)((outsideMask & 0x1) != 0);
+            pbPointsOnOutside[edgeIdx + 1] = (PointFlagT)((outsideMask & 0x2) != 0);
+            pbPointsOnOutside[edgeIdx + 2] = (PointFlagT)((outsideMask & 0x4) != 0);
+            pbPointsOnOutside[edgeIdx + 3] = (PointFlagT)((outsideMask & 0x8) != 0);
+            numPointsOutside += MASK_BIT_COUNTS[outsideMask];
+        }
+    #endif
+
+    // Do any remaining points one at a time
+    numPointsOutside += R_ClassifyLeafPoints_Scalar<bRightViewPlane>(pEdges + edgeIdx, numEdges - edgeIdx, pbPointsOnOutside + edgeIdx);
+
+    // Debug: verify the SIMD results match the scalar version exactly
+    #if ASSERTS_ENABLED && R_DRAW_USE_SSE2
+    {
+        int32_t numPointsOutsideCheck = 0;
+
+        for (int32_t i = 0; i < numEdges; ++i) {
+            PointFlagT bOutsideCheck = {};
+            numPointsOutsideCheck += R_ClassifyLeafPoints_Scalar<bRightViewPlane>(pEdges + i, 1, &bOutsideCheck);
+            ASSERT(pbPointsOnOutside[i] == bOutsideCheck);
+        }
+
+        ASSERT(numPointsOutside == numPointsOutsideCheck);
+    }
+    #endif
+
+    return numPointsOutside;
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Check to see what side of left or right view frustrum plane all points in the leaf are on.
 // Also stores what side each point is on at the start of scratchpad memory as a bool32_t.
@@ -488,57 +589,29 @@ int32_t R_CheckLeafSide(const bool bRightViewPlane, const leaf_t& leaf) noexcept
             }
 
             uint8_t* const pbPointsOnOutside = gbPointsOnOutside.data();
-            uint8_t* pbPointOnOutside = gbPointsOnOutside.data();
         #else
             bool* const pbPointsOnOutside = gbPointsOnOutside;
-            bool* pbPointOnOutside = gbPointsOnOutside;
         #endif
     #else
         bool32_t* const pbPointsOnOutside = (bool32_t*) LIBETC_getScratchAddr(0);
-        bool32_t* pbPointOnOutside = pbPointsOnOutside;
     #endif
 
-    // Track how many points are on the inside or outside of the plane here.
-    // For each point on the inside, increment - otherwise decrement.
-    int32_t insideOutsideCount = 0;
-
-    // See which plane we are checking against, left or right view frustrum plane
-    if (!bRightViewPlane) {
-        for (int32_t edgeIdx = 0; edgeIdx < numLeafEdges; ++edgeIdx, ++pLeafEdge, ++pbPointOnOutside) {
-            vertex_t& vert = *pLeafEdge->vertex;
-
-            if (-vert.viewx > vert.viewy) {
-                *pbPointOnOutside = true;
-                --insideOutsideCount;
-            } else {
-                *pbPointOnOutside = false;
-                ++insideOutsideCount;
-            }
-        }
-    } else {
-        for (int32_t edgeIdx = 0; edgeIdx < numLeafEdges; ++edgeIdx, ++pLeafEdge, ++pbPointOnOutside) {
-            vertex_t& vert = *pLeafEdge->vertex;
-
-            if (vert.viewx > vert.viewy) {
-                *pbPointOnOutside = true;
-                --insideOutsideCount;
-            } else {
-                *pbPointOnOutside = false;
-                ++insideOutsideCount;
-            }
-        }
-    }
+    // See which plane we are checking against, left or right view frustrum plane, and count how many points are on the outside of it.
+    // PsyDoom: this is now done using SIMD where possible, see 'R_ClassifyLeafPoints'.
+    const int32_t numPointsOutside = (bRightViewPlane) ?
+        R_ClassifyLeafPoints<true>(pLeafEdge, numLeafEdges, pbPointsOnOutside) :
+        R_ClassifyLeafPoints<false>(pLeafEdge, numLeafEdges, pbPointsOnOutside);
 
     // Terminate the list of whether each leaf point is on the front side of the plane or not by duplicating
     // the first entry in the list at the end. This allows the renderer to wraparound automatically to the
     // beginning of the list when accessing 1 past the end. This saves on checks when working with edges!
-    *pbPointOnOutside = pbPointsOnOutside[0];
+    pbPointsOnOutside[numLeafEdges] = pbPointsOnOutside[0];
 
     // Return what the renderer should do with the leaf
-    if (insideOutsideCount == numLeafEdges) {
+    if (numPointsOutside == 0) {
         // All points are on the inside, no clipping required
         return 0;
-    } else if (insideOutsideCount == -numLeafEdges) {
+    } else if (numPointsOutside == numLeafEdges) {
         // All points are on the outside, leaf should be completely discarded
         return -1;
     } else {
@@ -58,6 +58,7 @@ struct sector_t {
 #if PSYDOOM_MODS
     fixed_t         floorDrawH;         // PsyDoom: height to render the floor at taking into account interpolation and ghost/invisible platform effects.
     fixed_t         ceilingDrawH;       // PsyDoom: height to render the ceiling at taking into account interpolation.
+    uint32_t        drawHVersion;       // PsyDoom: incremented whenever 'floorDrawH' or 'ceilingDrawH' change, so render data derived from them can be cached
 #endif
     degenmobj_t     soundorg;           // A partial 'mobj_t' which defines where sounds come from in the sector, for sectors that make noises
     int32_t         validcount;         // A marker used to avoid re-doing certain checks
@@ -75,6 +76,9 @@ struct sector_t {
     InterpFixedT    floorTexOffsetX;    // PsyDoom: floor texture x offset (can be used to scroll flats)
 #endif
     mobj_t*         thinglist;          // The list of things in the sector; each thing stores next/previous sector thing links
+#if PSYDOOM_MODS
+    touchnode_t*    touchthings;        // PsyDoom: list of things touching the sector (overlapping it with their bounding box)
+#endif
     void*           specialdata;        // Stores a pointer to a thinker which is operating on the sector (if any)
     int32_t         linecount;          // How many lines in the sector
 #if PSYDOOM_MODS
@@ -130,10 +134,17 @@ struct line_t {
 // Describes a convex region within a sector
 struct subsector_t {
     sector_t*   sector;             // Parent sector for the subsector
+#if PSYDOOM_LIMIT_REMOVING
+    int16_t     numsegs;            // How many line segments in this subsector
+    int16_t     numLeafEdges;       // How many leaf edges there are for the subsector
+    int32_t     firstseg;           // Index of the first line segment for the subsector, in the global list of line segments. PsyDoom: widened for big maps.
+    int32_t     firstLeafEdge;      // Index of the first leaf edge for the subsector, in the global list of leaf edges. PsyDoom: widened for big maps.
+#else
     int16_t     numsegs;            // How many line segments in this subsector
     int16_t     firstseg;           // Index of the first line segment for the subsector, in the global list of line segments
     int16_t     numLeafEdges;       // How many leaf edges there are for the subsector
     int16_t     firstLeafEdge;      // Index of the first leaf edge for the subsector, in the global list of leaf edges
+#endif
 #if PSYDOOM_MODS
     int32_t     vkDrawSubsecIdx;    // PsyDoom: repurpose unused fields to hold the draw subsector index for the new Vulkan renderer. Will be '-1' if not drawn.
     bool        bVkCanBatchFlats;   // PsyDoom: a flag set to 'true' if the subsector's flats can be batched/merged with other flats by the Vulkan renderer.
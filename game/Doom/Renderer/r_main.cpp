@@ -10,11 +10,13 @@
 #include "Doom/Game/p_spec.h"
 #include "Doom/Game/p_user.h"
 #include "PsyDoom/Config/Config.h"
+#include "PsyDoom/FrameProfiler.h"
 #include "PsyDoom/Game.h"
 #include "PsyDoom/PlayerPrefs.h"
 #include "PsyQ/LIBGPU.h"
 #include "PsyQ/LIBGTE.h"
 #include "r_bsp.h"
+#include "r_coverage.h"
 #include "r_data.h"
 #include "r_draw.h"
 #include "r_local.h"
@@ -28,6 +30,20 @@
 // Incremented whenever checks are made
 int32_t gValidCount = 1;
 
+#if PSYDOOM_MODS
+    // PsyDoom: a grid over the level which gives the BSP node to start searching from for points in each grid cell.
+    // All points within a grid cell take the same path through the BSP tree until the start node is reached, so starting the search for a
+    // point's subsector there gives exactly the same result as starting at the root. The start node might also be a subsector itself.
+    static constexpr int32_t SUBSEC_GRID_CELL_SHIFT = 23;           // Size of a grid cell in fixed point units (128 map units)
+    static constexpr int32_t SUBSEC_GRID_MAX_CELLS = 1024 * 1024;   // Don't build the grid if the level is so big that it needs more cells than this
+
+    static fixed_t                  gSubsecGridOriginX;
+    static fixed_t                  gSubsecGridOriginY;
+    static int32_t                  gSubsecGridWidth;
+    static int32_t                  gSubsecGridHeight;
+    static std::vector<int32_t>     gSubsecGridStartNodes;
+#endif
+
 // View properties
 player_t*   gpViewPlayer;
 fixed_t     gViewX;
@@ -131,6 +147,8 @@ void R_Init() noexcept {
 // Render the 3D view and also player weapons
 //------------------------------------------------------------------------------------------------------------------------------------------
 void R_RenderPlayerView() noexcept {
+    PROFILE_SCOPE(RenderPlayerView);
+
     // If currently in fullbright mode (no lighting) then setup the light params now.
     // PsyDoom: we don't compute these globals anymore now that dual colored lighting can be used.
     #if !PSYDOOM_MODS
@@ -268,9 +286,11 @@ void R_RenderPlayerView() noexcept {
     LIBGTE_SetRotMatrix(gDrawMatrix);
 
 
-    // PsyDoom: increment the marker used to determine when to update the 'draw height' for each sector
+    // PsyDoom: increment the marker used to determine when to update the 'draw height' for each sector.
+    // Then compute the interpolated draw heights for all sectors in one pass, so BSP traversal can just read them.
     #if PSYDOOM_MODS
         gValidCount++;
+        R_UpdateAllSectorDrawHeights();
     #endif
 
     // Traverse the BSP tree to determine what needs to be drawn and in what order
@@ -297,6 +317,36 @@ void R_RenderPlayerView() noexcept {
         gValidCount++;
     #endif
 
+    // PsyDoom: if coverage culling is enabled then first visit all the subsectors front to back, drawing nothing.
+    // This records what parts of the screen are covered by opaque walls and flats in front of each subsector, so that primitives which will
+    // be completely drawn over can be skipped when the subsectors are drawn back to front below.
+    #if PSYDOOM_MODS
+    {
+        #if PSYDOOM_LIMIT_REMOVING
+            subsector_t* const* const ppDrawSubsectors = gpDrawSubsectors.data();
+            const int32_t numDrawSubsecs = (int32_t) gpDrawSubsectors.size();
+        #else
+            subsector_t* const* const ppDrawSubsectors = gpDrawSubsectors;
+            const int32_t numDrawSubsecs = gNumDrawSubsectors;
+        #endif
+
+        if (R_CovBeginFrame(numDrawSubsecs)) {
+            for (int32_t drawSubsecIdx = 0; drawSubsecIdx < numDrawSubsecs; ++drawSubsecIdx) {
+                subsector_t& subsec = *ppDrawSubsectors[drawSubsecIdx];
+                sector_t& sec = *subsec.sector;
+                gpCurDrawSector = &sec;
+                R_UpdateShadingParams(sec);
+
+                R_CovBeginSubsector(drawSubsecIdx);
+                R_DrawSubsector(subsec);
+                R_CovEndSubsector();
+            }
+
+            R_CovBeginCullPass();
+        }
+    }
+    #endif
+
     // Draw all subsectors emitted during BSP traversal.
     // Draw them in back to front order.
     #if PSYDOOM_LIMIT_REMOVING
@@ -319,9 +369,15 @@ void R_RenderPlayerView() noexcept {
         sector_t& sec = *subsec.sector;
         gpCurDrawSector = &sec;
 
-        // PsyDoom: make sure the shading params for the sector are up to date
+        // PsyDoom: make sure the shading params for the sector are up to date, and use the right coverage for culling (if enabled)
         #if PSYDOOM_MODS
             R_UpdateShadingParams(sec);
+
+            #if PSYDOOM_LIMIT_REMOVING
+                R_CovBeginSubsector((int32_t)(gppEndDrawSubsector - gpDrawSubsectors.data()));
+            #else
+                R_CovBeginSubsector((int32_t)(gppEndDrawSubsector - gpDrawSubsectors));
+            #endif
         #endif
 
         // Setup the lighting values to use for the sector.
@@ -352,6 +408,10 @@ void R_RenderPlayerView() noexcept {
         R_DrawSubsector(subsec);
     }
 
+    #if PSYDOOM_MODS
+        R_CovEndFrame();
+    #endif
+
     // Draw any player sprites/weapons.
     // PsyDoom: skip if we're using the external camera.
     #if PSYDOOM_MODS
@@ -489,6 +549,16 @@ subsector_t* R_PointInSubsector(const fixed_t x, const fixed_t y) noexcept {
     // Once we reach a subsector stop and return it.
     int32_t nodeNum = gNumBspNodes - 1;
 
+    // PsyDoom: skip past the part of the BSP tree that is the same for all points in the grid cell containing the point, if it's in the grid
+    #if PSYDOOM_MODS
+        const int64_t gridX = ((int64_t) x - gSubsecGridOriginX) >> SUBSEC_GRID_CELL_SHIFT;     // Note: 64-bit to avoid overflow for big levels
+        const int64_t gridY = ((int64_t) y - gSubsecGridOriginY) >> SUBSEC_GRID_CELL_SHIFT;
+
+        if ((gridX >= 0) && (gridY >= 0) && (gridX < gSubsecGridWidth) && (gridY < gSubsecGridHeight)) {
+            nodeNum = gSubsecGridStartNodes[gridX + gridY * gSubsecGridWidth];
+        }
+    #endif
+
     while ((nodeNum & NF_SUBSECTOR) == 0) {
         node_t& node = gpBspNodes[nodeNum];
         const int32_t side = R_PointOnSide(x, y, node);
@@ -500,6 +570,123 @@ subsector_t* R_PointInSubsector(const fixed_t x, const fixed_t y) noexcept {
 }
 
 #if PSYDOOM_MODS
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: tells which side of the given node all points in the given box (inclusive) are on, as per 'R_PointOnSide'.
+// Returns '0' or '1' if all points are on the same side, or '-1' if the box is split by the node or the answer is unclear.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static int32_t R_BoxOnNodeSide(const fixed_t lx, const fixed_t rx, const fixed_t by, const fixed_t ty, const node_t& node) noexcept {
+    const divline_t& line = node.line;
+
+    // Vertical and horizontal lines: the side test is monotonic in 'x' or 'y', so just test the extremes
+    if (line.dx == 0) {
+        const int32_t side = R_PointOnSide(lx, by, node);
+        return (R_PointOnSide(rx, by, node) == side) ? side : -1;
+    }
+
+    if (line.dy == 0) {
+        const int32_t side = R_PointOnSide(lx, by, node);
+        return (R_PointOnSide(lx, ty, node) == side) ? side : -1;
+    }
+
+    // Otherwise the side is decided by comparing two products of the integer parts of the point offsets and line deltas.
+    // Both products are monotonic in the point offsets, therefore if there is no numeric overflow for any corner of the box then there is
+    // no overflow anywhere in it and the cross product is a linear function over the box. Then if all corners are on the same side, the
+    // whole box is too. Do the calculations in 64-bit to detect overflow in the 32-bit calculations done by 'R_PointOnSide'.
+    const fixed_t cornersX[2] = { lx, rx };
+    const fixed_t cornersY[2] = { by, ty };
+    const int64_t lineDx = d_fixed_to_int(line.dx);
+    const int64_t lineDy = d_fixed_to_int(line.dy);
+    int32_t side = -1;
+
+    for (const fixed_t cornerX : cornersX) {
+        for (const fixed_t cornerY : cornersY) {
+            const int64_t dx = (int64_t) cornerX - (int64_t) line.x;
+            const int64_t dy = (int64_t) cornerY - (int64_t) line.y;
+
+            if ((dx < INT32_MIN) || (dx > INT32_MAX) || (dy < INT32_MIN) || (dy > INT32_MAX))
+                return -1;
+
+            const int64_t lprod = d_fixed_to_int((fixed_t) dx) * lineDy;
+            const int64_t rprod = d_fixed_to_int((fixed_t) dy) * lineDx;
+
+            if ((lprod < INT32_MIN) || (lprod > INT32_MAX) || (rprod < INT32_MIN) || (rprod > INT32_MAX))
+                return -1;
+
+            const int32_t cornerSide = (rprod >= lprod);
+
+            if (side < 0) {
+                side = cornerSide;
+            } else if (side != cornerSide) {
+                return -1;
+            }
+        }
+    }
+
+    return side;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: builds the grid used to speed up 'R_PointInSubsector' by skipping the top part of the BSP tree.
+// Must be called whenever the BSP nodes for the level are loaded.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void R_InitSubsectorLookup() noexcept {
+    gSubsecGridOriginX = 0;
+    gSubsecGridOriginY = 0;
+    gSubsecGridWidth = 0;
+    gSubsecGridHeight = 0;
+    gSubsecGridStartNodes.clear();
+
+    if (gNumBspNodes <= 0)
+        return;
+
+    // Figure out the bounds of the level from the bounding boxes of the root node's children
+    const node_t& rootNode = gpBspNodes[gNumBspNodes - 1];
+    const int64_t lx = std::min(rootNode.bbox[0][BOXLEFT], rootNode.bbox[1][BOXLEFT]);
+    const int64_t rx = std::max(rootNode.bbox[0][BOXRIGHT], rootNode.bbox[1][BOXRIGHT]);
+    const int64_t by = std::min(rootNode.bbox[0][BOXBOTTOM], rootNode.bbox[1][BOXBOTTOM]);
+    const int64_t ty = std::max(rootNode.bbox[0][BOXTOP], rootNode.bbox[1][BOXTOP]);
+
+    if ((rx < lx) || (ty < by))
+        return;
+
+    const int64_t gridW = ((rx - lx) >> SUBSEC_GRID_CELL_SHIFT) + 1;
+    const int64_t gridH = ((ty - by) >> SUBSEC_GRID_CELL_SHIFT) + 1;
+
+    if (gridW * gridH > SUBSEC_GRID_MAX_CELLS)
+        return;
+
+    // Find the start node for each grid cell by going down the BSP tree for as long as the whole cell is on one side of each node
+    gSubsecGridStartNodes.reserve((size_t)(gridW * gridH));
+
+    for (int64_t gridY = 0; gridY < gridH; ++gridY) {
+        for (int64_t gridX = 0; gridX < gridW; ++gridX) {
+            const fixed_t cellLx = (fixed_t)(lx + (gridX << SUBSEC_GRID_CELL_SHIFT));
+            const fixed_t cellBy = (fixed_t)(by + (gridY << SUBSEC_GRID_CELL_SHIFT));
+            const fixed_t cellRx = (fixed_t) std::min<int64_t>(lx + ((gridX + 1) << SUBSEC_GRID_CELL_SHIFT) - 1, INT32_MAX);
+            const fixed_t cellTy = (fixed_t) std::min<int64_t>(by + ((gridY + 1) << SUBSEC_GRID_CELL_SHIFT) - 1, INT32_MAX);
+
+            int32_t nodeNum = gNumBspNodes - 1;
+
+            while ((nodeNum & NF_SUBSECTOR) == 0) {
+                const node_t& node = gpBspNodes[nodeNum];
+                const int32_t side = R_BoxOnNodeSide(cellLx, cellRx, cellBy, cellTy, node);
+
+                if (side < 0)
+                    break;
+
+                nodeNum = node.children[side];
+            }
+
+            gSubsecGridStartNodes.push_back(nodeNum);
+        }
+    }
+
+    gSubsecGridOriginX = (fixed_t) lx;
+    gSubsecGridOriginY = (fixed_t) by;
+    gSubsecGridWidth = (int32_t) gridW;
+    gSubsecGridHeight = (int32_t) gridH;
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // PsyDoom addition: update the 'previous' player values used in interpolation to their current (actual) values.
 // Can be used in situations like teleporting.
@@ -696,26 +883,70 @@ bool R_HasLowerSurroundingSkyFloor(const sector_t& sector) noexcept {
     return false;
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: sets the floor and ceiling draw heights for a sector, bumping the sector's draw height version if they changed
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void R_SetSectorDrawHeights(sector_t& sector, const fixed_t floorDrawH, const fixed_t ceilingDrawH) noexcept {
+    if ((sector.floorDrawH != floorDrawH) || (sector.ceilingDrawH != ceilingDrawH)) {
+        sector.floorDrawH = floorDrawH;
+        sector.ceilingDrawH = ceilingDrawH;
+        sector.drawHVersion++;
+    }
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // PsyDoom: updates the heights that the sector's floor and ceilings are to be rendered at, if required.
 // These heights will take into account interpolation and also 'ghost platform' effects.
 //------------------------------------------------------------------------------------------------------------------------------------------
 void R_UpdateSectorDrawHeights(sector_t& sector) noexcept {
     const bool bIsInvisiblePlatform = (sector.flags & SF_GHOSTPLAT);
+    fixed_t floorDrawH = sector.floorDrawH;
 
     if (!bIsInvisiblePlatform) {
-        sector.floorDrawH = sector.floorheight.renderValue();
+        floorDrawH = sector.floorheight.renderValue();
     } else {
         // Finding the lowest floor surrounding a sector might be slightly expensive if done often, so skip it if we can:
         const int32_t validCount = gValidCount;
 
         if (sector.validcount != validCount) {
-            sector.floorDrawH = R_FindLowestSurroundingInterpFloorHeight(sector);
+            floorDrawH = R_FindLowestSurroundingInterpFloorHeight(sector);
             sector.validcount = validCount;
         }
     }
 
-    sector.ceilingDrawH = sector.ceilingheight.renderValue();
+    R_SetSectorDrawHeights(sector, floorDrawH, sector.ceilingheight.renderValue());
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: updates the floor and ceiling draw heights for all sectors in the level, once per frame and in one linear pass.
+// Doing this up front means the renderer does not need to interpolate sector heights every time it visits a sector or a seg neighboring
+// it during BSP traversal, which adds up at high uncapped framerates. Ghost platforms are resolved in a 2nd pass, since they depend on
+// the (interpolated) floor heights of their neighbors.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void R_UpdateAllSectorDrawHeights() noexcept {
+    sector_t* const pSectors = gpSectors;
+    const int32_t numSectors = gNumSectors;
+    bool bHaveGhostPlatforms = false;
+
+    for (int32_t secIdx = 0; secIdx < numSectors; ++secIdx) {
+        sector_t& sector = pSectors[secIdx];
+
+        if (sector.flags & SF_GHOSTPLAT) {
+            bHaveGhostPlatforms = true;
+        } else {
+            R_SetSectorDrawHeights(sector, sector.floorheight.renderValue(), sector.ceilingheight.renderValue());
+        }
+    }
+
+    if (bHaveGhostPlatforms) {
+        for (int32_t secIdx = 0; secIdx < numSectors; ++secIdx) {
+            sector_t& sector = pSectors[secIdx];
+
+            if (sector.flags & SF_GHOSTPLAT) {
+                R_SetSectorDrawHeights(sector, R_FindLowestSurroundingInterpFloorHeight(sector), sector.ceilingheight.renderValue());
+            }
+        }
+    }
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -78,6 +78,7 @@ int32_t R_PointOnSide(const fixed_t x, const fixed_t y, const node_t& node) noex
 subsector_t* R_PointInSubsector(const fixed_t x, const fixed_t y) noexcept;
 
 #if PSYDOOM_MODS
+    void R_InitSubsectorLookup() noexcept;
     void R_SnapPlayerInterpolation() noexcept;
     void R_InterpBeginPlayerFrame() noexcept;
     void R_InterpBeginWorldFrame() noexcept;
@@ -92,6 +93,7 @@ subsector_t* R_PointInSubsector(const fixed_t x, const fixed_t y) noexcept;
     bool R_HasHigherSurroundingSkyCeiling(const sector_t& sector) noexcept;
     bool R_HasLowerSurroundingSkyFloor(const sector_t& sector) noexcept;
     void R_UpdateSectorDrawHeights(sector_t& sector) noexcept;
+    void R_UpdateAllSectorDrawHeights() noexcept;
     void R_UpdateShadingParams(sector_t& sector) noexcept;
     light_t R_GetSectorLightColor(const sector_t& sector, const fixed_t z) noexcept;
     void R_GetSectorDrawColor(const sector_t& sector, const fixed_t z, uint8_t& r, uint8_t& g, uint8_t& b) noexcept;
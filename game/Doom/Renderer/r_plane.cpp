@@ -7,6 +7,7 @@
 #include "Doom/Game/doomdata.h"
 #include "PsyDoom/Config/Config.h"
 #include "PsyQ/LIBGPU.h"
+#include "r_coverage.h"
 #include "r_data.h"
 #include "r_local.h"
 #include "r_main.h"
@@ -52,7 +53,15 @@ void R_DrawSubsectorFlat(leaf_t& leaf, const bool bIsCeiling) noexcept {
     // Upload the flat texture to VRAM if required.
     // This case will be triggered for animated flats like water & slime - only one frame will be in VRAM at a time.
     // Most normal flats however will already be uploaded to VRAM on level start.
-    if (tex.uploadFrameNum == TEX_INVALID_UPLOAD_FRAME_NUM) {
+    //
+    // PsyDoom: if recording coverage then nothing is drawn and no GPU state is touched, so skip the upload and texture window.
+    #if PSYDOOM_MODS
+        const bool bCovRecord = (gRCoverageMode == RCoverageMode::Record);
+    #else
+        constexpr bool bCovRecord = false;
+    #endif
+
+    if ((tex.uploadFrameNum == TEX_INVALID_UPLOAD_FRAME_NUM) && (!bCovRecord)) {
         // Decompress the lump data to the temporary buffer if required.
         // PsyDoom: making some updates here to work with the new WAD management code.
         const std::byte* pLumpData;
@@ -95,9 +104,10 @@ void R_DrawSubsectorFlat(leaf_t& leaf, const bool bIsCeiling) noexcept {
         }
 
         // Load the decompressed texture to the required part of VRAM and mark as loaded.
-        // PsyDoom: also ensure texture metrics are up-to-date.
+        // PsyDoom: also ensure texture metrics are up-to-date, and note which palette indexes it uses (for coverage culling).
         #if PSYDOOM_MODS
             R_UpdateTexMetricsFromData(tex, pLumpData, flatLump.uncompressedSize);
+            R_UpdateTexPalIdxMaskFromData(tex, pLumpData, flatLump.uncompressedSize);
         #endif
 
         const SRECT vramRect = getTextureVramRect(tex);
@@ -108,7 +118,7 @@ void R_DrawSubsectorFlat(leaf_t& leaf, const bool bIsCeiling) noexcept {
     // Setup the texture window so that repeating occurs.
     // Note: the PSX version hardcoded the flat size here to 64x64 - but I will use the actual texture size instead.
     // The behavior should be the same but this way is more flexible for potential modding.
-    {
+    if (!bCovRecord) {
         SRECT texWinRect;
         LIBGPU_setRECT(texWinRect, tex.texPageCoordX, tex.texPageCoordY, tex.width, tex.height);
 
@@ -375,6 +385,11 @@ static void R_DrawFlatSpans(leaf_t& leaf, const int32_t planeViewZ, const textur
     drawPrim.clut = g3dViewPaletteClutId;
     drawPrim.tpage = tex.texPageId;
 
+    // PsyDoom: if recording coverage then note the rows covered by the flat, if it can never produce a transparent pixel
+    #if PSYDOOM_MODS
+        const bool bCovOccluder = ((gRCoverageMode == RCoverageMode::Record) && R_CovIsTexOpaque(tex));
+    #endif
+
     // Draw all of the horizontal spans in the flat
     const span_t* pSpan = &gFlatSpans[planeBegY];
 
@@ -590,7 +605,14 @@ static void R_DrawFlatSpans(leaf_t& leaf, const int32_t planeViewZ, const textur
                 );
             #endif
 
-            I_AddPrim(drawPrim);
+            // PsyDoom: skip the span if coverage culling determines it will be completely drawn over by what is in front of it
+            #if PSYDOOM_MODS
+                if (R_CovCheckFloorRow(drawPrim.x0, drawPrim.x1, drawPrim.y0, bCovOccluder)) {
+                    I_AddPrim(drawPrim);
+                }
+            #else
+                I_AddPrim(drawPrim);
+            #endif
         } else {
             // Harder case: we must split up the flat span and issue multiple primitives.
             // Note also, the piece count is minus 1 so increment here now to get the true amount:
@@ -684,7 +706,14 @@ static void R_DrawFlatSpans(leaf_t& leaf, const int32_t planeViewZ, const textur
                     );
                 #endif
 
-                I_AddPrim(drawPrim);
+                // PsyDoom: skip the span piece if coverage culling determines it will be completely drawn over by what is in front of it
+                #if PSYDOOM_MODS
+                    if (R_CovCheckFloorRow(drawPrim.x0, drawPrim.x1, drawPrim.y0, bCovOccluder)) {
+                        I_AddPrim(drawPrim);
+                    }
+                #else
+                    I_AddPrim(drawPrim);
+                #endif
 
                 // Move coords onto the next span.
                 // Note that the previous wrapping operation (if any) is also undone here.
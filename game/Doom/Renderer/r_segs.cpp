@@ -7,6 +7,7 @@
 #include "Doom/Game/doomdata.h"
 #include "PsyDoom/Config/Config.h"
 #include "PsyQ/LIBGPU.h"
+#include "r_coverage.h"
 #include "r_data.h"
 #include "r_local.h"
 #include "r_main.h"
@@ -55,9 +56,10 @@ static void R_UploadWallTexToVram(texture_t& tex) noexcept {
     #endif
 
     // Upload to the GPU and mark the texture as loaded this frame.
-    // PsyDoom: also ensure texture metrics are up-to-date.
+    // PsyDoom: also ensure texture metrics are up-to-date, and note which palette indexes it uses (for coverage culling).
     #if PSYDOOM_MODS
         R_UpdateTexMetricsFromData(tex, pTexData, texLump.uncompressedSize);
+        R_UpdateTexPalIdxMaskFromData(tex, pTexData, texLump.uncompressedSize);
     #endif
 
     const SRECT texRect = getTextureVramRect(tex);
@@ -361,10 +363,26 @@ static void R_DrawWallPieceImpl(
         bTransparent = true;
     }
 
+    // PsyDoom: if recording coverage then nothing is drawn and no GPU state is touched, only the columns covered by opaque walls are noted.
+    // A wall can only fully cover what is behind it if it is not translucent and can never produce a transparent pixel.
+    #if PSYDOOM_MODS
+        const bool bCovRecord = (gRCoverageMode == RCoverageMode::Record);
+        const bool bCovOccluder = (bCovRecord && (!bTransparent) && R_CovIsTexOpaque(tex));
+    #endif
+
     // Upload the wall texture to VRAM if needed
-    R_UploadWallTexToVram(tex);
+    #if PSYDOOM_MODS
+        if (!bCovRecord) {
+            R_UploadWallTexToVram(tex);
+        }
+    #else
+        R_UploadWallTexToVram(tex);
+    #endif
 
     // Set the texture window - the area of VRAM used for texturing
+    #if PSYDOOM_MODS
+        if (!bCovRecord)
+    #endif
     {
         SRECT texRect;
         LIBGPU_setRECT(texRect, tex.texPageCoordX, tex.texPageCoordY, tex.width, tex.height);
@@ -710,7 +728,14 @@ static void R_DrawWallPieceImpl(
                 );
             #endif
 
-            I_AddPrim(drawPrim);
+            // PsyDoom: skip the column if coverage culling determines it will be completely drawn over by what is in front of it
+            #if PSYDOOM_MODS
+                if (R_CovCheckWallCol(drawPrim.x0, drawPrim.y0, drawPrim.y1, bCovOccluder)) {
+                    I_AddPrim(drawPrim);
+                }
+            #else
+                I_AddPrim(drawPrim);
+            #endif
         }
 
         ++xCur;
@@ -7,11 +7,13 @@
 #include "Doom/Game/g_game.h"
 #include "Doom/Game/info.h"
 #include "Doom/Game/sprinfo.h"
+#include "PsyDoom/MobjSpritePrecacher.h"
 #include "PsyQ/LIBGPU.h"
 #include "PsyQ/LIBGTE.h"
 #include "r_data.h"
 #include "r_local.h"
 #include "r_main.h"
+#include "r_voxel.h"
 
 // Describes a sprite that is to be drawn
 struct vissprite_t {
@@ -242,6 +244,19 @@ void R_DrawSubsectorSprites(subsector_t& subsec) noexcept {
     for (const vissprite_t* pSpr = gVisSpriteHead.next; pSpr != &gVisSpriteHead; pSpr = pSpr->next) {
         // Grab the sprite frame to use
         mobj_t& thing = *pSpr->thing;
+
+        // PsyDoom: draw the thing using its voxel model instead, if it has one for this frame
+        #if PSYDOOM_MODS
+        {
+            visvoxel_t visVoxel;
+
+            if (R_ProjectVoxel(thing, visVoxel)) {
+                R_DrawVisVoxel(visVoxel);
+                continue;
+            }
+        }
+        #endif
+
         const spritedef_t& spriteDef = gSprites[thing.sprite];
         const spriteframe_t& frame = spriteDef.spriteframes[thing.frame & FF_FRAMEMASK];
 
@@ -270,6 +285,11 @@ void R_DrawSubsectorSprites(subsector_t& subsec) noexcept {
             bFlipSpr = frame.flip[0];
         }
 
+        // PsyDoom: if the sprite is still being streamed in then a placeholder might be used instead
+        #if PSYDOOM_MODS
+            lumpIdx = MobjSpritePrecacher::getSpriteLumpToDraw(thing, lumpIdx, bFlipSpr);
+        #endif
+
         // Upload the sprite texture to VRAM if not already uploaded.
         // PsyDoom: updates for changes to how textures are managed (changes that help support user modding).
         #if PSYDOOM_MODS
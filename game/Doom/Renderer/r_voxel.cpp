@@ -0,0 +1,459 @@
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Voxel model loading, and drawing of voxel models for the classic renderer.
+//
+// The classic renderer draws the models a column at a time: each model column is projected as a screen aligned box at the column's depth,
+// and each run of same colored voxels in the column's slabs is drawn as a flat colored screen column of pixels. The model columns are first
+// visited front to back, tracking which pixels of each screen column are already covered so that hidden runs can be skipped early.
+// The runs which survive are then drawn back to front, so that the result is correct even where the coverage tracking is conservative.
+//------------------------------------------------------------------------------------------------------------------------------------------
+#include "r_voxel.h"
+
+#include "Asserts.h"
+#include "Doom/Base/i_drawcmds.h"
+#include "Doom/Base/i_main.h"
+#include "Doom/Base/m_fixed.h"
+#include "Doom/Base/w_wad.h"
+#include "Doom/Base/z_zone.h"
+#include "Doom/Game/info.h"
+#include "Doom/Game/sprinfo.h"
+#include "PsyQ/LIBGPU.h"
+#include "r_data.h"
+#include "r_main.h"
+
+#include <algorithm>
+#include <cstring>
+
+// A run of same colored voxels which is visible on one screen column, and needs to be drawn
+struct voxelspan_t {
+    int16_t     x;
+    int16_t     yt;         // Top 'y' value (inclusive)
+    int16_t     yb;         // Bottom 'y' value (exclusive)
+    uint8_t     r, g, b;
+};
+
+// Voxel model lump ('-1' if none) for each sprite frame, indexed by 'sprite * VOXEL_MAX_FRAMES + frame'
+static std::vector<int32_t> gSpriteFrameVoxelLumps;
+
+// The first 'PLAYPAL' palette in 8-bit RGB format: used to color voxels in the classic renderer
+static uint8_t gVoxelPalette[256][3];
+
+// The visible voxel runs for the model currently being drawn, in front to back order
+static std::vector<voxelspan_t> gVoxelSpans;
+
+// The range of pixels which is known to be covered by the model being drawn, for each screen column.
+// Only one range per column is tracked, which means the coverage info is conservative.
+static int16_t gVoxelCoverTop[SCREEN_W];
+static int16_t gVoxelCoverBot[SCREEN_W];
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Verifies the voxel model in the specified lump is well formed and raises a fatal error if not.
+// This allows the rest of the code to decode the run-length encoded columns without any further bounds checks.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void R_ValidateVoxel(const voxel_t& voxel, const int32_t lumpIdx) noexcept {
+    const uint32_t lumpSize = (uint32_t) W_LumpLength(lumpIdx);
+
+    if (lumpSize < sizeof(voxel_t)) {
+        I_Error("R_ValidateVoxel: voxel lump %d is too small!", lumpIdx);
+    }
+
+    const int32_t width = voxel.width;
+    const int32_t height = voxel.height;
+    const int32_t depth = voxel.depth;
+
+    if ((width <= 0) || (height <= 0) || (depth <= 0) ||
+        (width > VOXEL_MAX_SIZE) || (height > VOXEL_MAX_SIZE) || (depth > VOXEL_MAX_SIZE)
+    ) {
+        I_Error("R_ValidateVoxel: voxel lump %d has bad dimensions %dx%dx%d!", lumpIdx, width, height, depth);
+    }
+
+    const uint32_t dataSize = lumpSize - (uint32_t) sizeof(voxel_t);
+    const uint32_t numColumns = (uint32_t) width * (uint32_t) depth;
+
+    if (dataSize < numColumns * sizeof(uint32_t)) {
+        I_Error("R_ValidateVoxel: voxel lump %d is missing column offsets!", lumpIdx);
+    }
+
+    // Check that all of the columns and their slabs are in bounds
+    for (uint32_t colIdx = 0; colIdx < numColumns; ++colIdx) {
+        uint32_t offset;
+        std::memcpy(&offset, voxel.data() + colIdx * sizeof(uint32_t), sizeof(uint32_t));
+
+        if (offset >= dataSize) {
+            I_Error("R_ValidateVoxel: voxel lump %d has a bad column offset!", lumpIdx);
+        }
+
+        const uint32_t numSlabs = voxel.data()[offset++];
+
+        for (uint32_t slabIdx = 0; slabIdx < numSlabs; ++slabIdx) {
+            if (offset + 2 > dataSize) {
+                I_Error("R_ValidateVoxel: voxel lump %d has a truncated column!", lumpIdx);
+            }
+
+            const int32_t zStart = voxel.data()[offset];
+            const int32_t zLength = voxel.data()[offset + 1];
+            offset += 2;
+
+            if ((zStart + zLength > height) || (offset + (uint32_t) zLength > dataSize)) {
+                I_Error("R_ValidateVoxel: voxel lump %d has a bad slab!", lumpIdx);
+            }
+
+            offset += zLength;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Returns the voxel model in the specified lump, caching it if required.
+// The model is validated when it is first loaded (or reloaded after being purged from the cache).
+//------------------------------------------------------------------------------------------------------------------------------------------
+voxel_t* R_GetVoxelForLump(const int32_t lumpIdx) noexcept {
+    const bool bWasCached = (W_GetLump(lumpIdx).pCachedData != nullptr);
+    const WadLump& lump = W_CacheLumpNum(lumpIdx, PU_CACHE, true);
+    voxel_t* const pVoxel = (voxel_t*) lump.pCachedData;
+
+    if (!bWasCached) {
+        R_ValidateVoxel(*pVoxel, lumpIdx);
+    }
+
+    return pVoxel;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Searches the WAD for the voxel model lump to use for the given sprite and frame, returning '-1' if there is none
+//------------------------------------------------------------------------------------------------------------------------------------------
+static int32_t R_FindVoxelLumpForSprite(const int32_t sprite, const int32_t frame) noexcept {
+    ASSERT((sprite >= 0) && (sprite < gNumSprites));
+    ASSERT((frame >= 0) && (frame < VOXEL_MAX_FRAMES));
+
+    // Note: PSX Doom sometimes sets the highest bit on the 1st character of sprite names; mask it out here
+    const sprname_t sprName = gSprites[sprite].name;
+    const char lumpName[8] = {
+        'V',
+        'X',
+        (char)(sprName.chars[0] & 0x7F),
+        sprName.chars[1],
+        sprName.chars[2],
+        sprName.chars[3],
+        (char)('A' + frame),
+        0
+    };
+
+    return W_CheckNumForName(lumpName);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Finds the voxel models for all sprite frames and converts the palette used to color voxels in the classic renderer.
+// Must be called after the list of sprites has been built.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void R_InitVoxels() noexcept {
+    gSpriteFrameVoxelLumps.clear();
+    gSpriteFrameVoxelLumps.resize((size_t) gNumSprites * VOXEL_MAX_FRAMES, -1);
+
+    for (int32_t sprite = 0; sprite < gNumSprites; ++sprite) {
+        const int32_t numFrames = std::min(gSprites[sprite].numframes, VOXEL_MAX_FRAMES);
+
+        for (int32_t frame = 0; frame < numFrames; ++frame) {
+            gSpriteFrameVoxelLumps[(size_t) sprite * VOXEL_MAX_FRAMES + frame] = R_FindVoxelLumpForSprite(sprite, frame);
+        }
+    }
+
+    const palette_t& palette = *(const palette_t*) W_CacheLumpName("PLAYPAL", PU_CACHE, true).pCachedData;
+
+    for (uint32_t colorIdx = 0; colorIdx < 256; ++colorIdx) {
+        const uint16_t color = palette.colors[colorIdx];
+
+        for (uint32_t comp = 0; comp < 3; ++comp) {
+            const uint32_t c5 = (color >> (comp * 5)) & 0x1Fu;
+            gVoxelPalette[colorIdx][comp] = (uint8_t)((c5 << 3) | (c5 >> 2));
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Returns the voxel model lump to use for the given sprite and frame, or '-1' if there is none
+//------------------------------------------------------------------------------------------------------------------------------------------
+int32_t R_GetVoxelLumpForSprite(const int32_t sprite, const int32_t frame) noexcept {
+    ASSERT((size_t) sprite * VOXEL_MAX_FRAMES + frame < gSpriteFrameVoxelLumps.size());
+    return gSpriteFrameVoxelLumps[(size_t) sprite * VOXEL_MAX_FRAMES + frame];
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Loads the voxel model in the specified lump into the cache ahead of time, if it's not already loaded
+//------------------------------------------------------------------------------------------------------------------------------------------
+void R_VoxelPrecache(const int32_t lumpIdx) noexcept {
+    R_GetVoxelForLump(lumpIdx);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Sets up the voxel model to draw for the specified thing.
+// Returns 'false' if the thing does not have a voxel model for its current sprite frame, in which case the sprite should be drawn instead.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool R_ProjectVoxel(mobj_t& thing, visvoxel_t& vis) noexcept {
+    // Blended things are drawn as sprites, since voxel models are only drawn opaque
+    if (thing.flags & MF_ALL_BLEND_FLAGS)
+        return false;
+
+    // Does this sprite frame have a voxel model?
+    const int32_t frame = (int32_t)(thing.frame & FF_FRAMEMASK);
+
+    if ((thing.sprite >= (uint32_t) gNumSprites) || (frame >= VOXEL_MAX_FRAMES) || gSpriteFrameVoxelLumps.empty())
+        return false;
+
+    const int32_t lumpIdx = R_GetVoxelLumpForSprite((int32_t) thing.sprite, frame);
+
+    if (lumpIdx < 0)
+        return false;
+
+    // Save the model and its interpolated position and angle
+    vis.thing = &thing;
+    vis.model = R_GetVoxelForLump(lumpIdx);
+    vis.gx = thing.x.renderValue();
+    vis.gy = thing.y.renderValue();
+    vis.gz = thing.z.renderValue();
+    vis.angle = thing.angle.renderValue();
+
+    // Decide on the color to shade the model with: full bright models are not affected by the sector light level
+    if (thing.frame & FF_FULLBRIGHT) {
+        vis.colR = LIGHT_INTENSTIY_MAX;
+        vis.colG = LIGHT_INTENSTIY_MAX;
+        vis.colB = LIGHT_INTENSTIY_MAX;
+    } else {
+        R_GetSectorDrawColor(*thing.subsector->sector, vis.gz, vis.colR, vis.colG, vis.colB);
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Helper: makes the order to visit the columns of a voxel model along one axis, front to back.
+// Columns on either side of the viewer do not overlap each other, so visit from the viewer's column outwards in each direction.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void R_GetVoxelColumnOrder(const int32_t size, const fixed_t viewPos, uint8_t order[VOXEL_MAX_SIZE]) noexcept {
+    const int32_t viewCol = std::clamp(d_fixed_to_int(viewPos), -1, size);
+    int32_t numCols = 0;
+
+    for (int32_t col = std::min(viewCol, size - 1); col >= 0; --col) {
+        order[numCols++] = (uint8_t) col;
+    }
+
+    for (int32_t col = std::max(viewCol + 1, 0); col < size; ++col) {
+        order[numCols++] = (uint8_t) col;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Helper: projects a view space 'x' or 'y' value to screen space, returning the result in 16.16 fixed point format
+//------------------------------------------------------------------------------------------------------------------------------------------
+static inline fixed_t R_VoxelProject(const fixed_t val, const fixed_t scale) noexcept {
+    return (fixed_t)(((int64_t) val * scale) >> FRACBITS);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Adds a run of voxels which covers the given pixels on a screen column, if the run is not already covered.
+// Trims the run to the parts that are not covered and updates the coverage info for the column.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void R_AddVoxelSpan(const int32_t x, const int32_t yt, const int32_t yb, const uint8_t r, const uint8_t g, const uint8_t b) noexcept {
+    int16_t& coverTop = gVoxelCoverTop[x];
+    int16_t& coverBot = gVoxelCoverBot[x];
+
+    const auto addSpan = [=](const int32_t spanYt, const int32_t spanYb) noexcept {
+        gVoxelSpans.push_back({ (int16_t) x, (int16_t) spanYt, (int16_t) spanYb, r, g, b });
+    };
+
+    // Nothing covered in this column yet?
+    if (coverTop >= coverBot) {
+        addSpan(yt, yb);
+        coverTop = (int16_t) yt;
+        coverBot = (int16_t) yb;
+        return;
+    }
+
+    // Fully hidden?
+    if ((yt >= coverTop) && (yb <= coverBot))
+        return;
+
+    // If the run touches the covered range then only the parts outside of it are visible, and the covered range grows to include it.
+    // Otherwise the run is fully visible and becomes the new covered range if it is bigger, since only one range is tracked.
+    if ((yt <= coverBot) && (yb >= coverTop)) {
+        if (yt < coverTop) {
+            addSpan(yt, coverTop);
+        }
+
+        if (yb > coverBot) {
+            addSpan(coverBot, yb);
+        }
+
+        coverTop = (int16_t) std::min<int32_t>(yt, coverTop);
+        coverBot = (int16_t) std::max<int32_t>(yb, coverBot);
+    } else {
+        addSpan(yt, yb);
+
+        if (yb - yt > coverBot - coverTop) {
+            coverTop = (int16_t) yt;
+            coverBot = (int16_t) yb;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Draws the specified voxel model.
+// Each model column is treated as a box facing the viewer, placed at the column's depth and sized to cover the column from all angles.
+// The top and bottom of each run of voxels are projected at both the nearest and furthest depths of the column, so that the top and bottom
+// faces of the column are also covered when viewing the model from above or below.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void R_DrawVisVoxel(const visvoxel_t& vis) noexcept {
+    const voxel_t& model = *vis.model;
+    const int32_t width = model.width;
+    const int32_t height = model.height;
+    const int32_t depth = model.depth;
+
+    // Figure out where the model origin is: the pivot offset moves the origin relative to the pivot point
+    const fixed_t originX = d_int_to_fixed(width) / 2 + model.offsetX;
+    const fixed_t originY = d_int_to_fixed(depth) / 2 + model.offsetY;
+    const fixed_t originZ = ((model.pivotType == VOXEL_PIVOT_BOTTOM_CENTER) ? 0 : d_int_to_fixed(height) / 2) + model.offsetZ;
+
+    // Get the view position in model space, for ordering the model columns front to back
+    const fixed_t modelCos = gFineCosine[vis.angle >> ANGLETOFINESHIFT];
+    const fixed_t modelSin = gFineSine[vis.angle >> ANGLETOFINESHIFT];
+    const fixed_t dx = gViewX - vis.gx;
+    const fixed_t dy = gViewY - vis.gy;
+    const fixed_t viewModelX = FixedMul(dx, modelCos) + FixedMul(dy, modelSin) + originX;
+    const fixed_t viewModelY = FixedMul(dy, modelCos) - FixedMul(dx, modelSin) + originY;
+
+    // Visit the columns in rows along the axis the viewer is furthest outside the model on, since those rows are roughly at the same depth
+    uint8_t orderX[VOXEL_MAX_SIZE];
+    uint8_t orderY[VOXEL_MAX_SIZE];
+    R_GetVoxelColumnOrder(width, viewModelX, orderX);
+    R_GetVoxelColumnOrder(depth, viewModelY, orderY);
+
+    const fixed_t outsideX = std::max({ 0, -viewModelX, viewModelX - d_int_to_fixed(width) });
+    const fixed_t outsideY = std::max({ 0, -viewModelY, viewModelY - d_int_to_fixed(depth) });
+    const bool bRowsAlongX = (outsideY >= outsideX);
+
+    // Get the view space position of the center of the first model column and how it changes for each step along the model 'x' and 'y' axes.
+    // The relative angle between the view and the model determines the step amounts.
+    const angle_t relAngle = gViewAngle - vis.angle;
+    const fixed_t relSin = gFineSine[relAngle >> ANGLETOFINESHIFT];
+    const fixed_t relCos = gFineCosine[relAngle >> ANGLETOFINESHIFT];
+    const fixed_t thingDx = vis.gx - gViewX;
+    const fixed_t thingDy = vis.gy - gViewY;
+    const fixed_t col0X = FRACUNIT / 2 - originX;
+    const fixed_t col0Y = FRACUNIT / 2 - originY;
+
+    const fixed_t viewCol0X = (
+        FixedMul(thingDx, gViewSin) - FixedMul(thingDy, gViewCos) +
+        FixedMul(col0X, relSin) - FixedMul(col0Y, relCos)
+    );
+
+    const fixed_t viewCol0Z = (
+        FixedMul(thingDx, gViewCos) + FixedMul(thingDy, gViewSin) +
+        FixedMul(col0X, relCos) + FixedMul(col0Y, relSin)
+    );
+
+    // Half the size of the box around each column, in view space
+    const fixed_t colHalfSize = (std::abs(relSin) + std::abs(relCos)) / 2;
+
+    // Height of the bottom of the model relative to the view
+    const fixed_t modelBotZ = vis.gz - originZ - gViewZ;
+
+    // Clear the coverage info and the list of runs to draw
+    std::fill_n(gVoxelCoverTop, SCREEN_W, (int16_t) 0);
+    std::fill_n(gVoxelCoverBot, SCREEN_W, (int16_t) 0);
+    gVoxelSpans.clear();
+
+    // Visit all the model columns front to back and gather the runs of voxels which are visible
+    const int32_t numRows = (bRowsAlongX) ? depth : width;
+    const int32_t rowSize = (bRowsAlongX) ? width : depth;
+
+    for (int32_t rowIdx = 0; rowIdx < numRows; ++rowIdx) {
+        for (int32_t colIdx = 0; colIdx < rowSize; ++colIdx) {
+            const int32_t mx = (bRowsAlongX) ? orderX[colIdx] : orderX[rowIdx];
+            const int32_t my = (bRowsAlongX) ? orderY[rowIdx] : orderY[colIdx];
+
+            // Get the column data and skip if it has no slabs
+            uint32_t colOffset;
+            std::memcpy(&colOffset, model.data() + (my * width + mx) * sizeof(uint32_t), sizeof(uint32_t));
+            const uint8_t* pSlab = model.data() + colOffset;
+            const uint32_t numSlabs = *pSlab++;
+
+            if (numSlabs == 0)
+                continue;
+
+            // Get the nearest and furthest depth of the column and skip if it's behind the near plane
+            const fixed_t viewColX = viewCol0X + mx * relSin - my * relCos;
+            const fixed_t viewColZ = viewCol0Z + mx * relCos + my * relSin;
+            const fixed_t farZ = viewColZ + colHalfSize;
+            const fixed_t nearZ = std::max(viewColZ - colHalfSize, d_int_to_fixed(NEAR_CLIP_DIST));
+
+            if (farZ <= nearZ)
+                continue;
+
+            const fixed_t nearScale = (fixed_t)(((int64_t) HALF_SCREEN_W << (2 * FRACBITS)) / nearZ);
+            const fixed_t farScale = (fixed_t)(((int64_t) HALF_SCREEN_W << (2 * FRACBITS)) / farZ);
+
+            // Get the screen columns covered by the model column and skip if offscreen
+            const fixed_t xl = std::min(R_VoxelProject(viewColX - colHalfSize, nearScale), R_VoxelProject(viewColX - colHalfSize, farScale));
+            const fixed_t xr = std::max(R_VoxelProject(viewColX + colHalfSize, nearScale), R_VoxelProject(viewColX + colHalfSize, farScale));
+            const int32_t x1 = std::max(HALF_SCREEN_W + d_fixed_to_int(xl + FRACUNIT / 2), 0);
+            const int32_t x2 = std::min(HALF_SCREEN_W + d_fixed_to_int(xr + FRACUNIT / 2), SCREEN_W);
+
+            if (x1 >= x2)
+                continue;
+
+            // Draw each run of same colored voxels in each slab
+            for (uint32_t slabIdx = 0; slabIdx < numSlabs; ++slabIdx) {
+                const int32_t zStart = pSlab[0];
+                const int32_t zLength = pSlab[1];
+                const uint8_t* const pColors = pSlab + 2;
+                pSlab += 2 + zLength;
+
+                for (int32_t runEnd = zLength; runEnd > 0;) {
+                    // Note: the colors are stored bottom to top, find the start of the run going downwards
+                    const uint8_t colorIdx = pColors[runEnd - 1];
+                    int32_t runStart = runEnd - 1;
+
+                    while ((runStart > 0) && (pColors[runStart - 1] == colorIdx)) {
+                        --runStart;
+                    }
+
+                    // Project the top and bottom of the run at the nearest and furthest depths of the column, and clip to the view
+                    const fixed_t runTopZ = modelBotZ + d_int_to_fixed(zStart + runEnd);
+                    const fixed_t runBotZ = modelBotZ + d_int_to_fixed(zStart + runStart);
+                    const fixed_t yt = std::max(R_VoxelProject(runTopZ, nearScale), R_VoxelProject(runTopZ, farScale));
+                    const fixed_t yb = std::min(R_VoxelProject(runBotZ, nearScale), R_VoxelProject(runBotZ, farScale));
+                    const int32_t y1 = std::max(HALF_VIEW_3D_H - d_fixed_to_int(yt + FRACUNIT / 2), 0);
+                    const int32_t y2 = std::min(HALF_VIEW_3D_H - d_fixed_to_int(yb + FRACUNIT / 2), VIEW_3D_H);
+                    runEnd = runStart;
+
+                    if (y1 >= y2)
+                        continue;
+
+                    // Light the voxel color and add the run to each screen column it covers
+                    const uint8_t* const pColor = gVoxelPalette[colorIdx];
+                    const uint8_t r = (uint8_t) std::min(((uint32_t) pColor[0] * vis.colR) >> 7, 255u);
+                    const uint8_t g = (uint8_t) std::min(((uint32_t) pColor[1] * vis.colG) >> 7, 255u);
+                    const uint8_t b = (uint8_t) std::min(((uint32_t) pColor[2] * vis.colB) >> 7, 255u);
+
+                    for (int32_t x = x1; x < x2; ++x) {
+                        R_AddVoxelSpan(x, y1, y2, r, g, b);
+                    }
+                }
+            }
+        }
+    }
+
+    // Draw all of the visible runs, back to front
+    WALLCOL_F drawPrim = {};
+    LIBGPU_SetWallColF(drawPrim);
+
+    for (auto iter = gVoxelSpans.rbegin(); iter != gVoxelSpans.rend(); ++iter) {
+        const voxelspan_t& span = *iter;
+        drawPrim.x0 = span.x;
+        drawPrim.y0 = span.yt;
+        drawPrim.y1 = span.yb;
+        drawPrim.r0 = span.r;
+        drawPrim.g0 = span.g;
+        drawPrim.b0 = span.b;
+        I_AddPrim(drawPrim);
+    }
+}
@@ -1,25 +1,42 @@
 #pragma once
 
-#include "Doom/doomtype.h"
+#include "Doom/doomdef.h"
 #include "Doom/Renderer/r_local.h" // For fixed_t, mobj_t, etc.
 
+#include <vector>
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Voxel Model Data Structure
 // Designed to be loaded as a single lump via Z_Malloc.
 //
-// To hook into R_DrawSubsectorSprites:
-// 1. Check if mobj_t->flags has MF_VOXEL set (or similar logic).
-// 2. If so, call R_ProjectVoxel(thing) instead of the standard sprite projection.
-// 3. R_ProjectVoxel creates a visvoxel_t (or reuses vissprite_t with a flag) and adds it to the sort list.
-// 4. During the draw loop, check if the sorted item is a voxel, and call R_DrawVisVoxel.
+// Things with a voxel model for their current sprite frame are drawn using that model instead of their sprite.
+// The classic renderer sorts them along with all of the other sprites in the subsector: when it is time to draw one 'R_ProjectVoxel' sets up
+// a 'visvoxel_t' for the thing and 'R_DrawVisVoxel' rasterizes the slabs of the model as columns of pixels.
+// The Vulkan renderer does not support voxel models yet and draws these things using their sprites.
+//
+// Voxel model lumps are named 'VX' followed by the 4 character sprite name and the frame letter, e.g 'VXBON1A' for frame 'A' of 'BON1'.
+// The data following the header is laid out as follows:
+//
+//  uint32_t columnOffsets[width * depth]   Byte offset of each column relative to the start of 'data()', indexed by 'y * width + x'.
+//  columns                                 Each column is a 'uint8_t' slab count followed by that many slabs.
+//
+// Each slab is a 'uint8_t' z start (where '0' is the bottom of the model), a 'uint8_t' length and then 'length' voxel colors.
+// Voxel colors are indexes into the first 'PLAYPAL' palette and each voxel is 1 world unit in size.
 //------------------------------------------------------------------------------------------------------------------------------------------
 
+// Where the origin of a voxel model is, before the pivot offset is added
+static constexpr int32_t VOXEL_PIVOT_CENTER         = 0;    // The center of the model
+static constexpr int32_t VOXEL_PIVOT_BOTTOM_CENTER  = 1;    // The center of the bottom of the model (the usual case for things on the floor)
+
+// Maximum size of a voxel model along any axis (z starts and lengths must fit in 8-bits)
+static constexpr int32_t VOXEL_MAX_SIZE = 256;
+
 typedef struct {
     int32_t     width;          // x axis size
     int32_t     height;         // z axis size (up/down in Doom is usually height, but Voxels often use z as height)
     int32_t     depth;          // y axis size
     
-    int32_t     pivotType;      // 0 = center, 1 = bottom-center, etc.
+    int32_t     pivotType;      // 0 = center, 1 = bottom-center, etc. (see 'VOXEL_PIVOT_*')
     fixed_t     offsetX;        // Pivot offset X (fixed_t)
     fixed_t     offsetY;        // Pivot offset Y (fixed_t)
     fixed_t     offsetZ;        // Pivot offset Z (fixed_t)
@@ -27,56 +44,50 @@ typedef struct {
     // Palette data or remap table index could go here if voxels have own palettes
     // ...
 
-    // Raw Voxel Data follows immediately after this struct in memory.
-    // Format: Slab6 / KVX style run-length encoded columns for efficiency.
-    // Data is accessed as: voxel_t* v = (voxel_t*)Z_Malloc(...); uint8_t* data = v->data;
-    uint8_t     data[];     
+    // The raw voxel data (column offsets and run-length encoded columns) follows immediately after this struct in memory.
+    // Note: this is an accessor rather than a flexible array member, since those are not standard C++.
+    inline const uint8_t* data() const noexcept { return (const uint8_t*)(this + 1); }
 } voxel_t;
 
+static_assert(sizeof(voxel_t) == 28);
+
+// Maximum number of animation frames per sprite which can have voxel models ('A' to 'Z')
+static constexpr int32_t VOXEL_MAX_FRAMES = 26;
+
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Runtime Voxel Visibility Structure
-// Analogous to vissprite_t, but carries 3D rotation data.
-// This structure needs to be compatible with the sorting mechanism in r_things.cpp.
-// Existing vissprite_t has: viewx, scale, thing, next.
-// We might need to extend vissprite_t or cast between types if we want to share the sort list.
+// Runtime Voxel Visibility Structure.
+// Holds everything needed to draw a voxel model for a thing; voxel things are sorted along with sprites by their 'vissprite_t'.
 //------------------------------------------------------------------------------------------------------------------------------------------
 typedef struct visvoxel_s {
-    struct visvoxel_s* next;    // Must match vissprite_t::next layout for shared sorting if possible
-    
-    int32_t         viewx;      // Viewspace x position (Must match vissprite_t::viewx)
-    fixed_t         scale;      // Scale due to perspective (Must match vissprite_t::scale)
-    mobj_t*         thing;      // The thing (Must match vissprite_t::thing)
-
-    // Voxel specific fields below
-    fixed_t         gy;         // World coordinates
+    mobj_t*         thing;      // The thing
+    const voxel_t*  model;      // Pointer to the cached voxel data
+    fixed_t         gx;         // World coordinates of the model origin
+    fixed_t         gy;
     fixed_t         gz;         // World Z (height)
-    fixed_t         gz_top;
-    
-    angle_t         angle;      // View angle relative to the object
-    
-    voxel_t*        model;      // Pointer to the cached voxel data
-    int32_t         colormap;   // Lighting level index
+    angle_t         angle;      // Which way the model is facing
+    uint8_t         colR;       // Color to shade the model with: '128' is regarded as 1.0
+    uint8_t         colG;
+    uint8_t         colB;
 } visvoxel_t;
 
-
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Public Interface
 //------------------------------------------------------------------------------------------------------------------------------------------
 
-// Called during R_Init to set up lookup tables for voxel rendering
-void R_InitVoxels(void);
-
-// Called by R_DrawSubsectorSprites in r_things.cpp when a voxel flag is detected
-void R_ProjectVoxel(mobj_t* thing);
+// Called after sprites are initialized to set up lookup tables for voxel rendering
+void R_InitVoxels() noexcept;
 
-// Adds a visible voxel to the draw list (called by R_ProjectVoxel)
-void R_AddVisVoxel(visvoxel_t* vis);
+// Called by R_DrawSubsectorSprites in r_things.cpp for each sorted sprite: returns 'true' if the thing should be drawn as a voxel model
+bool R_ProjectVoxel(mobj_t& thing, visvoxel_t& vis) noexcept;
 
 // Called during the standard draw phase (sorted with sprites)
-void R_DrawVisVoxel(visvoxel_t* vis);
+void R_DrawVisVoxel(const visvoxel_t& vis) noexcept;
 
 // Memory management
-voxel_t* R_GetVoxelForLump(int32_t lumpIdx);
+voxel_t* R_GetVoxelForLump(int32_t lumpIdx) noexcept;
+
+// Returns the voxel model lump to use for the given sprite and frame, or '-1' if there is none
+int32_t R_GetVoxelLumpForSprite(const int32_t sprite, const int32_t frame) noexcept;
 
 // Debug / Utilities
-void R_VoxelPrecache(int32_t lumpIdx);
+void R_VoxelPrecache(int32_t lumpIdx) noexcept;
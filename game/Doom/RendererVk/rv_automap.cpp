@@ -25,6 +25,7 @@
 #include "rv_utils.h"
 
 #include <cmath>
+#include <vector>
 
 // The position and rotation to use for the player this frame on the automap, and the free camera position and camera zoom
 static fixed_t gRvMap_PlayerX;
@@ -34,6 +35,16 @@ static fixed_t gRvMap_AutomapX;
 static fixed_t gRvMap_AutomapY;
 static fixed_t gRvMap_AutomapScale;
 
+// Cached vertices for all visible map lines, the color of each line (0 if not drawn) and the inputs used to decide the line colors.
+// The cached vertices are in map space and are transformed to the screen using the automap transform matrix.
+static std::vector<VVertex_Draw>    gRvMap_CachedLineVerts;
+static std::vector<uint32_t>        gRvMap_CachedLineColors;
+static const line_t*                gpRvMap_CachedLines;
+static int32_t                      gRvMap_CachedGameTic;
+static uint32_t                     gRvMap_CachedAllLinesCheat;
+static bool                         gbRvMap_CachedAllMapPower;
+static bool                         gbRvMap_CachedBrightLines;
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Compute the position and rotation to use for the automap for the player, taking into account framerate independent movement.
 // Also does the same for the 'free camera' automap position that is used when the player is manually panning over the map.
@@ -118,63 +129,130 @@ static void RV_AddAutomapLine(const uint32_t color, const float x1, const float
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Draws all visible map lines
+// Get the color to draw the specified map line with, or '0' if the line should not be drawn
 //------------------------------------------------------------------------------------------------------------------------------------------
-static void RV_DrawMapLines() noexcept {
+static uint32_t RV_GetMapLineColor(const line_t& line, const player_t& curPlayer, const bool bBrightLines) noexcept {
+    // See whether we should draw the automap line or not
+    const bool bHiddenLine = (line.flags & ML_DONTDRAW);
+    const bool bLineSeen = ((line.flags & ML_MAPPED) && (!bHiddenLine));
+    const bool bLineMapped = ((curPlayer.powers[pw_allmap]) && (!bHiddenLine));
+    const bool bAllLinesCheatOn = (curPlayer.cheats & CF_ALLLINES);
+    const bool bDraw = (bLineSeen || bLineMapped || bAllLinesCheatOn);
+
+    if (!bDraw)
+        return 0;
+
+    // Decide on line color: start off with the normal two sided line color to begin with
+    if (((curPlayer.cheats & CF_ALLLINES) + curPlayer.powers[pw_allmap] != 0) && ((line.flags & ML_MAPPED) == 0)) {
+        // A known line (due to all map cheat/powerup) but unseen
+        return (bBrightLines) ? BRIGHT_AM_COLOR_GREY : AM_COLOR_GREY;
+    }
+    else if (line.flags & ML_SECRET) {
+        // Secret
+        return (bBrightLines) ? BRIGHT_AM_COLOR_RED : AM_COLOR_RED;
+    }
+    else if (line.special != 0) {
+        // Special or activatable thing
+        return (bBrightLines) ? BRIGHT_AM_COLOR_YELLOW : AM_COLOR_YELLOW;
+    }
+    else if ((line.flags & ML_TWOSIDED) == 0) {
+        // One sided line
+        return (bBrightLines) ? BRIGHT_AM_COLOR_RED : AM_COLOR_RED;
+    } else {
+        // Everything else...
+        return (bBrightLines) ? BRIGHT_AM_COLOR_BROWN : AM_COLOR_BROWN;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Updates the cached vertices for all visible map lines, if required.
+//
+// Line visibility and colors can only change when the game ticks (lines get seen, specials get used up etc.) or when certain settings
+// change, so the line colors are only re-evaluated when that happens. The vertices themselves are only re-built if any color has changed.
+// This saves a lot of work when the automap is open on maps with many lines, since the view transform is done entirely via the matrix.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void RV_UpdateMapLinesCache() noexcept {
     const player_t& curPlayer = gPlayers[gCurPlayerIndex];
     const bool bBrightLines = Config::gbVulkanBrightenAutomap;
+    const bool bAllMapPower = (curPlayer.powers[pw_allmap] != 0);
+    const uint32_t allLinesCheat = (curPlayer.cheats & CF_ALLLINES);
 
     const int32_t numLines = gNumLines;
     const line_t* const pLines = gpLines;
 
-    for (int32_t lineIdx = 0; lineIdx < numLines; ++lineIdx) {
-        // See whether we should draw the automap line or not
-        const line_t& line = pLines[lineIdx];
+    // Must rebuild everything if the map or any of the settings affecting all lines have changed.
+    // Note: the game tick counter going backwards means a new game loop has started, for a possibly different map.
+    const bool bForceRebuild = (
+        (pLines != gpRvMap_CachedLines) ||
+        (gGameTic < gRvMap_CachedGameTic) ||
+        (gRvMap_CachedLineColors.size() != (size_t) numLines) ||
+        (bBrightLines != gbRvMap_CachedBrightLines) ||
+        (bAllMapPower != gbRvMap_CachedAllMapPower) ||
+        (allLinesCheat != gRvMap_CachedAllLinesCheat)
+    );
 
-        const bool bHiddenLine = (line.flags & ML_DONTDRAW);
-        const bool bLineSeen = ((line.flags & ML_MAPPED) && (!bHiddenLine));
-        const bool bLineMapped = ((curPlayer.powers[pw_allmap]) && (!bHiddenLine));
-        const bool bAllLinesCheatOn = (curPlayer.cheats & CF_ALLLINES);
-        const bool bDraw = (bLineSeen || bLineMapped || bAllLinesCheatOn);
+    // If nothing has changed and the game hasn't ticked then there is nothing to re-evaluate
+    if ((!bForceRebuild) && (gGameTic == gRvMap_CachedGameTic))
+        return;
 
-        if (!bDraw)
-            continue;
+    gpRvMap_CachedLines = pLines;
+    gbRvMap_CachedBrightLines = bBrightLines;
+    gbRvMap_CachedAllMapPower = bAllMapPower;
+    gRvMap_CachedAllLinesCheat = allLinesCheat;
+    gRvMap_CachedGameTic = gGameTic;
 
-        // Get the line point coords in float format
-        const vertex_t& v1 = *line.vertex1;
-        const vertex_t& v2 = *line.vertex2;
-        const float x1 = RV_FixedToFloat(v1.x);
-        const float y1 = RV_FixedToFloat(v1.y);
-        const float x2 = RV_FixedToFloat(v2.x);
-        const float y2 = RV_FixedToFloat(v2.y);
+    // Re-evaluate the color of every line and see if any changed
+    bool bRebuildVerts = bForceRebuild;
+    gRvMap_CachedLineColors.resize(numLines);
 
-        // Decide on line color: start off with the normal two sided line color to begin with
-        uint32_t color;
+    for (int32_t lineIdx = 0; lineIdx < numLines; ++lineIdx) {
+        const uint32_t color = RV_GetMapLineColor(pLines[lineIdx], curPlayer, bBrightLines);
 
-        if (((curPlayer.cheats & CF_ALLLINES) + curPlayer.powers[pw_allmap] != 0) && ((line.flags & ML_MAPPED) == 0)) {
-            // A known line (due to all map cheat/powerup) but unseen
-            color = (bBrightLines) ? BRIGHT_AM_COLOR_GREY : AM_COLOR_GREY;
-        }
-        else if (line.flags & ML_SECRET) {
-            // Secret
-            color = (bBrightLines) ? BRIGHT_AM_COLOR_RED : AM_COLOR_RED;
-        }
-        else if (line.special != 0) {
-            // Special or activatable thing
-            color = (bBrightLines) ? BRIGHT_AM_COLOR_YELLOW : AM_COLOR_YELLOW;
-        }
-        else if ((line.flags & ML_TWOSIDED) == 0) {
-            // One sided line
-            color = (bBrightLines) ? BRIGHT_AM_COLOR_RED : AM_COLOR_RED;
-        } else {
-            // Everything else...
-            color = (bBrightLines) ? BRIGHT_AM_COLOR_BROWN : AM_COLOR_BROWN;
+        if (color != gRvMap_CachedLineColors[lineIdx]) {
+            gRvMap_CachedLineColors[lineIdx] = color;
+            bRebuildVerts = true;
         }
+    }
 
-        RV_AddAutomapLine(color, x1, y1, x2, y2);
+    if (!bRebuildVerts)
+        return;
+
+    // Rebuild the vertices for all visible lines
+    gRvMap_CachedLineVerts.clear();
+
+    for (int32_t lineIdx = 0; lineIdx < numLines; ++lineIdx) {
+        const uint32_t color = gRvMap_CachedLineColors[lineIdx];
+
+        if (color == 0)
+            continue;
+
+        const line_t& line = pLines[lineIdx];
+        const vertex_t* const lineVerts[2] = { line.vertex1, line.vertex2 };
+
+        for (const vertex_t* const pLineVert : lineVerts) {
+            VVertex_Draw& vert = gRvMap_CachedLineVerts.emplace_back();
+            vert = {};
+            vert.x = RV_FixedToFloat(pLineVert->x);
+            vert.y = RV_FixedToFloat(pLineVert->y);
+            vert.r = (uint8_t)(color >> 16);
+            vert.g = (uint8_t)(color >> 8);
+            vert.b = (uint8_t)(color);
+            vert.stmulR = 255;
+            vert.stmulG = 255;
+            vert.stmulB = 255;
+            vert.stmulA = 255;
+        }
     }
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Draws all visible map lines
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void RV_DrawMapLines() noexcept {
+    RV_UpdateMapLinesCache();
+    VDrawing::addUILines(gRvMap_CachedLineVerts.data(), (uint32_t) gRvMap_CachedLineVerts.size());
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Draws things for the show all map things cheat: displays a little wireframe triangle for for all things
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -11,13 +11,15 @@
 #include "Doom/Game/p_setup.h"
 #include "Doom/Renderer/r_local.h"
 #include "Doom/Renderer/r_main.h"
+#include "PsyDoom/FrameProfiler.h"
 #include "rv_data.h"
 #include "rv_main.h"
 #include "rv_occlusion.h"
+#include "rv_pvs.h"
 #include "rv_utils.h"
 
 // This is the list of subsectors to be drawn by the Vulkan renderer, in front to back order
-std::vector<subsector_t*> gRvDrawSubsecs;
+VFrameArena::FrameVector<subsector_t*> gRvDrawSubsecs;
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Tells if the given line segment is occluding for the purposes of visibility testing.
@@ -33,9 +35,8 @@ static bool RV_IsOccludingSeg(const rvseg_t& seg, const sector_t& frontSector) n
         return true;
 
     // Get the mid-wall gap between the front and back sectors.
-    // Also update the height that the back sector floors and ceilings are to be drawn at, before we compare.
-    sector_t& backSector = *seg.backsector;
-    R_UpdateSectorDrawHeights(backSector);
+    // Note: sector draw heights are updated for all sectors at the start of the frame.
+    const sector_t& backSector = *seg.backsector;
 
     const fixed_t fty = frontSector.ceilingDrawH;
     const fixed_t fby = frontSector.floorDrawH;
@@ -111,10 +112,9 @@ static bool RV_NodeBBVisible(const fixed_t boxCoords[4]) noexcept {
 // Adds it to the list of subsectors to be drawn, and marks the areas that its fully solid walls occlude.
 //------------------------------------------------------------------------------------------------------------------------------------------
 static void RV_VisitSubsec(const int32_t subsecIdx) noexcept {
-    // Update the heights that the sector will use for rendering
+    // Note: the heights that the sector will use for rendering are updated for all sectors at the start of the frame
     subsector_t& subsec = gpSubsectors[subsecIdx];
     sector_t& frontSector = *subsec.sector;
-    R_UpdateSectorDrawHeights(frontSector);
 
     // Assume the subsector can have its flats merged/batched initially unless the sector is almost or completely closed.
     // Batching for closed or nearly closed sectors can cause ordering issues sometimes - be more strict about ordering in those cases.
@@ -132,8 +132,13 @@ static void RV_VisitSubsec(const int32_t subsecIdx) noexcept {
 
     // Run through all of the segs for the subsector and mark out areas of the screen that they fully occlude.
     // Also determine whether each seg is visible and backfacing while we are at it.
+    //
+    // Note: BSP node bounding boxes are checked with a lot of leniency (to avoid sprite pop-in) so many subsectors visited are actually
+    // entirely offscreen. Do one check against the bounding box for the subsector's segs to skip the per-seg frustum tests in that case.
     rvseg_t* const pSegs = gpRvSegs.get() + subsec.firstseg;
     const uint32_t numSegs = subsec.numsegs;
+    const rvsubsecbounds_t& subsecBounds = gpRvSubsecBounds[subsecIdx];
+    const bool bSubsecIsOffscreen = RV_IsBoxOutsideFrustum(subsecBounds.minX, subsecBounds.minY, subsecBounds.maxX, subsecBounds.maxY);
 
     for (uint32_t segIdx = 0; segIdx < numSegs; ++segIdx) {
         // Firstly, clear the line segment flags
@@ -159,7 +164,7 @@ static void RV_VisitSubsec(const int32_t subsecIdx) noexcept {
         // Get the area of the screen that the seg covers in normalized device coords, and whether it's onscreen (within the view frustum)
         float segLx = {};
         float segRx = {};
-        const bool bSegIsOnscreen = RV_GetLineNdcBounds(p1f[0], p1f[1], p2f[0], p2f[1], segLx, segRx);
+        const bool bSegIsOnscreen = ((!bSubsecIsOffscreen) && RV_GetLineNdcBounds(p1f[0], p1f[1], p2f[0], p2f[1], segLx, segRx));
 
         // Determine and mark if any part of the seg is actually visible, ignoring whether it is backfacing or not
         const bool bSegIsVisible = (bSegIsOnscreen && RV_IsRangeVisible(segLx, segRx));
@@ -168,11 +173,9 @@ static void RV_VisitSubsec(const int32_t subsecIdx) noexcept {
             seg.flags |= SGF_VISIBLE_COLS;
         }
 
-        // Determine whether this type of seg can potentially occlude for the purposes of visibility
-        const bool bIsOccludingSegType = RV_IsOccludingSeg(seg, frontSector);
-
-        // Make the seg occlude if it's the type of seg that occludes, it's not backfacing (so we can see via noclip) and if it's visible
-        const bool bMakeSegOcclude = (bSegIsFrontFacing && bSegIsVisible && bIsOccludingSegType);
+        // Make the seg occlude if it's the type of seg that occludes, it's not backfacing (so we can see via noclip) and if it's visible.
+        // Only determine whether this type of seg can potentially occlude if the other checks pass, since that is the most expensive test.
+        const bool bMakeSegOcclude = (bSegIsFrontFacing && bSegIsVisible && RV_IsOccludingSeg(seg, frontSector));
 
         if (bMakeSegOcclude) {
             RV_OccludeRange(segLx, segRx);
@@ -254,21 +257,22 @@ static void RV_VisitBspNode(const int32_t nodeIdx) noexcept {
         const float lprod = RV_FixedToFloat(node.line.dx) * dy;
         const float rprod = RV_FixedToFloat(node.line.dy) * dx;
 
-        // Depending on which side of the halfspace we are on, reverse the traversal order:
+        // Depending on which side of the halfspace we are on, reverse the traversal order.
+        // Children which can never be seen from the view sector (according to the PVS) are skipped before doing any occlusion tests.
         if (lprod < rprod) {
-            if (RV_NodeBBVisible(node.bbox[0])) {
+            if (RV_IsBspNodeInPvs(node.children[0]) && RV_NodeBBVisible(node.bbox[0])) {
                 RV_VisitBspNode(node.children[0]);
             }
 
-            if (RV_NodeBBVisible(node.bbox[1])) {
+            if (RV_IsBspNodeInPvs(node.children[1]) && RV_NodeBBVisible(node.bbox[1])) {
                 RV_VisitBspNode(node.children[1]);
             }
         } else {
-            if (RV_NodeBBVisible(node.bbox[1])) {
+            if (RV_IsBspNodeInPvs(node.children[1]) && RV_NodeBBVisible(node.bbox[1])) {
                 RV_VisitBspNode(node.children[1]);
             }
 
-            if (RV_NodeBBVisible(node.bbox[0])) {
+            if (RV_IsBspNodeInPvs(node.children[0]) && RV_NodeBBVisible(node.bbox[0])) {
                 RV_VisitBspNode(node.children[0]);
             }
         }
@@ -279,13 +283,18 @@ static void RV_VisitBspNode(const int32_t nodeIdx) noexcept {
 // Start traversing the BSP tree from the root using the current viewpoint and find what subsectors are to be drawn
 //------------------------------------------------------------------------------------------------------------------------------------------
 void RV_BuildDrawSubsecList() noexcept {
+    PROFILE_SCOPE(BuildDrawSubsecList);
+
     // Prepare the draw subsectors list and prealloc enough memory
-    gRvDrawSubsecs.clear();
+    VFrameArena::resetVector(gRvDrawSubsecs);
     gRvDrawSubsecs.reserve(gNumSubsectors);
 
     // Initially assume the sky is not visible
     gbIsSkyVisible = false;
 
+    // Decide which sectors might be visible from the view position, if using a PVS
+    RV_UpdatePvsForView();
+
     // Traverse the BSP tree, starting at the root
     const int32_t bspRootNodeIdx = gNumBspNodes - 1;
     RV_VisitBspNode(bspRootNodeIdx);
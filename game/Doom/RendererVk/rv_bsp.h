@@ -2,11 +2,11 @@
 
 #if PSYDOOM_VULKAN_RENDERER
 
-#include <vector>
+#include "PsyDoom/Vulkan/VFrameArena.h"
 
 struct subsector_t;
 
-extern std::vector<subsector_t*> gRvDrawSubsecs;
+extern VFrameArena::FrameVector<subsector_t*> gRvDrawSubsecs;
 
 void RV_BuildDrawSubsecList() noexcept;
 
@@ -13,12 +13,19 @@
 #include "Doom/Game/p_setup.h"
 #include "Doom/Renderer/r_local.h"
 #include "PsyDoom/Video.h"
+#include "rv_pvs.h"
+#include "rv_sprites.h"
 #include "rv_utils.h"
+#include "rv_walls.h"
 
+#include <algorithm>
+#include <cfloat>
 #include <cmath>
 
-std::unique_ptr<rvseg_t[]>          gpRvSegs;           // The Vulkan renderer version of segs: same count as in 'p_setup.cpp'
-std::unique_ptr<rvleafedge_t[]>     gpRvLeafEdges;      // The Vulkan renderer version of leaf edges: same count as in 'p_setup.cpp'
+std::unique_ptr<rvseg_t[]>              gpRvSegs;           // The Vulkan renderer version of segs: same count as in 'p_setup.cpp'
+std::unique_ptr<rvleafedge_t[]>         gpRvLeafEdges;      // The Vulkan renderer version of leaf edges: same count as in 'p_setup.cpp'
+std::unique_ptr<rvflattri_t[]>          gpRvFlatTris;       // Triangles for drawing subsector floors and ceilings: same count as leaf edges
+std::unique_ptr<rvsubsecbounds_t[]>     gpRvSubsecBounds;   // Bounding boxes for the segs of each subsector: same count as subsectors
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Initializes the list of segs for the Vulkan renderer
@@ -77,6 +84,75 @@ static void RV_InitLeafEdges() noexcept {
     }
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Initializes the triangles used to draw the floors and ceilings of all subsectors.
+// Each subsector is triangulated as a triangle fan, which is possible since subsectors are convex.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void RV_InitFlatTris() noexcept {
+    gpRvFlatTris.reset(new rvflattri_t[gTotalNumLeafEdges]);
+
+    for (int32_t subsecIdx = 0; subsecIdx < gNumSubsectors; ++subsecIdx) {
+        const subsector_t& subsec = gpSubsectors[subsecIdx];
+        const uint16_t numLeafEdges = subsec.numLeafEdges;
+
+        // Ignore degenerate subsectors: these are not drawn
+        if (numLeafEdges <= 2)
+            continue;
+
+        // Figure out a point to act as the center of the triangle fan for the subsector.
+        // Just use the first 3 points in the subsector, we don't need to average the whole lot...
+        const rvleafedge_t* const pLeafEdges = gpRvLeafEdges.get() + subsec.firstLeafEdge;
+        const rvleafedge_t& e1 = pLeafEdges[0];
+        const rvleafedge_t& e2 = pLeafEdges[1];
+        const rvleafedge_t& e3 = pLeafEdges[2];
+        const float triFanCenterX = (e1.v1x + e2.v1x + e3.v1x) * (1.0f / 3.0f);
+        const float triFanCenterZ = (e1.v1y + e2.v1y + e3.v1y) * (1.0f / 3.0f);
+
+        // Make a triangle from each edge to the center point
+        rvflattri_t* const pFlatTris = gpRvFlatTris.get() + subsec.firstLeafEdge;
+
+        for (uint16_t edgeIdx = 0; edgeIdx < numLeafEdges; ++edgeIdx) {
+            const rvleafedge_t& edge = pLeafEdges[edgeIdx];
+            const rvleafedge_t& nextEdge = pLeafEdges[(edgeIdx + 1) % numLeafEdges];
+
+            rvflattri_t& tri = pFlatTris[edgeIdx];
+            tri.x1 = edge.v1x;
+            tri.z1 = edge.v1y;
+            tri.x2 = nextEdge.v1x;
+            tri.z2 = nextEdge.v1y;
+            tri.xc = triFanCenterX;
+            tri.zc = triFanCenterZ;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Initializes the bounding boxes for the segs of all subsectors.
+// Subsectors without any segs are given an inverted (empty) box.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void RV_InitSubsecBounds() noexcept {
+    gpRvSubsecBounds.reset(new rvsubsecbounds_t[gNumSubsectors]);
+
+    for (int32_t subsecIdx = 0; subsecIdx < gNumSubsectors; ++subsecIdx) {
+        const subsector_t& subsec = gpSubsectors[subsecIdx];
+        const rvseg_t* const pSegs = gpRvSegs.get() + subsec.firstseg;
+
+        rvsubsecbounds_t& bounds = gpRvSubsecBounds[subsecIdx];
+        bounds.minX = +FLT_MAX;
+        bounds.minY = +FLT_MAX;
+        bounds.maxX = -FLT_MAX;
+        bounds.maxY = -FLT_MAX;
+
+        for (int32_t segIdx = 0; segIdx < subsec.numsegs; ++segIdx) {
+            const rvseg_t& seg = pSegs[segIdx];
+            bounds.minX = std::min({ bounds.minX, seg.v1x, seg.v2x });
+            bounds.minY = std::min({ bounds.minY, seg.v1y, seg.v2y });
+            bounds.maxX = std::max({ bounds.maxX, seg.v1x, seg.v2x });
+            bounds.maxY = std::max({ bounds.maxY, seg.v1y, seg.v2y });
+        }
+    }
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Initialize data-structures used by the Vulkan renderer on level startup
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -91,6 +167,12 @@ void RV_InitLevelData() noexcept {
     // Initialize basic data structures
     RV_InitSegs();
     RV_InitLeafEdges();
+    RV_InitFlatTris();
+    RV_InitSubsecBounds();
+    RV_InitWallCache();
+
+    // Compute which sectors can potentially see each other (if enabled)
+    RV_InitPvs();
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -101,6 +183,11 @@ void RV_FreeLevelData() noexcept {
     if (Video::gBackendType != Video::BackendType::Vulkan)
         return;
 
+    RV_ClearSpriteSplitCache();
+    RV_FreeWallCache();
+    RV_FreePvs();
+    gpRvSubsecBounds.reset();
+    gpRvFlatTris.reset();
     gpRvLeafEdges.reset();
     gpRvSegs.reset();
 }
@@ -33,8 +33,29 @@ struct rvleafedge_t {
     rvseg_t*    seg;        // The seg associated with the edge
 };
 
-extern std::unique_ptr<rvseg_t[]>       gpRvSegs;
-extern std::unique_ptr<rvleafedge_t[]>  gpRvLeafEdges;
+//------------------------------------------------------------------------------------------------------------------------------------------
+// A precomputed triangle for drawing the floor or ceiling of a subsector, on the XZ plane for the Vulkan renderer.
+// Each subsector is drawn as a triangle fan with one triangle per leaf edge, so there is 1 of these per leaf edge and the same indexing is
+// used for both. The height and texture coordinates for the triangle are derived from the sector when drawing.
+//------------------------------------------------------------------------------------------------------------------------------------------
+struct rvflattri_t {
+    float       x1, z1;     // The 1st vertex of the leaf edge for the triangle
+    float       x2, z2;     // The 2nd vertex of the leaf edge for the triangle (the 1st vertex of the next edge)
+    float       xc, zc;     // The center point of the triangle fan for the subsector
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// The bounding box of all the segs in a subsector, used to quickly reject subsectors which are entirely outside of the view frustum
+//------------------------------------------------------------------------------------------------------------------------------------------
+struct rvsubsecbounds_t {
+    float   minX, minY;     // Bottom left of the box (Doom world coord system)
+    float   maxX, maxY;     // Top right of the box (Doom world coord system)
+};
+
+extern std::unique_ptr<rvseg_t[]>           gpRvSegs;
+extern std::unique_ptr<rvleafedge_t[]>      gpRvLeafEdges;
+extern std::unique_ptr<rvflattri_t[]>       gpRvFlatTris;
+extern std::unique_ptr<rvsubsecbounds_t[]>  gpRvSubsecBounds;
 
 void RV_InitLevelData() noexcept;
 void RV_FreeLevelData() noexcept;
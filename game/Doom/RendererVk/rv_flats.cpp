@@ -19,28 +19,6 @@
 
 #include <cmath>
 
-static int32_t gNextFloorDrawSubsecIdx;     // Index of the next draw subsector to have its floor drawn
-static int32_t gNextCeilDrawSubsecIdx;      // Index of the next draw subsector to have its ceiling drawn
-
-//------------------------------------------------------------------------------------------------------------------------------------------
-// Figures out a 2D point (on the XZ plane) to act as the center of a triangle fan type arrangement for the subsector.
-// The subsector is convex so we should be able to do a triangle fan from this point to every other subector edge, in order to fill it.
-// N.B: assumes the subsector has at least 3 leaf edges!
-//------------------------------------------------------------------------------------------------------------------------------------------
-static void RV_CalcSubsecTriFanCenter(
-    const rvleafedge_t* const pLeafEdges,
-    float& triFanCenterX,
-    float& triFanCenterZ
-) noexcept {
-    // Just use the first 3 points in the subsector, we don't need to average the whole lot...
-    ASSERT(pLeafEdges);
-    const rvleafedge_t& e1 = pLeafEdges[0];
-    const rvleafedge_t& e2 = pLeafEdges[1];
-    const rvleafedge_t& e3 = pLeafEdges[2];
-    triFanCenterX = (e1.v1x + e2.v1x + e3.v1x) * (1.0f / 3.0f);
-    triFanCenterZ = (e1.v1y + e2.v1y + e3.v1y) * (1.0f / 3.0f);
-}
-
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Draw a floor or ceiling plane for the given subsector
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -63,14 +41,10 @@ static void RV_DrawPlane(
     uint16_t texWinW, texWinH;
     RV_GetTexWinXyWh(tex, texWinX, texWinY, texWinW, texWinH);
 
-    // Get the xz point to use as the center of a triangle fan for the subsector
-    const rvleafedge_t* const pLeafEdges = gpRvLeafEdges.get() + subsec.firstLeafEdge;
-    const uint16_t numLeafEdges = subsec.numLeafEdges;
-    ASSERT(numLeafEdges >= 3);
-
-    float triFanCenterX;
-    float triFanCenterZ;
-    RV_CalcSubsecTriFanCenter(pLeafEdges, triFanCenterX, triFanCenterZ);
+    // Get the triangles for the subsector, which were precomputed on level startup
+    const rvflattri_t* const pFlatTris = gpRvFlatTris.get() + subsec.firstLeafEdge;
+    const uint16_t numFlatTris = subsec.numLeafEdges;
+    ASSERT(numFlatTris >= 3);
 
     // Get the texture offset for the sector and wrap the offset to be within the texture's bounds (for precision purposes).
     // Note: this code assumes the floor texture dimensions are a power of two, which should always be the case for all textures.
@@ -94,14 +68,15 @@ static void RV_DrawPlane(
 
     // Do all the triangles for the plane.
     // Note that all draw calls assume that the correct pipeline has already been set beforehand.
-    for (uint16_t edgeIdx = 0; edgeIdx < numLeafEdges; ++edgeIdx) {
-        // Get the edge coords
-        const rvleafedge_t& e1 = pLeafEdges[edgeIdx];
-        const rvleafedge_t& e2 = pLeafEdges[(edgeIdx + 1) % numLeafEdges];
-        const float x1 = e1.v1x;
-        const float z1 = e1.v1y;
-        const float x2 = e2.v1x;
-        const float z2 = e2.v1y;
+    for (uint16_t triIdx = 0; triIdx < numFlatTris; ++triIdx) {
+        // Get the triangle coords
+        const rvflattri_t& tri = pFlatTris[triIdx];
+        const float x1 = tri.x1;
+        const float z1 = tri.z1;
+        const float x2 = tri.x2;
+        const float z2 = tri.z2;
+        const float triFanCenterX = tri.xc;
+        const float triFanCenterZ = tri.zc;
 
         // Draw the triangle: note that UV coords are just the vertex coords (scaled in the case of U) - no offsetting to worry about here.
         // For ceilings as well reverse the winding order so backface culling works OK.
@@ -169,114 +144,111 @@ static void RV_DrawFlat(const subsector_t& subsec, const bool bDrawFloor, const
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Must be called before drawing subsectors and their flats.
-// Initializes which subsector floor and ceiling is to be drawn next.
+// Tells if the floor or ceiling of the given draw subsector can be batched with the floor or ceiling of the draw subsector drawn after it.
+// Batches must be ended where the height or sky status changes, or where one of the subsectors does not allow flat batching.
 //------------------------------------------------------------------------------------------------------------------------------------------
-void RV_InitNextDrawFlats() noexcept {
-    const int32_t lastSubsecIdx = (int32_t) gRvDrawSubsecs.size() - 1;
-    gNextFloorDrawSubsecIdx = lastSubsecIdx;
-    gNextCeilDrawSubsecIdx = lastSubsecIdx;
+template <bool IsFloor>
+static bool RV_CanBatchFlatWithNext(const int32_t drawSubsecIdx) noexcept {
+    // Stop if there is no next draw sector, if this subsector (or the next) is not batchable
+    if (drawSubsecIdx <= 0)
+        return false;
+
+    const subsector_t& subsec = *gRvDrawSubsecs[drawSubsecIdx];
+    const subsector_t& nextSubsec = *gRvDrawSubsecs[drawSubsecIdx - 1];
+    const bool bAllowBatching = (subsec.bVkCanBatchFlats && nextSubsec.bVkCanBatchFlats);
+
+    if (!bAllowBatching)
+        return false;
+
+    // Stop if the height changes
+    const sector_t& sector = *subsec.sector;
+    const sector_t& nextSector = *nextSubsec.sector;
+    const fixed_t planeH = (IsFloor) ? sector.floorDrawH : sector.ceilingDrawH;
+    const fixed_t nextPlaneH = (IsFloor) ? nextSector.floorDrawH : nextSector.ceilingDrawH;
+
+    if (nextPlaneH != planeH)
+        return false;
+
+    // Also break the batch if there is a change in sky floor or ceiling status.
+    // If we don't do this then sky walls can sometimes bleed through to other neighboring floors or ceilings:
+    const bool bIsSkyPlane = (((IsFloor) ? sector.floorpic : sector.ceilingpic) == -1);
+    const bool bIsNextSkyPlane = (((IsFloor) ? nextSector.floorpic : nextSector.ceilingpic) == -1);
+    return (bIsSkyPlane == bIsNextSkyPlane);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Draws floors starting at the given draw subsector index. Tries to batch together as many similar floors (same height) as possible.
-// We draw flats in this way to try and avoid artifacts where sprites that extend into the floor/ceiling get cut off by neighboring flats.
-// Sprites which exhibit this problem are explosions and fireballs. Merging flat planes helps avoid it.
+// Draws floors or ceilings starting at the given draw subsector index, if it is the first draw subsector in a batch of similar flats.
+// Otherwise the flat has already been drawn as part of the batch that it belongs to.
+//
+// Note: whether a draw subsector begins a batch depends only on it and the draw subsector drawn before it, so this can be called for
+// draw subsectors in any order or in parallel (provided the vertices are captured and submitted in the usual order).
 //------------------------------------------------------------------------------------------------------------------------------------------
-void RV_DrawSubsecFloors(const int32_t fromDrawSubsecIdx) noexcept {
+template <bool IsFloor>
+static void RV_DrawSubsecFlats(const int32_t fromDrawSubsecIdx) noexcept {
     ASSERT((fromDrawSubsecIdx >= 0) && (fromDrawSubsecIdx < (int32_t) gRvDrawSubsecs.size()));
 
-    // If we've already drawn the floors for this subsector then we are done
-    if (gNextFloorDrawSubsecIdx != fromDrawSubsecIdx)
+    // If the flat for this subsector is part of the batch started by the previously drawn subsector then it's already drawn
+    const int32_t numDrawSubsecs = (int32_t) gRvDrawSubsecs.size();
+
+    if ((fromDrawSubsecIdx + 1 < numDrawSubsecs) && RV_CanBatchFlatWithNext<IsFloor>(fromDrawSubsecIdx + 1))
         return;
 
-    while (true) {
+    for (int32_t drawSubsecIdx = fromDrawSubsecIdx; ; --drawSubsecIdx) {
         // Get the light/color value for the sector
-        const subsector_t& subsec = *gRvDrawSubsecs[gNextFloorDrawSubsecIdx];
+        const subsector_t& subsec = *gRvDrawSubsecs[drawSubsecIdx];
         const sector_t& sector = *subsec.sector;
+        const fixed_t planeH = (IsFloor) ? sector.floorDrawH : sector.ceilingDrawH;
 
         uint8_t secR;
         uint8_t secG;
         uint8_t secB;
-        R_GetSectorDrawColor(sector, sector.floorDrawH, secR, secG, secB);
+        R_GetSectorDrawColor(sector, planeH, secR, secG, secB);
 
-        // Draw the floor
-        RV_DrawFlat(subsec, true, secR, secG, secB);
-        gNextFloorDrawSubsecIdx--;
+        // Draw the floor or ceiling
+        RV_DrawFlat(subsec, IsFloor, secR, secG, secB);
 
         // Should we end the draw batch here?
-        // Stop if there is no next draw sector, if this subsector (or the next) is not batchable or if the floor height changes.
-        if (gNextFloorDrawSubsecIdx < 0)
-            break;
-
-        const subsector_t& nextSubsec = *gRvDrawSubsecs[gNextFloorDrawSubsecIdx];
-        const sector_t& nextSector = *nextSubsec.sector;
-        const bool bAllowBatching = (subsec.bVkCanBatchFlats && nextSubsec.bVkCanBatchFlats);
-
-        if (!bAllowBatching)
-            break;
-
-        if (nextSector.floorDrawH != sector.floorDrawH)
-            break;
-
-        // Also break the batch if there is a change in sky floor status.
-        // If we don't do this then sky walls can sometimes bleed through to other neighboring floors:
-        const bool bIsSkyFloor = (sector.floorpic == -1);
-        const bool bIsNextSkyFloor = (nextSector.floorpic == -1);
-
-        if (bIsSkyFloor != bIsNextSkyFloor)
+        if (!RV_CanBatchFlatWithNext<IsFloor>(drawSubsecIdx))
             break;
     }
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Draws floors starting at the given draw subsector index. Tries to batch together as many similar floors (same height) as possible.
+// We draw flats in this way to try and avoid artifacts where sprites that extend into the floor/ceiling get cut off by neighboring flats.
+// Sprites which exhibit this problem are explosions and fireballs. Merging flat planes helps avoid it.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void RV_DrawSubsecFloors(const int32_t fromDrawSubsecIdx) noexcept {
+    RV_DrawSubsecFlats<true>(fromDrawSubsecIdx);
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Draws ceilings starting at the given draw subsector index. Tries to batch together as many similar ceilings (same height) as possible.
 // We draw flats in this way to try and avoid artifacts where sprites that extend into the floor/ceiling get cut off by neighboring flats.
 // Sprites which exhibit this problem are explosions and fireballs. Merging flat planes helps avoid it.
 //------------------------------------------------------------------------------------------------------------------------------------------
 void RV_DrawSubsecCeilings(const int32_t fromDrawSubsecIdx) noexcept {
-    ASSERT((fromDrawSubsecIdx >= 0) && (fromDrawSubsecIdx < (int32_t) gRvDrawSubsecs.size()));
-
-    // If we've already drawn the ceilings for this subsector then we are done
-    if (gNextCeilDrawSubsecIdx != fromDrawSubsecIdx)
-        return;
-
-    while (true) {
-        // Get the light/color value for the sector
-        const subsector_t& subsec = *gRvDrawSubsecs[gNextCeilDrawSubsecIdx];
-        const sector_t& sector = *subsec.sector;
-
-        uint8_t secR;
-        uint8_t secG;
-        uint8_t secB;
-        R_GetSectorDrawColor(sector, sector.ceilingDrawH, secR, secG, secB);
-
-        // Draw the ceiling
-        RV_DrawFlat(subsec, false, secR, secG, secB);
-        gNextCeilDrawSubsecIdx--;
-
-        // Should we end the draw batch here?
-        // Stop if there is no next draw sector, if this subsector (or the next) is not batchable or if the ceiling height changes.
-        if (gNextCeilDrawSubsecIdx < 0)
-            break;
-
-        const subsector_t& nextSubsec = *gRvDrawSubsecs[gNextCeilDrawSubsecIdx];
-        const sector_t& nextSector = *nextSubsec.sector;
-        const bool bAllowBatching = (subsec.bVkCanBatchFlats && nextSubsec.bVkCanBatchFlats);
-
-        if (!bAllowBatching)
-            break;
-
-        if (nextSector.ceilingDrawH != sector.ceilingDrawH)
-            break;
+    RV_DrawSubsecFlats<false>(fromDrawSubsecIdx);
+}
 
-        // Also break the batch if there is a change in sky ceiling status.
-        // If we don't do this then sky walls can sometimes bleed through to other neighboring ceilings:
-        const bool bIsSkyCeil = (sector.ceilingpic == -1);
-        const bool bIsNextSkyCeil = (nextSector.ceilingpic == -1);
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Does all the work for drawing the floor and ceiling of the given subsector which modifies shared state: uploads any floor or ceiling
+// textures which need to be uploaded to VRAM and resolves texture offset interpolation (which may modify the offsets).
+// This allows the flats to then be drawn in parallel.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void RV_PrepSubsecFlatsDraw(const subsector_t& subsec) noexcept {
+    sector_t& sector = *subsec.sector;
+    sector.floorTexOffsetX.renderValue();
+    sector.floorTexOffsetY.renderValue();
+    sector.ceilTexOffsetX.renderValue();
+    sector.ceilTexOffsetY.renderValue();
+
+    if (sector.floorpic >= 0) {
+        RV_UploadDirtyTex(gpFlatTextures[gpFlatTranslation[sector.floorpic]]);
+    }
 
-        if (bIsSkyCeil != bIsNextSkyCeil)
-            break;
+    if (sector.ceilingpic >= 0) {
+        RV_UploadDirtyTex(gpFlatTextures[gpFlatTranslation[sector.ceilingpic]]);
     }
 }
 
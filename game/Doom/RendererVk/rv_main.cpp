@@ -17,9 +17,12 @@
 #include "Doom/Renderer/r_sky.h"
 #include "Doom/Renderer/r_things.h"
 #include "PsyDoom/Config/Config.h"
+#include "PsyDoom/JobSystem.h"
 #include "PsyDoom/PlayerPrefs.h"
 #include "PsyDoom/Utils.h"
 #include "PsyDoom/Vulkan/VDrawing.h"
+#include "PsyDoom/Vulkan/VFrameArena.h"
+#include "PsyDoom/Vulkan/VRenderPath_Main.h"
 #include "PsyDoom/Vulkan/VRenderer.h"
 #include "PsyDoom/Vulkan/VTypes.h"
 #include "PsyQ/LIBGPU.h"
@@ -31,6 +34,8 @@
 #include "rv_utils.h"
 #include "rv_walls.h"
 
+#include <vector>
+
 float           gViewXf, gViewYf, gViewZf;      // View position in floating point format
 float           gViewAnglef;                    // View angle in radians (float)
 float           gViewCosf, gViewSinf;           // Sin and cosine for view angle
@@ -39,6 +44,27 @@ Matrix4f        gSpriteBillboardMatrix;         // A transform matrix containing
 Matrix4f        gViewProjMatrix;                // The combined view and projection transform matrix for the scene
 VPipelineType   gOpaqueGeomPipeline;            // The pipeline to use for drawing opaque geometry
 
+// If there are at least this many subsectors to be drawn (and there are job worker threads) then opaque walls and flats are generated in
+// parallel. Below this amount the overhead of distributing the work is not worth it.
+static constexpr int32_t MIN_PARALLEL_DRAW_SUBSECS = 64;
+
+// Where the opaque wall and flat vertices for a draw subsector were captured to, when generating them in parallel
+struct RvCapturedGeom {
+    const std::vector<VVertex_Draw>*    pVerts;         // The list the vertices were captured to
+    uint32_t                            firstVert;      // Index of the first vertex in the list
+    uint32_t                            numVerts;       // Number of vertices captured
+};
+
+// Per-thread list of captured vertices and the frame it was last cleared for
+struct RvThreadCapturedVerts {
+    std::vector<VVertex_Draw>   verts;
+    uint32_t                    frameNum = UINT32_MAX;
+};
+
+static VFrameArena::FrameVector<RvCapturedGeom>     gRvCapturedGeom;            // Captured opaque geometry for each draw subsector
+static uint32_t                                     gRvCaptureFrameNum;         // Incremented each time geometry is generated in parallel
+static thread_local RvThreadCapturedVerts           gRvThreadCapturedVerts;     // The list of captured vertices for the current thread
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Determine various parameters affecting the draw, including view position, projection matrix and so on
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -160,6 +186,150 @@ static void RV_SetShaderUniformsFor3D() noexcept {
     VDrawing::setDrawUniforms(uniforms);
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Job which generates the opaque walls and flats for one draw subsector, capturing the vertices instead of adding them to the frame.
+// This is the same geometry as added by the 'RV_DrawSubsecOpaqueWalls', 'RV_DrawSubsecFloors' and 'RV_DrawSubsecCeilings' calls.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void RV_CaptureSubsecOpaqueGeom(const uint32_t jobIdx, [[maybe_unused]] void* const pUserData) noexcept {
+    // Start a new list of captured vertices for this thread if this is the first job it has done this frame
+    RvThreadCapturedVerts& threadVerts = gRvThreadCapturedVerts;
+
+    if (threadVerts.frameNum != gRvCaptureFrameNum) {
+        threadVerts.verts.clear();
+        threadVerts.frameNum = gRvCaptureFrameNum;
+    }
+
+    // Capture the geometry and save where it went
+    const int32_t drawSubsecIdx = (int32_t) jobIdx;
+    subsector_t& subsec = *gRvDrawSubsecs[drawSubsecIdx];
+    const uint32_t firstVert = (uint32_t) threadVerts.verts.size();
+
+    VDrawing::beginWorldVertsCapture(threadVerts.verts);
+    RV_DrawSubsecOpaqueWalls(subsec);
+    RV_DrawSubsecFloors(drawSubsecIdx);
+    RV_DrawSubsecCeilings(drawSubsecIdx);
+    VDrawing::endWorldVertsCapture();
+
+    RvCapturedGeom& geom = gRvCapturedGeom[jobIdx];
+    geom.pVerts = &threadVerts.verts;
+    geom.firstVert = firstVert;
+    geom.numVerts = (uint32_t) threadVerts.verts.size() - firstVert;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Generates the opaque walls and flats for all draw subsectors in parallel, using the job system.
+// The vertices for each draw subsector are captured so they can be added to the frame later, in the usual order.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void RV_GenerateOpaqueGeomInParallel() noexcept {
+    // First do all of the work which modifies shared state on this thread, so that the jobs only need to read shared state
+    const int32_t numDrawSubsecs = (int32_t) gRvDrawSubsecs.size();
+
+    for (int32_t drawSubsecIdx = 0; drawSubsecIdx < numDrawSubsecs; ++drawSubsecIdx) {
+        subsector_t& subsec = *gRvDrawSubsecs[drawSubsecIdx];
+        R_UpdateShadingParams(*subsec.sector);
+        RV_PrepSubsecOpaqueWallsDraw(subsec);
+        RV_PrepSubsecFlatsDraw(subsec);
+    }
+
+    // Generate the geometry for each draw subsector
+    VFrameArena::resetVector(gRvCapturedGeom);
+    gRvCapturedGeom.resize((size_t) numDrawSubsecs);
+    gRvCaptureFrameNum++;
+    JobSystem::runJobs((uint32_t) numDrawSubsecs, RV_CaptureSubsecOpaqueGeom, nullptr);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Adds the opaque walls and flats for a draw subsector to the frame, after they have been generated by 'RV_GenerateOpaqueGeomInParallel'
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void RV_DrawSubsecCapturedOpaqueGeom(const int32_t drawSubsecIdx) noexcept {
+    const RvCapturedGeom& geom = gRvCapturedGeom[drawSubsecIdx];
+
+    if (geom.numVerts > 0) {
+        VDrawing::setDrawPipeline(gOpaqueGeomPipeline);
+        VDrawing::addWorldVerts(geom.pVerts->data() + geom.firstVert, geom.numVerts);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Draws all of the subsectors back to front, relying on the drawing order alone to resolve visibility
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void RV_DrawSubsecsBackToFront(const bool bParallelOpaqueGeom) noexcept {
+    const int32_t numDrawSubsecs = (int32_t) gRvDrawSubsecs.size();
+
+    for (int32_t drawSubsecIdx = numDrawSubsecs - 1; drawSubsecIdx >= 0; --drawSubsecIdx) {
+        // Make sure the shading params for the sector are up to date
+        subsector_t& subsec = *gRvDrawSubsecs[drawSubsecIdx];
+        sector_t& sector = *subsec.sector;
+        R_UpdateShadingParams(sector);
+
+        // Draw all subsector sky walls, blended and masked walls
+        RV_DrawSubsecSkyWalls(drawSubsecIdx);
+        RV_DrawSubsecBlendedWalls(subsec);
+
+        // Draw all subsector opaque elements and then sprites on top of that.
+        // Most of the time these should all be on the same draw pipeline, so we can do batching.
+        if (bParallelOpaqueGeom) {
+            RV_DrawSubsecCapturedOpaqueGeom(drawSubsecIdx);
+        } else {
+            RV_DrawSubsecOpaqueWalls(subsec);
+            RV_DrawSubsecFloors(drawSubsecIdx);
+            RV_DrawSubsecCeilings(drawSubsecIdx);
+        }
+
+        RV_DrawSubsecSpriteFrags(drawSubsecIdx);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Draws all of the subsectors using the depth buffer: opaque geometry is drawn front to back first, so that hidden pixels are rejected by
+// the depth test instead of being shaded and then overdrawn. Sky walls, blended walls and sprites are then drawn back to front on top.
+//
+// Each draw subsector is drawn at a fixed depth according to it's position in the draw order, rather than the depth of the geometry itself.
+// This makes the depth test reproduce the exact same result as drawing everything back to front, including all of the cases where the
+// original drawing order causes elements (such as sprites poking into walls or batched flats) to overlap in a particular way.
+// For draw subsector 'i' (where '0' is the closest) opaque geometry and sprites are drawn at slot '2i + 1' and sky and blended walls at
+// slot '2i + 2', so that they end up behind the opaque geometry of their own subsector but in front of everything further away.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void RV_DrawSubsecsDepthTested(const bool bParallelOpaqueGeom) noexcept {
+    const int32_t numDrawSubsecs = (int32_t) gRvDrawSubsecs.size();
+    const float depthSlotSize = 1.0f / (float)(2 * numDrawSubsecs + 2);
+
+    VDrawing::setWorldDepthTestEnabled(true);
+
+    // Draw all subsector opaque elements front to back, writing to the depth buffer
+    for (int32_t drawSubsecIdx = 0; drawSubsecIdx < numDrawSubsecs; ++drawSubsecIdx) {
+        subsector_t& subsec = *gRvDrawSubsecs[drawSubsecIdx];
+        R_UpdateShadingParams(*subsec.sector);
+        VDrawing::setDrawDepth((float)(2 * drawSubsecIdx + 1) * depthSlotSize);
+
+        if (bParallelOpaqueGeom) {
+            RV_DrawSubsecCapturedOpaqueGeom(drawSubsecIdx);
+        } else {
+            RV_DrawSubsecOpaqueWalls(subsec);
+            RV_DrawSubsecFloors(drawSubsecIdx);
+            RV_DrawSubsecCeilings(drawSubsecIdx);
+        }
+    }
+
+    // Draw all subsector sky walls, blended and masked walls and sprites back to front, testing against the depth buffer
+    for (int32_t drawSubsecIdx = numDrawSubsecs - 1; drawSubsecIdx >= 0; --drawSubsecIdx) {
+        subsector_t& subsec = *gRvDrawSubsecs[drawSubsecIdx];
+        R_UpdateShadingParams(*subsec.sector);
+
+        VDrawing::setDrawDepth((float)(2 * drawSubsecIdx + 2) * depthSlotSize);
+        RV_DrawSubsecSkyWalls(drawSubsecIdx);
+        RV_DrawSubsecBlendedWalls(subsec);
+
+        VDrawing::setDrawDepth((float)(2 * drawSubsecIdx + 1) * depthSlotSize);
+        RV_DrawSubsecSpriteFrags(drawSubsecIdx);
+    }
+
+    // Go back to drawing normally
+    VDrawing::endCurrentDrawBatch();
+    VDrawing::setDrawDepth(-1.0f);
+    VDrawing::setWorldDepthTestEnabled(false);
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Renders the player's view.
 // Some of the high level logic here is copied from the original renderer's 'R_RenderPlayerView'.
@@ -169,8 +339,10 @@ void RV_RenderPlayerView() noexcept {
     if (!VRenderer::isRendering())
         return;
 
-    // Increment the marker used to determine when to update the 'draw height' for each sector
+    // Increment the marker used to determine when to update the 'draw height' for each sector.
+    // Then compute the interpolated draw heights for all sectors in one pass, so BSP traversal can just read them.
     gValidCount++;
+    R_UpdateAllSectorDrawHeights();
 
     // Determine various draw settings and clear x-axis occlusion info to start with.
     // Then traverse the BSP tree to determine what needs to be drawn and in what order
@@ -181,9 +353,8 @@ void RV_RenderPlayerView() noexcept {
     // Build the list of sprite fragments to be drawn for each subsector
     RV_BuildSpriteFragLists();
 
-    // Init which subsectors are to have flats and sky walls drawn next.
-    // We try and batch all those for performance reasons, and also to avoid visual artifacts with sprite clipping.
-    RV_InitNextDrawFlats();
+    // Init which subsectors are to have sky walls drawn next.
+    // We try and batch those (and flats) for performance reasons, and also to avoid visual artifacts with sprite clipping.
     RV_InitNextDrawSkyWalls();
 
     // Upload a new sky texture for this frame if required.
@@ -202,25 +373,26 @@ void RV_RenderPlayerView() noexcept {
     // Increment the marker used to determine when to update the shading params for each sector
     gValidCount++;
 
-    // Draw all of the subsectors back to front
+    // If there is a lot to draw then generate opaque walls and flats in parallel ahead of time, since they are the bulk of the geometry.
+    // Note: the geometry is still added to the frame in the same order as usual, so this does not change the output.
     const int32_t numDrawSubsecs = (int32_t) gRvDrawSubsecs.size();
+    const bool bParallelOpaqueGeom = ((JobSystem::getNumWorkerThreads() > 0) && (numDrawSubsecs >= MIN_PARALLEL_DRAW_SUBSECS));
 
-    for (int32_t drawSubsecIdx = numDrawSubsecs - 1; drawSubsecIdx >= 0; --drawSubsecIdx) {
-        // Make sure the shading params for the sector are up to date
-        subsector_t& subsec = *gRvDrawSubsecs[drawSubsecIdx];
-        sector_t& sector = *subsec.sector;
-        R_UpdateShadingParams(sector);
+    if (bParallelOpaqueGeom) {
+        RV_GenerateOpaqueGeomInParallel();
+    }
 
-        // Draw all subsector sky walls, blended and masked walls
-        RV_DrawSubsecSkyWalls(drawSubsecIdx);
-        RV_DrawSubsecBlendedWalls(subsec);
+    // Draw all of the subsectors: use the depth buffer to reject hidden opaque pixels if available.
+    // Note: x-ray vision draws 'opaque' geometry with alpha blending, so that must always be drawn back to front.
+    const bool bUseDepthTest = (
+        VRenderer::gRenderPath_Main.hasDepthAttachments() &&
+        (gOpaqueGeomPipeline == VPipelineType::World_GeomMasked)
+    );
 
-        // Draw all subsector opaque elements and then sprites on top of that.
-        // Most of the time these should all be on the same draw pipeline, so we can do batching.
-        RV_DrawSubsecOpaqueWalls(subsec);
-        RV_DrawSubsecFloors(drawSubsecIdx);
-        RV_DrawSubsecCeilings(drawSubsecIdx);
-        RV_DrawSubsecSpriteFrags(drawSubsecIdx);
+    if (bUseDepthTest) {
+        RV_DrawSubsecsDepthTested(bParallelOpaqueGeom);
+    } else {
+        RV_DrawSubsecsBackToFront(bParallelOpaqueGeom);
     }
 
     // Cleanup after drawing the world: need to clear the draw order for each drawn subsector
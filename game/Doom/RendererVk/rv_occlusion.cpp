@@ -9,14 +9,21 @@
 //  (3) Zero sized ranges are always considered NOT visible.
 //  (4) Occlusion ranges are merged when they touch or overlap to keep the list of ranges as small as possible.
 //      If there are two neighboring ranges in the list then there is guaranteed to be a gap between them.
+//  (5) Alternatively, if enabled via config, occlusion is tracked with a coverage buffer containing 1 bit per screen column.
+//      A range covers a column if it contains the center of the column, which matches how the GPU decides which pixels to draw.
+//      Marking and testing ranges then operates on 64 columns at a time, without any searching or list insertion.
 //------------------------------------------------------------------------------------------------------------------------------------------
 #include "rv_occlusion.h"
 
 #if PSYDOOM_VULKAN_RENDERER
 
 #include "Asserts.h"
+#include "PsyDoom/Config/Config.h"
+#include "PsyDoom/Vulkan/VFrameArena.h"
+#include "PsyDoom/Vulkan/VRenderer.h"
 
 #include <algorithm>
+#include <cmath>
 #include <vector>
 
 // Occlusion range: represents a range of the screen that is occluded/blocked by walls
@@ -26,11 +33,23 @@ struct OccRange {
 };
 
 // Convenience typedef
-typedef std::vector<OccRange>::iterator OccRangeIter;
+typedef VFrameArena::FrameVector<OccRange>::iterator OccRangeIter;
 
 // These are all of the ranges of the screen that are currently occluded.
 // The list is kept in sorted order and there is no overlapping or touching ranges (those are merged).
-std::vector<OccRange> gRvOccRanges;
+VFrameArena::FrameVector<OccRange> gRvOccRanges;
+
+// Coverage buffer: whether the coverage buffer is being used for the current frame instead of the list of occluded ranges.
+// This is decided at the start of each frame.
+static bool gbRvUseOccCoverage;
+
+// Coverage buffer: 1 bit for each screen column, set if the column is occluded.
+// Any bits past the last column (in the last word) are always set.
+static std::vector<uint64_t> gRvOccCoverage;
+
+// Coverage buffer: the number of screen columns and the number of columns per unit of normalized device coordinates
+static uint32_t     gRvOccCoverageNumCols;
+static float        gRvOccCoverageColsPerNdc;
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Return an iterator to the occlusion range that the given x value falls within.
@@ -93,13 +112,120 @@ static void RV_GrowOccRangeTo(OccRangeIter rangeIter, const float newXMax) noexc
     }
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Coverage buffer: clears the coverage buffer and sizes it so that there is 1 bit for each column of pixels in the 3D view viewport
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void RV_ClearOccCoverage() noexcept {
+    // Figure out the width of the viewport in pixels; this must match the viewport setup done by 'VDrawing'.
+    // Note that widescreen (if enabled) extends the viewport horizontally to fill the entire framebuffer.
+    const bool bAllowWidescreen = Config::gbVulkanWidescreenEnabled;
+    const float viewportX = (bAllowWidescreen) ? 0 : VRenderer::gPsxCoordsFbX;
+    const float viewportW = (bAllowWidescreen) ? (float) VRenderer::gFramebufferW : VRenderer::gPsxCoordsFbW;
+    const int32_t viewportWInt = (int32_t)(viewportX + viewportW) - (int32_t)(viewportX);
+
+    const uint32_t numCols = (uint32_t) std::max(viewportWInt, 1);
+    const uint32_t numWords = (numCols + 63) / 64;
+    gRvOccCoverageNumCols = numCols;
+    gRvOccCoverageColsPerNdc = (float) numCols * 0.5f;
+
+    // Clear all bits but mark the unused bits at the end of the last word as occluded
+    gRvOccCoverage.assign(numWords, 0);
+    const uint32_t numLastWordCols = numCols - (numWords - 1) * 64;
+
+    if (numLastWordCols < 64) {
+        gRvOccCoverage.back() = ~((uint64_t(1) << numLastWordCols) - 1);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Coverage buffer: gets the range of columns (end exclusive) whose centers are within the given range of normalized device coordinates.
+// The range of columns returned might be empty.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void RV_GetOccCoverageCols(const float xMin, const float xMax, uint32_t& colBeg, uint32_t& colEnd) noexcept {
+    // The center of column 'c' is at NDC '(c + 0.5) / colsPerNdc - 1', so solve for 'c' at both ends of the range
+    const float colsPerNdc = gRvOccCoverageColsPerNdc;
+    const float numCols = (float) gRvOccCoverageNumCols;
+    colBeg = (uint32_t) std::clamp(std::ceil((xMin + 1.0f) * colsPerNdc - 0.5f), 0.0f, numCols);
+    colEnd = (uint32_t) std::clamp(std::ceil((xMax + 1.0f) * colsPerNdc - 0.5f), 0.0f, numCols);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Coverage buffer: get a mask of the bits from the given bit index onwards, or before the given bit index, in a single word
+//------------------------------------------------------------------------------------------------------------------------------------------
+static uint64_t RV_OccCoverageMaskFrom(const uint32_t bitIdx) noexcept {
+    return ~uint64_t(0) << bitIdx;
+}
+
+static uint64_t RV_OccCoverageMaskBefore(const uint32_t bitIdx) noexcept {
+    return (bitIdx > 0) ? (~uint64_t(0) >> (64 - bitIdx)) : 0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Coverage buffer: marks the given (non empty) range of columns as occluded
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void RV_OccludeCoverageCols(const uint32_t colBeg, const uint32_t colEnd) noexcept {
+    ASSERT(colBeg < colEnd);
+    uint64_t* const pWords = gRvOccCoverage.data();
+
+    const uint32_t begWordIdx = colBeg / 64;
+    const uint32_t endWordIdx = (colEnd - 1) / 64;
+    const uint64_t begMask = RV_OccCoverageMaskFrom(colBeg % 64);
+    const uint64_t endMask = RV_OccCoverageMaskBefore(((colEnd - 1) % 64) + 1);
+
+    if (begWordIdx == endWordIdx) {
+        pWords[begWordIdx] |= begMask & endMask;
+        return;
+    }
+
+    pWords[begWordIdx] |= begMask;
+
+    for (uint32_t wordIdx = begWordIdx + 1; wordIdx < endWordIdx; ++wordIdx) {
+        pWords[wordIdx] = ~uint64_t(0);
+    }
+
+    pWords[endWordIdx] |= endMask;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Coverage buffer: tells if any column in the given (non empty) range of columns is not occluded
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool RV_IsAnyCoverageColVisible(const uint32_t colBeg, const uint32_t colEnd) noexcept {
+    ASSERT(colBeg < colEnd);
+    const uint64_t* const pWords = gRvOccCoverage.data();
+
+    const uint32_t begWordIdx = colBeg / 64;
+    const uint32_t endWordIdx = (colEnd - 1) / 64;
+    const uint64_t begMask = RV_OccCoverageMaskFrom(colBeg % 64);
+    const uint64_t endMask = RV_OccCoverageMaskBefore(((colEnd - 1) % 64) + 1);
+
+    if (begWordIdx == endWordIdx)
+        return ((~pWords[begWordIdx] & begMask & endMask) != 0);
+
+    if ((~pWords[begWordIdx] & begMask) != 0)
+        return true;
+
+    for (uint32_t wordIdx = begWordIdx + 1; wordIdx < endWordIdx; ++wordIdx) {
+        if (pWords[wordIdx] != ~uint64_t(0))
+            return true;
+    }
+
+    return ((~pWords[endWordIdx] & endMask) != 0);
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Un-marks all areas of the screen as occluded.
 // Intended to be called at the start of a frame.
 //------------------------------------------------------------------------------------------------------------------------------------------
 void RV_ClearOcclussion() noexcept {
-    gRvOccRanges.clear();
+    VFrameArena::resetVector(gRvOccRanges);
     gRvOccRanges.reserve(128);  // This should be more than enough for even the most complex scenes
+
+    // Decide whether to use the coverage buffer for this frame and reset it if so
+    gbRvUseOccCoverage = Config::gbVulkanOcclusionCoverageBuffer;
+
+    if (gbRvUseOccCoverage) {
+        RV_ClearOccCoverage();
+    }
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -114,6 +240,18 @@ void RV_OccludeRange(float xMin, float xMax) noexcept {
     if (xMin >= xMax)
         return;
 
+    // Using the coverage buffer instead of the list of occluded ranges?
+    if (gbRvUseOccCoverage) {
+        uint32_t colBeg, colEnd;
+        RV_GetOccCoverageCols(xMin, xMax, colBeg, colEnd);
+
+        if (colBeg < colEnd) {
+            RV_OccludeCoverageCols(colBeg, colEnd);
+        }
+
+        return;
+    }
+
     // Try to find where to insert
     OccRangeIter insertIter = RV_GetOccRangeIter(xMin);
 
@@ -151,6 +289,14 @@ bool RV_IsRangeVisible(float xMin, float xMax) noexcept {
     if (xMin >= xMax)
         return false;
 
+    // Using the coverage buffer instead of the list of occluded ranges?
+    // Note that ranges which don't contain the center of any column are also never visible, since no pixels would be drawn.
+    if (gbRvUseOccCoverage) {
+        uint32_t colBeg, colEnd;
+        RV_GetOccCoverageCols(xMin, xMax, colBeg, colEnd);
+        return ((colBeg < colEnd) && RV_IsAnyCoverageColVisible(colBeg, colEnd));
+    }
+
     // Get the range that the x values overlap
     const OccRangeIter overlapRangeIter = RV_GetOccRangeIter(xMin);
 
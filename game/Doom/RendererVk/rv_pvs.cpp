@@ -0,0 +1,525 @@
+//------------------------------------------------------------------------------------------------------------------------------------------
+// This module computes and queries a 'potentially visible set' (PVS) for the new Vulkan renderer.
+// The PVS records which sectors could ever possibly be seen from anywhere in each sector. During BSP traversal it's used as a cheap first
+// stage cull, so that whole branches of the BSP tree which can never be seen from the view sector are skipped before any of the more
+// expensive occlusion tests are done on them.
+//
+// The PVS is built from 'portals', which are the two-sided lines between sectors. For each portal leaving a sector a flood fill is done
+// into the sectors beyond it, but only crossing portals that a straight line passing through the source portal could also pass through.
+// A sight line which has crossed a portal always stays on the far side of its line, and it must be on the near side of the line for any
+// portal that it crosses later. This test is conservative: it can report sectors as visible when they are not, but never the reverse.
+//
+// Sector heights are ignored entirely, so doors and lifts opening or closing never change the result and it never needs to be rebuilt.
+//------------------------------------------------------------------------------------------------------------------------------------------
+#include "rv_pvs.h"
+
+#if PSYDOOM_VULKAN_RENDERER
+
+#include "Asserts.h"
+#include "ContentHash.h"
+#include "Doom/Game/doomdata.h"
+#include "Doom/Game/p_setup.h"
+#include "Doom/Renderer/r_local.h"
+#include "Doom/Renderer/r_main.h"
+#include "FileUtils.h"
+#include "PsyDoom/Config/Config.h"
+#include "PsyDoom/JobSystem.h"
+#include "PsyDoom/MapHash.h"
+#include "rv_utils.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// A portal leading out of a sector into a neighboring sector, across a two-sided line
+struct rvportal_t {
+    float       x1, y1;         // 1st endpoint of the portal
+    float       x2, y2;         // 2nd endpoint of the portal
+    float       nx, ny;         // Unit normal for the portal's line, pointing into the sector that the portal leads to
+    float       dist;           // Distance of the portal's line from the origin along the normal
+    int32_t     toSecIdx;       // Which sector the portal leads to
+};
+
+// Don't build a PVS for maps with more sectors than this, due to the memory required.
+// The PVS needs 1 bit for every pair of sectors, so this limit means it will use no more than 32 MiB.
+static constexpr int32_t MAX_PVS_SECTORS = 16384;
+
+// How far (in world units) a portal is allowed to be on the wrong side of another portal and still be considered visible through it.
+// This makes the visibility tests more lenient, in case of precision issues.
+static constexpr float PORTAL_SIDE_EPSILON = 1.0f;
+
+// Binary cache file format details
+static constexpr uint32_t CACHE_MAGIC = 0x56504450;     // 'PDPV' in little endian
+static constexpr uint32_t CACHE_VERSION = 1;
+
+// Header for a binary PVS cache file: it is followed by the visibility bits for each sector
+struct CacheHdr {
+    uint32_t    magic;              // Should be 'CACHE_MAGIC'
+    uint32_t    version;            // Should be 'CACHE_VERSION'
+    uint64_t    key;                // Hash of all the portals the PVS was built from
+    uint64_t    payloadHash;        // Hash of all the data following the header, to detect corruption
+    uint32_t    numSectors;         // How many sectors the PVS is for
+    uint32_t    rowWords;           // How many 64-bit words of visibility bits there are for each sector
+};
+
+static bool                     gbRvPvsValid;               // True if there is a PVS for the current map
+static uint32_t                 gRvPvsRowWords;             // Number of 64-bit words in the visibility bits for each sector
+static std::vector<uint64_t>    gRvPvsBits;                 // Visibility bits for each sector: 'gRvPvsRowWords' per sector
+static std::vector<rvportal_t>  gRvPortals;                 // All portals in the map, grouped by the sector that they lead out of
+static std::vector<int32_t>     gRvSecFirstPortal;          // Index of the first portal leading out of each sector (plus an end index)
+static std::vector<int32_t>     gRvSecSubsecs;              // The subsectors in each sector, grouped by sector
+static std::vector<int32_t>     gRvSecFirstSubsec;          // Index of the first entry in 'gRvSecSubsecs' for each sector (plus an end index)
+static std::vector<int32_t>     gRvBspNodeParents;          // Parent node for each BSP node ('-1' for the root)
+static std::vector<int32_t>     gRvSubsecParents;           // Parent node for each subsector ('-1' if the map has no BSP nodes)
+static std::vector<uint32_t>    gRvBspNodePvsStamps;        // For each BSP node: equal to 'gRvPvsStamp' if something under the node is in the current PVS
+static uint32_t                 gRvPvsStamp;                // Incremented whenever the BSP nodes in the PVS are re-marked
+static int32_t                  gRvPvsViewSecIdx;           // Which sector's PVS is in use for the current frame, or '-1' if none
+static int32_t                  gRvPvsMarkedSecIdx;         // Which sector's PVS the BSP nodes were last marked for, or '-1' if none
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Helpers for testing and setting a bit in a row of visibility bits
+//------------------------------------------------------------------------------------------------------------------------------------------
+static inline bool RV_PvsTestBit(const uint64_t* const pRow, const int32_t secIdx) noexcept {
+    return ((pRow[secIdx >> 6] >> (secIdx & 63)) & 1u);
+}
+
+static inline void RV_PvsSetBit(uint64_t* const pRow, const int32_t secIdx) noexcept {
+    pRow[secIdx >> 6] |= (uint64_t) 1 << (secIdx & 63);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tells if the PVS can be used for the current map.
+// Maps with see-through 'void' lines can't use a PVS, since sectors can be seen across some one-sided lines there.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool RV_CanUsePvsForMap() noexcept {
+    if ((!Config::gbVulkanUsePvs) || (gNumSectors <= 0) || (gNumSectors > MAX_PVS_SECTORS) || (gNumBspNodes <= 0))
+        return false;
+
+    for (int32_t lineIdx = 0; lineIdx < gNumLines; ++lineIdx) {
+        if (gpLines[lineIdx].flags & ML_VOID)
+            return false;
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Records the parent of every BSP node and subsector, and which subsectors belong to each sector.
+// These are used to mark which BSP nodes contain subsectors that are in the PVS for the view sector.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void RV_InitPvsBspLinks() noexcept {
+    gRvBspNodeParents.clear();
+    gRvBspNodeParents.resize((size_t) gNumBspNodes, -1);
+    gRvSubsecParents.clear();
+    gRvSubsecParents.resize((size_t) gNumSubsectors, -1);
+    gRvBspNodePvsStamps.clear();
+    gRvBspNodePvsStamps.resize((size_t) gNumBspNodes, 0);
+
+    for (int32_t nodeIdx = 0; nodeIdx < gNumBspNodes; ++nodeIdx) {
+        for (const int32_t childIdx : gpBspNodes[nodeIdx].children) {
+            if (childIdx & NF_SUBSECTOR) {
+                const int32_t subsecIdx = (childIdx == -1) ? 0 : (childIdx & (~NF_SUBSECTOR));
+
+                if ((subsecIdx >= 0) && (subsecIdx < gNumSubsectors)) {
+                    gRvSubsecParents[subsecIdx] = nodeIdx;
+                }
+            } else if ((childIdx >= 0) && (childIdx < gNumBspNodes)) {
+                gRvBspNodeParents[childIdx] = nodeIdx;
+            }
+        }
+    }
+
+    // Group subsectors by sector
+    gRvSecFirstSubsec.clear();
+    gRvSecFirstSubsec.resize((size_t) gNumSectors + 1, 0);
+
+    for (int32_t subsecIdx = 0; subsecIdx < gNumSubsectors; ++subsecIdx) {
+        gRvSecFirstSubsec[(gpSubsectors[subsecIdx].sector - gpSectors) + 1]++;
+    }
+
+    for (int32_t secIdx = 0; secIdx < gNumSectors; ++secIdx) {
+        gRvSecFirstSubsec[secIdx + 1] += gRvSecFirstSubsec[secIdx];
+    }
+
+    std::vector<int32_t> nextSlot(gRvSecFirstSubsec.begin(), gRvSecFirstSubsec.end() - 1);
+    gRvSecSubsecs.resize((size_t) gNumSubsectors);
+
+    for (int32_t subsecIdx = 0; subsecIdx < gNumSubsectors; ++subsecIdx) {
+        gRvSecSubsecs[nextSlot[gpSubsectors[subsecIdx].sector - gpSectors]++] = subsecIdx;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Builds the list of portals leading out of each sector: each two-sided line between two different sectors gives one portal each way
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void RV_InitPortals() noexcept {
+    // Count the portals leading out of each sector first
+    gRvSecFirstPortal.clear();
+    gRvSecFirstPortal.resize((size_t) gNumSectors + 1, 0);
+
+    const auto isPortalLine = [](const line_t& line) noexcept {
+        return (line.backsector && (line.backsector != line.frontsector) && ((line.dx != 0) || (line.dy != 0)));
+    };
+
+    for (int32_t lineIdx = 0; lineIdx < gNumLines; ++lineIdx) {
+        const line_t& line = gpLines[lineIdx];
+
+        if (isPortalLine(line)) {
+            gRvSecFirstPortal[(line.frontsector - gpSectors) + 1]++;
+            gRvSecFirstPortal[(line.backsector - gpSectors) + 1]++;
+        }
+    }
+
+    for (int32_t secIdx = 0; secIdx < gNumSectors; ++secIdx) {
+        gRvSecFirstPortal[secIdx + 1] += gRvSecFirstPortal[secIdx];
+    }
+
+    // Fill in the portals.
+    // The front sector of a line is on the right side of it, so a portal going from the front to the back sector has the sector it leads to
+    // on the left side of 'v1 -> v2'. For portals going the other way the endpoints are swapped, so the same holds true.
+    std::vector<int32_t> nextSlot(gRvSecFirstPortal.begin(), gRvSecFirstPortal.end() - 1);
+    gRvPortals.resize((size_t) gRvSecFirstPortal[gNumSectors]);
+
+    const auto addPortal = [&](const int32_t fromSecIdx, const int32_t toSecIdx, const float x1, const float y1, const float x2, const float y2) noexcept {
+        const float dx = x2 - x1;
+        const float dy = y2 - y1;
+        const float len = std::sqrt(dx * dx + dy * dy);
+
+        rvportal_t& portal = gRvPortals[nextSlot[fromSecIdx]++];
+        portal.x1 = x1;
+        portal.y1 = y1;
+        portal.x2 = x2;
+        portal.y2 = y2;
+        portal.nx = -dy / len;
+        portal.ny = dx / len;
+        portal.dist = portal.nx * x1 + portal.ny * y1;
+        portal.toSecIdx = toSecIdx;
+    };
+
+    for (int32_t lineIdx = 0; lineIdx < gNumLines; ++lineIdx) {
+        const line_t& line = gpLines[lineIdx];
+
+        if (!isPortalLine(line))
+            continue;
+
+        const int32_t frontSecIdx = (int32_t)(line.frontsector - gpSectors);
+        const int32_t backSecIdx = (int32_t)(line.backsector - gpSectors);
+        const float x1 = RV_FixedToFloat(line.vertex1->x);
+        const float y1 = RV_FixedToFloat(line.vertex1->y);
+        const float x2 = RV_FixedToFloat(line.vertex2->x);
+        const float y2 = RV_FixedToFloat(line.vertex2->y);
+
+        addPortal(frontSecIdx, backSecIdx, x1, y1, x2, y2);
+        addPortal(backSecIdx, frontSecIdx, x2, y2, x1, y1);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tells if a sight line which passes through portal 'p1' could also go on to pass through portal 'p2'.
+// To do that 'p2' must be partly on the far side of 'p1' and 'p1' must be partly on the near side of 'p2'.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool RV_CanSeeThroughPortals(const rvportal_t& p1, const rvportal_t& p2) noexcept {
+    const float p2FarDist = std::max(
+        p1.nx * p2.x1 + p1.ny * p2.y1 - p1.dist,
+        p1.nx * p2.x2 + p1.ny * p2.y2 - p1.dist
+    );
+
+    if (p2FarDist <= -PORTAL_SIDE_EPSILON)
+        return false;
+
+    const float p1NearDist = std::min(
+        p2.nx * p1.x1 + p2.ny * p1.y1 - p2.dist,
+        p2.nx * p1.x2 + p2.ny * p1.y2 - p2.dist
+    );
+
+    return (p1NearDist < PORTAL_SIDE_EPSILON);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Job function: computes the visibility bits for one sector by flooding out through every portal leading out of it
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void RV_BuildSectorPvsJob(const uint32_t jobIdx, [[maybe_unused]] void* const pUserData) noexcept {
+    const int32_t srcSecIdx = (int32_t) jobIdx;
+    const uint32_t rowWords = gRvPvsRowWords;
+    uint64_t* const pRow = gRvPvsBits.data() + (size_t) srcSecIdx * rowWords;
+
+    std::vector<uint64_t> floodBits(rowWords);
+    std::vector<int32_t> floodStack;
+    RV_PvsSetBit(pRow, srcSecIdx);
+
+    for (int32_t srcPortalIdx = gRvSecFirstPortal[srcSecIdx]; srcPortalIdx < gRvSecFirstPortal[srcSecIdx + 1]; ++srcPortalIdx) {
+        const rvportal_t& srcPortal = gRvPortals[srcPortalIdx];
+
+        // The sector directly beyond the portal is always visible, flood out from there
+        std::fill(floodBits.begin(), floodBits.end(), 0);
+        RV_PvsSetBit(floodBits.data(), srcPortal.toSecIdx);
+        floodStack.clear();
+        floodStack.push_back(srcPortal.toSecIdx);
+
+        while (!floodStack.empty()) {
+            const int32_t secIdx = floodStack.back();
+            floodStack.pop_back();
+
+            for (int32_t portalIdx = gRvSecFirstPortal[secIdx]; portalIdx < gRvSecFirstPortal[secIdx + 1]; ++portalIdx) {
+                const rvportal_t& portal = gRvPortals[portalIdx];
+
+                if (RV_PvsTestBit(floodBits.data(), portal.toSecIdx))
+                    continue;
+
+                if (RV_CanSeeThroughPortals(srcPortal, portal)) {
+                    RV_PvsSetBit(floodBits.data(), portal.toSecIdx);
+                    floodStack.push_back(portal.toSecIdx);
+                }
+            }
+        }
+
+        for (uint32_t wordIdx = 0; wordIdx < rowWords; ++wordIdx) {
+            pRow[wordIdx] |= floodBits[wordIdx];
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Job function: expands the visibility bits for one sector to include all the direct neighbors of every visible sector.
+// Sprites in sectors just outside of the PVS can poke into visible areas, so this extra margin helps avoid them popping in.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void RV_DilateSectorPvsJob(const uint32_t jobIdx, void* const pUserData) noexcept {
+    const uint32_t rowWords = gRvPvsRowWords;
+    const uint64_t* const pSrcRow = gRvPvsBits.data() + (size_t) jobIdx * rowWords;
+    uint64_t* const pDstRow = ((uint64_t*) pUserData) + (size_t) jobIdx * rowWords;
+    std::memcpy(pDstRow, pSrcRow, sizeof(uint64_t) * rowWords);
+
+    for (int32_t secIdx = 0; secIdx < gNumSectors; ++secIdx) {
+        if (!RV_PvsTestBit(pSrcRow, secIdx))
+            continue;
+
+        for (int32_t portalIdx = gRvSecFirstPortal[secIdx]; portalIdx < gRvSecFirstPortal[secIdx + 1]; ++portalIdx) {
+            RV_PvsSetBit(pDstRow, gRvPortals[portalIdx].toSecIdx);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Computes a key for the PVS cache from all of the inputs to the PVS build
+//------------------------------------------------------------------------------------------------------------------------------------------
+static uint64_t RV_ComputePvsCacheKey() noexcept {
+    ContentHasher hasher;
+    hasher.addValue(CACHE_VERSION);
+    hasher.addValue(gNumSectors);
+    hasher.add(gRvSecFirstPortal.data(), gRvSecFirstPortal.size() * sizeof(int32_t));
+    hasher.add(gRvPortals.data(), gRvPortals.size() * sizeof(rvportal_t));
+    return hasher.getHash().word1;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Gets the path to the PVS cache file for the current map, which is named after the map hash
+//------------------------------------------------------------------------------------------------------------------------------------------
+static std::string RV_GetPvsCacheFilePath() noexcept {
+    char cacheFileName[48];
+    std::snprintf(
+        cacheFileName,
+        sizeof(cacheFileName),
+        "%016llX%016llX.pvscache",
+        (unsigned long long) MapHash::gWord1,
+        (unsigned long long) MapHash::gWord2
+    );
+
+    std::string cacheFilePath = Config::gLumpCacheDir;
+
+    if ((!cacheFilePath.empty()) && (cacheFilePath.back() != '/') && (cacheFilePath.back() != '\\')) {
+        cacheFilePath += '/';
+    }
+
+    cacheFilePath += cacheFileName;
+    return cacheFilePath;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tries to load the PVS from the cache file at the given path, returning 'true' on success.
+// The file must be valid and for the given key, otherwise it's ignored.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool RV_LoadPvsCache(const char* const filePath, const uint64_t key) noexcept {
+    const FileData fileData = FileUtils::getContentsOfFile(filePath);
+
+    if ((!fileData.bytes) || (fileData.size < sizeof(CacheHdr)))
+        return false;
+
+    CacheHdr hdr = {};
+    std::memcpy(&hdr, fileData.bytes.get(), sizeof(hdr));
+
+    const size_t payloadSize = fileData.size - sizeof(CacheHdr);
+    const bool bValidHdr = (
+        (hdr.magic == CACHE_MAGIC) &&
+        (hdr.version == CACHE_VERSION) &&
+        (hdr.key == key) &&
+        (hdr.numSectors == (uint32_t) gNumSectors) &&
+        (hdr.rowWords == gRvPvsRowWords) &&
+        (payloadSize == gRvPvsBits.size() * sizeof(uint64_t))
+    );
+
+    if (!bValidHdr)
+        return false;
+
+    const std::byte* const pData = fileData.bytes.get() + sizeof(CacheHdr);
+
+    if (ContentHasher::hash(pData, payloadSize).word1 != hdr.payloadHash)
+        return false;
+
+    std::memcpy(gRvPvsBits.data(), pData, payloadSize);
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Saves the PVS to a cache file at the given path.
+// The file is written to a temporary file first and then moved into place, so a partially written cache file is never used.
+// Failure to save is not an error: the PVS will just be computed again the next time the map is loaded.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void RV_SavePvsCache(const char* const filePath, const uint64_t key) noexcept {
+    const size_t payloadSize = gRvPvsBits.size() * sizeof(uint64_t);
+    std::vector<std::byte> fileData(sizeof(CacheHdr) + payloadSize);
+
+    CacheHdr hdr = {};
+    hdr.magic = CACHE_MAGIC;
+    hdr.version = CACHE_VERSION;
+    hdr.key = key;
+    hdr.payloadHash = ContentHasher::hash(gRvPvsBits.data(), payloadSize).word1;
+    hdr.numSectors = (uint32_t) gNumSectors;
+    hdr.rowWords = gRvPvsRowWords;
+    std::memcpy(fileData.data(), &hdr, sizeof(hdr));
+    std::memcpy(fileData.data() + sizeof(CacheHdr), gRvPvsBits.data(), payloadSize);
+
+    const std::string tmpFilePath = std::string(filePath) + ".tmp";
+
+    if (!FileUtils::writeDataToFile(tmpFilePath.c_str(), fileData.data(), fileData.size()))
+        return;
+
+    std::remove(filePath);
+
+    if (std::rename(tmpFilePath.c_str(), filePath) != 0) {
+        std::remove(tmpFilePath.c_str());
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Builds the PVS for the current map, if enabled and if the map supports it.
+// If the lump cache directory is set then a previously cached result is used if possible, and a newly computed one is saved there.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void RV_InitPvs() noexcept {
+    RV_FreePvs();
+
+    if (!RV_CanUsePvsForMap())
+        return;
+
+    RV_InitPvsBspLinks();
+    RV_InitPortals();
+
+    gRvPvsRowWords = ((uint32_t) gNumSectors + 63) / 64;
+    gRvPvsBits.clear();
+    gRvPvsBits.resize((size_t) gNumSectors * gRvPvsRowWords, 0);
+
+    // Try to use a cached PVS first
+    const bool bUseCache = (!Config::gLumpCacheDir.empty());
+    const uint64_t cacheKey = (bUseCache) ? RV_ComputePvsCacheKey() : 0;
+    const std::string cacheFilePath = (bUseCache) ? RV_GetPvsCacheFilePath() : std::string();
+
+    if ((!bUseCache) || (!RV_LoadPvsCache(cacheFilePath.c_str(), cacheKey))) {
+        // Compute the visibility for each sector in parallel, then expand it to include neighboring sectors
+        JobSystem::runJobs((uint32_t) gNumSectors, RV_BuildSectorPvsJob, nullptr);
+
+        std::vector<uint64_t> dilatedBits(gRvPvsBits.size());
+        JobSystem::runJobs((uint32_t) gNumSectors, RV_DilateSectorPvsJob, dilatedBits.data());
+        gRvPvsBits.swap(dilatedBits);
+
+        if (bUseCache) {
+            RV_SavePvsCache(cacheFilePath.c_str(), cacheKey);
+        }
+    }
+
+    gbRvPvsValid = true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Frees the PVS for the map
+//------------------------------------------------------------------------------------------------------------------------------------------
+void RV_FreePvs() noexcept {
+    gbRvPvsValid = false;
+    gRvPvsRowWords = 0;
+    gRvPvsBits = {};
+    gRvPortals = {};
+    gRvSecFirstPortal = {};
+    gRvSecSubsecs = {};
+    gRvSecFirstSubsec = {};
+    gRvBspNodeParents = {};
+    gRvSubsecParents = {};
+    gRvBspNodePvsStamps = {};
+    gRvPvsStamp = 0;
+    gRvPvsViewSecIdx = -1;
+    gRvPvsMarkedSecIdx = -1;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Decides which PVS to use for the current view position, and marks all BSP nodes that contain subsectors in it.
+// The PVS is not used if noclip is active, since the view might then be outside of the map where anything could be visible.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void RV_UpdatePvsForView() noexcept {
+    gRvPvsViewSecIdx = -1;
+
+    if ((!gbRvPvsValid) || (gpViewPlayer->cheats & CF_NOCLIP))
+        return;
+
+    const int32_t viewSecIdx = (int32_t)(R_PointInSubsector(gViewX, gViewY)->sector - gpSectors);
+    gRvPvsViewSecIdx = viewSecIdx;
+
+    // Only need to re-mark the BSP nodes if the view sector changed
+    if (viewSecIdx == gRvPvsMarkedSecIdx)
+        return;
+
+    gRvPvsMarkedSecIdx = viewSecIdx;
+    gRvPvsStamp++;
+
+    if (gRvPvsStamp == 0) {
+        std::fill(gRvBspNodePvsStamps.begin(), gRvBspNodePvsStamps.end(), 0);
+        gRvPvsStamp = 1;
+    }
+
+    // Mark all of the ancestor nodes of every subsector in every visible sector, stopping once we reach a node that is already marked
+    const uint32_t stamp = gRvPvsStamp;
+    const uint64_t* const pRow = gRvPvsBits.data() + (size_t) viewSecIdx * gRvPvsRowWords;
+
+    for (int32_t secIdx = 0; secIdx < gNumSectors; ++secIdx) {
+        if (!RV_PvsTestBit(pRow, secIdx))
+            continue;
+
+        for (int32_t i = gRvSecFirstSubsec[secIdx]; i < gRvSecFirstSubsec[secIdx + 1]; ++i) {
+            int32_t nodeIdx = gRvSubsecParents[gRvSecSubsecs[i]];
+
+            while ((nodeIdx >= 0) && (gRvBspNodePvsStamps[nodeIdx] != stamp)) {
+                gRvBspNodePvsStamps[nodeIdx] = stamp;
+                nodeIdx = gRvBspNodeParents[nodeIdx];
+            }
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tells if the given BSP node or subsector (if 'NF_SUBSECTOR' is set) might be visible according to the PVS for the view sector.
+// Always returns 'true' if the PVS is not in use for the current frame.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool RV_IsBspNodeInPvs(const int32_t nodeIdx) noexcept {
+    if (gRvPvsViewSecIdx < 0)
+        return true;
+
+    if (nodeIdx & NF_SUBSECTOR) {
+        const int32_t subsecIdx = (nodeIdx == -1) ? 0 : (nodeIdx & (~NF_SUBSECTOR));
+        const int32_t secIdx = (int32_t)(gpSubsectors[subsecIdx].sector - gpSectors);
+        return RV_PvsTestBit(gRvPvsBits.data() + (size_t) gRvPvsViewSecIdx * gRvPvsRowWords, secIdx);
+    }
+
+    ASSERT((nodeIdx >= 0) && (nodeIdx < gNumBspNodes));
+    return (gRvBspNodePvsStamps[nodeIdx] == gRvPvsStamp);
+}
+
+#endif  // #if PSYDOOM_VULKAN_RENDERER
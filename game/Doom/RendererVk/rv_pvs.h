@@ -0,0 +1,12 @@
+#pragma once
+
+#if PSYDOOM_VULKAN_RENDERER
+
+#include <cstdint>
+
+void RV_InitPvs() noexcept;
+void RV_FreePvs() noexcept;
+void RV_UpdatePvsForView() noexcept;
+bool RV_IsBspNodeInPvs(const int32_t nodeIdx) noexcept;
+
+#endif  // #if PSYDOOM_VULKAN_RENDERER
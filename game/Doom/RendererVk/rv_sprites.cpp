@@ -6,6 +6,7 @@
 
 #include "rv_sprites.h"
 
+#include "Doom/Base/i_main.h"
 #include "Doom/Base/i_texcache.h"
 #include "Doom/Game/doomdata.h"
 #include "Doom/Game/g_game.h"
@@ -14,13 +15,19 @@
 #include "Doom/Renderer/r_data.h"
 #include "Doom/Renderer/r_local.h"
 #include "Doom/Renderer/r_main.h"
+#include "PsyDoom/FrameProfiler.h"
+#include "PsyDoom/MobjSpritePrecacher.h"
 #include "PsyDoom/Vulkan/VDrawing.h"
+#include "PsyDoom/Vulkan/VFrameArena.h"
 #include "PsyDoom/Vulkan/VTypes.h"
 #include "rv_bsp.h"
 #include "rv_data.h"
 #include "rv_main.h"
 #include "rv_utils.h"
 
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
 #include <vector>
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -58,53 +65,138 @@ struct SplitTestLine {
     float yb, yt;
 };
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Describes one piece of a sprite after it has been split up by the BSP tree.
+// Records which subsector the piece belongs to and the range of the sprite billboard (in the 0-1 range, left to right) that it covers.
+//------------------------------------------------------------------------------------------------------------------------------------------
+struct SpriteSplitPiece {
+    int32_t     subsecIdx;
+    float       t1, t2;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Cached BSP split results for a thing's sprite.
+// If a thing has not moved, the sprite image and view angle have not changed much then the split results from the last time can be reused.
+//
+// Also remembers which sprite texture was picked for the thing the last time it was drawn, and the inputs that choice was made from.
+// While the thing's sprite, frame, angle and position and the view position are unchanged the same texture is used again.
+//------------------------------------------------------------------------------------------------------------------------------------------
+struct SpriteSplitCacheEntry {
+    fixed_t                         thingX, thingY, thingZ;     // Thing position the split was done for
+    texture_t*                      pTex;                       // Sprite texture that was split: determines the size and offset of the sprite
+    bool                            bFlipped;                   // Whether the sprite was flipped
+    bool                            bTexIsPlaceholder;          // If set then 'pTex' is a placeholder for a sprite still being streamed in
+    uint32_t                        texSprite;                  // The sprite and frame which 'pTex' was picked for
+    uint32_t                        texFrame;
+    angle_t                         texThingAngle;              // The thing angle and view position which 'pTex' was picked for
+    fixed_t                         texViewX, texViewY;
+    uint32_t                        viewAngleBucket;            // Which range of view angles the split is valid for
+    uint32_t                        buildFrameNum;              // Frame number when the split was done
+    uint32_t                        useFrameNum;                // Frame number when the split results were last used
+    std::vector<SpriteSplitPiece>   pieces;                     // Which subsectors each part of the sprite goes into
+};
+
+// How many bits of precision to drop from the view angle when deciding whether cached sprite splits can be reused.
+// A shift of '22' means changes of less than about 0.35 degrees re-use the same split results.
+static constexpr uint32_t SPLIT_CACHE_ANGLE_SHIFT = 22;
+
+// How many frames cached sprite splits remain valid for.
+// The split tests also depend on sector heights and seg visibility, so splits are periodically redone to pick up changes to those.
+static constexpr uint32_t SPLIT_CACHE_MAX_AGE = 8;
+
+// How many frames a cached sprite split is kept around unused before it is discarded
+static constexpr uint32_t SPLIT_CACHE_MAX_UNUSED_FRAMES = 64;
+
 // All of the sprite fragments to be drawn in this frame
-static std::vector<SpriteFrag> gRvSpriteFrags;
+static VFrameArena::FrameVector<SpriteFrag> gRvSpriteFrags;
 
 // The sprite fragment linked list for each draw subsector (-1 if no sprite fragments)
-static std::vector<int32_t> gRvDrawSubsecSprFrags;
+static VFrameArena::FrameVector<int32_t> gRvDrawSubsecSprFrags;
+
+// Depth sorted sprite fragments to be drawn for the current draw subsector, as 64-bit sort keys (see 'RV_MakeSpriteFragSortKey').
+// This temporary list is re-used for each subsector to avoid allocations, as is the scratch list used while sorting it.
+static VFrameArena::FrameVector<uint64_t> gRvSortedFrags;
+static VFrameArena::FrameVector<uint64_t> gRvSortedFragsTmp;
 
-// Depth sorted sprite fragments to be drawn for the current draw subsector.
-// This temporary list is re-used for each subsector to avoid allocations.
-static std::vector<const SpriteFrag*> gRvSortedFrags;
+// Subsectors with more than this many sprite fragments have them sorted with a radix sort rather than a comparison sort
+static constexpr size_t MIN_RADIX_SORT_SPRITE_FRAGS = 64;
 
 // XYZ position for the current thing which is having sprite fragments generated
 static float gSpriteFragThingPos[3];
 
+// The xz endpoints of the whole sprite billboard for the current thing which is having sprite fragments generated.
+// These are used to figure out which part of the sprite each split piece covers.
+static float gSpriteFragBillboard[4];
+
+// Cached BSP split results for each thing, and the split results for the current thing which is having sprite fragments generated
+static std::unordered_map<const mobj_t*, SpriteSplitCacheEntry>    gRvSpriteSplitCache;
+static std::vector<SpriteSplitPiece>*                               gpSpriteSplitPieces;
+
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Get and cache the texture to use for the given thing and sprite frame, and get whether it is flipped.
+// Get and cache the texture to use for the given thing, and get whether it is flipped.
 // This code is copied more or less directly from 'R_DrawSubsectorSprites'.
+//
+// PsyDoom: the texture picked the last time the thing was drawn is reused if nothing affecting the choice has changed since then.
+// The cache entry's position fields must still hold the thing position from the last time it was drawn when this is called.
 //------------------------------------------------------------------------------------------------------------------------------------------
 static texture_t& RV_CacheThingSpriteFrame(
+    const mobj_t& thing,
     const fixed_t thingX,
     const fixed_t thingY,
-    const angle_t thingAngle,
-    const spriteframe_t& frame,
+    SpriteSplitCacheEntry& cacheEntry,
     bool& bFlipSrite
 ) noexcept {
-    // Decide on which sprite lump to use and whether the sprite is flipped.
-    // If the frame supports rotations then decide on the exact orientation to use, otherwise use the default.
-    int32_t lumpIdx;
-
-    if (frame.rotate) {
-        const angle_t angToThing = R_PointToAngle2(gViewX, gViewY, thingX, thingY);
-        const uint32_t dirIdx = (angToThing - thingAngle + (ANG45 / 2) * 9) >> 29;      // Note: same calculation as PC Doom
+    const bool bCanUseCachedTex = (
+        cacheEntry.pTex &&
+        (!cacheEntry.bTexIsPlaceholder) &&
+        (cacheEntry.texSprite == thing.sprite) &&
+        (cacheEntry.texFrame == thing.frame) &&
+        (cacheEntry.texThingAngle == thing.angle) &&
+        (cacheEntry.thingX == thingX) &&
+        (cacheEntry.thingY == thingY) &&
+        (cacheEntry.texViewX == gViewX) &&
+        (cacheEntry.texViewY == gViewY)
+    );
 
-        lumpIdx = frame.lump[dirIdx];
-        bFlipSrite = frame.flip[dirIdx];
+    if (bCanUseCachedTex) {
+        bFlipSrite = cacheEntry.bFlipped;
     } else {
-        lumpIdx = frame.lump[0];
-        bFlipSrite = frame.flip[0];
+        // Decide on which sprite lump to use and whether the sprite is flipped.
+        // If the frame supports rotations then decide on the exact orientation to use, otherwise use the default.
+        const spritedef_t& spriteDef = gSprites[thing.sprite];
+        const spriteframe_t& frame = spriteDef.spriteframes[thing.frame & FF_FRAMEMASK];
+        const uint32_t dirIdx = (frame.rotate) ?
+            (R_PointToAngle2(gViewX, gViewY, thingX, thingY) - thing.angle + (ANG45 / 2) * 9) >> 29 :     // Note: same calculation as PC Doom
+            0;
+
+        const int32_t frameLumpIdx = (int32_t) frame.lump[dirIdx];
+        bFlipSrite = frame.flip[dirIdx];
+
+        // If the sprite is still being streamed in then a placeholder might be used instead.
+        // Otherwise use the texture resolved for the frame in advance, if there is one.
+        const int32_t lumpIdx = MobjSpritePrecacher::getSpriteLumpToDraw(thing, frameLumpIdx, bFlipSrite);
+        const bool bIsPlaceholder = (lumpIdx != frameLumpIdx);
+
+        cacheEntry.pTex = ((!bIsPlaceholder) && frame.pTex[dirIdx]) ? frame.pTex[dirIdx] : &R_GetTexForLump(lumpIdx);
+        cacheEntry.bFlipped = bFlipSrite;
+        cacheEntry.bTexIsPlaceholder = bIsPlaceholder;
+        cacheEntry.texSprite = thing.sprite;
+        cacheEntry.texFrame = thing.frame;
+        cacheEntry.texThingAngle = thing.angle;
+        cacheEntry.texViewX = gViewX;
+        cacheEntry.texViewY = gViewY;
     }
 
-    // Upload the sprite texture to VRAM if not already uploaded and return the texture to use
-    texture_t& tex = R_GetTexForLump(lumpIdx);
+    // Upload the sprite texture to VRAM if not already uploaded and return the texture to use.
+    // Note: this must be done every time since sprites can be evicted from VRAM at any point.
+    texture_t& tex = *cacheEntry.pTex;
     I_CacheTex(tex);
     return tex;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Populates a sprite fragment entry (covering the entire sprite) for the given thing and using the specified sector color
+// Populates a sprite fragment entry (covering the entire sprite) for the given thing and using the specified sector color.
+// Also outputs the sprite texture used and whether it is flipped.
 //------------------------------------------------------------------------------------------------------------------------------------------
 static void RV_InitSpriteFrag(
     mobj_t& thing,
@@ -114,7 +206,10 @@ static void RV_InitSpriteFrag(
     const fixed_t thingZ,
     const uint8_t secR,
     const uint8_t secG,
-    const uint8_t secB
+    const uint8_t secB,
+    SpriteSplitCacheEntry& cacheEntry,
+    const texture_t*& pSpriteTexOut,
+    bool& bFlipSpriteOut
 ) noexcept {
     // Transform its xyz (Doom xzy) position by the view projection matrix to obtain the depth of the thing.
     // This will be useful later for depth sorting.
@@ -133,12 +228,9 @@ static void RV_InitSpriteFrag(
     }
 
     // Grab the sprite frame to use
-    const spritedef_t& spriteDef = gSprites[thing.sprite];
-    const spriteframe_t& frame = spriteDef.spriteframes[thing.frame & FF_FRAMEMASK];
-
     // Make sure the sprite is resident in VRAM and get whether it is flipped
     bool bFlipSprite = {};
-    const texture_t& tex = RV_CacheThingSpriteFrame(thingX, thingY, thing.angle, frame, bFlipSprite);
+    const texture_t& tex = RV_CacheThingSpriteFrame(thing, thingX, thingY, cacheEntry, bFlipSprite);
 
     // Get the texture window params for the sprite
     uint16_t texWinX;
@@ -262,6 +354,8 @@ static void RV_InitSpriteFrag(
     sprFrag.texWinY = texWinY;
     sprFrag.texWinW = texWinW;
     sprFrag.texWinH = texWinH;
+    pSpriteTexOut = &tex;
+    bFlipSpriteOut = bFlipSprite;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -274,7 +368,7 @@ static void RV_DrawSpriteFrag(const SpriteFrag& sprFrag) noexcept {
     const uint8_t colG = sprFrag.colG;
     const uint8_t colB = sprFrag.colB;
 
-    VDrawing::addWorldQuad(
+    VDrawing::addWorldSpriteQuad(
         { sprFrag.x1, sprFrag.yb, sprFrag.z1, sprFrag.ul, sprFrag.vb, colR, colG, colB },
         { sprFrag.x1, sprFrag.yt, sprFrag.z1, sprFrag.ul, sprFrag.vt, colR, colG, colB },
         { sprFrag.x2, sprFrag.yt, sprFrag.z2, sprFrag.ur, sprFrag.vt, colR, colG, colB },
@@ -307,6 +401,59 @@ static void RV_SpriteFrag_VisitSubsector(const subsector_t& subsec, const Sprite
     gRvDrawSubsecSprFrags[drawSubsecIdx] = sprFragIdx;
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Gets how far along the current thing's sprite billboard the given xz point is, in the range 0-1
+//------------------------------------------------------------------------------------------------------------------------------------------
+static float RV_GetSpriteBillboardT(const float x, const float z) noexcept {
+    const float dx = gSpriteFragBillboard[2] - gSpriteFragBillboard[0];
+    const float dz = gSpriteFragBillboard[3] - gSpriteFragBillboard[1];
+    const float lenSq = dx * dx + dz * dz;
+
+    if (lenSq <= 0.0f)
+        return 0.0f;
+
+    const float t = ((x - gSpriteFragBillboard[0]) * dx + (z - gSpriteFragBillboard[1]) * dz) / lenSq;
+    return std::clamp(t, 0.0f, 1.0f);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Called when a sprite fragment reaches it's destination subsector after BSP splitting.
+// Records the split result for the current thing (so it can be cached) and adds the fragment to the subsector's draw list.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void RV_SpriteFrag_SplitToSubsector(const subsector_t& subsec, const SpriteFrag& frag) noexcept {
+    if (gpSpriteSplitPieces) {
+        SpriteSplitPiece& piece = gpSpriteSplitPieces->emplace_back();
+        piece.subsecIdx = (int32_t)(&subsec - gpSubsectors);
+        piece.t1 = RV_GetSpriteBillboardT(frag.x1, frag.z1);
+        piece.t2 = RV_GetSpriteBillboardT(frag.x2, frag.z2);
+    }
+
+    RV_SpriteFrag_VisitSubsector(subsec, frag);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Adds the sprite fragments for a thing to subsector draw lists using previously cached BSP split results.
+// The given fragment is the entire unsplit sprite, and the cached pieces determine which parts of it go into which subsectors.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void RV_SpriteFrag_AddCachedSplits(const SpriteFrag& frag, const std::vector<SpriteSplitPiece>& pieces) noexcept {
+    for (const SpriteSplitPiece& piece : pieces) {
+        const float t1 = piece.t1;
+        const float t2 = piece.t2;
+        const float t1_inv = 1.0f - t1;
+        const float t2_inv = 1.0f - t2;
+
+        SpriteFrag pieceFrag = frag;
+        pieceFrag.x1 = frag.x1 * t1_inv + frag.x2 * t1;
+        pieceFrag.z1 = frag.z1 * t1_inv + frag.z2 * t1;
+        pieceFrag.ul = frag.ul * t1_inv + frag.ur * t1;
+        pieceFrag.x2 = frag.x1 * t2_inv + frag.x2 * t2;
+        pieceFrag.z2 = frag.z1 * t2_inv + frag.z2 * t2;
+        pieceFrag.ur = frag.ul * t2_inv + frag.ur * t2;
+
+        RV_SpriteFrag_VisitSubsector(gpSubsectors[piece.subsecIdx], pieceFrag);
+    }
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Used to check if a sprite split test line collides against the specified seg.
 // Checks to see if the seg is considered blocking for the purposes of sprite splitting, and whether the line crosses it.
@@ -443,9 +590,9 @@ static void RV_SpriteFrag_VisitBspNode(const int32_t nodeIdx, SpriteFrag& frag)
         // Note: this strange check is in the PC engine too...
         // Under what circumstances can the node number be '-1'?
         if (nodeIdx == -1) {
-            RV_SpriteFrag_VisitSubsector(gpSubsectors[0], frag);
+            RV_SpriteFrag_SplitToSubsector(gpSubsectors[0], frag);
         } else {
-            RV_SpriteFrag_VisitSubsector(gpSubsectors[nodeIdx & (~NF_SUBSECTOR)], frag);
+            RV_SpriteFrag_SplitToSubsector(gpSubsectors[nodeIdx & (~NF_SUBSECTOR)], frag);
         }
     } else {
         // This is not a subsector, continue traversing the BSP tree and splitting the sprite fragment
@@ -593,9 +740,50 @@ static void RV_BuildSubsectorSpriteFrags(const subsector_t& subsec, [[maybe_unus
         uint8_t secB;
         R_GetSectorDrawColor(*subsec.sector, thingZ, secR, secG, secB);
 
+        // Get the cached split results and sprite texture choice for the thing, as of the last time it was drawn
+        SpriteSplitCacheEntry& cacheEntry = gRvSpriteSplitCache[pThing];
+        const texture_t* const pPrevSpriteTex = cacheEntry.pTex;
+        const bool bPrevFlipSprite = cacheEntry.bFlipped;
+
         // Allocate and initialize a full sprite fragment for the thing
         SpriteFrag sprFrag;
-        RV_InitSpriteFrag(*pThing, sprFrag, thingX, thingY, thingZ, secR, secG, secB);
+        const texture_t* pSpriteTex = nullptr;
+        bool bFlipSprite = false;
+        RV_InitSpriteFrag(*pThing, sprFrag, thingX, thingY, thingZ, secR, secG, secB, cacheEntry, pSpriteTex, bFlipSprite);
+
+        // If the thing has not moved and the sprite and view angle are much the same as the last time it was split then reuse the results.
+        // Otherwise the split must be redone, and the results for it cached for next time.
+        const uint32_t viewAngleBucket = gViewAngle >> SPLIT_CACHE_ANGLE_SHIFT;
+
+        const bool bCanUseCachedSplit = (
+            (cacheEntry.thingX == thingX) &&
+            (cacheEntry.thingY == thingY) &&
+            (cacheEntry.thingZ == thingZ) &&
+            (pPrevSpriteTex == pSpriteTex) &&
+            (bPrevFlipSprite == bFlipSprite) &&
+            (cacheEntry.viewAngleBucket == viewAngleBucket) &&
+            (gNumFramesDrawn - cacheEntry.buildFrameNum < SPLIT_CACHE_MAX_AGE)
+        );
+
+        cacheEntry.useFrameNum = gNumFramesDrawn;
+
+        if (bCanUseCachedSplit) {
+            RV_SpriteFrag_AddCachedSplits(sprFrag, cacheEntry.pieces);
+            continue;
+        }
+
+        cacheEntry.thingX = thingX;
+        cacheEntry.thingY = thingY;
+        cacheEntry.thingZ = thingZ;
+        cacheEntry.viewAngleBucket = viewAngleBucket;
+        cacheEntry.buildFrameNum = gNumFramesDrawn;
+        cacheEntry.pieces.clear();
+
+        gpSpriteSplitPieces = &cacheEntry.pieces;
+        gSpriteFragBillboard[0] = sprFrag.x1;
+        gSpriteFragBillboard[1] = sprFrag.z1;
+        gSpriteFragBillboard[2] = sprFrag.x2;
+        gSpriteFragBillboard[3] = sprFrag.z2;
 
         // Split up the sprite fragment into further small pieces (on subsector boundaries) if neccessary and remember the position of the thing being split.
         // The thing position is used to resolve cases that we can't split and where we need to decide on a sprite subsector.
@@ -605,6 +793,21 @@ static void RV_BuildSubsectorSpriteFrags(const subsector_t& subsec, [[maybe_unus
 
         const int32_t bspRootNodeIdx = gNumBspNodes - 1;
         RV_SpriteFrag_VisitBspNode(bspRootNodeIdx, sprFrag);
+        gpSpriteSplitPieces = nullptr;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Discards cached sprite split results for things that have not been drawn in a while.
+// This stops the cache growing indefinitely as things are removed from the level or go out of view.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void RV_PruneSpriteSplitCache() noexcept {
+    for (auto iter = gRvSpriteSplitCache.begin(); iter != gRvSpriteSplitCache.end();) {
+        if (gNumFramesDrawn - iter->second.useFrameNum >= SPLIT_CACHE_MAX_UNUSED_FRAMES) {
+            iter = gRvSpriteSplitCache.erase(iter);
+        } else {
+            ++iter;
+        }
     }
 }
 
@@ -612,16 +815,25 @@ static void RV_BuildSubsectorSpriteFrags(const subsector_t& subsec, [[maybe_unus
 // Builds a list of all the sprite fragments to be drawn for this frame
 //------------------------------------------------------------------------------------------------------------------------------------------
 void RV_BuildSpriteFragLists() noexcept {
+    PROFILE_SCOPE(BuildSpriteFragLists);
+
     // Clear the list of sprite fragments to draw and init each draw subsector as having no sprite frags.
     // ALso prealloc a minimum amount of memory for all of the draw vectors.
     const int32_t numDrawSubsecs = (int32_t) gRvDrawSubsecs.size();
 
-    gRvSpriteFrags.clear();
+    VFrameArena::resetVector(gRvSpriteFrags);
     gRvSpriteFrags.reserve(8192);
-    gRvDrawSubsecSprFrags.clear();
+    VFrameArena::resetVector(gRvDrawSubsecSprFrags);
     gRvDrawSubsecSprFrags.reserve(4196);
     gRvDrawSubsecSprFrags.resize((size_t) numDrawSubsecs, -1);
+    VFrameArena::resetVector(gRvSortedFrags);
     gRvSortedFrags.reserve(256);
+    VFrameArena::resetVector(gRvSortedFragsTmp);
+
+    // Periodically discard sprite split results that are no longer being used
+    if (gNumFramesDrawn % SPLIT_CACHE_MAX_UNUSED_FRAMES == 0) {
+        RV_PruneSpriteSplitCache();
+    }
 
     // Run through all of the draw subsectors and build a list of sprite fragments for each
     for (int32_t drawSubsecIdx = 0; drawSubsecIdx < numDrawSubsecs; ++drawSubsecIdx) {
@@ -629,6 +841,88 @@ void RV_BuildSpriteFragLists() noexcept {
     }
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Discards all cached sprite split results.
+// Must be called whenever the level is unloaded, since the results refer to the level's subsectors.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void RV_ClearSpriteSplitCache() noexcept {
+    gRvSpriteSplitCache.clear();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Makes a key for sorting sprite fragments back to front, where sorting the keys in ascending order gives the desired draw order.
+// The upper 32-bits hold the fragment depth, remapped so that larger depths give smaller keys. The lower 32-bits hold the fragment's
+// index, inverted so that fragments of equal depth are drawn in order of descending index.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static uint64_t RV_MakeSpriteFragSortKey(const float depth, const int32_t sprFragIdx) noexcept {
+    // Remap the float bits so that they sort in the same order as the floats themselves, then invert to sort by descending depth
+    uint32_t depthBits;
+    std::memcpy(&depthBits, &depth, sizeof(depthBits));
+    depthBits = (depthBits & 0x80000000u) ? ~depthBits : (depthBits | 0x80000000u);
+
+    return ((uint64_t) ~depthBits << 32) | (uint32_t) ~(uint32_t) sprFragIdx;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Sorts the sprite fragment keys for the current draw subsector in ascending order.
+// Uses a radix sort for subsectors crowded with many fragments, skipping all of the byte positions which are the same for every key.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void RV_SortSpriteFragKeys() noexcept {
+    const size_t numKeys = gRvSortedFrags.size();
+
+    // Frequently the fragments are already in the correct order (e.g nothing has moved in relation to each other), so check that first
+    if (std::is_sorted(gRvSortedFrags.begin(), gRvSortedFrags.end()))
+        return;
+
+    if (numKeys <= MIN_RADIX_SORT_SPRITE_FRAGS) {
+        std::sort(gRvSortedFrags.begin(), gRvSortedFrags.end());
+        return;
+    }
+
+    // Build the histograms for all 8 byte positions in one pass
+    uint32_t counts[8][256] = {};
+
+    for (const uint64_t key : gRvSortedFrags) {
+        for (uint32_t bytePos = 0; bytePos < 8; ++bytePos) {
+            counts[bytePos][(key >> (bytePos * 8)) & 0xFF]++;
+        }
+    }
+
+    // Do a stable counting sort pass for each byte position, from least to most significant
+    gRvSortedFragsTmp.resize(numKeys);
+    uint64_t* pSrc = gRvSortedFrags.data();
+    uint64_t* pDst = gRvSortedFragsTmp.data();
+
+    for (uint32_t bytePos = 0; bytePos < 8; ++bytePos) {
+        // If all keys have the same value for this byte then this pass would not change anything
+        const uint32_t shift = bytePos * 8;
+        uint32_t (&byteCounts)[256] = counts[bytePos];
+
+        if (byteCounts[(pSrc[0] >> shift) & 0xFF] == numKeys)
+            continue;
+
+        uint32_t offsets[256];
+        uint32_t nextOffset = 0;
+
+        for (uint32_t byteVal = 0; byteVal < 256; ++byteVal) {
+            offsets[byteVal] = nextOffset;
+            nextOffset += byteCounts[byteVal];
+        }
+
+        for (size_t i = 0; i < numKeys; ++i) {
+            const uint64_t key = pSrc[i];
+            pDst[offsets[(key >> shift) & 0xFF]++] = key;
+        }
+
+        std::swap(pSrc, pDst);
+    }
+
+    // Make sure the result ends up in the sorted list
+    if (pSrc != gRvSortedFrags.data()) {
+        std::memcpy(gRvSortedFrags.data(), pSrc, numKeys * sizeof(uint64_t));
+    }
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Draw sprite fragments for the specified draw subsector index
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -643,22 +937,18 @@ void RV_DrawSubsecSpriteFrags(const int32_t drawSubsecIdx) noexcept {
     while (nextSprIdx >= 0) {
         ASSERT((size_t) nextSprIdx < gRvSpriteFrags.size());
         const SpriteFrag& sprFrag = pAllSprFrags[nextSprIdx];
-        gRvSortedFrags.emplace_back(&sprFrag);
+        gRvSortedFrags.emplace_back(RV_MakeSpriteFragSortKey(sprFrag.depth, nextSprIdx));
         nextSprIdx = sprFrag.nextSubsecFragIdx;
     }
 
-    // Sort all of the sprite fragments back to front
-    std::stable_sort(
-        gRvSortedFrags.begin(),
-        gRvSortedFrags.end(),
-        [](const SpriteFrag* const pFrag1, const SpriteFrag* const pFrag2) noexcept {
-            return (pFrag1->depth > pFrag2->depth);
-        }
-    );
+    // Sort all of the sprite fragments back to front.
+    // Fragments of equal depth are drawn in order of descending index, which is the order they were gathered in.
+    RV_SortSpriteFragKeys();
 
     // Draw all the sorted fragments and clear the temporary list to finish up
-    for (const SpriteFrag* const pSprFrag : gRvSortedFrags) {
-        RV_DrawSpriteFrag(*pSprFrag);
+    for (const uint64_t sortKey : gRvSortedFrags) {
+        const int32_t sprFragIdx = (int32_t) ~(uint32_t) sortKey;
+        RV_DrawSpriteFrag(pAllSprFrags[sprFragIdx]);
     }
 
     gRvSortedFrags.clear();
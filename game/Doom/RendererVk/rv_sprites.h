@@ -9,5 +9,6 @@ struct subsector_t;
 void RV_BuildSpriteFragLists() noexcept;
 void RV_DrawSubsecSpriteFrags(const int32_t drawSubsecIdx) noexcept;
 void RV_DrawWeapon() noexcept;
+void RV_ClearSpriteSplitCache() noexcept;
 
 #endif  // #if PSYDOOM_VULKAN_RENDERER
@@ -265,6 +265,47 @@ bool RV_GetLineNdcBounds(
     return true;
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tells if the given box on the XY plane (Doom world coords) is entirely outside of one of the left, right or front view frustum planes.
+// Uses exactly the same tests as 'RV_GetLineNdcBounds' (with no left/right plane adjustment), so if this returns 'true' then every line
+// inside the box is guaranteed to be culled by that function also.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool RV_IsBoxOutsideFrustum(const float minX, const float minY, const float maxX, const float maxY) noexcept {
+    // An empty box can't be seen
+    if ((minX > maxX) || (minY > maxY))
+        return true;
+
+    // Convert the corners to clip space in the same way as 'RV_GetLineNdcBounds', saving only the xzw components
+    const float mR0C0 = gViewProjMatrix.e[0][0];
+    const float mR0C2 = gViewProjMatrix.e[0][2];
+    const float mR0C3 = gViewProjMatrix.e[0][3];
+    const float mR2C0 = gViewProjMatrix.e[2][0];
+    const float mR2C2 = gViewProjMatrix.e[2][2];
+    const float mR2C3 = gViewProjMatrix.e[2][3];
+    const float mR3C0 = gViewProjMatrix.e[3][0];
+    const float mR3C2 = gViewProjMatrix.e[3][2];
+    const float mR3C3 = gViewProjMatrix.e[3][3];
+
+    const float cornersX[4] = { minX, maxX, maxX, minX };
+    const float cornersY[4] = { minY, minY, maxY, maxY };
+
+    bool bAllOutsideLeft = true;
+    bool bAllOutsideRight = true;
+    bool bAllOutsideFront = true;
+
+    for (uint32_t i = 0; i < 4; ++i) {
+        const float clipX = cornersX[i] * mR0C0 + cornersY[i] * mR2C0 + mR3C0;
+        const float clipZ = cornersX[i] * mR0C2 + cornersY[i] * mR2C2 + mR3C2;
+        const float clipW = cornersX[i] * mR0C3 + cornersY[i] * mR2C3 + mR3C3;
+
+        bAllOutsideLeft &= (clipX < -clipW);
+        bAllOutsideRight &= (clipX > +clipW);
+        bAllOutsideFront &= (clipZ < -clipW);
+    }
+
+    return (bAllOutsideLeft || bAllOutsideRight || bAllOutsideFront);
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Clear the draw order field for each subsector drawn this frame.
 // This cleanup is required to be done after doing drawing each frame, so that each subsector is marked as initially not being drawn.
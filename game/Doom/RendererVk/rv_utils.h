@@ -47,6 +47,7 @@ bool RV_GetLineNdcBounds(
     const float lrpCullAdjust = 1.0f    // Left/right plane angle adjustment for culling (1.0 = no change)
 ) noexcept;
 
+bool RV_IsBoxOutsideFrustum(const float minX, const float minY, const float maxX, const float maxY) noexcept;
 void RV_ClearSubsecDrawIndexes() noexcept;
 void RV_DrawWidescreenStatusBarLetterbox() noexcept;
 
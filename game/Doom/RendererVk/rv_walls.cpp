@@ -19,8 +19,184 @@
 #include "rv_utils.h"
 
 #include <cmath>
+#include <cstring>
+#include <memory>
 
-static int32_t gNextSkyWallDrawSubsecIdx;       // Index of the next draw subsector to have its sky walls drawn
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Cached geometry for one part (upper, lower or mid) of the walls for a seg.
+// Note: the 'v' coordinates exclude the sidedef row offset, so that scrolling walls do not invalidate the cache.
+//------------------------------------------------------------------------------------------------------------------------------------------
+struct rvwallpart_t {
+    fixed_t     yt, yb;         // Top and bottom y values of the wall (used for shading)
+    float       ytF, ybF;       // Top and bottom y values of the wall (floating point)
+    float       vt, vb;         // Top and bottom 'v' texture coordinates, before the row offset is applied
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Cached wall geometry for a seg, along with the inputs it was computed from.
+// The geometry only needs to be recomputed when the draw heights of the front or back sector change, or the line's pegging changes.
+//------------------------------------------------------------------------------------------------------------------------------------------
+struct rvsegwalls_t {
+    uint32_t        frontDrawHVersion;      // The 'drawHVersion' of the front sector when the geometry was computed
+    uint32_t        backDrawHVersion;       // The 'drawHVersion' of the back sector when the geometry was computed ('0' if no back sector)
+    uint32_t        lineFlags;              // Line flags affecting wall geometry when the geometry was computed
+    int32_t         midFixedH;              // Mid wall height (in pixels) if it's forced to be a fixed height, otherwise '0'
+    bool            bValid;                 // False until the geometry is computed for the first time
+    rvwallpart_t    upper;                  // Upper wall geometry: only valid for two sided lines
+    rvwallpart_t    lower;                  // Lower wall geometry: only valid for two sided lines
+    rvwallpart_t    mid;                    // Mid wall geometry
+};
+
+// Line flags which affect the geometry of the walls for a seg
+static constexpr uint32_t WALL_GEOM_LINE_FLAGS = ML_DONTPEGTOP | ML_DONTPEGBOTTOM | ML_MID_FIXED_HEIGHT | ML_MIDTRANSLUCENT | ML_MIDMASKED;
+
+static int32_t                          gNextSkyWallDrawSubsecIdx;      // Index of the next draw subsector to have its sky walls drawn
+static std::unique_ptr<rvsegwalls_t[]>  gpRvSegWalls;                   // Cached wall geometry for each seg: same count as 'gpRvSegs'
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Initializes the cached wall geometry for all segs in the level; everything starts out needing to be computed
+//------------------------------------------------------------------------------------------------------------------------------------------
+void RV_InitWallCache() noexcept {
+    gpRvSegWalls.reset(new rvsegwalls_t[gNumSegs]);
+    std::memset(gpRvSegWalls.get(), 0, sizeof(rvsegwalls_t) * gNumSegs);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Frees the cached wall geometry for the level
+//------------------------------------------------------------------------------------------------------------------------------------------
+void RV_FreeWallCache() noexcept {
+    gpRvSegWalls.reset();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Fills in the geometry for a wall part spanning the given y values
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void RV_SetWallPart(rvwallpart_t& part, const fixed_t yt, const fixed_t yb, const float vt, const float vb) noexcept {
+    part.yt = yt;
+    part.yb = yb;
+    part.ytF = RV_FixedToFloat(yt);
+    part.ybF = RV_FixedToFloat(yb);
+    part.vt = vt;
+    part.vb = vb;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Gets the upper, lower and mid wall geometry for a seg, recomputing it only if the inputs to it have changed since it was last computed.
+// The front sector given must be the sector of the subsector being drawn, which is always the same for any given seg.
+//
+// Note: the cache entry for a seg is only ever touched by whoever draws the seg's subsector, so this is safe to call while opaque walls are
+// being drawn in parallel; the blended walls for the seg are drawn later, on the main thread.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static const rvsegwalls_t& RV_GetSegWalls(const rvseg_t& seg, const sector_t& frontSec) noexcept {
+    ASSERT(gpRvSegWalls);
+    rvsegwalls_t& walls = gpRvSegWalls[&seg - gpRvSegs.get()];
+
+    // Gather up all the inputs to the wall geometry.
+    // Note that the fixed height mid wall flag only applies to blended and masked mid walls, which are drawn by 'RV_DrawSegBlended'.
+    const side_t& side = *seg.sidedef;
+    const sector_t* const pBackSec = seg.backsector;
+    const uint32_t lineFlags = seg.linedef->flags & WALL_GEOM_LINE_FLAGS;
+    const bool bMidFixedH = (
+        (lineFlags & ML_MID_FIXED_HEIGHT) &&
+        (lineFlags & (ML_MIDTRANSLUCENT | ML_MIDMASKED)) &&
+        (side.midtexture >= 0)
+    );
+
+    const int32_t midFixedH = (bMidFixedH) ? gpTextures[gpTextureTranslation[side.midtexture]].height : 0;
+    const uint32_t frontDrawHVersion = frontSec.drawHVersion;
+    const uint32_t backDrawHVersion = (pBackSec) ? pBackSec->drawHVersion : 0;
+
+    // If nothing has changed then the cached geometry can be used as-is
+    const bool bIsCacheValid = (
+        walls.bValid &&
+        (walls.frontDrawHVersion == frontDrawHVersion) &&
+        (walls.backDrawHVersion == backDrawHVersion) &&
+        (walls.lineFlags == lineFlags) &&
+        (walls.midFixedH == midFixedH)
+    );
+
+    if (bIsCacheValid)
+        return walls;
+
+    walls.frontDrawHVersion = frontDrawHVersion;
+    walls.backDrawHVersion = backDrawHVersion;
+    walls.lineFlags = lineFlags;
+    walls.midFixedH = midFixedH;
+    walls.bValid = true;
+
+    // Get the top and bottom y values of the front sector, and initially the mid wall spans all of that
+    const fixed_t fty = frontSec.ceilingDrawH;
+    const fixed_t fby = frontSec.floorDrawH;
+    fixed_t midTy = fty;
+    fixed_t midBy = fby;
+
+    if (pBackSec) {
+        // Get the bottom and top y values of the back sector
+        const fixed_t bty = pBackSec->ceilingDrawH;
+        const fixed_t bby = pBackSec->floorDrawH;
+
+        // Adjust mid wall size so that it only occupies the gap between the upper and lower walls
+        midTy = std::min(midTy, bty);
+        midBy = std::max(midBy, bby);
+
+        // Upper wall: compute the top and bottom v coordinate
+        {
+            const float wallH = RV_FixedToFloat(fty - bty);
+
+            if (lineFlags & ML_DONTPEGTOP) {
+                // Top of texture is at top of upper wall
+                RV_SetWallPart(walls.upper, fty, bty, 0.0f, wallH);
+            } else {
+                // Bottom of texture is at bottom of upper wall
+                RV_SetWallPart(walls.upper, fty, bty, -wallH, 0.0f);
+            }
+        }
+
+        // Lower wall: compute the top and bottom v coordinate
+        {
+            const float heightToLower = RV_FixedToFloat(fty - bby);
+            const float wallH = RV_FixedToFloat(bby - fby);
+
+            if (lineFlags & ML_DONTPEGBOTTOM) {
+                // Don't anchor lower wall texture to the floor
+                RV_SetWallPart(walls.lower, bby, fby, heightToLower, heightToLower + wallH);
+            } else {
+                // Anchor lower wall texture to the floor
+                RV_SetWallPart(walls.lower, bby, fby, 0.0f, wallH);
+            }
+        }
+    }
+
+    // Final Doom: force the mid wall to be a fixed height (equal to the texture height) if this flag is specified.
+    // This is used for masked fences and such, to stop them from repeating vertically - MAP23 (BALLISTYX) is a good example of this.
+    // 
+    // Note that for PsyDoom this is restricted to two sided linedefs only; for more on that see 'R_DrawWalls' in the original renderer.
+    // Also, in the original renderer the fixed height was always '128' but for PsyDoom it's now based on the texture height.
+    // This allows us to have fence textures shorter than '128' units.
+    if (bMidFixedH) {
+        midTy = midBy + midFixedH * FRACUNIT;
+    }
+
+    // Mid wall: compute the top and bottom v coordinate.
+    //
+    // Note: I broke with the original strange PSX wrapping behavior here (see 'R_DrawWalls' for that) for simplicity.
+    // It may result in some different behavior in a few spots but it actually fixes a few texture related issues, and makes the levels look as they were intended.
+    // I think the original PSX code was mostly trying to work around the limitations of 8-bit texcoords, so wound up with a few strange bugs.
+    // We don't have to live with that limitation anymore for the Vulkan renderer...
+    {
+        const float wallH = RV_FixedToFloat(midTy - midBy);
+
+        if (lineFlags & ML_DONTPEGBOTTOM) {
+            // Bottom of texture is at bottom of mid wall
+            RV_SetWallPart(walls.mid, midTy, midBy, -wallH, 0.0f);
+        } else {
+            // Top of texture is at top of mid wall
+            RV_SetWallPart(walls.mid, midTy, midBy, 0.0f, wallH);
+        }
+    }
+
+    return walls;
+}
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Draw a wall (upper, mid, lower) for a seg
@@ -31,13 +207,11 @@ static void RV_DrawWall(
     const float z1,
     const float x2,
     const float z2,
-    const fixed_t yt,
-    const fixed_t yb,
-    // Texture UV coords
+    // Cached wall geometry, and the texture UV coords and offsets
+    const rvwallpart_t& part,
     const float u1,
     const float u2,
-    const float vt,
-    const float vb,
+    const float vOffset,
     // Sector, texture and shading details
     const sector_t& sector,
     texture_t& tex,
@@ -54,15 +228,17 @@ static void RV_DrawWall(
     // Decide light diminishing mode depending on whether view lighting is disabled or not (disabled for visor powerup)
     const VLightDimMode lightDimMode = (gbDoViewLighting) ? VLightDimMode::Walls : VLightDimMode::None;
 
-    // Get the floating point top and bottom y values
-    const float ytF = RV_FixedToFloat(yt);
-    const float ybF = RV_FixedToFloat(yb);
+    // Get the top and bottom y and v values
+    const float ytF = part.ytF;
+    const float ybF = part.ybF;
+    const float vt = part.vt + vOffset;
+    const float vb = part.vb + vOffset;
 
     // Compute the color to shade the top and bottom of the wall with
     uint8_t colR_t, colG_t, colB_t;
     uint8_t colR_b, colG_b, colB_b;
-    R_GetSectorDrawColor(sector, yt, colR_t, colG_t, colB_t);
-    R_GetSectorDrawColor(sector, yb, colR_b, colG_b, colB_b);
+    R_GetSectorDrawColor(sector, part.yt, colR_t, colG_t, colB_t);
+    R_GetSectorDrawColor(sector, part.yb, colR_b, colG_b, colB_b);
 
     // Draw the wall triangles.
     // Note: assuming the correct draw pipeline has been already set.
@@ -95,10 +271,14 @@ static void RV_DrawSegSolid(const rvseg_t& seg, const subsector_t& subsec) noexc
     if ((seg.flags & SGF_VISIBLE_COLS) == 0)
         return;
 
-    // This line is now viewed by the player: show in the automap if the line is viewable there
+    // This line is now viewed by the player: show in the automap if the line is viewable there.
+    // Note: only write the flag if not already set, since walls might be drawn in parallel after being marked beforehand.
     side_t& side = *seg.sidedef;
     line_t& line = *seg.linedef;
-    line.flags |= ML_MAPPED;
+
+    if ((line.flags & ML_MAPPED) == 0) {
+        line.flags |= ML_MAPPED;
+    }
 
     // Get the xz positions of the seg endpoints and the seg length
     const float x1 = seg.v1x;
@@ -107,14 +287,13 @@ static void RV_DrawSegSolid(const rvseg_t& seg, const subsector_t& subsec) noexc
     const float z2 = seg.v2y;
     const float segLen = seg.length;
 
-    // Get the top and bottom y values of the front sector.
+    // Get the cached geometry for the walls of this seg, using the front sector to compute it if the cache is out of date.
     //
     // Note: use the subsector passed into this function rather than the seg's reference to it - the subsector passed in is more reliable.
     // Some maps in PSX Final Doom (MAP04, 'Combine' for example) have not all segs in a subsector pointing to that same subsector, as expected.
     // This inconsitency causes problems such as bad wall heights, due to querying the wrong sector for height.
     const sector_t& frontSec = *subsec.sector;
-    const fixed_t fty = frontSec.ceilingDrawH;
-    const fixed_t fby = frontSec.floorDrawH;
+    const rvsegwalls_t& walls = RV_GetSegWalls(seg, frontSec);
 
     // Get u and v offsets for the seg and the u1/u2 coordinates
     const float uOffset = RV_FixedToFloat(side.textureoffset.renderValue()) + seg.uOffset;
@@ -122,10 +301,6 @@ static void RV_DrawSegSolid(const rvseg_t& seg, const subsector_t& subsec) noexc
     const float u1 = uOffset;
     const float u2 = uOffset + segLen;
 
-    // These are the y values for the top and bottom of the mid wall
-    fixed_t midTy = fty;
-    fixed_t midBy = fby;
-
     // Do we draw these walls transparent? (x-ray cheat)
     const bool bDrawTransparent = (gpViewPlayer->cheats & CF_XRAYVISION);
 
@@ -133,64 +308,25 @@ static void RV_DrawSegSolid(const rvseg_t& seg, const subsector_t& subsec) noexc
     const bool bTwoSidedWall = seg.backsector;
 
     if (bTwoSidedWall) {
-        // Get the bottom and top y values of the back sector
-        const sector_t& backSec = *seg.backsector;
-        const fixed_t bty = backSec.ceilingDrawH;
-        const fixed_t bby = backSec.floorDrawH;
-
-        // Adjust mid wall size so that it only occupies the gap between the upper and lower walls
-        midTy = std::min(midTy, bty);
-        midBy = std::max(midBy, bby);
-
         // Figure out whether there are upper and lower walls and whether the upper and lower walls should be treated as a sky walls
+        const sector_t& backSec = *seg.backsector;
         const bool bIsUpperSkyWall = (backSec.ceilingpic == -1);
         const bool bIsLowerSkyWall = (backSec.floorpic == -1);
-        const bool bHasUpperWall = ((bty < fty) && (side.toptexture >= 0));
-        const bool bHasLowerWall = ((bby > fby) && (side.bottomtexture >= 0));
+        const bool bHasUpperWall = ((walls.upper.yb < walls.upper.yt) && (side.toptexture >= 0));
+        const bool bHasLowerWall = ((walls.lower.yt > walls.lower.yb) && (side.bottomtexture >= 0));
 
         // Draw the upper wall if existing not a sky wall
         if (bHasUpperWall && (!bIsUpperSkyWall)) {
-            // Compute the top and bottom v coordinate and then draw
-            const float wallH = RV_FixedToFloat(fty - bty);
-            float vt;
-            float vb;
-
-            if (line.flags & ML_DONTPEGTOP) {
-                // Top of texture is at top of upper wall
-                vt = vOffset;
-                vb = vOffset + wallH;
-            } else {
-                // Bottom of texture is at bottom of upper wall
-                vt = vOffset - wallH;
-                vb = vt + wallH;
-            }
-
             VDrawing::setDrawPipeline(gOpaqueGeomPipeline);
             texture_t& tex_u = gpTextures[gpTextureTranslation[side.toptexture]];
-            RV_DrawWall(x1, z1, x2, z2, fty, bty, u1, u2, vt, vb, frontSec, tex_u, bDrawTransparent);
+            RV_DrawWall(x1, z1, x2, z2, walls.upper, u1, u2, vOffset, frontSec, tex_u, bDrawTransparent);
         }
 
         // Draw the lower wall if existing not a sky wall
         if (bHasLowerWall && (!bIsLowerSkyWall)) {
-            // Compute the top and bottom v coordinate and then draw
-            const float heightToLower = RV_FixedToFloat(fty - bby);
-            const float wallH = RV_FixedToFloat(bby - fby);
-            float vt;
-            float vb;
-
-            if (line.flags & ML_DONTPEGBOTTOM) {
-                // Don't anchor lower wall texture to the floor
-                vb = vOffset + heightToLower + wallH;
-                vt = vb - wallH;
-            } else {
-                // Anchor lower wall texture to the floor
-                vb = vOffset + wallH;
-                vt = vb - wallH;
-            }
-
             VDrawing::setDrawPipeline(gOpaqueGeomPipeline);
             texture_t& tex_l = gpTextures[gpTextureTranslation[side.bottomtexture]];
-            RV_DrawWall(x1, z1, x2, z2, bby, fby, u1, u2, vt, vb, frontSec, tex_l, bDrawTransparent);
+            RV_DrawWall(x1, z1, x2, z2, walls.lower, u1, u2, vOffset, frontSec, tex_l, bDrawTransparent);
         }
     }
 
@@ -199,29 +335,9 @@ static void RV_DrawSegSolid(const rvseg_t& seg, const subsector_t& subsec) noexc
     const bool bIsBlendedSeg = (line.flags & (ML_MIDTRANSLUCENT | ML_MIDMASKED));
 
     if ((!bTwoSidedWall) && (side.midtexture >= 0) && (!bIsBlendedSeg)) {
-        // Compute the top and bottom v coordinate
-        const float wallH = RV_FixedToFloat(midTy - midBy);
-        float vt;
-        float vb;
-
-        // Note: I broke with the original strange PSX wrapping behavior here (see 'R_DrawWalls' for that) for simplicity.
-        // It may result in some different behavior in a few spots but it actually fixes a few texture related issues, and makes the levels look as they were intended.
-        // I think the original PSX code was mostly trying to work around the limitations of 8-bit texcoords, so wound up with a few strange bugs.
-        // We don't have to live with that limitation anymore for the Vulkan renderer...
-        if (line.flags & ML_DONTPEGBOTTOM) {
-            // Bottom of texture is at bottom of mid wall
-            vb = vOffset;
-            vt = vOffset - wallH;
-        } else {
-            // Top of texture is at top of mid wall
-            vt = vOffset;
-            vb = vOffset + wallH;
-        }
-
-        // Draw the wall
         VDrawing::setDrawPipeline(gOpaqueGeomPipeline);
         texture_t& tex_m = gpTextures[gpTextureTranslation[side.midtexture]];
-        RV_DrawWall(x1, z1, x2, z2, midTy, midBy, u1, u2, vt, vb, frontSec, tex_m, bDrawTransparent);
+        RV_DrawWall(x1, z1, x2, z2, walls.mid, u1, u2, vOffset, frontSec, tex_m, bDrawTransparent);
     }
 }
 
@@ -253,15 +369,6 @@ static void RV_DrawSegBlended(const rvseg_t& seg, const subsector_t& subsec) noe
     const float z2 = seg.v2y;
     const float segLen = seg.length;
 
-    // Get the top and bottom y values of the front sector.
-    //
-    // Note: use the subsector passed into this function rather than the seg's reference to it - the subsector passed in is more reliable.
-    // Some maps in PSX Final Doom (MAP04, 'Combine' for example) have not all segs in a subsector pointing to that same subsector, as expected.
-    // This inconsitency causes problems such as bad wall heights, due to querying the wrong sector for height.
-    const sector_t& frontSec = *subsec.sector;
-    const fixed_t fty = frontSec.ceilingDrawH;
-    const fixed_t fby = frontSec.floorDrawH;
-
     // Get the mid texture for the seg; if it doesn't exist then don't draw
     side_t& side = *seg.sidedef;
     const int32_t midTexIdx = side.midtexture;
@@ -271,64 +378,27 @@ static void RV_DrawSegBlended(const rvseg_t& seg, const subsector_t& subsec) noe
 
     texture_t& tex_m = gpTextures[gpTextureTranslation[side.midtexture]];
 
+    // Get the cached geometry for the walls of this seg, using the front sector to compute it if the cache is out of date.
+    // The mid wall occupies the gap between the front and back sectors, or is a fixed height if the line specifies that.
+    //
+    // Note: use the subsector passed into this function rather than the seg's reference to it - the subsector passed in is more reliable.
+    // Some maps in PSX Final Doom (MAP04, 'Combine' for example) have not all segs in a subsector pointing to that same subsector, as expected.
+    // This inconsitency causes problems such as bad wall heights, due to querying the wrong sector for height.
+    const sector_t& frontSec = *subsec.sector;
+    const rvsegwalls_t& walls = RV_GetSegWalls(seg, frontSec);
+
     // Get u and v offsets for the seg and the u1/u2 coordinates
     const float uOffset = RV_FixedToFloat(side.textureoffset.renderValue()) + seg.uOffset;
     const float vOffset = RV_FixedToFloat(side.rowoffset.renderValue());
     const float u1 = uOffset;
     const float u2 = uOffset + segLen;
 
-    // These are the y values for the top and bottom of the mid wall.
-    // It occupies the gap between the front and back sectors.
-    fixed_t midTy = {};
-    fixed_t midBy = {};
-
-    if (sector_t* const pBackSec = seg.backsector) {
-        const fixed_t bty = pBackSec->ceilingDrawH;
-        const fixed_t bby = pBackSec->floorDrawH;
-
-        midTy = std::min(fty, bty);
-        midBy = std::max(fby, bby);
-    } else {
-        // No back sector, one sided line...
-        midTy = fty;
-        midBy = fby;
-    }
-
-    // Final Doom: force the mid wall to be a fixed height (equal to the texture height) if this flag is specified.
-    // This is used for masked fences and such, to stop them from repeating vertically - MAP23 (BALLISTYX) is a good example of this.
-    // 
-    // Note that for PsyDoom this is restricted to two sided linedefs only; for more on that see 'R_DrawWalls' in the original renderer.
-    // Also, in the original renderer the fixed height was always '128' but for PsyDoom it's now based on the texture height.
-    // This allows us to have fence textures shorter than '128' units.
-    if (line.flags & ML_MID_FIXED_HEIGHT) {
-        midTy = midBy + tex_m.height * FRACUNIT;
-    }
-
-    // Compute the top and bottom v coordinate
-    const float wallH = RV_FixedToFloat(midTy - midBy);
-    float vt;
-    float vb;
-
-    // Note: I broke with the original strange PSX wrapping behavior here (see 'R_DrawWalls' for that) for simplicity.
-    // It may result in some different behavior in a few spots but it actually fixes a few texture related issues, and makes the levels look as they were intended.
-    // I think the original PSX code was mostly trying to work around the limitations of 8-bit texcoords, so wound up with a few strange bugs.
-    // We don't have to live with that limitation anymore for the Vulkan renderer...
-    if (line.flags & ML_DONTPEGBOTTOM) {
-        // Bottom of texture is at bottom of mid wall
-        vb = vOffset;
-        vt = vOffset - wallH;
-    } else {
-        // Top of texture is at top of mid wall
-        vt = vOffset;
-        vb = vOffset + wallH;
-    }
-
     // Should this wall be drawn with 50% alpha or not?
     const bool bBlend = (line.flags & ML_MIDTRANSLUCENT);
 
     // Draw the wall and make sure we are on the correct alpha blended pipeline before we draw
     VDrawing::setDrawPipeline(VPipelineType::World_GeomAlpha);
-    RV_DrawWall(x1, z1, x2, z2, midTy, midBy, u1, u2, vt, vb, frontSec, tex_m, bBlend);
+    RV_DrawWall(x1, z1, x2, z2, walls.mid, u1, u2, vOffset, frontSec, tex_m, bBlend);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -451,6 +521,47 @@ void RV_DrawSubsecOpaqueWalls(subsector_t& subsec) noexcept {
     }
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Does all the work for drawing the fully opaque walls of the given subsector which modifies shared state: marks lines for visible walls as
+// seen in the automap, uploads any wall textures which need to be uploaded to VRAM and resolves texture offset interpolation (which may
+// modify the offsets). This allows the walls to then be drawn in parallel.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void RV_PrepSubsecOpaqueWallsDraw(subsector_t& subsec) noexcept {
+    const rvseg_t* const pBegSeg = gpRvSegs.get() + subsec.firstseg;
+    const rvseg_t* const pEndSeg = pBegSeg + subsec.numsegs;
+
+    for (const rvseg_t* pSeg = pBegSeg; pSeg < pEndSeg; ++pSeg) {
+        // Same visibility checks as 'RV_DrawSegSolid'
+        const rvseg_t& seg = *pSeg;
+
+        if (seg.flags & SGF_BACKFACING)
+            continue;
+
+        if ((seg.flags & SGF_VISIBLE_COLS) == 0)
+            continue;
+
+        seg.linedef->flags |= ML_MAPPED;
+
+        side_t& side = *seg.sidedef;
+        side.textureoffset.renderValue();
+        side.rowoffset.renderValue();
+
+        // Upload any textures the walls might use
+
+        if (side.toptexture >= 0) {
+            RV_UploadDirtyTex(gpTextures[gpTextureTranslation[side.toptexture]]);
+        }
+
+        if (side.bottomtexture >= 0) {
+            RV_UploadDirtyTex(gpTextures[gpTextureTranslation[side.bottomtexture]]);
+        }
+
+        if (side.midtexture >= 0) {
+            RV_UploadDirtyTex(gpTextures[gpTextureTranslation[side.midtexture]]);
+        }
+    }
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Draws all blended and masked mid walls for the specified subsector
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -7,8 +7,11 @@ struct subsector_t;
 
 #include <cstdint>
 
+void RV_InitWallCache() noexcept;
+void RV_FreeWallCache() noexcept;
 void RV_InitNextDrawSkyWalls() noexcept;
 void RV_DrawSubsecOpaqueWalls(subsector_t& subsec) noexcept;
+void RV_PrepSubsecOpaqueWallsDraw(subsector_t& subsec) noexcept;
 void RV_DrawSubsecBlendedWalls(subsector_t& subsec) noexcept;
 void RV_DrawSubsecSkyWalls(const int32_t fromDrawSubsecIdx) noexcept;
 
@@ -19,13 +19,13 @@
 #include "Doom/Renderer/r_data.h"
 #include "errormenu_main.h"
 #include "FileInputStream.h"
-#include "FileOutputStream.h"
 #include "FileUtils.h"
 #include "m_main.h"
 #include "o_main.h"
 #include "PsyDoom/Game.h"
 #include "PsyDoom/SaveAndLoad.h"
 #include "PsyDoom/SaveDataTypes.h"
+#include "PsyDoom/SaveFileWriter.h"
 #include "PsyDoom/Utils.h"
 #include "PsyQ/LIBSPU.h"
 #include "pw_main.h"
@@ -76,6 +76,7 @@ static bool                 gbLoadSaveOnLevelStart;     // If true then load the
 //------------------------------------------------------------------------------------------------------------------------------------------
 static void ReadSaveHeader(SaveFileInfo& save) noexcept {
     std::string saveFilePath = SaveAndLoad::getSaveFilePath(save.slot);
+    SaveFileWriter::waitForWrites();    // In case the save is still being written
 
     if (!FileUtils::fileExists(saveFilePath.c_str()))
         return;
@@ -529,14 +530,7 @@ gameaction_t SaveGameForSlot(const SaveFileSlot slot, const SaveGameContext save
     SaveAndLoad::gCurSaveSlot = slot;
     bool bSuccess = false;
 
-    try {
-        const std::string savePath = SaveAndLoad::getSaveFilePath(slot);
-        FileOutputStream file(savePath.c_str(), false);
-        bSuccess = SaveAndLoad::save(file);
-    }
-    catch (...) {
-        // Ignore...
-    }
+    bSuccess = SaveAndLoad::save(slot);
 
     // Display the result to the HUD and clear the current slot being loaded.
     // Skip the HUD message however if the unusual situation arises where we are auto-saving on level start and there is already
@@ -565,8 +559,9 @@ gameaction_t LoadGameForSlot(const SaveFileSlot slot, const LoadGameContext load
     gbLoadSaveOnLevelStart = false;
     SaveAndLoad::gCurSaveSlot = slot;
 
-    // Read the save first of all
+    // Read the save first of all, after waiting for any saves still being written
     ReadSaveResult readSaveResult = ReadSaveResult::IO_ERROR;
+    SaveFileWriter::waitForWrites();
 
     try {
         const std::string savePath = SaveAndLoad::getSaveFilePath(slot);
@@ -701,6 +696,7 @@ void DoQuicksave() noexcept {
 gameaction_t DoQuickload() noexcept {
     // Only do quickload if the file actually exists
     const std::string saveFilePath = SaveAndLoad::getSaveFilePath(SaveFileSlot::QUICKSAVE);
+    SaveFileWriter::waitForWrites();    // In case the quicksave is still being written
 
     if (FileUtils::fileExists(saveFilePath.c_str())) {
         return LoadGameForSlot(SaveFileSlot::QUICKSAVE, LoadGameContext::Quickload);
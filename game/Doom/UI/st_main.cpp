@@ -102,6 +102,124 @@ bool                    gbDoSpclFace;           // Should we do a special face n
 int32_t                 gNewFace;               // Which normal face to use next
 spclface_e              gSpclFaceType;          // Which special face to use next
 
+#if PSYDOOM_MODS
+    // PsyDoom: what is shown by the status bar elements (numbers, keys, weapon numbers and face) and the sprites for them.
+    // The sprites are built once and then re-used on subsequent frames until what the elements show changes.
+    struct sbarelems_t {
+        int32_t                 ammo;
+        int32_t                 health;
+        int32_t                 armor;
+        int32_t                 frags;
+        const facesprite_t*     pFaceSprite;            // Which face sprite is drawn or 'nullptr' if none
+        uint16_t                clutId;                 // CLUT used for all the sprites
+        uint8_t                 drawnCardsMask;         // Bit 'N' is set if card 'N' is drawn
+        uint8_t                 ownedWeaponsMask;       // Bit 'N' is set if weapon 'N' is owned
+        int32_t                 microNumIdx;            // Which weapon micro number is highlighted
+        bool                    bDeathmatch;            // If set then frags are shown instead of the weapon numbers
+
+        inline bool operator == (const sbarelems_t& other) const noexcept {
+            return (
+                (ammo == other.ammo) &&
+                (health == other.health) &&
+                (armor == other.armor) &&
+                (frags == other.frags) &&
+                (pFaceSprite == other.pFaceSprite) &&
+                (clutId == other.clutId) &&
+                (drawnCardsMask == other.drawnCardsMask) &&
+                (ownedWeaponsMask == other.ownedWeaponsMask) &&
+                (microNumIdx == other.microNumIdx) &&
+                (bDeathmatch == other.bDeathmatch)
+            );
+        }
+
+        inline bool operator != (const sbarelems_t& other) const noexcept {
+            return (!(*this == other));
+        }
+    };
+
+    // The most sprites the status bar elements can use: 4 numbers, 6 keys, the weapon box with 6 micro numbers and highlight, and the face
+    static constexpr uint32_t MAX_SBAR_ELEM_SPRITES = I_MAX_NUMBER_SPRITES * 4 + NUMCARDS + 8 + 1;
+
+    static sbarelems_t  gSBarElemsState;                                // What the cached status bar element sprites show
+    static bool         gbSBarElemsCached;                              // If false then the status bar element sprites must be rebuilt
+    static SPRT         gSBarElemSprites[MAX_SBAR_ELEM_SPRITES];        // The cached sprites for the status bar elements
+    static uint32_t     gNumSBarElemSprites;                            // How many cached status bar element sprites there are
+#endif
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Helper: figures out which weapon the status bar should show ammo for and highlight
+//------------------------------------------------------------------------------------------------------------------------------------------
+static weapontype_t ST_GetDisplayWeapon(const player_t& player) noexcept {
+    return (player.pendingweapon == wp_nochange) ? player.readyweapon : player.pendingweapon;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Helper: draws a sprite for one of the status bar elements (numbers, keys, weapon numbers and face).
+// PsyDoom: the sprite is now added to the cached list of status bar element sprites instead of being drawn immediately.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void ST_AddElemSprite(const SPRT& sprite) noexcept {
+    #if PSYDOOM_MODS
+        ASSERT(gNumSBarElemSprites < MAX_SBAR_ELEM_SPRITES);
+        gSBarElemSprites[gNumSBarElemSprites] = sprite;
+        gNumSBarElemSprites++;
+    #else
+        I_AddPrim(sprite);
+    #endif
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Helper: draws a number for one of the status bar elements.
+// PsyDoom: the sprites for the number are now added to the cached list of status bar element sprites instead of being drawn immediately.
+// They use the CLUT and shading settings of the given template sprite.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void ST_DrawElemNumber(const int32_t x, const int32_t y, const int32_t value, [[maybe_unused]] const SPRT& templateSprite) noexcept {
+    #if PSYDOOM_MODS
+        ASSERT(gNumSBarElemSprites + I_MAX_NUMBER_SPRITES <= MAX_SBAR_ELEM_SPRITES);
+        gNumSBarElemSprites += I_MakeNumberSprites(x, y, value, templateSprite, gSBarElemSprites + gNumSBarElemSprites);
+    #else
+        I_DrawNumber(x, y, value);
+    #endif
+}
+
+#if PSYDOOM_MODS
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: gets what the status bar elements (numbers, keys, weapon numbers and face) should currently show for the given player
+//------------------------------------------------------------------------------------------------------------------------------------------
+static sbarelems_t ST_GetElemsState(const player_t& player) noexcept {
+    const weapontype_t weapon = ST_GetDisplayWeapon(player);
+    const ammotype_t ammoType = gWeaponInfo[weapon].ammo;
+
+    sbarelems_t state = {};
+    state.ammo = (ammoType != am_noammo) ? player.ammo[ammoType] : 0;
+    state.health = player.health;
+    state.armor = player.armorpoints;
+    state.pFaceSprite = (gbDrawSBFace) ? gpCurSBFaceSprite : nullptr;
+    state.clutId = Game::getTexClut_STATUS();
+    state.bDeathmatch = (gNetGame == gt_deathmatch);
+
+    for (int32_t cardIdx = 0; cardIdx < NUMCARDS; ++cardIdx) {
+        if (player.cards[cardIdx] || (gFlashCards[cardIdx].active && gFlashCards[cardIdx].doDraw)) {
+            state.drawnCardsMask |= (uint8_t)(1u << cardIdx);
+        }
+    }
+
+    // Only include what is actually shown, so that changes to other values don't cause needless rebuilds
+    if (state.bDeathmatch) {
+        state.frags = player.frags;
+    } else {
+        for (int32_t weaponIdx = wp_shotgun; weaponIdx < NUMMICROS; ++weaponIdx) {
+            if (player.weaponowned[weaponIdx]) {
+                state.ownedWeaponsMask |= (uint8_t)(1u << weaponIdx);
+            }
+        }
+
+        state.microNumIdx = WEAPON_MICRO_INDEXES[weapon];
+    }
+
+    return state;
+}
+#endif  // #if PSYDOOM_MODS
+
 #if PSYDOOM_MODS
 //------------------------------------------------------------------------------------------------------------------------------------------
 // PsyDoom: draws a single stat in small text (8x8 pixel font), right aligned at the side of the screen
@@ -180,6 +298,7 @@ void ST_InitEveryLevel() noexcept {
     #if PSYDOOM_MODS
         std::memset(gStatusBar.alertMessage, 0, sizeof(gStatusBar.alertMessage));   // PsyDoom: init the alert message status
         gStatusBar.alertMessageTicsLeft = 0;
+        gbSBarElemsCached = false;                                                  // PsyDoom: rebuild the status bar element sprites
     #endif
 
     gbDrawSBFace = true;
@@ -346,6 +465,107 @@ void ST_Ticker() noexcept {
     I_UpdatePalette();
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Draws the status bar elements for the given player: ammo, health and armor numbers, keys, weapon numbers or frags, and the face.
+// Uses and modifies the given sprite primitive for drawing.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void ST_DrawElements(const player_t& player, SPRT& spritePrim) noexcept {
+    // Figure out what weapon to display ammo for and what to show for the ammo amount
+    const weapontype_t weapon = ST_GetDisplayWeapon(player);
+
+    const weaponinfo_t& weaponInfo = gWeaponInfo[weapon];
+    const ammotype_t ammoType = weaponInfo.ammo;
+    const int32_t ammo = (ammoType != am_noammo) ? player.ammo[ammoType] : 0;
+
+    // Draw ammo, health and armor amounts
+    ST_DrawElemNumber(28, 204, ammo, spritePrim);
+    ST_DrawElemNumber(71, 204, player.health, spritePrim);
+    ST_DrawElemNumber(168, 204, player.armorpoints, spritePrim);
+
+    // Draw keycards and skull keys
+    {
+        LIBGPU_setWH(spritePrim, 11, 8);
+        spritePrim.x0 = 100;
+        spritePrim.v0 = 184;
+
+        uint8_t texU = 114;
+
+        for (int32_t cardIdx = 0; cardIdx < NUMCARDS; ++cardIdx) {
+            const bool bHaveCard = player.cards[cardIdx];
+
+            // Draw the card if we have it or if it's currently flashing
+            if (bHaveCard || (gFlashCards[cardIdx].active && gFlashCards[cardIdx].doDraw)) {
+                spritePrim.u0 = texU;
+                spritePrim.y0 = gCardY[cardIdx];
+
+                ST_AddElemSprite(spritePrim);
+            }
+
+            texU += 11;
+        }
+    }
+
+    // Draw weapon selector or frags (if deathmatch)
+    if (gNetGame != gt_deathmatch) {
+        // Draw the weapon number box/container
+        LIBGPU_setXY0(spritePrim, 200, 205);
+        LIBGPU_setUV0(spritePrim, 180, 184);
+        LIBGPU_setWH(spritePrim, 51, 23);
+
+        ST_AddElemSprite(spritePrim);
+
+        // Draw the micro numbers for each weapon.
+        // Note that numbers '1' and '2' are already baked into the status bar graphic, so we start at the shotgun.
+        {
+            LIBGPU_setWH(spritePrim, 4, 6);
+            spritePrim.v0 = 184;
+
+            uint8_t texU = 232;
+
+            for (int32_t weaponIdx = wp_shotgun; weaponIdx < NUMMICROS; ++weaponIdx) {
+                if (player.weaponowned[weaponIdx]) {
+                    LIBGPU_setXY0(spritePrim, gMicronumsX[weaponIdx] + 5, gMicronumsY[weaponIdx] + 3);
+                    spritePrim.u0 = texU;
+
+                    ST_AddElemSprite(spritePrim);
+                }
+
+                texU += 4;
+            }
+        }
+
+        // Draw the white box or highlight for the currently selected weapon
+        const int32_t microNumIdx = WEAPON_MICRO_INDEXES[weapon];
+
+        LIBGPU_setXY0(spritePrim, gMicronumsX[microNumIdx], gMicronumsY[microNumIdx]);
+        LIBGPU_setUV0(spritePrim, 164, 192);
+        LIBGPU_setWH(spritePrim, 12, 12);
+
+        ST_AddElemSprite(spritePrim);
+    } else {
+        // Draw the frags container box
+        LIBGPU_setXY0(spritePrim, 209, 221);
+        LIBGPU_setUV0(spritePrim, 208, 243);
+        LIBGPU_setWH(spritePrim, 33, 8);
+
+        ST_AddElemSprite(spritePrim);
+
+        // Draw the number of frags
+        ST_DrawElemNumber(225, 204, player.frags, spritePrim);
+    }
+
+    // Draw the doomguy face if enabled
+    if (gbDrawSBFace) {
+        const facesprite_t& sprite = *gpCurSBFaceSprite;
+
+        LIBGPU_setXY0(spritePrim, sprite.xPos, sprite.yPos);
+        LIBGPU_setUV0(spritePrim, sprite.texU, sprite.texV);
+        LIBGPU_setWH(spritePrim, sprite.w, sprite.h);
+
+        ST_AddElemSprite(spritePrim);
+    }
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Do drawing for the HUD status bar
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -521,102 +741,32 @@ void ST_Drawer() noexcept {
         }
     #endif
 
-    // Figure out what weapon to display ammo for and what to show for the ammo amount
-    const weapontype_t weapon = (player.pendingweapon == wp_nochange) ?
-        player.readyweapon :
-        player.pendingweapon;
-
-    const weaponinfo_t& weaponInfo = gWeaponInfo[weapon];
-    const ammotype_t ammoType = weaponInfo.ammo;
-    const int32_t ammo = (ammoType != am_noammo) ? player.ammo[ammoType] : 0;
-
-    // Draw ammo, health and armor amounts
-    I_DrawNumber(28, 204, ammo);
-    I_DrawNumber(71, 204, player.health);
-    I_DrawNumber(168, 204, player.armorpoints);
-
-    // Draw keycards and skull keys
+    // Draw the status bar elements: numbers, keys, weapon numbers and the face.
+    // PsyDoom: the sprites for these are now cached and only rebuilt when what the elements show changes, instead of every frame.
+    // All the sprites are drawn after a single draw mode change; previously each number also set the draw mode before drawing.
+    #if PSYDOOM_MODS
     {
-        LIBGPU_setWH(spritePrim, 11, 8);
-        spritePrim.x0 = 100;
-        spritePrim.v0 = 184;
-
-        uint8_t texU = 114;
-
-        for (int32_t cardIdx = 0; cardIdx < NUMCARDS; ++cardIdx) {
-            const bool bHaveCard = player.cards[cardIdx];
-
-            // Draw the card if we have it or if it's currently flashing
-            if (bHaveCard || (gFlashCards[cardIdx].active && gFlashCards[cardIdx].doDraw)) {
-                spritePrim.u0 = texU;
-                spritePrim.y0 = gCardY[cardIdx];
+        const sbarelems_t elemsState = ST_GetElemsState(player);
 
-                I_AddPrim(spritePrim);
-            }
-
-            texU += 11;
+        if ((!gbSBarElemsCached) || (elemsState != gSBarElemsState)) {
+            gNumSBarElemSprites = 0;
+            ST_DrawElements(player, spritePrim);
+            gSBarElemsState = elemsState;
+            gbSBarElemsCached = true;
         }
-    }
 
-    // Draw weapon selector or frags (if deathmatch)
-    if (gNetGame != gt_deathmatch) {
-        // Draw the weapon number box/container
-        LIBGPU_setXY0(spritePrim, 200, 205);
-        LIBGPU_setUV0(spritePrim, 180, 184);
-        LIBGPU_setWH(spritePrim, 51, 23);
-
-        I_AddPrim(spritePrim);
-
-        // Draw the micro numbers for each weapon.
-        // Note that numbers '1' and '2' are already baked into the status bar graphic, so we start at the shotgun.
-        {
-            LIBGPU_setWH(spritePrim, 4, 6);
-            spritePrim.v0 = 184;
-
-            uint8_t texU = 232;
-
-            for (int32_t weaponIdx = wp_shotgun; weaponIdx < NUMMICROS; ++weaponIdx) {
-                if (player.weaponowned[weaponIdx]) {
-                    LIBGPU_setXY0(spritePrim, gMicronumsX[weaponIdx] + 5, gMicronumsY[weaponIdx] + 3);
-                    spritePrim.u0 = texU;
-
-                    I_AddPrim(spritePrim);
-                }
+        DR_MODE drawModePrim = {};
+        const SRECT texWindow = { (int16_t) gTex_STATUS.texPageCoordX, (int16_t) gTex_STATUS.texPageCoordY, 256, 256 };
+        LIBGPU_SetDrawMode(drawModePrim, false, false, gTex_STATUS.texPageId, &texWindow);
+        I_AddPrim(drawModePrim);
 
-                texU += 4;
-            }
+        for (uint32_t spriteIdx = 0; spriteIdx < gNumSBarElemSprites; ++spriteIdx) {
+            I_AddPrim(gSBarElemSprites[spriteIdx]);
         }
-
-        // Draw the white box or highlight for the currently selected weapon
-        const int32_t microNumIdx = WEAPON_MICRO_INDEXES[weapon];
-
-        LIBGPU_setXY0(spritePrim, gMicronumsX[microNumIdx], gMicronumsY[microNumIdx]);
-        LIBGPU_setUV0(spritePrim, 164, 192);
-        LIBGPU_setWH(spritePrim, 12, 12);
-
-        I_AddPrim(spritePrim);
-    } else {
-        // Draw the frags container box
-        LIBGPU_setXY0(spritePrim, 209, 221);
-        LIBGPU_setUV0(spritePrim, 208, 243);
-        LIBGPU_setWH(spritePrim, 33, 8);
-
-        I_AddPrim(spritePrim);
-
-        // Draw the number of frags
-        I_DrawNumber(225, 204, player.frags);
-    }
-
-    // Draw the doomguy face if enabled
-    if (gbDrawSBFace) {
-        const facesprite_t& sprite = *gpCurSBFaceSprite;
-
-        LIBGPU_setXY0(spritePrim, sprite.xPos, sprite.yPos);
-        LIBGPU_setUV0(spritePrim, sprite.texU, sprite.texV);
-        LIBGPU_setWH(spritePrim, sprite.w, sprite.h);
-
-        I_AddPrim(spritePrim);
     }
+    #else
+        ST_DrawElements(player, spritePrim);
+    #endif
 
     // PsyDoom: draw level stats if enabled, or frags if playing deathmatch:
     #if PSYDOOM_MODS
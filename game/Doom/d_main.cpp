@@ -28,14 +28,18 @@
 #include "PsyDoom/IntroLogos.h"
 #include "PsyDoom/MapInfo/MapInfo.h"
 #include "PsyDoom/Movie/MoviePlayer.h"
+#include "PsyDoom/NetStats.h"
+#include "PsyDoom/Network.h"
 #include "PsyDoom/PlayerPrefs.h"
 #include "PsyDoom/ProgArgs.h"
 #include "PsyDoom/PsxPadButtons.h"
+#include "PsyDoom/SoakTest.h"
 #include "PsyDoom/Utils.h"
 #include "PsyDoom/Video.h"
 #include "PsyQ/LIBGPU.h"
 #include "Renderer/r_data.h"
 #include "Renderer/r_main.h"
+#include "Renderer/r_voxel.h"
 #include "UI/cr_main.h"
 #include "UI/in_main.h"
 #include "UI/le_main.h"
@@ -45,9 +49,13 @@
 #include "UI/ti_main.h"
 
 #if PSYDOOM_VULKAN_RENDERER
+    #include "DescriptorPool.h"
+    #include "DescriptorSet.h"
+    #include "PsyDoom/Vulkan/VFrameArena.h"
     #include "PsyDoom/Vulkan/VRenderer.h"
 #endif
 
+#include <algorithm>
 #include <chrono>
 #include <cstdio>
 #include <memory>
@@ -63,9 +71,9 @@ int32_t gTicCon;
 // The number of elapsed vblanks for all players
 int32_t gPlayersElapsedVBlanks[MAXPLAYERS];
 
-// PsyDoom: networking - what amount of elapsed vblanks we told the other player we will simulate next
+// PsyDoom: networking - what amount of elapsed vblanks we told the other player we will simulate next (in order, one per 'gNextTickInputs')
 #if PSYDOOM_MODS
-    int32_t gNextPlayerElapsedVBlanks;
+    int32_t gNextPlayerElapsedVBlanks[NET_MAX_INPUT_DELAY];
 #endif
 
 // Pointer to a buffer holding the demo and the current pointer within the buffer for playback/recording
@@ -90,6 +98,8 @@ bool gbDidAbortGame = false;
     double      gPrevFrameDuration;             // How long the previous frame took: used to try and provide more accurate interpolation
     float       gPerfAvgFps;                    // Performance counter: averaged FPS for the last few frames
     float       gPerfAvgUsec;                   // Performance counter: averaged microseconds duration for the last few frames
+    float       gPerfAvgLatencyUsec;            // Performance counter: averaged input to present microseconds for the last few frames (0 if unknown)
+    float       gPerfMaxTickUsec;               // Performance counter: longest ticker duration in microseconds for the last few frames (shows sim spikes)
     bool        gbIsFirstTick;                  // Set to 'true' for the very first tick only, 'false' thereafter
     bool        gbKeepInputEvents;              // Ticker request: if true then don't consume input events after invoking the current ticker in 'MiniLoop'
     std::byte*  gpDemoBufferEnd;                // PsyDoom: save the end pointer for the buffer, so we know when to end the demo; do this instead of hardcoding the end
@@ -218,6 +228,7 @@ void D_DoomMain() noexcept {
     #if PSYDOOM_MODS
         MapInfo::init();        // Do this first since GEC MAPINFO can affect the base lists of animations and switches
         P_InitSprites();
+        R_InitVoxels();         // Needs the sprite list
         P_InitMobjInfo();
         P_InitAnimDefs();
         P_InitSwitchDefs();
@@ -242,8 +253,8 @@ void D_DoomMain() noexcept {
         }
 
         // PsyDoom: play intro movies and logos unless disabled.
-        // Note: also skip them if we are playing a demo file or warping directly to a map.
-        const bool bSkipIntros = (Config::gbSkipIntros || ProgArgs::gPlayDemoFilePath[0] || gbStartupWarpToMap);
+        // Note: also skip them if we are playing a demo file, running a soak test or warping directly to a map.
+        const bool bSkipIntros = (Config::gbSkipIntros || ProgArgs::gPlayDemoFilePath[0] || SoakTest::isActive() || gbStartupWarpToMap);
 
         if (!bSkipIntros) {
             D_PlayIntros();
@@ -264,7 +275,10 @@ void D_DoomMain() noexcept {
             gOldTickInputs[playerIdx] = {};
         }
 
-        gNextTickInputs = {};
+        for (TickInputs& nextTickInputs : gNextTickInputs) {
+            nextTickInputs = {};
+        }
+
         gTicButtons = 0;
         gOldTicButtons = 0;
     #else
@@ -279,13 +293,18 @@ void D_DoomMain() noexcept {
         // This way it will be waiting for the player upon opening that menu:
         PlayerPrefs::pushLastPassword();
 
-        // PsyDoom: play a single demo file and exit if commanded.
-        // Also, if in headless mode then don't run the main game - only single demo playback is allowed.
+        // PsyDoom: play a single demo file or run a soak test on all maps and exit if commanded.
+        // Also, if in headless mode then don't run the main game - only single demo playback or soak testing is allowed.
         if (ProgArgs::gPlayDemoFilePath[0]) {
             RunDemoAtPath(ProgArgs::gPlayDemoFilePath);
             return;
         }
 
+        if (SoakTest::isActive()) {
+            SoakTest::run();
+            return;
+        }
+
         if (ProgArgs::gbHeadlessMode)
             return;
     #endif
@@ -479,7 +498,12 @@ gameaction_t RunDemoAtPath(const char* const filePath) noexcept {
     // After user requested demo playback has finished show the intermission screen, if applicable, so that stats can be examined.
     // We allow the intermission to be shown if not in headless mode and if the end of the level was actually reached (didn't die, quit, restart etc.).
     const bool bDidCompleteLevel = DemoPlayer::wasLevelCompleted();
-    const bool bShowIntermissionScreen = (bDidCompleteLevel && (!Input::isQuitRequested()) && (!ProgArgs::gbHeadlessMode));
+    const bool bShowIntermissionScreen = (
+        bDidCompleteLevel &&
+        (!Input::isQuitRequested()) &&
+        (!ProgArgs::gbHeadlessMode) &&
+        (!ProgArgs::gbTimeDemo)
+    );
 
     if (bShowIntermissionScreen) {
         // Never show the next map when playing a demo, because we immediately quit after this
@@ -622,6 +646,97 @@ void I_DrawEnabledPerfCounters() noexcept {
     // Show average FPS counter
     std::snprintf(msgBuffer, sizeof(msgBuffer), "FPS:  %.1f", gPerfAvgFps);
     I_DrawStringSmall(2 + widescreenAdjust, 10, msgBuffer, Game::getTexClut_STATUS(), 128, 255, 255, false, false);
+
+    // Show the longest ticker duration: this is how much of the frame time the game simulation took at worst
+    std::snprintf(msgBuffer, sizeof(msgBuffer), "TICK: %zu", (size_t)(gPerfMaxTickUsec + 0.5f));
+    I_DrawStringSmall(2 + widescreenAdjust, 18, msgBuffer, Game::getTexClut_STATUS(), 128, 255, 255, false, false);
+
+    // Show average input to present latency, if it's being measured (Vulkan only)
+    int32_t nextLineY = 26;
+
+    if (gPerfAvgLatencyUsec > 0.0f) {
+        std::snprintf(msgBuffer, sizeof(msgBuffer), "LAT:  %zu", (size_t)(gPerfAvgLatencyUsec + 0.5f));
+        I_DrawStringSmall(2 + widescreenAdjust, nextLineY, msgBuffer, Game::getTexClut_STATUS(), 128, 255, 255, false, false);
+        nextLineY += 8;
+    }
+
+    // Show how much of the Vulkan renderer's per-frame arena was used last frame and how many heap allocations it had to make (ideally '0')
+    #if PSYDOOM_VULKAN_RENDERER
+        if (Video::isUsingVulkanRenderPath()) {
+            const VFrameArena::ArenaStats& arenaStats = VFrameArena::getLastFrameStats();
+            std::snprintf(
+                msgBuffer,
+                sizeof(msgBuffer),
+                "ARN:  %zuK HEAP: %u",
+                (arenaStats.usedBytes + 1023) / 1024,
+                arenaStats.numHeapAllocs
+            );
+
+            I_DrawStringSmall(2 + widescreenAdjust, nextLineY, msgBuffer, Game::getTexClut_STATUS(), 128, 255, 255, false, false);
+            nextLineY += 8;
+
+            // Show how many descriptor sets were allocated and how many descriptor updates were done since the last frame (ideally '0/0')
+            static uint32_t lastNumDescSetAllocs = 0;
+            static uint32_t lastNumDescUpdates = 0;
+            const uint32_t numDescSetAllocs = vgl::DescriptorPool::getTotalNumSetAllocs();
+            const uint32_t numDescUpdates = vgl::DescriptorSet::getTotalNumUpdates();
+
+            std::snprintf(
+                msgBuffer,
+                sizeof(msgBuffer),
+                "DSC:  %u/%u",
+                numDescSetAllocs - lastNumDescSetAllocs,
+                numDescUpdates - lastNumDescUpdates
+            );
+
+            lastNumDescSetAllocs = numDescSetAllocs;
+            lastNumDescUpdates = numDescUpdates;
+
+            I_DrawStringSmall(2 + widescreenAdjust, nextLineY, msgBuffer, Game::getTexClut_STATUS(), 128, 255, 255, false, false);
+            nextLineY += 8;
+        }
+    #endif
+
+    // Show the net graph for network games: this helps tell if hitches are coming from the network or from the local frame time
+    if ((gNetGame != gt_single) && (!gbDemoPlayback) && Network::isConnected()) {
+        const int32_t netX = 2 + widescreenAdjust;
+        const int32_t netY = nextLineY;
+
+        // Round trip time and jitter (MS)
+        std::snprintf(msgBuffer, sizeof(msgBuffer), "RTT:  %d JIT: %d", (int)(NetStats::gRttMs + 0.5f), (int)(NetStats::gJitterMs + 0.5f));
+        I_DrawStringSmall(netX, netY, msgBuffer, Game::getTexClut_STATUS(), 128, 255, 255, false, false);
+
+        // Stalled ticks for this player and the other player, and the current input delay (ticks)
+        std::snprintf(msgBuffer, sizeof(msgBuffer), "STL:  %u/%u DLY: %d", NetStats::gNumStalledTicks, NetStats::gNumPeerStalledTicks, gNumNextTickInputs);
+        I_DrawStringSmall(netX, netY + 8, msgBuffer, Game::getTexClut_STATUS(), 128, 255, 255, false, false);
+
+        // Bytes per second sent and received
+        std::snprintf(msgBuffer, sizeof(msgBuffer), "BPS:  %d/%d", (int)(NetStats::gSendBytesPerSec + 0.5f), (int)(NetStats::gRecvBytesPerSec + 0.5f));
+        I_DrawStringSmall(netX, netY + 16, msgBuffer, Game::getTexClut_STATUS(), 128, 255, 255, false, false);
+
+        // Graph how long we waited on the network for each recent tick, oldest first; stalled ticks are shown in red.
+        // Each bar is 1 pixel per millisecond, capped to the height of the graph.
+        constexpr int32_t GRAPH_H = 16;
+        const int32_t graphBottomY = netY + 24 + GRAPH_H;
+
+        for (int32_t i = 0; i < NetStats::GRAPH_NUM_TICKS; ++i) {
+            const NetStats::GraphTick& graphTick = NetStats::gGraphTicks[(NetStats::gGraphNextTickIdx + i) % NetStats::GRAPH_NUM_TICKS];
+            const int32_t barH = std::clamp((int32_t)(graphTick.waitMs + 0.5f), 1, GRAPH_H);
+            const int16_t barX = (int16_t)(netX + i);
+
+            LINE_F2 line = {};
+            LIBGPU_SetLineF2(line);
+
+            if (graphTick.bStalled) {
+                LIBGPU_setRGB0(line, 255, 64, 64);
+            } else {
+                LIBGPU_setRGB0(line, 64, 255, 64);
+            }
+
+            LIBGPU_setXY2(line, barX, (int16_t) graphBottomY, barX, (int16_t)(graphBottomY - barH));
+            I_AddPrim(line);
+        }
+    }
 }
 #endif  // #if PSYDOOM_MODS
 
@@ -804,6 +919,9 @@ gameaction_t MiniLoop(
         uint32_t profilerNumFramesElapsed = 0;                              // How many frames have elapsed for the frame profiler
         gPerfAvgFps = 0;                                                    // Don't know this yet, frame profiler will tell us later!
         gPerfAvgUsec = 0;                                                   // Don't know this yet, frame profiler will tell us later!
+        gPerfAvgLatencyUsec = 0;                                            // Don't know this yet, the Vulkan renderer will tell us later!
+        gPerfMaxTickUsec = 0;                                               // Don't know this yet, frame profiler will tell us later!
+        double profilerMaxTickUsec = 0.0;                                   // Longest ticker duration for the current few frames
     #endif
 
     // Continue running the game loop until something causes us to exit
@@ -848,6 +966,23 @@ gameaction_t MiniLoop(
                 
                 P_GatherTickInputs(tickInputs);
                 gTicButtons = I_ReadGamepad();
+
+                // If running a soak test then the test drives the player, and it also decides when the map run ends
+                if (SoakTest::isRunningMap()) {
+                    gTicButtons = 0;
+
+                    if (!SoakTest::updateTickInputs(tickInputs)) {
+                        exitAction = ga_exit;
+                        break;
+                    }
+                }
+
+                // Let the Vulkan renderer know inputs were sampled, so it can measure input to present latency
+                #if PSYDOOM_VULKAN_RENDERER
+                    if (Video::gBackendType == Video::BackendType::Vulkan) {
+                        VRenderer::markInputsSampled();
+                    }
+                #endif
             #else
                 for (uint32_t playerIdx = 0; playerIdx < MAXPLAYERS; ++playerIdx) {
                     gOldTicButtons[playerIdx] = gTicButtons[playerIdx];
@@ -889,7 +1024,12 @@ gameaction_t MiniLoop(
 
                     // PsyDoom: check if the demo is done due to the pause key being pressed.
                     // When playing back check for the exit demo keys or for when the end of the demo is reached.
-                    const bool bIsAnyPlayerPausing = (gTickInputs[0].fTogglePause() || gTickInputs[1].fTogglePause());
+                    bool bIsAnyPlayerPausing = false;
+
+                    for (const TickInputs& inputs : gTickInputs) {
+                        bIsAnyPlayerPausing |= inputs.fTogglePause();
+                    }
+
                     const bool bDoingADemo = (gbDemoPlayback || gbNetIsGameBeingRecorded);
                     const bool bPausedDuringADemo = (bDoingADemo && bIsAnyPlayerPausing);
                     const bool bExitDemoPlayback = (gbDemoPlayback && bExitDemoPlaybackKeysPressed);
@@ -1012,8 +1152,18 @@ gameaction_t MiniLoop(
         // Call the ticker function to do updates for the frame.
         // Note that I am calling this in all situations, even if the framerate is capped and if we haven't passed enough time for a game tick.
         // That allows for possible update logic which runs > 30 Hz in future, like framerate uncapped turning movement.
+        #if PSYDOOM_MODS
+            const frametimer_t::time_point tickerStartTime = frametimer_t::now();
+        #endif
+
         exitAction = pTicker();
 
+        #if PSYDOOM_MODS
+            // PsyDoom: track the longest ticker duration for the frame profiler
+            const double tickerUsec = std::chrono::duration<double, std::micro>(frametimer_t::now() - tickerStartTime).count();
+            profilerMaxTickUsec = std::max(profilerMaxTickUsec, tickerUsec);
+        #endif
+
         if (exitAction != ga_nothing)
             break;
 
@@ -1072,10 +1222,23 @@ gameaction_t MiniLoop(
 
                 gPerfAvgUsec = (float) avgUsec;
                 gPerfAvgFps = (float) avgFps;
+                gPerfMaxTickUsec = (float) profilerMaxTickUsec;
+
+                // Get the average input to present latency from the Vulkan renderer too, if available
+                gPerfAvgLatencyUsec = 0.0f;
+
+                #if PSYDOOM_VULKAN_RENDERER
+                    double avgLatencyUsec = 0.0;
+
+                    if ((Video::gBackendType == Video::BackendType::Vulkan) && VRenderer::takeAvgInputToPresentUsec(avgLatencyUsec)) {
+                        gPerfAvgLatencyUsec = (float) avgLatencyUsec;
+                    }
+                #endif
 
                 // Begin a new profiling iteration
                 profilerNumFramesElapsed = 0;
                 profilerStartTime = now;
+                profilerMaxTickUsec = 0.0;
             }
         #endif
     }
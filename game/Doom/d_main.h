@@ -17,7 +17,7 @@ extern int32_t      gTicCon;
 extern int32_t      gPlayersElapsedVBlanks[MAXPLAYERS];
 
 #if PSYDOOM_MODS
-    extern int32_t  gNextPlayerElapsedVBlanks;
+    extern int32_t  gNextPlayerElapsedVBlanks[NET_MAX_INPUT_DELAY];
 #endif
 
 extern std::byte*   gpDemoBuffer;
@@ -37,6 +37,8 @@ extern bool         gbDidAbortGame;
     extern double       gPrevFrameDuration;
     extern float        gPerfAvgFps;
     extern float        gPerfAvgUsec;
+    extern float        gPerfAvgLatencyUsec;
+    extern float        gPerfMaxTickUsec;
     extern bool         gbIsFirstTick;
     extern bool         gbKeepInputEvents;
     extern std::byte*   gpDemoBufferEnd;
@@ -97,6 +97,7 @@ void NetPacket_Connect::byteSwap() noexcept {
     Endian::byteSwapEnumInPlace(startGameSkill);
     Endian::byteSwapInPlace(startMap);
     Endian::byteSwapInPlace(bIsDemoRecording);
+    Endian::byteSwapInPlace(bWantsUdpTransport);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -116,6 +117,10 @@ void NetPacket_Tick::byteSwap() noexcept {
     Endian::byteSwapInPlace(elapsedVBlanks);
     Endian::byteSwapInPlace(lastPacketDelayMs);
     inputs.byteSwap();
+    Endian::byteSwapInPlace(sendTimeMs);
+    Endian::byteSwapInPlace(echoTimeMs);
+    Endian::byteSwapInPlace(echoHoldMs);
+    Endian::byteSwapInPlace(recvSlackMs);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
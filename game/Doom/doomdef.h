@@ -13,6 +13,10 @@ struct state_t;
 struct state_t;
 struct subsector_t;
 
+#if PSYDOOM_MODS
+    struct touchnode_t;
+#endif
+
 enum dirtype_t : int32_t;
 enum mobjtype_t : int32_t;
 enum statenum_t : int32_t;
@@ -197,6 +201,9 @@ static constexpr uint32_t MF_BLEND_MODE_BIT2    = 0x40000000;   // PSX DOOM: 1 o
 #if PSYDOOM_MODS
     // New flag for PsyDoom: skips collisions against other things for this mobj_t
     static constexpr uint32_t MF_NO_MOBJ_COLLIDE = 0x80000000;
+
+    // New flag for PsyDoom: the monster chooses chase directions using flow field pathing (only set if enabled by the game settings)
+    static constexpr uint32_t MF_FLOWFIELD = 0x8000000;
 #endif
 
 // Blend modes - when thing flags are masked by 'MF_ALL_BLEND_FLAGS':
@@ -216,30 +223,70 @@ typedef void (*latecall_t)(mobj_t& mobj) noexcept;
 // Holds state for an object/thing in the game world
 struct mobj_t {
 #if PSYDOOM_MODS
+    // PsyDoom: the fields of this struct have been reordered so that the data read every tic by 'P_RunMobjBase' and the movement code comes
+    // first, packed into as few cache lines as possible. Data that is only needed occasionally (AI, respawning etc.) is moved to the end.
+    // The original layout is preserved below for non PsyDoom builds. Note that the first 5 fields must match 'degenmobj_t' exactly.
+    //
+    // Hot data: thing list traversal, position, velocity and state ticking
     InterpFixedT    x;                  // Global position in the world, in 16.16 format (supporting interpolation)
     InterpFixedT    y;
     InterpFixedT    z;
+    int32_t         tag;                // PsyDoom: a tag that can be assigned via scripting, for identification purposes
+    subsector_t*    subsector;          // What subsector the map object is currently in (and by extension, what sector)
+    mobj_t*         next;               // Intrusive fields for the global linked list of things
+    latecall_t      latecall;
+    player_t*       player;             // Associated player, if any
+    state_t*        state;              // State data
+    fixed_t         momx;               // Current velocity/speed: x, y & z
+    fixed_t         momy;
+    fixed_t         momz;
+    fixed_t         floorz;             // Highest floor in contact with map object
+    int32_t         tics;               // Tick counter for the current state
+    uint32_t        flags;              // See the MF_XXX series of flags for possible bits.
+    fixed_t         ceilingz;           // Lowest ceiling in contact with map object
+    fixed_t         radius;             // For collision detection
+    fixed_t         height;             // For collision detection
+    mobjtype_t      type;               // Type enum
+    mobj_t*         prev;
+    // Warm data: rendering, sector and blockmap linkage
+    InterpAngle     angle;              // Direction the thing is facing in
+    fixed_t         pitch;              // PsyDoom: Pitch/Look-angle (fixed point)
+    uint32_t        sprite;             // Current sprite displayed
+    uint32_t        frame;              // Current sprite frame displayed. Must use 'FF_FRAMEMASK' to get the actual frame number.
+    mobj_t*         snext;              // Intrusive fields for the linked list of things in the current sector
+    mobj_t*         sprev;
+    mobj_t*         bnext;              // Linked list of things in this blockmap block
+    mobj_t*         bprev;
+    mobjinfo_t*     info;               // Type data
+    // Cold data: AI, damage, respawning and reference tracking.
+    // Need to use weak refs for 'target' and 'tracer' since these objects can sometimes get destroyed without references to them being cleared.
+    int32_t         health;             // When this reaches '0' the object is dead
+    dirtype_t       movedir;            // For enemy AI, what direction the enemy is moving in
+    int32_t         movecount;          // When this reaches 0 a new dir is selected
+    MobjWeakPtr     target;             // The current map object being chased or attacked (if any), or for missiles the source object
+    int32_t         reactiontime;       // Time left until an attack is allowed
+    int32_t         threshold;          // Time left chasing the current target
+    uintptr_t       extradata;          // Used for latecall functions
+    int16_t         spawnx;             // Used for respawns: original spawn position (integer) x
+    int16_t         spawny;             // Used for respawns: original spawn position (integer) y
+    uint16_t        spawntype;          // Used for respawns: item 'DoomEd' type/number
+    int16_t         spawnangle;         // Used for respawns: item angle
+    MobjWeakPtr     tracer;             // Used by homing missiles
+    uint32_t        weakCountIdx;       // PsyDoom: index of the weak reference counter allocated for this map object ('0' if there are no weak references to it)
+    touchnode_t*    touchsectors;       // PsyDoom: list of sectors touched by the thing (only for things in the blockmap)
+    int32_t         lodcount;           // PsyDoom: monster AI LOD - number of chase/look updates deferred while the monster was dormant
 #else
     fixed_t         x;                  // Global position in the world, in 16.16 format
     fixed_t         y;
     fixed_t         z;
-#endif
-#if PSYDOOM_MODS
-    int32_t         tag;                // PsyDoom: a tag that can be assigned via scripting, for identification purposes
-#endif
     subsector_t*    subsector;          // What subsector the map object is currently in (and by extension, what sector)
     mobj_t*         prev;               // Intrusive fields for the global linked list of things
     mobj_t*         next;
     latecall_t      latecall;
     mobj_t*         snext;              // Intrusive fields for the linked list of things in the current sector
     mobj_t*         sprev;
-#if PSYDOOM_MODS
-    InterpAngle     angle;              // Direction the thing is facing in
-    fixed_t         pitch;              // PsyDoom: Pitch/Look-angle (fixed point)
-#else
     angle_t         angle;              // Direction the thing is facing in
     fixed_t         pitch;              // PsyDoom: Pitch/Look-angle (fixed point)
-#endif
     uint32_t        sprite;             // Current sprite displayed
     uint32_t        frame;              // Current sprite frame displayed. Must use 'FF_FRAMEMASK' to get the actual frame number.
     mobj_t*         bnext;              // Linked list of things in this blockmap block
@@ -259,13 +306,7 @@ struct mobj_t {
     int32_t         health;             // When this reaches '0' the object is dead
     dirtype_t       movedir;            // For enemy AI, what direction the enemy is moving in
     int32_t         movecount;          // When this reaches 0 a new dir is selected
-// PsyDoom: need to use weak refs!
-// These objects can sometimes get destroyed without references to them being cleared.
-#if PSYDOOM_MODS
-    MobjWeakPtr     target;             // The current map object being chased or attacked (if any), or for missiles the source object
-#else
     mobj_t*         target;             // The current map object being chased or attacked (if any), or for missiles the source object
-#endif
     int32_t         reactiontime;       // Time left until an attack is allowed
     int32_t         threshold;          // Time left chasing the current target
     player_t*       player;             // Associated player, if any
@@ -274,12 +315,6 @@ struct mobj_t {
     int16_t         spawny;             // Used for respawns: original spawn position (integer) y
     uint16_t        spawntype;          // Used for respawns: item 'DoomEd' type/number
     int16_t         spawnangle;         // Used for respawns: item angle
-// PsyDoom: need to use weak refs!
-// These objects can sometimes get destroyed without references to them being cleared.
-#if PSYDOOM_MODS
-    MobjWeakPtr     tracer;             // Used by homing missiles
-    uint32_t        weakCountIdx;       // PsyDoom: index of the weak reference counter allocated for this map object ('0' if there are no weak references to it)
-#else
     mobj_t*         tracer;             // Used by homing missiles
 #endif
 };
@@ -568,6 +603,7 @@ struct player_t {
         skill_t     startGameSkill;     // Only sent by the server for the game: what skill level will be used
         int16_t     startMap;           // Only sent by the server for the game: what starting map will be used
         uint8_t     bIsDemoRecording;   // Whether this player is demo recording: affects whether pause can be used
+        uint8_t     bWantsUdpTransport; // Whether this player wants tick updates sent over UDP: only used if both players want it
 
         // Byte swapping for Endian correction
         void byteSwap() noexcept;
@@ -582,11 +618,20 @@ struct player_t {
         int32_t     elapsedVBlanks;     // How many vblanks have elapsed for the player sending the update
         int32_t     lastPacketDelayMs;  // Message from this peer: how long the last packet received was delayed from when we expected it (MS). Used to adjust time.
         TickInputs  inputs;             // Inputs for the player sending this update
+        uint16_t    sendTimeMs;         // Network telemetry: the sender's clock (MS, wrapping) when this packet was sent
+        uint16_t    echoTimeMs;         // Network telemetry: 'sendTimeMs' of the last packet the sender received from us, echoed back to measure round trip time
+        uint16_t    echoHoldMs;         // Network telemetry: how long the sender held the echoed packet before sending this one (MS); subtracted from round trip time
+        int16_t     recvSlackMs;        // Network telemetry: how long the last packet the sender received from us was waiting before it was needed (MS), or minus how long the sender stalled waiting on it
 
         // Byte swapping for Endian correction
         void byteSwap() noexcept;
         void endianCorrect() noexcept;
     };
 
-    static_assert(sizeof(NetPacket_Tick) == 26, "NetPacket_Tick struct size mismatch");
+    static_assert(sizeof(NetPacket_Tick) == 36, "NetPacket_Tick struct size mismatch");
+
+    // Maximum number of ticks ahead of when they are used that a player's inputs can be sent in a network game (the input delay).
+    // The error checking value in each tick packet is always for the game state this many ticks before the tick the packet is for, so that
+    // each player can change their own input delay at any time (up to this amount) without the other player needing to know about it.
+    static constexpr int32_t NET_MAX_INPUT_DELAY = 4;
 #endif
@@ -3,18 +3,25 @@
 #include "Base/i_main.h"
 #include "cdmaptbl.h"
 #include "FatalErrors.h"
+#include "Gpu.h"
 #include "PsyDoom/Cheats.h"
 #include "PsyDoom/Config/Config.h"
 #include "PsyDoom/Controls.h"
+#include "PsyDoom/FrameProfiler.h"
 #include "PsyDoom/Game.h"
 #include "PsyDoom/Input.h"
 #include "PsyDoom/IntroLogos.h"
+#include "PsyDoom/JobSystem.h"
 #include "PsyDoom/ModMgr.h"
 #include "PsyDoom/PlayerPrefs.h"
 #include "PsyDoom/ProgArgs.h"
 #include "PsyDoom/PsxVm.h"
+#include "PsyDoom/SaveFileWriter.h"
+#include "PsyDoom/ThinkerPool.h"
+#include "PsyDoom/ThreadUtils.h"
 #include "PsyDoom/Utils.h"
 #include "PsyDoom/Video.h"
+#include "Wess/psxcd.h"
 
 #if PSYDOOM_MODS
     // PsyDoom: a flag set to 'true' if the result of demo playback is unexpected/wrong (when checking demo results).
@@ -62,6 +69,20 @@ int psx_main(const int argc, const char* const* const argv) noexcept {
         Input::init();
         PlayerPrefs::load();
 
+        // Apply the user's priority and CPU core settings for this (the main) thread and start up the job worker threads
+        const ThreadUtils::ThreadSettings mainThreadSettings = ThreadUtils::makeThreadSettings(Config::gMainThreadPriority, Config::gMainThreadCores);
+        ThreadUtils::applyToCurrentThread(mainThreadSettings);
+
+        JobSystem::init(
+            Config::gJobWorkerThreads,
+            ThreadUtils::makeThreadSettings(Config::gJobWorkerThreadPriority, Config::gJobWorkerThreadCores),
+            mainThreadSettings.coreMask
+        );
+
+        #if PSYDOOM_FRAME_PROFILER
+            FrameProfiler::init();
+        #endif
+
         // Initialize the emulated PSX components using the PSX Doom disc (supplied as a .cue file).
         // This must be provided in order for the game to run.
         const char* const cueFilePath = (ProgArgs::gCueFileOverride) ? ProgArgs::gCueFileOverride : Config::gCueFilePath.c_str();
@@ -77,15 +98,26 @@ int psx_main(const int argc, const char* const* const argv) noexcept {
             );
         }
 
+        // Note: this starts mounting the game disc in the background, which must be waited on before the disc contents are used.
         if (!PsxVm::init(cueFilePath))
             return 1;
 
+        // If there are job worker threads then use them to rasterize the PSX GPU's draws in parallel (classic renderer).
+        // Use a few bands of rows per thread so the work can be balanced out, since some parts of the screen are more expensive to draw.
+        if (JobSystem::getNumWorkerThreads() > 0) {
+            Gpu::enableDeferredDraws(PsxVm::gGpu, JobSystem::runLargeJobs, (JobSystem::getNumWorkerThreads() + 1) * 4);
+        }
+
+        // Initialize the display while the game disc is being mounted in the background.
+        // Note: the window, video backend and pipelines don't depend on anything from the disc.
+        Video::initVideo();
+
         // Determine the game type and variant and initialize the table of files on the CD from the file system
+        PsxVm::waitForDiscMount();
         Game::determineGameTypeAndVariant();
         CdMapTbl_Init();
 
-        // Initialize the display, modding manager, cheats and intro logos
-        Video::initVideo();
+        // Initialize the modding manager, cheats and intro logos
         ModMgr::init();
         Cheats::init();
         IntroLogos::init();
@@ -96,14 +128,23 @@ int psx_main(const int argc, const char* const* const argv) noexcept {
 
     // PsyDoom: cleanup logic after Doom itself is done and save player prefs (unless headless mode)
     #if PSYDOOM_MODS
-        const bool bIsCheckingADemoResult = (ProgArgs::gCheckDemoResultFilePath[0] != 0);
+        const bool bIsCheckingADemoResult = ((ProgArgs::gCheckDemoResultFilePath[0] != 0) || (ProgArgs::gCheckStateHashFilePath[0] != 0));
 
         if (!ProgArgs::gbHeadlessMode) {
             PlayerPrefs::save();
         }
 
+        SaveFileWriter::shutdown();
+
+        #if PSYDOOM_FRAME_PROFILER
+            FrameProfiler::shutdown();
+        #endif
+
+        ThinkerPool::shutdown();
+        JobSystem::shutdown();
         IntroLogos::shutdown();
         Video::shutdownVideo();
+        psxcd_exit();
         PsxVm::shutdown();
         Cheats::shutdown();
         ModMgr::shutdown();
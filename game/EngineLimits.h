@@ -31,7 +31,9 @@ static constexpr bool IS_64_BIT_BUILD = (sizeof(void*) > 4);
 // most demanding game that PsyDoom supports.
 //------------------------------------------------------------------------------------------------------------------------------------------
 #if PSYDOOM_LIMIT_REMOVING
-    static constexpr uint32_t Z_HEAP_DEFAULT_SIZE = 64 * 1024 * 1024;
+    // Limit removing: this is only the initial size of the heap; it grows by whole chunks of 'Z_HEAP_CHUNK_SIZE' bytes on demand.
+    static constexpr uint32_t Z_HEAP_DEFAULT_SIZE = 16 * 1024 * 1024;
+    static constexpr uint32_t Z_HEAP_CHUNK_SIZE = 8 * 1024 * 1024;
 #else
     static constexpr uint32_t Z_HEAP_SIZE = 1800 * 1024 * (IS_64_BIT_BUILD ? 2 : 1);
 #endif
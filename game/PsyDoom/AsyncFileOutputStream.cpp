@@ -0,0 +1,184 @@
+#include "AsyncFileOutputStream.h"
+
+#include <algorithm>
+#include <cstring>
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Opens the specified file for writing and starts the writer thread; throws 'StreamException' if the file can't be opened
+//------------------------------------------------------------------------------------------------------------------------------------------
+AsyncFileOutputStream::AsyncFileOutputStream(const char* const filePath, const bool bAppend, const uint32_t maxQueuedChunks) THROWS
+    : mpFile(std::fopen(filePath, (bAppend) ? "ab" : "wb"))
+    , mMaxQueuedChunks(std::max(maxQueuedChunks, 1u))
+    , mNumBytesCommitted(0)
+    , mPendingBytes()
+    , mMutex()
+    , mWriterCV()
+    , mProducerCV()
+    , mQueuedChunks()
+    , mFreeChunks()
+    , mbWriterBusy(false)
+    , mbWriteError(false)
+    , mbWriterQuit(false)
+    , mWriterThread()
+{
+    if (!mpFile)
+        throw StreamException();
+
+    mWriterThread = std::thread([this]() noexcept { writerThreadMain(); });
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Commits any uncommitted bytes, waits for the writer thread to write everything and then closes the file.
+// Any errors are ignored: call 'flush' beforehand to check that all data was written successfully.
+//------------------------------------------------------------------------------------------------------------------------------------------
+AsyncFileOutputStream::~AsyncFileOutputStream() noexcept {
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        if (!mPendingBytes.empty()) {
+            mQueuedChunks.emplace_back(std::move(mPendingBytes));
+        }
+
+        mbWriterQuit = true;
+    }
+
+    mWriterCV.notify_one();
+    mWriterThread.join();
+
+    if (mpFile) {
+        std::fclose(mpFile);
+        mpFile = nullptr;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Writes bytes to the stream: they are held in memory until the next commit
+//------------------------------------------------------------------------------------------------------------------------------------------
+void AsyncFileOutputStream::writeBytes(const void* const pSrcBytes, const size_t numBytes) THROWS {
+    checkForWriteError();
+
+    if (numBytes > 0) {
+        const size_t oldSize = mPendingBytes.size();
+        mPendingBytes.resize(oldSize + numBytes);
+        std::memcpy(mPendingBytes.data() + oldSize, pSrcBytes, numBytes);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Writes the given byte value the specified number of times: the bytes are held in memory until the next commit
+//------------------------------------------------------------------------------------------------------------------------------------------
+void AsyncFileOutputStream::fillBytes(const size_t numBytes, const std::byte byteValue) THROWS {
+    checkForWriteError();
+    mPendingBytes.resize(mPendingBytes.size() + numBytes, byteValue);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Returns the current offset in the stream, including bytes that have not been committed or written to the file yet
+//------------------------------------------------------------------------------------------------------------------------------------------
+size_t AsyncFileOutputStream::tell() THROWS {
+    checkForWriteError();
+    return mNumBytesCommitted + mPendingBytes.size();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Commits all written bytes and blocks until the writer thread has written and flushed all of them to the file.
+// Throws 'StreamException' if any of the data could not be written.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void AsyncFileOutputStream::flush() THROWS {
+    commit();
+
+    std::unique_lock<std::mutex> lock(mMutex);
+    mProducerCV.wait(lock, [&]() noexcept {
+        return (mbWriteError || (mQueuedChunks.empty() && (!mbWriterBusy)));
+    });
+
+    if (mbWriteError)
+        throw StreamException();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Hands all bytes written since the last commit over to the writer thread, to be written to the file as one chunk.
+// Blocks if the maximum number of chunks are already waiting to be written.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void AsyncFileOutputStream::commit() THROWS {
+    if (mPendingBytes.empty()) {
+        checkForWriteError();
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(mMutex);
+    mProducerCV.wait(lock, [&]() noexcept {
+        return (mbWriteError || (mQueuedChunks.size() < mMaxQueuedChunks));
+    });
+
+    if (mbWriteError)
+        throw StreamException();
+
+    // Queue up the chunk and grab a previously written chunk buffer (if any) for the next lot of writes
+    mNumBytesCommitted += mPendingBytes.size();
+    mQueuedChunks.emplace_back(std::move(mPendingBytes));
+    mPendingBytes.clear();
+
+    if (!mFreeChunks.empty()) {
+        mPendingBytes = std::move(mFreeChunks.back());
+        mFreeChunks.pop_back();
+    }
+
+    lock.unlock();
+    mWriterCV.notify_one();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Throws 'StreamException' if the writer thread failed to write to the file
+//------------------------------------------------------------------------------------------------------------------------------------------
+void AsyncFileOutputStream::checkForWriteError() THROWS {
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    if (mbWriteError)
+        throw StreamException();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Entry point for the writer thread: writes and flushes committed chunks in order until told to quit and there is nothing left to write.
+// After an error all further chunks are discarded.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void AsyncFileOutputStream::writerThreadMain() noexcept {
+    std::unique_lock<std::mutex> lock(mMutex);
+
+    while (true) {
+        mWriterCV.wait(lock, [&]() noexcept {
+            return (mbWriterQuit || (!mQueuedChunks.empty()));
+        });
+
+        if (mQueuedChunks.empty())
+            return;     // Told to quit and nothing left to write
+
+        // Write the chunk outside of the lock
+        std::vector<std::byte> chunk = std::move(mQueuedChunks.front());
+        mQueuedChunks.pop_front();
+        mbWriterBusy = true;
+        const bool bSkipWrite = mbWriteError;
+        lock.unlock();
+
+        bool bWriteOk = true;
+
+        if (!bSkipWrite) {
+            bWriteOk = (
+                (std::fwrite(chunk.data(), chunk.size(), 1, mpFile) == 1) &&
+                (std::fflush(mpFile) == 0)
+            );
+        }
+
+        // Publish the result and recycle the chunk buffer
+        chunk.clear();
+        lock.lock();
+        mbWriterBusy = false;
+        mbWriteError = (mbWriteError || (!bWriteOk));
+
+        if (mFreeChunks.size() < mMaxQueuedChunks) {
+            mFreeChunks.emplace_back(std::move(chunk));
+        }
+
+        mProducerCV.notify_all();
+    }
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "OutputStream.h"
+
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// A file output stream which writes to disk on a background thread, so that the thread producing the data never waits on file I/O.
+//
+// Written bytes are held in memory until 'commit' is called, which hands them over to the writer thread as a single chunk. Each chunk is
+// written and flushed to the file in one go, so if the program crashes the file will only ever be missing the most recent chunks - it will
+// not end partway through the data in between two commits. Callers should therefore only commit at points where the data is consistent.
+//
+// The number of chunks waiting to be written is bounded: if the writer thread falls too far behind then 'commit' blocks until it catches up.
+// Write errors on the writer thread are reported by throwing 'StreamException' from the next call made on the stream.
+//------------------------------------------------------------------------------------------------------------------------------------------
+class AsyncFileOutputStream final : public OutputStream {
+public:
+    AsyncFileOutputStream(const char* const filePath, const bool bAppend, const uint32_t maxQueuedChunks = 8) THROWS;
+    virtual ~AsyncFileOutputStream() noexcept override;
+
+    virtual void writeBytes(const void* const pSrcBytes, const size_t numBytes) THROWS override;
+    virtual void fillBytes(const size_t numBytes, const std::byte byteValue) THROWS override;
+    virtual size_t tell() THROWS override;
+    virtual void flush() THROWS override;
+
+    void commit() THROWS;
+
+private:
+    AsyncFileOutputStream(const AsyncFileOutputStream& other) = delete;
+    AsyncFileOutputStream& operator = (const AsyncFileOutputStream& other) = delete;
+
+    void checkForWriteError() THROWS;
+    void writerThreadMain() noexcept;
+
+    FILE*                               mpFile;                 // The file being written to: only used by the writer thread once it starts
+    const uint32_t                      mMaxQueuedChunks;       // Maximum number of chunks which can be waiting to be written before 'commit' blocks
+    size_t                              mNumBytesCommitted;     // How many bytes have been handed to the writer thread in total
+    std::vector<std::byte>              mPendingBytes;          // Bytes written which have not been committed yet
+    std::mutex                          mMutex;                 // Guards all of the fields below
+    std::condition_variable             mWriterCV;              // Signalled when the writer thread has a chunk to write or should quit
+    std::condition_variable             mProducerCV;            // Signalled when the writer thread finishes writing a chunk
+    std::deque<std::vector<std::byte>>  mQueuedChunks;          // Committed chunks waiting to be written by the writer thread
+    std::vector<std::vector<std::byte>> mFreeChunks;            // Chunk buffers that were written and can be reused, to avoid reallocation
+    bool                                mbWriterBusy;           // True while the writer thread is writing a chunk (outside of the lock)
+    bool                                mbWriteError;           // Set by the writer thread if writing or flushing the file fails
+    bool                                mbWriterQuit;           // Tells the writer thread to finish writing all chunks and exit
+    std::thread                         mWriterThread;          // Writes committed chunks to the file
+};
@@ -4,9 +4,22 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstring>
+
+// Use SSE2 to process 4 samples at a time for the parts of compression which don't depend on the previous sample, where available.
+// SSE2 is always available on 64-bit x86 and is enabled by most 32-bit x86 builds.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+    #define AUDIO_COMPRESSOR_USE_SSE2 1
+    #include <emmintrin.h>
+#else
+    #define AUDIO_COMPRESSOR_USE_SSE2 0
+#endif
 
 BEGIN_NAMESPACE(AudioCompressor)
 
+static constexpr uint32_t MAX_SUB_BLOCK_SIZE = 256;     // Blocks are processed in sub blocks of at most this many samples
+static constexpr float MAX_SIGNAL_POWER = 1000000.0f;   // Signal power is clamped to this
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Initializes the audio compressor state with the specified settings.
 //
@@ -53,58 +66,227 @@ void init(
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Perform dynamic range compression on a single audio sample.
+// Fast approximations of 'log2(x)' for normal positive 'x' and '2^x' for 'x' in the range [-126, 127].
+// Both split off the exponent and use a polynomial for the rest: max error is ~1.7e-5 for 'log2' (~5e-5 dB) and ~1.2e-7 relative for '2^x'.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static constexpr float LOG2_C1 = 1.4418799f;
+static constexpr float LOG2_C2 = -0.708865218f;
+static constexpr float LOG2_C3 = 0.41524556f;
+static constexpr float LOG2_C4 = -0.193516524f;
+static constexpr float LOG2_C5 = 0.0452682923f;
+
+static constexpr float EXP2_C1 = 0.693152535f;
+static constexpr float EXP2_C2 = 0.240152444f;
+static constexpr float EXP2_C3 = 0.0558365986f;
+static constexpr float EXP2_C4 = 0.00897289862f;
+static constexpr float EXP2_C5 = 0.00188540406f;
+
+static constexpr float DB_PER_LOG2_POWER = 3.01029996f;             // 10 * log10(2): converts 'log2' of signal power to decibels
+static constexpr float LOG2_GAIN_PER_DB = 0.166096405f;             // log2(10) / 20: converts decibels of amplitude gain to 'log2' gain
+
+static float fastLog2(const float x) noexcept {
+    uint32_t bits;
+    std::memcpy(&bits, &x, sizeof(bits));
+    const int32_t exponent = (int32_t)(bits >> 23) - 127;
+    bits = (bits & 0x007FFFFFu) | 0x3F800000u;
+
+    float mantissa;
+    std::memcpy(&mantissa, &bits, sizeof(mantissa));
+    const float t = mantissa - 1.0f;
+    return (float) exponent + t * (LOG2_C1 + t * (LOG2_C2 + t * (LOG2_C3 + t * (LOG2_C4 + t * LOG2_C5))));
+}
+
+static float fastExp2(const float x) noexcept {
+    const float whole = std::floor(x);
+    const float t = x - whole;
+    const uint32_t scaleBits = (uint32_t)((int32_t) whole + 127) << 23;
+
+    float scale;
+    std::memcpy(&scale, &scaleBits, sizeof(scale));
+    return scale * (1.0f + t * (EXP2_C1 + t * (EXP2_C2 + t * (EXP2_C3 + t * (EXP2_C4 + t * EXP2_C5)))));
+}
+
+#if AUDIO_COMPRESSOR_USE_SSE2
+    static __m128 fastLog2(const __m128 x) noexcept {
+        const __m128i bits = _mm_castps_si128(x);
+        const __m128 exponent = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(127)));
+        const __m128i mantissaBits = _mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x007FFFFF)), _mm_set1_epi32(0x3F800000));
+        const __m128 t = _mm_sub_ps(_mm_castsi128_ps(mantissaBits), _mm_set1_ps(1.0f));
+
+        __m128 poly = _mm_set1_ps(LOG2_C5);
+        poly = _mm_add_ps(_mm_mul_ps(poly, t), _mm_set1_ps(LOG2_C4));
+        poly = _mm_add_ps(_mm_mul_ps(poly, t), _mm_set1_ps(LOG2_C3));
+        poly = _mm_add_ps(_mm_mul_ps(poly, t), _mm_set1_ps(LOG2_C2));
+        poly = _mm_add_ps(_mm_mul_ps(poly, t), _mm_set1_ps(LOG2_C1));
+        return _mm_add_ps(exponent, _mm_mul_ps(poly, t));
+    }
+
+    static __m128 fastExp2(const __m128 x) noexcept {
+        // SSE2 has no 'floor' so truncate and then correct for negative numbers
+        const __m128 truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(x));
+        const __m128 whole = _mm_sub_ps(truncated, _mm_and_ps(_mm_cmpgt_ps(truncated, x), _mm_set1_ps(1.0f)));
+        const __m128 t = _mm_sub_ps(x, whole);
+        const __m128 scale = _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(_mm_cvttps_epi32(whole), _mm_set1_epi32(127)), 23));
+
+        __m128 poly = _mm_set1_ps(EXP2_C5);
+        poly = _mm_add_ps(_mm_mul_ps(poly, t), _mm_set1_ps(EXP2_C4));
+        poly = _mm_add_ps(_mm_mul_ps(poly, t), _mm_set1_ps(EXP2_C3));
+        poly = _mm_add_ps(_mm_mul_ps(poly, t), _mm_set1_ps(EXP2_C2));
+        poly = _mm_add_ps(_mm_mul_ps(poly, t), _mm_set1_ps(EXP2_C1));
+        return _mm_mul_ps(scale, _mm_add_ps(_mm_set1_ps(1.0f), _mm_mul_ps(poly, t)));
+    }
+#endif
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Stage 1 of compression: replace NaN samples with silence and compute the instantaneous signal power of each stereo sample.
+// The power is found by squaring the signal (Ohm's law) and is the max power of both channels, clamped to within a reasonable range.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void computeSignalPower(float* const pSamples, float* const pPowerOut, const uint32_t numSamples) noexcept {
+    uint32_t i = 0;
+
+    #if AUDIO_COMPRESSOR_USE_SSE2
+        const __m128 maxPower = _mm_set1_ps(MAX_SIGNAL_POWER);
+
+        for (; i + 4 <= numSamples; i += 4) {
+            __m128 lr01 = _mm_loadu_ps(pSamples + i * 2);
+            __m128 lr23 = _mm_loadu_ps(pSamples + i * 2 + 4);
+            lr01 = _mm_and_ps(lr01, _mm_cmpord_ps(lr01, lr01));
+            lr23 = _mm_and_ps(lr23, _mm_cmpord_ps(lr23, lr23));
+            _mm_storeu_ps(pSamples + i * 2, lr01);
+            _mm_storeu_ps(pSamples + i * 2 + 4, lr23);
+
+            const __m128 left = _mm_shuffle_ps(lr01, lr23, _MM_SHUFFLE(2, 0, 2, 0));
+            const __m128 right = _mm_shuffle_ps(lr01, lr23, _MM_SHUFFLE(3, 1, 3, 1));
+            const __m128 power = _mm_max_ps(_mm_mul_ps(left, left), _mm_mul_ps(right, right));
+            _mm_storeu_ps(pPowerOut + i, _mm_min_ps(power, maxPower));
+        }
+    #endif
+
+    for (; i < numSamples; ++i) {
+        float& sampleL = pSamples[i * 2 + 0];
+        float& sampleR = pSamples[i * 2 + 1];
+        sampleL = (!std::isnan(sampleL)) ? sampleL : 0.0f;
+        sampleR = (!std::isnan(sampleR)) ? sampleR : 0.0f;
+        pPowerOut[i] = std::min(std::max(sampleL * sampleL, sampleR * sampleR), MAX_SIGNAL_POWER);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Stage 3 of compression: convert smoothed signal power to the instantaneous/non-smoothed gain in decibels.
+// Only negative gain is allowed, never a positive gain. Within the knee region the compression ratio is faded in gradually.
+//
+// This is a simplified form of the following, which gives the same result:
+//      goalAboveThresholdDB = aboveThresholdDB * compressionRatio
+//      smoothedGoalAboveThresholdDB = goalAboveThresholdDB * compressionStrength + (1.0f - compressionStrength) * aboveThresholdDB
+//      instantGainDB = smoothedGoalAboveThresholdDB - aboveThresholdDB
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void computeInstantGain(const State& state, float* const pPowerToGain, const uint32_t numSamples) noexcept {
+    const float thresholdDB = state.thresholdDB;
+    const float ratioMinus1 = state.compressionRatio - 1.0f;
+    const float invKneeWidthDB = (state.kneeWidthDB > 0.0f) ? 1.0f / state.kneeWidthDB : 1.0e30f;
+    uint32_t i = 0;
+
+    #if AUDIO_COMPRESSOR_USE_SSE2
+        const __m128 dbPerLog2 = _mm_set1_ps(DB_PER_LOG2_POWER);
+        const __m128 minDB = _mm_set1_ps(-100.0f);
+        const __m128 maxDB = _mm_set1_ps(+100.0f);
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 one = _mm_set1_ps(1.0f);
+
+        for (; i + 4 <= numSamples; i += 4) {
+            const __m128 powerDB = _mm_min_ps(_mm_max_ps(_mm_mul_ps(fastLog2(_mm_loadu_ps(pPowerToGain + i)), dbPerLog2), minDB), maxDB);
+            const __m128 aboveThresholdDB = _mm_sub_ps(powerDB, _mm_set1_ps(thresholdDB));
+            const __m128 strength = _mm_min_ps(_mm_max_ps(_mm_mul_ps(aboveThresholdDB, _mm_set1_ps(invKneeWidthDB)), zero), one);
+            const __m128 gainDB = _mm_mul_ps(_mm_mul_ps(aboveThresholdDB, _mm_set1_ps(ratioMinus1)), strength);
+            _mm_storeu_ps(pPowerToGain + i, _mm_min_ps(_mm_max_ps(gainDB, minDB), zero));
+        }
+    #endif
+
+    for (; i < numSamples; ++i) {
+        const float powerDB = std::clamp(fastLog2(pPowerToGain[i]) * DB_PER_LOG2_POWER, -100.0f, +100.0f);
+        const float aboveThresholdDB = powerDB - thresholdDB;
+        const float strength = std::clamp(aboveThresholdDB * invKneeWidthDB, 0.0f, 1.0f);
+        pPowerToGain[i] = std::clamp(aboveThresholdDB * ratioMinus1 * strength, -100.0f, 0.0f);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Stage 5 of compression: convert the smoothed gain (plus post gain) from decibels to linear gain and apply it to the samples
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void applyGain(const State& state, float* const pSamples, const float* const pGainDB, const uint32_t numSamples) noexcept {
+    const float postGainDB = state.postGainDB;
+    uint32_t i = 0;
+
+    #if AUDIO_COMPRESSOR_USE_SSE2
+        for (; i + 4 <= numSamples; i += 4) {
+            const __m128 gainDB = _mm_add_ps(_mm_loadu_ps(pGainDB + i), _mm_set1_ps(postGainDB));
+            const __m128 gain = fastExp2(_mm_mul_ps(gainDB, _mm_set1_ps(LOG2_GAIN_PER_DB)));
+            _mm_storeu_ps(pSamples + i * 2, _mm_mul_ps(_mm_loadu_ps(pSamples + i * 2), _mm_unpacklo_ps(gain, gain)));
+            _mm_storeu_ps(pSamples + i * 2 + 4, _mm_mul_ps(_mm_loadu_ps(pSamples + i * 2 + 4), _mm_unpackhi_ps(gain, gain)));
+        }
+    #endif
+
+    for (; i < numSamples; ++i) {
+        const float gain = fastExp2((pGainDB[i] + postGainDB) * LOG2_GAIN_PER_DB);
+        pSamples[i * 2 + 0] *= gain;
+        pSamples[i * 2 + 1] *= gain;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Perform dynamic range compression on a block of interleaved stereo samples, in place.
+//
+// The low pass filtering of signal power and the attack/release smoothing of gain depend on the previous sample so must be done one sample
+// at a time, but everything else (signal power, gain curve and applying gain) is done for multiple samples at once.
 // 
 // References for this implementation:
 //      https://openaudio.blogspot.com/2017/01/basic-dynamic-range-compressor.html
 //      https://github.com/chipaudette/OpenAudio_ArduinoLibrary/blob/master/AudioEffectCompressor_F32.h
 //      https://github.com/chipaudette/OpenAudio_ArduinoLibrary/blob/81492cc5aca290d95cd6b681729302148cb7e109/AudioEffectCompressor_F32.h
 //------------------------------------------------------------------------------------------------------------------------------------------
-void compress(State& state, float& sampleL, float& sampleR) noexcept {
-    // Safety check: recover from input NaN values
-    sampleL = (!std::isnan(sampleL)) ? sampleL : 0.0f;
-    sampleR = (!std::isnan(sampleR)) ? sampleR : 0.0f;
-
-    // Compute the instantaneous signal power of the current sample by squaring the signal (Ohm's law).
-    // Take the max power of both channels and clamp to within a reasonable range:
-    const float signalPower = std::min(std::max(sampleL * sampleL, sampleR * sampleR), 1000000.0f);
-
-    // Smooth this power with the previous sample and save as the new smoothed sample.
-    // Note: prevent smoothed signal power from dropping below -100 dBFS to prevent negative infinity when calculating signal power.
-    const float lpfLerp = state.lpfLerpFactor;
-    const float smoothedSignalPower = std::max(signalPower * lpfLerp + state.lpfPrevSignalPower * (1.0f - lpfLerp), 1.0e-10f);
-    ASSERT((!std::isnan(smoothedSignalPower)) && (!std::isinf(smoothedSignalPower)));
-
-    state.lpfPrevSignalPower = smoothedSignalPower;
-
-    // Compute the signal power in decibels.
-    // Note: normally the formula to convert is 'dB = 20 * log10(amplitude)' but we've already squared the signal so instead the multiply is by '10' instead.
-    const float signalPowerDB = std::clamp(10.0f * std::log10(smoothedSignalPower), -100.0f, +100.0f);
-    ASSERT((!std::isnan(signalPowerDB)) && (!std::isinf(signalPowerDB)));
-
-    // Compute the instantaneous/non-smoothed gain in decibels.
-    // Don't allow a positive gain, only negative!
-    const float aboveThresholdDB = signalPowerDB - state.thresholdDB;
-    const float goalAboveThresholdDB = aboveThresholdDB * state.compressionRatio;
-    const float kneeWidthDB = state.kneeWidthDB;
-    const float compressionStrength = std::clamp((kneeWidthDB > 0) ? aboveThresholdDB / kneeWidthDB : 1.0f, 0.0f, 1.0f);
-    ASSERT((!std::isnan(compressionStrength)) && (!std::isinf(compressionStrength)));
-
-    const float smoothedGoalAboveThresholdDB = goalAboveThresholdDB * compressionStrength + (1.0f - compressionStrength) * aboveThresholdDB;
-    const float instantGainDB = std::clamp(smoothedGoalAboveThresholdDB - aboveThresholdDB, -100.0f, 0.0f);
-
-    // Compute the smoothed gain in decibels and save as the new smoothed sample
-    const float prevGainDB = state.prevSampleGainDB;
-    const float gainLerp = (instantGainDB < prevGainDB) ? state.attackLerpFactor : state.releaseLerpFactor;
-    const float smoothedGainDB = instantGainDB * gainLerp + prevGainDB * (1.0f - gainLerp);
-    state.prevSampleGainDB = smoothedGainDB;
-
-    // Convert the gain to linear gain and apply it to the sample.
-    // Also apply the post gain at this point...
-    const float finalGainDB = smoothedGainDB + state.postGainDB;
-    const float linearGain = std::pow(10.0f, finalGainDB * (1.0f / 20.0f));
-    sampleL *= linearGain;
-    sampleR *= linearGain;
+void compressBlock(State& state, float* const pSamples, const uint32_t numSamples) noexcept {
+    float values[MAX_SUB_BLOCK_SIZE];
+
+    for (uint32_t subBlockIdx = 0; subBlockIdx < numSamples; subBlockIdx += MAX_SUB_BLOCK_SIZE) {
+        const uint32_t subBlockSize = std::min(numSamples - subBlockIdx, MAX_SUB_BLOCK_SIZE);
+        float* const pSubBlock = pSamples + subBlockIdx * 2;
+
+        // Stage 1: compute the signal power for each sample
+        computeSignalPower(pSubBlock, values, subBlockSize);
+
+        // Stage 2: smooth the power with the previous sample and save as the new smoothed sample.
+        // Note: prevent smoothed signal power from dropping below -100 dBFS to prevent negative infinity when calculating signal power.
+        const float lpfLerp = state.lpfLerpFactor;
+        float smoothedSignalPower = state.lpfPrevSignalPower;
+
+        for (uint32_t i = 0; i < subBlockSize; ++i) {
+            smoothedSignalPower = std::max(values[i] * lpfLerp + smoothedSignalPower * (1.0f - lpfLerp), 1.0e-10f);
+            values[i] = smoothedSignalPower;
+        }
+
+        ASSERT((!std::isnan(smoothedSignalPower)) && (!std::isinf(smoothedSignalPower)));
+        state.lpfPrevSignalPower = smoothedSignalPower;
+
+        // Stage 3: compute the instantaneous gain in decibels from the smoothed power
+        computeInstantGain(state, values, subBlockSize);
+
+        // Stage 4: smooth the gain using the attack and release envelopes
+        const float attackLerp = state.attackLerpFactor;
+        const float releaseLerp = state.releaseLerpFactor;
+        float smoothedGainDB = state.prevSampleGainDB;
+
+        for (uint32_t i = 0; i < subBlockSize; ++i) {
+            const float instantGainDB = values[i];
+            const float gainLerp = (instantGainDB < smoothedGainDB) ? attackLerp : releaseLerp;
+            smoothedGainDB = instantGainDB * gainLerp + smoothedGainDB * (1.0f - gainLerp);
+            values[i] = smoothedGainDB;
+        }
+
+        state.prevSampleGainDB = smoothedGainDB;
+
+        // Stage 5: apply the gain
+        applyGain(state, pSubBlock, values, subBlockSize);
+    }
 }
 
 END_NAMESPACE(AudioCompressor)
@@ -2,6 +2,8 @@
 
 #include "Macros.h"
 
+#include <cstdint>
+
 BEGIN_NAMESPACE(AudioCompressor)
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -30,6 +32,6 @@ void init(
     const float releaseTime
 ) noexcept;
 
-void compress(State& state, float& sampleL, float& sampleR) noexcept;
+void compressBlock(State& state, float* const pSamples, const uint32_t numSamples) noexcept;
 
 END_NAMESPACE(AudioCompressor)
@@ -0,0 +1,198 @@
+#include "AudioResampler.h"
+
+#include "Asserts.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+// Use SSE2 to evaluate the filter taps 4 at a time, where available.
+// SSE2 is always available on 64-bit x86 and is enabled by most 32-bit x86 builds.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+    #define AUDIO_RESAMPLER_USE_SSE2 1
+    #include <emmintrin.h>
+#else
+    #define AUDIO_RESAMPLER_USE_SSE2 0
+#endif
+
+BEGIN_NAMESPACE(AudioResampler)
+
+static_assert(NUM_TAPS % 4 == 0, "Number of taps must be a multiple of 4!");
+
+static constexpr double PI = 3.14159265358979323846;
+static constexpr double KAISER_BETA = 8.0;              // Kaiser window shape: gives roughly 80 dB of stopband attenuation
+static constexpr double PASSBAND_FRACTION = 0.91;       // How much of the lowest Nyquist frequency (input or output) is passed through
+static constexpr uint32_t INITIAL_INPUT_CAPACITY = 8192;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Zeroth order modified Bessel function of the first kind, as needed for the Kaiser window
+//------------------------------------------------------------------------------------------------------------------------------------------
+static double besselI0(const double x) noexcept {
+    double sum = 1.0;
+    double term = 1.0;
+
+    for (int32_t k = 1; k < 64; ++k) {
+        const double halfXOverK = x / (2.0 * k);
+        term *= halfXOverK * halfXOverK;
+        sum += term;
+
+        if (term < sum * 1e-12)
+            break;
+    }
+
+    return sum;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Initializes the resampler to convert between the given sample rates.
+// Returns 'false' if the ratio between the sample rates needs more filter phases than are supported.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool init(State& state, const uint32_t inputRate, const uint32_t outputRate) noexcept {
+    if ((inputRate == 0) || (outputRate == 0))
+        return false;
+
+    const uint32_t rateGcd = std::gcd(inputRate, outputRate);
+    const uint32_t numPhases = outputRate / rateGcd;
+    const uint32_t inputStep = inputRate / rateGcd;
+
+    if (numPhases > MAX_PHASES)
+        return false;
+
+    state.numPhases = numPhases;
+    state.inputStep = inputStep;
+    state.curPos = 0;
+
+    // Design the prototype low pass filter at the upsampled rate: a Kaiser windowed sinc function.
+    // The cutoff is in cycles per upsampled sample and is just under the lowest of the input and output Nyquist frequencies.
+    const uint32_t filterLen = numPhases * NUM_TAPS;
+    const double cutoff = 0.5 * PASSBAND_FRACTION * std::min(1.0, (double) numPhases / inputStep) / numPhases;
+    const double center = (filterLen - 1) * 0.5;
+    const double windowScale = 1.0 / besselI0(KAISER_BETA);
+    std::vector<double> filter(filterLen);
+
+    for (uint32_t i = 0; i < filterLen; ++i) {
+        const double t = i - center;
+        const double sincArg = 2.0 * cutoff * t * PI;
+        const double sinc = (t != 0.0) ? std::sin(sincArg) / sincArg : 1.0;
+        const double windowPos = t / center;
+        const double window = besselI0(KAISER_BETA * std::sqrt(std::max(1.0 - windowPos * windowPos, 0.0))) * windowScale;
+        filter[i] = sinc * window;
+    }
+
+    // Split the filter into phases, with the taps for each phase in the order they apply to consecutive input samples.
+    // Each phase is normalized to unity gain so that there is no ripple at DC.
+    state.coefs.resize(filterLen);
+
+    for (uint32_t phase = 0; phase < numPhases; ++phase) {
+        float* const pCoefs = state.coefs.data() + phase * NUM_TAPS;
+        double phaseSum = 0.0;
+
+        for (uint32_t tap = 0; tap < NUM_TAPS; ++tap) {
+            phaseSum += filter[(NUM_TAPS - 1 - tap) * numPhases + phase];
+        }
+
+        for (uint32_t tap = 0; tap < NUM_TAPS; ++tap) {
+            pCoefs[tap] = (float)(filter[(NUM_TAPS - 1 - tap) * numPhases + phase] / phaseSum);
+        }
+    }
+
+    // Start off with a full set of silent input samples, so that the first output sample can be made right away
+    state.inputL.clear();
+    state.inputR.clear();
+    state.inputL.reserve(INITIAL_INPUT_CAPACITY);
+    state.inputR.reserve(INITIAL_INPUT_CAPACITY);
+    state.inputL.resize(NUM_TAPS - 1);
+    state.inputR.resize(NUM_TAPS - 1);
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Returns how many more input samples must be added before the given number of output samples can be made
+//------------------------------------------------------------------------------------------------------------------------------------------
+uint32_t getNumInputSamplesNeeded(const State& state, const uint32_t numOutputSamples) noexcept {
+    if (numOutputSamples == 0)
+        return 0;
+
+    const uint64_t lastPos = state.curPos + (uint64_t)(numOutputSamples - 1) * state.inputStep;
+    const uint64_t numInputNeeded = lastPos / state.numPhases + NUM_TAPS;
+    const uint64_t numInput = state.inputL.size();
+    return (numInputNeeded > numInput) ? (uint32_t)(numInputNeeded - numInput) : 0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Adds a block of interleaved stereo input samples to the resampler
+//------------------------------------------------------------------------------------------------------------------------------------------
+void addInput(State& state, const float* const pSamples, const uint32_t numSamples) noexcept {
+    const size_t oldSize = state.inputL.size();
+    state.inputL.resize(oldSize + numSamples);
+    state.inputR.resize(oldSize + numSamples);
+
+    float* const pInputL = state.inputL.data() + oldSize;
+    float* const pInputR = state.inputR.data() + oldSize;
+
+    for (uint32_t i = 0; i < numSamples; ++i) {
+        pInputL[i] = pSamples[i * 2 + 0];
+        pInputR[i] = pSamples[i * 2 + 1];
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Makes the given number of interleaved stereo output samples and discards input samples which are no longer needed.
+// Enough input must have been added first, as determined by 'getNumInputSamplesNeeded'.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void resample(State& state, float* const pOutput, const uint32_t numOutputSamples) noexcept {
+    ASSERT(getNumInputSamplesNeeded(state, numOutputSamples) == 0);
+
+    const float* const pAllCoefs = state.coefs.data();
+    const float* const pInputL = state.inputL.data();
+    const float* const pInputR = state.inputR.data();
+    const uint32_t numPhases = state.numPhases;
+    const uint32_t inputStep = state.inputStep;
+    uint32_t curPos = state.curPos;
+    float* pOutputF = pOutput;
+
+    for (uint32_t outIdx = 0; outIdx < numOutputSamples; ++outIdx, pOutputF += 2) {
+        const uint32_t inputIdx = curPos / numPhases;
+        const float* const pCoefs = pAllCoefs + (curPos - inputIdx * numPhases) * NUM_TAPS;
+        const float* const pL = pInputL + inputIdx;
+        const float* const pR = pInputR + inputIdx;
+        curPos += inputStep;
+
+        #if AUDIO_RESAMPLER_USE_SSE2
+            __m128 accL = _mm_setzero_ps();
+            __m128 accR = _mm_setzero_ps();
+
+            for (uint32_t tap = 0; tap < NUM_TAPS; tap += 4) {
+                const __m128 coefs = _mm_loadu_ps(pCoefs + tap);
+                accL = _mm_add_ps(accL, _mm_mul_ps(coefs, _mm_loadu_ps(pL + tap)));
+                accR = _mm_add_ps(accR, _mm_mul_ps(coefs, _mm_loadu_ps(pR + tap)));
+            }
+
+            // Sum the lanes of both accumulators at once, leaving the left and right results in the lowest 2 lanes
+            const __m128 pairSums = _mm_add_ps(_mm_unpacklo_ps(accL, accR), _mm_unpackhi_ps(accL, accR));
+            const __m128 totals = _mm_add_ps(pairSums, _mm_movehl_ps(pairSums, pairSums));
+            _mm_storel_pi(reinterpret_cast<__m64*>(pOutputF), totals);
+        #else
+            float accL[4] = {};
+            float accR[4] = {};
+
+            for (uint32_t tap = 0; tap < NUM_TAPS; tap += 4) {
+                for (uint32_t lane = 0; lane < 4; ++lane) {
+                    accL[lane] += pCoefs[tap + lane] * pL[tap + lane];
+                    accR[lane] += pCoefs[tap + lane] * pR[tap + lane];
+                }
+            }
+
+            pOutputF[0] = (accL[0] + accL[2]) + (accL[1] + accL[3]);
+            pOutputF[1] = (accR[0] + accR[2]) + (accR[1] + accR[3]);
+        #endif
+    }
+
+    // Discard input samples that won't be needed again
+    const uint32_t numConsumed = curPos / numPhases;
+    state.inputL.erase(state.inputL.begin(), state.inputL.begin() + numConsumed);
+    state.inputR.erase(state.inputR.begin(), state.inputR.begin() + numConsumed);
+    state.curPos = curPos - numConsumed * numPhases;
+}
+
+END_NAMESPACE(AudioResampler)
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "Macros.h"
+
+#include <cstdint>
+#include <vector>
+
+BEGIN_NAMESPACE(AudioResampler)
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// A polyphase windowed sinc resampler for stereo audio.
+//
+// Converts between two sample rates which have an exact rational ratio 'numPhases / inputStep' (e.g 44,100 Hz to 48,000 Hz is 160 / 147).
+// Conceptually the input is upsampled by 'numPhases', low pass filtered and then decimated by 'inputStep'; in practice only the filter taps
+// for the needed output samples (one 'phase' of the filter) are evaluated, so the cost per output sample is just 'NUM_TAPS' multiply adds
+// per channel.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static constexpr uint32_t NUM_TAPS = 32;            // Number of filter taps per phase (must be a multiple of 4)
+static constexpr uint32_t MAX_PHASES = 1024;        // Maximum number of filter phases (upsampling factor) supported
+
+struct State {
+    uint32_t            numPhases;      // Upsampling factor: the number of filter phases
+    uint32_t            inputStep;      // Decimation factor: how many phases to advance by per output sample
+    uint32_t            curPos;         // Where the next output sample is, in phases, relative to the first buffered input sample
+    std::vector<float>  coefs;          // Filter coefficients for each phase, 'NUM_TAPS' per phase
+    std::vector<float>  inputL;         // Buffered input samples for the left and right channels
+    std::vector<float>  inputR;
+};
+
+bool init(State& state, const uint32_t inputRate, const uint32_t outputRate) noexcept;
+uint32_t getNumInputSamplesNeeded(const State& state, const uint32_t numOutputSamples) noexcept;
+void addInput(State& state, const float* const pSamples, const uint32_t numSamples) noexcept;
+void resample(State& state, float* const pOutput, const uint32_t numOutputSamples) noexcept;
+
+END_NAMESPACE(AudioResampler)
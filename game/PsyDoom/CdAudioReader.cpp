@@ -0,0 +1,456 @@
+#include "CdAudioReader.h"
+
+#include "Asserts.h"
+#include "DiscInfo.h"
+#include "ModMgr.h"
+#include "ProgArgs.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+static constexpr int32_t    CDDA_FRAME_SIZE     = 4;        // Size of a CD-DA stereo frame: 2x 16-bit samples
+static constexpr int32_t    CD_SAMPLE_RATE      = 44100;    // Sample rate that override files must have
+static constexpr int32_t    PCM_BLOCK_FRAMES    = 1024;     // How many frames of uncompressed PCM to read at once
+static constexpr uint16_t   WAV_FORMAT_PCM      = 0x0001;   // Format tags for WAV files
+static constexpr uint16_t   WAV_FORMAT_IMA      = 0x0011;
+static constexpr uint16_t   WAV_FORMAT_EXT      = 0xFFFE;
+
+// IMA ADPCM step sizes and step index adjustments for each encoded nibble
+static constexpr int16_t IMA_STEP_TABLE[89] = {
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45, 50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157,
+    173, 190, 209, 230, 253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963, 1060, 1166, 1282, 1411, 1552, 1707,
+    1878, 2066, 2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635,
+    13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+};
+
+static constexpr int8_t IMA_INDEX_TABLE[16] = {
+    -1, -1, -1, -1, 2, 4, 6, 8,
+    -1, -1, -1, -1, 2, 4, 6, 8
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Helpers to read little endian values from a byte buffer
+//------------------------------------------------------------------------------------------------------------------------------------------
+static uint16_t readU16LE(const uint8_t* const pBytes) noexcept {
+    return (uint16_t)(pBytes[0] | (pBytes[1] << 8));
+}
+
+static uint32_t readU32LE(const uint8_t* const pBytes) noexcept {
+    return (uint32_t) pBytes[0] | ((uint32_t) pBytes[1] << 8) | ((uint32_t) pBytes[2] << 16) | ((uint32_t) pBytes[3] << 24);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Decode a single IMA ADPCM nibble and update the decoder state
+//------------------------------------------------------------------------------------------------------------------------------------------
+static int16_t decodeImaNibble(const uint8_t nibble, int32_t& predictor, int32_t& stepIdx) noexcept {
+    const int32_t step = IMA_STEP_TABLE[stepIdx];
+    int32_t diff = step >> 3;
+
+    if (nibble & 1) { diff += step >> 2; }
+    if (nibble & 2) { diff += step >> 1; }
+    if (nibble & 4) { diff += step; }
+    if (nibble & 8) { diff = -diff; }
+
+    predictor = std::clamp(predictor + diff, -32768, 32767);
+    stepIdx = std::clamp(stepIdx + IMA_INDEX_TABLE[nibble], 0, 88);
+    return (int16_t) predictor;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Initialize the CD audio reader: the reference to the disc info must remain valid for the lifetime of this object
+//------------------------------------------------------------------------------------------------------------------------------------------
+CdAudioReader::CdAudioReader(const DiscInfo& discInfo) noexcept
+    : mDiscReader(discInfo)
+    , mpOverrideFile(nullptr)
+    , mOverrideTrackNum(0)
+    , mFileFormat(FileFormat::Pcm)
+    , mNumChannels(0)
+    , mDataOffset(0)
+    , mNumFrames(0)
+    , mFramesPerBlock(0)
+    , mBytesPerBlock(0)
+    , mCurFrame(0)
+    , mDecodedBlockIdx(-1)
+    , mBlockBytes()
+    , mDecodedBlock()
+{
+}
+
+CdAudioReader::~CdAudioReader() noexcept {
+    closeTrack();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Get the current track which is open for reading or '0' if none
+//------------------------------------------------------------------------------------------------------------------------------------------
+int32_t CdAudioReader::getTrackNum() const noexcept {
+    return (mpOverrideFile) ? mOverrideTrackNum : mDiscReader.getTrackNum();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Switch to the specified track for reading and return 'true' if successful.
+// Uses the override file for the track if there is a valid one, otherwise reads the track from the disc.
+// Note: the offset in the track is initialized to '0' if the current track is changed.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool CdAudioReader::setTrackNum(int32_t trackNum) noexcept {
+    // If not changing tracks then do nothing
+    if (mpOverrideFile && (trackNum == mOverrideTrackNum))
+        return true;
+
+    if ((!mpOverrideFile) && mDiscReader.isTrackOpen() && (trackNum == mDiscReader.getTrackNum()))
+        return true;
+
+    // Try the override file first, if there is one, then fall back to the disc
+    closeTrack();
+
+    if (openOverrideFile(trackNum))
+        return true;
+
+    return mDiscReader.setTrackNum(trackNum);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Is a track currently open for reading?
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool CdAudioReader::isTrackOpen() noexcept {
+    return (mpOverrideFile || mDiscReader.isTrackOpen());
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Close the track that is currently open for reading
+//------------------------------------------------------------------------------------------------------------------------------------------
+void CdAudioReader::closeTrack() noexcept {
+    closeOverrideFile();
+    mDiscReader.closeTrack();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Get the size of the currently open track in bytes of CD-DA data, or '0' if no track is open
+//------------------------------------------------------------------------------------------------------------------------------------------
+int32_t CdAudioReader::getTrackSize() const noexcept {
+    if (mpOverrideFile)
+        return mNumFrames * CDDA_FRAME_SIZE;
+
+    const DiscTrack* const pTrack = mDiscReader.getOpenTrack();
+    return (pTrack) ? pTrack->trackPayloadSize : 0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Seek to the given absolute offset in the track's CD-DA data.
+// For override files the offset must be a multiple of the CD-DA frame size.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool CdAudioReader::trackSeekAbs(const int32_t offsetAbs) noexcept {
+    if (!mpOverrideFile)
+        return mDiscReader.trackSeekAbs(offsetAbs);
+
+    if ((offsetAbs < 0) || (offsetAbs > getTrackSize()) || (offsetAbs % CDDA_FRAME_SIZE != 0))
+        return false;
+
+    mCurFrame = offsetAbs / CDDA_FRAME_SIZE;
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Try to read the specified number of bytes of CD-DA data into the given buffer.
+// For override files the size must be a multiple of the CD-DA frame size.
+// If the read fails for some reason then all bytes are zeroed.
+// If the read succeeds then the current offset in the track is advanced.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool CdAudioReader::read(void* const pBuffer, const int32_t numBytes) noexcept {
+    ASSERT(pBuffer);
+    ASSERT(numBytes >= 0);
+
+    if (!mpOverrideFile)
+        return mDiscReader.read(pBuffer, numBytes);
+
+    // Make sure the read is valid
+    const bool bValidRead = (
+        (numBytes % CDDA_FRAME_SIZE == 0) &&
+        (numBytes / CDDA_FRAME_SIZE <= mNumFrames - mCurFrame)
+    );
+
+    if (!bValidRead) {
+        std::memset(pBuffer, 0, (size_t) numBytes);
+        return false;
+    }
+
+    // Decode blocks as required and copy out the requested frames
+    int16_t* pDstSamples = (int16_t*) pBuffer;
+    int32_t framesLeft = numBytes / CDDA_FRAME_SIZE;
+
+    while (framesLeft > 0) {
+        const int32_t blockIdx = mCurFrame / mFramesPerBlock;
+
+        if ((blockIdx != mDecodedBlockIdx) && (!decodeOverrideFileBlock(blockIdx))) {
+            std::memset(pBuffer, 0, (size_t) numBytes);
+            return false;
+        }
+
+        const int32_t blockFrameIdx = mCurFrame - blockIdx * mFramesPerBlock;
+        const int32_t thisReadFrames = std::min(framesLeft, mFramesPerBlock - blockFrameIdx);
+        std::memcpy(pDstSamples, mDecodedBlock.data() + blockFrameIdx * 2, (size_t) thisReadFrames * CDDA_FRAME_SIZE);
+
+        pDstSamples += thisReadFrames * 2;
+        framesLeft -= thisReadFrames;
+        mCurFrame += thisReadFrames;
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Get the offset in the currently open track, in bytes of CD-DA data
+//------------------------------------------------------------------------------------------------------------------------------------------
+int32_t CdAudioReader::tell() const noexcept {
+    return (mpOverrideFile) ? mCurFrame * CDDA_FRAME_SIZE : mDiscReader.tell();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Try to open the override file for the specified track and return 'true' if successful.
+// Returns 'false' if there is no override file or if it is not a supported format.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool CdAudioReader::openOverrideFile(const int32_t trackNum) noexcept {
+    // Is there an override for this track?
+    if ((!ProgArgs::gDataDirPath[0]) || (trackNum < 0) || (trackNum > 99))
+        return false;
+
+    char fileName[16];
+    std::snprintf(fileName, sizeof(fileName), "TRACK%02d.WAV", (int) trackNum);
+
+    const CdFileId fileId = fileName;
+
+    if (!ModMgr::areOverridesAvailableForFile(fileId))
+        return false;
+
+    // Open the file and validate the WAV header
+    const std::string filePath = ModMgr::getOverridenFilePath(fileId);
+    std::FILE* const pFile = std::fopen(filePath.c_str(), "rb");
+
+    if (!pFile)
+        return false;
+
+    uint8_t riffHeader[12];
+    const bool bValidRiffHeader = (
+        (std::fread(riffHeader, sizeof(riffHeader), 1, pFile) == 1) &&
+        (std::memcmp(riffHeader, "RIFF", 4) == 0) &&
+        (std::memcmp(riffHeader + 8, "WAVE", 4) == 0)
+    );
+
+    if (!bValidRiffHeader) {
+        std::fclose(pFile);
+        return false;
+    }
+
+    // Search for the format, data and (optional) sample count chunks
+    uint8_t fmtChunk[40] = {};
+    int32_t fmtChunkSize = 0;
+    int32_t dataOffset = -1;
+    int32_t dataSize = 0;
+    int32_t factNumFrames = -1;
+
+    while (true) {
+        uint8_t chunkHeader[8];
+
+        if (std::fread(chunkHeader, sizeof(chunkHeader), 1, pFile) != 1)
+            break;
+
+        const uint32_t chunkSize = readU32LE(chunkHeader + 4);
+        const long chunkOffset = std::ftell(pFile);
+
+        if (std::memcmp(chunkHeader, "fmt ", 4) == 0) {
+            fmtChunkSize = (int32_t) std::min<uint32_t>(chunkSize, sizeof(fmtChunk));
+
+            if (std::fread(fmtChunk, (size_t) fmtChunkSize, 1, pFile) != 1)
+                break;
+        }
+        else if (std::memcmp(chunkHeader, "fact", 4) == 0) {
+            uint8_t factChunk[4];
+
+            if ((chunkSize >= 4) && (std::fread(factChunk, sizeof(factChunk), 1, pFile) == 1)) {
+                factNumFrames = (int32_t) std::min<uint32_t>(readU32LE(factChunk), INT32_MAX);
+            }
+        }
+        else if (std::memcmp(chunkHeader, "data", 4) == 0) {
+            // Note: clamp the size to the end of the file, since some tools write a placeholder size when streaming
+            if ((std::fseek(pFile, 0, SEEK_END) != 0) || (std::ftell(pFile) < chunkOffset))
+                break;
+
+            dataOffset = (int32_t) chunkOffset;
+            dataSize = (int32_t) std::min<long>((long) std::min<uint32_t>(chunkSize, INT32_MAX), std::ftell(pFile) - chunkOffset);
+            break;
+        }
+
+        // Move onto the next chunk: note that chunks are padded to 2 byte boundaries
+        if (std::fseek(pFile, chunkOffset + (long) chunkSize + (long)(chunkSize & 1), SEEK_SET) != 0)
+            break;
+    }
+
+    // Validate the format: must be 44.1 KHz mono or stereo and either 16-bit PCM or IMA ADPCM
+    uint16_t formatTag = readU16LE(fmtChunk + 0);
+    const uint16_t numChannels = readU16LE(fmtChunk + 2);
+    const uint32_t sampleRate = readU32LE(fmtChunk + 4);
+    const uint16_t blockAlign = readU16LE(fmtChunk + 12);
+    const uint16_t bitsPerSample = readU16LE(fmtChunk + 14);
+
+    if ((formatTag == WAV_FORMAT_EXT) && (fmtChunkSize >= 26)) {
+        formatTag = readU16LE(fmtChunk + 24);   // The first 2 bytes of the sub-format GUID are the actual format tag
+    }
+
+    const bool bValidFormat = (
+        (fmtChunkSize >= 16) &&
+        (dataOffset >= 0) &&
+        ((numChannels == 1) || (numChannels == 2)) &&
+        (sampleRate == CD_SAMPLE_RATE) &&
+        (
+            ((formatTag == WAV_FORMAT_PCM) && (bitsPerSample == 16) && (blockAlign == numChannels * 2)) ||
+            ((formatTag == WAV_FORMAT_IMA) && (bitsPerSample == 4) && (blockAlign > numChannels * 4) && ((blockAlign - numChannels * 4) % (numChannels * 4) == 0))
+        )
+    );
+
+    if (!bValidFormat) {
+        std::fclose(pFile);
+        return false;
+    }
+
+    // Figure out the block layout and the number of frames
+    mNumChannels = (uint8_t) numChannels;
+    mDataOffset = dataOffset;
+
+    if (formatTag == WAV_FORMAT_PCM) {
+        mFileFormat = FileFormat::Pcm;
+        mFramesPerBlock = PCM_BLOCK_FRAMES;
+        mBytesPerBlock = PCM_BLOCK_FRAMES * blockAlign;
+        mNumFrames = dataSize / blockAlign;
+    } else {
+        // Each block has a 4 byte header per channel containing the first sample, then 2 samples per byte for each channel
+        auto getNumBlockFrames = [=](const int32_t blockSize) noexcept {
+            return (blockSize > numChannels * 4) ? ((blockSize - numChannels * 4) * 2) / numChannels + 1 : 0;
+        };
+
+        mFileFormat = FileFormat::ImaAdpcm;
+        mFramesPerBlock = getNumBlockFrames(blockAlign);
+        mBytesPerBlock = blockAlign;
+        mNumFrames = (dataSize / blockAlign) * mFramesPerBlock + getNumBlockFrames(dataSize % blockAlign);
+
+        if (factNumFrames >= 0) {
+            mNumFrames = std::min(mNumFrames, factNumFrames);
+        }
+    }
+
+    // Track sizes are in terms of CD-DA bytes and must fit in 32-bits
+    mNumFrames = std::min(mNumFrames, INT32_MAX / CDDA_FRAME_SIZE);
+
+    // Success, setup the rest of the state for reading
+    mpOverrideFile = pFile;
+    mOverrideTrackNum = trackNum;
+    mCurFrame = 0;
+    mDecodedBlockIdx = -1;
+    mBlockBytes.resize((size_t) mBytesPerBlock);
+    mDecodedBlock.resize((size_t) mFramesPerBlock * 2);
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Close the override file for the current track, if there is one
+//------------------------------------------------------------------------------------------------------------------------------------------
+void CdAudioReader::closeOverrideFile() noexcept {
+    if (mpOverrideFile) {
+        std::fclose(mpOverrideFile);
+        mpOverrideFile = nullptr;
+    }
+
+    mOverrideTrackNum = 0;
+    mNumFrames = 0;
+    mCurFrame = 0;
+    mDecodedBlockIdx = -1;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Read and decode the specified block of the override file into the decoded block buffer as 16-bit stereo samples.
+// Returns 'false' if the block could not be read.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool CdAudioReader::decodeOverrideFileBlock(const int32_t blockIdx) noexcept {
+    ASSERT(mpOverrideFile);
+
+    // Read the block, which might be shorter than usual if it is the last one
+    const int32_t numBlockFrames = std::min(mFramesPerBlock, mNumFrames - blockIdx * mFramesPerBlock);
+    const long blockOffset = (long) mDataOffset + (long) blockIdx * mBytesPerBlock;
+    const int32_t bytesToRead = (mFileFormat == FileFormat::Pcm) ? numBlockFrames * mNumChannels * 2 : mBytesPerBlock;
+
+    if (numBlockFrames <= 0)
+        return false;
+
+    mDecodedBlockIdx = -1;
+    std::memset(mBlockBytes.data(), 0, mBlockBytes.size());
+
+    if (std::fseek(mpOverrideFile, blockOffset, SEEK_SET) != 0)
+        return false;
+
+    // Note: a short read is expected for the last IMA ADPCM block since it can be partial - missing data is left zeroed
+    const size_t bytesRead = std::fread(mBlockBytes.data(), 1, (size_t) bytesToRead, mpOverrideFile);
+
+    if ((mFileFormat == FileFormat::Pcm) && (bytesRead != (size_t) bytesToRead))
+        return false;
+
+    // Decode the block
+    if (mFileFormat == FileFormat::Pcm) {
+        for (int32_t frameIdx = 0; frameIdx < numBlockFrames; ++frameIdx) {
+            const uint8_t* const pFrame = mBlockBytes.data() + frameIdx * mNumChannels * 2;
+            const int16_t left = (int16_t) readU16LE(pFrame);
+            const int16_t right = (mNumChannels == 2) ? (int16_t) readU16LE(pFrame + 2) : left;
+            mDecodedBlock[frameIdx * 2 + 0] = left;
+            mDecodedBlock[frameIdx * 2 + 1] = right;
+        }
+    } else {
+        decodeImaAdpcmBlock(numBlockFrames);
+    }
+
+    mDecodedBlockIdx = blockIdx;
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Decodes the IMA ADPCM block currently in the raw block buffer into the decoded block buffer as 16-bit stereo samples.
+// Only the specified number of frames are output.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void CdAudioReader::decodeImaAdpcmBlock(const int32_t numBlockFrames) noexcept {
+    const int32_t numChannels = mNumChannels;
+    const uint8_t* pBytes = mBlockBytes.data();
+    int16_t* const pOutput = mDecodedBlock.data();
+
+    // Each channel has a header with the initial predictor (also the first sample) and step index
+    int32_t predictors[2] = {};
+    int32_t stepIdxs[2] = {};
+
+    for (int32_t chanIdx = 0; chanIdx < numChannels; ++chanIdx) {
+        predictors[chanIdx] = (int16_t) readU16LE(pBytes);
+        stepIdxs[chanIdx] = std::min<int32_t>(pBytes[2], 88);
+        pOutput[chanIdx] = (int16_t) predictors[chanIdx];
+        pBytes += 4;
+    }
+
+    // After that the data is in groups of 4 bytes (8 samples) for each channel in turn, low nibbles first
+    for (int32_t groupFrameIdx = 1; groupFrameIdx < numBlockFrames; groupFrameIdx += 8) {
+        for (int32_t chanIdx = 0; chanIdx < numChannels; ++chanIdx) {
+            for (int32_t i = 0; i < 8; ++i) {
+                const uint8_t nibble = (pBytes[i / 2] >> ((i & 1) * 4)) & 0xF;
+                const int16_t sample = decodeImaNibble(nibble, predictors[chanIdx], stepIdxs[chanIdx]);
+                const int32_t frameIdx = groupFrameIdx + i;
+
+                if (frameIdx < numBlockFrames) {
+                    pOutput[frameIdx * 2 + chanIdx] = sample;
+                }
+            }
+
+            pBytes += 4;
+        }
+    }
+
+    // Mono files: duplicate the left channel to the right
+    if (numChannels == 1) {
+        for (int32_t frameIdx = 0; frameIdx < numBlockFrames; ++frameIdx) {
+            pOutput[frameIdx * 2 + 1] = pOutput[frameIdx * 2];
+        }
+    }
+}
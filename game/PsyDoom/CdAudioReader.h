@@ -0,0 +1,57 @@
+#pragma once
+
+#include "DiscReader.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Reads CD audio tracks as raw 44.1 KHz 16-bit stereo CD-DA data.
+//
+// Tracks are read from the game disc by default, but can be overriden by files named 'TRACKnn.WAV' in the user data dir ('nn' being the
+// track number, e.g 'TRACK02.WAV'). Overrides can either be uncompressed 16-bit PCM or IMA ADPCM compressed (~4:1) and must be 44.1 KHz.
+// Override files are presented as if they were CD-DA tracks, so offsets and sizes are in terms of CD-DA bytes (4 bytes per stereo frame).
+//------------------------------------------------------------------------------------------------------------------------------------------
+class CdAudioReader {
+public:
+    CdAudioReader(const DiscInfo& discInfo) noexcept;
+    ~CdAudioReader() noexcept;
+
+    int32_t getTrackNum() const noexcept;
+    bool setTrackNum(int32_t trackNum) noexcept;
+
+    bool isTrackOpen() noexcept;
+    void closeTrack() noexcept;
+    int32_t getTrackSize() const noexcept;
+
+    bool trackSeekAbs(const int32_t offsetAbs) noexcept;
+    bool read(void* const pBuffer, const int32_t numBytes) noexcept;
+    int32_t tell() const noexcept;
+
+private:
+    // Format of an override file
+    enum class FileFormat : uint8_t {
+        Pcm,
+        ImaAdpcm
+    };
+
+    bool openOverrideFile(const int32_t trackNum) noexcept;
+    void closeOverrideFile() noexcept;
+    bool decodeOverrideFileBlock(const int32_t blockIdx) noexcept;
+    void decodeImaAdpcmBlock(const int32_t numBlockFrames) noexcept;
+
+    DiscReader              mDiscReader;            // Used to read tracks from the disc when they are not overriden
+    std::FILE*              mpOverrideFile;         // The override file for the current track or 'nullptr' if reading from disc
+    int32_t                 mOverrideTrackNum;      // Track number that the override file is for
+    FileFormat              mFileFormat;            // Format of the override file
+    uint8_t                 mNumChannels;           // Number of channels in the override file: 1 or 2
+    int32_t                 mDataOffset;            // Offset of the audio data in the override file
+    int32_t                 mNumFrames;             // Total number of frames (samples for all channels) in the override file
+    int32_t                 mFramesPerBlock;        // Number of frames in each block of the override file (the unit of decoding)
+    int32_t                 mBytesPerBlock;         // Size of each block in the override file
+    int32_t                 mCurFrame;              // Current read position in the override file (in frames)
+    int32_t                 mDecodedBlockIdx;       // Which block is in the decoded block buffer or '-1' if none
+    std::vector<uint8_t>    mBlockBytes;            // Raw file data for the current block
+    std::vector<int16_t>    mDecodedBlock;          // Decoded 16-bit stereo samples for the current block
+};
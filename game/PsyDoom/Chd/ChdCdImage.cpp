@@ -0,0 +1,485 @@
+#include "ChdCdImage.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+BEGIN_NAMESPACE(chd)
+
+// How many decompressed hunks each image keeps in memory, and how many hunks past the last one read are decompressed ahead of time.
+// With the usual CHD hunk size of 8 CD frames, each hunk is a little under 20 KiB.
+static constexpr uint32_t NUM_CACHED_HUNKS = 8;
+static constexpr uint32_t READ_AHEAD_HUNKS = 2;
+
+// Tracks in a CHD file are padded out to a multiple of this many frames
+static constexpr int32_t TRACK_FRAME_PADDING = 4;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// The track types which can appear in CHD metadata and how much sector data each stores in a frame
+//------------------------------------------------------------------------------------------------------------------------------------------
+struct TrackTypeInfo {
+    const char*     name;
+    int32_t         dataSize;
+    bool            bIsAudio;
+};
+
+static constexpr TrackTypeInfo TRACK_TYPES[] = {
+    { "MODE1",          2048, false },
+    { "MODE1_RAW",      2352, false },
+    { "MODE2",          2336, false },
+    { "MODE2_FORM1",    2048, false },
+    { "MODE2_FORM2",    2324, false },
+    { "MODE2_FORM_MIX", 2336, false },
+    { "MODE2_RAW",      2352, false },
+    { "AUDIO",          2352, true  },
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Creates a CHD CD image reader with no file open
+//------------------------------------------------------------------------------------------------------------------------------------------
+ChdCdImage::ChdCdImage() noexcept
+    : mFile()
+    , mReadAheadFile()
+    , mTracks()
+    , mNumFrames(0)
+    , mFramesPerHunk(0)
+    , mCurOffset(0)
+    , mCachedHunks()
+    , mCacheUseCounter(0)
+    , mReadAheadThread()
+    , mMutex()
+    , mCV()
+    , mbReadAheadQuit(false)
+{
+}
+
+ChdCdImage::~ChdCdImage() noexcept {
+    close();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Reads the list of tracks for a CD image from the metadata in the given CHD file.
+// Returns 'false' and an error message if the file is not a CD image or the track metadata is invalid.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool ChdCdImage::readTracks(ChdFile& file, std::vector<ChdCdTrack>& tracks, std::string& errorMsg) noexcept {
+    tracks.clear();
+
+    // The file must be made up of CD frames
+    const uint32_t hunkSize = file.getHunkSize();
+
+    if ((hunkSize == 0) || (hunkSize % ChdFile::CD_FRAME_SIZE != 0)) {
+        errorMsg = "The CHD file is not a CD image!";
+        return false;
+    }
+
+    // Newer files use the version 2 track metadata which includes pregap info.
+    // The tracks are stored in the file in the same order as the metadata entries.
+    std::string metadata;
+    const bool bIsV2Metadata = file.readMetadata(ChdFile::CDROM_TRACK_METADATA2_TAG, 0, metadata);
+    const uint32_t metadataTag = (bIsV2Metadata) ? ChdFile::CDROM_TRACK_METADATA2_TAG : ChdFile::CDROM_TRACK_METADATA_TAG;
+    int32_t nextFrame = 0;
+
+    for (uint32_t trackIdx = 0; file.readMetadata(metadataTag, trackIdx, metadata); ++trackIdx) {
+        // Parse the metadata for the track
+        int32_t trackNum = 0;
+        int32_t numFrames = 0;
+        int32_t numPregapFrames = 0;
+        int32_t numPostgapFrames = 0;
+        char type[32] = {};
+        char subtype[32] = {};
+        char pregapType[32] = {};
+        char pregapSubtype[32] = {};
+
+        const bool bParsedOk = (bIsV2Metadata) ?
+            (std::sscanf(
+                metadata.c_str(),
+                "TRACK:%d TYPE:%31s SUBTYPE:%31s FRAMES:%d PREGAP:%d PGTYPE:%31s PGSUB:%31s POSTGAP:%d",
+                &trackNum, type, subtype, &numFrames, &numPregapFrames, pregapType, pregapSubtype, &numPostgapFrames
+            ) == 8) :
+            (std::sscanf(metadata.c_str(), "TRACK:%d TYPE:%31s SUBTYPE:%31s FRAMES:%d", &trackNum, type, subtype, &numFrames) == 4);
+
+        if ((!bParsedOk) || (trackNum != (int32_t) trackIdx + 1) || (numFrames <= 0) || (numPregapFrames < 0)) {
+            errorMsg = "Invalid CHD track metadata: ";
+            errorMsg += metadata;
+            return false;
+        }
+
+        // Figure out the track type
+        const TrackTypeInfo* pTypeInfo = nullptr;
+
+        for (const TrackTypeInfo& typeInfo : TRACK_TYPES) {
+            if (std::strcmp(typeInfo.name, type) == 0) {
+                pTypeInfo = &typeInfo;
+                break;
+            }
+        }
+
+        if (!pTypeInfo) {
+            errorMsg = "Track mode not supported: ";
+            errorMsg += type;
+            return false;
+        }
+
+        // If the pregap type starts with 'V' then the pregap is stored in the file frames for the track, otherwise it isn't stored at all
+        const int32_t numStoredPregapFrames = (pregapType[0] == 'V') ? numPregapFrames : 0;
+
+        if (numStoredPregapFrames >= numFrames) {
+            errorMsg = "Invalid CHD track metadata: ";
+            errorMsg += metadata;
+            return false;
+        }
+
+        ChdCdTrack& track = tracks.emplace_back();
+        track.trackNum = trackNum;
+        track.type = type;
+        track.dataSize = pTypeInfo->dataSize;
+        track.firstFrame = nextFrame + numStoredPregapFrames;
+        track.numFrames = numFrames - numStoredPregapFrames;
+        track.numPregapFrames = numStoredPregapFrames;
+        track.bIsAudio = pTypeInfo->bIsAudio;
+
+        nextFrame += ((numFrames + TRACK_FRAME_PADDING - 1) / TRACK_FRAME_PADDING) * TRACK_FRAME_PADDING;
+    }
+
+    if (tracks.empty()) {
+        errorMsg = "The CHD file has no CD track metadata!";
+        return false;
+    }
+
+    // All of the tracks must be within the file
+    const ChdCdTrack& lastTrack = tracks.back();
+
+    if ((uint64_t)(lastTrack.firstFrame + lastTrack.numFrames) * ChdFile::CD_FRAME_SIZE > file.getLogicalSize()) {
+        errorMsg = "The CHD file is truncated: the tracks are larger than the file data!";
+        tracks.clear();
+        return false;
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Opens the specified CHD file containing a CD image, returning 'false' and an error message on failure
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool ChdCdImage::open(const char* const filePath, std::string& errorMsg) noexcept {
+    close();
+
+    if ((!mFile.open(filePath, errorMsg)) || (!readTracks(mFile, mTracks, errorMsg))) {
+        close();
+        return false;
+    }
+
+    // Note: the layout for the file is shared with the first handle, so this doesn't need to read much
+    if (!mReadAheadFile.open(filePath, errorMsg)) {
+        close();
+        return false;
+    }
+
+    // Setup the hunk cache and start the worker thread
+    const uint32_t hunkSize = mFile.getHunkSize();
+    mNumFrames = (uint32_t)(mFile.getLogicalSize() / ChdFile::CD_FRAME_SIZE);
+    mFramesPerHunk = hunkSize / ChdFile::CD_FRAME_SIZE;
+    mCurOffset = 0;
+    mCachedHunks.resize(NUM_CACHED_HUNKS);
+
+    for (CachedHunk& hunk : mCachedHunks) {
+        hunk.hunkIdx = -1;
+        hunk.state = HunkState::Empty;
+        hunk.bForWorker = false;
+        hunk.lastUseTime = 0;
+        hunk.data.resize(hunkSize);
+    }
+
+    mCacheUseCounter = 0;
+    mbReadAheadQuit = false;
+    mReadAheadThread = std::thread([this]() noexcept { readAheadThreadMain(); });
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Closes the image, if open, and stops the worker thread
+//------------------------------------------------------------------------------------------------------------------------------------------
+void ChdCdImage::close() noexcept {
+    if (mReadAheadThread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mbReadAheadQuit = true;
+        }
+
+        mCV.notify_all();
+        mReadAheadThread.join();
+    }
+
+    mFile.close();
+    mReadAheadFile.close();
+    mTracks.clear();
+    mNumFrames = 0;
+    mFramesPerHunk = 0;
+    mCurOffset = 0;
+    mCachedHunks.clear();
+    mCachedHunks.shrink_to_fit();
+    mCacheUseCounter = 0;
+    mbReadAheadQuit = false;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Seeks to the given offset in the image, which may be the end of the image but not past it
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool ChdCdImage::seek(const int64_t offset) noexcept {
+    if ((!isOpen()) || (offset < 0) || (offset > getSize()))
+        return false;
+
+    mCurOffset = offset;
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Reads up to the specified number of bytes from the current position in the image and advances the position.
+// Like 'fread' this returns how many bytes were read: this will be less than requested at the end of the image or if an error occurs.
+//------------------------------------------------------------------------------------------------------------------------------------------
+size_t ChdCdImage::read(void* const pDst, const size_t numBytes) noexcept {
+    std::byte* pDstBytes = (std::byte*) pDst;
+    size_t bytesRead = 0;
+
+    while ((bytesRead < numBytes) && (mCurOffset < getSize())) {
+        // Get the hunk containing the current sector
+        const uint32_t frameIdx = (uint32_t)(mCurOffset / SECTOR_SIZE);
+        const uint32_t frameOffset = (uint32_t)(mCurOffset % SECTOR_SIZE);
+        const std::byte* const pHunkData = getHunk((int32_t)(frameIdx / mFramesPerHunk));
+
+        if (!pHunkData)
+            break;
+
+        // Copy as much as we can or need from this sector
+        const std::byte* const pFrameData = pHunkData + (size_t)(frameIdx % mFramesPerHunk) * ChdFile::CD_FRAME_SIZE;
+        const size_t copySize = std::min<size_t>(numBytes - bytesRead, SECTOR_SIZE - frameOffset);
+        std::memcpy(pDstBytes + bytesRead, pFrameData + frameOffset, copySize);
+
+        bytesRead += copySize;
+        mCurOffset += (int64_t) copySize;
+    }
+
+    return bytesRead;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Gets the decompressed data for the specified hunk, decompressing it or waiting for the worker thread to finish doing so if required.
+// Also asks the worker thread to decompress the hunks following this one.
+// The returned data remains valid until the next call to this function. Returns 'nullptr' if the hunk could not be read.
+//------------------------------------------------------------------------------------------------------------------------------------------
+const std::byte* ChdCdImage::getHunk(const int32_t hunkIdx) noexcept {
+    std::unique_lock<std::mutex> lock(mMutex);
+    CachedHunk* pHunk = nullptr;
+
+    while (true) {
+        pHunk = findCachedHunk(hunkIdx);
+
+        // Already decompressed?
+        if (pHunk && (pHunk->state == HunkState::Ready)) {
+            pHunk->lastUseTime = ++mCacheUseCounter;
+            requestReadAhead(hunkIdx);
+            return pHunk->data.data();
+        }
+
+        // Being decompressed already? If the worker has yet to start on it then just do it here instead of waiting.
+        if (pHunk) {
+            if (pHunk->bForWorker) {
+                pHunk->bForWorker = false;
+                break;
+            }
+
+            mCV.wait(lock);
+            continue;
+        }
+
+        // Not in the cache: need to decompress it here.
+        // Note: there should always be a slot free since the worker only ever has a few hunks to decompress, but wait if not.
+        pHunk = allocCachedHunk(nullptr);
+
+        if (pHunk) {
+            pHunk->hunkIdx = hunkIdx;
+            pHunk->state = HunkState::Loading;
+            pHunk->bForWorker = false;
+            break;
+        }
+
+        mCV.wait(lock);
+    }
+
+    // Decompress the hunk outside of the lock: nothing else touches a hunk that is loading
+    lock.unlock();
+    std::byte* const pHunkData = pHunk->data.data();
+    const bool bReadOk = mFile.readHunk((uint32_t) hunkIdx, pHunkData);
+
+    if (bReadOk) {
+        fixupHunkData(hunkIdx, pHunkData);
+    }
+
+    lock.lock();
+
+    if (!bReadOk) {
+        pHunk->hunkIdx = -1;
+        pHunk->state = HunkState::Empty;
+        return nullptr;
+    }
+
+    pHunk->state = HunkState::Ready;
+    pHunk->lastUseTime = ++mCacheUseCounter;
+    requestReadAhead(hunkIdx);
+    return pHunkData;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Finds the cache slot for the specified hunk, or returns 'nullptr' if it's not in the cache.
+// Note: the mutex must be held when calling this.
+//------------------------------------------------------------------------------------------------------------------------------------------
+ChdCdImage::CachedHunk* ChdCdImage::findCachedHunk(const int32_t hunkIdx) noexcept {
+    for (CachedHunk& hunk : mCachedHunks) {
+        if ((hunk.state != HunkState::Empty) && (hunk.hunkIdx == hunkIdx))
+            return &hunk;
+    }
+
+    return nullptr;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Frees up a cache slot for a new hunk: either an unused slot or the least recently used one that isn't loading.
+// The specified hunk is never chosen. Returns 'nullptr' if no slot can be freed up.
+// Note: the mutex must be held when calling this.
+//------------------------------------------------------------------------------------------------------------------------------------------
+ChdCdImage::CachedHunk* ChdCdImage::allocCachedHunk(const CachedHunk* const pKeepHunk) noexcept {
+    CachedHunk* pBestHunk = nullptr;
+
+    for (CachedHunk& hunk : mCachedHunks) {
+        if ((&hunk == pKeepHunk) || (hunk.state == HunkState::Loading))
+            continue;
+
+        if (hunk.state == HunkState::Empty)
+            return &hunk;
+
+        if ((!pBestHunk) || (hunk.lastUseTime < pBestHunk->lastUseTime)) {
+            pBestHunk = &hunk;
+        }
+    }
+
+    if (pBestHunk) {
+        pBestHunk->hunkIdx = -1;
+        pBestHunk->state = HunkState::Empty;
+    }
+
+    return pBestHunk;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Asks the worker thread to decompress the hunks following the specified one, if they are not already in the cache.
+// Note: the mutex must be held when calling this, and the specified hunk must be in the cache.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void ChdCdImage::requestReadAhead(const int32_t hunkIdx) noexcept {
+    const CachedHunk* const pKeepHunk = findCachedHunk(hunkIdx);
+    bool bRequestedWork = false;
+
+    for (uint32_t i = 1; i <= READ_AHEAD_HUNKS; ++i) {
+        const int32_t readAheadHunkIdx = hunkIdx + (int32_t) i;
+
+        if ((uint32_t) readAheadHunkIdx >= mFile.getNumHunks())
+            break;
+
+        if (findCachedHunk(readAheadHunkIdx))
+            continue;
+
+        CachedHunk* const pHunk = allocCachedHunk(pKeepHunk);
+
+        if (!pHunk)
+            break;
+
+        pHunk->hunkIdx = readAheadHunkIdx;
+        pHunk->state = HunkState::Loading;
+        pHunk->bForWorker = true;
+        pHunk->lastUseTime = ++mCacheUseCounter;
+        bRequestedWork = true;
+    }
+
+    if (bRequestedWork) {
+        mCV.notify_all();
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Converts data in a freshly decompressed hunk to the format it is returned in: CD audio is byte swapped to little endian
+//------------------------------------------------------------------------------------------------------------------------------------------
+void ChdCdImage::fixupHunkData(const int32_t hunkIdx, std::byte* const pData) const noexcept {
+    const int32_t hunkFirstFrame = hunkIdx * (int32_t) mFramesPerHunk;
+    const int32_t hunkEndFrame = hunkFirstFrame + (int32_t) mFramesPerHunk;
+
+    for (const ChdCdTrack& track : mTracks) {
+        if (!track.bIsAudio)
+            continue;
+
+        // Note: include the pregap for the track since it is audio too
+        const int32_t beginFrame = std::max(track.firstFrame - track.numPregapFrames, hunkFirstFrame);
+        const int32_t endFrame = std::min(track.firstFrame + track.numFrames, hunkEndFrame);
+
+        for (int32_t frameIdx = beginFrame; frameIdx < endFrame; ++frameIdx) {
+            std::byte* const pFrame = pData + (size_t)(frameIdx - hunkFirstFrame) * ChdFile::CD_FRAME_SIZE;
+
+            for (uint32_t i = 0; i < SECTOR_SIZE; i += 2) {
+                std::swap(pFrame[i], pFrame[i + 1]);
+            }
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Entry point for the worker thread which decompresses hunks ahead of time.
+// Waits for hunks to be requested, then decompresses them (nearest one first) until it is told to quit.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void ChdCdImage::readAheadThreadMain() noexcept {
+    std::unique_lock<std::mutex> lock(mMutex);
+
+    while (true) {
+        // Wait for something to do
+        CachedHunk* pHunk = nullptr;
+
+        mCV.wait(lock, [&]() noexcept {
+            if (mbReadAheadQuit)
+                return true;
+
+            for (CachedHunk& hunk : mCachedHunks) {
+                if (hunk.bForWorker && ((!pHunk) || (hunk.hunkIdx < pHunk->hunkIdx))) {
+                    pHunk = &hunk;
+                }
+            }
+
+            return (pHunk != nullptr);
+        });
+
+        if (mbReadAheadQuit)
+            return;
+
+        // Claim the hunk and decompress it outside of the lock
+        pHunk->bForWorker = false;
+        const int32_t hunkIdx = pHunk->hunkIdx;
+        std::byte* const pHunkData = pHunk->data.data();
+        lock.unlock();
+
+        const bool bReadOk = mReadAheadFile.readHunk((uint32_t) hunkIdx, pHunkData);
+
+        if (bReadOk) {
+            fixupHunkData(hunkIdx, pHunkData);
+        }
+
+        // Publish the result: if it failed then the reader will try again itself and report the error
+        lock.lock();
+
+        if (bReadOk) {
+            pHunk->state = HunkState::Ready;
+        } else {
+            pHunk->hunkIdx = -1;
+            pHunk->state = HunkState::Empty;
+        }
+
+        mCV.notify_all();
+    }
+}
+
+END_NAMESPACE(chd)
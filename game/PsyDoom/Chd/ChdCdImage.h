@@ -0,0 +1,96 @@
+#pragma once
+
+#include "ChdFile.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+BEGIN_NAMESPACE(chd)
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Info for a track in a CD image stored in a CHD file
+//------------------------------------------------------------------------------------------------------------------------------------------
+struct ChdCdTrack {
+    int32_t         trackNum;           // The track number
+    std::string     type;               // Track type as given in the CHD metadata, e.g 'MODE2_RAW' or 'AUDIO'
+    int32_t         dataSize;           // How many bytes of sector data are stored in each frame for this track type
+    int32_t         firstFrame;         // The frame in the CHD where the track data starts (after any pregap stored in the file)
+    int32_t         numFrames;          // How many frames of track data there are (not including any pregap stored in the file)
+    int32_t         numPregapFrames;    // How many frames of pregap are stored in the file before the track data
+    bool            bIsAudio;           // True if the track is CD audio
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Provides access to a CD image stored in a CHD file as if it were a raw disc image file with 2,352 byte sectors (a '.bin' file).
+// Sector 'N' of the image is frame 'N' in the CHD, so the image includes the padding frames which CHD inserts between tracks.
+// CD audio is stored big endian in CHD files; it is converted back to the usual little endian format when read.
+//
+// Hunks are decompressed on demand and a few recently used ones are kept in memory.
+// A worker thread decompresses the hunks following the last one read ahead of time, so sequential reads rarely have to wait.
+// Like a regular file, each instance should only be used by one thread at a time.
+//------------------------------------------------------------------------------------------------------------------------------------------
+class ChdCdImage {
+public:
+    static constexpr uint32_t SECTOR_SIZE = ChdFile::CD_SECTOR_DATA_SIZE;
+
+    ChdCdImage() noexcept;
+    ~ChdCdImage() noexcept;
+
+    static bool readTracks(ChdFile& file, std::vector<ChdCdTrack>& tracks, std::string& errorMsg) noexcept;
+
+    bool open(const char* const filePath, std::string& errorMsg) noexcept;
+    void close() noexcept;
+    inline bool isOpen() const noexcept { return mFile.isOpen(); }
+    inline const std::vector<ChdCdTrack>& getTracks() const noexcept { return mTracks; }
+    inline int64_t getSize() const noexcept { return (int64_t) mNumFrames * SECTOR_SIZE; }
+
+    bool seek(const int64_t offset) noexcept;
+    inline int64_t tell() const noexcept { return mCurOffset; }
+    size_t read(void* const pDst, const size_t numBytes) noexcept;
+
+private:
+    ChdCdImage(const ChdCdImage& other) = delete;
+    ChdCdImage& operator = (const ChdCdImage& other) = delete;
+
+    // The state of a hunk in the cache
+    enum class HunkState : uint8_t {
+        Empty,          // Slot is unused
+        Loading,        // Hunk is being decompressed by either the reader or the worker thread
+        Ready           // Hunk is decompressed and can be used
+    };
+
+    // A decompressed hunk in the cache
+    struct CachedHunk {
+        int32_t                 hunkIdx;        // Which hunk this is or '-1' if none
+        HunkState               state;          // Whether the hunk is ready for use
+        bool                    bForWorker;     // True if the worker thread is to decompress this hunk
+        uint32_t                lastUseTime;    // Value of the cache use counter when the hunk was last used (for LRU eviction)
+        std::vector<std::byte>  data;           // The decompressed hunk data
+    };
+
+    const std::byte* getHunk(const int32_t hunkIdx) noexcept;
+    CachedHunk* findCachedHunk(const int32_t hunkIdx) noexcept;
+    CachedHunk* allocCachedHunk(const CachedHunk* const pKeepHunk) noexcept;
+    void requestReadAhead(const int32_t hunkIdx) noexcept;
+    void fixupHunkData(const int32_t hunkIdx, std::byte* const pData) const noexcept;
+    void readAheadThreadMain() noexcept;
+
+    ChdFile                     mFile;                  // The CHD file: only used by the thread reading from the image
+    ChdFile                     mReadAheadFile;         // Another handle to the CHD file for the worker thread
+    std::vector<ChdCdTrack>     mTracks;                // Info for all tracks in the image
+    uint32_t                    mNumFrames;             // Total number of frames in the image
+    uint32_t                    mFramesPerHunk;         // How many frames there are in each hunk
+    int64_t                     mCurOffset;             // Current read position in the image
+
+    // Hunk cache and read-ahead state: everything below is guarded by the mutex.
+    // Only the thread reading from the image allocates cache slots, so the data for a 'Ready' slot is never changed by the worker thread.
+    std::vector<CachedHunk>     mCachedHunks;
+    uint32_t                    mCacheUseCounter;       // Incremented every time a cached hunk is used
+    std::thread                 mReadAheadThread;
+    std::mutex                  mMutex;
+    std::condition_variable     mCV;                    // Signalled when read-ahead work is requested or a hunk finishes loading, or on quit
+    bool                        mbReadAheadQuit;        // Set to tell the worker thread to exit
+};
+
+END_NAMESPACE(chd)
@@ -0,0 +1,934 @@
+#include "ChdFile.h"
+
+#include "FlacDecoder.h"
+#include "Inflate.h"
+#include "LzmaDecoder.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+
+BEGIN_NAMESPACE(chd)
+
+// Identifies a CHD file, and the size of the version 5 header
+static constexpr char CHD_FILE_TAG[8] = { 'M', 'C', 'o', 'm', 'p', 'r', 'H', 'D' };
+static constexpr uint32_t CHD_V5_HEADER_SIZE = 124;
+
+// Supported codecs
+static constexpr uint32_t CODEC_ZLIB = makeTag('z', 'l', 'i', 'b');
+static constexpr uint32_t CODEC_LZMA = makeTag('l', 'z', 'm', 'a');
+static constexpr uint32_t CODEC_CD_ZLIB = makeTag('c', 'd', 'z', 'l');
+static constexpr uint32_t CODEC_CD_LZMA = makeTag('c', 'd', 'l', 'z');
+static constexpr uint32_t CODEC_CD_FLAC = makeTag('c', 'd', 'f', 'l');
+
+// How each hunk is stored, as found in the hunk map.
+// The 'pseudo' types only appear in the compressed hunk map and are converted to one of the regular types when the map is read.
+enum : uint8_t {
+    COMPRESSION_TYPE_0      = 0,    // Codec #0 in the header
+    COMPRESSION_TYPE_1      = 1,    // Codec #1 in the header
+    COMPRESSION_TYPE_2      = 2,    // Codec #2 in the header
+    COMPRESSION_TYPE_3      = 3,    // Codec #3 in the header
+    COMPRESSION_NONE        = 4,    // Uncompressed
+    COMPRESSION_SELF        = 5,    // Same as another hunk in this file
+    COMPRESSION_PARENT      = 6,    // Same as a hunk in the parent file
+    COMPRESSION_RLE_SMALL   = 7,    // Pseudo type: small repeat count of the last compression type
+    COMPRESSION_RLE_LARGE   = 8,    // Pseudo type: large repeat count of the last compression type
+    COMPRESSION_SELF_0      = 9,    // Pseudo type: same as the last 'self' hunk
+    COMPRESSION_SELF_1      = 10,   // Pseudo type: same as the hunk after the last 'self' hunk
+    COMPRESSION_PARENT_SELF = 11,   // Pseudo type: same as the hunk at the same location in the parent file
+    COMPRESSION_PARENT_0    = 12,   // Pseudo type: same as the last 'parent' hunk
+    COMPRESSION_PARENT_1    = 13,   // Pseudo type: same as the hunk after the last 'parent' hunk
+};
+
+// How many hunks deep a chain of references to other hunks can go.
+// References normally point to the actual data straight away, this just guards against malformed files.
+static constexpr uint32_t MAX_HUNK_REF_DEPTH = 4;
+
+// How many recently opened files have their layout (header and hunk map) remembered, so it doesn't need to be read again.
+// The same disc image usually gets opened many times over, once for each file or track being read from it.
+static constexpr uint32_t NUM_CACHED_LAYOUTS = 2;
+
+// Parameters of the Huffman code used to compress the hunk compression types in the compressed hunk map
+static constexpr uint32_t MAP_HUFF_NUM_CODES = 16;
+static constexpr uint32_t MAP_HUFF_MAX_BITS = 8;
+
+// The sync header at the start of each raw data sector, and details of the error correction codes that follow the sector data.
+// The ECC is removed from sectors where it can be regenerated, so it has to be computed again when the sector is decompressed.
+static constexpr uint8_t CD_SYNC_HEADER[12] = { 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x00 };
+static constexpr uint32_t ECC_P_OFFSET = 0x81C;
+static constexpr uint32_t ECC_Q_OFFSET = 0x8C8;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Lookup tables for multiplication in the Galois field used by the CD-ROM error correction codes
+//------------------------------------------------------------------------------------------------------------------------------------------
+struct EccTables {
+    uint8_t fwd[256];
+    uint8_t bwd[256];
+
+    constexpr EccTables() noexcept : fwd(), bwd() {
+        for (uint32_t i = 0; i < 256; ++i) {
+            const uint32_t j = (i << 1) ^ ((i & 0x80) ? 0x11D : 0);
+            fwd[i] = (uint8_t) j;
+            bwd[i ^ j] = (uint8_t) i;
+        }
+    }
+};
+
+static constexpr EccTables gEccTables = EccTables();
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Lookup table for computing the CRC-16/CCITT used by CHD
+//------------------------------------------------------------------------------------------------------------------------------------------
+struct Crc16Table {
+    uint16_t values[256];
+
+    constexpr Crc16Table() noexcept : values() {
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t crc = i << 8;
+
+            for (uint32_t bit = 0; bit < 8; ++bit) {
+                crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
+            }
+
+            values[i] = (uint16_t) crc;
+        }
+    }
+};
+
+static constexpr Crc16Table gCrc16Table = Crc16Table();
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Helper: computes the CRC16 of the given data
+//------------------------------------------------------------------------------------------------------------------------------------------
+static uint16_t crc16(const void* const pData, const size_t size) noexcept {
+    const uint8_t* const pBytes = (const uint8_t*) pData;
+    uint16_t crc = 0xFFFF;
+
+    for (size_t i = 0; i < size; ++i) {
+        crc = (uint16_t)((crc << 8) ^ gCrc16Table.values[(crc >> 8) ^ pBytes[i]]);
+    }
+
+    return crc;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Helpers: read big endian values
+//------------------------------------------------------------------------------------------------------------------------------------------
+static uint64_t readBigEndian(const uint8_t* const pBytes, const uint32_t numBytes) noexcept {
+    uint64_t value = 0;
+
+    for (uint32_t i = 0; i < numBytes; ++i) {
+        value = (value << 8) | pBytes[i];
+    }
+
+    return value;
+}
+
+static uint32_t readBigEndianU32(const uint8_t* const pBytes) noexcept {
+    return (uint32_t) readBigEndian(pBytes, 4);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Helper: gets a printable version of a codec tag for error messages
+//------------------------------------------------------------------------------------------------------------------------------------------
+static std::string getTagString(const uint32_t tag) noexcept {
+    std::string str;
+
+    for (int32_t shift = 24; shift >= 0; shift -= 8) {
+        const char c = (char)(tag >> shift);
+        str += ((c >= 32) && (c < 127)) ? c : '?';
+    }
+
+    return str;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Helper: computes one set of error correction codes (P or Q) for a raw sector.
+// Follows the scheme laid out by ECMA-130: the data from the sector header onwards is treated as a matrix of 16-bit words, with the low
+// and high bytes of each word encoded separately.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void computeEccBlock(
+    const uint8_t* const pSrc,
+    const uint32_t majorCount,
+    const uint32_t minorCount,
+    const uint32_t majorMult,
+    const uint32_t minorInc,
+    uint8_t* const pDst
+) noexcept {
+    const uint32_t size = majorCount * minorCount;
+
+    for (uint32_t major = 0; major < majorCount; ++major) {
+        uint32_t index = (major >> 1) * majorMult + (major & 1);
+        uint8_t eccA = 0;
+        uint8_t eccB = 0;
+
+        for (uint32_t minor = 0; minor < minorCount; ++minor) {
+            const uint8_t value = pSrc[index];
+            index += minorInc;
+
+            if (index >= size) {
+                index -= size;
+            }
+
+            eccA ^= value;
+            eccB ^= value;
+            eccA = gEccTables.fwd[eccA];
+        }
+
+        eccA = gEccTables.bwd[gEccTables.fwd[eccA] ^ eccB];
+        pDst[major] = eccA;
+        pDst[major + majorCount] = eccA ^ eccB;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Helper: regenerates the sync header and error correction codes for a raw sector, which were removed during compression
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void regenerateSectorEcc(uint8_t* const pSector) noexcept {
+    std::memcpy(pSector, CD_SYNC_HEADER, sizeof(CD_SYNC_HEADER));
+    computeEccBlock(pSector + 0xC, 86, 24, 2, 86, pSector + ECC_P_OFFSET);
+    computeEccBlock(pSector + 0xC, 52, 43, 86, 88, pSector + ECC_Q_OFFSET);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Reads bits from the compressed hunk map, most significant bit first.
+// Reading past the end of the data yields zero bits: whether that happened is checked via 'isOverrun()' once the map has been read.
+//------------------------------------------------------------------------------------------------------------------------------------------
+struct MapBitReader {
+    const uint8_t*  pData;
+    size_t          size;
+    size_t          bitPos;
+
+    uint32_t peek(const uint32_t count) const noexcept {
+        uint32_t bits = 0;
+
+        for (uint32_t i = 0; i < count; ++i) {
+            const size_t pos = bitPos + i;
+            const uint32_t bit = (pos < size * 8) ? (pData[pos >> 3] >> (7 - (pos & 7))) & 1 : 0;
+            bits = (bits << 1) | bit;
+        }
+
+        return bits;
+    }
+
+    uint32_t read(const uint32_t count) noexcept {
+        const uint32_t bits = peek(count);
+        bitPos += count;
+        return bits;
+    }
+
+    bool isOverrun() const noexcept {
+        return (bitPos > size * 8);
+    }
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Huffman decoder for the hunk compression types in the compressed hunk map.
+// The code lengths are stored with a simple run length encoding, and codes are assigned canonically with the longest codes first.
+//------------------------------------------------------------------------------------------------------------------------------------------
+struct MapHuffDecoder {
+    uint8_t     codeLengths[MAP_HUFF_NUM_CODES];
+    uint16_t    lookup[1 << MAP_HUFF_MAX_BITS];     // Indexed by the next 'MAP_HUFF_MAX_BITS' of input: '(symbol << 4) | codeLength'
+
+    bool importTree(MapBitReader& bits) noexcept {
+        // Read the code lengths: a value of '1' is an escape code for either a single '1' or a run of repeated lengths
+        uint32_t numLengths = 0;
+
+        while (numLengths < MAP_HUFF_NUM_CODES) {
+            const uint32_t length = bits.read(4);
+
+            if (length != 1) {
+                codeLengths[numLengths++] = (uint8_t) length;
+                continue;
+            }
+
+            const uint32_t repeatLength = bits.read(4);
+
+            if (repeatLength == 1) {
+                codeLengths[numLengths++] = 1;
+                continue;
+            }
+
+            const uint32_t repeatCount = bits.read(4) + 3;
+
+            if (numLengths + repeatCount > MAP_HUFF_NUM_CODES)
+                return false;
+
+            for (uint32_t i = 0; i < repeatCount; ++i) {
+                codeLengths[numLengths++] = (uint8_t) repeatLength;
+            }
+        }
+
+        // Figure out the first code for each code length: longer codes come first
+        uint32_t lengthCounts[MAP_HUFF_MAX_BITS + 1] = {};
+
+        for (uint32_t i = 0; i < MAP_HUFF_NUM_CODES; ++i) {
+            if (codeLengths[i] > MAP_HUFF_MAX_BITS)
+                return false;
+
+            lengthCounts[codeLengths[i]]++;
+        }
+
+        uint32_t nextCode[MAP_HUFF_MAX_BITS + 1] = {};
+        uint32_t curStart = 0;
+
+        for (uint32_t len = MAP_HUFF_MAX_BITS; len > 0; --len) {
+            const uint32_t nextStart = (curStart + lengthCounts[len]) >> 1;
+
+            if ((len != 1) && (nextStart * 2 != curStart + lengthCounts[len]))
+                return false;
+
+            nextCode[len] = curStart;
+            curStart = nextStart;
+        }
+
+        // Build the lookup table
+        std::memset(lookup, 0, sizeof(lookup));
+
+        for (uint32_t sym = 0; sym < MAP_HUFF_NUM_CODES; ++sym) {
+            const uint32_t len = codeLengths[sym];
+
+            if (len == 0)
+                continue;
+
+            const uint32_t code = nextCode[len]++;
+            const uint32_t shift = MAP_HUFF_MAX_BITS - len;
+            const uint32_t firstIdx = code << shift;
+            const uint32_t lastIdx = firstIdx | ((1u << shift) - 1);
+
+            if (lastIdx >= (1u << MAP_HUFF_MAX_BITS))
+                return false;
+
+            for (uint32_t i = firstIdx; i <= lastIdx; ++i) {
+                lookup[i] = (uint16_t)((sym << 4) | len);
+            }
+        }
+
+        return (!bits.isOverrun());
+    }
+
+    uint32_t decode(MapBitReader& bits) const noexcept {
+        const uint16_t entry = lookup[bits.peek(MAP_HUFF_MAX_BITS)];
+        bits.bitPos += entry & 0xF;
+        return entry >> 4;
+    }
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Where to find a hunk in the file and how to decompress it
+//------------------------------------------------------------------------------------------------------------------------------------------
+struct MapEntry {
+    uint64_t    offset;         // File offset of the compressed data, or the hunk number for a reference to another hunk
+    uint32_t    length;         // Length of the compressed data
+    uint16_t    crc;            // CRC16 of the decompressed hunk
+    uint8_t     compression;    // Which codec the hunk uses, or if it is uncompressed or a reference to another hunk
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// The details from the file header and the hunk map for a CHD file.
+// These never change once read, so they are shared between all readers of the same file.
+//------------------------------------------------------------------------------------------------------------------------------------------
+struct ChdFileLayout {
+    std::string             filePath;           // Which file this is the layout for
+    std::vector<uint8_t>    rawHeader;          // The raw header bytes for the file: used to check whether the file has changed
+    uint64_t                logicalBytes;       // Total size of the uncompressed data
+    uint64_t                mapOffset;          // Where the hunk map is located in the file
+    uint64_t                metaOffset;         // Where the first metadata entry is located in the file
+    uint32_t                hunkBytes;          // Size of each (uncompressed) hunk
+    uint32_t                unitBytes;          // Size of each unit within a hunk: the CD frame size for CD images
+    uint32_t                codecs[4];          // The codecs used by the file ('0' if unused)
+    bool                    bCompressed;        // False if the hunks in the file are all uncompressed
+    std::vector<MapEntry>   map;                // Where to find each hunk and how to decompress it
+};
+
+// Recently read file layouts, most recently used first: guarded by the mutex since files may be opened on different threads
+static std::mutex gCachedLayoutsMutex;
+static std::vector<std::shared_ptr<const ChdFileLayout>> gCachedLayouts;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Creates a CHD file reader with no file open
+//------------------------------------------------------------------------------------------------------------------------------------------
+ChdFile::ChdFile() noexcept
+    : mpFile(nullptr)
+    , mpLayout()
+    , mCompressedBuffer()
+    , mCdSectorBuffer()
+{
+}
+
+ChdFile::~ChdFile() noexcept {
+    close();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Opens the specified CHD file and reads the hunk map, returning 'false' and an error message on failure
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool ChdFile::open(const char* const filePath, std::string& errorMsg) noexcept {
+    close();
+    mpFile = std::fopen(filePath, "rb");
+
+    if (!mpFile) {
+        errorMsg = "Unable to open the file!";
+        return false;
+    }
+
+    // Read the raw header and see if we already have the layout for this file
+    std::vector<uint8_t> rawHeader(CHD_V5_HEADER_SIZE);
+
+    if (!readFileBytes(0, rawHeader.data(), rawHeader.size())) {
+        errorMsg = "Unable to read the CHD header!";
+        close();
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(gCachedLayoutsMutex);
+
+        for (size_t i = 0; i < gCachedLayouts.size(); ++i) {
+            const std::shared_ptr<const ChdFileLayout>& pLayout = gCachedLayouts[i];
+
+            if ((pLayout->filePath == filePath) && (pLayout->rawHeader == rawHeader)) {
+                mpLayout = pLayout;
+                std::rotate(gCachedLayouts.begin(), gCachedLayouts.begin() + i, gCachedLayouts.begin() + i + 1);
+                return true;
+            }
+        }
+    }
+
+    // Otherwise read the layout and remember it for next time
+    std::shared_ptr<ChdFileLayout> pLayout = std::make_shared<ChdFileLayout>();
+    pLayout->filePath = filePath;
+    pLayout->rawHeader = std::move(rawHeader);
+
+    if (!readLayout(*pLayout, errorMsg)) {
+        close();
+        return false;
+    }
+
+    mpLayout = pLayout;
+
+    {
+        std::lock_guard<std::mutex> lock(gCachedLayoutsMutex);
+        gCachedLayouts.insert(gCachedLayouts.begin(), std::move(pLayout));
+
+        if (gCachedLayouts.size() > NUM_CACHED_LAYOUTS) {
+            gCachedLayouts.pop_back();
+        }
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Closes the currently open file, if any
+//------------------------------------------------------------------------------------------------------------------------------------------
+void ChdFile::close() noexcept {
+    if (mpFile) {
+        std::fclose((FILE*) mpFile);
+        mpFile = nullptr;
+    }
+
+    mpLayout.reset();
+    mCompressedBuffer.clear();
+    mCompressedBuffer.shrink_to_fit();
+    mCdSectorBuffer.clear();
+    mCdSectorBuffer.shrink_to_fit();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Get the size of each hunk, the number of hunks and the total size of the data in the file.
+// These return '0' if no file is open.
+//------------------------------------------------------------------------------------------------------------------------------------------
+uint32_t ChdFile::getHunkSize() const noexcept {
+    return (mpLayout) ? mpLayout->hunkBytes : 0;
+}
+
+uint32_t ChdFile::getNumHunks() const noexcept {
+    return (mpLayout) ? (uint32_t) mpLayout->map.size() : 0;
+}
+
+uint64_t ChdFile::getLogicalSize() const noexcept {
+    return (mpLayout) ? mpLayout->logicalBytes : 0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Reads and decompresses the specified hunk into the given buffer, which must be the size of a hunk.
+// Returns 'false' if the hunk could not be read or is corrupt.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool ChdFile::readHunk(const uint32_t hunkIdx, std::byte* const pDst) noexcept {
+    return readHunkWithDepth(hunkIdx, pDst, 0);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Reads the specified metadata entry (the Nth entry of the given type) as a string.
+// Returns 'false' if there is no such entry.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool ChdFile::readMetadata(const uint32_t tag, const uint32_t index, std::string& metadata) noexcept {
+    metadata.clear();
+
+    if (!mpLayout)
+        return false;
+
+    // Walk the linked list of metadata entries until we find the requested one.
+    // Each entry has a 16 byte header: tag, flags and 24-bit length, and the offset to the next entry.
+    uint64_t entryOffset = mpLayout->metaOffset;
+    uint32_t numMatchingEntries = 0;
+
+    // Note: limit the number of entries visited in case of a malformed file with a loop in the list
+    for (uint32_t numEntriesVisited = 0; (entryOffset != 0) && (numEntriesVisited < 65536); ++numEntriesVisited) {
+        uint8_t entryHeader[16];
+
+        if (!readFileBytes(entryOffset, entryHeader, sizeof(entryHeader)))
+            return false;
+
+        const uint32_t entryTag = readBigEndianU32(entryHeader);
+        const uint32_t entryLength = readBigEndianU32(entryHeader + 4) & 0x00FFFFFF;
+        const uint64_t nextEntryOffset = readBigEndian(entryHeader + 8, 8);
+
+        if ((entryTag == tag) && (numMatchingEntries++ == index)) {
+            metadata.resize(entryLength);
+
+            if ((entryLength > 0) && (!readFileBytes(entryOffset + sizeof(entryHeader), metadata.data(), entryLength))) {
+                metadata.clear();
+                return false;
+            }
+
+            // Text metadata is normally null terminated: strip that off
+            while ((!metadata.empty()) && (metadata.back() == 0)) {
+                metadata.pop_back();
+            }
+
+            return true;
+        }
+
+        entryOffset = nextEntryOffset;
+    }
+
+    return false;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Reads the specified number of bytes at the given offset in the file, returning 'false' on failure
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool ChdFile::readFileBytes(const uint64_t offset, void* const pDst, const size_t size) noexcept {
+    FILE* const pFile = (FILE*) mpFile;
+
+    if (offset > (uint64_t) INT32_MAX)
+        return false;
+
+    if (std::fseek(pFile, (long) offset, SEEK_SET) != 0)
+        return false;
+
+    return (std::fread(pDst, 1, size, pFile) == size);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Validates the raw header for the file layout, fills in the details from it and reads the hunk map
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool ChdFile::readLayout(ChdFileLayout& layout, std::string& errorMsg) noexcept {
+    const uint8_t* const header = layout.rawHeader.data();
+
+    if (std::memcmp(header, CHD_FILE_TAG, sizeof(CHD_FILE_TAG)) != 0) {
+        errorMsg = "Not a CHD file!";
+        return false;
+    }
+
+    const uint32_t headerSize = readBigEndianU32(header + 8);
+    const uint32_t version = readBigEndianU32(header + 12);
+
+    if ((version != 5) || (headerSize != CHD_V5_HEADER_SIZE)) {
+        errorMsg = "Unsupported CHD version: only version 5 CHD files are supported!";
+        return false;
+    }
+
+    for (uint32_t i = 0; i < 4; ++i) {
+        layout.codecs[i] = readBigEndianU32(header + 16 + i * 4);
+    }
+
+    layout.logicalBytes = readBigEndian(header + 32, 8);
+    layout.mapOffset = readBigEndian(header + 40, 8);
+    layout.metaOffset = readBigEndian(header + 48, 8);
+    layout.hunkBytes = readBigEndianU32(header + 56);
+    layout.unitBytes = readBigEndianU32(header + 60);
+    layout.bCompressed = (layout.codecs[0] != 0);
+
+    const uint8_t* const pParentSha1 = header + 104;
+    const bool bHasParent = std::any_of(pParentSha1, pParentSha1 + 20, [](const uint8_t b) noexcept { return (b != 0); });
+
+    if (bHasParent) {
+        errorMsg = "CHD files which depend on a parent CHD file are not supported!";
+        return false;
+    }
+
+    const bool bValidSizes = (
+        (layout.hunkBytes > 0) &&
+        (layout.unitBytes > 0) &&
+        (layout.hunkBytes % layout.unitBytes == 0) &&
+        (layout.logicalBytes > 0) &&
+        ((layout.logicalBytes + layout.hunkBytes - 1) / layout.hunkBytes <= UINT32_MAX)
+    );
+
+    if (!bValidSizes) {
+        errorMsg = "Invalid CHD header!";
+        return false;
+    }
+
+    // Make sure all the codecs used are supported
+    for (const uint32_t codec : layout.codecs) {
+        const bool bSupportedCodec = (
+            (codec == 0) ||
+            (codec == CODEC_ZLIB) ||
+            (codec == CODEC_LZMA) ||
+            (codec == CODEC_CD_ZLIB) ||
+            (codec == CODEC_CD_LZMA) ||
+            (codec == CODEC_CD_FLAC)
+        );
+
+        if (!bSupportedCodec) {
+            errorMsg = "The CHD file uses an unsupported compression codec: '";
+            errorMsg += getTagString(codec);
+            errorMsg += "'!";
+            return false;
+        }
+    }
+
+    // Read the hunk map
+    layout.map.resize((size_t)((layout.logicalBytes + layout.hunkBytes - 1) / layout.hunkBytes));
+    return (layout.bCompressed) ? readCompressedMap(layout, errorMsg) : readUncompressedMap(layout, errorMsg);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Reads the hunk map for a file with no compression: each entry is just the location of the hunk in units of the hunk size
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool ChdFile::readUncompressedMap(ChdFileLayout& layout, std::string& errorMsg) noexcept {
+    std::vector<uint8_t> rawMap(layout.map.size() * 4);
+
+    if (!readFileBytes(layout.mapOffset, rawMap.data(), rawMap.size())) {
+        errorMsg = "Unable to read the CHD hunk map!";
+        return false;
+    }
+
+    for (size_t hunkIdx = 0; hunkIdx < layout.map.size(); ++hunkIdx) {
+        MapEntry& entry = layout.map[hunkIdx];
+        entry.offset = (uint64_t) readBigEndianU32(&rawMap[hunkIdx * 4]) * layout.hunkBytes;
+        entry.length = layout.hunkBytes;
+        entry.crc = 0;
+        entry.compression = COMPRESSION_NONE;
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Reads the hunk map for a compressed file.
+// The map starts with a 16 byte header, followed by the Huffman coded compression type for every hunk, followed by the variable length
+// bit packed details for each hunk (compressed length, CRC and so on). Offsets are implied by the lengths of the preceding hunks.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool ChdFile::readCompressedMap(ChdFileLayout& layout, std::string& errorMsg) noexcept {
+    errorMsg = "The CHD hunk map is corrupt!";
+
+    // Read the map header
+    uint8_t mapHeader[16];
+
+    if (!readFileBytes(layout.mapOffset, mapHeader, sizeof(mapHeader))) {
+        errorMsg = "Unable to read the CHD hunk map!";
+        return false;
+    }
+
+    const uint32_t mapBytes = readBigEndianU32(mapHeader);
+    const uint64_t firstOffset = readBigEndian(mapHeader + 4, 6);
+    const uint16_t mapCrc = (uint16_t) readBigEndian(mapHeader + 10, 2);
+    const uint32_t lengthBits = mapHeader[12];
+    const uint32_t selfBits = mapHeader[13];
+    const uint32_t parentBits = mapHeader[14];
+
+    if ((lengthBits > 32) || (selfBits > 32) || (parentBits > 32))
+        return false;
+
+    // Read the compressed map itself
+    std::vector<uint8_t> mapData(mapBytes);
+
+    if (!readFileBytes(layout.mapOffset + sizeof(mapHeader), mapData.data(), mapData.size())) {
+        errorMsg = "Unable to read the CHD hunk map!";
+        return false;
+    }
+
+    MapBitReader bits = { mapData.data(), mapData.size(), 0 };
+
+    // Decode the compression type for each hunk, which is run length encoded
+    MapHuffDecoder huffDecoder;
+
+    if (!huffDecoder.importTree(bits))
+        return false;
+
+    uint8_t lastCompression = 0;
+    uint32_t repeatCount = 0;
+
+    for (MapEntry& entry : layout.map) {
+        if (repeatCount > 0) {
+            entry.compression = lastCompression;
+            repeatCount--;
+            continue;
+        }
+
+        const uint32_t value = huffDecoder.decode(bits);
+
+        if (value == COMPRESSION_RLE_SMALL) {
+            entry.compression = lastCompression;
+            repeatCount = 2 + huffDecoder.decode(bits);
+        } else if (value == COMPRESSION_RLE_LARGE) {
+            entry.compression = lastCompression;
+            repeatCount = 2 + 16 + (huffDecoder.decode(bits) << 4);
+            repeatCount += huffDecoder.decode(bits);
+        } else {
+            entry.compression = lastCompression = (uint8_t) value;
+        }
+    }
+
+    // Then decode the details for each hunk and convert the pseudo types into regular ones
+    uint64_t curOffset = firstOffset;
+    uint64_t lastSelf = 0;
+    uint64_t lastParent = 0;
+
+    for (size_t hunkIdx = 0; hunkIdx < layout.map.size(); ++hunkIdx) {
+        MapEntry& entry = layout.map[hunkIdx];
+        entry.offset = curOffset;
+        entry.length = 0;
+        entry.crc = 0;
+
+        switch (entry.compression) {
+            case COMPRESSION_TYPE_0:
+            case COMPRESSION_TYPE_1:
+            case COMPRESSION_TYPE_2:
+            case COMPRESSION_TYPE_3:
+                entry.length = bits.read(lengthBits);
+                entry.crc = (uint16_t) bits.read(16);
+                curOffset += entry.length;
+                break;
+
+            case COMPRESSION_NONE:
+                entry.length = layout.hunkBytes;
+                entry.crc = (uint16_t) bits.read(16);
+                curOffset += entry.length;
+                break;
+
+            case COMPRESSION_SELF:
+                entry.offset = lastSelf = bits.read(selfBits);
+                break;
+
+            case COMPRESSION_PARENT:
+                entry.offset = lastParent = bits.read(parentBits);
+                break;
+
+            case COMPRESSION_SELF_1:
+                lastSelf++;
+                [[fallthrough]];
+
+            case COMPRESSION_SELF_0:
+                entry.compression = COMPRESSION_SELF;
+                entry.offset = lastSelf;
+                break;
+
+            case COMPRESSION_PARENT_SELF:
+                entry.compression = COMPRESSION_PARENT;
+                entry.offset = lastParent = ((uint64_t) hunkIdx * layout.hunkBytes) / layout.unitBytes;
+                break;
+
+            case COMPRESSION_PARENT_1:
+                lastParent += layout.hunkBytes / layout.unitBytes;
+                [[fallthrough]];
+
+            case COMPRESSION_PARENT_0:
+                entry.compression = COMPRESSION_PARENT;
+                entry.offset = lastParent;
+                break;
+
+            default:
+                return false;
+        }
+    }
+
+    if (bits.isOverrun())
+        return false;
+
+    // Verify the map is intact: the CRC is over the map entries in their original 12 byte format
+    std::vector<uint8_t> rawMap(layout.map.size() * 12);
+
+    for (size_t hunkIdx = 0; hunkIdx < layout.map.size(); ++hunkIdx) {
+        const MapEntry& entry = layout.map[hunkIdx];
+        uint8_t* const pRawEntry = &rawMap[hunkIdx * 12];
+        pRawEntry[0] = entry.compression;
+
+        for (uint32_t i = 0; i < 3; ++i) {
+            pRawEntry[1 + i] = (uint8_t)(entry.length >> (16 - i * 8));
+        }
+
+        for (uint32_t i = 0; i < 6; ++i) {
+            pRawEntry[4 + i] = (uint8_t)(entry.offset >> (40 - i * 8));
+        }
+
+        pRawEntry[10] = (uint8_t)(entry.crc >> 8);
+        pRawEntry[11] = (uint8_t) entry.crc;
+    }
+
+    if (crc16(rawMap.data(), rawMap.size()) != mapCrc)
+        return false;
+
+    errorMsg.clear();
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Reads the specified hunk, following references to other hunks up to a limited depth
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool ChdFile::readHunkWithDepth(const uint32_t hunkIdx, std::byte* const pDst, const uint32_t depth) noexcept {
+    if ((!mpLayout) || (hunkIdx >= mpLayout->map.size()) || (depth > MAX_HUNK_REF_DEPTH))
+        return false;
+
+    const ChdFileLayout& layout = *mpLayout;
+    const MapEntry& entry = layout.map[hunkIdx];
+
+    switch (entry.compression) {
+        case COMPRESSION_TYPE_0:
+        case COMPRESSION_TYPE_1:
+        case COMPRESSION_TYPE_2:
+        case COMPRESSION_TYPE_3: {
+            if (entry.length > layout.hunkBytes * 2u)
+                return false;
+
+            mCompressedBuffer.resize(entry.length);
+
+            if (!readFileBytes(entry.offset, mCompressedBuffer.data(), entry.length))
+                return false;
+
+            if (!decompressHunk(layout.codecs[entry.compression], mCompressedBuffer.data(), entry.length, pDst))
+                return false;
+        }   break;
+
+        case COMPRESSION_NONE: {
+            // Note: a zero offset in an uncompressed file means the hunk has never been written and is all zeros
+            if ((!layout.bCompressed) && (entry.offset == 0)) {
+                std::memset(pDst, 0, layout.hunkBytes);
+                return true;
+            }
+
+            if (!readFileBytes(entry.offset, pDst, layout.hunkBytes))
+                return false;
+
+            // Uncompressed files don't have hunk CRCs
+            if (!layout.bCompressed)
+                return true;
+        }   break;
+
+        case COMPRESSION_SELF:
+            return readHunkWithDepth((uint32_t) entry.offset, pDst, depth + 1);
+
+        default:
+            return false;
+    }
+
+    return (crc16(pDst, layout.hunkBytes) == entry.crc);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Decompresses the given data for a hunk using the specified codec
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool ChdFile::decompressHunk(const uint32_t codec, const std::byte* const pSrc, const uint32_t srcSize, std::byte* const pDst) noexcept {
+    switch (codec) {
+        case CODEC_ZLIB:
+            return Inflate::decode(pSrc, srcSize, pDst, mpLayout->hunkBytes);
+
+        case CODEC_LZMA:
+            return LzmaDecoder::decode(pSrc, srcSize, pDst, mpLayout->hunkBytes);
+
+        case CODEC_CD_ZLIB:
+        case CODEC_CD_LZMA:
+        case CODEC_CD_FLAC:
+            return decompressCdHunk(codec, pSrc, srcSize, pDst);
+
+        default:
+            return false;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Decompresses the given data for a hunk containing CD frames using the specified CD codec.
+//
+// The sector data for all the frames in the hunk is compressed together with the base codec (zlib, lzma or flac) followed by the subcode
+// data for all the frames compressed with zlib. For zlib and lzma there is a header before the compressed data with a bitmask of sectors
+// which had their sync header and ECC removed, and the size of the compressed sector data. For flac the size is implied by the end of the
+// last FLAC frame, and the sectors are all audio so there is no ECC to restore.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool ChdFile::decompressCdHunk(const uint32_t codec, const std::byte* const pSrc, const uint32_t srcSize, std::byte* const pDst) noexcept {
+    const uint32_t hunkBytes = mpLayout->hunkBytes;
+    const uint32_t numFrames = hunkBytes / CD_FRAME_SIZE;
+
+    if (numFrames * CD_FRAME_SIZE != hunkBytes)
+        return false;
+
+    const uint32_t sectorDataSize = numFrames * CD_SECTOR_DATA_SIZE;
+    const uint32_t subcodeDataSize = numFrames * CD_SUBCODE_DATA_SIZE;
+    mCdSectorBuffer.resize(sectorDataSize + subcodeDataSize);
+
+    std::byte* const pSectorData = mCdSectorBuffer.data();
+    std::byte* const pSubcodeData = mCdSectorBuffer.data() + sectorDataSize;
+    const uint8_t* const pSrcBytes = (const uint8_t*) pSrc;
+    const uint8_t* pEccBitmask = nullptr;
+    uint32_t subcodeOffset;
+
+    if (codec == CODEC_CD_FLAC) {
+        // Note: CD audio is always 16-bit stereo, so each sample is 4 bytes for both channels
+        size_t flacBytesUsed = 0;
+
+        if (!FlacDecoder::decode(pSrc, srcSize, 2, sectorDataSize / 4, pSectorData, flacBytesUsed))
+            return false;
+
+        subcodeOffset = (uint32_t) flacBytesUsed;
+    } else {
+        // Read the header for zlib and lzma
+        const uint32_t eccBytes = (numFrames + 7) / 8;
+        const uint32_t compLenBytes = (hunkBytes < 65536) ? 2 : 3;
+        const uint32_t headerBytes = eccBytes + compLenBytes;
+
+        if (srcSize < headerBytes)
+            return false;
+
+        pEccBitmask = pSrcBytes;
+        const uint32_t baseCompLen = (uint32_t) readBigEndian(pSrcBytes + eccBytes, compLenBytes);
+
+        if (baseCompLen > srcSize - headerBytes)
+            return false;
+
+        const bool bBaseOk = (codec == CODEC_CD_ZLIB) ?
+            Inflate::decode(pSrc + headerBytes, baseCompLen, pSectorData, sectorDataSize) :
+            LzmaDecoder::decode(pSrc + headerBytes, baseCompLen, pSectorData, sectorDataSize);
+
+        if (!bBaseOk)
+            return false;
+
+        subcodeOffset = headerBytes + baseCompLen;
+    }
+
+    // Decompress the subcode data
+    if (subcodeOffset > srcSize)
+        return false;
+
+    if (!Inflate::decode(pSrc + subcodeOffset, srcSize - subcodeOffset, pSubcodeData, subcodeDataSize))
+        return false;
+
+    // Interleave the sector and subcode data for each frame and regenerate any ECC data that was removed
+    for (uint32_t frameIdx = 0; frameIdx < numFrames; ++frameIdx) {
+        std::byte* const pFrame = pDst + (size_t) frameIdx * CD_FRAME_SIZE;
+        std::memcpy(pFrame, pSectorData + (size_t) frameIdx * CD_SECTOR_DATA_SIZE, CD_SECTOR_DATA_SIZE);
+        std::memcpy(pFrame + CD_SECTOR_DATA_SIZE, pSubcodeData + (size_t) frameIdx * CD_SUBCODE_DATA_SIZE, CD_SUBCODE_DATA_SIZE);
+
+        if (pEccBitmask && (pEccBitmask[frameIdx / 8] & (1u << (frameIdx % 8)))) {
+            regenerateSectorEcc((uint8_t*) pFrame);
+        }
+    }
+
+    return true;
+}
+
+END_NAMESPACE(chd)
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "Macros.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+BEGIN_NAMESPACE(chd)
+
+struct ChdFileLayout;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Makes a 4 character tag, as used to identify CHD compression codecs and metadata
+//------------------------------------------------------------------------------------------------------------------------------------------
+constexpr uint32_t makeTag(const char c1, const char c2, const char c3, const char c4) noexcept {
+    return ((uint32_t)(uint8_t) c1 << 24) | ((uint32_t)(uint8_t) c2 << 16) | ((uint32_t)(uint8_t) c3 << 8) | (uint32_t)(uint8_t) c4;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Reads a version 5 CHD (MAME 'Compressed Hunks of Data') file.
+//
+// A CHD file stores a large amount of data as a series of fixed size 'hunks', each of which is compressed separately with one of up to
+// four codecs. For CD images each hunk is a number of 2,448 byte CD frames (2,352 bytes of sector data followed by 96 bytes of subcode).
+// Supported codecs are: zlib, lzma and the CD specific versions of those plus flac ('cdzl', 'cdlz' and 'cdfl').
+// CHD files which depend on a parent CHD are not supported.
+//
+// Each hunk is decompressed on demand and verified against the CRC stored for it.
+// This class is not thread safe: use a separate instance for each thread that reads the file. The header and hunk map of recently opened
+// files are shared between instances, so opening the same file again is cheap.
+//------------------------------------------------------------------------------------------------------------------------------------------
+class ChdFile {
+public:
+    // Size of a CD frame in a CHD file and the amount of sector data and subcode data it contains
+    static constexpr uint32_t CD_FRAME_SIZE = 2448;
+    static constexpr uint32_t CD_SECTOR_DATA_SIZE = 2352;
+    static constexpr uint32_t CD_SUBCODE_DATA_SIZE = 96;
+
+    // Metadata tag for the CD track info: there is one entry of this type for each track
+    static constexpr uint32_t CDROM_TRACK_METADATA2_TAG = makeTag('C', 'H', 'T', '2');
+    static constexpr uint32_t CDROM_TRACK_METADATA_TAG = makeTag('C', 'H', 'T', 'R');
+
+    ChdFile() noexcept;
+    ~ChdFile() noexcept;
+
+    bool open(const char* const filePath, std::string& errorMsg) noexcept;
+    void close() noexcept;
+    inline bool isOpen() const noexcept { return (mpFile != nullptr); }
+
+    uint32_t getHunkSize() const noexcept;
+    uint32_t getNumHunks() const noexcept;
+    uint64_t getLogicalSize() const noexcept;
+
+    bool readHunk(const uint32_t hunkIdx, std::byte* const pDst) noexcept;
+    bool readMetadata(const uint32_t tag, const uint32_t index, std::string& metadata) noexcept;
+
+private:
+    ChdFile(const ChdFile& other) = delete;
+    ChdFile& operator = (const ChdFile& other) = delete;
+
+    bool readFileBytes(const uint64_t offset, void* const pDst, const size_t size) noexcept;
+    bool readLayout(ChdFileLayout& layout, std::string& errorMsg) noexcept;
+    bool readUncompressedMap(ChdFileLayout& layout, std::string& errorMsg) noexcept;
+    bool readCompressedMap(ChdFileLayout& layout, std::string& errorMsg) noexcept;
+    bool readHunkWithDepth(const uint32_t hunkIdx, std::byte* const pDst, const uint32_t depth) noexcept;
+    bool decompressHunk(const uint32_t codec, const std::byte* const pSrc, const uint32_t srcSize, std::byte* const pDst) noexcept;
+    bool decompressCdHunk(const uint32_t codec, const std::byte* const pSrc, const uint32_t srcSize, std::byte* const pDst) noexcept;
+
+    void*                                   mpFile;                 // The open CHD file
+    std::shared_ptr<const ChdFileLayout>    mpLayout;               // Header details and hunk map for the open file: shared with other instances
+    std::vector<std::byte>                  mCompressedBuffer;      // Holds compressed data being read from the file
+    std::vector<std::byte>                  mCdSectorBuffer;        // Holds decompressed sector and subcode data for CD hunks before it is interleaved
+};
+
+END_NAMESPACE(chd)
@@ -0,0 +1,496 @@
+#include "FlacDecoder.h"
+
+#include <vector>
+
+BEGIN_NAMESPACE(chd)
+BEGIN_NAMESPACE(FlacDecoder)
+
+// Limits for the FLAC format, or at least the subset that we support
+static constexpr uint32_t MAX_CHANNELS = 8;             // Max number of channels in a frame
+static constexpr uint32_t MAX_FIXED_ORDER = 4;          // Max order of a fixed predictor
+static constexpr uint32_t MAX_LPC_ORDER = 32;           // Max order of an LPC predictor
+static constexpr uint32_t BITS_PER_SAMPLE = 16;         // The only sample size supported
+
+// Channel assignments for stereo decorrelation
+static constexpr uint32_t CHANNELS_LEFT_SIDE = 8;
+static constexpr uint32_t CHANNELS_SIDE_RIGHT = 9;
+static constexpr uint32_t CHANNELS_MID_SIDE = 10;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Reads bits from the compressed stream, most significant bit first.
+// Reading past the end of the stream yields zero bits: whether that happened is checked via 'isOverrun()' at the end of each frame.
+//------------------------------------------------------------------------------------------------------------------------------------------
+struct BitReader {
+    const uint8_t*  pBeg;
+    const uint8_t*  pCur;
+    const uint8_t*  pEnd;
+    uint64_t        bitBuffer;      // Bits not yet consumed: the next bit to be read is the most significant one
+    uint32_t        numBits;
+    uint32_t        numPadBytes;    // How many zero bytes were fed into the bit buffer after the end of the stream
+
+    void refill() noexcept {
+        while (numBits <= 56) {
+            uint64_t nextByte = 0;
+
+            if (pCur < pEnd) {
+                nextByte = *pCur++;
+            } else {
+                numPadBytes++;
+            }
+
+            bitBuffer |= nextByte << (56 - numBits);
+            numBits += 8;
+        }
+    }
+
+    uint32_t readBits(const uint32_t count) noexcept {
+        if (count == 0)
+            return 0;
+
+        if (numBits < count) {
+            refill();
+        }
+
+        const uint32_t bits = (uint32_t)(bitBuffer >> (64 - count));
+        bitBuffer <<= count;
+        numBits -= count;
+        return bits;
+    }
+
+    int32_t readSignedBits(const uint32_t count) noexcept {
+        if (count == 0)
+            return 0;
+
+        const uint32_t bits = readBits(count);
+        return (int32_t)(bits << (32 - count)) >> (32 - count);
+    }
+
+    // Reads a unary coded number: the count of zero bits before the next one bit
+    uint32_t readUnary() noexcept {
+        uint32_t count = 0;
+
+        while (true) {
+            if (numBits == 0) {
+                refill();
+            }
+
+            if (bitBuffer == 0) {
+                // All remaining buffered bits are zero: consume them all and keep going.
+                // Give up if we are past the end of the data, otherwise we would loop forever.
+                count += numBits;
+                bitBuffer = 0;
+                numBits = 0;
+
+                if (isOverrun())
+                    return count;
+
+                continue;
+            }
+
+            while ((bitBuffer & (1ull << 63)) == 0) {
+                bitBuffer <<= 1;
+                numBits--;
+                count++;
+            }
+
+            // Consume the terminating one bit
+            bitBuffer <<= 1;
+            numBits--;
+            return count;
+        }
+    }
+
+    void alignToByte() noexcept {
+        const uint32_t numBitsToSkip = numBits & 7;
+        bitBuffer <<= numBitsToSkip;
+        numBits -= numBitsToSkip;
+    }
+
+    bool isOverrun() const noexcept {
+        return (numBits < numPadBytes * 8);
+    }
+
+    // How many bytes have been consumed so far, assuming the reader is byte aligned
+    size_t getBytePos() const noexcept {
+        return (size_t)(pCur - pBeg) + numPadBytes - numBits / 8;
+    }
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Reads the UTF-8 style coded frame or sample number from a frame header.
+// We don't need the value itself so it just gets skipped over; returns 'false' if the coding is invalid.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool skipCodedNumber(BitReader& bits) noexcept {
+    const uint32_t firstByte = bits.readBits(8);
+    uint32_t numExtraBytes;
+
+    if ((firstByte & 0x80) == 0) {
+        numExtraBytes = 0;
+    } else if ((firstByte & 0xE0) == 0xC0) {
+        numExtraBytes = 1;
+    } else if ((firstByte & 0xF0) == 0xE0) {
+        numExtraBytes = 2;
+    } else if ((firstByte & 0xF8) == 0xF0) {
+        numExtraBytes = 3;
+    } else if ((firstByte & 0xFC) == 0xF8) {
+        numExtraBytes = 4;
+    } else if ((firstByte & 0xFE) == 0xFC) {
+        numExtraBytes = 5;
+    } else if (firstByte == 0xFE) {
+        numExtraBytes = 6;
+    } else {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < numExtraBytes; ++i) {
+        if ((bits.readBits(8) & 0xC0) != 0x80)
+            return false;
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Decodes the Rice coded residual for a subframe and adds it to the output, following any warm-up samples
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool decodeResidual(BitReader& bits, const uint32_t blockSize, const uint32_t predictorOrder, int32_t* const pOut) noexcept {
+    const uint32_t codingMethod = bits.readBits(2);
+
+    if (codingMethod > 1)
+        return false;
+
+    const uint32_t paramBits = (codingMethod == 0) ? 4 : 5;
+    const uint32_t escapeParam = (1u << paramBits) - 1;
+    const uint32_t partitionOrder = bits.readBits(4);
+    const uint32_t numPartitions = 1u << partitionOrder;
+    const uint32_t partitionSize = blockSize >> partitionOrder;
+
+    if ((partitionSize << partitionOrder != blockSize) || (partitionSize < predictorOrder))
+        return false;
+
+    uint32_t outIdx = predictorOrder;
+
+    for (uint32_t partitionIdx = 0; partitionIdx < numPartitions; ++partitionIdx) {
+        const uint32_t param = bits.readBits(paramBits);
+        const uint32_t numSamples = (partitionIdx == 0) ? partitionSize - predictorOrder : partitionSize;
+
+        if (param == escapeParam) {
+            // Unencoded partition: samples are stored as plain signed values
+            const uint32_t numRawBits = bits.readBits(5);
+
+            for (uint32_t i = 0; i < numSamples; ++i) {
+                pOut[outIdx++] = bits.readSignedBits(numRawBits);
+            }
+        } else {
+            for (uint32_t i = 0; i < numSamples; ++i) {
+                const uint32_t quotient = bits.readUnary();
+                const uint32_t value = (quotient << param) | bits.readBits(param);
+                pOut[outIdx++] = (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+            }
+        }
+
+        if (bits.isOverrun())
+            return false;
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Decodes a single subframe (one channel's worth of samples for a frame)
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool decodeSubframe(BitReader& bits, const uint32_t blockSize, uint32_t bitsPerSample, int32_t* const pOut) noexcept {
+    // Read the subframe header
+    if (bits.readBits(1) != 0)
+        return false;
+
+    const uint32_t type = bits.readBits(6);
+    uint32_t wastedBits = 0;
+
+    if (bits.readBits(1) != 0) {
+        wastedBits = bits.readUnary() + 1;
+
+        if (wastedBits >= bitsPerSample)
+            return false;
+
+        bitsPerSample -= wastedBits;
+    }
+
+    // Decode the samples according to the subframe type
+    if (type == 0) {
+        // Constant value
+        const int32_t value = bits.readSignedBits(bitsPerSample);
+
+        for (uint32_t i = 0; i < blockSize; ++i) {
+            pOut[i] = value;
+        }
+    }
+    else if (type == 1) {
+        // Verbatim samples
+        for (uint32_t i = 0; i < blockSize; ++i) {
+            pOut[i] = bits.readSignedBits(bitsPerSample);
+        }
+    }
+    else if ((type >= 8) && (type <= 8 + MAX_FIXED_ORDER)) {
+        // Fixed polynomial predictor: read the warm-up samples and residual, then apply the predictor
+        const uint32_t order = type - 8;
+
+        if (order > blockSize)
+            return false;
+
+        for (uint32_t i = 0; i < order; ++i) {
+            pOut[i] = bits.readSignedBits(bitsPerSample);
+        }
+
+        if (!decodeResidual(bits, blockSize, order, pOut))
+            return false;
+
+        switch (order) {
+            case 1:
+                for (uint32_t i = 1; i < blockSize; ++i) {
+                    pOut[i] += pOut[i - 1];
+                }
+                break;
+
+            case 2:
+                for (uint32_t i = 2; i < blockSize; ++i) {
+                    pOut[i] += 2 * pOut[i - 1] - pOut[i - 2];
+                }
+                break;
+
+            case 3:
+                for (uint32_t i = 3; i < blockSize; ++i) {
+                    pOut[i] += 3 * pOut[i - 1] - 3 * pOut[i - 2] + pOut[i - 3];
+                }
+                break;
+
+            case 4:
+                for (uint32_t i = 4; i < blockSize; ++i) {
+                    pOut[i] += 4 * pOut[i - 1] - 6 * pOut[i - 2] + 4 * pOut[i - 3] - pOut[i - 4];
+                }
+                break;
+
+            default:
+                break;
+        }
+    }
+    else if (type >= 32) {
+        // Linear predictor: read the warm-up samples, predictor coefficients and residual, then apply the predictor
+        const uint32_t order = type - 31;
+
+        if (order > blockSize)
+            return false;
+
+        for (uint32_t i = 0; i < order; ++i) {
+            pOut[i] = bits.readSignedBits(bitsPerSample);
+        }
+
+        const uint32_t precision = bits.readBits(4) + 1;
+
+        if (precision == 16)
+            return false;
+
+        const int32_t shift = bits.readSignedBits(5);
+
+        if (shift < 0)
+            return false;
+
+        int32_t coefs[MAX_LPC_ORDER];
+
+        for (uint32_t i = 0; i < order; ++i) {
+            coefs[i] = bits.readSignedBits(precision);
+        }
+
+        if (!decodeResidual(bits, blockSize, order, pOut))
+            return false;
+
+        for (uint32_t i = order; i < blockSize; ++i) {
+            int64_t prediction = 0;
+
+            for (uint32_t j = 0; j < order; ++j) {
+                prediction += (int64_t) coefs[j] * pOut[i - 1 - j];
+            }
+
+            pOut[i] += (int32_t)(prediction >> shift);
+        }
+    }
+    else {
+        return false;
+    }
+
+    // Restore any wasted low bits
+    if (wastedBits > 0) {
+        for (uint32_t i = 0; i < blockSize; ++i) {
+            pOut[i] = (int32_t)((uint32_t) pOut[i] << wastedBits);
+        }
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Decodes a frame and writes the samples to the output, which must have room for the frame's samples
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool decodeFrame(
+    BitReader& bits,
+    const uint32_t numChannels,
+    const uint32_t maxBlockSize,
+    std::vector<int32_t>& channelSamples,
+    uint8_t* const pDst,
+    uint32_t& blockSizeOut
+) noexcept {
+    // Read and verify the frame header: the sync code must be present
+    if (bits.readBits(15) != 0x7FFC)
+        return false;
+
+    bits.readBits(1);   // Blocking strategy: don't care
+
+    const uint32_t blockSizeCode = bits.readBits(4);
+    const uint32_t sampleRateCode = bits.readBits(4);
+    const uint32_t channelAssignment = bits.readBits(4);
+    const uint32_t sampleSizeCode = bits.readBits(3);
+
+    if (bits.readBits(1) != 0)
+        return false;
+
+    if (!skipCodedNumber(bits))
+        return false;
+
+    uint32_t blockSize;
+
+    if (blockSizeCode == 1) {
+        blockSize = 192;
+    } else if ((blockSizeCode >= 2) && (blockSizeCode <= 5)) {
+        blockSize = 576u << (blockSizeCode - 2);
+    } else if (blockSizeCode == 6) {
+        blockSize = bits.readBits(8) + 1;
+    } else if (blockSizeCode == 7) {
+        blockSize = bits.readBits(16) + 1;
+    } else if (blockSizeCode >= 8) {
+        blockSize = 256u << (blockSizeCode - 8);
+    } else {
+        return false;
+    }
+
+    // Skip the sample rate if it is stored at the end of the header: we don't care what it is
+    if (sampleRateCode == 12) {
+        bits.readBits(8);
+    } else if ((sampleRateCode == 13) || (sampleRateCode == 14)) {
+        bits.readBits(16);
+    } else if (sampleRateCode == 15) {
+        return false;
+    }
+
+    bits.readBits(8);   // Header CRC-8: the CHD hunk CRC is checked instead
+
+    // Check the frame format is what we expect
+    const uint32_t frameChannels = (channelAssignment < CHANNELS_LEFT_SIDE) ? channelAssignment + 1 : 2;
+
+    if ((channelAssignment > CHANNELS_MID_SIDE) || (frameChannels != numChannels))
+        return false;
+
+    if ((sampleSizeCode != 0) && (sampleSizeCode != 4))
+        return false;
+
+    if (blockSize > maxBlockSize)
+        return false;
+
+    // Decode the subframes for each channel. The side channel in stereo decorrelation has an extra bit of precision.
+    channelSamples.resize((size_t) blockSize * numChannels);
+
+    for (uint32_t chanIdx = 0; chanIdx < numChannels; ++chanIdx) {
+        const bool bIsSideChannel = (
+            ((channelAssignment == CHANNELS_LEFT_SIDE) && (chanIdx == 1)) ||
+            ((channelAssignment == CHANNELS_SIDE_RIGHT) && (chanIdx == 0)) ||
+            ((channelAssignment == CHANNELS_MID_SIDE) && (chanIdx == 1))
+        );
+
+        const uint32_t bitsPerSample = BITS_PER_SAMPLE + ((bIsSideChannel) ? 1 : 0);
+
+        if (!decodeSubframe(bits, blockSize, bitsPerSample, channelSamples.data() + (size_t) chanIdx * blockSize))
+            return false;
+    }
+
+    // Frame footer: padding to a byte boundary and the frame CRC-16 (which the CHD hunk CRC makes redundant)
+    bits.alignToByte();
+    bits.readBits(16);
+
+    if (bits.isOverrun())
+        return false;
+
+    // Undo stereo decorrelation
+    int32_t* const pChan0 = channelSamples.data();
+    int32_t* const pChan1 = channelSamples.data() + blockSize;
+
+    if (channelAssignment == CHANNELS_LEFT_SIDE) {
+        for (uint32_t i = 0; i < blockSize; ++i) {
+            pChan1[i] = pChan0[i] - pChan1[i];
+        }
+    }
+    else if (channelAssignment == CHANNELS_SIDE_RIGHT) {
+        for (uint32_t i = 0; i < blockSize; ++i) {
+            pChan0[i] += pChan1[i];
+        }
+    }
+    else if (channelAssignment == CHANNELS_MID_SIDE) {
+        for (uint32_t i = 0; i < blockSize; ++i) {
+            const int32_t side = pChan1[i];
+            const int32_t mid = (int32_t)((uint32_t) pChan0[i] << 1) | (side & 1);
+            pChan0[i] = (mid + side) >> 1;
+            pChan1[i] = (mid - side) >> 1;
+        }
+    }
+
+    // Output the samples interleaved and in big endian format
+    for (uint32_t i = 0; i < blockSize; ++i) {
+        for (uint32_t chanIdx = 0; chanIdx < numChannels; ++chanIdx) {
+            const uint16_t sample = (uint16_t) channelSamples[(size_t) chanIdx * blockSize + i];
+            uint8_t* const pSampleDst = pDst + ((size_t) i * numChannels + chanIdx) * 2;
+            pSampleDst[0] = (uint8_t)(sample >> 8);
+            pSampleDst[1] = (uint8_t) sample;
+        }
+    }
+
+    blockSizeOut = blockSize;
+    return true;
+}
+
+bool decode(
+    const std::byte* const pSrc,
+    const size_t srcSize,
+    const uint32_t numChannels,
+    const uint32_t numSamples,
+    std::byte* const pDst,
+    size_t& srcBytesUsed
+) noexcept {
+    srcBytesUsed = 0;
+
+    if ((numChannels < 1) || (numChannels > MAX_CHANNELS))
+        return false;
+
+    BitReader bits = {};
+    bits.pBeg = (const uint8_t*) pSrc;
+    bits.pCur = (const uint8_t*) pSrc;
+    bits.pEnd = (const uint8_t*) pSrc + srcSize;
+
+    // Decode frames until we have all the samples
+    std::vector<int32_t> channelSamples;
+    uint8_t* const pDstBytes = (uint8_t*) pDst;
+    uint32_t samplesDone = 0;
+
+    while (samplesDone < numSamples) {
+        uint32_t blockSize = 0;
+        uint8_t* const pFrameDst = pDstBytes + (size_t) samplesDone * numChannels * 2;
+
+        if (!decodeFrame(bits, numChannels, numSamples - samplesDone, channelSamples, pFrameDst, blockSize))
+            return false;
+
+        samplesDone += blockSize;
+    }
+
+    srcBytesUsed = bits.getBytePos();
+    return true;
+}
+
+END_NAMESPACE(FlacDecoder)
+END_NAMESPACE(chd)
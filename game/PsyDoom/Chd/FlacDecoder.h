@@ -0,0 +1,27 @@
+#pragma once
+
+#include "Macros.h"
+
+#include <cstddef>
+#include <cstdint>
+
+BEGIN_NAMESPACE(chd)
+BEGIN_NAMESPACE(FlacDecoder)
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Decoder for a sequence of FLAC frames (with no 'fLaC' stream header or metadata), as used by the 'flac' and 'cdfl' CHD hunk codecs.
+// Decodes exactly the specified number of 16-bit samples per channel and outputs them interleaved in big endian order, which is the byte
+// order CHD stores CD audio in. The number of input bytes used (up to the end of the last frame) is also returned.
+// Returns 'false' if the data is invalid or truncated, or doesn't match the expected format.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool decode(
+    const std::byte* const pSrc,
+    const size_t srcSize,
+    const uint32_t numChannels,
+    const uint32_t numSamples,
+    std::byte* const pDst,
+    size_t& srcBytesUsed
+) noexcept;
+
+END_NAMESPACE(FlacDecoder)
+END_NAMESPACE(chd)
@@ -0,0 +1,409 @@
+#include "Inflate.h"
+
+#include <cstdint>
+#include <cstring>
+
+BEGIN_NAMESPACE(chd)
+BEGIN_NAMESPACE(Inflate)
+
+// Limits for the DEFLATE format
+static constexpr uint32_t MAX_CODE_BITS = 15;           // Maximum length of a Huffman code
+static constexpr uint32_t NUM_LIT_LEN_CODES = 288;      // Number of literal/length codes (including 2 unused ones)
+static constexpr uint32_t NUM_DIST_CODES = 32;          // Number of distance codes (including 2 unused ones)
+static constexpr uint32_t NUM_CODE_LEN_CODES = 19;      // Number of codes in the code length alphabet used by dynamic blocks
+
+// How many bits are decoded with a single table lookup.
+// Longer codes (which are rare) are decoded one bit at a time.
+static constexpr uint32_t FAST_BITS = 10;
+
+// Base values and number of extra bits for length codes 257-285 and distance codes 0-29
+static constexpr uint16_t LENGTH_BASE[29] = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+
+static constexpr uint8_t LENGTH_EXTRA_BITS[29] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+
+static constexpr uint16_t DIST_BASE[30] = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289,
+    16385, 24577
+};
+
+static constexpr uint8_t DIST_EXTRA_BITS[30] = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+
+// The order in which code length code lengths are stored in a dynamic block header
+static constexpr uint8_t CODE_LEN_ORDER[NUM_CODE_LEN_CODES] = {
+    16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Reads bits from the compressed stream, least significant bit first.
+// Reading past the end of the stream yields zero bits: whether that happened is checked via 'isOverrun()' at key points.
+//------------------------------------------------------------------------------------------------------------------------------------------
+struct BitReader {
+    const uint8_t*  pCur;
+    const uint8_t*  pEnd;
+    uint64_t        bitBuffer;
+    uint32_t        numBits;
+    uint32_t        numPadBytes;    // How many zero bytes were fed into the bit buffer after the end of the stream
+
+    void refill() noexcept {
+        while (numBits <= 56) {
+            if (pCur < pEnd) {
+                bitBuffer |= (uint64_t) *pCur++ << numBits;
+            } else {
+                numPadBytes++;
+            }
+
+            numBits += 8;
+        }
+    }
+
+    uint32_t peek(const uint32_t count) const noexcept {
+        return (uint32_t)(bitBuffer & ((1ull << count) - 1));
+    }
+
+    void consume(const uint32_t count) noexcept {
+        bitBuffer >>= count;
+        numBits -= count;
+    }
+
+    uint32_t read(const uint32_t count) noexcept {
+        if (numBits < count) {
+            refill();
+        }
+
+        const uint32_t bits = peek(count);
+        consume(count);
+        return bits;
+    }
+
+    void alignToByte() noexcept {
+        consume(numBits & 7);
+    }
+
+    bool isOverrun() const noexcept {
+        return (numBits < numPadBytes * 8);
+    }
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// A canonical Huffman code for decoding.
+// Codes up to 'FAST_BITS' long are found via a lookup table, the rest by walking the code lengths.
+//------------------------------------------------------------------------------------------------------------------------------------------
+struct HuffTable {
+    uint16_t    fast[1 << FAST_BITS];           // Indexed by the next 'FAST_BITS' of input: '(symbol << 4) | codeLength' or '0' for a long code
+    uint16_t    lengthCounts[MAX_CODE_BITS + 1];    // How many symbols there are with each code length
+    uint16_t    symbols[NUM_LIT_LEN_CODES];     // Symbols ordered by code length and then by symbol value (canonical order)
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Builds the decoding table for a Huffman code with the given code lengths (0 = unused symbol).
+// Incomplete codes are allowed (a single distance code is legal) but over-subscribed codes are not.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool buildTable(HuffTable& table, const uint8_t* const pCodeLengths, const uint32_t numSymbols) noexcept {
+    std::memset(&table, 0, sizeof(table));
+
+    for (uint32_t sym = 0; sym < numSymbols; ++sym) {
+        table.lengthCounts[pCodeLengths[sym]]++;
+    }
+
+    table.lengthCounts[0] = 0;
+
+    // Check the code is not over-subscribed and figure out where each code length starts in the canonical symbol order
+    uint16_t offsets[MAX_CODE_BITS + 2] = {};
+    int32_t codesLeft = 1;
+
+    for (uint32_t len = 1; len <= MAX_CODE_BITS; ++len) {
+        codesLeft = (codesLeft << 1) - table.lengthCounts[len];
+
+        if (codesLeft < 0)
+            return false;
+
+        offsets[len + 1] = offsets[len] + table.lengthCounts[len];
+    }
+
+    // Place the symbols in canonical order and fill in the fast lookup table for short codes
+    uint32_t nextCode[MAX_CODE_BITS + 1] = {};
+    uint32_t code = 0;
+
+    for (uint32_t len = 1; len <= MAX_CODE_BITS; ++len) {
+        code = (code + table.lengthCounts[len - 1]) << 1;
+        nextCode[len] = code;
+    }
+
+    for (uint32_t sym = 0; sym < numSymbols; ++sym) {
+        const uint32_t len = pCodeLengths[sym];
+
+        if (len == 0)
+            continue;
+
+        table.symbols[offsets[len]++] = (uint16_t) sym;
+        const uint32_t symCode = nextCode[len]++;
+
+        if (len <= FAST_BITS) {
+            // Codes are stored most significant bit first, so reverse them to match the order bits are read in
+            uint32_t reversedCode = 0;
+
+            for (uint32_t i = 0; i < len; ++i) {
+                reversedCode |= ((symCode >> i) & 1) << (len - 1 - i);
+            }
+
+            for (uint32_t i = reversedCode; i < (1u << FAST_BITS); i += (1u << len)) {
+                table.fast[i] = (uint16_t)((sym << 4) | len);
+            }
+        }
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Decodes one symbol using the given Huffman table, returning '-1' if the input is not a valid code
+//------------------------------------------------------------------------------------------------------------------------------------------
+static int32_t decodeSymbol(BitReader& bits, const HuffTable& table) noexcept {
+    if (bits.numBits < MAX_CODE_BITS) {
+        bits.refill();
+    }
+
+    // Try the fast lookup table first
+    const uint16_t fastEntry = table.fast[bits.peek(FAST_BITS)];
+
+    if (fastEntry != 0) {
+        bits.consume(fastEntry & 0xF);
+        return fastEntry >> 4;
+    }
+
+    // Long code: walk the code lengths one bit at a time until we find which range of canonical codes the input falls in
+    int32_t code = 0;
+    int32_t firstCode = 0;
+    int32_t symbolIdx = 0;
+
+    for (uint32_t len = 1; len <= MAX_CODE_BITS; ++len) {
+        code |= (int32_t)((bits.bitBuffer >> (len - 1)) & 1);
+        const int32_t count = table.lengthCounts[len];
+
+        if (code - count < firstCode) {
+            bits.consume(len);
+            return table.symbols[symbolIdx + (code - firstCode)];
+        }
+
+        symbolIdx += count;
+        firstCode = (firstCode + count) << 1;
+        code <<= 1;
+    }
+
+    return -1;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Reads the code lengths for a dynamic block and builds the literal/length and distance tables
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool readDynamicTables(BitReader& bits, HuffTable& litLenTable, HuffTable& distTable) noexcept {
+    const uint32_t numLitLenCodes = bits.read(5) + 257;
+    const uint32_t numDistCodes = bits.read(5) + 1;
+    const uint32_t numCodeLenCodes = bits.read(4) + 4;
+
+    if ((numLitLenCodes > 286) || (numDistCodes > 30))
+        return false;
+
+    // Read the code length code
+    uint8_t codeLenCodeLengths[NUM_CODE_LEN_CODES] = {};
+
+    for (uint32_t i = 0; i < numCodeLenCodes; ++i) {
+        codeLenCodeLengths[CODE_LEN_ORDER[i]] = (uint8_t) bits.read(3);
+    }
+
+    HuffTable codeLenTable;
+
+    if (!buildTable(codeLenTable, codeLenCodeLengths, NUM_CODE_LEN_CODES))
+        return false;
+
+    // Read the literal/length and distance code lengths, which are run length encoded as a single sequence
+    uint8_t codeLengths[NUM_LIT_LEN_CODES + NUM_DIST_CODES] = {};
+    const uint32_t numCodeLengths = numLitLenCodes + numDistCodes;
+
+    for (uint32_t i = 0; i < numCodeLengths;) {
+        const int32_t sym = decodeSymbol(bits, codeLenTable);
+
+        if (sym < 0)
+            return false;
+
+        if (sym < 16) {
+            codeLengths[i++] = (uint8_t) sym;
+            continue;
+        }
+
+        uint8_t repeatLen = 0;
+        uint32_t repeatCount;
+
+        if (sym == 16) {
+            if (i == 0)
+                return false;
+
+            repeatLen = codeLengths[i - 1];
+            repeatCount = 3 + bits.read(2);
+        } else if (sym == 17) {
+            repeatCount = 3 + bits.read(3);
+        } else {
+            repeatCount = 11 + bits.read(7);
+        }
+
+        if (i + repeatCount > numCodeLengths)
+            return false;
+
+        std::memset(codeLengths + i, repeatLen, repeatCount);
+        i += repeatCount;
+    }
+
+    // The end of block code must be present
+    if (codeLengths[256] == 0)
+        return false;
+
+    return (
+        buildTable(litLenTable, codeLengths, numLitLenCodes) &&
+        buildTable(distTable, codeLengths + numLitLenCodes, numDistCodes)
+    );
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Builds the tables for the fixed Huffman codes defined by the DEFLATE format
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void buildFixedTables(HuffTable& litLenTable, HuffTable& distTable) noexcept {
+    uint8_t codeLengths[NUM_LIT_LEN_CODES];
+    std::memset(codeLengths + 0, 8, 144);
+    std::memset(codeLengths + 144, 9, 112);
+    std::memset(codeLengths + 256, 7, 24);
+    std::memset(codeLengths + 280, 8, 8);
+    buildTable(litLenTable, codeLengths, NUM_LIT_LEN_CODES);
+
+    std::memset(codeLengths, 5, NUM_DIST_CODES);
+    buildTable(distTable, codeLengths, NUM_DIST_CODES);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Decodes the compressed data for a block using the given tables
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool decodeBlockData(
+    BitReader& bits,
+    const HuffTable& litLenTable,
+    const HuffTable& distTable,
+    uint8_t* const pDst,
+    const size_t dstSize,
+    size_t& dstPos
+) noexcept {
+    while (true) {
+        const int32_t sym = decodeSymbol(bits, litLenTable);
+
+        if (sym < 256) {
+            // Literal byte, or an invalid code
+            if ((sym < 0) || (dstPos >= dstSize))
+                return false;
+
+            pDst[dstPos++] = (uint8_t) sym;
+            continue;
+        }
+
+        if (sym == 256)
+            return (!bits.isOverrun());
+
+        // Length and distance pair: copy from earlier in the output
+        const uint32_t lengthCode = (uint32_t) sym - 257;
+
+        if (lengthCode >= 29)
+            return false;
+
+        const uint32_t length = LENGTH_BASE[lengthCode] + bits.read(LENGTH_EXTRA_BITS[lengthCode]);
+        const int32_t distCode = decodeSymbol(bits, distTable);
+
+        if ((distCode < 0) || (distCode >= 30))
+            return false;
+
+        const uint32_t dist = DIST_BASE[distCode] + bits.read(DIST_EXTRA_BITS[distCode]);
+
+        if ((dist > dstPos) || (length > dstSize - dstPos))
+            return false;
+
+        // Note: the source and destination can overlap (repeating patterns), so this must be done byte by byte
+        const uint8_t* pCopySrc = pDst + dstPos - dist;
+        uint8_t* pCopyDst = pDst + dstPos;
+
+        for (uint32_t i = 0; i < length; ++i) {
+            pCopyDst[i] = pCopySrc[i];
+        }
+
+        dstPos += length;
+    }
+}
+
+bool decode(const std::byte* const pSrc, const size_t srcSize, std::byte* const pDst, const size_t dstSize) noexcept {
+    BitReader bits = {};
+    bits.pCur = (const uint8_t*) pSrc;
+    bits.pEnd = (const uint8_t*) pSrc + srcSize;
+    bits.refill();
+
+    uint8_t* const pDstBytes = (uint8_t*) pDst;
+    size_t dstPos = 0;
+
+    HuffTable litLenTable;
+    HuffTable distTable;
+    bool bFinalBlock = false;
+
+    while (!bFinalBlock) {
+        bFinalBlock = (bits.read(1) != 0);
+        const uint32_t blockType = bits.read(2);
+
+        if (blockType == 0) {
+            // Stored block: byte aligned length and length complement followed by the raw bytes
+            bits.alignToByte();
+            const uint32_t len = bits.read(16);
+            const uint32_t lenComplement = bits.read(16);
+
+            if ((len != (~lenComplement & 0xFFFF)) || bits.isOverrun() || (len > dstSize - dstPos))
+                return false;
+
+            // Use up whatever bytes are in the bit buffer, then copy the rest directly
+            uint32_t bytesLeft = len;
+
+            while ((bytesLeft > 0) && (bits.numBits >= 8)) {
+                pDstBytes[dstPos++] = (uint8_t) bits.read(8);
+                bytesLeft--;
+            }
+
+            if (bits.isOverrun() || ((size_t)(bits.pEnd - bits.pCur) < bytesLeft))
+                return false;
+
+            if (bytesLeft > 0) {
+                std::memcpy(pDstBytes + dstPos, bits.pCur, bytesLeft);
+                dstPos += bytesLeft;
+                bits.pCur += bytesLeft;
+            }
+
+            bits.refill();
+        }
+        else if (blockType == 1) {
+            buildFixedTables(litLenTable, distTable);
+
+            if (!decodeBlockData(bits, litLenTable, distTable, pDstBytes, dstSize, dstPos))
+                return false;
+        }
+        else if (blockType == 2) {
+            if (!readDynamicTables(bits, litLenTable, distTable))
+                return false;
+
+            if (!decodeBlockData(bits, litLenTable, distTable, pDstBytes, dstSize, dstPos))
+                return false;
+        }
+        else {
+            return false;
+        }
+    }
+
+    return ((!bits.isOverrun()) && (dstPos == dstSize));
+}
+
+END_NAMESPACE(Inflate)
+END_NAMESPACE(chd)
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "Macros.h"
+
+#include <cstddef>
+
+BEGIN_NAMESPACE(chd)
+BEGIN_NAMESPACE(Inflate)
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Decoder for raw DEFLATE streams (RFC 1951, no zlib header), as used by the 'zlib' and 'cdzl' CHD hunk codecs.
+// Decodes a complete stream which must produce exactly the specified number of output bytes.
+// Returns 'false' if the data is invalid or truncated, or if the output size does not match.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool decode(const std::byte* const pSrc, const size_t srcSize, std::byte* const pDst, const size_t dstSize) noexcept;
+
+END_NAMESPACE(Inflate)
+END_NAMESPACE(chd)
@@ -0,0 +1,348 @@
+#include "LzmaDecoder.h"
+
+#include <memory>
+#include <vector>
+
+BEGIN_NAMESPACE(chd)
+BEGIN_NAMESPACE(LzmaDecoder)
+
+// Limits and constants for the LZMA format.
+// For more details see the 'LzmaSpec.cpp' reference decoder in the LZMA SDK, which the naming here mostly follows.
+static constexpr uint32_t NUM_STATES            = 12;       // Number of states in the LZMA state machine
+static constexpr uint32_t NUM_POS_BITS_MAX      = 4;        // Maximum value of 'pb'
+static constexpr uint32_t NUM_LEN_TO_POS_STATES = 4;        // Number of match length contexts used for decoding distances
+static constexpr uint32_t NUM_ALIGN_BITS        = 4;        // Number of low distance bits coded with the align decoder
+static constexpr uint32_t START_POS_MODEL_IDX   = 4;        // Distance slots below this are the distance itself
+static constexpr uint32_t END_POS_MODEL_IDX     = 14;       // Distance slots from here on use direct bits plus the align decoder
+static constexpr uint32_t NUM_FULL_DISTANCES    = 1u << (END_POS_MODEL_IDX >> 1);
+static constexpr uint32_t MATCH_MIN_LEN         = 2;        // Shortest possible match
+
+static constexpr uint32_t NUM_BIT_MODEL_BITS    = 11;       // Precision of bit probabilities
+static constexpr uint32_t BIT_MODEL_TOTAL       = 1u << NUM_BIT_MODEL_BITS;
+static constexpr uint32_t NUM_MOVE_BITS         = 5;        // Adaption speed of bit probabilities
+static constexpr uint32_t RANGE_TOP_VALUE       = 1u << 24; // The range is normalized when it drops below this
+
+typedef uint16_t Prob;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Range decoder for the compressed stream.
+// Reading past the end of the stream yields zero bytes: whether that happened is checked once decoding is done.
+//------------------------------------------------------------------------------------------------------------------------------------------
+struct RangeDecoder {
+    const uint8_t*  pCur;
+    const uint8_t*  pEnd;
+    uint32_t        range;
+    uint32_t        code;
+    bool            bOverrun;
+
+    uint8_t readByte() noexcept {
+        if (pCur < pEnd)
+            return *pCur++;
+
+        bOverrun = true;
+        return 0;
+    }
+
+    bool init(const uint8_t* const pSrc, const size_t srcSize) noexcept {
+        pCur = pSrc;
+        pEnd = pSrc + srcSize;
+        range = 0xFFFFFFFF;
+        code = 0;
+        bOverrun = false;
+
+        // The first byte is always zero
+        const uint8_t firstByte = readByte();
+
+        for (int32_t i = 0; i < 4; ++i) {
+            code = (code << 8) | readByte();
+        }
+
+        return ((firstByte == 0) && (code != range));
+    }
+
+    void normalize() noexcept {
+        if (range < RANGE_TOP_VALUE) {
+            range <<= 8;
+            code = (code << 8) | readByte();
+        }
+    }
+
+    uint32_t decodeBit(Prob& prob) noexcept {
+        const uint32_t bound = (range >> NUM_BIT_MODEL_BITS) * prob;
+        uint32_t bit;
+
+        if (code < bound) {
+            prob = (Prob)(prob + ((BIT_MODEL_TOTAL - prob) >> NUM_MOVE_BITS));
+            range = bound;
+            bit = 0;
+        } else {
+            prob = (Prob)(prob - (prob >> NUM_MOVE_BITS));
+            code -= bound;
+            range -= bound;
+            bit = 1;
+        }
+
+        normalize();
+        return bit;
+    }
+
+    uint32_t decodeDirectBits(const uint32_t numBits) noexcept {
+        uint32_t result = 0;
+
+        for (uint32_t i = 0; i < numBits; ++i) {
+            range >>= 1;
+            code -= range;
+            const uint32_t mask = 0u - (code >> 31);
+            code += range & mask;
+            result = (result << 1) + (mask + 1);
+            normalize();
+        }
+
+        return result;
+    }
+
+    // Decode a symbol of the given number of bits, most significant bit first
+    uint32_t decodeBitTree(Prob* const pProbs, const uint32_t numBits) noexcept {
+        uint32_t m = 1;
+
+        for (uint32_t i = 0; i < numBits; ++i) {
+            m = (m << 1) + decodeBit(pProbs[m]);
+        }
+
+        return m - (1u << numBits);
+    }
+
+    // Decode a symbol of the given number of bits, least significant bit first
+    uint32_t decodeReverseBitTree(Prob* const pProbs, const uint32_t numBits) noexcept {
+        uint32_t m = 1;
+        uint32_t symbol = 0;
+
+        for (uint32_t i = 0; i < numBits; ++i) {
+            const uint32_t bit = decodeBit(pProbs[m]);
+            m = (m << 1) + bit;
+            symbol |= bit << i;
+        }
+
+        return symbol;
+    }
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Probabilities for decoding match lengths
+//------------------------------------------------------------------------------------------------------------------------------------------
+struct LenDecoder {
+    Prob    choice;
+    Prob    choice2;
+    Prob    low[1 << NUM_POS_BITS_MAX][1 << 3];
+    Prob    mid[1 << NUM_POS_BITS_MAX][1 << 3];
+    Prob    high[1 << 8];
+
+    uint32_t decode(RangeDecoder& rc, const uint32_t posState) noexcept {
+        if (rc.decodeBit(choice) == 0)
+            return rc.decodeBitTree(low[posState], 3);
+
+        if (rc.decodeBit(choice2) == 0)
+            return 8 + rc.decodeBitTree(mid[posState], 3);
+
+        return 16 + rc.decodeBitTree(high, 8);
+    }
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// All of the probabilities used by the decoder, apart from the literal ones (which vary in number)
+//------------------------------------------------------------------------------------------------------------------------------------------
+struct DecoderProbs {
+    Prob        isMatch[NUM_STATES << NUM_POS_BITS_MAX];
+    Prob        isRep[NUM_STATES];
+    Prob        isRepG0[NUM_STATES];
+    Prob        isRepG1[NUM_STATES];
+    Prob        isRepG2[NUM_STATES];
+    Prob        isRep0Long[NUM_STATES << NUM_POS_BITS_MAX];
+    Prob        posSlot[NUM_LEN_TO_POS_STATES][1 << 6];
+    Prob        posDecoders[1 + NUM_FULL_DISTANCES - END_POS_MODEL_IDX];
+    Prob        align[1 << NUM_ALIGN_BITS];
+    LenDecoder  lenDecoder;
+    LenDecoder  repLenDecoder;
+};
+
+static_assert(sizeof(DecoderProbs) % sizeof(Prob) == 0);
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Helper: initializes all the given probabilities to 0.5
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void initProbs(Prob* const pProbs, const size_t numProbs) noexcept {
+    for (size_t i = 0; i < numProbs; ++i) {
+        pProbs[i] = BIT_MODEL_TOTAL / 2;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Helper: decodes a match distance for a match of the given length (minus the minimum match length)
+//------------------------------------------------------------------------------------------------------------------------------------------
+static uint32_t decodeDistance(RangeDecoder& rc, DecoderProbs& probs, const uint32_t len) noexcept {
+    const uint32_t lenState = (len < NUM_LEN_TO_POS_STATES - 1) ? len : NUM_LEN_TO_POS_STATES - 1;
+    const uint32_t posSlot = rc.decodeBitTree(probs.posSlot[lenState], 6);
+
+    if (posSlot < START_POS_MODEL_IDX)
+        return posSlot;
+
+    const uint32_t numDirectBits = (posSlot >> 1) - 1;
+    uint32_t dist = (2 | (posSlot & 1)) << numDirectBits;
+
+    if (posSlot < END_POS_MODEL_IDX) {
+        dist += rc.decodeReverseBitTree(probs.posDecoders + dist - posSlot, numDirectBits);
+    } else {
+        dist += rc.decodeDirectBits(numDirectBits - NUM_ALIGN_BITS) << NUM_ALIGN_BITS;
+        dist += rc.decodeReverseBitTree(probs.align, NUM_ALIGN_BITS);
+    }
+
+    return dist;
+}
+
+bool decode(
+    const std::byte* const pSrc,
+    const size_t srcSize,
+    std::byte* const pDst,
+    const size_t dstSize,
+    const uint32_t lc,
+    const uint32_t lp,
+    const uint32_t pb
+) noexcept {
+    if ((lc > 8) || (lp > 4) || (pb > NUM_POS_BITS_MAX))
+        return false;
+
+    RangeDecoder rc;
+
+    if (!rc.init((const uint8_t*) pSrc, srcSize))
+        return false;
+
+    // Setup the probabilities: note that the decoder state is big, so it goes on the heap
+    std::unique_ptr<DecoderProbs> pProbs = std::make_unique<DecoderProbs>();
+    DecoderProbs& probs = *pProbs;
+    initProbs((Prob*) &probs, sizeof(DecoderProbs) / sizeof(Prob));
+
+    std::vector<Prob> litProbs((size_t) 0x300 << (lc + lp));
+    initProbs(litProbs.data(), litProbs.size());
+
+    // Decode until the output is full
+    uint8_t* const pOut = (uint8_t*) pDst;
+    const uint32_t lpMask = (1u << lp) - 1;
+    const uint32_t pbMask = (1u << pb) - 1;
+
+    size_t outPos = 0;
+    uint32_t state = 0;
+    uint32_t rep0 = 0;
+    uint32_t rep1 = 0;
+    uint32_t rep2 = 0;
+    uint32_t rep3 = 0;
+
+    while (outPos < dstSize) {
+        const uint32_t posState = (uint32_t) outPos & pbMask;
+
+        // Literal byte?
+        if (rc.decodeBit(probs.isMatch[(state << NUM_POS_BITS_MAX) + posState]) == 0) {
+            const uint32_t prevByte = (outPos > 0) ? pOut[outPos - 1] : 0;
+            const uint32_t litState = (((uint32_t) outPos & lpMask) << lc) + (prevByte >> (8 - lc));
+            Prob* const pLitProbs = &litProbs[(size_t) 0x300 * litState];
+            uint32_t symbol = 1;
+
+            // After a match the literal is coded relative to the byte at the last match distance
+            if ((state >= 7) && (rep0 < outPos)) {
+                uint32_t matchByte = pOut[outPos - rep0 - 1];
+
+                do {
+                    const uint32_t matchBit = (matchByte >> 7) & 1;
+                    matchByte <<= 1;
+                    const uint32_t bit = rc.decodeBit(pLitProbs[((1 + matchBit) << 8) + symbol]);
+                    symbol = (symbol << 1) | bit;
+
+                    if (matchBit != bit)
+                        break;
+                } while (symbol < 0x100);
+            }
+
+            while (symbol < 0x100) {
+                symbol = (symbol << 1) | rc.decodeBit(pLitProbs[symbol]);
+            }
+
+            pOut[outPos++] = (uint8_t)(symbol - 0x100);
+            state = (state < 4) ? 0 : ((state < 10) ? state - 3 : state - 6);
+            continue;
+        }
+
+        // Otherwise some kind of match
+        uint32_t len;
+
+        if (rc.decodeBit(probs.isRep[state]) != 0) {
+            // Repeated match using one of the last 4 distances. Can't have a repeated match with no output so far.
+            if (outPos == 0)
+                return false;
+
+            if (rc.decodeBit(probs.isRepG0[state]) == 0) {
+                // 'Short rep': a single byte at the last distance
+                if (rc.decodeBit(probs.isRep0Long[(state << NUM_POS_BITS_MAX) + posState]) == 0) {
+                    if (rep0 >= outPos)
+                        return false;
+
+                    pOut[outPos] = pOut[outPos - rep0 - 1];
+                    outPos++;
+                    state = (state < 7) ? 9 : 11;
+                    continue;
+                }
+            } else {
+                uint32_t dist;
+
+                if (rc.decodeBit(probs.isRepG1[state]) == 0) {
+                    dist = rep1;
+                } else {
+                    if (rc.decodeBit(probs.isRepG2[state]) == 0) {
+                        dist = rep2;
+                    } else {
+                        dist = rep3;
+                        rep3 = rep2;
+                    }
+
+                    rep2 = rep1;
+                }
+
+                rep1 = rep0;
+                rep0 = dist;
+            }
+
+            len = probs.repLenDecoder.decode(rc, posState);
+            state = (state < 7) ? 8 : 11;
+        } else {
+            // New match with a new distance
+            rep3 = rep2;
+            rep2 = rep1;
+            rep1 = rep0;
+            len = probs.lenDecoder.decode(rc, posState);
+            state = (state < 7) ? 7 : 10;
+            rep0 = decodeDistance(rc, probs, len);
+
+            // Note: an end marker (distance 0xFFFFFFFF) is an error here too since the output isn't full yet
+            if (rep0 == 0xFFFFFFFF)
+                return false;
+        }
+
+        // Copy the match: it must be within the data decoded so far and not go past the end of the output
+        len += MATCH_MIN_LEN;
+
+        if ((rep0 >= outPos) || (len > dstSize - outPos))
+            return false;
+
+        const uint8_t* pCopySrc = pOut + outPos - rep0 - 1;
+        uint8_t* pCopyDst = pOut + outPos;
+
+        for (uint32_t i = 0; i < len; ++i) {
+            pCopyDst[i] = pCopySrc[i];
+        }
+
+        outPos += len;
+    }
+
+    return (!rc.bOverrun);
+}
+
+END_NAMESPACE(LzmaDecoder)
+END_NAMESPACE(chd)
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "Macros.h"
+
+#include <cstddef>
+#include <cstdint>
+
+BEGIN_NAMESPACE(chd)
+BEGIN_NAMESPACE(LzmaDecoder)
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Decoder for raw LZMA streams (no header or end marker), as used by the 'lzma' and 'cdlz' CHD hunk codecs.
+// The literal context bits, literal position bits and position bits ('lc', 'lp' and 'pb') must be supplied since the stream has no header.
+// CHD always uses the LZMA defaults of lc=3, lp=0, pb=2. The output buffer doubles as the dictionary, so the data is decoded in one go.
+// Returns 'false' if the data is invalid or truncated.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool decode(
+    const std::byte* const pSrc,
+    const size_t srcSize,
+    std::byte* const pDst,
+    const size_t dstSize,
+    const uint32_t lc = 3,
+    const uint32_t lp = 0,
+    const uint32_t pb = 2
+) noexcept;
+
+END_NAMESPACE(LzmaDecoder)
+END_NAMESPACE(chd)
@@ -18,6 +18,7 @@
 #include "Doom/UI/st_main.h"
 #include "Game.h"
 #include "Input.h"
+#include "RewindBuffer.h"
 #include "Wess/psxcd.h"
 #include "Wess/wessapi.h"
 
@@ -355,6 +356,7 @@ void update() noexcept {
         checkDevCheat(SDL_SCANCODE_F6, doToggleXRayVisionCheat);
         checkDevCheat(SDL_SCANCODE_F7, doToggleVramViewerCheat);
         checkDevCheat(SDL_SCANCODE_F8, doToggleNoTargetCheat);
+        checkDevCheat(SDL_SCANCODE_F9, RewindBuffer::requestRewind);
 
         if (Config::gbEnableDevInPlaceReloadFunctionKey) {
             checkDevCheat(SDL_SCANCODE_F11, doInPlaceReloadCheat);
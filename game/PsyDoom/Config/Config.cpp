@@ -25,6 +25,7 @@ BEGIN_NAMESPACE(Config)
 //------------------------------------------------------------------------------------------------------------------------------------------
 std::string     gCueFilePath;
 bool            gbShowPerfCounters;
+bool            gbShowZoneStats;
 bool            gbInterpolateSectors;
 bool            gbInterpolateMobj;
 bool            gbInterpolateMonsters;
@@ -62,6 +63,19 @@ bool            gbEnableMapPatches_Visual;
 bool            gbEnableMapPatches_PsyDoom;
 float           gViewBobbingStrength;
 bool            gbPauseOnWindowFocusLost;
+bool            gbFrameLimiterPowerSaver;
+int32_t         gJobWorkerThreads;
+int32_t         gJobWorkerThreadPriority;
+std::string     gJobWorkerThreadCores;
+int32_t         gMainThreadPriority;
+std::string     gMainThreadCores;
+std::string     gLumpCacheDir;
+int32_t         gDiscReadAheadSectors;
+std::string     gDiscIndexCacheDir;
+bool            gbStreamMobjSprites;
+bool            gbCompressSaveFiles;
+int32_t         gMonsterAiLodDist;
+bool            gbUseMonsterFlowFields;
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Graphics config settings
@@ -76,7 +90,12 @@ float           gLogicalDisplayW;
 bool            gbDisableVulkanRenderer;
 int32_t         gVulkanRenderHeight;
 bool            gbVulkanPixelStretch;
+float           gVulkanDynamicResTargetMs;
+float           gVulkanDynamicResMinScale;
+float           gVulkanDynamicResMaxScale;
 bool            gbVulkanTripleBuffer;
+bool            gbVulkanLowLatency;
+bool            gbVulkanRenderThread;
 bool            gbVulkanDrawExtendedStatusBar;
 bool            gbVulkanWidescreenEnabled;
 int32_t         gAAMultisamples;
@@ -85,10 +104,15 @@ int32_t         gBottomOverscanPixels;
 bool            gbEnhanceWallDrawPrecision;
 bool            gbFloorRenderGapFix;
 bool            gbSkyLeakFix;
+bool            gbClassicCoverageCulling;
 bool            gbVulkanBrightenAutomap;
 bool            gbUseVulkan32BitShading;
 bool            gbUseExtendedAutomapColors;
 int32_t         gVramSizeInMegabytes;
+bool            gbTexCacheBestFitPacking;
+bool            gbVulkanOcclusionCoverageBuffer;
+bool            gbVulkanDepthTestedWorld;
+bool            gbVulkanUsePvs;
 std::string     gVulkanPreferredDevicesRegex;
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -96,11 +120,15 @@ std::string     gVulkanPreferredDevicesRegex;
 //------------------------------------------------------------------------------------------------------------------------------------------
 int32_t     gAudioBufferSize;
 int32_t     gSpuRamSize;
+int32_t     gStreamedSoundMinSize;
+bool        gbAudioThreadHighPriority;
+std::string gAudioThreadCores;
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Input config settings
 //------------------------------------------------------------------------------------------------------------------------------------------
 float       gMouseTurnSpeed;
+bool        gbLateLatchMouseInput;
 float       gGamepadDeadZone;
 float       gGamepadFastTurnSpeed_High;
 float       gGamepadFastTurnSpeed_Low;
@@ -12,6 +12,7 @@ BEGIN_NAMESPACE(Config)
 //------------------------------------------------------------------------------------------------------------------------------------------
 extern std::string      gCueFilePath;
 extern bool             gbShowPerfCounters;
+extern bool             gbShowZoneStats;
 extern bool             gbInterpolateSectors;
 extern bool             gbInterpolateMobj;
 extern bool             gbInterpolateMonsters;
@@ -49,6 +50,19 @@ extern bool             gbEnableMapPatches_Visual;
 extern bool             gbEnableMapPatches_PsyDoom;
 extern float            gViewBobbingStrength;
 extern bool             gbPauseOnWindowFocusLost;
+extern bool             gbFrameLimiterPowerSaver;
+extern int32_t          gJobWorkerThreads;
+extern int32_t          gJobWorkerThreadPriority;
+extern std::string      gJobWorkerThreadCores;
+extern int32_t          gMainThreadPriority;
+extern std::string      gMainThreadCores;
+extern std::string      gLumpCacheDir;
+extern int32_t          gDiscReadAheadSectors;
+extern std::string      gDiscIndexCacheDir;
+extern bool             gbStreamMobjSprites;
+extern bool             gbCompressSaveFiles;
+extern int32_t          gMonsterAiLodDist;
+extern bool             gbUseMonsterFlowFields;
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Video settings
@@ -63,7 +77,12 @@ extern float            gLogicalDisplayW;
 extern bool             gbDisableVulkanRenderer;
 extern int32_t          gVulkanRenderHeight;
 extern bool             gbVulkanPixelStretch;
+extern float            gVulkanDynamicResTargetMs;
+extern float            gVulkanDynamicResMinScale;
+extern float            gVulkanDynamicResMaxScale;
 extern bool             gbVulkanTripleBuffer;
+extern bool             gbVulkanLowLatency;
+extern bool             gbVulkanRenderThread;
 extern bool             gbVulkanDrawExtendedStatusBar;
 extern bool             gbVulkanWidescreenEnabled;
 extern int32_t          gAAMultisamples;
@@ -72,10 +91,15 @@ extern int32_t          gBottomOverscanPixels;
 extern bool             gbEnhanceWallDrawPrecision;
 extern bool             gbFloorRenderGapFix;
 extern bool             gbSkyLeakFix;
+extern bool             gbClassicCoverageCulling;
 extern bool             gbVulkanBrightenAutomap;
 extern bool             gbUseVulkan32BitShading;
 extern bool             gbUseExtendedAutomapColors;
 extern int32_t          gVramSizeInMegabytes;
+extern bool             gbTexCacheBestFitPacking;
+extern bool             gbVulkanOcclusionCoverageBuffer;
+extern bool             gbVulkanDepthTestedWorld;
+extern bool             gbVulkanUsePvs;
 extern std::string      gVulkanPreferredDevicesRegex;
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -83,11 +107,15 @@ extern std::string      gVulkanPreferredDevicesRegex;
 //------------------------------------------------------------------------------------------------------------------------------------------
 extern int32_t      gAudioBufferSize;
 extern int32_t      gSpuRamSize;
+extern int32_t      gStreamedSoundMinSize;
+extern bool         gbAudioThreadHighPriority;
+extern std::string  gAudioThreadCores;
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Input settings
 //------------------------------------------------------------------------------------------------------------------------------------------
 extern float        gMouseTurnSpeed;
+extern bool         gbLateLatchMouseInput;
 extern float        gGamepadDeadZone;
 extern float        gGamepadFastTurnSpeed_High;
 extern float        gGamepadFastTurnSpeed_Low;
@@ -117,7 +145,7 @@ struct CheatKeySequence {
     static constexpr uint32_t MAX_KEYS = (uint32_t) C_ARRAY_SIZE(keys);
 };
 
-extern bool                 gbEnableDevCheatShortcuts;              // If 'true' then enable the convenience developer single cheat keys on the pause menu (keys F1-F8)
+extern bool                 gbEnableDevCheatShortcuts;              // If 'true' then enable the convenience developer single cheat keys on the pause menu (keys F1-F9)
 extern bool                 gbEnableDevInPlaceReloadFunctionKey;    // If 'true' then enable the development 'in-place map reload' function. This is activated with key F11.
 extern bool                 gbEnableDevMapAutoReload;               // If 'true' then allow the game to automatically reload a map if it has changed on-disk
 extern CheatKeySequence     gCheatKeys_GodMode;
@@ -22,14 +22,14 @@ void initCfgSerialization_Audio() noexcept {
 
     cfg.audioBufferSize = makeConfigField(
         "AudioBufferSize",
-        "Audio buffer size, in 44.1 KHz sound samples.\n"
+        "Audio buffer size, in sound samples at the audio device's native sample rate.\n"
         "Lower values reduce sound latency and improve music timing precision.\n"
         "\n"
         "Setting the buffer size too low however may cause audio instability or stutter on some systems.\n"
         "If set to '0' (auto) then PsyDoom will use a default value, which is '256' samples currently.\n"
         "Mostly this setting can be left alone but if you are experiencing sound issues, try adjusting.\n"
         "\n"
-        "Some example values and their corresponding added sound latency (MS):\n"
+        "Some example values and their corresponding added sound latency (MS) at 44.1 KHz:\n"
         " 64   = ~1.45 MS\n"
         " 128  = ~2.9 MS\n"
         " 256  = ~5.8 MS\n"
@@ -51,6 +51,40 @@ void initCfgSerialization_Audio() noexcept {
         gSpuRamSize,
         -1
     );
+
+    cfg.streamedSoundMinSize = makeConfigField(
+        "StreamedSoundMinSize",
+        "Size threshold in bytes at which sounds in .LCD files are streamed from disk on demand, instead of\n"
+        "being fully loaded into SPU RAM. Streamed sounds only use a small 32 KiB buffer in SPU RAM, which\n"
+        "allows mods to use long one-shot sounds without reserving sound RAM for the whole of each one.\n"
+        "\n"
+        "Only one-shot (non-looped) sounds are streamed, and a streamed sound can only be played by one\n"
+        "voice at a time: playing it again restarts it. Values below 64 KiB are raised to 64 KiB, since\n"
+        "there is no benefit to streaming smaller sounds. If <= 0 then sound streaming is disabled.",
+        gStreamedSoundMinSize,
+        0
+    );
+
+    cfg.audioThreadHighPriority = makeConfigField(
+        "AudioThreadHighPriority",
+        "If enabled then PsyDoom asks the OS to run the thread which generates audio at a high priority.\n"
+        "This can help prevent audio stutter (buffer underruns) when the system is under heavy load, which\n"
+        "in turn may allow a smaller 'AudioBufferSize' to be used for lower sound latency.\n"
+        "Some systems may ignore this request or require elevated permissions for it to take effect.",
+        gbAudioThreadHighPriority,
+        false
+    );
+
+    cfg.audioThreadCores = makeConfigField(
+        "AudioThreadCores",
+        "Optional list of CPU cores (numbered from '0') which the thread generating audio is allowed to run on.\n"
+        "The list is comma separated and can contain ranges of cores, for example: \"4-7\" or \"0,2,4-5\".\n"
+        "On CPUs with a mix of fast and slow cores (e.g 'big.LITTLE' ARM CPUs) keeping the audio thread on\n"
+        "the fast cores can help prevent audio stutter.\n"
+        "Leave empty to allow any core (default). Not supported on macOS, where this setting is ignored.",
+        gAudioThreadCores,
+        ""
+    );
 }
 
 END_NAMESPACE(ConfigSerialization)
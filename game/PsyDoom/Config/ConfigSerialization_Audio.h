@@ -12,6 +12,9 @@ BEGIN_NAMESPACE(ConfigSerialization)
 struct Config_Audio {
     ConfigField     audioBufferSize;
     ConfigField     spuRamSize;
+    ConfigField     streamedSoundMinSize;
+    ConfigField     audioThreadHighPriority;
+    ConfigField     audioThreadCores;
 
     inline ConfigFieldList getFieldList() noexcept {
         static_assert(sizeof(*this) % sizeof(ConfigField) == 0);
@@ -70,7 +70,8 @@ void initCfgSerialization_Cheats() noexcept {
         "\n"
         " F6: X-ray vision\n"
         " F7: VRAM Viewer (functionality hidden in retail)\n"
-        " F8: No-target (new cheat added by PsyDoom)",
+        " F8: No-target (new cheat added by PsyDoom)\n"
+        " F9: Rewind the game by 2 seconds (history is recorded while this setting is enabled)",
         gbEnableDevCheatShortcuts,
         false
     );
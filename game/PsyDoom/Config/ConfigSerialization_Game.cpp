@@ -29,6 +29,7 @@ void initCfgSerialization_Game() noexcept {
         "the command line with the '-cue <CUE_PATH>' command-line argument.\n"
         "\n"
         "A valid .cue (cue sheet) file for the desired game must be provided in order to run PsyDoom.\n"
+        "A .chd (compressed disc image) file may be given instead of a .cue file.\n"
         "A relative or absolute path can be used; relative paths are relative to the current OS working\n"
         "directory, which is normally the directory that the PsyDoom executable is found in.\n"
         "\n"
@@ -45,6 +46,14 @@ void initCfgSerialization_Game() noexcept {
         false
     );
 
+    cfg.showZoneStats = makeConfigField(
+        "ShowZoneStats",
+        "If enabled then show main memory heap statistics during gameplay and menus: heap usage for each\n"
+        "type of allocation, the largest free block, fragmentation and the number of purged blocks.",
+        gbShowZoneStats,
+        false
+    );
+
     cfg.interpolateSectors = makeConfigField(
         "InterpolateSectors",
         "When uncapped framerates are enabled, whether sector floor, ceiling and wall motion is smoothed.\n"
@@ -79,16 +88,16 @@ void initCfgSerialization_Game() noexcept {
 
     cfg.mainMemoryHeapSize = makeConfigField(
         "MainMemoryHeapSize",
-        "How much system RAM is available to Doom's 'Zone Memory' heap allocator (in bytes).\n"
-        "Many memory allocations in the game are serviced by this system so in effect this setting defines\n"
-        "one of the main memory limits for the game.\n"
+        "How much system RAM is initially reserved for Doom's 'Zone Memory' heap allocator (in bytes).\n"
+        "Many memory allocations in the game are serviced by this system. If the heap runs out of space then\n"
+        "it grows by 8 MiB chunks as needed, and extra chunks are released again when no longer in use.\n"
         "\n"
         "If the value of this setting is <= 0 then PsyDoom will reserve a default amount of memory which is\n"
-        "presently 64 MiB. This should be enough for even the most demanding user maps.\n"
+        "presently 16 MiB. This is enough for most maps without needing to grow the heap.\n"
         "\n"
         "For reference, the original PSX Doom had about 1.3 MiB of heap space\n"
         "available, though it also used less RAM in general being a 32-bit program instead of 64-bit.\n"
-        "WARNING: setting this value too low may result in the game crashing with an out of memory error!",
+        "Setting this value too low is harmless but may cause some extra work growing the heap during loading.",
         gMainMemoryHeapSize,
         -1
     );
@@ -508,6 +517,171 @@ void initCfgSerialization_Game() noexcept {
         gbPauseOnWindowFocusLost,
         true
     );
+
+    cfg.frameLimiterPowerSaver = makeConfigField(
+        "FrameLimiterPowerSaver",
+        "Use less CPU while waiting for the next frame when the game is paused or in the menus?\n"
+        "When enabled the frame limiter only sleeps in these situations and never spins waiting for the exact\n"
+        "frame time, so frames may be shown up to a millisecond or so late. During gameplay the frame limiter\n"
+        "always sleeps for most of the wait and then spins for the last fraction of a millisecond, so that frames\n"
+        "are shown on time.",
+        gbFrameLimiterPowerSaver,
+        true
+    );
+
+    cfg.jobWorkerThreads = makeConfigField(
+        "JobWorkerThreads",
+        "How many extra worker threads to use for game logic which can be done in parallel: currently enemy\n"
+        "sight checks. This can improve performance on maps with very large numbers of monsters.\n"
+        "The results of game logic are exactly the same regardless of this setting; demos stay in sync.\n"
+        "Worker threads are also used to rasterize the classic renderer's drawing in parallel, which gives\n"
+        "exactly the same output as drawing on the main thread.\n"
+        "\n"
+        "Allowed values:\n"
+        "   0 = Disabled: do all game logic on the main thread (default)\n"
+        "  -1 = Auto: use one worker thread for each CPU hardware thread, minus one for the main thread\n"
+        "  >0 = Use the specified number of worker threads",
+        gJobWorkerThreads,
+        0
+    );
+
+    cfg.jobWorkerThreadPriority = makeConfigField(
+        "JobWorkerThreadPriority",
+        "Priority to ask the OS to run job worker threads at (see 'JobWorkerThreads').\n"
+        "Some systems may ignore this request or require elevated permissions for it to take effect.\n"
+        "\n"
+        "Allowed values:\n"
+        "  -1 = Low\n"
+        "   0 = Default: leave the priority as it is (default)\n"
+        "   1 = High\n"
+        "   2 = Time critical",
+        gJobWorkerThreadPriority,
+        0
+    );
+
+    cfg.jobWorkerThreadCores = makeConfigField(
+        "JobWorkerThreadCores",
+        "Optional list of CPU cores (numbered from '0') which job worker threads are allowed to run on.\n"
+        "The list is comma separated and can contain ranges of cores, for example: \"4-7\" or \"0,2,4-5\".\n"
+        "If 'JobWorkerThreads' is set to auto then one worker thread is created for each core in this list\n"
+        "which is not also in 'MainThreadCores'. Leave empty to allow any core (default).\n"
+        "Pinning threads to cores is not supported on macOS and this setting is ignored there.",
+        gJobWorkerThreadCores,
+        ""
+    );
+
+    cfg.mainThreadPriority = makeConfigField(
+        "MainThreadPriority",
+        "Priority to ask the OS to run the main game thread at, which also does all rendering.\n"
+        "Some systems may ignore this request or require elevated permissions for it to take effect.\n"
+        "\n"
+        "Allowed values:\n"
+        "  -1 = Low\n"
+        "   0 = Default: leave the priority as it is (default)\n"
+        "   1 = High\n"
+        "   2 = Time critical",
+        gMainThreadPriority,
+        0
+    );
+
+    cfg.mainThreadCores = makeConfigField(
+        "MainThreadCores",
+        "Optional list of CPU cores (numbered from '0') which the main game thread is allowed to run on.\n"
+        "The list is comma separated and can contain ranges of cores, for example: \"4-7\" or \"0,2,4-5\".\n"
+        "On CPUs with a mix of fast and slow cores (e.g 'big.LITTLE' ARM CPUs) this can be used to keep the\n"
+        "game off the slow cores, which can cause intermittent hitches otherwise.\n"
+        "Leave empty to allow any core (default). Not supported on macOS, where this setting is ignored.",
+        gMainThreadCores,
+        ""
+    );
+
+    cfg.lumpCacheDir = makeConfigField(
+        "LumpCacheDir",
+        "Optional path to a directory where decompressed lumps from the game's main WAD files are cached.\n"
+        "When set, all compressed lumps in each main WAD are decompressed once and saved to a single cache\n"
+        "file for that WAD. On later launches lumps are served straight from the cache file instead of\n"
+        "being decompressed again, which can speed up startup. The cache is rebuilt if the WAD changes.\n"
+        "The parsed contents of the MAPINFO lump are also cached in this directory, so it is not re-parsed\n"
+        "on every launch.\n"
+        "The directory must already exist. Leave empty to disable the cache (default).",
+        gLumpCacheDir,
+        ""
+    );
+
+    cfg.discReadAheadSectors = makeConfigField(
+        "DiscReadAheadSectors",
+        "How many CD sectors to read at once when reading data from the game disc image.\n"
+        "Reads are done in aligned runs of this many sectors and a few recently used runs are kept in memory,\n"
+        "so that the many small reads done while loading are served from memory instead of the disk.\n"
+        "This can greatly speed up loading when the disc image is on a slow or network mounted drive.\n"
+        "Set to '0' to disable read-ahead and read only what is requested (the original behavior).",
+        gDiscReadAheadSectors,
+        32
+    );
+
+    cfg.discIndexCacheDir = makeConfigField(
+        "DiscIndexCacheDir",
+        "Optional path to a directory where the file system index for the game disc is cached.\n"
+        "When set, the directory tree of the game disc is read once and saved to a small cache file for that\n"
+        "disc. On later launches the file system is loaded from the cache file instead of being read from the\n"
+        "disc again, which can speed up startup when the disc image is on a slow or network mounted drive.\n"
+        "The detected game type and region for the disc are also cached here, to avoid reading files to identify it.\n"
+        "The cache is rebuilt if the disc changes.\n"
+        "The directory must already exist. Leave empty to disable the cache (default).",
+        gDiscIndexCacheDir,
+        ""
+    );
+
+    cfg.streamMobjSprites = makeConfigField(
+        "StreamMobjSprites",
+        "Whether to stream in sprites for monsters and other things during gameplay instead of loading them all\n"
+        "when a map starts. When enabled only the frames shown while things are idle are loaded with the map;\n"
+        "the rest are loaded gradually once a thing wakes up or comes near the player. This can speed up map\n"
+        "loading and reduce memory use for mods with large sprite sets. If a frame is needed before it has\n"
+        "been loaded, the thing's idle frame is shown briefly in its place.\n"
+        "Disable (default) to load all sprites needed for the map upfront.",
+        gbStreamMobjSprites,
+        false
+    );
+
+    cfg.compressSaveFiles = makeConfigField(
+        "CompressSaveFiles",
+        "Whether to compress save files when writing them. Compression is fast and makes saves for big maps several\n"
+        "times smaller, which reduces the time spent writing to slow storage such as SD cards.\n"
+        "Both compressed and uncompressed save files can always be loaded, regardless of this setting.\n"
+        "Disable to write uncompressed save files, which are readable by older versions of PsyDoom.",
+        gbCompressSaveFiles,
+        true
+    );
+
+    cfg.monsterAiLodDist = makeConfigField(
+        "MonsterAiLodDist",
+        "Optional performance setting for maps with very large numbers of monsters.\n"
+        "Monsters which are further than this distance (in map units) from every player and which cannot see\n"
+        "their target run their chase and look logic at a reduced rate. Their movement is accumulated and\n"
+        "applied in bigger steps, so they still travel at the same speed while their animations play normally.\n"
+        "Monsters within this distance of a player, or which can see their target, always update at the full rate.\n"
+        "Note: this changes monster behavior slightly, so it is ignored during classic demos and networked games\n"
+        "where you are not the host/server.\n"
+        "\n"
+        "Allowed values:\n"
+        "   0 = Disabled, all monsters update at the full rate (default)\n"
+        " >0 = Reduce the AI update rate beyond this distance. A value of at least '2048' is recommended.",
+        gMonsterAiLodDist,
+        0
+    );
+
+    cfg.useMonsterFlowFields = makeConfigField(
+        "UseMonsterFlowFields",
+        "Optional performance setting for maps with very large numbers of monsters.\n"
+        "If enabled then regular walking monsters chasing a player choose which way to go using a shared map of\n"
+        "the distances to that player, which is kept up to date as doors and lifts open and close. This greatly\n"
+        "reduces the number of trial moves hordes of monsters make, and helps them navigate around obstacles.\n"
+        "Note: this changes monster behavior, so it is ignored during classic demos and networked games where\n"
+        "you are not the host/server.",
+        gbUseMonsterFlowFields,
+        false
+    );
 }
 
 END_NAMESPACE(ConfigSerialization)
@@ -12,6 +12,7 @@ BEGIN_NAMESPACE(ConfigSerialization)
 struct Config_Game {
     ConfigField     cueFilePath;
     ConfigField     showPerfCounters;
+    ConfigField     showZoneStats;
     ConfigField     interpolateSectors;
     ConfigField     interpolateMobj;
     ConfigField     interpolateMonsters;
@@ -49,6 +50,19 @@ struct Config_Game {
     ConfigField     enableMapPatches_PsyDoom;
     ConfigField     viewBobbingStrength;
     ConfigField     pauseOnWindowFocusLost;
+    ConfigField     frameLimiterPowerSaver;
+    ConfigField     jobWorkerThreads;
+    ConfigField     jobWorkerThreadPriority;
+    ConfigField     jobWorkerThreadCores;
+    ConfigField     mainThreadPriority;
+    ConfigField     mainThreadCores;
+    ConfigField     lumpCacheDir;
+    ConfigField     discReadAheadSectors;
+    ConfigField     discIndexCacheDir;
+    ConfigField     streamMobjSprites;
+    ConfigField     compressSaveFiles;
+    ConfigField     monsterAiLodDist;
+    ConfigField     useMonsterFlowFields;
 
     inline ConfigFieldList getFieldList() noexcept {
         static_assert(sizeof(*this) % sizeof(ConfigField) == 0);
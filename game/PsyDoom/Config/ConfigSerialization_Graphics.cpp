@@ -127,6 +127,43 @@ void initCfgSerialization_Graphics() noexcept {
         false
     );
 
+    cfg.vulkanDynamicResTargetMs = makeConfigField(
+        "VulkanDynamicResTargetMs",
+        "Vulkan renderer: target GPU frame time (in milliseconds) for dynamic resolution scaling.\n"
+        "If set to a value greater than '0' then the render resolution is adjusted on the fly, within the\n"
+        "limits set by 'VulkanDynamicResMinScale' and 'VulkanDynamicResMaxScale', to try and keep the time\n"
+        "the GPU spends drawing each frame at or below this target. The scaled frame is stretched to fit\n"
+        "the display on output.\n"
+        "\n"
+        "This is useful for keeping frame rates smooth on slower GPUs at high display resolutions. Note that\n"
+        "the scale is relative to the resolution determined by 'VulkanRenderHeight' and pixel stretch.\n"
+        "Requires GPU timestamp support; if this is unavailable then the resolution is never changed.\n"
+        "\n"
+        "Example values:\n"
+        " 16.6 = Try to keep up with a 60 Hz display\n"
+        " 6.9  = Try to keep up with a 144 Hz display\n"
+        " 0    = Disable dynamic resolution scaling (default)",
+        gVulkanDynamicResTargetMs,
+        0.0f
+    );
+
+    cfg.vulkanDynamicResMinScale = makeConfigField(
+        "VulkanDynamicResMinScale",
+        "Vulkan renderer: the minimum scale (0.25 to 1.0) that dynamic resolution scaling can reduce the\n"
+        "render width and height to. Only used if 'VulkanDynamicResTargetMs' is enabled.",
+        gVulkanDynamicResMinScale,
+        0.5f
+    );
+
+    cfg.vulkanDynamicResMaxScale = makeConfigField(
+        "VulkanDynamicResMaxScale",
+        "Vulkan renderer: the maximum scale (0.25 to 2.0) that dynamic resolution scaling can increase the\n"
+        "render width and height to. Values over '1.0' allow supersampling when the GPU has time to spare.\n"
+        "Only used if 'VulkanDynamicResTargetMs' is enabled.",
+        gVulkanDynamicResMaxScale,
+        1.0f
+    );
+
     cfg.vulkanTripleBuffer = makeConfigField(
         "VulkanTripleBuffer",
         "If the Vulkan video backend is active and the Vulkan API is in use, whether to use triple\n"
@@ -143,6 +180,34 @@ void initCfgSerialization_Graphics() noexcept {
         false
     );
 
+    cfg.vulkanLowLatency = makeConfigField(
+        "VulkanLowLatency",
+        "If the Vulkan video backend is active and vsync is enabled, whether to use a low latency frame\n"
+        "pacing mode. This setting affects both the classic renderer when it is output via Vulkan and the\n"
+        "new Vulkan renderer itself, and overrides the 'VulkanTripleBuffer' setting when enabled.\n"
+        "\n"
+        "In this mode the game waits for the GPU to finish each frame before reading inputs for the next\n"
+        "frame, and uses mailbox presentation (if supported) so the newest frame is shown at each refresh.\n"
+        "This reduces input latency, especially at high refresh rates, at the cost of less overlap between\n"
+        "CPU and GPU work (and therefore possibly lower frame rates on slower systems).\n"
+        "When performance counters are enabled, the measured input to present delay is also shown.",
+        gbVulkanLowLatency,
+        false
+    );
+
+    cfg.vulkanRenderThread = makeConfigField(
+        "VulkanRenderThread",
+        "If the Vulkan video backend is active, whether to submit frames to the GPU and present them from a\n"
+        "dedicated render thread. This setting affects both the classic renderer when it is output via Vulkan\n"
+        "and the new Vulkan renderer itself.\n"
+        "\n"
+        "When enabled, the game can begin simulating the next frame while the previous frame is still being\n"
+        "submitted and queued for presentation, which can improve frame rates when those operations block.\n"
+        "This gives no benefit in low latency mode ('VulkanLowLatency'), since only 1 frame is allowed in flight.",
+        gbVulkanRenderThread,
+        false
+    );
+
     cfg.vulkanDrawExtendedStatusBar = makeConfigField(
         "VulkanDrawExtendedStatusBar",
         "Vulkan renderer only: draw extensions to the in-game status bar for widescreen mode?\n"
@@ -270,6 +335,16 @@ void initCfgSerialization_Graphics() noexcept {
         true
     );
 
+    cfg.classicCoverageCulling = makeConfigField(
+        "ClassicCoverageCulling",
+        "Classic renderer only: if enabled then the world is first walked front to back to find which screen\n"
+        "columns are already covered by nearer opaque walls, floors and ceilings. Wall columns and flat\n"
+        "spans which would be completely overdrawn are then skipped when the world is drawn, which can\n"
+        "greatly reduce overdraw on dense maps. The rendered image is identical either way.",
+        gbClassicCoverageCulling,
+        false
+    );
+
     cfg.vulkanBrightenAutomap = makeConfigField(
         "VulkanBrightenAutomap",
         "Vulkan renderer only: if enabled then automap lines will be brightened to compensate for them\n"
@@ -303,6 +378,51 @@ void initCfgSerialization_Graphics() noexcept {
         gDefaultVramSizeInMegabytes
     );
 
+    cfg.texCacheBestFitPacking = makeConfigField(
+        "TexCacheBestFitPacking",
+        "If enabled then sprites and textures are placed in video RAM using a best fit packing strategy.\n"
+        "Each new texture is placed in the top-most, then left-most free area of video RAM which can hold\n"
+        "it, filling gaps left by other textures. Existing textures are only evicted to make room if no\n"
+        "free area can be found, in which case the least recently used textures are evicted first.\n"
+        "This wastes less video RAM and causes fewer textures to be re-uploaded.\n"
+        "If disabled then textures are placed in video RAM in order, like the original game (default).",
+        gbTexCacheBestFitPacking,
+        false
+    );
+
+    cfg.vulkanOcclusionCoverageBuffer = makeConfigField(
+        "VulkanOcclusionCoverageBuffer",
+        "Vulkan renderer only: if enabled then the screen areas blocked by walls (used to decide what parts\n"
+        "of the level are visible) are tracked with a bitmask containing 1 bit per screen column, instead of\n"
+        "a sorted list of occluded ranges. This can speed up rendering of large, open and detailed maps.\n"
+        "If disabled then the sorted list of occluded ranges is used (default).",
+        gbVulkanOcclusionCoverageBuffer,
+        false
+    );
+
+    cfg.vulkanDepthTestedWorld = makeConfigField(
+        "VulkanDepthTestedWorld",
+        "Vulkan renderer only: if enabled then opaque walls and floors are drawn front to back using a depth\n"
+        "buffer, followed by sky walls, blended walls and sprites drawn back to front. This lets the GPU skip\n"
+        "shading for hidden pixels, which can speed up rendering of complex scenes at high resolutions or\n"
+        "with multisample anti-aliasing. The result is designed to look exactly the same as the normal\n"
+        "back to front drawing. If disabled then everything is drawn back to front only (default).",
+        gbVulkanDepthTestedWorld,
+        false
+    );
+
+    cfg.vulkanUsePvs = makeConfigField(
+        "VulkanUsePvs",
+        "Vulkan renderer only: if enabled then a 'potentially visible set' is computed for each map when it is\n"
+        "loaded, recording which areas of the map could ever be seen from each other. Areas which can never be\n"
+        "seen from the current view position are then skipped entirely when deciding what to draw, which can\n"
+        "speed up rendering of very large maps. If the lump cache directory is set ('LumpCacheDir') then the\n"
+        "result is cached there, so it is only computed the first time a map is loaded. Maps with very large\n"
+        "numbers of subsectors or with see-through 'void' lines do not use this. Disabled by default.",
+        gbVulkanUsePvs,
+        false
+    );
+
     cfg.vulkanPreferredDevicesRegex = makeConfigField(
         "VulkanPreferredDevicesRegex",
         "Vulkan renderer: a case insensitive regex that can specify which GPUs are preferable to use.\n"
@@ -19,7 +19,12 @@ struct Config_Graphics {
     ConfigField     antiAliasingMultisamples;
     ConfigField     vulkanRenderHeight;
     ConfigField     vulkanPixelStretch;
+    ConfigField     vulkanDynamicResTargetMs;
+    ConfigField     vulkanDynamicResMinScale;
+    ConfigField     vulkanDynamicResMaxScale;
     ConfigField     vulkanTripleBuffer;
+    ConfigField     vulkanLowLatency;
+    ConfigField     vulkanRenderThread;
     ConfigField     vulkanDrawExtendedStatusBar;
     ConfigField     vulkanWidescreenEnabled;
     ConfigField     useVulkan32BitShading;
@@ -30,9 +35,14 @@ struct Config_Graphics {
     ConfigField     enhanceWallDrawPrecision;
     ConfigField     floorRenderGapFix;
     ConfigField     skyLeakFix;
+    ConfigField     classicCoverageCulling;
     ConfigField     vulkanBrightenAutomap;
     ConfigField     useExtendedAutomapColors;
     ConfigField     vramSizeInMegabytes;
+    ConfigField     texCacheBestFitPacking;
+    ConfigField     vulkanOcclusionCoverageBuffer;
+    ConfigField     vulkanDepthTestedWorld;
+    ConfigField     vulkanUsePvs;
     ConfigField     vulkanPreferredDevicesRegex;
 
     inline ConfigFieldList getFieldList() noexcept {
@@ -27,6 +27,16 @@ void initCfgSerialization_Input() noexcept {
         7.0f
     );
 
+    cfg.lateLatchMouseInput = makeConfigField(
+        "LateLatchMouseInput",
+        "If enabled then check for new mouse movement right before it is used for turning, instead of only\n"
+        "at the start of the frame. This can reduce mouse turning latency by up to a frame.\n"
+        "Only mouse movement is checked at this point; key and button presses are still handled at the start of\n"
+        "the next frame.",
+        gbLateLatchMouseInput,
+        false
+    );
+
     cfg.gamepadDeadZone = makeConfigField(
         "GamepadDeadZone",
         "0-1 range: controls when minor controller inputs are discarded.\n"
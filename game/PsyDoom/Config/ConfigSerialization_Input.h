@@ -11,6 +11,7 @@ BEGIN_NAMESPACE(ConfigSerialization)
 // N.B: must ONLY contain 'ConfigField' entries!
 struct Config_Input {
     ConfigField     mouseTurnSpeed;
+    ConfigField     lateLatchMouseInput;
     ConfigField     gamepadDeadZone;
     ConfigField     gamepadFastTurnSpeed_High;
     ConfigField     gamepadFastTurnSpeed_Low;
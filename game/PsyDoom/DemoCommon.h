@@ -10,7 +10,20 @@ BEGIN_NAMESPACE(DemoCommon)
 // The current demo file format version.
 // This should be incremented whenever the contents of or expected behavior of the demo file changes.
 //------------------------------------------------------------------------------------------------------------------------------------------
-static constexpr uint32_t DEMO_FILE_VERSION = 14;
+static constexpr uint32_t DEMO_FILE_VERSION = 18;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// From demo file version 18 onwards a tick status byte of 'DEMO_ESCAPE_BYTE' is always followed by a 'DemoRecordType' byte.
+// This allows records other than ticks (such as map changes) to be placed in the stream of ticks.
+// A status byte with this value is otherwise a valid (but rare) tick, where both players change inputs and take 7 vblanks.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static constexpr uint32_t FIRST_DEMO_FILE_VERSION_WITH_ESCAPES = 18;
+static constexpr uint8_t DEMO_ESCAPE_BYTE = 0xFF;
+
+enum class DemoRecordType : uint8_t {
+    Tick        = 0,    // A normal tick with a status byte of 'DEMO_ESCAPE_BYTE': the tick inputs follow as usual
+    MapChange   = 1,    // The demo continues on another map: the map number, map hash and starting state of all players follow
+};
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Helper: calls 'byteSwap()' on the specified type if the host architecture is big endian.
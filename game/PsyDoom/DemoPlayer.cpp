@@ -5,6 +5,7 @@
 #include "DemoPlayer.h"
 
 #include "DemoCommon.h"
+#include "DemoStateHash.h"
 #include "Doom/Base/i_main.h"
 #include "Doom/Base/m_fixed.h"
 #include "Doom/d_main.h"
@@ -12,12 +13,17 @@
 #include "Doom/Game/p_spec.h"
 #include "Doom/Game/p_tick.h"
 #include "Doom/Game/p_user.h"
+#include "Doom/psx_main.h"
 #include "Doom/Renderer/r_main.h"
 #include "Doom/UI/errormenu_main.h"
 #include "Game.h"
 #include "MapHash.h"
+#include "ProgArgs.h"
+#include "SaveAndLoad.h"
 #include "SaveDataTypes.h"
+#include "TimeDemo.h"
 
+#include <cstdio>
 #include <cstring>
 
 using namespace DemoCommon;
@@ -28,7 +34,9 @@ static GameSettings     gPrevGameSettings;                          // The game
 static padbuttons_t     gPrevPsxCtrlBindings[NUM_BINDABLE_BTNS];    // The previous original PSX gamepad control bindings (used to restore later)
 static int32_t          gPrevPsxMouseSensitivity;                   // The previous original PSX mouse sensitivity (used to restore later)
 static DemoFormat       gPlayingDemoFormat;                         // Which format of demo is currently being played
+static uint32_t         gDemoFileVersion;                           // For PsyDoom's demo format: the file version of the demo being played
 static DemoTickInputs   gPrevTickInputs[MAXPLAYERS];                // The previous inputs of each player: used to avoid encoding repeats
+static int32_t          gNumTicksRead;                              // How many demo ticks have been read so far during this playback (used for seeking)
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Tick inputs for the 'GEC Master Edition' demo format
@@ -305,6 +313,8 @@ static bool onBeforeMapLoad_psydoomDemoFormat() noexcept {
         if (!bValidDemoProperties)
             return false;
 
+        gDemoFileVersion = demoFileVersion;
+
         // Make sure there is enough data to read all the game settings.
         // Note that 'verifyDemoFileVersion()' should have validated both the game settings version and size already.
         const int32_t gameSettingsVersion = GameSettingUtils::getGameSettingsVersionForDemoFileVersion(demoFileVersion);
@@ -448,6 +458,33 @@ static bool readTickInputs_classicDemoFormat() noexcept {
     }
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tells if the next tick in a demo using PsyDoom's new format is complete.
+// This will not be the case if the demo file was cut short while recording (due to a crash for example), in which case the incomplete
+// final tick is treated as the end of the demo rather than an error.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool canReadNextTick_psydoomDemoFormat() noexcept {
+    if (!demo_canRead<uint8_t>())
+        return false;
+
+    const uint8_t statusByte = (uint8_t) *gpDemo_p;
+    const uint32_t numInputs = ((statusByte & 0x80) ? 1 : 0) + ((statusByte & 0x40) ? 1 : 0);
+    size_t tickSize = sizeof(uint8_t) + numInputs * sizeof(DemoTickInputs);
+
+    // Escaped status bytes are followed by a record type, which must say that this is a tick
+    if ((gDemoFileVersion >= FIRST_DEMO_FILE_VERSION_WITH_ESCAPES) && (statusByte == DEMO_ESCAPE_BYTE)) {
+        if (!demo_canRead<uint8_t>(2))
+            return false;
+
+        if ((DemoRecordType) gpDemo_p[1] != DemoRecordType::Tick)
+            return false;
+
+        tickSize += sizeof(DemoRecordType);
+    }
+
+    return (gpDemo_p + tickSize <= gpDemoBufferEnd);
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Reads the tick inputs for PsyDoom's new demo format.
 // Returns 'false' if the demo should not be played due to some kind of error.
@@ -464,6 +501,14 @@ static bool readTickInputs_psydoomDemoFormat() noexcept {
         //
         const uint8_t statusByte = demo_read<uint8_t>();
 
+        // If the status byte is escaped then the record type which follows must say that this is a tick
+        if ((gDemoFileVersion >= FIRST_DEMO_FILE_VERSION_WITH_ESCAPES) && (statusByte == DEMO_ESCAPE_BYTE)) {
+            if (demo_read<DemoRecordType>() != DemoRecordType::Tick) {
+                RunDemoErrorMenu_UnexpectedError();
+                return false;
+            }
+        }
+
         // Set the elapsed vblank counts firstly
         gPlayersElapsedVBlanks[0] = (statusByte >> 3) & 0x7;
         gPlayersElapsedVBlanks[1] = (statusByte >> 0) & 0x7;
@@ -589,6 +634,47 @@ static bool readTickInputs_gecDemoFormat() noexcept {
     }
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// For PsyDoom's demo format: reads the info needed to start playback of the map that has just been loaded.
+// This is the map hash (which is verified) and the starting state for all players.
+// Returns 'false' if the demo should not be played due to some kind of error.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool readMapStartInfo() noexcept {
+    try {
+        // Verify the map hash matches what we expect
+        const uint64_t mapHashWord1 = Endian::hostToLittle(demo_read<uint64_t>());
+        const uint64_t mapHashWord2 = Endian::hostToLittle(demo_read<uint64_t>());
+
+        if (!verifyMapHash(mapHashWord1, mapHashWord2))
+            return false;
+
+        // Read the details for all the players starting the map, including health and ammo etc.
+        const int32_t numPlayers = (gNetGame != gt_single) ? 2 : 1;
+
+        for (int32_t playerIdx = 0; playerIdx < numPlayers; ++playerIdx) {
+            // Deserialize the player struct firstly
+            SavedPlayerT srcPlayer = demo_read<SavedPlayerT>();
+            DemoCommon::endianCorrect(srcPlayer);
+            player_t& dstPlayer = gPlayers[playerIdx];
+            srcPlayer.deserializeTo(dstPlayer, true);
+
+            // Synchronize the health of the player map object with the player
+            dstPlayer.mo->health = dstPlayer.health;
+        }
+
+        // Init the previous tick inputs for all players to predefined/known starting values
+        initPrevTickInputs();
+    }
+    catch (...) {
+        // Reached an unexpected end to the demo file!
+        RunDemoErrorMenu_UnexpectedEOF();
+        return false;
+    }
+
+    // Success if we get to here!
+    return true;
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // This should be called prior to loading the map.
 // Reads some demo header info and checks that its contents are valid.
@@ -633,34 +719,54 @@ bool onBeforeMapLoad() noexcept {
 // Returns 'false' if the demo should not be played due to some kind of error.
 //------------------------------------------------------------------------------------------------------------------------------------------
 bool onAfterMapLoad() noexcept {
-    // This only does stuff for PsyDoom's new demo format!
+    // Begin checking the game state on every tick against previously recorded hashes, if requested
+    if (ProgArgs::gCheckStateHashFilePath[0]) {
+        DemoStateHash::beginVerifying(ProgArgs::gCheckStateHashFilePath);
+    }
+
+    // The rest of this only does stuff for PsyDoom's new demo format!
     if (gPlayingDemoFormat != DemoFormat::PsyDoom)
         return true;
 
-    try {
-        // Verify the map hash matches what we expect
-        const uint64_t mapHashWord1 = Endian::hostToLittle(demo_read<uint64_t>());
-        const uint64_t mapHashWord2 = Endian::hostToLittle(demo_read<uint64_t>());
+    return readMapStartInfo();
+}
 
-        if (!verifyMapHash(mapHashWord1, mapHashWord2))
-            return false;
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tells if the demo continues on another map after the map currently being played.
+// This is the case for demos recorded with the '-recordmultimap' switch once all the ticks for the current map have been read.
+// Note: an incomplete map change (cut short while recording) is treated as the end of the demo instead.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool isAtMapChange() noexcept {
+    if ((!gpDemo_p) || (gPlayingDemoFormat != DemoFormat::PsyDoom) || (gDemoFileVersion < FIRST_DEMO_FILE_VERSION_WITH_ESCAPES))
+        return false;
 
-        // Read the details for all the players starting the game, including health and ammo etc.
-        const int32_t numPlayers = (gNetGame != gt_single) ? 2 : 1;
+    if (!demo_canRead<uint8_t>(2))
+        return false;
 
-        for (int32_t playerIdx = 0; playerIdx < numPlayers; ++playerIdx) {
-            // Deserialize the player struct firstly
-            SavedPlayerT srcPlayer = demo_read<SavedPlayerT>();
-            DemoCommon::endianCorrect(srcPlayer);
-            player_t& dstPlayer = gPlayers[playerIdx];
-            srcPlayer.deserializeTo(dstPlayer, true);
+    if ((gpDemo_p[0] != (std::byte) DEMO_ESCAPE_BYTE) || ((DemoRecordType) gpDemo_p[1] != DemoRecordType::MapChange))
+        return false;
 
-            // Synchronize the health of the player map object with the player
-            dstPlayer.mo->health = dstPlayer.health;
-        }
+    const int32_t numPlayers = (gNetGame != gt_single) ? 2 : 1;
+    const size_t mapChangeSize = 2 + sizeof(int32_t) + sizeof(uint64_t) * 2 + sizeof(SavedPlayerT) * numPlayers;
+    return (gpDemo_p + mapChangeSize <= gpDemoBufferEnd);
+}
 
-        // Init the previous tick inputs for all players to predefined/known starting values
-        initPrevTickInputs();
+//------------------------------------------------------------------------------------------------------------------------------------------
+// This should be called prior to loading the next map of the demo, when 'isAtMapChange()' says the demo continues on another map.
+// Consumes the map change marker and sets up the map to be loaded.
+// Returns 'false' if the demo should not be played further due to some kind of error.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool onBeforeNextMapLoad() noexcept {
+    ASSERT(isAtMapChange());
+
+    try {
+        demo_skip<uint8_t>(2);
+        const int32_t mapNum = Endian::littleToHost(demo_read<int32_t>());
+
+        if (!verifyDemoMapNum(mapNum))
+            return false;
+
+        gGameMap = mapNum;
     }
     catch (...) {
         // Reached an unexpected end to the demo file!
@@ -668,10 +774,17 @@ bool onAfterMapLoad() noexcept {
         return false;
     }
 
-    // Success if we get to here!
     return true;
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// This should be called after loading the next map of the demo and before continuing playback.
+// Returns 'false' if the demo should not be played further due to some kind of error.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool onAfterNextMapLoad() noexcept {
+    return readMapStartInfo();
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Tells if the end of the demo has been reached
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -682,7 +795,7 @@ bool hasReachedDemoEnd() noexcept {
     switch (gPlayingDemoFormat) {
         case DemoFormat::None:      return true;
         case DemoFormat::Classic:   return (!demo_canRead<padbuttons_t>());
-        case DemoFormat::PsyDoom:   return (!demo_canRead<DemoTickInputs>());
+        case DemoFormat::PsyDoom:   return ((!isAtMapChange()) && ((!demo_canRead<DemoTickInputs>()) || (!canReadNextTick_psydoomDemoFormat())));
         case DemoFormat::GecMe:     return (!demo_canRead<GecDemoTickInputs>());
     }
 
@@ -743,32 +856,94 @@ bool isPlayerTurning30HzCapped() noexcept {
     );
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Captures a snapshot of the game state and immediately restores it, for the '-checksnapshots' switch.
+// If restoring a snapshot is bit-exact then demo playback continues exactly as though this was never done, which '-checkhashes' can verify.
+// Only the first failure is reported, since the game state is left cleared or partially restored after that.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void roundTripSnapshot() noexcept {
+    if (gbCheckDemoResultFailed)
+        return;
+
+    SaveData saveData;
+    SaveAndLoad::captureSnapshot(saveData);
+
+    if (SaveAndLoad::restoreSnapshot(saveData) != LoadSaveResult::OK) {
+        std::printf("Failed to restore the game state snapshot captured at demo tick %d!\n", gNumTicksRead);
+        gbCheckDemoResultFailed = true;
+    }
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Reads the tick inputs for this tick.
 // Returns 'false' if the demo should not be played due to some kind of error.
 //------------------------------------------------------------------------------------------------------------------------------------------
 bool readTickInputs() noexcept {
+    // Stop playback of the current map if the demo continues on another map.
+    // Normally the map will have ended on the previous tick already.
+    if (isAtMapChange())
+        return false;
+
+    // Round trip the game state through a snapshot before checking it, if doing that
+    if (ProgArgs::gbCheckSnapshots) {
+        roundTripSnapshot();
+    }
+
+    // Check the game state prior to this tick's inputs against the recorded state hashes, if doing that
+    if (DemoStateHash::isVerifying()) {
+        DemoStateHash::verifyTick();
+    }
+
+    bool bReadInputs = false;
+
     switch (gPlayingDemoFormat) {
         case DemoFormat::None:      return false;
-        case DemoFormat::Classic:   return readTickInputs_classicDemoFormat();
-        case DemoFormat::PsyDoom:   return readTickInputs_psydoomDemoFormat();
-        case DemoFormat::GecMe:     return readTickInputs_gecDemoFormat();
+        case DemoFormat::Classic:   bReadInputs = readTickInputs_classicDemoFormat();   break;
+        case DemoFormat::PsyDoom:   bReadInputs = readTickInputs_psydoomDemoFormat();   break;
+        case DemoFormat::GecMe:     bReadInputs = readTickInputs_gecDemoFormat();       break;
+
+        default:
+            FatalErrors::raise("DemoPlayer::readTickInputs: unhandled demo format!");
+    }
+
+    // Let the timedemo benchmark know we did another tick
+    if (bReadInputs) {
+        gNumTicksRead++;
+        TimeDemo::onTickInputsRead();
     }
 
-    FatalErrors::raise("DemoPlayer::readTickInputs: unhandled demo format!");
+    return bReadInputs;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tells if demo playback is currently fast-forwarding to the tick requested via the '-demoseek' argument.
+// While seeking the game simulation runs as fast as possible and drawing, sound and frame pacing are all skipped.
+// Note: seeking is done by simulating every tick from the start of the demo rather than restoring snapshots, since demos do not store
+// snapshots of the game state to seek to.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool isFastForwarding() noexcept {
+    return ((gPlayingDemoFormat != DemoFormat::None) && (gNumTicksRead < ProgArgs::gDemoSeekTick));
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Should be called when demo playback is done, or when it has been aborted due to an error
 //------------------------------------------------------------------------------------------------------------------------------------------
 void onPlaybackDone() noexcept {
+    // In headless mode report how many ticks were simulated, so that batch runners can measure simulation throughput
+    if (ProgArgs::gbHeadlessMode && (gPlayingDemoFormat != DemoFormat::None)) {
+        std::printf("Demo ticks played: %d\n", gNumTicksRead);
+    }
+
     // Restore any changed game settings and reset the demo pointer
     restoreModifiedGameSettings();
     gpDemo_p = nullptr;
+    DemoStateHash::endVerifying();
 
     // Cleanup all globals and reset them to a default state
     std::memset(gPrevTickInputs, 0, sizeof(gPrevTickInputs));
     gPlayingDemoFormat = DemoFormat::None;
+    gDemoFileVersion = 0;
+    gNumTicksRead = 0;
     gPrevPsxMouseSensitivity = {};
     std::memset(gPrevPsxCtrlBindings, 0, sizeof(gPrevPsxCtrlBindings));
     gPrevGameSettings = {};
@@ -16,12 +16,16 @@ BEGIN_NAMESPACE(DemoPlayer)
 
 bool onBeforeMapLoad() noexcept;
 bool onAfterMapLoad() noexcept;
+bool isAtMapChange() noexcept;
+bool onBeforeNextMapLoad() noexcept;
+bool onAfterNextMapLoad() noexcept;
 bool hasReachedDemoEnd() noexcept;
 bool wasLevelCompleted() noexcept;
 DemoFormat getPlayingDemoFormat() noexcept;
 bool shouldOverrideMapMusicForDemo() noexcept;
 bool isPlayerTurning30HzCapped() noexcept;
 bool readTickInputs() noexcept;
+bool isFastForwarding() noexcept;
 void onPlaybackDone() noexcept;
 
 END_NAMESPACE(DemoPlayer)
@@ -5,15 +5,17 @@
 //------------------------------------------------------------------------------------------------------------------------------------------
 #include "DemoRecorder.h"
 
+#include "AsyncFileOutputStream.h"
 #include "DemoCommon.h"
+#include "DemoStateHash.h"
 #include "Doom/Base/i_main.h"
 #include "Doom/d_main.h"
 #include "Doom/Game/g_game.h"
 #include "Doom/Game/p_tick.h"
 #include "Endian.h"
-#include "FileOutputStream.h"
 #include "Game.h"
 #include "MapHash.h"
+#include "ProgArgs.h"
 #include "SaveDataTypes.h"
 #include "Utils.h"
 
@@ -23,11 +25,16 @@ using namespace DemoCommon;
 
 BEGIN_NAMESPACE(DemoRecorder)
 
-typedef std::unique_ptr<FileOutputStream> DemoFilePtr;
+typedef std::unique_ptr<AsyncFileOutputStream> DemoFilePtr;
+
+// How often (in ticks) recorded demo data is handed over to be written to disk in the background.
+// Data is only ever handed over after a whole tick, so if the game crashes the demo file is still playable up until the last handover.
+static constexpr int32_t DEMO_COMMIT_INTERVAL_TICKS = 30;
 
 static std::string      gDemoFilePath;                  // Path of the demo file being recorded to
 static DemoFilePtr      gpDemoFile;                     // The demo file currently being recorded to
 static DemoTickInputs   gPrevTickInputs[MAXPLAYERS];    // The previous inputs of each player: used to avoid encoding repeats
+static int32_t          gNumUncommittedTicks;           // How many ticks have been recorded since demo data was last handed over to be written
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Returns the path of the demo file that will be recorded for the current map
@@ -39,12 +46,23 @@ static std::string getDemoFilePath() noexcept {
     return userDataFolder + demoFileName;
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Returns the path of the per-tick game state hash file that will be recorded alongside the demo for the current map
+//------------------------------------------------------------------------------------------------------------------------------------------
+static std::string getStateHashFilePath() noexcept {
+    const std::string userDataFolder = Utils::getOrCreateUserDataFolder();
+    char hashFileName[64];
+    std::snprintf(hashFileName, C_ARRAY_SIZE(hashFileName), "DEMO_MAP%02d.HSH", gGameMap);
+    return userDataFolder + hashFileName;
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Opens the demo file for recording (may fail)
 //------------------------------------------------------------------------------------------------------------------------------------------
 static void openDemoFile() THROWS {
     gDemoFilePath = getDemoFilePath();
-    gpDemoFile = std::make_unique<FileOutputStream>(gDemoFilePath.c_str(), false);
+    gpDemoFile = std::make_unique<AsyncFileOutputStream>(gDemoFilePath.c_str(), false);
+    gNumUncommittedTicks = 0;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -55,6 +73,29 @@ static void closeDemoFile() noexcept {
     gpDemoFile.reset();
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Writes the info needed to start playback of the current map: the map hash and the starting state for all players.
+// Note: expects the demo file to be open for writing!
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void writeMapStartInfo() THROWS {
+    ASSERT(gpDemoFile);
+
+    // Record the hash of the map being played so we can verify the same map is being played for the demo
+    gpDemoFile->write<uint64_t>(Endian::hostToLittle(MapHash::gWord1));
+    gpDemoFile->write<uint64_t>(Endian::hostToLittle(MapHash::gWord2));
+
+    // Record details for all the players starting the map, including health and ammo etc.
+    const int32_t numPlayers = (gNetGame != gt_single) ? 2 : 1;
+
+    for (int32_t playerIdx = 0; playerIdx < numPlayers; ++playerIdx) {
+        // Convert the player into the save file format, endian correct and write it
+        SavedPlayerT player = {};
+        player.serializeFrom(gPlayers[playerIdx]);
+        DemoCommon::endianCorrect(player);
+        gpDemoFile->write(player);
+    }
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Writes the demo file header.
 // This includes all the information about the game and the starting state for all players.
@@ -84,20 +125,21 @@ static void writeDemoHeader() THROWS {
         gpDemoFile->write(settings);
     }
 
-    // Record the hash of the map being played so we can verify the same map is being played for the demo
-    gpDemoFile->write<uint64_t>(Endian::hostToLittle(MapHash::gWord1));
-    gpDemoFile->write<uint64_t>(Endian::hostToLittle(MapHash::gWord2));
+    // Record the map hash and the starting state of all players
+    writeMapStartInfo();
+}
 
-    // Record details for all the players starting the game, including health and ammo etc.
-    const int32_t numPlayers = (gNetGame != gt_single) ? 2 : 1;
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Writes a marker telling that the demo continues on another map, followed by the map number and the starting map info.
+// Note: expects the demo file to be open for writing!
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void writeMapChange() THROWS {
+    ASSERT(gpDemoFile);
 
-    for (int32_t playerIdx = 0; playerIdx < numPlayers; ++playerIdx) {
-        // Convert the player into the save file format, endian correct and write it
-        SavedPlayerT player = {};
-        player.serializeFrom(gPlayers[playerIdx]);
-        DemoCommon::endianCorrect(player);
-        gpDemoFile->write(player);
-    }
+    gpDemoFile->write(DEMO_ESCAPE_BYTE);
+    gpDemoFile->write(DemoRecordType::MapChange);
+    gpDemoFile->write<int32_t>(Endian::hostToLittle(gGameMap));
+    writeMapStartInfo();
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -149,6 +191,29 @@ void begin() noexcept {
     try {
         openDemoFile();
         writeDemoHeader();
+        gpDemoFile->commit();
+        initPrevTickInputs();
+    } catch (...) {
+        handleDemoWriteError();
+    }
+
+    // Also record per-tick game state hashes alongside the demo if requested
+    if (ProgArgs::gbRecordStateHashes) {
+        DemoStateHash::beginRecording(getStateHashFilePath().c_str());
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Continues recording the current demo on the map that has just been loaded, for the '-recordmultimap' switch.
+// Must only be called when the demo is recording!
+//------------------------------------------------------------------------------------------------------------------------------------------
+void beginNextMap() noexcept {
+    ASSERT(isRecording());
+
+    try {
+        writeMapChange();
+        gpDemoFile->commit();
+        gNumUncommittedTicks = 0;
         initPrevTickInputs();
     } catch (...) {
         handleDemoWriteError();
@@ -162,6 +227,8 @@ void begin() noexcept {
 void end() noexcept {
     ASSERT(isRecording());
 
+    DemoStateHash::endRecording();
+
     try {
         gpDemoFile->flush();
         closeDemoFile();
@@ -184,6 +251,11 @@ bool isRecording() noexcept {
 void recordTick() noexcept {
     ASSERT(isRecording());
 
+    // Record the game state hashes prior to this tick's inputs, if doing that
+    if (DemoStateHash::isRecording()) {
+        DemoStateHash::recordTick();
+    }
+
     // Get the inputs for player 1 and 2
     DemoTickInputs p1Inputs = {};
     DemoTickInputs p2Inputs = {};
@@ -211,10 +283,15 @@ void recordTick() noexcept {
     statusByte |= ((uint8_t) std::clamp(gPlayersElapsedVBlanks[0], 0, 7)) << 3;
     statusByte |= ((uint8_t) std::clamp(gPlayersElapsedVBlanks[1], 0, 7));
 
-    // Write the status byte followed by the inputs if they have changed
+    // Write the status byte followed by the inputs if they have changed.
+    // If the status byte is the escape byte then it must also be marked as being a tick.
     try {
         gpDemoFile->write(statusByte);
 
+        if (statusByte == DEMO_ESCAPE_BYTE) {
+            gpDemoFile->write(DemoRecordType::Tick);
+        }
+
         if (statusByte & 0x80) {
             writeTickInputs(p1Inputs);
         }
@@ -222,6 +299,14 @@ void recordTick() noexcept {
         if (statusByte & 0x40) {
             writeTickInputs(p2Inputs);
         }
+
+        // Periodically hand the recorded ticks over to be written to disk
+        gNumUncommittedTicks++;
+
+        if (gNumUncommittedTicks >= DEMO_COMMIT_INTERVAL_TICKS) {
+            gpDemoFile->commit();
+            gNumUncommittedTicks = 0;
+        }
     }
     catch (...) {
         handleDemoWriteError();
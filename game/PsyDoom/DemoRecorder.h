@@ -5,6 +5,7 @@
 BEGIN_NAMESPACE(DemoRecorder)
 
 void begin() noexcept;
+void beginNextMap() noexcept;
 void end() noexcept;
 bool isRecording() noexcept;
 void recordTick() noexcept;
@@ -0,0 +1,406 @@
+//------------------------------------------------------------------------------------------------------------------------------------------
+// A module which computes a cheap (non cryptographic) hash of the game simulation state on every demo tick, split by subsystem.
+//
+// During demo recording the hashes can be written out to a 'sidecar' file alongside the demo, and during demo playback they can be
+// checked against a previously recorded hash file. This allows the exact tick and subsystem where a demo first de-syncs to be reported,
+// which is useful for verifying that optimizations to the game logic are bit-exact. Note that 'DemoResult' only checks the end state.
+//
+// The hashes for each demo tick are taken immediately before the inputs for that tick are recorded or read, which is a point that is
+// identical for both recording and playback. The hashes for tick 'N' therefore reflect the state after the game ticker ran for tick 'N-1'.
+//------------------------------------------------------------------------------------------------------------------------------------------
+#include "DemoStateHash.h"
+
+#include "Asserts.h"
+#include "Doom/Base/i_main.h"
+#include "Doom/Base/m_random.h"
+#include "Doom/Game/g_game.h"
+#include "Doom/Game/info.h"
+#include "Doom/Game/p_setup.h"
+#include "Doom/Game/p_tick.h"
+#include "Doom/psx_main.h"
+#include "Doom/Renderer/r_local.h"
+#include "Endian.h"
+#include "FileOutputStream.h"
+#include "FileUtils.h"
+
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+
+BEGIN_NAMESPACE(DemoStateHash)
+
+// Identifies a state hash file (the characters 'PSHS' in little endian order) and the current version of the file format
+static constexpr uint32_t HASH_FILE_SIGNATURE = 0x53485350;
+static constexpr uint32_t HASH_FILE_VERSION = 1;
+
+// Header for a state hash file, all fields are in little endian format.
+// Following the header is an array of 'TickHashes' for each demo tick, with 'NUM_SUBSYSTEMS' 32-bit little endian words per tick.
+struct HashFileHdr {
+    uint32_t    signature;
+    uint32_t    version;
+    uint32_t    numSubsystems;
+};
+
+static_assert(sizeof(HashFileHdr) == 12);
+static_assert(sizeof(TickHashes) == NUM_SUBSYSTEMS * sizeof(uint32_t));
+
+typedef std::unique_ptr<FileOutputStream> HashFilePtr;
+
+static std::string      gRecordFilePath;        // Path of the hash file being recorded to
+static HashFilePtr      gpRecordFile;           // The hash file currently being recorded to
+static FileData         gVerifyFileData;        // The contents of the hash file being verified against (empty if not verifying)
+static const uint32_t*  gpVerifyHashes;         // Pointer to the recorded hashes in the file being verified against
+static int32_t          gNumVerifyTicks;        // The number of ticks with hashes in the file being verified against
+static int32_t          gCurVerifyTick;         // The current demo tick being verified
+static bool             gbVerifyMismatch;       // Set to true once the first hash mismatch has been reported (only the first is reported)
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Helper: a simple 64-bit FNV-1a style hasher which operates on whole 32-bit words rather than individual bytes, for speed.
+// Values are hashed rather than memory so the results are the same regardless of host endianness or structure padding.
+//------------------------------------------------------------------------------------------------------------------------------------------
+struct Hasher {
+    uint64_t state = 0xCBF29CE484222325ull;
+
+    inline void add(const uint32_t value) noexcept {
+        state = (state ^ value) * 0x100000001B3ull;
+    }
+
+    inline void add(const int32_t value) noexcept {
+        add((uint32_t) value);
+    }
+
+    inline void add(const bool value) noexcept {
+        add((uint32_t) value);
+    }
+
+    inline uint32_t finish() const noexcept {
+        return (uint32_t)(state ^ (state >> 32));
+    }
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Helper: returns the index of the given state or '-1' if null
+//------------------------------------------------------------------------------------------------------------------------------------------
+static int32_t getStateIndex(const state_t* const pState) noexcept {
+    return (pState) ? (int32_t)(pState - gStates) : -1;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Helpers: hash the state of each individual subsystem
+//------------------------------------------------------------------------------------------------------------------------------------------
+static uint32_t hashMobjs() noexcept {
+    Hasher hasher;
+
+    for (const mobj_t* pMobj = gMobjHead.next; pMobj != &gMobjHead; pMobj = pMobj->next) {
+        const mobj_t& mobj = *pMobj;
+        hasher.add((fixed_t) mobj.x);
+        hasher.add((fixed_t) mobj.y);
+        hasher.add((fixed_t) mobj.z);
+        hasher.add(mobj.momx);
+        hasher.add(mobj.momy);
+        hasher.add(mobj.momz);
+        hasher.add((angle_t) mobj.angle);
+        hasher.add((fixed_t) mobj.floorz);
+        hasher.add((fixed_t) mobj.ceilingz);
+        hasher.add((int32_t) mobj.type);
+        hasher.add(mobj.flags);
+        hasher.add(mobj.health);
+        hasher.add(mobj.tics);
+        hasher.add(getStateIndex(mobj.state));
+        hasher.add((int32_t) mobj.movedir);
+        hasher.add(mobj.movecount);
+        hasher.add(mobj.reactiontime);
+        hasher.add(mobj.threshold);
+    }
+
+    return hasher.finish();
+}
+
+static uint32_t hashSectors() noexcept {
+    Hasher hasher;
+
+    for (int32_t secIdx = 0; secIdx < gNumSectors; ++secIdx) {
+        const sector_t& sector = gpSectors[secIdx];
+        hasher.add((fixed_t) sector.floorheight);
+        hasher.add((fixed_t) sector.ceilingheight);
+        hasher.add(sector.floorpic);
+        hasher.add(sector.ceilingpic);
+        hasher.add((int32_t) sector.lightlevel);
+        hasher.add(sector.special);
+        hasher.add(sector.tag);
+        hasher.add(sector.soundtraversed);
+        hasher.add(sector.flags);
+        hasher.add(sector.specialdata != nullptr);
+    }
+
+    return hasher.finish();
+}
+
+static uint32_t hashPlayers() noexcept {
+    Hasher hasher;
+
+    for (int32_t playerIdx = 0; playerIdx < MAXPLAYERS; ++playerIdx) {
+        if (!gbPlayerInGame[playerIdx])
+            continue;
+
+        const player_t& player = gPlayers[playerIdx];
+        hasher.add((int32_t) player.playerstate);
+        hasher.add(player.viewz);
+        hasher.add(player.viewheight);
+        hasher.add(player.deltaviewheight);
+        hasher.add(player.bob);
+        hasher.add(player.health);
+        hasher.add(player.armorpoints);
+        hasher.add(player.armortype);
+
+        for (const int32_t power : player.powers) {
+            hasher.add(power);
+        }
+
+        for (const bool bHasCard : player.cards) {
+            hasher.add(bHasCard);
+        }
+
+        hasher.add(player.backpack);
+        hasher.add(player.frags);
+        hasher.add((int32_t) player.readyweapon);
+        hasher.add((int32_t) player.pendingweapon);
+
+        for (const bool bOwned : player.weaponowned) {
+            hasher.add(bOwned);
+        }
+
+        for (int32_t ammoIdx = 0; ammoIdx < NUMAMMO; ++ammoIdx) {
+            hasher.add(player.ammo[ammoIdx]);
+            hasher.add(player.maxammo[ammoIdx]);
+        }
+
+        hasher.add(player.attackdown);
+        hasher.add(player.usedown);
+        hasher.add(player.cheats);
+        hasher.add(player.refire);
+        hasher.add(player.killcount);
+        hasher.add(player.itemcount);
+        hasher.add(player.secretcount);
+        hasher.add(player.damagecount);
+        hasher.add(player.bonuscount);
+
+        for (const pspdef_t& sprite : player.psprites) {
+            hasher.add(getStateIndex(sprite.state));
+            hasher.add(sprite.tics);
+            hasher.add((fixed_t) sprite.sx);
+            hasher.add((fixed_t) sprite.sy);
+        }
+    }
+
+    return hasher.finish();
+}
+
+static uint32_t hashRandom() noexcept {
+    Hasher hasher;
+    hasher.add(gPRndIndex);
+    hasher.add(gMRndIndex);
+    return hasher.finish();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Compute the hashes for each game subsystem for the current game state
+//------------------------------------------------------------------------------------------------------------------------------------------
+void computeTickHashes(TickHashes& tickHashes) noexcept {
+    tickHashes.hashes[(uint32_t) Subsystem::Mobjs] = hashMobjs();
+    tickHashes.hashes[(uint32_t) Subsystem::Sectors] = hashSectors();
+    tickHashes.hashes[(uint32_t) Subsystem::Players] = hashPlayers();
+    tickHashes.hashes[(uint32_t) Subsystem::Random] = hashRandom();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Get a human readable name for the specified subsystem
+//------------------------------------------------------------------------------------------------------------------------------------------
+const char* getSubsystemName(const Subsystem subsystem) noexcept {
+    switch (subsystem) {
+        case Subsystem::Mobjs:      return "mobjs";
+        case Subsystem::Sectors:    return "sectors";
+        case Subsystem::Players:    return "players";
+        case Subsystem::Random:     return "random";
+
+        default:
+            return "unknown";
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Helper: handles an error writing to the hash file being recorded
+//------------------------------------------------------------------------------------------------------------------------------------------
+[[noreturn]] static void handleRecordWriteError() noexcept {
+    // Close up the hash file to flush any writes that we can
+    const std::string hashFilePath = gRecordFilePath;
+    endRecording();
+
+    // Issue a fatal error to let the user know about the problem
+    I_Error("Error writing to demo state hash file '%s'!", hashFilePath.c_str());
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Begins recording state hashes for each demo tick to the specified file.
+// If the file cannot be written then a fatal error is issued.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void beginRecording(const char* const filePath) noexcept {
+    ASSERT(!isRecording());
+    gRecordFilePath = filePath;
+
+    try {
+        gpRecordFile = std::make_unique<FileOutputStream>(filePath, false);
+
+        HashFileHdr hdr = {};
+        hdr.signature = Endian::hostToLittle(HASH_FILE_SIGNATURE);
+        hdr.version = Endian::hostToLittle(HASH_FILE_VERSION);
+        hdr.numSubsystems = Endian::hostToLittle(NUM_SUBSYSTEMS);
+        gpRecordFile->write(hdr);
+    }
+    catch (...) {
+        handleRecordWriteError();
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Ends recording of state hashes, if recording
+//------------------------------------------------------------------------------------------------------------------------------------------
+void endRecording() noexcept {
+    if (gpRecordFile) {
+        try {
+            gpRecordFile->flush();
+        } catch (...) {
+            // Ignore: the file is being closed anyway...
+        }
+    }
+
+    gpRecordFile.reset();
+    gRecordFilePath.clear();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tells if state hashes are currently being recorded
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool isRecording() noexcept {
+    return (gpRecordFile != nullptr);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Records the state hashes for the current demo tick.
+// Must only be called when recording!
+//------------------------------------------------------------------------------------------------------------------------------------------
+void recordTick() noexcept {
+    ASSERT(isRecording());
+
+    TickHashes tickHashes = {};
+    computeTickHashes(tickHashes);
+
+    for (uint32_t& hash : tickHashes.hashes) {
+        hash = Endian::hostToLittle(hash);
+    }
+
+    try {
+        gpRecordFile->write(tickHashes);
+    }
+    catch (...) {
+        handleRecordWriteError();
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Begins verifying the state hashes for each demo tick against those previously recorded in the specified file.
+// If the file cannot be read or is invalid then the demo check is flagged as a failure.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void beginVerifying(const char* const filePath) noexcept {
+    endVerifying();
+
+    {
+        FileData fileData = FileUtils::getContentsOfFile(filePath);
+        gVerifyFileData.bytes = std::move(fileData.bytes);
+        gVerifyFileData.size = fileData.size;
+    }
+
+    // Validate the file header
+    bool bValidFile = (gVerifyFileData.bytes && (gVerifyFileData.size >= sizeof(HashFileHdr)));
+
+    if (bValidFile) {
+        HashFileHdr hdr = {};
+        std::memcpy(&hdr, gVerifyFileData.bytes.get(), sizeof(HashFileHdr));
+
+        bValidFile = (
+            (Endian::littleToHost(hdr.signature) == HASH_FILE_SIGNATURE) &&
+            (Endian::littleToHost(hdr.version) == HASH_FILE_VERSION) &&
+            (Endian::littleToHost(hdr.numSubsystems) == NUM_SUBSYSTEMS)
+        );
+    }
+
+    if (!bValidFile) {
+        std::printf("Demo state hash file '%s' is missing or invalid! Demo check will fail...\n", filePath);
+        gbCheckDemoResultFailed = true;
+        endVerifying();
+        return;
+    }
+
+    // Note: the file data is allocated with 'new[]' so it is suitably aligned for 32-bit words
+    gpVerifyHashes = (const uint32_t*)(gVerifyFileData.bytes.get() + sizeof(HashFileHdr));
+    gNumVerifyTicks = (int32_t)((gVerifyFileData.size - sizeof(HashFileHdr)) / sizeof(TickHashes));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Ends verifying state hashes and frees the hash file loaded, if verifying
+//------------------------------------------------------------------------------------------------------------------------------------------
+void endVerifying() noexcept {
+    gVerifyFileData.bytes.reset();
+    gVerifyFileData.size = 0;
+    gpVerifyHashes = nullptr;
+    gNumVerifyTicks = 0;
+    gCurVerifyTick = 0;
+    gbVerifyMismatch = false;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tells if state hashes are currently being verified
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool isVerifying() noexcept {
+    return (gpVerifyHashes != nullptr);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Checks the state hashes for the current demo tick against the recorded ones and reports the first mismatch found (if any).
+// Must only be called when verifying!
+//------------------------------------------------------------------------------------------------------------------------------------------
+void verifyTick() noexcept {
+    ASSERT(isVerifying());
+
+    // Only report the first mismatch, since everything after that is expected to be different.
+    // Also stop checking if we've gone past the end of the recorded hashes.
+    const int32_t tickIdx = gCurVerifyTick++;
+
+    if (gbVerifyMismatch || (tickIdx >= gNumVerifyTicks))
+        return;
+
+    TickHashes tickHashes = {};
+    computeTickHashes(tickHashes);
+    const uint32_t* const pExpectedHashes = gpVerifyHashes + (size_t) tickIdx * NUM_SUBSYSTEMS;
+
+    for (uint32_t subsysIdx = 0; subsysIdx < NUM_SUBSYSTEMS; ++subsysIdx) {
+        if (tickHashes.hashes[subsysIdx] != Endian::littleToHost(pExpectedHashes[subsysIdx])) {
+            // Note: the state checked at demo tick 'N' is the result of running the game ticker for demo tick 'N-1'.
+            // The state checked at demo tick '0' is the initial state of the map, before any ticks have been run.
+            const char* const subsysName = getSubsystemName((Subsystem) subsysIdx);
+
+            if (tickIdx > 0) {
+                std::printf("Demo state hash mismatch! First divergence at demo tick %d in subsystem '%s'.\n", tickIdx - 1, subsysName);
+            } else {
+                std::printf("Demo state hash mismatch! The initial map state differs in subsystem '%s'.\n", subsysName);
+            }
+
+            gbVerifyMismatch = true;
+            gbCheckDemoResultFailed = true;
+            return;
+        }
+    }
+}
+
+END_NAMESPACE(DemoStateHash)
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "Macros.h"
+
+#include <cstdint>
+
+BEGIN_NAMESPACE(DemoStateHash)
+
+// The game subsystems which each get their own separate hash every tick
+enum class Subsystem : uint8_t {
+    Mobjs,
+    Sectors,
+    Players,
+    Random,
+    NUM_SUBSYSTEMS
+};
+
+static constexpr uint32_t NUM_SUBSYSTEMS = (uint32_t) Subsystem::NUM_SUBSYSTEMS;
+
+// Holds the hashes computed for each subsystem at a particular demo tick
+struct TickHashes {
+    uint32_t    hashes[NUM_SUBSYSTEMS];
+};
+
+void computeTickHashes(TickHashes& tickHashes) noexcept;
+const char* getSubsystemName(const Subsystem subsystem) noexcept;
+
+void beginRecording(const char* const filePath) noexcept;
+void endRecording() noexcept;
+bool isRecording() noexcept;
+void recordTick() noexcept;
+
+void beginVerifying(const char* const filePath) noexcept;
+void endVerifying() noexcept;
+bool isVerifying() noexcept;
+void verifyTick() noexcept;
+
+END_NAMESPACE(DemoStateHash)
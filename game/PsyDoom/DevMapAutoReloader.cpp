@@ -8,17 +8,27 @@
 //  (4) The file has been modified since we last checked.
 //  (5) The platform is Windows. This feature is currently not supported on MacOS due to the '<filesystem>'
 //      API not being available until later OS versions.
+//
+// When the file changes the hash of each map lump is compared against the version currently loaded. If only the sectors and/or sidedefs
+// were edited then the changes are applied to the running level in place, keeping all player and game state. Any other edit (geometry,
+// things, scripts etc.) or an edit that can't be applied in place falls back to doing a full in-place reload of the map.
 //------------------------------------------------------------------------------------------------------------------------------------------
 #include "DevMapAutoReloader.h"
 
 #include "Cheats.h"
 #include "Config/Config.h"
+#include "ContentHash.h"
+#include "Doom/Base/w_wad.h"
 #include "Doom/cdmaptbl.h"
 #include "Doom/Game/g_game.h"
+#include "Doom/Game/p_setup.h"
+#include "Doom/UI/st_main.h"
 #include "ModMgr.h"
 #include "ProgArgs.h"
 
+#include <cstring>
 #include <string>
+#include <vector>
 
 // Is the auto reloader available on this platform?
 #if __APPLE__
@@ -31,8 +41,35 @@
 BEGIN_NAMESPACE(DevMapAutoReloader)
 
 #if ENABLE_MAP_AUTO_RELOADER
+    // The map lumps which are checked for changes
+    enum MapLump : uint32_t {
+        LUMP_BLOCKMAP,
+        LUMP_VERTEXES,
+        LUMP_SECTORS,
+        LUMP_SIDEDEFS,
+        LUMP_LINEDEFS,
+        LUMP_SSECTORS,
+        LUMP_NODES,
+        LUMP_SEGS,
+        LUMP_LEAFS,
+        LUMP_REJECT,
+        LUMP_THINGS,
+        LUMP_SCRIPTS,
+        NUM_LUMPS
+    };
+
+    static constexpr const char* MAP_LUMP_NAMES[NUM_LUMPS] = {
+        "BLOCKMAP", "VERTEXES", "SECTORS", "SIDEDEFS", "LINEDEFS", "SSECTORS", "NODES", "SEGS", "LEAFS", "REJECT", "THINGS", "SCRIPTS"
+    };
+
+    // Hash used for a lump which is not present in the map WAD
+    static constexpr ContentHash MISSING_LUMP_HASH = { UINT64_MAX, UINT64_MAX };
+
     static std::filesystem::path            gMapFilePath;
     static std::filesystem::file_time_type  gLastMapFileModifiedTime;
+    static CdFileId                         gMapWadFile;
+    static ContentHash                      gMapLumpHashes[NUM_LUMPS];
+    static std::vector<std::byte>           gLumpReadBuffer;
 #endif
 
 #if ENABLE_MAP_AUTO_RELOADER
@@ -47,11 +84,79 @@ static std::filesystem::file_time_type queryMapFileModifiedTime() noexcept {
         return {};
     }
 }
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Computes the hash of each of the map lumps which are checked for changes in the currently open map WAD.
+// The raw (possibly compressed) lump data is hashed since it is only used to tell if a lump has changed.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void hashMapLumps(ContentHash (&lumpHashes)[NUM_LUMPS]) noexcept {
+    for (uint32_t i = 0; i < NUM_LUMPS; ++i) {
+        const int32_t lumpNum = W_MapCheckNumForName(MAP_LUMP_NAMES[i]);
+
+        if (lumpNum < 0) {
+            lumpHashes[i] = MISSING_LUMP_HASH;
+            continue;
+        }
+
+        const int32_t lumpSize = W_RawMapLumpLength(lumpNum);
+        gLumpReadBuffer.resize((size_t) lumpSize);
+        W_ReadMapLump(lumpNum, gLumpReadBuffer.data(), false);
+        lumpHashes[i] = ContentHasher::hash(gLumpReadBuffer.data(), gLumpReadBuffer.size());
+    }
+
+    gLumpReadBuffer.clear();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Opens the modified map file and tries to apply the changes to the current level in place, without doing a full reload.
+// Returns 'false' if the changes can't be applied in place and a full reload is needed.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool tryHotReloadMap() noexcept {
+    W_OpenMapWad(gMapWadFile);
+
+    ContentHash newLumpHashes[NUM_LUMPS];
+    hashMapLumps(newLumpHashes);
+
+    // Figure out which lumps changed: only edits to sectors and sidedefs can be applied in place
+    bool bOnlySectorsOrSidesChanged = true;
+
+    for (uint32_t i = 0; i < NUM_LUMPS; ++i) {
+        if ((i != LUMP_SECTORS) && (i != LUMP_SIDEDEFS) && (newLumpHashes[i] != gMapLumpHashes[i])) {
+            bOnlySectorsOrSidesChanged = false;
+        }
+    }
+
+    const bool bSectorsChanged = (newLumpHashes[LUMP_SECTORS] != gMapLumpHashes[LUMP_SECTORS]);
+    const bool bSidesChanged = (newLumpHashes[LUMP_SIDEDEFS] != gMapLumpHashes[LUMP_SIDEDEFS]);
+    bool bReloadedInPlace = false;
+
+    if (bOnlySectorsOrSidesChanged) {
+        // Note: if nothing changed (file touched but not edited) then there is nothing to do
+        if ((!bSectorsChanged) && (!bSidesChanged)) {
+            bReloadedInPlace = true;
+        } else if ((newLumpHashes[LUMP_SECTORS] != MISSING_LUMP_HASH) && (newLumpHashes[LUMP_SIDEDEFS] != MISSING_LUMP_HASH)) {
+            bReloadedInPlace = P_HotReloadSectorsAndSides(bSectorsChanged, bSidesChanged);
+        }
+    }
+
+    W_CloseMapWad();
+
+    if (bReloadedInPlace) {
+        std::memcpy(gMapLumpHashes, newLumpHashes, sizeof(gMapLumpHashes));
+
+        if (bSectorsChanged || bSidesChanged) {
+            gStatusBar.message = "Map changes applied.";
+            gStatusBar.messageTicsLeft = 30;
+        }
+    }
+
+    return bReloadedInPlace;
+}
 #endif
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Initializes the map auto-reloader.
-// This should be called when the map is initially loaded.
+// This should be called when the map is initially loaded, while the map WAD is still open.
 //------------------------------------------------------------------------------------------------------------------------------------------
 void init([[maybe_unused]] const CdFileId mapWadFile) noexcept {
     #if ENABLE_MAP_AUTO_RELOADER
@@ -72,8 +177,10 @@ void init([[maybe_unused]] const CdFileId mapWadFile) noexcept {
         gMapFilePath = ProgArgs::gDataDirPath;
         gMapFilePath.append(mapWadFileName.data());
 
-        // Get the current modified timestamp
+        // Get the current modified timestamp and remember the contents of the map lumps, for figuring out what changed later
         gLastMapFileModifiedTime = queryMapFileModifiedTime();
+        gMapWadFile = mapWadFile;
+        hashMapLumps(gMapLumpHashes);
     #endif
 }
 
@@ -85,12 +192,15 @@ void shutdown() noexcept {
     #if ENABLE_MAP_AUTO_RELOADER
         gMapFilePath.clear();
         gLastMapFileModifiedTime = {};
+        gMapWadFile = {};
+        std::memset(gMapLumpHashes, 0, sizeof(gMapLumpHashes));
+        gLumpReadBuffer.shrink_to_fit();
     #endif
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // This should be called periodically by the game loop.
-// It will trigger a reload of the current map if appropriate.
+// It will apply changes to the current map in place, or trigger a full reload of the current map if appropriate.
 //------------------------------------------------------------------------------------------------------------------------------------------
 void update() noexcept {
     #if ENABLE_MAP_AUTO_RELOADER
@@ -98,12 +208,16 @@ void update() noexcept {
         if (gMapFilePath.empty())
             return;
 
-        // Check for the map file being modified and start an in-place reload of the map if it's changed
+        // Check for the map file being modified and apply the changes if it's changed.
+        // If the changes can't be applied to the running level then do an in-place reload of the map instead.
         const std::filesystem::file_time_type modifiedTime = queryMapFileModifiedTime();
 
         if (modifiedTime > gLastMapFileModifiedTime) {
             gLastMapFileModifiedTime = modifiedTime;
-            Cheats::doInPlaceReloadCheat();
+
+            if (!tryHotReloadMap()) {
+                Cheats::doInPlaceReloadCheat();
+            }
         }
     #endif
 }
@@ -1,8 +1,10 @@
 #include "DiscInfo.h"
 
+#include "Chd/ChdCdImage.h"
 #include "FileUtils.h"
 
 #include <algorithm>
+#include <cctype>
 #include <cstring>
 #include <regex>
 
@@ -143,6 +145,7 @@ static bool parseCueCmd_Track(CueParseCtx& ctx) noexcept {
     track.blockCount = -1;
     track.index0 = -1;
     track.index1 = 1;
+    track.bSourceIsChd = false;
 
     // Get the track mode uppercased
     std::string mode = matches[2];
@@ -469,6 +472,81 @@ bool DiscInfo::parseFromCueFile(const char* const filePath, std::string& errorMs
     }
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Get the track list from the given CHD file; if there is an error 'false' is returned and an error message potentially set.
+// Each track is described in terms of the decompressed image, which holds a raw 2,352 byte sector for every CHD frame.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool DiscInfo::parseFromChdFile(const char* const filePath, std::string& errorMsg) noexcept {
+    tracks.clear();
+
+    // Note: only need the header and metadata here, so no need to open the file as an image
+    chd::ChdFile chdFile;
+    std::vector<chd::ChdCdTrack> chdTracks;
+
+    if (!chdFile.open(filePath, errorMsg))
+        return false;
+
+    if (!chd::ChdCdImage::readTracks(chdFile, chdTracks, errorMsg))
+        return false;
+
+    const int64_t imageSize = (int64_t)(chdFile.getLogicalSize() / chd::ChdFile::CD_FRAME_SIZE) * chd::ChdCdImage::SECTOR_SIZE;
+
+    if (imageSize > INT32_MAX) {
+        errorMsg = "The CHD file is too large to be a CD image!";
+        return false;
+    }
+
+    for (const chd::ChdCdTrack& chdTrack : chdTracks) {
+        DiscTrack& track = tracks.emplace_back();
+        track.sourceFilePath = filePath;
+        track.sourceFileTotalSize = (int32_t) imageSize;
+        track.trackNum = chdTrack.trackNum;
+        track.fileOffset = chdTrack.firstFrame * (int32_t) chd::ChdCdImage::SECTOR_SIZE;
+        track.blockSize = chd::ChdCdImage::SECTOR_SIZE;
+        track.blockCount = chdTrack.numFrames;
+        track.bIsData = (!chdTrack.bIsAudio);
+        track.index0 = chdTrack.firstFrame - chdTrack.numPregapFrames;
+        track.index1 = chdTrack.firstFrame;
+        track.bSourceIsChd = true;
+
+        // Unlike a .bin file, a CHD only stores the data for the sector portion indicated by the track type: it starts each frame
+        if (chdTrack.type == "MODE1_RAW") {
+            track.blockPayloadOffset = 16;
+            track.blockPayloadSize = 2048;
+        } else if (chdTrack.type == "MODE2_RAW") {
+            track.blockPayloadOffset = 24;
+            track.blockPayloadSize = 2048;
+        } else if ((chdTrack.type == "MODE2") || (chdTrack.type == "MODE2_FORM_MIX")) {
+            track.blockPayloadOffset = 8;
+            track.blockPayloadSize = 2048;
+        } else {
+            track.blockPayloadOffset = 0;
+            track.blockPayloadSize = chdTrack.dataSize;
+        }
+
+        track.trackPhysicalSize = track.blockCount * track.blockSize;
+        track.trackPayloadSize = track.blockCount * track.blockPayloadSize;
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Parse the disc info from either a .cue or a .chd file, depending on the file extension
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool DiscInfo::parseFromImageFile(const char* const filePath, std::string& errorMsg) noexcept {
+    const size_t pathLen = std::strlen(filePath);
+    const bool bIsChdFile = (
+        (pathLen >= 4) &&
+        (filePath[pathLen - 4] == '.') &&
+        (std::toupper(filePath[pathLen - 3]) == 'C') &&
+        (std::toupper(filePath[pathLen - 2]) == 'H') &&
+        (std::toupper(filePath[pathLen - 1]) == 'D')
+    );
+
+    return (bIsChdFile) ? parseFromChdFile(filePath, errorMsg) : parseFromCueFile(filePath, errorMsg);
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Returns what track a particular CD-ROM sector on the disc belongs to.
 // Returns '-1' if the sector does not belong to any track.
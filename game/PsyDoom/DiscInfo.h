@@ -48,6 +48,7 @@ struct DiscTrack {
     bool            bIsData;                // Audio or data track?
     int32_t         index0;                 // Raw CD-ROM sector (2,352 byte) where the pre-gap for the track starts, as read from the .cue file
     int32_t         index1;                 // Raw CD-ROM sector (2,352 byte) where the actual track data starts, as read from the .cue file
+    bool            bSourceIsChd;           // If true then the source file is a CHD (compressed) image, and 'fileOffset' etc. are offsets in the decompressed image
 };
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -61,5 +62,7 @@ struct DiscInfo {
 
     bool parseFromCueStr(const char* const str, const char* const cueBasePath, std::string& errorMsg) noexcept;
     bool parseFromCueFile(const char* const filePath, std::string& errorMsg) noexcept;
+    bool parseFromChdFile(const char* const filePath, std::string& errorMsg) noexcept;
+    bool parseFromImageFile(const char* const filePath, std::string& errorMsg) noexcept;
     int32_t getSectorTrack(const uint32_t sectorIdx) noexcept;
 };
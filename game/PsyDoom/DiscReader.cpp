@@ -1,11 +1,17 @@
 #include "DiscReader.h"
 
 #include "Asserts.h"
+#include "Chd/ChdCdImage.h"
+#include "Config/Config.h"
 #include "DiscInfo.h"
 
 #include <algorithm>
 #include <cstring>
 
+// How many runs of sectors each disc reader caches.
+// Kept small since there may be a number of disc readers open at once (one for each open file).
+static constexpr uint32_t NUM_CACHED_RUNS = 4;
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Initialize the disc reader: the reference to the disc info must remain valid for the lifetime of this object
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -15,6 +21,11 @@ DiscReader::DiscReader(const DiscInfo& discInfo) noexcept
     , mCurTrackIdx(-1)
     , mCurOffset(0)
     , mpOpenFile(nullptr)
+    , mpOpenChdImage()
+    , mCacheRunSectors(0)
+    , mCacheUseCounter(0)
+    , mCachedRuns()
+    , mCacheReadBuffer()
 {
 }
 
@@ -50,10 +61,12 @@ bool DiscReader::setTrackNum(int32_t trackNum) noexcept {
     if ((!mpCurTrack) || (mpCurTrack->sourceFilePath != pTrack->sourceFilePath)) {
         // Need to switch files: close the old track and open the new one
         closeTrack();
-        mpOpenFile = std::fopen(pTrack->sourceFilePath.c_str(), "rb");
 
-        if (!mpOpenFile)
+        if (!openSourceFile(*pTrack))
             return false;
+
+        // Decide whether to use the cache for this file: this setting is fixed until the file is closed
+        mCacheRunSectors = std::max(Config::gDiscReadAheadSectors, 0);
     }
 
     // Success - save the current track number and track!
@@ -76,23 +89,24 @@ bool DiscReader::setTrackNum(int32_t trackNum) noexcept {
 // Is a track currently open for reading?
 //------------------------------------------------------------------------------------------------------------------------------------------
 bool DiscReader::isTrackOpen() noexcept {
-    return (mpOpenFile != nullptr);
+    return (mpOpenFile || mpOpenChdImage);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Close the track that is currently open for reading
 //------------------------------------------------------------------------------------------------------------------------------------------
 void DiscReader::closeTrack() noexcept {
-    FILE* const pFile = (FILE*) mpOpenFile;
-
-    if (pFile) {
-        std::fclose(pFile);
-        mpOpenFile = nullptr;
-    }
-
+    closeSourceFile();
     mCurOffset = 0;
     mCurTrackIdx = -1;
     mpCurTrack = nullptr;
+
+    // Free up the cache, since the file it is for is now closed
+    mCacheRunSectors = 0;
+    mCachedRuns.clear();
+    mCachedRuns.shrink_to_fit();
+    mCacheReadBuffer.clear();
+    mCacheReadBuffer.shrink_to_fit();
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -103,7 +117,7 @@ bool DiscReader::trackSeekAbs(const int32_t offsetAbs) noexcept {
     if (!mpCurTrack)
         return false;
 
-    ASSERT(mpOpenFile);
+    ASSERT(isTrackOpen());
 
     if ((offsetAbs < 0) || (offsetAbs > mpCurTrack->trackPayloadSize))
         return false;
@@ -112,11 +126,12 @@ bool DiscReader::trackSeekAbs(const int32_t offsetAbs) noexcept {
     if (mCurOffset == offsetAbs)
         return true;
 
-    // Do the seek and save the result if successful
-    const int32_t physicalOffset = dataOffsetToPhysical(offsetAbs);
-
-    if (std::fseek((FILE*) mpOpenFile, physicalOffset, SEEK_SET) != 0)
-        return false;
+    // Do the seek and save the result if successful.
+    // When reading via the cache the file position is irrelevant, so there is no need to seek the file.
+    if (!isCacheEnabled()) {
+        if (!seekSourceFile(dataOffsetToPhysical(offsetAbs)))
+            return false;
+    }
 
     mCurOffset = offsetAbs;
     return true;
@@ -130,7 +145,7 @@ bool DiscReader::trackSeekRel(const int32_t offsetRel) noexcept {
     if (!mpCurTrack)
         return false;
 
-    ASSERT(mpOpenFile);
+    ASSERT(isTrackOpen());
     const int32_t newOffset = mCurOffset + offsetRel;
 
     if ((newOffset < 0) || (newOffset > mpCurTrack->trackPayloadSize))
@@ -140,11 +155,12 @@ bool DiscReader::trackSeekRel(const int32_t offsetRel) noexcept {
     if (mCurOffset == newOffset)
         return true;
 
-    // Do the seek and save the result if successful
-    const int32_t physicalOffset = dataOffsetToPhysical(newOffset);
-
-    if (std::fseek((FILE*) mpOpenFile, physicalOffset, SEEK_SET) != 0)
-        return false;
+    // Do the seek and save the result if successful.
+    // When reading via the cache the file position is irrelevant, so there is no need to seek the file.
+    if (!isCacheEnabled()) {
+        if (!seekSourceFile(dataOffsetToPhysical(newOffset)))
+            return false;
+    }
 
     mCurOffset = newOffset;
     return true;
@@ -165,6 +181,10 @@ bool DiscReader::read(void* const pBuffer, const int32_t numBytes) noexcept {
         return false;
     }
 
+    // Read via the cache if enabled
+    if (isCacheEnabled())
+        return readCached(pBuffer, numBytes);
+
     // Continue reading until there no bytes left
     const int32_t blockPayloadSize = mpCurTrack->blockPayloadSize;
 
@@ -176,7 +196,7 @@ bool DiscReader::read(void* const pBuffer, const int32_t numBytes) noexcept {
         const int32_t sectorBytesLeft = blockPayloadSize - (mCurOffset % blockPayloadSize);
         const int32_t thisReadSize = std::min(bytesLeft, sectorBytesLeft);
 
-        if (std::fread(pDstBytes, thisReadSize, 1, (FILE*) mpOpenFile) != 1) {
+        if (readSourceFile(pDstBytes, (size_t) thisReadSize) != (size_t) thisReadSize) {
             std::memset(pBuffer, 0, (size_t) numBytes);
             return false;
         }
@@ -202,6 +222,65 @@ int32_t DiscReader::tell() const noexcept {
     return mCurOffset;
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Opens the file containing the data for the specified track: either a regular file or a CHD image.
+// Any previously open file must be closed first.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool DiscReader::openSourceFile(const DiscTrack& track) noexcept {
+    ASSERT(!isTrackOpen());
+
+    if (track.bSourceIsChd) {
+        std::unique_ptr<chd::ChdCdImage> pChdImage = std::make_unique<chd::ChdCdImage>();
+        std::string errorMsg;
+
+        if (!pChdImage->open(track.sourceFilePath.c_str(), errorMsg))
+            return false;
+
+        mpOpenChdImage = std::move(pChdImage);
+    } else {
+        mpOpenFile = std::fopen(track.sourceFilePath.c_str(), "rb");
+
+        if (!mpOpenFile)
+            return false;
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Closes the file containing the data for the current track, if there is one open
+//------------------------------------------------------------------------------------------------------------------------------------------
+void DiscReader::closeSourceFile() noexcept {
+    FILE* const pFile = (FILE*) mpOpenFile;
+
+    if (pFile) {
+        std::fclose(pFile);
+        mpOpenFile = nullptr;
+    }
+
+    mpOpenChdImage.reset();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Seeks to the specified physical offset in the file containing the data for the current track
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool DiscReader::seekSourceFile(const int32_t offset) noexcept {
+    if (mpOpenChdImage)
+        return mpOpenChdImage->seek(offset);
+
+    return (std::fseek((FILE*) mpOpenFile, offset, SEEK_SET) == 0);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Reads up to the specified number of bytes from the file containing the data for the current track, and returns how many were read
+//------------------------------------------------------------------------------------------------------------------------------------------
+size_t DiscReader::readSourceFile(void* const pBuffer, const size_t numBytes) noexcept {
+    if (mpOpenChdImage)
+        return mpOpenChdImage->read(pBuffer, numBytes);
+
+    return std::fread(pBuffer, 1, numBytes, (FILE*) mpOpenFile);
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Get the actual offset in the current track's file for the given data offset.
 // This offset includes raw CD sector framing and so on, if present.
@@ -215,3 +294,121 @@ int32_t DiscReader::dataOffsetToPhysical(const int32_t dataOffset) const noexcep
         return 0;
     }
 }
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Returns the cached run of sectors containing the specified sector (relative to the start of the current track).
+// If the run is not already cached then it is read from the file, replacing the least recently used run.
+// Returns 'nullptr' if the sector could not be read.
+//------------------------------------------------------------------------------------------------------------------------------------------
+const DiscReader::CachedRun* DiscReader::getCachedRun(const int32_t lba) noexcept {
+    ASSERT(mpCurTrack);
+    ASSERT(isCacheEnabled());
+
+    // Is the sector already in the cache? If not find the least recently used run, or an unused one, to replace.
+    if (mCachedRuns.empty()) {
+        mCachedRuns.resize(NUM_CACHED_RUNS);
+    }
+
+    CachedRun* pReplaceRun = &mCachedRuns[0];
+
+    for (CachedRun& run : mCachedRuns) {
+        if ((run.pTrack == mpCurTrack) && (lba >= run.firstLba) && (lba < run.firstLba + run.numSectors)) {
+            run.lastUseTime = ++mCacheUseCounter;
+            return &run;
+        }
+
+        if ((!run.pTrack) || (pReplaceRun->pTrack && (run.lastUseTime < pReplaceRun->lastUseTime))) {
+            pReplaceRun = &run;
+        }
+    }
+
+    // Not cached: read the aligned run of sectors containing the sector, but don't go past the end of the track
+    const DiscTrack& track = *mpCurTrack;
+    const int32_t firstLba = lba - (lba % mCacheRunSectors);
+    const int32_t maxSectors = std::min(mCacheRunSectors, track.blockCount - firstLba);
+
+    if (maxSectors <= 0)
+        return nullptr;
+
+    CachedRun& run = *pReplaceRun;
+    run.pTrack = nullptr;
+
+    // If the sectors have no framing then read straight into the run, otherwise read the raw sectors and extract the payload afterwards
+    const bool bRawSectorsArePayload = ((track.blockSize == track.blockPayloadSize) && (track.blockPayloadOffset == 0));
+    run.data.resize((size_t) maxSectors * track.blockPayloadSize);
+
+    std::byte* pReadBuffer = run.data.data();
+
+    if (!bRawSectorsArePayload) {
+        mCacheReadBuffer.resize((size_t) maxSectors * track.blockSize);
+        pReadBuffer = mCacheReadBuffer.data();
+    }
+
+    if (!seekSourceFile(track.fileOffset + firstLba * track.blockSize))
+        return nullptr;
+
+    // Note: the file might end early (truncated image), in which case just cache the sectors that could be read.
+    // The read only fails if the requested sector itself is unavailable.
+    const size_t bytesRead = readSourceFile(pReadBuffer, (size_t) maxSectors * track.blockSize);
+    const int32_t numSectors = (int32_t)(bytesRead / (size_t) track.blockSize);
+
+    if (lba >= firstLba + numSectors)
+        return nullptr;
+
+    if (!bRawSectorsArePayload) {
+        for (int32_t i = 0; i < numSectors; ++i) {
+            std::memcpy(
+                run.data.data() + (size_t) i * track.blockPayloadSize,
+                pReadBuffer + (size_t) i * track.blockSize + track.blockPayloadOffset,
+                (size_t) track.blockPayloadSize
+            );
+        }
+    }
+
+    run.pTrack = mpCurTrack;
+    run.firstLba = firstLba;
+    run.numSectors = numSectors;
+    run.lastUseTime = ++mCacheUseCounter;
+    return &run;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Does a read via the sector cache: same behavior as 'read()' otherwise.
+// If the read fails then all bytes are zeroed, if it succeeds then the current offset in the track is advanced.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool DiscReader::readCached(void* const pBuffer, const int32_t numBytes) noexcept {
+    ASSERT(mpCurTrack);
+
+    // Can't read past the end of the track
+    if (numBytes > mpCurTrack->trackPayloadSize - mCurOffset) {
+        std::memset(pBuffer, 0, (size_t) numBytes);
+        return false;
+    }
+
+    // Continue copying from cached runs until there are no bytes left
+    const int32_t blockPayloadSize = mpCurTrack->blockPayloadSize;
+
+    std::byte* pDstBytes = (std::byte*) pBuffer;
+    int32_t bytesLeft = numBytes;
+
+    while (bytesLeft > 0) {
+        const CachedRun* const pRun = getCachedRun(mCurOffset / blockPayloadSize);
+
+        if (!pRun) {
+            std::memset(pBuffer, 0, (size_t) numBytes);
+            return false;
+        }
+
+        // Copy as much as we can or need from this run
+        const int32_t runOffset = mCurOffset - pRun->firstLba * blockPayloadSize;
+        const int32_t runBytesLeft = pRun->numSectors * blockPayloadSize - runOffset;
+        const int32_t thisReadSize = std::min(bytesLeft, runBytesLeft);
+        std::memcpy(pDstBytes, pRun->data.data() + runOffset, (size_t) thisReadSize);
+
+        bytesLeft -= thisReadSize;
+        pDstBytes += thisReadSize;
+        mCurOffset += thisReadSize;
+    }
+
+    return true;
+}
@@ -2,13 +2,23 @@
 
 #include "Macros.h"
 
+#include <cstddef>
 #include <cstdint>
+#include <memory>
+#include <vector>
 
 struct DiscInfo;
 struct DiscTrack;
 
+namespace chd {
+    class ChdCdImage;
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Provides access to the data in CD image
+// Provides access to the data in CD image.
+// Unless disabled via config, data is read in aligned runs of sectors which are kept in a small LRU cache, so small reads can be served
+// from memory rather than requiring a seek and read of the underlying file each time.
+// Tracks from CHD images are read via a 'ChdCdImage', which decompresses the image on demand.
 //------------------------------------------------------------------------------------------------------------------------------------------
 class DiscReader {
 public:
@@ -28,11 +38,33 @@ public:
     int32_t tell() const noexcept;
 
 private:
+    // A run of consecutive sectors from a track which has been read into memory.
+    // Only the payload data for each sector is stored, so the data for the run is contiguous.
+    struct CachedRun {
+        const DiscTrack*        pTrack;         // Track the run belongs to, or 'nullptr' if the run is unused
+        int32_t                 firstLba;       // First sector in the run (relative to the track start)
+        int32_t                 numSectors;     // Number of sectors in the run: may be less than the run size at the end of the track
+        uint32_t                lastUseTime;    // Value of the cache use counter when the run was last used (for LRU eviction)
+        std::vector<std::byte>  data;           // The payload data for all sectors in the run
+    };
+
+    bool openSourceFile(const DiscTrack& track) noexcept;
+    void closeSourceFile() noexcept;
+    bool seekSourceFile(const int32_t offset) noexcept;
+    size_t readSourceFile(void* const pBuffer, const size_t numBytes) noexcept;
     int32_t dataOffsetToPhysical(const int32_t dataOffset) const noexcept;
+    inline bool isCacheEnabled() const noexcept { return (mCacheRunSectors > 0); }
+    const CachedRun* getCachedRun(const int32_t lba) noexcept;
+    bool readCached(void* const pBuffer, const int32_t numBytes) noexcept;
 
-    const DiscInfo&     mDiscInfo;      // Information for the disc being read from
-    const DiscTrack*    mpCurTrack;     // Pointer to the current track open for the disc reader
-    int32_t             mCurTrackIdx;   // Current track index in the disc that is open for reading or '-1' if none
-    int32_t             mCurOffset;     // Current byte offset in the actual track data we are at (NOT physical offset in the file)
-    void*               mpOpenFile;     // Handle to the open file for the current track
+    const DiscInfo&         mDiscInfo;          // Information for the disc being read from
+    const DiscTrack*        mpCurTrack;         // Pointer to the current track open for the disc reader
+    int32_t                 mCurTrackIdx;       // Current track index in the disc that is open for reading or '-1' if none
+    int32_t                 mCurOffset;         // Current byte offset in the actual track data we are at (NOT physical offset in the file)
+    void*                   mpOpenFile;         // Handle to the open file for the current track (if not a CHD image)
+    std::unique_ptr<chd::ChdCdImage> mpOpenChdImage;    // The open CHD image for the current track (if a CHD image)
+    int32_t                 mCacheRunSectors;   // How many sectors are read at a time into the cache, or '0' if the cache is disabled
+    uint32_t                mCacheUseCounter;   // Incremented every time a cached run is used
+    std::vector<CachedRun>  mCachedRuns;        // Runs of sectors in the cache: the least recently used one is replaced when full
+    std::vector<std::byte>  mCacheReadBuffer;   // Holds raw sector data read from the file, before sector framing is stripped
 };
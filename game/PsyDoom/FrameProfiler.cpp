@@ -0,0 +1,413 @@
+//------------------------------------------------------------------------------------------------------------------------------------------
+// A lightweight frame profiler for development builds.
+//
+// Scoped timers ('PROFILE_SCOPE') placed around the major subsystems of the engine accumulate the time spent in each code zone for the
+// current frame. At the end of each frame these times are pushed into a rolling history, which is shown as a graph (along with average
+// zone timings) when performance counters are enabled. This makes it possible to tell at a glance whether a hitch is due to game logic,
+// BSP traversal or vertex submission.
+//
+// Optionally, every timed scope can also be recorded and written out in the Chrome trace event format ('-profiletrace' argument) upon
+// exit. The resulting file can be inspected using 'chrome://tracing' or similar tools.
+//
+// Note: the profiler is only compiled in when 'PSYDOOM_FRAME_PROFILER' is enabled and is only intended for use on the main thread.
+//------------------------------------------------------------------------------------------------------------------------------------------
+#include "FrameProfiler.h"
+
+#if PSYDOOM_FRAME_PROFILER
+
+#include "Config/Config.h"
+#include "Doom/Base/i_drawcmds.h"
+#include "Doom/Base/i_main.h"
+#include "Doom/Base/i_misc.h"
+#include "Doom/doomdef.h"
+#include "Doom/Renderer/r_data.h"
+#include "Game.h"
+#include "ProgArgs.h"
+#include "PsxVm.h"
+#include "PsyQ/LIBGPU.h"
+#include "ScriptingEngine.h"
+#include "Video.h"
+
+#if PSYDOOM_VULKAN_RENDERER
+    #include "Vulkan/VGpuTimings.h"
+    #include "Vulkan/VRenderer.h"
+#endif
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+#include <rapidjson/filewritestream.h>
+#include <rapidjson/writer.h>
+
+BEGIN_NAMESPACE(FrameProfiler)
+
+typedef std::chrono::steady_clock::time_point timepoint_t;
+
+static constexpr uint32_t NUM_ZONES = (uint32_t) Zone::NUM_ZONES;
+
+// How many frames of history to keep for the graph and the maximum number of trace events to record.
+// The trace event limit is to prevent memory usage from growing unbounded if the game is left running for a long time.
+static constexpr uint32_t HISTORY_LEN = 128;
+static constexpr uint32_t MAX_TRACE_EVENTS = 1024 * 1024;
+
+// Graph dimensions and scaling (graph pixels per millisecond)
+static constexpr int32_t GRAPH_X = 2;
+static constexpr int32_t GRAPH_Y = 20;
+static constexpr int32_t GRAPH_H = 64;
+static constexpr float GRAPH_PIXELS_PER_MS = 2.0f;
+
+// Names for each zone, used for the trace output
+static constexpr const char* ZONE_NAMES[NUM_ZONES] = {
+    "P_Ticker",
+    "P_RunThinkers",
+    "P_CheckSights",
+    "R_RenderPlayerView",
+    "RV_BuildDrawSubsecList",
+    "RV_BuildSpriteFragLists",
+    "VDrawing::endFrame",
+    "VRenderer::endFrame",
+};
+
+// Shorter names for each zone, used for the overlay (needs to fit on the screen in the small font)
+static constexpr const char* ZONE_SHORT_NAMES[NUM_ZONES] = {
+    "TICK",
+    "THINK",
+    "SIGHT",
+    "R_VIEW",
+    "RV_BSP",
+    "RV_SPR",
+    "VDRAW",
+    "VREND",
+};
+
+// The categories which each frame's time is split up into for the stacked graph.
+// Only top-level zones (ones not nested inside other zones) contribute to the graph, so that no time is counted twice.
+enum class GraphCategory : uint8_t {
+    None,           // Nested zone: not drawn in the graph
+    Logic,          // Game logic
+    Traversal,      // BSP traversal and rendering on the CPU
+    Submission,     // Vertex and command submission to the GPU
+    Other,          // Anything not accounted for by the zones
+    NUM_CATEGORIES
+};
+
+static constexpr uint32_t NUM_GRAPH_CATEGORIES = (uint32_t) GraphCategory::NUM_CATEGORIES;
+
+static constexpr GraphCategory ZONE_GRAPH_CATEGORIES[NUM_ZONES] = {
+    GraphCategory::Logic,           // Ticker
+    GraphCategory::None,            // RunThinkers
+    GraphCategory::None,            // CheckSights
+    GraphCategory::Traversal,       // RenderPlayerView
+    GraphCategory::Traversal,       // BuildDrawSubsecList
+    GraphCategory::Traversal,       // BuildSpriteFragLists
+    GraphCategory::Submission,      // VDrawingEndFrame
+    GraphCategory::Submission,      // VRendererEndFrame
+};
+
+// Colors for each graph category (RGB)
+static constexpr uint8_t GRAPH_CATEGORY_COLORS[NUM_GRAPH_CATEGORIES][3] = {
+    {   0,   0,   0 },      // None
+    { 255,  64,  64 },      // Logic
+    {  64, 255,  64 },      // Traversal
+    {  64, 128, 255 },      // Submission
+    { 128, 128, 128 },      // Other
+};
+
+// A recorded trace event (a single execution of a timed scope)
+struct TraceEvent {
+    Zone        zone;
+    int64_t     startUsec;
+    int64_t     durationUsec;
+};
+
+// Timings for one frame of history (microseconds)
+struct FrameTimes {
+    float   zoneUsec[NUM_ZONES];
+    float   totalUsec;
+};
+
+static timepoint_t              gStartTime;                     // When the profiler was initialized: trace event times are relative to this
+static timepoint_t              gFrameStartTime;                // When the current frame started
+static double                   gCurZoneUsec[NUM_ZONES];        // Time accumulated in each zone for the current frame (microseconds)
+static FrameTimes               gHistory[HISTORY_LEN];          // Rolling history of frame timings
+static uint32_t                 gHistoryHead;                   // Where the next frame's timings are written in the history
+static bool                     gbRecordTrace;                  // True if recording trace events
+static std::vector<TraceEvent>  gTraceEvents;                   // Trace events recorded so far
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Helper: get the time in microseconds from one point in time to another
+//------------------------------------------------------------------------------------------------------------------------------------------
+static int64_t getUsecElapsed(const timepoint_t from, const timepoint_t to) noexcept {
+    return std::chrono::duration_cast<std::chrono::microseconds>(to - from).count();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Accumulates the time elapsed for the timed scope into the zone for the current frame and records a trace event if enabled
+//------------------------------------------------------------------------------------------------------------------------------------------
+ScopedTimer::~ScopedTimer() noexcept {
+    const timepoint_t endTime = std::chrono::steady_clock::now();
+    const uint32_t zoneIdx = (uint32_t) mZone;
+    gCurZoneUsec[zoneIdx] += std::chrono::duration<double, std::micro>(endTime - mStartTime).count();
+
+    if (gbRecordTrace && (gTraceEvents.size() < MAX_TRACE_EVENTS)) {
+        gTraceEvents.push_back({ mZone, getUsecElapsed(gStartTime, mStartTime), getUsecElapsed(mStartTime, endTime) });
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Writes all recorded trace events to the specified file in the Chrome trace event json format.
+// Returns 'false' on failure.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool writeChromeTrace(const char* const filePath) noexcept {
+    FILE* const pFile = std::fopen(filePath, "wb");
+
+    if (!pFile)
+        return false;
+
+    char writeBuffer[64 * 1024];
+    rapidjson::FileWriteStream fileStream(pFile, writeBuffer, sizeof(writeBuffer));
+    rapidjson::Writer<rapidjson::FileWriteStream> writer(fileStream);
+
+    writer.StartObject();
+    writer.Key("traceEvents");
+    writer.StartArray();
+
+    for (const TraceEvent& event : gTraceEvents) {
+        writer.StartObject();
+        writer.Key("name");
+        writer.String(ZONE_NAMES[(uint32_t) event.zone]);
+        writer.Key("ph");
+        writer.String("X");
+        writer.Key("ts");
+        writer.Int64(event.startUsec);
+        writer.Key("dur");
+        writer.Int64(event.durationUsec);
+        writer.Key("pid");
+        writer.Int(0);
+        writer.Key("tid");
+        writer.Int(0);
+        writer.EndObject();
+    }
+
+    writer.EndArray();
+    writer.Key("displayTimeUnit");
+    writer.String("ms");
+    writer.EndObject();
+
+    fileStream.Flush();
+    const bool bSuccess = (std::ferror(pFile) == 0);
+    std::fclose(pFile);
+    return bSuccess;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Initializes the frame profiler and starts recording trace events if requested
+//------------------------------------------------------------------------------------------------------------------------------------------
+void init() noexcept {
+    gStartTime = std::chrono::steady_clock::now();
+    gFrameStartTime = gStartTime;
+    std::fill(std::begin(gCurZoneUsec), std::end(gCurZoneUsec), 0.0);
+    std::fill(std::begin(gHistory), std::end(gHistory), FrameTimes{});
+    gHistoryHead = 0;
+    gbRecordTrace = (ProgArgs::gProfileTraceFilePath[0] != 0);
+
+    if (gbRecordTrace) {
+        gTraceEvents.reserve(MAX_TRACE_EVENTS);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Shuts down the frame profiler and writes out the trace file, if recording trace events
+//------------------------------------------------------------------------------------------------------------------------------------------
+void shutdown() noexcept {
+    if (gbRecordTrace) {
+        if (!writeChromeTrace(ProgArgs::gProfileTraceFilePath)) {
+            std::printf("FrameProfiler: failed to write the trace file '%s'!\n", ProgArgs::gProfileTraceFilePath);
+        }
+
+        if (gTraceEvents.size() >= MAX_TRACE_EVENTS) {
+            std::printf("FrameProfiler: the trace event limit was reached, some events were not recorded!\n");
+        }
+    }
+
+    gbRecordTrace = false;
+    gTraceEvents.clear();
+    gTraceEvents.shrink_to_fit();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Should be called at the end of each frame: pushes the timings for the frame into the history and begins timing a new frame
+//------------------------------------------------------------------------------------------------------------------------------------------
+void endFrame() noexcept {
+    const timepoint_t now = std::chrono::steady_clock::now();
+    FrameTimes& frameTimes = gHistory[gHistoryHead];
+
+    for (uint32_t zoneIdx = 0; zoneIdx < NUM_ZONES; ++zoneIdx) {
+        frameTimes.zoneUsec[zoneIdx] = (float) gCurZoneUsec[zoneIdx];
+        gCurZoneUsec[zoneIdx] = 0.0;
+    }
+
+    frameTimes.totalUsec = (float) getUsecElapsed(gFrameStartTime, now);
+    gFrameStartTime = now;
+    gHistoryHead = (gHistoryHead + 1) % HISTORY_LEN;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Draws a single colored rectangle for the profiler graph
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void drawRect(const int32_t x, const int32_t y, const int32_t w, const int32_t h, const uint8_t r, const uint8_t g, const uint8_t b) noexcept {
+    if ((w <= 0) || (h <= 0))
+        return;
+
+    POLY_F4 quad = {};
+    LIBGPU_SetPolyF4(quad);
+    LIBGPU_setRGB0(quad, r, g, b);
+    LIBGPU_setXY4(quad,
+        (int16_t) x,        (int16_t) y,
+        (int16_t)(x + w),   (int16_t) y,
+        (int16_t) x,        (int16_t)(y + h),
+        (int16_t)(x + w),   (int16_t)(y + h)
+    );
+
+    I_AddPrim(quad);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Draws the profiler graph and average zone timings, if performance counters are enabled.
+// Should be called as part of drawing the UI overlay.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void drawOverlay() noexcept {
+    if (!Config::gbShowPerfCounters)
+        return;
+
+    // If using the Vulkan renderer, draw as far as possible to the left, being widescreen aware (same as the other perf counters)
+    int32_t widescreenAdjust = 0;
+
+    #if PSYDOOM_VULKAN_RENDERER
+        if (Video::isUsingVulkanRenderPath() && Config::gbVulkanWidescreenEnabled) {
+            const float xPadding = (VRenderer::gPsxCoordsFbX / VRenderer::gPsxCoordsFbW) * (float) SCREEN_W;
+            widescreenAdjust = (int32_t) -xPadding;
+        }
+    #endif
+
+    // Draw the graph background and a line marking the 30 Hz frame budget
+    const int32_t graphX = GRAPH_X + widescreenAdjust;
+    drawRect(graphX, GRAPH_Y, HISTORY_LEN, GRAPH_H, 0, 0, 0);
+    drawRect(graphX, GRAPH_Y + GRAPH_H - (int32_t)(GRAPH_PIXELS_PER_MS * 1000.0f / 30.0f), HISTORY_LEN, 1, 255, 255, 0);
+
+    // Draw the stacked bars for each frame of history, oldest to newest
+    double avgZoneUsec[NUM_ZONES] = {};
+    double avgTotalUsec = 0.0;
+
+    for (uint32_t i = 0; i < HISTORY_LEN; ++i) {
+        const FrameTimes& frameTimes = gHistory[(gHistoryHead + i) % HISTORY_LEN];
+
+        // Sum up the time for each category for this frame
+        float categoryUsec[NUM_GRAPH_CATEGORIES] = {};
+        float accountedUsec = 0.0f;
+
+        for (uint32_t zoneIdx = 0; zoneIdx < NUM_ZONES; ++zoneIdx) {
+            const GraphCategory category = ZONE_GRAPH_CATEGORIES[zoneIdx];
+            avgZoneUsec[zoneIdx] += frameTimes.zoneUsec[zoneIdx];
+
+            if (category != GraphCategory::None) {
+                categoryUsec[(uint32_t) category] += frameTimes.zoneUsec[zoneIdx];
+                accountedUsec += frameTimes.zoneUsec[zoneIdx];
+            }
+        }
+
+        categoryUsec[(uint32_t) GraphCategory::Other] = std::max(frameTimes.totalUsec - accountedUsec, 0.0f);
+        avgTotalUsec += frameTimes.totalUsec;
+
+        // Draw each category's bar segment, stacking them up from the bottom and clipping to the top of the graph
+        int32_t barY = GRAPH_Y + GRAPH_H;
+
+        for (uint32_t catIdx = 1; catIdx < NUM_GRAPH_CATEGORIES; ++catIdx) {
+            const int32_t segH = std::min((int32_t)(categoryUsec[catIdx] * GRAPH_PIXELS_PER_MS / 1000.0f + 0.5f), barY - GRAPH_Y);
+            const uint8_t* const color = GRAPH_CATEGORY_COLORS[catIdx];
+            drawRect(graphX + (int32_t) i, barY - segH, 1, segH, color[0], color[1], color[2]);
+            barY -= segH;
+        }
+    }
+
+    // Need to setup the texture window beforehand for the draw string calls
+    {
+        DR_MODE drawModePrim = {};
+        const SRECT texWindow = { (int16_t) gTex_STATUS.texPageCoordX, (int16_t) gTex_STATUS.texPageCoordY, 256, 256 };
+        LIBGPU_SetDrawMode(drawModePrim, false, false, gTex_STATUS.texPageId, &texWindow);
+        I_AddPrim(drawModePrim);
+    }
+
+    // Show the average time for each zone and for the entire frame across the history
+    char msgBuffer[128];
+    const int32_t textX = graphX + HISTORY_LEN + 4;
+    int32_t textY = GRAPH_Y;
+
+    for (uint32_t zoneIdx = 0; zoneIdx < NUM_ZONES; ++zoneIdx) {
+        std::snprintf(msgBuffer, sizeof(msgBuffer), "%s: %.2f", ZONE_SHORT_NAMES[zoneIdx], avgZoneUsec[zoneIdx] / (HISTORY_LEN * 1000.0));
+        I_DrawStringSmall(textX, textY, msgBuffer, Game::getTexClut_STATUS(), 128, 255, 255, false, false);
+        textY += 8;
+    }
+
+    std::snprintf(msgBuffer, sizeof(msgBuffer), "FRAME: %.2f", avgTotalUsec / (HISTORY_LEN * 1000.0));
+    I_DrawStringSmall(textX, textY, msgBuffer, Game::getTexClut_STATUS(), 255, 255, 128, false, false);
+
+    // Show how long generating audio takes relative to the audio buffer duration, and how many times the audio device likely underran
+    if (PsxVm::haveAudioOutputDevice()) {
+        const PsxVm::AudioStats audioStats = PsxVm::getAudioStats();
+
+        textY += 8;
+        std::snprintf(
+            msgBuffer,
+            sizeof(msgBuffer),
+            "AUDIO: %.2f/%.2f PK %.2f LATE %u",
+            audioStats.avgCallbackMs,
+            audioStats.bufferMs,
+            audioStats.peakCallbackMs,
+            audioStats.numLateCallbacks
+        );
+
+        I_DrawStringSmall(textX, textY, msgBuffer, Game::getTexClut_STATUS(), 255, 128, 128, false, false);
+    }
+
+    // Show script garbage collection stats when doing budgeted collection: time and steps last frame, memory used, cycles and forced collects
+    if (ScriptingEngine::isActive() && (ProgArgs::gLuaGCBudgetUsec > 0)) {
+        const ScriptingEngine::GCStats gcStats = ScriptingEngine::getGCStats();
+
+        textY += 8;
+        std::snprintf(
+            msgBuffer,
+            sizeof(msgBuffer),
+            "LUAGC: %.2f/%d %dK CYC %u/%u",
+            gcStats.usecLastFrame / 1000.0f,
+            gcStats.numStepsLastFrame,
+            gcStats.memUsedKB,
+            gcStats.numCyclesCompleted,
+            gcStats.numForcedCollects
+        );
+
+        I_DrawStringSmall(textX, textY, msgBuffer, Game::getTexClut_STATUS(), 255, 255, 128, false, false);
+    }
+
+    // Show the average GPU time for each GPU timing scope measured recently, if using the Vulkan renderer
+    #if PSYDOOM_VULKAN_RENDERER
+        if ((Video::gBackendType == Video::BackendType::Vulkan) && VGpuTimings::isAvailable()) {
+            for (uint32_t scopeIdx = 0; scopeIdx < (uint32_t) VGpuTimings::Scope::NUM_SCOPES; ++scopeIdx) {
+                const VGpuTimings::Scope scope = (VGpuTimings::Scope) scopeIdx;
+                const double avgTimeMs = VGpuTimings::getAvgTimeMs(scope);
+
+                if (avgTimeMs <= 0.0)
+                    continue;
+
+                textY += 8;
+                std::snprintf(msgBuffer, sizeof(msgBuffer), "%s: %.2f", VGpuTimings::getScopeName(scope), avgTimeMs);
+                I_DrawStringSmall(textX, textY, msgBuffer, Game::getTexClut_STATUS(), 128, 255, 128, false, false);
+            }
+        }
+    #endif
+}
+
+END_NAMESPACE(FrameProfiler)
+
+#endif  // #if PSYDOOM_FRAME_PROFILER
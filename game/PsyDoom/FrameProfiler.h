@@ -0,0 +1,67 @@
+#pragma once
+
+#include "Macros.h"
+
+#include <chrono>
+#include <cstdint>
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Scoped timer macro for profiling a block of code as one of the zones defined by 'FrameProfiler::Zone'.
+// The profiler is only compiled in when 'PSYDOOM_FRAME_PROFILER' is enabled, otherwise this macro does nothing.
+//
+// Example usage:
+//      PROFILE_SCOPE(RunThinkers);
+//------------------------------------------------------------------------------------------------------------------------------------------
+#if PSYDOOM_FRAME_PROFILER
+    #define PROFILE_SCOPE_CONCAT_INNER(A, B) A##B
+    #define PROFILE_SCOPE_CONCAT(A, B) PROFILE_SCOPE_CONCAT_INNER(A, B)
+    #define PROFILE_SCOPE(ZoneName)\
+        const FrameProfiler::ScopedTimer PROFILE_SCOPE_CONCAT(profileScopedTimer_, __LINE__)(FrameProfiler::Zone::ZoneName)
+#else
+    #define PROFILE_SCOPE(ZoneName)
+#endif
+
+#if PSYDOOM_FRAME_PROFILER
+
+BEGIN_NAMESPACE(FrameProfiler)
+
+// All of the code zones which can be profiled.
+// Zones which are nested inside other zones must be listed after the zones which contain them.
+enum class Zone : uint8_t {
+    Ticker,                     // 'P_Ticker': all game logic for a frame
+    RunThinkers,                // 'P_RunThinkers' (nested in 'Ticker')
+    CheckSights,                // 'P_CheckSights' (nested in 'Ticker')
+    RenderPlayerView,           // 'R_RenderPlayerView': the classic renderer
+    BuildDrawSubsecList,        // 'RV_BuildDrawSubsecList': Vulkan renderer BSP traversal
+    BuildSpriteFragLists,       // 'RV_BuildSpriteFragLists': Vulkan renderer sprite splitting
+    VDrawingEndFrame,           // 'VDrawing::endFrame': Vulkan renderer vertex submission
+    VRendererEndFrame,          // 'VRenderer::endFrame': Vulkan renderer command submission and presentation
+    NUM_ZONES
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Times the scope it is declared in and adds the time to the given zone for the current frame
+//------------------------------------------------------------------------------------------------------------------------------------------
+class ScopedTimer {
+public:
+    inline ScopedTimer(const Zone zone) noexcept
+        : mZone(zone)
+        , mStartTime(std::chrono::steady_clock::now())
+    {
+    }
+
+    ~ScopedTimer() noexcept;
+
+private:
+    const Zone                                      mZone;
+    const std::chrono::steady_clock::time_point     mStartTime;
+};
+
+void init() noexcept;
+void shutdown() noexcept;
+void endFrame() noexcept;
+void drawOverlay() noexcept;
+
+END_NAMESPACE(FrameProfiler)
+
+#endif  // #if PSYDOOM_FRAME_PROFILER
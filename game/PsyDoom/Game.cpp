@@ -9,6 +9,7 @@
 #include "Doom/UI/in_main.h"
 #include "Endian.h"
 #include "FatalErrors.h"
+#include "FileUtils.h"
 #include "IsoFileSys.h"
 #include "MapInfo/MapInfo.h"
 #include "ProgArgs.h"
@@ -17,6 +18,9 @@
 
 #include <algorithm>
 #include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
 
 BEGIN_NAMESPACE(Game)
 
@@ -35,6 +39,24 @@ GameConstants   gConstants;             // Constants that vary by game type
 bool            gbIsDemoVersion;        // If the game type is 'Doom' this is set to 'true' if the one level demo disc is being played
 bool            gbIsPsxDoomForever;     // If the game type is 'Final Doom' this is set to 'true' if the 'PSX Doom Forever' ROM hack is being played
 
+// Identifies a game type cache file, and the version of the cache file format
+static constexpr uint32_t GAME_TYPE_CACHE_MAGIC = 0x54474450;       // 'PDGT' in little endian
+static constexpr uint32_t GAME_TYPE_CACHE_VERSION = 1;
+
+// Format for a cache file holding the detected game type and variant for a disc
+struct GameTypeCache {
+    uint32_t    magic;                  // Should be 'GAME_TYPE_CACHE_MAGIC'
+    uint32_t    version;                // Should be 'GAME_TYPE_CACHE_VERSION'
+    uint64_t    discKey;                // Hash identifying the disc the cache is for
+    int32_t     gameType;               // Detected game type
+    int32_t     gameVariant;            // Detected game variant
+    uint8_t     bIsDemoVersion;         // '1' if this is the one level demo disc
+    uint8_t     bIsPsxDoomForever;      // '1' if this is the 'PSX Doom Forever' ROM hack
+    uint8_t     unused[6];
+};
+
+static_assert(sizeof(GameTypeCache) == 32);
+
 // Level timer: start time
 static std::chrono::high_resolution_clock::time_point gLevelStartTime;
 
@@ -57,10 +79,10 @@ static bool discFileExists(const char* const filePath, const uint64_t hashWord1,
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Determine which game type we are playing and from what region.
-// Also sets constants for the game based on the game type.
+// Helper: identifies the game type and region from the files on the game disc.
+// Raises a fatal error if the disc is not recognized.
 //------------------------------------------------------------------------------------------------------------------------------------------
-void determineGameTypeAndVariant() noexcept {
+static void detectGameTypeAndVariant() noexcept {
     gbIsDemoVersion = false;
     gbIsPsxDoomForever = false;
 
@@ -130,6 +152,112 @@ void determineGameTypeAndVariant() noexcept {
             "   - Doom single level PAL demo (standalone disc, or in a demo collection)."
         );
     }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Helper: gets the path to the file caching the detected game type and variant for the current disc.
+// Returns an empty string if there is no cache directory, or the disc could not be identified well enough to cache the result.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static std::string getGameTypeCacheFilePath() noexcept {
+    const std::string& cacheDir = Config::gDiscIndexCacheDir;
+    const uint64_t discKey = PsxVm::gIsoFileSys.discKey;
+
+    if (cacheDir.empty() || (discKey == 0))
+        return {};
+
+    char cacheFileName[32];
+    std::snprintf(cacheFileName, sizeof(cacheFileName), "%016llX.gametype", (unsigned long long) discKey);
+
+    std::string cacheFilePath = cacheDir;
+
+    if ((cacheFilePath.back() != '/') && (cacheFilePath.back() != '\\')) {
+        cacheFilePath += '/';
+    }
+
+    cacheFilePath += cacheFileName;
+    return cacheFilePath;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Helper: tries to load the game type and variant for the current disc from the specified cache file.
+// Returns 'false' if the cache file doesn't exist or is invalid.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool loadGameTypeCache(const char* const filePath) noexcept {
+    if (!FileUtils::fileExists(filePath))
+        return false;
+
+    const FileData fileData = FileUtils::getContentsOfFile(filePath);
+
+    if ((!fileData.bytes) || (fileData.size != sizeof(GameTypeCache)))
+        return false;
+
+    GameTypeCache cache;
+    std::memcpy(&cache, fileData.bytes.get(), sizeof(cache));
+
+    const bool bValidCache = (
+        (cache.magic == GAME_TYPE_CACHE_MAGIC) &&
+        (cache.version == GAME_TYPE_CACHE_VERSION) &&
+        (cache.discKey == PsxVm::gIsoFileSys.discKey) &&
+        (cache.gameType >= (int32_t) GameType::Doom) &&
+        (cache.gameType <= (int32_t) GameType::GEC_ME_Beta4) &&
+        (cache.gameVariant >= (int32_t) GameVariant::NTSC_U) &&
+        (cache.gameVariant <= (int32_t) GameVariant::PAL) &&
+        (cache.bIsDemoVersion <= 1) &&
+        (cache.bIsPsxDoomForever <= 1)
+    );
+
+    if (!bValidCache)
+        return false;
+
+    gGameType = (GameType) cache.gameType;
+    gGameVariant = (GameVariant) cache.gameVariant;
+    gbIsDemoVersion = (cache.bIsDemoVersion != 0);
+    gbIsPsxDoomForever = (cache.bIsPsxDoomForever != 0);
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Helper: saves the detected game type and variant for the current disc to the specified cache file.
+// Writes to a temporary file first and then moves it into place, so a partially written cache file is never used.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void saveGameTypeCache(const char* const filePath) noexcept {
+    GameTypeCache cache = {};
+    cache.magic = GAME_TYPE_CACHE_MAGIC;
+    cache.version = GAME_TYPE_CACHE_VERSION;
+    cache.discKey = PsxVm::gIsoFileSys.discKey;
+    cache.gameType = (int32_t) gGameType;
+    cache.gameVariant = (int32_t) gGameVariant;
+    cache.bIsDemoVersion = (gbIsDemoVersion) ? 1 : 0;
+    cache.bIsPsxDoomForever = (gbIsPsxDoomForever) ? 1 : 0;
+
+    const std::string tmpFilePath = std::string(filePath) + ".tmp";
+
+    if (!FileUtils::writeDataToFile(tmpFilePath.c_str(), &cache, sizeof(cache)))
+        return;
+
+    std::remove(filePath);
+
+    if (std::rename(tmpFilePath.c_str(), filePath) != 0) {
+        std::remove(tmpFilePath.c_str());
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Determine which game type we are playing and from what region.
+// Also sets constants for the game based on the game type.
+//
+// The result is cached per disc, alongside the disc's filesystem index cache, since identifying some discs requires hashing whole files on
+// the disc and this can be slow on some storage devices.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void determineGameTypeAndVariant() noexcept {
+    const std::string cacheFilePath = getGameTypeCacheFilePath();
+
+    if (cacheFilePath.empty()) {
+        detectGameTypeAndVariant();
+    } else if (!loadGameTypeCache(cacheFilePath.c_str())) {
+        detectGameTypeAndVariant();
+        saveGameTypeCache(cacheFilePath.c_str());
+    }
 
     // Populate constants that vary from game to game
     gConstants.populate(gGameType, gbIsDemoVersion);
@@ -220,6 +348,12 @@ void getUserGameSettings(GameSettings& settings) noexcept {
     settings.dmFragLimit                        = Config::gDmFragLimit;
     settings.coopPreserveAmmoFactor             = Config::gCoopPreserveAmmoFactor;
     settings.bSinglePlayerForceSpawnDmThings    = Config::gbSinglePlayerForceSpawnDmThings;
+
+    // Note: not worth making this one a config option either since it only changes performance, so always use it for new games and demos.
+    // It is still synchronized for multiplayer games and demos however, since it can subtly affect game behavior.
+    settings.bUseTouchingThingLists             = true;
+    settings.monsterAiLodDist                   = std::clamp(Config::gMonsterAiLodDist, 0, 32767);  // Cap so the distance can be expressed in 16.16 format
+    settings.bUseMonsterFlowFields              = Config::gbUseMonsterFlowFields;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -269,6 +403,9 @@ void getClassicDemoGameSettings(GameSettings& settings) noexcept {
     settings.dmFragLimit                        = 0;
     settings.coopPreserveAmmoFactor             = 0;
     settings.bSinglePlayerForceSpawnDmThings    = false;
+    settings.bUseTouchingThingLists             = false;
+    settings.monsterAiLodDist                   = 0;
+    settings.bUseMonsterFlowFields              = false;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
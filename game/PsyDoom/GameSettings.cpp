@@ -13,11 +13,158 @@
 #include <type_traits>
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Game version:            1.1.0+
+// Game version:            1.1.4+
+// Demo file version:       17
+// Net protocol version:    37
+//------------------------------------------------------------------------------------------------------------------------------------------
+typedef GameSettings GameSettingsV5;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Game version:            1.1.3
+// Demo file version:       16
+// Net protocol version:    36
+//------------------------------------------------------------------------------------------------------------------------------------------
+struct GameSettingsV4 {
+    static constexpr uint32_t VERSION = 4;
+
+    uint8_t     bUsePalTimings;
+    uint8_t     bUseDemoTimings;
+    uint8_t     bFixKillCount;
+    uint8_t     bFixLineActivation;
+    uint8_t     bUseExtendedPlayerShootRange;
+    uint8_t     bFixMultiLineSpecialCrossing;
+    uint8_t     bUsePlayerRocketBlastFix;
+    uint8_t     bUseSuperShotgunDelayTweak;
+    uint8_t     bUseMoveInputLatencyTweak;
+    uint8_t     bUseItemPickupFix;
+    uint8_t     bUseFinalDoomPlayerMovement;
+    uint8_t     bAllowMovementCancellation;
+    uint8_t     bAllowTurningCancellation;
+    uint8_t     bFixViewBobStrength;
+    uint8_t     bFixGravityStrength;
+    uint8_t     bNoMonsters;
+    uint8_t     bNoMonstersBossFixup;
+    uint8_t     bPistolStart;
+    uint8_t     bTurboMode;
+    uint8_t     bUseLostSoulSpawnFix;
+    uint8_t     bUseLineOfSightOverflowFix;
+    uint8_t     bRemoveMaxCrossLinesLimit;
+    uint8_t     bFixOutdoorBulletPuffs;
+    uint8_t     bFixBlockingGibsBug;
+    uint8_t     bFixSoundPropagation;
+    uint8_t     bFixSpriteVerticalWarp;
+    uint8_t     bAllowMultiMapPickup;
+    uint8_t     bEnableMapPatches_GamePlay;
+    uint8_t     bCoopNoFriendlyFire;
+    uint8_t     bCoopForceSpawnDeathmatchThings;
+    uint8_t     bDmExitDisabled;
+    uint8_t     bCoopPreserveKeys;
+    uint8_t     bDmActivateBossSpecialSectors;
+    int32_t     lostSoulSpawnLimit;
+    int32_t     viewBobbingStrengthFixed;
+    int32_t     dmFragLimit;
+    int32_t     coopPreserveAmmoFactor;
+    uint8_t     bSinglePlayerForceSpawnDmThings;
+    uint8_t     bUseTouchingThingLists;
+    int32_t     monsterAiLodDist;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Game version:            1.1.2
+// Demo file version:       15
+// Net protocol version:    33 - 35
+//------------------------------------------------------------------------------------------------------------------------------------------
+struct GameSettingsV3 {
+    static constexpr uint32_t VERSION = 3;
+
+    uint8_t     bUsePalTimings;
+    uint8_t     bUseDemoTimings;
+    uint8_t     bFixKillCount;
+    uint8_t     bFixLineActivation;
+    uint8_t     bUseExtendedPlayerShootRange;
+    uint8_t     bFixMultiLineSpecialCrossing;
+    uint8_t     bUsePlayerRocketBlastFix;
+    uint8_t     bUseSuperShotgunDelayTweak;
+    uint8_t     bUseMoveInputLatencyTweak;
+    uint8_t     bUseItemPickupFix;
+    uint8_t     bUseFinalDoomPlayerMovement;
+    uint8_t     bAllowMovementCancellation;
+    uint8_t     bAllowTurningCancellation;
+    uint8_t     bFixViewBobStrength;
+    uint8_t     bFixGravityStrength;
+    uint8_t     bNoMonsters;
+    uint8_t     bNoMonstersBossFixup;
+    uint8_t     bPistolStart;
+    uint8_t     bTurboMode;
+    uint8_t     bUseLostSoulSpawnFix;
+    uint8_t     bUseLineOfSightOverflowFix;
+    uint8_t     bRemoveMaxCrossLinesLimit;
+    uint8_t     bFixOutdoorBulletPuffs;
+    uint8_t     bFixBlockingGibsBug;
+    uint8_t     bFixSoundPropagation;
+    uint8_t     bFixSpriteVerticalWarp;
+    uint8_t     bAllowMultiMapPickup;
+    uint8_t     bEnableMapPatches_GamePlay;
+    uint8_t     bCoopNoFriendlyFire;
+    uint8_t     bCoopForceSpawnDeathmatchThings;
+    uint8_t     bDmExitDisabled;
+    uint8_t     bCoopPreserveKeys;
+    uint8_t     bDmActivateBossSpecialSectors;
+    int32_t     lostSoulSpawnLimit;
+    int32_t     viewBobbingStrengthFixed;
+    int32_t     dmFragLimit;
+    int32_t     coopPreserveAmmoFactor;
+    uint8_t     bSinglePlayerForceSpawnDmThings;
+    uint8_t     bUseTouchingThingLists;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Game version:            1.1.0 - 1.1.1
 // Demo file version:       14
 // Net protocol version:    31
 //------------------------------------------------------------------------------------------------------------------------------------------
-typedef GameSettings GameSettingsV2;
+struct GameSettingsV2 {
+    static constexpr uint32_t VERSION = 2;
+
+    uint8_t     bUsePalTimings;
+    uint8_t     bUseDemoTimings;
+    uint8_t     bFixKillCount;
+    uint8_t     bFixLineActivation;
+    uint8_t     bUseExtendedPlayerShootRange;
+    uint8_t     bFixMultiLineSpecialCrossing;
+    uint8_t     bUsePlayerRocketBlastFix;
+    uint8_t     bUseSuperShotgunDelayTweak;
+    uint8_t     bUseMoveInputLatencyTweak;
+    uint8_t     bUseItemPickupFix;
+    uint8_t     bUseFinalDoomPlayerMovement;
+    uint8_t     bAllowMovementCancellation;
+    uint8_t     bAllowTurningCancellation;
+    uint8_t     bFixViewBobStrength;
+    uint8_t     bFixGravityStrength;
+    uint8_t     bNoMonsters;
+    uint8_t     bNoMonstersBossFixup;
+    uint8_t     bPistolStart;
+    uint8_t     bTurboMode;
+    uint8_t     bUseLostSoulSpawnFix;
+    uint8_t     bUseLineOfSightOverflowFix;
+    uint8_t     bRemoveMaxCrossLinesLimit;
+    uint8_t     bFixOutdoorBulletPuffs;
+    uint8_t     bFixBlockingGibsBug;
+    uint8_t     bFixSoundPropagation;
+    uint8_t     bFixSpriteVerticalWarp;
+    uint8_t     bAllowMultiMapPickup;
+    uint8_t     bEnableMapPatches_GamePlay;
+    uint8_t     bCoopNoFriendlyFire;
+    uint8_t     bCoopForceSpawnDeathmatchThings;
+    uint8_t     bDmExitDisabled;
+    uint8_t     bCoopPreserveKeys;
+    uint8_t     bDmActivateBossSpecialSectors;
+    int32_t     lostSoulSpawnLimit;
+    int32_t     viewBobbingStrengthFixed;
+    int32_t     dmFragLimit;
+    int32_t     coopPreserveAmmoFactor;
+    uint8_t     bSinglePlayerForceSpawnDmThings;
+};
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Game version:            1.0.x
@@ -104,6 +251,18 @@ static void byteSwapGameSettings(GameSettingsT& settings) noexcept {
         Endian::byteSwapInPlace(settings.coopPreserveAmmoFactor);
         Endian::byteSwapInPlace(settings.bSinglePlayerForceSpawnDmThings);
     }
+
+    if constexpr (GameSettingsT::VERSION >= 3) {
+        Endian::byteSwapInPlace(settings.bUseTouchingThingLists);
+    }
+
+    if constexpr (GameSettingsT::VERSION >= 4) {
+        Endian::byteSwapInPlace(settings.monsterAiLodDist);
+    }
+
+    if constexpr (GameSettingsT::VERSION >= 5) {
+        Endian::byteSwapInPlace(settings.bUseMonsterFlowFields);
+    }
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -161,6 +320,18 @@ static void migrateGameSettings(OldGameSettingsT& oldSettings, GameSettings& new
         COPY_GAME_SETTINGS_FIELD(bSinglePlayerForceSpawnDmThings);
     }
 
+    if constexpr (OldGameSettingsT::VERSION >= 3) {
+        COPY_GAME_SETTINGS_FIELD(bUseTouchingThingLists);
+    }
+
+    if constexpr (OldGameSettingsT::VERSION >= 4) {
+        COPY_GAME_SETTINGS_FIELD(monsterAiLodDist);
+    }
+
+    if constexpr (OldGameSettingsT::VERSION >= 5) {
+        COPY_GAME_SETTINGS_FIELD(bUseMonsterFlowFields);
+    }
+
     #undef COPY_GAME_SETTINGS_FIELD
 }
 
@@ -215,6 +386,10 @@ int32_t getGameSettingsVersionForDemoFileVersion(const int32_t demoFileVersion)
     switch (demoFileVersion) {
         case 11:    return 1;
         case 14:    return 2;
+        case 15:    return 3;
+        case 16:    return 4;
+        case 17:    return 5;
+        case 18:    return 5;
     }
 
     ASSERT_FAIL_F("No 'GameSettings' mapping for demo file version '%d'! Support might need to be added here...", demoFileVersion);
@@ -229,6 +404,9 @@ int32_t getGameSettingsSize(const int32_t gameSettingsVersion) noexcept {
     switch (gameSettingsVersion) {
         case 1:     return sizeof(GameSettingsV1);
         case 2:     return sizeof(GameSettingsV2);
+        case 3:     return sizeof(GameSettingsV3);
+        case 4:     return sizeof(GameSettingsV4);
+        case 5:     return sizeof(GameSettingsV5);
     }
 
     ASSERT_FAIL_F("Invalid 'GameSettings' version '%d'!", gameSettingsVersion);
@@ -247,6 +425,9 @@ bool readAndMigrateGameSettings(const int32_t gameSettingsVersion, const void* c
     switch (gameSettingsVersion) {
         case 1:     readAndMigrateGameSettingsImpl<GameSettingsV1>(pSrcBuffer, dstSettings);    break;
         case 2:     readAndMigrateGameSettingsImpl<GameSettingsV2>(pSrcBuffer, dstSettings);    break;
+        case 3:     readAndMigrateGameSettingsImpl<GameSettingsV3>(pSrcBuffer, dstSettings);    break;
+        case 4:     readAndMigrateGameSettingsImpl<GameSettingsV4>(pSrcBuffer, dstSettings);    break;
+        case 5:     readAndMigrateGameSettingsImpl<GameSettingsV5>(pSrcBuffer, dstSettings);    break;
 
         default:
             ASSERT_FAIL_F("Invalid 'GameSettings' version '%d'!", gameSettingsVersion);
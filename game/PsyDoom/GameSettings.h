@@ -10,7 +10,7 @@
 //------------------------------------------------------------------------------------------------------------------------------------------
 struct GameSettings {
     // The current version of this struct: this can be incremented for future PsyDoom releases if the format changes
-    static constexpr uint32_t VERSION = 2;
+    static constexpr uint32_t VERSION = 5;
 
     uint8_t     bUsePalTimings;                         // Use 50 Hz vblanks and other various timing adjustments for the PAL version of the game?
     uint8_t     bUseDemoTimings;                        // Force player logic to run at a consistent, but slower rate used by demos? (15 Hz for NTSC)
@@ -50,6 +50,9 @@ struct GameSettings {
     int32_t     dmFragLimit;                            // If playing deathmatch, level will exit when this number of frags is reached. <0 = infinite.
     int32_t     coopPreserveAmmoFactor;                 // How much ammo a player keeps after dying in co-op. 0 = none | 1 = all | 2 = half
     uint8_t     bSinglePlayerForceSpawnDmThings;        // Enable multiplayer-only things in single player?
+    uint8_t     bUseTouchingThingLists;                 // Use per-sector lists of touching things to find things affected by moving floors and ceilings? (faster, but changes the order things are visited in)
+    int32_t     monsterAiLodDist;                       // Monsters further than this (integer) distance from all players and unable to see their target run their AI at a reduced rate. '0' = disabled.
+    uint8_t     bUseMonsterFlowFields;                  // Let regular walking monsters choose chase directions using shared, per player flow fields over the blockmap?
 
     void byteSwap() noexcept;
     void endianCorrect() noexcept;
@@ -40,6 +40,16 @@ static std::vector<JoyHat>              gJoystickHatsPressed;
 static std::vector<JoyHat>              gJoystickHatsJustPressed;
 static std::vector<JoyHat>              gJoystickHatsJustReleased;
 
+// Flags for whether each keyboard key, mouse button and gamepad input is pressed, just pressed or just released.
+// These flat tables mirror the vectors above and are indexed by the input, so that checking the state of an input is a single lookup.
+static constexpr uint8_t INPUT_PRESSED          = 0x1;
+static constexpr uint8_t INPUT_JUST_PRESSED     = 0x2;
+static constexpr uint8_t INPUT_JUST_RELEASED    = 0x4;
+
+static uint8_t  gKeyboardKeyFlags[NUM_KEYBOARD_KEYS];
+static uint8_t  gMouseButtonFlags[NUM_MOUSE_BUTTONS];
+static uint8_t  gGamepadInputFlags[NUM_GAMEPAD_INPUTS];
+
 static SDL_GameController*  gpGameController;
 static SDL_Joystick*        gpJoystick;         // Note: if there is a game controller then this joystick will be managed by that and not closed manually by this module!
 static SDL_JoystickID       gJoystickId;
@@ -80,6 +90,29 @@ static inline void emptyAndShrinkVector(std::vector<T>& vec) noexcept {
     vec.shrink_to_fit();
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Input state flag utility functions
+//------------------------------------------------------------------------------------------------------------------------------------------
+static inline void setInputFlagsPressed(uint8_t& flags) noexcept {
+    flags = (uint8_t)((flags & ~INPUT_JUST_RELEASED) | INPUT_PRESSED | INPUT_JUST_PRESSED);
+}
+
+static inline void setInputFlagsReleased(uint8_t& flags) noexcept {
+    flags = (uint8_t)((flags & ~(INPUT_PRESSED | INPUT_JUST_PRESSED)) | INPUT_JUST_RELEASED);
+}
+
+template <size_t N>
+static inline void clearJustPressedAndReleasedFlags(uint8_t (&flags)[N]) noexcept {
+    for (uint8_t& inputFlags : flags) {
+        inputFlags &= INPUT_PRESSED;
+    }
+}
+
+template <size_t N>
+static inline bool testInputFlag(const uint8_t (&flags)[N], const uint32_t inputIdx, const uint8_t flag) noexcept {
+    return ((inputIdx < N) && (flags[inputIdx] & flag));
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Update the value of a joystick axis in the vector of values: removes the value if it has reached '0'
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -118,6 +151,7 @@ static float sdlAxisValueToFloat(const int16_t axis) noexcept {
 //------------------------------------------------------------------------------------------------------------------------------------------
 static void closeCurrentGameController() noexcept {
     std::memset(gGamepadInputs, 0, sizeof(gGamepadInputs));
+    std::memset(gGamepadInputFlags, 0, sizeof(gGamepadInputFlags));
     gGamepadInputsPressed.clear();
     gGamepadInputsJustPressed.clear();
     gGamepadInputsJustReleased.clear();
@@ -216,6 +250,20 @@ static void updateJoystickHat(const JoyHat hat, const bool bPressed) noexcept {
     }
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Accumulate the movement from an SDL mouse motion event
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void handleMouseMotionEvent(const SDL_MouseMotionEvent& motion) noexcept {
+    // Only register movement if we have captured the mouse
+    if (SDL_GetRelativeMouseMode()) {
+        gMouseMovementX += (float) motion.xrel;
+        gMouseMovementY += (float) motion.yrel;
+    } else {
+        gMouseMovementX = 0.0f;
+        gMouseMovementY = 0.0f;
+    }
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Handle events sent by SDL (keypresses and such)
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -270,6 +318,7 @@ static void handleSdlEvents() noexcept {
                     removeValueFromVector(scancode, gKeyboardKeysJustReleased);
                     gKeyboardKeysPressed.push_back(scancode);
                     gKeyboardKeysJustPressed.push_back(scancode);
+                    setInputFlagsPressed(gKeyboardKeyFlags[scancode]);
                 }
             }   break;
 
@@ -281,6 +330,7 @@ static void handleSdlEvents() noexcept {
                     removeValueFromVector(scancode, gKeyboardKeysPressed);
                     removeValueFromVector(scancode, gKeyboardKeysJustPressed);
                     gKeyboardKeysJustReleased.push_back(scancode);
+                    setInputFlagsReleased(gKeyboardKeyFlags[scancode]);
                 }
             }   break;
 
@@ -304,6 +354,7 @@ static void handleSdlEvents() noexcept {
                     removeValueFromVector(button, gMouseButtonsJustReleased);
                     gMouseButtonsPressed.push_back(button);
                     gMouseButtonsJustPressed.push_back(button);
+                    setInputFlagsPressed(gMouseButtonFlags[(uint8_t) button]);
                 }
             } break;
 
@@ -314,19 +365,13 @@ static void handleSdlEvents() noexcept {
                     removeValueFromVector(button, gMouseButtonsPressed);
                     removeValueFromVector(button, gMouseButtonsJustPressed);
                     gMouseButtonsJustReleased.push_back(button);
+                    setInputFlagsReleased(gMouseButtonFlags[(uint8_t) button]);
                 }
             } break;
 
-            case SDL_MOUSEMOTION: {
-                // Only register movement if we have captured the mouse
-                if (SDL_GetRelativeMouseMode()) {
-                    gMouseMovementX += (float) sdlEvent.motion.xrel;
-                    gMouseMovementY += (float) sdlEvent.motion.yrel;
-                } else {
-                    gMouseMovementX = 0.0f;
-                    gMouseMovementY = 0.0f;
-                }
-            } break;
+            case SDL_MOUSEMOTION:
+                handleMouseMotionEvent(sdlEvent.motion);
+                break;
 
             case SDL_MOUSEWHEEL: {
                 // Only register movement if we have captured the mouse
@@ -362,10 +407,12 @@ static void handleSdlEvents() noexcept {
                                 removeValueFromVector(input, gGamepadInputsJustReleased);
                                 gGamepadInputsPressed.push_back(input);
                                 gGamepadInputsJustPressed.push_back(input);
+                                setInputFlagsPressed(gGamepadInputFlags[inputIdx]);
                             } else {
                                 removeValueFromVector(input, gGamepadInputsPressed);
                                 removeValueFromVector(input, gGamepadInputsJustPressed);
                                 gGamepadInputsJustReleased.push_back(input);
+                                setInputFlagsReleased(gGamepadInputFlags[inputIdx]);
                             }
                         }
                     }
@@ -410,6 +457,7 @@ static void handleSdlEvents() noexcept {
                         gGamepadInputsPressed.push_back(input);
                         gGamepadInputsJustPressed.push_back(input);
                         gGamepadInputs[(uint8_t) input] = 1.0f;
+                        setInputFlagsPressed(gGamepadInputFlags[(uint8_t) input]);
                     }
                 }
             }   break;
@@ -432,6 +480,7 @@ static void handleSdlEvents() noexcept {
                         removeValueFromVector(input, gGamepadInputsPressed);
                         removeValueFromVector(input, gGamepadInputsJustPressed);
                         gGamepadInputs[(uint8_t) input] = 0.0f;
+                        setInputFlagsReleased(gGamepadInputFlags[(uint8_t) input]);
                     }
                 }
             }   break;
@@ -554,6 +603,9 @@ void shutdown() noexcept {
     emptyAndShrinkVector(gKeyboardKeysJustPressed);
     emptyAndShrinkVector(gKeyboardKeysPressed);
 
+    std::memset(gKeyboardKeyFlags, 0, sizeof(gKeyboardKeyFlags));
+    std::memset(gMouseButtonFlags, 0, sizeof(gMouseButtonFlags));
+
     gpKeyboardState = nullptr;
     gbIsQuitRequested = false;
 
@@ -569,6 +621,27 @@ void update() noexcept {
     }
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Picks up any mouse movement that has arrived since the last call to 'update', just before the movement is used.
+// Only mouse motion events are taken from the SDL event queue: all other events are left queued for the next 'update'.
+// This means that no key or button events can be received and then consumed while the game logic is running.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void latchMouseMovements() noexcept {
+    if (ProgArgs::gbHeadlessMode)
+        return;
+
+    SDL_PumpEvents();
+
+    SDL_Event sdlEvents[32];
+    int numEvents = 0;
+
+    while ((numEvents = SDL_PeepEvents(sdlEvents, C_ARRAY_SIZE(sdlEvents), SDL_GETEVENT, SDL_MOUSEMOTION, SDL_MOUSEMOTION)) > 0) {
+        for (int i = 0; i < numEvents; ++i) {
+            handleMouseMotionEvent(sdlEvents[i].motion);
+        }
+    }
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Discards input events and movements.
 // Should be called whenever inputs have been processed for a frame.
@@ -584,7 +657,11 @@ void consumeEvents() noexcept {
 
     gGamepadInputsJustPressed.clear();
     gGamepadInputsJustReleased.clear();
-    
+
+    clearJustPressedAndReleasedFlags(gKeyboardKeyFlags);
+    clearJustPressedAndReleasedFlags(gMouseButtonFlags);
+    clearJustPressedAndReleasedFlags(gGamepadInputFlags);
+
     gJoystickAxesJustPressed.clear();
     gJoystickAxesJustReleased.clear();
     gJoystickButtonsJustPressed.clear();
@@ -763,11 +840,11 @@ const std::vector<JoystickAxis>& getActiveJoystickAxes() noexcept {
 }
 
 bool isKeyboardKeyPressed(const uint16_t key) noexcept {
-    return vectorContainsValue(gKeyboardKeysPressed, key);
+    return testInputFlag(gKeyboardKeyFlags, key, INPUT_PRESSED);
 }
 
 bool isKeyboardKeyJustPressed(const uint16_t key) noexcept {
-    return vectorContainsValue(gKeyboardKeysJustPressed, key);
+    return testInputFlag(gKeyboardKeyFlags, key, INPUT_JUST_PRESSED);
 }
 
 bool isKeyboardKeyReleased(const uint16_t key) noexcept {
@@ -775,35 +852,35 @@ bool isKeyboardKeyReleased(const uint16_t key) noexcept {
 }
 
 bool isKeyboardKeyJustReleased(const uint16_t key) noexcept {
-    return vectorContainsValue(gKeyboardKeysJustReleased, key);
+    return testInputFlag(gKeyboardKeyFlags, key, INPUT_JUST_RELEASED);
 }
 
 bool isMouseButtonPressed(const MouseButton button) noexcept {
-    return vectorContainsValue(gMouseButtonsPressed, button);
+    return testInputFlag(gMouseButtonFlags, (uint8_t) button, INPUT_PRESSED);
 }
 
 bool isMouseButtonJustPressed(const MouseButton button) noexcept {
-    return vectorContainsValue(gMouseButtonsJustPressed, button);
+    return testInputFlag(gMouseButtonFlags, (uint8_t) button, INPUT_JUST_PRESSED);
 }
 
 bool isMouseButtonReleased(const MouseButton button) noexcept {
-    return (!vectorContainsValue(gMouseButtonsPressed, button));
+    return (!isMouseButtonPressed(button));
 }
 
 bool isMouseButtonJustReleased(const MouseButton button) noexcept {
-    return vectorContainsValue(gMouseButtonsJustReleased, button);
+    return testInputFlag(gMouseButtonFlags, (uint8_t) button, INPUT_JUST_RELEASED);
 }
 
 bool isGamepadInputPressed(const GamepadInput input) noexcept {
-    return vectorContainsValue(gGamepadInputsPressed, input);
+    return testInputFlag(gGamepadInputFlags, (uint8_t) input, INPUT_PRESSED);
 }
 
 bool isGamepadInputJustPressed(const GamepadInput input) noexcept {
-    return vectorContainsValue(gGamepadInputsJustPressed, input);
+    return testInputFlag(gGamepadInputFlags, (uint8_t) input, INPUT_JUST_PRESSED);
 }
 
 bool isGamepadInputJustReleased(const GamepadInput input) noexcept {
-    return vectorContainsValue(gGamepadInputsJustReleased, input);
+    return testInputFlag(gGamepadInputFlags, (uint8_t) input, INPUT_JUST_RELEASED);
 }
 
 bool isJoystickAxisPressed(const uint32_t axis) noexcept {
@@ -64,6 +64,7 @@ struct JoystickAxis {
 void init() noexcept;
 void shutdown() noexcept;
 void update() noexcept;
+void latchMouseMovements() noexcept;
 void consumeEvents() noexcept;
 void consumeTypedChars() noexcept;
 void consumeMouseMovements() noexcept;
@@ -2,13 +2,32 @@
 
 #include "Asserts.h"
 #include "ByteInputStream.h"
+#include "ContentHash.h"
 #include "DiscInfo.h"
 #include "DiscReader.h"
 #include "Endian.h"
+#include "FileUtils.h"
 
+#include <cctype>
+#include <cstdio>
 #include <cstring>
 #include <queue>
 
+// Identifies a filesystem index cache file, and the version of the cache file format
+static constexpr uint32_t INDEX_CACHE_MAGIC = 0x58494450;       // 'PDIX' in little endian
+static constexpr uint32_t INDEX_CACHE_VERSION = 1;
+
+// Header for a filesystem index cache file, which is followed by all of the filesystem entries
+struct IndexCacheHdr {
+    uint32_t    magic;              // Should be 'INDEX_CACHE_MAGIC'
+    uint32_t    version;            // Should be 'INDEX_CACHE_VERSION'
+    uint64_t    discKey;            // Hash identifying the disc the cache is for
+    uint32_t    logicalBlockSize;   // Logical block size for the filesystem
+    uint32_t    numEntries;         // Number of filesystem entries following the header
+};
+
+static_assert(sizeof(IndexCacheHdr) == 24);
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Represents most of an ISO 9660 directory record.
 // Following this but not included are:
@@ -149,6 +168,165 @@ static bool isPathSeparator(const char c) noexcept {
     return ((c == '\\') || (c == '/'));
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Helper: converts a path relative to the filesystem root to the format used by the filesystem's path index.
+// Accepts the same path formats as the directory tree search: leading './' and path separators before each name are skipped.
+// Returns 'false' if the path can never match any filesystem entry (empty, or ends in a separator).
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool makeIndexPath(const char* path, std::string& indexPath) noexcept {
+    indexPath.clear();
+
+    while (true) {
+        // Skip root separators before this name
+        while (true) {
+            if ((path[0] == '.') && isPathSeparator(path[1])) {
+                path += 2;
+            } else if (isPathSeparator(path[0])) {
+                path += 1;
+            } else {
+                break;
+            }
+        }
+
+        // Must have a name following
+        if (!path[0])
+            return false;
+
+        if (!indexPath.empty()) {
+            indexPath += '/';
+        }
+
+        // Add the name to the output path and finish up if we reach the end of the input path
+        for (; path[0] && (!isPathSeparator(path[0])); ++path) {
+            indexPath += (char) std::toupper(path[0]);
+        }
+
+        if (!path[0])
+            return true;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Computes a key identifying the disc, used for the filesystem index cache.
+// Hashes the layout of the data track (01) and the contents of the volume descriptor sector, which includes the volume creation and
+// modification timestamps. This identifies the disc well enough without having to read the whole disc image.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool computeDiscKey(DiscReader& discReader, uint64_t& discKeyOut) noexcept {
+    if (!discReader.setTrackNum(1))
+        return false;
+
+    const DiscTrack* const pTrack = discReader.getOpenTrack();
+    ASSERT(pTrack);
+
+    std::byte volDescSector[sizeof(IsoVolDescriptor)];
+
+    if (!discReader.trackSeekAbs(pTrack->blockPayloadSize * VOL_DESC_SECTOR))
+        return false;
+
+    if (!discReader.read(volDescSector, sizeof(volDescSector)))
+        return false;
+
+    ContentHasher hasher;
+    hasher.addValue(pTrack->sourceFileTotalSize);
+    hasher.addValue(pTrack->fileOffset);
+    hasher.addValue(pTrack->blockSize);
+    hasher.addValue(pTrack->blockCount);
+    hasher.addValue(pTrack->blockPayloadOffset);
+    hasher.addValue(pTrack->blockPayloadSize);
+    hasher.add(volDescSector, sizeof(volDescSector));
+
+    discKeyOut = hasher.getHash().word1;
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tries to load the filesystem entries from the specified index cache file, which must be for the given disc.
+// The entries are sanity checked before use. Returns 'false' if the cache file doesn't exist or is invalid.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool loadFromIndexCache(IsoFileSys& fs, const char* const filePath, const uint64_t discKey) noexcept {
+    if (!FileUtils::fileExists(filePath))
+        return false;
+
+    const FileData fileData = FileUtils::getContentsOfFile(filePath);
+
+    if ((!fileData.bytes) || (fileData.size < sizeof(IndexCacheHdr)))
+        return false;
+
+    // Verify the header
+    IndexCacheHdr hdr;
+    std::memcpy(&hdr, fileData.bytes.get(), sizeof(hdr));
+
+    const bool bValidHeader = (
+        (hdr.magic == INDEX_CACHE_MAGIC) &&
+        (hdr.version == INDEX_CACHE_VERSION) &&
+        (hdr.discKey == discKey) &&
+        (hdr.logicalBlockSize >= IsoFileSys::MIN_LOGICAL_BLOCK_SIZE) &&
+        (hdr.logicalBlockSize <= IsoFileSys::MAX_LOGICAL_BLOCK_SIZE) &&
+        (hdr.numEntries > 0) &&
+        (hdr.numEntries <= IsoFileSysEntry::ROOT_PARENT_IDX) &&
+        (fileData.size == sizeof(IndexCacheHdr) + sizeof(IsoFileSysEntry) * (size_t) hdr.numEntries)
+    );
+
+    if (!bValidHeader)
+        return false;
+
+    // Read the entries and sanity check them, so that an index can't point outside of the list of entries
+    std::vector<IsoFileSysEntry> entries(hdr.numEntries);
+    std::memcpy(entries.data(), fileData.bytes.get() + sizeof(IndexCacheHdr), sizeof(IsoFileSysEntry) * (size_t) hdr.numEntries);
+
+    for (uint32_t entryIdx = 0; entryIdx < hdr.numEntries; ++entryIdx) {
+        const IsoFileSysEntry& entry = entries[entryIdx];
+
+        const bool bValidParent = (entryIdx == 0) ?
+            (entry.parentIdx == IsoFileSysEntry::ROOT_PARENT_IDX) :
+            (entry.parentIdx < entryIdx);
+
+        const bool bValidEntry = (
+            bValidParent &&
+            (entry.nameLen < C_ARRAY_SIZE(entry.name)) &&
+            (entry.name[entry.nameLen] == 0) &&
+            ((!entry.bIsDirectory) || ((uint32_t) entry.firstChildIdx + entry.numChildren <= hdr.numEntries))
+        );
+
+        if (!bValidEntry)
+            return false;
+    }
+
+    // All good: use the entries
+    fs.logicalBlockSize = hdr.logicalBlockSize;
+    fs.entries = std::move(entries);
+    fs.buildPathIndex();
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Saves the filesystem entries to the specified index cache file for the given disc.
+// Writes to a temporary file first and then moves it into place, so a partially written cache file is never used.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void saveToIndexCache(const IsoFileSys& fs, const char* const filePath, const uint64_t discKey) noexcept {
+    IndexCacheHdr hdr = {};
+    hdr.magic = INDEX_CACHE_MAGIC;
+    hdr.version = INDEX_CACHE_VERSION;
+    hdr.discKey = discKey;
+    hdr.logicalBlockSize = fs.logicalBlockSize;
+    hdr.numEntries = (uint32_t) fs.entries.size();
+
+    std::vector<std::byte> fileData(sizeof(IndexCacheHdr) + sizeof(IsoFileSysEntry) * fs.entries.size());
+    std::memcpy(fileData.data(), &hdr, sizeof(hdr));
+    std::memcpy(fileData.data() + sizeof(IndexCacheHdr), fs.entries.data(), sizeof(IsoFileSysEntry) * fs.entries.size());
+
+    const std::string tmpFilePath = std::string(filePath) + ".tmp";
+
+    if (!FileUtils::writeDataToFile(tmpFilePath.c_str(), fileData.data(), fileData.size()))
+        return;
+
+    std::remove(filePath);
+
+    if (std::rename(tmpFilePath.c_str(), filePath) != 0) {
+        std::remove(tmpFilePath.c_str());
+    }
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Sets up the file system and disc reader for the process of reading files and directories.
 // Reads the volume descriptor for the filesystem and creates the root filesystem entry.
@@ -362,15 +540,95 @@ bool IsoFileSys::build(DiscReader& discReader) noexcept {
             return false;
     }
 
+    buildPathIndex();
     return true;
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Same as the other overload, but first tries to load the filesystem entries from a cache file in the specified directory.
+// If there is no valid cache file for the disc then the filesystem is read from the disc and a new cache file is saved.
+// Failing to load or save the cache file is not an error: it just means the filesystem is read from the disc.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool IsoFileSys::build(DiscReader& discReader, const char* const indexCacheDir) noexcept {
+    // Figure out the path to the cache file for this disc, if possible.
+    // The key identifying the disc is also saved, for other cache files relating to the disc.
+    discKey = {};
+
+    if ((!indexCacheDir) || (!indexCacheDir[0]) || (!computeDiscKey(discReader, discKey))) {
+        discKey = {};
+        return build(discReader);
+    }
+
+    char cacheFileName[32];
+    std::snprintf(cacheFileName, sizeof(cacheFileName), "%016llX.isoindex", (unsigned long long) discKey);
+
+    std::string cacheFilePath = indexCacheDir;
+
+    if ((cacheFilePath.back() != '/') && (cacheFilePath.back() != '\\')) {
+        cacheFilePath += '/';
+    }
+
+    cacheFilePath += cacheFileName;
+
+    // Use the existing cache file if it's valid, otherwise read the filesystem from the disc and save it
+    if (loadFromIndexCache(*this, cacheFilePath.c_str(), discKey))
+        return true;
+
+    if (!build(discReader))
+        return false;
+
+    saveToIndexCache(*this, cacheFilePath.c_str(), discKey);
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Builds the hashed index of full paths to filesystem entries, used to lookup paths relative to the root.
+// Note: names are truncated and made unique by the disc mastering process, but if there are duplicates then the first entry wins.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void IsoFileSys::buildPathIndex() noexcept {
+    pathIndex.clear();
+    pathIndex.reserve(entries.size());
+
+    std::vector<std::string> entryPaths(entries.size());
+
+    // Note: parent entries always come before their children, since directories are read in breadth first order
+    for (int32_t entryIdx = 1; entryIdx < (int32_t) entries.size(); ++entryIdx) {
+        const IsoFileSysEntry& entry = entries[entryIdx];
+        std::string& path = entryPaths[entryIdx];
+
+        if (entry.parentIdx != 0) {
+            path = entryPaths[entry.parentIdx];
+            path += '/';
+        }
+
+        for (uint32_t charIdx = 0; charIdx < entry.nameLen; ++charIdx) {
+            path += (char) std::toupper(entry.name[charIdx]);
+        }
+
+        pathIndex.emplace(path, entryIdx);
+    }
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Lookup the index of the file system entry for the given path (case insensitive), relative to the root of the filesystem.
 // Returns '-1' if the file system entry is not found.
 //------------------------------------------------------------------------------------------------------------------------------------------
 int32_t IsoFileSys::getEntryIndex(const char* const path) const noexcept {
-    return (!entries.empty()) ? getEntryIndex(entries[0], path) : -1;
+    if (entries.empty())
+        return -1;
+
+    // Fallback to searching the directory tree if there is no path index
+    if (pathIndex.empty())
+        return getEntryIndex(entries[0], path);
+
+    // Convert the path to the format used by the path index and look it up
+    std::string indexPath;
+
+    if (!makeIndexPath(path, indexPath))
+        return -1;
+
+    const auto iter = pathIndex.find(indexPath);
+    return (iter != pathIndex.end()) ? iter->second : -1;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -3,6 +3,8 @@
 #include "Macros.h"
 
 #include <cstdint>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 class DiscReader;
@@ -27,15 +29,21 @@ struct IsoFileSysEntry {
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Contains the ISO 9660 filesystem for a game disc and allows lookup of files.
 // Note that the filesystem entries are cut down to just the attributes we are interested in.
+// Paths relative to the filesystem root are looked up via a hashed index of all the full paths in the filesystem.
+// Optionally the filesystem entries can be saved to a cache file, so that the directory tree doesn't need to be read on later launches.
 //------------------------------------------------------------------------------------------------------------------------------------------
 struct IsoFileSys {
     static constexpr uint32_t MIN_LOGICAL_BLOCK_SIZE = 2048;    // Minimum allowed logical sector size
     static constexpr uint32_t MAX_LOGICAL_BLOCK_SIZE = 2352;    // Maximum allowed logical sector size
 
-    uint32_t                        logicalBlockSize;   // Size of a logical sector for the CD-ROM's data track: normally 2,048 bytes
-    std::vector<IsoFileSysEntry>    entries;            // All the entries in the file system: the root entry is the first
+    uint32_t                                    logicalBlockSize;   // Size of a logical sector for the CD-ROM's data track: normally 2,048 bytes
+    uint64_t                                    discKey;            // Hash identifying the disc (for cache files), or '0' if not known
+    std::vector<IsoFileSysEntry>                entries;            // All the entries in the file system: the root entry is the first
+    std::unordered_map<std::string, int32_t>    pathIndex;          // Full upper case path of each entry (using '/' separators) to entry index
 
     bool build(DiscReader& discReader) noexcept;
+    bool build(DiscReader& discReader, const char* const indexCacheDir) noexcept;
+    void buildPathIndex() noexcept;
     int32_t getEntryIndex(const char* const path) const noexcept;
     int32_t getEntryIndex(const IsoFileSysEntry& root, const char* const path) const noexcept;
     const IsoFileSysEntry* getEntry(const char* const path) const noexcept;
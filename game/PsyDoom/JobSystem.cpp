@@ -0,0 +1,212 @@
+//------------------------------------------------------------------------------------------------------------------------------------------
+// A very simple job system which runs batches of small, independent jobs across a pool of worker threads.
+//
+// Worker threads sleep until a batch of jobs is submitted via 'runJobs'. The calling thread then also helps out with the batch and does not
+// return until every job in the batch is done. Jobs are claimed in small groups via an atomic counter, so there are no queues to manage.
+// Jobs must only read shared state, or write to state which no other job in the batch touches.
+// Batches of a few large jobs can also be run, where each job is claimed individually so that the work is spread out as evenly as possible.
+//------------------------------------------------------------------------------------------------------------------------------------------
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+BEGIN_NAMESPACE(JobSystem)
+
+// How many jobs are claimed at once by a thread working on a batch
+static constexpr uint32_t JOB_GROUP_SIZE = 8;
+
+static std::vector<std::thread>     gWorkerThreads;         // All the worker threads in the job system
+static std::mutex                   gMutex;                 // Guards the batch details below
+static std::condition_variable      gBatchStartedCV;        // Signalled when a new batch of jobs is started or on shutdown
+static uint32_t                     gBatchNum;              // Incremented each time a new batch of jobs is started
+static bool                         gbShutdown;             // Set when the worker threads should exit
+static JobFunc                      gBatchJobFunc;          // The function to run for each job in the current batch
+static void*                        gpBatchUserData;        // User data passed to each job in the current batch
+static uint32_t                     gBatchNumJobs;          // How many jobs there are in the current batch
+static uint32_t                     gBatchJobGroupSize;     // How many jobs are claimed at once in the current batch
+static std::atomic<uint32_t>        gBatchNextJob;          // Index of the next unclaimed job in the current batch
+static std::atomic<uint32_t>        gBatchNumJobsDone;      // How many jobs have been completed in the current batch
+static std::atomic<uint32_t>        gNumBusyWorkers;        // How many worker threads are currently working on a batch
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Claims and does jobs from the current batch until there are none left to claim
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void doBatchJobs(const JobFunc jobFunc, void* const pUserData, const uint32_t numJobs, const uint32_t jobGroupSize) noexcept {
+    while (true) {
+        const uint32_t startJob = gBatchNextJob.fetch_add(jobGroupSize, std::memory_order_relaxed);
+
+        if (startJob >= numJobs)
+            break;
+
+        const uint32_t endJob = std::min(startJob + jobGroupSize, numJobs);
+
+        for (uint32_t jobIdx = startJob; jobIdx < endJob; ++jobIdx) {
+            jobFunc(jobIdx, pUserData);
+        }
+
+        gBatchNumJobsDone.fetch_add(endJob - startJob, std::memory_order_release);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Main loop for a worker thread: applies the thread settings given, then waits for batches of jobs and helps with them until shutdown
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void workerThreadMain(const ThreadUtils::ThreadSettings threadSettings) noexcept {
+    ThreadUtils::applyToCurrentThread(threadSettings);
+    uint32_t lastBatchNum = 0;
+
+    while (true) {
+        JobFunc jobFunc;
+        void* pUserData;
+        uint32_t numJobs;
+        uint32_t jobGroupSize;
+
+        {
+            std::unique_lock lock(gMutex);
+            gBatchStartedCV.wait(lock, [&]() noexcept { return (gbShutdown || (gBatchNum != lastBatchNum)); });
+
+            if (gbShutdown)
+                return;
+
+            lastBatchNum = gBatchNum;
+            jobFunc = gBatchJobFunc;
+            pUserData = gpBatchUserData;
+            numJobs = gBatchNumJobs;
+            jobGroupSize = gBatchJobGroupSize;
+
+            // Nothing to do if we woke up too late and the batch is already finished
+            if (numJobs == 0)
+                continue;
+
+            gNumBusyWorkers.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        doBatchJobs(jobFunc, pUserData, numJobs, jobGroupSize);
+        gNumBusyWorkers.fetch_sub(1, std::memory_order_release);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Starts up the job system with the given number of worker threads, using the given priority and CPU core settings for them.
+// If the number is negative then one worker thread is created for each hardware thread (other than the calling thread).
+// If the workers are restricted to certain cores then instead one is created for each of those cores which the calling thread is not
+// restricted to, as given by the caller's core mask ('0' if unrestricted). At least one worker is created in that case.
+// If the number is zero then no worker threads are created and all jobs run on the calling thread.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void init(const int32_t numWorkerThreads, const ThreadUtils::ThreadSettings& workerThreadSettings, const uint64_t callerCoreMask) noexcept {
+    shutdown();
+
+    uint32_t numThreads = (uint32_t) numWorkerThreads;
+
+    if (numWorkerThreads < 0) {
+        if (workerThreadSettings.coreMask != 0) {
+            numThreads = std::max(ThreadUtils::getNumCores(workerThreadSettings.coreMask & (~callerCoreMask)), 1u);
+        } else {
+            numThreads = std::max(std::thread::hardware_concurrency(), 1u) - 1;
+        }
+    }
+
+    gbShutdown = false;
+    gWorkerThreads.reserve(numThreads);
+
+    for (uint32_t threadIdx = 0; threadIdx < numThreads; ++threadIdx) {
+        gWorkerThreads.emplace_back(workerThreadMain, workerThreadSettings);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Stops and destroys all worker threads
+//------------------------------------------------------------------------------------------------------------------------------------------
+void shutdown() noexcept {
+    {
+        std::lock_guard lock(gMutex);
+        gbShutdown = true;
+    }
+
+    gBatchStartedCV.notify_all();
+
+    for (std::thread& thread : gWorkerThreads) {
+        thread.join();
+    }
+
+    gWorkerThreads.clear();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Returns how many worker threads the job system has (not including the thread which submits jobs)
+//------------------------------------------------------------------------------------------------------------------------------------------
+uint32_t getNumWorkerThreads() noexcept {
+    return (uint32_t) gWorkerThreads.size();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Runs a batch of jobs across all worker threads, with threads claiming the given number of jobs at a time.
+// The calling thread participates in the work and this function only returns once all of the jobs are done.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void runJobBatch(const uint32_t numJobs, const JobFunc jobFunc, void* const pUserData, const uint32_t jobGroupSize) noexcept {
+    if (numJobs == 0)
+        return;
+
+    // If there are no worker threads or not enough jobs to share out then just run them here
+    if (gWorkerThreads.empty() || (numJobs <= jobGroupSize)) {
+        for (uint32_t jobIdx = 0; jobIdx < numJobs; ++jobIdx) {
+            jobFunc(jobIdx, pUserData);
+        }
+
+        return;
+    }
+
+    // Start the batch and wake up the workers
+    {
+        std::lock_guard lock(gMutex);
+        gBatchJobFunc = jobFunc;
+        gpBatchUserData = pUserData;
+        gBatchNumJobs = numJobs;
+        gBatchJobGroupSize = jobGroupSize;
+        gBatchNextJob.store(0, std::memory_order_relaxed);
+        gBatchNumJobsDone.store(0, std::memory_order_relaxed);
+        gBatchNum++;
+    }
+
+    gBatchStartedCV.notify_all();
+
+    // Help with the batch, then wait for any jobs still in progress on other threads to finish
+    doBatchJobs(jobFunc, pUserData, numJobs, jobGroupSize);
+
+    while (gBatchNumJobsDone.load(std::memory_order_acquire) < numJobs) {
+        std::this_thread::yield();
+    }
+
+    // Close off the batch so that workers which wake up late don't join it, and wait for all workers to leave it.
+    // This ensures no worker can claim jobs from the next batch using the details of this one.
+    {
+        std::lock_guard lock(gMutex);
+        gBatchNumJobs = 0;
+    }
+
+    while (gNumBusyWorkers.load(std::memory_order_acquire) > 0) {
+        std::this_thread::yield();
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Runs the specified number of jobs with the given job function and user data, spreading the jobs across all worker threads.
+// The calling thread participates in the work and this function only returns once all of the jobs are done.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void runJobs(const uint32_t numJobs, const JobFunc jobFunc, void* const pUserData) noexcept {
+    runJobBatch(numJobs, jobFunc, pUserData, JOB_GROUP_SIZE);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Same as 'runJobs' but for a small number of large jobs: each job is claimed individually so the work is spread out more evenly.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void runLargeJobs(const uint32_t numJobs, const JobFunc jobFunc, void* const pUserData) noexcept {
+    runJobBatch(numJobs, jobFunc, pUserData, 1);
+}
+
+END_NAMESPACE(JobSystem)
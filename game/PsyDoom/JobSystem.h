@@ -0,0 +1,20 @@
+#pragma once
+
+#include "Macros.h"
+#include "ThreadUtils.h"
+
+#include <cstdint>
+
+BEGIN_NAMESPACE(JobSystem)
+
+// Signature for a function which does one job in a batch of jobs.
+// Receives the index of the job in the batch, and the user data pointer given for the batch.
+typedef void (*JobFunc)(const uint32_t jobIdx, void* const pUserData) noexcept;
+
+void init(const int32_t numWorkerThreads, const ThreadUtils::ThreadSettings& workerThreadSettings, const uint64_t callerCoreMask) noexcept;
+void shutdown() noexcept;
+uint32_t getNumWorkerThreads() noexcept;
+void runJobs(const uint32_t numJobs, const JobFunc jobFunc, void* const pUserData) noexcept;
+void runLargeJobs(const uint32_t numJobs, const JobFunc jobFunc, void* const pUserData) noexcept;
+
+END_NAMESPACE(JobSystem)
@@ -10,6 +10,15 @@
 
 BEGIN_NAMESPACE(LIBGPU_CmdDispatch)
 
+// Used to mark the saved texture page and CLUT ids below as not matching the state of the GPU
+static constexpr uint32_t INVALID_STATE_ID = UINT32_MAX;
+
+// The texture page and CLUT ids that the GPU state was last set from.
+// Most primitives submitted in a row share the same texture and CLUT, so this lets us skip decoding the ids again for those primitives.
+// Note: only the functions in this module (and LIBGPU via them) change these parts of the GPU state, so the saved ids can't go stale.
+static uint32_t gGpuTexPageId = INVALID_STATE_ID;
+static uint32_t gGpuClutId = INVALID_STATE_ID;
+
 #if PSYDOOM_VULKAN_RENDERER
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -60,10 +69,24 @@ static void doSetupForVkRendererTexturedDraw(const bool bBlendPrimitive, uint16_
 
 #endif  // #if PSYDOOM_VULKAN_RENDERER
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Forget which texture page and CLUT ids the GPU state was last set from.
+// Must be called whenever the GPU is (re)initialized, since that resets the GPU state.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void resetGpuStateIds() noexcept {
+    gGpuTexPageId = INVALID_STATE_ID;
+    gGpuClutId = INVALID_STATE_ID;
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Set the GPU texture page, texture format, and blending (semi-transparency) mode from a 16-bit word as encoded by LIBGPU
 //------------------------------------------------------------------------------------------------------------------------------------------
 void setGpuTexPageId(const uint16_t texPageId) noexcept {
+    // Don't bother decoding the id again if the GPU state is already set from it
+    if (texPageId == gGpuTexPageId)
+        return;
+
+    gGpuTexPageId = texPageId;
     Gpu::Core& gpu = PsxVm::gGpu;
 
     // Set texture format
@@ -101,6 +124,11 @@ void setGpuTexPageId(const uint16_t texPageId) noexcept {
 // Set the GPU CLUT position, from a 16-bit word as encoded by LIBGPU
 //------------------------------------------------------------------------------------------------------------------------------------------
 void setGpuClutId(const uint16_t clutId) noexcept {
+    // Don't bother decoding the id again if the GPU state is already set from it
+    if (clutId == gGpuClutId)
+        return;
+
+    gGpuClutId = clutId;
     Gpu::Core& gpu = PsxVm::gGpu;
     const uint16_t clutX = (clutId & 0x3Fu) << 4;       // Clut X position is restricted to multiples of 16
     const uint16_t clutY = (clutId >> 6u) & 0xFFFu;
@@ -272,6 +300,88 @@ void submit(const SPRT& sprite) noexcept {
     }
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Handle a command to draw a group of variable sized sprites which all share the same CLUT and primitive flags (shading, blending, masking).
+// The result is the same as submitting each sprite individually, but the GPU state and Vulkan draw pipeline only need to be setup once.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void submit(const SPRT* const pSprites, const uint32_t numSprites) noexcept {
+    if (numSprites <= 0)
+        return;
+
+    Gpu::Core& gpu = PsxVm::gGpu;
+
+    // Set the CLUT to use and masking mode: these must be the same for all the sprites
+    const SPRT& firstSprite = pSprites[0];
+    setGpuClutId(firstSprite.clut);
+    setGpuMaskingMode(firstSprite);
+
+    const bool bColorSprite = ((firstSprite.code & 0x1) == 0);
+    const bool bBlendSprite = (firstSprite.code & 0x2);
+
+    // Are we using the Vulkan renderer? If so submit via that, in the same way as for single sprites.
+    #if PSYDOOM_VULKAN_RENDERER
+        if (Video::isUsingVulkanRenderPath()) {
+            if (VRenderer::isRendering()) {
+                uint16_t texPageX = gpu.texPageX;
+                uint16_t texPageY = gpu.texPageY;
+                uint8_t drawAlpha = {};
+                doSetupForVkRendererTexturedDraw(bBlendSprite, texPageX, drawAlpha);
+
+                const uint16_t texWinX = texPageX + gpu.texWinX;
+                const uint16_t texWinY = texPageY + gpu.texWinY;
+
+                for (uint32_t i = 0; i < numSprites; ++i) {
+                    const SPRT& sprite = pSprites[i];
+                    ASSERT((sprite.clut == firstSprite.clut) && (sprite.code == firstSprite.code));
+
+                    VDrawing::addUISprite(
+                        sprite.x0,
+                        sprite.y0,
+                        sprite.w,
+                        sprite.h,
+                        0,
+                        0,
+                        (bColorSprite) ? sprite.r0 : 128,
+                        (bColorSprite) ? sprite.g0 : 128,
+                        (bColorSprite) ? sprite.b0 : 128,
+                        drawAlpha,
+                        gpu.clutX,
+                        gpu.clutY,
+                        texWinX + sprite.u0,
+                        texWinY + sprite.v0,
+                        sprite.w,
+                        sprite.h
+                    );
+                }
+            }
+
+            return;
+        }
+    #endif  // #if PSYDOOM_VULKAN_RENDERER
+
+    for (uint32_t i = 0; i < numSprites; ++i) {
+        const SPRT& sprite = pSprites[i];
+        ASSERT((sprite.clut == firstSprite.clut) && (sprite.code == firstSprite.code));
+
+        Gpu::DrawRect drawRect = {};
+        drawRect.x = sprite.x0;
+        drawRect.y = sprite.y0;
+        drawRect.w = sprite.w;
+        drawRect.h = sprite.h;
+        drawRect.u = sprite.u0;
+        drawRect.v = sprite.v0;
+        drawRect.color.comp.r = (bColorSprite) ? sprite.r0 : 128;
+        drawRect.color.comp.g = (bColorSprite) ? sprite.g0 : 128;
+        drawRect.color.comp.b = (bColorSprite) ? sprite.b0 : 128;
+
+        if (bBlendSprite) {
+            Gpu::draw<Gpu::DrawMode::TexturedBlended>(gpu, drawRect);
+        } else {
+            Gpu::draw<Gpu::DrawMode::Textured>(gpu, drawRect);
+        }
+    }
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Handle a command to draw an 8x8 pixel sprite
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -655,4 +765,30 @@ void submit(const WALLCOL_GT& col) noexcept {
     }
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Handle a command to draw a flat colored and untextured column of pixels.
+// Note: this function does not support pass-through to the Vulkan renderer; it's not needed since it's just ussed by the Classic renderer.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void submit(const WALLCOL_F& col) noexcept {
+    Gpu::Core& gpu = PsxVm::gGpu;
+    setGpuMaskingMode(col);
+
+    // Setup the column to be drawn then submit to the GPU
+    const bool bBlendCol = (col.code & 0x2);
+
+    Gpu::DrawWallCol drawCol = {};
+    drawCol.y1 = col.y0;
+    drawCol.y2 = col.y1;
+    drawCol.x = col.x0;
+    drawCol.color.comp.r = col.r0;
+    drawCol.color.comp.g = col.g0;
+    drawCol.color.comp.b = col.b0;
+
+    if (bBlendCol) {
+        Gpu::draw<Gpu::DrawMode::ColoredBlended>(gpu, drawCol);
+    } else {
+        Gpu::draw<Gpu::DrawMode::Colored>(gpu, drawCol);
+    }
+}
+
 END_NAMESPACE(LIBGPU_CmdDispatch)
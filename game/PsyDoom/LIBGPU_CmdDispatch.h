@@ -11,6 +11,7 @@
 BEGIN_NAMESPACE(LIBGPU_CmdDispatch)
 
 // Helpers to set GPU state
+void resetGpuStateIds() noexcept;
 void setGpuTexPageId(const uint16_t texPageId) noexcept;
 void setGpuClutId(const uint16_t clutId) noexcept;
 void setGpuTexWin(const uint32_t texWin) noexcept;
@@ -19,6 +20,7 @@ void setGpuTexWin(const uint32_t texWin) noexcept;
 void submit(const DR_MODE& drawMode) noexcept;
 void submit(const DR_TWIN& texWin) noexcept;
 void submit(const SPRT& sprite) noexcept;
+void submit(const SPRT* const pSprites, const uint32_t numSprites) noexcept;
 void submit(const SPRT_8& sprite8) noexcept;
 void submit(const LINE_F2& line) noexcept;
 void submit(const POLY_FT3& poly) noexcept;
@@ -26,5 +28,6 @@ void submit(const POLY_F4& poly) noexcept;
 void submit(const POLY_FT4& poly) noexcept;
 void submit(const FLOORROW_FT& row) noexcept;
 void submit(const WALLCOL_GT& col) noexcept;
+void submit(const WALLCOL_F& col) noexcept;
 
 END_NAMESPACE(LIBGPU_CmdDispatch)
@@ -22,7 +22,7 @@ BEGIN_NAMESPACE(Launcher)
 static void makeSettingSection(const int x, const int y) noexcept {
     // Container frame
     new Fl_Box(FL_NO_BOX, x, y, 300, 30, "Audio settings");
-    new Fl_Box(FL_THIN_DOWN_BOX, x, y + 30, 300, 100, "");
+    new Fl_Box(FL_THIN_DOWN_BOX, x, y + 30, 300, 130, "");
 
     // Audio buffer size
     {
@@ -51,6 +51,13 @@ static void makeSettingSection(const int x, const int y) noexcept {
             pInput->deactivate();
         #endif
     }
+
+    // Audio thread priority boost
+    {
+        const auto pCheck = makeFl_Check_Button(x + 20, y + 110, 120, 30, "  High priority audio thread");
+        bindConfigField<Config::gbAudioThreadHighPriority, Config::gbNeedSave_Audio>(*pCheck);
+        pCheck->tooltip(ConfigSerialization::gConfig_Audio.audioThreadHighPriority.comment);
+    }
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -182,7 +182,7 @@ static void makeCueFileSelector(Tab_Launcher& tab, const int lx, const int rx, c
     const auto pLabel_cue = new Fl_Box(FL_NO_BOX, lx, ty, 150, 30, "Game disc");
     pLabel_cue->align(FL_ALIGN_LEFT | FL_ALIGN_INSIDE);
     pLabel_cue->tooltip(
-        "Path to the game disc's .cue file.\n"
+        "Path to the game disc's .cue (or .chd) file.\n"
         "\n"
         "The game disc supplied must be PlayStation 'Doom', 'Final Doom', or any other supported disc.\n"
         "See PsyDoom's main README.md file for a list of all supported game discs.\n"
@@ -210,7 +210,7 @@ static void makeCueFileSelector(Tab_Launcher& tab, const int lx, const int rx, c
             Tab_Launcher& tab = *(Tab_Launcher*) pUserData;
 
             const auto pFileChooser = std::make_unique<Fl_Native_File_Chooser>();
-            pFileChooser->filter("CUE Sheet Files\t*.{cue}");
+            pFileChooser->filter("Disc Image Files\t*.{cue,chd}");
             pFileChooser->type(Fl_Native_File_Chooser::BROWSE_FILE);
             pFileChooser->title("Choose a game disc .cue file");
 
@@ -0,0 +1,106 @@
+#include "LumpNameIndex.h"
+
+#include "WadFile.h"
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Hashes a lump name and returns the slot index to start probing at in a hash table of '2^(64 - hashShift)' slots
+//------------------------------------------------------------------------------------------------------------------------------------------
+static inline uint32_t getHashSlotIdx(const uint64_t name, const uint32_t hashShift) noexcept {
+    return (uint32_t)((name * 0x9E3779B97F4A7C15ull) >> hashShift);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Creates an empty lump name index
+//------------------------------------------------------------------------------------------------------------------------------------------
+LumpNameIndex::LumpNameIndex() noexcept
+    : mSlots()
+    , mNextLumpIdx()
+    , mHashShift(64)
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Builds the index for the given list of lump names, replacing any previous index contents
+//------------------------------------------------------------------------------------------------------------------------------------------
+void LumpNameIndex::build(const WadLumpName* const pLumpNames, const int32_t numLumps) noexcept {
+    clear();
+
+    if (numLumps <= 0)
+        return;
+
+    // Size the table so that it is always less than half full, which keeps probe sequences short
+    uint32_t numSlotsLog2 = 1;
+
+    while ((1u << numSlotsLog2) < (uint32_t) numLumps * 2) {
+        ++numSlotsLog2;
+    }
+
+    const uint32_t numSlots = 1u << numSlotsLog2;
+    const uint32_t slotMask = numSlots - 1;
+    mHashShift = 64 - numSlotsLog2;
+    mSlots.resize(numSlots, Slot{ 0, -1 });
+    mNextLumpIdx.resize((size_t) numLumps, -1);
+
+    // Add lumps in reverse order so that each lump with a particular name gets prepended to the chain of lumps with that name.
+    // This means the slot for a name ends up referring to the lowest index lump with the name, and the chain is in ascending order.
+    for (int32_t lumpIdx = numLumps - 1; lumpIdx >= 0; --lumpIdx) {
+        const uint64_t name = pLumpNames[lumpIdx].word() & WAD_LUMPNAME_MASK;
+
+        for (uint32_t slotIdx = getHashSlotIdx(name, mHashShift);; slotIdx = (slotIdx + 1) & slotMask) {
+            Slot& slot = mSlots[slotIdx];
+
+            if (slot.firstLumpIdx < 0) {
+                slot.name = name;
+                slot.firstLumpIdx = lumpIdx;
+                break;
+            }
+
+            if (slot.name == name) {
+                mNextLumpIdx[lumpIdx] = slot.firstLumpIdx;
+                slot.firstLumpIdx = lumpIdx;
+                break;
+            }
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Clears the index and frees up the memory used
+//------------------------------------------------------------------------------------------------------------------------------------------
+void LumpNameIndex::clear() noexcept {
+    mSlots.clear();
+    mSlots.shrink_to_fit();
+    mNextLumpIdx.clear();
+    mNextLumpIdx.shrink_to_fit();
+    mHashShift = 64;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Returns the lowest index of a lump with the given name that is at or after the specified index.
+// If not found then '-1' will be returned.
+//------------------------------------------------------------------------------------------------------------------------------------------
+int32_t LumpNameIndex::find(const WadLumpName lumpName, const int32_t searchStartIdx) const noexcept {
+    if (mSlots.empty())
+        return -1;
+
+    const uint64_t name = lumpName.word();
+    const uint32_t slotMask = (uint32_t) mSlots.size() - 1;
+
+    for (uint32_t slotIdx = getHashSlotIdx(name, mHashShift);; slotIdx = (slotIdx + 1) & slotMask) {
+        const Slot& slot = mSlots[slotIdx];
+
+        if (slot.firstLumpIdx < 0)
+            return -1;
+
+        if (slot.name == name) {
+            // Found the name: skip past any lumps with this name which are before the search start index
+            int32_t lumpIdx = slot.firstLumpIdx;
+
+            while ((lumpIdx >= 0) && (lumpIdx < searchStartIdx)) {
+                lumpIdx = mNextLumpIdx[lumpIdx];
+            }
+
+            return lumpIdx;
+        }
+    }
+}
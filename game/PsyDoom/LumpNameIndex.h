@@ -0,0 +1,32 @@
+#pragma once
+
+#include "SmallString.h"
+
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// A hash index for quickly finding lumps by name in a list of lump names, instead of linearly searching the entire list.
+// 
+// Lookups behave exactly like a linear search: the lowest index lump with the given name at or after the search start index is returned.
+// Note: the 'compressed' flag bit in the 1st byte of lump names is ignored when building the index, as with a linear search.
+//------------------------------------------------------------------------------------------------------------------------------------------
+class LumpNameIndex {
+public:
+    LumpNameIndex() noexcept;
+
+    // Note: lump names are given as 'String8' since that is what 'WadLumpName' is, and including 'WadFile.h' would be circular
+    void build(const String8* const pLumpNames, const int32_t numLumps) noexcept;
+    void clear() noexcept;
+    int32_t find(const String8 lumpName, const int32_t searchStartIdx) const noexcept;
+
+private:
+    // A slot in the open addressing hash table: holds a lump name and the first (lowest) index of a lump with that name
+    struct Slot {
+        uint64_t    name;
+        int32_t     firstLumpIdx;   // '-1' if the slot is unused
+    };
+
+    std::vector<Slot>       mSlots;             // The hash table: the size is always a power of two
+    std::vector<int32_t>    mNextLumpIdx;       // For each lump, the next (higher) index of a lump with the same name or '-1' if none
+    uint32_t                mHashShift;         // How much to shift hashed names by to get a slot index
+};
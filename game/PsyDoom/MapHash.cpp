@@ -1,6 +1,7 @@
 //------------------------------------------------------------------------------------------------------------------------------------------
 // A module that allows for a combined MD5 hash to be computed for all of the lumps in a map file. This hash can be used purposes such as
 // ensuring players are on the same map (in a network game) or deciding when to patch original map data with a few select bug fixes.
+// A fast 128-bit content hash of the same data is also computed, for uses which don't need to match existing MD5 values.
 //------------------------------------------------------------------------------------------------------------------------------------------
 #include "MapHash.h"
 
@@ -13,18 +14,24 @@ BEGIN_NAMESPACE(MapHash)
 int32_t     gDataSize;      // Size of the map data being hashed
 uint64_t    gWord1;         // Computed hash (bytes 0-7)
 uint64_t    gWord2;         // Computed hash (bytes 8-15)
+ContentHash gContentHash;   // Computed fast content hash of the map data
 
 // This holds the state of the MD5 hasher and allows us to retrieve the current hash
 static MD5 gMD5Hasher;
 
+// The same for the fast content hash
+static ContentHasher gContentHasher;
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Clears the map hash; should be called at the start of level loading
 //------------------------------------------------------------------------------------------------------------------------------------------
 void clear() noexcept {
     gMD5Hasher.reset();
+    gContentHasher.reset();
     gDataSize = 0;
     gWord1 = {};
     gWord2 = {};
+    gContentHash = {};
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -35,12 +42,13 @@ void addData(const void* const pData, const int32_t dataSize) noexcept {
 
     if (dataSize > 0) {
         gMD5Hasher.add(pData, (size_t) dataSize);
+        gContentHasher.add(pData, (size_t) dataSize);
         gDataSize += dataSize;
     }
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Sets the 2 64-bit words of the hash.
+// Sets the 2 64-bit words of the hash and the content hash.
 // This should be done after all of the map data has been added to the hash.
 //------------------------------------------------------------------------------------------------------------------------------------------
 void finalize() noexcept {
@@ -56,6 +64,8 @@ void finalize() noexcept {
         ((uint64_t) md5[8 ] << 56) | ((uint64_t) md5[9 ] << 48) | ((uint64_t) md5[10] << 40) | ((uint64_t) md5[11] << 32) |
         ((uint64_t) md5[12] << 24) | ((uint64_t) md5[13] << 16) | ((uint64_t) md5[14] <<  8) | ((uint64_t) md5[15] <<  0)
     );
+
+    gContentHash = gContentHasher.getHash();
 }
 
 END_NAMESPACE(MapHash)
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "ContentHash.h"
 #include "Macros.h"
 
 #include <cstddef>
@@ -10,6 +11,7 @@ BEGIN_NAMESPACE(MapHash)
 extern int32_t      gDataSize;
 extern uint64_t     gWord1;
 extern uint64_t     gWord2;
+extern ContentHash  gContentHash;
 
 void clear() noexcept;
 void addData(const void* const pData, const int32_t dataSize) noexcept;
@@ -16,13 +16,18 @@
 #include "Doom/UI/ti_main.h"
 #include "MapInfo_Defaults.h"
 #include "MapInfo_Parse.h"
+#include "ContentHash.h"
+#include "FileUtils.h"
+#include "PsyDoom/Config/Config.h"
 #include "PsyDoom/Game.h"
 #include "PsyQ/LIBSPU.h"
 
 #include <algorithm>
+#include <cstdio>
 #include <cstring>
 #include <string>
 #include <memory>
+#include <type_traits>
 
 BEGIN_NAMESPACE(MapInfo)
 
@@ -40,6 +45,36 @@ static std::vector<CreditsPage>     gCredits;
 static int32_t  gLastGetMap         = -1;
 static int32_t  gLastGetMapIndex    = -1;
 
+// Identifies a binary MAPINFO cache file, and the version of the cache file format.
+// Note: the version must be bumped whenever the MAPINFO structures, the built-in defaults or the parsing rules change.
+static constexpr uint32_t CACHE_MAGIC = 0x494D4450;     // 'PDMI' in little endian
+static constexpr uint32_t CACHE_VERSION = 1;
+
+// Header for a binary MAPINFO cache file.
+// It is followed by the 'GameInfo' struct and then the music track, episode, cluster, map and credits page lists, in that order.
+struct CacheHdr {
+    uint32_t    magic;              // Should be 'CACHE_MAGIC'
+    uint32_t    version;            // Should be 'CACHE_VERSION'
+    uint64_t    key;                // Hash of the MAPINFO lump and the game the cache was built for
+    uint64_t    payloadHash;        // Hash of all the data following the header, to detect corruption
+    uint16_t    structSizes[6];     // Sizes of the 'GameInfo', 'MusicTrack', 'Episode', 'Cluster', 'Map' and 'CreditsPage' structs
+    uint32_t    numMusicTracks;
+    uint32_t    numEpisodes;
+    uint32_t    numClusters;
+    uint32_t    numMaps;
+    uint32_t    numCredits;
+};
+
+static_assert(sizeof(CacheHdr) == 56);
+
+// All of the cached structures are written to and read from the cache file as raw bytes
+static_assert(std::is_trivially_copyable_v<GameInfo>);
+static_assert(std::is_trivially_copyable_v<MusicTrack>);
+static_assert(std::is_trivially_copyable_v<Episode>);
+static_assert(std::is_trivially_copyable_v<Cluster>);
+static_assert(std::is_trivially_copyable_v<Map>);
+static_assert(std::is_trivially_copyable_v<CreditsPage>);
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Initializes a cluster with default settings
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -415,13 +450,15 @@ static void readCreditsPage(const Block& block) noexcept {
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Returns the MAPINFO lump data from the main IWAD (if available) as a C string
 //------------------------------------------------------------------------------------------------------------------------------------------
-static std::unique_ptr<char[]> readMapInfoLumpAsCString() noexcept {
+static std::unique_ptr<char[]> readMapInfoLumpAsCString(int32_t& lumpSizeOut) noexcept {
+    lumpSizeOut = 0;
     const int32_t lumpNum = W_CheckNumForName("MAPINFO");
 
     if (lumpNum < 0)
         return {};
 
     const int32_t lumpSize = std::max(W_LumpLength(lumpNum), 0);
+    lumpSizeOut = lumpSize;
     std::unique_ptr<char[]> lumpCString(new char[lumpSize + 1]);
     W_ReadLump(lumpNum, lumpCString.get(), true);
     lumpCString[lumpSize] = 0;
@@ -430,16 +467,10 @@ static std::unique_ptr<char[]> readMapInfoLumpAsCString() noexcept {
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Tries to read MAPINFO from the main IWAD, if available
+// Parses the given MAPINFO lump text and applies all of the settings in it
 //------------------------------------------------------------------------------------------------------------------------------------------
-static void readMapInfoFromIWAD() noexcept {
-    // Read the MAPINFO string (if it exists) and parse it if it's valid
-    std::unique_ptr<char[]> mapInfoStr = readMapInfoLumpAsCString();
-
-    if (!mapInfoStr)
-        return;
-
-    MapInfo mapInfo = parseMapInfo(mapInfoStr.get());
+static void readMapInfoFromLumpText(const char* const mapInfoStr) noexcept {
+    MapInfo mapInfo = parseMapInfo(mapInfoStr);
 
     // Define the list of block type readers
     struct BlockReader {
@@ -469,6 +500,174 @@ static void readMapInfoFromIWAD() noexcept {
     }
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Computes the cache key for the given MAPINFO lump text.
+// Besides the lump itself this covers everything that can affect the default MAPINFO settings which the lump is applied on top of.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static uint64_t computeCacheKey(const char* const mapInfoStr, const int32_t mapInfoSize) noexcept {
+    const uint32_t gameType = (uint32_t) Game::gGameType;
+    const uint8_t bIsDemoVersion = Game::gbIsDemoVersion;
+
+    ContentHasher hasher;
+    hasher.addValue(CACHE_VERSION);
+    hasher.addValue(gameType);
+    hasher.addValue(bIsDemoVersion);
+    hasher.addValue(mapInfoSize);
+    hasher.add(mapInfoStr, (size_t) mapInfoSize);
+    return hasher.getHash().word1;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Gets the path to the binary MAPINFO cache file with the given key in the specified cache directory
+//------------------------------------------------------------------------------------------------------------------------------------------
+static std::string getCacheFilePath(const std::string& cacheDir, const uint64_t key) noexcept {
+    char cacheFileName[32];
+    std::snprintf(cacheFileName, sizeof(cacheFileName), "%016llX.mapinfocache", (unsigned long long) key);
+
+    std::string cacheFilePath = cacheDir;
+
+    if ((!cacheFilePath.empty()) && (cacheFilePath.back() != '/') && (cacheFilePath.back() != '\\')) {
+        cacheFilePath += '/';
+    }
+
+    cacheFilePath += cacheFileName;
+    return cacheFilePath;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Fills in the struct sizes for a cache file header
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void getCacheStructSizes(uint16_t (&structSizes)[6]) noexcept {
+    structSizes[0] = (uint16_t) sizeof(GameInfo);
+    structSizes[1] = (uint16_t) sizeof(MusicTrack);
+    structSizes[2] = (uint16_t) sizeof(Episode);
+    structSizes[3] = (uint16_t) sizeof(Cluster);
+    structSizes[4] = (uint16_t) sizeof(Map);
+    structSizes[5] = (uint16_t) sizeof(CreditsPage);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tries to load all MAPINFO data from the binary cache file at the given path, returning 'true' on success.
+// The file must be valid and for the given key, otherwise it's ignored and the current MAPINFO data is left untouched.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool loadMapInfoCache(const char* const filePath, const uint64_t key) noexcept {
+    const FileData fileData = FileUtils::getContentsOfFile(filePath);
+
+    if ((!fileData.bytes) || (fileData.size < sizeof(CacheHdr)))
+        return false;
+
+    // Validate the header, including the total size of the file
+    CacheHdr hdr = {};
+    std::memcpy(&hdr, fileData.bytes.get(), sizeof(hdr));
+
+    uint16_t structSizes[6] = {};
+    getCacheStructSizes(structSizes);
+
+    const uint64_t expectedSize = (
+        (uint64_t) sizeof(CacheHdr) +
+        (uint64_t) sizeof(GameInfo) +
+        (uint64_t) sizeof(MusicTrack) * hdr.numMusicTracks +
+        (uint64_t) sizeof(Episode) * hdr.numEpisodes +
+        (uint64_t) sizeof(Cluster) * hdr.numClusters +
+        (uint64_t) sizeof(Map) * hdr.numMaps +
+        (uint64_t) sizeof(CreditsPage) * hdr.numCredits
+    );
+
+    const bool bValidHdr = (
+        (hdr.magic == CACHE_MAGIC) &&
+        (hdr.version == CACHE_VERSION) &&
+        (hdr.key == key) &&
+        (std::memcmp(hdr.structSizes, structSizes, sizeof(structSizes)) == 0) &&
+        (expectedSize == fileData.size)
+    );
+
+    if (!bValidHdr)
+        return false;
+
+    const std::byte* pData = fileData.bytes.get() + sizeof(CacheHdr);
+    const size_t payloadSize = fileData.size - sizeof(CacheHdr);
+
+    if (ContentHasher::hash(pData, payloadSize).word1 != hdr.payloadHash)
+        return false;
+
+    // Read all of the data straight into the MAPINFO structures
+    const auto readList = [&](auto& list, const uint32_t count) noexcept {
+        list.resize(count);
+        const size_t numBytes = sizeof(list[0]) * (size_t) count;
+
+        if (numBytes > 0) {
+            std::memcpy((void*) list.data(), pData, numBytes);
+        }
+
+        pData += numBytes;
+    };
+
+    std::memcpy((void*) &gGameInfo, pData, sizeof(GameInfo));
+    pData += sizeof(GameInfo);
+
+    readList(gMusicTracks, hdr.numMusicTracks);
+    readList(gEpisodes, hdr.numEpisodes);
+    readList(gClusters, hdr.numClusters);
+    readList(gMaps, hdr.numMaps);
+    readList(gCredits, hdr.numCredits);
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Saves all of the current MAPINFO data to a binary cache file at the given path.
+// The file is written to a temporary file first and then moved into place, so a partially written cache file is never used.
+// Failure to save is not an error: the MAPINFO lump will just be parsed again on the next launch.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void saveMapInfoCache(const char* const filePath, const uint64_t key) noexcept {
+    // Serialize all of the MAPINFO structures after the header
+    std::vector<std::byte> fileData(sizeof(CacheHdr));
+
+    const auto writeBytes = [&](const void* const pSrc, const size_t numBytes) noexcept {
+        if (numBytes > 0) {
+            const size_t oldSize = fileData.size();
+            fileData.resize(oldSize + numBytes);
+            std::memcpy(fileData.data() + oldSize, pSrc, numBytes);
+        }
+    };
+
+    const auto writeList = [&](const auto& list) noexcept {
+        writeBytes(list.data(), sizeof(list[0]) * list.size());
+    };
+
+    writeBytes(&gGameInfo, sizeof(GameInfo));
+    writeList(gMusicTracks);
+    writeList(gEpisodes);
+    writeList(gClusters);
+    writeList(gMaps);
+    writeList(gCredits);
+
+    // Fill in the header
+    CacheHdr hdr = {};
+    hdr.magic = CACHE_MAGIC;
+    hdr.version = CACHE_VERSION;
+    hdr.key = key;
+    hdr.payloadHash = ContentHasher::hash(fileData.data() + sizeof(CacheHdr), fileData.size() - sizeof(CacheHdr)).word1;
+    getCacheStructSizes(hdr.structSizes);
+    hdr.numMusicTracks = (uint32_t) gMusicTracks.size();
+    hdr.numEpisodes = (uint32_t) gEpisodes.size();
+    hdr.numClusters = (uint32_t) gClusters.size();
+    hdr.numMaps = (uint32_t) gMaps.size();
+    hdr.numCredits = (uint32_t) gCredits.size();
+    std::memcpy(fileData.data(), &hdr, sizeof(hdr));
+
+    // Write the file and move it into place
+    const std::string tmpFilePath = std::string(filePath) + ".tmp";
+
+    if (!FileUtils::writeDataToFile(tmpFilePath.c_str(), fileData.data(), fileData.size()))
+        return;
+
+    std::remove(filePath);
+
+    if (std::rename(tmpFilePath.c_str(), filePath) != 0) {
+        std::remove(tmpFilePath.c_str());
+    }
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Sorts the map info so that maps and episodes are in ascending order
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -490,22 +689,47 @@ static void sortMapInfo() noexcept {
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Reads the MAPINFO lump, if present from one of the main IWAD files.
 // Otherwise initializes MAPINFO to the appropriate settings for the current game (Doom or Final Doom).
+//
+// If the lump cache directory is configured then the fully parsed result of applying the MAPINFO lump is also cached there in binary form,
+// keyed by the lump contents. On later launches the cached data is loaded straight into the MAPINFO lists instead of parsing the lump again.
+// GEC format MAPINFO is never cached since it is read from multiple files on disc, not from the MAPINFO lump.
 //------------------------------------------------------------------------------------------------------------------------------------------
 void init() noexcept {
+    // Clear the cached search result for 'getMap'
+    gLastGetMap = -1;
+    gLastGetMapIndex = -1;
+
     // Read GEC format MAPINFO if required (will become the default MAPINFO if appropriate)
-    if (GecMapInfo::shouldUseGecMapInfo()) {
+    const bool bUseGecMapInfo = GecMapInfo::shouldUseGecMapInfo();
+
+    if (bUseGecMapInfo) {
         GecMapInfo::init();
     }
 
-    // Set MAPINFO to the default values then read overrides from one of the IWADs.
+    // Read the MAPINFO lump (if it exists) and try to use a previously cached result of parsing it, if possible
+    int32_t mapInfoSize = 0;
+    const std::unique_ptr<char[]> mapInfoStr = readMapInfoLumpAsCString(mapInfoSize);
+    const bool bUseCache = (mapInfoStr && (!bUseGecMapInfo) && (!Config::gLumpCacheDir.empty()));
+    const uint64_t cacheKey = (bUseCache) ? computeCacheKey(mapInfoStr.get(), mapInfoSize) : 0;
+    const std::string cacheFilePath = (bUseCache) ? getCacheFilePath(Config::gLumpCacheDir, cacheKey) : std::string();
+
+    if (bUseCache && loadMapInfoCache(cacheFilePath.c_str(), cacheKey))
+        return;
+
+    // Set MAPINFO to the default values then read overrides from the MAPINFO lump.
     // Also sort it all so it's in a good order, once we're done reading.
     setMapInfoToDefaults(gGameInfo, gEpisodes, gClusters, gMaps, gCredits, gMusicTracks);
-    readMapInfoFromIWAD();
+
+    if (mapInfoStr) {
+        readMapInfoFromLumpText(mapInfoStr.get());
+    }
+
     sortMapInfo();
 
-    // Clear the cached search result for 'getMap'
-    gLastGetMap = -1;
-    gLastGetMapIndex = -1;
+    // Save the result for next time, if caching
+    if (bUseCache) {
+        saveMapInfoCache(cacheFilePath.c_str(), cacheKey);
+    }
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -9,6 +9,8 @@
 #include "PsyDoom/Game.h"
 #include "PsyDoom/MapHash.h"
 
+#include <algorithm>
+
 BEGIN_NAMESPACE(MapPatcher)
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -32,32 +34,27 @@ static MapPatches::PatchList getGamePatchList() noexcept {
 // Try to apply patches for the current map
 //------------------------------------------------------------------------------------------------------------------------------------------
 void applyPatches() noexcept {
-    // Cache these globals locally since they will be compared a lot
+    // Cache these globals locally
     const int32_t mapSize = MapHash::gDataSize;
     const uint64_t md5Word1 = MapHash::gWord1;
     const uint64_t md5Word2 = MapHash::gWord2;
 
-    // Iterate through the list of patches and check to see which patch applies (if any)
+    // Binary search the sorted list of patches for the first patch (if any) which matches the map size and MD5 of the map data
     const MapPatches::PatchList patchList = getGamePatchList();
+    const MapPatches::PatchDef* const pPatchesBeg = patchList.pPatches;
+    const MapPatches::PatchDef* const pPatchesEnd = patchList.pPatches + patchList.numPatches;
 
-    for (uint32_t patchIdx = 0; patchIdx < patchList.numPatches; ++patchIdx) {
-        const MapPatches::PatchDef& patch = patchList.pPatches[patchIdx];
-
-        // Expect all patch definitions to have a valid function!
-        ASSERT(patch.patcherFunc);
+    const MapPatches::PatchDef searchKey = { mapSize, md5Word1, md5Word2, nullptr };
+    const MapPatches::PatchDef* const pPatch = std::lower_bound(pPatchesBeg, pPatchesEnd, searchKey, MapPatches::isPatchKeyLess);
 
-        // Wrong map data size?
-        if (mapSize != patch.mapSize)
-            continue;
+    if ((pPatch == pPatchesEnd) || (pPatch->mapSize != mapSize) || (pPatch->md5Word1 != md5Word1) || (pPatch->md5Word2 != md5Word2))
+        return;
 
-        // Wrong MD5 hash for all the map data?
-        if ((md5Word1 != patch.md5Word1) || (md5Word2 != patch.md5Word2))
-            continue;
+    // Expect all patch definitions to have a valid function!
+    ASSERT(pPatch->patcherFunc);
 
-        // Match, apply the patch and abort the search:
-        patch.patcherFunc();
-        break;
-    }
+    // Match, apply the patch:
+    pPatch->patcherFunc();
 }
 
 END_NAMESPACE(MapPatcher)
@@ -7,6 +7,8 @@
 #include "PsyDoom/Config/Config.h"
 #include "PsyDoom/Game.h"
 
+#include <array>
+#include <cstddef>
 #include <cstdint>
 
 BEGIN_NAMESPACE(MapPatches)
@@ -28,13 +30,49 @@ struct PatchDef {
 };
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Struct containing a list of patches
+// Struct containing a list of patches.
+// The patches are sorted in ascending order of map size and then MD5 (see 'isPatchKeyLess'), so that they can be binary searched.
 //------------------------------------------------------------------------------------------------------------------------------------------
 struct PatchList {
     const PatchDef* pPatches;
     uint32_t        numPatches;
 };
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Defines the order of patches in a sorted patch list: by map size first and then by MD5
+//------------------------------------------------------------------------------------------------------------------------------------------
+inline constexpr bool isPatchKeyLess(const PatchDef& patch1, const PatchDef& patch2) noexcept {
+    if (patch1.mapSize != patch2.mapSize)
+        return (patch1.mapSize < patch2.mapSize);
+
+    if (patch1.md5Word1 != patch2.md5Word1)
+        return (patch1.md5Word1 < patch2.md5Word1);
+
+    return (patch1.md5Word2 < patch2.md5Word2);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Returns a sorted copy of the given array of patches, at compile time.
+// The sort is stable, so if two patches have the same key then the one listed first is still found first by a search.
+//------------------------------------------------------------------------------------------------------------------------------------------
+template <size_t N>
+constexpr std::array<PatchDef, N> sortPatchArray(const PatchDef (&patches)[N]) noexcept {
+    std::array<PatchDef, N> sortedPatches = {};
+
+    for (size_t i = 0; i < N; ++i) {
+        // Insertion sort: shift all patches with a greater key up by one slot and insert the new patch in the gap
+        size_t j = i;
+
+        for (; (j > 0) && isPatchKeyLess(patches[i], sortedPatches[j - 1]); --j) {
+            sortedPatches[j] = sortedPatches[j - 1];
+        }
+
+        sortedPatches[j] = patches[i];
+    }
+
+    return sortedPatches;
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // The list of patches for each game type
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -1127,7 +1127,7 @@ static void patchMap_TheMansion() noexcept {
 //------------------------------------------------------------------------------------------------------------------------------------------
 // All of the map patches for this game type
 //------------------------------------------------------------------------------------------------------------------------------------------
-static const PatchDef gPatchArray_Doom[] = {
+static constexpr PatchDef gPatchArray_Doom[] = {
     {  56435, 0x7921ADB466CEE45E, 0x4476F208866BF8A7, patchMap_Hangar               },      // MAP01
     { 119369, 0x4ED7CD6367900B52, 0x9609E85DB101DC09, patchMap_Plant                },      // MAP02
     { 110284, 0x9BFF3A037128D1CA, 0x12F445D3F9B8BAC6, patchMap_ToxinRefinery        },      // MAP03
@@ -1189,6 +1189,9 @@ static const PatchDef gPatchArray_Doom[] = {
     {  79441, 0x0ECE269F1AA74445, 0x0B254FDF53895D4F, applyOriginalMapCommonPatches },      // MAP59
 };
 
-const PatchList gPatches_Doom = { gPatchArray_Doom, C_ARRAY_SIZE(gPatchArray_Doom) };
+// The same patches sorted by map size and MD5 for fast lookup
+static constexpr auto gSortedPatchArray_Doom = sortPatchArray(gPatchArray_Doom);
+
+const PatchList gPatches_Doom = { gSortedPatchArray_Doom.data(), (uint32_t) gSortedPatchArray_Doom.size() };
 
 END_NAMESPACE(MapPatches)
@@ -760,7 +760,7 @@ static void patchMap_Onslaught() noexcept {
 //------------------------------------------------------------------------------------------------------------------------------------------
 // All of the map patches for this game type
 //------------------------------------------------------------------------------------------------------------------------------------------
-static const PatchDef gPatchArray_FinalDoom[] = {
+static constexpr PatchDef gPatchArray_FinalDoom[] = {
     { 149065, 0xEB9558B4F55AB3B1, 0xEFF704814B4411D6, applyOriginalMapCommonPatches },      // MAP01
     { 117111, 0xADAA213B6086EE11, 0x978D2CC01B168F5D, applyOriginalMapCommonPatches },      // MAP02 (NTSC)
     { 117187, 0xAA3783F676D9B0CE, 0x9DE393E81F9FF509, applyOriginalMapCommonPatches },      // MAP02 (PAL, why different?)
@@ -795,6 +795,9 @@ static const PatchDef gPatchArray_FinalDoom[] = {
     { 110131, 0x2C157281E504283E, 0x914845A33B9F0503, patchMap_Onslaught            },      // MAP30
 };
 
-const PatchList gPatches_FinalDoom = { gPatchArray_FinalDoom, C_ARRAY_SIZE(gPatchArray_FinalDoom) };
+// The same patches sorted by map size and MD5 for fast lookup
+static constexpr auto gSortedPatchArray_FinalDoom = sortPatchArray(gPatchArray_FinalDoom);
+
+const PatchList gPatches_FinalDoom = { gSortedPatchArray_FinalDoom.data(), (uint32_t) gSortedPatchArray_FinalDoom.size() };
 
 END_NAMESPACE(MapPatches)
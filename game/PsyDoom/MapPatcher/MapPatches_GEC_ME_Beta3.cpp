@@ -958,7 +958,7 @@ static void patchMap_Go2It() noexcept {
 //------------------------------------------------------------------------------------------------------------------------------------------
 // All of the map patches for this game type
 //------------------------------------------------------------------------------------------------------------------------------------------
-static const PatchDef gPatchArray_GEC_ME_Beta3[] = {
+static constexpr PatchDef gPatchArray_GEC_ME_Beta3[] = {
     { 122147, 0x794F1DDCA63477CF, 0x7167BA833E4218A9, patchMap_PhobosMissionControl },      // MAP01
     { 120087, 0x6CF71CAD6729761C, 0xB9AADBB88CC49757, patchMap_ForgottenSewers },           // MAP02
     {  22539, 0x099E3E7CAA75ED61, 0x6469C4CCE5F8A33D, patchMap_HellKeep },                  // MAP04
@@ -1012,6 +1012,9 @@ static const PatchDef gPatchArray_GEC_ME_Beta3[] = {
     {  97336, 0x7DBB35F7DE4902C0, 0x93F71E0D6A338D71, patchMap_Go2It },                     // MAP94
 };
 
-const PatchList gPatches_GEC_ME_Beta3 = { gPatchArray_GEC_ME_Beta3, C_ARRAY_SIZE(gPatchArray_GEC_ME_Beta3) };
+// The same patches sorted by map size and MD5 for fast lookup
+static constexpr auto gSortedPatchArray_GEC_ME_Beta3 = sortPatchArray(gPatchArray_GEC_ME_Beta3);
+
+const PatchList gPatches_GEC_ME_Beta3 = { gSortedPatchArray_GEC_ME_Beta3.data(), (uint32_t) gSortedPatchArray_GEC_ME_Beta3.size() };
 
 END_NAMESPACE(MapPatches)
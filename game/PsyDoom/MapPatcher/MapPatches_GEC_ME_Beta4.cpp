@@ -461,7 +461,7 @@ static void patchMap_Go2It() noexcept {
 //------------------------------------------------------------------------------------------------------------------------------------------
 // All of the map patches for this game type
 //------------------------------------------------------------------------------------------------------------------------------------------
-static const PatchDef gPatchArray_GEC_ME_Beta4[] = {
+static constexpr PatchDef gPatchArray_GEC_ME_Beta4[] = {
     {  20001, 0x51BD8C31DAE5DC9C, 0x0160232923A6BA2D, patchMap_HellKeep },                      // MAP04
     { 160332, 0x013F3B27435F706B, 0xA99F122A12E2E3EE, patchMap_Sheol },                         // MAP11
     { 173712, 0x93D4D689C51DEF47, 0x9F26A30E8101CF37, patchMap_PathsOfWretchedness },           // MAP13
@@ -496,6 +496,9 @@ static const PatchDef gPatchArray_GEC_ME_Beta4[] = {
     {  95297, 0x7933332EEC490012, 0x31A3577166916A83, patchMap_Go2It },                         // MAP109
 };
 
-const PatchList gPatches_GEC_ME_Beta4 = { gPatchArray_GEC_ME_Beta4, C_ARRAY_SIZE(gPatchArray_GEC_ME_Beta4) };
+// The same patches sorted by map size and MD5 for fast lookup
+static constexpr auto gSortedPatchArray_GEC_ME_Beta4 = sortPatchArray(gPatchArray_GEC_ME_Beta4);
+
+const PatchList gPatches_GEC_ME_Beta4 = { gSortedPatchArray_GEC_ME_Beta4.data(), (uint32_t) gSortedPatchArray_GEC_ME_Beta4.size() };
 
 END_NAMESPACE(MapPatches)
@@ -5,24 +5,48 @@
 // caches of all the textures and sprites needed for a map, arranged in nice flat files for fast CD-ROM access.
 // 
 // Instead for PsyDoom, we load all resources from the main IWAD and do it once during map load so there are no hitches during gameplay.
+//
+// Optionally sprites for map objects can also be streamed in during gameplay instead (see 'Config::gbStreamMobjSprites').
+// In that mode only the frames used by the spawn (idle) state of each thing type are loaded with the map. The remaining sprites for a thing
+// type are queued for loading once a thing of that type wakes up or comes near a player, and are then loaded gradually over the following
+// game tics. If a frame is needed before it has been loaded, then the spawn frame for the thing is drawn in its place until it's ready.
 //------------------------------------------------------------------------------------------------------------------------------------------
 #include "MobjSpritePrecacher.h"
 
+#include "Config/Config.h"
 #include "Doom/Base/i_main.h"
+#include "Doom/Base/i_texcache.h"
 #include "Doom/Base/w_wad.h"
 #include "Doom/Base/z_zone.h"
 #include "Doom/Game/g_game.h"
+#include "Doom/Game/p_maputl.h"
 #include "Doom/Game/p_tick.h"
 #include "Doom/Game/sprinfo.h"
 #include "Doom/Renderer/r_data.h"
 
+#include <algorithm>
 #include <cstring>
 #include <vector>
 
 BEGIN_NAMESPACE(MobjSpritePrecacher)
 
+// Sprite streaming: how close (in map units) a thing must get to a player before its sprites are streamed in, the maximum number of
+// (compressed) sprite bytes to load per game tic, and the maximum number of states to follow when looking for a thing's spawn frames.
+static constexpr fixed_t    STREAM_NEAR_PLAYER_DIST     = 1024 * FRACUNIT;
+static constexpr int32_t    STREAM_BYTES_PER_TIC        = 128 * 1024;
+static constexpr int32_t    MAX_SPAWN_CHAIN_STATES      = 32;
+
 static std::vector<bool>    gbCacheSprite;          // Whether to precache each sprite in the game
-static std::vector<bool>    gbCachedMobjType;       // Whether sprites were precached for each 'mobjtype_t'
+static std::vector<bool>    gbCachedSprite;         // Whether all frames for each sprite were precached (or queued for streaming)
+static std::vector<bool>    gbCachedMobjType;       // Whether sprites were precached (or queued for streaming) for each 'mobjtype_t'
+
+// Sprite streaming state: whether streaming is active for the current map, and the lumps queued for loading.
+// Lumps that are needed urgently for drawing are loaded first, followed by the main queue in order.
+static bool                     gbStreamingActive;
+static std::vector<bool>        gbLumpPending;          // Whether each lump is queued for loading and not yet loaded
+static std::vector<int32_t>     gStreamQueue;
+static size_t                   gStreamQueueIdx;        // Next lump in the stream queue to load
+static std::vector<int32_t>     gUrgentLumps;
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Clears the set of sprites to be precached and the set of map objects marked as precached
@@ -30,8 +54,16 @@ static std::vector<bool>    gbCachedMobjType;       // Whether sprites were prec
 static void clearPrecacheInfo() noexcept {
     gbCacheSprite.clear();
     gbCacheSprite.resize(gNumSprites);
+    gbCachedSprite.clear();
+    gbCachedSprite.resize(gNumSprites);
     gbCachedMobjType.clear();
     gbCachedMobjType.resize(gNumMobjInfo);
+
+    gbStreamingActive = false;
+    gbLumpPending.clear();
+    gStreamQueue.clear();
+    gStreamQueueIdx = 0;
+    gUrgentLumps.clear();
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -190,42 +222,275 @@ static void flagSpritesToPrecache() noexcept {
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Precaches all sprites that are flagged for precaching
+// Loads the specified sprite lump into memory, if it's not already loaded
 //------------------------------------------------------------------------------------------------------------------------------------------
-static void precacheSprites() noexcept {
+static void cacheSpriteLump(const int32_t sprLumpIdx) noexcept {
+    // Die with an error if the lump number is invalid, otherwise cache the sprite
+    if ((sprLumpIdx < 0) || (sprLumpIdx >= W_NumLumps())) {
+        I_Error("SprCache: bad lump num %d!", sprLumpIdx);
+    }
+
+    W_CacheLumpNum(sprLumpIdx, PU_CACHE, false);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tells if the specified sprite lump is ready to be drawn without having to load anything from disk
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool isSpriteLumpReady(const int32_t sprLumpIdx) noexcept {
+    return (W_GetLump(sprLumpIdx).pCachedData || R_GetTexForLump(sprLumpIdx).bIsCached);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Invokes the given function for all lumps in all frames of sprites which are flagged for precaching but not yet cached.
+// Marks all those sprites as cached afterwards.
+//------------------------------------------------------------------------------------------------------------------------------------------
+template <class LumpFuncT>
+static void forEachUncachedFlaggedSpriteLump(const LumpFuncT& lumpFunc) noexcept {
     // How many sprite lumps are there?
     const int32_t numSprites = gNumSprites;
 
     for (int32_t sprIdx = 0; sprIdx < numSprites; ++sprIdx) {
-        // Ignore if this sprite was not flagged to be precached
-        if (!gbCacheSprite[sprIdx])
+        // Ignore if this sprite was not flagged to be precached or if it was already done
+        if ((!gbCacheSprite[sprIdx]) || gbCachedSprite[sprIdx])
             continue;
 
-        // Otherwise cache the lumps for all sprite frames
+        // Otherwise visit the lumps for all sprite frames
+        gbCachedSprite[sprIdx] = true;
+
         const spritedef_t& spriteDef = gSprites[sprIdx];
         const spriteframe_t* const pBegFrame = spriteDef.spriteframes;
         const spriteframe_t* const pEndFrame = pBegFrame + spriteDef.numframes;
 
         for (const spriteframe_t* pFrame = pBegFrame; pFrame < pEndFrame; ++pFrame) {
             for (int32_t sprLumpIdx : pFrame->lump) {
-                // Die with an error if the lump number is invalid, otherwise cache the sprite
-                if ((sprLumpIdx < 0) || (sprLumpIdx >= W_NumLumps())) {
-                    I_Error("SprCache: bad lump num %d!", sprLumpIdx);
-                }
+                lumpFunc(sprLumpIdx);
+            }
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Precaches all sprites that are flagged for precaching
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void precacheSprites() noexcept {
+    forEachUncachedFlaggedSpriteLump(cacheSpriteLump);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Sprite streaming: queues all sprites that are flagged for precaching (and not yet cached) to be loaded during gameplay
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void queueSpritesForStreaming() noexcept {
+    forEachUncachedFlaggedSpriteLump([](const int32_t sprLumpIdx) noexcept {
+        if ((sprLumpIdx < 0) || (sprLumpIdx >= W_NumLumps())) {
+            I_Error("SprCache: bad lump num %d!", sprLumpIdx);
+        }
+
+        if (gbLumpPending[sprLumpIdx] || W_GetLump(sprLumpIdx).pCachedData)
+            return;
+
+        gbLumpPending[sprLumpIdx] = true;
+        gStreamQueue.push_back(sprLumpIdx);
+    });
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Sprite streaming: precaches the sprite frames used by the spawn (idle) state of the given thing type.
+// Follows the chain of states from the spawn state until it loops, ends or gets too long.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void precacheSpawnFrames(const mobjinfo_t& info) noexcept {
+    statenum_t stateNum = info.spawnstate;
+
+    for (int32_t i = 0; (i < MAX_SPAWN_CHAIN_STATES) && (stateNum != S_NULL); ++i) {
+        const state_t& state = gStates[stateNum];
+        const spritedef_t& spriteDef = gSprites[state.sprite];
+        const int32_t frameIdx = (int32_t)(state.frame & FF_FRAMEMASK);
 
-                W_CacheLumpNum(sprLumpIdx, PU_CACHE, false);
+        if (frameIdx < spriteDef.numframes) {
+            for (int32_t sprLumpIdx : spriteDef.spriteframes[frameIdx].lump) {
+                cacheSpriteLump(sprLumpIdx);
             }
         }
+
+        stateNum = state.nextstate;
+
+        if (stateNum == info.spawnstate)
+            break;
     }
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Called near the end of level setup to precache all the sprites needed for the map
+// Sprite streaming: precaches the spawn frames of all things in the level.
+// The rest of the sprites for each thing type are left to be streamed in when needed.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void precacheAllThingSpawnFrames() noexcept {
+    std::vector<bool> bDidTypeSpawnFrames((size_t) gNumMobjInfo);
+
+    for (const mobj_t* pMobj = gMobjHead.next; pMobj != &gMobjHead; pMobj = pMobj->next) {
+        const mobjtype_t type = pMobj->type;
+        ASSERT((size_t) type < bDidTypeSpawnFrames.size());
+
+        if (bDidTypeSpawnFrames[type] || gbCachedMobjType[type] || (type == MT_PLAYER))
+            continue;
+
+        bDidTypeSpawnFrames[type] = true;
+        precacheSpawnFrames(gMobjInfo[type]);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Sprite streaming: tells if the sprites for the given thing should be streamed in now.
+// This is the case once the thing has woken up and is chasing a target, or when it gets close enough to a player to be seen soon.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool shouldStreamMobjSprites(const mobj_t& mobj) noexcept {
+    if (mobj.target)
+        return true;
+
+    for (int32_t playerIdx = 0; playerIdx < MAXPLAYERS; ++playerIdx) {
+        const mobj_t* const pPlayerMobj = gPlayers[playerIdx].mo;
+
+        if ((!gbPlayerInGame[playerIdx]) || (!pPlayerMobj))
+            continue;
+
+        if (P_AproxDistance(pPlayerMobj->x - mobj.x, pPlayerMobj->y - mobj.y) < STREAM_NEAR_PLAYER_DIST)
+            return true;
+    }
+
+    return false;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Sprite streaming: loads the specified lump if it's still waiting to be loaded; returns the number of (compressed) bytes loaded
+//------------------------------------------------------------------------------------------------------------------------------------------
+static int32_t streamLump(const int32_t sprLumpIdx) noexcept {
+    if (!gbLumpPending[sprLumpIdx])
+        return 0;
+
+    gbLumpPending[sprLumpIdx] = false;
+
+    if (W_GetLump(sprLumpIdx).pCachedData)
+        return 0;
+
+    W_CacheLumpNum(sprLumpIdx, PU_CACHE, false);
+    return W_RawLumpLength(sprLumpIdx);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Sprite streaming: loads queued lumps until the byte budget for this tic is used up, starting with the urgently needed ones
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void streamQueuedLumps() noexcept {
+    int32_t bytesLeft = STREAM_BYTES_PER_TIC;
+
+    while ((bytesLeft > 0) && (!gUrgentLumps.empty())) {
+        bytesLeft -= streamLump(gUrgentLumps.back());
+        gUrgentLumps.pop_back();
+    }
+
+    while ((bytesLeft > 0) && (gStreamQueueIdx < gStreamQueue.size())) {
+        bytesLeft -= streamLump(gStreamQueue[gStreamQueueIdx]);
+        gStreamQueueIdx++;
+    }
+
+    // Free up the queue memory once everything has been loaded
+    if (gStreamQueueIdx >= gStreamQueue.size()) {
+        gStreamQueue.clear();
+        gStreamQueueIdx = 0;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Called near the end of level setup to precache all the sprites needed for the map.
+// If sprite streaming is enabled then only the sprites needed to show things in their spawn states are loaded for map things.
 //------------------------------------------------------------------------------------------------------------------------------------------
 void doPrecaching() noexcept {
     clearPrecacheInfo();
-    flagSpritesToPrecache();
-    precacheSprites();
+
+    if (Config::gbStreamMobjSprites) {
+        gbStreamingActive = true;
+        gbLumpPending.resize((size_t) W_NumLumps());
+        flagGeneralSpritesToPrecache();
+        precacheSprites();
+        precacheAllThingSpawnFrames();
+    } else {
+        flagSpritesToPrecache();
+        precacheSprites();
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Sprite streaming: called once per game tic to queue up sprites for things which have woken up or come near a player, and to load some
+// of the queued sprites. Does nothing if sprite streaming is not active.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void update() noexcept {
+    if (!gbStreamingActive)
+        return;
+
+    // Queue the sprites for any thing types that now need them
+    bool bFlaggedNewSprites = false;
+
+    for (const mobj_t* pMobj = gMobjHead.next; pMobj != &gMobjHead; pMobj = pMobj->next) {
+        const mobjtype_t type = pMobj->type;
+        ASSERT((size_t) type < gbCachedMobjType.size());
+
+        if (gbCachedMobjType[type] || (type == MT_PLAYER))
+            continue;
+
+        if (!shouldStreamMobjSprites(*pMobj))
+            continue;
+
+        gbCachedMobjType[type] = true;
+        flagSpritesForPrecache(type);
+        flagIndirectDependenciesForPrecache(type);
+        bFlaggedNewSprites = true;
+    }
+
+    if (bFlaggedNewSprites) {
+        queueSpritesForStreaming();
+    }
+
+    // Load some of the queued sprites
+    streamQueuedLumps();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Sprite streaming: decides which sprite lump to draw for the given thing, given the lump that it would normally be drawn with.
+// If that lump has been queued for streaming but is not loaded yet, then the thing's spawn frame is substituted (if that is ready) and the
+// lump is flagged as urgently needed. Otherwise the lump is used as-is, and is loaded immediately if required when it is drawn.
+//------------------------------------------------------------------------------------------------------------------------------------------
+int32_t getSpriteLumpToDraw(const mobj_t& thing, const int32_t sprLumpIdx, bool& bFlipSpriteOut) noexcept {
+    // Use the lump as-is if it's not waiting to be streamed in, or if it happens to be loaded already
+    if ((!gbStreamingActive) || (!gbLumpPending[sprLumpIdx]))
+        return sprLumpIdx;
+
+    if (isSpriteLumpReady(sprLumpIdx)) {
+        gbLumpPending[sprLumpIdx] = false;
+        return sprLumpIdx;
+    }
+
+    // Load the lump ahead of anything else and see if the spawn frame for the thing can be shown in the meantime
+    if (std::find(gUrgentLumps.begin(), gUrgentLumps.end(), sprLumpIdx) == gUrgentLumps.end()) {
+        gUrgentLumps.push_back(sprLumpIdx);
+    }
+
+    const mobjinfo_t& info = gMobjInfo[thing.type];
+
+    if (info.spawnstate == S_NULL)
+        return sprLumpIdx;
+
+    const state_t& spawnState = gStates[info.spawnstate];
+    const spritedef_t& spriteDef = gSprites[spawnState.sprite];
+    const int32_t frameIdx = (int32_t)(spawnState.frame & FF_FRAMEMASK);
+
+    if (frameIdx >= spriteDef.numframes)
+        return sprLumpIdx;
+
+    const spriteframe_t& spawnFrame = spriteDef.spriteframes[frameIdx];
+    const int32_t spawnLumpIdx = (int32_t) spawnFrame.lump[0];
+
+    if (!isSpriteLumpReady(spawnLumpIdx))
+        return sprLumpIdx;
+
+    bFlipSpriteOut = spawnFrame.flip[0];
+    return spawnLumpIdx;
 }
 
 END_NAMESPACE(MobjSpritePrecacher)
@@ -2,8 +2,14 @@
 
 #include "Macros.h"
 
+#include <cstdint>
+
+struct mobj_t;
+
 BEGIN_NAMESPACE(MobjSpritePrecacher)
 
 void doPrecaching() noexcept;
+void update() noexcept;
+int32_t getSpriteLumpToDraw(const mobj_t& thing, const int32_t sprLumpIdx, bool& bFlipSpriteOut) noexcept;
 
 END_NAMESPACE(MobjSpritePrecacher)
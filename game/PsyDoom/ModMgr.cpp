@@ -6,14 +6,16 @@
 #include "Asserts.h"
 #include "FileUtils.h"
 #include "IsoFileSys.h"
+#include "MappedFile.h"
 #include "ProgArgs.h"
 #include "PsxVm.h"
 #include "WadList.h"
 
 #include <algorithm>
+#include <cstring>
 #include <functional>
 #include <map>
-#include <unordered_set>
+#include <unordered_map>
 #include <vector>
 
 // MacOS: some POSIX stuff needed due to <filesystem> workaround
@@ -25,11 +27,13 @@
 #endif
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Provides a hash for a CD file ID, required so we can put it in a set
+// Provides a hash for a CD file ID, required so we can put it in a hash table.
+// Mixes the bits of each word so that names differing only in a few characters don't end up in the same buckets.
 //------------------------------------------------------------------------------------------------------------------------------------------
 template<> struct std::hash<CdFileId> {
     inline uint64_t operator()(const CdFileId& fileId) const noexcept {
-        return fileId.words[0] ^ fileId.words[1];
+        uint64_t hash = (fileId.words[0] ^ (fileId.words[1] * 0x9E3779B97F4A7C15ull)) * 0xBF58476D1CE4E5B9ull;
+        return hash ^ (hash >> 31);
     }
 };
 
@@ -38,13 +42,27 @@ BEGIN_NAMESPACE(ModMgr)
 // Maximum number of files that can be open at once by the mod manager
 static constexpr uint8_t MAX_OPEN_FILES = 16;
 
-// A set of filenames in the game that are overriden by a file in the user specified 'datadir'.
-// The names in this set are uppercased for case insensitive comparison.
-static std::unordered_set<CdFileId> gOverridenFileNames;
+// Details for a file in the user specified 'datadir' which overrides a game file
+struct OverrideFile {
+    std::string     fileName;   // Name of the file in the data dir, in its original case
+};
+
+// The files in the game that are overriden by a file in the user specified 'datadir'.
+// This is built once on init so that checking for overrides never needs to touch the disk.
+// The names used as keys are uppercased for case insensitive comparison.
+static std::unordered_map<CdFileId, OverrideFile> gOverrideFiles;
+
+// An open override file: the entire file is mapped into memory, so reads are just copies from the mapped view
+struct OpenFile {
+    bool        bIsOpen;        // Is this open file slot in use?
+    MappedFile  mappedFile;     // The mapped file data: not open for empty files
+    int32_t     size;           // Size of the file in bytes
+    int32_t     offset;         // Current IO offset in the file
+};
 
 // A list of currently open files.
 // Only a certain amount are allowed at a time:
-static std::FILE* gOpenFileSlots[MAX_OPEN_FILES] = {};
+static OpenFile gOpenFileSlots[MAX_OPEN_FILES] = {};
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Get the path to a file in the data dir.
@@ -75,14 +93,21 @@ static void makeUppercase(char* const pStr, const size_t len) noexcept {
 //------------------------------------------------------------------------------------------------------------------------------------------
 static void determineFileOverridesInUserDataDir() noexcept {
     // If there is no data dir then there are no overrides
-    gOverridenFileNames.clear();
+    gOverrideFiles.clear();
 
     if (!ProgArgs::gDataDirPath[0])
         return;
 
-    // Prealloc memory for the overriden filenames set
+    // Prealloc memory for the overriden files table
     const IsoFileSys& fileSys = PsxVm::gIsoFileSys;
-    gOverridenFileNames.reserve(fileSys.entries.size() * 8);
+    gOverrideFiles.reserve(fileSys.entries.size() * 8);
+
+    // Adds a file in the data dir to the overrides table
+    const auto addOverrideFile = [](const char* const fileName) noexcept {
+        CdFileId fileId = fileName;
+        makeUppercase(fileId.chars, CdFileId::MAX_LEN);
+        gOverrideFiles[fileId] = OverrideFile{ fileName };
+    };
 
     // MacOS: the C++ 17 '<filesystem>' header requires MacOS Catalina as a minimum target.
     // That's a bit too much for now, so use standard POSIX stuff instead as a workaround.
@@ -103,9 +128,7 @@ static void determineFileOverridesInUserDataDir() noexcept {
                 // allows us to add new files to variants of the game that might not have originally had them. An example of this would be
                 // allowing 'MAP01.WAD' (Doom format map) to override 'MAP01.ROM' (Final Doom format map) when the Final Doom game is loaded.
                 // This functionality is desirable since the Doom format is more modding friendly and doesn't contain baked-in texture numbers.
-                CdFileId fileId = pDirEnt->d_name;
-                makeUppercase(fileId.chars, CdFileId::MAX_LEN);
-                gOverridenFileNames.insert(fileId);
+                addOverrideFile(pDirEnt->d_name);
             }
 
             closedir(pDir);
@@ -128,9 +151,7 @@ static void determineFileOverridesInUserDataDir() noexcept {
                 // allows us to add new files to variants of the game that might not have originally had them. An example of this would be
                 // allowing 'MAP01.WAD' (Doom format map) to override 'MAP01.ROM' (Final Doom format map) when the Final Doom game is loaded.
                 // This functionality is desirable since the Doom format is more modding friendly and doesn't contain baked-in texture numbers.
-                CdFileId fileId = dirIter->path().filename().u8string().c_str();
-                makeUppercase(fileId.chars, CdFileId::MAX_LEN);
-                gOverridenFileNames.insert(fileId);
+                addOverrideFile(dirIter->path().filename().u8string().c_str());
 
                 ++dirIter;
             }
@@ -146,7 +167,7 @@ static void determineFileOverridesInUserDataDir() noexcept {
 //------------------------------------------------------------------------------------------------------------------------------------------
 static uint8_t findFreeOpenFileSlotIndex() noexcept {
     for (uint8_t i = 0; i < MAX_OPEN_FILES; ++i) {
-        if (!gOpenFileSlots[i])
+        if (!gOpenFileSlots[i].bIsOpen)
             return i;
     }
 
@@ -162,20 +183,33 @@ static bool isValidOverridenFile(const PsxCd_File& file) noexcept {
     return (
         (file.overrideFileHandle > 0) &&
         (file.overrideFileHandle <= MAX_OPEN_FILES) &&
-        (gOpenFileSlots[file.overrideFileHandle - 1] != nullptr)
+        gOpenFileSlots[file.overrideFileHandle - 1].bIsOpen
     );
 }
 #endif  // #if ASSERTS_ENABLED
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Get the path to an overriden file
+// Get the details for the file overriding the specified game file, or 'nullptr' if the file is not overriden
 //------------------------------------------------------------------------------------------------------------------------------------------
-static std::string getOverridenFilePath(const CdFileId discFile) noexcept {
+static const OverrideFile* findOverrideFile(const CdFileId discFile) noexcept {
+    CdFileId ucaseDiscFile = discFile;
+    makeUppercase(ucaseDiscFile.chars, CdFileId::MAX_LEN);
+    const auto iter = gOverrideFiles.find(ucaseDiscFile);
+    return (iter != gOverrideFiles.end()) ? &iter->second : nullptr;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Get the path to an overriden file.
+// Uses the name of the file as found in the data dir if it is known, since that might differ in case to the game file name.
+//------------------------------------------------------------------------------------------------------------------------------------------
+std::string getOverridenFilePath(const CdFileId discFile) noexcept {
+    const OverrideFile* const pOverrideFile = findOverrideFile(discFile);
+
     std::string filePath;
     filePath.reserve(255);
     filePath = ProgArgs::gDataDirPath;
     filePath.push_back('/');
-    filePath += discFile.c_str().data();
+    filePath += (pOverrideFile) ? pOverrideFile->fileName.c_str() : discFile.c_str().data();
 
     return filePath;
 }
@@ -186,15 +220,15 @@ void init() noexcept {
 
 void shutdown() noexcept {
     // Close all open files
-    for (std::FILE*& pFile : gOpenFileSlots) {
-        if (pFile) {
-            std::fclose(pFile);
-            pFile = nullptr;
-        }
+    for (OpenFile& openFile : gOpenFileSlots) {
+        openFile.bIsOpen = false;
+        openFile.mappedFile.close();
+        openFile.size = 0;
+        openFile.offset = 0;
     }
 
     // Clear all overrides
-    gOverridenFileNames.clear();
+    gOverrideFiles.clear();
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -227,9 +261,7 @@ void addUserWads(WadList& wadList) noexcept {
 }
 
 bool areOverridesAvailableForFile(const CdFileId discFile) noexcept {
-    CdFileId ucaseDiscFile = discFile;
-    makeUppercase(ucaseDiscFile.chars, CdFileId::MAX_LEN);
-    return (gOverridenFileNames.count(ucaseDiscFile) > 0);
+    return (findOverrideFile(discFile) != nullptr);
 }
 
 bool isFileOverriden(const PsxCd_File& file) noexcept {
@@ -247,57 +279,56 @@ bool openOverridenFile(const CdFileId discFile, PsxCd_File& fileOut) noexcept {
 
     std::string filePath = getOverridenFilePath(discFile);
 
-    // Open the file and save it in the file slot index
-    std::FILE* const pFile = std::fopen(filePath.c_str(), "rb");
-
-    if (!pFile) {
-        return false;
-    }
+    // Map the file into memory and save it in the file slot index.
+    // Note: empty files can't be mapped, but there is nothing to read from them anyway.
+    OpenFile& openFile = gOpenFileSlots[fileSlotIdx];
 
-    // Figure out the size of the file:
-    if (std::fseek(pFile, 0, SEEK_END) != 0) {
-        std::fclose(pFile);
-        return false;
-    }
-
-    const int32_t fileSize = (int32_t) std::ftell(pFile);
+    if (openFile.mappedFile.open(filePath.c_str())) {
+        if (openFile.mappedFile.getSize() > INT32_MAX) {
+            openFile.mappedFile.close();
+            return false;
+        }
 
-    if (fileSize < 0) {
-        std::fclose(pFile);
-        return false;
-    }
+        openFile.size = (int32_t) openFile.mappedFile.getSize();
+    } else {
+        if (FileUtils::getFileSize(filePath.c_str()) != 0)
+            return false;
 
-    // Seek to the start of the file by default
-    if (std::fseek(pFile, 0, SEEK_SET) != 0) {
-        std::fclose(pFile);
-        return false;
+        openFile.size = 0;
     }
 
-    // Save this in the open file slot
-    gOpenFileSlots[fileSlotIdx] = pFile;
+    openFile.bIsOpen = true;
+    openFile.offset = 0;
 
     // Save file details and return 'true' for success
     fileOut = {};
     fileOut.overrideFileHandle = fileSlotIdx + 1;   // Note: handle is the index + 1
-    fileOut.size = fileSize;
+    fileOut.size = openFile.size;
     return true;
 }
 
 void closeOverridenFile(PsxCd_File& file) noexcept {
     ASSERT(isValidOverridenFile(file));
-    std::FILE* const pFile = gOpenFileSlots[file.overrideFileHandle - 1];
-    std::fclose(pFile);
-    gOpenFileSlots[file.overrideFileHandle - 1] = nullptr;
+    OpenFile& openFile = gOpenFileSlots[file.overrideFileHandle - 1];
+    openFile.mappedFile.close();
+    openFile.bIsOpen = false;
+    openFile.size = 0;
+    openFile.offset = 0;
     file = {};
 }
 
 int32_t readFromOverridenFile(void* const pDest, int32_t numBytes, PsxCd_File& file) noexcept {
     ASSERT(isValidOverridenFile(file));
-    std::FILE* const pFile = gOpenFileSlots[file.overrideFileHandle - 1];
+    OpenFile& openFile = gOpenFileSlots[file.overrideFileHandle - 1];
 
-    // Note: a read size of '0' always succeeds and negative sizes always result in an error
+    // Note: a read size of '0' always succeeds and negative sizes always result in an error, as do reads past the end of the file
     if (numBytes > 0) {
-        return (std::fread(pDest, (size_t) numBytes, 1, pFile) == 1) ? numBytes : -1;
+        if ((openFile.offset < 0) || (numBytes > openFile.size - openFile.offset))
+            return -1;
+
+        std::memcpy(pDest, openFile.mappedFile.getData() + openFile.offset, (size_t) numBytes);
+        openFile.offset += numBytes;
+        return numBytes;
     } else if (numBytes == 0) {
         return 0;
     } else {
@@ -307,23 +338,31 @@ int32_t readFromOverridenFile(void* const pDest, int32_t numBytes, PsxCd_File& f
 
 int32_t seekForOverridenFile(PsxCd_File& file, int32_t offset, const PsxCd_SeekMode mode) noexcept {
     ASSERT(isValidOverridenFile(file));
-    std::FILE* const pFile = gOpenFileSlots[file.overrideFileHandle - 1];
+    OpenFile& openFile = gOpenFileSlots[file.overrideFileHandle - 1];
+
+    // Note: like 'fseek' it is valid to seek past the end of the file (reads will fail there) but not before the start
+    int64_t newOffset;
 
     if (mode == PsxCd_SeekMode::SET) {
-        return (std::fseek(pFile, offset, SEEK_SET) == 0) ? 0 : -1;
+        newOffset = offset;
     } else if (mode == PsxCd_SeekMode::CUR) {
-        return (std::fseek(pFile, offset, SEEK_CUR) == 0) ? 0 : -1;
+        newOffset = (int64_t) openFile.offset + offset;
     } else if (mode == PsxCd_SeekMode::END) {
-        return (std::fseek(pFile, -offset, SEEK_END) == 0) ? 0 : -1;
+        newOffset = (int64_t) openFile.size - offset;
     } else {
         return -1;  // Bad seek mode!
     }
+
+    if ((newOffset < 0) || (newOffset > INT32_MAX))
+        return -1;
+
+    openFile.offset = (int32_t) newOffset;
+    return 0;
 }
 
 int32_t tellForOverridenFile(const PsxCd_File& file) noexcept {
     ASSERT(isValidOverridenFile(file));
-    std::FILE* const pFile = gOpenFileSlots[file.overrideFileHandle - 1];
-    return (int32_t) std::ftell(pFile);
+    return gOpenFileSlots[file.overrideFileHandle - 1].offset;
 }
 
 int32_t getOverridenFileSize(const CdFileId discFile) noexcept {
@@ -7,19 +7,19 @@
 BEGIN_NAMESPACE(movie)
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// A matrix defining what indexes to swap into each matrix slot to perform an 'un-zig-zig' transformation.
-// This same transformation is done during MPEG1 and JPEG decoding. For more info see:
+// For each coefficient in MPEG1/JPEG 'zig-zag' order, gives the (flattened) index of the matrix slot that it belongs in.
+// Used to perform the 'un-zig-zag' transformation as coefficients are read. For more info see:
 //  https://github.com/m35/jpsxdec/blob/readme/jpsxdec/PlayStation1_STR_format.txt
 //------------------------------------------------------------------------------------------------------------------------------------------
-static constexpr uint8_t UNZIGZAG_MATRIX[Block::PIXELS_H][Block::PIXELS_W] = {
-    {  0,  1,  5,  6, 14, 15, 27, 28 },
-    {  2,  4,  7, 13, 16, 26, 29, 42 },
-    {  3,  8, 12, 17, 25, 30, 41, 43 },
-    {  9, 11, 18, 24, 31, 40, 44, 53 },
-    { 10, 19, 23, 32, 39, 45, 52, 54 },
-    { 20, 22, 33, 38, 46, 51, 55, 60 },
-    { 21, 34, 37, 47, 50, 56, 59, 61 },
-    { 35, 36, 48, 49, 57, 58, 62, 63 }
+static constexpr uint8_t ZIGZAG_TO_MATRIX_IDX[Block::PIXELS_W * Block::PIXELS_H] = {
+     0,  1,  8, 16,  9,  2,  3, 10,
+    17, 24, 32, 25, 18, 11,  4,  5,
+    12, 19, 26, 33, 40, 48, 41, 34,
+    27, 20, 13,  6,  7, 14, 21, 28,
+    35, 42, 49, 56, 57, 50, 43, 36,
+    29, 22, 15, 23, 30, 37, 44, 51,
+    58, 59, 52, 45, 38, 31, 39, 46,
+    53, 60, 61, 54, 47, 55, 62, 63,
 };
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -69,103 +69,97 @@ static constexpr int16_t IDCT_MT[Block::PIXELS_H][Block::PIXELS_W] = {
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Does one matrix multiply for the inverse discrete cosine transform.
 // Assumes one of the matrixes is in 0.16 fixed point format.
+//
+// Each output row is built up by scaling whole rows of 'matrix2' by single elements of 'matrix1' and accumulating all 8 columns at once.
+// Unlike a dot product for each output element there are no dependencies between columns, so compilers can vectorize the inner loops
+// (SSE2, NEON etc.). Terms where the 'matrix1' element is zero or where the row of 'matrix2' is known to be all zero ('matrix2RowsMask'
+// bit clear) are skipped. This is very common since most of the high frequency coefficients in a block are zero.
+// Integer addition is exact, so the result is identical to summing the products for each output element in order.
 //------------------------------------------------------------------------------------------------------------------------------------------
 static void doIdctMatrixMultiply(
     const int16_t matrix1[Block::PIXELS_H][Block::PIXELS_W],
     const int16_t matrix2[Block::PIXELS_H][Block::PIXELS_W],
+    const uint32_t matrix2RowsMask,
     int16_t outMatrix[Block::PIXELS_H][Block::PIXELS_W]
 ) noexcept {
     static_assert(Block::PIXELS_W == Block::PIXELS_H);  // Assuming a square matrix in this function
 
     for (uint32_t row = 0; row < Block::PIXELS_H; ++row) {
-        for (uint32_t col = 0; col < Block::PIXELS_W; ++col) {
-            // Note: the numbers in the value (non IDCT) matrix should be between -2048 and 2047 (12 bits needed) and the IDCT matrix itself
-            // needs 16-bits of precision. The sum is done over 8 elements so that should be an additional 4-bits of precision required, for
-            // a total of 32-bits used. Because of this I'm dropping 4-bits during calculations to avoid overflow, just to be safe.
-            // 
-            // For more on this see:
-            //  https://github.com/m35/jpsxdec/blob/readme/jpsxdec/PlayStation1_STR_format.txt
-            int32_t sum = 0;
-
-            for (uint32_t i = 0; i < Block::PIXELS_W; ++i) {
-                sum += ((int32_t) matrix1[row][i] * matrix2[i][col]) >> 4;  // Chop off a few fractional 16.16 bits to prevent overflow
+        // Note: the numbers in the value (non IDCT) matrix should be between -2048 and 2047 (12 bits needed) and the IDCT matrix itself
+        // needs 16-bits of precision. The sum is done over 8 elements so that should be an additional 4-bits of precision required, for
+        // a total of 32-bits used. Because of this I'm dropping 4-bits during calculations to avoid overflow, just to be safe.
+        // 
+        // For more on this see:
+        //  https://github.com/m35/jpsxdec/blob/readme/jpsxdec/PlayStation1_STR_format.txt
+        int32_t sums[Block::PIXELS_W] = {};
+
+        for (uint32_t i = 0; i < Block::PIXELS_W; ++i) {
+            const int32_t matrix1Val = matrix1[row][i];
+
+            if ((matrix1Val == 0) || ((matrix2RowsMask & (1u << i)) == 0))
+                continue;
+
+            for (uint32_t col = 0; col < Block::PIXELS_W; ++col) {
+                sums[col] += (matrix1Val * matrix2[i][col]) >> 4;   // Chop off a few fractional 16.16 bits to prevent overflow
             }
-
-            sum >>= 12; // Remove the rest of the fixed point fractional bits from the number
-            outMatrix[row][col] = (int16_t) sum;
         }
-    }
-}
 
-//------------------------------------------------------------------------------------------------------------------------------------------
-// Reorders the matrix values in the block so that they are no longer in MPEG1/JPEG 'zig-zag' order
-//------------------------------------------------------------------------------------------------------------------------------------------
-static void unZigZagBlock(Block& block) noexcept {
-    // Copy the original list of values that are in zig-zag order and flatten the list to 1 dimension
-    int16_t origMatrix[Block::PIXELS_W * Block::PIXELS_H];
-    std::memcpy(origMatrix, block.mValues, sizeof(block.mValues));
-
-    // Perform the un-zig-zag transform
-    for (uint32_t y = 0; y < Block::PIXELS_H; ++y) {
-        for (uint32_t x = 0; x < Block::PIXELS_W; ++x) {
-            const uint32_t origIdx = UNZIGZAG_MATRIX[y][x];
-            block.mValues[y][x] = origMatrix[origIdx];
+        for (uint32_t col = 0; col < Block::PIXELS_W; ++col) {
+            outMatrix[row][col] = (int16_t)(sums[col] >> 12);       // Remove the rest of the fixed point fractional bits from the number
         }
     }
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Decoding step: de-quantizes the given block's value matrix or scales the values
+// Decoding step: de-quantizes or scales a single value in the block's matrix, given the (flattened) matrix index of the value
 //------------------------------------------------------------------------------------------------------------------------------------------
-static void dequantizeBlock(Block& block, const int16_t quantizationScale) noexcept {
-    // The first row has the first value treated differently, hardcode this row to avoid conditionals:
-    static_assert(Block::PIXELS_W == 8);
+static int16_t dequantizeValue(const int16_t value, const uint32_t matrixIdx, const int16_t quantizationScale) noexcept {
+    const int16_t* const pScaleMatrix = &QUANTIZATION_SCALE_MATRIX[0][0];
 
-    block.mValues[0][0] = (int16_t)(block.mValues[0][0] * QUANTIZATION_SCALE_MATRIX[0][0]);
-    block.mValues[0][1] = (int16_t)((2 * block.mValues[0][1] * quantizationScale * QUANTIZATION_SCALE_MATRIX[0][1]) / 16);
-    block.mValues[0][2] = (int16_t)((2 * block.mValues[0][2] * quantizationScale * QUANTIZATION_SCALE_MATRIX[0][2]) / 16);
-    block.mValues[0][3] = (int16_t)((2 * block.mValues[0][3] * quantizationScale * QUANTIZATION_SCALE_MATRIX[0][3]) / 16);
-    block.mValues[0][4] = (int16_t)((2 * block.mValues[0][4] * quantizationScale * QUANTIZATION_SCALE_MATRIX[0][4]) / 16);
-    block.mValues[0][5] = (int16_t)((2 * block.mValues[0][5] * quantizationScale * QUANTIZATION_SCALE_MATRIX[0][5]) / 16);
-    block.mValues[0][6] = (int16_t)((2 * block.mValues[0][6] * quantizationScale * QUANTIZATION_SCALE_MATRIX[0][6]) / 16);
-    block.mValues[0][7] = (int16_t)((2 * block.mValues[0][7] * quantizationScale * QUANTIZATION_SCALE_MATRIX[0][7]) / 16);
+    // The first value (the DC coefficient) is treated differently
+    if (matrixIdx == 0)
+        return (int16_t)(value * pScaleMatrix[0]);
 
-    // Do the rest of the rows in a normal loop
-    for (uint32_t y = 1; y < Block::PIXELS_H; ++y) {
-        for (uint32_t x = 0; x < Block::PIXELS_W; ++x) {
-            block.mValues[y][x] = (int16_t)((2 * block.mValues[y][x] * quantizationScale * QUANTIZATION_SCALE_MATRIX[y][x]) / 16);
-        }
-    }
+    return (int16_t)((2 * value * quantizationScale * pScaleMatrix[matrixIdx]) / 16);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Decoding step: applies the inverse discrete cosine transform to a block.
+// The given bit mask specifies which rows of the block's matrix may contain non zero values.
 // For more on this see: https://github.com/m35/jpsxdec/blob/readme/jpsxdec/PlayStation1_STR_format.txt
 //------------------------------------------------------------------------------------------------------------------------------------------
-static void applyInverseDiscreteCosineTransformToBlock(Block& block) noexcept {
+static void applyInverseDiscreteCosineTransformToBlock(Block& block, const uint32_t nonZeroRowsMask) noexcept {
+    constexpr uint32_t ALL_ROWS_MASK = (1u << Block::PIXELS_H) - 1;
+
     int16_t tmpMatrix[Block::PIXELS_H][Block::PIXELS_W];
-    doIdctMatrixMultiply(IDCT_MT, block.mValues, tmpMatrix);
-    doIdctMatrixMultiply(tmpMatrix, IDCT_M, block.mValues);
+    doIdctMatrixMultiply(IDCT_MT, block.mValues, nonZeroRowsMask, tmpMatrix);
+    doIdctMatrixMultiply(tmpMatrix, IDCT_M, ALL_ROWS_MASK, block.mValues);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Decoding step: reads the DC and AC coefficients for the specified block.
+// As each coefficient is read, it is de-quantized and moved out of 'zig-zag' order into its final slot in the block's matrix.
+// Returns a bit mask of the matrix rows that had coefficients written to them, for skipping zero rows during the IDCT.
 // Assumes the block has already been zero filled to start with.
 // For more details on this, see: https://github.com/m35/jpsxdec/blob/readme/jpsxdec/PlayStation1_STR_format.txt
 //------------------------------------------------------------------------------------------------------------------------------------------
-static void readDcAndAcCoeffForBlock(Block& block, MBlockBitStream& inputStream) THROWS {
+static uint32_t readDcAndAcCoeffForBlock(Block& block, MBlockBitStream& inputStream, const int16_t quantizationScale) THROWS {
+    int16_t* const pValues = &block.mValues[0][0];
+
     // Read the DC coefficient firstly (10 bits signed)
     {
         const uint16_t dcBits = inputStream.readBits<10>();
         const int16_t dcNonSignBits = dcBits & 0x1FF;
-        block.mValues[0][0] = (dcBits & 0x200) ? dcNonSignBits - 0x200 : dcNonSignBits;
+        const int16_t dcCoeff = (dcBits & 0x200) ? dcNonSignBits - 0x200 : dcNonSignBits;
+        pValues[0] = dequantizeValue(dcCoeff, 0, quantizationScale);
     }
 
+    uint32_t nonZeroRowsMask = 1;
+
     // Read the AC coefficients until EOF is encountered.
     // If too many are provided then that is an error (63 max are allowed).
     // Note that the first entry in the array is taken up by the DC coefficient.
     constexpr uint32_t END_COEFF_IDX = Block::PIXELS_W * Block::PIXELS_H;
-    int16_t* const pCoeff = &block.mValues[0][0];
     uint32_t curCoeffIdx = 1;
 
     while (true) {
@@ -184,9 +178,13 @@ static void readDcAndAcCoeffForBlock(Block& block, MBlockBitStream& inputStream)
             throw MBlockBitStream::ErrorType::INVALID_ENCODING;
 
         // Save the AC coefficient
-        pCoeff[curCoeffIdx] = coeff.nonZeroCoeff;
+        const uint32_t matrixIdx = ZIGZAG_TO_MATRIX_IDX[curCoeffIdx];
+        pValues[matrixIdx] = dequantizeValue(coeff.nonZeroCoeff, matrixIdx, quantizationScale);
+        nonZeroRowsMask |= 1u << (matrixIdx / Block::PIXELS_W);
         ++curCoeffIdx;
     }
+
+    return nonZeroRowsMask;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -198,33 +196,49 @@ void Block::clear() noexcept {
             mValues[y][x] = 0;
         }
     }
+
+    mNonZeroRowsMask = 0;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Tries to read and decode the block of values.
+// Tries to read the block of values from the bitstream, leaving them de-quantized and in their final order but not yet decoded.
 // Takes the quantization scale for the frame as input.
 //------------------------------------------------------------------------------------------------------------------------------------------
-bool Block::readAndDecode(MBlockBitStream& inputStream, const int16_t quantizationScale) noexcept {
+bool Block::read(MBlockBitStream& inputStream, const int16_t quantizationScale) noexcept {
     // The set of AC coefficients (63 total) doesn't have to be complete within the stream.
     // The unspecified ones must be zero-initialized if not provided:
     clear();
 
-    // Firstly read/decode the DC coefficients and all the AC coefficients.
+    // Read/decode the DC coefficients and all the AC coefficients.
     // If that fails clear the block and abort with failure:
+    // Note: reading also reverses the zig-zag matrix order and dequantizes.
     try {
-        readDcAndAcCoeffForBlock(*this, inputStream);
+        mNonZeroRowsMask = readDcAndAcCoeffForBlock(*this, inputStream, quantizationScale);
     } catch (...) {
         clear();
         return false;
     }
 
-    // Reverse the zig-zag matrix order, dequantize and apply the inverse discrete cosine transform.
-    // This yields the final block values.
-    unZigZagBlock(*this);
-    dequantizeBlock(*this, quantizationScale);
-    applyInverseDiscreteCosineTransformToBlock(*this);
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Decodes a block previously read via 'read()' to yield the final block values.
+// Does not touch the bitstream, so blocks can be decoded independently of (and in parallel with) each other.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void Block::decode() noexcept {
+    applyInverseDiscreteCosineTransformToBlock(*this, mNonZeroRowsMask);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tries to read and decode the block of values.
+// Takes the quantization scale for the frame as input.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool Block::readAndDecode(MBlockBitStream& inputStream, const int16_t quantizationScale) noexcept {
+    if (!read(inputStream, quantizationScale))
+        return false;
 
-    // All good if we've made it to here!
+    decode();
     return true;
 }
 
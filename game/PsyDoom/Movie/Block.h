@@ -18,9 +18,12 @@ struct Block {
     static constexpr uint32_t PIXELS_H = 8;     // Height of the block in pixels
 
     void clear() noexcept;
+    bool read(MBlockBitStream& inputStream, const int16_t quantizationScale) noexcept;
+    void decode() noexcept;
     bool readAndDecode(MBlockBitStream& inputStream, const int16_t quantizationScale) noexcept;
 
-    int16_t mValues[PIXELS_H][PIXELS_W];
+    int16_t     mValues[PIXELS_H][PIXELS_W];
+    uint32_t    mNonZeroRowsMask;               // Which rows of 'mValues' may be non zero after reading (bit per row), used to speed up decoding
 };
 
 END_NAMESPACE(movie)
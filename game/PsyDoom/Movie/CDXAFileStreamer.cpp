@@ -2,33 +2,53 @@
 
 #include "Asserts.h"
 #include "FileInputStream.h"
+#include "PsyDoom/Chd/ChdCdImage.h"
 #include "PsyDoom/DiscInfo.h"
 #include "PsyDoom/IsoFileSys.h"
 
 #include <algorithm>
+#include <cstring>
 
 BEGIN_NAMESPACE(movie)
 
+// How many sectors the I/O thread can read ahead of the consumer of the stream.
+// At the 2x CD-ROM speed used for movies this is just under half a second worth of data.
+static constexpr uint32_t READ_AHEAD_NUM_SECTORS = 64;
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Creates a CD-XA file streamer with no open file
 //------------------------------------------------------------------------------------------------------------------------------------------
 CDXAFileStreamer::CDXAFileStreamer() noexcept
     : mFile()
+    , mChdImage()
     , mCurSector(0)
     , mEndSector(0)
     , mSectorBuffer()
     , mUsedSectorBufferSlots()
     , mFreeSectorBufferSlots()
+    , mReadAheadThread()
+    , mReadAheadMutex()
+    , mReadAheadCV()
+    , mReadAheadRing()
+    , mReadAheadHead(0)
+    , mReadAheadTail(0)
+    , mbReadAheadError(false)
+    , mbReadAheadQuit(false)
 {
 }
 
-CDXAFileStreamer::~CDXAFileStreamer() noexcept = default;
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Closes up the streamer and stops the read-ahead thread, if running
+//------------------------------------------------------------------------------------------------------------------------------------------
+CDXAFileStreamer::~CDXAFileStreamer() noexcept {
+    close();
+}
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Tells if a file is currently open for streaming
 //------------------------------------------------------------------------------------------------------------------------------------------
 bool CDXAFileStreamer::isOpen() const noexcept {
-    return (mFile != nullptr);
+    return (mFile || mChdImage);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -60,14 +80,28 @@ bool CDXAFileStreamer::open(
 
     // Try to open the file specified by the track and seek to the correct location for the file.
     // If it fails then abort the opening process.
-    try {
-        mFile = std::make_unique<FileInputStream>(pTrack->sourceFilePath.c_str());
-        mFile->skipBytes(pTrack->fileOffset + pFsEntry->startLba * sizeof(CDXASector));
-    } catch (...) {
-        close();
-        return false;
+    const int64_t fileOffset = (int64_t) pTrack->fileOffset + (int64_t) pFsEntry->startLba * sizeof(CDXASector);
+
+    if (pTrack->bSourceIsChd) {
+        std::unique_ptr<chd::ChdCdImage> chdImage = std::make_unique<chd::ChdCdImage>();
+        std::string errorMsg;
+
+        if ((!chdImage->open(pTrack->sourceFilePath.c_str(), errorMsg)) || (!chdImage->seek(fileOffset))) {
+            close();
+            return false;
+        }
+
+        mChdImage = std::move(chdImage);
+    } else {
+        try {
+            mFile = std::make_unique<FileInputStream>(pTrack->sourceFilePath.c_str());
+            mFile->skipBytes((size_t) fileOffset);
+        } catch (...) {
+            close();
+            return false;
+        }
     }
-    
+
     // Setup the sector buffer and buffer slot management.
     // Note: some of these fields should already be setup, hence checking these assumptions in debug.
     ASSERT(mCurSector == 0);
@@ -90,6 +124,9 @@ bool CDXAFileStreamer::open(
     // Figure out how many physical/raw CD sectors the file consumes, rounding up to the nearest whole sector.
     // This is the size of the XA file stream...
     mEndSector = (pFsEntry->size + pTrack->blockPayloadSize - 1) / pTrack->blockPayloadSize;
+
+    // Start reading sectors ahead of time
+    startReadAhead();
     return true;
 }
 
@@ -97,7 +134,9 @@ bool CDXAFileStreamer::open(
 // Closes up the current file being streamed
 //------------------------------------------------------------------------------------------------------------------------------------------
 void CDXAFileStreamer::close() noexcept {
+    stopReadAhead();
     mFile.reset();
+    mChdImage.reset();
     mCurSector = 0;
     mEndSector = 0;
     mSectorBuffer.clear();
@@ -112,23 +151,39 @@ void CDXAFileStreamer::close() noexcept {
 //------------------------------------------------------------------------------------------------------------------------------------------
 const CDXASector* CDXAFileStreamer::readSector() noexcept {
     // Is there a file opened for streaming or is there data ahead?
-    if (!mFile)
+    if (!isOpen())
         return nullptr;
 
     // Are we at the end of the stream?
     if (mCurSector >= mEndSector)
         return nullptr;
 
-    // Allocate a sector and then read it's contents from the file
-    CDXASector& sector = allocBufferSector();
+    // Wait for the read-ahead thread to read the next sector, or for it to report an error.
+    // Note that any sectors read before an error are still returned first.
+    bool bSectorAvailable;
+
+    {
+        std::unique_lock lock(mReadAheadMutex);
+        mReadAheadCV.wait(lock, [&]() noexcept { return ((mReadAheadHead != mReadAheadTail) || mbReadAheadError); });
+        bSectorAvailable = (mReadAheadHead != mReadAheadTail);
+    }
 
-    try {
-        mFile->read(sector);
-    } catch (...) {
+    if (!bSectorAvailable) {
         close();
         return nullptr;
     }
 
+    // Allocate a sector, copy in it's contents from the read-ahead ring buffer and free up that ring buffer slot for the I/O thread
+    CDXASector& sector = allocBufferSector();
+    std::memcpy(&sector, &mReadAheadRing[mReadAheadTail % READ_AHEAD_NUM_SECTORS], sizeof(CDXASector));
+
+    {
+        std::lock_guard lock(mReadAheadMutex);
+        mReadAheadTail++;
+    }
+
+    mReadAheadCV.notify_all();
+
     // Success! Mark this sector as read and return its contents:
     mCurSector++;
     return &sector;
@@ -174,4 +229,94 @@ CDXASector& CDXAFileStreamer::allocBufferSector() noexcept {
     return mSectorBuffer[slotIdx];
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Starts up the I/O thread which reads sectors from the file ahead of time
+//------------------------------------------------------------------------------------------------------------------------------------------
+void CDXAFileStreamer::startReadAhead() noexcept {
+    ASSERT(!mReadAheadThread.joinable());
+
+    mReadAheadRing.resize(READ_AHEAD_NUM_SECTORS);
+    mReadAheadHead = 0;
+    mReadAheadTail = 0;
+    mbReadAheadError = false;
+    mbReadAheadQuit = false;
+    mReadAheadThread = std::thread([this]() noexcept { readAheadThreadMain(); });
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Stops the I/O thread which reads sectors ahead of time (if running) and frees the read-ahead ring buffer
+//------------------------------------------------------------------------------------------------------------------------------------------
+void CDXAFileStreamer::stopReadAhead() noexcept {
+    if (mReadAheadThread.joinable()) {
+        {
+            std::lock_guard lock(mReadAheadMutex);
+            mbReadAheadQuit = true;
+        }
+
+        mReadAheadCV.notify_all();
+        mReadAheadThread.join();
+    }
+
+    mReadAheadRing.clear();
+    mReadAheadRing.shrink_to_fit();
+    mReadAheadHead = 0;
+    mReadAheadTail = 0;
+    mbReadAheadError = false;
+    mbReadAheadQuit = false;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Entry point for the I/O thread which reads sectors ahead of time.
+// Reads sectors into the ring buffer whenever there is room, until the end of the file is reached, an error occurs or it is told to quit.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void CDXAFileStreamer::readAheadThreadMain() noexcept {
+    for (uint32_t sectorIdx = 0; sectorIdx < mEndSector; ++sectorIdx) {
+        // Wait for room in the ring buffer
+        uint32_t head;
+
+        {
+            std::unique_lock lock(mReadAheadMutex);
+            mReadAheadCV.wait(lock, [&]() noexcept {
+                return (mbReadAheadQuit || (mReadAheadHead - mReadAheadTail < READ_AHEAD_NUM_SECTORS));
+            });
+
+            if (mbReadAheadQuit)
+                return;
+
+            head = mReadAheadHead;
+        }
+
+        // Read the sector: the consumer never touches the slot at the head of the ring buffer, so this can be done outside the lock
+        bool bReadOk = true;
+
+        CDXASector& sector = mReadAheadRing[head % READ_AHEAD_NUM_SECTORS];
+
+        if (mChdImage) {
+            bReadOk = (mChdImage->read(&sector, sizeof(CDXASector)) == sizeof(CDXASector));
+        } else {
+            try {
+                mFile->read(sector);
+            } catch (...) {
+                bReadOk = false;
+            }
+        }
+
+        // Publish the sector or report the error
+        {
+            std::lock_guard lock(mReadAheadMutex);
+
+            if (bReadOk) {
+                mReadAheadHead++;
+            } else {
+                mbReadAheadError = true;
+            }
+        }
+
+        mReadAheadCV.notify_all();
+
+        if (!bReadOk)
+            return;
+    }
+}
+
 END_NAMESPACE(movie)
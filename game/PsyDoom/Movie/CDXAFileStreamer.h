@@ -2,10 +2,17 @@
 
 #include "Macros.h"
 
+#include <condition_variable>
 #include <memory>
+#include <mutex>
+#include <thread>
 #include <vector>
 
 class FileInputStream;
+
+namespace chd {
+    class ChdCdImage;
+}
 struct DiscInfo;
 struct IsoFileSys;
 
@@ -77,6 +84,7 @@ static_assert(sizeof(CDXASector) == 2352);
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Reads and buffers raw CDXA sectors sequentially from a file on a disc.
 // Allows sectors of interest (video, audio etc.) to be picked out while other sectors get buffered for later use.
+// Sectors are read ahead of time from the file by a dedicated I/O thread into a ring buffer, so that consumers rarely wait on disk I/O.
 //------------------------------------------------------------------------------------------------------------------------------------------
 class CDXAFileStreamer {
 public:
@@ -137,13 +145,28 @@ private:
     CDXAFileStreamer& operator = (const CDXAFileStreamer& other) = delete;
 
     CDXASector& allocBufferSector() noexcept;
+    void startReadAhead() noexcept;
+    void stopReadAhead() noexcept;
+    void readAheadThreadMain() noexcept;
 
-    std::unique_ptr<FileInputStream>    mFile;                      // The file being streamed from
+    std::unique_ptr<FileInputStream>    mFile;                      // The file being streamed from: only used by the read-ahead thread while it is running
+    std::unique_ptr<chd::ChdCdImage>    mChdImage;                  // The CHD image being streamed from instead of 'mFile', if the disc is a CHD image
     uint32_t                            mCurSector;                 // Next sector to be read
     uint32_t                            mEndSector;                 // End sector in the file
     std::vector<CDXASector>             mSectorBuffer;              // Buffer of sectors that is potentially sparsely used
     std::vector<uint32_t>               mUsedSectorBufferSlots;     // Which sector buffer slots are in use (in FIFO order)
     std::vector<uint32_t>               mFreeSectorBufferSlots;     // Which sector buffer slots are free
+
+    // Read-ahead state: the ring buffer of sectors read by the I/O thread and the counts of sectors put into and taken from it (which wrap).
+    // The counts and flags are guarded by the read-ahead mutex. Only the I/O thread writes the ring buffer slot at the head of the buffer.
+    std::thread                         mReadAheadThread;
+    std::mutex                          mReadAheadMutex;
+    std::condition_variable             mReadAheadCV;               // Signalled when sectors are added to or removed from the ring buffer, or on errors/quit
+    std::vector<CDXASector>             mReadAheadRing;
+    uint32_t                            mReadAheadHead;             // Number of sectors added to the ring buffer by the I/O thread
+    uint32_t                            mReadAheadTail;             // Number of sectors taken from the ring buffer by 'readSector()'
+    bool                                mbReadAheadError;           // Set by the I/O thread if reading the file failed
+    bool                                mbReadAheadQuit;            // Set to tell the I/O thread to exit
 };
 
 END_NAMESPACE(movie)
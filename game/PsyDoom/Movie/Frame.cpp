@@ -5,6 +5,7 @@
 #include "FatalErrors.h"
 #include "MacroBlockDecoder.h"
 #include "MBlockBitStream.h"
+#include "PsyDoom/JobSystem.h"
 
 #include <cstdlib>
 #include <cstring>
@@ -242,38 +243,57 @@ bool Frame::decodeMacroBlocks() noexcept {
     MBlockBitStream frameDataStream;
     frameDataStream.open((const uint16_t*)(mpDemuxedData + 8), (mDemuxedDataSize - 8) / sizeof(uint16_t));
 
-    // The macro blocks are arranged in a column major order, decode in that fashion.
+    // The macro blocks are arranged in a column major order, read them in that fashion.
     // If the frame size is not an even multiple of 16 then the extra pixels are simply padding that are ignored.
+    //
+    // Reading the bitstream must be done serially since the size of each block is not known until it is read, but once all of the blocks
+    // have been read they can be decoded independently. Read all of the blocks firstly, then decode them across the job system's threads.
     const uint32_t blocksW = (mFirstSecHdr.frameW + 15u) / 16u;
     const uint32_t blocksH = (mFirstSecHdr.frameH + 15u) / 16u;
+    const uint32_t numMacroBlocks = blocksW * blocksH;
+    mMacroBlocks.resize(numMacroBlocks);
 
-    for (uint32_t bx = 0; bx < blocksW; ++bx) {
-        for (uint32_t by = 0; by < blocksH; ++by) {
-            // Decode this block of pixels and abort if failed
-            uint32_t blockPixels[16][16];
-
-            if (!MacroBlockDecoder::decode(frameDataStream, mFirstSecHdr.quantizationScale, blockPixels))
-                return false;
-
-            // Copy the pixels to the pixel buffer, the ones that are in range at least
-            const uint32_t dstStartX = bx * 16u;
-            const uint32_t dstStartY = by * 16u;
-            const uint32_t dstEndX = std::min(dstStartX + 16u, (uint32_t) mFirstSecHdr.frameW);
-            const uint32_t dstEndY = std::min(dstStartY + 16u, (uint32_t) mFirstSecHdr.frameH);
-            const uint32_t copyRectW = dstEndX - dstStartX;
-            const uint32_t copyRectH = dstEndY - dstStartY;
-
-            for (uint32_t y = 0; y < copyRectH; ++y) {
-                for (uint32_t x = 0; x < copyRectW; ++x) {
-                    const uint32_t dstX = dstStartX + x;
-                    const uint32_t dstY = dstStartY + y;
-                    mpPixelBuffer[mFirstSecHdr.frameW * dstY + dstX] = blockPixels[y][x];
-                }
-            }
-        }
+    for (uint32_t blockIdx = 0; blockIdx < numMacroBlocks; ++blockIdx) {
+        // Read this block and abort if failed
+        if (!MacroBlockDecoder::read(frameDataStream, mFirstSecHdr.quantizationScale, mMacroBlocks[blockIdx]))
+            return false;
     }
 
+    JobSystem::runJobs(numMacroBlocks, decodeMacroBlockJob, this);
     return true;
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Job system job which decodes the specified macro block (previously read from the bitstream) and saves it to the frame's pixel buffer.
+// Each job writes to a different area of the pixel buffer, so these can be run in parallel.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void Frame::decodeMacroBlockJob(const uint32_t macroBlockIdx, void* const pUserData) noexcept {
+    Frame& frame = *(Frame*) pUserData;
+    const FrameSectorHeader& hdr = frame.mFirstSecHdr;
+
+    // Decode this block of pixels
+    uint32_t blockPixels[16][16];
+    MacroBlockDecoder::decode(frame.mMacroBlocks[macroBlockIdx], blockPixels);
+
+    // Copy the pixels to the pixel buffer, the ones that are in range at least.
+    // Note that the macro blocks are in column major order.
+    const uint32_t blocksH = (hdr.frameH + 15u) / 16u;
+    const uint32_t bx = macroBlockIdx / blocksH;
+    const uint32_t by = macroBlockIdx % blocksH;
+    const uint32_t dstStartX = bx * 16u;
+    const uint32_t dstStartY = by * 16u;
+    const uint32_t dstEndX = std::min(dstStartX + 16u, (uint32_t) hdr.frameW);
+    const uint32_t dstEndY = std::min(dstStartY + 16u, (uint32_t) hdr.frameH);
+    const uint32_t copyRectW = dstEndX - dstStartX;
+    const uint32_t copyRectH = dstEndY - dstStartY;
+
+    for (uint32_t y = 0; y < copyRectH; ++y) {
+        for (uint32_t x = 0; x < copyRectW; ++x) {
+            const uint32_t dstX = dstStartX + x;
+            const uint32_t dstY = dstStartY + y;
+            frame.mpPixelBuffer[hdr.frameW * dstY + dstX] = blockPixels[y][x];
+        }
+    }
+}
+
 END_NAMESPACE(movie)
@@ -1,6 +1,6 @@
 #pragma once
 
-#include "Macros.h"
+#include "MacroBlockDecoder.h"
 
 #include <cstdint>
 #include <vector>
@@ -59,6 +59,7 @@ private:
     void bufferFrameData(const CDXASector& sector) noexcept;
     bool demuxFrame(CDXAFileStreamer& cdStreamer, const uint8_t channelNum) noexcept;
     bool decodeMacroBlocks() noexcept;
+    static void decodeMacroBlockJob(const uint32_t macroBlockIdx, void* const pUserData) noexcept;
 
     FrameSectorHeader   mFirstSecHdr;           // Holds the header for the first sector in the frame, subsequent sectors largely duplicate this info
     std::byte*          mpDemuxedData;          // Buffer holding the de-multiplexed compressed data for the frame
@@ -66,6 +67,9 @@ private:
     uint32_t            mDemuxedDataCapacity;   // Size of the demuxed frame data buffer
     uint32_t*           mpPixelBuffer;          // Pixel buffer for holding decoded frame data (32-bit ABGR8888)
     uint32_t            mPixelBufferCapacity;   // The number of pixels that the pixel buffer can hold
+
+    // Macro blocks for the frame which have been read from the bitstream but not yet decoded, in column major order
+    std::vector<MacroBlockDecoder::MacroBlock>  mMacroBlocks;
 };
 
 END_NAMESPACE(movie)
@@ -12,42 +12,43 @@ BEGIN_NAMESPACE(movie)
 BEGIN_NAMESPACE(MacroBlockDecoder)
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Attempts to decode a 16x16 block of pixels in the movie.
-// Takes the quantization scale for the frame as input and outputs the pixels to the specified array.
-// Returns 'false' on failure to read or decode the block.
+// Attempts to read the 6 blocks within a 16x16 macro block of pixels in the movie, without decoding them.
+// Takes the quantization scale for the frame as input and saves the blocks to the given macro block.
+// Returns 'false' on failure to read the blocks.
 // For more on this, see: https://github.com/m35/jpsxdec/blob/readme/jpsxdec/PlayStation1_STR_format.txt
 //------------------------------------------------------------------------------------------------------------------------------------------
-bool decode(
-    MBlockBitStream& inputStream,
-    const int16_t quantizationScale,
-    uint32_t pPixelsOut[PIXELS_H][PIXELS_W]
-) noexcept {
+bool read(MBlockBitStream& inputStream, const int16_t quantizationScale, MacroBlock& macroBlockOut) noexcept {
+    // The blocks in the bitstream are in this order: cr, cb, y[0], y[1], y[2], y[3]
+    return (
+        macroBlockOut.blockCr.read(inputStream, quantizationScale) &&
+        macroBlockOut.blockCb.read(inputStream, quantizationScale) &&
+        macroBlockOut.blockY[0].read(inputStream, quantizationScale) &&
+        macroBlockOut.blockY[1].read(inputStream, quantizationScale) &&
+        macroBlockOut.blockY[2].read(inputStream, quantizationScale) &&
+        macroBlockOut.blockY[3].read(inputStream, quantizationScale)
+    );
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Decodes a 16x16 block of pixels in the movie that was previously read via 'read()' and outputs the pixels to the specified array.
+// The blocks within the macro block are decoded in place. Does not touch the bitstream, so macro blocks can be decoded in parallel.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void decode(MacroBlock& macroBlock, uint32_t pPixelsOut[PIXELS_H][PIXELS_W]) noexcept {
     ASSERT(pPixelsOut);
 
-    // Firstly decode the 6 blocks within this macro block:
-    // 
-    //  cr = Chroma Red
-    //  cb = Chroma Blue
-    //  y[0] = Luma (top left)
-    //  y[1] = Luma (top right)
-    //  y[2] = Luma (bottom left)
-    //  y[3] = Luma (bottom right)
-    //
+    // Firstly decode the 6 blocks within this macro block.
     // Note that the chroma blocks cover a 16x16 pixel area but each luma block covers a 8x8 pixel area.
     // Thus luma resolution is twice that of color.
-    Block blockCr, blockCb, blockY[4];
-
-    const bool bDecodedAllBlocksOk = (
-        blockCr.readAndDecode(inputStream, quantizationScale) &&
-        blockCb.readAndDecode(inputStream, quantizationScale) &&
-        blockY[0].readAndDecode(inputStream, quantizationScale) &&
-        blockY[1].readAndDecode(inputStream, quantizationScale) &&
-        blockY[2].readAndDecode(inputStream, quantizationScale) &&
-        blockY[3].readAndDecode(inputStream, quantizationScale)
-    );
+    const Block& blockCr = macroBlock.blockCr;
+    const Block& blockCb = macroBlock.blockCb;
+    const Block* const blockY = macroBlock.blockY;
 
-    if (!bDecodedAllBlocksOk)
-        return false;
+    macroBlock.blockCr.decode();
+    macroBlock.blockCb.decode();
+    macroBlock.blockY[0].decode();
+    macroBlock.blockY[1].decode();
+    macroBlock.blockY[2].decode();
+    macroBlock.blockY[3].decode();
 
     // Process each pixel and convert to ABGR8888 format
     for (uint32_t y = 0; y < PIXELS_H; ++y) {
@@ -71,7 +72,24 @@ bool decode(
             pPixelsOut[y][x] = 0xFF000000 | (colorB << 16) | (colorG << 8) | colorR;
         }
     }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Attempts to read and decode a 16x16 block of pixels in the movie.
+// Takes the quantization scale for the frame as input and outputs the pixels to the specified array.
+// Returns 'false' on failure to read or decode the block.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool decode(
+    MBlockBitStream& inputStream,
+    const int16_t quantizationScale,
+    uint32_t pPixelsOut[PIXELS_H][PIXELS_W]
+) noexcept {
+    MacroBlock macroBlock;
+
+    if (!read(inputStream, quantizationScale, macroBlock))
+        return false;
 
+    decode(macroBlock, pPixelsOut);
     return true;
 }
 
@@ -1,8 +1,6 @@
 #pragma once
 
-#include "Macros.h"
-
-#include <cstdint>
+#include "Block.h"
 
 BEGIN_NAMESPACE(movie)
 
@@ -13,6 +11,23 @@ BEGIN_NAMESPACE(MacroBlockDecoder)
 static constexpr uint32_t PIXELS_W = 16;    // Width of the decoded block in pixels
 static constexpr uint32_t PIXELS_H = 16;    // Height of the decoded block in pixels
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Holds the 6 blocks within a macro block after they have been read from the bitstream, but before they have been decoded.
+// Note that the chroma blocks cover a 16x16 pixel area but each luma block covers a 8x8 pixel area.
+//------------------------------------------------------------------------------------------------------------------------------------------
+struct MacroBlock {
+    Block   blockCr;        // Chroma Red
+    Block   blockCb;        // Chroma Blue
+    Block   blockY[4];      // Luma: top left, top right, bottom left, bottom right
+};
+
+bool read(MBlockBitStream& inputStream, const int16_t quantizationScale, MacroBlock& macroBlockOut) noexcept;
+
+void decode(
+    MacroBlock& macroBlock,
+    uint32_t pPixelsOut[PIXELS_H][PIXELS_W]     // 32-bit ABGR8888 format
+) noexcept;
+
 bool decode(
     MBlockBitStream& inputStream,
     const int16_t quantizationScale,
@@ -26,6 +26,9 @@ BEGIN_NAMESPACE(MoviePlayer)
 // How many audio sectors to read ahead for
 static constexpr uint32_t AUDIO_BUFFER_SECTORS = 16;
 
+// How often the audio decode thread checks for free audio sectors to decode into
+static constexpr auto AUDIO_DECODE_POLL_TIME = std::chrono::milliseconds(2);
+
 // Convenience typedefs
 typedef XAAdpcmDecoder::SectorAudio             AudioSector;
 typedef std::unique_ptr<Video::IVideoSurface>   IVideoSurfacePtr;
@@ -51,6 +54,8 @@ static std::vector<AudioSector*>    gDecodingAudioSectors;                  // W
 static std::vector<AudioSector*>    gReadyAudioSectors;                     // Which audio sectors are populated with data and ready to use
 static Spu::ExtInputCallback        gPrevAudioExtInput;                     // Previous audio external input callback: restored after playback finishes
 static void*                        gPrevAudioExtInputUserdata;             // User data for the previous audio external input callback
+static std::thread                  gAudioDecodeThread;                     // Decodes audio sectors ahead of time, off the main thread
+static std::atomic<bool>            gbAudioDecodeThreadQuit;                // Set to 'true' to tell the audio decode thread to exit
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Helper: returns an empty audio sector for decoding or 'nullptr' if there are none.
@@ -144,7 +149,7 @@ static bool tryDecodeMovieAudioSector() noexcept {
         gDecodingAudioSectors.erase(iter);
         
         // The audio sector is now free again since decoding failed
-        gEmptyAudioSectors.push_back(gpCurAudioSector);
+        gEmptyAudioSectors.push_back(pAudioSector);
 
         // We are done!
         return false;
@@ -171,6 +176,18 @@ static bool tryDecodeMovieAudioSector() noexcept {
     return true;    // Decoded an audio sector!
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Entry point for the thread which decodes movie audio ahead of time.
+// Keeps all free audio sectors populated until the end of the audio stream is reached or it is told to quit.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void audioDecodeThreadMain() noexcept {
+    while ((!gbAudioDecodeThreadQuit) && gbCanReadAudioSectors) {
+        // Decode as many sectors as there is room for, then wait a while for some to be consumed
+        while ((!gbAudioDecodeThreadQuit) && tryDecodeMovieAudioSector()) {}
+        std::this_thread::sleep_for(AUDIO_DECODE_POLL_TIME);
+    }
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Tries to load the next audio sample into the buffers.
 // May fail if the end of the stream is reached or a decoding error is encountered.
@@ -311,6 +328,10 @@ static bool initMoviePlayback(const char* const cdFilePath) noexcept {
             break;
     }
 
+    // Start decoding the rest of the audio in the background
+    gbAudioDecodeThreadQuit = false;
+    gAudioDecodeThread = std::thread(audioDecodeThreadMain);
+
     // Install the external audio input callback.
     // This will cause the movie's audio to be fed to the SPU:
     {
@@ -332,6 +353,12 @@ static bool initMoviePlayback(const char* const cdFilePath) noexcept {
 // Shuts down playback of the movie and cleans up resources
 //------------------------------------------------------------------------------------------------------------------------------------------
 static void shutdownMoviePlayback() noexcept {
+    // Stop decoding audio in the background
+    if (gAudioDecodeThread.joinable()) {
+        gbAudioDecodeThreadQuit = true;
+        gAudioDecodeThread.join();
+    }
+
     // Uninstall the audio callback and restore the previous one
     {
         PsxVm::LockSpu lockSpu;
@@ -485,9 +512,8 @@ static void moviePlaybackLoop(const float secondsPerFrame) noexcept {
         }
 
         // Show the currently loaded frame and update the window afterwards.
-        // Also buffer audio on the main thread, so it's ready for the audio thread when needed.
+        // Note: audio is buffered by the audio decode thread, so it's ready for the audio thread when needed.
         displayCurrentVideoFrame();
-        tryDecodeMovieAudioSector();
         Input::update();
     }
 
@@ -30,41 +30,72 @@ static uint32_t getSamplesPerAdpcmChunk(const bool bStereo, const bool b8Bit) no
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Helper: converts an unsigned 4-bit sample to a signed 16-bit quantity
+// Filter and shift parameters for one block/group of 28 ADPCM samples, taken from the block's XA-ADPCM header
 //------------------------------------------------------------------------------------------------------------------------------------------
-static int16_t sampleNibbleToSigned16Bit(const uint16_t nibble) noexcept {
-    if (nibble & 0x8) {
-        return (int16_t)((int32_t)(nibble << 12u) - 65536);
-    } else {
-        return (int16_t)(nibble << 12u);
-    }
+struct BlockParams {
+    int32_t     sampleShift;
+    int32_t     posFilter;
+    int32_t     negFilter;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Helper: gets the filter and shift parameters for the specified block in an ADPCM chunk
+//------------------------------------------------------------------------------------------------------------------------------------------
+static BlockParams getBlockParams(const uint8_t* const pDataIn, const uint32_t blockIdx) noexcept {
+    // Note: the XA-ADPCM headers for each block are found in the first 16-bytes.
+    // The first and last 4 bytes are copies of the ones in the middle, starting at byte 4.
+    const uint8_t xaAdpcmHdr = pDataIn[4 + blockIdx];
+
+    // Get the sample shift and filter coefficients via the XA-ADPCM header
+    const uint8_t xaHdrShiftBits = xaAdpcmHdr & 0xFu;
+    const uint8_t xaHdrFilterBits = (xaAdpcmHdr >> 4) & 0x3u;
+
+    BlockParams params;
+    params.sampleShift = (xaHdrShiftBits < 13) ? xaHdrShiftBits : 9;   // Per NO$PSX: shift >= 13 acts the same as '9'
+    params.posFilter = XA_ADPCM_POS_FILTER_TBL[xaHdrFilterBits];
+    params.negFilter = XA_ADPCM_NEG_FILTER_TBL[xaHdrFilterBits];
+    return params;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Helper: converts an unsigned 8-bit sample to a signed 16-bit quantity
+// Helper: extracts the 28 unfiltered 4 or 8 bit samples for the specified block in an ADPCM chunk.
+// The samples are sign extended to 16-bits and shifted according to the block's header, ready for filtering.
+// There are no dependencies between samples here so compilers can vectorize this loop.
 //------------------------------------------------------------------------------------------------------------------------------------------
-static int16_t sampleByteToSigned16Bit(const uint16_t byte) noexcept {
-    if (byte & 0x80) {
-        return (int16_t)((int32_t)(byte << 8u) - 65536);
-    } else {
-        return (int16_t)(byte << 8u);
+template <bool FOUR_BIT>
+static void unpackBlockSamples(
+    const uint32_t* const pDataWords,
+    const uint32_t blockIdx,
+    const int32_t sampleShift,
+    int32_t samplesOut[ADPCM_DATA_WORDS_PER_CHUNK]
+) noexcept {
+    for (uint32_t sampleIdx = 0; sampleIdx < ADPCM_DATA_WORDS_PER_CHUNK; ++sampleIdx) {
+        // Move the 4 or 8 bit sample into the top bits of a signed 16-bit integer: this converts to a signed 16-bit sample
+        int16_t unfilteredSample;
+
+        if constexpr (FOUR_BIT) {
+            unfilteredSample = (int16_t)(uint16_t)(pDataWords[sampleIdx] >> (blockIdx * 4) << 12);
+        } else {
+            unfilteredSample = (int16_t)(uint16_t)(pDataWords[sampleIdx] >> (blockIdx * 8) << 8);
+        }
+
+        samplesOut[sampleIdx] = unfilteredSample >> sampleShift;
     }
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Helper: decodes a single ADPCM sample.
-// Takes as input the decoding context, the unfiltered 16-bit sample, the filter coefficients, the shift amount and the previous samples.
+// Helper: applies the ADPCM filter to a single shifted sample, given the previous samples and filter coefficients.
+// The result is clamped to the 16-bit range.
 //------------------------------------------------------------------------------------------------------------------------------------------
-static int16_t decodeAdpcmSample(
-    const int16_t unfilteredSample,
-    const int16_t prevSample1,          // Old sample
-    const int16_t prevSample2,          // Oldest sample
-    const uint8_t sampleShift,
-    const int16_t posFilter,
-    const int16_t negFilter
+static int32_t filterAdpcmSample(
+    const int32_t shiftedSample,
+    const int32_t prevSample1,      // Old sample
+    const int32_t prevSample2,      // Oldest sample
+    const int32_t posFilter,
+    const int32_t negFilter
 ) noexcept {
-    const int32_t filteredSample = (unfilteredSample >> sampleShift) + (prevSample1 * posFilter + prevSample2 * negFilter + 32) / 64;
-    return (int16_t) std::clamp(
+    const int32_t filteredSample = shiftedSample + (prevSample1 * posFilter + prevSample2 * negFilter + 32) / 64;
+    return std::clamp(
         filteredSample,
         (int32_t) std::numeric_limits<int16_t>::min(),
         (int32_t) std::numeric_limits<int16_t>::max()
@@ -74,6 +105,10 @@ static int16_t decodeAdpcmSample(
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Decodes a chunk of ADPCM samples in 4-bit or 8-bit mono or stereo formats.
 // For more on this, see: https://problemkaputt.de/psx-spx.htm#cdromxaaudioadpcmcompression
+//
+// Each block/group of samples is decoded in two steps: unpacking the raw samples (which has no dependencies between samples) and then
+// applying the filter, which depends on previous samples and must be done serially. In stereo mode the left and right channel blocks are
+// filtered together in the same loop since they are independent, which lets the CPU work on both channels at once.
 //------------------------------------------------------------------------------------------------------------------------------------------
 template <bool FOUR_BIT, bool STEREO>
 static void decodeAdpcmChunk(Context& ctx, const uint8_t* const pDataIn, int16_t* const pSamplesOut) noexcept {
@@ -86,80 +121,65 @@ static void decodeAdpcmChunk(Context& ctx, const uint8_t* const pDataIn, int16_t
     // This depends on whether the sample format is 4 or 8 bit:
     constexpr uint32_t NUM_BLOCKS = (FOUR_BIT) ? 8 : 4;
 
-    for (uint32_t blockIdx = 0; blockIdx < NUM_BLOCKS; ++blockIdx) {
-        // Note: the XA-ADPCM headers for each block are found in the first 16-bytes.
-        // The first and last 4 bytes are copies of the ones in the middle, starting at byte 4.
-        const uint8_t xaAdpcmHdr = pDataIn[4 + blockIdx];
-
-        // Get the sample shift and filter coefficients via the XA-ADPCM header
-        const uint8_t xaHdrShiftBits = xaAdpcmHdr & 0xFu;
-        const uint8_t xaHdrFilterBits = (xaAdpcmHdr >> 4) & 0x3u;
-        const uint8_t sampleShift = (xaHdrShiftBits < 13) ? xaHdrShiftBits : 9;   // Per NO$PSX: shift >= 13 acts the same as '9'
-        const int16_t posFilter = XA_ADPCM_POS_FILTER_TBL[xaHdrFilterBits];
-        const int16_t negFilter = XA_ADPCM_NEG_FILTER_TBL[xaHdrFilterBits];
-
-        // Decode each sample in the block (28 total)
-        for (uint32_t sampleIdx = 0; sampleIdx < ADPCM_DATA_WORDS_PER_CHUNK; ++sampleIdx) {
-            // Get the unfiltered 4 or 8 bit sample and convert to a signed 16-bit sample:
-            int16_t unfilteredSample;
-
-            if constexpr (FOUR_BIT) {
-                const uint8_t sampleNibble = (uint8_t)((pDataWords[sampleIdx] >> (blockIdx * 4)) & 0xFu);
-                unfilteredSample = sampleNibbleToSigned16Bit(sampleNibble);
-            } else {
-                const uint8_t sampleByte = (uint8_t)(pDataWords[sampleIdx] >> (blockIdx * 8));
-                unfilteredSample = sampleByteToSigned16Bit(sampleByte);
-            }
-
-            // Are we dealing with a mono or stereo data stream?
-            // If it's mono then we double up the sample across both channels:
-            if constexpr (STEREO) {
-                // Stereo: is this the left or right channel?
-                // The blocks for each channel are interleaved, with left being the first:
-                const bool bIsRightChannel = (blockIdx & 1);
-
-                if (bIsRightChannel) {
-                    const int16_t prevSample1 = ctx.prevSamplesR[0];
-                    const int16_t prevSample2 = ctx.prevSamplesR[1];
-                    const int16_t sample = decodeAdpcmSample(unfilteredSample, prevSample1, prevSample2, sampleShift, posFilter, negFilter);
-                    pOutSample[0] = sample;
-                    ctx.addPrevRSample(sample);
-                } else {
-                    const int16_t prevSample1 = ctx.prevSamplesL[0];
-                    const int16_t prevSample2 = ctx.prevSamplesL[1];
-                    const int16_t sample = decodeAdpcmSample(unfilteredSample, prevSample1, prevSample2, sampleShift, posFilter, negFilter);
-                    pOutSample[0] = sample;
-                    ctx.addPrevLSample(sample);
-                }
-
-                pOutSample += 2;    // Note: the other channel will be handled by a separate block
-            } else {
-                // Mono: double up the sample for the left and right channels
-                const int16_t prevSample1 = ctx.prevSamplesL[0];
-                const int16_t prevSample2 = ctx.prevSamplesL[1];
-                const int16_t sample = decodeAdpcmSample(unfilteredSample, prevSample1, prevSample2, sampleShift, posFilter, negFilter);
-                pOutSample[0] = sample;
-                pOutSample[1] = sample;
-                ctx.addPrevLSample(sample);
-                ctx.addPrevRSample(sample);
+    // Previous samples for the filters: kept in locals while decoding the chunk
+    int32_t prevL1 = ctx.prevSamplesL[0];
+    int32_t prevL2 = ctx.prevSamplesL[1];
+    int32_t prevR1 = ctx.prevSamplesR[0];
+    int32_t prevR2 = ctx.prevSamplesR[1];
+
+    if constexpr (STEREO) {
+        // Stereo: the blocks for each channel are interleaved, with left being the first.
+        // Decode each pair of left and right blocks together:
+        for (uint32_t blockIdx = 0; blockIdx < NUM_BLOCKS; blockIdx += 2) {
+            const BlockParams paramsL = getBlockParams(pDataIn, blockIdx);
+            const BlockParams paramsR = getBlockParams(pDataIn, blockIdx + 1);
+
+            int32_t samplesL[ADPCM_DATA_WORDS_PER_CHUNK];
+            int32_t samplesR[ADPCM_DATA_WORDS_PER_CHUNK];
+            unpackBlockSamples<FOUR_BIT>(pDataWords, blockIdx, paramsL.sampleShift, samplesL);
+            unpackBlockSamples<FOUR_BIT>(pDataWords, blockIdx + 1, paramsR.sampleShift, samplesR);
+
+            for (uint32_t sampleIdx = 0; sampleIdx < ADPCM_DATA_WORDS_PER_CHUNK; ++sampleIdx) {
+                const int32_t sampleL = filterAdpcmSample(samplesL[sampleIdx], prevL1, prevL2, paramsL.posFilter, paramsL.negFilter);
+                const int32_t sampleR = filterAdpcmSample(samplesR[sampleIdx], prevR1, prevR2, paramsR.posFilter, paramsR.negFilter);
+                pOutSample[0] = (int16_t) sampleL;
+                pOutSample[1] = (int16_t) sampleR;
                 pOutSample += 2;
+
+                prevL2 = prevL1;
+                prevL1 = sampleL;
+                prevR2 = prevR1;
+                prevR1 = sampleR;
             }
         }
+    } else {
+        // Mono: double up the samples for the left and right channels
+        for (uint32_t blockIdx = 0; blockIdx < NUM_BLOCKS; ++blockIdx) {
+            const BlockParams params = getBlockParams(pDataIn, blockIdx);
 
-        // Handle the end of the block for stereo mode, need to do rewinding due to the stride between channel samples
-        if constexpr (STEREO) {
-            const bool bIsRightChannel = (blockIdx & 1);
+            int32_t samples[ADPCM_DATA_WORDS_PER_CHUNK];
+            unpackBlockSamples<FOUR_BIT>(pDataWords, blockIdx, params.sampleShift, samples);
 
-            if (bIsRightChannel) {
-                // Put us onto the left channel for the next block
-                pOutSample -= 1;
-            } else {
-                // Put us onto the right channel for the current block
-                pOutSample -= ADPCM_DATA_WORDS_PER_CHUNK * 2;
-                pOutSample += 1;
+            for (uint32_t sampleIdx = 0; sampleIdx < ADPCM_DATA_WORDS_PER_CHUNK; ++sampleIdx) {
+                const int32_t sample = filterAdpcmSample(samples[sampleIdx], prevL1, prevL2, params.posFilter, params.negFilter);
+                pOutSample[0] = (int16_t) sample;
+                pOutSample[1] = (int16_t) sample;
+                pOutSample += 2;
+
+                prevL2 = prevL1;
+                prevL1 = sample;
             }
         }
+
+        prevR1 = prevL1;
+        prevR2 = prevL2;
     }
+
+    // Save the previous samples for the next chunk
+    ctx.prevSamplesL[0] = (int16_t) prevL1;
+    ctx.prevSamplesL[1] = (int16_t) prevL2;
+    ctx.prevSamplesR[0] = (int16_t) prevR1;
+    ctx.prevSamplesR[1] = (int16_t) prevR2;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
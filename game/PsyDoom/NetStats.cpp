@@ -0,0 +1,260 @@
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Network telemetry for network games: round trip time, jitter, stalled ticks and bandwidth, which are shown in the net graph overlay.
+// Also contains the adaptive input delay controller, which picks the smallest input delay that avoids stalling on the other player.
+//
+// The input delay is how many ticks ahead of when they are used that our inputs are sent to the other player. Since this determines how
+// early our packets arrive at the other end, it's the other player's stalls (reported back in each tick packet) that decide our delay.
+//
+// Round trip time is measured by echoing timestamps in the tick packets: each packet contains the sender's clock when it was sent, the
+// send time of the last packet it received from us and how long it held onto that packet before sending. The hold time is subtracted so
+// that the round trip time only includes time spent in the network and not the other player's frame time. Jitter is computed from the
+// variation in one-way transit times in the same way as RFC 3550, which does not require the clocks of both players to be in sync.
+//------------------------------------------------------------------------------------------------------------------------------------------
+#include "NetStats.h"
+
+#include "Doom/doomdef.h"
+#include "Network.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
+BEGIN_NAMESPACE(NetStats)
+
+typedef std::chrono::system_clock::time_point time_point_t;
+
+// Sentinel value for 'NetPacket_Tick::echoHoldMs' when no packet has been received from the other player yet
+static constexpr uint16_t NO_ECHO_HOLD_MS = UINT16_MAX;
+
+// How often bandwidth figures are updated
+static constexpr float BANDWIDTH_UPDATE_INTERVAL = 1.0f;
+
+// Adaptive input delay controller settings.
+// The input delay is increased if the other player stalls more than once within a short window and decreased again once our packets have
+// consistently been arriving at the other player more than a full tick ahead of when they are needed for a while, with no stalls.
+static constexpr float INCREASE_STALL_WINDOW    = 2.0f;     // Increase delay if two stalls occur within this many seconds
+static constexpr float MIN_DELAY_CHANGE_TIME    = 1.0f;     // Don't change the delay again until this many seconds after the last change
+static constexpr float DECREASE_CALM_TIME       = 10.0f;    // Decrease delay after no stalls for this many seconds...
+static constexpr float DECREASE_SLACK_MARGIN_MS = 5.0f;     // ...and packets always arrived at least this long more than a tick early
+
+float       gRttMs;                         // Smoothed round trip time to the other player (MS), not including time either player held packets
+float       gJitterMs;                      // Smoothed variation in the one-way transit time of tick packets (MS)
+uint32_t    gNumStalledTicks;               // Total number of ticks where the game had to wait on the network for the other player
+uint32_t    gNumPeerStalledTicks;           // Total number of ticks where the other player reported it had to wait on the network for us
+float       gSendBytesPerSec;               // Tick packet bytes sent per second, including transport overhead
+float       gRecvBytesPerSec;               // Tick packet bytes received per second, including transport overhead
+GraphTick   gGraphTicks[GRAPH_NUM_TICKS];   // Ring buffer of network wait times for the most recent ticks
+int32_t     gGraphNextTickIdx;              // Where the next tick will be written to in the net graph ring buffer
+
+static bool         gbHaveRecvPacket;       // True if a tick packet has been received from the other player
+static uint16_t     gLastRecvSendTimeMs;    // The 'sendTimeMs' of the last tick packet received from the other player
+static time_point_t gLastRecvTime;          // When the last tick packet from the other player was received
+static bool         gbHaveTransitMs;        // True if 'gLastTransitMs' is valid
+static uint16_t     gLastTransitMs;         // Last one-way transit time (MS) using both player's clocks: includes the clock offset
+static time_point_t gLastUpdateTime;        // When 'onIncomingPacket' was last called
+static float        gAvgTickIntervalMs;     // Smoothed time between ticks (MS)
+static time_point_t gBandwidthStartTime;    // When bandwidth measurement started for the current interval
+static uint64_t     gBandwidthStartSent;    // Tick bytes sent at the start of the current bandwidth measurement interval
+static uint64_t     gBandwidthStartRecv;    // Tick bytes received at the start of the current bandwidth measurement interval
+static int16_t      gRecvSlackMs;           // Reported to the other player: slack for their last packet, or minus how long we stalled waiting on it
+static time_point_t gLastStallTime;         // When the last stall happened (before the current tick)
+static time_point_t gLastDelayChangeTime;   // When the adaptive input delay was last changed
+static time_point_t gCalmStartTime;         // When the current period of no stalls started (for decreasing delay)
+static float        gCalmMinSlackMs;        // The least amount of time our packets were waiting before being needed, during the current calm period
+static int16_t      gPeerRecvSlackMs;       // The 'recvSlackMs' reported in the last packet from the other player
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Helper: get a wrapping millisecond timestamp for the given time, used for exchanging times in tick packets
+//------------------------------------------------------------------------------------------------------------------------------------------
+static uint16_t toPacketTimeMs(const time_point_t time) noexcept {
+    return (uint16_t) std::chrono::duration_cast<std::chrono::milliseconds>(time.time_since_epoch()).count();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Helper: get the number of seconds elapsed between two times
+//------------------------------------------------------------------------------------------------------------------------------------------
+static float getSecondsBetween(const time_point_t start, const time_point_t end) noexcept {
+    return std::chrono::duration<float>(end - start).count();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Clears all network telemetry: should be called when a new network connection is established
+//------------------------------------------------------------------------------------------------------------------------------------------
+void init() noexcept {
+    const time_point_t now = std::chrono::system_clock::now();
+
+    gRttMs = 0.0f;
+    gJitterMs = 0.0f;
+    gNumStalledTicks = 0;
+    gNumPeerStalledTicks = 0;
+    gSendBytesPerSec = 0.0f;
+    gRecvBytesPerSec = 0.0f;
+    std::fill(std::begin(gGraphTicks), std::end(gGraphTicks), GraphTick{});
+    gGraphNextTickIdx = 0;
+
+    gbHaveRecvPacket = false;
+    gLastRecvSendTimeMs = 0;
+    gLastRecvTime = {};
+    gbHaveTransitMs = false;
+    gLastTransitMs = 0;
+    gLastUpdateTime = {};
+    gAvgTickIntervalMs = 0.0f;
+    gBandwidthStartTime = now;
+    gBandwidthStartSent = 0;
+    gBandwidthStartRecv = 0;
+    gRecvSlackMs = 0;
+    gLastStallTime = {};
+    gLastDelayChangeTime = now;
+    gCalmStartTime = now;
+    gCalmMinSlackMs = INFINITY;
+    gPeerRecvSlackMs = 0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Fills in the telemetry timestamps for a tick packet which is about to be sent (fields are in host byte order)
+//------------------------------------------------------------------------------------------------------------------------------------------
+void stampOutgoingPacket(NetPacket_Tick& packet) noexcept {
+    const time_point_t now = std::chrono::system_clock::now();
+    packet.sendTimeMs = toPacketTimeMs(now);
+
+    if (gbHaveRecvPacket) {
+        const int64_t holdMs = std::chrono::duration_cast<std::chrono::milliseconds>(now - gLastRecvTime).count();
+        packet.echoTimeMs = gLastRecvSendTimeMs;
+        packet.echoHoldMs = (uint16_t) std::clamp<int64_t>(holdMs, 0, NO_ECHO_HOLD_MS - 1);
+    } else {
+        packet.echoTimeMs = 0;
+        packet.echoHoldMs = NO_ECHO_HOLD_MS;
+    }
+
+    packet.recvSlackMs = gRecvSlackMs;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Updates telemetry for a tick packet received from the other player (fields are in host byte order) and the time it was received at.
+// Should be called once per tick, right after the tick packet is received.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void onIncomingPacket(const NetPacket_Tick& packet, const time_point_t receiveTime) noexcept {
+    const time_point_t now = std::chrono::system_clock::now();
+    const uint16_t recvTimeMs = toPacketTimeMs(receiveTime);
+
+    // Round trip time: how long ago we sent the packet being echoed, minus how long the other player held onto it.
+    // Note: all of this arithmetic is done using wrapping 16-bit millisecond timestamps.
+    if (packet.echoHoldMs != NO_ECHO_HOLD_MS) {
+        const uint16_t rttMs = (uint16_t)(recvTimeMs - packet.echoTimeMs - packet.echoHoldMs);
+
+        // Ignore nonsense values, which can happen due to rounding the timestamps to whole milliseconds
+        if (rttMs < INT16_MAX) {
+            gRttMs = (gRttMs > 0.0f) ? gRttMs + ((float) rttMs - gRttMs) / 8.0f : (float) rttMs;
+        }
+    }
+
+    // Jitter: the smoothed change in one-way transit time between consecutive packets (RFC 3550 style)
+    const uint16_t transitMs = (uint16_t)(recvTimeMs - packet.sendTimeMs);
+
+    if (gbHaveTransitMs) {
+        const float transitChangeMs = (float) std::abs((int16_t)(transitMs - gLastTransitMs));
+        gJitterMs += (transitChangeMs - gJitterMs) / 16.0f;
+    }
+
+    gbHaveTransitMs = true;
+    gLastTransitMs = transitMs;
+
+    // Save the details needed to echo this packet's timestamp back to the other player
+    gbHaveRecvPacket = true;
+    gLastRecvSendTimeMs = packet.sendTimeMs;
+    gLastRecvTime = receiveTime;
+
+    // Update the average time between ticks
+    if (gLastUpdateTime != time_point_t{}) {
+        const float tickIntervalMs = getSecondsBetween(gLastUpdateTime, now) * 1000.0f;
+        gAvgTickIntervalMs = (gAvgTickIntervalMs > 0.0f) ? gAvgTickIntervalMs + (tickIntervalMs - gAvgTickIntervalMs) / 16.0f : tickIntervalMs;
+    }
+
+    gLastUpdateTime = now;
+
+    // Record how long we waited on the network for this tick and whether the tick was stalled
+    Network::TickTrafficStats trafficStats = {};
+    Network::getTickTrafficStats(trafficStats);
+
+    const bool bTickWasStalled = (trafficStats.lastRecvWaitUsec > STALL_THRESHOLD_USEC);
+
+    if (bTickWasStalled) {
+        gNumStalledTicks++;
+    }
+
+    GraphTick& graphTick = gGraphTicks[gGraphNextTickIdx];
+    graphTick.waitMs = (float) trafficStats.lastRecvWaitUsec / 1000.0f;
+    graphTick.bStalled = bTickWasStalled;
+    gGraphNextTickIdx = (gGraphNextTickIdx + 1) % GRAPH_NUM_TICKS;
+
+    // Tell the other player how long their packet was waiting before we needed it (how much they could reduce their input delay by) or
+    // how long we stalled waiting for it, if we were stalled. A negative value always means a stall.
+    if (bTickWasStalled) {
+        gRecvSlackMs = (int16_t) -std::min<int64_t>(trafficStats.lastRecvWaitUsec / 1000 + 1, INT16_MAX);
+    } else {
+        gRecvSlackMs = (int16_t) std::min<int64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(now - receiveTime).count(), INT16_MAX);
+    }
+
+    gPeerRecvSlackMs = packet.recvSlackMs;
+
+    if (gPeerRecvSlackMs < 0) {
+        gNumPeerStalledTicks++;
+    }
+
+    // Update bandwidth usage periodically
+    const float bandwidthInterval = getSecondsBetween(gBandwidthStartTime, now);
+
+    if (bandwidthInterval >= BANDWIDTH_UPDATE_INTERVAL) {
+        gSendBytesPerSec = (float)(trafficStats.numBytesSent - gBandwidthStartSent) / bandwidthInterval;
+        gRecvBytesPerSec = (float)(trafficStats.numBytesRecv - gBandwidthStartRecv) / bandwidthInterval;
+        gBandwidthStartTime = now;
+        gBandwidthStartSent = trafficStats.numBytesSent;
+        gBandwidthStartRecv = trafficStats.numBytesRecv;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Adaptive input delay controller: returns the input delay (in ticks) that should be used from now on, given the current input delay.
+// Only ever changes the delay by one tick at a time, and should be called once per tick after 'onIncomingPacket'.
+//------------------------------------------------------------------------------------------------------------------------------------------
+int32_t getAdaptiveInputDelay(const int32_t curInputDelay) noexcept {
+    const time_point_t now = std::chrono::system_clock::now();
+    const bool bCanChangeDelay = (getSecondsBetween(gLastDelayChangeTime, now) >= MIN_DELAY_CHANGE_TIME);
+    int32_t newInputDelay = curInputDelay;
+
+    if (gPeerRecvSlackMs < 0) {
+        // The other player stalled repeatedly: increase the delay so our inputs arrive in time
+        const bool bRepeatedStall = (
+            (gLastStallTime != time_point_t{}) &&
+            (getSecondsBetween(gLastStallTime, now) <= INCREASE_STALL_WINDOW)
+        );
+
+        if (bRepeatedStall && bCanChangeDelay && (curInputDelay < NET_MAX_INPUT_DELAY)) {
+            newInputDelay = curInputDelay + 1;
+        }
+
+        gLastStallTime = now;
+        gCalmStartTime = now;
+        gCalmMinSlackMs = INFINITY;
+    } else {
+        gCalmMinSlackMs = std::min(gCalmMinSlackMs, (float) gPeerRecvSlackMs);
+    }
+
+    if ((curInputDelay > 1) && bCanChangeDelay && (getSecondsBetween(gCalmStartTime, now) >= DECREASE_CALM_TIME)) {
+        // No stalls for a while: decrease the delay if our packets have always been arriving over a tick before they were needed
+        if (gCalmMinSlackMs >= gAvgTickIntervalMs + DECREASE_SLACK_MARGIN_MS) {
+            newInputDelay = curInputDelay - 1;
+        }
+
+        gCalmStartTime = now;
+        gCalmMinSlackMs = INFINITY;
+    }
+
+    if (newInputDelay != curInputDelay) {
+        gLastDelayChangeTime = now;
+    }
+
+    return newInputDelay;
+}
+
+END_NAMESPACE(NetStats)
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "Macros.h"
+
+#include <chrono>
+#include <cstdint>
+
+struct NetPacket_Tick;
+
+BEGIN_NAMESPACE(NetStats)
+
+// How many of the most recent ticks are kept for the net graph
+static constexpr int32_t GRAPH_NUM_TICKS = 64;
+
+// A tick is counted as stalled if the game had to wait longer than this for the other player's tick packet
+static constexpr int64_t STALL_THRESHOLD_USEC = 2000;
+
+// Network wait time and whether the tick was stalled, for one tick in the net graph
+struct GraphTick {
+    float   waitMs;
+    bool    bStalled;
+};
+
+extern float        gRttMs;
+extern float        gJitterMs;
+extern uint32_t     gNumStalledTicks;
+extern uint32_t     gNumPeerStalledTicks;
+extern float        gSendBytesPerSec;
+extern float        gRecvBytesPerSec;
+extern GraphTick    gGraphTicks[GRAPH_NUM_TICKS];
+extern int32_t      gGraphNextTickIdx;
+
+void init() noexcept;
+void stampOutgoingPacket(NetPacket_Tick& packet) noexcept;
+void onIncomingPacket(const NetPacket_Tick& packet, const std::chrono::system_clock::time_point receiveTime) noexcept;
+int32_t getAdaptiveInputDelay(const int32_t curInputDelay) noexcept;
+
+END_NAMESPACE(NetStats)
@@ -3,6 +3,7 @@
 #include "Doom/Base/i_main.h"
 #include "Doom/Game/p_tick.h"
 #include "Doom/UI/m_main.h"
+#include "Endian.h"
 #include "Input.h"
 #include "NetPacketReader.h"
 #include "NetPacketWriter.h"
@@ -21,19 +22,76 @@ BEGIN_DISABLE_HEADER_WARNINGS
     #include <asio.hpp>
 END_DISABLE_HEADER_WARNINGS
 
+#include <algorithm>
+#include <cstring>
+#include <deque>
+
 BEGIN_NAMESPACE(Network)
 
 // A flag set to true if network init was aborted by the user
 bool gbWasInitAborted = false;
 
-// Maximum number of input/output tick packets that can be buffered
-static constexpr int32_t MAX_TICK_PKTS = 2;
+// Maximum number of input/output tick packets that can be buffered: enough for packets sent ahead by the maximum input delay
+static constexpr int32_t MAX_TICK_PKTS = NET_MAX_INPUT_DELAY + 1;
 
 static std::unique_ptr<asio::io_context>                                    gpIoContext;
 static std::unique_ptr<asio::ip::tcp::socket>                               gpSocket;
 static std::unique_ptr<NetPacketReader<NetPacket_Tick, MAX_TICK_PKTS>>      gTickPacketReader;
 static std::unique_ptr<NetPacketWriter<NetPacket_Tick, MAX_TICK_PKTS>>      gTickPacketWriter;
 static bool                                                                 gbWasWaitForAsyncNetOpAborted;
+static TickTrafficStats                                                     gTickTrafficStats;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Optional UDP transport for tick packets.
+//
+// After the connection is established and the game details are exchanged via TCP, both peers can switch to sending tick packets over UDP.
+// Each datagram contains up to the last 'UDP_MAX_TICKS_PER_DGRAM' tick packets which the other peer has not yet acknowledged, along with
+// a sequence number for the first tick packet in the datagram and an acknowledgement of how many tick packets have been received so far.
+// This means that a lost datagram costs nothing if the next datagram arrives, since it will contain the lost tick packets also.
+// If no acknowledgement arrives then any unacknowledged tick packets are resent periodically, until the peer times out.
+// Tick packets are always delivered in order and exactly once, so the 'sendTickPacket'/'recvTickPacket' API works the same as with TCP.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static constexpr uint32_t   UDP_DGRAM_SIGNATURE         = 0x50445044;   // 'DPDP' in little endian: identifies a PsyDoom tick datagram
+static constexpr uint32_t   UDP_MAX_TICKS_PER_DGRAM     = 8;            // Maximum number of (redundant) tick packets sent in each datagram
+static constexpr uint32_t   UDP_MAX_UNACKED_TICKS       = 256;          // If the peer gets this far behind acknowledging packets then the connection is dropped
+static constexpr int32_t    UDP_RESEND_INTERVAL_MS      = 10;           // How often to resend unacknowledged tick packets
+static constexpr int32_t    UDP_TIMEOUT_MS              = 10000;        // Drop the connection if nothing is received from the peer for this long
+
+// Header for a tick datagram: followed by 'numTicks' tick packets. All fields are little endian.
+struct UdpDgramHdr {
+    uint32_t    signature;      // Must be 'UDP_DGRAM_SIGNATURE'
+    uint32_t    firstTickSeq;   // Sequence number of the first tick packet in this datagram
+    uint32_t    ackTickSeq;     // Acknowledgement: the number of tick packets received in order by the sender of this datagram
+    uint32_t    numTicks;       // The number of tick packets in this datagram
+};
+
+static_assert(sizeof(UdpDgramHdr) == 16);
+static constexpr uint32_t UDP_MAX_DGRAM_SIZE = sizeof(UdpDgramHdr) + UDP_MAX_TICKS_PER_DGRAM * sizeof(NetPacket_Tick);
+
+// A tick packet received over UDP and the time it arrived at
+struct UdpRecvTick {
+    NetPacket_Tick                          packet;
+    std::chrono::system_clock::time_point   receiveTime;
+};
+
+typedef std::chrono::steady_clock udp_clock_t;
+
+static std::unique_ptr<asio::ip::udp::socket>   gpUdpSocket;                // The UDP socket used for tick packets (if using UDP)
+static std::unique_ptr<asio::steady_timer>      gpUdpResendTimer;           // Timer used to periodically resend unacknowledged tick packets
+static asio::ip::udp::endpoint                  gUdpPeerEndpoint;           // Where to send datagrams to: updated when datagrams are received (for NAT)
+static asio::ip::udp::endpoint                  gUdpRecvEndpoint;           // The sender of the datagram currently being received
+static std::byte                                gUdpRecvBuffer[UDP_MAX_DGRAM_SIZE];
+static std::byte                                gUdpSendBuffer[UDP_MAX_DGRAM_SIZE];
+static std::deque<NetPacket_Tick>               gUdpUnackedTicks;           // Sent tick packets which the peer has not acknowledged yet
+static uint32_t                                 gUdpUnackedFirstSeq;        // Sequence number of the first unacknowledged tick packet
+static std::deque<UdpRecvTick>                  gUdpRecvTicks;              // Received tick packets (in order) which have not yet been consumed
+static uint32_t                                 gUdpRecvNextSeq;            // Sequence number of the next tick packet expected from the peer
+static udp_clock_t::time_point                  gUdpLastSendTime;           // When a datagram was last sent
+static udp_clock_t::time_point                  gUdpLastRecvTime;           // When a datagram was last received from the peer
+static udp_clock_t::time_point                  gUdpWaitStartTime;          // When we started waiting on a tick packet from the peer (for timeouts)
+static bool                                     gbUdpWaitingForTick;        // True if currently blocked waiting for a tick packet from the peer
+static bool                                     gbUdpHasRecvTicks;          // True if 'gUdpRecvTicks' is not empty, or an error occurred (used for waiting)
+static bool                                     gbUdpError;                 // Set if the peer timed out or some other error occurred
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Checks for user input to cancel an abortable network operation like establishing a connection
@@ -115,6 +173,153 @@ static void postConnectSetup(asio::ip::tcp::socket& socket) noexcept {
     gTickPacketWriter.reset(new NetPacketWriter<NetPacket_Tick, MAX_TICK_PKTS>(*gpSocket));
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// UDP transport: sends a datagram to the peer containing the oldest unacknowledged tick packets (if any) and an acknowledgement of the
+// tick packets received so far. Send errors are ignored since datagrams can be lost anyway; the resend logic will cover for them.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void udpSendDgram() noexcept {
+    const uint32_t numTicks = std::min((uint32_t) gUdpUnackedTicks.size(), UDP_MAX_TICKS_PER_DGRAM);
+
+    UdpDgramHdr hdr = {};
+    hdr.signature = Endian::hostToLittle(UDP_DGRAM_SIGNATURE);
+    hdr.firstTickSeq = Endian::hostToLittle(gUdpUnackedFirstSeq);
+    hdr.ackTickSeq = Endian::hostToLittle(gUdpRecvNextSeq);
+    hdr.numTicks = Endian::hostToLittle(numTicks);
+    std::memcpy(gUdpSendBuffer, &hdr, sizeof(hdr));
+
+    // Note: tick packets are already endian corrected by the caller of 'sendTickPacket'
+    for (uint32_t i = 0; i < numTicks; ++i) {
+        std::memcpy(gUdpSendBuffer + sizeof(hdr) + i * sizeof(NetPacket_Tick), &gUdpUnackedTicks[i], sizeof(NetPacket_Tick));
+    }
+
+    const size_t dgramSize = sizeof(hdr) + numTicks * sizeof(NetPacket_Tick);
+    asio::error_code error;
+    gpUdpSocket->send_to(asio::buffer(gUdpSendBuffer, dgramSize), gUdpPeerEndpoint, 0, error);
+    gUdpLastSendTime = udp_clock_t::now();
+    gTickTrafficStats.numBytesSent += dgramSize;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// UDP transport: handles a datagram received from the peer, queuing any new tick packets it contains and discarding acknowledged ones
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void udpHandleDgram(const size_t dgramSize) noexcept {
+    // Only accept datagrams from the peer's address, and make sure the datagram is valid
+    if (gUdpRecvEndpoint.address() != gUdpPeerEndpoint.address())
+        return;
+
+    if (dgramSize < sizeof(UdpDgramHdr))
+        return;
+
+    UdpDgramHdr hdr = {};
+    std::memcpy(&hdr, gUdpRecvBuffer, sizeof(hdr));
+    hdr.signature = Endian::littleToHost(hdr.signature);
+    hdr.firstTickSeq = Endian::littleToHost(hdr.firstTickSeq);
+    hdr.ackTickSeq = Endian::littleToHost(hdr.ackTickSeq);
+    hdr.numTicks = Endian::littleToHost(hdr.numTicks);
+
+    const bool bValidDgram = (
+        (hdr.signature == UDP_DGRAM_SIGNATURE) &&
+        (hdr.numTicks <= UDP_MAX_TICKS_PER_DGRAM) &&
+        (dgramSize == sizeof(UdpDgramHdr) + hdr.numTicks * sizeof(NetPacket_Tick))
+    );
+
+    if (!bValidDgram)
+        return;
+
+    gTickTrafficStats.numBytesRecv += dgramSize;
+
+    // Send all future datagrams to wherever this one came from, in case a NAT changed the peer's port
+    gUdpPeerEndpoint = gUdpRecvEndpoint;
+
+    // Discard any tick packets the peer has acknowledged receiving
+    const int32_t numAcked = std::min((int32_t)(hdr.ackTickSeq - gUdpUnackedFirstSeq), (int32_t) gUdpUnackedTicks.size());
+
+    if (numAcked > 0) {
+        gUdpUnackedTicks.erase(gUdpUnackedTicks.begin(), gUdpUnackedTicks.begin() + numAcked);
+        gUdpUnackedFirstSeq += (uint32_t) numAcked;
+    }
+
+    // Queue up any tick packets which are the next in sequence, ignoring ones we already have
+    const std::chrono::system_clock::time_point receiveTime = std::chrono::system_clock::now();
+    bool bGotNewTicks = false;
+
+    for (uint32_t i = 0; i < hdr.numTicks; ++i) {
+        if (hdr.firstTickSeq + i != gUdpRecvNextSeq)
+            continue;
+
+        UdpRecvTick& recvTick = gUdpRecvTicks.emplace_back();
+        std::memcpy(&recvTick.packet, gUdpRecvBuffer + sizeof(UdpDgramHdr) + i * sizeof(NetPacket_Tick), sizeof(NetPacket_Tick));
+        recvTick.receiveTime = receiveTime;
+        gUdpRecvNextSeq++;
+        bGotNewTicks = true;
+    }
+
+    if (bGotNewTicks) {
+        gbUdpHasRecvTicks = true;
+    }
+
+    // If the peer resent tick packets we already have then our acknowledgement was probably lost, send it again now
+    if ((hdr.numTicks > 0) && (!bGotNewTicks)) {
+        udpSendDgram();
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// UDP transport: kicks off an asynchronous receive of the next datagram from the peer
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void udpBeginRecvDgram() noexcept {
+    gpUdpSocket->async_receive_from(
+        asio::buffer(gUdpRecvBuffer, sizeof(gUdpRecvBuffer)),
+        gUdpRecvEndpoint,
+        [](const asio::error_code& error, const std::size_t bytesRead) noexcept {
+            // Socket closed? Note: other errors (like 'connection refused' from ICMP messages) are ignored since the peer may just be slow to start.
+            if (error == asio::error::operation_aborted)
+                return;
+
+            if (!error) {
+                udpHandleDgram(bytesRead);
+            }
+
+            udpBeginRecvDgram();
+        }
+    );
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// UDP transport: periodically resends unacknowledged tick packets and checks for the peer timing out
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void udpBeginResendTimer() noexcept {
+    gpUdpResendTimer->expires_after(std::chrono::milliseconds(UDP_RESEND_INTERVAL_MS));
+    gpUdpResendTimer->async_wait(
+        [](const asio::error_code& error) noexcept {
+            if (error)
+                return;
+
+            const udp_clock_t::time_point now = udp_clock_t::now();
+
+            // If we've been waiting too long for the peer then flag an error and wake up the waiter
+            if (gbUdpWaitingForTick && (now - gUdpWaitStartTime >= std::chrono::milliseconds(UDP_TIMEOUT_MS))) {
+                gbUdpError = true;
+                gbUdpHasRecvTicks = true;
+                return;
+            }
+
+            if ((!gUdpUnackedTicks.empty()) && (now - gUdpLastSendTime >= std::chrono::milliseconds(UDP_RESEND_INTERVAL_MS))) {
+                udpSendDgram();
+            }
+
+            udpBeginResendTimer();
+        }
+    );
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tells if tick packets are being sent via UDP rather than TCP
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool isUsingUdpTransport() noexcept {
+    return (gpUdpSocket != nullptr);
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Create a connection for the server of a game (player 1).
 // Waits until an incomming connection is received from the client (player 2).
@@ -230,10 +435,79 @@ bool initForClient() noexcept {
     return bWasSuccessful;
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Switches tick packets over to the UDP transport, after a TCP connection has been established.
+// Both peers must call this at the same point, as the UDP ports to use are exchanged via TCP.
+// The server uses the same port number as the TCP connection where possible, so only one port needs to be forwarded.
+// Returns 'false' and kills the connection on failure.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool beginUdpTransport() noexcept {
+    if ((!isConnected()) || isUsingUdpTransport())
+        return false;
+
+    try {
+        // Create the UDP socket using the same protocol as the TCP connection
+        const asio::ip::tcp::endpoint tcpLocalEndpoint = gpSocket->local_endpoint();
+        const asio::ip::tcp::endpoint tcpRemoteEndpoint = gpSocket->remote_endpoint();
+        const asio::ip::udp udpProtocol = (tcpLocalEndpoint.address().is_v6()) ? asio::ip::udp::v6() : asio::ip::udp::v4();
+
+        gpUdpSocket.reset(new asio::ip::udp::socket(*gpIoContext));
+        gpUdpSocket->open(udpProtocol);
+
+        if (udpProtocol == asio::ip::udp::v6()) {
+            asio::error_code error;
+            gpUdpSocket->set_option(asio::ip::v6_only(false), error);   // Accept IPv4 mapped addresses too (ignore if unsupported)
+        }
+
+        asio::error_code bindError;
+        gpUdpSocket->bind(asio::ip::udp::endpoint(udpProtocol, (ProgArgs::gbIsNetServer) ? tcpLocalEndpoint.port() : 0), bindError);
+
+        if (bindError) {
+            gpUdpSocket->bind(asio::ip::udp::endpoint(udpProtocol, 0));
+        }
+
+        // Exchange UDP ports with the peer
+        const uint16_t localUdpPort = Endian::hostToLittle(gpUdpSocket->local_endpoint().port());
+        uint16_t peerUdpPort = 0;
+
+        if ((!sendBytes(&localUdpPort, sizeof(localUdpPort))) || (!recvBytes(&peerUdpPort, sizeof(peerUdpPort))))
+            return false;
+
+        gUdpPeerEndpoint = asio::ip::udp::endpoint(tcpRemoteEndpoint.address(), Endian::littleToHost(peerUdpPort));
+
+        // Start receiving datagrams and resending unacknowledged tick packets
+        gpUdpResendTimer.reset(new asio::steady_timer(*gpIoContext));
+        gUdpLastSendTime = udp_clock_t::now();
+        udpBeginRecvDgram();
+        udpBeginResendTimer();
+    }
+    catch (...) {
+        shutdown();
+        return false;
+    }
+
+    return true;
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Closes up the current network connection (if any)
 //------------------------------------------------------------------------------------------------------------------------------------------
 void shutdown() noexcept {
+    gpUdpResendTimer.reset();
+    gpUdpSocket.reset();
+    gUdpPeerEndpoint = {};
+    gUdpRecvEndpoint = {};
+    gUdpUnackedTicks.clear();
+    gUdpUnackedFirstSeq = 0;
+    gUdpRecvTicks.clear();
+    gUdpRecvNextSeq = 0;
+    gUdpLastSendTime = {};
+    gUdpWaitStartTime = {};
+    gbUdpWaitingForTick = false;
+    gbUdpHasRecvTicks = false;
+    gbUdpError = false;
+    gTickTrafficStats = {};
+
     gpSocket.reset();
     gpIoContext.reset();
 }
@@ -363,11 +637,25 @@ bool sendTickPacket(const NetPacket_Tick& packet) noexcept {
     if (!isConnected())
         return false;
 
+    // UDP transport: queue the packet for sending until acknowledged and send it (along with any other unacknowledged packets) right away.
+    // Kill the connection if the peer has stopped acknowledging packets.
+    if (isUsingUdpTransport()) {
+        if (gUdpUnackedTicks.size() >= UDP_MAX_UNACKED_TICKS) {
+            shutdown();
+            return false;
+        }
+
+        gUdpUnackedTicks.push_back(packet);
+        udpSendDgram();
+        return true;
+    }
+
     if (!gTickPacketWriter->writePacket(packet, nullptr)) {
         shutdown();
         return false;
     }
 
+    gTickTrafficStats.numBytesSent += sizeof(NetPacket_Tick);
     return true;
 }
 
@@ -378,6 +666,10 @@ bool requestTickPackets() noexcept {
     if (!isConnected())
         return false;
 
+    // UDP transport: datagrams are always being received, so nothing to do
+    if (isUsingUdpTransport())
+        return true;
+
     if (!gTickPacketReader->asyncFillPacketBuffer()) {
         shutdown();
         return false;
@@ -394,12 +686,54 @@ bool recvTickPacket(NetPacket_Tick& packet, std::chrono::system_clock::time_poin
     if (!isConnected())
         return false;
 
-    if (!gTickPacketReader->popRequestedPacket(packet, receiveTime, nullptr)) {
+    // Telemetry: record how long we are blocked waiting for the packet, which is how long the game is stalled by the network
+    const udp_clock_t::time_point recvStartTime = udp_clock_t::now();
+
+    const auto recordRecvWaitTime = [&]() noexcept {
+        gTickTrafficStats.lastRecvWaitUsec = std::chrono::duration_cast<std::chrono::microseconds>(udp_clock_t::now() - recvStartTime).count();
+    };
+
+    // UDP transport: wait until the next tick packet arrives in sequence, the peer times out or the app is quit
+    if (isUsingUdpTransport()) {
+        if (gUdpRecvTicks.empty()) {
+            gbUdpHasRecvTicks = false;
+            gbUdpWaitingForTick = true;
+            gUdpWaitStartTime = recvStartTime;
+            waitForAsyncNetworkOp(gbUdpHasRecvTicks, false);
+            gbUdpWaitingForTick = false;
+        }
+
+        recordRecvWaitTime();
+
+        if (gbUdpError || gUdpRecvTicks.empty()) {
+            shutdown();
+            return false;
+        }
+
+        packet = gUdpRecvTicks.front().packet;
+        receiveTime = gUdpRecvTicks.front().receiveTime;
+        gUdpRecvTicks.pop_front();
+        gbUdpHasRecvTicks = (!gUdpRecvTicks.empty());
+        return true;
+    }
+
+    const bool bGotPacket = gTickPacketReader->popRequestedPacket(packet, receiveTime, nullptr);
+    recordRecvWaitTime();
+
+    if (!bGotPacket) {
         shutdown();
         return false;
     }
 
+    gTickTrafficStats.numBytesRecv += sizeof(NetPacket_Tick);
     return true;
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Get the running totals for tick packet traffic since the connection was established
+//------------------------------------------------------------------------------------------------------------------------------------------
+void getTickTrafficStats(TickTrafficStats& stats) noexcept {
+    stats = gTickTrafficStats;
+}
+
 END_NAMESPACE(Network)
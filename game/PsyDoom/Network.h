@@ -9,10 +9,18 @@ struct NetPacket_Tick;
 
 BEGIN_NAMESPACE(Network)
 
+// Running totals for tick packet traffic, used for network telemetry
+struct TickTrafficStats {
+    uint64_t    numBytesSent;       // Total bytes sent for tick packets, including any transport headers and redundant (UDP) copies
+    uint64_t    numBytesRecv;       // Total bytes received for tick packets, including any transport headers and redundant (UDP) copies
+    int64_t     lastRecvWaitUsec;   // How long the last call to 'recvTickPacket' blocked waiting for the packet to arrive
+};
+
 extern bool gbWasInitAborted;
 
 bool initForServer() noexcept;
 bool initForClient() noexcept;
+bool beginUdpTransport() noexcept;
 void shutdown() noexcept;
 bool isConnected() noexcept;
 void doUpdates() noexcept;
@@ -21,5 +29,6 @@ bool recvBytes(void* pBuffer, const int32_t numBytes) noexcept;
 bool sendTickPacket(const NetPacket_Tick& packet) noexcept;
 bool requestTickPackets() noexcept;
 bool recvTickPacket(NetPacket_Tick& packet, std::chrono::system_clock::time_point& receiveTime) noexcept;
+void getTickTrafficStats(TickTrafficStats& stats) noexcept;
 
 END_NAMESPACE(Network)
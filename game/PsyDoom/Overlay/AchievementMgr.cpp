@@ -9,24 +9,80 @@
 #include <rapidjson/document.h>
 #include <rapidjson/stringbuffer.h>
 #include <rapidjson/writer.h>
+#include <algorithm>
 #include <cstdio>
+#include <cstring>
 #include <vector>
 
 static const char* ACHIEVEMENTS_FILE = "achievements.json";
 static const char* SAVE_FILE = "saved_achievements.json";
 
+// Names for each event type, as used by the 'event' field in 'achievements.json'
+static constexpr const char* EVENT_TYPE_NAMES[(size_t) AchievementEventType::Count] = {
+    "kill",
+    "pickup",
+    "secret",
+    "levelStart",
+    "levelExit",
+};
+
+static bool GetEventTypeForName(const char* const name, AchievementEventType& outType) {
+    for (size_t i = 0; i < (size_t) AchievementEventType::Count; ++i) {
+        if (std::strcmp(name, EVENT_TYPE_NAMES[i]) == 0) {
+            outType = (AchievementEventType) i;
+            return true;
+        }
+    }
+
+    return false;
+}
+
 void AchievementManager::Init() {
     LoadAchievementsData();
     LoadProgress();
+
+    m_saveThreadQuit = false;
+
+    if (!m_saveThread.joinable()) {
+        m_saveThread = std::thread([this]() { SaveThreadMain(); });
+    }
+}
+
+void AchievementManager::Shutdown() {
+    // Let the save thread finish writing any pending progress and then exit
+    {
+        std::lock_guard<std::mutex> lock(m_saveMutex);
+        m_saveThreadQuit = true;
+    }
+
+    m_saveCV.notify_one();
+
+    if (m_saveThread.joinable()) {
+        m_saveThread.join();
+    }
+}
+
+AchievementManager::~AchievementManager() {
+    Shutdown();
+}
+
+void AchievementManager::AddCondition(const uint32_t achievementIdx, const AchievementEventType type, const int32_t arg, const uint32_t count) {
+    m_conditionsByEvent[(size_t) type].push_back({ type, arg, std::max(count, 1u), 0, achievementIdx });
 }
 
 void AchievementManager::LoadAchievementsData() {
     m_achievements.clear();
 
+    for (auto& conditions : m_conditionsByEvent) {
+        conditions.clear();
+    }
+
     if (!FileUtils::fileExists(ACHIEVEMENTS_FILE)) {
         // Fallback defaults
         m_achievements.push_back({ "CYBER_KILL", "Cyberbully", "Defeated the Cyberdemon", "STKEYS2", false });
         m_achievements.push_back({ "FIRST_BLOOD", "First Blood", "Killed your first enemy", "STKEYS0", false });
+        AddCondition(0, AchievementEventType::Kill, 16, 1);     // Cyberdemon
+        AddCondition(1, AchievementEventType::Kill, AchievementCondition::ANY_ARG, 1);
         return;
     }
 
@@ -51,6 +107,24 @@ void AchievementManager::LoadAchievementsData() {
         ach.icon = JsonUtils::getOrDefault<const char*>(val, "icon", "");
         ach.unlocked = false;
         m_achievements.push_back(ach);
+
+        // Compile the unlock condition, if any: achievements without one can only be unlocked directly via 'Unlock'.
+        // The event argument to match is given by 'doomednum' for kills and pickups, or by 'map' for secrets and level events.
+        const char* const eventName = JsonUtils::getOrDefault<const char*>(val, "event", "");
+        AchievementEventType eventType = {};
+
+        if (!eventName[0])
+            continue;
+
+        if (!GetEventTypeForName(eventName, eventType)) {
+            std::printf("Achievements: unknown event type '%s' for achievement '%s'! Achievement can't be unlocked by events...\n", eventName, ach.id.c_str());
+            continue;
+        }
+
+        const bool bIsThingEvent = ((eventType == AchievementEventType::Kill) || (eventType == AchievementEventType::Pickup));
+        const int32_t arg = JsonUtils::getOrDefault<int32_t>(val, (bIsThingEvent) ? "doomednum" : "map", AchievementCondition::ANY_ARG);
+        const uint32_t count = (uint32_t) std::max(JsonUtils::getOrDefault<int32_t>(val, "count", 1), 1);
+        AddCondition((uint32_t) m_achievements.size() - 1, eventType, arg, count);
     }
 }
 
@@ -80,6 +154,7 @@ void AchievementManager::LoadProgress() {
     }
 }
 
+// Serializes progress on the calling thread (which is cheap) and hands it off to the save thread to be written to disk
 void AchievementManager::SaveProgress() {
     rapidjson::Document doc;
     doc.SetArray();
@@ -97,19 +172,106 @@ void AchievementManager::SaveProgress() {
     rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
     doc.Accept(writer);
 
-    FileUtils::writeDataToFile(SAVE_FILE, buffer.GetString(), buffer.GetSize());
+    // If the save thread isn't running then just write the file directly
+    if (!m_saveThread.joinable()) {
+        FileUtils::writeDataToFile(SAVE_FILE, buffer.GetString(), buffer.GetSize());
+        return;
+    }
+
+    // Only the most recent progress matters, so this replaces any progress still waiting to be written
+    {
+        std::lock_guard<std::mutex> lock(m_saveMutex);
+        m_pendingSaveData.assign(buffer.GetString(), buffer.GetSize());
+        m_savePending = true;
+    }
+
+    m_saveCV.notify_one();
 }
 
-void AchievementManager::Unlock(const std::string_view id) {
-    for (auto& ach : m_achievements) {
-        if (ach.id == id) {
-            if (!ach.unlocked) {
+void AchievementManager::SaveThreadMain() {
+    std::string saveData;
+    std::unique_lock<std::mutex> lock(m_saveMutex);
+
+    while (true) {
+        m_saveCV.wait(lock, [&]() { return (m_savePending || m_saveThreadQuit); });
+
+        if (!m_savePending)
+            return;     // Told to quit and nothing left to write
+
+        // Write the file outside of the lock
+        saveData.swap(m_pendingSaveData);
+        m_savePending = false;
+        lock.unlock();
+        FileUtils::writeDataToFile(SAVE_FILE, saveData.data(), saveData.size());
+        lock.lock();
+    }
+}
+
+void AchievementManager::RaiseEvent(const AchievementEventType type, const int32_t arg) {
+    // Cheap early out if nothing is interested in this type of event
+    if (m_conditionsByEvent[(size_t) type].empty())
+        return;
+
+    // Process events now if the buffer is full, so nothing is lost
+    if (m_numEvents >= EVENT_BUFFER_SIZE) {
+        ProcessEvents();
+    }
+
+    m_events[(m_eventsHead + m_numEvents) % EVENT_BUFFER_SIZE] = { type, arg };
+    m_numEvents++;
+}
+
+void AchievementManager::ProcessEvents() {
+    bool bUnlockedAny = false;
+
+    while (m_numEvents > 0) {
+        const AchievementEvent event = m_events[m_eventsHead];
+        m_eventsHead = (m_eventsHead + 1) % EVENT_BUFFER_SIZE;
+        m_numEvents--;
+
+        // Only the conditions for this event type need to be checked
+        for (AchievementCondition& condition : m_conditionsByEvent[(size_t) event.type]) {
+            if ((condition.arg != AchievementCondition::ANY_ARG) && (condition.arg != event.arg))
+                continue;
+
+            Achievement& ach = m_achievements[condition.achievementIdx];
+
+            if (ach.unlocked)
+                continue;
+
+            condition.progress++;
+
+            if (condition.progress >= condition.count) {
                 ach.unlocked = true;
-                m_notificationQueue.push(ach.id);
-                // Play achievement sound
-                S_StartSound(nullptr, sfx_getpow);
-                SaveProgress();
+                m_notificationQueue.push(condition.achievementIdx);
+                bUnlockedAny = true;
             }
+        }
+    }
+
+    // Play the achievement sound and save once for all achievements unlocked
+    if (bUnlockedAny) {
+        S_StartSound(nullptr, sfx_getpow);
+        SaveProgress();
+    }
+}
+
+void AchievementManager::UnlockByIndex(const uint32_t achievementIdx) {
+    Achievement& ach = m_achievements[achievementIdx];
+
+    if (!ach.unlocked) {
+        ach.unlocked = true;
+        m_notificationQueue.push(achievementIdx);
+        // Play achievement sound
+        S_StartSound(nullptr, sfx_getpow);
+        SaveProgress();
+    }
+}
+
+void AchievementManager::Unlock(const std::string_view id) {
+    for (uint32_t i = 0; i < (uint32_t) m_achievements.size(); ++i) {
+        if (m_achievements[i].id == id) {
+            UnlockByIndex(i);
             return;
         }
     }
@@ -124,25 +286,24 @@ const std::string& AchievementManager::GetCurrentNotificationIcon() const {
 }
 
 void AchievementManager::UpdateAndRender(float deltaTime) {
-    // 1. Manage Queue
+    // Nothing to do on frames where no events happened and no notifications are pending or showing
+    if ((m_numEvents == 0) && (!m_showingNotification) && m_notificationQueue.empty())
+        return;
+
+    // 1. Evaluate any events raised since the last frame
+    ProcessEvents();
+
+    // 2. Manage Queue
     if (!m_showingNotification && !m_notificationQueue.empty()) {
-        m_currentNotificationId = m_notificationQueue.front();
+        const Achievement& ach = m_achievements[m_notificationQueue.front()];
         m_notificationQueue.pop();
-        
-        // Find title
-        for (const auto& a : m_achievements) {
-            if (a.id == m_currentNotificationId) {
-                m_currentNotificationTitle = a.title;
-                m_currentNotificationIcon = a.icon;
-                break;
-            }
-        }
-        
+        m_currentNotificationTitle = ach.title;
+        m_currentNotificationIcon = ach.icon;
         m_showingNotification = true;
         m_notificationTimer = NOTIFICATION_DURATION;
     }
 
-    // 2. Render if active
+    // 3. Render if active
     if (m_showingNotification) {
         m_notificationTimer -= deltaTime;
         if (m_notificationTimer <= 0.0f) {
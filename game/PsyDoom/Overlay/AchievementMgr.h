@@ -1,9 +1,30 @@
 #pragma once
 
-#include <string>
-#include <vector>
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
 #include <queue>
+#include <string>
 #include <string_view>
+#include <thread>
+#include <vector>
+
+// Types of game event which can unlock achievements
+enum class AchievementEventType : uint8_t {
+    Kill,           // The local player killed something: arg is the 'doomednum' of the thing killed
+    Pickup,         // The local player picked up an item: arg is the 'doomednum' of the item
+    Secret,         // The local player found a secret: arg is the map number
+    LevelStart,     // A level was started: arg is the map number
+    LevelExit,      // A level was completed: arg is the map number
+    Count
+};
+
+// A game event raised for achievement evaluation
+struct AchievementEvent {
+    AchievementEventType type;
+    int32_t arg;
+};
 
 struct Achievement {
     std::string id;
@@ -13,6 +34,17 @@ struct Achievement {
     bool unlocked;
 };
 
+// A compiled unlock condition for an achievement: the achievement unlocks after 'count' events of the given type with a matching argument
+struct AchievementCondition {
+    AchievementEventType eventType;
+    int32_t arg;                // Event argument which must match, or 'ANY_ARG' to match any event of the type
+    uint32_t count;             // How many matching events are needed to unlock
+    uint32_t progress;          // How many matching events have happened so far (this session)
+    uint32_t achievementIdx;    // Which achievement the condition unlocks
+
+    static constexpr int32_t ANY_ARG = INT32_MIN;
+};
+
 class AchievementManager {
 public:
     static AchievementManager& Get() {
@@ -21,8 +53,14 @@ public:
     }
 
     void Init();
-    
-    // Call this when a game event happens
+    void Shutdown();
+
+    // Call this when a game event happens; this is cheap and never allocates.
+    // Events are evaluated against achievement conditions the next time 'UpdateAndRender' is called.
+    // Usage: AchievementManager::Get().RaiseEvent(AchievementEventType::Kill, target.info->doomednum);
+    void RaiseEvent(const AchievementEventType type, const int32_t arg);
+
+    // Unlocks an achievement directly by id
     // Usage: AchievementManager::Get().Unlock("CYBER_KILL");
     void Unlock(const std::string_view id);
 
@@ -35,21 +73,43 @@ public:
 
 private:
     AchievementManager() = default;
+    ~AchievementManager();
 
     void LoadAchievementsData();
     void LoadProgress();
     void SaveProgress();
+    void ProcessEvents();
+    void UnlockByIndex(const uint32_t achievementIdx);
+    void AddCondition(const uint32_t achievementIdx, const AchievementEventType type, const int32_t arg, const uint32_t count);
+    void SaveThreadMain();
 
     std::vector<Achievement> m_achievements;
-    std::queue<std::string> m_notificationQueue;
-    
+    std::queue<uint32_t> m_notificationQueue;       // Indexes of achievements to show notifications for
+
+    // Compiled unlock conditions, grouped by the event type they are interested in
+    std::array<std::vector<AchievementCondition>, (size_t) AchievementEventType::Count> m_conditionsByEvent;
+
+    // Ring buffer of events raised since they were last processed.
+    // If it fills up then events are processed immediately rather than being dropped.
+    static constexpr uint32_t EVENT_BUFFER_SIZE = 64;
+    std::array<AchievementEvent, EVENT_BUFFER_SIZE> m_events = {};
+    uint32_t m_eventsHead = 0;
+    uint32_t m_numEvents = 0;
+
     // Notification State
     bool m_showingNotification = false;
     float m_notificationTimer = 0.0f;
-    std::string m_currentNotificationId;
-    std::string m_currentNotificationTitle; 
+    std::string m_currentNotificationTitle;
     std::string m_currentNotificationIcon;
-    
+
+    // Background saving of progress: the most recent serialized progress is handed to the save thread, which writes it to disk
+    std::thread m_saveThread;
+    std::mutex m_saveMutex;
+    std::condition_variable m_saveCV;
+    std::string m_pendingSaveData;
+    bool m_savePending = false;
+    bool m_saveThreadQuit = false;
+
     // Constants
     static constexpr float NOTIFICATION_DURATION = 5.0f; // Seconds
 };
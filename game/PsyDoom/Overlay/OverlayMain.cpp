@@ -2,6 +2,8 @@
 #include "AchievementMgr.h"
 #include "../../Doom/Game/p_tick.h" 
 #include "../../Doom/Base/i_main.h" 
+#include "../FrameProfiler.h"
+#include "../ZoneStats.h"
 #include <cstdio>
 
 extern double gPrevFrameDuration;
@@ -13,6 +15,7 @@ void OverlayMain::Init() {
 }
 
 void OverlayMain::Shutdown() {
+    AchievementManager::Get().Shutdown();
     m_isInitialized = false;
 }
 
@@ -26,6 +29,12 @@ void OverlayMain::Render() {
 
     AchievementManager::Get().UpdateAndRender(dt);
 
+    #if PSYDOOM_FRAME_PROFILER
+        FrameProfiler::drawOverlay();
+    #endif
+
+    ZoneStats::drawOverlay();
+
     if (m_isInteractiveMode) {
         int startX = 60;
         int startY = 40;
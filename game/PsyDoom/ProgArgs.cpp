@@ -36,10 +36,59 @@ const char* gPlayDemoFilePath = "";             // The demo file to play and exi
 const char* gSaveDemoResultFilePath = "";       // Path to a json file to save the demo result to
 const char* gCheckDemoResultFilePath = "";      // Path to a json file to read the demo result from and verify a match with
 bool        gbRecordDemos;                      // True if the game should record demos for every map played
+bool        gbRecordMultiMapDemos;              // With '-record': record all the maps played into one continuous demo, instead of one demo per map
+bool        gbRecordStateHashes;                // True if demo recording should also write per-tick game state hashes to a '.HSH' file
+const char* gCheckStateHashFilePath = "";       // Path to a file of per-tick game state hashes to verify demo playback against
+bool        gbCheckSnapshots;                   // True if demo playback should capture and restore a snapshot of the game state on every tick
+
+// If true then play back the demo as fast as possible (no frame limiting, vsync or sound) and print frame timing statistics when done
+bool gbTimeDemo = false;
+
+// Timedemo mode only: if true then skip displaying frames to the screen, so only game logic and drawing is measured.
+// Note: this only applies to the classic renderer, the Vulkan renderer must always present in order to render anything.
+// Use '-vkoffscreen' instead to measure the Vulkan renderer without a window or display.
+bool gbNoPresent = false;
+
+// Vulkan renderer only, demo playback only: if true then render into offscreen images instead of a window swapchain.
+// This allows the Vulkan renderer to be benchmarked or checked for regressions on machines without a display (GPU CI runners etc.).
+bool gbVulkanOffscreen = false;
+
+// Offscreen Vulkan rendering only: if greater than '0' then read back every N'th rendered frame and save it as an image.
+// The images are saved to the given directory path, which is expected to already exist.
+int32_t     gVkReadbackEveryNFrames = 0;
+const char* gVkReadbackDir = "";
+
+// Vulkan renderer only: if greater than '0' then capture video of the main render path output at this many frames per second.
+// The video is written as a YUV4MPEG2 ('.y4m') stream to the given file path, or piped to the given command if it begins with '|'.
+int32_t     gVkCaptureFps = 0;
+const char* gVkCaptureOutput = "";
+
+// Path to a json file to write a Chrome format trace of all frame profiler timings to upon exit.
+// Only has an effect if the frame profiler is compiled in, empty string when no trace is to be written.
+const char* gProfileTraceFilePath = "";
+
+// Path to a json file to write main memory heap statistics to at the end of each level.
+// The file is rewritten after every level, empty string when no stats are to be written.
+const char* gZoneStatsFilePath = "";
+
+// If greater than '0' then run a soak benchmark: every map is loaded in turn and played for this many seconds of game time, with the
+// player spinning in place at the start of the map. Per-map load time, frame times and memory stats are written to the given .csv file.
+int32_t     gSoakSeconds = 0;
+const char* gSoakCsvFilePath = "";
+
+// Demo playback only: if greater than '0' then fast-forward through the demo until this many demo ticks have been simulated.
+// While seeking nothing is drawn, no sounds are played and no frame pacing is done; normal playback then resumes from the target tick.
+int32_t gDemoSeekTick = 0;
+
+// If greater than '0' then automatic garbage collection for map scripts is disabled, and instead incremental collection is done during idle
+// time after each frame is presented, for up to this many microseconds per frame. This avoids collections landing in the middle of a tick.
+int32_t gLuaGCBudgetUsec = 0;
 
 bool        gbIsNetServer   = false;                // True if this peer is a server in a networked game (player 1, waits for client connection)
 bool        gbIsNetClient   = false;                // True if this peer is a client in a networked game (player 2, connects to waiting server)
 uint16_t    gServerPort     = DEFAULT_NET_PORT;     // Port that the server listens on or that the client connects to
+bool        gbNetUseUdp     = false;                // If true then request that tick updates use UDP (with redundancy) rather than TCP
+int32_t     gNetInputDelay  = 1;                    // How many ticks ahead of when they are used to send inputs in a network game, or '0' to adapt it automatically
 
 bool gbNoMonsters           = false;    // Cheat: if true then do not spawn any monsters
 bool gbNoMonstersBossFixup  = false;    // Cheat: if 'no monsters' is active then try to fix broken boss specials by triggering them at the start of the map
@@ -123,6 +172,100 @@ static int parseArg_checkresult(const int argc, const char* const* const argv) {
     return 0;
 }
 
+static int parseArg_timedemo(const int argc, const char* const* const argv) {
+    if ((argc >= 2) && (std::strcmp(argv[0], "-timedemo") == 0)) {
+        gPlayDemoFilePath = argv[1];
+        gbTimeDemo = true;
+        return 2;
+    }
+
+    return 0;
+}
+
+static int parseArg_nopresent([[maybe_unused]] const int argc, const char* const* const argv) {
+    if (std::strcmp(argv[0], "-nopresent") == 0) {
+        gbNoPresent = true;
+        return 1;
+    }
+
+    return 0;
+}
+
+static int parseArg_vkoffscreen([[maybe_unused]] const int argc, const char* const* const argv) {
+    if (std::strcmp(argv[0], "-vkoffscreen") == 0) {
+        gbVulkanOffscreen = true;
+        return 1;
+    }
+
+    return 0;
+}
+
+static int parseArg_vkreadback(const int argc, const char* const* const argv) {
+    if ((argc >= 3) && (std::strcmp(argv[0], "-vkreadback") == 0)) {
+        gVkReadbackEveryNFrames = std::max(std::atoi(argv[1]), 0);
+        gVkReadbackDir = argv[2];
+        return 3;
+    }
+
+    return 0;
+}
+
+static int parseArg_vkcapture(const int argc, const char* const* const argv) {
+    if ((argc >= 3) && (std::strcmp(argv[0], "-vkcapture") == 0)) {
+        gVkCaptureFps = std::max(std::atoi(argv[1]), 0);
+        gVkCaptureOutput = argv[2];
+        return 3;
+    }
+
+    return 0;
+}
+
+static int parseArg_profiletrace(const int argc, const char* const* const argv) {
+    if ((argc >= 2) && (std::strcmp(argv[0], "-profiletrace") == 0)) {
+        gProfileTraceFilePath = argv[1];
+        return 2;
+    }
+
+    return 0;
+}
+
+static int parseArg_zonestats(const int argc, const char* const* const argv) {
+    if ((argc >= 2) && (std::strcmp(argv[0], "-zonestats") == 0)) {
+        gZoneStatsFilePath = argv[1];
+        return 2;
+    }
+
+    return 0;
+}
+
+static int parseArg_soak(const int argc, const char* const* const argv) {
+    if ((argc >= 3) && (std::strcmp(argv[0], "-soak") == 0)) {
+        gSoakSeconds = std::max(std::atoi(argv[1]), 0);
+        gSoakCsvFilePath = argv[2];
+        return 3;
+    }
+
+    return 0;
+}
+
+static int parseArg_demoseek(const int argc, const char* const* const argv) {
+    if ((argc >= 2) && (std::strcmp(argv[0], "-demoseek") == 0)) {
+        gDemoSeekTick = std::max(std::atoi(argv[1]), 0);
+        return 2;
+    }
+
+    return 0;
+}
+
+static int parseArg_luagcbudget(const int argc, const char* const* const argv) {
+    if ((argc >= 2) && (std::strcmp(argv[0], "-luagcbudget") == 0)) {
+        gLuaGCBudgetUsec = std::max(std::atoi(argv[1]), 0);
+        return 2;
+    }
+
+    return 0;
+}
+
 static int parseArg_record([[maybe_unused]] const int argc, const char* const* const argv) {
     if (std::strcmp(argv[0], "-record") == 0) {
         gbRecordDemos = true;
@@ -132,6 +275,42 @@ static int parseArg_record([[maybe_unused]] const int argc, const char* const* c
     return 0;
 }
 
+static int parseArg_recordmultimap([[maybe_unused]] const int argc, const char* const* const argv) {
+    if (std::strcmp(argv[0], "-recordmultimap") == 0) {
+        gbRecordMultiMapDemos = true;
+        return 1;
+    }
+
+    return 0;
+}
+
+static int parseArg_recordhashes([[maybe_unused]] const int argc, const char* const* const argv) {
+    if (std::strcmp(argv[0], "-recordhashes") == 0) {
+        gbRecordStateHashes = true;
+        return 1;
+    }
+
+    return 0;
+}
+
+static int parseArg_checkhashes(const int argc, const char* const* const argv) {
+    if ((argc >= 2) && (std::strcmp(argv[0], "-checkhashes") == 0)) {
+        gCheckStateHashFilePath = argv[1];
+        return 2;
+    }
+
+    return 0;
+}
+
+static int parseArg_checksnapshots([[maybe_unused]] const int argc, const char* const* const argv) {
+    if (std::strcmp(argv[0], "-checksnapshots") == 0) {
+        gbCheckSnapshots = true;
+        return 1;
+    }
+
+    return 0;
+}
+
 static int parseArg_nomonsters(const int argc, const char* const* const argv) {
     if ((argc >= 1) && (std::strcmp(argv[0], "-nomonsters") == 0)) {
         gbNoMonsters = true;
@@ -236,6 +415,35 @@ static int parseArg_client([[maybe_unused]] const int argc, const char* const* c
     return 0;
 }
 
+static int parseArg_udp([[maybe_unused]] const int argc, const char* const* const argv) {
+    if (std::strcmp(argv[0], "-udp") == 0) {
+        gbNetUseUdp = true;
+        return 1;
+    }
+
+    return 0;
+}
+
+static int parseArg_netdelay(const int argc, const char* const* const argv) {
+    if ((argc >= 2) && (std::strcmp(argv[0], "-netdelay") == 0)) {
+        if (std::strcmp(argv[1], "auto") == 0) {
+            gNetInputDelay = 0;
+        } else {
+            const int32_t inputDelay = std::atoi(argv[1]);
+
+            if ((inputDelay >= 1) && (inputDelay <= NET_MAX_INPUT_DELAY)) {
+                gNetInputDelay = inputDelay;
+            } else {
+                std::printf("Bad network input delay '%s'! Must be 'auto' or 1-%d. Arg will be ignored...\n", argv[1], (int) NET_MAX_INPUT_DELAY);
+            }
+        }
+
+        return 2;
+    }
+
+    return 0;
+}
+
 static int parseArg_file(const int argc, const char* const* const argv) {
     if ((argc >= 2) && (std::strcmp(argv[0], "-file") == 0)) {
         gUserWadFiles.push_back(argv[1]);
@@ -281,13 +489,29 @@ static constexpr ArgParser ARG_PARSERS[] = {
     parseArg_playdemo,
     parseArg_saveresult,
     parseArg_checkresult,
+    parseArg_timedemo,
+    parseArg_nopresent,
+    parseArg_vkoffscreen,
+    parseArg_vkreadback,
+    parseArg_vkcapture,
+    parseArg_profiletrace,
+    parseArg_zonestats,
+    parseArg_soak,
+    parseArg_demoseek,
+    parseArg_luagcbudget,
     parseArg_record,
+    parseArg_recordmultimap,
+    parseArg_recordhashes,
+    parseArg_checkhashes,
+    parseArg_checksnapshots,
     parseArg_nomonsters,
     parseArg_nmbossfixup,
     parseArg_pistolstart,
     parseArg_turbo,
     parseArg_server,
     parseArg_client,
+    parseArg_udp,
+    parseArg_netdelay,
     parseArg_file,
     parseArg_nolauncher,
     parseArg_warp,
@@ -298,16 +522,112 @@ static constexpr ArgParser ARG_PARSERS[] = {
 // Performs additional validation and sanity checks for program arguments to fix some unsupported/invalid combos
 //------------------------------------------------------------------------------------------------------------------------------------------
 static void validateAndSanitizeArgs() noexcept {
-    if (gbHeadlessMode && (!gPlayDemoFilePath[0])) {
-        std::printf("The '-headless' switch can only be used in conjunction with '-playdemo'! Arg will be ignored...\n");
+    if ((gSoakSeconds > 0) && gPlayDemoFilePath[0]) {
+        std::printf("Can't use '-soak' in conjunction with '-playdemo' or '-timedemo'! Arg will be ignored...\n");
+        gSoakSeconds = 0;
+        gSoakCsvFilePath = "";
+    }
+
+    if ((gSoakSeconds > 0) && (gbIsNetServer || gbIsNetClient)) {
+        std::printf("Can't use '-soak' in conjunction with '-server' or '-client'! Arg will be ignored...\n");
+        gSoakSeconds = 0;
+        gSoakCsvFilePath = "";
+    }
+
+    if (gbHeadlessMode && (!gPlayDemoFilePath[0]) && (gSoakSeconds <= 0)) {
+        std::printf("The '-headless' switch can only be used in conjunction with '-playdemo' or '-soak'! Arg will be ignored...\n");
         gbHeadlessMode = false;
     }
 
+    if (gbNoPresent && (!gbTimeDemo) && (gSoakSeconds <= 0)) {
+        std::printf("The '-nopresent' switch can only be used in conjunction with '-timedemo' or '-soak'! Arg will be ignored...\n");
+        gbNoPresent = false;
+    }
+
+    #if PSYDOOM_VULKAN_RENDERER
+        if (gbVulkanOffscreen && (!gPlayDemoFilePath[0]) && (gSoakSeconds <= 0)) {
+            std::printf("The '-vkoffscreen' switch can only be used in conjunction with '-playdemo', '-timedemo' or '-soak'! Arg will be ignored...\n");
+            gbVulkanOffscreen = false;
+        }
+
+        if (gbVulkanOffscreen && gbHeadlessMode) {
+            std::printf("Can't use '-vkoffscreen' in conjunction with '-headless'! Arg will be ignored...\n");
+            gbVulkanOffscreen = false;
+        }
+    #else
+        if (gbVulkanOffscreen) {
+            std::printf("The '-vkoffscreen' switch requires a build with the Vulkan renderer enabled! Arg will be ignored...\n");
+            gbVulkanOffscreen = false;
+        }
+    #endif
+
+    if ((gVkReadbackEveryNFrames > 0) && (!gbVulkanOffscreen)) {
+        std::printf("The '-vkreadback' argument can only be used in conjunction with '-vkoffscreen'! Arg will be ignored...\n");
+        gVkReadbackEveryNFrames = 0;
+        gVkReadbackDir = "";
+    }
+
+    #if PSYDOOM_VULKAN_RENDERER
+        if ((gVkCaptureFps > 0) && gbHeadlessMode) {
+            std::printf("Can't use '-vkcapture' in conjunction with '-headless'! Arg will be ignored...\n");
+            gVkCaptureFps = 0;
+            gVkCaptureOutput = "";
+        }
+    #else
+        if (gVkCaptureFps > 0) {
+            std::printf("The '-vkcapture' argument requires a build with the Vulkan renderer enabled! Arg will be ignored...\n");
+            gVkCaptureFps = 0;
+            gVkCaptureOutput = "";
+        }
+    #endif
+
+    #if !PSYDOOM_FRAME_PROFILER
+        if (gProfileTraceFilePath[0]) {
+            std::printf("The '-profiletrace' switch requires a build with the frame profiler enabled! Arg will be ignored...\n");
+            gProfileTraceFilePath = "";
+        }
+    #endif
+
+    if ((gDemoSeekTick > 0) && (!gPlayDemoFilePath[0])) {
+        std::printf("The '-demoseek' argument can only be used in conjunction with '-playdemo'! Arg will be ignored...\n");
+        gDemoSeekTick = 0;
+    }
+
+    if (gbRecordMultiMapDemos && (!gbRecordDemos)) {
+        std::printf("The '-recordmultimap' switch can only be used in conjunction with '-record'! Arg will be ignored...\n");
+        gbRecordMultiMapDemos = false;
+    }
+
+    if (gbRecordStateHashes && (!gbRecordDemos)) {
+        std::printf("The '-recordhashes' switch can only be used in conjunction with '-record'! Arg will be ignored...\n");
+        gbRecordStateHashes = false;
+    }
+
+    if (gCheckStateHashFilePath[0] && (!gPlayDemoFilePath[0])) {
+        std::printf("The '-checkhashes' argument can only be used in conjunction with '-playdemo'! Arg will be ignored...\n");
+        gCheckStateHashFilePath = "";
+    }
+
+    if (gbCheckSnapshots && (!gPlayDemoFilePath[0])) {
+        std::printf("The '-checksnapshots' switch can only be used in conjunction with '-playdemo'! Arg will be ignored...\n");
+        gbCheckSnapshots = false;
+    }
+
     if (gbRecordDemos && gPlayDemoFilePath[0]) {
         std::printf("Can't use '-record' in conjunction with '-playdemo'! Arg will be ignored...\n");
         gbRecordDemos = false;
     }
 
+    if (gbNetUseUdp && (!gbIsNetClient) && (!gbIsNetServer)) {
+        std::printf("The '-udp' switch can only be used in conjunction with '-server' or '-client'! Arg will be ignored...\n");
+        gbNetUseUdp = false;
+    }
+
+    if ((gNetInputDelay != 1) && (!gbIsNetClient) && (!gbIsNetServer)) {
+        std::printf("The '-netdelay' argument can only be used in conjunction with '-server' or '-client'! Arg will be ignored...\n");
+        gNetInputDelay = 1;
+    }
+
     if (gbIsNetClient && gbIsNetServer) {
         std::printf("Can't use '-server' in conjunction with '-client'! Arg will be ignored...\n");
         gbIsNetServer = false;
@@ -327,6 +647,17 @@ static void validateAndSanitizeArgs() noexcept {
         std::printf("The '-warp' argument conflicts with '-playdemo'! Arg will be ignored...\n");
         gWarpMap = 0;
     }
+
+    if ((gWarpMap > 0) && (gSoakSeconds > 0)) {
+        std::printf("The '-warp' argument conflicts with '-soak'! Arg will be ignored...\n");
+        gWarpMap = 0;
+    }
+
+    if (gbRecordDemos && (gSoakSeconds > 0)) {
+        std::printf("Can't use '-record' in conjunction with '-soak'! Arg will be ignored...\n");
+        gbRecordDemos = false;
+        gbRecordStateHashes = false;
+    }
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -376,9 +707,27 @@ void shutdown() noexcept {
     gPlayDemoFilePath = "";
     gSaveDemoResultFilePath = "";
     gCheckDemoResultFilePath = "";
+    gbTimeDemo = false;
+    gbNoPresent = false;
+    gbVulkanOffscreen = false;
+    gVkReadbackEveryNFrames = 0;
+    gVkReadbackDir = "";
+    gVkCaptureFps = 0;
+    gVkCaptureOutput = "";
+    gProfileTraceFilePath = "";
+    gZoneStatsFilePath = "";
+    gDemoSeekTick = 0;
+    gLuaGCBudgetUsec = 0;
+    gbRecordDemos = false;
+    gbRecordMultiMapDemos = false;
+    gbRecordStateHashes = false;
+    gCheckStateHashFilePath = "";
+    gbCheckSnapshots = false;
     gbIsNetServer = false;
     gbIsNetClient = false;
     gServerPort = DEFAULT_NET_PORT;
+    gbNetUseUdp = false;
+    gNetInputDelay = 1;
     gbNoMonsters = false;
     gbNoMonstersBossFixup = false;
     gbPistolStart = false;
@@ -14,10 +14,29 @@ extern const char*  gDataDirPath;
 extern const char*  gPlayDemoFilePath;
 extern const char*  gSaveDemoResultFilePath;
 extern const char*  gCheckDemoResultFilePath;
+extern bool         gbTimeDemo;
+extern bool         gbNoPresent;
+extern bool         gbVulkanOffscreen;
+extern int32_t      gVkReadbackEveryNFrames;
+extern const char*  gVkReadbackDir;
+extern int32_t      gVkCaptureFps;
+extern const char*  gVkCaptureOutput;
+extern const char*  gProfileTraceFilePath;
+extern const char*  gZoneStatsFilePath;
+extern int32_t      gSoakSeconds;
+extern const char*  gSoakCsvFilePath;
+extern int32_t      gDemoSeekTick;
+extern int32_t      gLuaGCBudgetUsec;
 extern bool         gbRecordDemos;
+extern bool         gbRecordMultiMapDemos;
+extern bool         gbRecordStateHashes;
+extern const char*  gCheckStateHashFilePath;
+extern bool         gbCheckSnapshots;
 extern bool         gbIsNetServer;
 extern bool         gbIsNetClient;
 extern uint16_t     gServerPort;
+extern bool         gbNetUseUdp;
+extern int32_t      gNetInputDelay;
 extern bool         gbNoMonsters;
 extern bool         gbNoMonstersBossFixup;
 extern bool         gbPistolStart;
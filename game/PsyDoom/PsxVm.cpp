@@ -5,17 +5,27 @@
 
 #include "Asserts.h"
 #include "AudioCompressor.h"
+#include "AudioResampler.h"
 #include "Config/Config.h"
 #include "DiscInfo.h"
 #include "DiscReader.h"
+#include "FatalErrors.h"
 #include "Gpu.h"
 #include "Input.h"
 #include "IsoFileSys.h"
+#include "LIBGPU_CmdDispatch.h"
 #include "ProgArgs.h"
 #include "Spu.h"
+#include "ThreadUtils.h"
 
 #include <SDL.h>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
 #include <mutex>
+#include <string>
+#include <thread>
 
 BEGIN_NAMESPACE(PsxVm)
 
@@ -24,14 +34,102 @@ IsoFileSys  gIsoFileSys;
 Gpu::Core   gGpu;
 Spu::Core   gSpu;
 
+// The rate that the SPU generates audio at
+static constexpr uint32_t SPU_SAMPLE_RATE = 44100;
+
 static SDL_AudioDeviceID        gSdlAudioDeviceId;
 static std::recursive_mutex     gSpuMutex;
 
+// Thread used to mount the game disc during startup and any error message from it.
+// The error message is only read after the thread has been joined.
+static std::thread              gDiscMountThread;
+static std::string              gDiscMountErrorMsg;
+
+// A queued SPU command and the ring buffer holding them.
+// The head (next command to apply) is only written by the consumer of commands, and the tail (next command slot to write) only by the producer.
+struct SpuCmd {
+    SpuCmdFunc  pFunc;
+    alignas(alignof(std::max_align_t)) std::byte args[MAX_SPU_CMD_ARGS_SIZE];
+};
+
+static constexpr uint32_t SPU_CMD_QUEUE_SIZE = 1024;
+static_assert((SPU_CMD_QUEUE_SIZE & (SPU_CMD_QUEUE_SIZE - 1)) == 0, "Queue size must be a power of two!");
+
+static SpuCmd                   gSpuCmdQueue[SPU_CMD_QUEUE_SIZE];
+static std::atomic<uint32_t>    gSpuCmdQueueHead;
+static std::atomic<uint32_t>    gSpuCmdQueueTail;
+
 // The audio compressor is only needed if we have a floating point SPU
 #if SIMPLE_SPU_FLOAT_SPU
     static AudioCompressor::State gAudioCompState;
 #endif
 
+// The sample rate of the audio device, and whether SPU output is resampled to it (only touched by the audio thread once the device is open).
+// The audio device is opened at its native rate where possible so that SDL doesn't need to do any resampling or extra buffering of its own.
+static uint32_t                 gAudioOutputRate = SPU_SAMPLE_RATE;
+static bool                     gbAudioResample;
+static AudioResampler::State    gAudioResampler;
+
+// Audio callback statistics, written only by the audio thread.
+// The previous callback start time and priority boost flag are only ever touched by the audio thread, so don't need to be atomic.
+static std::atomic<uint32_t>                    gAudioNumCallbacks;
+static std::atomic<uint32_t>                    gAudioNumLateCallbacks;
+static std::atomic<float>                       gAudioBufferMs;
+static std::atomic<float>                       gAudioAvgCallbackMs;
+static std::atomic<float>                       gAudioPeakCallbackMs;
+static std::chrono::steady_clock::time_point    gAudioPrevCallbackStartTime;
+static bool                                     gbAudioThreadSettingsApplied;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Updates audio callback statistics after generating a buffer of audio.
+// A callback which starts much later than the previous buffer's duration is counted as 'late': in that case the audio device has likely
+// run out of audio to play (underrun), causing an audible glitch. Overruns can't happen since SDL pulls audio only as it needs it.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void updateAudioStats(
+    const std::chrono::steady_clock::time_point startTime,
+    const std::chrono::steady_clock::time_point endTime,
+    const uint32_t numSamples
+) noexcept {
+    const float bufferMs = (float) numSamples * (1000.0f / (float) gAudioOutputRate);
+    const float callbackMs = std::chrono::duration<float, std::milli>(endTime - startTime).count();
+    const uint32_t numCallbacks = gAudioNumCallbacks.load(std::memory_order_relaxed);
+
+    if (numCallbacks > 0) {
+        const float timeSincePrevCallbackMs = std::chrono::duration<float, std::milli>(startTime - gAudioPrevCallbackStartTime).count();
+
+        if (timeSincePrevCallbackMs > bufferMs * 1.5f) {
+            gAudioNumLateCallbacks.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    // Use an exponential moving average for the average callback time and have the peak decay slowly so that spikes remain visible for a while
+    const float prevAvgMs = (numCallbacks > 0) ? gAudioAvgCallbackMs.load(std::memory_order_relaxed) : callbackMs;
+    const float prevPeakMs = gAudioPeakCallbackMs.load(std::memory_order_relaxed);
+
+    gAudioBufferMs.store(bufferMs, std::memory_order_relaxed);
+    gAudioAvgCallbackMs.store(prevAvgMs + (callbackMs - prevAvgMs) * 0.05f, std::memory_order_relaxed);
+    gAudioPeakCallbackMs.store(std::max(callbackMs, prevPeakMs * 0.99f), std::memory_order_relaxed);
+    gAudioNumCallbacks.store(numCallbacks + 1, std::memory_order_relaxed);
+    gAudioPrevCallbackStartTime = startTime;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Apply all SPU commands that have been queued so far, in order.
+// Note: the SPU must be locked when calling this, so that there is only ever one consumer of commands at a time.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void applyPendingSpuCmds() noexcept {
+    uint32_t head = gSpuCmdQueueHead.load(std::memory_order_relaxed);
+    const uint32_t tail = gSpuCmdQueueTail.load(std::memory_order_acquire);
+
+    while (head != tail) {
+        const SpuCmd& cmd = gSpuCmdQueue[head % SPU_CMD_QUEUE_SIZE];
+        cmd.pFunc(cmd.args);
+        head++;
+    }
+
+    gSpuCmdQueueHead.store(head, std::memory_order_release);
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // A callback invoked by SDL to ask for audio from PsyDoom
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -40,36 +138,71 @@ static void SdlAudioCallback([[maybe_unused]] void* userData, Uint8* pOutput, in
     if (outputSize <= 0)
         return;
 
-    // How many samples are to be output?
+    // Apply the user's settings for the audio thread the first time around: a priority boost and which cores it can run on
+    if (!gbAudioThreadSettingsApplied) {
+        const int32_t priority = (Config::gbAudioThreadHighPriority) ?
+            ThreadUtils::THREAD_PRIORITY_TIME_CRITICAL :
+            ThreadUtils::THREAD_PRIORITY_DEFAULT;
+
+        ThreadUtils::applyToCurrentThread(ThreadUtils::makeThreadSettings(priority, Config::gAudioThreadCores));
+        gbAudioThreadSettingsApplied = true;
+    }
+
+    // How many samples are to be output, and how many need to be generated by the SPU to make them?
+    const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
     const uint32_t numSamples = (uint32_t) outputSize / (sizeof(float) * 2);
+    const uint32_t numSpuSamples = (gbAudioResample) ? AudioResampler::getNumInputSamplesNeeded(gAudioResampler, numSamples) : numSamples;
 
-    // Lock the SPU and generate the requested number of samples
-    float* pOutputF = reinterpret_cast<float*>(pOutput);
-    PsxVm::LockSpu spuLock;
+    // Lock the SPU and generate the required number of samples, a block at a time.
+    // These either go straight to the output or to the resampler, if the audio device is not running at the SPU's sample rate.
+    constexpr uint32_t MAX_BLOCK_SIZE = 256;
+    Spu::StereoSample samples[MAX_BLOCK_SIZE];
+    float samplesF[MAX_BLOCK_SIZE * 2];
 
-    for (uint32_t sampleIdx = 0; sampleIdx < numSamples; ++sampleIdx) {
-        // Get this sample in floating point format
-        const Spu::StereoSample sample = Spu::stepCore(gSpu);
+    float* const pOutputStart = reinterpret_cast<float*>(pOutput);
+    float* pOutputF = pOutputStart;
+    PsxVm::LockSpu spuLock;
 
-        #if SIMPLE_SPU_FLOAT_SPU
-            float sampleL = sample.left;
-            float sampleR = sample.right;
-        #else
-            float sampleL = Spu::toFloatSample(sample.left);
-            float sampleR = Spu::toFloatSample(sample.right);
-        #endif
+    for (uint32_t blockStartIdx = 0; blockStartIdx < numSpuSamples; blockStartIdx += MAX_BLOCK_SIZE) {
+        // Pick up any SPU commands queued by the main thread since the last block (or since taking the lock), then generate the block
+        const uint32_t blockSize = std::min(numSpuSamples - blockStartIdx, MAX_BLOCK_SIZE);
+        applyPendingSpuCmds();
+        Spu::stepCoreBlock(gSpu, samples, blockSize);
+
+        // Get the block in interleaved floating point format, writing directly to the output if not resampling
+        float* const pBlockF = (gbAudioResample) ? samplesF : pOutputF;
+
+        for (uint32_t sampleIdx = 0; sampleIdx < blockSize; ++sampleIdx) {
+            const Spu::StereoSample sample = samples[sampleIdx];
+
+            #if SIMPLE_SPU_FLOAT_SPU
+                pBlockF[sampleIdx * 2 + 0] = sample.left;
+                pBlockF[sampleIdx * 2 + 1] = sample.right;
+            #else
+                pBlockF[sampleIdx * 2 + 0] = Spu::toFloatSample(sample.left);
+                pBlockF[sampleIdx * 2 + 1] = Spu::toFloatSample(sample.right);
+            #endif
+        }
 
         // If using the floating point SPU apply audio compression.
         // When using floating point sound the audio can get EXTREMELY loud (and painful to listen to) if not capped.
         // When using the original 16-bit SPU the sound will also clip/distort if too loud, so no point in using compression in that case.
         #if SIMPLE_SPU_FLOAT_SPU
-            AudioCompressor::compress(gAudioCompState, sampleL, sampleR);
+            AudioCompressor::compressBlock(gAudioCompState, pBlockF, blockSize);
         #endif
 
-        pOutputF[0] = sampleL;
-        pOutputF[1] = sampleR;
-        pOutputF += 2;
+        if (gbAudioResample) {
+            AudioResampler::addInput(gAudioResampler, pBlockF, blockSize);
+        } else {
+            pOutputF += blockSize * 2;
+        }
+    }
+
+    if (gbAudioResample) {
+        AudioResampler::resample(gAudioResampler, pOutputStart, numSamples);
     }
+
+    updateAudioStats(startTime, std::chrono::steady_clock::now(), numSamples);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -103,6 +236,39 @@ static void getVramSize(uint16_t& vramW, uint16_t& vramH) noexcept {
     #endif
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Parses the game disc image and builds up the ISO file system for it.
+// This runs on the disc mount thread, so any errors are saved for reporting later on the main thread rather than raised here.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void mountDisc(const char* const doomCdCuePath) noexcept {
+    // Parse the .cue (or .chd) info for the game disc
+    std::string parseErrorMsg;
+
+    if (!gDiscInfo.parseFromImageFile(doomCdCuePath, parseErrorMsg)) {
+        char errorMsg[1024];
+        std::snprintf(
+            errorMsg,
+            sizeof(errorMsg),
+            "Couldn't open or failed to parse the game disc .cue or .chd file '%s'!\nError message: %s",
+            doomCdCuePath,
+            parseErrorMsg.c_str()
+        );
+
+        gDiscMountErrorMsg = errorMsg;
+        return;
+    }
+
+    // Build up the ISO file system from the game disc
+    DiscReader discReader(gDiscInfo);
+
+    if (!gIsoFileSys.build(discReader, Config::gDiscIndexCacheDir.c_str())) {
+        gDiscMountErrorMsg = (
+            "Failed to extract the ISO 9960 filesystem records from the game's disc! "
+            "Is the disc in a strange format, or is the image corrupt?"
+        );
+    }
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Initialize emulated PlayStation system components and use the given .cue file for the game disc
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -113,6 +279,7 @@ bool init(const char* const doomCdCuePath) noexcept {
         uint16_t vramH = {};
         getVramSize(vramW, vramH);
         Gpu::initCore(gGpu, vramW, vramH);
+        LIBGPU_CmdDispatch::resetGpuStateIds();
     }
 
     // Init the SPU core and use extended hardware voice counts (64 max) and an expanded RAM size (defaulted to 16 MiB) if the build is limit removing.
@@ -130,6 +297,10 @@ bool init(const char* const doomCdCuePath) noexcept {
 
     Spu::initCore(gSpu, spuRamSize, SPU_VOICE_COUNT);
 
+    // Cache decoded ADPCM blocks so that frequently repeated sounds don't need to be decoded again every time they play
+    constexpr uint32_t SPU_ADPCM_CACHE_SIZE = 8192;
+    Spu::initAdpcmCache(gSpu, SPU_ADPCM_CACHE_SIZE);
+
     // Init the audio compressor if using the float SPU (don't need it for the 16-bit SPU)
     #if SIMPLE_SPU_FLOAT_SPU
         AudioCompressor::init(
@@ -144,37 +315,38 @@ bool init(const char* const doomCdCuePath) noexcept {
         );
     #endif
 
-    // Parse the .cue info for the game disc
-    {
-        std::string parseErrorMsg;
-
-        if (!gDiscInfo.parseFromCueFile(doomCdCuePath, parseErrorMsg)) {
-            FatalErrors::raiseF(
-                "Couldn't open or failed to parse the game disc .cue file '%s'!\nError message: %s",
-                doomCdCuePath,
-                parseErrorMsg.c_str()
-            );
+    // Mount the game disc on a background thread while the rest of startup (window, video backend and audio device creation) continues.
+    // Anything needing the disc contents must call 'waitForDiscMount' first.
+    gDiscMountErrorMsg.clear();
+    gDiscMountThread = std::thread([cuePath = std::string(doomCdCuePath)]() noexcept { mountDisc(cuePath.c_str()); });
+
+    // Setup sound.
+    // Note: don't open an audio device when doing a timedemo or soak benchmark since we won't be playing back in realtime.
+    const bool bBenchmarking = (ProgArgs::gbTimeDemo || (ProgArgs::gSoakSeconds > 0));
+
+    if ((!bBenchmarking) && (SDL_InitSubSystem(SDL_INIT_AUDIO) >= 0)) {
+        // Find out the native sample rate of the default audio device and resample the SPU output to that, if the ratio between the rates
+        // is one that the resampler supports. Otherwise fall back to the SPU's sample rate and let SDL do any resampling needed.
+        char* pDeviceName = nullptr;
+        SDL_AudioSpec nativeFmt = {};
+        gAudioOutputRate = SPU_SAMPLE_RATE;
+        gbAudioResample = false;
+
+        if (SDL_GetDefaultAudioInfo(&pDeviceName, &nativeFmt, false) == 0) {
+            SDL_free(pDeviceName);
+
+            if ((nativeFmt.freq > 0) && ((uint32_t) nativeFmt.freq != SPU_SAMPLE_RATE)) {
+                if (AudioResampler::init(gAudioResampler, SPU_SAMPLE_RATE, (uint32_t) nativeFmt.freq)) {
+                    gAudioOutputRate = (uint32_t) nativeFmt.freq;
+                    gbAudioResample = true;
+                }
+            }
         }
-    }
 
-    // Build up the ISO file system from the game disc
-    {
-        DiscReader discReader(gDiscInfo);
-
-        if (!gIsoFileSys.build(discReader)) {
-            FatalErrors::raise(
-                "Failed to extract the ISO 9960 filesystem records from the game's disc! "
-                "Is the disc in a strange format, or is the image corrupt?"
-            );
-        }
-    }
-
-    // Setup sound
-    if (SDL_InitSubSystem(SDL_INIT_AUDIO) >= 0) {
-        // Firstly try to open an audio device sampling at 44,100 Hz stereo in floating point mode.
+        // Try to open an audio device sampling at that rate in stereo floating point mode.
         // Note that if initialization succeeds then we've got our requested format, since we ask SDL not to allow any deviation.
         SDL_AudioSpec wantFmt = {};
-        wantFmt.freq = 44100;
+        wantFmt.freq = (int) gAudioOutputRate;
         wantFmt.format = AUDIO_F32;
         wantFmt.channels = 2;
 
@@ -189,6 +361,14 @@ bool init(const char* const doomCdCuePath) noexcept {
         SDL_AudioSpec gotFmt = {};
         gSdlAudioDeviceId = SDL_OpenAudioDevice(nullptr, false, &wantFmt, &gotFmt, false);
 
+        // If the native rate didn't work out for some reason then try again at the SPU's sample rate
+        if ((gSdlAudioDeviceId == 0) && gbAudioResample) {
+            gAudioOutputRate = SPU_SAMPLE_RATE;
+            gbAudioResample = false;
+            wantFmt.freq = (int) SPU_SAMPLE_RATE;
+            gSdlAudioDeviceId = SDL_OpenAudioDevice(nullptr, false, &wantFmt, &gotFmt, false);
+        }
+
         if (gSdlAudioDeviceId != 0) {
             SDL_PauseAudioDevice(gSdlAudioDeviceId, false);
         } else {
@@ -201,10 +381,29 @@ bool init(const char* const doomCdCuePath) noexcept {
     return true;
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Waits for the game disc to finish mounting after 'init' is called, and raises a fatal error if that failed.
+// Must be called before accessing the disc info or the file system for the disc.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void waitForDiscMount() noexcept {
+    if (gDiscMountThread.joinable()) {
+        gDiscMountThread.join();
+    }
+
+    if (!gDiscMountErrorMsg.empty()) {
+        FatalErrors::raise(gDiscMountErrorMsg.c_str());
+    }
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Tear down emulated PlayStation components
 //------------------------------------------------------------------------------------------------------------------------------------------
 void shutdown() noexcept {
+    // Make sure the disc mount thread is done before tearing everything down
+    if (gDiscMountThread.joinable()) {
+        gDiscMountThread.join();
+    }
+
     if (gSdlAudioDeviceId != 0) {
         SDL_PauseAudioDevice(gSdlAudioDeviceId, true);
         SDL_CloseAudioDevice(gSdlAudioDeviceId);
@@ -220,12 +419,66 @@ bool haveAudioOutputDevice() noexcept {
     return (gSdlAudioDeviceId != 0);
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Get the current statistics for the audio callback
+//------------------------------------------------------------------------------------------------------------------------------------------
+AudioStats getAudioStats() noexcept {
+    AudioStats stats = {};
+    stats.numCallbacks = gAudioNumCallbacks.load(std::memory_order_relaxed);
+    stats.numLateCallbacks = gAudioNumLateCallbacks.load(std::memory_order_relaxed);
+    stats.bufferMs = gAudioBufferMs.load(std::memory_order_relaxed);
+    stats.avgCallbackMs = gAudioAvgCallbackMs.load(std::memory_order_relaxed);
+    stats.peakCallbackMs = gAudioPeakCallbackMs.load(std::memory_order_relaxed);
+    return stats;
+}
+
 void lockSpu() noexcept {
     gSpuMutex.lock();
+    applyPendingSpuCmds();
 }
 
 void unlockSpu() noexcept {
     gSpuMutex.unlock();
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Queue a command to modify the SPU, to be applied by whoever next holds the SPU lock.
+// The given arguments are copied into the queue and a pointer to that copy is passed to the command function when it is applied.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void queueSpuCmd(const SpuCmdFunc pFunc, const void* const pArgs, const uint32_t argsSize) noexcept {
+    ASSERT(pFunc);
+    ASSERT(pArgs || (argsSize == 0));
+    ASSERT(argsSize <= MAX_SPU_CMD_ARGS_SIZE);
+
+    // If there is no audio thread to consume commands, or if the queue is full, then just apply the command immediately.
+    // Locking the SPU applies all previously queued commands first, so ordering is still preserved.
+    const uint32_t tail = gSpuCmdQueueTail.load(std::memory_order_relaxed);
+    const uint32_t head = gSpuCmdQueueHead.load(std::memory_order_acquire);
+
+    if ((gSdlAudioDeviceId == 0) || (tail - head >= SPU_CMD_QUEUE_SIZE)) {
+        LockSpu spuLock;
+        pFunc(pArgs);
+        return;
+    }
+
+    // Fill in the command and make it visible to the consumer
+    SpuCmd& cmd = gSpuCmdQueue[tail % SPU_CMD_QUEUE_SIZE];
+    cmd.pFunc = pFunc;
+    std::memcpy(cmd.args, pArgs, argsSize);
+    gSpuCmdQueueTail.store(tail + 1, std::memory_order_release);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Ensures all queued SPU commands have been applied before returning.
+// Only needs to wait on the SPU lock if there are actually commands pending.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void flushSpuCmds() noexcept {
+    const uint32_t tail = gSpuCmdQueueTail.load(std::memory_order_relaxed);
+    const uint32_t head = gSpuCmdQueueHead.load(std::memory_order_acquire);
+
+    if (head != tail) {
+        LockSpu spuLock;
+    }
+}
+
 END_NAMESPACE(PsxVm)
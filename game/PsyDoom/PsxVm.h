@@ -3,6 +3,8 @@
 #include "Macros.h"
 
 #include <cstdint>
+#include <cstring>
+#include <type_traits>
 
 struct DiscInfo;
 struct IsoFileSys;
@@ -26,11 +28,23 @@ extern Gpu::Core    gGpu;
 extern Spu::Core    gSpu;
 
 bool init(const char* const doomCdCuePath) noexcept;
+void waitForDiscMount() noexcept;
 void shutdown() noexcept;
 
 // Returns 'true' if there is valid audio output device
 bool haveAudioOutputDevice() noexcept;
 
+// Statistics for the audio callback, used to judge how much headroom the audio buffer has
+struct AudioStats {
+    uint32_t    numCallbacks;           // How many times audio has been requested by the audio device
+    uint32_t    numLateCallbacks;       // How many requests came late enough that the device likely ran out of audio (underran)
+    float       bufferMs;               // The duration of audio generated for each request
+    float       avgCallbackMs;          // Average time taken to generate each buffer of audio
+    float       peakCallbackMs;         // Recent peak time taken to generate a buffer of audio (slowly decays)
+};
+
+AudioStats getAudioStats() noexcept;
+
 // Fire timer (root counter) related events if appropriate.
 // Note: this is implemented in LIBAPI, where timers are handled.
 void generateTimerEvents() noexcept;
@@ -45,4 +59,34 @@ struct LockSpu {
     ~LockSpu() noexcept { unlockSpu(); }
 };
 
+// Queued SPU commands: a way to modify the SPU without waiting on the audio thread to release the SPU lock.
+// Commands are pushed onto a lock-free single producer, single consumer ring buffer and are applied in order by whoever next holds the SPU
+// lock; normally this is the audio thread, at sample block boundaries. Locking the SPU always applies any pending commands first, so that
+// state read while the lock is held is up to date. Notes:
+//  (1) Only the main thread may queue commands.
+//  (2) Command functions are invoked with the SPU locked and must NOT lock the SPU themselves.
+//  (3) If the queue is full, or if there is no audio thread, then the command is applied immediately with the SPU locked.
+typedef void (*SpuCmdFunc)(const void* const pArgs) noexcept;
+static constexpr uint32_t MAX_SPU_CMD_ARGS_SIZE = 96;
+
+void queueSpuCmd(const SpuCmdFunc pFunc, const void* const pArgs, const uint32_t argsSize) noexcept;
+void flushSpuCmds() noexcept;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Helper: queue a command which is applied using the given function and a copy of the specified arguments
+//------------------------------------------------------------------------------------------------------------------------------------------
+template <class ArgsT, void (*Func)(const ArgsT& args) noexcept>
+inline void queueSpuCmd(const ArgsT& args) noexcept {
+    static_assert(std::is_trivially_copyable_v<ArgsT>);
+    static_assert(sizeof(ArgsT) <= MAX_SPU_CMD_ARGS_SIZE);
+
+    const SpuCmdFunc pFunc = [](const void* const pArgs) noexcept {
+        ArgsT argsCopy;
+        std::memcpy(&argsCopy, pArgs, sizeof(ArgsT));
+        Func(argsCopy);
+    };
+
+    queueSpuCmd(pFunc, &args, sizeof(ArgsT));
+}
+
 END_NAMESPACE(PsxVm)
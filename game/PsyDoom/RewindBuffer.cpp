@@ -0,0 +1,355 @@
+//------------------------------------------------------------------------------------------------------------------------------------------
+// A developer feature that records a history of the game state for the current map and allows it to be rewound.
+//
+// The game state is captured periodically using the same format as save files (see 'SaveAndLoad::captureSnapshot') and stored in a bounded
+// ring buffer. To keep memory usage down most frames are stored as a delta against the previous frame: the two frames are XORed together and
+// the result run length encoded, which is very effective since most of the game state does not change between frames. Every so often a full
+// keyframe is stored instead (also run length encoded), so that any frame can be rebuilt by applying a limited number of deltas.
+// When the memory budget is exceeded the oldest keyframe and all of the deltas which depend on it are discarded.
+//
+// Recording is only active in singleplayer games when the developer cheat shortcuts are enabled, and never during demo recording or playback.
+//------------------------------------------------------------------------------------------------------------------------------------------
+#include "RewindBuffer.h"
+
+#include "Asserts.h"
+#include "ByteInputStream.h"
+#include "ByteVecOutputStream.h"
+#include "Config/Config.h"
+#include "Doom/Game/g_game.h"
+#include "Doom/Game/p_tick.h"
+#include "Doom/UI/st_main.h"
+#include "SaveAndLoad.h"
+#include "SaveDataTypes.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <deque>
+#include <vector>
+
+BEGIN_NAMESPACE(RewindBuffer)
+
+static constexpr uint32_t   RECORD_INTERVAL_TICS    = 5;                    // How many game tics between each captured frame (1/3 of a second for NTSC)
+static constexpr uint32_t   KEYFRAME_INTERVAL       = 30;                   // Store a full keyframe every this many frames (every 10 seconds for NTSC)
+static constexpr uint32_t   REWIND_NUM_FRAMES       = 6;                    // How many frames to go back for each rewind request (2 seconds for NTSC)
+static constexpr size_t     MAX_MEMORY_USAGE        = 64 * 1024 * 1024;     // Memory budget for the entire rewind history
+
+// A single frame in the rewind history
+struct Frame {
+    std::vector<std::byte>  encoded;        // Run length encoded XOR delta against the previous frame (or against all zeros for a keyframe)
+    uint32_t                rawSize;        // Size of the decoded frame in bytes
+    bool                    bIsKeyframe;    // If true this frame does not depend on any previous frames
+};
+
+static std::deque<Frame>        gFrames;                // The recorded history of frames, oldest first
+static std::vector<std::byte>   gLastFrameBytes;        // The decoded bytes of the newest frame in the history, used to build the next delta
+static size_t                   gMemoryUsage;           // Total number of bytes used by the encoded frames
+static uint32_t                 gTicsUntilNextFrame;    // How many game tics until the next frame is captured
+static uint32_t                 gFramesSinceKeyframe;   // How many frames have been captured since the last keyframe
+static bool                     gbRewindRequested;      // Set when a rewind has been requested and is to be done on the next tick boundary
+static char                     gMessageBuffer[64];     // Buffer for the status bar message shown after rewinding
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Writes a variable length unsigned integer to the given output vector, 7 bits at a time
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void writeVarUint(std::vector<std::byte>& out, uint32_t value) noexcept {
+    while (value >= 0x80) {
+        out.push_back((std::byte)((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+
+    out.push_back((std::byte) value);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Reads a variable length unsigned integer written by 'writeVarUint' and advances the given read position
+//------------------------------------------------------------------------------------------------------------------------------------------
+static uint32_t readVarUint(const std::byte*& pCur) noexcept {
+    uint32_t value = 0;
+    uint32_t shift = 0;
+
+    while (true) {
+        const uint32_t byte = (uint32_t) *pCur++;
+        value |= (byte & 0x7F) << shift;
+
+        if ((byte & 0x80) == 0)
+            return value;
+
+        shift += 7;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Encodes the given frame as an XOR delta against the previous frame, run length encoded.
+// Bytes past the end of the previous frame are treated as zero. The encoding is a series of pairs: a count of unchanged bytes (zero after
+// XOR) followed by a count of changed bytes and then the XORed values of those changed bytes.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void encodeFrame(const std::vector<std::byte>& cur, const std::vector<std::byte>& prev, std::vector<std::byte>& out) noexcept {
+    const size_t curSize = cur.size();
+    const size_t prevSize = prev.size();
+    const auto getDelta = [&](const size_t i) noexcept {
+        return (i < prevSize) ? (cur[i] ^ prev[i]) : cur[i];
+    };
+
+    out.clear();
+    size_t i = 0;
+
+    while (i < curSize) {
+        // Count the unchanged bytes: no need to encode any unchanged bytes at the end of the frame
+        const size_t unchangedStart = i;
+
+        while ((i < curSize) && (getDelta(i) == std::byte(0))) {
+            ++i;
+        }
+
+        if (i >= curSize)
+            break;
+
+        // Count the changed bytes, absorbing short runs of unchanged bytes if that is cheaper than starting a new pair
+        const size_t changedStart = i;
+        size_t changedEnd = i;
+
+        while (i < curSize) {
+            if (getDelta(i) != std::byte(0)) {
+                changedEnd = ++i;
+                continue;
+            }
+
+            size_t gapEnd = i;
+
+            while ((gapEnd < curSize) && (gapEnd - i < 4) && (getDelta(gapEnd) == std::byte(0))) {
+                ++gapEnd;
+            }
+
+            if ((gapEnd - i >= 4) || (gapEnd >= curSize))
+                break;
+
+            i = gapEnd;
+        }
+
+        i = changedEnd;
+        writeVarUint(out, (uint32_t)(changedStart - unchangedStart));
+        writeVarUint(out, (uint32_t)(changedEnd - changedStart));
+
+        for (size_t j = changedStart; j < changedEnd; ++j) {
+            out.push_back(getDelta(j));
+        }
+    }
+
+    out.shrink_to_fit();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Applies the given encoded frame on top of the given decoded previous frame, producing the decoded bytes for the frame in-place
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void decodeFrame(const Frame& frame, std::vector<std::byte>& bytes) noexcept {
+    if (frame.bIsKeyframe) {
+        bytes.clear();
+    }
+
+    bytes.resize(frame.rawSize, std::byte(0));
+
+    const std::byte* pCur = frame.encoded.data();
+    const std::byte* const pEnd = pCur + frame.encoded.size();
+    size_t outIdx = 0;
+
+    while (pCur < pEnd) {
+        outIdx += readVarUint(pCur);
+        const uint32_t numChanged = readVarUint(pCur);
+        ASSERT(outIdx + numChanged <= bytes.size());
+
+        for (uint32_t j = 0; j < numChanged; ++j) {
+            bytes[outIdx++] ^= *pCur++;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Discards the oldest frames (the oldest keyframe and all deltas depending on it) until the history fits within the memory budget.
+// Always keeps the most recent keyframe group, no matter how big it is.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void trimToMemoryBudget() noexcept {
+    while (gMemoryUsage > MAX_MEMORY_USAGE) {
+        // Find the next keyframe after the oldest one: if there is none then we can't discard anything
+        const auto nextKeyframeIter = std::find_if(gFrames.begin() + 1, gFrames.end(), [](const Frame& frame) noexcept {
+            return frame.bIsKeyframe;
+        });
+
+        if (nextKeyframeIter == gFrames.end())
+            break;
+
+        for (auto iter = gFrames.begin(); iter != nextKeyframeIter; ++iter) {
+            gMemoryUsage -= iter->encoded.size();
+        }
+
+        gFrames.erase(gFrames.begin(), nextKeyframeIter);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Captures the current game state and adds it to the rewind history
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void recordFrame() noexcept {
+    // Capture the game state and serialize it to bytes in the save file format
+    SaveData saveData;
+    SaveAndLoad::captureSnapshot(saveData);
+
+    ByteVecOutputStream out;
+
+    if (!saveData.writeTo(out))
+        return;
+
+    const std::vector<std::byte>& curBytes = out.getBytes();
+
+    // Encode as either a keyframe or a delta against the previous frame
+    Frame& frame = gFrames.emplace_back();
+    frame.rawSize = (uint32_t) curBytes.size();
+    frame.bIsKeyframe = (gFrames.size() == 1) || (gFramesSinceKeyframe + 1 >= KEYFRAME_INTERVAL);
+    static const std::vector<std::byte> noBytes;
+    encodeFrame(curBytes, (frame.bIsKeyframe) ? noBytes : gLastFrameBytes, frame.encoded);
+
+    gFramesSinceKeyframe = (frame.bIsKeyframe) ? 0 : gFramesSinceKeyframe + 1;
+    gMemoryUsage += frame.encoded.size();
+    gLastFrameBytes = curBytes;
+    trimToMemoryBudget();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tells if rewind recording is allowed in the current game
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool isRewindAllowed() noexcept {
+    return (
+        Config::gbEnableDevCheatShortcuts &&
+        (gNetGame == gt_single) &&
+        (!gbDemoPlayback) &&
+        (!gbDemoRecording)
+    );
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Discards the entire rewind history: should be called whenever a new map is started
+//------------------------------------------------------------------------------------------------------------------------------------------
+void clear() noexcept {
+    gFrames.clear();
+    gFrames.shrink_to_fit();
+    gLastFrameBytes.clear();
+    gLastFrameBytes.shrink_to_fit();
+    gMemoryUsage = 0;
+    gTicsUntilNextFrame = 0;
+    gFramesSinceKeyframe = 0;
+    gbRewindRequested = false;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Should be called once per game tic boundary (15 Hz for NTSC) during gameplay.
+// Does any requested rewind or otherwise captures a new frame for the history if it is time.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void update() noexcept {
+    if (!isRewindAllowed()) {
+        if (!gFrames.empty()) {
+            clear();
+        }
+
+        return;
+    }
+
+    if (gbRewindRequested) {
+        gbRewindRequested = false;
+
+        if (rewind(REWIND_NUM_FRAMES)) {
+            std::snprintf(gMessageBuffer, sizeof(gMessageBuffer), "Rewound (%.1f MB history)", (float) getMemoryUsage() / (1024.0f * 1024.0f));
+        } else {
+            std::snprintf(gMessageBuffer, sizeof(gMessageBuffer), "Nothing to rewind!");
+        }
+
+        gStatusBar.message = gMessageBuffer;
+        gStatusBar.messageTicsLeft = 30;
+        return;
+    }
+
+    if (gbGamePaused)
+        return;
+
+    if (gTicsUntilNextFrame > 0) {
+        gTicsUntilNextFrame--;
+        return;
+    }
+
+    recordFrame();
+    gTicsUntilNextFrame = RECORD_INTERVAL_TICS - 1;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Requests that the game be rewound on the next game tic boundary
+//------------------------------------------------------------------------------------------------------------------------------------------
+void requestRewind() noexcept {
+    if (isRewindAllowed()) {
+        gbRewindRequested = true;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Rewinds the game state by the specified number of frames, or to the oldest frame in the history if there are not enough frames.
+// All frames newer than the one rewound to are discarded. Returns 'false' if there was nothing to rewind to or the restore failed.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool rewind(const uint32_t numFrames) noexcept {
+    if (gFrames.size() < 2)
+        return false;
+
+    // Figure out which frame to go back to and the keyframe that it depends on
+    const size_t targetIdx = (gFrames.size() - 1 > numFrames) ? gFrames.size() - 1 - numFrames : 0;
+    size_t keyframeIdx = targetIdx;
+
+    while (!gFrames[keyframeIdx].bIsKeyframe) {
+        ASSERT(keyframeIdx > 0);
+        keyframeIdx--;
+    }
+
+    // Rebuild the frame and discard everything after it
+    std::vector<std::byte> frameBytes;
+
+    for (size_t i = keyframeIdx; i <= targetIdx; ++i) {
+        decodeFrame(gFrames[i], frameBytes);
+    }
+
+    for (size_t i = targetIdx + 1; i < gFrames.size(); ++i) {
+        gMemoryUsage -= gFrames[i].encoded.size();
+    }
+
+    gFrames.erase(gFrames.begin() + (targetIdx + 1), gFrames.end());
+    gFramesSinceKeyframe = (uint32_t)(targetIdx - keyframeIdx);
+    gTicsUntilNextFrame = RECORD_INTERVAL_TICS - 1;
+
+    // Read the frame back in and restore it
+    SaveData saveData;
+    ByteInputStream in(frameBytes.data(), frameBytes.size());
+
+    if (saveData.readFrom(in) != ReadSaveResult::OK) {
+        clear();
+        return false;
+    }
+
+    gLastFrameBytes = std::move(frameBytes);
+
+    if (SaveAndLoad::restoreSnapshot(saveData) != LoadSaveResult::OK) {
+        clear();
+        return false;
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Returns the number of frames in the rewind history
+//------------------------------------------------------------------------------------------------------------------------------------------
+uint32_t getNumFrames() noexcept {
+    return (uint32_t) gFrames.size();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Returns the approximate amount of memory used by the rewind history in bytes
+//------------------------------------------------------------------------------------------------------------------------------------------
+size_t getMemoryUsage() noexcept {
+    return gMemoryUsage + gLastFrameBytes.size() + gFrames.size() * sizeof(Frame);
+}
+
+END_NAMESPACE(RewindBuffer)
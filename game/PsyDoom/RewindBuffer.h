@@ -0,0 +1,17 @@
+#pragma once
+
+#include "Macros.h"
+
+#include <cstddef>
+#include <cstdint>
+
+BEGIN_NAMESPACE(RewindBuffer)
+
+void clear() noexcept;
+void update() noexcept;
+void requestRewind() noexcept;
+bool rewind(const uint32_t numFrames) noexcept;
+uint32_t getNumFrames() noexcept;
+size_t getMemoryUsage() noexcept;
+
+END_NAMESPACE(RewindBuffer)
@@ -4,15 +4,20 @@
 //------------------------------------------------------------------------------------------------------------------------------------------
 #include "SaveAndLoad.h"
 
+#include "ByteVecOutputStream.h"
+#include "Config/Config.h"
 #include "Doom/Base/s_sound.h"
 #include "Doom/Base/z_zone.h"
+#include "Doom/d_main.h"
 #include "Doom/Game/g_game.h"
 #include "Doom/Game/p_ceiling.h"
 #include "Doom/Game/p_floor.h"
+#include "Doom/Game/p_flowfield.h"
 #include "Doom/Game/p_lights.h"
 #include "Doom/Game/p_maputl.h"
 #include "Doom/Game/p_mobj.h"
 #include "Doom/Game/p_plats.h"
+#include "Doom/Game/p_pspr.h"
 #include "Doom/Game/p_setup.h"
 #include "Doom/Game/p_spec.h"
 #include "Doom/Game/p_switch.h"
@@ -24,9 +29,13 @@
 #include "MapHash.h"
 #include "OutputStream.h"
 #include "SaveDataTypes.h"
+#include "SaveFileWriter.h"
 #include "ScriptingEngine.h"
+#include "ThinkerPool.h"
 #include "Utils.h"
 
+#include <algorithm>
+
 BEGIN_NAMESPACE(SaveAndLoad)
 
 // Save/load accelerator LUT: maps from a map object to it's index in the global linked list of map objects
@@ -53,6 +62,9 @@ static std::vector<delayaction_t*>      gDelayedExits;
 // A list of buttons that are active: used during saving
 static std::vector<button_t*> gActiveButtons;
 
+// The order of the thinkers list, as references to thinkers in the lists above: used during saving
+static std::vector<SavedThinkerRefT> gThinkerOrder;
+
 // Used during loading, the input save data loaded into memory
 static SaveData gSaveDataIn;
 
@@ -78,12 +90,13 @@ static void removeAllMobj() noexcept {
 // Removes all thinkers from the game
 //------------------------------------------------------------------------------------------------------------------------------------------
 static void removeAllThinkers() noexcept {
-    // Remove all thinkers
+    // Remove all thinkers, including ones which were moved out of the main thinker list
+    P_UnsegregateThinkers();
     thinker_t* pThinker = gThinkerCap.next;
 
     while (pThinker != &gThinkerCap) {
         thinker_t* const pNextThinker = pThinker->next;
-        Z_Free2(*gpMainMemZone, pThinker);
+        ThinkerPool::dealloc(pThinker);
         pThinker = pNextThinker;
     }
 
@@ -120,11 +133,10 @@ static void removeActiveButtons() noexcept {
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Allocates all of the map objects to be loaded; assumes there no map objects currently existing in the game
 //------------------------------------------------------------------------------------------------------------------------------------------
-static void allocMobjsToLoad() noexcept {
+static void allocMobjsToLoad(const uint32_t numMobjs) noexcept {
     // Sanity check, there should be no map objects in the game at this point
     ASSERT(gMobjHead.next == &gMobjHead);
 
-    const uint32_t numMobjs = gSaveDataIn.hdr.numMobjs;
     gMobjToIdx.clear();
     gMobjList.clear();
     gMobjToIdx.reserve(numMobjs);
@@ -134,7 +146,8 @@ static void allocMobjsToLoad() noexcept {
 
     for (uint32_t i = 0; i < numMobjs; ++i) {
         // Alloc the map object and zero init
-        mobj_t& mobj = *(mobj_t*) Z_ZeroedMalloc(*gpMainMemZone, sizeof(mobj_t), PU_LEVEL, nullptr);
+        mobj_t& mobj = ThinkerPool::alloc<mobj_t>(PU_LEVEL);
+        D_memset(&mobj, std::byte(0), sizeof(mobj_t));
 
         #if PSYDOOM_MODS
             new (&mobj) mobj_t();   // PsyDoom: construct C++ weak pointers
@@ -155,6 +168,7 @@ static void allocMobjsToLoad() noexcept {
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Allocates thinkers of the specified type that are to be loaded and places pointers to them in the specified list.
+// The thinkers are not added to the thinkers list yet, that is done in the saved order once all thinkers are allocated.
 //------------------------------------------------------------------------------------------------------------------------------------------
 template <class ThinkerT>
 static void allocThinkersToLoad(std::vector<ThinkerT*>& outputList, const uint32_t amt) noexcept {
@@ -162,18 +176,89 @@ static void allocThinkersToLoad(std::vector<ThinkerT*>& outputList, const uint32
     outputList.reserve(amt);
 
     for (uint32_t i = 0; i < amt; ++i) {
-        ThinkerT& thinker = *(ThinkerT*) Z_ZeroedMalloc(*gpMainMemZone, sizeof(ThinkerT), PU_LEVSPEC, nullptr);
-        P_AddThinker(thinker.thinker);
+        ThinkerT& thinker = ThinkerPool::alloc<ThinkerT>(PU_LEVSPEC);
+        D_memset(&thinker, std::byte(0), sizeof(ThinkerT));
         outputList.push_back(&thinker);
     }
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Returns the allocated thinker to be loaded at the given index in the given list, or null if the index is out of range
+//------------------------------------------------------------------------------------------------------------------------------------------
+template <class ThinkerT>
+static thinker_t* getThinkerToLoad(const std::vector<ThinkerT*>& thinkers, const uint32_t idx) noexcept {
+    return (idx < thinkers.size()) ? &thinkers[idx]->thinker : nullptr;
+}
+
+static thinker_t* getThinkerToLoad(const SavedThinkerRefT& thinkerRef) noexcept {
+    switch (thinkerRef.type) {
+        case SavedThinkerType::VlDoor:          return getThinkerToLoad(gVlDoors, thinkerRef.idx);
+        case SavedThinkerType::VlCustomDoor:    return getThinkerToLoad(gVlCustomDoors, thinkerRef.idx);
+        case SavedThinkerType::FloorMover:      return getThinkerToLoad(gFloorMovers, thinkerRef.idx);
+        case SavedThinkerType::Ceiling:         return getThinkerToLoad(gCeilings, thinkerRef.idx);
+        case SavedThinkerType::Plat:            return getThinkerToLoad(gPlats, thinkerRef.idx);
+        case SavedThinkerType::FireFlicker:     return getThinkerToLoad(gFireFlickers, thinkerRef.idx);
+        case SavedThinkerType::LightFlash:      return getThinkerToLoad(gLightFlashes, thinkerRef.idx);
+        case SavedThinkerType::Strobe:          return getThinkerToLoad(gStrobes, thinkerRef.idx);
+        case SavedThinkerType::Glow:            return getThinkerToLoad(gGlows, thinkerRef.idx);
+        case SavedThinkerType::DelayedExit:     return getThinkerToLoad(gDelayedExits, thinkerRef.idx);
+
+        default:
+            return nullptr;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Adds any of the given allocated thinkers which are not yet in the thinkers list to the end of the list
+//------------------------------------------------------------------------------------------------------------------------------------------
+template <class ThinkerT>
+static void addUnlinkedThinkersToLoad(const std::vector<ThinkerT*>& thinkers) noexcept {
+    for (ThinkerT* const pThinker : thinkers) {
+        if (!pThinker->thinker.prev) {
+            P_AddThinker(pThinker->thinker);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Adds all of the allocated thinkers to the thinkers list in the order recorded by the save data, which is the order they will update in.
+// If the recorded order is invalid then 'false' is returned; all thinkers are still added to the list, so the game state is consistent.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool addThinkersToLoadInSavedOrder(const SaveData& saveData) noexcept {
+    bool bValidOrder = true;
+    const uint32_t numThinkerRefs = saveData.hdr.numThinkerRefs;
+
+    for (uint32_t i = 0; i < numThinkerRefs; ++i) {
+        thinker_t* const pThinker = getThinkerToLoad(saveData.thinkerOrder[i]);
+
+        // Each thinker must be referenced only once: allocated thinkers have a null 'prev' link until they are added to the list
+        if ((!pThinker) || pThinker->prev) {
+            bValidOrder = false;
+            continue;
+        }
+
+        P_AddThinker(*pThinker);
+    }
+
+    addUnlinkedThinkersToLoad(gVlDoors);
+    addUnlinkedThinkersToLoad(gVlCustomDoors);
+    addUnlinkedThinkersToLoad(gFloorMovers);
+    addUnlinkedThinkersToLoad(gCeilings);
+    addUnlinkedThinkersToLoad(gPlats);
+    addUnlinkedThinkersToLoad(gFireFlickers);
+    addUnlinkedThinkersToLoad(gLightFlashes);
+    addUnlinkedThinkersToLoad(gStrobes);
+    addUnlinkedThinkersToLoad(gGlows);
+    addUnlinkedThinkersToLoad(gDelayedExits);
+    return bValidOrder;
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Allocates room for all of the buttons to be loaded
 //------------------------------------------------------------------------------------------------------------------------------------------
-static void allocButtonsToLoad() noexcept {
+static void allocButtonsToLoad(const SaveData& saveData) noexcept {
     // This can only be done in limit removing builds
-    const uint32_t numBtns = gSaveDataIn.hdr.numButtons;
+    const uint32_t numBtns = saveData.hdr.numButtons;
 
     #if PSYDOOM_LIMIT_REMOVING
         gButtonList.clear();
@@ -185,7 +270,7 @@ static void allocButtonsToLoad() noexcept {
 
         if (numBtns > MAXBUTTONS) {
             for (uint32_t i = MAXBUTTONS; i < numBtns; ++i) {
-                const SavedButtonT& savedBtn = gSaveDataIn.buttons[i];
+                const SavedButtonT& savedBtn = saveData.buttons[i];
 
                 if (savedBtn.lineIdx < (uint32_t) gNumLines) {
                     line_t& line = gpLines[savedBtn.lineIdx];
@@ -219,6 +304,7 @@ static void clearTempLuts() noexcept {
     gGlows.clear();
     gDelayedExits.clear();
     gActiveButtons.clear();
+    gThinkerOrder.clear();
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -234,6 +320,12 @@ static void gatherThinkersOfType(void (* const pThinkerFn)(ThinkerT& thinker), s
             outputList.push_back(reinterpret_cast<ThinkerT*>(pThinker));
         }
     }
+
+    for (thinker_t* const pThinker : P_GetSegregatedThinkers((think_t) pThinkerFn)) {
+        if ((void*) pThinker->function == (void*) pThinkerFn) {
+            outputList.push_back(reinterpret_cast<ThinkerT*>(pThinker));
+        }
+    }
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -307,6 +399,55 @@ static void gatherActiveButtons(std::vector<button_t*>& outputList, const uint32
     }
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Records the order of the thinkers list as references to the gathered lists of thinkers; expects those lists to be gathered already.
+// Thinkers which were moved out of the main list into buckets (see 'P_SegregateThinkers') can update in any order, so they come last.
+// That is also where they are returned to when the buckets are emptied, which is always done when loading.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void gatherThinkerOrder(std::vector<SavedThinkerRefT>& outputList) noexcept {
+    std::unordered_map<const thinker_t*, SavedThinkerRefT> thinkerToRef;
+
+    const auto addThinkerRefs = [&](const auto& thinkers, const SavedThinkerType type) noexcept {
+        for (uint32_t i = 0; i < (uint32_t) thinkers.size(); ++i) {
+            thinkerToRef[&thinkers[i]->thinker] = SavedThinkerRefT{ type, i };
+        }
+    };
+
+    addThinkerRefs(gVlDoors, SavedThinkerType::VlDoor);
+    addThinkerRefs(gVlCustomDoors, SavedThinkerType::VlCustomDoor);
+    addThinkerRefs(gFloorMovers, SavedThinkerType::FloorMover);
+    addThinkerRefs(gCeilings, SavedThinkerType::Ceiling);
+    addThinkerRefs(gPlats, SavedThinkerType::Plat);
+    addThinkerRefs(gFireFlickers, SavedThinkerType::FireFlicker);
+    addThinkerRefs(gLightFlashes, SavedThinkerType::LightFlash);
+    addThinkerRefs(gStrobes, SavedThinkerType::Strobe);
+    addThinkerRefs(gGlows, SavedThinkerType::Glow);
+    addThinkerRefs(gDelayedExits, SavedThinkerType::DelayedExit);
+
+    outputList.clear();
+    outputList.reserve(thinkerToRef.size());
+
+    const auto addToOrder = [&](const thinker_t* const pThinker) noexcept {
+        const auto iter = thinkerToRef.find(pThinker);
+
+        if (iter != thinkerToRef.end()) {
+            outputList.push_back(iter->second);
+        }
+    };
+
+    for (thinker_t* pThinker = gThinkerCap.next; pThinker != &gThinkerCap; pThinker = pThinker->next) {
+        addToOrder(pThinker);
+    }
+
+    for (thinker_t* const pThinker : P_GetSegregatedThinkers((think_t) &T_Glow)) {
+        addToOrder(pThinker);
+    }
+
+    for (thinker_t* const pThinker : P_GetSegregatedThinkers((think_t) &T_StrobeFlash)) {
+        addToOrder(pThinker);
+    }
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Builds the LUTs for accelerating map object lookups; this is a prerequisite step for saving and loading.
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -354,6 +495,7 @@ static void populateSaveHeader(SaveFileHdr& hdr) noexcept {
     hdr.numDelayedExits = (uint32_t) gDelayedExits.size();
     hdr.numButtons = (uint32_t) gActiveButtons.size();
     hdr.numScheduledActions = (uint32_t) ScriptingEngine::gScheduledActions.size();
+    hdr.numThinkerRefs = (uint32_t) gThinkerOrder.size();
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -458,9 +600,9 @@ static void playOrStopCdTrackIfNeeded(const int32_t cdTrackNum) noexcept {
 // Load helper: add loaded active ceilings and plats to the active lists.
 // Note: expects the lists of output ceilings and plats to be allocated.
 //------------------------------------------------------------------------------------------------------------------------------------------
-static void addActiveCeilingsAndPlats() noexcept {
-    const uint32_t numCeils = gSaveDataIn.hdr.numCeilings;
-    const uint32_t numPlats = gSaveDataIn.hdr.numPlats;
+static void addActiveCeilingsAndPlats(const SaveFileHdr& hdr) noexcept {
+    const uint32_t numCeils = hdr.numCeilings;
+    const uint32_t numPlats = hdr.numPlats;
     ASSERT(numCeils == gCeilings.size());
     ASSERT(numPlats == gPlats.size());
 
@@ -512,9 +654,10 @@ static void associateThinkersWithSectors(const std::vector<ThinkerT*>& thinkers)
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Attempts to save the game to the specified output file
+// Captures the current state of the game into the given in-memory snapshot, which is in the same format as a save file.
+// Pointers to map objects, sectors, lines and so on are converted to indexes. Any existing data in the snapshot is discarded.
 //------------------------------------------------------------------------------------------------------------------------------------------
-bool save(OutputStream& out) noexcept {
+void captureSnapshot(SaveData& saveData) noexcept {
     // Build required LUTs
     buildMobjLuts(8192);
     gatherThinkersOfType(T_VerticalDoor, gVlDoors, 128);
@@ -528,9 +671,10 @@ bool save(OutputStream& out) noexcept {
     gatherThinkersOfType(T_Glow, gGlows, 512);
     gatherDelayedActionsOfType(G_CompleteLevel, gDelayedExits, 0);      // Don't expect to ever save this in practice...
     gatherActiveButtons(gActiveButtons, 32);
+    gatherThinkerOrder(gThinkerOrder);
 
     // Populate the save header, globals and all the lists of objects
-    SaveData saveData = {};
+    saveData = {};
     SaveFileHdr& hdr = saveData.hdr;
 
     populateSaveHeader(hdr);
@@ -550,11 +694,31 @@ bool save(OutputStream& out) noexcept {
     serializeObjects(gGlows, saveData.glows);
     serializeObjects(gDelayedExits, saveData.delayedExits);
     serializeObjects(gActiveButtons, saveData.buttons);
+    ScriptingEngine::updateScheduledActionDelays();
     serializeObjects(ScriptingEngine::gScheduledActions.data(), saveData.scheduledActions, hdr.numScheduledActions);
+    saveData.thinkerOrder = std::make_unique<SavedThinkerRefT[]>(hdr.numThinkerRefs);
+    std::copy(gThinkerOrder.begin(), gThinkerOrder.end(), saveData.thinkerOrder.get());
 
-    // Cleanup and finish up by writing it all out to a file
+    // Cleanup the temporary LUTs
     clearTempLuts();
-    return saveData.writeTo(out);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Attempts to save the game to the specified save file slot.
+// The game is serialized to memory here and the file is then written in the background, see 'SaveFileWriter'.
+// Returns 'false' if serialization fails; failures to write the file are reported by 'SaveFileWriter::waitForWrites' instead.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool save(const SaveFileSlot slot) noexcept {
+    SaveData saveData;
+    captureSnapshot(saveData);
+
+    ByteVecOutputStream out;
+
+    if (!saveData.writeTo(out, Config::gbCompressSaveFiles))
+        return false;
+
+    SaveFileWriter::writeFile(getSaveFilePath(slot), std::move(out.getBytes()));
+    return true;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -567,11 +731,11 @@ ReadSaveResult read(InputStream& in) noexcept {
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Loads the current save file that has been read into memory, after the map file used by the save has been loaded
+// Restores the game state from the given in-memory snapshot or read save file, in-place on the current map and without reloading it.
+// The map that the snapshot was captured on must be the currently loaded map.
 //------------------------------------------------------------------------------------------------------------------------------------------
-LoadSaveResult load() noexcept {
+LoadSaveResult restoreSnapshot(const SaveData& saveData) noexcept {
     // Do some very basic validations first
-    const SaveData& saveData = gSaveDataIn;
     const SaveFileHdr& hdr = saveData.hdr;
 
     if (!hdr.validateMapHash())
@@ -587,7 +751,7 @@ LoadSaveResult load() noexcept {
     ScriptingEngine::gScheduledActions.clear();
 
     // Allocate objects that the save file calls for
-    allocMobjsToLoad();
+    allocMobjsToLoad(hdr.numMobjs);
     allocThinkersToLoad(gVlDoors, hdr.numVlDoors);
     allocThinkersToLoad(gVlCustomDoors, hdr.numVlCustomDoors);
     allocThinkersToLoad(gFloorMovers, hdr.numFloorMovers);
@@ -598,11 +762,14 @@ LoadSaveResult load() noexcept {
     allocThinkersToLoad(gStrobes, hdr.numStrobes);
     allocThinkersToLoad(gGlows, hdr.numGlows);
     allocThinkersToLoad(gDelayedExits, hdr.numDelayedExits);
-    allocButtonsToLoad();
+    const bool bValidThinkerOrder = addThinkersToLoadInSavedOrder(saveData);
+    allocButtonsToLoad(saveData);
     ScriptingEngine::gScheduledActions.resize(hdr.numScheduledActions);
+    ScriptingEngine::onScheduledActionsLoaded();    // Keep scheduling state consistent in case loading fails
 
     // Validate everything that needs to be validated
     const bool bAllValid = (
+        bValidThinkerOrder &&
         saveData.globals.validate() &&
         validateObjects(saveData.sectors, hdr.numSectors) &&
         validateObjects(saveData.sides, hdr.numSides) &&
@@ -646,6 +813,7 @@ LoadSaveResult load() noexcept {
     deserializeObjects(saveData.delayedExits, gDelayedExits);
     deserializeObjects(saveData.buttons, pButtons, hdr.numButtons);
     deserializeObjects(saveData.scheduledActions, ScriptingEngine::gScheduledActions.data(), hdr.numScheduledActions);
+    ScriptingEngine::onScheduledActionsLoaded();
 
     // Post load actions: update skill based game settings, adding map objects into the blockmap and sector lists, and associating thinkers with their sectors
     G_UpdateMobjInfoForSkill(gGameSkill);
@@ -655,18 +823,27 @@ LoadSaveResult load() noexcept {
     associateThinkersWithSectors(gFloorMovers);
     associateThinkersWithSectors(gCeilings);
     associateThinkersWithSectors(gPlats);
-    addActiveCeilingsAndPlats();
+    addActiveCeilingsAndPlats(hdr);
 
-    // Post load actions: play or stop CD music if required, kill interpolations and update sector draw params
+    // Post load actions: play or stop CD music if required, kill interpolations, update sector draw params, sound propagation and flow fields
     playOrStopCdTrackIfNeeded(saveData.globals.curCDTrack);
     R_SnapPlayerInterpolation();
     updateSectorDrawParams();
+    P_InitSoundPropagation();
+    P_InitFlowFields();
 
     // Finish up and cleanup
     clearTempLuts();
     return LoadSaveResult::OK;
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Loads the current save file that has been read into memory, after the map file used by the save has been loaded
+//------------------------------------------------------------------------------------------------------------------------------------------
+LoadSaveResult load() noexcept {
+    return restoreSnapshot(gSaveDataIn);
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Returns the base name of the save file used for the specified save slot.
 // The returned name does not have any game specific save file prefixes added.
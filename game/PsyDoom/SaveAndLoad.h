@@ -7,8 +7,8 @@
 #include <vector>
 
 class InputStream;
-class OutputStream;
 struct mobj_t;
+struct SaveData;
 
 // Enum representing the result of reading a save file
 enum class ReadSaveResult : int32_t {
@@ -42,7 +42,9 @@ extern std::unordered_map<mobj_t*, int32_t>     gMobjToIdx;
 extern std::vector<mobj_t*>                     gMobjList;
 extern SaveFileSlot                             gCurSaveSlot;
 
-bool save(OutputStream& out) noexcept;
+void captureSnapshot(SaveData& saveData) noexcept;
+LoadSaveResult restoreSnapshot(const SaveData& saveData) noexcept;
+bool save(const SaveFileSlot slot) noexcept;
 ReadSaveResult read(InputStream& in) noexcept;
 LoadSaveResult load() noexcept;
 const char* getSaveFileBaseName(const SaveFileSlot slot) noexcept;
@@ -37,9 +37,12 @@
 #include "Doom/Renderer/r_main.h"
 #include "Doom/UI/pw_main.h"
 #include "Doom/UI/st_main.h"
+#include "ByteInputStream.h"
+#include "ByteVecOutputStream.h"
 #include "Endian.h"
 #include "Game.h"
 #include "InputStream.h"
+#include "LzCompress.h"
 #include "MapHash.h"
 #include "OutputStream.h"
 #include "SaveAndLoad.h"
@@ -47,6 +50,7 @@
 #include "Wess/psxcd.h"
 
 #include <algorithm>
+#include <vector>
 
 // Make sure the global password character buffer is the expected size
 static_assert(PW_SEQ_LEN == C_ARRAY_SIZE(SavedGlobals::passwordCharBuffer), "Password char buffer has unexpected size!");
@@ -314,12 +318,13 @@ void SavedSectorT::deserializeTo(sector_t& sector) const noexcept {
     sector.colorid = colorid;
     sector.lightlevel = lightlevel;
     sector.special = special;
-    sector.tag = tag;
+    P_SetSectorTag(sector, tag);        // Note: keeps the index of sectors by tag up to date
     sector.soundtraversed = 0;
     sector.soundtarget = getMobjAtIdx(soundtargetIdx);
     sector.flags = flags;
     sector.floorDrawH = {};                         // Not serialized, default init
     sector.ceilingDrawH = {};                       // Not serialized, default init
+    sector.drawHVersion++;                          // Not serialized, bumped to discard any render data cached before the load
     sector.validcount = 0;                          // Not serialized, resets on load
     sector.ceilColorid = ceilColorid;
     sector.lowerColorZ = {};                        // Not serialized, default init
@@ -426,6 +431,7 @@ void SavedMobjT::byteSwap() noexcept {
     byteSwapValue(spawntype);
     byteSwapValue(spawnangle);
     byteSwapValue(tracerIdx);
+    byteSwapValue(lodcount);
 }
 
 bool SavedMobjT::validate() const noexcept {
@@ -437,7 +443,8 @@ bool SavedMobjT::validate() const noexcept {
         isValidStateIdx(stateIdx) &&
         isValidMoveDir(movedir) &&
         isValidMobjIdx(targetIdx) &&
-        isValidMobjIdx(tracerIdx)
+        isValidMobjIdx(tracerIdx) &&
+        (lodcount >= 0)
     );
 
     if (!bValidFields)
@@ -480,6 +487,7 @@ void SavedMobjT::serializeFrom(const mobj_t& mobj) noexcept {
     spawntype = mobj.spawntype;
     spawnangle = mobj.spawnangle;
     tracerIdx = getMobjIndex(mobj.tracer);
+    lodcount = mobj.lodcount;
 }
 
 void SavedMobjT::deserializeTo(mobj_t& mobj) const noexcept {
@@ -519,6 +527,7 @@ void SavedMobjT::deserializeTo(mobj_t& mobj) const noexcept {
     mobj.spawntype = spawntype;
     mobj.spawnangle = spawnangle;
     mobj.tracer = getMobjAtIdx(tracerIdx);
+    mobj.lodcount = lodcount;
 
     // Don't do interpolations for the first frame!
     R_SnapMobjInterpolation(mobj);
@@ -1201,6 +1210,14 @@ void SavedScheduledAction::deserializeTo(ScriptingEngine::ScheduledAction& actio
     action.bPendingExecute = bPendingExecute;
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// SavedThinkerRefT
+//------------------------------------------------------------------------------------------------------------------------------------------
+void SavedThinkerRefT::byteSwap() noexcept {
+    byteSwapEnumValue(type);
+    byteSwapValue(idx);
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // SavedSTBarT
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -1446,6 +1463,8 @@ void SaveFileHdr::byteSwap() noexcept {
     byteSwapValue(numDelayedExits);
     byteSwapValue(numButtons);
     byteSwapValue(numScheduledActions);
+    byteSwapValue(numThinkerRefs);
+    byteSwapValue(reserved);
 }
 
 bool SaveFileHdr::validateFileId() const noexcept {
@@ -1453,7 +1472,10 @@ bool SaveFileHdr::validateFileId() const noexcept {
 }
 
 bool SaveFileHdr::validateVersion() const noexcept {
-    return (version == SAVE_FILE_VERSION);
+    return (
+        ((version & SAVE_FILE_VERSION_MASK) == SAVE_FILE_VERSION) &&
+        ((version & ~(SAVE_FILE_VERSION_MASK | SAVE_FILE_KNOWN_FLAGS)) == 0)
+    );
 }
 
 bool SaveFileHdr::validateMapNum() const noexcept {
@@ -1481,29 +1503,45 @@ bool SaveFileHdr::validate() const noexcept {
     );
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// SaveCompressedDataHdr
+//------------------------------------------------------------------------------------------------------------------------------------------
+void SaveCompressedDataHdr::byteSwap() noexcept {
+    byteSwapValue(dataSize);
+    byteSwapValue(compressedSize);
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // SaveData
 //------------------------------------------------------------------------------------------------------------------------------------------
-bool SaveData::writeTo(OutputStream& out) const noexcept {
+bool SaveData::writeTo(OutputStream& out, const bool bCompress) const noexcept {
     try {
-        writeObjectLE(out, hdr);
-        writeObjectLE(out, globals);
-        writeArrayLE(out, sectors.get(), hdr.numSectors);
-        writeArrayLE(out, lines.get(), hdr.numLines);
-        writeArrayLE(out, sides.get(), hdr.numSides);
-        writeArrayLE(out, mobjs.get(), hdr.numMobjs);
-        writeArrayLE(out, vlDoors.get(), hdr.numVlDoors);
-        writeArrayLE(out, vlCustomDoors.get(), hdr.numVlCustomDoors);
-        writeArrayLE(out, floorMovers.get(), hdr.numFloorMovers);
-        writeArrayLE(out, ceilings.get(), hdr.numCeilings);
-        writeArrayLE(out, plats.get(), hdr.numPlats);
-        writeArrayLE(out, fireFlickers.get(), hdr.numFireFlickers);
-        writeArrayLE(out, lightFlashes.get(), hdr.numLightFlashes);
-        writeArrayLE(out, strobes.get(), hdr.numStrobes);
-        writeArrayLE(out, glows.get(), hdr.numGlows);
-        writeArrayLE(out, delayedExits.get(), hdr.numDelayedExits);
-        writeArrayLE(out, buttons.get(), hdr.numButtons);
-        writeArrayLE(out, scheduledActions.get(), hdr.numScheduledActions);
+        // Note: the compression flag in the written header always reflects whether the data is compressed
+        SaveFileHdr outHdr = hdr;
+        outHdr.version &= ~SAVE_FILE_FLAG_LZ;
+
+        if (!bCompress) {
+            writeObjectLE(out, outHdr);
+            writeDataTo(out);
+            return true;
+        }
+
+        // Serialize everything following the header to memory first and then compress it
+        ByteVecOutputStream dataOut;
+        writeDataTo(dataOut);
+
+        const std::vector<std::byte>& data = dataOut.getBytes();
+        std::vector<std::byte> compressedData;
+        LzCompress::compress(data.data(), data.size(), compressedData);
+
+        SaveCompressedDataHdr compressedHdr = {};
+        compressedHdr.dataSize = (uint32_t) data.size();
+        compressedHdr.compressedSize = (uint32_t) compressedData.size();
+        outHdr.version |= SAVE_FILE_FLAG_LZ;
+
+        writeObjectLE(out, outHdr);
+        writeObjectLE(out, compressedHdr);
+        out.writeBytes(compressedData.data(), compressedData.size());
         return true;
     }
     catch (...) {
@@ -1525,27 +1563,75 @@ ReadSaveResult SaveData::readFrom(InputStream& in) noexcept {
         if (!hdr.validateMapNum())
             return ReadSaveResult::BAD_MAP_NUM;
 
-        // Read the globals and everything else
-        readObjectLE(in, globals);
-        readArrayLE(in, sectors, hdr.numSectors);
-        readArrayLE(in, lines, hdr.numLines);
-        readArrayLE(in, sides, hdr.numSides);
-        readArrayLE(in, mobjs, hdr.numMobjs);
-        readArrayLE(in, vlDoors, hdr.numVlDoors);
-        readArrayLE(in, vlCustomDoors, hdr.numVlCustomDoors);
-        readArrayLE(in, floorMovers, hdr.numFloorMovers);
-        readArrayLE(in, ceilings, hdr.numCeilings);
-        readArrayLE(in, plats, hdr.numPlats);
-        readArrayLE(in, fireFlickers, hdr.numFireFlickers);
-        readArrayLE(in, lightFlashes, hdr.numLightFlashes);
-        readArrayLE(in, strobes, hdr.numStrobes);
-        readArrayLE(in, glows, hdr.numGlows);
-        readArrayLE(in, delayedExits, hdr.numDelayedExits);
-        readArrayLE(in, buttons, hdr.numButtons);
-        readArrayLE(in, scheduledActions, hdr.numScheduledActions);
+        // Read the globals and everything else, decompressing first if required
+        if ((hdr.version & SAVE_FILE_FLAG_LZ) == 0) {
+            readDataFrom(in);
+            return ReadSaveResult::OK;
+        }
+
+        SaveCompressedDataHdr compressedHdr = {};
+        readObjectLE(in, compressedHdr);
+
+        std::vector<std::byte> compressedData(compressedHdr.compressedSize);
+        std::vector<std::byte> data(compressedHdr.dataSize);
+        in.readBytes(compressedData.data(), compressedData.size());
+
+        if (!LzCompress::decompress(compressedData.data(), compressedData.size(), data.data(), data.size()))
+            return ReadSaveResult::IO_ERROR;
+
+        ByteInputStream dataIn(data.data(), data.size());
+        readDataFrom(dataIn);
         return ReadSaveResult::OK;
     }
     catch (...) {
         return ReadSaveResult::IO_ERROR;
     }
 }
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Writes everything following the header to the given stream
+//------------------------------------------------------------------------------------------------------------------------------------------
+void SaveData::writeDataTo(OutputStream& out) const THROWS {
+    writeObjectLE(out, globals);
+    writeArrayLE(out, sectors.get(), hdr.numSectors);
+    writeArrayLE(out, lines.get(), hdr.numLines);
+    writeArrayLE(out, sides.get(), hdr.numSides);
+    writeArrayLE(out, mobjs.get(), hdr.numMobjs);
+    writeArrayLE(out, vlDoors.get(), hdr.numVlDoors);
+    writeArrayLE(out, vlCustomDoors.get(), hdr.numVlCustomDoors);
+    writeArrayLE(out, floorMovers.get(), hdr.numFloorMovers);
+    writeArrayLE(out, ceilings.get(), hdr.numCeilings);
+    writeArrayLE(out, plats.get(), hdr.numPlats);
+    writeArrayLE(out, fireFlickers.get(), hdr.numFireFlickers);
+    writeArrayLE(out, lightFlashes.get(), hdr.numLightFlashes);
+    writeArrayLE(out, strobes.get(), hdr.numStrobes);
+    writeArrayLE(out, glows.get(), hdr.numGlows);
+    writeArrayLE(out, delayedExits.get(), hdr.numDelayedExits);
+    writeArrayLE(out, buttons.get(), hdr.numButtons);
+    writeArrayLE(out, scheduledActions.get(), hdr.numScheduledActions);
+    writeArrayLE(out, thinkerOrder.get(), hdr.numThinkerRefs);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Reads everything following the header from the given stream: expects the header to have been read already
+//------------------------------------------------------------------------------------------------------------------------------------------
+void SaveData::readDataFrom(InputStream& in) THROWS {
+    readObjectLE(in, globals);
+    readArrayLE(in, sectors, hdr.numSectors);
+    readArrayLE(in, lines, hdr.numLines);
+    readArrayLE(in, sides, hdr.numSides);
+    readArrayLE(in, mobjs, hdr.numMobjs);
+    readArrayLE(in, vlDoors, hdr.numVlDoors);
+    readArrayLE(in, vlCustomDoors, hdr.numVlCustomDoors);
+    readArrayLE(in, floorMovers, hdr.numFloorMovers);
+    readArrayLE(in, ceilings, hdr.numCeilings);
+    readArrayLE(in, plats, hdr.numPlats);
+    readArrayLE(in, fireFlickers, hdr.numFireFlickers);
+    readArrayLE(in, lightFlashes, hdr.numLightFlashes);
+    readArrayLE(in, strobes, hdr.numStrobes);
+    readArrayLE(in, glows, hdr.numGlows);
+    readArrayLE(in, delayedExits, hdr.numDelayedExits);
+    readArrayLE(in, buttons, hdr.numButtons);
+    readArrayLE(in, scheduledActions, hdr.numScheduledActions);
+    readArrayLE(in, thinkerOrder, hdr.numThinkerRefs);
+}
@@ -36,7 +36,13 @@ namespace ScriptingEngine {
 }
 
 // The current save file format version
-static constexpr uint32_t SAVE_FILE_VERSION = 3;
+static constexpr uint32_t SAVE_FILE_VERSION = 5;
+
+// Flags stored in the upper bits of the save file version, and the mask to get the actual format version.
+// Files without any flags are laid out exactly as before the flags were added, so older saves can still be read.
+static constexpr uint32_t SAVE_FILE_VERSION_MASK    = 0x0000FFFF;
+static constexpr uint32_t SAVE_FILE_FLAG_LZ         = 0x00010000;   // Everything following the header is compressed (see 'SaveCompressedDataHdr')
+static constexpr uint32_t SAVE_FILE_KNOWN_FLAGS     = SAVE_FILE_FLAG_LZ;
 
 // The expected file ids in little endian format (says 'PSYDSAVF' at the top of the file)
 static constexpr uint32_t SAVE_FILE_ID1 = 0x44595350;
@@ -131,6 +137,7 @@ struct SavedMobjT {
     uint16_t        spawntype;          // Used for respawns: item 'DoomEd' type/number
     int16_t         spawnangle;         // Used for respawns: item angle
     int32_t         tracerIdx;          // Used by homing missiles (map object index, or '-1' if none)
+    int32_t         lodcount;           // Monster AI LOD: number of chase/look updates deferred while the monster was dormant
 
     void byteSwap() noexcept;
     bool validate() const noexcept;
@@ -138,7 +145,7 @@ struct SavedMobjT {
     void deserializeTo(mobj_t& mobj) const noexcept;
 };
 
-static_assert(sizeof(SavedMobjT) == 112);
+static_assert(sizeof(SavedMobjT) == 116);
 
 // Saved state for a player weapon sprite (gun and muzzle flash)
 struct SavedPspdefT {
@@ -426,6 +433,33 @@ struct SavedScheduledAction {
 
 static_assert(sizeof(SavedScheduledAction) == 28);
 
+// Which list of saved thinkers a 'SavedThinkerRefT' refers to
+enum class SavedThinkerType : uint32_t {
+    VlDoor,
+    VlCustomDoor,
+    FloorMover,
+    Ceiling,
+    Plat,
+    FireFlicker,
+    LightFlash,
+    Strobe,
+    Glow,
+    DelayedExit,
+    NUM_TYPES
+};
+
+// Refers to a saved thinker by the list it is saved in and it's index in that list.
+// A list of these records the order of the thinkers list: thinkers are updated in list order and many use the random number generator,
+// so the order must be restored exactly for the game to continue the same way it would have without saving and loading.
+struct SavedThinkerRefT {
+    SavedThinkerType    type;       // Which list of saved thinkers the thinker is in
+    uint32_t            idx;        // Index of the thinker in that list
+
+    void byteSwap() noexcept;
+};
+
+static_assert(sizeof(SavedThinkerRefT) == 8);
+
 // Saved state for the status bar
 struct SavedSTBarT {
     uint32_t        face;                   // Index of the face sprite to currently use
@@ -510,6 +544,8 @@ struct SaveFileHdr {
     uint32_t    numDelayedExits;        // Number of 'SavedDelayedExitT' in the save file
     uint32_t    numButtons;             // Number of 'SavedButtonT' in the save file
     uint32_t    numScheduledActions;    // Number of 'SavedScheduledAction' in the save file
+    uint32_t    numThinkerRefs;         // Number of 'SavedThinkerRefT' in the save file (the order of the thinkers list)
+    uint32_t    reserved;               // Unused: keeps the header size a multiple of 8 bytes so it has no implicit padding
 
     void byteSwap() noexcept;
     bool validateFileId() const noexcept;
@@ -519,7 +555,17 @@ struct SaveFileHdr {
     bool validate() const noexcept;
 };
 
-static_assert(sizeof(SaveFileHdr) == 136);
+static_assert(sizeof(SaveFileHdr) == 144);
+
+// Follows the save file header when the 'SAVE_FILE_FLAG_LZ' flag is set, and is followed by the compressed data ('LzCompress' format)
+struct SaveCompressedDataHdr {
+    uint32_t    dataSize;               // Size of the data once decompressed
+    uint32_t    compressedSize;         // Size of the compressed data following this header
+
+    void byteSwap() noexcept;
+};
+
+static_assert(sizeof(SaveCompressedDataHdr) == 8);
 
 // Save data for the game in it's entirety, in order of how it appears in the file.
 // Just encapsulates state for a single player game, does NOT support multiplayer.
@@ -549,7 +595,12 @@ struct SaveData {
     std::unique_ptr<SavedDelayedExitT[]>        delayedExits;
     std::unique_ptr<SavedButtonT[]>             buttons;
     std::unique_ptr<SavedScheduledAction[]>     scheduledActions;
+    std::unique_ptr<SavedThinkerRefT[]>         thinkerOrder;
 
-    bool writeTo(OutputStream& out) const noexcept;
+    bool writeTo(OutputStream& out, const bool bCompress = false) const noexcept;
     [[nodiscard]] ReadSaveResult readFrom(InputStream& in) noexcept;
+
+private:
+    void writeDataTo(OutputStream& out) const THROWS;
+    void readDataFrom(InputStream& in) THROWS;
 };
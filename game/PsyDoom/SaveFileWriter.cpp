@@ -0,0 +1,148 @@
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Writes save files to disk on a background thread, so that saving never causes a hitch on slow storage (SD cards etc.).
+// The save is serialized to memory on the main thread and the bytes are then handed over here to be written.
+//
+// Each file is written to a temporary file first which is then renamed over the real file, so that an interrupted write never leaves behind
+// a partially written or corrupt save; the previous save is kept intact instead. Writes are done in the order they are queued.
+//------------------------------------------------------------------------------------------------------------------------------------------
+#include "SaveFileWriter.h"
+
+#include "FileUtils.h"
+
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#if _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <Windows.h>
+#endif
+
+BEGIN_NAMESPACE(SaveFileWriter)
+
+// A file waiting to be written
+struct PendingWrite {
+    std::string             filePath;
+    std::vector<std::byte>  fileData;
+};
+
+static std::mutex                   gMutex;                 // Guards all of the fields below
+static std::condition_variable      gWriterCV;              // Signalled when there is a file to write or when the writer thread should quit
+static std::condition_variable      gWaiterCV;              // Signalled when the writer thread finishes writing a file
+static std::deque<PendingWrite>     gPendingWrites;         // Files waiting to be written, in order
+static bool                         gbWriterBusy;           // True while the writer thread is writing a file (outside of the lock)
+static bool                         gbWriteFailed;          // Set if any write has failed since the last call to 'waitForWrites'
+static bool                         gbWriterQuit;           // Tells the writer thread to finish writing all files and exit
+static std::thread                  gWriterThread;          // Writes the files: started on demand
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Writes the given file via a temporary file and returns 'true' if successful
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool writeFileNow(const PendingWrite& write) noexcept {
+    const std::string tmpFilePath = write.filePath + ".tmp";
+
+    if (!FileUtils::writeDataToFile(tmpFilePath.c_str(), write.fileData.data(), write.fileData.size()))
+        return false;
+
+    // Note: on Windows 'std::rename' will not replace an existing file, so use 'MoveFileEx' to replace it in one step instead.
+    // Removing the existing file first would leave no save at all if the rename were to fail or be interrupted.
+    #if _WIN32
+        const DWORD moveFlags = MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH;
+        const bool bRenamed = (MoveFileExA(tmpFilePath.c_str(), write.filePath.c_str(), moveFlags) != FALSE);
+    #else
+        const bool bRenamed = (std::rename(tmpFilePath.c_str(), write.filePath.c_str()) == 0);
+    #endif
+
+    if (!bRenamed) {
+        std::remove(tmpFilePath.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Writer thread: writes queued files until told to quit, once all files are written
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void writerThreadMain() noexcept {
+    std::unique_lock<std::mutex> lock(gMutex);
+
+    while (true) {
+        gWriterCV.wait(lock, []() noexcept { return (!gPendingWrites.empty()) || gbWriterQuit; });
+
+        if (gPendingWrites.empty())
+            break;
+
+        // Write the next file outside of the lock
+        PendingWrite write = std::move(gPendingWrites.front());
+        gPendingWrites.pop_front();
+        gbWriterBusy = true;
+        lock.unlock();
+
+        const bool bSuccess = writeFileNow(write);
+
+        if (!bSuccess) {
+            std::printf("SaveFileWriter: failed to write save file '%s'!\n", write.filePath.c_str());
+        }
+
+        lock.lock();
+        gbWriterBusy = false;
+        gbWriteFailed |= (!bSuccess);
+        gWaiterCV.notify_all();
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Queues the given file data to be written to the specified path in the background, starting the writer thread if required
+//------------------------------------------------------------------------------------------------------------------------------------------
+void writeFile(const std::string& filePath, std::vector<std::byte>&& fileData) noexcept {
+    {
+        std::lock_guard<std::mutex> lock(gMutex);
+        gPendingWrites.push_back({ filePath, std::move(fileData) });
+
+        if (!gWriterThread.joinable()) {
+            gbWriterQuit = false;
+            gWriterThread = std::thread(writerThreadMain);
+        }
+    }
+
+    gWriterCV.notify_one();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Waits for all queued files to finish writing.
+// This must be done before reading any save file, in case it is still being written.
+// Returns 'false' if any write has failed since the last time this was called.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool waitForWrites() noexcept {
+    std::unique_lock<std::mutex> lock(gMutex);
+    gWaiterCV.wait(lock, []() noexcept { return gPendingWrites.empty() && (!gbWriterBusy); });
+
+    const bool bSuccess = (!gbWriteFailed);
+    gbWriteFailed = false;
+    return bSuccess;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Finishes writing all queued files and stops the writer thread
+//------------------------------------------------------------------------------------------------------------------------------------------
+void shutdown() noexcept {
+    {
+        std::lock_guard<std::mutex> lock(gMutex);
+
+        if (!gWriterThread.joinable())
+            return;
+
+        gbWriterQuit = true;
+    }
+
+    gWriterCV.notify_one();
+    gWriterThread.join();
+    gbWriterQuit = false;
+    gbWriteFailed = false;
+}
+
+END_NAMESPACE(SaveFileWriter)
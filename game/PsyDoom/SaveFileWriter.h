@@ -0,0 +1,15 @@
+#pragma once
+
+#include "Macros.h"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+BEGIN_NAMESPACE(SaveFileWriter)
+
+void writeFile(const std::string& filePath, std::vector<std::byte>&& fileData) noexcept;
+bool waitForWrites() noexcept;
+void shutdown() noexcept;
+
+END_NAMESPACE(SaveFileWriter)
@@ -11,6 +11,7 @@
 #include "Doom/Game/p_ceiling.h"
 #include "Doom/Game/p_doors.h"
 #include "Doom/Game/p_floor.h"
+#include "Doom/Game/p_flowfield.h"
 #include "Doom/Game/p_inter.h"
 #include "Doom/Game/p_local.h"
 #include "Doom/Game/p_map.h"
@@ -35,6 +36,7 @@
 #include <cstdio>
 #include <optional>
 #include <sol/sol.hpp>
+#include <vector>
 
 BEGIN_NAMESPACE(ScriptBindings)
 
@@ -303,17 +305,8 @@ static sector_t* GetSector(const int32_t index) noexcept {
 }
 
 static sector_t* FindSectorWithTag(const int32_t tag) noexcept {
-    const int32_t numSectors = gNumSectors;
-    sector_t* const pSectors = gpSectors;
-
-    for (int32_t i = 0; i < numSectors; ++i) {
-        sector_t& sector = pSectors[i];
-
-        if (sector.tag == tag)
-            return &sector;
-    }
-
-    return nullptr;
+    const int32_t sectorIdx = P_FindSectorFromTag(tag, -1);
+    return (sectorIdx >= 0) ? gpSectors + sectorIdx : nullptr;
 }
 
 static void ForEachSector(const std::function<void (sector_t& sector)>& callback) noexcept {
@@ -332,18 +325,188 @@ static void ForEachSectorWithTag(const int32_t tag, const std::function<void (se
     if (!callback)
         return;
 
-    const int32_t numSectors = gNumSectors;
-    sector_t* const pSectors = gpSectors;
+    // Note: the next sector is looked up again after each callback in case the callback changes sector tags
+    for (int32_t sectorIdx = P_FindSectorFromTag(tag, -1); sectorIdx >= 0; sectorIdx = P_FindSectorFromTag(tag, sectorIdx)) {
+        callback(gpSectors[sectorIdx]);
+    }
+}
 
-    for (int32_t i = 0; i < numSectors; ++i) {
-        sector_t& sector = pSectors[i];
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Helpers for bulk sector operations: set the floor or ceiling height of a sector, or set its light level.
+// These behave the same way as the equivalent 'sector_t' property setters.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void setSectorFloorH(sector_t& sector, const fixed_t height) noexcept {
+    sector.floorheight = height;
+
+    if (!Config::gbInterpolateSectors) {
+        sector.floorheight.snap();
+    }
+
+    P_UpdateSectorSoundPropagation(sector);
+    P_UpdateSectorFlowFields(sector);
+}
 
-        if (sector.tag == tag) {
-            callback(sector);
+static void setSectorCeilingH(sector_t& sector, const fixed_t height) noexcept {
+    sector.ceilingheight = height;
+
+    if (!Config::gbInterpolateSectors) {
+        sector.ceilingheight.snap();
+    }
+
+    P_UpdateSectorSoundPropagation(sector);
+    P_UpdateSectorFlowFields(sector);
+}
+
+static void setSectorLightLevel(sector_t& sector, const int32_t lightLevel) noexcept {
+    sector.lightlevel = (uint8_t) std::clamp(lightLevel, 0, 255);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Helper: gets the sector at the specified 1-based position in a Lua array of sector indexes.
+// Returns 'nullptr' if the array entry is missing, not a number or not a valid sector index.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static sector_t* getSectorInIndexArray(const sol::table& sectorIndexes, const size_t arrayIdx) noexcept {
+    const std::optional<int32_t> sectorIdx = sectorIndexes.raw_get<std::optional<int32_t>>(arrayIdx);
+    return (sectorIdx.has_value()) ? GetSector(sectorIdx.value()) : nullptr;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Helper: applies a value from a Lua array to each sector in a Lua array of sector indexes.
+// The two arrays are matched up by position; entries which are missing or invalid in either array are skipped.
+//------------------------------------------------------------------------------------------------------------------------------------------
+template <class ValT, class SetFnT>
+static void setSectorValuesFromArray(const sol::table& sectorIndexes, const sol::table& values, const SetFnT& setValue) noexcept {
+    const size_t numEntries = std::min(sectorIndexes.size(), values.size());
+
+    for (size_t arrayIdx = 1; arrayIdx <= numEntries; ++arrayIdx) {
+        sector_t* const pSector = getSectorInIndexArray(sectorIndexes, arrayIdx);
+        const std::optional<ValT> value = values.raw_get<std::optional<ValT>>(arrayIdx);
+
+        if (pSector && value.has_value()) {
+            setValue(*pSector, value.value());
         }
     }
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Helper: reads a value from each sector in a Lua array of sector indexes and returns the results as a new Lua array.
+// Invalid sector indexes produce the specified default value, so that the output array always lines up with the input array.
+//------------------------------------------------------------------------------------------------------------------------------------------
+template <class GetFnT>
+static auto getSectorValuesAsArray(const sol::table& sectorIndexes, const GetFnT& getValue, const SectorGetterRetT<GetFnT> defaultValue) noexcept {
+    const size_t numEntries = sectorIndexes.size();
+    std::vector<SectorGetterRetT<GetFnT>> values;
+    values.reserve(numEntries);
+
+    for (size_t arrayIdx = 1; arrayIdx <= numEntries; ++arrayIdx) {
+        sector_t* const pSector = getSectorInIndexArray(sectorIndexes, arrayIdx);
+        values.push_back((pSector) ? getValue(*pSector) : defaultValue);
+    }
+
+    return sol::as_table(std::move(values));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Script API: bulk sector operations.
+// These allow many sectors to be queried or modified with a single call from Lua, avoiding the overhead of crossing between Lua and
+// C++ for each individual sector. Arrays of values are passed in and returned as plain Lua tables with 1-based indexes.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static auto GetSectorIndexesWithTag(const int32_t tag) noexcept {
+    std::vector<int32_t> sectorIndexes;
+
+    for (int32_t sectorIdx = P_FindSectorFromTag(tag, -1); sectorIdx >= 0; sectorIdx = P_FindSectorFromTag(tag, sectorIdx)) {
+        sectorIndexes.push_back(sectorIdx);
+    }
+
+    return sol::as_table(std::move(sectorIndexes));
+}
+
+static auto GetSectorIndexesWithSpecial(const int32_t special) noexcept {
+    std::vector<int32_t> sectorIndexes;
+    const int32_t numSectors = gNumSectors;
+    const sector_t* const pSectors = gpSectors;
+
+    for (int32_t sectorIdx = 0; sectorIdx < numSectors; ++sectorIdx) {
+        if (pSectors[sectorIdx].special == special) {
+            sectorIndexes.push_back(sectorIdx);
+        }
+    }
+
+    return sol::as_table(std::move(sectorIndexes));
+}
+
+static void SetFloorHeightForTag(const int32_t tag, const float height) noexcept {
+    const fixed_t heightFixed = FloatToFixed(height);
+
+    for (int32_t sectorIdx = P_FindSectorFromTag(tag, -1); sectorIdx >= 0; sectorIdx = P_FindSectorFromTag(tag, sectorIdx)) {
+        setSectorFloorH(gpSectors[sectorIdx], heightFixed);
+    }
+}
+
+static void SetCeilingHeightForTag(const int32_t tag, const float height) noexcept {
+    const fixed_t heightFixed = FloatToFixed(height);
+
+    for (int32_t sectorIdx = P_FindSectorFromTag(tag, -1); sectorIdx >= 0; sectorIdx = P_FindSectorFromTag(tag, sectorIdx)) {
+        setSectorCeilingH(gpSectors[sectorIdx], heightFixed);
+    }
+}
+
+static void SetLightLevelForTag(const int32_t tag, const int32_t lightLevel) noexcept {
+    for (int32_t sectorIdx = P_FindSectorFromTag(tag, -1); sectorIdx >= 0; sectorIdx = P_FindSectorFromTag(tag, sectorIdx)) {
+        setSectorLightLevel(gpSectors[sectorIdx], lightLevel);
+    }
+}
+
+static void OffsetFloorHeightForTag(const int32_t tag, const float amount) noexcept {
+    const fixed_t amountFixed = FloatToFixed(amount);
+
+    for (int32_t sectorIdx = P_FindSectorFromTag(tag, -1); sectorIdx >= 0; sectorIdx = P_FindSectorFromTag(tag, sectorIdx)) {
+        sector_t& sector = gpSectors[sectorIdx];
+        setSectorFloorH(sector, sector.floorheight + amountFixed);
+    }
+}
+
+static void OffsetCeilingHeightForTag(const int32_t tag, const float amount) noexcept {
+    const fixed_t amountFixed = FloatToFixed(amount);
+
+    for (int32_t sectorIdx = P_FindSectorFromTag(tag, -1); sectorIdx >= 0; sectorIdx = P_FindSectorFromTag(tag, sectorIdx)) {
+        sector_t& sector = gpSectors[sectorIdx];
+        setSectorCeilingH(sector, sector.ceilingheight + amountFixed);
+    }
+}
+
+static void SetSectorFloorHeights(const sol::table& sectorIndexes, const sol::table& heights) noexcept {
+    setSectorValuesFromArray<float>(
+        sectorIndexes,
+        heights,
+        [](sector_t& sector, const float height) noexcept { setSectorFloorH(sector, FloatToFixed(height)); }
+    );
+}
+
+static void SetSectorCeilingHeights(const sol::table& sectorIndexes, const sol::table& heights) noexcept {
+    setSectorValuesFromArray<float>(
+        sectorIndexes,
+        heights,
+        [](sector_t& sector, const float height) noexcept { setSectorCeilingH(sector, FloatToFixed(height)); }
+    );
+}
+
+static void SetSectorLightLevels(const sol::table& sectorIndexes, const sol::table& lightLevels) noexcept {
+    setSectorValuesFromArray<int32_t>(sectorIndexes, lightLevels, setSectorLightLevel);
+}
+
+static auto GetSectorFloorHeights(const sol::table& sectorIndexes) noexcept {
+    return getSectorValuesAsArray(sectorIndexes, getSectorFloorH, 0.0f);
+}
+
+static auto GetSectorCeilingHeights(const sol::table& sectorIndexes) noexcept {
+    return getSectorValuesAsArray(sectorIndexes, getSectorCeilingH, 0.0f);
+}
+
+static auto GetSectorLightLevels(const sol::table& sectorIndexes) noexcept {
+    return getSectorValuesAsArray(sectorIndexes, getSectorLightLevel, 0);
+}
+
 static line_t* GetLineInSector(sector_t& sector, const int32_t index) noexcept {
     return ((index >= 0) && (index < sector.linecount)) ? sector.lines[index] : nullptr;
 }
@@ -582,6 +745,86 @@ static void ForEachMobjInArea(
     }
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Script API: bulk thing operations.
+// As with the bulk sector operations, these filter things in C++ and exchange arrays of values with Lua in a single call.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void ForEachMobjWithType(const uint32_t type, const std::function<void (mobj_t& mo)>& callback) noexcept {
+    if (!callback)
+        return;
+
+    for (mobj_t* pMobj = gMobjHead.next; pMobj != &gMobjHead;) {
+        mobj_t* const pNextMobj = pMobj->next;
+
+        if (pMobj->type == (mobjtype_t) type) {
+            callback(*pMobj);
+        }
+
+        pMobj = pNextMobj;
+    }
+}
+
+static void ForEachMobjWithTag(const int32_t tag, const std::function<void (mobj_t& mo)>& callback) noexcept {
+    if (!callback)
+        return;
+
+    for (mobj_t* pMobj = gMobjHead.next; pMobj != &gMobjHead;) {
+        mobj_t* const pNextMobj = pMobj->next;
+
+        if (pMobj->tag == tag) {
+            callback(*pMobj);
+        }
+
+        pMobj = pNextMobj;
+    }
+}
+
+static auto GetMobjsWithType(const uint32_t type) noexcept {
+    std::vector<mobj_t*> mobjs;
+
+    for (mobj_t* pMobj = gMobjHead.next; pMobj != &gMobjHead; pMobj = pMobj->next) {
+        if (pMobj->type == (mobjtype_t) type) {
+            mobjs.push_back(pMobj);
+        }
+    }
+
+    return sol::as_table(std::move(mobjs));
+}
+
+static auto GetMobjsWithTag(const int32_t tag) noexcept {
+    std::vector<mobj_t*> mobjs;
+
+    for (mobj_t* pMobj = gMobjHead.next; pMobj != &gMobjHead; pMobj = pMobj->next) {
+        if (pMobj->tag == tag) {
+            mobjs.push_back(pMobj);
+        }
+    }
+
+    return sol::as_table(std::move(mobjs));
+}
+
+// Returns the positions of an array of things as a flat array of 'x, y, z' triples: entries which are not things produce '0, 0, 0'
+static auto GetMobjPositions(const sol::table& mobjs) noexcept {
+    const size_t numMobjs = mobjs.size();
+    std::vector<float> positions;
+    positions.reserve(numMobjs * 3);
+
+    for (size_t arrayIdx = 1; arrayIdx <= numMobjs; ++arrayIdx) {
+        const sol::object mobjObj = mobjs.raw_get<sol::object>(arrayIdx);
+        const mobj_t* const pMobj = (mobjObj.is<mobj_t*>()) ? mobjObj.as<mobj_t*>() : nullptr;
+
+        if (pMobj) {
+            positions.push_back(FixedToFloat(pMobj->x));
+            positions.push_back(FixedToFloat(pMobj->y));
+            positions.push_back(FixedToFloat(pMobj->z));
+        } else {
+            positions.insert(positions.end(), 3, 0.0f);
+        }
+    }
+
+    return sol::as_table(std::move(positions));
+}
+
 static int32_t FindMobjTypeForDoomEdNum(const int32_t doomEdNum) noexcept {
     const int32_t numMobjTypes = gNumMobjInfo;
     const mobjinfo_t* const pMobjInfo = gMobjInfo;
@@ -796,6 +1039,39 @@ void S_PlaySoundAtPosition(const float x, const float y, const uint32_t soundId)
         }\
     )
 
+// Register a sector floor or ceiling height property which is interpolated if sector interpolation is enabled.
+// Height changes can open or close gaps between sectors, so the sound propagation and monster flow field state for the sector is also updated.
+#define SOL_SECTOR_HEIGHT_PROPERTY(FieldName)\
+    sol::property(\
+        [](const sector_t& sector) noexcept { return sector.FieldName; },\
+        [](sector_t& sector, const fixed_t value) noexcept {\
+            sector.FieldName = value;\
+            \
+            if (!Config::gbInterpolateSectors) {\
+                sector.FieldName.snap();\
+            }\
+            \
+            P_UpdateSectorSoundPropagation(sector);\
+            P_UpdateSectorFlowFields(sector);\
+        }\
+    )
+
+// Register a sector floor or ceiling height property (exposed as a float), as per 'SOL_SECTOR_HEIGHT_PROPERTY'
+#define SOL_SECTOR_HEIGHT_PROPERTY_AS_FLOAT(FieldName)\
+    sol::property(\
+        [](const sector_t& sector) noexcept { return FixedToFloat(sector.FieldName); },\
+        [](sector_t& sector, const float value) noexcept {\
+            sector.FieldName = FloatToFixed(value);\
+            \
+            if (!Config::gbInterpolateSectors) {\
+                sector.FieldName.snap();\
+            }\
+            \
+            P_UpdateSectorSoundPropagation(sector);\
+            P_UpdateSectorFlowFields(sector);\
+        }\
+    )
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Type registration functions
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -803,16 +1079,19 @@ static void registerType_sector_t(sol::state& lua) noexcept {
     sol::usertype<sector_t> type = lua.new_usertype<sector_t>("sector_t", sol::no_constructor);
 
     type["index"] = sol::readonly_property([](const sector_t& s) noexcept { return &s - gpSectors; });
-    type["floorheight"] = SOL_LERPED_SECTOR_FIXED_PROPERTY_AS_FLOAT(sector_t, floorheight);
-    type["floorheight_fixed"] = SOL_LERPED_SECTOR_FIXED_PROPERTY(sector_t, floorheight);
-    type["ceilingheight"] = SOL_LERPED_SECTOR_FIXED_PROPERTY_AS_FLOAT(sector_t, ceilingheight);
-    type["ceilingheight_fixed"] = SOL_LERPED_SECTOR_FIXED_PROPERTY(sector_t, ceilingheight);
+    type["floorheight"] = SOL_SECTOR_HEIGHT_PROPERTY_AS_FLOAT(floorheight);
+    type["floorheight_fixed"] = SOL_SECTOR_HEIGHT_PROPERTY(floorheight);
+    type["ceilingheight"] = SOL_SECTOR_HEIGHT_PROPERTY_AS_FLOAT(ceilingheight);
+    type["ceilingheight_fixed"] = SOL_SECTOR_HEIGHT_PROPERTY(ceilingheight);
     type["floorpic"] = &sector_t::floorpic;
     type["ceilingpic"] = &sector_t::ceilingpic;
     type["colorid"] = SOL_BYTE_PROPERTY(sector_t, colorid);
     type["lightlevel"] = SOL_BYTE_PROPERTY(sector_t, lightlevel);
     type["special"] = &sector_t::special;
-    type["tag"] = &sector_t::tag;
+    type["tag"] = sol::property(
+        [](const sector_t& sector) noexcept { return sector.tag; },
+        [](sector_t& sector, const int32_t tag) noexcept { P_SetSectorTag(sector, tag); }     // Keeps the index of sectors by tag up to date
+    );
     type["flags"] = &sector_t::flags;
     type["ceil_colorid"] = SOL_BYTE_PROPERTY(sector_t, ceilColorid);
     type["floor_tex_offset_x"] = SOL_LERPED_SECTOR_FIXED_PROPERTY_AS_FLOAT(sector_t, floorTexOffsetX);
@@ -852,7 +1131,14 @@ static void registerType_line_t(sol::state& lua) noexcept {
     type["v2x"] = sol::readonly_property([](const line_t& line) noexcept { return FixedToFloat(line.vertex2->x); });
     type["v2y"] = sol::readonly_property([](const line_t& line) noexcept { return FixedToFloat(line.vertex2->y); });
     type["angle"] = sol::readonly_property([](const line_t& line) noexcept { return AngleToDegrees((angle_t) line.fineangle << ANGLETOFINESHIFT); });
-    type["flags"] = &line_t::flags;
+    type["flags"] = sol::property(
+        [](const line_t& line) noexcept { return line.flags; },
+        [](line_t& line, const uint32_t flags) noexcept {
+            line.flags = flags;
+            P_UpdateLineSoundPropagation(line);     // Sound block flags may have changed
+            P_UpdateLineFlowFields(line);           // Monster blocking flags may have changed
+        }
+    );
     type["special"] = &line_t::special;
     type["tag"] = &line_t::tag;
     type["frontside"] = sol::readonly_property([](const line_t& line) noexcept { return GetSide(line.sidenum[0]); });
@@ -1067,6 +1353,19 @@ static void registerLuaFunctions(sol::state& lua) noexcept {
     lua["ForEachSector"] = ForEachSector;
     lua["ForEachSectorWithTag"] = ForEachSectorWithTag;
     lua["SectorAtPosition"] = SectorAtPosition;
+    lua["GetSectorIndexesWithTag"] = GetSectorIndexesWithTag;
+    lua["GetSectorIndexesWithSpecial"] = GetSectorIndexesWithSpecial;
+    lua["SetFloorHeightForTag"] = SetFloorHeightForTag;
+    lua["SetCeilingHeightForTag"] = SetCeilingHeightForTag;
+    lua["SetLightLevelForTag"] = SetLightLevelForTag;
+    lua["OffsetFloorHeightForTag"] = OffsetFloorHeightForTag;
+    lua["OffsetCeilingHeightForTag"] = OffsetCeilingHeightForTag;
+    lua["SetSectorFloorHeights"] = SetSectorFloorHeights;
+    lua["SetSectorCeilingHeights"] = SetSectorCeilingHeights;
+    lua["SetSectorLightLevels"] = SetSectorLightLevels;
+    lua["GetSectorFloorHeights"] = GetSectorFloorHeights;
+    lua["GetSectorCeilingHeights"] = GetSectorCeilingHeights;
+    lua["GetSectorLightLevels"] = GetSectorLightLevels;
     
     lua["GetNumLines"] = GetNumLines;
     lua["GetLine"] = GetLine;
@@ -1089,6 +1388,11 @@ static void registerLuaFunctions(sol::state& lua) noexcept {
 
     lua["ForEachMobj"] = ForEachMobj;
     lua["ForEachMobjInArea"] = ForEachMobjInArea;
+    lua["ForEachMobjWithType"] = ForEachMobjWithType;
+    lua["ForEachMobjWithTag"] = ForEachMobjWithTag;
+    lua["GetMobjsWithType"] = GetMobjsWithType;
+    lua["GetMobjsWithTag"] = GetMobjsWithTag;
+    lua["GetMobjPositions"] = GetMobjPositions;
     lua["FindMobjTypeForDoomEdNum"] = FindMobjTypeForDoomEdNum;
     lua["P_SpawnMobj"] = Script_P_SpawnMobj;
     lua["P_SpawnMissile"] = Script_P_SpawnMissile;
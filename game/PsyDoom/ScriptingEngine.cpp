@@ -4,16 +4,23 @@
 //------------------------------------------------------------------------------------------------------------------------------------------
 #include "ScriptingEngine.h"
 
+#include "ContentHash.h"
 #include "Doom/Base/w_wad.h"
+#include "Doom/Game/g_game.h"
 #include "Doom/Game/p_mobj.h"
 #include "Doom/Game/p_setup.h"
 #include "Doom/Game/p_tick.h"
 #include "Doom/UI/st_main.h"
 #include "MapHash.h"
+#include "ProgArgs.h"
 #include "ScriptBindings.h"
 
+#include <algorithm>
+#include <chrono>
 #include <cstdio>
+#include <cstring>
 #include <memory>
+#include <string>
 #include <sol/sol.hpp>
 
 BEGIN_NAMESPACE(ScriptingEngine)
@@ -25,6 +32,31 @@ static std::unique_ptr<sol::state> gpLuaState;
 // Each action has an integer identifier associated with it that is referenced by line tags.
 static std::unordered_map<int32_t, sol::protected_function> gScriptActions;
 
+// A dense lookup table built after all actions are registered, mapping from action number to the Lua registry reference for the action's
+// function ('LUA_NOREF' if there is no such action). This avoids hashing on every action call. Action numbers that are negative or larger
+// than 'MAX_DENSE_ACTION_NUM' are left out of the table to avoid wasting memory and are looked up in 'gScriptActions' instead.
+static constexpr int32_t MAX_DENSE_ACTION_NUM = 65535;
+static std::vector<int> gScriptActionRefs;
+
+// A cache of compiled Lua bytecode for map scripts that have been loaded before, so that revisiting a map (or loading another map which
+// uses the same script) skips parsing. Entries are keyed by a hash of the script source and the full source is compared on lookup, so a
+// hash collision can never cause the wrong script to run. The cache is only held in memory: bytecode is never loaded from outside sources
+// since Lua does not verify bytecode, and malformed bytecode could crash the game.
+struct CachedMapScript {
+    std::string     source;
+    std::string     bytecode;
+};
+
+static constexpr size_t MAX_CACHED_MAP_SCRIPTS = 32;
+static std::unordered_map<uint64_t, CachedMapScript> gCachedMapScripts;
+
+// Budgeted garbage collection mode ('-luagcbudget'): automatic collection is stopped and 'doIdleGC' does incremental steps instead, within
+// a time budget each frame. If memory use runs away because the budget is too small then a full collection is forced as a fallback.
+static constexpr int32_t MIN_GC_FORCE_COLLECT_KB = 1024;
+static bool     gbUseBudgetedGC = false;
+static int32_t  gGCForceCollectKB = MIN_GC_FORCE_COLLECT_KB;    // Memory use (KiB) at which a full collection is forced
+static GCStats  gGCStats = {};
+
 // How many 'doAction' calls are currently active?
 // Scripts might invoke other scripts, so the 'doAction' calls can be nested.
 static int32_t gNumExecutingScripts = 0;
@@ -33,6 +65,30 @@ static int32_t gNumExecutingScripts = 0;
 // This is so we preserve the relative order of actions scheduled to occur on the same tic - they should happen in the same order they were scheduled in.
 std::vector<ScheduledAction> gScheduledActions;
 
+// Internal scheduling state for each entry in 'gScheduledActions'.
+// This allows actions to be run without visiting every scheduled action on every tic, which matters when maps have thousands of them.
+struct ActionSchedState {
+    int64_t     fireTic;        // Scheduler tic when the action next becomes pending (only meaningful if the action is active and not paused)
+    uint64_t    serial;         // Changed whenever the action is rescheduled, paused, stopped or reused: invalidates stale queue entries
+    int32_t     tagListIdx;     // Index of the action in its tag's list of active actions, or '-1' if not in any list
+};
+
+// An entry in the queue of actions ordered by when they become pending.
+// Entries are never removed from the middle of the queue, they are just made stale by changing the action's serial number.
+struct ActionQueueEntry {
+    int64_t     fireTic;
+    uint64_t    serial;
+    int32_t     actionIdx;
+};
+
+static int64_t                                          gSchedTic;              // How many times 'runScheduledActions' has been called
+static uint64_t                                         gNextSchedSerial;       // Next serial number to give out for 'ActionSchedState'
+static std::vector<ActionSchedState>                    gActionSchedStates;     // Scheduling state for each entry in 'gScheduledActions'
+static std::vector<ActionQueueEntry>                    gActionQueue;           // Min heap of actions ordered by fire tic, then by action index
+static std::vector<int32_t>                             gFreeActionIdxs;        // Min heap of free entries in 'gScheduledActions' (may contain stale entries)
+static std::unordered_map<int32_t, std::vector<int32_t>> gActiveActionsByTag;   // Which actions are active (not stopped/finished) for each tag
+static std::vector<int32_t>                             gPendingActionIdxs;     // Temporary list of actions pending execution this tic
+
 // Context for the current script action being executed.
 // Which linedef, sector and thing triggered the action, all of which are optional.
 // All, some or none of these might be specified depending on the context in which the script action is executed.
@@ -87,6 +143,57 @@ static std::unique_ptr<char[]> readCurrentMapScript() noexcept {
     return mapScript;
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Helper: 'lua_Writer' callback used to save compiled Lua bytecode to a string
+//------------------------------------------------------------------------------------------------------------------------------------------
+static int writeBytecode([[maybe_unused]] lua_State* const L, const void* const pData, const size_t size, void* const pUserData) noexcept {
+    std::string& bytecode = *static_cast<std::string*>(pUserData);
+    bytecode.append(static_cast<const char*>(pData), size);
+    return 0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Compiles the given map script (or fetches the cached bytecode for it) and leaves the resulting function on top of the Lua stack.
+// On failure returns 'false' and leaves an error message on top of the Lua stack instead.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool loadMapScript(lua_State* const L, const char* const script, const size_t scriptLen) noexcept {
+    constexpr const char* const CHUNK_NAME = "SCRIPTS";
+
+    // Is there cached bytecode for this script?
+    const uint64_t scriptHash = ContentHasher::hash(script, scriptLen).word1;
+
+    if (auto cacheIter = gCachedMapScripts.find(scriptHash); cacheIter != gCachedMapScripts.end()) {
+        const CachedMapScript& cached = cacheIter->second;
+
+        if ((cached.source.size() == scriptLen) && (std::memcmp(cached.source.data(), script, scriptLen) == 0)) {
+            if (luaL_loadbufferx(L, cached.bytecode.data(), cached.bytecode.size(), CHUNK_NAME, "b") == LUA_OK)
+                return true;
+
+            lua_pop(L, 1);  // Shouldn't ever happen, but if it does just compile the source instead
+        }
+
+        gCachedMapScripts.erase(cacheIter);
+    }
+
+    // Otherwise compile the script from source
+    if (luaL_loadbufferx(L, script, scriptLen, CHUNK_NAME, "t") != LUA_OK)
+        return false;
+
+    // Save the bytecode for next time, keeping debug info so that error messages still have line numbers
+    if (gCachedMapScripts.size() >= MAX_CACHED_MAP_SCRIPTS) {
+        gCachedMapScripts.clear();
+    }
+
+    CachedMapScript& cached = gCachedMapScripts[scriptHash];
+    cached.source.assign(script, scriptLen);
+
+    if (lua_dump(L, writeBytecode, &cached.bytecode, 0) != 0) {
+        gCachedMapScripts.erase(scriptHash);
+    }
+
+    return true;
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Helper: makes a lua table readonly as much as possible
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -183,6 +290,24 @@ static void setupActionExecuteLuaEnv() noexcept {
     sol::state& lua = *gpLuaState;
     lua["SetAction"] = nullptr;
 
+    // No more actions can be registered after this point, so build the dense action lookup table
+    int32_t maxDenseActionNum = -1;
+
+    for (const auto& [actionNum, func] : gScriptActions) {
+        if ((actionNum <= MAX_DENSE_ACTION_NUM) && func.valid()) {
+            maxDenseActionNum = std::max(maxDenseActionNum, actionNum);
+        }
+    }
+
+    gScriptActionRefs.clear();
+    gScriptActionRefs.resize((size_t)(maxDenseActionNum + 1), LUA_NOREF);
+
+    for (const auto& [actionNum, func] : gScriptActions) {
+        if ((actionNum >= 0) && (actionNum <= maxDenseActionNum) && func.valid()) {
+            gScriptActionRefs[actionNum] = func.registry_index();
+        }
+    }
+
     // Do garbage collection at this point to clean up, scripts should only be using locals variables after this
     lua.collect_gc();
 }
@@ -211,19 +336,175 @@ static void doMobjGC() noexcept {
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Allocates and zero initializes a 'ScheduledAction' structure.
-// Tries to find a free one in the list first, otherwise adds a new one to the end of the list.
+// Heap ordering helpers: 'std::push_heap' and friends build max heaps, so these compare using 'greater than' to get min heaps
 //------------------------------------------------------------------------------------------------------------------------------------------
-static ScheduledAction& allocScheduledAction() noexcept {
-    for (ScheduledAction& action : gScheduledActions) {
-        // If there are no more executions left then it is free
+static bool isQueueEntryLater(const ActionQueueEntry& entry1, const ActionQueueEntry& entry2) noexcept {
+    return (entry1.fireTic != entry2.fireTic) ? (entry1.fireTic > entry2.fireTic) : (entry1.actionIdx > entry2.actionIdx);
+}
+
+static bool isActionIdxGreater(const int32_t idx1, const int32_t idx2) noexcept {
+    return (idx1 > idx2);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Queues up the specified action to become pending after the given number of tics, starting from the next scheduler tic.
+// Removes the action from the queue instead if the delay is negative.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void queueScheduledAction(const int32_t actionIdx, const int32_t delayTics) noexcept {
+    ActionSchedState& schedState = gActionSchedStates[actionIdx];
+    schedState.serial = gNextSchedSerial++;
+
+    if (delayTics >= 0) {
+        schedState.fireTic = gSchedTic + 1 + delayTics;
+        gActionQueue.push_back({ schedState.fireTic, schedState.serial, actionIdx });
+        std::push_heap(gActionQueue.begin(), gActionQueue.end(), isQueueEntryLater);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Returns how many more scheduler tics the specified active and unpaused queued action must wait before becoming pending.
+// Note: this is the equivalent of the 'delayTics' field for queued actions.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static int32_t getQueuedActionDelayTics(const int32_t actionIdx) noexcept {
+    return (int32_t) std::max<int64_t>(gActionSchedStates[actionIdx].fireTic - (gSchedTic + 1), 0);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Adds or removes the specified action from its tag's list of active actions
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void addToActiveActionsForTag(const int32_t actionIdx) noexcept {
+    std::vector<int32_t>& tagActions = gActiveActionsByTag[gScheduledActions[actionIdx].tag];
+    gActionSchedStates[actionIdx].tagListIdx = (int32_t) tagActions.size();
+    tagActions.push_back(actionIdx);
+}
+
+static void removeFromActiveActionsForTag(const int32_t actionIdx) noexcept {
+    ActionSchedState& schedState = gActionSchedStates[actionIdx];
+
+    if (schedState.tagListIdx < 0)
+        return;
+
+    const auto tagIter = gActiveActionsByTag.find(gScheduledActions[actionIdx].tag);
+    ASSERT(tagIter != gActiveActionsByTag.end());
+    std::vector<int32_t>& tagActions = tagIter->second;
+
+    // Swap with the last action in the list and pop it off the end
+    const int32_t lastActionIdx = tagActions.back();
+    tagActions[schedState.tagListIdx] = lastActionIdx;
+    gActionSchedStates[lastActionIdx].tagListIdx = schedState.tagListIdx;
+    tagActions.pop_back();
+    schedState.tagListIdx = -1;
+
+    if (tagActions.empty()) {
+        gActiveActionsByTag.erase(tagIter);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Should be called when the specified action has just been stopped or finished executing (no executions left).
+// Removes the action from the queue and tag lists and makes its slot available for reuse.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void onScheduledActionFinished(const int32_t actionIdx) noexcept {
+    ASSERT(gScheduledActions[actionIdx].executionsLeft == 0);
+    queueScheduledAction(actionIdx, -1);
+    removeFromActiveActionsForTag(actionIdx);
+    gFreeActionIdxs.push_back(actionIdx);
+    std::push_heap(gFreeActionIdxs.begin(), gFreeActionIdxs.end(), isActionIdxGreater);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Stops the specified action, if it is active
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void stopScheduledAction(const int32_t actionIdx) noexcept {
+    ScheduledAction& action = gScheduledActions[actionIdx];
+    action.bPendingExecute = false;
+
+    if (action.executionsLeft != 0) {
+        action.executionsLeft = 0;
+        onScheduledActionFinished(actionIdx);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Pauses or unpauses the specified action.
+// Either way, an action pending execution for this tic will not execute until the next tic at least.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void setScheduledActionPaused(const int32_t actionIdx, const bool bPause) noexcept {
+    ScheduledAction& action = gScheduledActions[actionIdx];
+    const bool bWasPaused = action.bPaused;
+    const bool bWasPending = action.bPendingExecute;
+
+    action.bPaused = bPause;
+    action.bPendingExecute = false;
+
+    // Nothing more to do for stopped actions, or if not changing anything about when the action will execute
+    if ((action.executionsLeft == 0) || (bWasPaused == bPause && (!bWasPending)))
+        return;
+
+    // Paused actions keep their remaining delay in 'delayTics' and are not queued
+    const int32_t delayTics = (bWasPaused) ? action.delayTics : getQueuedActionDelayTics(actionIdx);
+
+    if (bPause) {
+        action.delayTics = delayTics;
+        queueScheduledAction(actionIdx, -1);
+    } else {
+        queueScheduledAction(actionIdx, delayTics);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Rebuilds all of the scheduling state for 'gScheduledActions' from scratch, using the 'delayTics' field of each active action
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void rebuildScheduledActionState() noexcept {
+    gActionSchedStates.clear();
+    gActionSchedStates.resize(gScheduledActions.size(), ActionSchedState{ 0, 0, -1 });
+    gActionQueue.clear();
+    gFreeActionIdxs.clear();
+    gActiveActionsByTag.clear();
+
+    for (int32_t actionIdx = 0; actionIdx < (int32_t) gScheduledActions.size(); ++actionIdx) {
+        ScheduledAction& action = gScheduledActions[actionIdx];
+        action.bPendingExecute = false;
+
         if (action.executionsLeft == 0) {
-            action = {};
-            return action;
+            gFreeActionIdxs.push_back(actionIdx);   // Note: already in ascending order, so is a valid min heap
+        } else {
+            addToActiveActionsForTag(actionIdx);
+            queueScheduledAction(actionIdx, (action.bPaused) ? -1 : std::max(action.delayTics, 0));
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Allocates and zero initializes a 'ScheduledAction' structure and returns its index.
+// Reuses the free entry in the list with the lowest index first (to preserve relative action order), otherwise adds a new one to the end.
+// The caller must call 'onScheduledActionAllocated' once it has finished setting up the action.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static int32_t allocScheduledAction() noexcept {
+    while (!gFreeActionIdxs.empty()) {
+        const int32_t actionIdx = gFreeActionIdxs.front();
+        std::pop_heap(gFreeActionIdxs.begin(), gFreeActionIdxs.end(), isActionIdxGreater);
+        gFreeActionIdxs.pop_back();
+
+        // Entries might be stale if the list was compacted or if they were pushed more than once, make sure the entry is really free
+        if ((actionIdx < (int32_t) gScheduledActions.size()) && (gScheduledActions[actionIdx].executionsLeft == 0)) {
+            gScheduledActions[actionIdx] = {};
+            return actionIdx;
         }
     }
 
-    return gScheduledActions.emplace_back();
+    gScheduledActions.emplace_back();
+    gActionSchedStates.push_back(ActionSchedState{ 0, 0, -1 });
+    return (int32_t) gScheduledActions.size() - 1;
+}
+
+static void onScheduledActionAllocated(const int32_t actionIdx) noexcept {
+    const ScheduledAction& action = gScheduledActions[actionIdx];
+
+    if (action.executionsLeft != 0) {
+        addToActiveActionsForTag(actionIdx);
+        queueScheduledAction(actionIdx, action.delayTics);
+    }
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -236,6 +517,7 @@ static void compactScheduledActionList() noexcept {
 
         if (last.executionsLeft == 0) {
             gScheduledActions.pop_back();
+            gActionSchedStates.pop_back();
         } else {
             break;
         }
@@ -262,7 +544,18 @@ void init() noexcept {
     setupActionRegisterLuaEnv();
 
     try {
-        gpLuaState->script(mapScript.get());
+        lua_State* const L = gpLuaState->lua_state();
+        const bool bScriptOk = (
+            loadMapScript(L, mapScript.get(), std::strlen(mapScript.get())) &&
+            (lua_pcall(L, 0, 0, 0) == LUA_OK)
+        );
+
+        if (!bScriptOk) {
+            const char* const errorMsg = lua_tostring(L, -1);
+            std::printf("PsyDoom: error executing the map script! Details follow:\n%s\n", (errorMsg) ? errorMsg : "(unknown error)");
+            showStatusBarError("Script error! See stdout.");
+            lua_pop(L, 1);
+        }
     }
     catch (const std::exception& e) {
         std::printf("PsyDoom: error executing the map script! Details follow:\n%s\n", e.what());
@@ -271,6 +564,18 @@ void init() noexcept {
 
     // Setup the environment for executing script actions
     setupActionExecuteLuaEnv();
+
+    // Switch to doing garbage collection in idle time if requested.
+    // Not done for network games since the exact timing of collections differs between peers, which could in theory affect the order of
+    // 'pairs' iteration over tables keyed by objects (their addresses) and cause a desync.
+    gGCStats = {};
+    gbUseBudgetedGC = ((ProgArgs::gLuaGCBudgetUsec > 0) && (gNetGame == gt_single));
+
+    if (gbUseBudgetedGC) {
+        lua_State* const L = gpLuaState->lua_state();
+        lua_gc(L, LUA_GCSTOP);
+        gGCForceCollectKB = std::max(lua_gc(L, LUA_GCCOUNT) * 4, MIN_GC_FORCE_COLLECT_KB);
+    }
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -280,39 +585,112 @@ void shutdown() noexcept {
     ASSERT_LOG(gNumExecutingScripts == 0, "Shutdown should only be done when no scripts are executing!");
 
     gScheduledActions.clear();
+    rebuildScheduledActionState();
+    gPendingActionIdxs.clear();
+    gSchedTic = 0;
+    gScriptActionRefs.clear();
     gScriptActions.clear();
     gpLuaState.reset();
+    gbUseBudgetedGC = false;
+    gGCStats = {};
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tells if the scripting engine is active for the current level, which is the case if the map has a script
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool isActive() noexcept {
+    return (gpLuaState != nullptr);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// If budgeted garbage collection is enabled ('-luagcbudget'), runs incremental garbage collection steps for up to the configured number of
+// microseconds. Should be called once per frame during idle time (after the frame has been presented), and never while scripts execute.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void doIdleGC() noexcept {
+    ASSERT(gNumExecutingScripts == 0);
+
+    if ((!gpLuaState) || (!gbUseBudgetedGC))
+        return;
+
+    lua_State* const L = gpLuaState->lua_state();
+    const auto startTime = std::chrono::steady_clock::now();
+    const auto endTime = startTime + std::chrono::microseconds(ProgArgs::gLuaGCBudgetUsec);
+
+    // If memory use has gotten out of hand then the budget is not keeping up: do a full collection
+    gGCStats.numStepsLastFrame = 0;
+
+    if (lua_gc(L, LUA_GCCOUNT) >= gGCForceCollectKB) {
+        lua_gc(L, LUA_GCCOLLECT);
+        gGCStats.numForcedCollects++;
+        gGCStats.numCyclesCompleted++;
+        gGCForceCollectKB = std::max(lua_gc(L, LUA_GCCOUNT) * 4, MIN_GC_FORCE_COLLECT_KB);
+    } else {
+        // Do single basic steps until the time budget is used up or a collection cycle finishes.
+        // Stop once a cycle finishes because otherwise if there is little garbage we'd just spin starting new cycles for no benefit.
+        do {
+            gGCStats.numStepsLastFrame++;
+
+            if (lua_gc(L, LUA_GCSTEP, 0) != 0) {
+                gGCStats.numCyclesCompleted++;
+                gGCForceCollectKB = std::max(lua_gc(L, LUA_GCCOUNT) * 4, MIN_GC_FORCE_COLLECT_KB);
+                break;
+            }
+        } while (std::chrono::steady_clock::now() < endTime);
+    }
+
+    gGCStats.usecLastFrame = (float) std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - startTime).count();
+    gGCStats.memUsedKB = lua_gc(L, LUA_GCCOUNT);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Returns garbage collection statistics for the current map's Lua state, for the profiler overlay.
+// The stats are only updated when budgeted garbage collection is enabled.
+//------------------------------------------------------------------------------------------------------------------------------------------
+GCStats getGCStats() noexcept {
+    return gGCStats;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Returns the Lua registry reference for the function of the specified action number, or 'LUA_NOREF' if there is no such action
+//------------------------------------------------------------------------------------------------------------------------------------------
+static int getActionFuncRef(const int32_t actionNum) noexcept {
+    if ((actionNum >= 0) && (actionNum < (int32_t) gScriptActionRefs.size()))
+        return gScriptActionRefs[actionNum];
+
+    const auto actionIter = gScriptActions.find(actionNum);
+    return ((actionIter != gScriptActions.end()) && actionIter->second.valid()) ? actionIter->second.registry_index() : LUA_NOREF;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Runs all actions that are scheduled for execution
 //------------------------------------------------------------------------------------------------------------------------------------------
 void runScheduledActions() noexcept {
-    // Flag which actions are pending execution for this frame.
+    ASSERT(gActionSchedStates.size() == gScheduledActions.size());
+    gSchedTic++;
+
+    // Flag which actions are pending execution for this frame: these are the queued actions that are due this tic.
+    // The queue is ordered by fire tic and then by action index, so the actions come out in the order they appear in the list.
     // If any actions schedule any other actions then they will be delayed by 1 frame at least.
-    const int32_t numActions = (int32_t) gScheduledActions.size();
+    gPendingActionIdxs.clear();
 
-    for (int32_t i = 0; i < numActions; ++i) {
-        // Skip the action if paused or if there are no more executions left (stopped)
-        ScheduledAction& action = gScheduledActions[i];
+    while ((!gActionQueue.empty()) && (gActionQueue.front().fireTic <= gSchedTic)) {
+        const ActionQueueEntry entry = gActionQueue.front();
+        std::pop_heap(gActionQueue.begin(), gActionQueue.end(), isQueueEntryLater);
+        gActionQueue.pop_back();
 
-        if (action.bPaused || (action.executionsLeft == 0))
+        // Ignore the entry if the action was rescheduled, paused, stopped or reused since it was queued
+        if (entry.serial != gActionSchedStates[entry.actionIdx].serial)
             continue;
 
-        // Reduce the time until the action executes or schedule it to execute if executing now
-        const int32_t delayTics = action.delayTics;
-
-        if (delayTics > 0) {
-            action.delayTics = delayTics - 1;
-        } else {
-            action.bPendingExecute = true;
-        }
+        gScheduledActions[entry.actionIdx].bPendingExecute = true;
+        gPendingActionIdxs.push_back(entry.actionIdx);
     }
 
-    // Execute all pending actions and ignore any new ones that have been added
-    for (int32_t i = 0; i < numActions; ++i) {
-        // Only execute the action if it's pending execution
-        ScheduledAction& action = gScheduledActions[i];
+    // Execute all pending actions and ignore any new ones that have been added.
+    // Note: the action list might be reallocated by scheduling new actions, so don't hold onto references to actions across calls.
+    for (const int32_t actionIdx : gPendingActionIdxs) {
+        // Only execute the action if it's still pending execution (it might have been stopped or paused by another action)
+        ScheduledAction& action = gScheduledActions[actionIdx];
 
         if (!action.bPendingExecute)
             continue;
@@ -326,6 +704,13 @@ void runScheduledActions() noexcept {
 
         action.delayTics = action.repeatDelay;
         action.bPendingExecute = false;
+
+        if (action.executionsLeft != 0) {
+            queueScheduledAction(actionIdx, action.repeatDelay);
+        } else {
+            onScheduledActionFinished(actionIdx);
+        }
+
         doAction(action.actionNum, nullptr, nullptr, nullptr, action.tag, action.userdata);
     }
 
@@ -357,17 +742,21 @@ bool doAction(
     // Assume the current action is allowed until scripts indicate otherwise
     gbCurActionAllowed = true;
 
-    // Try and execute the action
-    const auto actionIter = gScriptActions.find(actionNum);
+    // Try and execute the action.
+    // Note: actions take no arguments and any results are discarded, so a direct 'lua_pcall' is done instead of going through Sol2's
+    // protected function call and result handling. Script errors are still caught and reported in the same way as before.
+    const int actionFuncRef = getActionFuncRef(actionNum);
 
-    if (actionIter != gScriptActions.end()) {
+    if (actionFuncRef != LUA_NOREF) {
         try {
-            const sol::protected_function_result result = actionIter->second();
+            lua_State* const L = gpLuaState->lua_state();
+            lua_rawgeti(L, LUA_REGISTRYINDEX, actionFuncRef);
 
-            if (!result.valid()) {
-                const sol::error error = result;
+            if (lua_pcall(L, 0, 0, 0) != LUA_OK) {
+                const char* const errorMsg = lua_tostring(L, -1);
                 showStatusBarError("Script #%d error! See stdout.", actionNum);
-                std::printf("PsyDoom: error executing map script action #%d! Details follow:\n%s\n", actionNum, error.what());
+                std::printf("PsyDoom: error executing map script action #%d! Details follow:\n%s\n", actionNum, (errorMsg) ? errorMsg : "(unknown error)");
+                lua_pop(L, 1);
             }
         }
         catch (const std::exception& e) {
@@ -409,12 +798,14 @@ void scheduleAction(
     const int32_t tag,
     const int32_t userdata
 ) noexcept {
-    ScheduledAction& action = allocScheduledAction();
+    const int32_t actionIdx = allocScheduledAction();
+    ScheduledAction& action = gScheduledActions[actionIdx];
     action.actionNum = actionNum;
     action.delayTics = std::max(delayTics, 0);
     action.executionsLeft = 1;
     action.tag = tag;
     action.userdata = userdata;
+    onScheduledActionAllocated(actionIdx);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -429,13 +820,15 @@ void scheduleRepeatingAction(
     const int32_t tag,
     const int32_t userdata
 ) noexcept {
-    ScheduledAction& action = allocScheduledAction();
+    const int32_t actionIdx = allocScheduledAction();
+    ScheduledAction& action = gScheduledActions[actionIdx];
     action.actionNum = actionNum;
     action.delayTics = std::max(initialDelayTics, 0);
     action.executionsLeft = (numRepeats < 0) ? -1 : numRepeats + 1;    // Note: use '-1' always for infinite
     action.repeatDelay = std::max(repeatDelay, 0);
     action.tag = tag;
     action.userdata = userdata;
+    onScheduledActionAllocated(actionIdx);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -448,6 +841,8 @@ void stopAllScheduledActions() noexcept {
         action.executionsLeft = 0;
         action.bPendingExecute = false;
     }
+
+    rebuildScheduledActionState();
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -456,11 +851,18 @@ void stopAllScheduledActions() noexcept {
 void stopScheduledActionsWithTag(const int32_t tag) noexcept {
     // Note: this can be called while executing and iterating through the scheduled action list.
     // Therefore just flag the action as stopped rather than trying to cleanup or compact the list.
-    for (ScheduledAction& action : gScheduledActions) {
-        if (action.tag == tag) {
-            action.executionsLeft = 0;
-            action.bPendingExecute = false;
-        }
+    const auto tagIter = gActiveActionsByTag.find(tag);
+
+    if (tagIter == gActiveActionsByTag.end())
+        return;
+
+    // Take the whole list of actions for the tag, since all of them are being removed from it
+    const std::vector<int32_t> tagActions = std::move(tagIter->second);
+    gActiveActionsByTag.erase(tagIter);
+
+    for (const int32_t actionIdx : tagActions) {
+        gActionSchedStates[actionIdx].tagListIdx = -1;
+        stopScheduledAction(actionIdx);
     }
 }
 
@@ -468,9 +870,8 @@ void stopScheduledActionsWithTag(const int32_t tag) noexcept {
 // Pauses or unpaused all scheduled actions
 //------------------------------------------------------------------------------------------------------------------------------------------
 void pauseAllScheduledActions(const bool bPause) noexcept {
-    for (ScheduledAction& action : gScheduledActions) {
-        action.bPaused = bPause;
-        action.bPendingExecute = false;     // Action must wait another frame if it is unpaused
+    for (int32_t actionIdx = 0; actionIdx < (int32_t) gScheduledActions.size(); ++actionIdx) {
+        setScheduledActionPaused(actionIdx, bPause);    // Note: action must wait another frame if it is unpaused
     }
 }
 
@@ -478,11 +879,14 @@ void pauseAllScheduledActions(const bool bPause) noexcept {
 // Pauses or unpaused all scheduled actions with the specified tag
 //------------------------------------------------------------------------------------------------------------------------------------------
 void pauseScheduledActionsWithTag(const int32_t tag, const bool bPause) noexcept {
-    for (ScheduledAction& action : gScheduledActions) {
-        if (action.tag == tag) {
-            action.bPaused = bPause;
-            action.bPendingExecute = false;     // Action must wait another frame if it is unpaused
-        }
+    // Note: stopped/finished actions with the tag are not affected, but that doesn't matter since they are reset when reused
+    const auto tagIter = gActiveActionsByTag.find(tag);
+
+    if (tagIter == gActiveActionsByTag.end())
+        return;
+
+    for (const int32_t actionIdx : tagIter->second) {
+        setScheduledActionPaused(actionIdx, bPause);    // Note: action must wait another frame if it is unpaused
     }
 }
 
@@ -491,15 +895,31 @@ void pauseScheduledActionsWithTag(const int32_t tag, const bool bPause) noexcept
 // This count includes any actions that have been paused, but not actions that are stopped/finished.
 //------------------------------------------------------------------------------------------------------------------------------------------
 int32_t getNumScheduledActionsWithTag(const int32_t tag) noexcept {
-    int32_t actionCount = 0;
+    const auto tagIter = gActiveActionsByTag.find(tag);
+    return (tagIter != gActiveActionsByTag.end()) ? (int32_t) tagIter->second.size() : 0;
+}
 
-    for (ScheduledAction& action : gScheduledActions) {
-        if ((action.tag == tag) && (action.executionsLeft != 0)) {
-            actionCount++;
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Updates the 'delayTics' field of all active and unpaused scheduled actions, which is otherwise not kept up to date for such actions.
+// Must be called before saving 'gScheduledActions'.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void updateScheduledActionDelays() noexcept {
+    ASSERT(gActionSchedStates.size() == gScheduledActions.size());
+
+    for (int32_t actionIdx = 0; actionIdx < (int32_t) gScheduledActions.size(); ++actionIdx) {
+        ScheduledAction& action = gScheduledActions[actionIdx];
+
+        if ((action.executionsLeft != 0) && (!action.bPaused)) {
+            action.delayTics = getQueuedActionDelayTics(actionIdx);
         }
     }
+}
 
-    return actionCount;
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Must be called after 'gScheduledActions' has been replaced (loading a save), to rebuild the internal scheduling state for the actions
+//------------------------------------------------------------------------------------------------------------------------------------------
+void onScheduledActionsLoaded() noexcept {
+    rebuildScheduledActionState();
 }
 
 END_NAMESPACE(ScriptingEngine)
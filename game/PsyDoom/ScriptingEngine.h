@@ -15,7 +15,7 @@ BEGIN_NAMESPACE(ScriptingEngine)
 // Note that delayed actions have no triggering line, sector or thing associated with them.
 struct ScheduledAction {
     int32_t     actionNum;          // Which action function to execute with
-    int32_t     delayTics;          // Game tics left until the action executes
+    int32_t     delayTics;          // Game tics left until the action executes. Only kept up to date for paused actions: see 'updateScheduledActionDelays'.
     int32_t     executionsLeft;     // The number of action executions left; '0' if the action will not execute again, or '-1' if infinitely repeating.
     int32_t     repeatDelay;        // The delay in tics between repeats ('0' means execute every tic)
     int32_t     tag;                // User defined tag associated with the action
@@ -24,6 +24,15 @@ struct ScheduledAction {
     bool        bPendingExecute;    // If 'true' then the action is pending execution this frame
 };
 
+// Garbage collection statistics for the current map's Lua state, when using budgeted garbage collection ('-luagcbudget')
+struct GCStats {
+    int32_t     memUsedKB;              // Memory in use by Lua (KiB)
+    int32_t     numStepsLastFrame;      // Number of incremental collection steps done last frame
+    float       usecLastFrame;          // Time spent collecting garbage last frame (microseconds)
+    uint32_t    numCyclesCompleted;     // Number of full collection cycles completed for the current map
+    uint32_t    numForcedCollects;      // How many of those were forced full collections because the budget did not keep up
+};
+
 extern std::vector<ScheduledAction>     gScheduledActions;
 extern line_t*                          gpCurTriggeringLine;
 extern sector_t*                        gpCurTriggeringSector;
@@ -35,6 +44,9 @@ extern bool                             gbNeedMobjGC;
 
 void init() noexcept;
 void shutdown() noexcept;
+bool isActive() noexcept;
+void doIdleGC() noexcept;
+GCStats getGCStats() noexcept;
 void runScheduledActions() noexcept;
 
 bool doAction(
@@ -67,5 +79,7 @@ void stopScheduledActionsWithTag(const int32_t tag) noexcept;
 void pauseAllScheduledActions(const bool bPause) noexcept;
 void pauseScheduledActionsWithTag(const int32_t tag, const bool bPause) noexcept;
 int32_t getNumScheduledActionsWithTag(const int32_t tag) noexcept;
+void updateScheduledActionDelays() noexcept;
+void onScheduledActionsLoaded() noexcept;
 
 END_NAMESPACE(ScriptingEngine)
@@ -0,0 +1,350 @@
+//------------------------------------------------------------------------------------------------------------------------------------------
+// A module that handles the '-soak' benchmarking mode.
+//
+// In this mode every map defined by MapInfo is loaded in turn and played for a fixed amount of game time with no frame rate limiting,
+// vsync or audio output. The player is made invulnerable and slowly spins in place at the map start, so that each run follows the exact
+// same deterministic camera path and sees the full surroundings of the map start. For each map the load time, frame time percentiles,
+// memory high-water marks and texture cache activity are written as a row to a CSV file, allowing regressions to be spotted across the
+// entire game (rather than just a single demo) and results to be diffed between runs.
+//------------------------------------------------------------------------------------------------------------------------------------------
+#include "SoakTest.h"
+
+#include "Doom/Base/i_main.h"
+#include "Doom/Base/i_texcache.h"
+#include "Doom/Base/z_zone.h"
+#include "Doom/d_main.h"
+#include "Doom/doomdef.h"
+#include "Doom/Game/g_game.h"
+#include "Doom/Game/p_tick.h"
+#include "Doom/Renderer/r_data.h"
+#include "Game.h"
+#include "Input.h"
+#include "MapInfo/MapInfo.h"
+#include "ProgArgs.h"
+#include "Video.h"
+#include "ZoneStats.h"
+
+#if PSYDOOM_VULKAN_RENDERER
+    #include "LogicalDevice.h"
+    #include "Vulkan/VRenderer.h"
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+BEGIN_NAMESPACE(SoakTest)
+
+typedef std::chrono::steady_clock::time_point timepoint_t;
+
+// How often (in frames) to sample memory usage while running a map.
+// Sampling is not free so it is not done every frame, and the time spent sampling is excluded from frame times.
+static constexpr uint32_t MEM_SAMPLE_INTERVAL = 30;
+
+// How many game seconds it takes the player to do one full turn on the spot
+static constexpr int32_t TURN_PERIOD_SECS = 8;
+
+static bool                 gbIsRunningMap;         // True if we are currently running a map for the soak test
+static bool                 gbIsFirstTick;          // True if the first tick of the current map has not been run yet
+static int32_t              gNumTicksLeft;          // How many ticks are left to run for the current map
+static timepoint_t          gLastFrameTime;         // When the previous frame finished (or when the first tick started, for the 1st frame)
+static std::vector<double>  gFrameTimesMs;          // The time taken for each frame drawn for the current map (milliseconds)
+static int32_t              gPeakZoneUsedBytes;     // The highest amount of zone memory in use seen for the current map
+static uint64_t             gPeakVkDeviceMemBytes;  // The highest amount of device local Vulkan memory seen for the current map
+static uint64_t             gPeakVkHostMemBytes;    // The highest amount of host Vulkan memory allocated seen for the current map
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Get a percentile frame time (0-100) from the given list of sorted frame times
+//------------------------------------------------------------------------------------------------------------------------------------------
+static double getPercentile(const std::vector<double>& sortedTimes, const double percentile) noexcept {
+    if (sortedTimes.empty())
+        return 0.0;
+
+    const size_t lastIdx = sortedTimes.size() - 1;
+    const size_t idx = std::min((size_t)((double) lastIdx * percentile / 100.0 + 0.5), lastIdx);
+    return sortedTimes[idx];
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Get how many ticks of game time there are in the given number of seconds
+//------------------------------------------------------------------------------------------------------------------------------------------
+static int32_t getNumTicksForSecs(const int32_t numSecs) noexcept {
+    const int32_t vblanksPerSec = (Game::gSettings.bUsePalTimings) ? 50 : VBLANKS_PER_SEC;
+    const int32_t tickVBlanks = (Game::gSettings.bUsePalTimings) ? 3 : VBLANKS_PER_TIC;
+    return std::max((numSecs * vblanksPerSec) / tickVBlanks, 1);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Sample how much zone memory and Vulkan memory is currently in use and update the high-water marks for the current map
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void sampleMemUsage() noexcept {
+    zoneheapstats_t heapStats = {};
+    Z_GetHeapStats(*gpMainMemZone, heapStats);
+    gPeakZoneUsedBytes = std::max(gPeakZoneUsedBytes, heapStats.totalBytes - heapStats.freeBytes);
+
+    #if PSYDOOM_VULKAN_RENDERER
+        if ((!ProgArgs::gbHeadlessMode) && (Video::gBackendType == Video::BackendType::Vulkan)) {
+            vgl::DeviceMemStats memStats = {};
+            VRenderer::gDevice.getDeviceMemMgr().getStats(memStats);
+
+            uint64_t deviceMemBytes = 0;
+            uint64_t hostMemBytes = 0;
+
+            for (uint32_t heapIdx = 0; heapIdx < memStats.numHeaps; ++heapIdx) {
+                const vgl::DeviceMemHeapStats& heap = memStats.heaps[heapIdx];
+                const uint64_t heapBytes = heap.numPoolBytes + heap.numUnpooledBytes;
+
+                if (heap.bIsDeviceLocal) {
+                    deviceMemBytes += heapBytes;
+                } else {
+                    hostMemBytes += heapBytes;
+                }
+            }
+
+            gPeakVkDeviceMemBytes = std::max(gPeakVkDeviceMemBytes, deviceMemBytes);
+            gPeakVkHostMemBytes = std::max(gPeakVkHostMemBytes, hostMemBytes);
+        }
+    #endif
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Write the given map name to the CSV file as a quoted field, escaping any quotes within it
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void writeCsvMapName(std::FILE* const pCsvFile, const String32& name) noexcept {
+    std::fputc('"', pCsvFile);
+
+    for (uint32_t i = 0; (i < String32::MAX_LEN) && name.chars[i]; ++i) {
+        const char c = name.chars[i];
+
+        if (c == '"') {
+            std::fputc('"', pCsvFile);
+        }
+
+        std::fputc(c, pCsvFile);
+    }
+
+    std::fputc('"', pCsvFile);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Load and run the specified map for the soak test, then write the results for it to the given CSV file.
+// Returns the average frame time for the map (in milliseconds).
+//------------------------------------------------------------------------------------------------------------------------------------------
+static double runMap(const MapInfo::Map& map, std::FILE* const pCsvFile) noexcept {
+    // Setup the game for the map and load it, timing how long the load takes
+    G_InitNew(ProgArgs::gWarpSkill, map.mapNum, gt_single);
+
+    texcachestats_t startTCacheStats = {};
+    I_GetTexCacheStats(startTCacheStats);
+
+    const timepoint_t loadStartTime = std::chrono::steady_clock::now();
+    G_DoLoadLevel();
+    const double loadTimeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - loadStartTime).count();
+
+    // The player must not die during the run, since the camera path would then differ
+    gPlayers[0].cheats |= CF_GODMODE;
+
+    // Run the map until the required number of ticks have elapsed
+    gbIsRunningMap = true;
+    gbIsFirstTick = true;
+    gNumTicksLeft = getNumTicksForSecs(ProgArgs::gSoakSeconds);
+    gFrameTimesMs.clear();
+    gFrameTimesMs.reserve((size_t) gNumTicksLeft + 1);
+    gPeakZoneUsedBytes = 0;
+    gPeakVkDeviceMemBytes = 0;
+    gPeakVkHostMemBytes = 0;
+    sampleMemUsage();
+
+    MiniLoop(P_Start, P_Stop, P_Ticker, P_Drawer);
+    gbIsRunningMap = false;
+
+    // Record main memory heap statistics for the level just ended, while level data is still in memory (if enabled)
+    ZoneStats::onLevelExit();
+
+    // Compute the stats for the map and write them to the CSV file
+    texcachestats_t endTCacheStats = {};
+    I_GetTexCacheStats(endTCacheStats);
+
+    std::vector<double> sortedTimes = gFrameTimesMs;
+    std::sort(sortedTimes.begin(), sortedTimes.end());
+
+    const size_t numFrames = sortedTimes.size();
+    double totalTimeMs = 0.0;
+
+    for (const double frameTimeMs : sortedTimes) {
+        totalTimeMs += frameTimeMs;
+    }
+
+    const double avgFrameTimeMs = (numFrames > 0) ? totalTimeMs / (double) numFrames : 0.0;
+
+    #if PSYDOOM_LIMIT_REMOVING
+        const int32_t zoneHeapPeakBytes = gpMainMemZone->peakSize;
+    #else
+        const int32_t zoneHeapPeakBytes = gpMainMemZone->size;
+    #endif
+
+    std::fprintf(pCsvFile, "%d,", (int) map.mapNum);
+    writeCsvMapName(pCsvFile, map.name);
+    std::fprintf(pCsvFile, ",%.3f,%u,%.3f,%.3f,%.3f,%.3f,%.3f,%d,%d,%llu,%llu,%u,%u,%llu\n",
+        loadTimeMs,
+        (uint32_t) numFrames,
+        avgFrameTimeMs,
+        getPercentile(sortedTimes, 50.0),
+        getPercentile(sortedTimes, 90.0),
+        getPercentile(sortedTimes, 99.0),
+        (numFrames > 0) ? sortedTimes.back() : 0.0,
+        gPeakZoneUsedBytes / 1024,
+        zoneHeapPeakBytes / 1024,
+        (unsigned long long)(gPeakVkDeviceMemBytes / 1024),
+        (unsigned long long)(gPeakVkHostMemBytes / 1024),
+        endTCacheStats.numMisses - startTCacheStats.numMisses,
+        endTCacheStats.numEvictions - startTCacheStats.numEvictions,
+        (unsigned long long)((endTCacheStats.numUploadBytes - startTCacheStats.numUploadBytes) / 1024)
+    );
+
+    std::fflush(pCsvFile);
+
+    // Texture cache: unlock everything except UI assets and other reserved areas of VRAM.
+    // In limit removing mode also ensure we are using tight packing of VRAM.
+    #if PSYDOOM_LIMIT_REMOVING
+        I_LockAllWallAndFloorTextures(false);
+        I_TexCacheUseLoosePacking(false);
+    #else
+        I_UnlockAllTexCachePages();
+        I_LockTexCachePage(0);
+    #endif
+
+    // Purge the heap and texture cache to cleanup and and finish up
+    Z_FreeTags(*gpMainMemZone, PU_LEVEL | PU_LEVSPEC | PU_ANIMATION | PU_CACHE);
+    I_PurgeTexCache();
+
+    for (uint32_t playerIdx = 0; playerIdx < MAXPLAYERS; ++playerIdx) {
+        gTickInputs[playerIdx].reset();
+        gOldTickInputs[playerIdx].reset();
+    }
+
+    return avgFrameTimeMs;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tells if the game is running in '-soak' benchmark mode
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool isActive() noexcept {
+    return (ProgArgs::gSoakSeconds > 0);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tells if a map is currently being run for the soak test
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool isRunningMap() noexcept {
+    return gbIsRunningMap;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Runs the soak test on all maps, writing the results to the CSV file specified and printing a summary to stdout when done
+//------------------------------------------------------------------------------------------------------------------------------------------
+void run() noexcept {
+    if (!isActive())
+        return;
+
+    std::FILE* const pCsvFile = std::fopen(ProgArgs::gSoakCsvFilePath, "w");
+
+    if (!pCsvFile) {
+        std::printf("Soak test: unable to open the results file '%s' for writing!\n", ProgArgs::gSoakCsvFilePath);
+        return;
+    }
+
+    std::fprintf(pCsvFile,
+        "map,name,load_ms,frames,avg_ms,p50_ms,p90_ms,p99_ms,max_ms,zone_used_peak_kib,zone_heap_peak_kib,"
+        "vk_device_mem_peak_kib,vk_host_mem_peak_kib,tcache_misses,tcache_evictions,tcache_upload_kib\n"
+    );
+
+    // Ensure this required graphic is loaded before loading any maps
+    if (!gTex_LOADING.bIsCached) {
+        I_LoadAndCache_LOADING_TexLump(gTex_LOADING);
+    }
+
+    // Run all of the maps which are playable in this game, keeping track of the slowest one
+    const int32_t numGameMaps = Game::getNumMaps();
+    uint32_t numMapsRun = 0;
+    int32_t slowestMapNum = 0;
+    double slowestMapAvgMs = 0.0;
+
+    for (const MapInfo::Map& map : MapInfo::allMaps()) {
+        if ((map.mapNum < 1) || (map.mapNum > numGameMaps))
+            continue;
+
+        const double avgFrameTimeMs = runMap(map, pCsvFile);
+        numMapsRun++;
+
+        if (avgFrameTimeMs > slowestMapAvgMs) {
+            slowestMapAvgMs = avgFrameTimeMs;
+            slowestMapNum = map.mapNum;
+        }
+
+        if (Input::isQuitRequested())
+            break;
+    }
+
+    std::fclose(pCsvFile);
+
+    // Print the results summary and free up memory used
+    std::printf("Soak test results:\n");
+    std::printf("  Renderer:            %s%s\n",
+        (ProgArgs::gbHeadlessMode) ? "none (headless)" : ((Video::isUsingVulkanRenderPath()) ? "Vulkan" : "Classic"),
+        (ProgArgs::gbNoPresent) ? " (no present)" : ""
+    );
+    std::printf("  Maps run:            %u (%d seconds each)\n", numMapsRun, ProgArgs::gSoakSeconds);
+    std::printf("  Slowest map:         MAP%02d (%.3f ms avg frame time)\n", slowestMapNum, slowestMapAvgMs);
+    std::printf("  Results file:        %s\n", ProgArgs::gSoakCsvFilePath);
+    std::fflush(stdout);
+
+    gFrameTimesMs.clear();
+    gFrameTimesMs.shrink_to_fit();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Should be called after the inputs for a tick have been read while running a soak test map.
+// Replaces the inputs with the ones for the deterministic camera path and returns 'false' when the map run should end.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool updateTickInputs(TickInputs& inputs) noexcept {
+    if (!gbIsRunningMap)
+        return true;
+
+    if (gbIsFirstTick) {
+        gbIsFirstTick = false;
+        gLastFrameTime = std::chrono::steady_clock::now();
+    }
+
+    if (gNumTicksLeft <= 0)
+        return false;
+
+    gNumTicksLeft--;
+
+    // Turn the player at a constant rate: one full turn every few seconds
+    const uint64_t ticksPerTurn = (uint64_t) getNumTicksForSecs(TURN_PERIOD_SECS);
+    inputs.reset();
+    inputs.setAnalogTurn((angle_t)((uint64_t(1) << 32) / ticksPerTurn));
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Should be called at the end of every frame of gameplay: records how long the frame took and periodically samples memory usage
+//------------------------------------------------------------------------------------------------------------------------------------------
+void onFrameDone() noexcept {
+    if ((!gbIsRunningMap) || gbIsFirstTick)
+        return;
+
+    timepoint_t now = std::chrono::steady_clock::now();
+    gFrameTimesMs.push_back(std::chrono::duration<double, std::milli>(now - gLastFrameTime).count());
+
+    if (gFrameTimesMs.size() % MEM_SAMPLE_INTERVAL == 0) {
+        sampleMemUsage();
+        now = std::chrono::steady_clock::now();
+    }
+
+    gLastFrameTime = now;
+}
+
+END_NAMESPACE(SoakTest)
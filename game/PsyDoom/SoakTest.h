@@ -0,0 +1,15 @@
+#pragma once
+
+#include "Macros.h"
+
+struct TickInputs;
+
+BEGIN_NAMESPACE(SoakTest)
+
+bool isActive() noexcept;
+bool isRunningMap() noexcept;
+void run() noexcept;
+bool updateTickInputs(TickInputs& inputs) noexcept;
+void onFrameDone() noexcept;
+
+END_NAMESPACE(SoakTest)
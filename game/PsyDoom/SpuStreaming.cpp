@@ -0,0 +1,310 @@
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Streaming of long one-shot sounds into SPU RAM on demand.
+// Instead of keeping the entire sound resident in SPU RAM, a streamed sound only occupies a small ring buffer there. The ring initially holds
+// the start of the sound, and as a voice plays through it the half which the voice has just left is refilled with the next part of the sound
+// from disk. The ADPCM block flags in the ring are patched so that the voice wraps around from the end of the ring back to the start, and
+// stops once it reaches the real end of the sound.
+//
+// Notes:
+//  (1) Only one voice can play a streamed sound at a time: keying on the sound again restarts it and silences the previous voice.
+//  (2) All stream state that is shared with the SPU is only ever touched with the SPU locked. The key on hook is invoked by the SPU command
+//      queue (possibly on the audio thread) so it must never do any I/O; disk reads are done by 'update' on the main thread, without the SPU
+//      lock held, so that the audio thread is never kept waiting on the disk.
+//------------------------------------------------------------------------------------------------------------------------------------------
+#include "SpuStreaming.h"
+
+#include "Asserts.h"
+#include "Config/Config.h"
+#include "PsxVm.h"
+#include "SmallString.h"
+#include "Spu.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+BEGIN_NAMESPACE(SpuStreaming)
+
+static_assert(RING_HALF_SIZE % Spu::ADPCM_BLOCK_SIZE == 0);
+
+// Holds the details for one streamed sound
+struct Stream {
+    CdFileId                file;               // Which file the sound data is streamed from
+    int32_t                 fileOffset;         // Where the sound data starts in the file
+    uint32_t                soundSize;          // Size of the sound data in bytes
+    uint32_t                ringSpuAddr;        // Where the ring buffer for the sound is in SPU RAM; this is also the sound's address
+    std::vector<uint8_t>    ringHead;           // The initial contents of the ring (the start of the sound), restored on 'key on'
+    uint32_t                nextReadOffset;     // Offset of the next sound byte to be put into the ring
+    uint32_t                halfToFill;         // Which half of the ring gets refilled once the voice moves into the other half
+    uint32_t                generation;         // Incremented on each 'key on', so refills made stale by a restart can be discarded
+    int32_t                 voiceIdx;           // Which voice is playing the stream or '-1' if none
+    bool                    bRingDirty;         // True if the ring no longer holds the start of the sound
+};
+
+static std::vector<Stream>      gStreams;       // All of the currently registered streams
+static std::vector<uint8_t>     gReadBuffer;    // Buffer used to read sound data from disk before patching it and copying it into the ring
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Helpers: get or set the flags for the ADPCM block at the given pointer
+//------------------------------------------------------------------------------------------------------------------------------------------
+static uint8_t getAdpcmFlags(const uint8_t* const pBlock) noexcept {
+    return pBlock[1];
+}
+
+static void setAdpcmFlags(uint8_t* const pBlock, const uint8_t flags) noexcept {
+    pBlock[1] = flags;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Copies sound data into a buffer destined for the specified position in the ring and patches the ADPCM block flags to suit that position.
+// The first block in the ring becomes the loop start point, and the last block in the ring jumps back to it unless it's already ending the
+// sound. Any part of the buffer past the end of the sound data given is zero filled.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void prepareRingData(
+    uint8_t* const pDst,
+    const uint32_t dstSize,
+    const uint8_t* const pSrc,
+    const uint32_t srcSize,
+    const uint32_t ringOffset
+) noexcept {
+    ASSERT(srcSize <= dstSize);
+    ASSERT((dstSize % Spu::ADPCM_BLOCK_SIZE == 0) && (ringOffset % Spu::ADPCM_BLOCK_SIZE == 0));
+    ASSERT(ringOffset + dstSize <= RING_SIZE);
+
+    std::memcpy(pDst, pSrc, srcSize);
+    std::memset(pDst + srcSize, 0, dstSize - srcSize);
+
+    for (uint32_t blockOffset = 0; blockOffset < dstSize; blockOffset += Spu::ADPCM_BLOCK_SIZE) {
+        uint8_t* const pBlock = pDst + blockOffset;
+        const uint32_t ringPos = ringOffset + blockOffset;
+        uint8_t flags = getAdpcmFlags(pBlock);
+
+        if (ringPos == 0) {
+            flags |= Spu::ADPCM_FLAG_LOOP_START;
+        }
+
+        if ((ringPos + Spu::ADPCM_BLOCK_SIZE == RING_SIZE) && ((flags & Spu::ADPCM_FLAG_LOOP_END) == 0)) {
+            flags |= Spu::ADPCM_FLAG_LOOP_END | Spu::ADPCM_FLAG_REPEAT;
+        }
+
+        setAdpcmFlags(pBlock, flags);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Reads part of a stream's sound data from disk, returning 'false' on failure
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool readSoundData(const Stream& stream, const uint32_t soundOffset, const uint32_t numBytes, uint8_t* const pDst) noexcept {
+    PsxCd_File* const pFile = psxcd_open(stream.file);
+
+    if (!pFile)
+        return false;
+
+    const bool bReadOk = (
+        (psxcd_seek(*pFile, stream.fileOffset + (int32_t) soundOffset, PsxCd_SeekMode::SET) == 0) &&
+        (psxcd_read(pDst, (int32_t) numBytes, *pFile) == (int32_t) numBytes)
+    );
+
+    psxcd_close(*pFile);
+    return bReadOk;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tells if a sound in an LCD file should be streamed rather than fully loaded into SPU RAM.
+// Only sounds at least as big as the configured threshold are streamed, and they must also be one-shot sounds: looped sounds need to jump
+// back to an arbitrary point in the sound, which the ring can't support. The one exception is a final block which loops on itself; that is
+// a common way of ending one-shot sounds and a voice sitting on that block never needs the ring to be refilled.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool shouldStreamSound(const uint8_t* const pSoundData, const uint32_t soundSize) noexcept {
+    // Is streaming enabled and is the sound big enough to be worth streaming?
+    if (Config::gStreamedSoundMinSize <= 0)
+        return false;
+
+    const uint32_t minStreamedSize = std::max((uint32_t) Config::gStreamedSoundMinSize, RING_SIZE * 2);
+
+    if ((soundSize < minStreamedSize) || (soundSize % Spu::ADPCM_BLOCK_SIZE != 0))
+        return false;
+
+    // Only stream one-shot sounds
+    const uint32_t lastBlockOffset = soundSize - Spu::ADPCM_BLOCK_SIZE;
+
+    for (uint32_t blockOffset = 0; blockOffset < lastBlockOffset; blockOffset += Spu::ADPCM_BLOCK_SIZE) {
+        const uint8_t flags = getAdpcmFlags(pSoundData + blockOffset);
+        const uint8_t disallowedFlags = (blockOffset == 0) ? Spu::ADPCM_FLAG_REPEAT : Spu::ADPCM_FLAG_REPEAT | Spu::ADPCM_FLAG_LOOP_START;
+
+        if (flags & disallowedFlags)
+            return false;
+    }
+
+    const uint8_t lastBlockFlags = getAdpcmFlags(pSoundData + lastBlockOffset);
+    return (((lastBlockFlags & Spu::ADPCM_FLAG_REPEAT) == 0) || (lastBlockFlags & Spu::ADPCM_FLAG_LOOP_START));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Registers a streamed sound and writes the start of the sound to its ring buffer in SPU RAM.
+// The first 'RING_SIZE' bytes of the sound data must be given, and 'fileOffset' is where the whole of the sound data starts in the file.
+// This must be called with the SPU locked.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void addStream(
+    const CdFileId file,
+    const int32_t fileOffset,
+    const uint8_t* const pSoundData,
+    const uint32_t soundSize,
+    const uint32_t ringSpuAddr
+) noexcept {
+    ASSERT(soundSize > RING_SIZE);
+    ASSERT(ringSpuAddr % 8 == 0);
+
+    Spu::Core& spu = PsxVm::gSpu;
+
+    if (ringSpuAddr + RING_SIZE > spu.ramSize)
+        return;
+
+    // Replace any stream already using this ring
+    removeStreamsFromAddr(ringSpuAddr);
+
+    Stream& stream = gStreams.emplace_back();
+    stream.file = file;
+    stream.fileOffset = fileOffset;
+    stream.soundSize = soundSize;
+    stream.ringSpuAddr = ringSpuAddr;
+    stream.nextReadOffset = RING_SIZE;
+    stream.halfToFill = 0;
+    stream.generation = 0;
+    stream.voiceIdx = -1;
+    stream.bRingDirty = false;
+
+    stream.ringHead.resize(RING_SIZE);
+    prepareRingData(stream.ringHead.data(), RING_SIZE, pSoundData, RING_SIZE, 0);
+    std::memcpy(spu.pRam + ringSpuAddr, stream.ringHead.data(), RING_SIZE);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Unregisters all streams with a ring buffer at or after the given SPU address.
+// This is called when sounds are about to be loaded at that address, since the loaded sounds will overwrite those rings.
+// This must be called with the SPU locked.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void removeStreamsFromAddr(const uint32_t spuAddr) noexcept {
+    gStreams.erase(
+        std::remove_if(
+            gStreams.begin(),
+            gStreams.end(),
+            [=](const Stream& stream) noexcept { return (stream.ringSpuAddr >= spuAddr); }
+        ),
+        gStreams.end()
+    );
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Called just after a voice has been keyed on, with the SPU locked.
+// If the voice is playing a streamed sound then the stream is restarted from the beginning.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void onVoiceKeyOn(const uint32_t voiceIdx) noexcept {
+    if (gStreams.empty())
+        return;
+
+    Spu::Core& spu = PsxVm::gSpu;
+    const uint32_t startSpuAddr = spu.pVoices[voiceIdx].adpcmStartAddr8 * 8;
+
+    for (Stream& stream : gStreams) {
+        // If this voice was playing some other stream then it no longer is
+        if (stream.ringSpuAddr != startSpuAddr) {
+            if (stream.voiceIdx == (int32_t) voiceIdx) {
+                stream.voiceIdx = -1;
+            }
+
+            continue;
+        }
+
+        // Silence any other voice still playing this stream, since the ring is about to be reset
+        if ((stream.voiceIdx >= 0) && (stream.voiceIdx != (int32_t) voiceIdx)) {
+            Spu::Voice& prevVoice = spu.pVoices[stream.voiceIdx];
+
+            if (prevVoice.adpcmStartAddr8 * 8 == stream.ringSpuAddr) {
+                prevVoice.envLevel = 0;
+                prevVoice.envPhase = Spu::EnvPhase::Off;
+            }
+        }
+
+        // Restart the stream
+        if (stream.bRingDirty) {
+            std::memcpy(spu.pRam + stream.ringSpuAddr, stream.ringHead.data(), RING_SIZE);
+            stream.bRingDirty = false;
+        }
+
+        stream.nextReadOffset = RING_SIZE;
+        stream.halfToFill = 0;
+        stream.generation++;
+        stream.voiceIdx = (int32_t) voiceIdx;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Refills the rings for all streams being played, where needed.
+// This should be called regularly from the main thread: each half of the ring lasts for ~0.16 seconds at the maximum SPU sample rate.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void update() noexcept {
+    if (gStreams.empty())
+        return;
+
+    for (Stream& stream : gStreams) {
+        // Figure out if the stream needs to be refilled and what to read
+        uint32_t generation = {};
+        uint32_t halfToFill = {};
+        uint32_t soundOffset = {};
+
+        {
+            PsxVm::LockSpu spuLock;
+
+            if (stream.voiceIdx < 0)
+                continue;
+
+            // Has the voice stopped playing the stream?
+            const Spu::Voice& voice = PsxVm::gSpu.pVoices[stream.voiceIdx];
+
+            if ((voice.envPhase == Spu::EnvPhase::Off) || (voice.adpcmStartAddr8 * 8 != stream.ringSpuAddr)) {
+                stream.voiceIdx = -1;
+                continue;
+            }
+
+            // Only refill once the voice has moved into the other half of the ring and if there is more of the sound left
+            const uint32_t ringPos = voice.adpcmCurAddr8 * 8 - stream.ringSpuAddr;
+
+            if ((ringPos >= RING_SIZE) || (ringPos / RING_HALF_SIZE == stream.halfToFill) || (stream.nextReadOffset >= stream.soundSize))
+                continue;
+
+            generation = stream.generation;
+            halfToFill = stream.halfToFill;
+            soundOffset = stream.nextReadOffset;
+        }
+
+        // Read the next part of the sound from disk without the SPU locked.
+        // If that fails then fill the rest of the ring with silence and end the sound there.
+        const uint32_t numBytesToRead = std::min(stream.soundSize - soundOffset, RING_HALF_SIZE);
+        gReadBuffer.resize(RING_HALF_SIZE * 2);
+        uint8_t* const pReadBytes = gReadBuffer.data();
+        uint8_t* const pRingBytes = gReadBuffer.data() + RING_HALF_SIZE;
+
+        const bool bReadOk = readSoundData(stream, soundOffset, numBytesToRead, pReadBytes);
+        prepareRingData(pRingBytes, RING_HALF_SIZE, pReadBytes, (bReadOk) ? numBytesToRead : 0, halfToFill * RING_HALF_SIZE);
+
+        if (!bReadOk) {
+            setAdpcmFlags(pRingBytes, Spu::ADPCM_FLAG_LOOP_END);
+        }
+
+        // Write the data to the ring, unless the stream was restarted while reading
+        {
+            PsxVm::LockSpu spuLock;
+
+            if (stream.generation != generation)
+                continue;
+
+            std::memcpy(PsxVm::gSpu.pRam + stream.ringSpuAddr + halfToFill * RING_HALF_SIZE, pRingBytes, RING_HALF_SIZE);
+            stream.nextReadOffset = (bReadOk) ? soundOffset + numBytesToRead : stream.soundSize;
+            stream.halfToFill ^= 1;
+            stream.bRingDirty = true;
+        }
+    }
+}
+
+END_NAMESPACE(SpuStreaming)
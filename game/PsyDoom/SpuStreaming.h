@@ -0,0 +1,29 @@
+#pragma once
+
+#include "Macros.h"
+#include "Wess/psxcd.h"
+
+#include <cstdint>
+
+BEGIN_NAMESPACE(SpuStreaming)
+
+// Size of the ring buffer in SPU RAM used by each streamed sound, in bytes.
+// The ring is split into 2 halves: one half is refilled from disk while the voice plays the other half.
+static constexpr uint32_t RING_SIZE = 32 * 1024;
+static constexpr uint32_t RING_HALF_SIZE = RING_SIZE / 2;
+
+bool shouldStreamSound(const uint8_t* const pSoundData, const uint32_t soundSize) noexcept;
+
+void addStream(
+    const CdFileId file,
+    const int32_t fileOffset,
+    const uint8_t* const pSoundData,
+    const uint32_t soundSize,
+    const uint32_t ringSpuAddr
+) noexcept;
+
+void removeStreamsFromAddr(const uint32_t spuAddr) noexcept;
+void onVoiceKeyOn(const uint32_t voiceIdx) noexcept;
+void update() noexcept;
+
+END_NAMESPACE(SpuStreaming)
@@ -0,0 +1,174 @@
+//------------------------------------------------------------------------------------------------------------------------------------------
+// A module which provides fixed size slab pools for map objects and thinkers (doors, floors, platforms, lights etc.).
+//
+// Originally each map object and thinker was allocated individually from the zone heap, which in busy fights with lots of projectiles
+// churns the heap and scatters map objects all over memory. With pools, objects of the same size are stored contiguously in large slabs
+// of memory which are never moved or freed until shutdown, so object addresses are stable. Freed objects are recycled via a free list,
+// so spawning a new object is just a free list pop. All objects are released at once whenever level memory is purged.
+//
+// Note: pools are only used in limit removing builds, since they allocate outside of the zone heap which has a fixed size in the original
+// game. In other builds all allocations go to the zone heap as before.
+//------------------------------------------------------------------------------------------------------------------------------------------
+#include "ThinkerPool.h"
+
+#include "Doom/Base/i_main.h"
+#include "Doom/Base/z_zone.h"
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+BEGIN_NAMESPACE(ThinkerPool)
+
+// All pool slots must have this id while in use
+static constexpr uint16_t SLOTID = 0x7F3C;
+
+// How many slots there are in each slab of memory allocated for a pool
+static constexpr uint32_t SLAB_NUM_SLOTS = 256;
+
+// Header for a slot in a pool, which comes immediately before the object memory
+struct SlotHeader {
+    SlotHeader*     pNextFree;      // Next free slot in the pool (if this slot is free)
+    uint16_t        poolIdx;        // Which pool the slot belongs to
+    uint16_t        id;             // Should be 'SLOTID' if the slot is in use, or '0' if free
+};
+
+// Size of the slot header, padded so that object memory has the maximum alignment required by any type
+static constexpr uint32_t SLOT_HEADER_SIZE = (uint32_t)(
+    (sizeof(SlotHeader) + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1)
+);
+
+// A pool of objects with a particular size
+struct Pool {
+    uint32_t                                    objSize;        // Size of each object stored in the pool
+    uint32_t                                    slotSize;       // Size of each slot in the pool, including the header and padding
+    SlotHeader*                                 pFreeList;      // The next free slot in the pool, or null if the pool is full
+    std::vector<std::unique_ptr<std::byte[]>>   slabs;          // Memory for all slots in the pool
+};
+
+// All the pools which have been created.
+// Note that pools are never removed once created, so that pool indexes remain valid.
+static std::vector<Pool> gPools;
+
+#if PSYDOOM_LIMIT_REMOVING
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Get the header for the given slot in a slab
+//------------------------------------------------------------------------------------------------------------------------------------------
+static SlotHeader& getSlot(const Pool& pool, std::byte* const pSlab, const uint32_t slotIdx) noexcept {
+    return *(SlotHeader*)(pSlab + (size_t) slotIdx * pool.slotSize);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Adds all the slots in the given slab to the pool's free list.
+// The lowest addressed slot ends up at the front of the free list, so the pool fills up in memory order.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void freeAllSlotsInSlab(Pool& pool, std::byte* const pSlab) noexcept {
+    const uint16_t poolIdx = (uint16_t)(&pool - gPools.data());
+
+    for (uint32_t slotIdx = SLAB_NUM_SLOTS; slotIdx > 0; --slotIdx) {
+        SlotHeader& slot = getSlot(pool, pSlab, slotIdx - 1);
+        slot.pNextFree = pool.pFreeList;
+        slot.poolIdx = poolIdx;
+        slot.id = 0;
+        pool.pFreeList = &slot;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Adds another slab of memory (and free slots) to the given pool
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void addSlab(Pool& pool) noexcept {
+    std::byte* const pSlab = pool.slabs.emplace_back(new std::byte[(size_t) pool.slotSize * SLAB_NUM_SLOTS]).get();
+    freeAllSlotsInSlab(pool, pSlab);
+}
+#endif  // #if PSYDOOM_LIMIT_REMOVING
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Get the index of the pool to use for objects of the given size, creating the pool if it doesn't exist already.
+// This should be called once for each object type and the result cached, for efficiency.
+//------------------------------------------------------------------------------------------------------------------------------------------
+uint16_t getPoolForSize(const uint32_t objSize) noexcept {
+    for (uint16_t poolIdx = 0; poolIdx < gPools.size(); ++poolIdx) {
+        if (gPools[poolIdx].objSize == objSize)
+            return poolIdx;
+    }
+
+    const uint32_t alignedObjSize = (uint32_t)((objSize + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1));
+
+    Pool& pool = gPools.emplace_back();
+    pool.objSize = objSize;
+    pool.slotSize = SLOT_HEADER_SIZE + alignedObjSize;
+    pool.pFreeList = nullptr;
+    return (uint16_t)(gPools.size() - 1);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Allocates memory for an object from the specified pool.
+// In builds which are not limit removing, the memory is allocated from the zone heap with the specified tag instead.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void* alloc(const uint16_t poolIdx, [[maybe_unused]] const int16_t zoneTag) noexcept {
+    Pool& pool = gPools[poolIdx];
+
+    #if PSYDOOM_LIMIT_REMOVING
+        if (!pool.pFreeList) {
+            addSlab(pool);
+        }
+
+        SlotHeader& slot = *pool.pFreeList;
+        pool.pFreeList = slot.pNextFree;
+        slot.pNextFree = nullptr;
+        slot.id = SLOTID;
+        return (std::byte*) &slot + SLOT_HEADER_SIZE;
+    #else
+        return Z_Malloc(*gpMainMemZone, pool.objSize, zoneTag, nullptr);
+    #endif
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Frees memory for an object that was allocated with 'alloc', returning it to the pool it came from
+//------------------------------------------------------------------------------------------------------------------------------------------
+void dealloc(void* const pObj) noexcept {
+    #if PSYDOOM_LIMIT_REMOVING
+        SlotHeader& slot = *(SlotHeader*)((std::byte*) pObj - SLOT_HEADER_SIZE);
+
+        if (slot.id != SLOTID) {
+            I_Error("ThinkerPool::dealloc: freed a pointer without SLOTID");
+        }
+
+        Pool& pool = gPools[slot.poolIdx];
+        slot.id = 0;
+        slot.pNextFree = pool.pFreeList;
+        pool.pFreeList = &slot;
+    #else
+        Z_Free2(*gpMainMemZone, pObj);
+    #endif
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Frees all objects in all pools, but retains the memory for the pools for reuse.
+// Should be called whenever level memory is purged; objects allocated from the zone heap are freed by the purge itself.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void reset() noexcept {
+    #if PSYDOOM_LIMIT_REMOVING
+        for (Pool& pool : gPools) {
+            pool.pFreeList = nullptr;
+
+            for (auto slabIter = pool.slabs.rbegin(); slabIter != pool.slabs.rend(); ++slabIter) {
+                freeAllSlotsInSlab(pool, slabIter->get());
+            }
+        }
+    #endif
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Frees all objects in all pools and releases the memory used by the pools
+//------------------------------------------------------------------------------------------------------------------------------------------
+void shutdown() noexcept {
+    for (Pool& pool : gPools) {
+        pool.pFreeList = nullptr;
+        pool.slabs.clear();
+        pool.slabs.shrink_to_fit();
+    }
+}
+
+END_NAMESPACE(ThinkerPool)
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "Macros.h"
+
+#include <cstdint>
+
+BEGIN_NAMESPACE(ThinkerPool)
+
+uint16_t getPoolForSize(const uint32_t objSize) noexcept;
+void* alloc(const uint16_t poolIdx, const int16_t zoneTag) noexcept;
+void dealloc(void* const pObj) noexcept;
+void reset() noexcept;
+void shutdown() noexcept;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Allocates (uninitialized) memory for a map object or thinker of the given type.
+// The zone memory tag given is only used if the object has to be allocated from the zone instead of a pool.
+//------------------------------------------------------------------------------------------------------------------------------------------
+template <class T>
+inline T& alloc(const int16_t zoneTag) noexcept {
+    static const uint16_t poolIdx = getPoolForSize((uint32_t) sizeof(T));
+    return *(T*) alloc(poolIdx, zoneTag);
+}
+
+END_NAMESPACE(ThinkerPool)
@@ -0,0 +1,144 @@
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Utilities for configuring the priority of threads and which CPU cores they run on.
+// This is mostly useful on CPUs with a mix of fast and slow cores (e.g 'big.LITTLE' ARM CPUs), where threads that are sensitive to
+// timing such as the main thread or audio thread can be kept off the slow cores.
+//
+// Notes:
+//  (1) All requests are best effort only: the OS may ignore them or require elevated permissions for them to take effect.
+//  (2) Pinning threads to cores is not supported on macOS, since it does not provide any way to do that; the core list is ignored there.
+//------------------------------------------------------------------------------------------------------------------------------------------
+#include "ThreadUtils.h"
+
+#include <SDL.h>
+#include <cctype>
+#include <cstdlib>
+
+#if _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <Windows.h>
+#elif __linux__
+    #include <sched.h>
+#endif
+
+BEGIN_NAMESPACE(ThreadUtils)
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Parses a list of CPU cores from the config into a mask containing one bit per core.
+// The list is comma separated and each entry is either a single core index or an inclusive range of them, e.g: "0,2,4-7".
+// Invalid entries and cores past 'MAX_CORES' are ignored. Returns '0' (any core) if the list is empty.
+//------------------------------------------------------------------------------------------------------------------------------------------
+uint64_t parseCoreList(const std::string& coreList) noexcept {
+    uint64_t coreMask = 0;
+    const char* pStr = coreList.c_str();
+
+    // Helper: skips whitespace and reads a core index, returning '-1' if there is no valid number
+    const auto readCoreIdx = [&]() noexcept -> int32_t {
+        while (std::isspace((unsigned char) *pStr)) {
+            ++pStr;
+        }
+
+        if (!std::isdigit((unsigned char) *pStr))
+            return -1;
+
+        char* pNumEnd = nullptr;
+        const long coreIdx = std::strtol(pStr, &pNumEnd, 10);
+        pStr = pNumEnd;
+
+        while (std::isspace((unsigned char) *pStr)) {
+            ++pStr;
+        }
+
+        return (coreIdx < (long) MAX_CORES) ? (int32_t) coreIdx : (int32_t) MAX_CORES;
+    };
+
+    while (*pStr) {
+        // Read the entry: either a single core or a range
+        const int32_t firstCoreIdx = readCoreIdx();
+        int32_t lastCoreIdx = firstCoreIdx;
+
+        if (*pStr == '-') {
+            ++pStr;
+            lastCoreIdx = readCoreIdx();
+        }
+
+        // Only add the entry if it is valid and is followed by a separator or the end of the list
+        const bool bValidEntry = ((firstCoreIdx >= 0) && (lastCoreIdx >= firstCoreIdx) && ((*pStr == ',') || (*pStr == 0)));
+
+        if (bValidEntry) {
+            for (int32_t coreIdx = firstCoreIdx; (coreIdx <= lastCoreIdx) && (coreIdx < (int32_t) MAX_CORES); ++coreIdx) {
+                coreMask |= uint64_t(1) << coreIdx;
+            }
+        }
+
+        // Move onto the next entry
+        while ((*pStr != ',') && (*pStr != 0)) {
+            ++pStr;
+        }
+
+        if (*pStr == ',') {
+            ++pStr;
+        }
+    }
+
+    return coreMask;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Returns how many cores are in the given core mask
+//------------------------------------------------------------------------------------------------------------------------------------------
+uint32_t getNumCores(const uint64_t coreMask) noexcept {
+    uint32_t numCores = 0;
+
+    for (uint64_t mask = coreMask; mask != 0; mask &= mask - 1) {
+        ++numCores;
+    }
+
+    return numCores;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Makes settings for a thread from the priority and list of cores given in the config
+//------------------------------------------------------------------------------------------------------------------------------------------
+ThreadSettings makeThreadSettings(const int32_t priority, const std::string& coreList) noexcept {
+    ThreadSettings settings = {};
+    settings.priority = priority;
+    settings.coreMask = parseCoreList(coreList);
+    return settings;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Applies the given settings to the calling thread.
+// The thread is left as it is for default priority levels or an empty core mask.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void applyToCurrentThread(const ThreadSettings& settings) noexcept {
+    // Set the priority
+    if (settings.priority <= THREAD_PRIORITY_LOW) {
+        SDL_SetThreadPriority(SDL_THREAD_PRIORITY_LOW);
+    } else if (settings.priority == THREAD_PRIORITY_HIGH) {
+        SDL_SetThreadPriority(SDL_THREAD_PRIORITY_HIGH);
+    } else if (settings.priority >= THREAD_PRIORITY_TIME_CRITICAL) {
+        SDL_SetThreadPriority(SDL_THREAD_PRIORITY_TIME_CRITICAL);
+    }
+
+    // Pin the thread to the requested cores
+    if (settings.coreMask == 0)
+        return;
+
+    #if _WIN32
+        SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR) settings.coreMask);
+    #elif __linux__
+        cpu_set_t cpuSet;
+        CPU_ZERO(&cpuSet);
+
+        for (uint32_t coreIdx = 0; coreIdx < MAX_CORES; ++coreIdx) {
+            if (settings.coreMask & (uint64_t(1) << coreIdx)) {
+                CPU_SET(coreIdx, &cpuSet);
+            }
+        }
+
+        sched_setaffinity(0, sizeof(cpuSet), &cpuSet);      // Note: a PID of '0' means the calling thread on Linux
+    #endif
+}
+
+END_NAMESPACE(ThreadUtils)
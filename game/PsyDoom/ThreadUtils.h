@@ -0,0 +1,30 @@
+#pragma once
+
+#include "Macros.h"
+
+#include <cstdint>
+#include <string>
+
+BEGIN_NAMESPACE(ThreadUtils)
+
+// Priority levels that can be requested for a thread, as specified in the config
+static constexpr int32_t THREAD_PRIORITY_LOW            = -1;
+static constexpr int32_t THREAD_PRIORITY_DEFAULT        = 0;       // Leave the priority as it is
+static constexpr int32_t THREAD_PRIORITY_HIGH           = 1;
+static constexpr int32_t THREAD_PRIORITY_TIME_CRITICAL  = 2;
+
+// The max number of CPU cores that threads can be pinned to
+static constexpr uint32_t MAX_CORES = 64;
+
+// Settings for a particular role of thread: what priority it runs at and which CPU cores it is allowed to run on
+struct ThreadSettings {
+    int32_t     priority;       // One of the 'THREAD_PRIORITY_*' constants
+    uint64_t    coreMask;       // One bit per CPU core that the thread may run on, or '0' if the thread may run on any core
+};
+
+uint64_t parseCoreList(const std::string& coreList) noexcept;
+uint32_t getNumCores(const uint64_t coreMask) noexcept;
+ThreadSettings makeThreadSettings(const int32_t priority, const std::string& coreList) noexcept;
+void applyToCurrentThread(const ThreadSettings& settings) noexcept;
+
+END_NAMESPACE(ThreadUtils)
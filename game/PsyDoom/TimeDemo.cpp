@@ -0,0 +1,197 @@
+//------------------------------------------------------------------------------------------------------------------------------------------
+// A module that handles the '-timedemo' benchmarking mode.
+//
+// In this mode a single demo is played back as fast as possible with no frame rate limiting, vsync or audio output, and the time taken
+// to do each frame is measured. Once playback finishes a summary of the frame timings is printed to stdout, along with the outcome of
+// any demo result check that was requested. This allows renderer and simulation changes to be measured using the exact same stream of
+// inputs, and the results compared between runs or between the classic and Vulkan renderers.
+//------------------------------------------------------------------------------------------------------------------------------------------
+#include "TimeDemo.h"
+
+#include "Doom/Base/z_zone.h"
+#include "Doom/Game/g_game.h"
+#include "Doom/psx_main.h"
+#include "ProgArgs.h"
+#include "Video.h"
+
+#if PSYDOOM_VULKAN_RENDERER
+    #include "Vulkan/VGpuTimings.h"
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+BEGIN_NAMESPACE(TimeDemo)
+
+typedef std::chrono::steady_clock::time_point timepoint_t;
+
+static bool                 gbIsTiming;         // True if we are currently timing demo playback
+static uint32_t             gNumTicks;          // The number of demo ticks read during playback
+static timepoint_t          gStartTime;         // When timing of playback started
+static timepoint_t          gLastFrameTime;     // When the previous frame finished (or when playback started, for the 1st frame)
+static std::vector<double>  gFrameTimesMs;      // The time taken for each frame drawn during playback (milliseconds)
+static zonestats_t          gStartZoneStats;    // Zone memory allocator counters when playback started
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Get a percentile frame time (0-100) from the given list of sorted frame times
+//------------------------------------------------------------------------------------------------------------------------------------------
+static double getPercentile(const std::vector<double>& sortedTimes, const double percentile) noexcept {
+    if (sortedTimes.empty())
+        return 0.0;
+
+    const size_t lastIdx = sortedTimes.size() - 1;
+    const size_t idx = std::min((size_t)((double) lastIdx * percentile / 100.0 + 0.5), lastIdx);
+    return sortedTimes[idx];
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Get a string describing the render path which was used during the timed demo
+//------------------------------------------------------------------------------------------------------------------------------------------
+static const char* getRendererName() noexcept {
+    if (ProgArgs::gbHeadlessMode)
+        return "none (headless)";
+
+    return (Video::isUsingVulkanRenderPath()) ? "Vulkan" : "Classic";
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tells if the game is running in '-timedemo' benchmark mode
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool isActive() noexcept {
+    return ProgArgs::gbTimeDemo;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Should be called when demo gameplay is about to begin: starts timing if in timedemo mode
+//------------------------------------------------------------------------------------------------------------------------------------------
+void onPlaybackStart() noexcept {
+    if ((!isActive()) || (!gbDemoPlayback))
+        return;
+
+    gbIsTiming = true;
+    gNumTicks = 0;
+    gFrameTimesMs.clear();
+    gFrameTimesMs.reserve(1024 * 64);
+    gStartZoneStats = gpMainMemZone->stats;
+
+    #if PSYDOOM_VULKAN_RENDERER
+        VGpuTimings::resetTotals();
+    #endif
+
+    gStartTime = std::chrono::steady_clock::now();
+    gLastFrameTime = gStartTime;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Should be called whenever a tick's worth of inputs has been read from the demo
+//------------------------------------------------------------------------------------------------------------------------------------------
+void onTickInputsRead() noexcept {
+    if (gbIsTiming) {
+        gNumTicks++;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Should be called at the end of every frame of gameplay: records how long the frame took
+//------------------------------------------------------------------------------------------------------------------------------------------
+void onFrameDone() noexcept {
+    if (!gbIsTiming)
+        return;
+
+    const timepoint_t now = std::chrono::steady_clock::now();
+    gFrameTimesMs.push_back(std::chrono::duration<double, std::milli>(now - gLastFrameTime).count());
+    gLastFrameTime = now;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Should be called when demo gameplay has ended (after the demo result has been checked).
+// Stops timing and prints a summary of the results.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void onPlaybackEnd() noexcept {
+    if (!gbIsTiming)
+        return;
+
+    gbIsTiming = false;
+
+    // Compute all the stats
+    const double totalTimeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - gStartTime).count();
+    const size_t numFrames = gFrameTimesMs.size();
+    const double avgFrameTimeMs = (numFrames > 0) ? totalTimeMs / (double) numFrames : 0.0;
+    const double avgFps = (totalTimeMs > 0.0) ? (double) numFrames * 1000.0 / totalTimeMs : 0.0;
+
+    std::vector<double> sortedTimes = gFrameTimesMs;
+    std::sort(sortedTimes.begin(), sortedTimes.end());
+
+    // Figure out the result of the demo check (if any)
+    const char* demoCheckResult = "not requested";
+
+    if (ProgArgs::gCheckDemoResultFilePath[0]) {
+        demoCheckResult = (gbCheckDemoResultFailed) ? "FAILED" : "PASSED";
+    }
+
+    // How much work the zone memory allocator did during playback
+    const zonestats_t& zoneStats = gpMainMemZone->stats;
+
+    // Print the results
+    std::printf("Timedemo results:\n");
+    std::printf("  Renderer:            %s%s\n", getRendererName(), (ProgArgs::gbNoPresent) ? " (no present)" : "");
+    std::printf("  Total ticks:         %u\n", gNumTicks);
+    std::printf("  Total frames:        %u\n", (uint32_t) numFrames);
+    std::printf("  Total time:          %.3f ms\n", totalTimeMs);
+    std::printf("  Average frame time:  %.3f ms (%.1f FPS)\n", avgFrameTimeMs, avgFps);
+    std::printf("  Min frame time:      %.3f ms\n", (numFrames > 0) ? sortedTimes.front() : 0.0);
+    std::printf("  50th percentile:     %.3f ms\n", getPercentile(sortedTimes, 50.0));
+    std::printf("  90th percentile:     %.3f ms\n", getPercentile(sortedTimes, 90.0));
+    std::printf("  99th percentile:     %.3f ms\n", getPercentile(sortedTimes, 99.0));
+    std::printf("  Max frame time:      %.3f ms\n", (numFrames > 0) ? sortedTimes.back() : 0.0);
+    std::printf("  Zone allocs/frees:   %u / %u (%u purged)\n",
+        zoneStats.numMallocs - gStartZoneStats.numMallocs,
+        zoneStats.numFrees - gStartZoneStats.numFrees,
+        zoneStats.numPurges - gStartZoneStats.numPurges
+    );
+    std::printf("  Zone blocks visited: %llu\n", (unsigned long long)(zoneStats.numBlocksVisited - gStartZoneStats.numBlocksVisited));
+
+    #if PSYDOOM_LIMIT_REMOVING
+        std::printf("  Zone heap size:      %d KiB (peak %d KiB, %u chunks added, %u chunks released)\n",
+            gpMainMemZone->size / 1024,
+            gpMainMemZone->peakSize / 1024,
+            zoneStats.numChunksAdded - gStartZoneStats.numChunksAdded,
+            zoneStats.numChunksReleased - gStartZoneStats.numChunksReleased
+        );
+    #endif
+
+    // Print the average GPU time for each GPU timing scope measured during playback, if available (Vulkan renderer only)
+    #if PSYDOOM_VULKAN_RENDERER
+        if (VGpuTimings::isAvailable()) {
+            for (uint32_t scopeIdx = 0; scopeIdx < (uint32_t) VGpuTimings::Scope::NUM_SCOPES; ++scopeIdx) {
+                const VGpuTimings::Scope scope = (VGpuTimings::Scope) scopeIdx;
+                const char* const scopeName = VGpuTimings::getScopeName(scope);
+                uint32_t numScopeFrames = 0;
+                const double totalScopeTimeMs = VGpuTimings::getTotalTimeMs(scope, numScopeFrames);
+
+                if (numScopeFrames == 0)
+                    continue;
+
+                std::printf("  %s:%*s%.3f ms avg (%u frames)\n",
+                    scopeName,
+                    (int) std::max<size_t>(20 - std::strlen(scopeName), 1),
+                    "",
+                    totalScopeTimeMs / (double) numScopeFrames,
+                    numScopeFrames
+                );
+            }
+        }
+    #endif
+
+    std::printf("  Demo result check:   %s\n", demoCheckResult);
+    std::fflush(stdout);
+
+    // Free up memory used
+    gFrameTimesMs.clear();
+    gFrameTimesMs.shrink_to_fit();
+}
+
+END_NAMESPACE(TimeDemo)
@@ -0,0 +1,13 @@
+#pragma once
+
+#include "Macros.h"
+
+BEGIN_NAMESPACE(TimeDemo)
+
+bool isActive() noexcept;
+void onPlaybackStart() noexcept;
+void onTickInputsRead() noexcept;
+void onFrameDone() noexcept;
+void onPlaybackEnd() noexcept;
+
+END_NAMESPACE(TimeDemo)
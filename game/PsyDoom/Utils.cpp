@@ -13,6 +13,7 @@
 #include "PlayerPrefs.h"
 #include "ProgArgs.h"
 #include "PsxVm.h"
+#include "SpuStreaming.h"
 #include "Video.h"
 #include "Vulkan/VDrawing.h"
 #include "Vulkan/VRenderer.h"
@@ -22,11 +23,23 @@
 #include "Wess/wessapi.h"
 #include "Wess/wessseq.h"
 
+#include <algorithm>
 #include <chrono>
 #include <md5.h>
 #include <SDL.h>
 #include <thread>
 
+#if _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <Windows.h>
+
+    // Not defined by older Windows SDKs: this flag requires Windows 10 version 1803 or later
+    #ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+        #define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+    #endif
+#endif
+
 BEGIN_NAMESPACE(Utils)
 
 static constexpr const char* const SAVE_FILE_ORG        = "com.codelobster";    // Root folder to save config in (in a OS specific writable prefs location)
@@ -35,8 +48,16 @@ static constexpr const char* const SAVE_FILE_PRODUCT    = "PsyDoom";
 // Because typing this is a pain...
 typedef std::chrono::high_resolution_clock::time_point timepoint_t;
 
-// When we last did platform updates
+// When we last did platform updates, and when we last polled for input events
 static timepoint_t gLastPlatformUpdateTime = {};
+static timepoint_t gLastInputUpdateTime = {};
+
+// Windows: a high resolution waitable timer used for precise sleeps, and whether we tried to create it yet.
+// The timer is created on first use and lives until the app exits.
+#if _WIN32
+    static HANDLE   gHighResTimer = nullptr;
+    static bool     gbTriedCreatingHighResTimer = false;
+#endif
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Gets the game version string.
@@ -110,17 +131,25 @@ void doPlatformUpdates() noexcept {
         SeqEngine();
     }
 
-    // Only do these updates if enough time has elapsed.
-    // Do this to prevent excessive CPU usage in loops that are periodically trying to update sound etc. while waiting for some event.
+    // Poll for input events at up to 1 kHz, which is more often than the other platform updates.
+    // While waiting on frame pacing this keeps the time between an input event arriving and the game seeing it to around a millisecond.
+    // Note: this can't be done on a separate thread because SDL requires events to be pumped on the main (video) thread.
     const timepoint_t now = std::chrono::high_resolution_clock::now();
 
+    if (now - gLastInputUpdateTime >= std::chrono::milliseconds(1)) {
+        gLastInputUpdateTime = now;
+        Input::update();
+    }
+
+    // Only do these updates if enough time has elapsed.
+    // Do this to prevent excessive CPU usage in loops that are periodically trying to update sound etc. while waiting for some event.
     if (now - gLastPlatformUpdateTime < std::chrono::milliseconds(4))
         return;
 
     // Actually do the platform updates
     gLastPlatformUpdateTime = now;
     Network::doUpdates();
-    Input::update();
+    SpuStreaming::update();
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -231,6 +260,67 @@ void threadYield() noexcept {
     std::this_thread::yield();
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Puts the calling thread to sleep for the specified amount of time, using the most precise sleep that the OS offers.
+// Note that OS sleeps usually overshoot the requested time by a little, anywhere up to a millisecond or so.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void osSleep(const std::chrono::steady_clock::duration sleepTime) noexcept {
+    #if _WIN32
+        // Windows: regular sleeps are only as precise as the system timer interval, so try to use a high resolution waitable timer instead.
+        // If that is not available (older than Windows 10, version 1803) then fallback to a regular sleep. SDL raises the system timer
+        // resolution to 1 ms for the lifetime of the app, so regular sleeps are still reasonably precise.
+        if (!gbTriedCreatingHighResTimer) {
+            gHighResTimer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+            gbTriedCreatingHighResTimer = true;
+        }
+
+        if (gHighResTimer) {
+            // Note: a negative due time means a relative time, in 100 nanosecond units
+            const int64_t sleepTime100ns = std::chrono::duration_cast<std::chrono::nanoseconds>(sleepTime).count() / 100;
+            LARGE_INTEGER dueTime = {};
+            dueTime.QuadPart = -std::max<int64_t>(sleepTime100ns, 1);
+
+            if (SetWaitableTimer(gHighResTimer, &dueTime, 0, nullptr, nullptr, FALSE)) {
+                WaitForSingleObject(gHighResTimer, INFINITE);
+                return;
+            }
+        }
+    #endif
+
+    std::this_thread::sleep_for(sleepTime);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Waits until the specified time before returning.
+// Most of the wait is done using OS sleeps, which are cheap on the CPU but imprecise, and the last fraction of a millisecond is spent spinning
+// with thread yields so that the wait ends on time. In power saver mode there is no spinning: the thread just sleeps until the wake time,
+// which means less CPU usage but it might wake up a little late.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void sleepUntil(const std::chrono::steady_clock::time_point wakeTime, const bool bPowerSaver) noexcept {
+    // How long before the wake time to stop sleeping and start spinning: enough to cover the usual overshoot of an OS sleep
+    constexpr std::chrono::microseconds SPIN_TIME = std::chrono::microseconds(300);
+
+    while (true) {
+        const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+        if (now >= wakeTime)
+            return;
+
+        const std::chrono::steady_clock::duration timeLeft = wakeTime - now;
+
+        if (bPowerSaver) {
+            osSleep(timeLeft);
+            return;
+        }
+
+        if (timeLeft > SPIN_TIME) {
+            osSleep(timeLeft - SPIN_TIME);
+        } else {
+            threadYield();
+        }
+    }
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Does some setup for UI drawing if using the new Vulkan based renderer
 //------------------------------------------------------------------------------------------------------------------------------------------
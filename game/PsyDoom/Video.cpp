@@ -14,7 +14,9 @@
 #include "Vulkan/VRenderer.h"
 
 #include <algorithm>
+#include <chrono>
 #include <cstdint>
+#include <cstdio>
 #include <SDL.h>
 
 BEGIN_NAMESPACE(Video)
@@ -30,6 +32,10 @@ static VideoBackend_SDL gVideoBackend_SDL;
 // Pointer to the video backend implementation in use
 static IVideoBackend* gpVideoBackend;
 
+// When the program was launched (approximately: during static initialization) and whether the time to the first frame has been reported
+static const std::chrono::steady_clock::time_point  gLaunchTime = std::chrono::steady_clock::now();
+static bool                                         gbReportedFirstFrameTime;
+
 SDL_Window*     gpSdlWindow;    // The SDL window being used
 BackendType     gBackendType;   // Which type of video backend is in use
 int32_t         gTopOverscan;   // Sanitized config input: number of pixels to discard at the top of the screen in terms of the original 256x240 framebuffer
@@ -161,6 +167,20 @@ void initVideo() noexcept {
     gTopOverscan = std::clamp(Config::gTopOverscanPixels, 0, ORIG_DRAW_RES_Y / 2 - 1);
     gBotOverscan = std::clamp(Config::gBottomOverscanPixels, 0, ORIG_DRAW_RES_Y / 2 - 1);
 
+    // Offscreen Vulkan rendering: no window is created and the Vulkan renderer draws to offscreen images instead.
+    // Note: SDL video must still be initialized since it is what loads the Vulkan library. On machines without a display,
+    // the 'SDL_VIDEODRIVER' environment variable may need to be set to a driver that does not require one (e.g 'offscreen').
+    #if PSYDOOM_VULKAN_RENDERER
+        if (ProgArgs::gbVulkanOffscreen) {
+            if (gBackendType != BackendType::Vulkan) {
+                FatalErrors::raise("The '-vkoffscreen' switch requires the Vulkan renderer but it is disabled or not supported on this machine!");
+            }
+
+            gpVideoBackend->initRenderers(nullptr);
+            return;
+        }
+    #endif
+
     // Decide what display to use
     const uint8_t displayIndex = pickStartupDisplay();
 
@@ -219,9 +239,11 @@ void shutdownVideo() noexcept {
     if (ProgArgs::gbHeadlessMode)
         return;
 
-    // Turn off relative mouse mode and unhide the cursor
-    SDL_SetRelativeMouseMode(SDL_FALSE);
-    SDL_ShowCursor(SDL_ENABLE);
+    // Turn off relative mouse mode and unhide the cursor (if there is a window)
+    if (gpSdlWindow) {
+        SDL_SetRelativeMouseMode(SDL_FALSE);
+        SDL_ShowCursor(SDL_ENABLE);
+    }
 
     // Cleanup for the video backend
     if (gpVideoBackend) {
@@ -326,11 +348,25 @@ void getClassicFramebufferWindowRect(
 // Display the currently renderered PSX GPU frame to the screen; this is used by the classic renderer
 //------------------------------------------------------------------------------------------------------------------------------------------
 void displayFramebuffer() noexcept {
+    // Finish any deferred drawing to the framebuffer first
+    Gpu::flushDeferredDraws(PsxVm::gGpu);
+
     // Ignore call in headless mode otherwise handle and ensure the window is updated after we do the swap
     if (ProgArgs::gbHeadlessMode)
         return;
 
     gpVideoBackend->displayFramebuffer();
+
+    // Report how long it took from launch to get the first frame on screen, for judging startup times.
+    // This is only reported when benchmarking with '-timedemo' or '-soak', so as not to print on every launch.
+    const bool bBenchmarking = (ProgArgs::gbTimeDemo || (ProgArgs::gSoakSeconds > 0));
+
+    if (bBenchmarking && (!gbReportedFirstFrameTime)) {
+        gbReportedFirstFrameTime = true;
+        const double startupMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - gLaunchTime).count();
+        std::printf("PsyDoom: time from launch to first frame: %.1f ms\n", startupMs);
+    }
+
     Utils::doPlatformUpdates();
 }
 
@@ -3,6 +3,7 @@
 #include "Asserts.h"
 #include "Config/Config.h"
 #include "Gpu.h"
+#include "ProgArgs.h"
 #include "PsxVm.h"
 #include "Video.h"
 #include "VideoSurface_SDL.h"
@@ -21,6 +22,7 @@ VideoBackend_SDL::VideoBackend_SDL() noexcept
     , mpRenderer(nullptr)
     , mpFramebufferTexture(nullptr)
     , mpFramebufferPixels(nullptr)
+    , mFramebufferPitch(0)
 {
 }
 
@@ -57,7 +59,8 @@ void VideoBackend_SDL::initRenderers(SDL_Window* const pSdlWindow) noexcept {
 
     // Create the renderer and framebuffer texture
     mpSdlWindow = pSdlWindow;
-    const Uint32 vsyncFlag = (Config::gbEnableVSync) ? SDL_RENDERER_PRESENTVSYNC : 0;
+    const bool bBenchmarking = (ProgArgs::gbTimeDemo || (ProgArgs::gSoakSeconds > 0));
+    const Uint32 vsyncFlag = (Config::gbEnableVSync && (!bBenchmarking)) ? SDL_RENDERER_PRESENTVSYNC : 0;
     mpRenderer = SDL_CreateRenderer(pSdlWindow, -1, SDL_RENDERER_ACCELERATED | vsyncFlag);
 
     if (!mpRenderer) {
@@ -199,6 +202,10 @@ void VideoBackend_SDL::lockFramebufferTexture() noexcept {
     if (SDL_LockTexture(mpFramebufferTexture, nullptr, reinterpret_cast<void**>(&mpFramebufferPixels), &pitch) != 0) {
         FatalErrors::raise("Failed to lock the framebuffer texture for writing!");
     }
+
+    // Note: the rows of the locked texture may be padded, so they can't be assumed to be tightly packed
+    ASSERT((pitch >= (int) (ORIG_DRAW_RES_X * sizeof(uint32_t))) && (pitch % sizeof(uint32_t) == 0));
+    mFramebufferPitch = (uint32_t) pitch / sizeof(uint32_t);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -210,6 +217,7 @@ void VideoBackend_SDL::unlockFramebufferTexture() noexcept {
 
     SDL_UnlockTexture(mpFramebufferTexture);
     mpFramebufferPixels = nullptr;
+    mFramebufferPitch = 0;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -219,26 +227,27 @@ void VideoBackend_SDL::copyPsxToSdlFramebufferTexture() noexcept {
     // Sanity checks
     ASSERT(mpFramebufferPixels);
 
-    // Copy the framebuffer
+    // Copy the framebuffer, converting from XBGR1555 to ABGR8888 and writing straight into the locked texture.
+    // Note: the source and destination rows are held in local pointers of different types, so the compiler knows they can't alias and can
+    // convert many pixels at a time using SIMD instructions.
     Gpu::Core& gpu = PsxVm::gGpu;
-    const Gpu::Color16* const vramPixels = reinterpret_cast<const Gpu::Color16*>(gpu.pRam);
-    uint32_t* pDstPixel = mpFramebufferPixels;
+    ASSERT((uint32_t) gpu.displayAreaX + ORIG_DRAW_RES_X <= gpu.ramPixelW);
+
+    const uint16_t* pSrcRow = gpu.pRam + (gpu.displayAreaX + (uintptr_t) gpu.displayAreaY * gpu.ramPixelW);
+    uint32_t* pDstRow = mpFramebufferPixels;
 
     for (uint32_t y = 0; y < ORIG_DRAW_RES_Y; ++y) {
-        const Gpu::Color16* const rowPixels = vramPixels + ((intptr_t) y + gpu.displayAreaY) * gpu.ramPixelW;
-        const uint32_t xStart = (uint32_t) gpu.displayAreaX;
-        const uint32_t xEnd = xStart + ORIG_DRAW_RES_X;
-        ASSERT(xEnd <= gpu.ramPixelW);
-
-        // Note: don't bother doing multiple pixels at a time - compiler is smart and already optimizes this to use SIMD
-        for (uint32_t x = xStart; x < xEnd; ++x, ++pDstPixel) {
-            const Gpu::Color16 srcPixel = rowPixels[x];
-            const uint32_t r = (uint32_t) srcPixel.getR() << 3;
-            const uint32_t g = (uint32_t) srcPixel.getG() << 3;
-            const uint32_t b = (uint32_t) srcPixel.getB() << 3;
-
-            *pDstPixel = (0xFF000000 | (b << 16) | (g << 8 ) | (r << 0));
+        for (uint32_t x = 0; x < ORIG_DRAW_RES_X; ++x) {
+            const uint32_t srcPixel = pSrcRow[x];
+            const uint32_t r = ((srcPixel >>  0) & 0x1Fu) << 3;
+            const uint32_t g = ((srcPixel >>  5) & 0x1Fu) << 3;
+            const uint32_t b = ((srcPixel >> 10) & 0x1Fu) << 3;
+
+            pDstRow[x] = (0xFF000000u | (b << 16) | (g << 8) | (r << 0));
         }
+
+        pSrcRow += gpu.ramPixelW;
+        pDstRow += mFramebufferPitch;
     }
 }
 
@@ -47,6 +47,7 @@ private:
     SDL_Renderer*   mpRenderer;             // The SDL renderer used for blitting to the display
     SDL_Texture*    mpFramebufferTexture;   // A texture we populate for blitting to the display
     uint32_t*       mpFramebufferPixels;    // The pixels for framebuffer texture when locked for writing
+    uint32_t        mFramebufferPitch;      // The number of pixels between the start of each row in the locked framebuffer texture
 };
 
 END_NAMESPACE(Video)
@@ -6,6 +6,7 @@
 #include "CmdBufferRecorder.h"
 #include "LogicalDevice.h"
 #include "PhysicalDeviceSelection.h"
+#include "ProgArgs.h"
 #include "Swapchain.h"
 #include "VideoSurface_Vulkan.h"
 #include "VkFuncs.h"
@@ -99,8 +100,9 @@ uint32_t VideoBackend_Vulkan::getSdlWindowCreateFlags() noexcept {
 // Initializes the SDL renderer used by this backend
 //------------------------------------------------------------------------------------------------------------------------------------------
 void VideoBackend_Vulkan::initRenderers(SDL_Window* const pSdlWindow) noexcept {
-    // Save the SDL window for later use
-    ASSERT(pSdlWindow);
+    // Save the SDL window for later use.
+    // Note: there is no window when rendering offscreen.
+    ASSERT(pSdlWindow || ProgArgs::gbVulkanOffscreen);
     mpSdlWindow = pSdlWindow;
 
     // Initialize the game's core Vulkan renderer module and begin a frame
@@ -299,7 +301,7 @@ void VideoBackend_Vulkan::displayExternalSurface(
     // Finish up and wait for all rendering to complete so the surface can be used freely again without worrying about synchronization.
     // This is of course suboptimal, but this routine is used for things that don't need much performance.
     VRenderer::endFrame();
-    VRenderer::gDevice.waitUntilDeviceIdle();
+    VRenderer::waitUntilDeviceIdle();
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
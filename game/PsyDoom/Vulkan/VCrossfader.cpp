@@ -174,9 +174,7 @@ void doPreCrossfadeSetup() noexcept {
 // Does a crossfade for the specified duration given in original PSX vblanks
 //------------------------------------------------------------------------------------------------------------------------------------------
 void doCrossfade(const int32_t vblanksDuration) noexcept {
-    // Get the device to crossfade with
     ASSERT(gScreenQuad.isValid());
-    vgl::LogicalDevice& device = *gDescriptorPool.getDevice();
 
     // Prior to this being called the renderer should already be put into the crossfade render path, and crossfade textures determined
     ASSERT(&VRenderer::getActiveRenderPath() == &VRenderer::gRenderPath_Crossfade);
@@ -224,7 +222,7 @@ void doCrossfade(const int32_t vblanksDuration) noexcept {
     // We have to do this in case the framebuffers need to be resized after the crossfade is done, so the crossfade needs to be done with them at this point.
     VRenderer::setNextRenderPath(VRenderer::gRenderPath_Main);
     VRenderer::endFrame();
-    device.waitUntilDeviceIdle();
+    VRenderer::waitUntilDeviceIdle();
 
     // Go back to doing normal rendering
     VRenderer::beginFrame();
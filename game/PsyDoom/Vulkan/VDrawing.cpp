@@ -20,12 +20,15 @@
 #include "LogicalDevice.h"
 #include "Pipeline.h"
 #include "PsyDoom/Config/Config.h"
+#include "PsyDoom/FrameProfiler.h"
 #include "PsyDoom/Video.h"
 #include "VPipelines.h"
 #include "VRenderer.h"
 #include "VTypes.h"
 #include "VVertexBufferSet.h"
 
+#include <cstring>
+
 BEGIN_NAMESPACE(VDrawing)
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -35,7 +38,9 @@ BEGIN_NAMESPACE(VDrawing)
 enum class DrawCmdType : uint32_t {
     SetPipeline,        // Set the graphics pipeline to use: 1st arg is pipeline type, 2nd arg unused
     SetUniforms,        // Set the uniforms to use: 1st arg is index in the uniforms list
-    Draw                // A command to draw primitives: 1st arg is vertex count, 2nd arg is vertex offset
+    SetDrawDepth,       // Set the depth that geometry is drawn at: 1st arg is the bits of the float depth (or 'DRAW_DEPTH_DEFAULT'), 2nd arg unused
+    Draw,               // A command to draw primitives: 1st arg is vertex count, 2nd arg is vertex offset
+    DrawIndexedQuads    // A command to draw quads (4 vertices each) using the quad index buffer: 1st arg is quad count, 2nd arg is vertex offset
 };
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -47,6 +52,13 @@ struct DrawCmd {
     uint32_t        arg2;
 };
 
+// The maximum number of quads that can be drawn with a single indexed draw command.
+// This is limited by the number of vertices that 16-bit indexes can address.
+static constexpr uint32_t MAX_INDEXED_QUADS = 65536 / 4;
+
+// A draw depth which means geometry is drawn at whatever depth the transform matrix gives it, over the full '0-1' depth range
+static constexpr float DRAW_DEPTH_DEFAULT = -1.0f;
+
 // Ringbuffer index for the current frame being generated
 static uint32_t gCurRingbufferIdx;
 
@@ -58,15 +70,170 @@ static vgl::DescriptorSet*  gpDescriptorSet;
 // Vertex buffers: for the 'draw' subpass (VVertex_Draw)
 static VVertexBufferSet gVertexBuffers_Draw;
 
+// An index buffer which turns every group of 4 vertices into the 2 triangles of a quad, for up to 'MAX_INDEXED_QUADS' quads.
+// Used to draw quads with 4 vertices instead of 6, which saves on vertex memory and bandwidth.
+static vgl::Buffer gQuadIndexBuffer;
+
+// Whether the current draw batch consists of indexed quads rather than regular (non-indexed) primitives
+static bool gbCurBatchIsIndexedQuads;
+
 // The current pipeline being used by the 'draw' subpass; used to help avoid unneccessary pipeline switches
 static VPipelineType gCurDrawPipelineType;
 
+// The current depth that geometry is drawn at (see 'setDrawDepth') and whether world pipelines are being remapped to depth tested versions
+static float gCurDrawDepth = DRAW_DEPTH_DEFAULT;
+static bool gbWorldDepthTestEnabled;
+
 // Sets of uniforms for the current frame
 static std::vector<VShaderUniforms_Draw> gFrameUniforms;
 
 // Drawing commands for the current frame
 static std::vector<DrawCmd> gFrameDrawCmds;
 
+// If set then world triangles and quads added by the current thread go to this list instead of the vertex buffer, and pipeline switches
+// are ignored. This allows world geometry to be generated on multiple threads and then added to the vertex buffer later, in order.
+static thread_local std::vector<VVertex_Draw>* gpCapturedWorldVerts;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Allocates the specified number of vertices for regular (non-indexed) primitives from the 'draw' vertex buffer.
+// If the current draw batch consists of indexed quads then it is ended first, since the two can't be drawn with the same command.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static VVertex_Draw* allocDrawVerts(const uint32_t numVerts) noexcept {
+    if (gbCurBatchIsIndexedQuads) {
+        endCurrentDrawBatch();
+    }
+
+    return gVertexBuffers_Draw.allocVerts<VVertex_Draw>(numVerts);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Allocates the specified number of vertices for world geometry: from the vertex buffer, or from the capture list if capturing
+//------------------------------------------------------------------------------------------------------------------------------------------
+static VVertex_Draw* allocWorldVerts(const uint32_t numVerts) noexcept {
+    if (std::vector<VVertex_Draw>* const pCapturedVerts = gpCapturedWorldVerts) {
+        const size_t oldSize = pCapturedVerts->size();
+        pCapturedVerts->resize(oldSize + numVerts);
+        return pCapturedVerts->data() + oldSize;
+    }
+
+    return allocDrawVerts(numVerts);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Get how many vertices are consumed by each primitive count unit of the given draw command type
+//------------------------------------------------------------------------------------------------------------------------------------------
+static uint32_t getDrawCmdVertsPerUnit(const DrawCmdType type) noexcept {
+    return (type == DrawCmdType::DrawIndexedQuads) ? 4 : 1;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Conversion of a draw depth to and from the argument of a 'SetDrawDepth' command
+//------------------------------------------------------------------------------------------------------------------------------------------
+static uint32_t drawDepthToCmdArg(const float depth) noexcept {
+    uint32_t arg;
+    std::memcpy(&arg, &depth, sizeof(arg));
+    return arg;
+}
+
+static float cmdArgToDrawDepth(const uint32_t arg) noexcept {
+    float depth;
+    std::memcpy(&depth, &arg, sizeof(depth));
+    return depth;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Get the depth tested version of a world pipeline, for when world depth testing is enabled.
+// Pipelines without a depth tested version are returned unchanged.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static VPipelineType getDepthTestedPipeline(const VPipelineType type) noexcept {
+    switch (type) {
+        case VPipelineType::World_GeomMasked:           return VPipelineType::World_GeomMasked_DepthWrite;
+        case VPipelineType::World_GeomAlpha:            return VPipelineType::World_GeomAlpha_DepthTest;
+        case VPipelineType::World_SpriteMasked:         return VPipelineType::World_SpriteMasked_DepthTest;
+        case VPipelineType::World_SpriteAlpha:          return VPipelineType::World_SpriteAlpha_DepthTest;
+        case VPipelineType::World_SpriteAdditive:       return VPipelineType::World_SpriteAdditive_DepthTest;
+        case VPipelineType::World_SpriteSubtractive:    return VPipelineType::World_SpriteSubtractive_DepthTest;
+        case VPipelineType::World_Sky:                  return VPipelineType::World_Sky_DepthTest;
+
+        default:
+            return type;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Removes redundant state changes from the drawing commands for the current frame and merges draw batches where possible.
+//
+// Pipeline switches are only applied once something is actually drawn with the pipeline, so switching to a pipeline and back again without
+// drawing anything no longer costs anything. When that happens the draws before and after the switch reference consecutive ranges in the
+// vertex buffer, with the same pipeline bound, so they are merged into a single draw. This reduces the number of 'vkCmdDraw' calls.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void compactDrawCmds() noexcept {
+    const uint32_t NO_PIPELINE = UINT32_MAX;
+    uint32_t boundPipeline = NO_PIPELINE;       // Pipeline bound by the compacted commands so far
+    uint32_t pendingPipeline = NO_PIPELINE;     // Pipeline which should be bound before the next draw
+    uint32_t setDepth = drawDepthToCmdArg(DRAW_DEPTH_DEFAULT);      // Draw depth set by the compacted commands so far
+    uint32_t pendingDepth = setDepth;                               // Draw depth which should be set before the next draw
+    size_t numOutCmds = 0;
+
+    for (const DrawCmd& drawCmd : gFrameDrawCmds) {
+        switch (drawCmd.type) {
+            case DrawCmdType::SetPipeline: {
+                pendingPipeline = drawCmd.arg1;
+            }   break;
+
+            // Draw depth changes are applied lazily in the same way as pipeline switches
+            case DrawCmdType::SetDrawDepth: {
+                pendingDepth = drawCmd.arg1;
+            }   break;
+
+            // Note: uniforms are push constants, which are retained across pipeline switches since all draw pipeline layouts are compatible
+            case DrawCmdType::SetUniforms: {
+                gFrameDrawCmds[numOutCmds++] = drawCmd;
+            }   break;
+
+            case DrawCmdType::Draw:
+            case DrawCmdType::DrawIndexedQuads: {
+                // Bind the pipeline for the draw if it has changed
+                if (pendingPipeline != boundPipeline) {
+                    DrawCmd& setPipelineCmd = gFrameDrawCmds[numOutCmds++];
+                    setPipelineCmd.type = DrawCmdType::SetPipeline;
+                    setPipelineCmd.arg1 = pendingPipeline;
+                    setPipelineCmd.arg2 = 0;
+                    boundPipeline = pendingPipeline;
+                }
+
+                // Set the depth for the draw if it has changed
+                if (pendingDepth != setDepth) {
+                    DrawCmd& setDepthCmd = gFrameDrawCmds[numOutCmds++];
+                    setDepthCmd.type = DrawCmdType::SetDrawDepth;
+                    setDepthCmd.arg1 = pendingDepth;
+                    setDepthCmd.arg2 = 0;
+                    setDepth = pendingDepth;
+                }
+
+                // Extend the previous draw if it's the same type and directly precedes this one in the vertex buffer, otherwise add a new draw.
+                // Indexed quad draws can only be extended as far as the quad index buffer allows.
+                if (numOutCmds > 0) {
+                    DrawCmd& prevCmd = gFrameDrawCmds[numOutCmds - 1];
+                    const bool bIsQuads = (drawCmd.type == DrawCmdType::DrawIndexedQuads);
+                    const uint32_t prevEnd = prevCmd.arg2 + prevCmd.arg1 * getDrawCmdVertsPerUnit(drawCmd.type);
+
+                    if ((prevCmd.type == drawCmd.type) && (prevEnd == drawCmd.arg2)) {
+                        if ((!bIsQuads) || (prevCmd.arg1 + drawCmd.arg1 <= MAX_INDEXED_QUADS)) {
+                            prevCmd.arg1 += drawCmd.arg1;
+                            break;
+                        }
+                    }
+                }
+
+                gFrameDrawCmds[numOutCmds++] = drawCmd;
+            }   break;
+        }
+    }
+
+    gFrameDrawCmds.resize(numOutCmds);
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Records all drawing commands for the current frame to a Vulkan command buffer
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -88,8 +255,9 @@ static void recordCmdBuffer(vgl::CmdBufferRecorder& cmdRec) noexcept {
     cmdRec.setViewport((float) viewportXInt, (float) viewportYInt, (float) viewportWInt, (float) viewportHInt, 0.0f, 1.0f);
     cmdRec.setScissors(viewportXInt, viewportYInt, viewportWInt, viewportHInt);
 
-    // Bind the correct vertex buffer for drawing
+    // Bind the correct vertex buffer for drawing and the index buffer used for drawing quads
     cmdRec.bindVertexBuffer(*gVertexBuffers_Draw.pCurBuffer, 0, 0);
+    cmdRec.bindIndexBufferUint16(gQuadIndexBuffer, 0);
 
     // Clear this flag once we bind the drawing descriptor set - it only needs to be done once since all draw pipeline layouts are compatible
     bool bNeedToBindDescriptorSet = true;
@@ -120,9 +288,22 @@ static void recordCmdBuffer(vgl::CmdBufferRecorder& cmdRec) noexcept {
                 );
             }   break;
 
+            // Geometry is drawn at a fixed depth by collapsing the viewport depth range down to that depth
+            case DrawCmdType::SetDrawDepth: {
+                const float depth = cmdArgToDrawDepth(drawCmd.arg1);
+                const float minDepth = (depth == DRAW_DEPTH_DEFAULT) ? 0.0f : depth;
+                const float maxDepth = (depth == DRAW_DEPTH_DEFAULT) ? 1.0f : depth;
+                cmdRec.setViewport((float) viewportXInt, (float) viewportYInt, (float) viewportWInt, (float) viewportHInt, minDepth, maxDepth);
+            }   break;
+
             case DrawCmdType::Draw: {
                 cmdRec.draw(drawCmd.arg1, drawCmd.arg2);
             }   break;
+
+            case DrawCmdType::DrawIndexedQuads: {
+                ASSERT(drawCmd.arg1 <= MAX_INDEXED_QUADS);
+                cmdRec.drawIndexed(drawCmd.arg1 * 6, 0, drawCmd.arg2);
+            }   break;
         }
     }
 }
@@ -156,6 +337,41 @@ void init(vgl::LogicalDevice& device, vgl::BaseTexture& vramTex) noexcept {
     constexpr uint32_t DRAW_VB_SIZE = 4 * 1024 * 1024;
     gVertexBuffers_Draw.init<VVertex_Draw>(device, DRAW_VB_SIZE / sizeof(VVertex_Draw));
 
+    // Create the index buffer used for drawing quads and populate it: it never changes after this
+    {
+        constexpr uint32_t NUM_QUAD_INDEXES = MAX_INDEXED_QUADS * 6;
+
+        const bool bCreatedIndexBufferOk = gQuadIndexBuffer.initWithElementCount<uint16_t>(
+            device,
+            VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            vgl::BufferUsageMode::STATIC,
+            NUM_QUAD_INDEXES
+        );
+
+        if (!bCreatedIndexBufferOk)
+            FatalErrors::raise("VDrawing: Failed to create a required Vulkan index buffer!");
+
+        uint16_t* const pIndexes = gQuadIndexBuffer.lockElements<uint16_t>(0, NUM_QUAD_INDEXES);
+
+        if (!pIndexes)
+            FatalErrors::raise("VDrawing: Failed to lock a required Vulkan index buffer!");
+
+        // Note: same triangle order as 'addWorldQuad'
+        for (uint32_t quadIdx = 0; quadIdx < MAX_INDEXED_QUADS; ++quadIdx) {
+            uint16_t* const pQuadIndexes = pIndexes + quadIdx * 6;
+            const uint16_t firstVertIdx = (uint16_t)(quadIdx * 4);
+
+            pQuadIndexes[0] = firstVertIdx + 0;
+            pQuadIndexes[1] = firstVertIdx + 1;
+            pQuadIndexes[2] = firstVertIdx + 2;
+            pQuadIndexes[3] = firstVertIdx + 2;
+            pQuadIndexes[4] = firstVertIdx + 3;
+            pQuadIndexes[5] = firstVertIdx + 0;
+        }
+
+        gQuadIndexBuffer.unlockElements<uint16_t>(NUM_QUAD_INDEXES);
+    }
+
     // Current draw pipeline in use is undefined initially
     gCurDrawPipelineType = (VPipelineType) -1;
 
@@ -171,6 +387,8 @@ void shutdown() noexcept {
     gFrameDrawCmds.clear();
     gFrameUniforms.clear();
     gCurDrawPipelineType = {};
+    gbCurBatchIsIndexedQuads = false;
+    gQuadIndexBuffer.destroy(true);
     gVertexBuffers_Draw.destroy();
 
     if (gpDescriptorSet) {
@@ -197,8 +415,11 @@ void beginFrame(const uint32_t ringbufferIdx) noexcept {
 // Performs end of frame logic for the drawing module
 //------------------------------------------------------------------------------------------------------------------------------------------
 void endFrame(vgl::CmdBufferRecorder& cmdRec) noexcept {
-    // Finish the current draw batch then record all drawing commands in the Vulkan command buffer
+    PROFILE_SCOPE(VDrawingEndFrame);
+
+    // Finish the current draw batch, compact the drawing commands, then record them all in the Vulkan command buffer
     endCurrentDrawBatch();
+    compactDrawCmds();
     recordCmdBuffer(cmdRec);
 
     // Upload vertices generated during drawing, so the draw commands can use them
@@ -208,15 +429,25 @@ void endFrame(vgl::CmdBufferRecorder& cmdRec) noexcept {
     gFrameDrawCmds.clear();
     gFrameUniforms.clear();
     gCurDrawPipelineType = (VPipelineType) -1;
+    gCurDrawDepth = DRAW_DEPTH_DEFAULT;
+    gbWorldDepthTestEnabled = false;
+    gbCurBatchIsIndexedQuads = false;
     gCurRingbufferIdx = {};
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Set which pipeline is being used for the 'draw' subpass with lazy early out if there is no change
 //------------------------------------------------------------------------------------------------------------------------------------------
-void setDrawPipeline(const VPipelineType type) noexcept {
-    // Only switch pipelines if we need to
-    ASSERT((uint32_t) type < (uint32_t) VPipelineType::NUM_TYPES);
+void setDrawPipeline(const VPipelineType requestedType) noexcept {
+    // Vertices being captured are drawn with whatever pipeline is set when they are added; ignore the switch
+    ASSERT((uint32_t) requestedType < (uint32_t) VPipelineType::NUM_TYPES);
+
+    if (gpCapturedWorldVerts)
+        return;
+
+    // Use the depth tested version of world pipelines if world depth testing is enabled.
+    // Only switch pipelines if we need to.
+    const VPipelineType type = (gbWorldDepthTestEnabled) ? getDepthTestedPipeline(requestedType) : requestedType;
     const VPipelineType oldPipelineType = gCurDrawPipelineType;
 
     if (oldPipelineType == type)
@@ -232,6 +463,41 @@ void setDrawPipeline(const VPipelineType type) noexcept {
     drawCmd.arg1 = (uint32_t) type;
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Enables or disables drawing the world with depth tested pipelines; requires the main render path to have depth attachments.
+// While enabled, world pipelines set via 'setDrawPipeline' are switched to their depth tested versions. Note that the pipeline currently
+// set is not affected, so this should be called before setting the pipeline for the geometry about to be drawn.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void setWorldDepthTestEnabled(const bool bEnable) noexcept {
+    gbWorldDepthTestEnabled = bEnable;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Sets a fixed depth which all geometry submitted from now on is drawn at, regardless of the depth given by the transform matrix.
+// Used to make depth testing follow the drawing order of the world: each subsector is assigned it's own depth, front to back.
+// Pass a negative depth to go back to drawing geometry at the depth given by the transform matrix.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void setDrawDepth(const float depth) noexcept {
+    // Vertices being captured are drawn with whatever depth is set when they are added; ignore the change.
+    // Otherwise only change the depth if we need to.
+    if (gpCapturedWorldVerts)
+        return;
+
+    const float newDepth = (depth < 0.0f) ? DRAW_DEPTH_DEFAULT : depth;
+
+    if (newDepth == gCurDrawDepth)
+        return;
+
+    // Must end the current draw batch before changing the depth, since it affects all primitives drawn by the batch
+    endCurrentDrawBatch();
+    gCurDrawDepth = newDepth;
+
+    DrawCmd& drawCmd = gFrameDrawCmds.emplace_back();
+    drawCmd.type = DrawCmdType::SetDrawDepth;
+    drawCmd.arg1 = drawDepthToCmdArg(newDepth);
+    drawCmd.arg2 = 0;
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Set uniforms used by draw shaders, including the model/view/projection transform matrix
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -299,18 +565,60 @@ Matrix4f computeTransformMatrixFor3D(const float viewX, const float viewY, const
 // The primitives are drawn with whatever pipeline is currently bound.
 //------------------------------------------------------------------------------------------------------------------------------------------
 void endCurrentDrawBatch() noexcept {
-    // Ignore if there are no vertices in the current batch
+    // Ignore if there are no vertices in the current batch.
+    // The next batch will be regular (non-indexed) primitives unless specified otherwise.
+    const bool bIsIndexedQuads = gbCurBatchIsIndexedQuads;
+    gbCurBatchIsIndexedQuads = false;
+
     if (gVertexBuffers_Draw.curBatchSize <= 0)
         return;
 
     // Record the draw command
     DrawCmd& drawCmd = gFrameDrawCmds.emplace_back();
-    drawCmd.type = DrawCmdType::Draw;
-    drawCmd.arg1 = gVertexBuffers_Draw.curBatchSize;
+
+    if (bIsIndexedQuads) {
+        ASSERT(gVertexBuffers_Draw.curBatchSize % 4 == 0);
+        drawCmd.type = DrawCmdType::DrawIndexedQuads;
+        drawCmd.arg1 = gVertexBuffers_Draw.curBatchSize / 4;
+    } else {
+        drawCmd.type = DrawCmdType::Draw;
+        drawCmd.arg1 = gVertexBuffers_Draw.curBatchSize;
+    }
+
     drawCmd.arg2 = gVertexBuffers_Draw.curBatchStart;
     gVertexBuffers_Draw.endCurrentDrawBatch();
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Begins capturing vertices for world triangles and quads added by the calling thread to the given list.
+// While capturing, pipeline switches made by the calling thread are ignored; 'addWorldVerts' can be used to draw the vertices later.
+// This is safe to call from any thread, provided all the vertices are captured with the same pipeline in mind.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void beginWorldVertsCapture(std::vector<VVertex_Draw>& verts) noexcept {
+    ASSERT(!gpCapturedWorldVerts);
+    gpCapturedWorldVerts = &verts;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Ends capturing world vertices on the calling thread
+//------------------------------------------------------------------------------------------------------------------------------------------
+void endWorldVertsCapture() noexcept {
+    ASSERT(gpCapturedWorldVerts);
+    gpCapturedWorldVerts = nullptr;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Adds the given pre-built world vertices to the 'draw' subpass, as triangles.
+// Assumes the correct draw pipeline has been set beforehand.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void addWorldVerts(const VVertex_Draw* const pVerts, const uint32_t numVerts) noexcept {
+    ASSERT(numVerts % 3 == 0);
+
+    if (numVerts > 0) {
+        std::memcpy(allocDrawVerts(numVerts), pVerts, numVerts * sizeof(VVertex_Draw));
+    }
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Add a 2D/UI line to the 'draw' subpass
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -324,7 +632,7 @@ void addUILine(
     const uint8_t b
 ) noexcept {
     // Fill in the vertices, starting first with common parameters
-    VVertex_Draw* const pVerts = gVertexBuffers_Draw.allocVerts<VVertex_Draw>(2);
+    VVertex_Draw* const pVerts = allocDrawVerts(2);
 
     for (uint32_t i = 0; i < 2; ++i) {
         VVertex_Draw& vert = pVerts[i];
@@ -343,6 +651,18 @@ void addUILine(
     pVerts[1].x = x2;   pVerts[1].y = y2;
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Adds the given pre-built 2D/UI line vertices to the 'draw' subpass: 2 vertices per line.
+// Assumes the correct draw pipeline has been set beforehand.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void addUILines(const VVertex_Draw* const pVerts, const uint32_t numVerts) noexcept {
+    ASSERT(numVerts % 2 == 0);
+
+    if (numVerts > 0) {
+        std::memcpy(allocDrawVerts(numVerts), pVerts, numVerts * sizeof(VVertex_Draw));
+    }
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Add a flat colored triangle to the 'draw' subpass
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -360,7 +680,7 @@ void addFlatColoredTriangle(
     const uint8_t g,
     const uint8_t b
 ) noexcept {
-    VVertex_Draw* const pVerts = gVertexBuffers_Draw.allocVerts<VVertex_Draw>(3);
+    VVertex_Draw* const pVerts = allocDrawVerts(3);
 
     for (uint32_t i = 0; i < 3; ++i) {
         VVertex_Draw& vert = pVerts[i];
@@ -399,7 +719,7 @@ void addFlatColoredQuad(
     const uint8_t g,
     const uint8_t b
 ) noexcept {
-    VVertex_Draw* const pVerts = gVertexBuffers_Draw.allocVerts<VVertex_Draw>(6);
+    VVertex_Draw* const pVerts = allocDrawVerts(6);
 
     for (uint32_t i = 0; i < 6; ++i) {
         VVertex_Draw& vert = pVerts[i];
@@ -443,7 +763,7 @@ void addUISprite(
     const uint16_t texWinH
 ) noexcept {
     // Fill in the vertices, starting first with common parameters
-    VVertex_Draw* const pVerts = gVertexBuffers_Draw.allocVerts<VVertex_Draw>(6);
+    VVertex_Draw* const pVerts = allocDrawVerts(6);
 
     for (uint32_t i = 0; i < 6; ++i) {
         VVertex_Draw& vert = pVerts[i];
@@ -529,46 +849,48 @@ void addWorldTriangle(
     const uint8_t stMulB,
     const uint8_t stMulA
 ) noexcept {
-    // Fill in the vertices, starting first with common parameters
-    VVertex_Draw* const pVerts = gVertexBuffers_Draw.allocVerts<VVertex_Draw>(3);
-
-    for (uint32_t i = 0; i < 3; ++i) {
-        VVertex_Draw& vert = pVerts[i];
-        vert.r = r;
-        vert.g = g;
-        vert.b = b;
-        vert.texWinX = texWinX;
-        vert.texWinY = texWinY;
-        vert.texWinW = texWinW;
-        vert.texWinH = texWinH;
-        vert.clutX = clutX;
-        vert.clutY = clutY;
-        vert.stmulR = stMulR;
-        vert.stmulG = stMulG;
-        vert.stmulB = stMulB;
-        vert.stmulA = stMulA;
-        vert.lightDimMode = lightDimMode;
-    }
+    // Build the vertices locally first, starting with the parameters that are the same for all vertices.
+    // Each vertex is then written to the vertex buffer in one go and in order. The vertex buffer may be in uncached (write combined) memory
+    // which is slow to write to in a scattered fashion, so this is much faster than filling in the vertex buffer field by field.
+    VVertex_Draw verts[3];
+    verts[0].r = r;
+    verts[0].g = g;
+    verts[0].b = b;
+    verts[0].lightDimMode = lightDimMode;
+    verts[0].texWinX = texWinX;
+    verts[0].texWinY = texWinY;
+    verts[0].texWinW = texWinW;
+    verts[0].texWinH = texWinH;
+    verts[0].clutX = clutX;
+    verts[0].clutY = clutY;
+    verts[0].stmulR = stMulR;
+    verts[0].stmulG = stMulG;
+    verts[0].stmulB = stMulB;
+    verts[0].stmulA = stMulA;
+    verts[1] = verts[0];
+    verts[2] = verts[0];
 
     // Fill in verts xy and uv positions
-    pVerts[0].x = x1;   pVerts[0].y = y1;   pVerts[0].z = z1;
-    pVerts[1].x = x2;   pVerts[1].y = y2;   pVerts[1].z = z2;
-    pVerts[2].x = x3;   pVerts[2].y = y3;   pVerts[2].z = z3;
-
-    pVerts[0].u = u1;   pVerts[0].v = v1;
-    pVerts[1].u = u2;   pVerts[1].v = v2;
-    pVerts[2].u = u3;   pVerts[2].v = v3;
+    verts[0].x = x1;    verts[0].y = y1;    verts[0].z = z1;
+    verts[1].x = x2;    verts[1].y = y2;    verts[1].z = z2;
+    verts[2].x = x3;    verts[2].y = y3;    verts[2].z = z3;
+
+    verts[0].u = u1;    verts[0].v = v1;
+    verts[1].u = u2;    verts[1].v = v2;
+    verts[2].u = u3;    verts[2].v = v3;
+
+    // Write the vertices to the vertex buffer
+    VVertex_Draw* const pVerts = allocWorldVerts(3);
+    pVerts[0] = verts[0];
+    pVerts[1] = verts[1];
+    pVerts[2] = verts[2];
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Add a quadrilateral for the game's 3D view/world to the 'draw' subpass.
-// 
-// Notes:
-//  (1) The texture format is assumed to be 8 bits per pixel always.
-//  (2) All texture coordinates and texture sizes are in terms of 8-bit pixels (not VRAM 16-bit pixels).
-//  (3) The alpha component is only used if alpha blending is being used.
+// Builds the 4 unique vertices of a world quad, for 'addWorldQuad' and 'addWorldSpriteQuad'
 //------------------------------------------------------------------------------------------------------------------------------------------
-void addWorldQuad(
+static void buildWorldQuadVerts(
+    VVertex_Draw verts[4],
     const AddWorldQuadVert& v1,
     const AddWorldQuadVert& v2,
     const AddWorldQuadVert& v3,
@@ -585,23 +907,21 @@ void addWorldQuad(
     const uint8_t stMulB,
     const uint8_t stMulA
 ) noexcept {
-    // Fill in the vertices, starting first with the parameters that are the same for all vertices
-    VVertex_Draw* const pVerts = gVertexBuffers_Draw.allocVerts<VVertex_Draw>(6);
-
-    for (uint32_t i = 0; i < 6; ++i) {
-        VVertex_Draw& vert = pVerts[i];
-        vert.texWinX = texWinX;
-        vert.texWinY = texWinY;
-        vert.texWinW = texWinW;
-        vert.texWinH = texWinH;
-        vert.clutX = clutX;
-        vert.clutY = clutY;
-        vert.stmulR = stMulR;
-        vert.stmulG = stMulG;
-        vert.stmulB = stMulB;
-        vert.stmulA = stMulA;
-        vert.lightDimMode = lightDimMode;
-    }
+    // Start with the parameters that are the same for all vertices
+    verts[0].lightDimMode = lightDimMode;
+    verts[0].texWinX = texWinX;
+    verts[0].texWinY = texWinY;
+    verts[0].texWinW = texWinW;
+    verts[0].texWinH = texWinH;
+    verts[0].clutX = clutX;
+    verts[0].clutY = clutY;
+    verts[0].stmulR = stMulR;
+    verts[0].stmulG = stMulG;
+    verts[0].stmulB = stMulB;
+    verts[0].stmulA = stMulA;
+    verts[1] = verts[0];
+    verts[2] = verts[0];
+    verts[3] = verts[0];
 
     // Fill in the unique vertex attributes
     constexpr auto assignVertexUniqueAttribs = [](VVertex_Draw& dst, const AddWorldQuadVert& src) noexcept {
@@ -615,12 +935,95 @@ void addWorldQuad(
         dst.b = src.b;
     };
 
-    assignVertexUniqueAttribs(pVerts[0], v1);
-    assignVertexUniqueAttribs(pVerts[1], v2);
-    assignVertexUniqueAttribs(pVerts[2], v3);
-    assignVertexUniqueAttribs(pVerts[3], v3);
-    assignVertexUniqueAttribs(pVerts[4], v4);
-    assignVertexUniqueAttribs(pVerts[5], v1);
+    assignVertexUniqueAttribs(verts[0], v1);
+    assignVertexUniqueAttribs(verts[1], v2);
+    assignVertexUniqueAttribs(verts[2], v3);
+    assignVertexUniqueAttribs(verts[3], v4);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Add a quadrilateral for the game's 3D view/world to the 'draw' subpass.
+// 
+// Notes:
+//  (1) The texture format is assumed to be 8 bits per pixel always.
+//  (2) All texture coordinates and texture sizes are in terms of 8-bit pixels (not VRAM 16-bit pixels).
+//  (3) The alpha component is only used if alpha blending is being used.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void addWorldQuad(
+    const AddWorldQuadVert& v1,
+    const AddWorldQuadVert& v2,
+    const AddWorldQuadVert& v3,
+    const AddWorldQuadVert& v4,
+    const uint16_t clutX,
+    const uint16_t clutY,
+    const uint16_t texWinX,
+    const uint16_t texWinY,
+    const uint16_t texWinW,
+    const uint16_t texWinH,
+    const VLightDimMode lightDimMode,
+    const uint8_t stMulR,
+    const uint8_t stMulG,
+    const uint8_t stMulB,
+    const uint8_t stMulA
+) noexcept {
+    // Build the 4 unique vertices of the quad locally first.
+    // Each vertex is then written to the vertex buffer in one go and in order, for the same reasons as 'addWorldTriangle'.
+    VVertex_Draw verts[4];
+    buildWorldQuadVerts(verts, v1, v2, v3, v4, clutX, clutY, texWinX, texWinY, texWinW, texWinH, lightDimMode, stMulR, stMulG, stMulB, stMulA);
+
+    // Write the two triangles of the quad to the vertex buffer
+    VVertex_Draw* const pVerts = allocWorldVerts(6);
+    pVerts[0] = verts[0];
+    pVerts[1] = verts[1];
+    pVerts[2] = verts[2];
+    pVerts[3] = verts[2];
+    pVerts[4] = verts[3];
+    pVerts[5] = verts[0];
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Same as 'addWorldQuad' but the quad is drawn using the quad index buffer, so only it's 4 unique vertices are written.
+// This is intended for sprites, which are drawn in long runs of quads with nothing else in between; mixing indexed quads with other
+// primitives in the same pipeline will cause the draw batch to be split, hence normal world geometry should use 'addWorldQuad'.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void addWorldSpriteQuad(
+    const AddWorldQuadVert& v1,
+    const AddWorldQuadVert& v2,
+    const AddWorldQuadVert& v3,
+    const AddWorldQuadVert& v4,
+    const uint16_t clutX,
+    const uint16_t clutY,
+    const uint16_t texWinX,
+    const uint16_t texWinY,
+    const uint16_t texWinW,
+    const uint16_t texWinH,
+    const VLightDimMode lightDimMode,
+    const uint8_t stMulR,
+    const uint8_t stMulG,
+    const uint8_t stMulB,
+    const uint8_t stMulA
+) noexcept {
+    // Captured vertices are always drawn as regular triangles
+    if (gpCapturedWorldVerts) {
+        addWorldQuad(v1, v2, v3, v4, clutX, clutY, texWinX, texWinY, texWinW, texWinH, lightDimMode, stMulR, stMulG, stMulB, stMulA);
+        return;
+    }
+
+    // Start a new batch of indexed quads if we are not in one already, or if the quad index buffer can't address any more quads
+    if ((!gbCurBatchIsIndexedQuads) || (gVertexBuffers_Draw.curBatchSize >= MAX_INDEXED_QUADS * 4)) {
+        endCurrentDrawBatch();
+        gbCurBatchIsIndexedQuads = true;
+    }
+
+    // Build the vertices locally and write them in order to the vertex buffer
+    VVertex_Draw verts[4];
+    buildWorldQuadVerts(verts, v1, v2, v3, v4, clutX, clutY, texWinX, texWinY, texWinW, texWinH, lightDimMode, stMulR, stMulG, stMulB, stMulA);
+
+    VVertex_Draw* const pVerts = gVertexBuffers_Draw.allocVerts<VVertex_Draw>(4);
+    pVerts[0] = verts[0];
+    pVerts[1] = verts[1];
+    pVerts[2] = verts[2];
+    pVerts[3] = verts[3];
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -645,7 +1048,7 @@ void addWorldInfiniteSkyWall(
 ) noexcept {
     // Fill in the vertices, starting first with common parameters.
     // Note: we store the sky U offset based on player rotation in the U coordinate.
-    VVertex_Draw* const pVerts = gVertexBuffers_Draw.allocVerts<VVertex_Draw>(6);
+    VVertex_Draw* const pVerts = allocDrawVerts(6);
 
     for (uint32_t i = 0; i < 6; ++i) {
         VVertex_Draw& vert = pVerts[i];
@@ -723,7 +1126,7 @@ void addWorldSkyQuad(
 ) noexcept {
     // Fill in the vertices, starting first with common parameters.
     // Note: we store the sky U offset based on player rotation in the U coordinate.
-    VVertex_Draw* const pVerts = gVertexBuffers_Draw.allocVerts<VVertex_Draw>(6);
+    VVertex_Draw* const pVerts = allocDrawVerts(6);
 
     for (uint32_t i = 0; i < 6; ++i) {
         VVertex_Draw& vert = pVerts[i];
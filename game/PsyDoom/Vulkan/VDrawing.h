@@ -6,6 +6,7 @@
 #include "Matrix4.h"
 
 #include <cstdint>
+#include <vector>
 
 namespace vgl {
     class BaseRenderPass;
@@ -24,6 +25,7 @@ enum class VLightDimMode : uint8_t;
 enum class VPipelineType : uint8_t;
 enum class VPipelineType : uint8_t;
 struct VShaderUniforms_Draw;
+struct VVertex_Draw;
 
 BEGIN_NAMESPACE(VDrawing)
 
@@ -38,11 +40,16 @@ void init(vgl::LogicalDevice& device, vgl::BaseTexture& vramTex) noexcept;
 void shutdown() noexcept;
 void beginFrame(const uint32_t ringbufferIdx) noexcept;
 void endFrame(vgl::CmdBufferRecorder& cmdRec) noexcept;
-void setDrawPipeline(const VPipelineType type) noexcept;
+void setDrawPipeline(const VPipelineType requestedType) noexcept;
+void setWorldDepthTestEnabled(const bool bEnable) noexcept;
+void setDrawDepth(const float depth) noexcept;
 void setDrawUniforms(const VShaderUniforms_Draw& uniforms) noexcept;
 Matrix4f computeTransformMatrixForUI(const bool bAllowWidescreen) noexcept;
 Matrix4f computeTransformMatrixFor3D(const float viewX, const float viewY, const float viewZ, const float viewAngle) noexcept;
 void endCurrentDrawBatch() noexcept;
+void beginWorldVertsCapture(std::vector<VVertex_Draw>& verts) noexcept;
+void endWorldVertsCapture() noexcept;
+void addWorldVerts(const VVertex_Draw* const pVerts, const uint32_t numVerts) noexcept;
 
 void addUILine(
     const float x1,
@@ -54,6 +61,8 @@ void addUILine(
     const uint8_t b
 ) noexcept;
 
+void addUILines(const VVertex_Draw* const pVerts, const uint32_t numVerts) noexcept;
+
 void addFlatColoredTriangle(
     const float x1,
     const float y1,
@@ -156,6 +165,24 @@ void addWorldQuad(
     const uint8_t stMulA
 ) noexcept;
 
+void addWorldSpriteQuad(
+    const AddWorldQuadVert& v1,
+    const AddWorldQuadVert& v2,
+    const AddWorldQuadVert& v3,
+    const AddWorldQuadVert& v4,
+    const uint16_t clutX,
+    const uint16_t clutY,
+    const uint16_t texWinX,
+    const uint16_t texWinY,
+    const uint16_t texWinW,
+    const uint16_t texWinH,
+    const VLightDimMode lightDimMode,
+    const uint8_t stMulR,
+    const uint8_t stMulG,
+    const uint8_t stMulB,
+    const uint8_t stMulA
+) noexcept;
+
 void addWorldInfiniteSkyWall(
     const float x1,
     const float z1,
@@ -0,0 +1,173 @@
+//------------------------------------------------------------------------------------------------------------------------------------------
+// This module implements dynamic resolution scaling for the Vulkan renderer.
+// It is fed the measured GPU time for each frame and adjusts a scale applied to the render resolution, to try and keep the GPU frame time
+// at or below the target set by the user. The framebuffers are recreated at the new size whenever the scale changes, and the rendered
+// frame is then stretched to fit the display on output.
+//
+// To avoid constantly recreating framebuffers and visible 'pumping' of the resolution, the scale is quantized into fixed steps and only
+// changed after averaging the frame time over a number of frames. Reducing the scale happens as soon as the target is exceeded, but the
+// scale is only increased after the GPU has had plenty of headroom for a while, and if the predicted cost at the higher scale still fits.
+//------------------------------------------------------------------------------------------------------------------------------------------
+#include "VDynamicRes.h"
+
+#if PSYDOOM_VULKAN_RENDERER
+
+#include "PsyDoom/Config/Config.h"
+
+#include <algorithm>
+#include <cmath>
+
+BEGIN_NAMESPACE(VDynamicRes)
+
+// How much the render scale changes by in each step, and the absolute limits on the scale
+static constexpr float SCALE_STEP = 0.05f;
+static constexpr float ABS_MIN_SCALE = 0.25f;
+static constexpr float ABS_MAX_SCALE = 2.0f;
+
+// How many frame time samples are averaged before deciding whether to change the scale
+static constexpr uint32_t SAMPLES_PER_DECISION = 16;
+
+// How many frame time samples to ignore after a scale change.
+// Frames already in flight were rendered at the old scale and the first frames after framebuffer recreation tend to be slow.
+static constexpr uint32_t NUM_SAMPLES_TO_SKIP_AFTER_CHANGE = 4;
+
+// How many consecutive decisions must show the GPU has headroom before increasing the scale
+static constexpr uint32_t NUM_DECISIONS_BEFORE_SCALE_UP = 4;
+
+// Increase the scale only if the average frame time is below this fraction of the target, and if the predicted frame time at the new
+// scale is below the 2nd fraction of the target. Decreases aim for the 2nd fraction also, to leave some headroom.
+static constexpr double SCALE_UP_THRESHOLD = 0.8;
+static constexpr double TARGET_HEADROOM = 0.9;
+
+static float        gRenderScale = 1.0f;        // The current scale to apply to the render resolution
+static double       gSampleTotalMs;             // Sum of all frame time samples for the current decision
+static uint32_t     gNumSamples;                // Number of frame time samples for the current decision
+static uint32_t     gNumSamplesToSkip;          // How many more frame time samples to ignore (following a scale change)
+static uint32_t     gNumScaleUpDecisions;       // How many consecutive decisions found the GPU to have enough headroom to scale up
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Get the min and max scale allowed by the user's config, quantized to the scale step
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void getScaleLimits(float& minScale, float& maxScale) noexcept {
+    minScale = std::clamp(std::ceil(Config::gVulkanDynamicResMinScale / SCALE_STEP) * SCALE_STEP, ABS_MIN_SCALE, 1.0f);
+    maxScale = std::clamp(std::floor(Config::gVulkanDynamicResMaxScale / SCALE_STEP) * SCALE_STEP, minScale, ABS_MAX_SCALE);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Clears all accumulated frame time samples
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void clearSamples() noexcept {
+    gSampleTotalMs = 0.0;
+    gNumSamples = 0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Changes the render scale to the specified value and waits a while before gathering samples at the new scale
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void changeScale(const float newScale) noexcept {
+    gRenderScale = newScale;
+    gNumSamplesToSkip = NUM_SAMPLES_TO_SKIP_AFTER_CHANGE;
+    gNumScaleUpDecisions = 0;
+    clearSamples();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Decides whether to change the render scale based on the average GPU frame time gathered
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void decideScale(const double avgFrameTimeMs) noexcept {
+    float minScale, maxScale;
+    getScaleLimits(minScale, maxScale);
+    const double targetMs = Config::gVulkanDynamicResTargetMs;
+
+    // If the limits changed so that the current scale is outside of them then just clamp and wait for more samples
+    const float clampedScale = std::clamp(gRenderScale, minScale, maxScale);
+
+    if (clampedScale != gRenderScale) {
+        changeScale(clampedScale);
+        return;
+    }
+
+    // Over budget? Assume GPU cost is proportional to the number of pixels drawn and estimate the scale required to fit the target.
+    // Always drop by at least one step, so that we don't get stuck over budget when the cost doesn't scale with resolution as expected.
+    if (avgFrameTimeMs > targetMs) {
+        gNumScaleUpDecisions = 0;
+
+        if (gRenderScale > minScale) {
+            const double idealScale = gRenderScale * std::sqrt((targetMs * TARGET_HEADROOM) / avgFrameTimeMs);
+            const float steppedScale = std::floor((float) idealScale / SCALE_STEP) * SCALE_STEP;
+            changeScale(std::clamp(std::min(steppedScale, gRenderScale - SCALE_STEP), minScale, maxScale));
+        }
+
+        return;
+    }
+
+    // Plenty of headroom? Go up one step at a time, only after this has been the case for a while and if the next step should fit.
+    if ((avgFrameTimeMs < targetMs * SCALE_UP_THRESHOLD) && (gRenderScale < maxScale)) {
+        const float nextScale = std::min(gRenderScale + SCALE_STEP, maxScale);
+        const double scaleRatio = (double) nextScale / (double) gRenderScale;
+        const double predictedMs = avgFrameTimeMs * scaleRatio * scaleRatio;
+
+        if (predictedMs < targetMs * TARGET_HEADROOM) {
+            gNumScaleUpDecisions++;
+
+            if (gNumScaleUpDecisions >= NUM_DECISIONS_BEFORE_SCALE_UP) {
+                changeScale(nextScale);
+            }
+
+            return;
+        }
+    }
+
+    gNumScaleUpDecisions = 0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Resets dynamic resolution scaling back to the default scale and discards all previously gathered frame time samples.
+// Should be called when the renderer is (re)initialized or when GPU frame time measurements are interrupted.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void reset() noexcept {
+    gRenderScale = 1.0f;
+    gNumSamplesToSkip = 0;
+    gNumScaleUpDecisions = 0;
+    clearSamples();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tells if dynamic resolution scaling is enabled by the user's config
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool isEnabled() noexcept {
+    return (Config::gVulkanDynamicResTargetMs > 0.0f);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Feeds the measured GPU time for a frame into the dynamic resolution controller, which may update the render scale as a result
+//------------------------------------------------------------------------------------------------------------------------------------------
+void addGpuFrameTimeSample(const double frameTimeMs) noexcept {
+    if (!isEnabled())
+        return;
+
+    if (gNumSamplesToSkip > 0) {
+        gNumSamplesToSkip--;
+        return;
+    }
+
+    gSampleTotalMs += frameTimeMs;
+    gNumSamples++;
+
+    if (gNumSamples >= SAMPLES_PER_DECISION) {
+        const double avgFrameTimeMs = gSampleTotalMs / (double) gNumSamples;
+        clearSamples();
+        decideScale(avgFrameTimeMs);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Returns the scale to apply to the width and height of the render resolution; always '1.0' if dynamic resolution is disabled
+//------------------------------------------------------------------------------------------------------------------------------------------
+float getRenderScale() noexcept {
+    return (isEnabled()) ? gRenderScale : 1.0f;
+}
+
+END_NAMESPACE(VDynamicRes)
+
+#endif  // #if PSYDOOM_VULKAN_RENDERER
@@ -0,0 +1,16 @@
+#pragma once
+
+#if PSYDOOM_VULKAN_RENDERER
+
+#include "Macros.h"
+
+BEGIN_NAMESPACE(VDynamicRes)
+
+void reset() noexcept;
+bool isEnabled() noexcept;
+void addGpuFrameTimeSample(const double frameTimeMs) noexcept;
+float getRenderScale() noexcept;
+
+END_NAMESPACE(VDynamicRes)
+
+#endif  // #if PSYDOOM_VULKAN_RENDERER
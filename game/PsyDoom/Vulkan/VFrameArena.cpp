@@ -0,0 +1,128 @@
+//------------------------------------------------------------------------------------------------------------------------------------------
+// A linear 'bump' allocator for short-lived data which only needs to exist for the duration of one frame.
+//
+// The Vulkan world renderer builds various temporary lists every frame (draw subsectors, occlusion ranges, sprite fragments and so on).
+// Allocating these from the arena means that they never need to go to the heap once the arena has grown big enough for a typical frame.
+// The arena is reset at the start of each frame. If more than one chunk of memory was needed during the last frame then all chunks are
+// replaced by a single chunk big enough to hold everything, so that in the steady state the arena makes no heap allocations at all.
+//
+// Note: the arena is NOT thread safe and is only intended to be used from the main thread.
+//------------------------------------------------------------------------------------------------------------------------------------------
+#include "VFrameArena.h"
+
+#if PSYDOOM_VULKAN_RENDERER
+
+#include "Asserts.h"
+
+#include <algorithm>
+#include <memory>
+
+BEGIN_NAMESPACE(VFrameArena)
+
+// The minimum size of a chunk of memory allocated by the arena
+static constexpr size_t MIN_CHUNK_SIZE = 1024 * 1024;
+
+// A chunk of memory used by the arena
+struct Chunk {
+    std::unique_ptr<std::byte[]>    pMem;
+    size_t                          size;
+};
+
+static std::vector<Chunk>   gChunks;                // The chunks owned by the arena: allocations are made from the last chunk
+static size_t               gCurChunkUsedBytes;     // How many bytes of the current (last) chunk are in use
+static ArenaStats           gCurFrameStats;         // Stats for the current frame
+static ArenaStats           gLastFrameStats;        // Stats for the previous frame
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Adds a new chunk of at least the specified size to the arena and makes it the current chunk
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void addChunk(const size_t minSize) noexcept {
+    const size_t chunkSize = std::max(minSize, MIN_CHUNK_SIZE);
+
+    Chunk& chunk = gChunks.emplace_back();
+    chunk.pMem.reset(new std::byte[chunkSize]);
+    chunk.size = chunkSize;
+    gCurChunkUsedBytes = 0;
+
+    gCurFrameStats.numHeapAllocs++;
+    gCurFrameStats.capacityBytes += chunkSize;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tries to allocate the specified number of bytes from the current chunk, returning 'nullptr' if there is not enough room
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void* tryAllocFromCurChunk(const size_t size, const size_t alignment) noexcept {
+    if (gChunks.empty())
+        return nullptr;
+
+    const Chunk& chunk = gChunks.back();
+    const uintptr_t chunkAddr = (uintptr_t) chunk.pMem.get();
+    const uintptr_t allocAddr = (chunkAddr + gCurChunkUsedBytes + (alignment - 1)) & ~(uintptr_t)(alignment - 1);
+    const size_t allocEndOffset = (size_t)(allocAddr - chunkAddr) + size;
+
+    if (allocEndOffset > chunk.size)
+        return nullptr;
+
+    gCurFrameStats.numAllocs++;
+    gCurFrameStats.usedBytes += allocEndOffset - gCurChunkUsedBytes;
+    gCurChunkUsedBytes = allocEndOffset;
+    return (void*) allocAddr;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Allocates the specified number of bytes from the arena with the given alignment, which must be a power of two.
+// The memory is valid until the arena is next reset, which happens at the start of each frame.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void* alloc(const size_t size, const size_t alignment) noexcept {
+    ASSERT((alignment > 0) && ((alignment & (alignment - 1)) == 0));
+
+    if (void* const pAlloc = tryAllocFromCurChunk(size, alignment))
+        return pAlloc;
+
+    // Not enough room: add a new chunk big enough for the allocation, which also at least doubles the capacity of the arena
+    addChunk(std::max(size + alignment, gCurFrameStats.capacityBytes));
+    void* const pAlloc = tryAllocFromCurChunk(size, alignment);
+    ASSERT(pAlloc);
+    return pAlloc;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Frees all allocations made from the arena: must be called at the start of each frame.
+// Consolidates all chunks into one if more than one chunk was needed for the last frame.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void reset() noexcept {
+    gLastFrameStats = gCurFrameStats;
+    gCurFrameStats = {};
+
+    if (gChunks.size() > 1) {
+        const size_t totalSize = gLastFrameStats.capacityBytes;
+        gChunks.clear();
+        addChunk(totalSize);
+    } else {
+        gCurFrameStats.capacityBytes = gLastFrameStats.capacityBytes;
+    }
+
+    gCurChunkUsedBytes = 0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Frees all memory owned by the arena
+//------------------------------------------------------------------------------------------------------------------------------------------
+void destroy() noexcept {
+    gChunks.clear();
+    gChunks.shrink_to_fit();
+    gCurChunkUsedBytes = 0;
+    gCurFrameStats = {};
+    gLastFrameStats = {};
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Returns the usage statistics for the arena for the last completed frame
+//------------------------------------------------------------------------------------------------------------------------------------------
+const ArenaStats& getLastFrameStats() noexcept {
+    return gLastFrameStats;
+}
+
+END_NAMESPACE(VFrameArena)
+
+#endif  // #if PSYDOOM_VULKAN_RENDERER
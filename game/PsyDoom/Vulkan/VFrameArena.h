@@ -0,0 +1,74 @@
+#pragma once
+
+#if PSYDOOM_VULKAN_RENDERER
+
+#include "Macros.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+BEGIN_NAMESPACE(VFrameArena)
+
+// Usage statistics for the arena over the course of one frame
+struct ArenaStats {
+    uint32_t    numHeapAllocs;      // How many times the arena had to go to the heap for more memory
+    uint32_t    numAllocs;          // How many allocations were made from the arena
+    size_t      usedBytes;          // How many bytes were allocated from the arena (including alignment padding)
+    size_t      capacityBytes;      // Total size of all the memory owned by the arena
+};
+
+void* alloc(const size_t size, const size_t alignment) noexcept;
+void reset() noexcept;
+void destroy() noexcept;
+const ArenaStats& getLastFrameStats() noexcept;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// STL allocator which allocates from the frame arena.
+// Freeing memory does nothing: all memory is reclaimed at once when the arena is reset at the start of the next frame.
+//------------------------------------------------------------------------------------------------------------------------------------------
+template <class T>
+struct FrameAllocator {
+    typedef T               value_type;
+    typedef std::true_type  is_always_equal;
+    typedef std::true_type  propagate_on_container_move_assignment;
+
+    inline FrameAllocator() noexcept = default;
+
+    template <class U>
+    inline FrameAllocator([[maybe_unused]] const FrameAllocator<U>& other) noexcept {}
+
+    inline T* allocate(const size_t count) noexcept {
+        return (T*) alloc(count * sizeof(T), alignof(T));
+    }
+
+    inline void deallocate([[maybe_unused]] T* const ptr, [[maybe_unused]] const size_t count) noexcept {}
+
+    template <class U>
+    inline bool operator == ([[maybe_unused]] const FrameAllocator<U>& other) const noexcept { return true; }
+
+    template <class U>
+    inline bool operator != ([[maybe_unused]] const FrameAllocator<U>& other) const noexcept { return false; }
+};
+
+// A vector whose memory comes from the frame arena
+template <class T>
+using FrameVector = std::vector<T, FrameAllocator<T>>;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Empties a frame vector and drops its memory without touching it, so that the vector can be used for the current frame.
+//
+// IMPORTANT: this MUST be done before a frame vector is first used in a frame, since its memory may be reused after the arena is reset.
+// Calling 'clear()' is not enough because the vector would keep its old memory.
+//------------------------------------------------------------------------------------------------------------------------------------------
+template <class T>
+inline void resetVector(FrameVector<T>& vec) noexcept {
+    // Element destructors must not touch the old memory when the vector is released, since it might now belong to something else
+    static_assert(std::is_trivially_destructible_v<T>);
+    FrameVector<T>().swap(vec);
+}
+
+END_NAMESPACE(VFrameArena)
+
+#endif  // #if PSYDOOM_VULKAN_RENDERER
@@ -0,0 +1,227 @@
+//------------------------------------------------------------------------------------------------------------------------------------------
+// This module reads back rendered frames from the GPU when the Vulkan renderer is drawing offscreen ('-vkoffscreen' switch).
+// Every N'th frame is copied from the offscreen swapchain image to a host visible buffer and then saved as a .ppm image file, which is a
+// trivially simple format that image comparison tools can read. This is intended for automated image regression tests and benchmarks.
+//
+// The copy is recorded into the frame's own command buffer and there is one readback buffer per ringbuffer slot. The buffer for a slot is
+// saved once the renderer has waited on that slot's fence (the next time the slot is used) so reading back never stalls the GPU.
+//------------------------------------------------------------------------------------------------------------------------------------------
+#include "VFrameReadback.h"
+
+#if PSYDOOM_VULKAN_RENDERER
+
+#include "Asserts.h"
+#include "CmdBufferRecorder.h"
+#include "DeviceMemAlloc.h"
+#include "LogicalDevice.h"
+#include "PsyDoom/ProgArgs.h"
+#include "RawBuffer.h"
+#include "RingbufferMgr.h"
+#include "Swapchain.h"
+
+#include <cstdio>
+#include <vector>
+
+BEGIN_NAMESPACE(VFrameReadback)
+
+// A pending or previously used readback for a ringbuffer slot
+struct Readback {
+    vgl::RawBuffer  buffer;         // Host visible buffer that the frame is copied to
+    bool            bPending;       // True if a frame was copied to the buffer and hasn't been saved yet
+    uint32_t        frameNum;       // Which frame was copied, used to name the saved image
+    uint32_t        width;          // Size of the frame copied
+    uint32_t        height;
+    bool            bIsBgra;        // True if the pixels are in BGRA order rather than RGBA
+};
+
+static vgl::LogicalDevice*  gpDevice;                                       // The device to read back from, null if readback is disabled
+static Readback             gReadbacks[vgl::Defines::RINGBUFFER_SIZE];      // The readback for each ringbuffer slot
+static uint32_t             gNumFramesRendered;                             // How many frames have been rendered so far
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Saves the frame held by the given readback to a .ppm file in the readback directory
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void saveReadback(Readback& readback) noexcept {
+    ASSERT(readback.bPending);
+    readback.bPending = false;
+
+    // Open the output file
+    char filePath[1024];
+    std::snprintf(filePath, sizeof(filePath), "%s/frame_%06u.ppm", ProgArgs::gVkReadbackDir, readback.frameNum);
+    std::FILE* const pFile = std::fopen(filePath, "wb");
+
+    if (!pFile) {
+        std::printf("VFrameReadback: failed to open '%s' for writing!\n", filePath);
+        return;
+    }
+
+    // Convert the pixels to 24-bit RGB, one row at a time, and write them out with the header
+    const uint32_t width = readback.width;
+    const uint32_t height = readback.height;
+    const std::byte* pSrcPixels = readback.buffer.getBytes();
+    const uint32_t rIdx = (readback.bIsBgra) ? 2 : 0;
+    const uint32_t bIdx = (readback.bIsBgra) ? 0 : 2;
+
+    std::vector<uint8_t> rowPixels((size_t) width * 3);
+    std::fprintf(pFile, "P6\n%u %u\n255\n", width, height);
+
+    for (uint32_t y = 0; y < height; ++y) {
+        uint8_t* pDstPixels = rowPixels.data();
+
+        for (uint32_t x = 0; x < width; ++x, pSrcPixels += 4, pDstPixels += 3) {
+            pDstPixels[0] = (uint8_t) pSrcPixels[rIdx];
+            pDstPixels[1] = (uint8_t) pSrcPixels[1];
+            pDstPixels[2] = (uint8_t) pSrcPixels[bIdx];
+        }
+
+        std::fwrite(rowPixels.data(), 1, rowPixels.size(), pFile);
+    }
+
+    std::fclose(pFile);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Initializes frame readback using the given device if it has been requested via program arguments
+//------------------------------------------------------------------------------------------------------------------------------------------
+void init(vgl::LogicalDevice& device) noexcept {
+    gNumFramesRendered = 0;
+
+    if (ProgArgs::gbVulkanOffscreen && (ProgArgs::gVkReadbackEveryNFrames > 0)) {
+        gpDevice = &device;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Saves any pending readbacks and releases the readback buffers. The device must be idle when this is called.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void destroy() noexcept {
+    for (Readback& readback : gReadbacks) {
+        if (readback.bPending) {
+            saveReadback(readback);
+        }
+
+        readback.buffer.destroy(true);
+        readback.frameNum = 0;
+        readback.width = 0;
+        readback.height = 0;
+        readback.bIsBgra = false;
+    }
+
+    gpDevice = nullptr;
+    gNumFramesRendered = 0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tells if frame readback is active
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool isEnabled() noexcept {
+    return (gpDevice != nullptr);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Saves the frame read back by the last frame to use the current ringbuffer slot, if any.
+// The slot's fence must have been waited on already, so the copy to the readback buffer is known to be complete.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void saveCompletedReadbacks() noexcept {
+    if (!isEnabled())
+        return;
+
+    Readback& readback = gReadbacks[gpDevice->getRingbufferMgr().getBufferIndex()];
+
+    if (readback.bPending) {
+        saveReadback(readback);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Should be called once at the end of every frame, after the render path has finished with the current swapchain image.
+// If the frame is one that should be read back then records commands to copy the image to the readback buffer for this ringbuffer slot.
+// The swapchain image is expected to be in the transfer source layout, which is the case for offscreen swapchains.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void recordReadback(vgl::CmdBufferRecorder& cmdRec, const vgl::Swapchain& swapchain) noexcept {
+    if (!isEnabled())
+        return;
+
+    // Only read back every N'th frame
+    const uint32_t frameNum = gNumFramesRendered++;
+
+    if (frameNum % (uint32_t) ProgArgs::gVkReadbackEveryNFrames != 0)
+        return;
+
+    // Can only read back from offscreen images in a known 32-bit color format
+    const VkFormat format = swapchain.getSurfaceFormat().format;
+    const uint32_t swapchainIdx = swapchain.getAcquiredImageIdx();
+
+    if ((!swapchain.isOffscreen()) || (swapchainIdx == vgl::Swapchain::INVALID_IMAGE_IDX))
+        return;
+
+    if ((format != VK_FORMAT_B8G8R8A8_UNORM) && (format != VK_FORMAT_R8G8B8A8_UNORM))
+        return;
+
+    // Make sure the readback buffer for this ringbuffer slot is big enough.
+    // Note: if there was a pending readback in this slot then it would have been saved already at the start of the frame.
+    Readback& readback = gReadbacks[gpDevice->getRingbufferMgr().getBufferIndex()];
+    ASSERT(!readback.bPending);
+
+    const uint32_t width = swapchain.getSwapExtentWidth();
+    const uint32_t height = swapchain.getSwapExtentHeight();
+    const uint64_t bufferSize = (uint64_t) width * height * 4;
+
+    if ((!readback.buffer.isValid()) || (readback.buffer.getSize() < bufferSize)) {
+        readback.buffer.destroy();
+
+        if (!readback.buffer.init(*gpDevice, bufferSize, vgl::DeviceMemAllocMode::REQUIRE_HOST_VISIBLE, VK_BUFFER_USAGE_TRANSFER_DST_BIT)) {
+            std::printf("VFrameReadback: failed to create a %ux%u readback buffer!\n", width, height);
+            return;
+        }
+    }
+
+    // Wait for all output to the image to finish before copying
+    {
+        VkMemoryBarrier barrier = {};
+        barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+        cmdRec.addPipelineBarrier(VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 1, &barrier, 0, nullptr);
+    }
+
+    // Copy the image to the buffer
+    {
+        VkBufferImageCopy copyRegion = {};
+        copyRegion.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        copyRegion.imageSubresource.layerCount = 1;
+        copyRegion.imageExtent.width = width;
+        copyRegion.imageExtent.height = height;
+        copyRegion.imageExtent.depth = 1;
+
+        cmdRec.copyImageToBuffer(
+            swapchain.getVkImages()[swapchainIdx],
+            VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+            readback.buffer.getVkBuffer(),
+            1,
+            &copyRegion
+        );
+    }
+
+    // Make the copied pixels visible to the host once the frame's fence is signalled
+    {
+        VkMemoryBarrier barrier = {};
+        barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+
+        cmdRec.addPipelineBarrier(VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 1, &barrier, 0, nullptr);
+    }
+
+    // Save the details of the readback: the image is written once the GPU is done with the frame
+    readback.bPending = true;
+    readback.frameNum = frameNum;
+    readback.width = width;
+    readback.height = height;
+    readback.bIsBgra = (format == VK_FORMAT_B8G8R8A8_UNORM);
+}
+
+END_NAMESPACE(VFrameReadback)
+
+#endif  // #if PSYDOOM_VULKAN_RENDERER
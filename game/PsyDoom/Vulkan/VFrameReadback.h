@@ -0,0 +1,23 @@
+#pragma once
+
+#if PSYDOOM_VULKAN_RENDERER
+
+#include "Macros.h"
+
+namespace vgl {
+    class CmdBufferRecorder;
+    class LogicalDevice;
+    class Swapchain;
+}
+
+BEGIN_NAMESPACE(VFrameReadback)
+
+void init(vgl::LogicalDevice& device) noexcept;
+void destroy() noexcept;
+bool isEnabled() noexcept;
+void saveCompletedReadbacks() noexcept;
+void recordReadback(vgl::CmdBufferRecorder& cmdRec, const vgl::Swapchain& swapchain) noexcept;
+
+END_NAMESPACE(VFrameReadback)
+
+#endif  // #if PSYDOOM_VULKAN_RENDERER
@@ -0,0 +1,270 @@
+//------------------------------------------------------------------------------------------------------------------------------------------
+// This module measures how long the GPU spends executing various parts of each frame, using timestamp queries.
+//
+// Each timed scope writes a timestamp at the start and end of the commands it covers. There is a separate set of queries for each
+// ringbuffer slot, and the results for a slot are read back once the renderer has waited on that slot's fence, so reading never stalls.
+// The results are used for dynamic resolution scaling, shown in the frame profiler overlay and summarized in timedemo output.
+//
+// Note: timings are not available if the device's work queue does not support timestamps.
+//------------------------------------------------------------------------------------------------------------------------------------------
+#include "VGpuTimings.h"
+
+#if PSYDOOM_VULKAN_RENDERER
+
+#include "CmdBufferRecorder.h"
+#include "LogicalDevice.h"
+#include "PhysicalDevice.h"
+#include "QueryPool.h"
+#include "RingbufferMgr.h"
+
+BEGIN_NAMESPACE(VGpuTimings)
+
+static constexpr uint32_t NUM_SCOPES = (uint32_t) Scope::NUM_SCOPES;
+
+// Names for each scope, used for the profiler overlay and timedemo output (needs to fit on the screen in the small font)
+static constexpr const char* SCOPE_NAMES[NUM_SCOPES] = {
+    "GPU FRAME",
+    "GPU MAIN",
+    "GPU PSX",
+    "GPU XFADE",
+    "GPU BLIT",
+    "GPU MSAA",
+};
+
+// How much weight each new measurement has for the smoothed (averaged) scope timings.
+// Also how many frames a scope can go without being measured before its average is considered stale and no longer reported.
+static constexpr double SMOOTHING_FACTOR = 0.05;
+static constexpr uint32_t MAX_FRAMES_UNMEASURED = 60;
+
+static vgl::LogicalDevice*  gpDevice;                                           // The device the timings are for
+static vgl::QueryPool       gQueryPool;                                         // Start and end timestamps for each scope and ringbuffer slot
+static uint64_t             gTimestampValidMask;                                // Mask for the bits of a timestamp which are valid
+static double               gTimestampPeriodMs;                                 // How many milliseconds each timestamp tick represents
+static uint32_t             gScopesBegun[vgl::Defines::RINGBUFFER_SIZE];        // Bit mask of scopes started in each ringbuffer slot
+static uint32_t             gScopesWritten[vgl::Defines::RINGBUFFER_SIZE];      // Bit mask of scopes fully timed in each ringbuffer slot
+static uint32_t             gNumFramesRead;                                     // How many frames of results have been read
+static uint32_t             gLastFrameMeasured[NUM_SCOPES];                     // The value of 'gNumFramesRead' when each scope was last timed
+static double               gLastTimeMs[NUM_SCOPES];                            // The most recent time measured for each scope
+static double               gAvgTimeMs[NUM_SCOPES];                             // Smoothed time measured for each scope
+static double               gTotalTimeMs[NUM_SCOPES];                           // Total time measured for each scope since totals were reset
+static uint32_t             gTotalNumFrames[NUM_SCOPES];                        // Number of frames measured for each scope since totals were reset
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Get the index of the start timestamp query for the given scope & ringbuffer slot; the end timestamp query follows this
+//------------------------------------------------------------------------------------------------------------------------------------------
+static uint32_t getQueryIdx(const uint32_t ringbufferIdx, const Scope scope) noexcept {
+    return (ringbufferIdx * NUM_SCOPES + (uint32_t) scope) * 2;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Begins timing the specified scope
+//------------------------------------------------------------------------------------------------------------------------------------------
+ScopedTimer::ScopedTimer(vgl::CmdBufferRecorder& cmdRec, const Scope scope) noexcept
+    : mCmdRec(cmdRec)
+    , mScope(scope)
+{
+    beginScope(cmdRec, scope);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Ends timing the scope
+//------------------------------------------------------------------------------------------------------------------------------------------
+ScopedTimer::~ScopedTimer() noexcept {
+    endScope(mCmdRec, mScope);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Initializes GPU timings for the given device; if the device work queue doesn't support timestamps then timings will be unavailable.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void init(vgl::LogicalDevice& device) noexcept {
+    ASSERT(device.getPhysicalDevice());
+    const vgl::PhysicalDevice& physicalDevice = *device.getPhysicalDevice();
+    const uint32_t timestampValidBits = physicalDevice.getQueueFamilyProps()[device.getWorkQueueFamilyIdx()].timestampValidBits;
+    const float timestampPeriodNs = physicalDevice.getProps().limits.timestampPeriod;
+
+    resetTotals();
+
+    if ((timestampValidBits == 0) || (timestampPeriodNs <= 0.0f))
+        return;
+
+    if (!gQueryPool.init(device, VK_QUERY_TYPE_TIMESTAMP, vgl::Defines::RINGBUFFER_SIZE * NUM_SCOPES * 2))
+        return;
+
+    gpDevice = &device;
+    gTimestampValidMask = (timestampValidBits >= 64) ? UINT64_MAX : ((uint64_t) 1 << timestampValidBits) - 1;
+    gTimestampPeriodMs = (double) timestampPeriodNs / 1000000.0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Releases the resources used for GPU timings. The device must be idle when this is called.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void destroy() noexcept {
+    gQueryPool.destroy();
+    gpDevice = nullptr;
+    gTimestampValidMask = 0;
+    gTimestampPeriodMs = 0.0;
+    gNumFramesRead = 0;
+
+    for (uint32_t i = 0; i < vgl::Defines::RINGBUFFER_SIZE; ++i) {
+        gScopesBegun[i] = 0;
+        gScopesWritten[i] = 0;
+    }
+
+    for (uint32_t i = 0; i < NUM_SCOPES; ++i) {
+        gLastFrameMeasured[i] = 0;
+        gLastTimeMs[i] = 0.0;
+        gAvgTimeMs[i] = 0.0;
+    }
+
+    resetTotals();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tells if GPU timings are supported and being measured
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool isAvailable() noexcept {
+    return gQueryPool.isValid();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Reads the timings for the last frame which used the current ringbuffer slot, if any.
+// The slot's fence must have been waited on already, so the results should be available immediately.
+// Returns 'true' if a new measurement was made for the 'Frame' scope.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool readResults() noexcept {
+    if (!isAvailable())
+        return false;
+
+    const uint32_t ringbufferIdx = gpDevice->getRingbufferMgr().getBufferIndex();
+    const uint32_t scopesWritten = gScopesWritten[ringbufferIdx];
+    gScopesWritten[ringbufferIdx] = 0;
+
+    if (scopesWritten == 0)
+        return false;
+
+    gNumFramesRead++;
+    bool bMeasuredFrame = false;
+
+    for (uint32_t scopeIdx = 0; scopeIdx < NUM_SCOPES; ++scopeIdx) {
+        if ((scopesWritten & (1u << scopeIdx)) == 0)
+            continue;
+
+        uint64_t timestamps[2] = {};
+
+        if (!gQueryPool.getResults(getQueryIdx(ringbufferIdx, (Scope) scopeIdx), 2, timestamps, false))
+            continue;
+
+        const uint64_t elapsedTicks = (timestamps[1] - timestamps[0]) & gTimestampValidMask;
+        const double timeMs = (double) elapsedTicks * gTimestampPeriodMs;
+        const bool bAvgIsStale = (gNumFramesRead - gLastFrameMeasured[scopeIdx] > MAX_FRAMES_UNMEASURED) || (gAvgTimeMs[scopeIdx] <= 0.0);
+
+        gLastTimeMs[scopeIdx] = timeMs;
+        gAvgTimeMs[scopeIdx] = (bAvgIsStale) ? timeMs : gAvgTimeMs[scopeIdx] + (timeMs - gAvgTimeMs[scopeIdx]) * SMOOTHING_FACTOR;
+        gLastFrameMeasured[scopeIdx] = gNumFramesRead;
+        gTotalTimeMs[scopeIdx] += timeMs;
+        gTotalNumFrames[scopeIdx]++;
+        bMeasuredFrame |= (scopeIdx == (uint32_t) Scope::Frame);
+    }
+
+    return bMeasuredFrame;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Should be called after the frame's primary command buffer begins recording, before any scopes are timed.
+// Resets all of the queries for the current ringbuffer slot so they can be written again.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void beginFrame(vgl::CmdBufferRecorder& cmdRec) noexcept {
+    if (!isAvailable())
+        return;
+
+    const uint32_t ringbufferIdx = gpDevice->getRingbufferMgr().getBufferIndex();
+    gScopesBegun[ringbufferIdx] = 0;
+    gScopesWritten[ringbufferIdx] = 0;
+    cmdRec.resetQueries(gQueryPool, getQueryIdx(ringbufferIdx, (Scope) 0), NUM_SCOPES * 2);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Records the start timestamp for the given scope; ignored if the scope was already timed this frame
+//------------------------------------------------------------------------------------------------------------------------------------------
+void beginScope(vgl::CmdBufferRecorder& cmdRec, const Scope scope) noexcept {
+    if (!isAvailable())
+        return;
+
+    const uint32_t ringbufferIdx = gpDevice->getRingbufferMgr().getBufferIndex();
+    const uint32_t scopeBit = 1u << (uint32_t) scope;
+
+    if (gScopesBegun[ringbufferIdx] & scopeBit)
+        return;
+
+    gScopesBegun[ringbufferIdx] |= scopeBit;
+    cmdRec.writeTimestamp(VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, gQueryPool, getQueryIdx(ringbufferIdx, scope));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Records the end timestamp for the given scope; ignored if the scope was not started or was already ended this frame
+//------------------------------------------------------------------------------------------------------------------------------------------
+void endScope(vgl::CmdBufferRecorder& cmdRec, const Scope scope) noexcept {
+    if (!isAvailable())
+        return;
+
+    const uint32_t ringbufferIdx = gpDevice->getRingbufferMgr().getBufferIndex();
+    const uint32_t scopeBit = 1u << (uint32_t) scope;
+
+    if (((gScopesBegun[ringbufferIdx] & scopeBit) == 0) || (gScopesWritten[ringbufferIdx] & scopeBit))
+        return;
+
+    gScopesWritten[ringbufferIdx] |= scopeBit;
+    cmdRec.writeTimestamp(VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, gQueryPool, getQueryIdx(ringbufferIdx, scope) + 1);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Get the display name for a scope
+//------------------------------------------------------------------------------------------------------------------------------------------
+const char* getScopeName(const Scope scope) noexcept {
+    ASSERT(scope < Scope::NUM_SCOPES);
+    return SCOPE_NAMES[(uint32_t) scope];
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Get the most recently measured time for a scope (milliseconds), or '0' if never measured
+//------------------------------------------------------------------------------------------------------------------------------------------
+double getLastTimeMs(const Scope scope) noexcept {
+    ASSERT(scope < Scope::NUM_SCOPES);
+    return gLastTimeMs[(uint32_t) scope];
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Get the smoothed time for a scope (milliseconds), or '0' if the scope has not been measured recently
+//------------------------------------------------------------------------------------------------------------------------------------------
+double getAvgTimeMs(const Scope scope) noexcept {
+    ASSERT(scope < Scope::NUM_SCOPES);
+    const uint32_t scopeIdx = (uint32_t) scope;
+
+    if (gNumFramesRead - gLastFrameMeasured[scopeIdx] > MAX_FRAMES_UNMEASURED)
+        return 0.0;
+
+    return gAvgTimeMs[scopeIdx];
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Resets the total time measured for all scopes, to begin measuring over a new period (e.g for a timedemo)
+//------------------------------------------------------------------------------------------------------------------------------------------
+void resetTotals() noexcept {
+    for (uint32_t i = 0; i < NUM_SCOPES; ++i) {
+        gTotalTimeMs[i] = 0.0;
+        gTotalNumFrames[i] = 0;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Get the total time measured for a scope since totals were last reset (milliseconds), and the number of frames it was measured in
+//------------------------------------------------------------------------------------------------------------------------------------------
+double getTotalTimeMs(const Scope scope, uint32_t& numFramesOut) noexcept {
+    ASSERT(scope < Scope::NUM_SCOPES);
+    numFramesOut = gTotalNumFrames[(uint32_t) scope];
+    return gTotalTimeMs[(uint32_t) scope];
+}
+
+END_NAMESPACE(VGpuTimings)
+
+#endif  // #if PSYDOOM_VULKAN_RENDERER
@@ -0,0 +1,68 @@
+#pragma once
+
+#if PSYDOOM_VULKAN_RENDERER
+
+#include "Macros.h"
+
+#include <cstdint>
+
+namespace vgl {
+    class CmdBufferRecorder;
+    class LogicalDevice;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Scoped GPU timer macro for measuring how long the GPU spends executing the commands recorded within a block of code.
+// The commands are timed as one of the scopes defined by 'VGpuTimings::Scope'.
+//
+// Example usage:
+//      GPU_PROFILE_SCOPE(cmdRec, MsaaResolve);
+//------------------------------------------------------------------------------------------------------------------------------------------
+#define GPU_PROFILE_SCOPE_CONCAT_INNER(A, B) A##B
+#define GPU_PROFILE_SCOPE_CONCAT(A, B) GPU_PROFILE_SCOPE_CONCAT_INNER(A, B)
+#define GPU_PROFILE_SCOPE(CmdRec, ScopeName)\
+    const VGpuTimings::ScopedTimer GPU_PROFILE_SCOPE_CONCAT(gpuProfileScopedTimer_, __LINE__)(CmdRec, VGpuTimings::Scope::ScopeName)
+
+BEGIN_NAMESPACE(VGpuTimings)
+
+// All of the GPU work which can be timed.
+// Each scope can be timed at most once per frame.
+enum class Scope : uint8_t {
+    Frame,                  // All commands in the frame's primary command buffer
+    RenderPath_Main,        // The main Vulkan renderer path (nested in 'Frame')
+    RenderPath_Psx,         // The classic renderer output path (nested in 'Frame')
+    RenderPath_Crossfade,   // The crossfade render path (nested in 'Frame')
+    RenderPath_Blit,        // The blit render path (nested in 'Frame')
+    MsaaResolve,            // The MSAA resolve subpass (nested in 'RenderPath_Main')
+    NUM_SCOPES
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Times the GPU execution of the commands recorded while the object is in scope
+//------------------------------------------------------------------------------------------------------------------------------------------
+class ScopedTimer {
+public:
+    ScopedTimer(vgl::CmdBufferRecorder& cmdRec, const Scope scope) noexcept;
+    ~ScopedTimer() noexcept;
+
+private:
+    vgl::CmdBufferRecorder&     mCmdRec;
+    const Scope                 mScope;
+};
+
+void init(vgl::LogicalDevice& device) noexcept;
+void destroy() noexcept;
+bool isAvailable() noexcept;
+bool readResults() noexcept;
+void beginFrame(vgl::CmdBufferRecorder& cmdRec) noexcept;
+void beginScope(vgl::CmdBufferRecorder& cmdRec, const Scope scope) noexcept;
+void endScope(vgl::CmdBufferRecorder& cmdRec, const Scope scope) noexcept;
+const char* getScopeName(const Scope scope) noexcept;
+double getLastTimeMs(const Scope scope) noexcept;
+double getAvgTimeMs(const Scope scope) noexcept;
+void resetTotals() noexcept;
+double getTotalTimeMs(const Scope scope, uint32_t& numFramesOut) noexcept;
+
+END_NAMESPACE(VGpuTimings)
+
+#endif  // #if PSYDOOM_VULKAN_RENDERER
@@ -7,16 +7,24 @@
 
 #include "DescriptorSetLayout.h"
 #include "FatalErrors.h"
+#include "FileUtils.h"
 #include "LogicalDevice.h"
 #include "PhysicalDevice.h"
 #include "Pipeline.h"
+#include "PipelineCache.h"
 #include "PipelineLayout.h"
 #include "PsyDoom/Config/Config.h"
+#include "PsyDoom/Utils.h"
 #include "Sampler.h"
 #include "ShaderModule.h"
 #include "VRenderPath_Crossfade.h"
 #include "VRenderPath_Main.h"
 
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
 BEGIN_NAMESPACE(VPipelines)
 
 // The raw SPIRV binary code for the shaders
@@ -133,10 +141,80 @@ vgl::PipelineColorBlendState gBlendState_subtractive;
 
 // Pipeline depth/stencil states
 vgl::PipelineDepthStencilState gDepthState_disabled;        // No depth/stencil buffer: Depth write, test and all stencil operations disabled
+vgl::PipelineDepthStencilState gDepthState_testAndWrite;    // Depth test (less or equal) and depth write enabled, no stencil operations
+vgl::PipelineDepthStencilState gDepthState_testOnly;        // Depth test (less or equal) only enabled, no depth write or stencil operations
 
 // The pipelines themselves
 vgl::Pipeline gPipelines[(size_t) VPipelineType::NUM_TYPES];
 
+// Name of the file in the user data folder which the pipeline cache is saved to
+static constexpr const char* PIPELINE_CACHE_FILE_NAME = "vulkan_pipeline_cache.bin";
+
+// A pipeline cache which is used to speed up pipeline creation, and which is persisted to disk across launches.
+// Also the serialized cache data that was loaded from disk, which is used to tell if the cache needs to be saved again.
+static vgl::PipelineCache       gPipelineCache;
+static std::vector<std::byte>   gLoadedPipelineCacheData;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Get the path to the file which the pipeline cache is saved to
+//------------------------------------------------------------------------------------------------------------------------------------------
+static std::string getPipelineCacheFilePath() noexcept {
+    return Utils::getOrCreateUserDataFolder() + PIPELINE_CACHE_FILE_NAME;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Creates the pipeline cache, initializing it with the cache data saved from a previous launch (if available and compatible)
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void initPipelineCache(vgl::LogicalDevice& device) noexcept {
+    const std::string cacheFilePath = getPipelineCacheFilePath();
+    gLoadedPipelineCacheData.clear();
+
+    if (FileUtils::fileExists(cacheFilePath.c_str())) {
+        const FileData fileData = FileUtils::getContentsOfFile(cacheFilePath.c_str());
+
+        if (fileData.bytes && vgl::PipelineCache::isDataCompatible(*device.getPhysicalDevice(), fileData.bytes.get(), fileData.size)) {
+            gLoadedPipelineCacheData.assign(fileData.bytes.get(), fileData.bytes.get() + fileData.size);
+        }
+    }
+
+    // Note: failing to create the cache is not fatal, pipelines can still be created without it (just more slowly)
+    gPipelineCache.init(device, gLoadedPipelineCacheData.data(), gLoadedPipelineCacheData.size());
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Saves the contents of the pipeline cache to disk, if they have changed since being loaded.
+// Writes to a temporary file first and then moves it into place, so a partially written cache file is never used.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void savePipelineCache() noexcept {
+    std::vector<std::byte> cacheData;
+
+    if (!gPipelineCache.getData(cacheData))
+        return;
+
+    const bool bCacheUnchanged = (
+        (cacheData.size() == gLoadedPipelineCacheData.size()) &&
+        (std::memcmp(cacheData.data(), gLoadedPipelineCacheData.data(), cacheData.size()) == 0)
+    );
+
+    if (bCacheUnchanged)
+        return;
+
+    const std::string cacheFilePath = getPipelineCacheFilePath();
+    const std::string tmpFilePath = cacheFilePath + ".tmp";
+
+    if (!FileUtils::writeDataToFile(tmpFilePath.c_str(), cacheData.data(), cacheData.size()))
+        return;
+
+    std::remove(cacheFilePath.c_str());
+
+    if (std::rename(tmpFilePath.c_str(), cacheFilePath.c_str()) != 0) {
+        std::remove(tmpFilePath.c_str());
+        return;
+    }
+
+    gLoadedPipelineCacheData = std::move(cacheData);
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Initialize a single shader and raise a fatal error if it fails
 //-----------------------------------------------------------------------------------------------------------------------------------------
@@ -457,6 +535,15 @@ static void initPipelineColorBlendStates() noexcept {
 //------------------------------------------------------------------------------------------------------------------------------------------
 static void initPipelineDepthStencilStates() noexcept {
     gDepthState_disabled = vgl::PipelineDepthStencilState().setToDefault();
+
+    gDepthState_testAndWrite = vgl::PipelineDepthStencilState().setToDefault();
+    gDepthState_testAndWrite.bDepthTestEnable = true;
+    gDepthState_testAndWrite.bDepthWriteEnable = true;
+    gDepthState_testAndWrite.depthCompareOp = VK_COMPARE_OP_LESS_OR_EQUAL;
+
+    gDepthState_testOnly = vgl::PipelineDepthStencilState().setToDefault();
+    gDepthState_testOnly.bDepthTestEnable = true;
+    gDepthState_testOnly.depthCompareOp = VK_COMPARE_OP_LESS_OR_EQUAL;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -493,7 +580,8 @@ static void initPipeline(
         rasterizerState,
         multisampleState,
         colorBlendState,
-        depthStencilState
+        depthStencilState,
+        (gPipelineCache.isValid()) ? &gPipelineCache : nullptr
     );
 
     if (!bSuccess)
@@ -558,7 +646,8 @@ static void initDrawPipeline(
 // These elements have very few dependencies and can be initialized early in order to solve bootstrap dependency issues.
 //------------------------------------------------------------------------------------------------------------------------------------------
 void initPipelineComponents(vgl::LogicalDevice& device, const uint32_t numSamples) noexcept {
-    // Create all pipeline creation inputs and states
+    // Create all pipeline creation inputs and states, and the cache used to speed up pipeline creation
+    initPipelineCache(device);
     initShaders(device);
     initSamplers(device);
     initDescriptorSetLayouts(device);
@@ -595,6 +684,17 @@ void initPipelines(
     initDrawPipeline(VPipelineType::World_SpriteSubtractive, mainRPath, gShaders_world, gInputAS_triList, gRasterState_noCull, gBlendState_subtractive, gDepthState_disabled, false, false);
     initDrawPipeline(VPipelineType::World_Sky, mainRPath, gShaders_sky, gInputAS_triList, gRasterState_backFaceCull, gBlendState_noBlend, gDepthState_disabled, true, true);
 
+    // Depth tested versions of the world drawing pipelines: only needed if the render path has a depth buffer to draw the world with
+    if (mainRPath.hasDepthAttachments()) {
+        initDrawPipeline(VPipelineType::World_GeomMasked_DepthWrite, mainRPath, gShaders_world, gInputAS_triList, gRasterState_backFaceCull, gBlendState_noBlend, gDepthState_testAndWrite, true, false);
+        initDrawPipeline(VPipelineType::World_GeomAlpha_DepthTest, mainRPath, gShaders_world, gInputAS_triList, gRasterState_backFaceCull, gBlendState_alpha, gDepthState_testOnly, true, false);
+        initDrawPipeline(VPipelineType::World_SpriteMasked_DepthTest, mainRPath, gShaders_world, gInputAS_triList, gRasterState_noCull, gBlendState_noBlend, gDepthState_testOnly, false, false);
+        initDrawPipeline(VPipelineType::World_SpriteAlpha_DepthTest, mainRPath, gShaders_world, gInputAS_triList, gRasterState_noCull, gBlendState_alpha, gDepthState_testOnly, false, false);
+        initDrawPipeline(VPipelineType::World_SpriteAdditive_DepthTest, mainRPath, gShaders_world, gInputAS_triList, gRasterState_noCull, gBlendState_additive, gDepthState_testOnly, false, false);
+        initDrawPipeline(VPipelineType::World_SpriteSubtractive_DepthTest, mainRPath, gShaders_world, gInputAS_triList, gRasterState_noCull, gBlendState_subtractive, gDepthState_testOnly, false, false);
+        initDrawPipeline(VPipelineType::World_Sky_DepthTest, mainRPath, gShaders_sky, gInputAS_triList, gRasterState_backFaceCull, gBlendState_noBlend, gDepthState_testOnly, true, true);
+    }
+
     // The pipeline to resolve MSAA: only bother creating this if we are doing MSAA.
     // Specialize the shader to the number of samples also, so that loops can be unrolled.
     if (numSamples > 1) {
@@ -648,6 +748,9 @@ void initPipelines(
         gInputAS_triList, gRasterState_noCull,
         gBlendState_noBlend, gDepthState_disabled, gMultisampleState_perSettingsEdgeOnly
     );
+
+    // Save any newly compiled pipelines to the pipeline cache file so they can be reused on the next launch
+    savePipelineCache();
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -686,6 +789,10 @@ void shutdown() noexcept {
     gShader_ui_vert.destroy(true);
     gShader_colored_frag.destroy(true);
     gShader_colored_vert.destroy(true);
+
+    gPipelineCache.destroy();
+    gLoadedPipelineCacheData.clear();
+    gLoadedPipelineCacheData.shrink_to_fit();
 }
 
 END_NAMESPACE(VRPipelines)
@@ -36,8 +36,12 @@ static vgl::DescriptorPool gDescriptorPool;
 static vgl::DescriptorSet* gpDescSet_Background;
 static vgl::DescriptorSet* gpDescSet_Plaque;
 
-// This is the texture from which the loading plaque is drawn
+// This is the texture from which the loading plaque is drawn.
+// It's kept between plaque draws and only rebuilt if a different plaque texture or CLUT is drawn, since the same plaque is usually shown
+// for every load. Converting it and uploading it to the GPU again would otherwise hold up loading each time.
 static vgl::Texture gPlaqueTex;
+static int32_t      gPlaqueTexLumpNum = -1;
+static int16_t      gPlaqueTexClutId;
 
 // This is the background texture to use during plaque drawing.
 // It's sourced from the framebuffer of a previously rendered frame.
@@ -89,6 +93,10 @@ static void initPlaqueTex(vgl::LogicalDevice& device, const texture_t& tex, cons
     ASSERT(!gPlaqueTex.isValid());
     ASSERT(tex.ppTexCacheEntries);
 
+    // Remember what the texture was made from, so it can be reused for the next plaque
+    gPlaqueTexLumpNum = tex.lumpNum;
+    gPlaqueTexClutId = clutId;
+
     // Get where the texture is in VRAM, note that these are 8bpp coords and not 16bpp
     uint16_t texX, texY, texW, texH;
     RV_GetTexWinXyWh(tex, texX, texY, texW, texH);
@@ -105,7 +113,8 @@ static void initPlaqueTex(vgl::LogicalDevice& device, const texture_t& tex, cons
 
     uint32_t* const pPlaquePixels = (uint32_t*) gPlaqueTex.lock();
 
-    // Populate all of those pixels
+    // Populate all of those pixels (finishing any deferred PSX GPU draws first)
+    Gpu::flushDeferredDraws(PsxVm::gGpu);
     const uint16_t* const pVram = PsxVm::gGpu.pRam;
     const uint32_t vramWidth = PsxVm::gGpu.ramPixelW;
     const uint16_t* const pClut = pVram + ((clutY * vramWidth) + clutX);
@@ -245,6 +254,7 @@ void init(vgl::LogicalDevice& device) noexcept {
 void destroy() noexcept {
     gpBackgroundTex = nullptr;
     gPlaqueTex.destroy(true);
+    gPlaqueTexLumpNum = -1;
 
     if (gpDescSet_Background) {
         gDescriptorPool.freeDescriptorSet(*gpDescSet_Background);
@@ -282,12 +292,18 @@ void drawPlaque(texture_t& plaqueTex, const int16_t plaqueX, const int16_t plaqu
         VRenderer::beginFrame();
     }
 
-    // Make sure the plaque texture is cached to VRAM firstly and populate the loading plaque texture.
+    // Populate the loading plaque texture, if the one from the last plaque drawn can't be reused.
+    // The plaque texture must be cached to VRAM firstly in order to do this.
     // Also decide which previous framebuffer texture to use for the background.
     vgl::LogicalDevice& device = VRenderer::gDevice;
 
-    I_CacheTex(plaqueTex);
-    initPlaqueTex(device, plaqueTex, clutId);
+    const bool bReusePlaqueTex = (gPlaqueTex.isValid() && (gPlaqueTexLumpNum == plaqueTex.lumpNum) && (gPlaqueTexClutId == clutId));
+
+    if (!bReusePlaqueTex) {
+        gPlaqueTex.destroy(false);
+        I_CacheTex(plaqueTex);
+        initPlaqueTex(device, plaqueTex, clutId);
+    }
 
     determineBackgroundTex(device);
     ASSERT(gpBackgroundTex);
@@ -342,13 +358,10 @@ void drawPlaque(texture_t& plaqueTex, const int16_t plaqueX, const int16_t plaqu
         cmdRec.draw(12, 6);
     }
 
-    // Cleanup when we are done by destroying the plaque tex later
-    gPlaqueTex.destroy(false);
-
     // End the frame and wait for all drawing to end.
     // We have to do this to avoid external code overwriting the background framebuffer before we are done using it.
     VRenderer::endFrame();
-    device.waitUntilDeviceIdle();
+    VRenderer::waitUntilDeviceIdle();
 
     // Go back to doing normal rendering
     VRenderer::beginFrame();
@@ -118,7 +118,7 @@ void VRenderPath_Blit::endFrame(vgl::Swapchain& swapchain, vgl::CmdBufferRecorde
     if (VRenderer::willSkipNextFramePresent())
         return;
 
-    // Transition the swapchain image back to presentation optimal in preparation for presentation
+    // Transition the swapchain image back to presentation optimal in preparation for presentation (or for readback, if offscreen)
     const uint32_t swapchainIdx = swapchain.getAcquiredImageIdx();
     const VkImage swapchainImage = swapchain.getVkImages()[swapchainIdx];
 
@@ -128,7 +128,7 @@ void VRenderPath_Blit::endFrame(vgl::Swapchain& swapchain, vgl::CmdBufferRecorde
         imgBarrier.srcAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
         imgBarrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
         imgBarrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-        imgBarrier.newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+        imgBarrier.newLayout = swapchain.getPresentImageLayout();
         imgBarrier.image = swapchainImage;
         imgBarrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
         imgBarrier.subresourceRange.levelCount = 1;
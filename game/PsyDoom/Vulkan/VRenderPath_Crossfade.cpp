@@ -51,6 +51,7 @@ VRenderPath_Crossfade::VRenderPath_Crossfade() noexcept
     , mpDevice(nullptr)
     , mpSwapchain(nullptr)
     , mPresentSurfaceFormat()
+    , mPresentImageLayout()
     , mpMainRenderPath(nullptr)
     , mRenderPass()
     , mFramebuffers()
@@ -72,6 +73,7 @@ void VRenderPath_Crossfade::init(
     vgl::LogicalDevice& device,
     vgl::Swapchain& swapchain,
     const VkFormat presentSurfaceFormat,
+    const VkImageLayout presentImageLayout,
     VRenderPath_Main& mainRenderPath
 ) noexcept {
     // Sanity checks
@@ -83,6 +85,7 @@ void VRenderPath_Crossfade::init(
     mpSwapchain = &swapchain;
     mpMainRenderPath = &mainRenderPath;
     mPresentSurfaceFormat = presentSurfaceFormat;
+    mPresentImageLayout = presentImageLayout;
 
     // Create the renderpass
     if (!initRenderPass())
@@ -112,6 +115,7 @@ void VRenderPath_Crossfade::destroy() noexcept {
     mRenderPass.destroy();
 
     mPresentSurfaceFormat = {};
+    mPresentImageLayout = {};
     mpMainRenderPath = nullptr;
     mpSwapchain = nullptr;
     mpDevice = nullptr;
@@ -133,8 +137,9 @@ bool VRenderPath_Crossfade::ensureValidFramebuffers([[maybe_unused]] const uint3
     mFramebuffers.resize(swapchainLen);
 
     for (uint32_t swapImgIdx = 0; swapImgIdx < swapchainLen; ++swapImgIdx) {
+        // Note: retire the old framebuffer rather than destroying it immediately, since frames still in flight might be using it
         vgl::Framebuffer& framebuffer = mFramebuffers[swapImgIdx];
-        framebuffer.destroy(true);
+        framebuffer.destroy();
 
         if (!framebuffer.init(mRenderPass, swapchain, swapImgIdx, {}))
             return false;
@@ -210,7 +215,7 @@ bool VRenderPath_Crossfade::initRenderPass() noexcept {
     colorAttach.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
     colorAttach.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
     colorAttach.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    colorAttach.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;          // Ready for presentation
+    colorAttach.finalLayout = mPresentImageLayout;                      // Ready for presentation (or readback, if offscreen)
 
     // Define the single subpass and it's attachments
     {
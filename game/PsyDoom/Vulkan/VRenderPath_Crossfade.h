@@ -29,6 +29,7 @@ public:
         vgl::LogicalDevice& device,
         vgl::Swapchain& swapchain,
         const VkFormat presentSurfaceFormat,
+        const VkImageLayout presentImageLayout,
         VRenderPath_Main& mainRenderPath
     ) noexcept;
 
@@ -50,6 +51,7 @@ private:
     vgl::LogicalDevice*             mpDevice;                   // The vulkan device used
     vgl::Swapchain*                 mpSwapchain;                // The swapchain used
     VkFormat                        mPresentSurfaceFormat;      // The format for the swapchain image we present to (the output destination for this render path)
+    VkImageLayout                   mPresentImageLayout;        // The layout the swapchain image must be left in when done (ready for presentation or readback)
     VRenderPath_Main*               mpMainRenderPath;           // The main render path: used to source the images to crossfade between
     vgl::RenderPass                 mRenderPass;                // The Vulkan renderpass for this render path
     std::vector<vgl::Framebuffer>   mFramebuffers;              // Framebuffers for each swapchain image
@@ -7,7 +7,9 @@
 #include "RenderPassDef.h"
 #include "Swapchain.h"
 #include "VDrawing.h"
+#include "VGpuTimings.h"
 #include "VRenderer.h"
+#include "VVideoCapture.h"
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Sets the render path to a default uninitialized state
@@ -18,9 +20,11 @@ VRenderPath_Main::VRenderPath_Main() noexcept
     , mNumDrawSamples(0)
     , mColorFormat{}
     , mResolveFormat{}
+    , mDepthFormat{}
     , mRenderPass()
     , mMsaaResolver()
     , mColorAttachments{}
+    , mDepthAttachments{}
     , mFramebuffers{}
     , mbRenderedToFramebuffer{}
 {
@@ -34,13 +38,15 @@ VRenderPath_Main::~VRenderPath_Main() noexcept {
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Initializes the render path - this must always succeed
+// Initializes the render path - this must always succeed.
+// If the depth format is 'VK_FORMAT_UNDEFINED' then no depth attachments are created and the world cannot be drawn with depth testing.
 //------------------------------------------------------------------------------------------------------------------------------------------
 void VRenderPath_Main::init(
     vgl::LogicalDevice& device,
     const uint32_t numDrawSamples,
     const VkFormat colorFormat,
-    const VkFormat resolveFormat
+    const VkFormat resolveFormat,
+    const VkFormat depthFormat
 ) noexcept {
     // Sanity checks
     ASSERT_LOG(!mbIsValid, "Can't initialize twice!");
@@ -51,6 +57,7 @@ void VRenderPath_Main::init(
     mNumDrawSamples = numDrawSamples;
     mColorFormat = colorFormat;
     mResolveFormat = resolveFormat;
+    mDepthFormat = depthFormat;
 
     // Create the renderpass and the MSAA resolver if we are doing multi-sampling
     if (!initRenderPass())
@@ -75,12 +82,14 @@ void VRenderPath_Main::destroy() noexcept {
 
     for (uint32_t i = 0; i < vgl::Defines::RINGBUFFER_SIZE; ++i) {
         mFramebuffers[i].destroy(true);
+        mDepthAttachments[i].destroy(true);
         mColorAttachments[i].destroy(true);
         mbRenderedToFramebuffer[i] = false;
     }
 
     mMsaaResolver.destroy();
     mRenderPass.destroy();
+    mDepthFormat = {};
     mResolveFormat = {};
     mColorFormat = {};
     mNumDrawSamples = 0;
@@ -96,10 +105,14 @@ bool VRenderPath_Main::ensureValidFramebuffers(const uint32_t fbWidth, const uin
     ASSERT(mpDevice);
     vgl::LogicalDevice& device = *mpDevice;
 
-    // Recreate MSAA resolve attachments if needed
+    // Recreate MSAA resolve attachments if needed.
+    // Note: the MSAA resolver's descriptor sets reference the framebuffer color attachments and cannot be updated while frames using them
+    // are still in flight. In that case wait for the GPU to finish before recreating anything; otherwise old framebuffers are retired.
     const bool bDoingMsaa = (mNumDrawSamples > 1);
 
     if (bDoingMsaa && (!mMsaaResolver.areAllResolveAttachmentsValid(fbWidth, fbHeight))) {
+        device.waitUntilDeviceIdle();
+
         if (!mMsaaResolver.createResolveAttachments(mResolveFormat, fbWidth, fbHeight))
             return false;
     }
@@ -119,9 +132,11 @@ bool VRenderPath_Main::ensureValidFramebuffers(const uint32_t fbWidth, const uin
         if (!bNeedNewFramebuffer)
             continue;
 
-        // Cleanup any previous framebuffer and attachments
-        mFramebuffers[i].destroy(true);
-        mColorAttachments[i].destroy(true);
+        // Cleanup any previous framebuffer and attachments.
+        // When not doing MSAA these are retired rather than destroyed, since frames still in flight might be using them.
+        mFramebuffers[i].destroy(bDoingMsaa);
+        mDepthAttachments[i].destroy(bDoingMsaa);
+        mColorAttachments[i].destroy(bDoingMsaa);
         mbRenderedToFramebuffer[i] = false;
 
         // Color attachment can either be used as a transfer & sampling source (for blits and crossfades, with no MSAA) or an input attachment for MSAA resolve
@@ -140,6 +155,14 @@ bool VRenderPath_Main::ensureValidFramebuffers(const uint32_t fbWidth, const uin
             fbAttachments.push_back(&mMsaaResolver.getResolveAttachment(i));
         }
 
+        // The depth attachment (if any) always comes last and is never read after the render pass
+        if (hasDepthAttachments()) {
+            if (!mDepthAttachments[i].initAsDepthStencilBuffer(device, true, mDepthFormat, 0, fbWidth, fbHeight, mNumDrawSamples))
+                return false;
+
+            fbAttachments.push_back(&mDepthAttachments[i]);
+        }
+
         if (!mFramebuffers[i].init(mRenderPass, fbAttachments))
             return false;
 
@@ -191,10 +214,17 @@ void VRenderPath_Main::beginFrame(vgl::Swapchain& swapchain, vgl::CmdBufferRecor
         );
     }
 
-    // Begin the render pass and clear all attachments
+    // Begin the render pass and clear all attachments.
+    // The depth attachment (if any) comes after the color and MSAA resolve attachments and is cleared to the far plane.
     const uint32_t ringbufferIdx = device.getRingbufferMgr().getBufferIndex();
     vgl::Framebuffer& framebuffer = mFramebuffers[ringbufferIdx];
-    VkClearValue framebufferClearValues[1] = {};
+    VkClearValue framebufferClearValues[3] = {};
+    uint32_t numClearValues = (mNumDrawSamples > 1) ? 2 : 1;
+
+    if (hasDepthAttachments()) {
+        framebufferClearValues[numClearValues].depthStencil.depth = 1.0f;
+        ++numClearValues;
+    }
 
     cmdRec.beginRenderPass(
         mRenderPass,
@@ -205,7 +235,7 @@ void VRenderPath_Main::beginFrame(vgl::Swapchain& swapchain, vgl::CmdBufferRecor
         framebuffer.getWidth(),
         framebuffer.getHeight(),
         framebufferClearValues,
-        C_ARRAY_SIZE(framebufferClearValues)
+        numClearValues
     );
 
     // Begin a frame for the drawing module
@@ -232,6 +262,7 @@ void VRenderPath_Main::endFrame(vgl::Swapchain& swapchain, vgl::CmdBufferRecorde
     // Do an MSAA resolve subpass if MSAA is enabled
     if (mNumDrawSamples > 1) {
         cmdRec.nextSubpass(VK_SUBPASS_CONTENTS_INLINE);
+        GPU_PROFILE_SCOPE(cmdRec, MsaaResolve);
         mMsaaResolver.resolve(cmdRec);
     }
 
@@ -301,14 +332,18 @@ void VRenderPath_Main::endFrame(vgl::Swapchain& swapchain, vgl::CmdBufferRecorde
         );
     }
 
-    // Transition the swapchain image back to presentation optimal in preparation for presentation
+    // Capture the frame for video recording, if that is enabled
+    const VkFormat blitSrcFormat = (mNumDrawSamples > 1) ? mResolveFormat : mColorFormat;
+    VVideoCapture::recordCapture(cmdRec, blitSrcImage, blitSrcFormat, framebuffer.getWidth(), framebuffer.getHeight());
+
+    // Transition the swapchain image back to presentation optimal in preparation for presentation (or for readback, if offscreen)
     {
         VkImageMemoryBarrier imgBarrier = {};
         imgBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
         imgBarrier.srcAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
         imgBarrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
         imgBarrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-        imgBarrier.newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+        imgBarrier.newLayout = swapchain.getPresentImageLayout();
         imgBarrier.image = swapchainImage;
         imgBarrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
         imgBarrier.subresourceRange.levelCount = 1;
@@ -380,6 +415,23 @@ bool VRenderPath_Main::initRenderPass() noexcept {
         resolveAttach.finalLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;     // Ready for blitting to the swapchain image
     }
 
+    // If drawing the world with depth testing is possible, define the depth attachment.
+    // It is only used during the main 'draw' subpass, so it's contents never need to be saved.
+    const bool bDepthEnabled = hasDepthAttachments();
+    const uint32_t depthAttachIdx = (uint32_t) renderPassDef.attachments.size();
+
+    if (bDepthEnabled) {
+        VkAttachmentDescription& depthAttach = renderPassDef.attachments.emplace_back();
+        depthAttach.format = mDepthFormat;
+        depthAttach.samples = (VkSampleCountFlagBits) mNumDrawSamples;
+        depthAttach.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+        depthAttach.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        depthAttach.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        depthAttach.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        depthAttach.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        depthAttach.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+    }
+
     // Define the main 'draw' subpass and it's attachments
     {
         vgl::SubpassDef& subpassDef = renderPassDef.subpasses.emplace_back();
@@ -387,6 +439,12 @@ bool VRenderPath_Main::initRenderPass() noexcept {
         VkAttachmentReference& colorAttachRef = subpassDef.colorAttachments.emplace_back();
         colorAttachRef.attachment = 0;
         colorAttachRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+        if (bDepthEnabled) {
+            VkAttachmentReference& depthAttachRef = subpassDef.depthStencilAttachments.emplace_back();
+            depthAttachRef.attachment = depthAttachIdx;
+            depthAttachRef.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+        }
     }
 
     // If doing MSAA, define the MSAA color resolve subpass and the attachment resolved to as well as the input MSAA color attachment
@@ -412,6 +470,14 @@ bool VRenderPath_Main::initRenderPass() noexcept {
         dep.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
         dep.srcAccessMask = (bMsaaEnabled) ? VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT : VK_ACCESS_TRANSFER_READ_BIT;
         dep.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+
+        // The depth attachment must also wait for previous depth testing to finish before it is cleared and used again
+        if (bDepthEnabled) {
+            dep.srcStageMask |= VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+            dep.dstStageMask |= VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+            dep.srcAccessMask |= VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+            dep.dstAccessMask |= VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+        }
     }
 
     {
@@ -21,7 +21,8 @@ public:
         vgl::LogicalDevice& device,
         const uint32_t numDrawSamples,
         const VkFormat colorFormat,
-        const VkFormat resolveFormat
+        const VkFormat resolveFormat,
+        const VkFormat depthFormat
     ) noexcept;
 
     void destroy() noexcept;
@@ -31,6 +32,7 @@ public:
 
     inline bool isValid() const noexcept { return mbIsValid; }
     inline uint32_t getNumDrawSamples() const noexcept { return mNumDrawSamples; }
+    inline bool hasDepthAttachments() const noexcept { return (mDepthFormat != VK_FORMAT_UNDEFINED); }
     inline const vgl::RenderPass& getRenderPass() const noexcept { return mRenderPass; }
     inline VMsaaResolver& getMsaaResolver() noexcept { return mMsaaResolver; }
 
@@ -49,12 +51,15 @@ private:
     uint32_t                mNumDrawSamples;    // How many samples to use during drawing, '1' if MSAA is disabled
     VkFormat                mColorFormat;       // The format used for color attachments during drawing
     VkFormat                mResolveFormat;     // If doing MSAA this is the format to use for the MSAA resolve target
+    VkFormat                mDepthFormat;       // Format for the depth attachments used to draw the world with depth testing, or 'VK_FORMAT_UNDEFINED' if none
     vgl::RenderPass         mRenderPass;        // The Vulkan renderpass for this render path
     VMsaaResolver           mMsaaResolver;      // Only initialized if doing MSAA: helper to help resolve the multi-sampled framebuffer
 
-    // Framebuffer color attachments and framebuffers - one per ringbuffer slot.
+    // Framebuffer color and depth attachments and framebuffers - one per ringbuffer slot.
     // Note that the framebuffer might contain an additional MSAA resolve attachment (owned by the MSAA resolver) if that feature is active.
+    // The depth attachments are only created if a depth format was given.
     vgl::RenderTexture  mColorAttachments[vgl::Defines::RINGBUFFER_SIZE];
+    vgl::RenderTexture  mDepthAttachments[vgl::Defines::RINGBUFFER_SIZE];
     vgl::Framebuffer    mFramebuffers[vgl::Defines::RINGBUFFER_SIZE];
 
     // Whether each of the framebuffers have been involved in a frame yet
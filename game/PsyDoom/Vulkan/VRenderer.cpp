@@ -14,14 +14,23 @@
 #include "PhysicalDevice.h"
 #include "PhysicalDeviceSelection.h"
 #include "PsyDoom/Config/Config.h"
+#include "PsyDoom/FrameProfiler.h"
 #include "PsyDoom/PlayerPrefs.h"
+#include "PsyDoom/ProgArgs.h"
 #include "PsyDoom/PsxVm.h"
+#include "PsyDoom/ThreadUtils.h"
 #include "PsyDoom/Video.h"
+#include "RawBuffer.h"
 #include "Semaphore.h"
 #include "Swapchain.h"
 #include "Texture.h"
+#include "TransferMgr.h"
 #include "VCrossfader.h"
 #include "VDrawing.h"
+#include "VDynamicRes.h"
+#include "VFrameArena.h"
+#include "VFrameReadback.h"
+#include "VGpuTimings.h"
 #include "VkFuncs.h"
 #include "VPipelines.h"
 #include "VPlaqueDrawer.h"
@@ -29,11 +38,17 @@
 #include "VRenderPath_Crossfade.h"
 #include "VRenderPath_Main.h"
 #include "VRenderPath_Psx.h"
+#include "VVideoCapture.h"
 #include "VulkanInstance.h"
 #include "WindowSurface.h"
 
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
 #include <regex>
 #include <SDL_vulkan.h>
+#include <thread>
+#include <vector>
 
 BEGIN_NAMESPACE(VRenderer)
 
@@ -99,9 +114,10 @@ float gPsxNdcOffsetX,  gPsxNdcOffsetY;
 
 static bool                         gbDidBeginFrame;                // Whether a frame was begun
 static vgl::VulkanInstance          gVulkanInstance(gVkFuncs);      // Vulkan API instance object
-static vgl::WindowSurface           gWindowSurface;                 // Window surface to draw on
+static vgl::WindowSurface           gWindowSurface;                 // Window surface to draw on (not used when rendering offscreen)
 static const vgl::PhysicalDevice*   gpPhysicalDevice;               // Physical device chosen for rendering
 static VkFormat                     gPresentSurfaceFormat;          // What color format the surface we are presenting to should be in
+static VkFormat                     gDepthFormat;                   // Format of the depth buffer for depth tested world drawing, 'VK_FORMAT_UNDEFINED' if none
 static VkColorSpaceKHR              gPresentSurfaceColorspace;      // What colorspace the surface we are presenting to should use
 static uint32_t                     gDrawSampleCount;               // The number of samples to use when drawing (if > 1 then MSAA is active)
 
@@ -126,14 +142,49 @@ static uint32_t gCurSwapchainSemaphoreIdx;
 // One per ringbuffer slot, so we don't disturb a frame that is still being processed.
 static vgl::Semaphore gRenderDoneSemaphores[vgl::Defines::RINGBUFFER_SIZE];
 
+// Input to present latency measurement: when inputs were last sampled (if not yet presented) and the accumulated latency since this
+// was last queried. Only the first input sample after each present is measured, since that is the oldest input making it into the frame.
+typedef std::chrono::high_resolution_clock latencytimer_t;
+
+static bool                         gbHaveUnpresentedInputSample;
+static latencytimer_t::time_point   gInputSampleTime;
+static double                       gTotalInputLatencyUsec;
+static uint32_t                     gNumInputLatencySamples;
+
 // Primary command buffers used for drawing operations in each frame.
 // One for each ringbuffer slot, so we can record a new buffer while a previous frame's buffer is still executing.
 static vgl::CmdBuffer gCmdBuffers[vgl::Defines::RINGBUFFER_SIZE];
 
+// The dynamic resolution scale that the current framebuffer size was computed with
+static float gAppliedRenderScale = 1.0f;
+
 // A mirrored copy of PSX VRAM (minus framebuffers) so we can access in the new Vulkan renderer.
 // Any texture uploads to PSX VRAM will get passed along from LIBGPU and eventually find their way in here.
 static vgl::Texture gPsxVramTexture;
 
+// Updates to PSX VRAM are not uploaded to the Vulkan texture immediately, instead the exact rectangles written are recorded as dirty.
+// All dirty areas are then uploaded once at the end of the frame, just before transfers are kicked off. This avoids lots of tiny transfers
+// and also uploading the same area more than once per frame (e.g when the texture cache overwrites an area repeatedly). Only the pixels that
+// were actually written are uploaded, so areas of VRAM updated by the GPU (such as the fire sky) are not overwritten by stale CPU pixels.
+struct VramDirtyRect {
+    uint16_t lx, rx;    // Left and right bounds (inclusive)
+    uint16_t ty, by;    // Top and bottom bounds (inclusive)
+};
+
+// Size of the block of zeroed pixels that is repeatedly uploaded to clear the Vulkan PSX VRAM texture on init
+static constexpr uint32_t VRAM_CLEAR_BLOCK_SIZE = 512;
+
+static std::vector<VramDirtyRect>   gVramDirtyRects;    // Areas of VRAM with pending updates: none of these fully contain another
+
+// The regions of VRAM to be uploaded when flushing updates: kept around to avoid reallocating each time
+static std::vector<vgl::TextureRegionUpload> gVramUploadRegions;
+
+// Persistently mapped staging buffers for PSX VRAM updates, one per ringbuffer slot.
+// These are grown as required and reused every frame, instead of allocating a new temporary staging buffer every time VRAM is flushed.
+// The number of bytes used in the current slot's buffer is also tracked, since VRAM may be flushed more than once per frame.
+static vgl::RawBuffer   gVramStagingBuffers[vgl::Defines::RINGBUFFER_SIZE];
+static uint64_t         gVramStagingBytesUsed;
+
 // The current and next frame render paths to use: these should always be valid
 static IVRendererPath* gpCurRenderPath;
 static IVRendererPath* gpNextRenderPath;
@@ -144,6 +195,27 @@ static bool gbSkipNextFramePresent;
 // If true then we must wait on the swapchain image semaphore this frame (we had to acquire it)
 static bool gbDidAcquireSwapImageThisFrame;
 
+// Details for submitting a recorded frame to the GPU and presenting it
+struct FrameSubmit {
+    uint32_t                        ringbufferIdx;          // Ringbuffer slot that the frame was recorded for
+    vgl::Fence*                     pRingbufferSlotFence;   // Fence for the ringbuffer slot, signalled when the frame's commands are done
+    uint32_t                        swapSemaphoreIdx;       // Which 'swap image ready' semaphore to wait on, if waiting
+    bool                            bWaitOnSwapImage;       // Whether the command buffer must wait for the swapchain image to be acquired
+    bool                            bPresent;               // Whether to present the frame (false if skipping the present)
+    bool                            bMeasureInputLatency;   // Whether to measure the input to present latency for this frame
+    latencytimer_t::time_point      inputSampleTime;        // When inputs for this frame were sampled, if measuring latency
+};
+
+// Optional render thread which submits recorded frames to the GPU and presents them, so that the main thread can move onto the next
+// frame without blocking on those operations. Frames are always recorded on the main thread and at most 1 submit is pending at a time.
+// The mutex guards the pending submit and the input latency measurements.
+static std::thread                  gRenderThread;
+static std::mutex                   gRenderThreadMutex;
+static std::condition_variable      gRenderThreadCV;
+static bool                         gbRenderThreadShutdown;
+static bool                         gbFrameSubmitPending;
+static FrameSubmit                  gPendingFrameSubmit;
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Decides the multisample anti-aliasing sample count based on user preferences and hardware capabilities
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -172,6 +244,37 @@ static void decideDrawSampleCount() noexcept {
     }
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Decides the format of the depth buffer used for depth tested world drawing, if that is enabled and supported.
+// Note: needs a lot more precision than 16-bits, since each subsector drawn takes up 2 unique depth values.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void decideDepthFormat() noexcept {
+    gDepthFormat = VK_FORMAT_UNDEFINED;
+
+    if (!Config::gbVulkanDepthTestedWorld)
+        return;
+
+    // The depth buffer must support the same number of samples as the color buffer
+    const VkPhysicalDeviceLimits& deviceLimits = gpPhysicalDevice->getProps().limits;
+
+    if ((deviceLimits.framebufferDepthSampleCounts & (VkSampleCountFlags) gDrawSampleCount) == 0)
+        return;
+
+    constexpr VkFormat DEPTH_FORMATS[] = {
+        VK_FORMAT_D32_SFLOAT,
+        VK_FORMAT_X8_D24_UNORM_PACK32,
+        VK_FORMAT_D24_UNORM_S8_UINT,
+        VK_FORMAT_D32_SFLOAT_S8_UINT,
+    };
+
+    gDepthFormat = gpPhysicalDevice->findFirstSupportedDepthStencilBufferFormat(
+        DEPTH_FORMATS,
+        C_ARRAY_SIZE(DEPTH_FORMATS),
+        VK_IMAGE_TILING_OPTIMAL,
+        0
+    );
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Determines if 16-bit color framebuffers and textures are possible for the specified device
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -201,6 +304,26 @@ static void determine16BitColorSupport(const vgl::PhysicalDevice& device) noexce
 // Decides on the color format used for the window/presentation surface as well as the colorspace
 //------------------------------------------------------------------------------------------------------------------------------------------
 static void decidePresentSurfaceFormat() noexcept {
+    // Offscreen rendering: there is no window surface, just use the first of the allowed formats which the offscreen images can use.
+    // Only consider the 32-bit formats with 8-bit components so that frames can be easily read back.
+    if (ProgArgs::gbVulkanOffscreen) {
+        constexpr VkFormatFeatureFlags OFFSCREEN_FORMAT_FEATURES = (
+            VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT |
+        #if VGL_VULKAN_1_1
+            VK_FORMAT_FEATURE_TRANSFER_SRC_BIT |    // N.B: only available in Vulkan 1.1 or greater
+        #endif
+            VK_FORMAT_FEATURE_BLIT_DST_BIT
+        );
+
+        gPresentSurfaceFormat = gpPhysicalDevice->findFirstSupportedOptimalTilingFormat(ALLOWED_COLOR_SURFACE_FORMATS, 2, OFFSCREEN_FORMAT_FEATURES);
+        gPresentSurfaceColorspace = VK_COLORSPACE_SRGB_NONLINEAR_KHR;
+
+        if (gPresentSurfaceFormat == VK_FORMAT_UNDEFINED)
+            FatalErrors::raise("Failed to find a suitable format for offscreen rendering!");
+
+        return;
+    }
+
     // Firstly query the device surface capabilities
     vgl::DeviceSurfaceCaps surfaceCaps;
 
@@ -244,6 +367,14 @@ static void updateCoordSysInfo() noexcept {
             gFramebufferW = gPresentSurfaceW;
             gFramebufferH = gPresentSurfaceH;
         }
+
+        // Apply dynamic resolution scaling, if active
+        gAppliedRenderScale = VDynamicRes::getRenderScale();
+
+        if (gAppliedRenderScale != 1.0f) {
+            gFramebufferW = (uint32_t) std::max((float) gFramebufferW * gAppliedRenderScale + 0.5f, 1.0f);
+            gFramebufferH = (uint32_t) std::max((float) gFramebufferH * gAppliedRenderScale + 0.5f, 1.0f);
+        }
     } else {
         gFramebufferW = 0;
         gFramebufferH = 0;
@@ -335,6 +466,22 @@ static void updateCoordSysInfo() noexcept {
     }
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Get which GPU timing scope to use for the given render path
+//------------------------------------------------------------------------------------------------------------------------------------------
+static VGpuTimings::Scope getRenderPathGpuTimingScope(const IVRendererPath& renderPath) noexcept {
+    if (&renderPath == &gRenderPath_Main)
+        return VGpuTimings::Scope::RenderPath_Main;
+
+    if (&renderPath == &gRenderPath_Crossfade)
+        return VGpuTimings::Scope::RenderPath_Crossfade;
+
+    if (&renderPath == &gRenderPath_Blit)
+        return VGpuTimings::Scope::RenderPath_Blit;
+
+    return VGpuTimings::Scope::RenderPath_Psx;
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Create or recreate the 'swap image ready' semaphores
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -361,34 +508,68 @@ static bool ensureValidSwapchainAndFramebuffers() noexcept {
 
     // No swapchain or invalid swapchain? If that is the case then try to create or re-create...
     if ((!gSwapchain.isValid()) || gSwapchain.needsRecreate() || VRenderer::isSwapchainOutOfDate()) {
-        // Destroy the old swapchain
-        gDevice.waitUntilDeviceIdle();
-        gSwapchain.destroy();
-
         // Decide which swap mode to use
         vgl::SwapPresentMode swapMode = {};
         
-        if (Config::gbEnableVSync) {
-            swapMode = (Config::gbVulkanTripleBuffer) ? vgl::SwapPresentMode::TripleBuffer : vgl::SwapPresentMode::DoubleBuffer;
+        // Note: never use vsync when doing a timedemo or soak benchmark
+        if (Config::gbEnableVSync && (!ProgArgs::gbTimeDemo) && (ProgArgs::gSoakSeconds <= 0)) {
+            if (Config::gbVulkanLowLatency) {
+                swapMode = vgl::SwapPresentMode::LowLatency;
+            } else {
+                swapMode = (Config::gbVulkanTripleBuffer) ? vgl::SwapPresentMode::TripleBuffer : vgl::SwapPresentMode::DoubleBuffer;
+            }
         } else {
             swapMode = vgl::SwapPresentMode::Immediate;
         }
 
-        // Recreate the swapchain
-        if (!gSwapchain.init(gDevice, gPresentSurfaceFormat, gPresentSurfaceColorspace, swapMode))
-            return false;
+        // In low latency mode only allow 1 frame in flight, so that the CPU waits for the GPU to finish the previous frame before
+        // reading inputs and preparing the next one. Otherwise inputs can be read a full frame before the GPU gets to them.
+        vgl::RingbufferMgr& ringbufferMgr = gDevice.getRingbufferMgr();
+        ringbufferMgr.setMaxFramesInFlight((swapMode == vgl::SwapPresentMode::LowLatency) ? 1 : vgl::Defines::RINGBUFFER_SIZE);
+
+        if (ProgArgs::gbVulkanOffscreen) {
+            // Offscreen rendering: create the offscreen images once, these never go out of date.
+            // Use the user's output resolution if specified, otherwise 4x the logical display resolution.
+            const float logicalDispW = (Config::gLogicalDisplayW <= 0.0f) ? (float) Video::ORIG_DISP_RES_X : Config::gLogicalDisplayW;
+            const uint32_t imageW = (uint32_t)((Config::gOutputResolutionW > 0) ? Config::gOutputResolutionW : (int32_t)(logicalDispW * 4.0f));
+            const uint32_t imageH = (uint32_t)((Config::gOutputResolutionH > 0) ? Config::gOutputResolutionH : Video::ORIG_DISP_RES_Y * 4);
+
+            gSwapchain.destroy();
+
+            if (!gSwapchain.initOffscreen(gDevice, gPresentSurfaceFormat, imageW, imageH, vgl::Defines::RINGBUFFER_SIZE))
+                FatalErrors::raise("Failed to create the images for offscreen Vulkan rendering!");
+
+            recreateSwapImageReadySemaphores();
+        } else if (gSwapchain.isValid()) {
+            // If there is an existing swapchain then recreate it without stalling: the old swapchain is handed off to the new one and retired.
+            // Frames still in flight can finish with the old images while we render the next frame to the new ones.
+            //
+            // Note: the swap image ready semaphores don't need recreation in this case. Every semaphore signalled by acquiring an image is
+            // consumed by the command buffer submitted for that same frame, so none of them can be left in a signalled state.
+            if (!gSwapchain.recreate(swapMode))
+                return false;
+        } else {
+            // Otherwise create the swapchain from scratch, after waiting for the GPU to finish with any previous swapchain
+            gDevice.waitUntilDeviceIdle();
+            gSwapchain.destroy();
+
+            if (!gSwapchain.init(gDevice, gPresentSurfaceFormat, gPresentSurfaceColorspace, swapMode))
+                return false;
 
-        // Create or recreate the swap image synchronization semaphores too. We do this every time the swapchain is recreated in case
-        // one of the 'image ready' semaphores got signalled before drawing commands could consume that signal.
-        // The semaphores must always be in an unsignalled state before being used by 'vkAcquireNextImageKHR'.
-        recreateSwapImageReadySemaphores();
+            // Create or recreate the swap image synchronization semaphores too. We do this every time the swapchain is created in case
+            // one of the 'image ready' semaphores got signalled before drawing commands could consume that signal.
+            // The semaphores must always be in an unsignalled state before being used by 'vkAcquireNextImageKHR'.
+            recreateSwapImageReadySemaphores();
+        }
     }
 
     // Do we need to update coord system info?
     const uint32_t presentSurfaceW = gSwapchain.getSwapExtentWidth();
     const uint32_t presentSurfaceH = gSwapchain.getSwapExtentHeight();
 
-    if ((presentSurfaceW != gPresentSurfaceW) || (presentSurfaceH != gPresentSurfaceH)) {
+    const bool bRenderScaleChanged = (VDynamicRes::getRenderScale() != gAppliedRenderScale);
+
+    if ((presentSurfaceW != gPresentSurfaceW) || (presentSurfaceH != gPresentSurfaceH) || bRenderScaleChanged) {
         updateCoordSysInfo();
     }
 
@@ -497,6 +678,97 @@ bool isPhysicalDeviceSuitable(const vgl::PhysicalDevice& device, const vgl::Devi
     return true;
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Submits the command buffer for a recorded frame to the device and presents the frame (unless skipped).
+// May be called from either the main thread or the render thread.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void submitAndPresentFrame(const FrameSubmit& frame) noexcept {
+    // Conditions that the command buffer waits on.
+    // Just wait on the swap chain image to be acquired, unless we didn't actually have to acquire one this frame.
+    // Sometimes we might have just had a swap image due to a previous frame that wasn't presented...
+    std::vector<vgl::CmdBufferWaitCond> cmdBufferWaitConds;
+
+    if (frame.bWaitOnSwapImage) {
+        vgl::CmdBufferWaitCond& cmdsWaitCond = cmdBufferWaitConds.emplace_back();
+        cmdsWaitCond.pSemaphore = &gSwapImageReadySemaphores[frame.swapSemaphoreIdx];
+        cmdsWaitCond.blockedStageFlags = VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT;
+    }
+
+    // Note: signal the render done semaphore and the ringbuffer slot fence when finished.
+    // Skip signalling the render semaphore however if we are not presenting, as the swapchain will not be able to consume it.
+    // It needs to be in an unsignalled state the next time we go to use it...
+    // The same goes for offscreen rendering, where 'presenting' the image does not consume the semaphore.
+    const bool bSkipRenderDoneSignal = ((!frame.bPresent) || gSwapchain.isOffscreen());
+    vgl::Semaphore* pSignalSemaphore = (bSkipRenderDoneSignal) ? nullptr : &gRenderDoneSemaphores[frame.ringbufferIdx];
+
+    gDevice.submitCmdBuffer(
+        gCmdBuffers[frame.ringbufferIdx],
+        cmdBufferWaitConds,
+        pSignalSemaphore,
+        frame.pRingbufferSlotFence
+    );
+
+    // Present the swapchain image once all the commands have finished, unless skip was requested
+    if (!frame.bPresent)
+        return;
+
+    gSwapchain.presentAcquiredImage(gRenderDoneSemaphores[frame.ringbufferIdx]);
+
+    // Measure the delay between the inputs for this frame being sampled and the frame being queued for presentation
+    if (frame.bMeasureInputLatency) {
+        const latencytimer_t::duration latency = latencytimer_t::now() - frame.inputSampleTime;
+
+        std::unique_lock lock(gRenderThreadMutex);
+        gTotalInputLatencyUsec += std::chrono::duration<double, std::micro>(latency).count();
+        gNumInputLatencySamples++;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Entry point for the render thread: waits for frames to be handed over and submits/presents them until told to shut down
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void renderThreadMain() noexcept {
+    // The render thread is on the critical path for every frame, so give it the same priority and cores as the main thread
+    ThreadUtils::applyToCurrentThread(ThreadUtils::makeThreadSettings(Config::gMainThreadPriority, Config::gMainThreadCores));
+
+    while (true) {
+        // Wait for a frame to submit or to be told to shut down
+        FrameSubmit frame;
+
+        {
+            std::unique_lock lock(gRenderThreadMutex);
+            gRenderThreadCV.wait(lock, [&]() noexcept { return (gbFrameSubmitPending || gbRenderThreadShutdown); });
+
+            if (!gbFrameSubmitPending)
+                break;
+
+            frame = gPendingFrameSubmit;
+        }
+
+        // Do the submit and present, then let the main thread know the frame is done with
+        submitAndPresentFrame(frame);
+
+        {
+            std::unique_lock lock(gRenderThreadMutex);
+            gbFrameSubmitPending = false;
+        }
+
+        gRenderThreadCV.notify_all();
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Waits until the render thread (if active) has finished submitting and presenting the last frame handed to it.
+// This must be done before the main thread uses the device queues, swapchain or last ringbuffer slot fence again.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void waitForRenderThread() noexcept {
+    if (!gRenderThread.joinable())
+        return;
+
+    std::unique_lock lock(gRenderThreadMutex);
+    gRenderThreadCV.wait(lock, [&]() noexcept { return (!gbFrameSubmitPending); });
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Initializes Vulkan for PsyDoom
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -504,11 +776,14 @@ void init() noexcept {
     // Coord sys info is initially invalid
     updateCoordSysInfo();
 
-    // Initialize the Vulkan API and the window surface
+    // Initialize the Vulkan API and the window surface.
+    // Note: when rendering offscreen there is no window and the API instance is created in headless mode.
+    const bool bOffscreen = ProgArgs::gbVulkanOffscreen;
+
     if (!gVulkanInstance.init(Video::gpSdlWindow))
         FatalErrors::raise("Failed to initialize a Vulkan API instance!");
 
-    if (!gWindowSurface.init(Video::gpSdlWindow, gVulkanInstance))
+    if ((!bOffscreen) && (!gWindowSurface.init(Video::gpSdlWindow, gVulkanInstance)))
         FatalErrors::raise("Failed to initialize a Vulkan window surface!");
 
     // Choose a device to use and try to use the preferred device regex if set.
@@ -519,21 +794,40 @@ void init() noexcept {
         try {
             std::regex preferredGpusRegex(preferredGpusRegexStr, std::regex_constants::ECMAScript | std::regex_constants::icase);
 
-            gpPhysicalDevice = vgl::PhysicalDeviceSelection::selectBestDevice(
-                gVulkanInstance.getPhysicalDevices(),
-                gWindowSurface,
-                [&](const vgl::PhysicalDevice& device, const vgl::DeviceSurfaceCaps& surfaceCaps) -> bool {
-                    if (!std::regex_search(device.getName(), preferredGpusRegex))
-                        return false;
-
-                    return isPhysicalDeviceSuitable(device, surfaceCaps);
-                }
-            );
+            if (bOffscreen) {
+                gpPhysicalDevice = vgl::PhysicalDeviceSelection::selectBestHeadlessDevice(
+                    gVulkanInstance.getPhysicalDevices(),
+                    [&](const vgl::PhysicalDevice& device) -> bool {
+                        if (!std::regex_search(device.getName(), preferredGpusRegex))
+                            return false;
+
+                        return isHeadlessPhysicalDeviceSuitable(device);
+                    }
+                );
+            } else {
+                gpPhysicalDevice = vgl::PhysicalDeviceSelection::selectBestDevice(
+                    gVulkanInstance.getPhysicalDevices(),
+                    gWindowSurface,
+                    [&](const vgl::PhysicalDevice& device, const vgl::DeviceSurfaceCaps& surfaceCaps) -> bool {
+                        if (!std::regex_search(device.getName(), preferredGpusRegex))
+                            return false;
+
+                        return isPhysicalDeviceSuitable(device, surfaceCaps);
+                    }
+                );
+            }
         } catch (...) {
             FatalErrors::raiseF("Invalid value for 'VulkanPreferredDevicesRegex' - not a valid regex:\n%s", preferredGpusRegexStr);
         }
     }
 
+    if ((!gpPhysicalDevice) && bOffscreen) {
+        gpPhysicalDevice = vgl::PhysicalDeviceSelection::selectBestHeadlessDevice(
+            gVulkanInstance.getPhysicalDevices(),
+            isHeadlessPhysicalDeviceSuitable
+        );
+    }
+
     if (!gpPhysicalDevice) {
         gpPhysicalDevice = vgl::PhysicalDeviceSelection::selectBestDevice(
             gVulkanInstance.getPhysicalDevices(),
@@ -549,13 +843,14 @@ void init() noexcept {
         );
     }
 
-    // Decide whether 16-bit color is possible, draw sample count and window/present surface format
+    // Decide whether 16-bit color is possible, draw sample count, depth format and window/present surface format
     decideDrawSampleCount();
+    decideDepthFormat();
     determine16BitColorSupport(*gpPhysicalDevice);
     decidePresentSurfaceFormat();
 
     // Initialize the logical Vulkan device used for commands and operations and then 
-    if (!gDevice.init(*gpPhysicalDevice, &gWindowSurface))
+    if (!gDevice.init(*gpPhysicalDevice, (bOffscreen) ? nullptr : &gWindowSurface))
         FatalErrors::raise("Failed to initialize a Vulkan logical device!");
 
     // Initialize all pipeline components: must be done BEFORE creating render paths, as they rely on some components
@@ -565,8 +860,15 @@ void init() noexcept {
     const VkFormat drawColorFormat = (Config::gbUseVulkan32BitShading || (!gbCanVulkanFbUse16BitColor)) ? COLOR_32_FORMAT : COLOR_16_FORMAT;
 
     gRenderPath_Psx.init(gDevice, (gbCanPsxFbUse16BitColor) ? COLOR_16_FORMAT : COLOR_32_FORMAT);
-    gRenderPath_Main.init(gDevice, gDrawSampleCount, drawColorFormat, COLOR_32_FORMAT);
-    gRenderPath_Crossfade.init(gDevice, gSwapchain, gPresentSurfaceFormat, gRenderPath_Main);
+    gRenderPath_Main.init(gDevice, gDrawSampleCount, drawColorFormat, COLOR_32_FORMAT, gDepthFormat);
+    gRenderPath_Crossfade.init(
+        gDevice,
+        gSwapchain,
+        gPresentSurfaceFormat,
+        (bOffscreen) ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+        gRenderPath_Main
+    );
+
     gRenderPath_Blit.init(gDevice);
 
     // Create all of the pipelines needed, these use the previously created pipeline components
@@ -584,6 +886,16 @@ void init() noexcept {
             FatalErrors::raise("Failed to create a Vulkan command buffer required for rendering!");
     }
 
+    // Setup GPU timing measurements and start dynamic resolution scaling from scratch
+    VGpuTimings::init(gDevice);
+    VDynamicRes::reset();
+
+    // Setup reading back frames when rendering offscreen, if requested
+    VFrameReadback::init(gDevice);
+
+    // Setup capturing video of the main render path output, if requested
+    VVideoCapture::init(gDevice);
+
     // Workaround for lower-end devices like the Raspberry Pi 4 which only support texture sizes of 4096x4096 at the time of writing.
     // Determine the maximum texture size supported by the Vulkan device and if it's smaller than the already chosen PSX VRAM size
     // then re-initialize the PSX GPU with the smaller of the two memory sizes:
@@ -620,12 +932,38 @@ void init() noexcept {
         );
     }
 
+    // Clear VRAM by uploading the same small block of zeroed pixels to every part of the texture.
+    // This avoids needing a host staging buffer as big as VRAM itself, which can be very large for limit removing VRAM sizes.
     {
-        std::byte* const pBytes = gPsxVramTexture.lock();
-        std::memset(pBytes, 0, (size_t) gPsxVramTexture.getLockedSizeInBytes());
-        gPsxVramTexture.unlock();
+        const uint32_t clearBlockW = std::min<uint32_t>(VRAM_CLEAR_BLOCK_SIZE, psxGpu.ramPixelW);
+        const uint32_t clearBlockH = std::min<uint32_t>(VRAM_CLEAR_BLOCK_SIZE, psxGpu.ramPixelH);
+        const uint64_t clearBlockSize = (uint64_t) clearBlockW * clearBlockH * sizeof(uint16_t);
+        const vgl::TransferMgr::StagingBuffer stagingBuffer = gDevice.getTransferMgr().allocTempStagingBuffer(clearBlockSize);
+
+        if (!stagingBuffer.pBytes) {
+            FatalErrors::raise("Failed to allocate a staging buffer to clear Vulkan PSX VRAM!");
+        }
+
+        std::memset(stagingBuffer.pBytes, 0, (size_t) clearBlockSize);
+        gVramUploadRegions.clear();
+
+        for (uint32_t y = 0; y < psxGpu.ramPixelH; y += clearBlockH) {
+            for (uint32_t x = 0; x < psxGpu.ramPixelW; x += clearBlockW) {
+                vgl::TextureRegionUpload& region = gVramUploadRegions.emplace_back();
+                region.srcBufferOffset = 0;
+                region.offsetX = x;
+                region.offsetY = y;
+                region.sizeX = std::min(clearBlockW, psxGpu.ramPixelW - x);
+                region.sizeY = std::min(clearBlockH, psxGpu.ramPixelH - y);
+            }
+        }
+
+        gPsxVramTexture.uploadRegions(stagingBuffer.vkBuffer, gVramUploadRegions.data(), (uint32_t) gVramUploadRegions.size());
+        gVramUploadRegions.clear();
     }
 
+    gVramDirtyRects.clear();
+
     // Initialize the draw command submission module, crossfader and loading plaque drawer
     VDrawing::init(gDevice, gPsxVramTexture);
     VCrossfader::init(gDevice);
@@ -642,6 +980,13 @@ void init() noexcept {
 
     // Try to init the swapchain and framebuffers
     ensureValidSwapchainAndFramebuffers();
+
+    // Start up the render thread if enabled
+    if (Config::gbVulkanRenderThread) {
+        gbRenderThreadShutdown = false;
+        gbFrameSubmitPending = false;
+        gRenderThread = std::thread(renderThreadMain);
+    }
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -653,6 +998,20 @@ void destroy() noexcept {
         endFrame();
     }
 
+    // Shut down the render thread (if active) once it has finished with the last frame
+    if (gRenderThread.joinable()) {
+        waitForRenderThread();
+
+        {
+            std::unique_lock lock(gRenderThreadMutex);
+            gbRenderThreadShutdown = true;
+        }
+
+        gRenderThreadCV.notify_all();
+        gRenderThread.join();
+        gbRenderThreadShutdown = false;
+    }
+
     // Wait for the device to finish before proceeding
     if (gDevice.isValid()) {
         gDevice.waitUntilDeviceIdle();
@@ -668,11 +1027,27 @@ void destroy() noexcept {
     gpNextRenderPath = nullptr;
     gpCurRenderPath = nullptr;
     gPsxVramTexture.destroy(true);
+    gVramDirtyRects.clear();
+    gVramDirtyRects.shrink_to_fit();
+    gVramUploadRegions.clear();
+    gVramUploadRegions.shrink_to_fit();
+
+    for (vgl::RawBuffer& stagingBuffer : gVramStagingBuffers) {
+        stagingBuffer.destroy(true);
+    }
+
+    gVramStagingBytesUsed = 0;
 
     for (vgl::CmdBuffer& cmdBuffer : gCmdBuffers) {
         cmdBuffer.destroy(true);
     }
 
+    VVideoCapture::destroy();
+    VFrameReadback::destroy();
+    VGpuTimings::destroy();
+    VDynamicRes::reset();
+    VFrameArena::destroy();
+
     for (vgl::Semaphore& semaphore : gRenderDoneSemaphores) {
         semaphore.destroy();
     }
@@ -692,6 +1067,7 @@ void destroy() noexcept {
     gSwapchain.destroy();
     gDevice.destroy();
     gDrawSampleCount = 0;
+    gDepthFormat = VK_FORMAT_UNDEFINED;
     gpPhysicalDevice = nullptr;
     gWindowSurface.destroy();
     gVulkanInstance.destroy();
@@ -713,9 +1089,27 @@ bool beginFrame() noexcept {
     ASSERT(!gbDidBeginFrame);
     gbDidBeginFrame = true;
 
+    // The render thread must be done with the previous frame before the swapchain, queues and ringbuffer are touched again
+    waitForRenderThread();
+
+    // All temporary allocations made by the world renderer for the previous frame are now finished with
+    VFrameArena::reset();
+
     // Do a render path switch if requested
     gpCurRenderPath = gpNextRenderPath;
 
+    // Read the GPU timings for the last frame to use this ringbuffer slot.
+    // The frame time is used for dynamic resolution scaling, which may change the resolution to render at.
+    if (VGpuTimings::readResults()) {
+        VDynamicRes::addGpuFrameTimeSample(VGpuTimings::getLastTimeMs(VGpuTimings::Scope::Frame));
+    }
+
+    // Save any frame read back by the last frame to use this ringbuffer slot
+    VFrameReadback::saveCompletedReadbacks();
+
+    // Hand any video frame captured by the last frame to use this ringbuffer slot to the encoder
+    VVideoCapture::submitCompletedCaptures();
+
     // Recreate the swapchain and framebuffers if required and bail if that operation failed
     if (!ensureValidSwapchainAndFramebuffers())
         return false;
@@ -727,7 +1121,9 @@ bool beginFrame() noexcept {
 
     if (gSwapchain.getAcquiredImageIdx() == vgl::Swapchain::INVALID_IMAGE_IDX) {
         swapchainIdx = gSwapchain.acquireImage(gSwapImageReadySemaphores[gCurSwapchainSemaphoreIdx]);
-        gbDidAcquireSwapImageThisFrame = (swapchainIdx != vgl::Swapchain::INVALID_IMAGE_IDX);
+
+        // Note: offscreen images don't signal the 'image ready' semaphore when acquired, so there is nothing to wait on
+        gbDidAcquireSwapImageThisFrame = ((swapchainIdx != vgl::Swapchain::INVALID_IMAGE_IDX) && (!gSwapchain.isOffscreen()));
     } else {
         swapchainIdx = gSwapchain.getAcquiredImageIdx();
         gbDidAcquireSwapImageThisFrame = false;
@@ -739,6 +1135,10 @@ bool beginFrame() noexcept {
     // Begin recording the command buffer for this frame
     gCmdBufferRec.beginPrimaryCmdBuffer(gCmdBuffers[ringbufferIdx], VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
 
+    // Start timing the GPU work for this frame
+    VGpuTimings::beginFrame(gCmdBufferRec);
+    VGpuTimings::beginScope(gCmdBufferRec, VGpuTimings::Scope::Frame);
+
     // The first command is to wait for any transfers to finish
     {
         VkMemoryBarrier barrier = {};
@@ -757,6 +1157,7 @@ bool beginFrame() noexcept {
     }
 
     // Render path specific frame start
+    VGpuTimings::beginScope(gCmdBufferRec, getRenderPathGpuTimingScope(*gpCurRenderPath));
     gpCurRenderPath->beginFrame(gSwapchain, gCmdBufferRec);
     return true;
 }
@@ -775,6 +1176,8 @@ bool isRendering() noexcept {
 // End the current frame and present to the screen
 //------------------------------------------------------------------------------------------------------------------------------------------
 void endFrame() noexcept {
+    PROFILE_SCOPE(VRendererEndFrame);
+
     // Must have begun the frame
     ASSERT(gbDidBeginFrame);
     gbDidBeginFrame = false;
@@ -791,71 +1194,98 @@ void endFrame() noexcept {
 
         // Finish up the frame for the render path
         gpCurRenderPath->endFrame(gSwapchain, gCmdBufferRec);
+        VGpuTimings::endScope(gCmdBufferRec, getRenderPathGpuTimingScope(*gpCurRenderPath));
+
+        // Read back the frame if rendering offscreen and the frame is one to be saved
+        if (!gbSkipNextFramePresent) {
+            VFrameReadback::recordReadback(gCmdBufferRec, gSwapchain);
+        }
     }
 
-    // Begin executing any pending transfers
+    // Upload any pending PSX VRAM updates and begin executing any pending transfers
+    flushPsxVramUpdates();
     vgl::TransferMgr& transferMgr = gDevice.getTransferMgr();
     transferMgr.executePreFrameTransferTask();
 
     // If we are not rendering a frame then simply wait until transfers have finished (device idle) and exit
     if (!isRendering()) {
         gDevice.waitUntilDeviceIdle();
+        gVramStagingBytesUsed = 0;
         return;
     }
 
     // End command recording and submit the command buffer to the device.
     // Wait for the current swapchain image to be acquired before executing this command buffer.
     // Signal the current ringbuffer slot fence when drawing is done.
+    VGpuTimings::endScope(gCmdBufferRec, VGpuTimings::Scope::Frame);
     gCmdBufferRec.endCmdBuffer();
 
     vgl::RingbufferMgr& ringbufferMgr = gDevice.getRingbufferMgr();
-    const uint32_t ringbufferIdx = ringbufferMgr.getBufferIndex();
 
-    {
-        // Conditions that the command buffer waits on.
-        // Just wait on the swap chain image to be acquired, unless we didn't actually have to acquire one this frame.
-        // Sometimes we might have just had a swap image due to a previous frame that wasn't presented...
-        std::vector<vgl::CmdBufferWaitCond> cmdBufferWaitConds;
-
-        if (gbDidAcquireSwapImageThisFrame) {
-            vgl::CmdBufferWaitCond& cmdsWaitCond = cmdBufferWaitConds.emplace_back();
-            cmdsWaitCond.pSemaphore = &gSwapImageReadySemaphores[gCurSwapchainSemaphoreIdx];
-            cmdsWaitCond.blockedStageFlags = VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT;
-        }
+    FrameSubmit frame = {};
+    frame.ringbufferIdx = ringbufferMgr.getBufferIndex();
+    frame.pRingbufferSlotFence = &ringbufferMgr.getCurrentBufferFence();
+    frame.swapSemaphoreIdx = gCurSwapchainSemaphoreIdx;
+    frame.bWaitOnSwapImage = gbDidAcquireSwapImageThisFrame;
+    frame.bPresent = (!gbSkipNextFramePresent);
 
-        // Note: signal the render done semaphore and the ringbuffer slot fence when finished.
-        // Skip signalling the render semaphore however if we are not presenting, as the swapchain will not be able to consume it.
-        // It needs to be in an unsignalled state the next time we go to use it...
-        vgl::Fence& ringbufferSlotFence = ringbufferMgr.getCurrentBufferFence();
-        vgl::Semaphore* pSignalSemaphore = (gbSkipNextFramePresent) ? nullptr : &gRenderDoneSemaphores[ringbufferIdx];
-
-        gDevice.submitCmdBuffer(
-            gCmdBuffers[ringbufferIdx],
-            cmdBufferWaitConds,
-            pSignalSemaphore,
-            &ringbufferSlotFence
-        );
-    }
+    if (frame.bPresent) {
+        // Only the first input sample after each present is measured, as that is the oldest input making it into the frame
+        frame.bMeasureInputLatency = gbHaveUnpresentedInputSample;
+        frame.inputSampleTime = gInputSampleTime;
+        gbHaveUnpresentedInputSample = false;
 
-    // Present the current swapchain image once all the commands have finished, unless skip was requested.
-    // Also use a different semaphore (if presenting) for the next frame.
-    if (!gbSkipNextFramePresent) {
-        gSwapchain.presentAcquiredImage(gRenderDoneSemaphores[ringbufferIdx]);
+        // Use a different semaphore for the next frame
         gCurSwapchainSemaphoreIdx ^= 1;
+    }
+
+    // Submit and present the frame: this is handed to the render thread if there is one.
+    // Skipped frames are handled synchronously since we must wait for all of their commands to finish anyway.
+    if (gRenderThread.joinable() && frame.bPresent) {
+        {
+            std::unique_lock lock(gRenderThreadMutex);
+            gPendingFrameSubmit = frame;
+            gbFrameSubmitPending = true;
+        }
+
+        gRenderThreadCV.notify_all();
+
+        // If frames in flight are being limited then acquiring the next ringbuffer slot waits on the fence for this frame.
+        // That fence must be submitted first, so wait for the render thread in that case.
+        if (ringbufferMgr.getMaxFramesInFlight() < vgl::Defines::RINGBUFFER_SIZE) {
+            waitForRenderThread();
+        }
     } else {
-        // Skipping showing this frame? Don't bother presenting, and wait for all commands to finish
-        gDevice.waitUntilDeviceIdle();
-        gbSkipNextFramePresent = false;
+        submitAndPresentFrame(frame);
+
+        // Skipping showing this frame? Wait for all commands to finish
+        if (!frame.bPresent) {
+            gDevice.waitUntilDeviceIdle();
+            gbSkipNextFramePresent = false;
+        }
     }
 
     // Move onto the next ringbuffer index and clear the command buffer used: will get it again once we begin a frame.
     gbDidAcquireSwapImageThisFrame = false;
     ringbufferMgr.acquireNextBuffer();
+    gVramStagingBytesUsed = 0;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Copies a rectangular area of pixels (of at least 1x1 pixels) from the PSX GPU's VRAM to the Vulkan texture that mirrors it.
-// This makes updates to PSX VRAM visible to the new native Vulkan renderer.
+// Waits until all submitted frames and GPU work have finished, including any frame still being handed over to the render thread.
+// This should be used instead of waiting on the logical device directly, since the device queues must not be used by 2 threads at once.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void waitUntilDeviceIdle() noexcept {
+    waitForRenderThread();
+
+    if (gDevice.isValid()) {
+        gDevice.waitUntilDeviceIdle();
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Marks a rectangular area of pixels (of at least 1x1 pixels) in the PSX GPU's VRAM as needing to be copied to the Vulkan texture that
+// mirrors it. This makes updates to PSX VRAM visible to the new native Vulkan renderer once the pending updates are flushed.
 //------------------------------------------------------------------------------------------------------------------------------------------
 void pushPsxVramUpdates(const uint16_t rectLx, const uint16_t rectRx, const uint16_t rectTy, const uint16_t rectBy) noexcept {
     // Sanity check the rectangle bounds.
@@ -886,23 +1316,136 @@ void pushPsxVramUpdates(const uint16_t rectLx, const uint16_t rectRx, const uint
         return;
     }
 
-    // This is the size of the area to be updated and the number of bytes in each row
-    const uint32_t copyRectW = (uint32_t) rectRx + 1 - rectLx;
-    const uint32_t copyRectH = (uint32_t) rectBy + 1 - rectTy;
-    const uint32_t copyRowSize = copyRectW * sizeof(uint16_t);
+    // Merge the update rect with existing dirty rects where that can be done without growing the area uploaded.
+    // Existing rects which are contained within the update rect are discarded, and if the update rect is contained within an existing rect
+    // then there is nothing to do. Rects which line up exactly with the update rect along one axis and touch or overlap it along the other
+    // are combined with it; this is repeated since the combined rect might in turn line up with another existing rect.
+    VramDirtyRect newRect = { rectLx, rectRx, rectTy, rectBy };
+
+    for (size_t rectIdx = 0; rectIdx < gVramDirtyRects.size();) {
+        const VramDirtyRect rect = gVramDirtyRects[rectIdx];
 
-    // Lock the required region of the texture and copy in the updates, row by row
-    uint16_t* pDstBytes = (uint16_t*) gPsxVramTexture.lock(rectLx, rectTy, 0, 0, copyRectW, copyRectH, 1, 1);
-    const uint16_t* pSrcBytes = psxGpu.pRam + rectLx + ((uintptr_t) rectTy * vramW);
+        const bool bContainsNewRect = (
+            (rect.lx <= newRect.lx) && (rect.rx >= newRect.rx) &&
+            (rect.ty <= newRect.ty) && (rect.by >= newRect.by)
+        );
+
+        if (bContainsNewRect)
+            return;
 
-    for (uint32_t row = 0; row < copyRectH; ++row) {
-        std::memcpy(pDstBytes, pSrcBytes, copyRowSize);
-        pDstBytes += copyRectW;
-        pSrcBytes += vramW;
+        const bool bInsideNewRect = (
+            (newRect.lx <= rect.lx) && (newRect.rx >= rect.rx) &&
+            (newRect.ty <= rect.ty) && (newRect.by >= rect.by)
+        );
+
+        const bool bMergeVertically = (
+            (rect.lx == newRect.lx) && (rect.rx == newRect.rx) &&
+            (rect.ty <= newRect.by + 1) && (newRect.ty <= rect.by + 1)
+        );
+
+        const bool bMergeHorizontally = (
+            (rect.ty == newRect.ty) && (rect.by == newRect.by) &&
+            (rect.lx <= newRect.rx + 1) && (newRect.lx <= rect.rx + 1)
+        );
+
+        if ((!bInsideNewRect) && (!bMergeVertically) && (!bMergeHorizontally)) {
+            ++rectIdx;
+            continue;
+        }
+
+        // Absorb this rect into the update rect and remove it, then check all of the remaining rects again against the combined rect
+        newRect.lx = std::min(newRect.lx, rect.lx);
+        newRect.rx = std::max(newRect.rx, rect.rx);
+        newRect.ty = std::min(newRect.ty, rect.ty);
+        newRect.by = std::max(newRect.by, rect.by);
+
+        gVramDirtyRects[rectIdx] = gVramDirtyRects.back();
+        gVramDirtyRects.pop_back();
+        rectIdx = 0;
+    }
+
+    gVramDirtyRects.push_back(newRect);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Copies all areas of the PSX GPU's VRAM which have pending updates to the Vulkan texture that mirrors it.
+// All of the dirty rectangles are uploaded together using a single copy command from a persistently mapped staging buffer owned by the
+// current ringbuffer slot. This is called automatically at the end of every frame but can be called earlier to make the updates happen sooner.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void flushPsxVramUpdates() noexcept {
+    if (gVramDirtyRects.empty())
+        return;
+
+    // Finish any deferred PSX GPU draws before reading VRAM
+    Gpu::Core& psxGpu = PsxVm::gGpu;
+    Gpu::flushDeferredDraws(psxGpu);
+
+    const uint32_t vramW = psxGpu.ramPixelW;
+
+    // Figure out where each dirty region will go in the staging buffer.
+    // Note: the data for each region must start on an aligned boundary in the staging buffer.
+    gVramUploadRegions.clear();
+    const uint64_t stagingBufferStart = gVramStagingBytesUsed;
+    uint64_t stagingBufferSize = stagingBufferStart;
+
+    for (const VramDirtyRect& rect : gVramDirtyRects) {
+        vgl::TextureRegionUpload& region = gVramUploadRegions.emplace_back();
+        region.srcBufferOffset = stagingBufferSize;
+        region.offsetX = rect.lx;
+        region.offsetY = rect.ty;
+        region.sizeX = (uint32_t) rect.rx + 1 - rect.lx;
+        region.sizeY = (uint32_t) rect.by + 1 - rect.ty;
+
+        const uint64_t regionSize = (uint64_t) region.sizeX * region.sizeY * sizeof(uint16_t);
+        constexpr uint64_t ALIGN_MASK = vgl::Defines::MIN_IMAGE_ALIGNMENT - 1;
+        stagingBufferSize = (stagingBufferSize + regionSize + ALIGN_MASK) & ~ALIGN_MASK;
+    }
+
+    gVramDirtyRects.clear();
+
+    // Grow the staging buffer for this ringbuffer slot if it can't hold all the regions.
+    // If the buffer is still in use by transfers already recorded this frame then it is retired rather than destroyed immediately,
+    // and the new buffer is filled from the start. The new buffer is given some slack to avoid regrowing again in the near future.
+    vgl::RawBuffer& stagingBuffer = gVramStagingBuffers[gDevice.getRingbufferMgr().getBufferIndex()];
+
+    if (stagingBufferSize > stagingBuffer.getSize()) {
+        if (stagingBufferStart > 0) {
+            for (vgl::TextureRegionUpload& region : gVramUploadRegions) {
+                region.srcBufferOffset -= stagingBufferStart;
+            }
+
+            stagingBufferSize -= stagingBufferStart;
+        }
+
+        stagingBuffer.destroy();
+
+        if (!stagingBuffer.init(gDevice, stagingBufferSize + stagingBufferSize / 2, vgl::DeviceMemAllocMode::REQUIRE_HOST_VISIBLE, VK_BUFFER_USAGE_TRANSFER_SRC_BIT)) {
+            ASSERT_FAIL("Failed to allocate a PSX VRAM staging buffer!");
+            gVramStagingBytesUsed = 0;
+            return;
+        }
     }
 
-    // Unlock the texture to begin uploading the updates
-    gPsxVramTexture.unlock();
+    gVramStagingBytesUsed = stagingBufferSize;
+
+    // Copy in the updates for each region, row by row
+    std::byte* const pStagingBytes = stagingBuffer.getBytes();
+    ASSERT(pStagingBytes);
+
+    for (const vgl::TextureRegionUpload& region : gVramUploadRegions) {
+        uint16_t* pDstPixels = (uint16_t*)(pStagingBytes + region.srcBufferOffset);
+        const uint16_t* pSrcPixels = psxGpu.pRam + region.offsetX + ((uintptr_t) region.offsetY * vramW);
+        const uint32_t copyRowSize = region.sizeX * sizeof(uint16_t);
+
+        for (uint32_t row = 0; row < region.sizeY; ++row) {
+            std::memcpy(pDstPixels, pSrcPixels, copyRowSize);
+            pDstPixels += region.sizeX;
+            pSrcPixels += vramW;
+        }
+    }
+
+    // Schedule the upload of all the regions
+    gPsxVramTexture.uploadRegions(stagingBuffer.getVkBuffer(), gVramUploadRegions.data(), (uint32_t) gVramUploadRegions.size());
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -976,6 +1519,10 @@ bool willSkipNextFramePresent() noexcept {
 // Tells if the swapchain size is out of date and thus whether it needs to be recreated
 //------------------------------------------------------------------------------------------------------------------------------------------
 bool isSwapchainOutOfDate() noexcept {
+    // Offscreen images never go out of date since there is no window to be resized
+    if (gSwapchain.isOffscreen())
+        return (!gSwapchain.isValid());
+
     // We're always out of date if we have an invalid swapchain or window surface
     if ((!gSwapchain.isValid()) || (!gWindowSurface.isValid()))
         return true;
@@ -986,6 +1533,33 @@ bool isSwapchainOutOfDate() noexcept {
     return ((winW != (int) gSwapchain.getSwapExtentWidth()) || (winH != (int) gSwapchain.getSwapExtentHeight()));
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Notifies the renderer that player inputs were just sampled for the next game tick, for the purposes of measuring input latency.
+// If inputs are sampled multiple times before a frame is presented, then only the first (oldest) sample is measured.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void markInputsSampled() noexcept {
+    if (!gbHaveUnpresentedInputSample) {
+        gInputSampleTime = latencytimer_t::now();
+        gbHaveUnpresentedInputSample = true;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Returns the average delay (in microseconds) between inputs being sampled and the resulting frame being queued for presentation, for all
+// frames presented since this was last called. Resets the measurement afterwards. Returns 'false' if no frames were measured.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool takeAvgInputToPresentUsec(double& avgUsecOut) noexcept {
+    std::unique_lock lock(gRenderThreadMutex);
+
+    if (gNumInputLatencySamples <= 0)
+        return false;
+
+    avgUsecOut = gTotalInputLatencyUsec / (double) gNumInputLatencySamples;
+    gTotalInputLatencyUsec = 0.0;
+    gNumInputLatencySamples = 0;
+    return true;
+}
+
 END_NAMESPACE(VRenderer)
 
 #endif  // #if PSYDOOM_VULKAN_RENDERER
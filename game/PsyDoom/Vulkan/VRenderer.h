@@ -57,7 +57,9 @@ void destroy() noexcept;
 bool beginFrame() noexcept;
 bool isRendering() noexcept;
 void endFrame() noexcept;
+void waitUntilDeviceIdle() noexcept;
 void pushPsxVramUpdates(const uint16_t rectLx, const uint16_t rectRx, const uint16_t rectTy, const uint16_t rectBy) noexcept;
+void flushPsxVramUpdates() noexcept;
 void initRendererUniformFields(VShaderUniforms_Draw& uniforms) noexcept;
 IVRendererPath& getActiveRenderPath() noexcept;
 IVRendererPath& getNextRenderPath() noexcept;
@@ -68,6 +70,8 @@ void switchToMainVulkanRenderPath() noexcept;
 void skipNextFramePresent() noexcept;
 bool willSkipNextFramePresent() noexcept;
 bool isSwapchainOutOfDate() noexcept;
+void markInputsSampled() noexcept;
+bool takeAvgInputToPresentUsec(double& avgUsecOut) noexcept;
 
 END_NAMESPACE(VRenderer)
 
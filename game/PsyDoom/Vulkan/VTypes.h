@@ -27,6 +27,13 @@ enum class VPipelineType : uint8_t {
     World_SpriteAdditive,       // 3D world/view: textured with clamping @ 8bpp and lit, masked & additive blended
     World_SpriteSubtractive,    // 3D world/view: textured with clamping @ 8bpp and lit, masked & subtractive blended
     World_Sky,                  // 3D world/view: used to draw the sky, masked but no blending
+    World_GeomMasked_DepthWrite,        // Depth tested world drawing: same as 'World_GeomMasked' but also depth tested and written
+    World_GeomAlpha_DepthTest,          // Depth tested world drawing: same as 'World_GeomAlpha' but also depth tested
+    World_SpriteMasked_DepthTest,       // Depth tested world drawing: same as 'World_SpriteMasked' but also depth tested
+    World_SpriteAlpha_DepthTest,        // Depth tested world drawing: same as 'World_SpriteAlpha' but also depth tested
+    World_SpriteAdditive_DepthTest,     // Depth tested world drawing: same as 'World_SpriteAdditive' but also depth tested
+    World_SpriteSubtractive_DepthTest,  // Depth tested world drawing: same as 'World_SpriteSubtractive' but also depth tested
+    World_Sky_DepthTest,                // Depth tested world drawing: same as 'World_Sky' but also depth tested
     Msaa_Resolve,               // Simple shader that resolves MSAA samples
     Crossfade,                  // Used for doing crossfades
     LoadingPlaque,              // Used for drawing loading plaques
@@ -104,6 +111,13 @@ struct VVertex_Draw {
     uint8_t stmulR, stmulG, stmulB, stmulA;
 };
 
+// Keep an eye on the size of the draw vertex since it dominates the per-frame vertex ringbuffer bandwidth.
+// Note: the UVs must remain full 32-bit floats since world geometry specifies them in texels and they can run into the thousands
+// (long walls, flats using world coordinates), which is far beyond what half floats can represent with sub-texel precision.
+// All the other fields are already packed down to 8 or 16-bits. The size must also be a multiple of 4 for vertex attribute alignment.
+static_assert(sizeof(VVertex_Draw) == 40);
+static_assert(sizeof(VVertex_Draw) % 4 == 0);
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Vulkan renderer vertex type: used for MSAA resolve and just contains a 2D position in normalized device coords
 //------------------------------------------------------------------------------------------------------------------------------------------
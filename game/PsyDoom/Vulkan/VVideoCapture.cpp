@@ -0,0 +1,489 @@
+//------------------------------------------------------------------------------------------------------------------------------------------
+// This module captures gameplay video from the Vulkan renderer ('-vkcapture' switch), without relying on external screen capture.
+// The final output of the main render path (after any MSAA resolve) is copied into host visible buffers as part of each frame's
+// command buffer, and the buffers are handed to an encoder thread which converts them to YUV 4:2:0 and writes a '.y4m' (YUV4MPEG2) stream.
+// The stream can go to a file, or be piped to an external program such as 'ffmpeg' by giving an output that begins with '|'.
+//
+// None of this ever blocks the render thread:
+//  (1) A captured frame is only handed over once the renderer has waited on the fence for the frame's ringbuffer slot, which it does anyway.
+//  (2) The encoder thread reads the pixels straight out of the mapped buffer and then returns the buffer to a small pool of free buffers.
+//  (3) If the encoder falls behind and no buffer is free then the frame is simply not captured.
+//
+// Frames are captured at a fixed rate: a frame is only copied if it is the first in a new frame period, and the encoder repeats the last
+// frame for any periods which had no frame. This keeps the video in sync with real time regardless of how fast the game is rendering.
+//------------------------------------------------------------------------------------------------------------------------------------------
+#include "VVideoCapture.h"
+
+#if PSYDOOM_VULKAN_RENDERER
+
+#include "Asserts.h"
+#include "CmdBufferRecorder.h"
+#include "DeviceMemAlloc.h"
+#include "LogicalDevice.h"
+#include "PsyDoom/ProgArgs.h"
+#include "RawBuffer.h"
+#include "RingbufferMgr.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+BEGIN_NAMESPACE(VVideoCapture)
+
+// How many capture buffers there are in addition to the ones in use by frames in flight.
+// These give the encoder thread some slack before frames start being dropped.
+static constexpr uint32_t NUM_SPARE_CAPTURES = 4;
+static constexpr uint32_t NUM_CAPTURES = vgl::Defines::RINGBUFFER_SIZE + NUM_SPARE_CAPTURES;
+
+// A frame being captured, or a buffer that can be used to capture a frame
+struct Capture {
+    vgl::RawBuffer  buffer;         // Host visible buffer that the frame is copied to
+    uint64_t        framePeriod;    // Which frame period (since capture started) the frame was captured in
+    uint32_t        width;          // Size of the frame captured
+    uint32_t        height;
+    VkFormat        format;         // Pixel format of the frame captured
+};
+
+static vgl::LogicalDevice*                      gpDevice;                                           // The device to capture from, null if capture is disabled
+static Capture                                  gCaptures[NUM_CAPTURES];                            // All capture buffers
+static Capture*                                 gpSlotCaptures[vgl::Defines::RINGBUFFER_SIZE];      // Capture recorded by each ringbuffer slot (render thread only)
+static std::chrono::steady_clock::time_point    gStartTime;                                         // When capture started
+static uint64_t                                 gNextFramePeriod;                                   // Next frame period to capture a frame for (render thread only)
+static uint32_t                                 gNumDroppedFrames;                                  // Frames not captured because no buffer was free (render thread only)
+static std::FILE*                               gpOutputFile;                                       // The file or pipe that the video is written to
+static bool                                     gbOutputIsPipe;                                     // True if the output was opened with 'popen'
+static std::thread                              gEncoderThread;                                     // Converts and writes captured frames
+
+// Encoder thread state: all guarded by the mutex
+static std::mutex                   gMutex;
+static std::condition_variable      gEncoderCV;             // Signalled when there is a frame to encode or when the encoder should quit
+static std::deque<Capture*>         gEncodeQueue;           // Captured frames waiting to be encoded, in order
+static std::vector<Capture*>        gFreeCaptures;          // Capture buffers which are free for the render thread to use
+static bool                         gbEncoderQuit;          // Tells the encoder thread to encode all queued frames and then exit
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Opens the file or pipe that the video is to be written to
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool openOutput(const char* const output) noexcept {
+    gbOutputIsPipe = (output[0] == '|');
+
+    if (gbOutputIsPipe) {
+        #if _WIN32
+            gpOutputFile = _popen(output + 1, "wb");
+        #else
+            gpOutputFile = popen(output + 1, "w");
+        #endif
+    } else {
+        gpOutputFile = std::fopen(output, "wb");
+    }
+
+    return (gpOutputFile != nullptr);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Closes the file or pipe that the video is written to
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void closeOutput() noexcept {
+    if (!gpOutputFile)
+        return;
+
+    if (gbOutputIsPipe) {
+        #if _WIN32
+            _pclose(gpOutputFile);
+        #else
+            pclose(gpOutputFile);
+        #endif
+    } else {
+        std::fclose(gpOutputFile);
+    }
+
+    gpOutputFile = nullptr;
+    gbOutputIsPipe = false;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Converts the pixels of a captured frame to 8-bit RGB.
+// Returns 'false' if the frame is in a pixel format that is not supported for capture.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool getCaptureRgbPixels(const Capture& capture, std::vector<uint8_t>& rgbPixels) noexcept {
+    const uint32_t numPixels = capture.width * capture.height;
+    const std::byte* const pSrcBytes = capture.buffer.getBytes();
+    rgbPixels.resize((size_t) numPixels * 3);
+    uint8_t* pDstPixels = rgbPixels.data();
+
+    if ((capture.format == VK_FORMAT_B8G8R8A8_UNORM) || (capture.format == VK_FORMAT_R8G8B8A8_UNORM)) {
+        const uint32_t rIdx = (capture.format == VK_FORMAT_B8G8R8A8_UNORM) ? 2 : 0;
+        const uint32_t bIdx = 2 - rIdx;
+        const std::byte* pSrcPixels = pSrcBytes;
+
+        for (uint32_t i = 0; i < numPixels; ++i, pSrcPixels += 4, pDstPixels += 3) {
+            pDstPixels[0] = (uint8_t) pSrcPixels[rIdx];
+            pDstPixels[1] = (uint8_t) pSrcPixels[1];
+            pDstPixels[2] = (uint8_t) pSrcPixels[bIdx];
+        }
+
+        return true;
+    }
+
+    if (capture.format == VK_FORMAT_A1R5G5B5_UNORM_PACK16) {
+        const uint16_t* const pSrcPixels = (const uint16_t*) pSrcBytes;
+
+        for (uint32_t i = 0; i < numPixels; ++i, pDstPixels += 3) {
+            const uint16_t color = pSrcPixels[i];
+            const uint32_t r5 = (color >> 10) & 0x1Fu;
+            const uint32_t g5 = (color >> 5) & 0x1Fu;
+            const uint32_t b5 = color & 0x1Fu;
+            pDstPixels[0] = (uint8_t)((r5 << 3) | (r5 >> 2));
+            pDstPixels[1] = (uint8_t)((g5 << 3) | (g5 >> 2));
+            pDstPixels[2] = (uint8_t)((b5 << 3) | (b5 >> 2));
+        }
+
+        return true;
+    }
+
+    return false;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Converts 8-bit RGB pixels to planar YUV 4:2:0 (BT.601, limited range) with chroma averaged over each 2x2 block of pixels.
+// The output is the Y plane followed by the U and V planes, as expected by the YUV4MPEG2 format.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void rgbToYuv420(const uint8_t* const pRgb, const uint32_t width, const uint32_t height, std::vector<uint8_t>& yuv) noexcept {
+    const uint32_t chromaW = (width + 1) / 2;
+    const uint32_t chromaH = (height + 1) / 2;
+    const size_t lumaSize = (size_t) width * height;
+    const size_t chromaSize = (size_t) chromaW * chromaH;
+    yuv.resize(lumaSize + chromaSize * 2);
+
+    uint8_t* const pY = yuv.data();
+    uint8_t* const pU = pY + lumaSize;
+    uint8_t* const pV = pU + chromaSize;
+
+    for (uint32_t y = 0; y < height; ++y) {
+        const uint8_t* pSrc = pRgb + (size_t) y * width * 3;
+        uint8_t* pDst = pY + (size_t) y * width;
+
+        for (uint32_t x = 0; x < width; ++x, pSrc += 3) {
+            const int32_t r = pSrc[0];
+            const int32_t g = pSrc[1];
+            const int32_t b = pSrc[2];
+            *pDst++ = (uint8_t)(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+        }
+    }
+
+    for (uint32_t cy = 0; cy < chromaH; ++cy) {
+        for (uint32_t cx = 0; cx < chromaW; ++cx) {
+            // Average the 2x2 block of pixels, clamping to the edges of the image when the size is odd
+            const uint32_t x1 = cx * 2;
+            const uint32_t y1 = cy * 2;
+            const uint32_t x2 = (x1 + 1 < width) ? x1 + 1 : x1;
+            const uint32_t y2 = (y1 + 1 < height) ? y1 + 1 : y1;
+            const uint8_t* const p11 = pRgb + ((size_t) y1 * width + x1) * 3;
+            const uint8_t* const p21 = pRgb + ((size_t) y1 * width + x2) * 3;
+            const uint8_t* const p12 = pRgb + ((size_t) y2 * width + x1) * 3;
+            const uint8_t* const p22 = pRgb + ((size_t) y2 * width + x2) * 3;
+
+            const int32_t r = (p11[0] + p21[0] + p12[0] + p22[0] + 2) / 4;
+            const int32_t g = (p11[1] + p21[1] + p12[1] + p22[1] + 2) / 4;
+            const int32_t b = (p11[2] + p21[2] + p12[2] + p22[2] + 2) / 4;
+
+            const size_t chromaIdx = (size_t) cy * chromaW + cx;
+            pU[chromaIdx] = (uint8_t)(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+            pV[chromaIdx] = (uint8_t)(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Encoder thread: converts captured frames to YUV and writes them to the output until told to quit.
+// The size of the video is decided by the first frame; frames of any other size (after a window resize for example) are skipped.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void encoderThreadMain() noexcept {
+    std::vector<uint8_t> rgbPixels;
+    std::vector<uint8_t> yuvPixels;
+    uint32_t videoW = 0;
+    uint32_t videoH = 0;
+    uint64_t numPeriodsWritten = 0;
+    bool bWriteError = false;
+    bool bWarnedSizeChange = false;
+    bool bWarnedFormat = false;
+
+    while (true) {
+        // Wait for a frame to encode or for the signal to quit, once all frames are encoded
+        Capture* pCapture = nullptr;
+
+        {
+            std::unique_lock<std::mutex> lock(gMutex);
+            gEncoderCV.wait(lock, []() noexcept { return (!gEncodeQueue.empty()) || gbEncoderQuit; });
+
+            if (gEncodeQueue.empty())
+                break;
+
+            pCapture = gEncodeQueue.front();
+            gEncodeQueue.pop_front();
+        }
+
+        // Convert the frame to YUV and return the capture buffer to the free pool: the frame data is no longer needed after conversion
+        const uint32_t width = pCapture->width;
+        const uint32_t height = pCapture->height;
+        const uint64_t framePeriod = pCapture->framePeriod;
+        const bool bGotPixels = getCaptureRgbPixels(*pCapture, rgbPixels);
+
+        {
+            std::lock_guard<std::mutex> lock(gMutex);
+            gFreeCaptures.push_back(pCapture);
+        }
+
+        if (!bGotPixels) {
+            if (!bWarnedFormat) {
+                std::printf("VVideoCapture: unsupported framebuffer format for capture, frames will be skipped!\n");
+                bWarnedFormat = true;
+            }
+
+            continue;
+        }
+
+        if ((videoW == 0) && (!bWriteError)) {
+            videoW = width;
+            videoH = height;
+            numPeriodsWritten = framePeriod;
+
+            if (std::fprintf(gpOutputFile, "YUV4MPEG2 W%u H%u F%d:1 Ip A1:1 C420jpeg XCOLORRANGE=LIMITED\n", videoW, videoH, ProgArgs::gVkCaptureFps) < 0) {
+                bWriteError = true;
+            }
+        }
+
+        if ((width != videoW) || (height != videoH)) {
+            if (!bWarnedSizeChange) {
+                std::printf("VVideoCapture: framebuffer size changed from %ux%u to %ux%u, frames will be skipped!\n", videoW, videoH, width, height);
+                bWarnedSizeChange = true;
+            }
+
+            continue;
+        }
+
+        if (bWriteError)
+            continue;
+
+        // Write the frame for its period and repeat it for any earlier periods that didn't get a frame
+        rgbToYuv420(rgbPixels.data(), width, height, yuvPixels);
+
+        while ((numPeriodsWritten <= framePeriod) && (!bWriteError)) {
+            const bool bWroteFrame = (
+                (std::fputs("FRAME\n", gpOutputFile) >= 0) &&
+                (std::fwrite(yuvPixels.data(), 1, yuvPixels.size(), gpOutputFile) == yuvPixels.size())
+            );
+
+            if (!bWroteFrame) {
+                std::printf("VVideoCapture: failed to write to the video output, capture will stop!\n");
+                bWriteError = true;
+            }
+
+            numPeriodsWritten++;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Initializes video capture using the given device if it has been requested via program arguments
+//------------------------------------------------------------------------------------------------------------------------------------------
+void init(vgl::LogicalDevice& device) noexcept {
+    if (ProgArgs::gVkCaptureFps <= 0)
+        return;
+
+    if (!openOutput(ProgArgs::gVkCaptureOutput)) {
+        std::printf("VVideoCapture: failed to open video output '%s'! Capture will be disabled.\n", ProgArgs::gVkCaptureOutput);
+        return;
+    }
+
+    gpDevice = &device;
+    gStartTime = std::chrono::steady_clock::now();
+    gNextFramePeriod = 0;
+    gNumDroppedFrames = 0;
+    gbEncoderQuit = false;
+
+    for (Capture*& pSlotCapture : gpSlotCaptures) {
+        pSlotCapture = nullptr;
+    }
+
+    gFreeCaptures.clear();
+
+    for (Capture& capture : gCaptures) {
+        gFreeCaptures.push_back(&capture);
+    }
+
+    gEncoderThread = std::thread(encoderThreadMain);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Encodes any pending captures, stops the encoder thread and releases the capture buffers. The device must be idle when this is called.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void destroy() noexcept {
+    if (!isEnabled())
+        return;
+
+    // Hand over all of the frames in flight (these are complete since the device is idle) and wait for the encoder to finish
+    {
+        std::lock_guard<std::mutex> lock(gMutex);
+
+        for (Capture*& pSlotCapture : gpSlotCaptures) {
+            if (pSlotCapture) {
+                gEncodeQueue.push_back(pSlotCapture);
+                pSlotCapture = nullptr;
+            }
+        }
+
+        gbEncoderQuit = true;
+    }
+
+    gEncoderCV.notify_one();
+    gEncoderThread.join();
+    closeOutput();
+
+    if (gNumDroppedFrames > 0) {
+        std::printf("VVideoCapture: %u frame(s) were dropped because the encoder could not keep up.\n", gNumDroppedFrames);
+    }
+
+    // Cleanup everything else
+    for (Capture& capture : gCaptures) {
+        capture.buffer.destroy(true);
+        capture.framePeriod = 0;
+        capture.width = 0;
+        capture.height = 0;
+        capture.format = {};
+    }
+
+    gFreeCaptures.clear();
+    gEncodeQueue.clear();
+    gbEncoderQuit = false;
+    gpDevice = nullptr;
+    gNextFramePeriod = 0;
+    gNumDroppedFrames = 0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tells if video capture is active
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool isEnabled() noexcept {
+    return (gpDevice != nullptr);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Hands the frame captured by the last frame to use the current ringbuffer slot (if any) to the encoder thread.
+// The slot's fence must have been waited on already, so the copy to the capture buffer is known to be complete.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void submitCompletedCaptures() noexcept {
+    if (!isEnabled())
+        return;
+
+    Capture*& pSlotCapture = gpSlotCaptures[gpDevice->getRingbufferMgr().getBufferIndex()];
+
+    if (!pSlotCapture)
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(gMutex);
+        gEncodeQueue.push_back(pSlotCapture);
+    }
+
+    pSlotCapture = nullptr;
+    gEncoderCV.notify_one();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Should be called by the main render path once it has finished producing the frame in the given image, before the image is next written.
+// If a frame is due to be captured then records commands to copy the image to a free capture buffer for the current ringbuffer slot.
+// The image is expected to be in the transfer source layout and all writes to it must have been made available to transfers already.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void recordCapture(
+    vgl::CmdBufferRecorder& cmdRec,
+    const VkImage srcImage,
+    const VkFormat srcFormat,
+    const uint32_t width,
+    const uint32_t height
+) noexcept {
+    if (!isEnabled())
+        return;
+
+    // Only capture the first frame in each frame period
+    const std::chrono::duration<double> elapsedTime = std::chrono::steady_clock::now() - gStartTime;
+    const uint64_t framePeriod = (uint64_t)(elapsedTime.count() * ProgArgs::gVkCaptureFps);
+
+    if (framePeriod < gNextFramePeriod)
+        return;
+
+    // Grab a free capture buffer, or drop the frame if there are none because the encoder is behind.
+    // Note: if there was a capture in this slot then it would have been given to the encoder already at the start of the frame.
+    Capture*& pSlotCapture = gpSlotCaptures[gpDevice->getRingbufferMgr().getBufferIndex()];
+    ASSERT(!pSlotCapture);
+
+    Capture* pCapture = nullptr;
+
+    {
+        std::lock_guard<std::mutex> lock(gMutex);
+
+        if (!gFreeCaptures.empty()) {
+            pCapture = gFreeCaptures.back();
+            gFreeCaptures.pop_back();
+        }
+    }
+
+    if (!pCapture) {
+        gNumDroppedFrames++;
+        return;
+    }
+
+    // Make sure the capture buffer is big enough
+    const uint32_t bytesPerPixel = (srcFormat == VK_FORMAT_A1R5G5B5_UNORM_PACK16) ? 2 : 4;
+    const uint64_t bufferSize = (uint64_t) width * height * bytesPerPixel;
+
+    if ((!pCapture->buffer.isValid()) || (pCapture->buffer.getSize() < bufferSize)) {
+        pCapture->buffer.destroy();
+
+        if (!pCapture->buffer.init(*gpDevice, bufferSize, vgl::DeviceMemAllocMode::REQUIRE_HOST_VISIBLE, VK_BUFFER_USAGE_TRANSFER_DST_BIT)) {
+            std::printf("VVideoCapture: failed to create a %ux%u capture buffer!\n", width, height);
+
+            std::lock_guard<std::mutex> lock(gMutex);
+            gFreeCaptures.push_back(pCapture);
+            return;
+        }
+    }
+
+    // Copy the image to the buffer
+    {
+        VkBufferImageCopy copyRegion = {};
+        copyRegion.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        copyRegion.imageSubresource.layerCount = 1;
+        copyRegion.imageExtent.width = width;
+        copyRegion.imageExtent.height = height;
+        copyRegion.imageExtent.depth = 1;
+
+        cmdRec.copyImageToBuffer(srcImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, pCapture->buffer.getVkBuffer(), 1, &copyRegion);
+    }
+
+    // Make the copied pixels visible to the host once the frame's fence is signalled
+    {
+        VkMemoryBarrier barrier = {};
+        barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+
+        cmdRec.addPipelineBarrier(VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 1, &barrier, 0, nullptr);
+    }
+
+    // Save the details of the capture: it is handed to the encoder once the GPU is done with the frame
+    pCapture->framePeriod = framePeriod;
+    pCapture->width = width;
+    pCapture->height = height;
+    pCapture->format = srcFormat;
+    pSlotCapture = pCapture;
+    gNextFramePeriod = framePeriod + 1;
+}
+
+END_NAMESPACE(VVideoCapture)
+
+#endif  // #if PSYDOOM_VULKAN_RENDERER
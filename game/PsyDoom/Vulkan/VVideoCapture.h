@@ -0,0 +1,32 @@
+#pragma once
+
+#if PSYDOOM_VULKAN_RENDERER
+
+#include "Macros.h"
+
+#include <cstdint>
+#include <vulkan/vulkan.h>
+
+namespace vgl {
+    class CmdBufferRecorder;
+    class LogicalDevice;
+}
+
+BEGIN_NAMESPACE(VVideoCapture)
+
+void init(vgl::LogicalDevice& device) noexcept;
+void destroy() noexcept;
+bool isEnabled() noexcept;
+void submitCompletedCaptures() noexcept;
+
+void recordCapture(
+    vgl::CmdBufferRecorder& cmdRec,
+    const VkImage srcImage,
+    const VkFormat srcFormat,
+    const uint32_t width,
+    const uint32_t height
+) noexcept;
+
+END_NAMESPACE(VVideoCapture)
+
+#endif  // #if PSYDOOM_VULKAN_RENDERER
@@ -7,6 +7,7 @@
 #include "WadUtils.h"
 
 #include <cctype>
+#include <cstring>
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Header for a WAD file: constains high level information about the contents of the WAD
@@ -38,7 +39,10 @@ WadFile::WadFile() noexcept
     , mSizeInBytes(0)
     , mLumpNames{}
     , mLumps{}
+    , mLumpNameIndex()
     , mFileReader()
+    , mMappedFile()
+    , mLumpCache()
 {
 }
 
@@ -50,7 +54,10 @@ WadFile::WadFile(WadFile&& other) noexcept
     , mSizeInBytes(other.mSizeInBytes)
     , mLumpNames(std::move(other.mLumpNames))
     , mLumps(std::move(other.mLumps))
+    , mLumpNameIndex(std::move(other.mLumpNameIndex))
     , mFileReader(std::move(other.mFileReader))
+    , mMappedFile(std::move(other.mMappedFile))
+    , mLumpCache(std::move(other.mLumpCache))
 {
     other.mNumLumps = 0;
     other.mSizeInBytes = 0;
@@ -69,7 +76,10 @@ WadFile::~WadFile() noexcept {
 void WadFile::close() noexcept {
     purgeAllLumps();
 
+    mLumpCache.close();
+    mMappedFile.close();
     mFileReader.close();
+    mLumpNameIndex.clear();
     mLumps.reset();
     mLumpNames.reset();
     mSizeInBytes = 0;
@@ -96,6 +106,15 @@ void WadFile::open(const char* const filePath, const RemapWadLumpNameFn lumpName
     mSizeInBytes = (int32_t) fileSize;
     mFileReader.open(filePath);
     initAfterOpen(lumpNameRemapFn);
+
+    // Try to map the WAD into memory also, so lumps can be accessed directly without copying.
+    // This is only done on little endian hosts, where the lump data can be used exactly as it is stored on disk.
+    // If mapping fails for whatever reason then lumps are just read via the file reader instead, as normal.
+    if constexpr (Endian::isLittle()) {
+        if (mMappedFile.open(filePath) && (mMappedFile.getSize() != (size_t) mSizeInBytes)) {
+            mMappedFile.close();
+        }
+    }
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -123,15 +142,8 @@ void WadFile::open(const CdFileId fileId, const RemapWadLumpNameFn lumpNameRemap
 // Note: when searching the 'compressed' flag bit in the 1st byte of candidate lump names is ignored.
 //------------------------------------------------------------------------------------------------------------------------------------------
 int32_t WadFile::findLumpIdx(const WadLumpName lumpName, const int32_t searchStartIdx) const noexcept {
-    const int32_t numLumps = mNumLumps;
-    const WadLumpName* const pLumpNames = mLumpNames.get();
-
-    for (int32_t i = searchStartIdx; i < numLumps; ++i) {
-        if ((pLumpNames[i].word() & WAD_LUMPNAME_MASK) == lumpName.word())
-            return i;
-    }
-
-    return -1;
+    // PsyDoom: use a hash index rather than searching linearly through all lump names, the result is exactly the same
+    return mLumpNameIndex.find(lumpName, searchStartIdx);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -143,7 +155,10 @@ void WadFile::purgeCachedLump(const int32_t lumpIdx) noexcept {
     WadLump& lump = mLumps[lumpIdx];
     void* const pCachedData = lump.pCachedData;
 
-    if (pCachedData) {
+    if (isMappedData(pCachedData)) {
+        lump.pCachedData = nullptr;
+        lump.bIsUncompressed = false;
+    } else if (pCachedData) {
         Z_Free2(*gpMainMemZone, pCachedData);
         ASSERT_LOG(!lump.pCachedData, "Z_Free2 should clear the pointer field pointing to the freed memory block!");
         lump.bIsUncompressed = false;
@@ -161,7 +176,10 @@ void WadFile::purgeAllLumps() noexcept {
     for (int32_t i = 0; i < numLumps; ++i) {
         void* const pCachedData = pLumps[i].pCachedData;
 
-        if (pCachedData) {
+        if (isMappedData(pCachedData)) {
+            pLumps[i].pCachedData = nullptr;
+            pLumps[i].bIsUncompressed = false;
+        } else if (pCachedData) {
             Z_Free2(mainMemZone, pCachedData);
             ASSERT_LOG(!pLumps[i].pCachedData, "Z_Free2 should clear the pointer field pointing to the freed memory block!");
             pLumps[i].bIsUncompressed = false;
@@ -207,11 +225,18 @@ const WadLump& WadFile::cacheLump(const int32_t lumpIdx, const int16_t allocTag,
         // The original game did not trigger this case but now with PsyDoom it's possible, so we must fix.
         if (bDecompress && (!lump.bIsUncompressed)) {
             void* const pCompressedLump = lump.pCachedData;
-            
-            Z_SetUser(pCompressedLump, nullptr); // N.B: Doing this to avoid wiping the cache entry on 'Z_Free'
-            Z_Malloc(*gpMainMemZone, lump.uncompressedSize, allocTag, &lump.pCachedData);
-            WadUtils::decompressLump(pCompressedLump, lump.pCachedData);
-            Z_Free2(*gpMainMemZone, pCompressedLump);
+
+            // Note: compressed data which points into the file mapping does not need to be freed
+            if (isMappedData(pCompressedLump)) {
+                lump.pCachedData = nullptr;
+                Z_Malloc(*gpMainMemZone, lump.uncompressedSize, allocTag, &lump.pCachedData);
+                WadUtils::decompressLump(pCompressedLump, lump.pCachedData);
+            } else {
+                Z_SetUser(pCompressedLump, nullptr); // N.B: Doing this to avoid wiping the cache entry on 'Z_Free'
+                Z_Malloc(*gpMainMemZone, lump.uncompressedSize, allocTag, &lump.pCachedData);
+                WadUtils::decompressLump(pCompressedLump, lump.pCachedData);
+                Z_Free2(*gpMainMemZone, pCompressedLump);
+            }
 
             lump.bIsUncompressed = true;
         }
@@ -222,6 +247,32 @@ const WadLump& WadFile::cacheLump(const int32_t lumpIdx, const int16_t allocTag,
     // If we get to here then the lump is not cached and will have to be loaded.
     // Note that originally the PSX engine disallowed loading lumps during gameplay due to slow CD-ROM I/O, but PsyDoom waives this restriction.
     // This change means that levels no longer need to ship with 'MAPSPR--.IMG' and 'MAPTEX--.IMG' files and can load resources on the fly.
+    const bool bIsLumpCompressed = ((uint8_t) mLumpNames[lumpIdx].chars[0] & 0x80);
+
+    // If the lump is compressed and the decompressed data is in the lump cache then just point to the data in the cache.
+    // Note that this will return decompressed data even if decompression is not required, which callers must be prepared to handle.
+    if (bIsLumpCompressed) {
+        const std::byte* const pCachedLumpData = mLumpCache.getLumpData(lumpIdx);
+
+        if (pCachedLumpData) {
+            lump.pCachedData = (void*) pCachedLumpData;
+            lump.bIsUncompressed = true;
+            return lump;
+        }
+    }
+
+    // If the WAD is mapped into memory and the lump data can be used exactly as it is stored, then just point to the mapped data.
+    // This avoids a copy and also does not use any zone memory. This is only possible if no decompression is required.
+    if ((!bIsLumpCompressed) || (!bDecompress)) {
+        const std::byte* const pMappedData = getMappedLumpData(lumpIdx);
+
+        if (pMappedData) {
+            lump.pCachedData = (void*) pMappedData;
+            lump.bIsUncompressed = (!bIsLumpCompressed);
+            return lump;
+        }
+    }
+
     int32_t sizeToRead;
 
     if (bDecompress) {
@@ -236,7 +287,7 @@ const WadLump& WadFile::cacheLump(const int32_t lumpIdx, const int16_t allocTag,
 
     // Save whether the lump is compressed or not.
     // If the lump is compressed then the highest bit of the first character in the name will be set:
-    if ((uint8_t) mLumpNames[lumpIdx].chars[0] & 0x80) {
+    if (bIsLumpCompressed) {
         lump.bIsUncompressed = bDecompress;
     } else {
         lump.bIsUncompressed = true;
@@ -261,6 +312,30 @@ void WadFile::readLump(const int32_t lumpIdx, void* const pDest, const bool bDec
     const uint32_t sizeToRead = getRawSize(lumpIdx);
     const bool bIsLumpCompressed = ((uint8_t) lumpName.chars[0] & 0x80u);
 
+    // If the decompressed data for the lump is in the lump cache then just copy it from there
+    if (bDecompress && bIsLumpCompressed) {
+        const std::byte* const pCachedLumpData = mLumpCache.getLumpData(lumpIdx);
+
+        if (pCachedLumpData) {
+            std::memcpy(pDest, pCachedLumpData, lump.uncompressedSize);
+            return;
+        }
+    }
+
+    // If the WAD is mapped into memory then copy or decompress straight from the mapping, no file IO or temporary buffer needed
+    if (mMappedFile.isOpen() && ((size_t) lump.wadFileOffset + sizeToRead <= mMappedFile.getSize())) {
+        const std::byte* const pSrc = mMappedFile.getData() + lump.wadFileOffset;
+
+        if (bDecompress && bIsLumpCompressed) {
+            ASSERT(WadUtils::getDecompressedLumpSize(pSrc) == lump.uncompressedSize);   // Sanity check the WAD data in debug mode
+            WadUtils::decompressLump(pSrc, pDest);
+        } else {
+            std::memcpy(pDest, pSrc, sizeToRead);
+        }
+
+        return;
+    }
+
     if (bDecompress && bIsLumpCompressed) {
         // Decompression needed, must alloc a temp buffer for the compressed data before reading and decompressing!
         void* const pTmpBuffer = Z_EndMalloc(*gpMainMemZone, sizeToRead, PU_STATIC, nullptr);
@@ -278,11 +353,22 @@ void WadFile::readLump(const int32_t lumpIdx, void* const pDest, const bool bDec
     }
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Opens the persistent cache of decompressed lumps for this WAD in the given cache directory, building the cache if required.
+// If the cache cannot be opened then lumps are just decompressed on demand as normal.
+// Note: any lumps which are currently cached are purged, so that they can be sourced from the lump cache if possible.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void WadFile::openLumpCache(const char* const cacheDir) noexcept {
+    purgeAllLumps();
+    mLumpCache.open(cacheDir, *this);
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Performs WAD initialization after the file has been opened
 //------------------------------------------------------------------------------------------------------------------------------------------
 void WadFile::initAfterOpen(const RemapWadLumpNameFn lumpNameRemapFn) noexcept {
     readLumpInfo(lumpNameRemapFn);
+    mLumpNameIndex.build(mLumpNames.get(), mNumLumps);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -333,3 +419,40 @@ void WadFile::readLumpInfo(const RemapWadLumpNameFn lumpNameRemapFn) noexcept {
         lump.uncompressedSize = lumpHdr.uncompressedSize;
     }
 }
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Returns a pointer to the raw data for the specified lump inside the WAD's file mapping, or 'nullptr' if the data cannot be used directly.
+// The data cannot be used if the WAD is not mapped, or if the lump is not suitably aligned to be accessed in place like zone memory.
+//------------------------------------------------------------------------------------------------------------------------------------------
+const std::byte* WadFile::getMappedLumpData(const int32_t lumpIdx) noexcept {
+    ASSERT(isValidLumpIdx(lumpIdx));
+
+    if (!mMappedFile.isOpen())
+        return nullptr;
+
+    const WadLump& lump = mLumps[lumpIdx];
+    const int32_t rawSize = getRawSize(lumpIdx);
+
+    if ((lump.wadFileOffset < 0) || (rawSize <= 0) || ((lump.wadFileOffset & 3) != 0))
+        return nullptr;
+
+    if ((size_t) lump.wadFileOffset + (size_t) rawSize > mMappedFile.getSize())
+        return nullptr;
+
+    return mMappedFile.getData() + lump.wadFileOffset;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tells if the given pointer points into the WAD's file mapping or lump cache, as opposed to zone memory
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool WadFile::isMappedData(const void* const pData) const noexcept {
+    if (mLumpCache.containsData(pData))
+        return true;
+
+    if ((!pData) || (!mMappedFile.isOpen()))
+        return false;
+
+    const std::byte* const pBytes = (const std::byte*) pData;
+    const std::byte* const pMapStart = mMappedFile.getData();
+    return ((pBytes >= pMapStart) && (pBytes < pMapStart + mMappedFile.getSize()));
+}
@@ -3,7 +3,10 @@
 #include "Asserts.h"
 #include "Endian.h"
 #include "GameFileReader.h"
+#include "LumpNameIndex.h"
+#include "MappedFile.h"
 #include "SmallString.h"
+#include "WadLumpCache.h"
 
 #include <memory>
 
@@ -39,6 +42,10 @@ typedef WadLumpName (*RemapWadLumpNameFn)(const WadLumpName& oldName) noexcept;
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Represents a WAD file: provides access to the lumps within the file and maintains an open file handle to the WAD.
 // This is part of the replacement for the old WAD handling code for PsyDoom.
+//
+// WAD files on disk are also mapped into memory where possible, so that uncompressed lumps can be 'cached' without any copying.
+// Such lumps point directly into the file mapping and do not use any zone memory.
+// Optionally, a persistent on-disk cache of decompressed lumps can also be used to serve compressed lumps in the same way.
 //------------------------------------------------------------------------------------------------------------------------------------------
 class WadFile {
 public:
@@ -75,6 +82,7 @@ public:
     int32_t getRawSize(const int32_t lumpIdx) noexcept;
     const WadLump& cacheLump(const int32_t lumpIdx, const int16_t allocTag, const bool bDecompress) noexcept;
     void readLump(const int32_t lumpIdx, void* const pDest, const bool bDecompress) noexcept;
+    void openLumpCache(const char* const cacheDir) noexcept;
 
 private:
     WadFile(const WadFile& other) = delete;
@@ -83,10 +91,15 @@ private:
 
     void initAfterOpen(const RemapWadLumpNameFn lumpNameRemapFn) noexcept;
     void readLumpInfo(const RemapWadLumpNameFn lumpNameRemapFn) noexcept;
+    const std::byte* getMappedLumpData(const int32_t lumpIdx) noexcept;
+    bool isMappedData(const void* const pData) const noexcept;
 
     int32_t                         mNumLumps;          // The number of lumps in the WAD
     int32_t                         mSizeInBytes;       // The total size (in bytes) of the entire WAD file
     std::unique_ptr<WadLumpName[]>  mLumpNames;         // Store names in their own list for cache-friendly search
     std::unique_ptr<WadLump[]>      mLumps;             // The details and data for each lump
+    LumpNameIndex                   mLumpNameIndex;     // Hash index used to speed up finding lumps by name
     GameFileReader                  mFileReader;        // Responsible for reading from the WAD file
+    MappedFile                      mMappedFile;        // If the WAD is a file on disk that could be mapped into memory, the mapping for it
+    WadLumpCache                    mLumpCache;         // Optional on-disk cache of decompressed lump data for the WAD
 };
@@ -6,6 +6,7 @@
 WadList::WadList() noexcept
     : mWadFiles()
     , mLumpHandles()
+    , mLumpNameIndex()
 {
 }
 
@@ -59,12 +60,24 @@ void WadList::finalize() noexcept {
             mLumpHandles.push_back({ wadFileIndex, lumpIdx, lumpName.word() & WAD_LUMPNAME_MASK });     // Note: remove the special 'compressed' flag bit to make later search a bit faster
         }
     }
+
+    // Build the hash index used to find lumps by name.
+    // Since user WADs are added first, lookups return lumps from those WADs first - the same as a linear search would.
+    std::vector<WadLumpName> lumpNames;
+    lumpNames.reserve(mLumpHandles.size());
+
+    for (const LumpHandle& lumpHandle : mLumpHandles) {
+        lumpNames.push_back(lumpHandle.name);
+    }
+
+    mLumpNameIndex.build(lumpNames.data(), (int32_t) lumpNames.size());
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Clears the WAD list and unloads all WADs
 //------------------------------------------------------------------------------------------------------------------------------------------
 void WadList::clear() noexcept {
+    mLumpNameIndex.clear();
     mLumpHandles.clear();
     mWadFiles.clear();
 }
@@ -75,15 +88,8 @@ void WadList::clear() noexcept {
 // Note: when searching the 'compressed' flag bit in the 1st byte of candidate lump names is ignored.
 //------------------------------------------------------------------------------------------------------------------------------------------
 int32_t WadList::findLumpIdx(const WadLumpName lumpName, const int32_t searchStartIdx) const noexcept {
-    const int32_t numLumps = (int32_t) mLumpHandles.size();
-    const LumpHandle* const pLumpHandles = mLumpHandles.data();
-
-    for (int32_t i = searchStartIdx; i < numLumps; ++i) {
-        if (pLumpHandles[i].name.word() == lumpName.word())
-            return i;
-    }
-
-    return -1;
+    // PsyDoom: use a hash index rather than searching linearly through all lump names, the result is exactly the same
+    return mLumpNameIndex.find(lumpName, searchStartIdx);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -163,3 +169,12 @@ void WadList::readLump(const int32_t lumpIdx, void* const pDest, const bool bDec
     WadFile& wadFile = mWadFiles[lumpHandle.wadFileIdx];
     wadFile.readLump(lumpHandle.wadLumpIdx, pDest, bDecompress);
 }
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Opens the persistent caches of decompressed lumps for all WADs in the list, using the specified cache directory
+//------------------------------------------------------------------------------------------------------------------------------------------
+void WadList::openLumpCaches(const char* const cacheDir) noexcept {
+    for (WadFile& wadFile : mWadFiles) {
+        wadFile.openLumpCache(cacheDir);
+    }
+}
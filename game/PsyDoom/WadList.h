@@ -32,6 +32,7 @@ public:
     int32_t getRawSize(const int32_t lumpIdx) noexcept;
     const WadLump& cacheLump(const int32_t lumpIdx, const int16_t allocTag, const bool bDecompress) noexcept;
     void readLump(const int32_t lumpIdx, void* const pDest, const bool bDecompress) noexcept;
+    void openLumpCaches(const char* const cacheDir) noexcept;
 
 private:
     // Describes a lump in the 'combined' WAD file.
@@ -45,4 +46,5 @@ private:
 
     std::vector<WadFile>        mWadFiles;
     std::vector<LumpHandle>     mLumpHandles;
+    LumpNameIndex               mLumpNameIndex;     // Hash index used to speed up finding lumps by name (in all WADs)
 };
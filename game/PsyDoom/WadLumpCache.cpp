@@ -0,0 +1,271 @@
+//------------------------------------------------------------------------------------------------------------------------------------------
+// A persistent on-disk cache of decompressed WAD lumps.
+// Saves having to LZSS decompress the same lumps over and over again each time the game is launched.
+//------------------------------------------------------------------------------------------------------------------------------------------
+#include "WadLumpCache.h"
+
+#include "ContentHash.h"
+#include "FileUtils.h"
+#include "WadFile.h"
+#include "WadUtils.h"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Identifies a lump cache blob file, and the version of the blob file format
+static constexpr uint32_t BLOB_MAGIC = 0x434C4450;      // 'PDLC' in little endian
+static constexpr uint32_t BLOB_VERSION = 2;
+
+// Lump data within the blob file is aligned to this many bytes
+static constexpr uint32_t BLOB_DATA_ALIGN = 8;
+
+// Header for the blob file, which is followed by the lump index and then the lump data
+struct BlobHdr {
+    uint32_t    magic;          // Should be 'BLOB_MAGIC'
+    uint32_t    version;        // Should be 'BLOB_VERSION'
+    uint64_t    wadKey;         // Hash of the WAD the blob is for
+    int32_t     numLumps;       // Number of entries in the lump index
+    uint32_t    reserved;       // Unused, for alignment
+};
+
+static_assert(sizeof(BlobHdr) == 24);
+
+// An entry in the lump index of the blob file: tells where the decompressed data for the lump is located.
+// If the size is zero then there is no cached data for the lump (it is not compressed, or is empty).
+struct BlobLumpEntry {
+    uint32_t    offset;
+    uint32_t    size;
+};
+
+static_assert(sizeof(BlobLumpEntry) == 8);
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Computes the key for the given WAD from its lump directory and the contents of all the compressed lumps which would be cached.
+// Hashing the lump contents means that an edited WAD with exactly the same layout still gets a different key, and never uses stale data.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static uint64_t computeWadKey(WadFile& wadFile) noexcept {
+    ContentHasher hasher;
+    const int32_t numLumps = wadFile.getNumLumps();
+    hasher.addValue(numLumps);
+
+    std::vector<std::byte> rawData;
+
+    for (int32_t lumpIdx = 0; lumpIdx < numLumps; ++lumpIdx) {
+        const WadLump& lump = wadFile.getLump(lumpIdx);
+        const WadLumpName lumpName = wadFile.getLumpName(lumpIdx);
+        const int32_t rawSize = wadFile.getRawSize(lumpIdx);
+
+        hasher.addValue(lumpName);
+        hasher.addValue(lump.wadFileOffset);
+        hasher.addValue(lump.uncompressedSize);
+        hasher.addValue(rawSize);
+
+        // Include the raw (compressed) data for any lump which would have cached data
+        const bool bIsLumpCompressed = ((uint8_t) lumpName.chars[0] & 0x80u);
+
+        if (bIsLumpCompressed && (rawSize > 0)) {
+            rawData.resize((size_t) rawSize);
+            wadFile.readLump(lumpIdx, rawData.data(), false);
+            hasher.add(rawData.data(), rawData.size());
+        }
+    }
+
+    return hasher.getHash().word1;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Decompresses all compressed lumps in the given WAD and returns the data for a lump cache blob file containing them
+//------------------------------------------------------------------------------------------------------------------------------------------
+static std::vector<std::byte> buildBlob(WadFile& wadFile, const uint64_t wadKey) noexcept {
+    const int32_t numLumps = wadFile.getNumLumps();
+    const size_t indexOffset = sizeof(BlobHdr);
+    const size_t dataOffset = indexOffset + sizeof(BlobLumpEntry) * (size_t) numLumps;
+
+    std::vector<std::byte> blob(dataOffset);
+    std::vector<std::byte> rawData;
+
+    for (int32_t lumpIdx = 0; lumpIdx < numLumps; ++lumpIdx) {
+        const bool bIsLumpCompressed = ((uint8_t) wadFile.getLumpName(lumpIdx).chars[0] & 0x80u);
+        const int32_t rawSize = wadFile.getRawSize(lumpIdx);
+        const int32_t uncompressedSize = wadFile.getLump(lumpIdx).uncompressedSize;
+        BlobLumpEntry entry = {};
+
+        if (bIsLumpCompressed && (rawSize > 0) && (uncompressedSize > 0)) {
+            // Read the compressed lump and sanity check the data before decompressing.
+            // If the decompressed size is not what it should be then don't cache the lump.
+            rawData.resize((size_t) rawSize);
+            wadFile.readLump(lumpIdx, rawData.data(), false);
+
+            if (WadUtils::getDecompressedLumpSize(rawData.data()) == uncompressedSize) {
+                const size_t lumpOffset = (blob.size() + BLOB_DATA_ALIGN - 1) & ~((size_t) BLOB_DATA_ALIGN - 1);
+                blob.resize(lumpOffset + (size_t) uncompressedSize);
+                WadUtils::decompressLump(rawData.data(), blob.data() + lumpOffset);
+
+                entry.offset = (uint32_t) lumpOffset;
+                entry.size = (uint32_t) uncompressedSize;
+            }
+        }
+
+        std::memcpy(blob.data() + indexOffset + sizeof(BlobLumpEntry) * (size_t) lumpIdx, &entry, sizeof(entry));
+    }
+
+    BlobHdr hdr = {};
+    hdr.magic = BLOB_MAGIC;
+    hdr.version = BLOB_VERSION;
+    hdr.wadKey = wadKey;
+    hdr.numLumps = numLumps;
+    std::memcpy(blob.data(), &hdr, sizeof(hdr));
+
+    return blob;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Creates a lump cache with no blob file opened
+//------------------------------------------------------------------------------------------------------------------------------------------
+WadLumpCache::WadLumpCache() noexcept
+    : mMappedFile()
+    , mNumLumps(0)
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Move the lump cache from one object to another
+//------------------------------------------------------------------------------------------------------------------------------------------
+WadLumpCache::WadLumpCache(WadLumpCache&& other) noexcept
+    : mMappedFile(std::move(other.mMappedFile))
+    , mNumLumps(other.mNumLumps)
+{
+    other.mNumLumps = 0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Closes the lump cache to cleanup
+//------------------------------------------------------------------------------------------------------------------------------------------
+WadLumpCache::~WadLumpCache() noexcept {
+    close();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Opens the lump cache for the given WAD file in the specified cache directory, returning 'true' on success.
+// If there is no valid cache blob file for the WAD then one is built and saved.
+// If the cache cannot be opened or created for whatever reason then the WAD is just used without a cache.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool WadLumpCache::open(const char* const cacheDir, WadFile& wadFile) noexcept {
+    close();
+
+    // Figure out the path to the blob file for this WAD
+    const uint64_t wadKey = computeWadKey(wadFile);
+    const int32_t numLumps = wadFile.getNumLumps();
+
+    char blobFileName[32];
+    std::snprintf(blobFileName, sizeof(blobFileName), "%016llX.lumpcache", (unsigned long long) wadKey);
+
+    std::string blobFilePath = cacheDir;
+
+    if ((!blobFilePath.empty()) && (blobFilePath.back() != '/') && (blobFilePath.back() != '\\')) {
+        blobFilePath += '/';
+    }
+
+    blobFilePath += blobFileName;
+
+    // Use the existing blob file if it's valid
+    if (openExisting(blobFilePath.c_str(), wadKey, numLumps))
+        return true;
+
+    // Otherwise build a new blob file.
+    // Write to a temporary file first and then move it into place, so a partially written blob file is never used.
+    const std::vector<std::byte> blob = buildBlob(wadFile, wadKey);
+    const std::string tmpFilePath = blobFilePath + ".tmp";
+
+    if (!FileUtils::writeDataToFile(tmpFilePath.c_str(), blob.data(), blob.size()))
+        return false;
+
+    std::remove(blobFilePath.c_str());
+
+    if (std::rename(tmpFilePath.c_str(), blobFilePath.c_str()) != 0) {
+        std::remove(tmpFilePath.c_str());
+        return false;
+    }
+
+    return openExisting(blobFilePath.c_str(), wadKey, numLumps);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Closes the lump cache, if open
+//------------------------------------------------------------------------------------------------------------------------------------------
+void WadLumpCache::close() noexcept {
+    mMappedFile.close();
+    mNumLumps = 0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Returns the cached decompressed data for the specified lump or 'nullptr' if there is no cached data for the lump
+//------------------------------------------------------------------------------------------------------------------------------------------
+const std::byte* WadLumpCache::getLumpData(const int32_t lumpIdx) const noexcept {
+    if ((!mMappedFile.isOpen()) || (lumpIdx < 0) || (lumpIdx >= mNumLumps))
+        return nullptr;
+
+    BlobLumpEntry entry;
+    std::memcpy(&entry, mMappedFile.getData() + sizeof(BlobHdr) + sizeof(BlobLumpEntry) * (size_t) lumpIdx, sizeof(entry));
+    return (entry.size > 0) ? mMappedFile.getData() + entry.offset : nullptr;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tells if the given pointer points into the lump cache's data
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool WadLumpCache::containsData(const void* const pData) const noexcept {
+    if ((!pData) || (!mMappedFile.isOpen()))
+        return false;
+
+    const std::byte* const pBytes = (const std::byte*) pData;
+    const std::byte* const pMapStart = mMappedFile.getData();
+    return ((pBytes >= pMapStart) && (pBytes < pMapStart + mMappedFile.getSize()));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tries to open and validate an existing blob file for the WAD with the given key and number of lumps, returning 'true' on success
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool WadLumpCache::openExisting(const char* const filePath, const uint64_t wadKey, const int32_t numLumps) noexcept {
+    if (!mMappedFile.open(filePath))
+        return false;
+
+    // Validate the header and make sure the index fits in the file
+    const std::byte* const pData = mMappedFile.getData();
+    const size_t dataSize = mMappedFile.getSize();
+    const size_t indexEnd = sizeof(BlobHdr) + sizeof(BlobLumpEntry) * (size_t) numLumps;
+
+    BlobHdr hdr = {};
+
+    if (dataSize >= sizeof(BlobHdr)) {
+        std::memcpy(&hdr, pData, sizeof(hdr));
+    }
+
+    const bool bValidHdr = (
+        (hdr.magic == BLOB_MAGIC) &&
+        (hdr.version == BLOB_VERSION) &&
+        (hdr.wadKey == wadKey) &&
+        (hdr.numLumps == numLumps) &&
+        (dataSize >= indexEnd)
+    );
+
+    if (!bValidHdr) {
+        close();
+        return false;
+    }
+
+    // Make sure all the lump data is within the bounds of the file
+    for (int32_t lumpIdx = 0; lumpIdx < numLumps; ++lumpIdx) {
+        BlobLumpEntry entry;
+        std::memcpy(&entry, pData + sizeof(BlobHdr) + sizeof(BlobLumpEntry) * (size_t) lumpIdx, sizeof(entry));
+
+        if ((entry.size > 0) && ((entry.offset < indexEnd) || ((size_t) entry.offset + entry.size > dataSize))) {
+            close();
+            return false;
+        }
+    }
+
+    mNumLumps = numLumps;
+    return true;
+}
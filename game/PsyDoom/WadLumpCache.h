@@ -0,0 +1,37 @@
+#pragma once
+
+#include "MappedFile.h"
+
+class WadFile;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// A persistent on-disk cache of the decompressed data for all compressed lumps in a WAD file.
+// 
+// The cache for a WAD is stored as a single indexed blob file in a user specified cache directory and is mapped into memory when opened,
+// so lumps can be served directly from it without having to decompress them again. The blob file is keyed by a hash of the WAD's size
+// and lump directory (names, offsets and sizes); if the WAD changes then a new blob is built the next time the WAD is opened.
+//------------------------------------------------------------------------------------------------------------------------------------------
+class WadLumpCache {
+public:
+    WadLumpCache() noexcept;
+    WadLumpCache(WadLumpCache&& other) noexcept;
+    ~WadLumpCache() noexcept;
+
+    bool open(const char* const cacheDir, WadFile& wadFile) noexcept;
+    void close() noexcept;
+
+    inline bool isOpen() const noexcept { return mMappedFile.isOpen(); }
+
+    const std::byte* getLumpData(const int32_t lumpIdx) const noexcept;
+    bool containsData(const void* const pData) const noexcept;
+
+private:
+    WadLumpCache(const WadLumpCache& other) = delete;
+    WadLumpCache& operator = (const WadLumpCache& other) = delete;
+    WadLumpCache& operator = (WadLumpCache&& other) = delete;
+
+    bool openExisting(const char* const filePath, const uint64_t wadKey, const int32_t numLumps) noexcept;
+
+    MappedFile  mMappedFile;    // The mapped blob file containing the cached lump data
+    int32_t     mNumLumps;      // Number of lumps in the WAD and in the blob file's index
+};
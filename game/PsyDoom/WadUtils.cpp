@@ -3,58 +3,77 @@
 //------------------------------------------------------------------------------------------------------------------------------------------
 #include "WadUtils.h"
 
+#include <cstring>
+
 BEGIN_NAMESPACE(WadUtils)
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Decompresses the given compressed lump data into the given output buffer.
 // The compression algorithm used is a form of LZSS.
 // Assumes the output buffer is sized big enough to hold all of the decompressed data.
+// 
+// PsyDoom: this has been optimized to handle all 8 items controlled by each id byte in one step, instead of re-checking whether an id
+// byte needs to be read for every single item. Runs of 8 uncompressed bytes and repeated data which does not overlap the bytes being
+// output are also copied in 8 byte chunks. The output is exactly the same as the original byte-by-byte decompression code, and no
+// bytes past the end of the decompressed data are ever written.
 //------------------------------------------------------------------------------------------------------------------------------------------
 void decompressLump(const void* const pSrc, void* const pDst) noexcept {
     const uint8_t* pSrcByte = (const uint8_t*) pSrc;
     uint8_t* pDstByte = (uint8_t*) pDst;
 
-    uint32_t idByte = 0;        // Controls whether there is compressed or uncompressed data ahead
-    uint32_t haveIdByte = 0;    // Controls when to read an id byte, when '0' we need to read another one
-
     while (true) {
-        // Read the id byte if required.
-        // We need 1 id byte for every 8 bytes of uncompressed output, or every 8 runs of compressed data.
-        if (haveIdByte == 0) {
-            idByte = *pSrcByte;
-            ++pSrcByte;
+        // Read the id byte which controls the next 8 items: each bit tells whether there is compressed or uncompressed data ahead.
+        // If all 8 items are uncompressed bytes then just copy them all in one go.
+        uint32_t idByte = *pSrcByte;
+        ++pSrcByte;
+
+        if (idByte == 0) {
+            std::memcpy(pDstByte, pSrcByte, 8);
+            pSrcByte += 8;
+            pDstByte += 8;
+            continue;
         }
 
-        haveIdByte = (haveIdByte + 1) & 7;
-
-        if (idByte & 1) {
-            // Compressed data ahead: the first 12-bits tells where to take repeated data from.
-            // The remaining 4-bits tell how many bytes of repeated data to take.
-            const uint32_t srcByte1 = pSrcByte[0];
-            const uint32_t srcByte2 = pSrcByte[1];
-            pSrcByte += 2;
-
-            const int32_t srcOffset = ((srcByte1 << 4) | (srcByte2 >> 4)) + 1;
-            const int32_t numRepeatedBytes = (srcByte2 & 0xF) + 1;
-
-            // A value of '1' is a special value and means we have reached the end of the compressed stream
-            if (numRepeatedBytes == 1)
-                break;
-
-            const uint8_t* const pRepeatedBytes = pDstByte - srcOffset;
-
-            for (int32_t i = 0; i < numRepeatedBytes; ++i) {
-                *pDstByte = pRepeatedBytes[i];
+        for (uint32_t itemIdx = 0; itemIdx < 8; ++itemIdx, idByte >>= 1) {
+            if (idByte & 1) {
+                // Compressed data ahead: the first 12-bits tells where to take repeated data from.
+                // The remaining 4-bits tell how many bytes of repeated data to take.
+                const uint32_t srcByte1 = pSrcByte[0];
+                const uint32_t srcByte2 = pSrcByte[1];
+                pSrcByte += 2;
+
+                const uint32_t srcOffset = ((srcByte1 << 4) | (srcByte2 >> 4)) + 1;
+                uint32_t numRepeatedBytes = (srcByte2 & 0xF) + 1;
+
+                // A value of '1' is a special value and means we have reached the end of the compressed stream
+                if (numRepeatedBytes == 1)
+                    return;
+
+                const uint8_t* pRepeatedBytes = pDstByte - srcOffset;
+
+                // If the repeated data is at least 8 bytes behind the output then 8 byte chunks can be copied without overlap.
+                // Otherwise the repeated data overlaps the output and must be copied byte by byte, so recently output bytes are repeated.
+                if (srcOffset >= 8) {
+                    while (numRepeatedBytes >= 8) {
+                        std::memcpy(pDstByte, pRepeatedBytes, 8);
+                        pRepeatedBytes += 8;
+                        pDstByte += 8;
+                        numRepeatedBytes -= 8;
+                    }
+                }
+
+                for (uint32_t i = 0; i < numRepeatedBytes; ++i) {
+                    pDstByte[i] = pRepeatedBytes[i];
+                }
+
+                pDstByte += numRepeatedBytes;
+            } else {
+                // Uncompressed data: just copy the input byte
+                *pDstByte = *pSrcByte;
+                ++pSrcByte;
                 ++pDstByte;
             }
-        } else {
-            // Uncompressed data: just copy the input byte
-            *pDstByte = *pSrcByte;
-            ++pSrcByte;
-            ++pDstByte;
         }
-
-        idByte >>= 1;
     }
 }
 
@@ -68,37 +87,34 @@ int32_t getDecompressedLumpSize(const void* const pSrc) noexcept {
     const uint8_t* pSrcByte = (uint8_t*) pSrc;
     int32_t size = 0;
 
-    uint32_t idByte = 0;
-    uint32_t haveIdByte = 0;
-
     while (true) {
-        if (haveIdByte == 0) {
-            idByte = *pSrcByte;
-            ++pSrcByte;
-        }
-
-        haveIdByte = (haveIdByte + 1) & 7;
-
-        if (idByte & 1) {
-            // Note: not bothering to read the byte containing only positional information for the replicated data.
-            // We are only interested in the byte count for this function.
-            const uint32_t srcByte2 = pSrcByte[1];
-            pSrcByte += 2;
-            const uint32_t numRepeatedBytes = (srcByte2 & 0xF) + 1;
+        uint32_t idByte = *pSrcByte;
+        ++pSrcByte;
 
-            if (numRepeatedBytes == 1)
-                break;
-
-            size += numRepeatedBytes;
-        } else {
-            ++size;
-            ++pSrcByte;
+        if (idByte == 0) {
+            size += 8;
+            pSrcByte += 8;
+            continue;
         }
 
-        idByte >>= 1;
+        for (uint32_t itemIdx = 0; itemIdx < 8; ++itemIdx, idByte >>= 1) {
+            if (idByte & 1) {
+                // Note: not bothering to read the byte containing only positional information for the replicated data.
+                // We are only interested in the byte count for this function.
+                const uint32_t srcByte2 = pSrcByte[1];
+                pSrcByte += 2;
+                const uint32_t numRepeatedBytes = (srcByte2 & 0xF) + 1;
+
+                if (numRepeatedBytes == 1)
+                    return size;
+
+                size += numRepeatedBytes;
+            } else {
+                ++size;
+                ++pSrcByte;
+            }
+        }
     }
-
-    return size;
 }
 
 END_NAMESPACE(WadUtils)
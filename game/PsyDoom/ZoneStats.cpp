@@ -0,0 +1,228 @@
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Telemetry for the main memory zone, to help with sizing the heap and tuning the allocator.
+//
+// When enabled via the 'ShowZoneStats' config setting, a breakdown of heap usage per block tag, the largest free block, fragmentation and
+// purge counts is shown in the overlay. Optionally, a snapshot of these stats can also be taken at the end of each level and written out
+// to a json file ('-zonestats' argument). The file is rewritten after each level, so it is still valid if the game is quit mid way.
+//------------------------------------------------------------------------------------------------------------------------------------------
+#include "ZoneStats.h"
+
+#include "Config/Config.h"
+#include "Doom/Base/i_drawcmds.h"
+#include "Doom/Base/i_main.h"
+#include "Doom/Base/i_misc.h"
+#include "Doom/Base/z_zone.h"
+#include "Doom/doomdef.h"
+#include "Doom/Game/g_game.h"
+#include "Doom/Renderer/r_data.h"
+#include "Game.h"
+#include "ProgArgs.h"
+#include "PsyQ/LIBGPU.h"
+#include "Video.h"
+
+#if PSYDOOM_VULKAN_RENDERER
+    #include "Vulkan/VRenderer.h"
+#endif
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include <rapidjson/filewritestream.h>
+#include <rapidjson/writer.h>
+
+BEGIN_NAMESPACE(ZoneStats)
+
+// A snapshot of the zone stats taken at the end of a level
+struct LevelSnapshot {
+    int32_t             mapNum;         // Which map was exited
+    zoneheapstats_t     heapStats;      // How the heap was being used at the end of the level
+    zonestats_t         levelStats;     // Allocator counters for the level: the change in the counters since the previous level ended
+    int32_t             peakBytes;      // Limit removing: the biggest the heap has been so far, otherwise the heap size
+};
+
+static std::vector<LevelSnapshot>   gLevelSnapshots;        // All the level snapshots taken so far
+static zonestats_t                  gPrevLevelEndStats;     // The allocator counters at the end of the previous level
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Gives the difference between two sets of zone allocator counters
+//------------------------------------------------------------------------------------------------------------------------------------------
+static zonestats_t getStatsDelta(const zonestats_t& from, const zonestats_t& to) noexcept {
+    zonestats_t delta = {};
+    delta.numMallocs = to.numMallocs - from.numMallocs;
+    delta.numFrees = to.numFrees - from.numFrees;
+    delta.numPurges = to.numPurges - from.numPurges;
+    delta.numCachePurges = to.numCachePurges - from.numCachePurges;
+    delta.numFreeTagsCalls = to.numFreeTagsCalls - from.numFreeTagsCalls;
+    delta.numBlocksVisited = to.numBlocksVisited - from.numBlocksVisited;
+    delta.numChunksAdded = to.numChunksAdded - from.numChunksAdded;
+    delta.numChunksReleased = to.numChunksReleased - from.numChunksReleased;
+    return delta;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Writes all the level snapshots taken so far to the specified json file.
+// Returns 'false' on failure.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool writeJsonFile(const char* const filePath) noexcept {
+    FILE* const pFile = std::fopen(filePath, "wb");
+
+    if (!pFile)
+        return false;
+
+    char writeBuffer[16 * 1024];
+    rapidjson::FileWriteStream fileStream(pFile, writeBuffer, sizeof(writeBuffer));
+    rapidjson::Writer<rapidjson::FileWriteStream> writer(fileStream);
+
+    writer.StartObject();
+    writer.Key("levels");
+    writer.StartArray();
+
+    for (const LevelSnapshot& snapshot : gLevelSnapshots) {
+        const zoneheapstats_t& heapStats = snapshot.heapStats;
+        const zonestats_t& levelStats = snapshot.levelStats;
+
+        writer.StartObject();
+        writer.Key("map");                  writer.Int(snapshot.mapNum);
+        writer.Key("totalBytes");           writer.Int(heapStats.totalBytes);
+        writer.Key("peakBytes");            writer.Int(snapshot.peakBytes);
+        writer.Key("freeBytes");            writer.Int(heapStats.freeBytes);
+        writer.Key("numFreeBlocks");        writer.Int(heapStats.numFreeBlocks);
+        writer.Key("largestFreeBlock");     writer.Int(heapStats.largestFreeBlock);
+        writer.Key("fragmentation");        writer.Double(heapStats.fragmentation);
+        writer.Key("numMallocs");           writer.Uint(levelStats.numMallocs);
+        writer.Key("numFrees");             writer.Uint(levelStats.numFrees);
+        writer.Key("numPurges");            writer.Uint(levelStats.numPurges);
+        writer.Key("numCachePurges");       writer.Uint(levelStats.numCachePurges);
+        writer.Key("numBlocksVisited");     writer.Uint64(levelStats.numBlocksVisited);
+        writer.Key("numChunksAdded");       writer.Uint(levelStats.numChunksAdded);
+        writer.Key("numChunksReleased");    writer.Uint(levelStats.numChunksReleased);
+
+        writer.Key("tags");
+        writer.StartObject();
+
+        for (int32_t tagIdx = 0; tagIdx < NUM_ZONE_STATS_TAGS; ++tagIdx) {
+            writer.Key(Z_GetHeapStatsTagName(tagIdx));
+            writer.StartObject();
+            writer.Key("bytes");    writer.Int(heapStats.usedBytes[tagIdx]);
+            writer.Key("blocks");   writer.Int(heapStats.numUsedBlocks[tagIdx]);
+            writer.EndObject();
+        }
+
+        writer.EndObject();
+        writer.EndObject();
+    }
+
+    writer.EndArray();
+    writer.EndObject();
+
+    fileStream.Flush();
+    const bool bSuccess = (std::ferror(pFile) == 0);
+    std::fclose(pFile);
+    return bSuccess;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Should be called when a level ends (before level memory is freed): takes a snapshot of the zone stats and writes the json file, if enabled
+//------------------------------------------------------------------------------------------------------------------------------------------
+void onLevelExit() noexcept {
+    if (!ProgArgs::gZoneStatsFilePath[0])
+        return;
+
+    const memzone_t& zone = *gpMainMemZone;
+
+    LevelSnapshot& snapshot = gLevelSnapshots.emplace_back();
+    snapshot.mapNum = gGameMap;
+    Z_GetHeapStats(zone, snapshot.heapStats);
+    snapshot.levelStats = getStatsDelta(gPrevLevelEndStats, zone.stats);
+
+    #if PSYDOOM_LIMIT_REMOVING
+        snapshot.peakBytes = zone.peakSize;
+    #else
+        snapshot.peakBytes = zone.size;
+    #endif
+
+    gPrevLevelEndStats = zone.stats;
+
+    if (!writeJsonFile(ProgArgs::gZoneStatsFilePath)) {
+        std::printf("ZoneStats: failed to write the zone stats file '%s'!\n", ProgArgs::gZoneStatsFilePath);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Draws the zone stats at the top right of the screen, if enabled.
+// Should be called as part of drawing the UI overlay.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void drawOverlay() noexcept {
+    if (!Config::gbShowZoneStats)
+        return;
+
+    // If using the Vulkan renderer, draw as far as possible to the right, being widescreen aware (same as the perf counters on the left)
+    int32_t widescreenAdjust = 0;
+
+    #if PSYDOOM_VULKAN_RENDERER
+        if (Video::isUsingVulkanRenderPath() && Config::gbVulkanWidescreenEnabled) {
+            const float xPadding = (VRenderer::gPsxCoordsFbX / VRenderer::gPsxCoordsFbW) * (float) SCREEN_W;
+            widescreenAdjust = (int32_t) xPadding;
+        }
+    #endif
+
+    // Need to setup the texture window beforehand for the draw string calls
+    {
+        DR_MODE drawModePrim = {};
+        const SRECT texWindow = { (int16_t) gTex_STATUS.texPageCoordX, (int16_t) gTex_STATUS.texPageCoordY, 256, 256 };
+        LIBGPU_SetDrawMode(drawModePrim, false, false, gTex_STATUS.texPageId, &texWindow);
+        I_AddPrim(drawModePrim);
+    }
+
+    // Helper that draws a line of text right aligned to the edge of the screen, using the 8x8 pixel small font
+    const int32_t rightX = SCREEN_W - 2 + widescreenAdjust;
+    int32_t textY = 2;
+
+    const auto drawLine = [&](const char* const str, const uint8_t r, const uint8_t g, const uint8_t b) noexcept {
+        const int32_t textW = (int32_t) std::strlen(str) * 8;
+        I_DrawStringSmall(rightX - textW, textY, str, Game::getTexClut_STATUS(), r, g, b, false, false);
+        textY += 8;
+    };
+
+    // Show the overall heap usage and fragmentation
+    const memzone_t& zone = *gpMainMemZone;
+    zoneheapstats_t heapStats;
+    Z_GetHeapStats(zone, heapStats);
+
+    char msgBuffer[128];
+    std::snprintf(msgBuffer, sizeof(msgBuffer), "ZONE: %dK FREE %dK", heapStats.totalBytes / 1024, heapStats.freeBytes / 1024);
+    drawLine(msgBuffer, 255, 255, 128);
+
+    std::snprintf(
+        msgBuffer,
+        sizeof(msgBuffer),
+        "BIG: %dK FRAG %d%%",
+        heapStats.largestFreeBlock / 1024,
+        (int32_t)(heapStats.fragmentation * 100.0f + 0.5f)
+    );
+
+    drawLine(msgBuffer, 255, 255, 128);
+
+    std::snprintf(msgBuffer, sizeof(msgBuffer), "PURGE: %u CACHE %u", zone.stats.numPurges, zone.stats.numCachePurges);
+    drawLine(msgBuffer, 255, 128, 128);
+
+    // Show the usage for each tag category which has blocks
+    for (int32_t tagIdx = 0; tagIdx < NUM_ZONE_STATS_TAGS; ++tagIdx) {
+        if (heapStats.numUsedBlocks[tagIdx] <= 0)
+            continue;
+
+        std::snprintf(
+            msgBuffer,
+            sizeof(msgBuffer),
+            "%s: %dK/%d",
+            Z_GetHeapStatsTagName(tagIdx),
+            heapStats.usedBytes[tagIdx] / 1024,
+            heapStats.numUsedBlocks[tagIdx]
+        );
+
+        drawLine(msgBuffer, 128, 255, 255);
+    }
+}
+
+END_NAMESPACE(ZoneStats)
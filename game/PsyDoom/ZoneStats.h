@@ -0,0 +1,10 @@
+#pragma once
+
+#include "Macros.h"
+
+BEGIN_NAMESPACE(ZoneStats)
+
+void drawOverlay() noexcept;
+void onLevelExit() noexcept;
+
+END_NAMESPACE(ZoneStats)
@@ -104,6 +104,11 @@ WadFormatInfo WadCompatibilityLayer::detectWadFormat(const WadFile& wadFile) noe
     if (hasPNames && hasTexture1 && (hasMap01 || hasE1M1)) {
         info.format = WadFormat::PC_Doom;
     }
+
+    // PSX map WADs using the extended (32-bit index) map format are flagged by the presence of a marker lump
+    if ((info.format == WadFormat::Unknown) && (wadFile.findLumpIdx("EXTMAP32") >= 0)) {
+        info.format = WadFormat::PSX_Extended;
+    }
     
     return info;
 }
@@ -125,6 +130,52 @@ void WadCompatibilityLayer::endMapConversion() noexcept {
     // Nothing to cleanup yet
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Gets the size of one element of a map lump in the PC and PSX formats, or returns 'false' if the lump needs no conversion
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool getMapLumpElemSizes(const char* const lumpName, int32_t& srcElemSize, int32_t& dstElemSize) noexcept {
+    if (strnicmp(lumpName, "VERTEXES", 8) == 0) {
+        srcElemSize = sizeof(mapvertex_pc_t);
+        dstElemSize = sizeof(mapvertex_t);
+    }
+    else if (strnicmp(lumpName, "SECTORS", 8) == 0) {
+        srcElemSize = sizeof(mapsector_pc_t);
+        dstElemSize = sizeof(mapsector_t);
+    }
+    else if (strnicmp(lumpName, "SIDEDEFS", 8) == 0) {
+        srcElemSize = sizeof(mapsidedef_pc_t);
+        dstElemSize = sizeof(mapsidedef_t);
+    }
+    else if (strnicmp(lumpName, "LINEDEFS", 8) == 0) {
+        srcElemSize = sizeof(maplinedef_pc_t);
+        dstElemSize = sizeof(maplinedef_t);
+    }
+    else {
+        return false;
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Returns the size a map lump will be after conversion, so that destination buffers can be allocated before converting.
+// Lumps that don't need conversion keep their original size.
+//------------------------------------------------------------------------------------------------------------------------------------------
+int32_t WadCompatibilityLayer::getConvertedSize(const char* const lumpName, const int32_t sourceSize) const noexcept {
+    int32_t srcElemSize = 0;
+    int32_t dstElemSize = 0;
+
+    if ((!needsConversion()) || (!getMapLumpElemSizes(lumpName, srcElemSize, dstElemSize)))
+        return sourceSize;
+
+    return (sourceSize / srcElemSize) * dstElemSize;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Converts a map lump to the PSX format and returns the converted size. Lumps that don't need conversion are copied as-is.
+// If no destination buffer is given then just the converted size is returned.
+// This only reads the source data and the texture registry, so different lumps may be converted in parallel on multiple threads.
+//------------------------------------------------------------------------------------------------------------------------------------------
 int32_t WadCompatibilityLayer::convertMapLump(
     const char* const lumpName,
     const void* const pSourceData,
@@ -134,43 +185,33 @@ int32_t WadCompatibilityLayer::convertMapLump(
 ) noexcept {
     if (!needsConversion()) return 0;
 
-    int32_t neededSize = 0;
+    const int32_t neededSize = getConvertedSize(lumpName, sourceSize);
+
+    if (!pDestBuffer)
+        return neededSize;
+
+    ASSERT(destBufferSize >= neededSize);
+    int32_t srcElemSize = 0;
+    int32_t dstElemSize = 0;
+
+    if (!getMapLumpElemSizes(lumpName, srcElemSize, dstElemSize)) {
+        std::memcpy(pDestBuffer, pSourceData, (size_t) sourceSize);
+        return neededSize;
+    }
+
+    const int32_t count = sourceSize / srcElemSize;
 
     if (strnicmp(lumpName, "VERTEXES", 8) == 0) {
-        int32_t count = sourceSize / sizeof(mapvertex_pc_t);
-        neededSize = count * sizeof(mapvertex_t);
-        
-        if (pDestBuffer) {
-            ASSERT(destBufferSize >= neededSize);
-            convertVertices_PCToPSX(pSourceData, pDestBuffer, count);
-        }
+        convertVertices_PCToPSX(pSourceData, pDestBuffer, count);
     }
     else if (strnicmp(lumpName, "SECTORS", 8) == 0) {
-        int32_t count = sourceSize / sizeof(mapsector_pc_t);
-        neededSize = count * sizeof(mapsector_t);
-        
-        if (pDestBuffer) {
-            ASSERT(destBufferSize >= neededSize);
-            convertSectors_PCToPSX(pSourceData, pDestBuffer, count);
-        }
+        convertSectors_PCToPSX(pSourceData, pDestBuffer, count);
     }
     else if (strnicmp(lumpName, "SIDEDEFS", 8) == 0) {
-        int32_t count = sourceSize / sizeof(mapsidedef_pc_t);
-        neededSize = count * sizeof(mapsidedef_t);
-        
-        if (pDestBuffer) {
-            ASSERT(destBufferSize >= neededSize);
-            convertSidedefs_PCToPSX(pSourceData, pDestBuffer, count);
-        }
+        convertSidedefs_PCToPSX(pSourceData, pDestBuffer, count);
     }
     else if (strnicmp(lumpName, "LINEDEFS", 8) == 0) {
-        int32_t count = sourceSize / sizeof(maplinedef_pc_t);
-        neededSize = count * sizeof(maplinedef_t);
-        
-        if (pDestBuffer) {
-            ASSERT(destBufferSize >= neededSize);
-            convertLinedefs_PCToPSX(pSourceData, pDestBuffer, count);
-        }
+        convertLinedefs_PCToPSX(pSourceData, pDestBuffer, count);
     }
 
     return neededSize;
@@ -20,7 +20,8 @@ enum class WadFormat : uint8_t {
     PC_Doom,
     PC_Hexen,
     PSX_Doom,
-    PSX_FinalDoom
+    PSX_FinalDoom,
+    PSX_Extended        // PSX map using 32-bit indices for the geometry lumps (see 'maplinedef_ext_t' etc.); only for limit removing builds
 };
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -138,6 +139,10 @@ public:
         return (mCurrentFormat == WadFormat::PC_Doom);
     }
 
+    inline bool isExtendedMapFormat() const noexcept {
+        return (mCurrentFormat == WadFormat::PSX_Extended);
+    }
+
     inline int32_t getTextureCount() const noexcept {
         return (int32_t)mPCTextures.size();
     }
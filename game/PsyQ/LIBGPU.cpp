@@ -42,6 +42,21 @@ static int32_t gDbgMsgBufPos;
     static std::vector<uint16_t> gLoadImage8TmpBuffer;
 #endif
 
+#if PSYDOOM_LIMIT_REMOVING && PSYDOOM_VULKAN_RENDERER
+    // PsyDoom: an area of VRAM updated by 'LIBGPU_LoadImage' (inclusive coordinates)
+    struct VramUpdateRect {
+        uint16_t lx;
+        uint16_t rx;
+        uint16_t ty;
+        uint16_t by;
+    };
+
+    // PsyDoom: if true then VRAM updates made by 'LIBGPU_LoadImage' are not pushed to the Vulkan renderer immediately.
+    // Instead they are saved in a list and pushed all together (and coalesced) when the batch of loads ends.
+    static bool gbBatchingLoadImage = false;
+    static std::vector<VramUpdateRect> gBatchedVramUpdates;
+#endif
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // PsyDoom helper function that clears the current drawing area to the specified color
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -168,8 +183,9 @@ void LIBGPU_SetDispMask([[maybe_unused]] const int32_t mask) noexcept {
 //  1 = Return the number of drawing operations currently in progress.
 //------------------------------------------------------------------------------------------------------------------------------------------
 int32_t LIBGPU_DrawSync([[maybe_unused]] const int32_t mode) noexcept {
-    // This function doesn't need to do anything in this emulated environment.
-    // When we submit something to the 'gpu' it is handled immediately, in a blocking fashion.
+    // When we submit something to the 'gpu' it is usually handled immediately, in a blocking fashion.
+    // The only thing to do is finish any draws that the GPU is deferring.
+    Gpu::flushDeferredDraws(PsxVm::gGpu);
     return 0;
 }
 
@@ -187,6 +203,9 @@ void LIBGPU_LoadImage(const SRECT& dstRect, const uint16_t* const pImageData) no
     ASSERT(dstRect.w <= gpu.ramPixelW);
     ASSERT(dstRect.h <= gpu.ramPixelH);
 
+    // Finish any deferred draws before touching VRAM
+    Gpu::flushDeferredDraws(gpu);
+
     // Determine the destination bounds and row size for the copy.
     // Note that we must wrap horizontal coordinates (see comments below).
     const uint16_t rowW = dstRect.w;
@@ -230,9 +249,20 @@ void LIBGPU_LoadImage(const SRECT& dstRect, const uint16_t* const pImageData) no
         }
     }
 
+    // Discard anything the GPU has cached from the area written to
+    Gpu::invalidateVramCaches(gpu, dstLx, dstRx, dstTy, dstBy);
+
     // Vulkan renderer: push this upload to the Vulkan texture mirroring PSX VRAM
     #if PSYDOOM_VULKAN_RENDERER
         if (Video::gBackendType == Video::BackendType::Vulkan) {
+            // PsyDoom: defer the update until the end of the batch if batching loads
+            #if PSYDOOM_LIMIT_REMOVING
+                if (gbBatchingLoadImage) {
+                    gBatchedVramUpdates.push_back({ dstLx, dstRx, dstTy, dstBy });
+                    return;
+                }
+            #endif
+
             VRenderer::pushPsxVramUpdates(dstLx, dstRx, dstTy, dstBy);
         }
     #endif  // #if PSYDOOM_VULKAN_RENDERER
@@ -290,6 +320,58 @@ void LIBGPU_LoadImage8(const SRECT& dstRect, const void* const pImageData) noexc
     dstRect16.w = (int16_t) paddedW16;
     LIBGPU_LoadImage(dstRect16, gLoadImage8TmpBuffer.data());
 }
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: begins a batch of 'LIBGPU_LoadImage' calls.
+// Until the batch is ended, updates to VRAM are not pushed to the Vulkan renderer's copy of VRAM.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void LIBGPU_BeginLoadImageBatch() noexcept {
+    #if PSYDOOM_VULKAN_RENDERER
+        ASSERT(!gbBatchingLoadImage);
+        gbBatchingLoadImage = true;
+        gBatchedVramUpdates.clear();
+    #endif
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: ends a batch of 'LIBGPU_LoadImage' calls and pushes all of the VRAM updates made to the Vulkan renderer.
+// 
+// Updates which cover the same rows and are horizontally adjacent (which is how the texture cache fills VRAM) are merged into one
+// update, so that there are far fewer updates overall. Updates of different heights are not merged, so that the merged area never
+// includes VRAM that was not written: that area might have been updated on the GPU since, and the CPU copy of it could be stale.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void LIBGPU_EndLoadImageBatch() noexcept {
+    #if PSYDOOM_VULKAN_RENDERER
+        ASSERT(gbBatchingLoadImage);
+        gbBatchingLoadImage = false;
+
+        const auto bIsWrappingRect = [](const VramUpdateRect& rect) noexcept {
+            return ((rect.rx < rect.lx) || (rect.by < rect.ty));
+        };
+
+        const uint32_t numUpdates = (uint32_t) gBatchedVramUpdates.size();
+
+        for (uint32_t i = 0; i < numUpdates;) {
+            VramUpdateRect mergedRect = gBatchedVramUpdates[i];
+            ++i;
+
+            if (!bIsWrappingRect(mergedRect)) {
+                for (; i < numUpdates; ++i) {
+                    const VramUpdateRect& nextRect = gBatchedVramUpdates[i];
+
+                    if (bIsWrappingRect(nextRect) || (nextRect.ty != mergedRect.ty) || (nextRect.by != mergedRect.by) || (nextRect.lx != mergedRect.rx + 1))
+                        break;
+
+                    mergedRect.rx = nextRect.rx;
+                }
+            }
+
+            VRenderer::pushPsxVramUpdates(mergedRect.lx, mergedRect.rx, mergedRect.ty, mergedRect.by);
+        }
+
+        gBatchedVramUpdates.clear();
+    #endif
+}
 #endif
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -307,6 +389,9 @@ int32_t LIBGPU_MoveImage(const SRECT& srcRect, const int32_t dstX, const int32_t
     ASSERT(dstX + srcRect.w <= gpu.ramPixelW);
     ASSERT(dstY + srcRect.y <= gpu.ramPixelH);
 
+    // Finish any deferred draws before touching VRAM
+    Gpu::flushDeferredDraws(gpu);
+
     // Copy each row
     const uint32_t numRows = srcRect.h;
     const uint32_t rowSize = srcRect.w * sizeof(uint16_t);
@@ -320,6 +405,9 @@ int32_t LIBGPU_MoveImage(const SRECT& srcRect, const int32_t dstX, const int32_t
         pDstRow += gpu.ramPixelW;
     }
 
+    // Discard anything the GPU has cached from the area written to
+    Gpu::invalidateVramCaches(gpu, (uint16_t) dstX, (uint16_t)(dstX + srcRect.w - 1), (uint16_t) dstY, (uint16_t)(dstY + srcRect.h - 1));
+
     return 0;   // This is the position of the command in the queue, according to PsyQ docs - don't care about this...
 }
 
@@ -579,6 +667,15 @@ void LIBGPU_SetWallColGT(WALLCOL_GT& col) noexcept {
     col.code = 0;
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Initialize the specified primitive as a flat shaded and untextured column
+//------------------------------------------------------------------------------------------------------------------------------------------
+void LIBGPU_SetWallColF(WALLCOL_F& col) noexcept {
+    // Note: don't care about the 'primitive id' element of the code here, just want to disable blending by default.
+    // This is because draw primitives are no longer saved in buffers, they get dispatched simply based on their C++ type which is known beforehand at compile time.
+    col.code = 0;
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Set which print stream to use for debug printing.
 // Note: for this re-implementation of LIBGPU multiple debug print streams are NOT supported, therfore this call is ignored.
@@ -199,6 +199,18 @@ struct SPRT_8 {
         uint8_t     g1;
         uint8_t     b1;
     };
+
+    // New for PsyDoom: a flat shaded untextured column of pixels.
+    // This is used to draw the slabs of voxel models in the classic renderer.
+    struct WALLCOL_F {
+        uint8_t     r0;         // Color to draw the primitive with
+        uint8_t     g0;
+        uint8_t     b0;
+        uint8_t     code;       // Type info for the hardware
+        int16_t     y0;         // The 'y' position of the column vertices and the column 'x' value
+        int16_t     y1;
+        int16_t     x0;
+    };
 #endif
 
 // Drawing primitive: modify the current draw mode
@@ -251,6 +263,8 @@ void LIBGPU_LoadImage(const SRECT& dstRect, const uint16_t* const pImageData) no
 
 #if PSYDOOM_LIMIT_REMOVING
     void LIBGPU_LoadImage8(const SRECT& dstRect, const void* const pImageData) noexcept;
+    void LIBGPU_BeginLoadImageBatch() noexcept;
+    void LIBGPU_EndLoadImageBatch() noexcept;
 #endif
 
 int32_t LIBGPU_MoveImage(const SRECT& srcRect, const int32_t dstX, const int32_t dstY) noexcept;
@@ -294,6 +308,7 @@ void LIBGPU_SetLineF2(LINE_F2& line) noexcept;
 #if PSYDOOM_MODS
     void LIBGPU_SetFloorRowFT(FLOORROW_FT& row) noexcept;
     void LIBGPU_SetWallColGT(WALLCOL_GT& col) noexcept;
+    void LIBGPU_SetWallColF(WALLCOL_F& col) noexcept;
 #endif
 
 void LIBGPU_SetDumpFnt(const int32_t printStreamId) noexcept;
@@ -4,8 +4,18 @@
 //------------------------------------------------------------------------------------------------------------------------------------------
 #include "LIBGTE.h"
 
+#include "Asserts.h"
 #include "PsyDoom/BitShift.h"
 
+// PsyDoom: use SSE2 to transform 4 vectors at a time in 'LIBGTE_RotTransBatch', where available.
+// SSE2 is always available on 64-bit x86 and is enabled by most 32-bit x86 builds.
+#if PSYDOOM_MODS && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2)))
+    #define LIBGTE_USE_SSE2 1
+    #include <emmintrin.h>
+#else
+    #define LIBGTE_USE_SSE2 0
+#endif
+
 static int16_t gGteRotMatrix[3][3];     // Emulated Geometry Transform Engine (GTE): current rotation matrix
 static int32_t gGteTransVec[3];         // Emulated Geometry Transform Engine (GTE): current translation vector
 
@@ -74,3 +84,95 @@ void LIBGTE_RotTrans(const SVECTOR& vecIn, VECTOR& vecOut, int32_t& flagsOut) no
     // Don't care about the value of this - it's never used anywhere...
     flagsOut = 0;
 }
+
+#if PSYDOOM_MODS
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: transform a batch of vectors by the current GTE rotation matrix and translation vector.
+// The results are exactly the same as calling 'LIBGTE_RotTrans' for each vector; the unused GTE flags are not output.
+//
+// Notes on the SIMD version:
+//  (1) Each product of a 16-bit matrix element and a 16-bit vector element fits in 32-bits, but the sum of all 3 might not. Instead of
+//      widening to 64-bits the sum is divided down by 4096 piecewise: 'floor(sum / 4096)' equals the sum of each product shifted right by 12
+//      plus the carry from adding up the low 12 bits of each product.
+//  (2) Since the translation is scaled by 4096 before being added it never affects the low 12 bits, so it can be added after the division.
+//  (3) Truncating the final result to 32-bits means the 32-bit wraparound of that last addition gives the same result as 64-bit math.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void LIBGTE_RotTransBatch(const SVECTOR* const pVecsIn, VECTOR* const pVecsOut, const int32_t count) noexcept {
+    ASSERT((count == 0) || (pVecsIn && pVecsOut));
+    int32_t vecIdx = 0;
+
+    #if LIBGTE_USE_SSE2
+    {
+        // Matrix elements for each row, placed in either the low or high 16-bits of each 32-bit lane.
+        // Multiplying against pairs of 16-bit vector elements with '_mm_madd_epi16' then picks out just one element of the pair.
+        const auto lowWord = [](const int16_t val) noexcept { return _mm_set1_epi32((int32_t)(uint16_t) val); };
+        const auto highWord = [](const int16_t val) noexcept { return _mm_set1_epi32((int32_t)((uint32_t)(uint16_t) val << 16)); };
+
+        __m128i matX[3], matY[3], matZ[3], trans[3];
+
+        for (int32_t row = 0; row < 3; ++row) {
+            matX[row] = lowWord(gGteRotMatrix[row][0]);
+            matY[row] = highWord(gGteRotMatrix[row][1]);
+            matZ[row] = lowWord(gGteRotMatrix[row][2]);
+            trans[row] = _mm_set1_epi32(gGteTransVec[row]);
+        }
+
+        const __m128i lowBitsMask = _mm_set1_epi32(0xFFF);
+
+        for (; vecIdx + 4 <= count; vecIdx += 4) {
+            // Load 4 vectors and rearrange into 'xy' and 'z/pad' pairs of 16-bit values (one pair per 32-bit lane) for each vector
+            const __m128 vecs01 = _mm_castsi128_ps(_mm_loadu_si128((const __m128i*) &pVecsIn[vecIdx + 0]));
+            const __m128 vecs23 = _mm_castsi128_ps(_mm_loadu_si128((const __m128i*) &pVecsIn[vecIdx + 2]));
+            const __m128i vecsXY = _mm_castps_si128(_mm_shuffle_ps(vecs01, vecs23, _MM_SHUFFLE(2, 0, 2, 0)));
+            const __m128i vecsZP = _mm_castps_si128(_mm_shuffle_ps(vecs01, vecs23, _MM_SHUFFLE(3, 1, 3, 1)));
+
+            // Transform by each row of the matrix
+            alignas(16) int32_t results[3][4];
+
+            for (int32_t row = 0; row < 3; ++row) {
+                const __m128i prodX = _mm_madd_epi16(vecsXY, matX[row]);
+                const __m128i prodY = _mm_madd_epi16(vecsXY, matY[row]);
+                const __m128i prodZ = _mm_madd_epi16(vecsZP, matZ[row]);
+
+                const __m128i lowBitsSum = _mm_add_epi32(
+                    _mm_add_epi32(_mm_and_si128(prodX, lowBitsMask), _mm_and_si128(prodY, lowBitsMask)),
+                    _mm_and_si128(prodZ, lowBitsMask)
+                );
+
+                const __m128i highBitsSum = _mm_add_epi32(
+                    _mm_add_epi32(_mm_srai_epi32(prodX, 12), _mm_srai_epi32(prodY, 12)),
+                    _mm_srai_epi32(prodZ, 12)
+                );
+
+                const __m128i result = _mm_add_epi32(_mm_add_epi32(highBitsSum, _mm_srli_epi32(lowBitsSum, 12)), trans[row]);
+                _mm_store_si128((__m128i*) results[row], result);
+            }
+
+            // Save the results; note that the 'pad' field is left as-is, same as 'LIBGTE_RotTrans'
+            for (int32_t i = 0; i < 4; ++i) {
+                VECTOR& vecOut = pVecsOut[vecIdx + i];
+                vecOut.vx = results[0][i];
+                vecOut.vy = results[1][i];
+                vecOut.vz = results[2][i];
+            }
+        }
+    }
+    #endif
+
+    // Do any remaining vectors one at a time
+    for (; vecIdx < count; ++vecIdx) {
+        int32_t flagsOut;
+        LIBGTE_RotTrans(pVecsIn[vecIdx], pVecsOut[vecIdx], flagsOut);
+    }
+
+    // Debug: verify the SIMD results match the scalar version exactly
+    #if ASSERTS_ENABLED && LIBGTE_USE_SSE2
+        for (int32_t i = 0; i < count; ++i) {
+            VECTOR vecCheck = pVecsOut[i];
+            int32_t flagsOut;
+            LIBGTE_RotTrans(pVecsIn[i], vecCheck, flagsOut);
+            ASSERT((vecCheck.vx == pVecsOut[i].vx) && (vecCheck.vy == pVecsOut[i].vy) && (vecCheck.vz == pVecsOut[i].vz));
+        }
+    #endif
+}
+#endif  // #if PSYDOOM_MODS
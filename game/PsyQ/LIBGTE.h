@@ -30,3 +30,7 @@ void LIBGTE_SetGeomOffset(const int32_t x, const int32_t y) noexcept;
 void LIBGTE_SetGeomScreen(const int32_t h) noexcept;
 void LIBGTE_InitGeom() noexcept;
 void LIBGTE_RotTrans(const SVECTOR& vecIn, VECTOR& vecOut, int32_t& flagsOut) noexcept;
+
+#if PSYDOOM_MODS
+    void LIBGTE_RotTransBatch(const SVECTOR* const pVecsIn, VECTOR* const pVecsOut, const int32_t count) noexcept;
+#endif
@@ -6,8 +6,10 @@
 
 #include "Asserts.h"
 #include "PsyDoom/PsxVm.h"
+#include "PsyDoom/SpuStreaming.h"
 #include "Spu.h"
 
+#include <atomic>
 #include <cmath>
 #include <cstring>
 
@@ -57,6 +59,21 @@ static uint32_t gTransferStartAddr;
 // See the implementation of 'LIBSPU__spu_note2pitch' for more details on that.
 static uint16_t gVoiceBaseNotes[SPU_NUM_VOICES] = {};
 
+// PsyDoom: which voices have reverb enabled, as last requested via 'LIBSPU_SpuSetReverbVoice'.
+// This is tracked here so that the reverb status of all voices can be returned without waiting on queued SPU commands to be applied.
+static SpuVoiceMask gReverbVoiceBits = 0;
+
+// PsyDoom: how many queued 'key on' commands have not yet been applied to the SPU, for each voice.
+// Incremented by the main thread when queueing a key on and decremented by whoever applies it. This allows 'LIBSPU_SpuGetAllKeysStatus'
+// to report voices which are about to be keyed on as playing, without having to wait on the audio thread to apply queued commands.
+static std::atomic<uint32_t> gPendingKeyOnCounts[SPU_NUM_VOICES] = {};
+
+// PsyDoom: arguments for a queued 'LIBSPU_SpuSetKey' command
+struct SpuSetKeyArgs {
+    int32_t         onOff;
+    SpuVoiceMask    voiceBits;
+};
+
 // Internal LIBSPU function: convert a note to a pitch.
 // See definition for details.
 uint16_t LIBSPU__spu_note2pitch(
@@ -88,9 +105,10 @@ static uint32_t LIBSPU_GetExtReverbBaseAddr(const uint16_t origPsxReverbBaseAddr
 #endif  // #if PSYDOOM_LIMIT_REMOVING
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Set one or more (or all) properties on a voice or voices using the information in the given struct
+// Set one or more (or all) properties on a voice or voices using the information in the given struct.
+// PsyDoom: this is applied via the SPU command queue and is called with the SPU already locked.
 //------------------------------------------------------------------------------------------------------------------------------------------
-void LIBSPU_SpuSetVoiceAttr(const SpuVoiceAttr& attribs) noexcept {
+static void LIBSPU_ApplySetVoiceAttr(const SpuVoiceAttr& attribs) noexcept {
     // Figure out what attributes to set for the specified voices
     const uint32_t attribMask = attribs.attr_mask;
 
@@ -117,8 +135,6 @@ void LIBSPU_SpuSetVoiceAttr(const SpuVoiceAttr& attribs) noexcept {
 
     // Set the required attributes for all specified voices
     Spu::Core& spu = PsxVm::gSpu;
-    PsxVm::LockSpu spuLock;
-
     const SpuVoiceMask voiceBits = attribs.voice_bits;
 
     for (uint32_t voiceIdx = 0; voiceIdx < spu.numVoices; ++voiceIdx) {
@@ -289,6 +305,10 @@ void LIBSPU_SpuSetVoiceAttr(const SpuVoiceAttr& attribs) noexcept {
     }
 }
 
+void LIBSPU_SpuSetVoiceAttr(const SpuVoiceAttr& attribs) noexcept {
+    PsxVm::queueSpuCmd<SpuVoiceAttr, LIBSPU_ApplySetVoiceAttr>(attribs);
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Internal LIBSPU function which converts a musical note to a frequency that can be set on a voice.
 // The returned integer frequency is such that 4,096 units = 44,100 Hz.
@@ -498,9 +518,10 @@ int32_t LIBSPU_SpuSetReverbModeParam(const SpuReverbAttr& reverbAttr) noexcept {
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Set the specified common/master sound settings using the given stuct
+// Set the specified common/master sound settings using the given stuct.
+// PsyDoom: this is applied via the SPU command queue and is called with the SPU already locked.
 //------------------------------------------------------------------------------------------------------------------------------------------
-void LIBSPU_SpuSetCommonAttr(const SpuCommonAttr& attribs) noexcept {
+static void LIBSPU_ApplySetCommonAttr(const SpuCommonAttr& attribs) noexcept {
     // Figure out what attributes we are setting
     const uint32_t attribMask = attribs.mask;
 
@@ -524,7 +545,6 @@ void LIBSPU_SpuSetCommonAttr(const SpuCommonAttr& attribs) noexcept {
 
     // Set: master volume and mode (left)
     Spu::Core& spu = PsxVm::gSpu;
-    PsxVm::LockSpu spuLock;
 
     if (bSetMVolL) {
         const uint16_t mode = (bSetMVolModeL) ? attribs.mvolmode.left : 0;
@@ -594,6 +614,10 @@ void LIBSPU_SpuSetCommonAttr(const SpuCommonAttr& attribs) noexcept {
     #endif
 }
 
+void LIBSPU_SpuSetCommonAttr(const SpuCommonAttr& attribs) noexcept {
+    PsxVm::queueSpuCmd<SpuCommonAttr, LIBSPU_ApplySetCommonAttr>(attribs);
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Returns the address in SPU RAM where reverb effects are performed.
 // Any bytes past this address are used for reverb.
@@ -642,10 +666,10 @@ void LIBSPU_SpuStart() noexcept {
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Set the depth of reverb using the settings in the given structure.
 // By default both left and right channels are set, but you can set independently using 'SPU_REV_DEPTHL' and 'SPU_REV_DEPTHR' mask flags.
+// PsyDoom: this is applied via the SPU command queue and is called with the SPU already locked.
 //------------------------------------------------------------------------------------------------------------------------------------------
-void LIBSPU_SpuSetReverbDepth(const SpuReverbAttr& reverb) noexcept {
+static void LIBSPU_ApplySetReverbDepth(const SpuReverbAttr& reverb) noexcept {
     Spu::Core& spu = PsxVm::gSpu;
-    PsxVm::LockSpu spuLock;
 
     if ((reverb.mask == 0) || (reverb.mask & SPU_REV_DEPTHL)) {
         spu.reverbVol.left = reverb.depth.left;
@@ -656,6 +680,23 @@ void LIBSPU_SpuSetReverbDepth(const SpuReverbAttr& reverb) noexcept {
     }
 }
 
+void LIBSPU_SpuSetReverbDepth(const SpuReverbAttr& reverb) noexcept {
+    PsxVm::queueSpuCmd<SpuReverbAttr, LIBSPU_ApplySetReverbDepth>(reverb);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: sets the reverb enabled status for ALL voices based on whether the corresponding voice bit is set in the given mask.
+// This is applied via the SPU command queue and is called with the SPU already locked.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void LIBSPU_ApplyReverbVoiceBits(const SpuVoiceMask& voiceBits) noexcept {
+    Spu::Core& spu = PsxVm::gSpu;
+
+    for (uint32_t voiceIdx = 0; voiceIdx < SPU_NUM_VOICES; ++voiceIdx) {
+        Spu::Voice& voice = spu.pVoices[voiceIdx];
+        voice.bDoReverb = (voiceBits & (SpuVoiceMask(1) << voiceIdx));
+    }
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Enable or disable reverb for specific voices, or set the reverb enabled/disabled status for ALL voices.
 // Returns a bit mask indicating which voices have reverb enabled, upon return.
@@ -667,34 +708,19 @@ void LIBSPU_SpuSetReverbDepth(const SpuReverbAttr& reverb) noexcept {
 //            If the bit is set then reverb is enabled.
 //------------------------------------------------------------------------------------------------------------------------------------------
 SpuVoiceMask LIBSPU_SpuSetReverbVoice(const int32_t onOff, const SpuVoiceMask voiceBits) noexcept {
-    // Enabling/disabling reverb for every single voice with the bit mask?
-    Spu::Core& spu = PsxVm::gSpu;
-    PsxVm::LockSpu spuLock;
-
+    // PsyDoom: figure out the new reverb status of all voices up front, then queue a command to apply it to the SPU
     if (onOff == SPU_BIT) {
-        for (uint32_t voiceIdx = 0; voiceIdx < SPU_NUM_VOICES; ++voiceIdx) {
-            Spu::Voice& voice = spu.pVoices[voiceIdx];
-            voice.bDoReverb = (voiceBits & (SpuVoiceMask(1) << voiceIdx));
-        }
-
-        return voiceBits;
+        gReverbVoiceBits = voiceBits & SPU_ALLCH;
+    } else if (onOff != SPU_OFF) {
+        gReverbVoiceBits |= voiceBits & SPU_ALLCH;
+    } else {
+        gReverbVoiceBits &= ~voiceBits;
     }
 
-    // Enable or disable reverb for specific voices and return the reverb status of all voices after
-    const bool bEnableReverb = (onOff != SPU_OFF);
-    SpuVoiceMask enabledVoiceBits = 0;
-
-    for (uint32_t voiceIdx = 0; voiceIdx < SPU_NUM_VOICES; ++voiceIdx) {
-        Spu::Voice& voice = spu.pVoices[voiceIdx];
-
-        if (voiceBits & (SpuVoiceMask(1) << voiceIdx)) {
-            voice.bDoReverb = bEnableReverb;
-        }
-
-        enabledVoiceBits |= (voice.bDoReverb) ? (SpuVoiceMask(1) << voiceIdx) : 0;
-    }
+    PsxVm::queueSpuCmd<SpuVoiceMask, LIBSPU_ApplyReverbVoiceBits>(gReverbVoiceBits);
 
-    return enabledVoiceBits;
+    // Enabling/disabling reverb for every single voice with the bit mask returns the input mask, otherwise return the reverb status of all voices
+    return (onOff == SPU_BIT) ? voiceBits : gReverbVoiceBits;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -743,12 +769,13 @@ void LIBSPU_SpuInit() noexcept {
 // In the real LIBSPU, this could fail due to 'SpuMalloc' occupying the work area required for reverb.
 // Since DOOM does not use SpuMalloc, this can never fail.
 //------------------------------------------------------------------------------------------------------------------------------------------
+static void LIBSPU_ApplySetReverb(const bool& bEnable) noexcept {
+    PsxVm::gSpu.bReverbWriteEnable = bEnable;
+}
+
 int32_t LIBSPU_SpuSetReverb(const int32_t onOff) noexcept {
     const bool bEnable = (onOff != SPU_OFF);
-
-    Spu::Core& spu = PsxVm::gSpu;
-    PsxVm::LockSpu spuLock;
-    spu.bReverbWriteEnable = bEnable;
+    PsxVm::queueSpuCmd<bool, LIBSPU_ApplySetReverb>(bEnable);
     return (bEnable) ? SPU_ON : SPU_OFF;
 }
 
@@ -836,10 +863,12 @@ void LIBSPU_SpuSetKeyOnWithAttr(const SpuVoiceAttr& attribs) noexcept {
 // Begin voices ramp up (attack phase or 'key on') or begin voice ramp down (release phase or 'key off').
 // The voices affected are specified by the given voice bit mask.
 // The on/off action to perform must be either 'SPU_OFF' or 'SPU_ON'
+// PsyDoom: this is applied via the SPU command queue and is called with the SPU already locked.
 //------------------------------------------------------------------------------------------------------------------------------------------
-void LIBSPU_SpuSetKey(const int32_t onOff, const SpuVoiceMask voiceBits) noexcept {
+static void LIBSPU_ApplySetKey(const SpuSetKeyArgs& args) noexcept {
     Spu::Core& spu = PsxVm::gSpu;
-    PsxVm::LockSpu spuLock;
+    const int32_t onOff = args.onOff;
+    const SpuVoiceMask voiceBits = args.voiceBits;
 
     const uint32_t numVoicesToSet = std::min(SPU_NUM_VOICES, spu.numVoices);
 
@@ -856,9 +885,31 @@ void LIBSPU_SpuSetKey(const int32_t onOff, const SpuVoiceMask voiceBits) noexcep
             if (voiceBits & (SpuVoiceMask(1) << voiceIdx)) {
                 Spu::Voice& voice = spu.pVoices[voiceIdx];
                 Spu::keyOn(voice);
+                SpuStreaming::onVoiceKeyOn(voiceIdx);   // PsyDoom: restart the stream if this voice is playing a streamed sound
+            }
+        }
+
+        // This key on is no longer pending.
+        // Note: release ordering so that the voice state changes above are visible to anyone who sees the updated count.
+        for (uint32_t voiceIdx = 0; voiceIdx < SPU_NUM_VOICES; ++voiceIdx) {
+            if (voiceBits & (SpuVoiceMask(1) << voiceIdx)) {
+                gPendingKeyOnCounts[voiceIdx].fetch_sub(1, std::memory_order_release);
+            }
+        }
+    }
+}
+
+void LIBSPU_SpuSetKey(const int32_t onOff, const SpuVoiceMask voiceBits) noexcept {
+    // PsyDoom: remember which voices have key ons pending until the command is applied
+    if (onOff == SPU_ON) {
+        for (uint32_t voiceIdx = 0; voiceIdx < SPU_NUM_VOICES; ++voiceIdx) {
+            if (voiceBits & (SpuVoiceMask(1) << voiceIdx)) {
+                gPendingKeyOnCounts[voiceIdx].fetch_add(1, std::memory_order_relaxed);
             }
         }
     }
+
+    PsxVm::queueSpuCmd<SpuSetKeyArgs, LIBSPU_ApplySetKey>(SpuSetKeyArgs{ onOff, voiceBits });
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -875,6 +926,13 @@ void LIBSPU_SpuGetAllKeysStatus(uint8_t statuses[SPU_NUM_VOICES]) noexcept {
     const uint32_t numVoicesToGet = std::min(SPU_NUM_VOICES, spu.numVoices);
 
     for (uint32_t voiceIdx = 0; voiceIdx < numVoicesToGet; ++voiceIdx) {
+        // PsyDoom: report voices with a queued key on as being in the attack phase, rather than waiting on the audio thread to apply it.
+        // Queued key offs don't matter here: they only delay when a voice is reported as being switched off.
+        if (gPendingKeyOnCounts[voiceIdx].load(std::memory_order_acquire) > 0) {
+            statuses[voiceIdx] = SPU_ON;
+            continue;
+        }
+
         const Spu::EnvPhase envPhase = spu.pVoices[voiceIdx].envPhase;
 
         switch (envPhase) {
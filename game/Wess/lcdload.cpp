@@ -10,12 +10,15 @@
 #include "Finally.h"
 #include "psxspu.h"
 #include "PsyDoom/ProgArgs.h"
+#include "PsyDoom/PsxVm.h"
+#include "PsyDoom/SpuStreaming.h"
 #include "PsyQ/LIBSPU.h"
 #include "wessapi.h"
 #include "wessarc.h"
 
 #include <cstdio>
 #include <cstring>
+#include <vector>
 
 // Maximum number of sounds that can be in an LCD file
 static constexpr uint32_t MAX_LCD_SOUNDS = 100;
@@ -38,6 +41,32 @@ static uint32_t             gWess_lcd_load_samplePos;           // This is the c
     // PsyDoom: the total number of patch samples in the loaded WMD file.
     // Use this for additional safety checks when reading an LCD file, in case it contains a sound that doesn't exist in the WMD.
     static uint16_t gWess_lcd_load_numPatchSamples;
+
+    // PsyDoom: holds all of the sound data for the LCD file being loaded, zero padded to a whole number of CD sectors.
+    // The buffer is kept around between loads so that it doesn't need to be reallocated on every map change.
+    static std::vector<uint8_t> gWess_lcd_load_dataBuf;
+
+    // PsyDoom: which LCD file is being loaded and how many bytes of sound data it has (excluding padding in the buffer above)
+    static CdFileId gWess_lcd_load_fileId;
+    static int32_t  gWess_lcd_load_dataSize;
+
+    // PsyDoom: set if the current sound being loaded is streamed on demand rather than uploaded to the SPU (see 'SpuStreaming')
+    static bool gbWess_lcd_load_soundStreamed;
+#endif
+
+#if PSYDOOM_MODS
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: tells if the sound of the given size starting at the given offset in the sector data should be streamed.
+// Only possible if the sound is fully contained in the buffered LCD file data, since the streaming code will need all of it.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool wess_dig_lcd_should_stream_sound(const uint8_t* const pSoundData, const uint32_t soundSize, const uint32_t spuAddr) noexcept {
+    const uint8_t* const pLcdData = gWess_lcd_load_dataBuf.data();
+
+    if ((pSoundData < pLcdData) || (pSoundData + soundSize > pLcdData + gWess_lcd_load_dataSize))
+        return false;
+
+    return ((spuAddr % 8 == 0) && SpuStreaming::shouldStreamSound(pSoundData, soundSize));
+}
 #endif
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -176,6 +205,10 @@ int32_t wess_dig_lcd_data_read(
             patch_sample& nextPatchSample = pPatchSamples[nextPatchSampleIdx];
             gWess_lcd_load_soundBytesLeft = nextPatchSample.size;
 
+            #if PSYDOOM_MODS
+                gbWess_lcd_load_soundStreamed = false;
+            #endif
+
             // PsyDoom: fix samples being uploaded to the wrong SPU address in some cases if other sounds in the LCD are already loaded and skipped over.
             // There was a slight mishandling of SPU addresses when skipping uploading samples to the SPU. This bug can cause sounds to be cut short
             // sometimes and is observable in 'Final Doom' on MAP28 (Baron's Lair) with the Revenant's pain sound being too short.
@@ -187,8 +220,18 @@ int32_t wess_dig_lcd_data_read(
 
             // If uploading this sound would cause us to go beyond the bounds of SPU ram then do not try to upload this sound
             #if PSYDOOM_MODS
+                // PsyDoom: sounds that are streamed only need space for their ring buffer in SPU RAM
+                const uint8_t* const pNextSoundData = pSectorData + sndDataOffset;
+                const bool bUploadNextSound = ((nextPatchSample.spu_addr == 0) || bOverride);
+                const bool bStreamNextSound = (
+                    bUploadNextSound &&
+                    wess_dig_lcd_should_stream_sound(pNextSoundData, nextPatchSample.size, gWess_lcd_load_samplePos)
+                );
+
+                const uint32_t nextSoundSpuSize = (bStreamNextSound) ? SpuStreaming::RING_SIZE : nextPatchSample.size;
+
                 // PsyDoom: I think this condition was slightly wrong?
-                const bool bInsufficientSpuRam = (destSpuAddr + sndDataOffset + nextPatchSample.size > gPsxSpu_sram_end);
+                const bool bInsufficientSpuRam = (destSpuAddr + sndDataOffset + nextSoundSpuSize > gPsxSpu_sram_end);
             #else
                 const bool bInsufficientSpuRam = (destSpuAddr + nextPatchSample.size > gPsxSpu_sram_end + sndDataOffset);
             #endif
@@ -203,6 +246,17 @@ int32_t wess_dig_lcd_data_read(
                 return bytesWritten;
             }
 
+            // PsyDoom: setup streaming for the sound if required, which also writes the start of it to SPU RAM.
+            // None of the rest of the sound's data gets uploaded below, it's read from disk as the sound plays instead.
+            #if PSYDOOM_MODS
+                if (bStreamNextSound) {
+                    const int32_t fileOffset = CDROM_SECTOR_SIZE + (int32_t)(pNextSoundData - gWess_lcd_load_dataBuf.data());
+                    SpuStreaming::addStream(gWess_lcd_load_fileId, fileOffset, pNextSoundData, nextPatchSample.size, gWess_lcd_load_samplePos);
+                    bytesWritten += SpuStreaming::RING_SIZE;
+                    gbWess_lcd_load_soundStreamed = true;
+                }
+            #endif
+
             // If there are no more bytes left to read then we are done: this check here is actually not neccessary?
             if (sectorBytesLeft == 0)
                 return bytesWritten;
@@ -216,7 +270,13 @@ int32_t wess_dig_lcd_data_read(
         const uint32_t sndBytesLeft = (uint32_t) gWess_lcd_load_soundBytesLeft;
         const uint32_t writeSize = (sectorBytesLeft > sndBytesLeft) ? sndBytesLeft : sectorBytesLeft;
 
-        if ((patchSample.spu_addr == 0) || bOverride) {
+        #if PSYDOOM_MODS
+            const bool bUploadSound = (((patchSample.spu_addr == 0) || bOverride) && (!gbWess_lcd_load_soundStreamed));
+        #else
+            const bool bUploadSound = ((patchSample.spu_addr == 0) || bOverride);
+        #endif
+
+        if (bUploadSound) {
             LIBSPU_SpuIsTransferCompleted(SPU_TRANSFER_WAIT);
 
             // PsyDoom: fix samples being uploaded to the wrong SPU address in some cases if other sounds in the LCD are already loaded and skipped over.
@@ -302,24 +362,38 @@ int32_t wess_dig_lcd_load(
     if (psxcd_seek(*pLcdFile, CDROM_SECTOR_SIZE, PsxCd_SeekMode::SET) != 0)
         return 0;
 
-    // Read all of the sound data and upload to the SPU using sector buffer 2 as a temporary.
+    // Read all of the sound data in the file with a single read, rather than one sector at a time.
+    // The per read overhead of the CD file layer is what made loading slow, and sound data is only a few hundred KiB at most.
     // Note: we've already consumed 1 sector from the file, so the byte count left is adjusted accordingly.
-    int32_t lcdBytesLeft = pLcdFile->size - CDROM_SECTOR_SIZE;
-    int32_t numSpuBytesWritten = 0;
+    const int32_t lcdDataSize = pLcdFile->size - CDROM_SECTOR_SIZE;
 
-    while ((lcdBytesLeft > 0) && (!gbWess_lcd_load_abort)) {
-        // Read this sector from the LCD file and the number of bytes left is smaller then read that amount instead
-        uint8_t* const sectorBuffer = gWess_sectorBuffer2;
-        const int32_t readSize = (lcdBytesLeft < CDROM_SECTOR_SIZE) ? lcdBytesLeft : CDROM_SECTOR_SIZE;
-        psxcd_read(sectorBuffer, readSize, *pLcdFile);
+    if (lcdDataSize <= 0)
+        return 0;
 
-        if (readSize < CDROM_SECTOR_SIZE) {
-            // When we are not filling part of the buffer then zero it out just for consistency
-            std::memset(sectorBuffer + readSize, 0, (size_t) CDROM_SECTOR_SIZE - readSize);
-        }
+    const int32_t numLcdDataSectors = (lcdDataSize + CDROM_SECTOR_SIZE - 1) / CDROM_SECTOR_SIZE;
+    std::vector<uint8_t>& lcdData = gWess_lcd_load_dataBuf;
+    lcdData.clear();
+    lcdData.resize((size_t) numLcdDataSectors * CDROM_SECTOR_SIZE);     // Note: zero fills the padding after the end of the sound data
+
+    if (psxcd_read(lcdData.data(), lcdDataSize, *pLcdFile) != lcdDataSize)
+        return 0;
+
+    gWess_lcd_load_fileId = lcdFileToLoad;
+    gWess_lcd_load_dataSize = lcdDataSize;
+    gbWess_lcd_load_soundStreamed = false;
+
+    // Upload all of the sound data to the SPU, holding the SPU lock for the whole upload instead of re-acquiring it for every sector.
+    // The data is still handed to 'wess_dig_lcd_data_read' one sector at a time, so SPU addresses and out of sound RAM checks are exactly
+    // the same as before; each of those calls is now just a copy from memory straight into SPU RAM.
+    PsxVm::LockSpu spuLock;
+    int32_t numSpuBytesWritten = 0;
+
+    // Any sounds streamed from this address onwards are about to be overwritten, so stop streaming them
+    SpuStreaming::removeStreamsFromAddr(destSpuAddr);
 
-        numSpuBytesWritten += wess_dig_lcd_data_read(sectorBuffer, destSpuAddr + numSpuBytesWritten, pSampleBlock, bOverride);
-        lcdBytesLeft -= readSize;
+    for (int32_t sectorIdx = 0; (sectorIdx < numLcdDataSectors) && (!gbWess_lcd_load_abort); ++sectorIdx) {
+        uint8_t* const pSectorData = lcdData.data() + (size_t) sectorIdx * CDROM_SECTOR_SIZE;
+        numSpuBytesWritten += wess_dig_lcd_data_read(pSectorData, destSpuAddr + numSpuBytesWritten, pSampleBlock, bOverride);
     }
 
     return numSpuBytesWritten;
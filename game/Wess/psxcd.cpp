@@ -10,6 +10,7 @@
 #include "Asserts.h"
 #include "FatalErrors.h"
 #include "psxspu.h"
+#include "PsyDoom/CdAudioReader.h"
 #include "PsyDoom/DiscInfo.h"
 #include "PsyDoom/DiscReader.h"
 #include "PsyDoom/ModMgr.h"
@@ -18,8 +19,13 @@
 #include "PsyDoom/Utils.h"
 #include "Spu.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <cstring>
 #include <mutex>
+#include <thread>
 
 // PsyDoom: raise the open file limit
 #if PSYDOOM_MODS
@@ -38,22 +44,49 @@ static bool gbPSXCD_IsCdInit;
 static PsxCd_File gPSXCD_cdfile;
 
 // CD audio playback related state.
-// Access to all of this is controlled by the CD player mutex.
+// Access to all of this is controlled by the CD player mutex, except for the atomic fields which the SPU audio callback reads.
 static struct {
-    DiscReader  discReader          = { PsxVm::gDiscInfo };     // The disc reader used to stream the audio
-    bool        bPlay               = false;                    // If 'false' then playback is either paused or stopped (stopped if the disc reader doesn't have a track)
-    bool        bLoop               = false;                    // If 'true' then playback is looped upon reaching the end
-    int32_t     bufferOffset        = 0;                        // Where we are in the audio buffer
-    int32_t     loopTrack           = 0;                        // The track to play when looping
-    int32_t     loopSectorOffset    = 0;                        // Offset (in sectors) to start at in the track when looping
-
-    // The CD audio buffer: we read CD audio in chunks
-    int16_t buffer[CDDA_SECTOR_SIZE / sizeof(int16_t)];
+    CdAudioReader           audioReader         = { PsxVm::gDiscInfo };     // Reads the audio from disc or override files: only used by the streaming thread once playback starts
+    std::atomic<bool>       bPlay               = false;                    // If 'false' then playback is either paused or stopped (stopped if the disc reader doesn't have a track)
+    bool                    bLoop               = false;                    // If 'true' then playback is looped upon reaching the end
+    int32_t                 loopTrack           = 0;                        // The track to play when looping
+    int32_t                 loopSectorOffset    = 0;                        // Offset (in sectors) to start at in the track when looping
+    int32_t                 startTrack          = 0;                        // The track that playback started on: reported as the playing track until the play head is known
+    int32_t                 startSector         = 0;                        // The sector that playback started on: reported as the elapsed sector count until the play head is known
+    uint32_t                streamEndGen        = UINT32_MAX;               // Set to the current stream generation once the streaming thread has read the end of a non looping track
+    std::atomic<uint32_t>   streamGen           = 0;                        // Incremented whenever playback restarts or stops: audio buffered for older generations is discarded
+    std::atomic<uint32_t>   playedEndGen        = UINT32_MAX;               // Set to the current stream generation by the audio callback once the end of a non looping track has been played
+    std::atomic<uint64_t>   playHead            = 0;                        // Stream generation, track and elapsed sector count for the chunk being played (see 'packPlayHead')
 } gCdPlayer;
 
+// A chunk of CD audio which has been read ahead by the streaming thread: one CD sector's worth
+struct CdStreamChunk {
+    uint32_t    streamGen;          // The stream generation that the chunk was read for; discarded if it does not match the current generation
+    int32_t     trackNum;           // The track the chunk was read from
+    int32_t     elapsedSectors;     // Elapsed sector count in the track once this chunk has been read: reported as the play position
+    bool        bEndOfStream;       // If 'true' then this is the last chunk of a non looping track
+    int16_t     samples[CDDA_SECTOR_SIZE / sizeof(int16_t)];
+};
+
+// Ring buffer of CD audio which has been read ahead of the play head.
+// This is a single producer (the streaming thread) and single consumer (the SPU audio callback) queue, so the audio callback never has to wait on disc I/O.
+static constexpr uint32_t   CD_STREAM_NUM_CHUNKS    = 64;                               // Number of sectors to read ahead: ~0.85 seconds of audio. Must be a power of two.
+static constexpr auto       CD_STREAM_POLL_TIME     = std::chrono::milliseconds(5);     // How often the streaming thread checks for room in the ring buffer to read more audio
+
+static_assert((CD_STREAM_NUM_CHUNKS & (CD_STREAM_NUM_CHUNKS - 1)) == 0);
+
+static CdStreamChunk            gCdStreamChunks[CD_STREAM_NUM_CHUNKS];
+static std::atomic<uint32_t>    gCdStreamHead;          // Number of chunks written by the streaming thread (wraps)
+static std::atomic<uint32_t>    gCdStreamTail;          // Number of chunks consumed by the audio callback (wraps)
+static uint32_t                 gCdStreamChunkOffset;   // Audio callback only: offset of the next sample to play in the chunk at the tail of the ring buffer
+
+// The thread which reads CD audio ahead of time, a signal to wake it up and a flag telling it to exit
+static std::thread                  gCdStreamThread;
+static std::condition_variable_any  gCdStreamWakeup;
+static bool                         gbCdStreamThreadQuit;
+
 // The lock for the CD player and a helper to lock/unlock via RAII.
-// N.B: this *CANNOT* be held the same time as the SPU lock, otherwise deadlock MIGHT occur!
-// The SPU can request audio from the CD and thus needs access to the cd player lock also.
+// N.B: the SPU audio callback no longer takes this lock, but to be safe do not hold it at the same time as the SPU lock.
 static std::recursive_mutex gCdPlayerMutex;
 
 struct LockCdPlayer {
@@ -69,78 +102,299 @@ static DiscReader gFileDiscReaders[MAX_OPEN_FILES] = {
     PsxVm::gDiscInfo, PsxVm::gDiscInfo, PsxVm::gDiscInfo, PsxVm::gDiscInfo,
 };
 
+// Asynchronous read requests which have been issued but not yet collected via 'psxcd_poll_async' or 'psxcd_wait_async'.
+// Requests are serviced in the order they were issued by the I/O thread, so reads from the same file happen in order.
+static constexpr int32_t MAX_ASYNC_READS = 32;
+
+struct AsyncReadRequest {
+    uint32_t                    id;                     // Id of the request or '0' if the slot is unused
+    bool                        bDone;                  // Set once the I/O thread has finished with the request
+    void*                       pDest;                  // Where to read to
+    int32_t                     numBytes;               // How many bytes to read
+    PsxCd_File                  file;                   // The file to read from (a copy of the caller's struct)
+    int32_t                     fileOffset;             // Offset to read from in the file or 'PSXCD_ASYNC_CUR_OFFSET'
+    PsxCd_AsyncReadCallback     pCallback;              // Optional callback invoked on completion
+    void*                       pCallbackUserData;      // User data passed to the callback
+    int32_t                     result;                 // Result of the read once done
+};
+
+static AsyncReadRequest         gAsyncReads[MAX_ASYNC_READS];
+static uint32_t                 gNextAsyncReadId = 1;
+
+// The thread which services asynchronous reads and the mutex guarding the requests.
+// The condition variable is signalled when a request is issued or completed, or when the thread is told to quit.
+static std::thread              gAsyncReadThread;
+static std::mutex               gAsyncReadMutex;
+static std::condition_variable  gAsyncReadCV;
+static bool                     gbAsyncReadThreadQuit;
+
 //------------------------------------------------------------------------------------------------------------------------------------------
-// A callback invoked by the SPU when it wants audio from the CD player - returns a single sample.
+// Helpers to pack and unpack the play head position: stream generation in the upper 32-bits, track in the next 8-bits and sector in the rest
 //------------------------------------------------------------------------------------------------------------------------------------------
-static Spu::StereoSample SpuAudioCallback([[maybe_unused]] void* pUserData) noexcept {
-    // Lock the CD player while we are doing this.
-    // Note that this thread also has the SPU lock at this point too.
-    // Therefore the main thread must NOT lock both the CD player and the SPU at the same time, or otherwise a deadlock might occur.
-    LockCdPlayer cdPlayerLock;
+static constexpr uint64_t packPlayHead(const uint32_t streamGen, const int32_t trackNum, const int32_t elapsedSectors) noexcept {
+    return ((uint64_t) streamGen << 32) | ((uint64_t)(trackNum & 0xFF) << 24) | (uint64_t)(elapsedSectors & 0xFFFFFF);
+}
 
-    // If the CD player is not currently active then return silence
-    if ((!gCdPlayer.bPlay) || (!gCdPlayer.discReader.isTrackOpen()))
-        return Spu::StereoSample{};
+static constexpr uint32_t getPlayHeadStreamGen(const uint64_t playHead) noexcept { return (uint32_t)(playHead >> 32); }
+static constexpr int32_t getPlayHeadTrack(const uint64_t playHead) noexcept { return (int32_t)((playHead >> 24) & 0xFF); }
+static constexpr int32_t getPlayHeadSectors(const uint64_t playHead) noexcept { return (int32_t)(playHead & 0xFFFFFF); }
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Starts a new generation of the CD audio stream, so that any audio read ahead previously is discarded and not played.
+// The CD player lock must be held when calling this.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void startNewCdStreamGen() noexcept {
+    gCdPlayer.streamGen.fetch_add(1, std::memory_order_release);
+    gCdStreamWakeup.notify_one();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tells if the streaming thread has more CD audio to read and room to put it.
+// The CD player lock must be held when calling this.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool canStreamMoreCdAudio() noexcept {
+    if ((!gCdPlayer.audioReader.isTrackOpen()) || (gCdPlayer.streamEndGen == gCdPlayer.streamGen.load(std::memory_order_relaxed)))
+        return false;
 
-    // Check if we have any data left in the buffer firstly
+    const uint32_t numQueuedChunks = gCdStreamHead.load(std::memory_order_relaxed) - gCdStreamTail.load(std::memory_order_acquire);
+    return (numQueuedChunks < CD_STREAM_NUM_CHUNKS);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Reads the next sector of CD audio into the ring buffer, handling looping and the end of the track.
+// The CD player lock must be held when calling this and there must be room in the ring buffer.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void streamNextCdAudioSector() noexcept {
     constexpr int16_t SAMPLE_SIZE = sizeof(int16_t);
-    constexpr int32_t NUM_BUFFER_SAMPLES = sizeof(gCdPlayer.buffer) / SAMPLE_SIZE;
-    static_assert(NUM_BUFFER_SAMPLES % 2 == 0);
-
-    DiscReader& disc = gCdPlayer.discReader;
-
-    if (gCdPlayer.bufferOffset + 1 >= NUM_BUFFER_SAMPLES) {
-        // Get the size of the track and where we are at in it
-        const DiscTrack* pTrack = disc.getOpenTrack();
-        int32_t trackSize = pTrack->trackPayloadSize;
-        int32_t trackOffset = disc.tell();
-
-        // See if there is any data left in the track to read
-        if (trackOffset >= trackSize) {
-            // We reached the end, do we loop back around again?
-            if (gCdPlayer.bLoop) {
-                // Looping: rewind back to the start plus any additional offset.
-                // Change tracks also if we need to.
-                if (disc.getTrackNum() != gCdPlayer.loopTrack) {
-                    disc.setTrackNum(gCdPlayer.loopTrack);
-
-                    // Need to re-fetch this info when changing tracks
-                    pTrack = disc.getOpenTrack();
-                    trackSize = pTrack->trackPayloadSize;
-                }
-
-                if (gCdPlayer.loopSectorOffset > 0) {
-                    disc.trackSeekAbs(CDDA_SECTOR_SIZE * gCdPlayer.loopSectorOffset);
-                } else {
-                    disc.trackSeekAbs(0);
-                }
-
-                trackOffset = disc.tell();
-            }
-            else {
-                // No looping, mark the CD player as no longer playing and return an empty sample
-                gCdPlayer.bPlay = false;
-                return Spu::StereoSample{};
-            }
+    constexpr int32_t NUM_CHUNK_SAMPLES = CDDA_SECTOR_SIZE / SAMPLE_SIZE;
+    static_assert(NUM_CHUNK_SAMPLES % 2 == 0);
+
+    // Get the size of the track and where we are at in it
+    CdAudioReader& disc = gCdPlayer.audioReader;
+    int32_t trackSize = disc.getTrackSize();
+    int32_t trackOffset = disc.tell();
+
+    // If we reached the end then loop back around again if looping.
+    // Looping: rewind back to the start plus any additional offset, changing tracks also if we need to.
+    if ((trackOffset >= trackSize) && gCdPlayer.bLoop) {
+        if (disc.getTrackNum() != gCdPlayer.loopTrack) {
+            disc.setTrackNum(gCdPlayer.loopTrack);
+            trackSize = disc.getTrackSize();     // Need to re-fetch this info when changing tracks
+        }
+
+        if (gCdPlayer.loopSectorOffset > 0) {
+            disc.trackSeekAbs(CDDA_SECTOR_SIZE * gCdPlayer.loopSectorOffset);
+        } else {
+            disc.trackSeekAbs(0);
+        }
+
+        trackOffset = disc.tell();
+    }
+
+    // Read what we can and zero anything we can't (in case the last sector is short for some reason).
+    // If this is the end of a non looping track then mark this chunk as the last one.
+    const uint32_t streamGen = gCdPlayer.streamGen.load(std::memory_order_relaxed);
+    const uint32_t head = gCdStreamHead.load(std::memory_order_relaxed);
+    CdStreamChunk& chunk = gCdStreamChunks[head & (CD_STREAM_NUM_CHUNKS - 1)];
+
+    const int32_t samplesToRead = std::clamp<int32_t>((trackSize - trackOffset) / SAMPLE_SIZE, 0, NUM_CHUNK_SAMPLES);
+    const int32_t samplesToZero = NUM_CHUNK_SAMPLES - samplesToRead;
+
+    if (samplesToRead > 0) {
+        disc.read(chunk.samples, samplesToRead * SAMPLE_SIZE);
+    }
+
+    if (samplesToZero > 0) {
+        std::memset(chunk.samples + samplesToRead, 0, (size_t) samplesToZero * SAMPLE_SIZE);
+    }
+
+    chunk.streamGen = streamGen;
+    chunk.trackNum = disc.getTrackNum();
+    chunk.elapsedSectors = disc.tell() / CDDA_SECTOR_SIZE;
+    chunk.bEndOfStream = ((!gCdPlayer.bLoop) && (disc.tell() >= trackSize));
+
+    if (chunk.bEndOfStream) {
+        gCdPlayer.streamEndGen = streamGen;
+    }
+
+    // Make the chunk visible to the audio callback
+    gCdStreamHead.store(head + 1, std::memory_order_release);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Entry point for the thread which reads CD audio ahead of the play head.
+// Reads a sector at a time, releasing the CD player lock in between so that the main thread is not held up for long.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void cdStreamThreadMain() noexcept {
+    while (true) {
+        std::unique_lock<std::recursive_mutex> cdPlayerLock(gCdPlayerMutex);
+
+        if (gbCdStreamThreadQuit)
+            break;
+
+        // Wait until there is something to read and room to put it, waking up regularly to check if the ring buffer has been drained
+        if (!canStreamMoreCdAudio()) {
+            gCdStreamWakeup.wait_for(cdPlayerLock, CD_STREAM_POLL_TIME);
+            continue;
+        }
+
+        streamNextCdAudioSector();
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Helpers: find the pending asynchronous read which should be serviced next (the oldest one) or find the request with the given id.
+// Note: the async read mutex must be held when calling these.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static AsyncReadRequest* findNextAsyncReadToService() noexcept {
+    AsyncReadRequest* pNextRequest = nullptr;
+
+    for (AsyncReadRequest& request : gAsyncReads) {
+        if ((request.id == 0) || request.bDone)
+            continue;
+
+        // Note: compare ids relatively so that wrapping is handled
+        if ((!pNextRequest) || ((int32_t)(request.id - pNextRequest->id) < 0)) {
+            pNextRequest = &request;
+        }
+    }
+
+    return pNextRequest;
+}
+
+static AsyncReadRequest* findAsyncRead(const uint32_t id) noexcept {
+    if (id == 0)
+        return nullptr;
+
+    for (AsyncReadRequest& request : gAsyncReads) {
+        if (request.id == id)
+            return &request;
+    }
+
+    return nullptr;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Entry point for the thread which services asynchronous reads.
+// Each read is done via the regular synchronous read functions with the mutex unlocked, so issuing and polling requests never waits on I/O.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void asyncReadThreadMain() noexcept {
+    std::unique_lock<std::mutex> lock(gAsyncReadMutex);
+
+    while (true) {
+        AsyncReadRequest* pRequest = nullptr;
+
+        gAsyncReadCV.wait(lock, [&]() noexcept {
+            pRequest = findNextAsyncReadToService();
+            return (gbAsyncReadThreadQuit || pRequest);
+        });
+
+        if (gbAsyncReadThreadQuit)
+            break;
+
+        // Do the read: nothing else touches the request or the file it reads from while the request is not done
+        lock.unlock();
+        int32_t result = 0;
+
+        if (pRequest->fileOffset != PSXCD_ASYNC_CUR_OFFSET) {
+            result = psxcd_seek(pRequest->file, pRequest->fileOffset, PsxCd_SeekMode::SET);
+        }
+
+        if (result == 0) {
+            result = psxcd_read(pRequest->pDest, pRequest->numBytes, pRequest->file);
+        }
+
+        if (pRequest->pCallback) {
+            pRequest->pCallback(pRequest->pCallbackUserData, result);
+        }
+
+        lock.lock();
+        pRequest->result = result;
+        pRequest->bDone = true;
+        gAsyncReadCV.notify_all();
+    }
+
+    // Fail any requests which have not been serviced, so nobody waits on them forever
+    for (AsyncReadRequest& request : gAsyncReads) {
+        if ((request.id != 0) && (!request.bDone)) {
+            request.result = -1;
+            request.bDone = true;
         }
+    }
+
+    gAsyncReadCV.notify_all();
+}
 
-        // Read what we can and zero anything we can't (in case the last sector is short for some reason)
-        const int32_t samplesToRead = std::min<int32_t>((trackSize - trackOffset) / SAMPLE_SIZE, NUM_BUFFER_SAMPLES);
-        const int32_t samplesToZero = NUM_BUFFER_SAMPLES - samplesToRead;
-        disc.read(gCdPlayer.buffer, samplesToRead * SAMPLE_SIZE);
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Waits for all asynchronous reads on the given file to finish, so that the file can be closed safely
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void waitForFileAsyncReads(const PsxCd_File& file) noexcept {
+    std::unique_lock<std::mutex> lock(gAsyncReadMutex);
 
-        if (samplesToZero > 0) {
-            std::memset(gCdPlayer.buffer + samplesToRead * SAMPLE_SIZE, 0, (size_t) samplesToZero * SAMPLE_SIZE);
+    gAsyncReadCV.wait(lock, [&]() noexcept {
+        for (const AsyncReadRequest& request : gAsyncReads) {
+            const bool bSameFile = (
+                (request.file.fileHandle == file.fileHandle) &&
+                (request.file.overrideFileHandle == file.overrideFileHandle)
+            );
+
+            if ((request.id != 0) && (!request.bDone) && bSameFile)
+                return false;
         }
 
-        gCdPlayer.bufferOffset = 0;
+        return true;
+    });
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// A callback invoked by the SPU when it wants audio from the CD player - returns a single sample.
+// Plays back audio which has been read ahead by the streaming thread, so that the audio thread never has to wait on disc I/O.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static Spu::StereoSample SpuAudioCallback([[maybe_unused]] void* pUserData) noexcept {
+    constexpr uint32_t NUM_CHUNK_SAMPLES = CDDA_SECTOR_SIZE / sizeof(int16_t);
+
+    // Discard any audio which was read ahead for a previous play, stop or seek
+    const uint32_t streamGen = gCdPlayer.streamGen.load(std::memory_order_acquire);
+    const uint32_t head = gCdStreamHead.load(std::memory_order_acquire);
+    uint32_t tail = gCdStreamTail.load(std::memory_order_relaxed);
+
+    if ((tail != head) && (gCdStreamChunks[tail & (CD_STREAM_NUM_CHUNKS - 1)].streamGen != streamGen)) {
+        do {
+            ++tail;
+        } while ((tail != head) && (gCdStreamChunks[tail & (CD_STREAM_NUM_CHUNKS - 1)].streamGen != streamGen));
+
+        gCdStreamChunkOffset = 0;
+        gCdStreamTail.store(tail, std::memory_order_release);
+    }
+
+    // If the CD player is not currently active, has finished or we are waiting on the streaming thread then return silence
+    if ((!gCdPlayer.bPlay.load(std::memory_order_relaxed)) || (gCdPlayer.playedEndGen.load(std::memory_order_relaxed) == streamGen))
+        return Spu::StereoSample{};
+
+    if (tail == head)
+        return Spu::StereoSample{};
+
+    // Update the play position when beginning a chunk
+    const CdStreamChunk& chunk = gCdStreamChunks[tail & (CD_STREAM_NUM_CHUNKS - 1)];
+
+    if (gCdStreamChunkOffset == 0) {
+        gCdPlayer.playHead.store(packPlayHead(streamGen, chunk.trackNum, chunk.elapsedSectors), std::memory_order_relaxed);
     }
 
-    // Should have samples in the buffer at this point, return the requested samples
-    ASSERT(gCdPlayer.bufferOffset + 2 <= NUM_BUFFER_SAMPLES);
+    // Return the next sample and move onto the next chunk once this one is done, stopping playback if its the end of the stream
+    ASSERT(gCdStreamChunkOffset + 2 <= NUM_CHUNK_SAMPLES);
+    const Spu::StereoSample sample = { chunk.samples[gCdStreamChunkOffset], chunk.samples[gCdStreamChunkOffset + 1] };
+    gCdStreamChunkOffset += 2;
+
+    if (gCdStreamChunkOffset >= NUM_CHUNK_SAMPLES) {
+        if (chunk.bEndOfStream) {
+            gCdPlayer.playedEndGen.store(streamGen, std::memory_order_relaxed);
+        }
+
+        gCdStreamChunkOffset = 0;
+        gCdStreamTail.store(tail + 1, std::memory_order_release);
+    }
 
-    Spu::StereoSample sample = { gCdPlayer.buffer[gCdPlayer.bufferOffset], gCdPlayer.buffer[gCdPlayer.bufferOffset + 1] };
-    gCdPlayer.bufferOffset += 2;
     return sample;
 }
 
@@ -162,6 +416,16 @@ void psxcd_init() noexcept {
         PsxVm::gSpu.pExtInputCallback = SpuAudioCallback;
         PsxVm::gSpu.pExtInputUserData = nullptr;
     }
+
+    // Start up the thread which reads CD audio ahead of time (CD audio is not played in headless mode)
+    if (!ProgArgs::gbHeadlessMode) {
+        gbCdStreamThreadQuit = false;
+        gCdStreamThread = std::thread(cdStreamThreadMain);
+    }
+
+    // Start up the thread which services asynchronous reads
+    gbAsyncReadThreadQuit = false;
+    gAsyncReadThread = std::thread(asyncReadThreadMain);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -174,6 +438,30 @@ void psxcd_exit() noexcept {
         PsxVm::gSpu.pExtInputCallback = nullptr;
         PsxVm::gSpu.pExtInputUserData = nullptr;
     }
+
+    // Stop the CD audio streaming thread
+    if (gCdStreamThread.joinable()) {
+        {
+            LockCdPlayer cdPlayerLock;
+            gbCdStreamThreadQuit = true;
+            gCdStreamWakeup.notify_one();
+        }
+
+        gCdStreamThread.join();
+    }
+
+    // Stop the asynchronous read thread: any reads not yet serviced will fail
+    if (gAsyncReadThread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(gAsyncReadMutex);
+            gbAsyncReadThreadQuit = true;
+        }
+
+        gAsyncReadCV.notify_all();
+        gAsyncReadThread.join();
+    }
+
+    gbPSXCD_IsCdInit = false;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -324,6 +612,9 @@ int32_t psxcd_tell(const PsxCd_File& file) noexcept {
 // Close a CD file and free up the file slot
 //------------------------------------------------------------------------------------------------------------------------------------------
 void psxcd_close([[maybe_unused]] PsxCd_File& file) noexcept {
+    // Can't close the file while the I/O thread might still be reading from it
+    waitForFileAsyncReads(file);
+
     // Modding mechanism: allow files to be overriden with user files in a specified directory
     if (ModMgr::isFileOverriden(file)) {
         ModMgr::closeOverridenFile(file);
@@ -338,6 +629,104 @@ void psxcd_close([[maybe_unused]] PsxCd_File& file) noexcept {
     file = {};
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Starts an asynchronous read of the specified number of bytes from the given CD file (or override file) and returns a handle to the request.
+// If a file offset is given then the file is seeked to that offset first, otherwise the read happens from wherever the file is at once all
+// previously issued reads have been done. Reads happen in the order that they are issued.
+//
+// Notes:
+//  (1) The destination buffer must remain valid until the request has been completed.
+//  (2) The file must not be read, seeked or told synchronously while it has reads in flight; closing it waits for those reads to finish.
+//  (3) Every request must be collected via 'psxcd_wait_async' or a successful 'psxcd_poll_async' to release it.
+//------------------------------------------------------------------------------------------------------------------------------------------
+PsxCd_AsyncRead psxcd_read_async(
+    void* const pDest,
+    const int32_t numBytes,
+    const PsxCd_File& file,
+    const int32_t fileOffset,
+    const PsxCd_AsyncReadCallback pCallback,
+    void* const pCallbackUserData
+) noexcept {
+    ASSERT(gAsyncReadThread.joinable());
+    std::unique_lock<std::mutex> lock(gAsyncReadMutex);
+
+    // Find a free request slot
+    AsyncReadRequest* pRequest = nullptr;
+
+    for (AsyncReadRequest& request : gAsyncReads) {
+        if (request.id == 0) {
+            pRequest = &request;
+            break;
+        }
+    }
+
+    if (!pRequest) {
+        FatalErrors::raise("psxcd_read_async: too many asynchronous reads in flight!");
+    }
+
+    // Fill in the request and wake up the I/O thread.
+    // Note: never hand out an id of '0' since that means the null request.
+    pRequest->id = gNextAsyncReadId++;
+
+    if (gNextAsyncReadId == 0) {
+        gNextAsyncReadId = 1;
+    }
+
+    pRequest->bDone = false;
+    pRequest->pDest = pDest;
+    pRequest->numBytes = numBytes;
+    pRequest->file = file;
+    pRequest->fileOffset = fileOffset;
+    pRequest->pCallback = pCallback;
+    pRequest->pCallbackUserData = pCallbackUserData;
+    pRequest->result = -1;
+
+    const PsxCd_AsyncRead handle = { pRequest->id };
+    lock.unlock();
+    gAsyncReadCV.notify_all();
+    return handle;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Checks to see if an asynchronous read is done without waiting.
+// If done then the result of the read ('numBytes' on success, '-1' on failure) is saved and the request is released.
+// Returns 'true' and a result of '-1' for invalid or already released requests.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool psxcd_poll_async(const PsxCd_AsyncRead request, int32_t& result) noexcept {
+    std::lock_guard<std::mutex> lock(gAsyncReadMutex);
+    AsyncReadRequest* const pRequest = findAsyncRead(request.id);
+
+    if (!pRequest) {
+        result = -1;
+        return true;
+    }
+
+    if (!pRequest->bDone)
+        return false;
+
+    result = pRequest->result;
+    *pRequest = {};
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Waits for an asynchronous read to finish, releases the request and returns the result of the read.
+// Returns '-1' for invalid or already released requests.
+//------------------------------------------------------------------------------------------------------------------------------------------
+int32_t psxcd_wait_async(const PsxCd_AsyncRead request) noexcept {
+    std::unique_lock<std::mutex> lock(gAsyncReadMutex);
+    AsyncReadRequest* const pRequest = findAsyncRead(request.id);
+
+    if (!pRequest)
+        return -1;
+
+    gAsyncReadCV.wait(lock, [&]() noexcept { return pRequest->bDone; });
+
+    const int32_t result = pRequest->result;
+    *pRequest = {};
+    return result;
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Internal helper to eliminate the redundancy between 'psxcd_play_at_andloop' and 'psxcd_play_at'.
 // This is a new addition for PsyDoom.
@@ -362,7 +751,8 @@ static void psxcd_play_internal(
         // N.B: don't hold this lock in the main thread at the same time as the SPU lock - otherwise deadlock might occur!
         LockCdPlayer cdPlayerLock;
         gCdPlayer.bPlay = false;
-        setTrackOk = gCdPlayer.discReader.setTrackNum(track);
+        setTrackOk = gCdPlayer.audioReader.setTrackNum(track);
+        startNewCdStreamGen();
     }
 
     if (!setTrackOk) {
@@ -386,16 +776,18 @@ static void psxcd_play_internal(
         // N.B: don't hold this lock in the main thread at the same time as the SPU lock - otherwise deadlock might occur!
         LockCdPlayer cdPlayerLock;
 
-        if (sectorOffset > 0) {
-            gCdPlayer.discReader.trackSeekAbs(CDDA_SECTOR_SIZE * sectorOffset);
-        }
+        // Note: always seek since the streaming thread may have read some of the track while the lock was released
+        gCdPlayer.audioReader.trackSeekAbs(CDDA_SECTOR_SIZE * std::max(sectorOffset, 0));
 
-        // Mark the player as playing and save loop parameters
+        // Mark the player as playing and save loop parameters.
+        // Start a new stream generation so that only audio read from here onwards will be played.
         gCdPlayer.bPlay = true;
-        gCdPlayer.bufferOffset = CDDA_SECTOR_SIZE / sizeof(int16_t);    // Need to read a sector
         gCdPlayer.bLoop = bLoop;
         gCdPlayer.loopTrack = loopTrack;
         gCdPlayer.loopSectorOffset = loopSectorOffset;
+        gCdPlayer.startTrack = track;
+        gCdPlayer.startSector = gCdPlayer.audioReader.tell() / CDDA_SECTOR_SIZE;
+        startNewCdStreamGen();
     }
 }
 
@@ -456,7 +848,7 @@ void psxcd_stop() noexcept {
     {
         // N.B: don't hold this lock in the main thread at the same time as the SPU lock - otherwise deadlock might occur!
         LockCdPlayer cdPlayerLock;
-        bMightNeedFade = (gCdPlayer.discReader.isTrackOpen() && gCdPlayer.bPlay);
+        bMightNeedFade = (gCdPlayer.audioReader.isTrackOpen() && gCdPlayer.bPlay);
     }
 
     if (bMightNeedFade) {
@@ -473,11 +865,11 @@ void psxcd_stop() noexcept {
         // N.B: don't hold this lock in the main thread at the same time as the SPU lock - otherwise deadlock might occur!
         LockCdPlayer cdPlayerLock;
 
-        gCdPlayer.discReader.closeTrack();
+        gCdPlayer.audioReader.closeTrack();
         gCdPlayer.bPlay = false;
         gCdPlayer.bLoop = false;
-        gCdPlayer.bufferOffset = 0;
         gCdPlayer.loopSectorOffset = 0;
+        startNewCdStreamGen();
     }
 }
 
@@ -491,7 +883,7 @@ void psxcd_pause() noexcept {
     {
         // N.B: don't hold this lock in the main thread at the same time as the SPU lock - otherwise deadlock might occur!
         LockCdPlayer cdPlayerLock;
-        bMightNeedFade = (gCdPlayer.discReader.isTrackOpen() && gCdPlayer.bPlay);
+        bMightNeedFade = (gCdPlayer.audioReader.isTrackOpen() && gCdPlayer.bPlay);
     }
 
     if (bMightNeedFade) {
@@ -520,7 +912,7 @@ void psxcd_restart(const int32_t vol) noexcept {
         // N.B: don't hold this lock in the main thread at the same time as the SPU lock - otherwise deadlock might occur!
         LockCdPlayer cdPlayerLock;
 
-        if (!gCdPlayer.discReader.isTrackOpen())
+        if (!gCdPlayer.audioReader.isTrackOpen())
             return;
 
         // Begin playing again
@@ -536,8 +928,15 @@ void psxcd_restart(const int32_t vol) noexcept {
 //------------------------------------------------------------------------------------------------------------------------------------------
 int32_t psxcd_elapsed_sectors() noexcept {
     // N.B: don't hold this lock in the main thread at the same time as the SPU lock - otherwise deadlock might occur!
+    // PsyDoom: report the position of the play head rather than the disc reader, since the disc reader is ahead due to streaming.
     LockCdPlayer cdPlayerLock;
-    return (gCdPlayer.discReader.isTrackOpen()) ? gCdPlayer.discReader.tell() / CDDA_SECTOR_SIZE : 0;
+
+    if (!gCdPlayer.audioReader.isTrackOpen())
+        return 0;
+
+    const uint64_t playHead = gCdPlayer.playHead.load(std::memory_order_relaxed);
+    const bool bPlayHeadValid = (getPlayHeadStreamGen(playHead) == gCdPlayer.streamGen.load(std::memory_order_relaxed));
+    return (bPlayHeadValid) ? getPlayHeadSectors(playHead) : gCdPlayer.startSector;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -552,7 +951,13 @@ int32_t psxcd_get_file_size(const CdFileId discFile) noexcept {
 }
 
 int32_t psxcd_get_playing_track() noexcept {
+    // PsyDoom: report the track at the play head rather than the disc reader, since the disc reader may have already looped due to streaming.
     LockCdPlayer cdPlayerLock;
-    const DiscTrack* const pTrack = gCdPlayer.discReader.getOpenTrack();
-    return (pTrack) ? pTrack->trackNum : -1;
+
+    if (!gCdPlayer.audioReader.isTrackOpen())
+        return -1;
+
+    const uint64_t playHead = gCdPlayer.playHead.load(std::memory_order_relaxed);
+    const bool bPlayHeadValid = (getPlayHeadStreamGen(playHead) == gCdPlayer.streamGen.load(std::memory_order_relaxed));
+    return (bPlayHeadValid) ? getPlayHeadTrack(playHead) : gCdPlayer.startTrack;
 }
@@ -55,6 +55,18 @@ struct PsxCd_MapTblEntry {
     }
 };
 
+// Handle to an asynchronous read request: an id of '0' means an invalid or null request
+struct PsxCd_AsyncRead {
+    uint32_t    id;
+};
+
+// Optional callback invoked when an asynchronous read completes, with the result of the read ('numBytes' on success, '-1' on failure).
+// N.B: this is called on the I/O thread, so it must be thread safe and should do very little work!
+typedef void (*PsxCd_AsyncReadCallback)(void* const pUserData, const int32_t result) noexcept;
+
+// Offset value for an asynchronous read which means 'read from wherever the file is currently at'
+static constexpr int32_t PSXCD_ASYNC_CUR_OFFSET = -1;
+
 void psxcd_init() noexcept;
 void psxcd_exit() noexcept;
 PsxCd_File* psxcd_open(const CdFileId discFile) noexcept;
@@ -64,6 +76,18 @@ int32_t psxcd_seek(PsxCd_File& file, int32_t offset, const PsxCd_SeekMode mode)
 int32_t psxcd_tell(const PsxCd_File& file) noexcept;
 void psxcd_close(PsxCd_File& file) noexcept;
 
+PsxCd_AsyncRead psxcd_read_async(
+    void* const pDest,
+    const int32_t numBytes,
+    const PsxCd_File& file,
+    const int32_t fileOffset = PSXCD_ASYNC_CUR_OFFSET,
+    const PsxCd_AsyncReadCallback pCallback = nullptr,
+    void* const pCallbackUserData = nullptr
+) noexcept;
+
+bool psxcd_poll_async(const PsxCd_AsyncRead request, int32_t& result) noexcept;
+int32_t psxcd_wait_async(const PsxCd_AsyncRead request) noexcept;
+
 void psxcd_play_at_andloop(
     const int32_t track,
     const int32_t vol,
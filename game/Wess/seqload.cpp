@@ -8,11 +8,16 @@
 #include "wessapi.h"
 #include "wessarc.h"
 
+#include <cstring>
+#include <vector>
+
 bool gbWess_seq_loader_enable;      // Has the sequence loader been initialized?
 
 static int32_t                      gWess_num_sequences;            // The number of sequences in the loaded module file
 static int32_t                      gWess_seqld_moduleRefCount;     // Reference count for the opened module file - closed upon reaching '0'
-static PsxCd_File*                  gpWess_seqld_moduleFile;        // The module file from which sequences are loaded
+#if !PSYDOOM_MODS
+    static PsxCd_File*              gpWess_seqld_moduleFile;        // The module file from which sequences are loaded
+#endif
 static CdFileId                     gWess_seqld_moduleFileId;       // File id for the module file
 static master_status_structure*     gpWess_seqld_mstat;             // Saved reference to the master status structure
 static track_header                 gWess_seqld_seqTrackHdr;        // Track header for the current sequence track being loaded
@@ -20,6 +25,14 @@ static track_header                 gWess_seqld_emptyTrackHdr;      // Track hea
 static SeqLoaderErrorHandler        gpWess_seqld_errorHandler;      // Callback invoked if there are problems loading sequences
 static int32_t                      gWess_seqld_errorModule;        // Module value passed to the error handling callback
 
+#if PSYDOOM_MODS
+    // PsyDoom: the entire module file is buffered in memory the first time sequence data is needed and all sequences are loaded from that.
+    // Module files are small, so this is much faster than doing multiple small reads from the file for each sequence that is loaded.
+    static std::vector<uint8_t>     gWess_seqld_moduleData;         // The contents of the module file
+    static bool                     gbWess_seqld_moduleDataLoaded;  // True if the module file has been buffered
+    static int32_t                  gWess_seqld_moduleDataPos;      // Current read position in the buffered module file
+#endif
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Invokes the sequence loader error handler with the given error code
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -50,14 +63,39 @@ bool Is_Seq_Seq_Num_Valid(const int32_t seqIdx) noexcept {
 // Returns 'true' if the file is successfully opened.
 //------------------------------------------------------------------------------------------------------------------------------------------
 bool open_sequence_data() noexcept {
-    if (gWess_seqld_moduleRefCount == 0) {
-        gpWess_seqld_moduleFile = module_open(gWess_seqld_moduleFileId);
+    #if PSYDOOM_MODS
+        // PsyDoom: buffer the entire module file instead of keeping it open, if not already done
+        if (!gbWess_seqld_moduleDataLoaded) {
+            PsxCd_File* const pModuleFile = module_open(gWess_seqld_moduleFileId);
+
+            if (!pModuleFile) {
+                wess_seq_load_err(SEQLOAD_FOPEN);
+                return false;
+            }
 
-        if (!gpWess_seqld_moduleFile) {
-            wess_seq_load_err(SEQLOAD_FOPEN);
-            return false;
+            const int32_t moduleFileSize = pModuleFile->size;
+            gWess_seqld_moduleData.resize((moduleFileSize > 0) ? (size_t) moduleFileSize : 0);
+            const int32_t numBytesRead = module_read(gWess_seqld_moduleData.data(), moduleFileSize, *pModuleFile);
+            module_close(*pModuleFile);
+
+            if ((moduleFileSize <= 0) || (numBytesRead != moduleFileSize)) {
+                gWess_seqld_moduleData.clear();
+                wess_seq_load_err(SEQLOAD_FREAD);
+                return false;
+            }
+
+            gbWess_seqld_moduleDataLoaded = true;
         }
-    }
+    #else
+        if (gWess_seqld_moduleRefCount == 0) {
+            gpWess_seqld_moduleFile = module_open(gWess_seqld_moduleFileId);
+
+            if (!gpWess_seqld_moduleFile) {
+                wess_seq_load_err(SEQLOAD_FOPEN);
+                return false;
+            }
+        }
+    #endif
 
     gWess_seqld_moduleRefCount++;
     return true;
@@ -68,15 +106,65 @@ bool open_sequence_data() noexcept {
 // If the reference count falls to '0' then the file is closed.
 //------------------------------------------------------------------------------------------------------------------------------------------
 void close_sequence_data() noexcept {
-    if (gWess_seqld_moduleRefCount == 1) {
-        module_close(*gpWess_seqld_moduleFile);
-    }
+    // PsyDoom: the module file is not kept open anymore, it's buffered in memory instead
+    #if !PSYDOOM_MODS
+        if (gWess_seqld_moduleRefCount == 1) {
+            module_close(*gpWess_seqld_moduleFile);
+        }
+    #endif
 
     if (gWess_seqld_moduleRefCount > 0) {
         gWess_seqld_moduleRefCount--;
     }
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Seek to the specified position in the module file containing sequences.
+// Returns '0' on success, any other value on failure.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static int32_t seqld_module_seek(const int32_t seekPos, const PsxCd_SeekMode seekMode) noexcept {
+    #if PSYDOOM_MODS
+        // PsyDoom: seek within the buffered module file
+        const int32_t moduleDataSize = (int32_t) gWess_seqld_moduleData.size();
+        int32_t newPos = seekPos;
+
+        if (seekMode == PsxCd_SeekMode::CUR) {
+            newPos += gWess_seqld_moduleDataPos;
+        } else if (seekMode == PsxCd_SeekMode::END) {
+            newPos = moduleDataSize - seekPos;
+        }
+
+        if ((newPos < 0) || (newPos > moduleDataSize))
+            return -1;
+
+        gWess_seqld_moduleDataPos = newPos;
+        return 0;
+    #else
+        return module_seek(*gpWess_seqld_moduleFile, seekPos, seekMode);
+    #endif
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Read the specified number of bytes from the module file containing sequences and return the number of bytes read
+//------------------------------------------------------------------------------------------------------------------------------------------
+static int32_t seqld_module_read(void* const pDest, const int32_t numBytes) noexcept {
+    #if PSYDOOM_MODS
+        // PsyDoom: read from the buffered module file
+        const int32_t moduleDataSize = (int32_t) gWess_seqld_moduleData.size();
+        const int32_t numBytesLeft = moduleDataSize - gWess_seqld_moduleDataPos;
+        const int32_t numBytesToRead = (numBytes < numBytesLeft) ? numBytes : numBytesLeft;
+
+        if (numBytesToRead <= 0)
+            return 0;
+
+        std::memcpy(pDest, gWess_seqld_moduleData.data() + gWess_seqld_moduleDataPos, (size_t) numBytesToRead);
+        gWess_seqld_moduleDataPos += numBytesToRead;
+        return numBytesToRead;
+    #else
+        return module_read(pDest, numBytes, *gpWess_seqld_moduleFile);
+    #endif
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Loads the given sequence into the given memory block, which is expected to be big enough.
 // Returns the number of bytes used from the given memory block, or '0' on failure.
@@ -109,15 +197,13 @@ static int32_t load_sequence_data(const int32_t seqIdx, void* const pSeqMem) noe
     }
 
     // Go to where the sequence is located in the module file
-    PsxCd_File& moduleFile = *gpWess_seqld_moduleFile;
-
-    if (module_seek(moduleFile, sequence.modfile_offset, PsxCd_SeekMode::SET) != 0) {
+    if (seqld_module_seek(sequence.modfile_offset, PsxCd_SeekMode::SET) != 0) {
         wess_seq_load_err(SEQLOAD_FSEEK);
         return 0;
     }
 
     // Read the sequence header
-    if (module_read(&sequence.hdr, sizeof(sequence_header), moduleFile) != sizeof(sequence_header)) {
+    if (seqld_module_read(&sequence.hdr, sizeof(sequence_header)) != sizeof(sequence_header)) {
         wess_seq_load_err(SEQLOAD_FREAD);
         return 0;
     }
@@ -127,7 +213,7 @@ static int32_t load_sequence_data(const int32_t seqIdx, void* const pSeqMem) noe
         // Read the track header firstly
         track_header& trackHdr = gWess_seqld_seqTrackHdr;
 
-        if (module_read(&trackHdr, sizeof(track_header), moduleFile) != sizeof(track_header)) {
+        if (seqld_module_read(&trackHdr, sizeof(track_header)) != sizeof(track_header)) {
             wess_seq_load_err(SEQLOAD_FREAD);
             return 0;
         }
@@ -162,7 +248,7 @@ static int32_t load_sequence_data(const int32_t seqIdx, void* const pSeqMem) noe
         if (!bLoadTrack) {
             const uint32_t bytesToSkip = trackHdr.num_labels * sizeof(uint32_t) + trackHdr.cmd_stream_size;
 
-            if (module_seek(moduleFile, bytesToSkip, PsxCd_SeekMode::CUR) != 0) {
+            if (seqld_module_seek(bytesToSkip, PsxCd_SeekMode::CUR) != 0) {
                 wess_seq_load_err(SEQLOAD_FSEEK);
                 return 0;
             }
@@ -221,7 +307,7 @@ static int32_t load_sequence_data(const int32_t seqIdx, void* const pSeqMem) noe
         track.plabels = (uint32_t*) pCurSeqMem;
         pCurSeqMem += labelListSize;
 
-        if (module_read(track.plabels, labelListSize, moduleFile) != labelListSize) {
+        if (seqld_module_read(track.plabels, labelListSize) != labelListSize) {
             wess_seq_load_err(SEQLOAD_FREAD);
             return 0;
         }
@@ -235,7 +321,7 @@ static int32_t load_sequence_data(const int32_t seqIdx, void* const pSeqMem) noe
         pCurSeqMem += ((uintptr_t) pCurSeqMem) & 2;
 
         // Read the track command stream
-        if (module_read(track.pcmd_stream, trackCmdStreamSize, moduleFile) != trackCmdStreamSize) {
+        if (seqld_module_read(track.pcmd_stream, trackCmdStreamSize) != trackCmdStreamSize) {
             wess_seq_load_err(SEQLOAD_FREAD);
             return 0;
         }
@@ -278,6 +364,13 @@ bool wess_seq_loader_init(master_status_structure* const pMStat, const CdFileId
     gWess_seqld_moduleFileId = moduleFileId;
     gpWess_seqld_mstat = pMStat;
 
+    // PsyDoom: the module file might be different, so it needs to be buffered again
+    #if PSYDOOM_MODS
+        gWess_seqld_moduleData.clear();
+        gbWess_seqld_moduleDataLoaded = false;
+        gWess_seqld_moduleDataPos = 0;
+    #endif
+
     // If there is no master stat then this fails
     if (!pMStat)
         return false;
@@ -322,6 +415,12 @@ bool wess_seq_loader_init(master_status_structure* const pMStat, const CdFileId
 void wess_seq_loader_exit() noexcept {
     close_sequence_data();
     gbWess_seq_loader_enable = false;
+
+    #if PSYDOOM_MODS
+        gWess_seqld_moduleData.clear();
+        gWess_seqld_moduleData.shrink_to_fit();
+        gbWess_seqld_moduleDataLoaded = false;
+    #endif
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "Macros.h"
+
+#include <cstdint>
+#include <vector>
+
+BEGIN_NAMESPACE(Bench)
+
+// Prepares the fixed input data for a benchmark: this is called once before the benchmark is timed
+typedef void (*SetupFunc)() noexcept;
+
+// Runs one pass of a benchmark and returns a checksum of the results.
+// The checksum stops the compiler from optimizing the work away and is also reported, so that optimizations can be checked for changes
+// in behavior: for the same build settings it should always be the same from run to run.
+typedef uint64_t (*RunFunc)() noexcept;
+
+// Describes a single benchmark
+struct Benchmark {
+    const char*     name;       // Name of the benchmark, as shown in the results and matched by the '-filter' argument
+    SetupFunc       setup;      // Optional function called once before timing, 'nullptr' if none
+    RunFunc         run;        // Runs one timed pass of the benchmark
+    uint32_t        numOps;     // How many operations one pass does: used to report the time per operation
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Deterministic 'xorshift64*' random number generator used to generate the fixed input data for the benchmarks.
+// Always produces the same sequence for a given seed, on all platforms, so that the input data is the same for every run.
+//------------------------------------------------------------------------------------------------------------------------------------------
+class Rng {
+public:
+    inline Rng(const uint64_t seed) noexcept : mState(seed ? seed : 0x9E3779B97F4A7C15ull) {}
+
+    inline uint64_t next() noexcept {
+        mState ^= mState >> 12;
+        mState ^= mState << 25;
+        mState ^= mState >> 27;
+        return mState * 0x2545F4914F6CDD1Dull;
+    }
+
+    // Returns a random number in the inclusive range given
+    inline int32_t range(const int32_t minVal, const int32_t maxVal) noexcept {
+        const uint64_t numVals = (uint64_t)((int64_t) maxVal - minVal) + 1;
+        return (int32_t)((int64_t) minVal + (int64_t)((next() >> 16) % numVals));
+    }
+
+private:
+    uint64_t mState;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Mixes a value into a running checksum
+//------------------------------------------------------------------------------------------------------------------------------------------
+inline constexpr uint64_t mixChecksum(const uint64_t checksum, const uint64_t value) noexcept {
+    return (checksum ^ value) * 0x100000001B3ull + (checksum >> 29);
+}
+
+// Functions adding each group of benchmarks to the list of benchmarks to run
+void addBenchmarks_Fixed(std::vector<Benchmark>& benchmarks) noexcept;
+void addBenchmarks_Wad(std::vector<Benchmark>& benchmarks) noexcept;
+void addBenchmarks_Spu(std::vector<Benchmark>& benchmarks) noexcept;
+void addBenchmarks_Gpu(std::vector<Benchmark>& benchmarks) noexcept;
+void addBenchmarks_Occlusion(std::vector<Benchmark>& benchmarks) noexcept;
+
+END_NAMESPACE(Bench)
@@ -0,0 +1,118 @@
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Microbenchmark suite for performance critical PsyDoom code.
+//
+// Each benchmark runs a fixed amount of work on fixed input data (generated from a fixed seed) a number of times, and the median and
+// minimum time per operation across all runs are reported. These numbers are intended to serve as a baseline when optimizing, so that
+// before and after timings can be compared. A checksum of the results is also reported for each benchmark: an optimization should not
+// normally change it.
+//
+// Usage:
+//      PsyDoomBench [-filter <TEXT>] [-runs <NUM_RUNS>] [-list]
+//
+//  -filter <TEXT>      Only run benchmarks with names containing the given text (case sensitive)
+//  -runs <NUM_RUNS>    How many timed runs to do for each benchmark (default 21)
+//  -list               Just list the names of all benchmarks and exit
+//------------------------------------------------------------------------------------------------------------------------------------------
+#include "Bench.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// How many timed runs to do by default for each benchmark
+static constexpr uint32_t DEFAULT_NUM_RUNS = 21;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Times all the runs for the given benchmark and prints the results
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void runBenchmark(const Bench::Benchmark& benchmark, const uint32_t numRuns) noexcept {
+    typedef std::chrono::steady_clock clock;
+
+    // Setup and do an untimed warmup run first, so that caches are warm and any lazily allocated memory is allocated
+    if (benchmark.setup) {
+        benchmark.setup();
+    }
+
+    const uint64_t checksum = benchmark.run();
+
+    // Do all of the timed runs: note that the checksum should be the same for every run!
+    std::vector<double> runNsPerOp;
+    runNsPerOp.reserve(numRuns);
+    bool bChecksumMismatch = false;
+
+    for (uint32_t runIdx = 0; runIdx < numRuns; ++runIdx) {
+        const clock::time_point startTime = clock::now();
+        const uint64_t runChecksum = benchmark.run();
+        const clock::time_point endTime = clock::now();
+
+        const double runNs = (double) std::chrono::duration_cast<std::chrono::nanoseconds>(endTime - startTime).count();
+        runNsPerOp.push_back(runNs / (double) benchmark.numOps);
+        bChecksumMismatch |= (runChecksum != checksum);
+    }
+
+    std::sort(runNsPerOp.begin(), runNsPerOp.end());
+    const double medianNsPerOp = runNsPerOp[runNsPerOp.size() / 2];
+    const double minNsPerOp = runNsPerOp.front();
+
+    std::printf(
+        "%-44s %12.2f ns/op   (min %12.2f)   checksum %016llX%s\n",
+        benchmark.name,
+        medianNsPerOp,
+        minNsPerOp,
+        (unsigned long long) checksum,
+        (bChecksumMismatch) ? "   (NOT REPEATABLE!)" : ""
+    );
+
+    std::fflush(stdout);
+}
+
+int main(const int argc, const char* const* const argv) {
+    // Parse command line arguments
+    const char* filter = "";
+    uint32_t numRuns = DEFAULT_NUM_RUNS;
+    bool bListOnly = false;
+
+    for (int argIdx = 1; argIdx < argc; ++argIdx) {
+        const char* const arg = argv[argIdx];
+
+        if ((std::strcmp(arg, "-filter") == 0) && (argIdx + 1 < argc)) {
+            filter = argv[++argIdx];
+        }
+        else if ((std::strcmp(arg, "-runs") == 0) && (argIdx + 1 < argc)) {
+            numRuns = (uint32_t) std::max(std::atoi(argv[++argIdx]), 1);
+        }
+        else if (std::strcmp(arg, "-list") == 0) {
+            bListOnly = true;
+        }
+        else {
+            std::printf("Usage: PsyDoomBench [-filter <TEXT>] [-runs <NUM_RUNS>] [-list]\n");
+            return 1;
+        }
+    }
+
+    // Gather all of the benchmarks and run the ones requested
+    std::vector<Bench::Benchmark> benchmarks;
+    Bench::addBenchmarks_Fixed(benchmarks);
+    Bench::addBenchmarks_Wad(benchmarks);
+    Bench::addBenchmarks_Spu(benchmarks);
+    Bench::addBenchmarks_Gpu(benchmarks);
+
+    #if PSYDOOM_VULKAN_RENDERER
+        Bench::addBenchmarks_Occlusion(benchmarks);
+    #endif
+
+    for (const Bench::Benchmark& benchmark : benchmarks) {
+        if (!std::strstr(benchmark.name, filter))
+            continue;
+
+        if (bListOnly) {
+            std::printf("%s\n", benchmark.name);
+        } else {
+            runBenchmark(benchmark, numRuns);
+        }
+    }
+
+    return 0;
+}
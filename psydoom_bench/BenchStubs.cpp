@@ -0,0 +1,25 @@
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Definitions for the few game globals used by the game modules that the benchmarks link against.
+// The benchmarks do not link the entire game, so these stand in for the real definitions; values are for a 1280x960 framebuffer.
+//------------------------------------------------------------------------------------------------------------------------------------------
+#include "PsyDoom/Config/Config.h"
+#include "PsyDoom/Vulkan/VRenderer.h"
+
+#if PSYDOOM_VULKAN_RENDERER
+
+BEGIN_NAMESPACE(Config)
+
+bool gbVulkanWidescreenEnabled = false;
+bool gbVulkanOcclusionCoverageBuffer = false;
+
+END_NAMESPACE(Config)
+
+BEGIN_NAMESPACE(VRenderer)
+
+uint32_t    gFramebufferW = 1280;
+float       gPsxCoordsFbX = 0.0f;
+float       gPsxCoordsFbW = 1280.0f;
+
+END_NAMESPACE(VRenderer)
+
+#endif  // #if PSYDOOM_VULKAN_RENDERER
@@ -0,0 +1,67 @@
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Benchmarks for the fixed point math functions in 'm_fixed.cpp'
+//------------------------------------------------------------------------------------------------------------------------------------------
+#include "Bench.h"
+
+#include "Doom/Base/m_fixed.h"
+
+BEGIN_NAMESPACE(Bench)
+
+// How many operands there are and how many passes over them each run does
+static constexpr uint32_t NUM_OPERANDS = 4096;
+static constexpr uint32_t NUM_PASSES = 16;
+
+static fixed_t gMulOperands[NUM_OPERANDS][2];
+static fixed_t gDivOperands[NUM_OPERANDS][2];
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Generates operands in the ranges typically seen in game code: map coordinates, distances, slopes and scale factors
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void setupFixedOperands() noexcept {
+    Rng rng(0xF1C3Du);
+
+    for (fixed_t (&operands)[2] : gMulOperands) {
+        operands[0] = rng.range(-4096 * FRACUNIT, 4096 * FRACUNIT);
+        operands[1] = rng.range(-4 * FRACUNIT, 4 * FRACUNIT);
+    }
+
+    for (fixed_t (&operands)[2] : gDivOperands) {
+        operands[0] = rng.range(-1024 * FRACUNIT, 1024 * FRACUNIT);
+        operands[1] = rng.range(FRACUNIT / 16, 2048 * FRACUNIT);
+        operands[1] = (rng.next() & 1) ? operands[1] : -operands[1];
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Note: results are just summed for the checksum, so that checksum calculations do not add much to the measured time
+//------------------------------------------------------------------------------------------------------------------------------------------
+static uint64_t runFixedMul() noexcept {
+    uint64_t checksum = 0;
+
+    for (uint32_t pass = 0; pass < NUM_PASSES; ++pass) {
+        for (const fixed_t (&operands)[2] : gMulOperands) {
+            checksum += (uint32_t) FixedMul(operands[0], operands[1]);
+        }
+    }
+
+    return checksum;
+}
+
+static uint64_t runFixedDiv() noexcept {
+    uint64_t checksum = 0;
+
+    for (uint32_t pass = 0; pass < NUM_PASSES; ++pass) {
+        for (const fixed_t (&operands)[2] : gDivOperands) {
+            checksum += (uint32_t) FixedDiv(operands[0], operands[1]);
+        }
+    }
+
+    return checksum;
+}
+
+void addBenchmarks_Fixed(std::vector<Benchmark>& benchmarks) noexcept {
+    benchmarks.push_back({ "FixedMul", setupFixedOperands, runFixedMul, NUM_OPERANDS * NUM_PASSES });
+    benchmarks.push_back({ "FixedDiv", setupFixedOperands, runFixedDiv, NUM_OPERANDS * NUM_PASSES });
+}
+
+END_NAMESPACE(Bench)
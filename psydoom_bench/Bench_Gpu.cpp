@@ -0,0 +1,224 @@
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Benchmarks for the software GPU in the 'SimpleGpu' library: drawing each type of primitive with the typical draw mode for it.
+// All primitives are drawn into a 320x240 area of VRAM (the size of the original framebuffer) and textured primitives use an 8bpp
+// 128x128 texture, like most of the wall and floor textures in the game.
+//------------------------------------------------------------------------------------------------------------------------------------------
+#include "Bench.h"
+
+#include "Gpu.h"
+
+#include <algorithm>
+
+BEGIN_NAMESPACE(Bench)
+
+// How many primitives of each type are drawn per run
+static constexpr uint32_t NUM_PRIMS = 256;
+
+// Size of the area being drawn to, and the size and location in VRAM of the texture & CLUT used
+static constexpr int16_t DRAW_AREA_W = 320;
+static constexpr int16_t DRAW_AREA_H = 240;
+static constexpr uint16_t TEX_VRAM_X = 512;
+static constexpr uint16_t TEX_SIZE = 128;
+static constexpr uint16_t CLUT_VRAM_X = 0;
+static constexpr uint16_t CLUT_VRAM_Y = 480;
+
+static Gpu::Core                                gGpuCore;
+static bool                                     gbGpuCoreInit;
+static std::vector<Gpu::DrawRect>               gGpuRects;
+static std::vector<Gpu::DrawLine>               gGpuLines;
+static std::vector<Gpu::DrawTriangle>           gGpuTriangles;
+static std::vector<Gpu::DrawTriangleGouraud>    gGpuTrianglesGouraud;
+static std::vector<Gpu::DrawFloorRow>           gGpuFloorRows;
+static std::vector<Gpu::DrawWallCol>            gGpuWallCols;
+static std::vector<Gpu::DrawWallColGouraud>     gGpuWallColsGouraud;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Helpers that generate random primitive attributes
+//------------------------------------------------------------------------------------------------------------------------------------------
+static Gpu::Color24F randomColor(Rng& rng) noexcept {
+    return Gpu::Color24F((uint8_t) rng.range(32, 160), (uint8_t) rng.range(32, 160), (uint8_t) rng.range(32, 160));
+}
+
+static int16_t randomX(Rng& rng) noexcept { return (int16_t) rng.range(-16, DRAW_AREA_W + 15); }
+static int16_t randomY(Rng& rng) noexcept { return (int16_t) rng.range(-16, DRAW_AREA_H + 15); }
+static int16_t randomUV(Rng& rng) noexcept { return (int16_t) rng.range(0, TEX_SIZE - 1); }
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Creates the GPU core, uploads the texture and CLUT and generates all of the primitives to be drawn
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void setupGpuCore() noexcept {
+    if (gbGpuCoreInit)
+        return;
+
+    Gpu::initCore(gGpuCore, Gpu::PS1_VRAM_W, Gpu::PS1_VRAM_H);
+    gbGpuCoreInit = true;
+    Rng rng(0x69D0u);
+
+    // Upload an 8bpp texture (2 texels per VRAM pixel) and a CLUT with no fully transparent colors
+    for (uint16_t y = 0; y < TEX_SIZE; ++y) {
+        for (uint16_t x = 0; x < TEX_SIZE / 2; ++x) {
+            const uint16_t texel1 = (uint16_t)((x * 2 + y) & 0xFF);
+            const uint16_t texel2 = (uint16_t)((x * 2 + 1 + y + rng.range(0, 3)) & 0xFF);
+            Gpu::vramWriteU16(gGpuCore, TEX_VRAM_X + x, y, texel1 | (texel2 << 8));
+        }
+    }
+
+    for (uint16_t i = 0; i < 256; ++i) {
+        const Gpu::Color16 color = Gpu::Color16::make((uint16_t) rng.range(1, 31), (uint16_t) rng.range(1, 31), (uint16_t) rng.range(1, 31));
+        Gpu::vramWriteU16(gGpuCore, CLUT_VRAM_X + i, CLUT_VRAM_Y, color.bits);
+    }
+
+    Gpu::invalidateVramCaches(gGpuCore, 0, Gpu::PS1_VRAM_W - 1, 0, Gpu::PS1_VRAM_H - 1);
+
+    // Setup all of the drawing state explicitly
+    gGpuCore.drawAreaLx = 0;
+    gGpuCore.drawAreaRx = DRAW_AREA_W - 1;
+    gGpuCore.drawAreaTy = 0;
+    gGpuCore.drawAreaBy = DRAW_AREA_H - 1;
+    gGpuCore.drawOffsetX = 0;
+    gGpuCore.drawOffsetY = 0;
+    gGpuCore.texPageX = TEX_VRAM_X;
+    gGpuCore.texPageY = 0;
+    gGpuCore.texPageXMask = 0xFF;
+    gGpuCore.texPageYMask = 0xFF;
+    gGpuCore.texWinX = 0;
+    gGpuCore.texWinY = 0;
+    gGpuCore.texWinXMask = TEX_SIZE - 1;
+    gGpuCore.texWinYMask = TEX_SIZE - 1;
+    gGpuCore.texFmt = Gpu::TexFmt::Bpp8;
+    gGpuCore.clutX = CLUT_VRAM_X;
+    gGpuCore.clutY = CLUT_VRAM_Y;
+    gGpuCore.blendMode = Gpu::BlendMode::Alpha50;
+
+    // Generate the primitives: sizes are similar to what the game draws (mostly small, some large)
+    for (uint32_t i = 0; i < NUM_PRIMS; ++i) {
+        Gpu::DrawRect& rect = gGpuRects.emplace_back();
+        rect.x = randomX(rng);
+        rect.y = randomY(rng);
+        rect.w = (uint16_t) rng.range(8, 64);
+        rect.h = (uint16_t) rng.range(8, 64);
+        rect.u = (uint16_t) rng.range(0, TEX_SIZE - 64);
+        rect.v = (uint16_t) rng.range(0, TEX_SIZE - 64);
+        rect.color = randomColor(rng);
+
+        Gpu::DrawLine& line = gGpuLines.emplace_back();
+        line.x1 = randomX(rng);
+        line.y1 = randomY(rng);
+        line.x2 = randomX(rng);
+        line.y2 = randomY(rng);
+        line.color = randomColor(rng);
+
+        const int16_t triX = randomX(rng);
+        const int16_t triY = randomY(rng);
+        const int16_t triSize = (int16_t) rng.range(8, 96);
+
+        Gpu::DrawTriangle& triangle = gGpuTriangles.emplace_back();
+        triangle.x1 = triX;
+        triangle.y1 = triY;
+        triangle.x2 = (int16_t)(triX + rng.range(-triSize, triSize));
+        triangle.y2 = (int16_t)(triY + rng.range(0, triSize));
+        triangle.x3 = (int16_t)(triX + rng.range(-triSize, triSize));
+        triangle.y3 = (int16_t)(triY + rng.range(0, triSize));
+        triangle.u1 = randomUV(rng);
+        triangle.v1 = randomUV(rng);
+        triangle.u2 = randomUV(rng);
+        triangle.v2 = randomUV(rng);
+        triangle.u3 = randomUV(rng);
+        triangle.v3 = randomUV(rng);
+        triangle.color = randomColor(rng);
+
+        Gpu::DrawTriangleGouraud& triangleGouraud = gGpuTrianglesGouraud.emplace_back();
+        triangleGouraud.x1 = triangle.x1;
+        triangleGouraud.y1 = triangle.y1;
+        triangleGouraud.u1 = triangle.u1;
+        triangleGouraud.v1 = triangle.v1;
+        triangleGouraud.x2 = triangle.x2;
+        triangleGouraud.y2 = triangle.y2;
+        triangleGouraud.u2 = triangle.u2;
+        triangleGouraud.v2 = triangle.v2;
+        triangleGouraud.x3 = triangle.x3;
+        triangleGouraud.y3 = triangle.y3;
+        triangleGouraud.u3 = triangle.u3;
+        triangleGouraud.v3 = triangle.v3;
+        triangleGouraud.color1 = randomColor(rng);
+        triangleGouraud.color2 = randomColor(rng);
+        triangleGouraud.color3 = randomColor(rng);
+
+        Gpu::DrawFloorRow& floorRow = gGpuFloorRows.emplace_back();
+        floorRow.y = (int16_t) rng.range(0, DRAW_AREA_H - 1);
+        floorRow.x1 = (int16_t) rng.range(0, DRAW_AREA_W / 2);
+        floorRow.x2 = (int16_t)(floorRow.x1 + rng.range(16, DRAW_AREA_W / 2));
+        floorRow.u1 = randomUV(rng);
+        floorRow.v1 = randomUV(rng);
+        floorRow.u2 = (int16_t)(floorRow.u1 + rng.range(-256, 256));
+        floorRow.v2 = (int16_t)(floorRow.v1 + rng.range(-256, 256));
+        floorRow.color = randomColor(rng);
+
+        Gpu::DrawWallCol& wallCol = gGpuWallCols.emplace_back();
+        wallCol.x = (int16_t) rng.range(0, DRAW_AREA_W - 1);
+        wallCol.u = randomUV(rng);
+        wallCol.y1 = (int16_t) rng.range(-32, DRAW_AREA_H / 2);
+        wallCol.y2 = (int16_t)(wallCol.y1 + rng.range(8, DRAW_AREA_H));
+        wallCol.v1 = 0;
+        wallCol.v2 = (int16_t) rng.range(16, 256);
+        wallCol.color = randomColor(rng);
+
+        Gpu::DrawWallColGouraud& wallColGouraud = gGpuWallColsGouraud.emplace_back();
+        wallColGouraud.x = wallCol.x;
+        wallColGouraud.u = wallCol.u;
+        wallColGouraud.y1 = wallCol.y1;
+        wallColGouraud.y2 = wallCol.y2;
+        wallColGouraud.v1 = wallCol.v1;
+        wallColGouraud.v2 = wallCol.v2;
+        wallColGouraud.color1 = randomColor(rng);
+        wallColGouraud.color2 = randomColor(rng);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Clears the draw area before a benchmark, so that its checksum does not depend on which other benchmarks ran before it
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void setupGpuDraws() noexcept {
+    setupGpuCore();
+    Gpu::clearRect(gGpuCore, Gpu::Color16(0), 0, 0, DRAW_AREA_W, DRAW_AREA_H);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Draws all the primitives in the given list with the specified draw mode and checksums a sparse sampling of the draw area
+//------------------------------------------------------------------------------------------------------------------------------------------
+template <Gpu::DrawMode DrawMode, class Prim>
+static uint64_t runGpuDraws(const std::vector<Prim>& prims) noexcept {
+    for (const Prim& prim : prims) {
+        Gpu::draw<DrawMode>(gGpuCore, prim);
+    }
+
+    uint64_t checksum = 0;
+
+    for (uint16_t y = 0; y < DRAW_AREA_H; y += 7) {
+        for (uint16_t x = 0; x < DRAW_AREA_W; x += 5) {
+            checksum = mixChecksum(checksum, Gpu::vramReadU16(gGpuCore, x, y));
+        }
+    }
+
+    return checksum;
+}
+
+static uint64_t runGpuRects() noexcept              { return runGpuDraws<Gpu::DrawMode::Textured>(gGpuRects);               }
+static uint64_t runGpuLines() noexcept              { return runGpuDraws<Gpu::DrawMode::Colored>(gGpuLines);                }
+static uint64_t runGpuTriangles() noexcept          { return runGpuDraws<Gpu::DrawMode::Textured>(gGpuTriangles);           }
+static uint64_t runGpuTrianglesGouraud() noexcept   { return runGpuDraws<Gpu::DrawMode::Textured>(gGpuTrianglesGouraud);    }
+static uint64_t runGpuFloorRows() noexcept          { return runGpuDraws<Gpu::DrawMode::Textured>(gGpuFloorRows);           }
+static uint64_t runGpuWallCols() noexcept           { return runGpuDraws<Gpu::DrawMode::Textured>(gGpuWallCols);            }
+static uint64_t runGpuWallColsGouraud() noexcept    { return runGpuDraws<Gpu::DrawMode::Textured>(gGpuWallColsGouraud);     }
+
+void addBenchmarks_Gpu(std::vector<Benchmark>& benchmarks) noexcept {
+    benchmarks.push_back({ "Gpu::draw DrawRect (textured)", setupGpuDraws, runGpuRects, NUM_PRIMS });
+    benchmarks.push_back({ "Gpu::draw DrawLine (colored)", setupGpuDraws, runGpuLines, NUM_PRIMS });
+    benchmarks.push_back({ "Gpu::draw DrawTriangle (textured)", setupGpuDraws, runGpuTriangles, NUM_PRIMS });
+    benchmarks.push_back({ "Gpu::draw DrawTriangleGouraud (textured)", setupGpuDraws, runGpuTrianglesGouraud, NUM_PRIMS });
+    benchmarks.push_back({ "Gpu::draw DrawFloorRow (textured)", setupGpuDraws, runGpuFloorRows, NUM_PRIMS });
+    benchmarks.push_back({ "Gpu::draw DrawWallCol (textured)", setupGpuDraws, runGpuWallCols, NUM_PRIMS });
+    benchmarks.push_back({ "Gpu::draw DrawWallColGouraud (textured)", setupGpuDraws, runGpuWallColsGouraud, NUM_PRIMS });
+}
+
+END_NAMESPACE(Bench)
@@ -0,0 +1,86 @@
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Benchmarks for the Vulkan renderer's horizontal occlusion tracking ('rv_occlusion.cpp').
+// Simulates what BSP traversal does each frame: many visibility checks for subsectors and walls, interleaved with walls occluding
+// parts of the screen as they are drawn from front to back. Both the sorted range list and the coverage buffer modes are benchmarked.
+//------------------------------------------------------------------------------------------------------------------------------------------
+#include "Bench.h"
+
+#if PSYDOOM_VULKAN_RENDERER
+
+#include "Doom/RendererVk/rv_occlusion.h"
+#include "PsyDoom/Config/Config.h"
+#include "PsyDoom/Vulkan/VFrameArena.h"
+
+BEGIN_NAMESPACE(Bench)
+
+// How many simulated frames are done per run and how many occlusion queries/updates are done per frame
+static constexpr uint32_t NUM_OCC_FRAMES = 16;
+static constexpr uint32_t NUM_OCC_OPS_PER_FRAME = 512;
+
+// An occlusion operation: either check whether a range is visible or mark it as occluded
+struct OccOp {
+    float   xMin;
+    float   xMax;
+    bool    bOcclude;
+};
+
+static std::vector<OccOp> gOccOps;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Generates the operations for all frames: ranges are in normalized device coordinates and some extend offscreen
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void setupOccOps() noexcept {
+    if (!gOccOps.empty())
+        return;
+
+    Rng rng(0x0CC1u);
+
+    for (uint32_t i = 0; i < NUM_OCC_FRAMES * NUM_OCC_OPS_PER_FRAME; ++i) {
+        OccOp& op = gOccOps.emplace_back();
+        op.bOcclude = (rng.range(0, 9) < 4);
+
+        const float width = (float) rng.range(1, (op.bOcclude) ? 150 : 300) * 0.001f;
+        op.xMin = (float) rng.range(-1100, 1100) * 0.001f;
+        op.xMax = op.xMin + width;
+    }
+}
+
+static void setupOccRangeList() noexcept {
+    setupOccOps();
+    Config::gbVulkanOcclusionCoverageBuffer = false;
+}
+
+static void setupOccCoverageBuffer() noexcept {
+    setupOccOps();
+    Config::gbVulkanOcclusionCoverageBuffer = true;
+}
+
+static uint64_t runOcclusion() noexcept {
+    uint64_t checksum = 0;
+    const OccOp* pOp = gOccOps.data();
+
+    for (uint32_t frameIdx = 0; frameIdx < NUM_OCC_FRAMES; ++frameIdx) {
+        VFrameArena::reset();
+        RV_ClearOcclussion();
+
+        for (uint32_t opIdx = 0; opIdx < NUM_OCC_OPS_PER_FRAME; ++opIdx, ++pOp) {
+            if (pOp->bOcclude) {
+                RV_OccludeRange(pOp->xMin, pOp->xMax);
+            } else {
+                checksum = mixChecksum(checksum, RV_IsRangeVisible(pOp->xMin, pOp->xMax));
+            }
+        }
+    }
+
+    return checksum;
+}
+
+void addBenchmarks_Occlusion(std::vector<Benchmark>& benchmarks) noexcept {
+    constexpr uint32_t NUM_OPS = NUM_OCC_FRAMES * NUM_OCC_OPS_PER_FRAME;
+    benchmarks.push_back({ "RV_OccludeRange/RV_IsRangeVisible (list)", setupOccRangeList, runOcclusion, NUM_OPS });
+    benchmarks.push_back({ "RV_OccludeRange/RV_IsRangeVisible (coverage)", setupOccCoverageBuffer, runOcclusion, NUM_OPS });
+}
+
+END_NAMESPACE(Bench)
+
+#endif  // #if PSYDOOM_VULKAN_RENDERER
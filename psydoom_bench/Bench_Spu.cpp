@@ -0,0 +1,166 @@
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Benchmarks for the SPU emulation in the 'SimpleSpu' library: mixing many looping ADPCM voices at once
+//------------------------------------------------------------------------------------------------------------------------------------------
+#include "Bench.h"
+
+#include "Spu.h"
+
+#include <algorithm>
+#include <cmath>
+
+BEGIN_NAMESPACE(Bench)
+
+// Settings for the benchmark: how many voices are playing, how many looping sounds there are and how long they are
+static constexpr uint32_t NUM_VOICES = 24;
+static constexpr uint32_t NUM_SOUNDS = 8;
+static constexpr uint32_t NUM_BLOCKS_PER_SOUND = 64;
+static constexpr uint32_t SPU_RAM_SIZE = 512 * 1024;
+
+// How many samples are mixed per run: 1/10 of a second of audio
+static constexpr uint32_t NUM_SAMPLES_PER_RUN = 4410;
+
+static Spu::Core                        gSpuCore;
+static bool                             gbSpuCoreInit;
+static std::vector<Spu::StereoSample>   gSpuOutput;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Writes a looping sound to SPU RAM at the given block index, encoding a waveform as ADPCM blocks with a spread of filters and shifts
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void writeLoopingSound(const uint32_t startBlockIdx, const float frequency, Rng& rng) noexcept {
+    std::byte* const pSoundBlocks = gSpuCore.pRam + startBlockIdx * Spu::ADPCM_BLOCK_SIZE;
+
+    for (uint32_t blockIdx = 0; blockIdx < NUM_BLOCKS_PER_SOUND; ++blockIdx) {
+        std::byte* const pBlock = pSoundBlocks + blockIdx * Spu::ADPCM_BLOCK_SIZE;
+
+        // Header: shift and filter followed by the loop flags
+        const uint8_t shift = (uint8_t) rng.range(0, 12);
+        const uint8_t filter = (uint8_t) rng.range(0, 4);
+        uint8_t flags = 0;
+
+        if (blockIdx == 0) {
+            flags |= Spu::ADPCM_FLAG_LOOP_START;
+        }
+
+        if (blockIdx + 1 == NUM_BLOCKS_PER_SOUND) {
+            flags |= Spu::ADPCM_FLAG_LOOP_END | Spu::ADPCM_FLAG_REPEAT;
+        }
+
+        pBlock[0] = (std::byte)(shift | (filter << 4));
+        pBlock[1] = (std::byte) flags;
+
+        // Pack 28 4-bit samples of the waveform, plus a little noise
+        for (uint32_t byteIdx = 0; byteIdx < 14; ++byteIdx) {
+            uint8_t sampleBits = 0;
+
+            for (uint32_t nibbleIdx = 0; nibbleIdx < 2; ++nibbleIdx) {
+                const uint32_t sampleIdx = blockIdx * Spu::ADPCM_BLOCK_NUM_SAMPLES + byteIdx * 2 + nibbleIdx;
+                const float wave = std::sin((float) sampleIdx * frequency);
+                const int32_t nibble = std::clamp((int32_t)(wave * 7.0f) + rng.range(-1, 1), -8, 7);
+                sampleBits |= (uint8_t)((nibble & 0xF) << (nibbleIdx * 4));
+            }
+
+            pBlock[2 + byteIdx] = (std::byte) sampleBits;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Creates the SPU core and fills SPU RAM with the sounds to be played
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void setupSpuCore() noexcept {
+    if (gbSpuCoreInit) {
+        Spu::destroyCore(gSpuCore);
+    }
+
+    Spu::initCore(gSpuCore, SPU_RAM_SIZE, NUM_VOICES);
+    gbSpuCoreInit = true;
+    gSpuCore.masterVol = { Spu::MAX_MASTER_VOLUME, Spu::MAX_MASTER_VOLUME };
+    gSpuCore.bUnmute = true;
+
+    Rng rng(0x5E0Du);
+
+    for (uint32_t soundIdx = 0; soundIdx < NUM_SOUNDS; ++soundIdx) {
+        writeLoopingSound(soundIdx * NUM_BLOCKS_PER_SOUND, 0.01f + (float) soundIdx * 0.013f, rng);
+    }
+
+    // Setup the voices: each plays one of the sounds with a different pitch, volume and envelope
+    for (uint32_t voiceIdx = 0; voiceIdx < NUM_VOICES; ++voiceIdx) {
+        Spu::Voice& voice = gSpuCore.pVoices[voiceIdx];
+        voice.adpcmStartAddr8 = (voiceIdx % NUM_SOUNDS) * NUM_BLOCKS_PER_SOUND * (Spu::ADPCM_BLOCK_SIZE / 8);
+        voice.sampleRate = (uint16_t) rng.range(0x400, 0x2000);
+        voice.volume = { (int16_t) rng.range(0x1000, 0x3FFF), (int16_t) rng.range(0x1000, 0x3FFF) };
+        voice.env.sustainLevel = (uint32_t) rng.range(4, 15);
+        voice.env.decayShift = (uint32_t) rng.range(0, 15);
+        voice.env.attackShift = (uint32_t) rng.range(0, 12);
+        voice.env.bAttackExp = (uint32_t) rng.range(0, 1);
+        voice.env.sustainShift = 31;
+        voice.env.releaseShift = (uint32_t) rng.range(0, 20);
+        voice.env.bReleaseExp = (uint32_t) rng.range(0, 1);
+    }
+
+    gSpuOutput.resize(NUM_SAMPLES_PER_RUN);
+}
+
+static void setupSpuCoreWithCache() noexcept {
+    setupSpuCore();
+    Spu::initAdpcmCache(gSpuCore, 512);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Restarts all voices so that each run mixes exactly the same audio
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void restartSpuVoices() noexcept {
+    gSpuCore.cycleCount = 0;
+    gSpuCore.reverbCurAddr = 0;
+    gSpuCore.processedReverb = {};
+
+    for (uint32_t voiceIdx = 0; voiceIdx < NUM_VOICES; ++voiceIdx) {
+        Spu::keyOn(gSpuCore.pVoices[voiceIdx]);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Mixes a sample into a checksum
+//------------------------------------------------------------------------------------------------------------------------------------------
+static uint64_t mixSampleChecksum(const uint64_t checksum, const Spu::StereoSample sample) noexcept {
+    #if SIMPLE_SPU_FLOAT_SPU
+        const int16_t left = Spu::toInt16Sample(sample.left);
+        const int16_t right = Spu::toInt16Sample(sample.right);
+    #else
+        const int16_t left = sample.left;
+        const int16_t right = sample.right;
+    #endif
+
+    return checksum + (uint16_t) left + ((uint64_t)(uint16_t) right << 16);
+}
+
+static uint64_t runSpuStepCore() noexcept {
+    restartSpuVoices();
+    uint64_t checksum = 0;
+
+    for (uint32_t i = 0; i < NUM_SAMPLES_PER_RUN; ++i) {
+        checksum = mixSampleChecksum(checksum, Spu::stepCore(gSpuCore));
+    }
+
+    return checksum;
+}
+
+static uint64_t runSpuStepCoreBlock() noexcept {
+    restartSpuVoices();
+    Spu::stepCoreBlock(gSpuCore, gSpuOutput.data(), NUM_SAMPLES_PER_RUN);
+    uint64_t checksum = 0;
+
+    for (const Spu::StereoSample sample : gSpuOutput) {
+        checksum = mixSampleChecksum(checksum, sample);
+    }
+
+    return checksum;
+}
+
+void addBenchmarks_Spu(std::vector<Benchmark>& benchmarks) noexcept {
+    benchmarks.push_back({ "Spu::stepCore (24 voices, per sample)", setupSpuCore, runSpuStepCore, NUM_SAMPLES_PER_RUN });
+    benchmarks.push_back({ "Spu::stepCoreBlock (24 voices, per sample)", setupSpuCore, runSpuStepCoreBlock, NUM_SAMPLES_PER_RUN });
+    benchmarks.push_back({ "Spu::stepCoreBlock (ADPCM cache, per sample)", setupSpuCoreWithCache, runSpuStepCoreBlock, NUM_SAMPLES_PER_RUN });
+}
+
+END_NAMESPACE(Bench)
@@ -0,0 +1,351 @@
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Benchmarks for WAD handling: LZSS lump decompression and finding lumps by name.
+//
+// Note: 'WadFile::findLumpIdx' simply forwards to 'LumpNameIndex::find', so the lump name index is benchmarked directly.
+// This avoids the need to open a real WAD file.
+//------------------------------------------------------------------------------------------------------------------------------------------
+#include "Bench.h"
+
+#include "PsyDoom/LumpNameIndex.h"
+#include "PsyDoom/WadUtils.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+BEGIN_NAMESPACE(Bench)
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// LZSS decompression
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+// Limits of the compression format: 12-bits of offset and 4-bits of length, with a length of '1' marking the end of the stream
+static constexpr uint32_t LZSS_MAX_OFFSET = 4096;
+static constexpr uint32_t LZSS_MIN_MATCH = 3;
+static constexpr uint32_t LZSS_MAX_MATCH = 16;
+static constexpr uint32_t LZSS_HASH_SIZE = 4096;
+static constexpr uint32_t LZSS_MAX_CHAIN = 64;
+
+// How many records of each type of map data are generated and the total uncompressed size of all the data
+static constexpr int32_t NUM_VERTEXES = 4000;
+static constexpr int32_t NUM_LINEDEFS = 5000;
+static constexpr int32_t NUM_SIDEDEFS = 4000;
+static constexpr uint32_t LZSS_TOTAL_UNCOMPRESSED_SIZE = NUM_VERTEXES * 8 + NUM_LINEDEFS * 14 + NUM_SIDEDEFS * 30;
+
+// A compressed lump to be decompressed and the uncompressed size of it
+struct CompressedLump {
+    std::vector<uint8_t>    data;
+    uint32_t                uncompressedSize;
+};
+
+static std::vector<CompressedLump>  gCompressedLumps;
+static std::vector<uint8_t>         gDecompressBuffer;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Compresses data into the LZSS format used by PlayStation Doom WADs, using a greedy longest match search.
+// The compression ratio is similar to the original tools, which is all that matters for benchmarking decompression.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static std::vector<uint8_t> compressLzss(const std::vector<uint8_t>& input) noexcept {
+    std::vector<uint8_t> output;
+    size_t idBytePos = 0;
+    uint32_t numItemsForIdByte = 8;
+
+    const auto beginItem = [&](const bool bCompressed) noexcept {
+        if (numItemsForIdByte >= 8) {
+            idBytePos = output.size();
+            output.push_back(0);
+            numItemsForIdByte = 0;
+        }
+
+        if (bCompressed) {
+            output[idBytePos] |= (uint8_t)(1u << numItemsForIdByte);
+        }
+
+        ++numItemsForIdByte;
+    };
+
+    // Hash chains to speed up match searches: the most recent position for each hash and the previous position with the same hash
+    std::vector<int32_t> hashHeads(LZSS_HASH_SIZE, -1);
+    std::vector<int32_t> prevPositions(input.size(), -1);
+
+    const auto getHash = [&](const size_t pos) noexcept {
+        return ((uint32_t) input[pos] * 251u + (uint32_t) input[pos + 1] * 17u + input[pos + 2]) & (LZSS_HASH_SIZE - 1);
+    };
+
+    const auto addToHashChain = [&](const size_t pos) noexcept {
+        if (pos + LZSS_MIN_MATCH <= input.size()) {
+            const uint32_t hash = getHash(pos);
+            prevPositions[pos] = hashHeads[hash];
+            hashHeads[hash] = (int32_t) pos;
+        }
+    };
+
+    size_t pos = 0;
+
+    while (pos < input.size()) {
+        // Find the longest match within the window
+        uint32_t bestLen = 0;
+        uint32_t bestOffset = 0;
+
+        if (pos + LZSS_MIN_MATCH <= input.size()) {
+            const uint32_t maxLen = (uint32_t) std::min<size_t>(LZSS_MAX_MATCH, input.size() - pos);
+            int32_t matchPos = hashHeads[getHash(pos)];
+
+            for (uint32_t chainLen = 0; (matchPos >= 0) && (chainLen < LZSS_MAX_CHAIN); ++chainLen, matchPos = prevPositions[matchPos]) {
+                const uint32_t offset = (uint32_t)(pos - (size_t) matchPos);
+
+                if (offset > LZSS_MAX_OFFSET)
+                    break;
+
+                uint32_t len = 0;
+
+                while ((len < maxLen) && (input[matchPos + len] == input[pos + len])) {
+                    ++len;
+                }
+
+                if (len > bestLen) {
+                    bestLen = len;
+                    bestOffset = offset;
+                }
+            }
+        }
+
+        // Output either a match or a literal byte
+        if (bestLen >= LZSS_MIN_MATCH) {
+            beginItem(true);
+            output.push_back((uint8_t)((bestOffset - 1) >> 4));
+            output.push_back((uint8_t)((((bestOffset - 1) & 0xF) << 4) | (bestLen - 1)));
+
+            for (uint32_t i = 0; i < bestLen; ++i) {
+                addToHashChain(pos + i);
+            }
+
+            pos += bestLen;
+        } else {
+            beginItem(false);
+            output.push_back(input[pos]);
+            addToHashChain(pos);
+            ++pos;
+        }
+    }
+
+    // End of stream marker: a match with a length of '1'
+    beginItem(true);
+    output.push_back(0);
+    output.push_back(0);
+    return output;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Generates lumps with the kind of data found in maps and compresses them: vertices, line definitions and side definitions.
+// The data follows the same sort of patterns as real map data (small deltas between records, repeated texture names and so on).
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void setupCompressedLumps() noexcept {
+    if (!gCompressedLumps.empty())
+        return;
+
+    Rng rng(0x1255u);
+
+    const auto addInt16 = [](std::vector<uint8_t>& data, const int32_t value) noexcept {
+        data.push_back((uint8_t) value);
+        data.push_back((uint8_t)(value >> 8));
+    };
+
+    // Vertices: a random walk around a grid, with coordinates in fixed point format
+    std::vector<uint8_t> vertexes;
+    int32_t vertX = 0;
+    int32_t vertY = 0;
+
+    for (int32_t i = 0; i < NUM_VERTEXES; ++i) {
+        vertX += rng.range(-8, 8) * 16;
+        vertY += rng.range(-8, 8) * 16;
+        addInt16(vertexes, 0);
+        addInt16(vertexes, vertX);
+        addInt16(vertexes, 0);
+        addInt16(vertexes, vertY);
+    }
+
+    // Line definitions: mostly sequential vertices with a small set of flags and few specials or tags
+    std::vector<uint8_t> linedefs;
+
+    for (int32_t i = 0; i < NUM_LINEDEFS; ++i) {
+        const bool bSpecial = (rng.range(0, 15) == 0);
+        addInt16(linedefs, std::min(i, NUM_VERTEXES - 1));
+        addInt16(linedefs, std::min(i + rng.range(1, 3), NUM_VERTEXES - 1));
+        addInt16(linedefs, (rng.range(0, 3) == 0) ? 0x4 : 0x1);
+        addInt16(linedefs, (bSpecial) ? rng.range(1, 140) : 0);
+        addInt16(linedefs, (bSpecial) ? rng.range(1, 40) : 0);
+        addInt16(linedefs, i * 2);
+        addInt16(linedefs, (rng.range(0, 2) == 0) ? i * 2 + 1 : -1);
+    }
+
+    // Side definitions: offsets, texture names from a small set of textures and the sector index
+    static constexpr const char* TEXTURE_NAMES[] = {
+        "-", "BROWN01", "BROWN12", "STARTAN1", "STARG1", "SUPPORT1", "DOORTRAK", "COMPWALL", "TEKWALL1", "MARBLE1", "GRAY1", "SKIN1"
+    };
+
+    constexpr int32_t NUM_TEXTURE_NAMES = (int32_t)(sizeof(TEXTURE_NAMES) / sizeof(TEXTURE_NAMES[0]));
+    std::vector<uint8_t> sidedefs;
+
+    for (int32_t i = 0; i < NUM_SIDEDEFS; ++i) {
+        addInt16(sidedefs, (rng.range(0, 7) == 0) ? rng.range(0, 127) : 0);
+        addInt16(sidedefs, (rng.range(0, 7) == 0) ? rng.range(0, 127) : 0);
+
+        for (int32_t texIdx = 0; texIdx < 3; ++texIdx) {
+            const char* const name = TEXTURE_NAMES[rng.range(0, NUM_TEXTURE_NAMES - 1)];
+            const size_t nameLen = std::strlen(name);
+            sidedefs.insert(sidedefs.end(), name, name + nameLen);
+            sidedefs.insert(sidedefs.end(), 8 - nameLen, 0);
+        }
+
+        addInt16(sidedefs, i / 12);
+    }
+
+    // Compress all of the lumps
+    for (const std::vector<uint8_t>* const pLumpData : { &vertexes, &linedefs, &sidedefs }) {
+        CompressedLump& lump = gCompressedLumps.emplace_back();
+        lump.data = compressLzss(*pLumpData);
+        lump.uncompressedSize = (uint32_t) pLumpData->size();
+
+        // Sanity check the compressed data round trips
+        std::vector<uint8_t> decompressed(lump.uncompressedSize);
+        WadUtils::decompressLump(lump.data.data(), decompressed.data());
+
+        if (decompressed != *pLumpData) {
+            std::printf("LZSS benchmark: compressed data does not decompress correctly!\n");
+        }
+    }
+
+    gDecompressBuffer.resize(LZSS_TOTAL_UNCOMPRESSED_SIZE);
+}
+
+static uint64_t runDecompressLump() noexcept {
+    uint8_t* pDst = gDecompressBuffer.data();
+    uint64_t checksum = 0;
+
+    for (const CompressedLump& lump : gCompressedLumps) {
+        WadUtils::decompressLump(lump.data.data(), pDst);
+        checksum = mixChecksum(checksum, pDst[lump.uncompressedSize - 1]);
+        checksum = mixChecksum(checksum, pDst[lump.uncompressedSize / 2]);
+        pDst += lump.uncompressedSize;
+    }
+
+    return checksum;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Finding lumps by name
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+// How many lump name searches to do per run
+static constexpr uint32_t NUM_LUMP_SEARCHES = 8192;
+
+// A search for a lump name starting at a particular lump index
+struct LumpSearch {
+    String8     name;
+    int32_t     searchStartIdx;
+};
+
+static std::vector<String8>     gLumpNames;
+static LumpNameIndex            gLumpNameIndex;
+static std::vector<LumpSearch>  gLumpSearches;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Generates a list of lump names laid out like the main game WAD combined with a WAD containing many maps.
+// Generates a fixed list of searches also: mostly for names that exist, some for map lumps after a map marker and some for missing names.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void setupLumpNames() noexcept {
+    if (!gLumpNames.empty())
+        return;
+
+    const auto addName = [](const char* const name) noexcept {
+        gLumpNames.emplace_back(name);
+    };
+
+    char name[16];
+    addName("S_START");
+
+    for (int32_t spriteIdx = 0; spriteIdx < 120; ++spriteIdx) {
+        for (char frame = 'A'; frame <= 'H'; ++frame) {
+            for (int32_t rotation = 1; rotation <= 5; ++rotation) {
+                std::snprintf(name, sizeof(name), "S%03d%c%d", spriteIdx, frame, rotation);
+                addName(name);
+            }
+        }
+    }
+
+    addName("S_END");
+    addName("T_START");
+
+    for (int32_t texIdx = 0; texIdx < 400; ++texIdx) {
+        std::snprintf(name, sizeof(name), "TEX%04d", texIdx);
+        addName(name);
+    }
+
+    addName("T_END");
+    addName("F_START");
+
+    for (int32_t flatIdx = 0; flatIdx < 120; ++flatIdx) {
+        std::snprintf(name, sizeof(name), "FLAT%03d", flatIdx);
+        addName(name);
+    }
+
+    addName("F_END");
+
+    // Maps: all with the same set of lump names following the map marker.
+    // Remember where each map marker is so that map lump searches can start there.
+    static constexpr const char* MAP_LUMP_NAMES[] = {
+        "THINGS", "LINEDEFS", "SIDEDEFS", "VERTEXES", "SEGS", "SSECTORS", "NODES", "SECTORS", "REJECT", "BLOCKMAP", "LEAFS"
+    };
+
+    std::vector<int32_t> mapMarkerIndexes;
+
+    for (int32_t mapNum = 1; mapNum <= 60; ++mapNum) {
+        std::snprintf(name, sizeof(name), "MAP%02d", mapNum);
+        mapMarkerIndexes.push_back((int32_t) gLumpNames.size());
+        addName(name);
+
+        for (const char* const mapLumpName : MAP_LUMP_NAMES) {
+            addName(mapLumpName);
+        }
+    }
+
+    gLumpNameIndex.build(gLumpNames.data(), (int32_t) gLumpNames.size());
+
+    // Generate the searches
+    Rng rng(0x7A11u);
+
+    for (uint32_t i = 0; i < NUM_LUMP_SEARCHES; ++i) {
+        LumpSearch& search = gLumpSearches.emplace_back();
+        const int32_t searchType = rng.range(0, 9);
+
+        if (searchType < 8) {
+            search.name = gLumpNames[rng.range(0, (int32_t) gLumpNames.size() - 1)];
+            search.searchStartIdx = 0;
+        } else if (searchType == 8) {
+            search.name = MAP_LUMP_NAMES[rng.range(0, 10)];
+            search.searchStartIdx = mapMarkerIndexes[rng.range(0, (int32_t) mapMarkerIndexes.size() - 1)];
+        } else {
+            std::snprintf(name, sizeof(name), "MISS%04d", rng.range(0, 9999));
+            search.name = name;
+            search.searchStartIdx = 0;
+        }
+    }
+}
+
+static uint64_t runFindLump() noexcept {
+    uint64_t checksum = 0;
+
+    for (const LumpSearch& search : gLumpSearches) {
+        checksum += (uint32_t) gLumpNameIndex.find(search.name, search.searchStartIdx);
+    }
+
+    return checksum;
+}
+
+void addBenchmarks_Wad(std::vector<Benchmark>& benchmarks) noexcept {
+    benchmarks.push_back({ "WadUtils::decompressLump (LZSS, per byte)", setupCompressedLumps, runDecompressLump, LZSS_TOTAL_UNCOMPRESSED_SIZE });
+    benchmarks.push_back({ "WadFile::findLumpIdx (LumpNameIndex)", setupLumpNames, runFindLump, NUM_LUMP_SEARCHES });
+}
+
+END_NAMESPACE(Bench)
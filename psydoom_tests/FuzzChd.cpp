@@ -0,0 +1,135 @@
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Fuzzing entry point for the CHD decompressors: feeds arbitrary input to one of the decoders, as chosen by the first byte of the input.
+// Used both by the 'PsyDoomFuzzChd' libFuzzer target and by the test suite, which runs it on randomly corrupted copies of the test data.
+//
+// Input format:
+//  Byte 0          Which decoder to use: '0' = DEFLATE, '1' = LZMA, '2' = FLAC, '3' = CHD CD image (the value is used modulo 4)
+//  Bytes 1-2       Big endian output size in bytes (DEFLATE and LZMA) or in stereo samples (FLAC); unused for CHD CD images
+//  Bytes 3+        The data to decode
+//
+// Invalid data is expected and must simply be rejected. The only failures reported are writing outside of the output buffer, or reading
+// back different data for the same part of a CD image. Out of bounds reads are caught by building with a sanitizer.
+//------------------------------------------------------------------------------------------------------------------------------------------
+#include "FuzzChd.h"
+
+#include "PsyDoom/Chd/ChdCdImage.h"
+#include "PsyDoom/Chd/FlacDecoder.h"
+#include "PsyDoom/Chd/Inflate.h"
+#include "PsyDoom/Chd/LzmaDecoder.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+BEGIN_NAMESPACE(FuzzChd)
+
+// How many bytes after the output buffer must be left untouched by the decoders, and the value they are filled with
+static constexpr size_t NUM_GUARD_BYTES = 64;
+static constexpr uint8_t GUARD_BYTE = 0xCD;
+
+// The most data that is read from a CD image: limits the time spent on inputs that claim to be huge images
+static constexpr size_t MAX_CD_IMAGE_READ_SIZE = 1024 * 1024;
+
+// Used to give each temporary CHD file a unique name.
+// CHD file layouts are cached by path and header, so reusing a name could cause a layout for a different input to be used.
+static std::atomic<uint32_t> gNextTempFileIdx;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Checks that none of the guard bytes after the output of a decoder have been overwritten
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool checkGuardBytes(const std::vector<std::byte>& buffer, const size_t outputSize) noexcept {
+    return std::all_of(buffer.begin() + outputSize, buffer.end(), [](const std::byte b) noexcept { return (b == (std::byte) GUARD_BYTE); });
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Writes the given data to a temporary CHD file, then opens it as a CD image and reads it back.
+// Returns 'false' if reading the same part of the image twice gives different results.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool fuzzChdCdImage(const std::byte* const pData, const size_t size) noexcept {
+    std::error_code errorCode;
+    const std::filesystem::path tempDir = std::filesystem::temp_directory_path(errorCode);
+
+    if (errorCode)
+        return true;
+
+    const std::string tempFilePath = (tempDir / ("PsyDoomFuzzChd_" + std::to_string(gNextTempFileIdx++) + ".chd")).string();
+    std::FILE* const pFile = std::fopen(tempFilePath.c_str(), "wb");
+
+    if (!pFile)
+        return true;
+
+    const bool bWroteFile = (std::fwrite(pData, 1, size, pFile) == size);
+    std::fclose(pFile);
+    bool bResultOk = true;
+
+    if (bWroteFile) {
+        chd::ChdCdImage image;
+        std::string errorMsg;
+
+        if (image.open(tempFilePath.c_str(), errorMsg)) {
+            // Read the start of the image sequentially, then read it again in the opposite order: the results must match
+            const size_t readSize = (size_t) std::min<int64_t>(image.getSize(), MAX_CD_IMAGE_READ_SIZE);
+            std::vector<std::byte> firstRead(readSize);
+            std::vector<std::byte> secondRead(readSize);
+            const size_t firstReadSize = image.read(firstRead.data(), readSize);
+
+            for (size_t sectorOffset = (readSize / chd::ChdCdImage::SECTOR_SIZE) * chd::ChdCdImage::SECTOR_SIZE;; sectorOffset -= chd::ChdCdImage::SECTOR_SIZE) {
+                if (image.seek((int64_t) sectorOffset)) {
+                    const size_t sectorReadSize = std::min<size_t>(chd::ChdCdImage::SECTOR_SIZE, readSize - sectorOffset);
+                    const size_t sectorBytesRead = image.read(secondRead.data() + sectorOffset, sectorReadSize);
+
+                    // Only compare sectors that were fully read both times: bad hunks fail to read
+                    if ((sectorOffset + sectorBytesRead <= firstReadSize) && (sectorBytesRead == sectorReadSize)) {
+                        bResultOk &= (std::memcmp(firstRead.data() + sectorOffset, secondRead.data() + sectorOffset, sectorBytesRead) == 0);
+                    }
+                }
+
+                if (sectorOffset == 0)
+                    break;
+            }
+        }
+    }
+
+    std::filesystem::remove(tempFilePath, errorCode);
+    return bResultOk;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Runs the given fuzzing input: returns 'false' if a decoder misbehaved
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool run(const uint8_t* const pData, const size_t size) noexcept {
+    if (size < 3)
+        return true;
+
+    const uint32_t decoderType = pData[0] % 4;
+    const uint32_t outputCount = ((uint32_t) pData[1] << 8) | pData[2];
+    const std::byte* const pSrc = (const std::byte*)(pData + 3);
+    const size_t srcSize = size - 3;
+
+    if (decoderType == 3)
+        return fuzzChdCdImage(pSrc, srcSize);
+
+    const size_t outputSize = (decoderType == 2) ? (size_t) outputCount * 4 : outputCount;
+    std::vector<std::byte> output(outputSize + NUM_GUARD_BYTES, (std::byte) GUARD_BYTE);
+
+    if (decoderType == 0) {
+        chd::Inflate::decode(pSrc, srcSize, output.data(), outputSize);
+    } else if (decoderType == 1) {
+        chd::LzmaDecoder::decode(pSrc, srcSize, output.data(), outputSize);
+    } else {
+        size_t srcBytesUsed = 0;
+
+        if (chd::FlacDecoder::decode(pSrc, srcSize, 2, outputCount, output.data(), srcBytesUsed)) {
+            if (srcBytesUsed > srcSize)
+                return false;
+        }
+    }
+
+    return checkGuardBytes(output, outputSize);
+}
+
+END_NAMESPACE(FuzzChd)
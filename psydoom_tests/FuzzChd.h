@@ -0,0 +1,12 @@
+#pragma once
+
+#include "Macros.h"
+
+#include <cstddef>
+#include <cstdint>
+
+BEGIN_NAMESPACE(FuzzChd)
+
+bool run(const uint8_t* const pData, const size_t size) noexcept;
+
+END_NAMESPACE(FuzzChd)
@@ -0,0 +1,52 @@
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Fuzzing target for the CHD decompressors. See 'FuzzChd.cpp' for the input format.
+//
+// When built with libFuzzer (Clang with '-fsanitize=fuzzer') this is the libFuzzer entry point.
+// Otherwise it is a standalone program which runs each of the input files given on the command line, for reproducing crashes:
+//      PsyDoomFuzzChd <INPUT_FILE> [<INPUT_FILE>...]
+//------------------------------------------------------------------------------------------------------------------------------------------
+#include "FuzzChd.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* const pData, const size_t size) {
+    if (!FuzzChd::run(pData, size)) {
+        std::abort();
+    }
+
+    return 0;
+}
+
+#if !PSYDOOM_FUZZ_WITH_LIBFUZZER
+int main(const int argc, const char* const* const argv) {
+    if (argc < 2) {
+        std::printf("Usage: PsyDoomFuzzChd <INPUT_FILE> [<INPUT_FILE>...]\n");
+        return 1;
+    }
+
+    for (int argIdx = 1; argIdx < argc; ++argIdx) {
+        std::FILE* const pFile = std::fopen(argv[argIdx], "rb");
+
+        if (!pFile) {
+            std::printf("Unable to open input file '%s'!\n", argv[argIdx]);
+            return 1;
+        }
+
+        std::vector<uint8_t> input;
+        uint8_t buffer[4096];
+
+        for (size_t numRead; (numRead = std::fread(buffer, 1, sizeof(buffer), pFile)) > 0;) {
+            input.insert(input.end(), buffer, buffer + numRead);
+        }
+
+        std::fclose(pFile);
+        std::printf("Running: %s\n", argv[argIdx]);
+        LLVMFuzzerTestOneInput(input.data(), input.size());
+    }
+
+    std::printf("All inputs ran without errors.\n");
+    return 0;
+}
+#endif
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "Macros.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+BEGIN_NAMESPACE(Tests)
+
+// Runs a single test and returns 'true' if it passed.
+// Failures should be reported via 'TEST_CHECK', which prints where the failure happened.
+typedef bool (*TestFunc)() noexcept;
+
+// Describes a single test
+struct Test {
+    const char*     name;       // Name of the test, as shown in the results and matched by the '-filter' argument
+    TestFunc        run;        // Runs the test
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Deterministic 'xorshift64*' random number generator used to generate test inputs.
+// Always produces the same sequence for a given seed, on all platforms, so that any failure can be reproduced.
+//------------------------------------------------------------------------------------------------------------------------------------------
+class Rng {
+public:
+    inline Rng(const uint64_t seed) noexcept : mState(seed ? seed : 0x9E3779B97F4A7C15ull) {}
+
+    inline uint64_t next() noexcept {
+        mState ^= mState >> 12;
+        mState ^= mState << 25;
+        mState ^= mState >> 27;
+        return mState * 0x2545F4914F6CDD1Dull;
+    }
+
+    // Returns a random number in the inclusive range given
+    inline int32_t range(const int32_t minVal, const int32_t maxVal) noexcept {
+        const uint64_t numVals = (uint64_t)((int64_t) maxVal - minVal) + 1;
+        return (int32_t)((int64_t) minVal + (int64_t)((next() >> 16) % numVals));
+    }
+
+private:
+    uint64_t mState;
+};
+
+// Reports a failed check and where it happened
+void reportFailure(const char* const file, const int line, const char* const expr) noexcept;
+
+// Test data utilities
+uint32_t computeCrc32(const void* const pData, const size_t size) noexcept;
+bool readTestDataFile(const char* const fileName, std::vector<uint8_t>& data) noexcept;
+std::string getTestDataFilePath(const char* const fileName) noexcept;
+
+// Functions adding each group of tests to the list of tests to run
+void addTests_Chd(std::vector<Test>& tests) noexcept;
+void addTests_LzCompress(std::vector<Test>& tests) noexcept;
+void addTests_Lzss(std::vector<Test>& tests) noexcept;
+
+END_NAMESPACE(Tests)
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Checks the given condition and fails the current test (by returning 'false' from it) if the condition is not met
+//------------------------------------------------------------------------------------------------------------------------------------------
+#define TEST_CHECK(COND)\
+    do {\
+        if (!(COND)) {\
+            Tests::reportFailure(__FILE__, __LINE__, #COND);\
+            return false;\
+        }\
+    } while (0)
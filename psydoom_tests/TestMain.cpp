@@ -0,0 +1,88 @@
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Test suite for PsyDoom code which can be tested in isolation, such as decoders for data formats.
+//
+// Each test checks some code against known good results, for example the output of a simpler reference implementation.
+// Inputs are generated from fixed seeds so that any failures can be reproduced.
+//
+// Usage:
+//      PsyDoomTests [-filter <TEXT>] [-list]
+//
+//  -filter <TEXT>      Only run tests with names containing the given text (case sensitive)
+//  -list               Just list the names of all tests and exit
+//
+// The exit code is '0' if all tests that were run passed, or '1' otherwise.
+//------------------------------------------------------------------------------------------------------------------------------------------
+#include "Test.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+BEGIN_NAMESPACE(Tests)
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Reports a failed check and where it happened
+//------------------------------------------------------------------------------------------------------------------------------------------
+void reportFailure(const char* const file, const int line, const char* const expr) noexcept {
+    std::printf("    CHECK FAILED: %s (%s:%d)\n", expr, file, line);
+    std::fflush(stdout);
+}
+
+END_NAMESPACE(Tests)
+
+int main(const int argc, const char* const* const argv) {
+    // Parse command line arguments
+    const char* filter = "";
+    bool bListOnly = false;
+
+    for (int argIdx = 1; argIdx < argc; ++argIdx) {
+        const char* const arg = argv[argIdx];
+
+        if ((std::strcmp(arg, "-filter") == 0) && (argIdx + 1 < argc)) {
+            filter = argv[++argIdx];
+        } else if (std::strcmp(arg, "-list") == 0) {
+            bListOnly = true;
+        } else {
+            std::printf("Usage: PsyDoomTests [-filter <TEXT>] [-list]\n");
+            return 1;
+        }
+    }
+
+    // Gather all of the tests
+    std::vector<Tests::Test> tests;
+    Tests::addTests_Chd(tests);
+    Tests::addTests_LzCompress(tests);
+    Tests::addTests_Lzss(tests);
+
+    // List or run the tests requested
+    typedef std::chrono::steady_clock clock;
+    uint32_t numRun = 0;
+    uint32_t numFailed = 0;
+
+    for (const Tests::Test& test : tests) {
+        if (!std::strstr(test.name, filter))
+            continue;
+
+        if (bListOnly) {
+            std::printf("%s\n", test.name);
+            continue;
+        }
+
+        const clock::time_point startTime = clock::now();
+        const bool bPassed = test.run();
+        const clock::time_point endTime = clock::now();
+        const double runMs = std::chrono::duration<double, std::milli>(endTime - startTime).count();
+
+        std::printf("%-44s %s   (%.1f ms)\n", test.name, (bPassed) ? "PASSED" : "FAILED", runMs);
+        std::fflush(stdout);
+
+        ++numRun;
+        numFailed += (bPassed) ? 0 : 1;
+    }
+
+    if (bListOnly)
+        return 0;
+
+    std::printf("\n%u of %u tests passed\n", numRun - numFailed, numRun);
+    return (numFailed == 0) ? 0 : 1;
+}
@@ -0,0 +1,80 @@
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Utilities shared by the tests: reading the test data files and computing checksums for comparing against the expected results
+//------------------------------------------------------------------------------------------------------------------------------------------
+#include "Test.h"
+
+#include <cstdio>
+
+BEGIN_NAMESPACE(Tests)
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Computes the standard CRC32 (as used by zlib) of the given data.
+// The test data generator script records this checksum for the expected output of each test case.
+//------------------------------------------------------------------------------------------------------------------------------------------
+uint32_t computeCrc32(const void* const pData, const size_t size) noexcept {
+    static uint32_t crcTable[256] = {};
+
+    if (crcTable[1] == 0) {
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t crc = i;
+
+            for (uint32_t bit = 0; bit < 8; ++bit) {
+                crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320u : (crc >> 1);
+            }
+
+            crcTable[i] = crc;
+        }
+    }
+
+    const uint8_t* const pBytes = (const uint8_t*) pData;
+    uint32_t crc = 0xFFFFFFFFu;
+
+    for (size_t i = 0; i < size; ++i) {
+        crc = crcTable[(crc ^ pBytes[i]) & 0xFF] ^ (crc >> 8);
+    }
+
+    return ~crc;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Gets the path to the specified file in the test data directory
+//------------------------------------------------------------------------------------------------------------------------------------------
+std::string getTestDataFilePath(const char* const fileName) noexcept {
+    std::string path = PSYDOOM_TESTS_DATA_DIR;
+    path += "/";
+    path += fileName;
+    return path;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Reads the entire contents of the specified file in the test data directory, returning 'false' on failure
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool readTestDataFile(const char* const fileName, std::vector<uint8_t>& data) noexcept {
+    data.clear();
+    std::FILE* const pFile = std::fopen(getTestDataFilePath(fileName).c_str(), "rb");
+
+    if (!pFile) {
+        std::printf("    Unable to open test data file '%s'!\n", fileName);
+        return false;
+    }
+
+    bool bReadOk = (std::fseek(pFile, 0, SEEK_END) == 0);
+    const long fileSize = (bReadOk) ? std::ftell(pFile) : -1;
+    bReadOk = (bReadOk && (fileSize >= 0) && (std::fseek(pFile, 0, SEEK_SET) == 0));
+
+    if (bReadOk) {
+        data.resize((size_t) fileSize);
+        bReadOk = (std::fread(data.data(), 1, data.size(), pFile) == data.size());
+    }
+
+    std::fclose(pFile);
+
+    if (!bReadOk) {
+        std::printf("    Unable to read test data file '%s'!\n", fileName);
+        data.clear();
+    }
+
+    return bReadOk;
+}
+
+END_NAMESPACE(Tests)
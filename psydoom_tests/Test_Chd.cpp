@@ -0,0 +1,297 @@
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tests for the CHD decompressors ('chd::Inflate', 'chd::LzmaDecoder' and 'chd::FlacDecoder') and CD image reader ('chd::ChdCdImage').
+//
+// The expected results come from the test data in the 'data' directory, which is made by 'make_test_data.py' using the reference zlib and
+// liblzma libraries, a FLAC encoder written from the specification and a CHD writer written from the format used by 'chdman'.
+// Randomly corrupted copies of the test data are also run through the fuzzing entry point, to check that bad data is rejected safely.
+//------------------------------------------------------------------------------------------------------------------------------------------
+#include "Test.h"
+
+#include "FuzzChd.h"
+#include "PsyDoom/Chd/ChdCdImage.h"
+#include "PsyDoom/Chd/FlacDecoder.h"
+#include "PsyDoom/Chd/Inflate.h"
+#include "PsyDoom/Chd/LzmaDecoder.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+BEGIN_NAMESPACE(Tests)
+
+// How many bytes after the decompressed output must be left untouched and the value they are filled with
+static constexpr uint32_t NUM_GUARD_BYTES = 64;
+static constexpr uint8_t GUARD_BYTE = 0xCD;
+
+// How many random corruptions of the test data to try
+static constexpr int32_t NUM_CORRUPTED_CASES = 3000;
+static constexpr int32_t NUM_CORRUPTED_CD_IMAGES = 40;
+
+// A test case read from one of the '*_cases.bin' files
+struct TestCase {
+    std::vector<uint32_t>   header;     // The header words for the case
+    std::vector<uint8_t>    data;       // The data following the header
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Reads all of the test cases from the specified test data file.
+// Each case is a header with the specified number of words, the first of which is the size of the data that follows.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool readTestCases(const char* const fileName, const uint32_t numHeaderWords, std::vector<TestCase>& cases) noexcept {
+    std::vector<uint8_t> fileData;
+    TEST_CHECK(readTestDataFile(fileName, fileData));
+
+    for (size_t offset = 0; offset < fileData.size();) {
+        TEST_CHECK(fileData.size() - offset >= numHeaderWords * sizeof(uint32_t));
+        TestCase& testCase = cases.emplace_back();
+
+        for (uint32_t wordIdx = 0; wordIdx < numHeaderWords; ++wordIdx, offset += 4) {
+            const uint8_t* const pWord = fileData.data() + offset;
+            testCase.header.push_back((uint32_t) pWord[0] | ((uint32_t) pWord[1] << 8) | ((uint32_t) pWord[2] << 16) | ((uint32_t) pWord[3] << 24));
+        }
+
+        const uint32_t dataSize = testCase.header[0];
+        TEST_CHECK(fileData.size() - offset >= dataSize);
+        testCase.data.assign(fileData.begin() + offset, fileData.begin() + offset + dataSize);
+        offset += dataSize;
+    }
+
+    TEST_CHECK(!cases.empty());
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Checks a DEFLATE or LZMA decoder against the cases in the given file: the output must match and nothing after it may be written.
+// Also checks decoding into an output buffer which is too small for the data: DEFLATE streams end with a marker, so this must fail.
+// Raw LZMA streams used by CHD have no end marker however, so decoding may instead stop when the output is full: the result must then
+// match the start of the full output.
+//------------------------------------------------------------------------------------------------------------------------------------------
+template <class DecodeFunc>
+static bool checkDecoderCases(const char* const fileName, const bool bShortOutputMustFail, const DecodeFunc& decode) noexcept {
+    std::vector<TestCase> cases;
+    TEST_CHECK(readTestCases(fileName, 3, cases));
+
+    for (const TestCase& testCase : cases) {
+        const std::byte* const pSrc = (const std::byte*) testCase.data.data();
+        const size_t srcSize = testCase.data.size();
+        const uint32_t rawSize = testCase.header[1];
+        const uint32_t rawCrc32 = testCase.header[2];
+
+        std::vector<uint8_t> output((size_t) rawSize + NUM_GUARD_BYTES, GUARD_BYTE);
+        TEST_CHECK(decode(pSrc, srcSize, (std::byte*) output.data(), rawSize));
+        TEST_CHECK(computeCrc32(output.data(), rawSize) == rawCrc32);
+        TEST_CHECK(std::all_of(output.begin() + rawSize, output.end(), [](const uint8_t b) noexcept { return (b == GUARD_BYTE); }));
+
+        if (rawSize > 0) {
+            std::vector<uint8_t> shortOutput(output.size(), GUARD_BYTE);
+            const bool bShortDecodeOk = decode(pSrc, srcSize, (std::byte*) shortOutput.data(), rawSize - 1);
+            TEST_CHECK(!(bShortDecodeOk && bShortOutputMustFail));
+            TEST_CHECK((!bShortDecodeOk) || (std::memcmp(shortOutput.data(), output.data(), rawSize - 1) == 0));
+            TEST_CHECK(std::all_of(shortOutput.begin() + rawSize - 1, shortOutput.end(), [](const uint8_t b) noexcept { return (b == GUARD_BYTE); }));
+        }
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tests: decoding known good data for each codec
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool test_Inflate() noexcept {
+    return checkDecoderCases(
+        "inflate_cases.bin",
+        true,
+        [](const std::byte* const pSrc, const size_t srcSize, std::byte* const pDst, const size_t dstSize) noexcept {
+            return chd::Inflate::decode(pSrc, srcSize, pDst, dstSize);
+        }
+    );
+}
+
+static bool test_Lzma() noexcept {
+    return checkDecoderCases(
+        "lzma_cases.bin",
+        false,
+        [](const std::byte* const pSrc, const size_t srcSize, std::byte* const pDst, const size_t dstSize) noexcept {
+            return chd::LzmaDecoder::decode(pSrc, srcSize, pDst, dstSize);
+        }
+    );
+}
+
+static bool test_Flac() noexcept {
+    std::vector<TestCase> cases;
+    TEST_CHECK(readTestCases("flac_cases.bin", 4, cases));
+
+    for (const TestCase& testCase : cases) {
+        const uint32_t flacSize = testCase.header[1];
+        const uint32_t numSamples = testCase.header[2];
+        const uint32_t outputCrc32 = testCase.header[3];
+        const size_t outputSize = (size_t) numSamples * 4;
+
+        // Note: the input may have extra data after the FLAC frames, which the decoder should not consume
+        std::vector<uint8_t> output(outputSize + NUM_GUARD_BYTES, GUARD_BYTE);
+        size_t srcBytesUsed = 0;
+        TEST_CHECK(chd::FlacDecoder::decode((const std::byte*) testCase.data.data(), testCase.data.size(), 2, numSamples, (std::byte*) output.data(), srcBytesUsed));
+        TEST_CHECK(srcBytesUsed == flacSize);
+        TEST_CHECK(computeCrc32(output.data(), outputSize) == outputCrc32);
+        TEST_CHECK(std::all_of(output.begin() + outputSize, output.end(), [](const uint8_t b) noexcept { return (b == GUARD_BYTE); }));
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tests: reading a CD image containing hunks compressed with each of the CD codecs, as well as uncompressed and self referencing hunks
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool test_CdImage() noexcept {
+    // Read the expected size, checksum and tracks for the image
+    std::FILE* const pInfoFile = std::fopen(getTestDataFilePath("cd_image.txt").c_str(), "r");
+    TEST_CHECK(pInfoFile);
+
+    long long expectedSize = 0;
+    uint32_t expectedCrc32 = 0;
+    const bool bReadSize = (std::fscanf(pInfoFile, "size %lld crc32 %x", &expectedSize, &expectedCrc32) == 2);
+    std::vector<chd::ChdCdTrack> expectedTracks;
+
+    for (chd::ChdCdTrack track = {}; bReadSize;) {
+        char trackType[32] = {};
+
+        if (std::fscanf(pInfoFile, " track %d %31s %d %d %d", &track.trackNum, trackType, &track.firstFrame, &track.numFrames, &track.numPregapFrames) != 5)
+            break;
+
+        track.type = trackType;
+        expectedTracks.push_back(track);
+    }
+
+    std::fclose(pInfoFile);
+    TEST_CHECK(bReadSize);
+    TEST_CHECK(!expectedTracks.empty());
+
+    // Open the image and check the tracks
+    chd::ChdCdImage image;
+    std::string errorMsg;
+    TEST_CHECK(image.open(getTestDataFilePath("cd_image.chd").c_str(), errorMsg));
+    TEST_CHECK(image.getSize() == expectedSize);
+
+    const std::vector<chd::ChdCdTrack>& tracks = image.getTracks();
+    TEST_CHECK(tracks.size() == expectedTracks.size());
+
+    for (size_t trackIdx = 0; trackIdx < tracks.size(); ++trackIdx) {
+        const chd::ChdCdTrack& track = tracks[trackIdx];
+        const chd::ChdCdTrack& expected = expectedTracks[trackIdx];
+        TEST_CHECK(track.trackNum == expected.trackNum);
+        TEST_CHECK(track.type == expected.type);
+        TEST_CHECK(track.firstFrame == expected.firstFrame);
+        TEST_CHECK(track.numFrames == expected.numFrames);
+        TEST_CHECK(track.numPregapFrames == expected.numPregapFrames);
+        TEST_CHECK(track.bIsAudio == (expected.type == "AUDIO"));
+    }
+
+    // Read the whole image sequentially in randomly sized chunks (which cross sector and hunk boundaries) and verify the checksum
+    Rng rng(0x0C0Du);
+    std::vector<uint8_t> imageData((size_t) expectedSize);
+
+    for (size_t offset = 0; offset < imageData.size();) {
+        const size_t chunkSize = std::min<size_t>((size_t) rng.range(1, 3 * chd::ChdCdImage::SECTOR_SIZE), imageData.size() - offset);
+        TEST_CHECK(image.read(imageData.data() + offset, chunkSize) == chunkSize);
+        offset += chunkSize;
+        TEST_CHECK(image.tell() == (int64_t) offset);
+    }
+
+    TEST_CHECK(computeCrc32(imageData.data(), imageData.size()) == expectedCrc32);
+
+    // Reading at the end of the image should give nothing
+    uint8_t readBuffer[3 * chd::ChdCdImage::SECTOR_SIZE];
+    TEST_CHECK(image.read(readBuffer, 1) == 0);
+
+    // Random seeks and reads (including reads running off the end of the image) must match the data read sequentially
+    for (int32_t readIdx = 0; readIdx < 500; ++readIdx) {
+        const size_t offset = (size_t) rng.range(0, (int32_t) imageData.size() - 1);
+        const size_t readSize = (size_t) rng.range(1, (int32_t) sizeof(readBuffer));
+        const size_t expectedReadSize = std::min(readSize, imageData.size() - offset);
+
+        TEST_CHECK(image.seek((int64_t) offset));
+        TEST_CHECK(image.read(readBuffer, readSize) == expectedReadSize);
+        TEST_CHECK(std::memcmp(readBuffer, imageData.data() + offset, expectedReadSize) == 0);
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Corrupts the given data with a few random bit flips, byte changes, truncations or duplicated runs of bytes
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void corruptData(Rng& rng, std::vector<uint8_t>& data) noexcept {
+    const int32_t numCorruptions = rng.range(1, 4);
+
+    for (int32_t i = 0; (i < numCorruptions) && (!data.empty()); ++i) {
+        const size_t pos = (size_t) rng.range(0, (int32_t) data.size() - 1);
+
+        switch (rng.range(0, 3)) {
+            case 0: data[pos] ^= (uint8_t)(1u << rng.range(0, 7));                      break;
+            case 1: data[pos] = (uint8_t) rng.range(0, 255);                            break;
+            case 2: data.resize(pos);                                                   break;
+
+            case 3: {
+                const size_t runSize = std::min<size_t>((size_t) rng.range(1, 64), data.size() - pos);
+                const std::vector<uint8_t> run(data.begin() + pos, data.begin() + pos + runSize);
+                data.insert(data.begin() + (size_t) rng.range(0, (int32_t) data.size()), run.begin(), run.end());
+            }   break;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tests: corrupted data must be rejected (or decode to anything) without writing outside of the output or reading out of bounds.
+// The inputs are in the format expected by the fuzzing entry point, so failures found here can be reproduced with 'PsyDoomFuzzChd'.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool test_CorruptedData() noexcept {
+    Rng rng(0xBADu);
+
+    const auto makeFuzzInput = [](const uint8_t decoderType, const uint32_t outputCount, const std::vector<uint8_t>& data) noexcept {
+        std::vector<uint8_t> input = { decoderType, (uint8_t)(outputCount >> 8), (uint8_t) outputCount };
+        input.insert(input.end(), data.begin(), data.end());
+        return input;
+    };
+
+    // Corrupted DEFLATE, LZMA and FLAC data: the output size is also sometimes wrong
+    for (uint8_t decoderType = 0; decoderType < 3; ++decoderType) {
+        constexpr const char* const CASE_FILES[3] = { "inflate_cases.bin", "lzma_cases.bin", "flac_cases.bin" };
+        std::vector<TestCase> cases;
+        TEST_CHECK(readTestCases(CASE_FILES[decoderType], (decoderType == 2) ? 4 : 3, cases));
+
+        for (int32_t caseIdx = 0; caseIdx < NUM_CORRUPTED_CASES; ++caseIdx) {
+            const TestCase& testCase = cases[(size_t) rng.range(0, (int32_t) cases.size() - 1)];
+            std::vector<uint8_t> data = testCase.data;
+            corruptData(rng, data);
+
+            const uint32_t outputCount = std::min<uint32_t>((decoderType == 2) ? testCase.header[2] : testCase.header[1], UINT16_MAX);
+            const uint32_t fuzzOutputCount = (rng.range(0, 3) == 0) ? (uint32_t) rng.range(0, UINT16_MAX) : outputCount;
+            const std::vector<uint8_t> input = makeFuzzInput(decoderType, fuzzOutputCount, data);
+            TEST_CHECK(FuzzChd::run(input.data(), input.size()));
+        }
+    }
+
+    // Corrupted CD images
+    std::vector<uint8_t> cdImage;
+    TEST_CHECK(readTestDataFile("cd_image.chd", cdImage));
+
+    for (int32_t imageIdx = 0; imageIdx < NUM_CORRUPTED_CD_IMAGES; ++imageIdx) {
+        std::vector<uint8_t> data = cdImage;
+        corruptData(rng, data);
+
+        const std::vector<uint8_t> input = makeFuzzInput(3, 0, data);
+        TEST_CHECK(FuzzChd::run(input.data(), input.size()));
+    }
+
+    return true;
+}
+
+void addTests_Chd(std::vector<Test>& tests) noexcept {
+    tests.push_back({ "Chd/Inflate", test_Inflate });
+    tests.push_back({ "Chd/Lzma", test_Lzma });
+    tests.push_back({ "Chd/Flac", test_Flac });
+    tests.push_back({ "Chd/CdImage", test_CdImage });
+    tests.push_back({ "Chd/CorruptedData", test_CorruptedData });
+}
+
+END_NAMESPACE(Tests)
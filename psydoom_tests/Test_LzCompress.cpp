@@ -0,0 +1,251 @@
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tests for the LZ4 block format compressor used for data written at runtime ('LzCompress::compress' and 'LzCompress::decompress').
+//
+// Data is round tripped through the compressor for empty, incompressible (random) and highly repetitive inputs, along with a mix of both.
+// Truncated and randomly corrupted streams are also checked, to make sure that the bounds checked decompressor rejects them safely and
+// never writes outside of the output buffer.
+//------------------------------------------------------------------------------------------------------------------------------------------
+#include "Test.h"
+
+#include "LzCompress.h"
+
+#include <algorithm>
+#include <cstring>
+
+BEGIN_NAMESPACE(Tests)
+
+// How many random inputs and corruptions to check and how many bytes after the decompressed output must be left untouched
+static constexpr int32_t NUM_RANDOM_INPUTS = 2000;
+static constexpr int32_t NUM_CORRUPTED_CASES = 5000;
+static constexpr uint32_t NUM_GUARD_BYTES = 64;
+static constexpr uint8_t GUARD_BYTE = 0xCD;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Decompresses the given stream to an output buffer of the given size, followed by guard bytes.
+// Returns the result of decompression and checks that the guard bytes after the output were left untouched.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool decompressWithGuard(const std::vector<std::byte>& stream, const size_t dstSize, std::vector<uint8_t>& output, bool& bResult) noexcept {
+    output.assign(dstSize + NUM_GUARD_BYTES, GUARD_BYTE);
+    bResult = LzCompress::decompress(stream.data(), stream.size(), output.data(), dstSize);
+    TEST_CHECK(std::all_of(output.begin() + dstSize, output.end(), [](const uint8_t b) noexcept { return (b == GUARD_BYTE); }));
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Compresses the given data and checks that it decompresses back to the original.
+// Also checks that the compressed size is within the worst case bound and that decompressing to the wrong size fails.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool checkRoundTrip(const std::vector<uint8_t>& data, std::vector<std::byte>& compressed) noexcept {
+    LzCompress::compress(data.data(), data.size(), compressed);
+    TEST_CHECK(compressed.size() <= LzCompress::getMaxCompressedSize(data.size()));
+
+    std::vector<uint8_t> output;
+    bool bResult = false;
+    TEST_CHECK(decompressWithGuard(compressed, data.size(), output, bResult));
+    TEST_CHECK(bResult);
+    TEST_CHECK(std::equal(data.begin(), data.end(), output.begin()));
+
+    // The output size given must match the original size exactly
+    TEST_CHECK(decompressWithGuard(compressed, data.size() + 1, output, bResult));
+    TEST_CHECK(!bResult);
+
+    if (!data.empty()) {
+        TEST_CHECK(decompressWithGuard(compressed, data.size() - 1, output, bResult));
+        TEST_CHECK(!bResult);
+    }
+
+    return true;
+}
+
+static bool checkRoundTrip(const std::vector<uint8_t>& data) noexcept {
+    std::vector<std::byte> compressed;
+    return checkRoundTrip(data, compressed);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Helper: makes data with runs of random bytes and repeats of earlier data, a bit like a save file
+//------------------------------------------------------------------------------------------------------------------------------------------
+static std::vector<uint8_t> makeMixedData(Rng& rng, const size_t size) noexcept {
+    std::vector<uint8_t> data;
+    data.reserve(size);
+
+    while (data.size() < size) {
+        const size_t runLen = std::min<size_t>((size_t) rng.range(1, 300), size - data.size());
+
+        if (data.empty() || (rng.range(0, 1) == 0)) {
+            for (size_t i = 0; i < runLen; ++i) {
+                data.push_back((uint8_t) rng.range(0, 255));
+            }
+        } else {
+            const size_t srcPos = (size_t) rng.range(0, (int32_t) data.size() - 1);
+
+            for (size_t i = 0; i < runLen; ++i) {
+                data.push_back(data[srcPos + i]);   // Note: may overlap the data being added, which makes repeating patterns
+            }
+        }
+    }
+
+    return data;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tests: round trips of empty, incompressible, highly repetitive and mixed inputs
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool test_RoundTripEmpty() noexcept {
+    std::vector<std::byte> compressed;
+    TEST_CHECK(checkRoundTrip({}, compressed));
+    TEST_CHECK(compressed.size() == 1);
+    return true;
+}
+
+static bool test_RoundTripIncompressible() noexcept {
+    Rng rng(0x4C5Au);
+
+    // Cover sizes around where matches are allowed to start (LZ4 block rules) and sizes needing multiple literal length bytes
+    const size_t sizes[] = { 1, 4, 5, 11, 12, 13, 14, 15, 16, 254, 255, 256, 270, 271, 4096, 65536, 65537, 300000 };
+
+    for (const size_t size : sizes) {
+        std::vector<uint8_t> data(size);
+
+        for (uint8_t& b : data) {
+            b = (uint8_t) rng.range(0, 255);
+        }
+
+        TEST_CHECK(checkRoundTrip(data));
+    }
+
+    return true;
+}
+
+static bool test_RoundTripRepetitive() noexcept {
+    std::vector<std::byte> compressed;
+
+    // All zeros: this should compress to a tiny fraction of the original size
+    const std::vector<uint8_t> zeros(200000, 0);
+    TEST_CHECK(checkRoundTrip(zeros, compressed));
+    TEST_CHECK(compressed.size() < zeros.size() / 100);
+
+    // A short repeating pattern, which produces matches overlapping the output being written
+    std::vector<uint8_t> pattern(100000);
+
+    for (size_t i = 0; i < pattern.size(); ++i) {
+        pattern[i] = (uint8_t)("PSXDOOM"[i % 7]);
+    }
+
+    TEST_CHECK(checkRoundTrip(pattern, compressed));
+    TEST_CHECK(compressed.size() < pattern.size() / 100);
+
+    // A pattern repeating further back than the maximum match offset: matches can't reach it, but must still round trip
+    Rng rng(0x9D1Fu);
+    std::vector<uint8_t> farPattern(70000 * 3);
+
+    for (size_t i = 0; i < 70000; ++i) {
+        farPattern[i] = (uint8_t) rng.range(0, 255);
+    }
+
+    for (size_t i = 70000; i < farPattern.size(); ++i) {
+        farPattern[i] = farPattern[i - 70000];
+    }
+
+    TEST_CHECK(checkRoundTrip(farPattern));
+    return true;
+}
+
+static bool test_RoundTripMixed() noexcept {
+    Rng rng(0x7E11u);
+
+    for (int32_t inputIdx = 0; inputIdx < NUM_RANDOM_INPUTS; ++inputIdx) {
+        const size_t size = (size_t) rng.range(0, (rng.range(0, 7) == 0) ? 100000 : 2000);
+        TEST_CHECK(checkRoundTrip(makeMixedData(rng, size)));
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tests: rejection of truncated and corrupted streams
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool test_RejectTruncated() noexcept {
+    Rng rng(0x3A07u);
+    const std::vector<uint8_t> data = makeMixedData(rng, 5000);
+
+    std::vector<std::byte> compressed;
+    LzCompress::compress(data.data(), data.size(), compressed);
+
+    // Every cut short version of the stream must be rejected, whatever point it ends at
+    std::vector<uint8_t> output;
+    bool bResult = true;
+
+    for (size_t truncatedSize = 0; truncatedSize < compressed.size(); ++truncatedSize) {
+        const std::vector<std::byte> truncated(compressed.begin(), compressed.begin() + truncatedSize);
+        TEST_CHECK(decompressWithGuard(truncated, data.size(), output, bResult));
+        TEST_CHECK(!bResult);
+    }
+
+    return true;
+}
+
+static bool test_RejectCorrupt() noexcept {
+    // Hand built streams that break each of the rules checked by the decompressor
+    const auto checkRejected = [](const std::vector<uint8_t>& streamBytes, const size_t dstSize) noexcept -> bool {
+        const std::vector<std::byte> stream((const std::byte*) streamBytes.data(), (const std::byte*) streamBytes.data() + streamBytes.size());
+        std::vector<uint8_t> output;
+        bool bResult = true;
+        TEST_CHECK(decompressWithGuard(stream, dstSize, output, bResult));
+        TEST_CHECK(!bResult);
+        return true;
+    };
+
+    TEST_CHECK(checkRejected({ 0x10, 'A', 0x00, 0x00, 0x00 }, 5));     // A match offset of '0'
+    TEST_CHECK(checkRejected({ 0x10, 'A', 0x02, 0x00, 0x00 }, 5));     // A match offset before the start of the output
+    TEST_CHECK(checkRejected({ 0x50, 'A', 'B' }, 5));                  // More literals than there is input
+    TEST_CHECK(checkRejected({ 0x30, 'A', 'B', 'C' }, 2));             // More literals than there is output
+    TEST_CHECK(checkRejected({ 0x10, 'A', 0x01, 0x00, 0x00 }, 4));     // A match longer than the remaining output
+    TEST_CHECK(checkRejected({ 0xF0, 0xFF }, 300));                    // A literal length missing its last length byte
+    TEST_CHECK(checkRejected({ 0x1F, 'A', 0x01, 0x00 }, 30));          // A match length missing its length bytes
+    TEST_CHECK(checkRejected({ 0x10, 'A', 0x01 }, 5));                 // A match offset cut short
+
+    // The valid version of the streams above, which repeats a single byte with an overlapping match
+    {
+        const uint8_t streamBytes[] = { 0x10, 'A', 0x01, 0x00, 0x00 };
+        const std::vector<std::byte> stream((const std::byte*) streamBytes, (const std::byte*) streamBytes + sizeof(streamBytes));
+        std::vector<uint8_t> output;
+        bool bResult = false;
+        TEST_CHECK(decompressWithGuard(stream, 5, output, bResult));
+        TEST_CHECK(bResult);
+        TEST_CHECK(std::memcmp(output.data(), "AAAAA", 5) == 0);
+    }
+
+    // Randomly corrupted copies of valid streams: these may or may not decompress, but must never write outside the output buffer
+    Rng rng(0x51C3u);
+
+    for (int32_t caseIdx = 0; caseIdx < NUM_CORRUPTED_CASES; ++caseIdx) {
+        const std::vector<uint8_t> data = makeMixedData(rng, (size_t) rng.range(1, 3000));
+        std::vector<std::byte> stream;
+        LzCompress::compress(data.data(), data.size(), stream);
+
+        const int32_t numCorruptions = rng.range(1, 4);
+
+        for (int32_t i = 0; i < numCorruptions; ++i) {
+            std::byte& b = stream[(size_t) rng.range(0, (int32_t) stream.size() - 1)];
+            b ^= (std::byte) rng.range(1, 255);
+        }
+
+        std::vector<uint8_t> output;
+        bool bResult = false;
+        TEST_CHECK(decompressWithGuard(stream, data.size(), output, bResult));
+    }
+
+    return true;
+}
+
+void addTests_LzCompress(std::vector<Test>& tests) noexcept {
+    tests.push_back({ "LzCompress/RoundTripEmpty", test_RoundTripEmpty });
+    tests.push_back({ "LzCompress/RoundTripIncompressible", test_RoundTripIncompressible });
+    tests.push_back({ "LzCompress/RoundTripRepetitive", test_RoundTripRepetitive });
+    tests.push_back({ "LzCompress/RoundTripMixed", test_RoundTripMixed });
+    tests.push_back({ "LzCompress/RejectTruncated", test_RejectTruncated });
+    tests.push_back({ "LzCompress/RejectCorrupt", test_RejectCorrupt });
+}
+
+END_NAMESPACE(Tests)
@@ -0,0 +1,179 @@
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tests for PSX LZSS lump decompression ('WadUtils::decompressLump' and 'WadUtils::getDecompressedLumpSize').
+//
+// The optimized decoder is checked against the original byte-at-a-time decoder, which is kept here as the reference implementation.
+// Streams are randomly generated to cover all of the cases the optimized decoder treats specially: runs of 8 literals, matches far enough
+// back to be copied in chunks, overlapping matches close behind the output and streams that end partway through an id byte.
+//------------------------------------------------------------------------------------------------------------------------------------------
+#include "Test.h"
+
+#include "PsyDoom/WadUtils.h"
+
+#include <algorithm>
+#include <cstring>
+
+BEGIN_NAMESPACE(Tests)
+
+// Limits of the compression format: 12-bits of offset and 4-bits of length, with a length of '1' marking the end of the stream
+static constexpr int32_t LZSS_MAX_OFFSET = 4096;
+static constexpr int32_t LZSS_MIN_LENGTH = 2;
+static constexpr int32_t LZSS_MAX_LENGTH = 16;
+
+// How many random streams to check and how many bytes after the decompressed output must be left untouched
+static constexpr int32_t NUM_RANDOM_STREAMS = 20000;
+static constexpr uint32_t NUM_GUARD_BYTES = 64;
+static constexpr uint8_t GUARD_BYTE = 0xCD;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// The original LZSS decoder, before it was optimized: used as the reference for the expected output
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void referenceDecompressLump(const uint8_t* pSrcByte, uint8_t* pDstByte) noexcept {
+    uint32_t idByte = 0;
+    uint32_t haveIdByte = 0;
+
+    while (true) {
+        if (haveIdByte == 0) {
+            idByte = *pSrcByte;
+            ++pSrcByte;
+        }
+
+        haveIdByte = (haveIdByte + 1) & 7;
+
+        if (idByte & 1) {
+            const uint32_t srcByte1 = pSrcByte[0];
+            const uint32_t srcByte2 = pSrcByte[1];
+            pSrcByte += 2;
+
+            const int32_t srcOffset = ((srcByte1 << 4) | (srcByte2 >> 4)) + 1;
+            const int32_t numRepeatedBytes = (srcByte2 & 0xF) + 1;
+
+            if (numRepeatedBytes == 1)
+                break;
+
+            const uint8_t* const pRepeatedBytes = pDstByte - srcOffset;
+
+            for (int32_t i = 0; i < numRepeatedBytes; ++i) {
+                *pDstByte = pRepeatedBytes[i];
+                ++pDstByte;
+            }
+        } else {
+            *pDstByte = *pSrcByte;
+            ++pSrcByte;
+            ++pDstByte;
+        }
+
+        idByte >>= 1;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Generates a random but valid compressed stream, returning the stream and the size of the data it decompresses to.
+// Matches never reference data before the start of the output, since that is invalid for the format.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static std::vector<uint8_t> makeRandomStream(Rng& rng, int32_t& decompressedSize) noexcept {
+    std::vector<uint8_t> stream;
+    size_t idBytePos = 0;
+    uint32_t numItemsForIdByte = 8;
+
+    const auto beginItem = [&](const bool bMatch) noexcept {
+        if (numItemsForIdByte >= 8) {
+            idBytePos = stream.size();
+            stream.push_back(0);
+            numItemsForIdByte = 0;
+        }
+
+        if (bMatch) {
+            stream[idBytePos] |= (uint8_t)(1u << numItemsForIdByte);
+        }
+
+        ++numItemsForIdByte;
+    };
+
+    // Vary the mix of items between streams: some streams are mostly literals, some mostly matches
+    const int32_t matchChance = rng.range(0, 100);
+    const int32_t closeMatchChance = rng.range(0, 100);
+    const int32_t numItems = rng.range(0, (rng.range(0, 3) == 0) ? 4000 : 200);
+    decompressedSize = 0;
+
+    for (int32_t itemIdx = 0; itemIdx < numItems; ++itemIdx) {
+        const bool bMatch = ((decompressedSize > 0) && (rng.range(1, 100) <= matchChance));
+        beginItem(bMatch);
+
+        if (bMatch) {
+            // Pick either a close match (which overlaps the output being written) or one anywhere in the window
+            const int32_t maxOffset = std::min(decompressedSize, LZSS_MAX_OFFSET);
+            const int32_t offset = (rng.range(1, 100) <= closeMatchChance) ? rng.range(1, std::min(maxOffset, 8)) : rng.range(1, maxOffset);
+            const int32_t length = rng.range(LZSS_MIN_LENGTH, LZSS_MAX_LENGTH);
+
+            stream.push_back((uint8_t)((offset - 1) >> 4));
+            stream.push_back((uint8_t)((((offset - 1) & 0xF) << 4) | (length - 1)));
+            decompressedSize += length;
+        } else {
+            // Use a small alphabet sometimes so that the data is more repetitive, like real lump data
+            stream.push_back((uint8_t)((rng.range(0, 1) == 0) ? rng.range(0, 255) : rng.range(0, 3)));
+            decompressedSize += 1;
+        }
+    }
+
+    // End of stream marker: a match with a length of '1' (the offset is irrelevant)
+    beginItem(true);
+    stream.push_back((uint8_t) rng.range(0, 255));
+    stream.push_back((uint8_t)(rng.range(0, 15) << 4));
+    return stream;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Decompresses the given stream with both the reference and optimized decoders and checks the results are identical.
+// Also checks that the optimized decoder does not write anything past the end of the decompressed data.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool checkStream(const std::vector<uint8_t>& stream, const int32_t expectedSize) noexcept {
+    TEST_CHECK(WadUtils::getDecompressedLumpSize(stream.data()) == expectedSize);
+
+    std::vector<uint8_t> expected((size_t) expectedSize + NUM_GUARD_BYTES, GUARD_BYTE);
+    std::vector<uint8_t> actual((size_t) expectedSize + NUM_GUARD_BYTES, GUARD_BYTE);
+    referenceDecompressLump(stream.data(), expected.data());
+    WadUtils::decompressLump(stream.data(), actual.data());
+
+    TEST_CHECK(std::memcmp(expected.data(), actual.data(), (size_t) expectedSize) == 0);
+    TEST_CHECK(std::all_of(actual.begin() + expectedSize, actual.end(), [](const uint8_t b) noexcept { return (b == GUARD_BYTE); }));
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tests: random streams covering all item types, plus a few hand built edge cases
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool test_RandomStreams() noexcept {
+    Rng rng(0x1255u);
+
+    for (int32_t streamIdx = 0; streamIdx < NUM_RANDOM_STREAMS; ++streamIdx) {
+        int32_t decompressedSize = 0;
+        const std::vector<uint8_t> stream = makeRandomStream(rng, decompressedSize);
+
+        if (!checkStream(stream, decompressedSize))
+            return false;
+    }
+
+    return true;
+}
+
+static bool test_EdgeCases() noexcept {
+    // An empty stream: just the end marker
+    TEST_CHECK(checkStream({ 0x01, 0x00, 0x00 }, 0));
+
+    // Exactly 8 literals followed by the end marker in the next id byte
+    TEST_CHECK(checkStream({ 0x00, 1, 2, 3, 4, 5, 6, 7, 8, 0x01, 0x00, 0x00 }, 8));
+
+    // A single literal repeated with an offset of '1' for the maximum length, which overlaps the output being written
+    TEST_CHECK(checkStream({ 0x06, 0xAB, 0x00, 0x0F, 0x00, 0x00 }, 17));
+
+    // Two literals repeated with an offset of '2', then a match 8 bytes back that is far enough to be copied in chunks
+    TEST_CHECK(checkStream({ 0x1C, 0x11, 0x22, 0x00, 0x1F, 0x00, 0x7F, 0x00, 0x00 }, 34));
+    return true;
+}
+
+void addTests_Lzss(std::vector<Test>& tests) noexcept {
+    tests.push_back({ "Lzss/RandomStreams", test_RandomStreams });
+    tests.push_back({ "Lzss/EdgeCases", test_EdgeCases });
+}
+
+END_NAMESPACE(Tests)
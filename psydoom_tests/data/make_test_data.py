@@ -0,0 +1,591 @@
+#!python
+
+############################################################################################################################################
+# This script generates the test data for the CHD decompressor tests in 'Test_Chd.cpp'.
+# The data is generated from fixed seeds, so running the script again should produce identical files.
+#
+# Files generated:
+#   inflate_cases.bin       Raw DEFLATE streams made by zlib, using all compression levels and strategies
+#   lzma_cases.bin          Raw LZMA streams (lc=3, lp=0, pb=2, as used by CHD) made by liblzma, using various presets and dictionary sizes
+#   flac_cases.bin          Sequences of FLAC frames (no stream header) using all of the subframe types, channel modes and residual codings
+#   cd_image.chd            A small version 5 CHD CD image with a data track and audio tracks, using all of the CD codecs
+#   cd_image.txt            The expected tracks and the size and CRC32 of the CD image, as it should be read via 'chd::ChdCdImage'
+#
+# The formats of the '*_cases.bin' files are a series of cases, each of which is a header of little endian 32-bit words followed by data:
+#   inflate/lzma:   compressed size, decompressed size, CRC32 of the decompressed data, compressed data
+#   flac:           input size, size of the FLAC frames within the input, number of stereo samples, CRC32 of the decoded big endian samples, input
+#
+# Requirements:
+#   (1) Python 3 with the standard 'zlib' and 'lzma' modules.
+#   (2) This script must be executed from the 'data' directory.
+############################################################################################################################################
+import lzma
+import math
+import random
+import struct
+import zlib
+
+#-------------------------------------------------------------------------------------------------------------------------------------------
+# Test input data generation
+#-------------------------------------------------------------------------------------------------------------------------------------------
+WORDS = [b"the", b"doom", b"imp", b"demon", b"sector", b"line", b"thing", b"texture", b"flat", b"sky", b"wad", b"lump", b"map"]
+
+def make_text(rng, size):
+    out = bytearray()
+    while len(out) < size:
+        out += rng.choice(WORDS) + rng.choice([b" ", b" ", b"\n", b", "])
+    return bytes(out[:size])
+
+def make_data(rng, size):
+    style = rng.randrange(5)
+
+    if style == 0:
+        return bytes(rng.randrange(256) for _ in range(size))
+    elif style == 1:
+        return make_text(rng, size)
+    elif style == 2:
+        out = bytearray()
+        while len(out) < size:
+            out += bytes([rng.randrange(256)]) * rng.randrange(1, 300)
+        return bytes(out[:size])
+    elif style == 3:
+        return bytes((i * 7 + (i >> 5)) & 0xFF for i in range(size))
+    else:
+        out = bytearray(make_text(rng, size))
+        for _ in range(size // 20):
+            out[rng.randrange(size)] = rng.randrange(256)
+        return bytes(out)
+
+def write_u32s(file, *values):
+    file.write(struct.pack("<%dI" % len(values), *values))
+
+#-------------------------------------------------------------------------------------------------------------------------------------------
+# DEFLATE and LZMA cases
+#-------------------------------------------------------------------------------------------------------------------------------------------
+def deflate(data, level, strategy):
+    compressor = zlib.compressobj(level, zlib.DEFLATED, -15, 9, strategy)
+    return compressor.compress(data) + compressor.flush()
+
+def lzma_raw(data, preset, dict_size):
+    filters = [{ "id": lzma.FILTER_LZMA1, "preset": preset, "lc": 3, "lp": 0, "pb": 2, "dict_size": dict_size }]
+    return lzma.compress(data, format=lzma.FORMAT_RAW, filters=filters)
+
+def make_inflate_cases():
+    rng = random.Random(1)
+    strategies = [zlib.Z_DEFAULT_STRATEGY, zlib.Z_FILTERED, zlib.Z_HUFFMAN_ONLY, zlib.Z_RLE, zlib.Z_FIXED]
+
+    with open("inflate_cases.bin", "wb") as file:
+        for case_idx in range(40):
+            size = rng.choice([0, 1, 2, 17, 255, 1000, 4096, 8192, 19584, 40000])
+            data = make_data(rng, size)
+            comp = deflate(data, rng.randrange(0, 10), rng.choice(strategies))
+            write_u32s(file, len(comp), len(data), zlib.crc32(data))
+            file.write(comp)
+
+def make_lzma_cases():
+    rng = random.Random(2)
+
+    with open("lzma_cases.bin", "wb") as file:
+        for case_idx in range(40):
+            size = rng.choice([0, 1, 2, 17, 255, 1000, 4096, 8192, 19584, 40000])
+            data = make_data(rng, size)
+            comp = lzma_raw(data, rng.randrange(0, 10), rng.choice([4096, 1 << 16, 1 << 20]))
+            write_u32s(file, len(comp), len(data), zlib.crc32(data))
+            file.write(comp)
+
+#-------------------------------------------------------------------------------------------------------------------------------------------
+# FLAC encoding: a simple encoder following the FLAC format specification, which randomly picks between all of the available options
+# for each frame and subframe, so that all of the decoder's code paths are exercised. It does not aim to compress well.
+#-------------------------------------------------------------------------------------------------------------------------------------------
+class BitWriter:
+    def __init__(self):
+        self.bits = []
+
+    def write(self, value, num_bits):
+        for i in range(num_bits - 1, -1, -1):
+            self.bits.append((value >> i) & 1)
+
+    def write_signed(self, value, num_bits):
+        self.write(value & ((1 << num_bits) - 1), num_bits)
+
+    def write_unary(self, value):
+        self.bits += [0] * value + [1]
+
+    def align(self):
+        while len(self.bits) % 8:
+            self.bits.append(0)
+
+    def get_bytes(self):
+        self.align()
+        out = bytearray()
+        for i in range(0, len(self.bits), 8):
+            byte = 0
+            for j in range(8):
+                byte = (byte << 1) | self.bits[i + j]
+            out.append(byte)
+        return bytes(out)
+
+def flac_encode_residual(rng, bw, residual, block_size, order):
+    method = rng.randint(0, 1)
+    param_bits = 4 if method == 0 else 5
+    escape_code = (1 << param_bits) - 1
+    partition_orders = [po for po in range(0, 5) if (block_size % (1 << po) == 0) and ((block_size >> po) >= order)]
+    partition_order = rng.choice(partition_orders)
+    bw.write(method, 2)
+    bw.write(partition_order, 4)
+
+    idx = 0
+    partition_size = block_size >> partition_order
+
+    for partition_idx in range(1 << partition_order):
+        num_values = (partition_size - order) if partition_idx == 0 else partition_size
+        values = residual[idx:idx + num_values]
+        idx += num_values
+
+        if rng.random() < 0.1:
+            # Escaped partition: values stored verbatim with a fixed number of bits
+            num_bits = min(max([(abs(v) * 2 + 1).bit_length() + 1 for v in values] + [1]), 31)
+            bw.write(escape_code, param_bits)
+            bw.write(num_bits, 5)
+            for v in values:
+                bw.write_signed(v, num_bits)
+        else:
+            # Rice coded partition
+            max_bits = max([abs(v) for v in values] + [0]).bit_length()
+            rice_param = rng.randint(min(max(0, max_bits - 3), escape_code - 1), min(escape_code - 1, max_bits + 1))
+            bw.write(rice_param, param_bits)
+            for v in values:
+                folded = (v << 1) if v >= 0 else ((-v) << 1) - 1
+                bw.write_unary(folded >> rice_param)
+                bw.write(folded & ((1 << rice_param) - 1), rice_param)
+
+def flac_encode_subframe(rng, bw, samples, bits_per_sample):
+    block_size = len(samples)
+    wasted_bits = 0
+
+    if any(v != 0 for v in samples):
+        while all(((v >> wasted_bits) & 1) == 0 for v in samples) and (wasted_bits < bits_per_sample - 1):
+            wasted_bits += 1
+
+    if wasted_bits and (rng.random() < 0.7):
+        samples = [v >> wasted_bits for v in samples]
+        bits_per_sample -= wasted_bits
+    else:
+        wasted_bits = 0
+
+    kinds = ["fixed", "fixed", "lpc", "lpc", "verbatim"]
+    if len(set(samples)) == 1:
+        kinds.append("constant")
+
+    kind = rng.choice(kinds)
+
+    def write_header(subframe_type):
+        bw.write(0, 1)
+        bw.write(subframe_type, 6)
+        if wasted_bits:
+            bw.write(1, 1)
+            bw.write_unary(wasted_bits - 1)
+        else:
+            bw.write(0, 1)
+
+    if kind == "constant":
+        write_header(0)
+        bw.write_signed(samples[0], bits_per_sample)
+    elif kind == "verbatim":
+        write_header(1)
+        for v in samples:
+            bw.write_signed(v, bits_per_sample)
+    elif kind == "fixed":
+        order = rng.randint(0, min(4, block_size))
+        coeffs = [[], [1], [2, -1], [3, -3, 1], [4, -6, 4, -1]][order]
+        residual = [samples[i] - sum(c * samples[i - 1 - j] for j, c in enumerate(coeffs)) for i in range(order, block_size)]
+        write_header(8 + order)
+        for v in samples[:order]:
+            bw.write_signed(v, bits_per_sample)
+        flac_encode_residual(rng, bw, residual, block_size, order)
+    else:
+        order = rng.randint(1, min(12, block_size))
+        precision = rng.randint(4, 15)
+        shift = min(15, precision - 1 + rng.randint(0, 2))
+        coeffs = [rng.randint(-(1 << (precision - 1)), (1 << (precision - 1)) - 1) // order for _ in range(order)]
+        residual = [samples[i] - (sum(c * samples[i - 1 - j] for j, c in enumerate(coeffs)) >> shift) for i in range(order, block_size)]
+        write_header(31 + order)
+        for v in samples[:order]:
+            bw.write_signed(v, bits_per_sample)
+        bw.write(precision - 1, 4)
+        bw.write_signed(shift, 5)
+        for c in coeffs:
+            bw.write_signed(c, precision)
+        flac_encode_residual(rng, bw, residual, block_size, order)
+
+def flac_encode_frame(rng, bw, left, right, frame_num):
+    block_size = len(left)
+    bw.write(0x7FFC, 15)
+    bw.write(0, 1)
+
+    standard_sizes = { 192: 1, 576: 2, 1152: 3, 2304: 4, 4608: 5, 256: 8, 512: 9, 1024: 10, 2048: 11, 4096: 12 }
+
+    if (block_size in standard_sizes) and (rng.random() < 0.7):
+        block_size_code = standard_sizes[block_size]
+    else:
+        block_size_code = 6 if block_size <= 256 else 7
+
+    bw.write(block_size_code, 4)
+    sample_rate_code = rng.choice([0, 9, 12, 13])
+    bw.write(sample_rate_code, 4)
+    channel_assignment = rng.choice([1, 8, 9, 10])
+    bw.write(channel_assignment, 4)
+    bw.write(rng.choice([0, 4]), 3)
+    bw.write(0, 1)
+
+    # Frame number, UTF-8 style
+    if frame_num < 0x80:
+        bw.write(frame_num, 8)
+    else:
+        bw.write(0xC0 | (frame_num >> 6), 8)
+        bw.write(0x80 | (frame_num & 0x3F), 8)
+
+    if block_size_code == 6:
+        bw.write(block_size - 1, 8)
+    elif block_size_code == 7:
+        bw.write(block_size - 1, 16)
+
+    if sample_rate_code == 12:
+        bw.write(44, 8)
+    elif sample_rate_code == 13:
+        bw.write(44100, 16)
+
+    bw.write(0, 8)  # Header CRC8: not verified by the decoder
+
+    if channel_assignment == 1:
+        flac_encode_subframe(rng, bw, left, 16)
+        flac_encode_subframe(rng, bw, right, 16)
+    elif channel_assignment == 8:
+        flac_encode_subframe(rng, bw, left, 16)
+        flac_encode_subframe(rng, bw, [l - r for l, r in zip(left, right)], 17)
+    elif channel_assignment == 9:
+        flac_encode_subframe(rng, bw, [l - r for l, r in zip(left, right)], 17)
+        flac_encode_subframe(rng, bw, right, 16)
+    else:
+        flac_encode_subframe(rng, bw, [(l + r) >> 1 for l, r in zip(left, right)], 16)
+        flac_encode_subframe(rng, bw, [l - r for l, r in zip(left, right)], 17)
+
+    bw.align()
+    bw.write(0, 16)  # Frame CRC16: not verified by the decoder
+
+def flac_encode(rng, left, right):
+    bw = BitWriter()
+    pos = 0
+    frame_num = 0
+
+    while pos < len(left):
+        block_size = min(rng.choice([192, 576, 1152, 256, 1024, 2352, 100, 17]), len(left) - pos)
+        flac_encode_frame(rng, bw, left[pos:pos + block_size], right[pos:pos + block_size], frame_num)
+        pos += block_size
+        frame_num += 1
+
+    return bw.get_bytes()
+
+def make_audio(rng, num_samples):
+    style = rng.randrange(4)
+
+    if style == 0:
+        left = [rng.randint(-32768, 32767) for _ in range(num_samples)]
+        right = [rng.randint(-32768, 32767) for _ in range(num_samples)]
+    elif style == 1:
+        left = [int(12000 * math.sin(i * 0.05)) for i in range(num_samples)]
+        right = [int(9000 * math.sin(i * 0.031 + 1)) for i in range(num_samples)]
+    elif style == 2:
+        left = [0] * num_samples
+        right = [(i % 7) * 4 for i in range(num_samples)]
+    else:
+        left = [rng.randint(-100, 100) * 8 for _ in range(num_samples)]
+        right = [v + rng.randint(-3, 3) * 8 for v in left]
+
+    return left, right
+
+def big_endian_pcm(left, right):
+    return b"".join(struct.pack(">hh", l, r) for l, r in zip(left, right))
+
+def make_flac_cases():
+    rng = random.Random(3)
+
+    with open("flac_cases.bin", "wb") as file:
+        for case_idx in range(20):
+            num_samples = rng.choice([1, 17, 588, 1000, 2352])
+            left, right = make_audio(rng, num_samples)
+            frames = flac_encode(rng, left, right)
+            extra = bytes(rng.randrange(256) for _ in range(rng.randint(0, 20)))
+            write_u32s(file, len(frames) + len(extra), len(frames), num_samples, zlib.crc32(big_endian_pcm(left, right)))
+            file.write(frames + extra)
+
+#-------------------------------------------------------------------------------------------------------------------------------------------
+# CHD CD image
+#-------------------------------------------------------------------------------------------------------------------------------------------
+CD_FRAME_SIZE = 2448
+CD_SECTOR_SIZE = 2352
+CD_SUBCODE_SIZE = 96
+CD_FRAMES_PER_HUNK = 8
+CD_SYNC = bytes([0] + [0xFF] * 10 + [0])
+
+# Galois field tables and ECC computation for mode 1/2 sectors, as per the ECMA-130 standard
+ECC_F_TABLE = [0] * 256
+ECC_B_TABLE = [0] * 256
+
+for i in range(256):
+    j = ((i << 1) ^ (0x11D if (i & 0x80) else 0)) & 0xFF
+    ECC_F_TABLE[i] = j
+    ECC_B_TABLE[i ^ j] = i
+
+def compute_ecc(src, major_count, minor_count, major_mult, minor_inc):
+    size = major_count * minor_count
+    out = bytearray(major_count * 2)
+
+    for major in range(major_count):
+        idx = (major >> 1) * major_mult + (major & 1)
+        ecc_a = 0
+        ecc_b = 0
+
+        for minor in range(minor_count):
+            value = src[idx]
+            idx += minor_inc
+            if idx >= size:
+                idx -= size
+            ecc_a ^= value
+            ecc_b ^= value
+            ecc_a = ECC_F_TABLE[ecc_a]
+
+        ecc_a = ECC_B_TABLE[ECC_F_TABLE[ecc_a] ^ ecc_b]
+        out[major] = ecc_a
+        out[major + major_count] = ecc_a ^ ecc_b
+
+    return bytes(out)
+
+def make_data_sector(rng, lba):
+    sector = bytearray(CD_SECTOR_SIZE)
+    sector[0:12] = CD_SYNC
+    sector[12:16] = bytes([lba % 75, (lba // 75) % 60, lba // 4500, 2])
+    sector[16:0x81C] = make_data(rng, 0x81C - 16)
+    sector[0x81C:0x81C + 172] = compute_ecc(bytes(sector[12:]), 86, 24, 2, 86)
+    sector[0x8C8:0x8C8 + 104] = compute_ecc(bytes(sector[12:]), 52, 43, 86, 88)
+    return bytes(sector)
+
+def is_ecc_ok(sector):
+    return (
+        (sector[0:12] == CD_SYNC) and
+        (compute_ecc(sector[12:], 86, 24, 2, 86) == sector[0x81C:0x81C + 172]) and
+        (compute_ecc(sector[12:], 52, 43, 86, 88) == sector[0x8C8:0x8C8 + 104])
+    )
+
+def crc16(data):
+    crc = 0xFFFF
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if (crc & 0x8000) else (crc << 1)
+        crc &= 0xFFFF
+    return crc
+
+def compress_cd_hunk(rng, frames, codec):
+    # Sector data for all frames, then subcode data for all frames
+    ecc_bitmask = bytearray((CD_FRAMES_PER_HUNK + 7) // 8)
+    sector_data = bytearray()
+    subcode_data = bytearray()
+
+    for frame_idx, (sector, subcode) in enumerate(frames):
+        sector = bytearray(sector)
+
+        if (codec != "cdfl") and is_ecc_ok(sector):
+            ecc_bitmask[frame_idx // 8] |= 1 << (frame_idx % 8)
+            sector[0:12] = bytes(12)
+            sector[0x81C:0x81C + 172] = bytes(172)
+            sector[0x8C8:0x8C8 + 104] = bytes(104)
+
+        sector_data += sector
+        subcode_data += subcode
+
+    subcode_comp = deflate(bytes(subcode_data), 9, zlib.Z_DEFAULT_STRATEGY)
+
+    if codec == "cdzl":
+        base_comp = deflate(bytes(sector_data), 9, zlib.Z_DEFAULT_STRATEGY)
+        return bytes(ecc_bitmask) + struct.pack(">H", len(base_comp)) + base_comp + subcode_comp
+    elif codec == "cdlz":
+        base_comp = lzma_raw(bytes(sector_data), 9, 1 << 16)
+        return bytes(ecc_bitmask) + struct.pack(">H", len(base_comp)) + base_comp + subcode_comp
+    else:
+        samples = struct.unpack(">%dh" % (len(sector_data) // 2), bytes(sector_data))
+        return flac_encode(rng, list(samples[0::2]), list(samples[1::2])) + subcode_comp
+
+def make_chd_cd_image():
+    rng = random.Random(4)
+    codecs = ["cdzl", "cdlz", "cdfl"]
+
+    # Tracks: a data track followed by audio tracks, some with a pregap stored in the file.
+    # Each track is padded to a multiple of 4 frames, as CHD does.
+    tracks = [("MODE2_RAW", 40, 0), ("AUDIO", 20, 10), ("AUDIO", 13, 0), ("AUDIO", 9, 4)]
+    frames = []         # Frames as read via 'chd::ChdCdImage': little endian audio
+    track_infos = []
+
+    for track_idx, (track_type, num_frames, num_pregap_frames) in enumerate(tracks):
+        track_infos.append((track_idx + 1, track_type, len(frames) + num_pregap_frames, num_frames, num_pregap_frames))
+
+        for frame_idx in range(num_pregap_frames + num_frames):
+            is_pregap = (frame_idx < num_pregap_frames)
+
+            if track_type == "AUDIO":
+                if is_pregap:
+                    frames.append(("audio", bytes(CD_SECTOR_SIZE)))
+                else:
+                    left, right = make_audio(rng, CD_SECTOR_SIZE // 4)
+                    frames.append(("audio", b"".join(struct.pack("<hh", l, r) for l, r in zip(left, right))))
+            else:
+                # Mostly valid mode 2 sectors (ECC is removed and regenerated), plus some which are not
+                if rng.random() < 0.8:
+                    frames.append(("data", make_data_sector(rng, len(frames) + 150)))
+                else:
+                    frames.append(("data", make_data(rng, CD_SECTOR_SIZE)))
+
+        while len(frames) % 4:
+            frames.append(("pad", bytes(CD_SECTOR_SIZE)))
+
+    # Repeat the last hunk exactly as a final audio track, to create a hunk that is a reference to another hunk.
+    # It must be part of a track since frames outside of all tracks are not known to be audio, and so would not be byte swapped when read.
+    while len(frames) % CD_FRAMES_PER_HUNK:
+        frames.append(("pad", bytes(CD_SECTOR_SIZE)))
+
+    assert track_infos[-1][2] + track_infos[-1][3] + 4 > len(frames), "Padding must not extend past the end of the last track's 4 frame padding"
+    track_infos.append((len(tracks) + 1, "AUDIO", len(frames), CD_FRAMES_PER_HUNK, 0))
+    frames += [("audio", sector) for kind, sector in frames[-CD_FRAMES_PER_HUNK:]]
+    num_hunks = len(frames) // CD_FRAMES_PER_HUNK
+    hunk_bytes = CD_FRAMES_PER_HUNK * CD_FRAME_SIZE
+    logical_bytes = len(frames) * CD_FRAME_SIZE
+
+    # Convert to how the frames are stored in the CHD: big endian audio and with subcode data
+    def to_chd_frame(kind, sector):
+        if kind == "audio":
+            sector = b"".join(sector[i + 1:i + 2] + sector[i:i + 1] for i in range(0, CD_SECTOR_SIZE, 2))
+        return (sector, bytes(rng.randrange(4) for _ in range(CD_SUBCODE_SIZE)))
+
+    chd_frames = [to_chd_frame(kind, sector) for kind, sector in frames]
+    chd_frames[-CD_FRAMES_PER_HUNK:] = chd_frames[-2 * CD_FRAMES_PER_HUNK:-CD_FRAMES_PER_HUNK]
+
+    # Compress each hunk: cycle through the codecs so that each is used, or store uncompressed/as a reference where required
+    hunk_entries = []       # (compression type, data length, crc16, data or referenced hunk index)
+    seen_hunks = {}
+
+    for hunk_idx in range(num_hunks):
+        hunk_frames = chd_frames[hunk_idx * CD_FRAMES_PER_HUNK:(hunk_idx + 1) * CD_FRAMES_PER_HUNK]
+        raw_hunk = b"".join(sector + subcode for sector, subcode in hunk_frames)
+        hunk_crc = crc16(raw_hunk)
+
+        if raw_hunk in seen_hunks:
+            hunk_entries.append((5, 0, 0, seen_hunks[raw_hunk]))
+            continue
+
+        seen_hunks[raw_hunk] = hunk_idx
+
+        if hunk_idx % 5 == 4:
+            hunk_entries.append((4, hunk_bytes, hunk_crc, raw_hunk))
+            continue
+
+        codec_idx = hunk_idx % len(codecs)
+        comp = compress_cd_hunk(rng, hunk_frames, codecs[codec_idx])
+
+        if len(comp) >= hunk_bytes:
+            hunk_entries.append((4, hunk_bytes, hunk_crc, raw_hunk))
+        else:
+            hunk_entries.append((codec_idx, len(comp), hunk_crc, comp))
+
+    # File layout: header, metadata, hunk data, then the compressed hunk map
+    HEADER_SIZE = 124
+    metadata = bytearray()
+    metadata_texts = []
+
+    for (track_num, track_type, first_frame, num_frames, num_pregap_frames) in track_infos:
+        pregap_type = ("V" + track_type) if num_pregap_frames else track_type
+        text = "TRACK:%d TYPE:%s SUBTYPE:RW FRAMES:%d PREGAP:%d PGTYPE:%s PGSUB:RW POSTGAP:0" % (
+            track_num, track_type, num_frames + num_pregap_frames, num_pregap_frames, pregap_type
+        )
+        metadata_texts.append(text.encode() + b"\0")
+
+    metadata_offset = HEADER_SIZE
+    entry_offset = metadata_offset
+
+    for i, text in enumerate(metadata_texts):
+        next_offset = (entry_offset + 16 + len(text)) if (i + 1 < len(metadata_texts)) else 0
+        metadata += b"CHT2" + struct.pack(">I", (1 << 24) | len(text)) + struct.pack(">Q", next_offset) + text
+        entry_offset += 16 + len(text)
+
+    # Compressed hunk map: a Huffman table giving every compression type a 4-bit code, then the codes and the entry details as bits
+    first_data_offset = metadata_offset + len(metadata)
+    hunk_data = bytearray()
+    raw_map = bytearray()
+    map_bits = []
+
+    def put_bits(value, num_bits):
+        for i in range(num_bits - 1, -1, -1):
+            map_bits.append((value >> i) & 1)
+
+    for i in range(16):
+        put_bits(4, 4)
+
+    for entry in hunk_entries:
+        put_bits(entry[0], 4)
+
+    LENGTH_BITS = 24
+    SELF_BITS = 32
+    cur_offset = first_data_offset
+
+    for (comp_type, length, crc, data) in hunk_entries:
+        if comp_type <= 3:
+            put_bits(length, LENGTH_BITS)
+            put_bits(crc, 16)
+            offset = cur_offset
+            cur_offset += length
+            hunk_data += data
+        elif comp_type == 4:
+            put_bits(crc, 16)
+            offset = cur_offset
+            cur_offset += length
+            hunk_data += data
+        else:
+            put_bits(data, SELF_BITS)
+            offset = data
+
+        raw_map += bytes([comp_type]) + length.to_bytes(3, "big") + offset.to_bytes(6, "big") + crc.to_bytes(2, "big")
+
+    while len(map_bits) % 8:
+        map_bits.append(0)
+
+    map_bytes = bytes(int("".join(map(str, map_bits[i:i + 8])), 2) for i in range(0, len(map_bits), 8))
+    map_offset = first_data_offset + len(hunk_data)
+    map_header = struct.pack(">I", len(map_bytes)) + first_data_offset.to_bytes(6, "big") + struct.pack(">H", crc16(raw_map))
+    map_header += bytes([LENGTH_BITS, SELF_BITS, 0, 0])
+
+    header = bytearray(HEADER_SIZE)
+    header[0:8] = b"MComprHD"
+    struct.pack_into(">II", header, 8, HEADER_SIZE, 5)
+    header[16:32] = b"".join(codec.encode() for codec in codecs) + bytes(4)
+    struct.pack_into(">QQQII", header, 32, logical_bytes, map_offset, metadata_offset, hunk_bytes, CD_FRAME_SIZE)
+
+    with open("cd_image.chd", "wb") as file:
+        file.write(header + metadata + hunk_data + map_header + map_bytes)
+
+    # The expected image contents as read via 'chd::ChdCdImage'
+    image = b"".join(sector for kind, sector in frames)
+
+    with open("cd_image.txt", "w") as file:
+        file.write("size %d crc32 %08x\n" % (len(image), zlib.crc32(image)))
+
+        for (track_num, track_type, first_frame, num_frames, num_pregap_frames) in track_infos:
+            file.write("track %d %s %d %d %d\n" % (track_num, track_type, first_frame, num_frames, num_pregap_frames))
+
+    print("cd_image.chd: {0:d} hunks, compression types {1:s}".format(num_hunks, str([e[0] for e in hunk_entries])))
+
+def main():
+    make_inflate_cases()
+    make_lzma_cases()
+    make_flac_cases()
+    make_chd_cd_image()
+
+main()
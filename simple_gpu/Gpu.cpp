@@ -3,10 +3,165 @@
 #include "Asserts.h"
 
 #include <algorithm>
+#include <cstdlib>
 #include <cstring>
+#include <type_traits>
+#include <vector>
+
+// Use SSE2 to modulate and blend the pixels of textured rectangles 8 at a time, where available.
+// SSE2 is always available on 64-bit x86 and is enabled by most 32-bit x86 builds.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+    #define GPU_USE_SSE2 1
+    #include <emmintrin.h>
+#else
+    #define GPU_USE_SSE2 0
+#endif
 
 BEGIN_NAMESPACE(Gpu)
 
+// Deferred draws: flush automatically once this many draws are queued, to keep memory use bounded
+static constexpr uint32_t MAX_DEFERRED_CMDS = 1 << 16;
+
+// Deferred draws: the minimum height of a band of rows that is rasterized as one job
+static constexpr int32_t MIN_DEFERRED_BAND_H = 8;
+
+// Texture cache: how many decoded textures can be cached and the maximum size of a decoded texture
+static constexpr uint32_t NUM_DECODED_TEXES = 64;
+static constexpr uint32_t MAX_DECODED_TEX_TEXELS = 256 * 128;
+
+// Texture cache: used to indicate that a deferred draw does not use a decoded texture
+static constexpr uint32_t NO_DECODED_TEX = UINT32_MAX;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Texture cache types.
+// A decoded texture holds all the colors that can be read for a particular texture window, page, format and CLUT, stored as a flat array
+// of 16-bit colors. The array is indexed by the texture coordinates masked by the texture window mask (also including the bits which pick
+// out a texel in a VRAM pixel for 4-bit and 8-bit textures). Decoded textures are discarded whenever the VRAM they came from is written.
+//------------------------------------------------------------------------------------------------------------------------------------------
+struct DecodedTexKey {
+    uint16_t    texPageX;
+    uint16_t    texPageY;
+    uint16_t    texPageXMask;
+    uint16_t    texPageYMask;
+    uint16_t    texWinX;
+    uint16_t    texWinY;
+    uint16_t    texWinXMask;
+    uint16_t    texWinYMask;
+    uint16_t    clutCacheX;
+    uint16_t    clutCacheY;
+    TexFmt      texFmt;
+    TexFmt      clutCacheFmt;
+};
+
+// Keys are compared with 'memcmp', so there must be no padding bytes
+static_assert(sizeof(DecodedTexKey) == 22);
+
+struct DecodedTex {
+    DecodedTexKey           key;            // The settings the texture was decoded with
+    bool                    bValid;         // False if the texture must be decoded again before being used
+    bool                    bPinned;        // True if the texture is used by deferred draws which have not been flushed yet
+    uint16_t                xMask;          // Masks texture coordinates to get the position of a texel in the decoded texture
+    uint16_t                yMask;
+    uint16_t                rowShift;       // How much to shift the 'y' texel position by to get the offset of its row
+    uint16_t                srcLx;          // The area of VRAM the texels were read from (left X, inclusive)
+    uint16_t                srcRx;          // The area of VRAM the texels were read from (right X, inclusive)
+    uint16_t                srcTy;          // The area of VRAM the texels were read from (top Y, inclusive)
+    uint16_t                srcBy;          // The area of VRAM the texels were read from (bottom Y, inclusive)
+    uint16_t                clutLx;         // The area of VRAM the CLUT was read from (left X, inclusive)
+    uint16_t                clutRx;         // The area of VRAM the CLUT was read from (right X, inclusive)
+    uint16_t                clutY;          // The row of VRAM that the CLUT was read from
+    uint32_t                lastUseNum;     // When the texture was last used, for deciding which texture to replace
+    std::vector<Color16>    texels;         // The decoded texels
+};
+
+struct TexCache {
+    DecodedTex      texes[NUM_DECODED_TEXES];   // All the decoded textures
+    DecodedTex*     pLastTex;                   // The last decoded texture used, checked first when looking for a texture
+    uint32_t        useNum;                     // Incremented whenever a decoded texture is used
+    uint16_t        drawAreaLx;                 // The draw area which decoded textures were last checked against (left X, inclusive)
+    uint16_t        drawAreaRx;                 // The draw area which decoded textures were last checked against (right X, inclusive)
+    uint16_t        drawAreaTy;                 // The draw area which decoded textures were last checked against (top Y, inclusive)
+    uint16_t        drawAreaBy;                 // The draw area which decoded textures were last checked against (bottom Y, inclusive)
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Deferred drawing types.
+// Each queued draw references a snapshot of the GPU state which affects drawing, and consecutive draws share the same snapshot when the
+// state does not change. A copy of the CLUT cache is also saved whenever it is reloaded, so that every band draws with exactly the same
+// CLUT colors that immediate drawing would have used.
+//------------------------------------------------------------------------------------------------------------------------------------------
+enum class DeferredPrimType : uint8_t {
+    Rect,
+    Line,
+    Triangle,
+    TriangleGouraud,
+    FloorRow,
+    WallCol,
+    WallColGouraud,
+};
+
+struct DeferredState {
+    int16_t     drawOffsetX;
+    int16_t     drawOffsetY;
+    uint16_t    drawAreaLx;
+    uint16_t    drawAreaRx;
+    uint16_t    drawAreaTy;
+    uint16_t    drawAreaBy;
+    uint16_t    texPageX;
+    uint16_t    texPageY;
+    uint16_t    texPageXMask;
+    uint16_t    texPageYMask;
+    uint16_t    texWinX;
+    uint16_t    texWinY;
+    uint16_t    texWinXMask;
+    uint16_t    texWinYMask;
+    uint16_t    clutX;
+    uint16_t    clutY;
+    uint16_t    clutCacheX;
+    uint16_t    clutCacheY;
+    BlendMode   blendMode;
+    TexFmt      texFmt;
+    TexFmt      clutCacheFmt;
+    bool        bDisableMasking;
+    uint32_t    clutCacheIdx;       // Which saved copy of the CLUT cache to draw with
+    uint32_t    decodedTexIdx;      // Which decoded texture in the core's texture cache to draw with ('NO_DECODED_TEX' if none)
+};
+
+// Snapshots are compared with 'memcmp', so there must be no padding bytes
+static_assert(sizeof(DeferredState) == 48);
+
+struct DeferredCmd {
+    DeferredPrimType    primType;   // Which primitive list the draw is in
+    DrawMode            drawMode;   // How to draw the primitive
+    uint16_t            ty;         // The range of VRAM rows the draw might write to (top Y, inclusive)
+    uint16_t            by;         // The range of VRAM rows the draw might write to (bottom Y, inclusive)
+    uint32_t            primIdx;    // Index of the primitive in its list
+    uint32_t            stateIdx;   // Index of the GPU state snapshot to draw with
+};
+
+struct DeferredClut {
+    Color16 colors[256];
+};
+
+struct DeferredDraws {
+    RunJobsFunc                         runJobs;            // Host supplied function used to rasterize the bands in parallel
+    uint32_t                            maxBands;           // The maximum number of bands the draw area is split into when flushing
+    std::vector<DeferredCmd>            cmds;               // All the queued draws, in order
+    std::vector<DeferredState>          states;             // GPU state snapshots referenced by the queued draws
+    std::vector<DeferredClut>           cluts;              // Saved copies of the CLUT cache referenced by the GPU state snapshots
+    std::vector<DrawRect>               rects;              // The queued primitives of each type
+    std::vector<DrawLine>               lines;
+    std::vector<DrawTriangle>           triangles;
+    std::vector<DrawTriangleGouraud>    trianglesGouraud;
+    std::vector<DrawFloorRow>           floorRows;
+    std::vector<DrawWallCol>            wallCols;
+    std::vector<DrawWallColGouraud>     wallColsGouraud;
+    std::vector<std::vector<uint32_t>>  bandCmdIndexes;     // When flushing: the indexes of the draws touching each band, in order
+    const Core*                         pFlushingCore;      // When flushing: the core being flushed, which each band copies
+    int32_t                             bandsTy;            // When flushing: the first VRAM row covered by the bands
+    int32_t                             bandH;              // When flushing: the height of each band in rows
+};
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Rounds the given number up to the next power of two if it's not a power of two
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -34,8 +189,11 @@ void initCore(Core& core, const uint16_t ramPixelW, const uint16_t ramPixelH) no
 
     core = {};
 
-    core.pRam = new std::uint16_t[(size_t) ramPixelW * ramPixelH];
-    std::memset(core.pRam, 0, sizeof(uint16_t) * ramPixelW * ramPixelH);    // Zero init VRAM
+    // Note: VRAM is zero initialized via 'calloc' rather than by clearing it explicitly.
+    // For large (limit removing) VRAM sizes this lets the OS hand out demand-zero pages which are only committed once actually touched,
+    // so memory usage tracks how much of VRAM is in use rather than the full VRAM size.
+    core.pRam = (uint16_t*) std::calloc((size_t) ramPixelW * ramPixelH, sizeof(uint16_t));
+    ASSERT(core.pRam);
 
     core.ramPixelW = (uint16_t) nextPow2(ramPixelW);
     core.ramPixelH = (uint16_t) nextPow2(ramPixelH);
@@ -65,6 +223,14 @@ void initCore(Core& core, const uint16_t ramPixelW, const uint16_t ramPixelH) no
     core.clutX = 0;
     core.clutY = 240;
     core.bDisableMasking = false;
+    core.bandTy = 0;
+    core.bandBy = UINT16_MAX;
+    core.pDeferredDraws = nullptr;
+
+    core.pTexCache = new TexCache();
+    core.pTexCache->drawAreaLx = 1;     // Invalid area: make sure the first draw checks the draw area against decoded textures
+    core.pTexCache->drawAreaRx = 0;
+    core.pDecodedTex = nullptr;
 
     core.clutCacheX = UINT16_MAX;
     core.clutCacheY = UINT16_MAX;
@@ -73,7 +239,9 @@ void initCore(Core& core, const uint16_t ramPixelW, const uint16_t ramPixelH) no
 }
 
 void destroyCore(Core& core) noexcept {
-    delete[] core.pRam;
+    delete core.pDeferredDraws;     // Note: any pending draws are discarded
+    delete core.pTexCache;
+    std::free(core.pRam);
     core = {};
 }
 
@@ -213,6 +381,372 @@ void updateClutCache(Core& core) noexcept {
     }
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tells if two rectangular areas of VRAM overlap; left/right and top/bottom coordinates are inclusive
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool doVramRectsOverlap(
+    const uint16_t lx1,
+    const uint16_t rx1,
+    const uint16_t ty1,
+    const uint16_t by1,
+    const uint16_t lx2,
+    const uint16_t rx2,
+    const uint16_t ty2,
+    const uint16_t by2
+) noexcept {
+    return ((lx1 <= rx2) && (lx2 <= rx1) && (ty1 <= by2) && (ty2 <= by1));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tells if a decoded texture reads its texels or CLUT from the given area of VRAM; coordinates are inclusive
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool isDecodedTexInArea(
+    const DecodedTex& tex,
+    const uint16_t rectLx,
+    const uint16_t rectRx,
+    const uint16_t rectTy,
+    const uint16_t rectBy
+) noexcept {
+    return (
+        doVramRectsOverlap(tex.srcLx, tex.srcRx, tex.srcTy, tex.srcBy, rectLx, rectRx, rectTy, rectBy) ||
+        doVramRectsOverlap(tex.clutLx, tex.clutRx, tex.clutY, tex.clutY, rectLx, rectRx, rectTy, rectBy)
+    );
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Discards any decoded textures that were read from the given area of VRAM.
+// Note that textures in use by deferred draws keep their texels until the draws are done, since they can't be replaced until then.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void invalidateDecodedTexes(
+    Core& core,
+    const uint16_t rectLx,
+    const uint16_t rectRx,
+    const uint16_t rectTy,
+    const uint16_t rectBy
+) noexcept {
+    if (!core.pTexCache)
+        return;
+
+    for (DecodedTex& tex : core.pTexCache->texes) {
+        if (!tex.bValid)
+            continue;
+
+        if (isDecodedTexInArea(tex, rectLx, rectRx, rectTy, rectBy)) {
+            tex.bValid = false;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Must be called whenever VRAM is written to directly (not by drawing) so that caches of data read from VRAM can be updated.
+// The given area is inclusive and if it extends past the bounds of VRAM then it is assumed to wrap around.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void invalidateVramCaches(Core& core, const uint16_t rectLx, const uint16_t rectRx, const uint16_t rectTy, const uint16_t rectBy) noexcept {
+    // If the area wraps around then just assume it covers the whole width or height of VRAM
+    uint16_t lx = rectLx;
+    uint16_t rx = rectRx;
+    uint16_t ty = rectTy;
+    uint16_t by = rectBy;
+
+    if ((lx > rx) || (rx >= core.ramPixelW)) {
+        lx = 0;
+        rx = core.ramPixelW - 1;
+    }
+
+    if ((ty > by) || (by >= core.ramPixelH)) {
+        ty = 0;
+        by = core.ramPixelH - 1;
+    }
+
+    invalidateDecodedTexes(core, lx, rx, ty, by);
+
+    // Discard the CLUT cache too if the CLUT it holds was written to
+    const uint16_t clutCacheW = (core.clutCacheFmt == TexFmt::Bpp4) ? 16 : 256;
+    const uint16_t clutCacheRx = core.clutCacheX + clutCacheW - 1;
+
+    if ((core.clutCacheX != UINT16_MAX) && doVramRectsOverlap(core.clutCacheX, clutCacheRx, core.clutCacheY, core.clutCacheY, lx, rx, ty, by)) {
+        core.clutCacheX = UINT16_MAX;
+        core.clutCacheY = UINT16_MAX;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Must be called before every draw: discards any decoded textures within the current draw area, since drawing might overwrite them.
+// Only needs to check the textures when the draw area changes, since textures inside the draw area are never decoded.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void invalidateDecodedTexesInDrawArea(Core& core) noexcept {
+    TexCache* const pTexCache = core.pTexCache;
+
+    if (!pTexCache)
+        return;
+
+    TexCache& cache = *pTexCache;
+
+    const bool bSameDrawArea = (
+        (cache.drawAreaLx == core.drawAreaLx) &&
+        (cache.drawAreaRx == core.drawAreaRx) &&
+        (cache.drawAreaTy == core.drawAreaTy) &&
+        (cache.drawAreaBy == core.drawAreaBy)
+    );
+
+    if (bSameDrawArea)
+        return;
+
+    cache.drawAreaLx = core.drawAreaLx;
+    cache.drawAreaRx = core.drawAreaRx;
+    cache.drawAreaTy = core.drawAreaTy;
+    cache.drawAreaBy = core.drawAreaBy;
+    invalidateDecodedTexes(core, core.drawAreaLx, core.drawAreaRx, core.drawAreaTy, core.drawAreaBy);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Figures out the area of VRAM that the texels of a decoded texture are read from using the current texture settings.
+// This mirrors the calculations done by 'readTexel'.
+//------------------------------------------------------------------------------------------------------------------------------------------
+template <TexFmt TexFmt>
+static void getDecodedTexSrcArea(const Core& core, DecodedTex& tex) noexcept {
+    tex.srcLx = UINT16_MAX;
+    tex.srcRx = 0;
+    tex.srcTy = UINT16_MAX;
+    tex.srcBy = 0;
+
+    for (uint32_t u = 0; u <= tex.xMask; ++u) {
+        uint16_t vramX = (uint16_t) u & core.texWinXMask;
+        vramX += core.texWinX;
+
+        if constexpr (TexFmt == TexFmt::Bpp4) {
+            vramX /= 4;
+        } else if constexpr (TexFmt == TexFmt::Bpp8) {
+            vramX /= 2;
+        }
+
+        vramX &= core.texPageXMask;
+        vramX += core.texPageX;
+        vramX &= core.ramXMask;
+        tex.srcLx = std::min(tex.srcLx, vramX);
+        tex.srcRx = std::max(tex.srcRx, vramX);
+    }
+
+    for (uint32_t v = 0; v <= tex.yMask; ++v) {
+        uint16_t vramY = (uint16_t) v & core.texWinYMask;
+        vramY += core.texWinY;
+        vramY &= core.texPageYMask;
+        vramY += core.texPageY;
+        vramY &= core.ramYMask;
+        tex.srcTy = std::min(tex.srcTy, vramY);
+        tex.srcBy = std::max(tex.srcBy, vramY);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Decodes all the texels for a decoded texture using the current texture settings and CLUT cache.
+// Uses the same function that drawing does to read texels, so the colors will always be exactly the same.
+//------------------------------------------------------------------------------------------------------------------------------------------
+template <TexFmt TexFmt>
+static void decodeTexels(const Core& core, DecodedTex& tex) noexcept {
+    for (uint32_t v = 0; v <= tex.yMask; ++v) {
+        Color16* const pDstRow = tex.texels.data() + (v << tex.rowShift);
+
+        for (uint32_t u = 0; u <= tex.xMask; ++u) {
+            pDstRow[u] = readTexel<TexFmt>(core, (uint16_t) u, (uint16_t) v);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tells if a decoded texture reads from an area of VRAM that might be drawn to by any queued deferred draws
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool isDecodedTexInQueuedDrawArea(const Core& core, const DecodedTex& tex) noexcept {
+    if ((!core.pDeferredDraws) || core.pDeferredDraws->cmds.empty())
+        return false;
+
+    for (const DeferredState& state : core.pDeferredDraws->states) {
+        if (isDecodedTexInArea(tex, state.drawAreaLx, state.drawAreaRx, state.drawAreaTy, state.drawAreaBy))
+            return true;
+    }
+
+    return false;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Finds a decoded texture in the texture cache which can be replaced, or returns null if all of them are in use by deferred draws
+//------------------------------------------------------------------------------------------------------------------------------------------
+static DecodedTex* findReplaceableDecodedTex(TexCache& cache) noexcept {
+    DecodedTex* pBestTex = nullptr;
+
+    for (DecodedTex& tex : cache.texes) {
+        if (tex.bPinned)
+            continue;
+
+        if (!tex.bValid)
+            return &tex;
+
+        if ((!pBestTex) || (tex.lastUseNum < pBestTex->lastUseNum)) {
+            pBestTex = &tex;
+        }
+    }
+
+    return pBestTex;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Sets the decoded texture used for drawing with the current texture settings and CLUT cache, decoding the texture if required.
+// If the texture can't be decoded then no decoded texture is used and texels are read from VRAM instead.
+// The CLUT cache must be up to date for the texture format before calling this.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void bindDecodedTex(Core& core, const TexFmt texFmt) noexcept {
+    // If there is no texture cache then leave the current decoded texture as-is.
+    // This is the case for deferred draws, which use the decoded texture picked when the draw was queued.
+    TexCache* const pTexCache = core.pTexCache;
+
+    if (!pTexCache)
+        return;
+
+    TexCache& cache = *pTexCache;
+    core.pDecodedTex = nullptr;
+
+    // Only textures using a CLUT are decoded and the CLUT cache must hold a CLUT for the texture format
+    if ((texFmt == TexFmt::Bpp16) || (core.clutCacheFmt != texFmt))
+        return;
+
+    DecodedTexKey key;
+    key.texPageX = core.texPageX;
+    key.texPageY = core.texPageY;
+    key.texPageXMask = core.texPageXMask;
+    key.texPageYMask = core.texPageYMask;
+    key.texWinX = core.texWinX;
+    key.texWinY = core.texWinY;
+    key.texWinXMask = core.texWinXMask;
+    key.texWinYMask = core.texWinYMask;
+    key.clutCacheX = core.clutCacheX;
+    key.clutCacheY = core.clutCacheY;
+    key.texFmt = texFmt;
+    key.clutCacheFmt = core.clutCacheFmt;
+
+    // Usually the same texture gets used over and over again, so check the last texture used first before searching
+    DecodedTex* pTex = cache.pLastTex;
+
+    if ((!pTex) || (!pTex->bValid) || (std::memcmp(&pTex->key, &key, sizeof(DecodedTexKey)) != 0)) {
+        pTex = nullptr;
+
+        for (DecodedTex& tex : cache.texes) {
+            if (tex.bValid && (std::memcmp(&tex.key, &key, sizeof(DecodedTexKey)) == 0)) {
+                pTex = &tex;
+                break;
+            }
+        }
+    }
+
+    // Decode the texture if it's not already decoded
+    if (!pTex) {
+        // Can only decode textures where the texture window is a power of two in size (so it can be masked) and isn't too big.
+        // Include the bits which pick out a texel within a VRAM pixel in the 'x' mask.
+        const uint16_t texelsPerPixel = (texFmt == TexFmt::Bpp4) ? 4 : 2;
+        const uint16_t xMask = core.texWinXMask | (texelsPerPixel - 1);
+        const uint16_t yMask = core.texWinYMask;
+        const uint32_t numTexels = ((uint32_t) xMask + 1) * ((uint32_t) yMask + 1);
+
+        if (((xMask & (xMask + 1)) != 0) || ((yMask & (yMask + 1)) != 0) || (numTexels > MAX_DECODED_TEX_TEXELS))
+            return;
+
+        // Replace the least recently used texture, first doing any deferred draws if all the textures are in use by them
+        pTex = findReplaceableDecodedTex(cache);
+
+        if (!pTex) {
+            flushDeferredDraws(core);
+            pTex = findReplaceableDecodedTex(cache);
+        }
+
+        ASSERT(pTex);
+        DecodedTex& tex = *pTex;
+        tex.key = key;
+        tex.xMask = xMask;
+        tex.yMask = yMask;
+        tex.rowShift = 0;
+
+        while ((1u << tex.rowShift) <= xMask) {
+            tex.rowShift++;
+        }
+
+        tex.clutLx = core.clutCacheX;
+        tex.clutRx = core.clutCacheX + ((texFmt == TexFmt::Bpp4) ? 16 : 256) - 1;
+        tex.clutY = core.clutCacheY;
+
+        if (texFmt == TexFmt::Bpp4) {
+            getDecodedTexSrcArea<TexFmt::Bpp4>(core, tex);
+        } else {
+            getDecodedTexSrcArea<TexFmt::Bpp8>(core, tex);
+        }
+
+        // Don't use the texture if it's inside the draw area, since drawing might change it while it's in use.
+        // If queued deferred draws might change the texture then do those first, so the texture is decoded from up to date VRAM.
+        tex.bValid = false;
+
+        if (isDecodedTexInArea(tex, core.drawAreaLx, core.drawAreaRx, core.drawAreaTy, core.drawAreaBy))
+            return;
+
+        if (isDecodedTexInQueuedDrawArea(core, tex)) {
+            flushDeferredDraws(core);
+        }
+
+        tex.texels.resize(numTexels);
+
+        if (texFmt == TexFmt::Bpp4) {
+            decodeTexels<TexFmt::Bpp4>(core, tex);
+        } else {
+            decodeTexels<TexFmt::Bpp8>(core, tex);
+        }
+
+        tex.bValid = true;
+    }
+
+    // Use this texture and if deferring draws then make sure it doesn't get replaced until they are done
+    pTex->lastUseNum = ++cache.useNum;
+    pTex->bPinned |= (core.pDeferredDraws != nullptr);
+    cache.pLastTex = pTex;
+    core.pDecodedTex = pTex;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Holds a copy of the details of the decoded texture being used for drawing, if any.
+// Drawing code keeps this in a local since it would otherwise need to re-read these details through the GPU core after every VRAM write.
+//------------------------------------------------------------------------------------------------------------------------------------------
+struct DecodedTexView {
+    const Color16*  pTexels;    // The decoded texels or null if there is no decoded texture
+    uint16_t        xMask;      // Masks to wrap texture coordinates to the decoded texture
+    uint16_t        yMask;
+    uint32_t        rowShift;   // Shift to get the index of a row of texels
+};
+
+static DecodedTexView getDecodedTexView(const Core& core) noexcept {
+    const DecodedTex* const pTex = core.pDecodedTex;
+
+    if (!pTex)
+        return DecodedTexView{ nullptr, 0, 0, 0 };
+
+    return DecodedTexView{ pTex->texels.data(), pTex->xMask, pTex->yMask, pTex->rowShift };
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Read a texture using the given texture coordinate within the current texture page and window.
+// Reads from the given decoded texture if there is one, otherwise falls back to reading from VRAM.
+//------------------------------------------------------------------------------------------------------------------------------------------
+template <TexFmt TexFmt>
+static Color16 readTexel(
+    const Core& core,
+    [[maybe_unused]] const DecodedTexView& decodedTex,
+    const uint16_t coordX,
+    const uint16_t coordY
+) noexcept {
+    // Note: 16-bit textures are never decoded since there is no CLUT lookup to save
+    if constexpr (TexFmt != TexFmt::Bpp16) {
+        if (decodedTex.pTexels)
+            return decodedTex.pTexels[((uint32_t)(coordY & decodedTex.yMask) << decodedTex.rowShift) | (coordX & decodedTex.xMask)];
+    }
+
+    return readTexel<TexFmt>(core, coordX, coordY);
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Tells if the given pixel is inside the drawing area
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -229,6 +763,9 @@ bool isPixelInDrawArea(const Core& core, const uint16_t x, const uint16_t y) noe
 // Clears a region of VRAM to the specified color
 //------------------------------------------------------------------------------------------------------------------------------------------
 void clearRect(Core& core, const Color16 color, const uint16_t x, const uint16_t y, const uint16_t w, const uint16_t h) noexcept {
+    // Any queued draws must be done first so that the clear happens after them
+    flushDeferredDraws(core);
+
     // Caching GPU state
     uint16_t* const pRam = core.pRam;
     const uint16_t ramPixelW = core.ramPixelW;
@@ -245,6 +782,11 @@ void clearRect(Core& core, const Color16 color, const uint16_t x, const uint16_t
             pRam[(uint32_t) curY * ramPixelW + curX] = color;
         }
     }
+
+    // Discard anything cached from the area cleared
+    if ((begX < endX) && (begY < endY)) {
+        invalidateVramCaches(core, begX, endX - 1, begY, endY - 1);
+    }
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -275,61 +817,516 @@ template Color16 color24FTo16<DrawMode::ColoredBlended>(const Color24F colorIn)
 template Color16 color24FTo16<DrawMode::Textured>(const Color24F colorIn) noexcept;
 template Color16 color24FTo16<DrawMode::TexturedBlended>(const Color24F colorIn) noexcept;
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Lookup table for modulating 5-bit color components by 8-bit multipliers in 1.7 fixed point format, indexed by [multiplier][component].
+// The table is built at compile time and is small enough (8 KiB) to stay in the CPU cache while drawing.
+//------------------------------------------------------------------------------------------------------------------------------------------
+struct ColorMulTable {
+    uint8_t values[256][32];
+};
+
+static constexpr ColorMulTable makeColorMulTable() noexcept {
+    ColorMulTable table = {};
+
+    for (uint32_t mul = 0; mul < 256; ++mul) {
+        for (uint32_t comp = 0; comp < 32; ++comp) {
+            table.values[mul][comp] = (uint8_t) std::min((comp * mul) >> 7, 31u);
+        }
+    }
+
+    return table;
+}
+
+static constexpr ColorMulTable gColorMulTable = makeColorMulTable();
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Modulate a 16-bit color by a 24-bit one where the components are in 1.7 fixed point format
 //------------------------------------------------------------------------------------------------------------------------------------------
 Color16 colorMul(const Color16 color1, const Color24F color2) noexcept {
     return Color16::make(
-        (uint16_t) std::min((color1.getR() * color2.comp.r) >> 7, 31),
-        (uint16_t) std::min((color1.getG() * color2.comp.g) >> 7, 31),
-        (uint16_t) std::min((color1.getB() * color2.comp.b) >> 7, 31),
+        gColorMulTable.values[color2.comp.r][color1.getR()],
+        gColorMulTable.values[color2.comp.g][color1.getG()],
+        gColorMulTable.values[color2.comp.b][color1.getB()],
         color1.getT()
     );
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Blend the two colors (foreground and background) and return the result
+// Helpers for blending: these operate on all 3 RGB555 components of a color at once, treating each component as a 5-bit lane in the word.
+// The 'T' (semi-transparency) bit of the inputs must be zero.
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+// Masks covering bit 4 (the highest bit) and bits 1-4 of every color component
+static constexpr uint32_t RGB555_COMP_HIGH_BITS = 0x4210;
+static constexpr uint32_t RGB555_COMP_UPPER_4_BITS = 0x7BDE;
+
+// Computes '(a + b) / 2' (rounded down) for each component.
+// The bits shared by both values are counted once in full and the differing bits are halved, so no component ever overflows into the next.
+static uint32_t rgb555Average(const uint32_t a, const uint32_t b) noexcept {
+    return (a & b) + (((a ^ b) & RGB555_COMP_UPPER_4_BITS) >> 1);
+}
+
+// Computes 'min(a + b, 31)' for each component.
+// A component overflows if the highest bit of its average is set, which tells which components to saturate.
+static uint32_t rgb555AddSat(const uint32_t a, const uint32_t b) noexcept {
+    const uint32_t overflowBits = (rgb555Average(a, b) & RGB555_COMP_HIGH_BITS) << 1;
+    const uint32_t sum = a + b - overflowBits;
+    return sum | (overflowBits - (overflowBits >> 5));
+}
+
+// Computes 'max(a - b, 0)' for each component.
+// 'a - b' is positive for a component if 'a + (31 - b)' overflows, and the components where it is not are zeroed before subtracting.
+static uint32_t rgb555SubSat(const uint32_t a, const uint32_t b) noexcept {
+    const uint32_t positiveBits = (rgb555Average(a, b ^ 0x7FFF) & RGB555_COMP_HIGH_BITS) << 1;
+    const uint32_t positiveMask = positiveBits - (positiveBits >> 5);
+    return (a & positiveMask) - (b & positiveMask);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Blend the two colors (foreground and background) and return the result.
+// The 'T' (semi-transparency) bit of the foreground color is preserved.
 //------------------------------------------------------------------------------------------------------------------------------------------
 Color16 colorBlend(const Color16 bg, const Color16 fg, const BlendMode mode) noexcept {
-    Color16 result = fg;
+    const uint32_t bgRgb = bg.bits & 0x7FFFu;
+    const uint32_t fgRgb = fg.bits & 0x7FFFu;
+    uint32_t resultRgb;
 
     switch (mode) {
-        case BlendMode::Alpha50:
-            result.setRGB(
-                (uint16_t)((bg.getR() + fg.getR()) >> 1),
-                (uint16_t)((bg.getG() + fg.getG()) >> 1),
-                (uint16_t)((bg.getB() + fg.getB()) >> 1)
-            );
-            break;
+        case BlendMode::Alpha50:    resultRgb = rgb555Average(bgRgb, fgRgb);                    break;
+        case BlendMode::Add:        resultRgb = rgb555AddSat(bgRgb, fgRgb);                     break;
+        case BlendMode::Subtract:   resultRgb = rgb555SubSat(bgRgb, fgRgb);                     break;
+        case BlendMode::Add25:      resultRgb = rgb555AddSat(bgRgb, (fgRgb >> 2) & 0x1CE7u);    break;      // Note: mask keeps the 3 bits of each component that remain after the shift
 
-        case BlendMode::Add:
-            result.setRGB(
-                (uint16_t) std::min(bg.getR() + fg.getR(), 31),
-                (uint16_t) std::min(bg.getG() + fg.getG(), 31),
-                (uint16_t) std::min(bg.getB() + fg.getB(), 31)
-            );
+        default:
+            resultRgb = fgRgb;
             break;
+    }
 
-        case BlendMode::Subtract:
-            result.setRGB(
-                (uint16_t) std::max((int32_t) bg.getR() - (int32_t) fg.getR(), 0),
-                (uint16_t) std::max((int32_t) bg.getG() - (int32_t) fg.getG(), 0),
-                (uint16_t) std::max((int32_t) bg.getB() - (int32_t) fg.getB(), 0)
-            );
-            break;
+    return Color16((uint16_t)((fg.bits & 0x8000u) | resultRgb));
+}
 
-        case BlendMode::Add25:
-            result.setRGB(
-                (uint16_t) std::min(bg.getR() + (fg.getR() >> 2), 31),
-                (uint16_t) std::min(bg.getG() + (fg.getG() >> 2), 31),
-                (uint16_t) std::min(bg.getB() + (fg.getB() >> 2), 31)
-            );
+#if GPU_USE_SSE2
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// SSE2 versions of the color modulation and blending functions above.
+// These operate on 8 colors at once (one per 16-bit lane) and give exactly the same results as the scalar versions.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static constexpr int32_t SIMD_NUM_PIXELS = 8;
+
+static inline __m128i rgb555AverageX8(const __m128i a, const __m128i b) noexcept {
+    const __m128i upper4Bits = _mm_set1_epi16((int16_t) RGB555_COMP_UPPER_4_BITS);
+    return _mm_add_epi16(_mm_and_si128(a, b), _mm_srli_epi16(_mm_and_si128(_mm_xor_si128(a, b), upper4Bits), 1));
+}
+
+static inline __m128i rgb555AddSatX8(const __m128i a, const __m128i b) noexcept {
+    const __m128i highBits = _mm_set1_epi16((int16_t) RGB555_COMP_HIGH_BITS);
+    const __m128i overflowBits = _mm_slli_epi16(_mm_and_si128(rgb555AverageX8(a, b), highBits), 1);
+    const __m128i sum = _mm_sub_epi16(_mm_add_epi16(a, b), overflowBits);
+    return _mm_or_si128(sum, _mm_sub_epi16(overflowBits, _mm_srli_epi16(overflowBits, 5)));
+}
+
+static inline __m128i rgb555SubSatX8(const __m128i a, const __m128i b) noexcept {
+    const __m128i highBits = _mm_set1_epi16((int16_t) RGB555_COMP_HIGH_BITS);
+    const __m128i positiveBits = _mm_slli_epi16(_mm_and_si128(rgb555AverageX8(a, _mm_xor_si128(b, _mm_set1_epi16(0x7FFF))), highBits), 1);
+    const __m128i positiveMask = _mm_sub_epi16(positiveBits, _mm_srli_epi16(positiveBits, 5));
+    return _mm_sub_epi16(_mm_and_si128(a, positiveMask), _mm_and_si128(b, positiveMask));
+}
+
+// Modulates 8 colors by the same 1.7 fixed point multipliers, which are given in 16-bit lanes.
+// Note: the products never exceed 31 * 255, so they always fit in a 16-bit lane.
+static inline __m128i colorMulX8(const __m128i colors, const __m128i mulR, const __m128i mulG, const __m128i mulB) noexcept {
+    const __m128i compMask = _mm_set1_epi16(0x1F);
+    const __m128i r = _mm_min_epi16(_mm_srli_epi16(_mm_mullo_epi16(_mm_and_si128(colors, compMask), mulR), 7), compMask);
+    const __m128i g = _mm_min_epi16(_mm_srli_epi16(_mm_mullo_epi16(_mm_and_si128(_mm_srli_epi16(colors, 5), compMask), mulG), 7), compMask);
+    const __m128i b = _mm_min_epi16(_mm_srli_epi16(_mm_mullo_epi16(_mm_and_si128(_mm_srli_epi16(colors, 10), compMask), mulB), 7), compMask);
+    const __m128i t = _mm_and_si128(colors, _mm_set1_epi16((int16_t) 0x8000));
+    return _mm_or_si128(_mm_or_si128(r, _mm_slli_epi16(g, 5)), _mm_or_si128(_mm_slli_epi16(b, 10), t));
+}
+
+static inline __m128i colorBlendX8(const __m128i bg, const __m128i fg, const BlendMode mode) noexcept {
+    const __m128i rgbMask = _mm_set1_epi16(0x7FFF);
+    const __m128i bgRgb = _mm_and_si128(bg, rgbMask);
+    const __m128i fgRgb = _mm_and_si128(fg, rgbMask);
+    __m128i resultRgb;
+
+    switch (mode) {
+        case BlendMode::Alpha50:    resultRgb = rgb555AverageX8(bgRgb, fgRgb);                                                          break;
+        case BlendMode::Add:        resultRgb = rgb555AddSatX8(bgRgb, fgRgb);                                                           break;
+        case BlendMode::Subtract:   resultRgb = rgb555SubSatX8(bgRgb, fgRgb);                                                           break;
+        case BlendMode::Add25:      resultRgb = rgb555AddSatX8(bgRgb, _mm_and_si128(_mm_srli_epi16(fgRgb, 2), _mm_set1_epi16(0x1CE7)));  break;
+
+        default:
+            resultRgb = fgRgb;
             break;
     }
 
-    return result;
+    return _mm_or_si128(_mm_andnot_si128(rgbMask, fg), resultRgb);
+}
+
+#endif  // #if GPU_USE_SSE2
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Deferred draws: get the type and the queue for each type of primitive
+//------------------------------------------------------------------------------------------------------------------------------------------
+template <class PrimT>
+static constexpr DeferredPrimType getDeferredPrimType() noexcept {
+    if constexpr (std::is_same_v<PrimT, DrawRect>) {
+        return DeferredPrimType::Rect;
+    } else if constexpr (std::is_same_v<PrimT, DrawLine>) {
+        return DeferredPrimType::Line;
+    } else if constexpr (std::is_same_v<PrimT, DrawTriangle>) {
+        return DeferredPrimType::Triangle;
+    } else if constexpr (std::is_same_v<PrimT, DrawTriangleGouraud>) {
+        return DeferredPrimType::TriangleGouraud;
+    } else if constexpr (std::is_same_v<PrimT, DrawFloorRow>) {
+        return DeferredPrimType::FloorRow;
+    } else if constexpr (std::is_same_v<PrimT, DrawWallCol>) {
+        return DeferredPrimType::WallCol;
+    } else {
+        static_assert(std::is_same_v<PrimT, DrawWallColGouraud>);
+        return DeferredPrimType::WallColGouraud;
+    }
+}
+
+template <class PrimT>
+static std::vector<PrimT>& getDeferredPrims(DeferredDraws& deferred) noexcept {
+    if constexpr (std::is_same_v<PrimT, DrawRect>) {
+        return deferred.rects;
+    } else if constexpr (std::is_same_v<PrimT, DrawLine>) {
+        return deferred.lines;
+    } else if constexpr (std::is_same_v<PrimT, DrawTriangle>) {
+        return deferred.triangles;
+    } else if constexpr (std::is_same_v<PrimT, DrawTriangleGouraud>) {
+        return deferred.trianglesGouraud;
+    } else if constexpr (std::is_same_v<PrimT, DrawFloorRow>) {
+        return deferred.floorRows;
+    } else if constexpr (std::is_same_v<PrimT, DrawWallCol>) {
+        return deferred.wallCols;
+    } else {
+        static_assert(std::is_same_v<PrimT, DrawWallColGouraud>);
+        return deferred.wallColsGouraud;
+    }
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Deferred draws: figure out the range of VRAM rows that a primitive might write to ('ty' > 'by' if nothing is written).
+// Also returns whether drawing the primitive immediately would update the CLUT cache, since that must be done when the draw is queued.
+// Note: these checks MUST match the early outs and clipping done by each of the drawing functions!
+//------------------------------------------------------------------------------------------------------------------------------------------
+template <DrawMode DrawMode>
+static bool getDeferredDrawRows(const Core& core, const DrawRect& rect, int32_t& ty, int32_t& by) noexcept {
+    ty = 1;
+    by = 0;
+
+    if ((rect.w >= 1024) || (rect.h >= 512))
+        return false;
+
+    const int16_t rectTy = rect.y + core.drawOffsetY;
+    ty = std::max((int32_t) rectTy, (int32_t) core.drawAreaTy);
+    by = std::min((int32_t) rectTy + rect.h, core.drawAreaBy + 1) - 1;
+
+    constexpr bool bTextured = ((DrawMode == DrawMode::Textured) || (DrawMode == DrawMode::TexturedBlended));
+    return (bTextured && ((core.texFmt == TexFmt::Bpp4) || (core.texFmt == TexFmt::Bpp8)));
+}
+
+template <DrawMode DrawMode>
+static bool getDeferredDrawRows(const Core& core, const DrawLine& line, int32_t& ty, int32_t& by) noexcept {
+    ty = 1;
+    by = 0;
+
+    const int32_t lineY1 = line.y1 + core.drawOffsetY;
+    const int32_t lineY2 = line.y2 + core.drawOffsetY;
+    const int32_t absDx = std::abs((int32_t) line.x2 - line.x1);
+    const int32_t absDy = std::abs(lineY2 - lineY1);
+
+    if ((absDx >= 1024) || (absDy >= 512))
+        return false;
+
+    // Line pixel coordinates get truncated to 16-bits, so if the line goes outside of that range then assume any row might be touched
+    const int32_t minY = std::min(lineY1, lineY2);
+    const int32_t maxY = std::max(lineY1, lineY2);
+
+    if ((minY < 0) || (maxY > UINT16_MAX)) {
+        ty = core.drawAreaTy;
+        by = core.drawAreaBy;
+    } else {
+        ty = std::max(minY, (int32_t) core.drawAreaTy);
+        by = std::min(maxY, (int32_t) core.drawAreaBy);
+    }
+
+    return false;
+}
+
+static bool getDeferredTriangleRows(
+    const Core& core,
+    const int32_t p1x,
+    const int32_t p1y,
+    const int32_t p2x,
+    const int32_t p2y,
+    const int32_t p3x,
+    const int32_t p3y,
+    int32_t& ty,
+    int32_t& by
+) noexcept {
+    ty = 1;
+    by = 0;
+
+    const int32_t minX = std::min(std::min(p1x, p2x), p3x);
+    const int32_t minY = std::min(std::min(p1y, p2y), p3y);
+    const int32_t maxX = std::max(std::max(p1x, p2x), p3x);
+    const int32_t maxY = std::max(std::max(p1y, p2y), p3y);
+
+    if ((maxX - minX >= 1024) || (maxY - minY >= 512))
+        return false;
+
+    ty = std::max((int32_t) core.drawAreaTy, minY + core.drawOffsetY);
+    by = std::min((int32_t) core.drawAreaBy, maxY + core.drawOffsetY - 1);
+    return true;
+}
+
+template <DrawMode DrawMode>
+static bool getDeferredDrawRows(const Core& core, const DrawTriangle& tri, int32_t& ty, int32_t& by) noexcept {
+    const bool bDrawn = getDeferredTriangleRows(core, tri.x1, tri.y1, tri.x2, tri.y2, tri.x3, tri.y3, ty, by);
+    constexpr bool bTextured = ((DrawMode == DrawMode::Textured) || (DrawMode == DrawMode::TexturedBlended));
+    return (bDrawn && bTextured && ((core.texFmt == TexFmt::Bpp4) || (core.texFmt == TexFmt::Bpp8)));
+}
+
+template <DrawMode DrawMode>
+static bool getDeferredDrawRows(const Core& core, const DrawTriangleGouraud& tri, int32_t& ty, int32_t& by) noexcept {
+    const bool bDrawn = getDeferredTriangleRows(core, tri.x1, tri.y1, tri.x2, tri.y2, tri.x3, tri.y3, ty, by);
+    constexpr bool bTextured = ((DrawMode == DrawMode::Textured) || (DrawMode == DrawMode::TexturedBlended));
+    return (bDrawn && bTextured && ((core.texFmt == TexFmt::Bpp4) || (core.texFmt == TexFmt::Bpp8)));
+}
+
+template <DrawMode DrawMode>
+static bool getDeferredDrawRows(const Core& core, const DrawFloorRow& row, int32_t& ty, int32_t& by) noexcept {
+    ty = 1;
+    by = 0;
+
+    const int32_t xrange = std::abs((int32_t) row.x2 - row.x1);
+    const int32_t py = row.y + core.drawOffsetY;
+
+    if ((xrange >= 1024) || (py < core.drawAreaTy) || (py > core.drawAreaBy))
+        return false;
+
+    ty = py;
+    by = py;
+
+    constexpr bool bTextured = ((DrawMode == DrawMode::Textured) || (DrawMode == DrawMode::TexturedBlended));
+    return bTextured;
+}
+
+static bool getDeferredWallColRows(const Core& core, const int32_t x, const int32_t y1, const int32_t y2, int32_t& ty, int32_t& by) noexcept {
+    ty = 1;
+    by = 0;
+
+    const int32_t px = x + core.drawOffsetX;
+    const int32_t minY = std::min(y1, y2) + core.drawOffsetY;
+    const int32_t maxY = std::max(y1, y2) + core.drawOffsetY;
+
+    if ((maxY - minY >= 512) || (px < core.drawAreaLx) || (px > core.drawAreaRx))
+        return false;
+
+    ty = std::max((int32_t) core.drawAreaTy, minY);
+    by = std::min((int32_t) core.drawAreaBy, maxY - 1);
+    return true;
+}
+
+template <DrawMode DrawMode>
+static bool getDeferredDrawRows(const Core& core, const DrawWallCol& col, int32_t& ty, int32_t& by) noexcept {
+    const bool bDrawn = getDeferredWallColRows(core, col.x, col.y1, col.y2, ty, by);
+    constexpr bool bTextured = ((DrawMode == DrawMode::Textured) || (DrawMode == DrawMode::TexturedBlended));
+    return (bDrawn && bTextured);
+}
+
+template <DrawMode DrawMode>
+static bool getDeferredDrawRows(const Core& core, const DrawWallColGouraud& col, int32_t& ty, int32_t& by) noexcept {
+    const bool bDrawn = getDeferredWallColRows(core, col.x, col.y1, col.y2, ty, by);
+    constexpr bool bTextured = ((DrawMode == DrawMode::Textured) || (DrawMode == DrawMode::TexturedBlended));
+    return (bDrawn && bTextured);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Deferred draws: saves a copy of the current CLUT cache for queued draws to use
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void saveDeferredClut(const Core& core, DeferredDraws& deferred) noexcept {
+    DeferredClut& clut = deferred.cluts.emplace_back();
+    std::memcpy(clut.colors, core.clutCache, sizeof(clut.colors));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Deferred draws: queues the given primitive to be drawn later when the queue is flushed
+//------------------------------------------------------------------------------------------------------------------------------------------
+template <DrawMode DrawMode, class PrimT>
+static void deferDraw(Core& core, const PrimT& prim) noexcept {
+    sanityCheckGpuDrawState(core);
+
+    // Figure out which rows the primitive touches and do any update to the CLUT cache and decoded texture that immediate drawing would do
+    int32_t ty, by;
+    bool bClutCacheReloaded = false;
+
+    if (getDeferredDrawRows<DrawMode>(core, prim, ty, by)) {
+        bClutCacheReloaded = (
+            (core.clutCacheX != core.clutX) ||
+            (core.clutCacheY != core.clutY) ||
+            (core.clutCacheFmt != core.texFmt)
+        );
+
+        // Note: Doom floor rows and wall columns always draw with an 8bpp texture format
+        constexpr bool bIs8bppPrim = (
+            std::is_same_v<PrimT, DrawFloorRow> ||
+            std::is_same_v<PrimT, DrawWallCol> ||
+            std::is_same_v<PrimT, DrawWallColGouraud>
+        );
+
+        updateClutCache(core);
+        bindDecodedTex(core, (bIs8bppPrim) ? TexFmt::Bpp8 : core.texFmt);
+    } else {
+        core.pDecodedTex = nullptr;
+    }
+
+    // The CLUT cache as it is before the first queued draw might get used by that draw, so save it.
+    // Also save a copy of the cache if it was reloaded. Note: this is done after binding the decoded texture since that might flush draws.
+    DeferredDraws& deferred = *core.pDeferredDraws;
+
+    if (deferred.cmds.empty()) {
+        deferred.cluts.clear();
+        deferred.states.clear();
+        saveDeferredClut(core, deferred);
+    } else if (bClutCacheReloaded) {
+        saveDeferredClut(core, deferred);
+    }
+
+    // Don't bother queueing the draw if it won't write any pixels
+    if (ty > by)
+        return;
+
+    // Snapshot the GPU state used for drawing, unless it's the same as the previous snapshot
+    DeferredState state;
+    state.drawOffsetX = core.drawOffsetX;
+    state.drawOffsetY = core.drawOffsetY;
+    state.drawAreaLx = core.drawAreaLx;
+    state.drawAreaRx = core.drawAreaRx;
+    state.drawAreaTy = core.drawAreaTy;
+    state.drawAreaBy = core.drawAreaBy;
+    state.texPageX = core.texPageX;
+    state.texPageY = core.texPageY;
+    state.texPageXMask = core.texPageXMask;
+    state.texPageYMask = core.texPageYMask;
+    state.texWinX = core.texWinX;
+    state.texWinY = core.texWinY;
+    state.texWinXMask = core.texWinXMask;
+    state.texWinYMask = core.texWinYMask;
+    state.clutX = core.clutX;
+    state.clutY = core.clutY;
+    state.clutCacheX = core.clutCacheX;
+    state.clutCacheY = core.clutCacheY;
+    state.blendMode = core.blendMode;
+    state.texFmt = core.texFmt;
+    state.clutCacheFmt = core.clutCacheFmt;
+    state.bDisableMasking = core.bDisableMasking;
+    state.clutCacheIdx = (uint32_t) deferred.cluts.size() - 1;
+    state.decodedTexIdx = (core.pDecodedTex) ? (uint32_t)(core.pDecodedTex - core.pTexCache->texes) : NO_DECODED_TEX;
+
+    if (deferred.states.empty() || (std::memcmp(&deferred.states.back(), &state, sizeof(DeferredState)) != 0)) {
+        deferred.states.push_back(state);
+    }
+
+    // Queue the draw and flush if the queue is getting too big
+    std::vector<PrimT>& prims = getDeferredPrims<PrimT>(deferred);
+    prims.push_back(prim);
+
+    DeferredCmd& cmd = deferred.cmds.emplace_back();
+    cmd.primType = getDeferredPrimType<PrimT>();
+    cmd.drawMode = DrawMode;
+    cmd.ty = (uint16_t) ty;
+    cmd.by = (uint16_t) by;
+    cmd.primIdx = (uint32_t) prims.size() - 1;
+    cmd.stateIdx = (uint32_t) deferred.states.size() - 1;
+
+    if (deferred.cmds.size() >= MAX_DEFERRED_CMDS) {
+        flushDeferredDraws(core);
+    }
+}
+
+#if GPU_USE_SSE2
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tells if the rows of a textured rectangle covering the given area of VRAM can be drawn 8 pixels at a time using SSE2.
+// Pixels are written to VRAM directly so rows must not wrap around, and since the texels for each group of 8 pixels are all read before
+// any are written the texture page must not overlap the area being drawn. The area is inclusive of the left and top coordinates only.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool canDrawTexturedRectRowsX8(const Core& core, const int32_t lx, const int32_t rx, const int32_t ty, const int32_t by) noexcept {
+    if ((rx - lx < SIMD_NUM_PIXELS) || (ty >= by))
+        return false;
+
+    if ((rx - 1 > core.ramXMask) || (by - 1 > core.ramYMask))
+        return false;
+
+    const int32_t texPageRx = core.texPageX + core.texPageXMask;
+    const int32_t texPageBy = core.texPageY + core.texPageYMask;
+
+    if ((texPageRx > core.ramXMask) || (texPageBy > core.ramYMask))
+        return false;
+
+    return (!doVramRectsOverlap(
+        core.texPageX, (uint16_t) texPageRx, core.texPageY, (uint16_t) texPageBy,
+        (uint16_t) lx, (uint16_t)(rx - 1), (uint16_t) ty, (uint16_t)(by - 1)
+    ));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Draws as much of a row of a textured rectangle as possible 8 pixels at a time, using SSE2.
+// Returns the number of pixels drawn: the caller must draw the remaining pixels (fewer than 8) one at a time.
+//------------------------------------------------------------------------------------------------------------------------------------------
+template <DrawMode DrawMode, TexFmt TexFmt>
+static int32_t drawTexturedRectRowX8(
+    const Core& core,
+    const DecodedTexView& decodedTex,
+    uint16_t* const pDstPixels,
+    const int32_t numPixels,
+    const uint16_t begU,
+    const uint16_t v,
+    const Color24F color,
+    const bool bEnableMasking
+) noexcept {
+    const __m128i mulR = _mm_set1_epi16(color.comp.r);
+    const __m128i mulG = _mm_set1_epi16(color.comp.g);
+    const __m128i mulB = _mm_set1_epi16(color.comp.b);
+    const __m128i maskingMask = _mm_set1_epi16((bEnableMasking) ? -1 : 0);
+    const BlendMode blendMode = core.blendMode;
+
+    alignas(16) uint16_t texels[SIMD_NUM_PIXELS];
+    int32_t numDrawn = 0;
+
+    for (; numDrawn + SIMD_NUM_PIXELS <= numPixels; numDrawn += SIMD_NUM_PIXELS) {
+        // Read the texels for this group of pixels
+        const uint16_t u = (uint16_t)(begU + numDrawn);
+
+        for (int32_t i = 0; i < SIMD_NUM_PIXELS; ++i) {
+            texels[i] = readTexel<TexFmt>(core, decodedTex, (uint16_t)(u + i), v);
+        }
+
+        // Modulate and blend, then keep the background for transparent pixels if masking is enabled
+        const __m128i fgColors = _mm_load_si128((const __m128i*) texels);
+        __m128i* const pDst = (__m128i*)(pDstPixels + numDrawn);
+        const __m128i bgColors = _mm_loadu_si128(pDst);
+        __m128i outColors = colorMulX8(fgColors, mulR, mulG, mulB);
+
+        if constexpr (DrawMode == DrawMode::TexturedBlended) {
+            outColors = colorBlendX8(bgColors, outColors, blendMode);
+        }
+
+        const __m128i skipMask = _mm_and_si128(_mm_cmpeq_epi16(fgColors, _mm_setzero_si128()), maskingMask);
+        outColors = _mm_or_si128(_mm_and_si128(skipMask, bgColors), _mm_andnot_si128(skipMask, outColors));
+        _mm_storeu_si128(pDst, outColors);
+    }
+
+    return numDrawn;
+}
+
+#endif  // #if GPU_USE_SSE2
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Drawing a rectangle - internal implementation tailored to each texture format
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -345,9 +1342,12 @@ static void draw(Core& core, const DrawRect& rect) noexcept {
     if constexpr ((DrawMode == DrawMode::Textured) || (DrawMode == DrawMode::TexturedBlended)) {
         if constexpr ((TexFmt == TexFmt::Bpp4) || (TexFmt == TexFmt::Bpp8)) {
             updateClutCache(core);
+            bindDecodedTex(core, TexFmt);
         }
     }
 
+    [[maybe_unused]] const DecodedTexView decodedTex = getDecodedTexView(core);
+
     // Clip the rectangle bounds to the draw area and generate adjustments to the uv coords if that happens.
     // Note must translate the rectangle according to the draw offset too...
     const int16_t rectTx = rect.x + core.drawOffsetX;
@@ -368,8 +1368,14 @@ static void draw(Core& core, const DrawRect& rect) noexcept {
         begY = core.drawAreaTy;
     }
 
+    // Deferred draws: also clip to the band of rows being drawn
+    if (begY < core.bandTy) {
+        topLeftV += core.bandTy - begY;
+        begY = (int16_t) core.bandTy;
+    }
+
     const int16_t endX = (int16_t) std::min((int) rectTx + rect.w, core.drawAreaRx + 1);
-    const int16_t endY = (int16_t) std::min((int) rectTy + rect.h, core.drawAreaBy + 1);
+    const int16_t endY = (int16_t) std::min(std::min((int) rectTy + rect.h, core.drawAreaBy + 1), core.bandBy + 1);
 
     // If we are in flat colored mode then decide the foreground color for every pixel in the rectangle
     const Color24F rectColor = rect.color;
@@ -379,18 +1385,42 @@ static void draw(Core& core, const DrawRect& rect) noexcept {
         fgColor = color24FTo16<DrawMode>(rectColor);
     }
 
-    // Fill in the rectangle pixels
+    // Fill in the rectangle pixels.
+    // If possible then most of each row of a textured rectangle is drawn 8 pixels at a time, and the rest one pixel at a time.
     const bool bEnableMasking = (!core.bDisableMasking);
     uint16_t curV = topLeftV;
 
+    #if GPU_USE_SSE2
+        [[maybe_unused]] bool bDrawRowsX8 = false;
+
+        if constexpr ((DrawMode == DrawMode::Textured) || (DrawMode == DrawMode::TexturedBlended)) {
+            bDrawRowsX8 = canDrawTexturedRectRowsX8(core, begX, endX, begY, endY);
+        }
+    #endif
+
     for (int16_t y = begY; y < endY; ++y, ++curV) {
         uint16_t curU = topLeftU;
+        int16_t x = begX;
 
-        for (int16_t x = begX; x < endX; ++x, ++curU) {
+        #if GPU_USE_SSE2
+            if constexpr ((DrawMode == DrawMode::Textured) || (DrawMode == DrawMode::TexturedBlended)) {
+                if (bDrawRowsX8) {
+                    uint16_t* const pDstRow = core.pRam + ((uint32_t) y * core.ramPixelW + (uint32_t) x);
+                    const int32_t numDrawn = drawTexturedRectRowX8<DrawMode, TexFmt>(
+                        core, decodedTex, pDstRow, endX - x, curU, curV, rectColor, bEnableMasking
+                    );
+
+                    x = (int16_t)(x + numDrawn);
+                    curU = (uint16_t)(curU + numDrawn);
+                }
+            }
+        #endif
+
+        for (; x < endX; ++x, ++curU) {
             // Get the foreground color for the rectangle pixel if the rectangle is textured.
             // If the pixel is transparent and masking is enabled then also skip it, otherwise modulate it by the primitive color...
             if constexpr ((DrawMode == DrawMode::Textured) || (DrawMode == DrawMode::TexturedBlended)) {
-                fgColor = readTexel<TexFmt>(core, curU, curV);
+                fgColor = readTexel<TexFmt>(core, decodedTex, curU, curV);
 
                 if ((fgColor.bits == 0) && bEnableMasking)
                     continue;
@@ -398,14 +1428,17 @@ static void draw(Core& core, const DrawRect& rect) noexcept {
                 fgColor = colorMul(fgColor, rectColor);
             }
 
-            // Do blending with the background if that is enabled
+            // Do blending with the background if that is enabled.
+            // Blend into a separate color so the constant foreground color of flat colored primitives doesn't get changed for the next pixel.
+            Color16 outColor = fgColor;
+
             if constexpr ((DrawMode == DrawMode::ColoredBlended) || (DrawMode == DrawMode::TexturedBlended)) {
                 const Color16 bgColor = vramReadU16(core, x, y);
-                fgColor = colorBlend(bgColor, fgColor, core.blendMode);
+                outColor = colorBlend(bgColor, fgColor, core.blendMode);
             }
 
             // Save the output pixel
-            vramWriteU16(core, x, y, fgColor);
+            vramWriteU16(core, x, y, outColor);
         }
     }
 }
@@ -415,6 +1448,15 @@ static void draw(Core& core, const DrawRect& rect) noexcept {
 //------------------------------------------------------------------------------------------------------------------------------------------
 template <DrawMode DrawMode>
 void draw(Core& core, const DrawRect& rect) noexcept {
+    // Drawing might overwrite any decoded textures in the draw area, so make sure those are discarded
+    invalidateDecodedTexesInDrawArea(core);
+
+    // Queue the draw for later instead if deferring draws
+    if (core.pDeferredDraws) {
+        deferDraw<DrawMode>(core, rect);
+        return;
+    }
+
     if (core.texFmt == TexFmt::Bpp4) {
         draw<DrawMode, TexFmt::Bpp4>(core, rect);
     } else if (core.texFmt == TexFmt::Bpp8) {
@@ -436,6 +1478,15 @@ template void draw<DrawMode::TexturedBlended>(Core& core, const DrawRect& rect)
 //------------------------------------------------------------------------------------------------------------------------------------------
 template <DrawMode DrawMode>
 void draw(Core& core, const DrawLine& line) noexcept {
+    // Drawing might overwrite any decoded textures in the draw area, so make sure those are discarded
+    invalidateDecodedTexesInDrawArea(core);
+
+    // Queue the draw for later instead if deferring draws
+    if (core.pDeferredDraws) {
+        deferDraw<DrawMode>(core, line);
+        return;
+    }
+
     sanityCheckGpuDrawState(core);
 
     // Translate the line by the drawing offset
@@ -504,7 +1555,7 @@ void draw(Core& core, const DrawLine& line) noexcept {
         const uint16_t x = (uint16_t)((bLineIsSteep) ? b : a);
         const uint16_t y = (uint16_t)((bLineIsSteep) ? a : b);
 
-        if (isPixelInDrawArea(core, x, y)) {
+        if (isPixelInDrawArea(core, x, y) && (y >= core.bandTy) && (y <= core.bandBy)) {
             const Color16 color = (bBlend) ? colorBlend(vramReadU16(core, x, y), lineColor, blendMode) : lineColor;
             vramWriteU16(core, x, y, color);
         }
@@ -566,9 +1617,12 @@ static void draw(Core& core, const DrawTriangle& triangle) noexcept {
     if constexpr ((DrawMode == DrawMode::Textured) || (DrawMode == DrawMode::TexturedBlended)) {
         if constexpr ((TexFmt == TexFmt::Bpp4) || (TexFmt == TexFmt::Bpp8)) {
             updateClutCache(core);
+            bindDecodedTex(core, TexFmt);
         }
     }
 
+    [[maybe_unused]] const DecodedTexView decodedTex = getDecodedTexView(core);
+
     // Precompute the edge deltas used in the edge functions
     const float p1xf = (float) p1x;     const float p1yf = (float) p1y;
     const float p2xf = (float) p2x;     const float p2yf = (float) p2y;
@@ -611,11 +1665,22 @@ static void draw(Core& core, const DrawTriangle& triangle) noexcept {
     const float triArea = row_ef1 + row_ef2 + row_ef3;
     const float weightNormalize = 1.0f / triArea;
 
+    // Deferred draws: only draw the rows in the current band.
+    // Rows above the band are stepped over one at a time so the edge functions come out exactly the same as when drawing every row.
+    const int32_t bandTy = std::max(ty, (int32_t) core.bandTy);
+    const int32_t bandBy = std::min(by, (int32_t) core.bandBy);
+
+    for (int32_t y = ty; y < bandTy; ++y) {
+        row_ef1 -= e1dx;
+        row_ef2 -= e2dx;
+        row_ef3 -= e3dx;
+    }
+
     // Process each pixel in the rectangular region being rasterized
-    uint16_t* pDstPixelRow = core.pRam + ty * core.ramPixelW;
+    uint16_t* pDstPixelRow = core.pRam + bandTy * core.ramPixelW;
     const bool bEnableMasking = (!core.bDisableMasking);
 
-    for (int32_t y = ty; y <= by; ++y, pDstPixelRow += core.ramPixelW) {
+    for (int32_t y = bandTy; y <= bandBy; ++y, pDstPixelRow += core.ramPixelW) {
         // The edge function for the current column starts off as the edge function for the row
         float col_ef1 = row_ef1;
         float col_ef2 = row_ef2;
@@ -649,7 +1714,7 @@ static void draw(Core& core, const DrawTriangle& triangle) noexcept {
             // Get the foreground color for the triangle pixel if the triangle is textured.
             // If the pixel is transparent and masking is enabled then also skip it, otherwise modulate it by the primitive color...
             if constexpr ((DrawMode == DrawMode::Textured) || (DrawMode == DrawMode::TexturedBlended)) {
-                fgColor = readTexel<TexFmt>(core, u, v);
+                fgColor = readTexel<TexFmt>(core, decodedTex, u, v);
 
                 if ((fgColor.bits == 0) && bEnableMasking)
                     continue;
@@ -657,14 +1722,17 @@ static void draw(Core& core, const DrawTriangle& triangle) noexcept {
                 fgColor = colorMul(fgColor, triangleColor);
             }
 
-            // Do blending with the background if that is enabled
+            // Do blending with the background if that is enabled.
+            // Blend into a separate color so the constant foreground color of flat colored primitives doesn't get changed for the next pixel.
+            Color16 outColor = fgColor;
+
             if constexpr ((DrawMode == DrawMode::ColoredBlended) || (DrawMode == DrawMode::TexturedBlended)) {
                 const Color16 bgColor = pDstPixelRow[x];
-                fgColor = colorBlend(bgColor, fgColor, core.blendMode);
+                outColor = colorBlend(bgColor, fgColor, core.blendMode);
             }
 
             // Save the output pixel
-            pDstPixelRow[x] = fgColor;
+            pDstPixelRow[x] = outColor;
         }
 
         // Step the edge function onto the next row
@@ -679,6 +1747,15 @@ static void draw(Core& core, const DrawTriangle& triangle) noexcept {
 //------------------------------------------------------------------------------------------------------------------------------------------
 template <DrawMode DrawMode>
 void draw(Core& core, const DrawTriangle& triangle) noexcept {
+    // Drawing might overwrite any decoded textures in the draw area, so make sure those are discarded
+    invalidateDecodedTexesInDrawArea(core);
+
+    // Queue the draw for later instead if deferring draws
+    if (core.pDeferredDraws) {
+        deferDraw<DrawMode>(core, triangle);
+        return;
+    }
+
     if (core.texFmt == TexFmt::Bpp4) {
         draw<DrawMode, TexFmt::Bpp4>(core, triangle);
     } else if (core.texFmt == TexFmt::Bpp8) {
@@ -740,9 +1817,12 @@ static void draw(Core& core, const DrawTriangleGouraud& triangle) noexcept {
     if constexpr ((DrawMode == DrawMode::Textured) || (DrawMode == DrawMode::TexturedBlended)) {
         if constexpr ((TexFmt == TexFmt::Bpp4) || (TexFmt == TexFmt::Bpp8)) {
             updateClutCache(core);
+            bindDecodedTex(core, TexFmt);
         }
     }
 
+    [[maybe_unused]] const DecodedTexView decodedTex = getDecodedTexView(core);
+
     // Precompute the edge deltas used in the edge functions
     const float p1xf = (float) p1x;     const float p1yf = (float) p1y;
     const float p2xf = (float) p2x;     const float p2yf = (float) p2y;
@@ -788,11 +1868,22 @@ static void draw(Core& core, const DrawTriangleGouraud& triangle) noexcept {
     const float triArea = row_ef1 + row_ef2 + row_ef3;
     const float weightNormalize = 1.0f / triArea;
 
+    // Deferred draws: only draw the rows in the current band.
+    // Rows above the band are stepped over one at a time so the edge functions come out exactly the same as when drawing every row.
+    const int32_t bandTy = std::max(ty, (int32_t) core.bandTy);
+    const int32_t bandBy = std::min(by, (int32_t) core.bandBy);
+
+    for (int32_t y = ty; y < bandTy; ++y) {
+        row_ef1 -= e1dx;
+        row_ef2 -= e2dx;
+        row_ef3 -= e3dx;
+    }
+
     // Process each pixel in the rectangular region being rasterized
-    uint16_t* pDstPixelRow = core.pRam + ty * core.ramPixelW;
+    uint16_t* pDstPixelRow = core.pRam + bandTy * core.ramPixelW;
     const bool bEnableMasking = (!core.bDisableMasking);
 
-    for (int32_t y = ty; y <= by; ++y, pDstPixelRow += core.ramPixelW) {
+    for (int32_t y = bandTy; y <= bandBy; ++y, pDstPixelRow += core.ramPixelW) {
         // The edge function for the current column starts off as the edge function for the row
         float col_ef1 = row_ef1;
         float col_ef2 = row_ef2;
@@ -834,7 +1925,7 @@ static void draw(Core& core, const DrawTriangleGouraud& triangle) noexcept {
 
             if constexpr ((DrawMode == DrawMode::Textured) || (DrawMode == DrawMode::TexturedBlended)) {
                 // Doing texture mapping in addition to gouraud shading
-                fgColor = readTexel<TexFmt>(core, u, v);
+                fgColor = readTexel<TexFmt>(core, decodedTex, u, v);
 
                 if ((fgColor.bits == 0) && bEnableMasking)
                     continue;
@@ -873,6 +1964,15 @@ static void draw(Core& core, const DrawTriangleGouraud& triangle) noexcept {
 //------------------------------------------------------------------------------------------------------------------------------------------
 template <DrawMode DrawMode>
 void draw(Core& core, const DrawTriangleGouraud& triangle) noexcept {
+    // Drawing might overwrite any decoded textures in the draw area, so make sure those are discarded
+    invalidateDecodedTexesInDrawArea(core);
+
+    // Queue the draw for later instead if deferring draws
+    if (core.pDeferredDraws) {
+        deferDraw<DrawMode>(core, triangle);
+        return;
+    }
+
     if (core.texFmt == TexFmt::Bpp4) {
         draw<DrawMode, TexFmt::Bpp4>(core, triangle);
     } else if (core.texFmt == TexFmt::Bpp8) {
@@ -895,6 +1995,15 @@ template void draw<DrawMode::TexturedBlended>(Core& core, const DrawTriangleGour
 //------------------------------------------------------------------------------------------------------------------------------------------
 template <DrawMode DrawMode>
 void draw(Core& core, const DrawFloorRow& row) noexcept {
+    // Drawing might overwrite any decoded textures in the draw area, so make sure those are discarded
+    invalidateDecodedTexesInDrawArea(core);
+
+    // Queue the draw for later instead if deferring draws
+    if (core.pDeferredDraws) {
+        deferDraw<DrawMode>(core, row);
+        return;
+    }
+
     sanityCheckGpuDrawState(core);
 
     // Apply the draw offset to the row coordinates
@@ -931,9 +2040,14 @@ void draw(Core& core, const DrawFloorRow& row) noexcept {
     if ((xrange >= 1024) || (py < core.drawAreaTy) || (py > core.drawAreaBy))
         return;
 
+    // Deferred draws: skip if the row is outside the band of rows being drawn
+    if ((py < core.bandTy) || (py > core.bandBy))
+        return;
+
     // If we're going to draw textured and with a CLUT make sure it is up to date
     if constexpr ((DrawMode == DrawMode::Textured) || (DrawMode == DrawMode::TexturedBlended)) {
         updateClutCache(core);
+        bindDecodedTex(core, TexFmt::Bpp8);
     }
 
     // If we are in flat colored mode then decide the foreground color for every pixel in the row
@@ -950,6 +2064,20 @@ void draw(Core& core, const DrawFloorRow& row) noexcept {
     const uint16_t vramYMask = core.ramYMask;
     uint16_t* const pVram = core.pRam;
 
+    // Cache the texture window, texture page and blend settings also.
+    // Since we write to VRAM through a 16-bit pointer the compiler must otherwise assume these fields could change with every pixel written,
+    // and would be forced to re-read all of them from the GPU core for every pixel in the span.
+    const uint16_t texWinX = core.texWinX;
+    const uint16_t texWinY = core.texWinY;
+    const uint16_t texWinXMask = core.texWinXMask;
+    const uint16_t texWinYMask = core.texWinYMask;
+    const uint16_t texPageX = core.texPageX;
+    const uint16_t texPageY = core.texPageY;
+    const uint16_t texPageXMask = core.texPageXMask;
+    const uint16_t texPageYMask = core.texPageYMask;
+    const BlendMode blendMode = core.blendMode;
+    [[maybe_unused]] const DecodedTexView decodedTex = getDecodedTexView(core);
+
     // Process each pixel in the line being rasterized
     float t = (0.5f + (float) lx - minX) * tStep;
     float tinv = 1.0f - t;
@@ -969,21 +2097,26 @@ void draw(Core& core, const DrawFloorRow& row) noexcept {
         // Get the foreground color for the row pixel if the row is textured.
         // If the pixel is transparent and masking is enabled then also skip it, otherwise modulate it by the primitive color...
         if constexpr ((DrawMode == DrawMode::Textured) || (DrawMode == DrawMode::TexturedBlended)) {
-            // Figure out the VRAM coordinates to read the VRAM pixel from
-            uint16_t vramX = u & core.texWinXMask;
-            uint16_t vramY = v & core.texWinYMask;
-            vramX += core.texWinX;
-            vramY += core.texWinY;
-            vramX /= 2;
-            vramX &= core.texPageXMask;
-            vramY &= core.texPageYMask;
-            vramX += core.texPageX;
-            vramY += core.texPageY;
-
-            // Read the VRAM pixel and lookup the actual texel using the clut index
-            const uint16_t vramPixel = pVram[(vramY & vramYMask) * vramPixelW + (vramX & vramXMask)];
-            const uint16_t clutIdx = (vramPixel >> ((u & 1) * 8)) & 0xFF;
-            fgColor = core.clutCache[clutIdx];
+            if (decodedTex.pTexels) {
+                // Fast path: read the texel directly from the decoded texture
+                fgColor = decodedTex.pTexels[((uint32_t)(v & decodedTex.yMask) << decodedTex.rowShift) | (u & decodedTex.xMask)];
+            } else {
+                // Figure out the VRAM coordinates to read the VRAM pixel from
+                uint16_t vramX = u & texWinXMask;
+                uint16_t vramY = v & texWinYMask;
+                vramX += texWinX;
+                vramY += texWinY;
+                vramX /= 2;
+                vramX &= texPageXMask;
+                vramY &= texPageYMask;
+                vramX += texPageX;
+                vramY += texPageY;
+
+                // Read the VRAM pixel and lookup the actual texel using the clut index
+                const uint16_t vramPixel = pVram[(vramY & vramYMask) * vramPixelW + (vramX & vramXMask)];
+                const uint16_t clutIdx = (vramPixel >> ((u & 1) * 8)) & 0xFF;
+                fgColor = core.clutCache[clutIdx];
+            }
 
             if ((fgColor.bits == 0) && bEnableMasking)
                 continue;
@@ -991,16 +2124,18 @@ void draw(Core& core, const DrawFloorRow& row) noexcept {
             fgColor = colorMul(fgColor, rowColor);
         }
 
-        // Do blending with the background if that is enabled
+        // Do blending with the background if that is enabled.
+        // Blend into a separate color so the constant foreground color of flat colored primitives doesn't get changed for the next pixel.
         uint16_t& dstPixel = pDstPixelRow[x];
+        Color16 outColor = fgColor;
 
         if constexpr ((DrawMode == DrawMode::ColoredBlended) || (DrawMode == DrawMode::TexturedBlended)) {
             const Color16 bgColor = dstPixel;
-            fgColor = colorBlend(bgColor, fgColor, core.blendMode);
+            outColor = colorBlend(bgColor, fgColor, blendMode);
         }
 
         // Save the output pixel and step to the next pixel
-        dstPixel = fgColor;
+        dstPixel = outColor;
     }
 }
 
@@ -1016,6 +2151,15 @@ template void draw<DrawMode::TexturedBlended>(Core& core, const DrawFloorRow& ro
 //------------------------------------------------------------------------------------------------------------------------------------------
 template <DrawMode DrawMode>
 void draw(Core& core, const DrawWallCol& col) noexcept {
+    // Drawing might overwrite any decoded textures in the draw area, so make sure those are discarded
+    invalidateDecodedTexesInDrawArea(core);
+
+    // Queue the draw for later instead if deferring draws
+    if (core.pDeferredDraws) {
+        deferDraw<DrawMode>(core, col);
+        return;
+    }
+
     sanityCheckGpuDrawState(core);
 
     // Apply the draw offset to the column coordinates
@@ -1053,6 +2197,7 @@ void draw(Core& core, const DrawWallCol& col) noexcept {
     // If we're going to draw textured and with a CLUT make sure it is up to date
     if constexpr ((DrawMode == DrawMode::Textured) || (DrawMode == DrawMode::TexturedBlended)) {
         updateClutCache(core);
+        bindDecodedTex(core, TexFmt::Bpp8);
     }
 
     // If we are in flat colored mode then decide the foreground color for every pixel in the column
@@ -1080,14 +2225,39 @@ void draw(Core& core, const DrawWallCol& col) noexcept {
         texVramX &= core.ramXMask;
     }
 
+    // Which byte of the VRAM pixel holds the CLUT index is also constant since 'u' is constant.
+    // Likewise which column of the decoded texture to read from, if there is a decoded texture.
+    const uint16_t clutIdxShift = (uint16_t)((u & 1) * 8);
+    [[maybe_unused]] const DecodedTexView decodedTex = getDecodedTexView(core);
+    [[maybe_unused]] const Color16* const pDecodedTexCol = (decodedTex.pTexels) ? decodedTex.pTexels + (u & decodedTex.xMask) : nullptr;
+
+    // Cache the texture window, texture page and blend settings also.
+    // Since we write to VRAM through a 16-bit pointer the compiler must otherwise assume these fields could change with every pixel written.
+    const uint16_t texWinY = core.texWinY;
+    const uint16_t texWinYMask = core.texWinYMask;
+    const uint16_t texPageY = core.texPageY;
+    const uint16_t texPageYMask = core.texPageYMask;
+    const uint16_t vramYMask = core.ramYMask;
+    const BlendMode blendMode = core.blendMode;
+
     // Process each pixel in the line being rasterized
     float t = (0.5f + (float) ty - minY) * tStep;
     float tinv = 1.0f - t;
 
+    // Deferred draws: only draw the rows in the current band.
+    // Rows above the band are stepped over one at a time so the interpolation comes out exactly the same as when drawing every row.
+    const int32_t bandTy = std::max(ty, (int32_t) core.bandTy);
+    const int32_t bandBy = std::min(by, (int32_t) core.bandBy);
+
+    for (int32_t y = ty; y < bandTy; ++y) {
+        t += tStep;
+        tinv -= tStep;
+    }
+
     uint16_t* pDstPixelCol = core.pRam + px;
     const bool bEnableMasking = (!core.bDisableMasking);
 
-    for (int32_t y = ty; y <= by; ++y) {
+    for (int32_t y = bandTy; y <= bandBy; ++y) {
         // Compute the 'v' texture coordinate to use
         const uint16_t v = (uint16_t)(v1 * tinv + v2 * t);
 
@@ -1098,17 +2268,22 @@ void draw(Core& core, const DrawWallCol& col) noexcept {
         // Get the foreground color for the column pixel if the column is textured.
         // If the pixel is transparent and masking is enabled then also skip it, otherwise modulate it by the primitive color...
         if constexpr ((DrawMode == DrawMode::Textured) || (DrawMode == DrawMode::TexturedBlended)) {
-            // Figure out the VRAM coordinates to read the VRAM pixel from
-            uint16_t vramY = v & core.texWinYMask;
-            vramY += core.texWinY;
-            vramY &= core.texPageYMask;
-            vramY += core.texPageY;
-            vramY &= core.ramYMask;
-
-            // Read the VRAM pixel and lookup the actual texel using the clut index
-            const uint16_t vramPixel = pVram[vramY * vramPixelW + texVramX];
-            const uint16_t clutIdx = (vramPixel >> ((u & 1) * 8)) & 0xFF;
-            fgColor = core.clutCache[clutIdx];
+            if (pDecodedTexCol) {
+                // Fast path: read the texel directly from the decoded texture
+                fgColor = pDecodedTexCol[(uint32_t)(v & decodedTex.yMask) << decodedTex.rowShift];
+            } else {
+                // Figure out the VRAM coordinates to read the VRAM pixel from
+                uint16_t vramY = v & texWinYMask;
+                vramY += texWinY;
+                vramY &= texPageYMask;
+                vramY += texPageY;
+                vramY &= vramYMask;
+
+                // Read the VRAM pixel and lookup the actual texel using the clut index
+                const uint16_t vramPixel = pVram[vramY * vramPixelW + texVramX];
+                const uint16_t clutIdx = (vramPixel >> clutIdxShift) & 0xFF;
+                fgColor = core.clutCache[clutIdx];
+            }
 
             if ((fgColor.bits == 0) && bEnableMasking)
                 continue;
@@ -1116,16 +2291,18 @@ void draw(Core& core, const DrawWallCol& col) noexcept {
             fgColor = colorMul(fgColor, colColor);
         }
 
-        // Do blending with the background if that is enabled
+        // Do blending with the background if that is enabled.
+        // Blend into a separate color so the constant foreground color of flat colored primitives doesn't get changed for the next pixel.
         uint16_t& dstPixel = pDstPixelCol[y * vramPixelW];
+        Color16 outColor = fgColor;
 
         if constexpr ((DrawMode == DrawMode::ColoredBlended) || (DrawMode == DrawMode::TexturedBlended)) {
             const Color16 bgColor = dstPixel;
-            fgColor = colorBlend(bgColor, fgColor, core.blendMode);
+            outColor = colorBlend(bgColor, fgColor, blendMode);
         }
 
         // Save the output pixel and step to the next pixel
-        dstPixel = fgColor;
+        dstPixel = outColor;
     }
 }
 
@@ -1141,6 +2318,15 @@ template void draw<DrawMode::TexturedBlended>(Core& core, const DrawWallCol& col
 //------------------------------------------------------------------------------------------------------------------------------------------
 template <DrawMode DrawMode>
 void draw(Core& core, const DrawWallColGouraud& col) noexcept {
+    // Drawing might overwrite any decoded textures in the draw area, so make sure those are discarded
+    invalidateDecodedTexesInDrawArea(core);
+
+    // Queue the draw for later instead if deferring draws
+    if (core.pDeferredDraws) {
+        deferDraw<DrawMode>(core, col);
+        return;
+    }
+
     sanityCheckGpuDrawState(core);
 
     // Apply the draw offset to the column coordinates
@@ -1187,6 +2373,7 @@ void draw(Core& core, const DrawWallColGouraud& col) noexcept {
     // If we're going to draw textured and with a CLUT make sure it is up to date
     if constexpr ((DrawMode == DrawMode::Textured) || (DrawMode == DrawMode::TexturedBlended)) {
         updateClutCache(core);
+        bindDecodedTex(core, TexFmt::Bpp8);
     }
 
     // Cache some GPU RAM related params
@@ -1206,14 +2393,39 @@ void draw(Core& core, const DrawWallColGouraud& col) noexcept {
         texVramX &= core.ramXMask;
     }
 
+    // Which byte of the VRAM pixel holds the CLUT index is also constant since 'u' is constant.
+    // Likewise which column of the decoded texture to read from, if there is a decoded texture.
+    const uint16_t clutIdxShift = (uint16_t)((u & 1) * 8);
+    [[maybe_unused]] const DecodedTexView decodedTex = getDecodedTexView(core);
+    [[maybe_unused]] const Color16* const pDecodedTexCol = (decodedTex.pTexels) ? decodedTex.pTexels + (u & decodedTex.xMask) : nullptr;
+
+    // Cache the texture window, texture page and blend settings also.
+    // Since we write to VRAM through a 16-bit pointer the compiler must otherwise assume these fields could change with every pixel written.
+    const uint16_t texWinY = core.texWinY;
+    const uint16_t texWinYMask = core.texWinYMask;
+    const uint16_t texPageY = core.texPageY;
+    const uint16_t texPageYMask = core.texPageYMask;
+    const uint16_t vramYMask = core.ramYMask;
+    const BlendMode blendMode = core.blendMode;
+
     // Process each pixel in the line being rasterized
     float t = (0.5f + (float) ty - minY) * tStep;
     float tInv = 1.0f - t;
 
+    // Deferred draws: only draw the rows in the current band.
+    // Rows above the band are stepped over one at a time so the interpolation comes out exactly the same as when drawing every row.
+    const int32_t bandTy = std::max(ty, (int32_t) core.bandTy);
+    const int32_t bandBy = std::min(by, (int32_t) core.bandBy);
+
+    for (int32_t y = ty; y < bandTy; ++y) {
+        t += tStep;
+        tInv -= tStep;
+    }
+
     uint16_t* pDstPixelCol = core.pRam + px;
     const bool bEnableMasking = (!core.bDisableMasking);
 
-    for (int32_t y = ty; y <= by; ++y) {
+    for (int32_t y = bandTy; y <= bandBy; ++y) {
         // Compute the 'v' texture coordinate to use
         const uint16_t v = (uint16_t)(v1 * tInv + v2 * t);
 
@@ -1232,18 +2444,23 @@ void draw(Core& core, const DrawWallColGouraud& col) noexcept {
         Color16 fgColor;
 
         if constexpr ((DrawMode == DrawMode::Textured) || (DrawMode == DrawMode::TexturedBlended)) {
-            // Doing texture mapping in addition to gouraud shading.
-            // Figure out the VRAM coordinates to read the VRAM pixel from.
-            uint16_t vramY = v & core.texWinYMask;
-            vramY += core.texWinY;
-            vramY &= core.texPageYMask;
-            vramY += core.texPageY;
-            vramY &= core.ramYMask;
-
-            // Read the VRAM pixel and lookup the actual texel using the clut index
-            const uint16_t vramPixel = pVram[vramY * vramPixelW + texVramX];
-            const uint16_t clutIdx = (vramPixel >> ((u & 1) * 8)) & 0xFF;
-            fgColor = core.clutCache[clutIdx];
+            // Doing texture mapping in addition to gouraud shading
+            if (pDecodedTexCol) {
+                // Fast path: read the texel directly from the decoded texture
+                fgColor = pDecodedTexCol[(uint32_t)(v & decodedTex.yMask) << decodedTex.rowShift];
+            } else {
+                // Figure out the VRAM coordinates to read the VRAM pixel from
+                uint16_t vramY = v & texWinYMask;
+                vramY += texWinY;
+                vramY &= texPageYMask;
+                vramY += texPageY;
+                vramY &= vramYMask;
+
+                // Read the VRAM pixel and lookup the actual texel using the clut index
+                const uint16_t vramPixel = pVram[vramY * vramPixelW + texVramX];
+                const uint16_t clutIdx = (vramPixel >> clutIdxShift) & 0xFF;
+                fgColor = core.clutCache[clutIdx];
+            }
 
             if ((fgColor.bits == 0) && bEnableMasking)
                 continue;
@@ -1264,7 +2481,7 @@ void draw(Core& core, const DrawWallColGouraud& col) noexcept {
 
         if constexpr ((DrawMode == DrawMode::ColoredBlended) || (DrawMode == DrawMode::TexturedBlended)) {
             const Color16 bgColor = dstPixel;
-            fgColor = colorBlend(bgColor, fgColor, core.blendMode);
+            fgColor = colorBlend(bgColor, fgColor, blendMode);
         }
 
         // Save the output pixel and step to the next pixel
@@ -1278,4 +2495,198 @@ template void draw<DrawMode::ColoredBlended>(Core& core, const DrawWallColGourau
 template void draw<DrawMode::Textured>(Core& core, const DrawWallColGouraud& col) noexcept;
 template void draw<DrawMode::TexturedBlended>(Core& core, const DrawWallColGouraud& col) noexcept;
 
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Deferred draws: draws a queued primitive using the draw mode saved for it
+//------------------------------------------------------------------------------------------------------------------------------------------
+template <class PrimT>
+static void drawDeferredPrim(Core& core, const DrawMode drawMode, const PrimT& prim) noexcept {
+    if constexpr (std::is_same_v<PrimT, DrawLine>) {
+        // Lines cannot be textured
+        if (drawMode == DrawMode::ColoredBlended) {
+            draw<DrawMode::ColoredBlended>(core, prim);
+        } else {
+            ASSERT(drawMode == DrawMode::Colored);
+            draw<DrawMode::Colored>(core, prim);
+        }
+    } else {
+        switch (drawMode) {
+            case DrawMode::Colored:             draw<DrawMode::Colored>(core, prim);            break;
+            case DrawMode::ColoredBlended:      draw<DrawMode::ColoredBlended>(core, prim);     break;
+            case DrawMode::Textured:            draw<DrawMode::Textured>(core, prim);           break;
+            case DrawMode::TexturedBlended:     draw<DrawMode::TexturedBlended>(core, prim);    break;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Deferred draws: a job which does all the queued draws touching one band of rows.
+// Each band draws using its own copy of the GPU core which is restricted to the rows in the band, so bands can be drawn in parallel.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void drawDeferredBand(const uint32_t bandIdx, void* const pUserData) noexcept {
+    ASSERT(pUserData);
+    const DeferredDraws& deferred = *(const DeferredDraws*) pUserData;
+
+    const TexCache* const pTexCache = deferred.pFlushingCore->pTexCache;
+
+    Core core = *deferred.pFlushingCore;
+    core.pDeferredDraws = nullptr;
+    core.pTexCache = nullptr;
+    core.bandTy = (uint16_t)(deferred.bandsTy + (int32_t) bandIdx * deferred.bandH);
+    core.bandBy = (uint16_t)(core.bandTy + deferred.bandH - 1);
+
+    uint32_t curStateIdx = UINT32_MAX;
+    uint32_t curClutIdx = UINT32_MAX;
+
+    for (const uint32_t cmdIdx : deferred.bandCmdIndexes[bandIdx]) {
+        const DeferredCmd& cmd = deferred.cmds[cmdIdx];
+
+        // Restore the GPU state that the draw was queued with, if it's different to the previous draw
+        if (cmd.stateIdx != curStateIdx) {
+            const DeferredState& state = deferred.states[cmd.stateIdx];
+            curStateIdx = cmd.stateIdx;
+
+            core.drawOffsetX = state.drawOffsetX;
+            core.drawOffsetY = state.drawOffsetY;
+            core.drawAreaLx = state.drawAreaLx;
+            core.drawAreaRx = state.drawAreaRx;
+            core.drawAreaTy = state.drawAreaTy;
+            core.drawAreaBy = state.drawAreaBy;
+            core.texPageX = state.texPageX;
+            core.texPageY = state.texPageY;
+            core.texPageXMask = state.texPageXMask;
+            core.texPageYMask = state.texPageYMask;
+            core.texWinX = state.texWinX;
+            core.texWinY = state.texWinY;
+            core.texWinXMask = state.texWinXMask;
+            core.texWinYMask = state.texWinYMask;
+            core.clutX = state.clutX;
+            core.clutY = state.clutY;
+            core.clutCacheX = state.clutCacheX;
+            core.clutCacheY = state.clutCacheY;
+            core.blendMode = state.blendMode;
+            core.texFmt = state.texFmt;
+            core.clutCacheFmt = state.clutCacheFmt;
+            core.bDisableMasking = state.bDisableMasking;
+            core.pDecodedTex = (state.decodedTexIdx != NO_DECODED_TEX) ? &pTexCache->texes[state.decodedTexIdx] : nullptr;
+
+            if (state.clutCacheIdx != curClutIdx) {
+                std::memcpy(core.clutCache, deferred.cluts[state.clutCacheIdx].colors, sizeof(core.clutCache));
+                curClutIdx = state.clutCacheIdx;
+            }
+        }
+
+        // Do the draw
+        switch (cmd.primType) {
+            case DeferredPrimType::Rect:                drawDeferredPrim(core, cmd.drawMode, deferred.rects[cmd.primIdx]);              break;
+            case DeferredPrimType::Line:                drawDeferredPrim(core, cmd.drawMode, deferred.lines[cmd.primIdx]);              break;
+            case DeferredPrimType::Triangle:            drawDeferredPrim(core, cmd.drawMode, deferred.triangles[cmd.primIdx]);          break;
+            case DeferredPrimType::TriangleGouraud:     drawDeferredPrim(core, cmd.drawMode, deferred.trianglesGouraud[cmd.primIdx]);   break;
+            case DeferredPrimType::FloorRow:            drawDeferredPrim(core, cmd.drawMode, deferred.floorRows[cmd.primIdx]);          break;
+            case DeferredPrimType::WallCol:             drawDeferredPrim(core, cmd.drawMode, deferred.wallCols[cmd.primIdx]);           break;
+            case DeferredPrimType::WallColGouraud:      drawDeferredPrim(core, cmd.drawMode, deferred.wallColsGouraud[cmd.primIdx]);    break;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Turns on deferred drawing for the given core.
+// Draws are queued up instead of being done immediately and are rasterized in parallel when flushed, by splitting up the rows being drawn
+// to into (at most) the given number of bands. Draws are done in their original order within each band, so the output is exactly the same
+// as drawing immediately. The given function is used to run the jobs which draw each band.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void enableDeferredDraws(Core& core, const RunJobsFunc runJobs, const uint32_t numBands) noexcept {
+    ASSERT(runJobs);
+    ASSERT(numBands > 0);
+
+    if (core.pDeferredDraws) {
+        flushDeferredDraws(core);
+    } else {
+        core.pDeferredDraws = new DeferredDraws();
+    }
+
+    core.pDeferredDraws->runJobs = runJobs;
+    core.pDeferredDraws->maxBands = numBands;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Does any pending deferred draws and goes back to drawing immediately
+//------------------------------------------------------------------------------------------------------------------------------------------
+void disableDeferredDraws(Core& core) noexcept {
+    flushDeferredDraws(core);
+    delete core.pDeferredDraws;
+    core.pDeferredDraws = nullptr;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Does all pending deferred draws.
+// This must be called before accessing VRAM directly, for example before displaying the framebuffer or uploading textures.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void flushDeferredDraws(Core& core) noexcept {
+    DeferredDraws* const pDeferred = core.pDeferredDraws;
+
+    if ((!pDeferred) || pDeferred->cmds.empty())
+        return;
+
+    // Figure out the range of rows being drawn to and split it up into bands of equal height
+    DeferredDraws& deferred = *pDeferred;
+    int32_t drawTy = INT32_MAX;
+    int32_t drawBy = INT32_MIN;
+
+    for (const DeferredCmd& cmd : deferred.cmds) {
+        drawTy = std::min(drawTy, (int32_t) cmd.ty);
+        drawBy = std::max(drawBy, (int32_t) cmd.by);
+    }
+
+    const int32_t numRows = drawBy - drawTy + 1;
+    const int32_t bandH = std::max((numRows + (int32_t) deferred.maxBands - 1) / (int32_t) deferred.maxBands, MIN_DEFERRED_BAND_H);
+    const uint32_t numBands = (uint32_t)((numRows + bandH - 1) / bandH);
+
+    // Bin the draws into every band they touch, keeping them in order
+    if (deferred.bandCmdIndexes.size() < numBands) {
+        deferred.bandCmdIndexes.resize(numBands);
+    }
+
+    for (uint32_t bandIdx = 0; bandIdx < numBands; ++bandIdx) {
+        deferred.bandCmdIndexes[bandIdx].clear();
+    }
+
+    const uint32_t numCmds = (uint32_t) deferred.cmds.size();
+
+    for (uint32_t cmdIdx = 0; cmdIdx < numCmds; ++cmdIdx) {
+        const DeferredCmd& cmd = deferred.cmds[cmdIdx];
+        const uint32_t startBand = (uint32_t)(((int32_t) cmd.ty - drawTy) / bandH);
+        const uint32_t endBand = (uint32_t)(((int32_t) cmd.by - drawTy) / bandH);
+
+        for (uint32_t bandIdx = startBand; bandIdx <= endBand; ++bandIdx) {
+            deferred.bandCmdIndexes[bandIdx].push_back(cmdIdx);
+        }
+    }
+
+    // Draw all the bands and clear the queue
+    deferred.pFlushingCore = &core;
+    deferred.bandsTy = drawTy;
+    deferred.bandH = bandH;
+    deferred.runJobs(numBands, drawDeferredBand, &deferred);
+    deferred.pFlushingCore = nullptr;
+
+    deferred.cmds.clear();
+    deferred.states.clear();
+    deferred.cluts.clear();
+    deferred.rects.clear();
+    deferred.lines.clear();
+    deferred.triangles.clear();
+    deferred.trianglesGouraud.clear();
+    deferred.floorRows.clear();
+    deferred.wallCols.clear();
+    deferred.wallColsGouraud.clear();
+
+    // The decoded textures used by the draws can now be replaced
+    if (core.pTexCache) {
+        for (DecodedTex& tex : core.pTexCache->texes) {
+            tex.bPinned = false;
+        }
+    }
+}
+
 END_NAMESPACE(Gpu)
@@ -12,6 +12,7 @@
 // Simplifications made for this GPU include:
 //  (1) The removal of all links to an emulated PlayStation system, including DMA and interrupts etc.
 //  (2) All memory transfer stuff, status registers and I/O registers are removed, the host game can just access everything directly.
+//      After writing to VRAM directly the host must call 'invalidateVramCaches' however, so textures cached by the GPU are not stale.
 //  (3) This GPU does not concern itself with output format or video timings (PAL vs NTSC) - it just stores the VRAM region being displayed.
 //  (4) The output display format is assumed to be 15-bit color, 24-bit color is not supported.
 //  (5) Dithering is not supported, since Doom did not use this at all.
@@ -19,6 +20,7 @@
 //  (7) The GPU 'mask bit' for masking pixels is not supported, Doom did not use this.
 //  (8) X and Y flipping textures is not supported; original PS1 models did not have this anyway so games could not use it.
 //  (9) All rendering/command primitives are fed directly to the GPU and handled immediately - command buffers are not supported.
+//      The exception is the optional 'deferred draws' mode, where draws are queued up and later rasterized in parallel bands of rows.
 //  (10) Only rectangles, lines, triangles, and a few (newly added) Doom specific primitives are supported.
 //       Quads must be decomposed externally into triangles.
 //  (11) The full range of draw primitives exposed by the original LIBGPU is NOT provided, only the ones that Doom uses.
@@ -222,6 +224,18 @@ struct DrawWallColGouraud {
     Color24F    color2;     // Column point 2: color
 };
 
+//----------------------------------------------------------------------------------------------------------------------
+// Deferred drawing support.
+// The GPU does not depend on any particular thread pool, instead the host supplies a function which runs a batch of jobs.
+// The function must run the job function once for each job index given, possibly in parallel, and return once all jobs are done.
+//----------------------------------------------------------------------------------------------------------------------
+struct DecodedTex;
+struct DeferredDraws;
+struct TexCache;
+
+typedef void (*JobFunc)(const uint32_t jobIdx, void* const pUserData) noexcept;
+typedef void (*RunJobsFunc)(const uint32_t numJobs, const JobFunc jobFunc, void* const pUserData) noexcept;
+
 //----------------------------------------------------------------------------------------------------------------------
 // The GPU core/device itself
 //----------------------------------------------------------------------------------------------------------------------
@@ -254,12 +268,20 @@ struct Core {
     uint16_t        clutX;              // X position of the current CLUT/color-index table in 16-bit VRAM pixels (CLUT is arranged in a row at this location)
     uint16_t        clutY;              // Y position of the current CLUT/color-index table in 16-bit VRAM pixels (CLUT is arranged in a row at this location)
     bool            bDisableMasking;    // PSX GPU extension: disable pixel discard during texture mapping when all the texel bits are '0'?
+    uint16_t        bandTy;             // Deferred draws: restricts drawing to this band of VRAM rows (top Y, inclusive)
+    uint16_t        bandBy;             // Deferred draws: restricts drawing to this band of VRAM rows (bottom Y, inclusive)
+    DeferredDraws*  pDeferredDraws;     // If not null then draws are queued here rather than being done immediately
 
     // CLUT cache to speed up texture mapping and the settings it was last saved with
     TexFmt          clutCacheFmt;
     uint16_t        clutCacheX;
     uint16_t        clutCacheY;
     Color16         clutCache[256];
+
+    // Cache of textures decoded from VRAM to 16-bit colors (using the CLUT cache) to speed up texture mapping.
+    // Also the decoded texture being used by the current draw, if there is one.
+    TexCache*           pTexCache;
+    const DecodedTex*   pDecodedTex;
 };
 
 // Initializing and shutting down a core
@@ -275,6 +297,7 @@ Color16 readTexel(Core& core, const uint16_t coordX, const uint16_t coordY) noex
 void updateClutCache(Core& core) noexcept;
 bool isPixelInDrawArea(const Core& core, const uint16_t x, const uint16_t y) noexcept;
 void clearRect(Core& core, const Color16 color, const uint16_t x, const uint16_t y, const uint16_t w, const uint16_t h) noexcept;
+void invalidateVramCaches(Core& core, const uint16_t rectLx, const uint16_t rectRx, const uint16_t rectTy, const uint16_t rectBy) noexcept;
 
 // Color manipulation and conversion
 template <DrawMode DrawMode>
@@ -283,6 +306,12 @@ Color16 color24FTo16(const Color24F colorIn) noexcept;
 Color16 colorMul(const Color16 color1, const Color24F color2) noexcept;
 Color16 colorBlend(const Color16 bg, const Color16 fg, const BlendMode mode) noexcept;
 
+// Deferred drawing: queues up draws and later rasterizes them in parallel across bands of rows in the draw area.
+// While enabled, VRAM must not be accessed directly until pending draws are flushed, and textures & CLUTs must not be drawn to.
+void enableDeferredDraws(Core& core, const RunJobsFunc runJobs, const uint32_t numBands) noexcept;
+void disableDeferredDraws(Core& core) noexcept;
+void flushDeferredDraws(Core& core) noexcept;
+
 // Drawing functions: note that lines CANNOT be textured!
 template <DrawMode DrawMode>
 void draw(Core& core, const DrawRect& rect) noexcept;
@@ -150,6 +150,57 @@ static void decodeAdpcmBlock(Voice& voice, std::byte adpcmBlock[ADPCM_BLOCK_SIZE
     }
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Decode an ADPCM block located at the given address for the given voice, using the ADPCM block cache if available.
+// The results are always identical to calling 'decodeAdpcmBlock' directly.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void decodeAdpcmBlockCached(
+    Voice& voice,
+    std::byte adpcmBlock[ADPCM_BLOCK_SIZE],
+    const uint32_t addr8,
+    AdpcmCacheEntry* const pCache,
+    const uint32_t numCacheEntries
+) noexcept {
+    // If there is no cache then just decode directly
+    if (!pCache) {
+        decodeAdpcmBlock(voice, adpcmBlock);
+        return;
+    }
+
+    // The previous 2 samples which will be fed into the decoder, with the newest first
+    const Sample prevSamples[2] = {
+        voice.samples[Voice::SAMPLE_BUFFER_SIZE - 1],
+        voice.samples[Voice::SAMPLE_BUFFER_SIZE - 2],
+    };
+
+    // Note: ADPCM blocks are normally 16 byte aligned, hence discard the lowest address bit when choosing a cache entry
+    ASSERT((numCacheEntries & (numCacheEntries - 1)) == 0);
+    AdpcmCacheEntry& entry = pCache[(addr8 >> 1) & (numCacheEntries - 1)];
+
+    const bool bCacheHit = (
+        (entry.addr8 == addr8) &&
+        (std::memcmp(entry.adpcmBlock, adpcmBlock, ADPCM_BLOCK_SIZE) == 0) &&
+        (std::memcmp(entry.prevSamples, prevSamples, sizeof(prevSamples)) == 0)
+    );
+
+    if (bCacheHit) {
+        // Cache hit: do the same shuffling of the previous block's samples that 'decodeAdpcmBlock' does and copy in the decoded samples
+        static_assert(Voice::NUM_PREV_SAMPLES == 3);
+        voice.samples[0] = voice.samples[Voice::SAMPLE_BUFFER_SIZE - 3];
+        voice.samples[1] = voice.samples[Voice::SAMPLE_BUFFER_SIZE - 2];
+        voice.samples[2] = voice.samples[Voice::SAMPLE_BUFFER_SIZE - 1];
+        std::memcpy(voice.samples + Voice::NUM_PREV_SAMPLES, entry.samples, sizeof(entry.samples));
+    } else {
+        // Cache miss: decode and save the result
+        decodeAdpcmBlock(voice, adpcmBlock);
+
+        entry.addr8 = addr8;
+        std::memcpy(entry.adpcmBlock, adpcmBlock, ADPCM_BLOCK_SIZE);
+        std::memcpy(entry.prevSamples, prevSamples, sizeof(prevSamples));
+        std::memcpy(entry.samples, voice.samples + Voice::NUM_PREV_SAMPLES, sizeof(entry.samples));
+    }
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Get the next phase for a given envelope phase
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -340,6 +391,8 @@ static void stepVoice(
     Voice& voice,
     const std::byte* pRam,
     const uint32_t ramSize,
+    AdpcmCacheEntry* const pAdpcmCache,
+    const uint32_t numAdpcmCacheEntries,
     StereoSample& output,
     StereoSample& outputToReverb
 ) noexcept {
@@ -355,7 +408,7 @@ static void stepVoice(
     if (!voice.bSamplesLoaded) {
         const uint32_t samplesAddr = voice.adpcmCurAddr8 * 8;
         sramRead(pRam, ramSize, samplesAddr, ADPCM_BLOCK_SIZE, adpcmBlock);
-        decodeAdpcmBlock(voice, adpcmBlock);
+        decodeAdpcmBlockCached(voice, adpcmBlock, voice.adpcmCurAddr8, pAdpcmCache, numAdpcmCacheEntries);
         voice.bSamplesLoaded = true;
         bHandleAdpcmFlags = true;
     }
@@ -364,8 +417,11 @@ static void stepVoice(
     stepVoiceEnvelope(voice);
 
     // Get the interpolated sample for the voice, attenuate by the volume envelope and voice volume, and add to the output.
-    // Only bother doing this however if the voice is actually turned on.
-    if (!voice.bDisabled) {
+    // Only bother doing this however if the voice is actually turned on and audible: a zero envelope level or voice volume always produces
+    // a zeroed sample, and adding that to the output would not change anything.
+    const bool bVoiceSilent = ((voice.envLevel == 0) || ((voice.volume.left == 0) && (voice.volume.right == 0)));
+
+    if ((!voice.bDisabled) && (!bVoiceSilent)) {
         const Sample rawSample = getInterpolatedVoiceSample(voice);
         const Sample sampleEnvScaled = rawSample * voice.envLevel;
         const int16_t realVoiceVolL = (int16_t) std::clamp((int32_t) voice.volume.left * 2, INT16_MIN, +INT16_MAX);     // N.B: voice volume was divided by 2
@@ -434,13 +490,71 @@ static void stepVoices(
     const int32_t numVoices,
     const std::byte* pRam,
     const uint32_t ramSize,
+    AdpcmCacheEntry* const pAdpcmCache,
+    const uint32_t numAdpcmCacheEntries,
     StereoSample& output,
     StereoSample& outputToReverb
 ) noexcept {
     ASSERT(pVoices || (numVoices == 0));
 
     for (int32_t voiceIdx = 0; voiceIdx < numVoices; ++voiceIdx) {
-        stepVoice(pVoices[voiceIdx], pRam, ramSize, output, outputToReverb);
+        stepVoice(pVoices[voiceIdx], pRam, ramSize, pAdpcmCache, numAdpcmCacheEntries, output, outputToReverb);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Process/update all voices for a block of samples, accumulating into the given output buffers.
+// Each voice is run over the entire block before moving onto the next, which keeps it's state hot and avoids per-sample call overhead.
+// The accumulation order for each individual sample is still by voice index, so results are identical to calling 'stepVoices' repeatedly.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void stepVoicesBlock(
+    Voice* const pVoices,
+    const int32_t numVoices,
+    const std::byte* pRam,
+    const uint32_t ramSize,
+    AdpcmCacheEntry* const pAdpcmCache,
+    const uint32_t numAdpcmCacheEntries,
+    StereoSample* const pOutput,
+    StereoSample* const pOutputToReverb,
+    const uint32_t numSamples
+) noexcept {
+    ASSERT(pVoices || (numVoices == 0));
+    ASSERT(pOutput && pOutputToReverb);
+
+    // Gather up the voices that are playing at the start of the block: no other voices can start playing until the block is done.
+    // Voices that are switched off then only cost a single check per block, instead of a check per sample.
+    constexpr int32_t MAX_GATHERED_VOICES = 256;
+
+    uint32_t activeVoiceIdxs[MAX_GATHERED_VOICES];
+    int32_t numActiveVoices = 0;
+
+    for (int32_t voiceIdx = 0; voiceIdx < numVoices; ++voiceIdx) {
+        if (pVoices[voiceIdx].envPhase == EnvPhase::Off)
+            continue;
+
+        // Too many voices to gather? If that's the case then just process all voices, skipping ones that are switched off as we go.
+        if (numActiveVoices >= MAX_GATHERED_VOICES) {
+            numActiveVoices = -1;
+            break;
+        }
+
+        activeVoiceIdxs[numActiveVoices] = (uint32_t) voiceIdx;
+        numActiveVoices++;
+    }
+
+    const bool bUseActiveVoiceList = (numActiveVoices >= 0);
+    const int32_t numVoicesToStep = (bUseActiveVoiceList) ? numActiveVoices : numVoices;
+
+    for (int32_t i = 0; i < numVoicesToStep; ++i) {
+        Voice& voice = pVoices[(bUseActiveVoiceList) ? activeVoiceIdxs[i] : i];
+
+        for (uint32_t sampleIdx = 0; sampleIdx < numSamples; ++sampleIdx) {
+            // Once a voice is off it can't come back on again until keyed on, so skip the rest of the block
+            if (voice.envPhase == EnvPhase::Off)
+                break;
+
+            stepVoice(voice, pRam, ramSize, pAdpcmCache, numAdpcmCacheEntries, pOutput[sampleIdx], pOutputToReverb[sampleIdx]);
+        }
     }
 }
 
@@ -514,10 +628,45 @@ static void doReverb(
         return 0;
     };
 
+    // Helper: the same as 'wrapRevAddr16(reverbCurAddr + addrRelative)' but avoids the expensive modulus operation in the common case.
+    // If the current reverb address is within the work area and the address being accessed does not fall before the start of the work area,
+    // then wrapping normally only requires a single subtraction. Otherwise fallback to the general wrapping logic to get exactly the same result.
+    const uint32_t reverbCurAddrRel2 = (reverbCurAddr - reverbBaseAddr) / 2;
+    const bool bCanFastWrap = (
+        (reverbWorkAreaSize2 > 0) &&
+        (reverbCurAddr >= reverbBaseAddr) &&
+        (reverbCurAddr < 0x80000000u) &&
+        ((reverbCurAddr & 1) == 0)
+    );
+
+    const auto relRevAddr16 = [=](uint32_t addrRelative) noexcept -> uint32_t {
+        const int32_t relativeAddr2 = (int32_t) reverbCurAddrRel2 + ((int32_t) addrRelative >> 1);
+
+        if (bCanFastWrap && (relativeAddr2 >= 0) && ((addrRelative & 1) == 0)) {
+            uint32_t wrappedAddr2 = (uint32_t) relativeAddr2;
+
+            if (wrappedAddr2 >= reverbWorkAreaSize2) {
+                wrappedAddr2 -= reverbWorkAreaSize2;
+
+                if (wrappedAddr2 >= reverbWorkAreaSize2) {
+                    wrappedAddr2 %= reverbWorkAreaSize2;
+                }
+            }
+
+            #if SIMPLE_SPU_FLOAT_SPU
+                return wrappedAddr2 * 2;
+            #else
+                return (reverbBaseAddr2 + wrappedAddr2) * 2;
+            #endif
+        }
+
+        return wrapRevAddr16(reverbCurAddr + addrRelative);
+    };
+
     // Helpers: read and write a 16-bit sample relative to the current reverb address.
     // Wraps the read or write to be within the work area for reverb.
     const auto revR = [=](uint32_t addrRelative) noexcept -> Sample {
-        const uint32_t addr = wrapRevAddr16(reverbCurAddr + addrRelative);
+        const uint32_t addr = relRevAddr16(addrRelative);
 
         #if SIMPLE_SPU_FLOAT_SPU
             return pReverbRam[addr / 2];
@@ -529,7 +678,7 @@ static void doReverb(
 
     const auto revW = [=](uint32_t addrRelative, const Sample sample) noexcept {
         if (bReverbWriteEnable) {
-            const uint32_t addr = wrapRevAddr16(reverbCurAddr + addrRelative);
+            const uint32_t addr = relRevAddr16(addrRelative);
 
             #if SIMPLE_SPU_FLOAT_SPU
                 pReverbRam[addr / 2] = sample.value;
@@ -712,6 +861,8 @@ void doMasterMix(
 }
 
 void Spu::destroyCore(Core& core) noexcept {
+    delete[] core.pAdpcmCache;
+
     #if SIMPLE_SPU_FLOAT_SPU
         delete[] core.pReverbRam;
     #endif
@@ -722,19 +873,10 @@ void Spu::destroyCore(Core& core) noexcept {
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Start playing the given voice
+// Finishes a single step of the SPU core after voices have been processed: mixes external input, does reverb and the final master mix.
+// Takes the voice output and voice output to reverberate for this step and returns the final sample of output.
 //------------------------------------------------------------------------------------------------------------------------------------------
-StereoSample Spu::stepCore(Core& core) noexcept {
-    // Process all voices firstly and silence the output if we are not unmuted
-    StereoSample output = {};
-    StereoSample outputToReverb = {};
-    stepVoices(core.pVoices, core.numVoices, core.pRam, core.ramSize, output, outputToReverb);
-
-    if (!core.bUnmute) {
-        output = {};
-        outputToReverb = {};
-    }
-
+static StereoSample finishCoreStep(Core& core, StereoSample output, StereoSample outputToReverb) noexcept {
     // Mix any external input
     if (core.bExtEnabled) {
         mixExternalInput(
@@ -773,6 +915,88 @@ StereoSample Spu::stepCore(Core& core) noexcept {
     return output;
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Setup the optional cache of decoded ADPCM blocks
+//------------------------------------------------------------------------------------------------------------------------------------------
+void Spu::initAdpcmCache(Core& core, const uint32_t numEntries) noexcept {
+    ASSERT((numEntries & (numEntries - 1)) == 0);
+
+    delete[] core.pAdpcmCache;
+    core.pAdpcmCache = nullptr;
+    core.numAdpcmCacheEntries = 0;
+
+    if (numEntries > 0) {
+        core.pAdpcmCache = new AdpcmCacheEntry[numEntries];
+        core.numAdpcmCacheEntries = numEntries;
+
+        for (uint32_t i = 0; i < numEntries; ++i) {
+            core.pAdpcmCache[i] = {};
+            core.pAdpcmCache[i].addr8 = UINT32_MAX;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Step the SPU core and return 1 sample of output
+//------------------------------------------------------------------------------------------------------------------------------------------
+StereoSample Spu::stepCore(Core& core) noexcept {
+    // Process all voices firstly and silence the output if we are not unmuted
+    StereoSample output = {};
+    StereoSample outputToReverb = {};
+    stepVoices(core.pVoices, core.numVoices, core.pRam, core.ramSize, core.pAdpcmCache, core.numAdpcmCacheEntries, output, outputToReverb);
+
+    if (!core.bUnmute) {
+        output = {};
+        outputToReverb = {};
+    }
+
+    return finishCoreStep(core, output, outputToReverb);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Step the SPU core multiple times and output the given number of samples.
+// Voices are processed over a block of samples at a time, followed by external input mixing, reverb and the master mix for each sample.
+// The output is identical to calling 'stepCore' once for each sample, assuming voices don't play from the reverb work area while it's being written.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void Spu::stepCoreBlock(Core& core, StereoSample* const pOutput, const uint32_t numSamples) noexcept {
+    ASSERT(pOutput || (numSamples == 0));
+
+    // How many samples of voice output to buffer at a time
+    constexpr uint32_t VOICE_BLOCK_SIZE = 256;
+
+    StereoSample voiceOutput[VOICE_BLOCK_SIZE];
+    StereoSample voiceOutputToReverb[VOICE_BLOCK_SIZE];
+
+    for (uint32_t blockStartIdx = 0; blockStartIdx < numSamples; blockStartIdx += VOICE_BLOCK_SIZE) {
+        const uint32_t blockSize = std::min(numSamples - blockStartIdx, VOICE_BLOCK_SIZE);
+
+        // Process all voices firstly for the whole block and silence the output if we are not unmuted
+        std::fill_n(voiceOutput, blockSize, StereoSample{});
+        std::fill_n(voiceOutputToReverb, blockSize, StereoSample{});
+        stepVoicesBlock(
+            core.pVoices,
+            core.numVoices,
+            core.pRam,
+            core.ramSize,
+            core.pAdpcmCache,
+            core.numAdpcmCacheEntries,
+            voiceOutput,
+            voiceOutputToReverb,
+            blockSize
+        );
+
+        if (!core.bUnmute) {
+            std::fill_n(voiceOutput, blockSize, StereoSample{});
+            std::fill_n(voiceOutputToReverb, blockSize, StereoSample{});
+        }
+
+        // Do the rest of the processing for each sample
+        for (uint32_t i = 0; i < blockSize; ++i) {
+            pOutput[blockStartIdx + i] = finishCoreStep(core, voiceOutput[i], voiceOutputToReverb[i]);
+        }
+    }
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Start playing the given voice
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -791,11 +1015,13 @@ void Spu::keyOn(Voice& voice) noexcept {
     voice.bReachedLoopEnd = false;
     voice.bRepeat = false;
 
-    // Zero the 3 previous samples used for interpolation and previous 2 samples used for ADPCM decoding
+    // Zero the 3 previous samples used for interpolation and previous 2 samples used for ADPCM decoding.
+    // Note: the last 3 samples in the buffer also need to be zeroed since decoding the first block copies them over the previous samples.
     static_assert(Voice::NUM_PREV_SAMPLES == 3);
     voice.samples[0] = {};
     voice.samples[1] = {};
     voice.samples[2] = {};
+    voice.samples[Voice::SAMPLE_BUFFER_SIZE - 3] = {};
     voice.samples[Voice::SAMPLE_BUFFER_SIZE - 2] = {};
     voice.samples[Voice::SAMPLE_BUFFER_SIZE - 1] = {};
 }
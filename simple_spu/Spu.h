@@ -391,6 +391,21 @@ struct Voice {
     Sample samples[SAMPLE_BUFFER_SIZE];
 };
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// An entry in the optional cache of decoded ADPCM blocks.
+//
+// Decoding an ADPCM block depends on the last 2 samples decoded before it (for the adaptive filter), as well as the block contents.
+// Because of this each entry remembers the raw block data and the decoder history it was decoded with, and is only used if both match.
+// That way the cache never needs to be invalidated when sound RAM changes, and loops (which decode with different history the first time
+// around) still sound exactly the same as they would without the cache.
+//------------------------------------------------------------------------------------------------------------------------------------------
+struct AdpcmCacheEntry {
+    uint32_t    addr8;                                  // Address of the ADPCM block in SPU RAM (in 8 byte units), or 'UINT32_MAX' if the entry is empty
+    std::byte   adpcmBlock[ADPCM_BLOCK_SIZE];           // The raw ADPCM block that was decoded
+    Sample      prevSamples[2];                         // The previous 2 samples given to the decoder, with the newest first
+    Sample      samples[ADPCM_BLOCK_NUM_SAMPLES];       // The decoded samples
+};
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // A callback which is invoked by the SPU to provide external input.
 // Can be used to mix in CD audio or anything else and run it through the reverb processing of the SPU.
@@ -424,6 +439,8 @@ struct Core {
     uint32_t            reverbCurAddr;          // Used for relative reads and writes to the reverb work area; continously incremented and wrapped as reverb is processed
     StereoSample        processedReverb;        // The processed reverb that is to be added into the final mix: only updated at 22,050 Hz instead of 44,100 Hz (every 2 SPU steps)
     ReverbRegs          reverbRegs;             // Registers with settings determining how reverb is processed: determines the type of reverb
+    AdpcmCacheEntry*    pAdpcmCache;            // Optional cache of decoded ADPCM blocks, indexed by block address: null if not in use
+    uint32_t            numAdpcmCacheEntries;   // Number of entries in the ADPCM block cache: must be a power of two
 };
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -448,8 +465,14 @@ struct Core {
 
 void destroyCore(Core& core) noexcept;
 
-// Step the given SPU core
+// Setup the optional cache of decoded ADPCM blocks with the given number of entries, which must be a power of two.
+// Using the cache does not change the output of the SPU in any way; it simply avoids re-decoding sounds that are played repeatedly.
+// The cache is freed by 'destroyCore'.
+void initAdpcmCache(Core& core, const uint32_t numEntries) noexcept;
+
+// Step the given SPU core once, or multiple times to produce a block of samples
 StereoSample stepCore(Core& core) noexcept;
+void stepCoreBlock(Core& core, StereoSample* const pOutput, const uint32_t numSamples) noexcept;
 
 // Key on or off the given SPU voice
 void keyOn(Voice& voice) noexcept;
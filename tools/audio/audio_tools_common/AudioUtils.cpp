@@ -14,7 +14,7 @@ BEGIN_NAMESPACE(AudioUtils)
 //------------------------------------------------------------------------------------------------------------------------------------------
 float getNoteSampleRate(const float baseNote, const float baseNoteSampleRate, const float note) noexcept {
     const float noteOffset = note - baseNote;
-    const float sampleRate = baseNoteSampleRate * std::powf(2.0f, noteOffset / 12.0f);
+    const float sampleRate = baseNoteSampleRate * std::pow(2.0f, noteOffset / 12.0f);
     return sampleRate;
 }
 
@@ -7,6 +7,8 @@
 #include "FileUtils.h"
 
 #include <algorithm>
+#include <cstring>
+#include <iterator>
 
 BEGIN_NAMESPACE(AudioTools)
 BEGIN_NAMESPACE(VagUtils)
@@ -42,6 +44,49 @@ static constexpr ShiftNibbleEncodingTable buildShiftNibbleEncodingTable() noexce
 
 constexpr ShiftNibbleEncodingTable SHIFT_NIBBLE_ENC_TABLE = buildShiftNibbleEncodingTable();
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// All of the combinations of prediction filter and sample shift which are tried when encoding an ADPCM block.
+// These are stored in 'structure of arrays' format so that all of the combinations can be evaluated together, one sample at a time,
+// in a way which compilers can easily vectorize. Candidates are ordered by filter first and then by shift.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static constexpr uint32_t NUM_ADPCM_FILTERS = 5;
+static constexpr uint32_t NUM_ADPCM_SHIFTS = 13;
+static constexpr uint32_t NUM_ADPCM_ENC_CANDIDATES = NUM_ADPCM_FILTERS * NUM_ADPCM_SHIFTS;
+
+struct AdpcmEncCandidates {
+    int32_t predictCoefPos[NUM_ADPCM_ENC_CANDIDATES];
+    int32_t predictCoefNeg[NUM_ADPCM_ENC_CANDIDATES];
+    int32_t sampleShift[NUM_ADPCM_ENC_CANDIDATES];
+    int32_t adjustStepShift[NUM_ADPCM_ENC_CANDIDATES];      // Log2 of the size of each correction step for the sample shift
+};
+
+static constexpr AdpcmEncCandidates buildAdpcmEncCandidates() noexcept {
+    AdpcmEncCandidates candidates = {};
+
+    for (uint32_t sampleFilter = 0; sampleFilter < NUM_ADPCM_FILTERS; ++sampleFilter) {
+        for (uint32_t sampleShift = 0; sampleShift < NUM_ADPCM_SHIFTS; ++sampleShift) {
+            const uint32_t candidateIdx = sampleFilter * NUM_ADPCM_SHIFTS + sampleShift;
+            candidates.predictCoefPos[candidateIdx] = ADPCM_PREDICT_COEF_POS[sampleFilter];
+            candidates.predictCoefNeg[candidateIdx] = ADPCM_PREDICT_COEF_NEG[sampleFilter];
+            candidates.sampleShift[candidateIdx] = (int32_t) sampleShift;
+            candidates.adjustStepShift[candidateIdx] = 12 - (int32_t) sampleShift;
+        }
+    }
+
+    return candidates;
+}
+
+constexpr AdpcmEncCandidates ADPCM_ENC_CANDIDATES = buildAdpcmEncCandidates();
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Helper: does a signed division by a power of two which rounds towards zero, exactly like regular integer division does.
+// Written with shifts so that it can be vectorized with a different divisor for each candidate encoding.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static inline int32_t truncDivPow2(const int32_t value, const int32_t shift) noexcept {
+    const int32_t roundingBias = (value >> 31) & ((1 << shift) - 1);
+    return (value + roundingBias) >> shift;
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Do byte swapping for little endian host CPUs.
 // The VAG header is stored in big endian format in the file.
@@ -508,46 +553,73 @@ void encodePcmToPsxAdpcmBlock(
     int16_t& prevEncSampleOut1,
     int16_t& prevEncSampleOut2
 ) noexcept {
-    // Try various combinations of ADPCM encoding and sample shift adjust to find the best one
-    uint64_t bestError = UINT64_MAX;
-    uint32_t bestSampleFilter = 0;
-    uint32_t bestSampleShift = 0;
-    uint8_t bestSampleNibbles[ADPCM_BLOCK_NUM_SAMPLES] = {};
+    // Evaluate every combination of ADPCM prediction filter and sample shift at the same time, one sample at a time.
+    // This gives exactly the same results as 'tryPsxAdpcmEncoding' but is much faster since it vectorizes well.
+    const AdpcmEncCandidates& candidates = ADPCM_ENC_CANDIDATES;
+
+    int32_t prevSamples1[NUM_ADPCM_ENC_CANDIDATES];
+    int32_t prevSamples2[NUM_ADPCM_ENC_CANDIDATES];
+    uint64_t errors[NUM_ADPCM_ENC_CANDIDATES] = {};
+
+    std::fill(std::begin(prevSamples1), std::end(prevSamples1), (int32_t) prevSample1);
+    std::fill(std::begin(prevSamples2), std::end(prevSamples2), (int32_t) prevSample2);
+
+    for (uint32_t sampleIdx = 0; sampleIdx < ADPCM_BLOCK_NUM_SAMPLES; ++sampleIdx) {
+        const int32_t realSample = samples[sampleIdx];
 
-    for (uint32_t sampleFilter = 0; sampleFilter <= 4; ++sampleFilter) {
-        for (int32_t sampleShift = 0; sampleShift <= 12; ++sampleShift) {
-            // Evaluate this encoding
-            uint8_t sampleNibbles[ADPCM_BLOCK_NUM_SAMPLES];
-            int16_t lastEncSample1;
-            int16_t lastEncSample2;
-            uint64_t error;
-
-            tryPsxAdpcmEncoding(
-                sampleFilter,
-                sampleShift,
-                samples,
-                prevSample1,
-                prevSample2,
-                sampleNibbles,
-                lastEncSample1,
-                lastEncSample2,
-                error
+        for (uint32_t candIdx = 0; candIdx < NUM_ADPCM_ENC_CANDIDATES; ++candIdx) {
+            // Predict the sample and figure out how many correction steps to adjust by, as per 'tryPsxAdpcmEncoding'
+            const int32_t predictedSample = truncDivPow2(
+                prevSamples1[candIdx] * candidates.predictCoefPos[candIdx] + prevSamples2[candIdx] * candidates.predictCoefNeg[candIdx] + 32,
+                6
             );
 
-            // Is this a better one? If so then remember it...
-            if (error < bestError) {
-                bestError = error;
-                bestSampleFilter = sampleFilter;
-                bestSampleShift = sampleShift;
-                std::memcpy(bestSampleNibbles, sampleNibbles, sizeof(sampleNibbles));
+            const int32_t predictionError = realSample - predictedSample;
+            const int32_t adjustSteps = std::clamp(truncDivPow2(predictionError, candidates.adjustStepShift[candIdx]), -8, 7);
 
-                // Save this for the caller, so it knows the last two encoded samples for the best encoding
-                prevEncSampleOut1 = lastEncSample1;
-                prevEncSampleOut2 = lastEncSample2;
-            }
+            // Encode the sample: this is the same as using 'SHIFT_NIBBLE_ENC_TABLE' with the nibble for the adjust steps
+            const int32_t encodedSampleUnclamped = predictedSample + ((adjustSteps * 4096) >> candidates.sampleShift[candIdx]);
+            const int32_t encodedSample = std::clamp<int32_t>(encodedSampleUnclamped, INT16_MIN, INT16_MAX);
+            prevSamples2[candIdx] = prevSamples1[candIdx];
+            prevSamples1[candIdx] = encodedSample;
+
+            // Update the error of this encoding: penalize heavily overflow
+            const int32_t encodingError = encodedSample - realSample;
+            const int32_t overflowError = (encodedSampleUnclamped - encodedSample) * 64;
+            errors[candIdx] += (uint64_t)((int64_t) encodingError * encodingError);
+            errors[candIdx] += (uint64_t)((int64_t) overflowError * overflowError);
         }
     }
 
+    // Pick the best encoding, preferring earlier candidates if there is a tie
+    uint32_t bestCandIdx = 0;
+
+    for (uint32_t candIdx = 1; candIdx < NUM_ADPCM_ENC_CANDIDATES; ++candIdx) {
+        if (errors[candIdx] < errors[bestCandIdx]) {
+            bestCandIdx = candIdx;
+        }
+    }
+
+    // Redo the best encoding to get its sample nibbles and the last two encoded samples for the caller
+    const uint32_t bestSampleFilter = bestCandIdx / NUM_ADPCM_SHIFTS;
+    const uint32_t bestSampleShift = bestCandIdx % NUM_ADPCM_SHIFTS;
+    uint8_t bestSampleNibbles[ADPCM_BLOCK_NUM_SAMPLES] = {};
+    uint64_t bestError = {};
+
+    tryPsxAdpcmEncoding(
+        bestSampleFilter,
+        (int32_t) bestSampleShift,
+        samples,
+        prevSample1,
+        prevSample2,
+        bestSampleNibbles,
+        prevEncSampleOut1,
+        prevEncSampleOut2,
+        bestError
+    );
+
+    ASSERT(bestError == errors[bestCandIdx]);
+
     // Save the sample shift and the prediction filter
     adpcmDataOut[0] = (std::byte)(bestSampleShift | (bestSampleFilter << 4));
 
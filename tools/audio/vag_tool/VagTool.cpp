@@ -6,6 +6,15 @@
 #include "VagUtils.h"
 #include "WavUtils.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <thread>
+
 using namespace AudioTools;
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -31,6 +40,13 @@ Command switches and arguments:
         Example:
             VagTool -wav-to-vag SOME_SOUND.WAV PSX_SOUND.VAG
 
+    -wav-to-vag-batch <INPUT DIRECTORY> <OUTPUT DIRECTORY> [NUM THREADS]
+        Convert all .WAV files in the input directory (and sub-directories) to PlayStation 1 .VAG format.
+        Each .VAG file is output to the same relative path in the output directory, with the same name as the .WAV file.
+        The same notes as '-wav-to-vag' apply. Files are converted in parallel, by default using one thread per CPU core.
+        Example:
+            VagTool -wav-to-vag-batch WAV_SOUNDS PSX_SOUNDS
+
     -vag-to-wav <INPUT WAV FILE PATH> <OUTPUT VAG FILE PATH>
         Convert an input PlayStation 1 .VAG file into a standard .WAV file.
         Notes:
@@ -117,6 +133,81 @@ static bool convertWavToVag(const char* const wavFilePath, const char* const vag
     return true;
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Convert all of the .wav files in a directory (and sub-directories) to .vag files, using the specified number of threads
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool convertWavToVagBatch(const char* const inputDirPath, const char* const outputDirPath, const uint32_t numThreads) noexcept {
+    namespace fs = std::filesystem;
+
+    // Gather all the input .wav files and where the .vag files for them should go
+    std::vector<fs::path> wavFilePaths;
+    std::vector<fs::path> vagFilePaths;
+    std::error_code errorCode;
+
+    for (fs::recursive_directory_iterator iter(inputDirPath, errorCode), endIter; (!errorCode) && (iter != endIter); iter.increment(errorCode)) {
+        if (!iter->is_regular_file(errorCode))
+            continue;
+
+        const fs::path& wavFilePath = iter->path();
+        std::string extension = wavFilePath.extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(), [](const char c) noexcept { return (char) std::toupper((unsigned char) c); });
+
+        if (extension != ".WAV")
+            continue;
+
+        // Note: keep the case of the extension the same as the input file
+        const bool bUpperCaseExt = (wavFilePath.extension().string() == ".WAV");
+        fs::path vagFilePath = fs::path(outputDirPath) / fs::relative(wavFilePath, inputDirPath, errorCode);
+        vagFilePath.replace_extension((bUpperCaseExt) ? ".VAG" : ".vag");
+
+        wavFilePaths.push_back(wavFilePath);
+        vagFilePaths.push_back(vagFilePath);
+    }
+
+    if (errorCode) {
+        std::printf("Error! Failed to list the .wav files in input directory '%s'!\n", inputDirPath);
+        return false;
+    }
+
+    // Make sure all the output directories exist before starting
+    for (const fs::path& vagFilePath : vagFilePaths) {
+        fs::create_directories(vagFilePath.parent_path(), errorCode);
+
+        if (errorCode) {
+            std::printf("Error! Failed to create output directory '%s'!\n", vagFilePath.parent_path().string().c_str());
+            return false;
+        }
+    }
+
+    // Convert all the files in parallel: each thread grabs the next unconverted file until there are none left
+    const uint32_t numFiles = (uint32_t) wavFilePaths.size();
+    std::atomic<uint32_t> nextFileIdx = 0;
+    std::atomic<uint32_t> numFailedFiles = 0;
+
+    const auto doWork = [&]() noexcept {
+        for (uint32_t fileIdx = nextFileIdx++; fileIdx < numFiles; fileIdx = nextFileIdx++) {
+            if (!convertWavToVag(wavFilePaths[fileIdx].string().c_str(), vagFilePaths[fileIdx].string().c_str())) {
+                numFailedFiles++;
+            }
+        }
+    };
+
+    const uint32_t numWorkers = std::clamp(numThreads, 1u, std::max(numFiles, 1u));
+    std::vector<std::thread> threads;
+    threads.reserve(numWorkers);
+
+    for (uint32_t threadIdx = 0; threadIdx < numWorkers; ++threadIdx) {
+        threads.emplace_back(doWork);
+    }
+
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    std::printf("Converted %u of %u .wav file(s).\n", numFiles - numFailedFiles, numFiles);
+    return (numFailedFiles == 0);
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Convert a .vag file to a .wav file
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -173,6 +264,14 @@ int main(int argc, const char* const argv[]) noexcept {
             return (convertWavToVag(wavFilePath, vagFilePath)) ? 0 : 1;
         }
     }
+    else if (std::strcmp(cmdSwitch, "-wav-to-vag-batch") == 0) {
+        if ((argc == 4) || (argc == 5)) {
+            const char* const inputDirPath = argv[2];
+            const char* const outputDirPath = argv[3];
+            const uint32_t numThreads = (argc == 5) ? (uint32_t) std::strtoul(argv[4], nullptr, 10) : std::thread::hardware_concurrency();
+            return (convertWavToVagBatch(inputDirPath, outputDirPath, numThreads)) ? 0 : 1;
+        }
+    }
     else if (std::strcmp(cmdSwitch, "-vag-to-wav") == 0) {
         if (argc == 4) {
             const char* const vagFilePath = argv[2];
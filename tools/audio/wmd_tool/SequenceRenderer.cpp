@@ -0,0 +1,726 @@
+//------------------------------------------------------------------------------------------------------------------------------------------
+// SequenceRenderer:
+//      Renders a sequence in a module offline to 44.1 KHz stereo audio, as fast as possible, using PsyDoom's 'SimpleSpu' SPU emulation.
+//      The sequencer and PSX sound driver logic here is a compact re-implementation of what the game's 'Wess' sound system does,
+//      following the same timing, volume, pan, pitch bend and voice allocation rules. Unlike the game it is not tied to the PlayStation
+//      VM or LIBSPU and there is no audio thread, so the SPU can simply be stepped in between each sequencer tick.
+//
+//      Limitations:
+//          - Reverb is not applied. PSX Doom decides the reverb mode and depth on a per map basis, so it is not part of the module.
+//          - Drum tracks use the track patch to play notes, as the PSX driver drum patch table is not part of the module data.
+//          - Sequencer commands not used by PSX Doom (gates, iters, sequence level jumps etc.) are ignored.
+//------------------------------------------------------------------------------------------------------------------------------------------
+#include "SequenceRenderer.h"
+
+#include "Lcd.h"
+#include "Module.h"
+#include "Spu.h"
+#include "WmdFileTypes.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+BEGIN_NAMESPACE(AudioTools)
+BEGIN_NAMESPACE(SequenceRenderer)
+
+static constexpr uint32_t   TICKS_PER_SEC               = 120;              // How many times a second the sequencer is updated
+static constexpr uint32_t   MS_FRAC_STEP                = 0x85555;          // How much to step the millisecond count each tick in 16.16 format: approximately 1000/120
+static constexpr uint32_t   MIN_SPU_RAM_SIZE            = 512 * 1024;       // Minimum amount of SPU RAM to use: more is allocated if the samples need it
+static constexpr uint32_t   SPU_RAM_SAMPLES_START       = 4 * 1024;         // Where samples start in SPU RAM: PSX Doom reserves the first 4 KiB for the SPU capture buffers
+static constexpr uint32_t   DEFAULT_HW_VOICE_LIMIT      = 24;               // How many hardware voices to use if the module doesn't specify
+static constexpr uint32_t   SPU_ADPCM_CACHE_SIZE        = 8192;             // Size of the cache of decoded ADPCM blocks (same as PsyDoom)
+static constexpr uint32_t   MASTER_VOL                  = 127;              // Master music and sound effects volume (0-127): always the maximum
+static constexpr int32_t    PAN_LEFT                    = 0;
+static constexpr int32_t    PAN_CENTER                  = 64;
+static constexpr int32_t    PAN_RIGHT                   = 127;
+static constexpr uint32_t   MAX_RELEASE_TIME_MS         = 0x10000000;       // Maximum time something can release for (milliseconds)
+static constexpr uint32_t   MAX_FAST_RELEASE_TIME_MS    = 0x05DC0000;       // A scaled version of the maximum release time that is faster, used by some voices
+static constexpr uint32_t   MUTE_RELEASE_TIME_MS        = 256;              // How long it takes for muted voices to fade out: this is the value used by PSX Doom
+static constexpr uint32_t   MAX_CMDS_PER_TICK           = 0x10000;          // Safety limit so a malformed track that jumps in a loop with no delay can't hang the render
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// State for a hardware voice
+//------------------------------------------------------------------------------------------------------------------------------------------
+struct VoiceStatus {
+    bool                    bActive;            // Is the voice allocated to a track?
+    bool                    bRelease;           // Is the voice being released?
+    uint8_t                 note;               // Note being played by the voice
+    uint8_t                 volume;             // Volume the note was triggered with
+    uint8_t                 priority;           // Priority of the voice, from the track that triggered it
+    uint32_t                trackIdx;           // Which track the voice belongs to
+    const PsxPatchVoice*    pPatchVoice;        // Patch voice being played
+    uint32_t                releaseTimeMs;      // Approximately how long it takes the voice to fade out when released
+    uint32_t                onOffAbsTimeMs;     // When the voice was triggered or when it will finish releasing (if releasing)
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// State for a track in the sequence being rendered
+//------------------------------------------------------------------------------------------------------------------------------------------
+struct TrackStatus {
+    const Track*            pTrack;             // The track being played
+    bool                    bStopped;           // Set once the track has ended: no more commands are executed
+    uint32_t                cmdIdx;             // Index of the next command to execute
+    uint16_t                patchIdx;           // Current patch used to play notes
+    int16_t                 pitchCntrl;         // Current pitch bend amount
+    uint8_t                 volumeCntrl;        // Current track volume
+    uint8_t                 panCntrl;           // Current track pan
+    uint32_t                numActiveVoices;    // How many voices the track has active
+    uint32_t                tempoPpiFrac;       // How many quarter note parts to advance the track by every tick (16.16 format)
+    uint32_t                deltaTimeQnpFrac;   // Fractional quarter note parts elapsed (16.16 format)
+    uint32_t                deltaTimeQnp;       // Quarter note parts elapsed towards the next command
+    uint32_t                absTimeQnp;         // Total quarter note parts elapsed for the track
+    uint32_t                qnpTillNextCmd;     // Quarter note parts until the next command executes
+    std::vector<uint32_t>   locStack;           // Command indexes to return to for 'TrkRet'
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// All of the state for a render
+//------------------------------------------------------------------------------------------------------------------------------------------
+struct RenderState {
+    const Module*               pModule;            // Module being played from
+    Spu::Core                   spu;                // The SPU used to produce the audio
+    std::vector<uint32_t>       sampleSpuAddrs;     // SPU RAM address of each patch sample, or '0' if the sample is not loaded
+    std::vector<VoiceStatus>    voices;             // State for each hardware voice
+    std::vector<TrackStatus>    tracks;             // State for each track in the sequence
+    uint32_t                    numActiveVoices;    // How many hardware voices are allocated
+    uint32_t                    absTimeMs;          // Elapsed time in milliseconds
+    uint32_t                    absTimeMsFrac;      // Fractional elapsed milliseconds (16.16 format)
+    uint8_t                     muteReleaseRate;    // SPU release rate used to fade out muted voices
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Sample rates for an entire octave of notes (12 semitones) in 1/16 semitone steps, in the scale used by the SPU (0x1000 = 44,100 Hz).
+// These exactly match the table that LIBSPU uses to convert notes to sample rates.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static const std::vector<uint16_t>& getOctaveSampleRates() noexcept {
+    static const std::vector<uint16_t> sampleRates = []() noexcept {
+        std::vector<uint16_t> rates(12 * 16);
+
+        for (uint32_t i = 0; i < rates.size(); ++i) {
+            rates[i] = (uint16_t)(4096.0 * std::pow(2.0, (double) i / 192.0));
+        }
+
+        return rates;
+    }();
+
+    return sampleRates;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Convert a musical note to an SPU sample rate, in the same way LIBSPU does ('LIBSPU__spu_note2pitch').
+// The center note is the note at which the sample plays at 44,100 Hz; note fractions are in 1/128 semitone units.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static uint16_t noteToSampleRate(
+    const int32_t centerNote,
+    const int32_t centerNoteFrac,
+    const int32_t offsetNote,
+    const int32_t offsetNoteFrac
+) noexcept {
+    const int32_t noteFracUnwrapped = offsetNoteFrac + centerNoteFrac;
+    const int32_t noteFrac = (noteFracUnwrapped >> 3) & 0xF;
+    const int32_t note = offsetNote - centerNote + noteFracUnwrapped / 128;
+
+    const int32_t octave = (note < 0) ? (note - 11) / 12 : note / 12;
+    const int32_t noteInOctave = note - octave * 12;
+    const uint16_t baseSampleRate = getOctaveSampleRates()[(noteInOctave << 4) | noteFrac];
+
+    if (octave > 0) {
+        return (uint16_t)(baseSampleRate << std::min(octave, 15));
+    } else if (octave < 0) {
+        return (uint16_t)(baseSampleRate >> std::min(-octave, 15));
+    } else {
+        return baseSampleRate;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Calculates the number of quarter note parts per sequencer tick, in 16.16 fixed point format (same as 'CalcPartsPerInt' in the game)
+//------------------------------------------------------------------------------------------------------------------------------------------
+static uint32_t calcPartsPerTick(const uint32_t partsPerQNote, const uint32_t qnotesPerMin) noexcept {
+    const uint32_t ticksPerMin = TICKS_PER_SEC * 60;
+    const uint32_t qnotesPerMinFrac = qnotesPerMin << 16;
+    const uint32_t qnotesPerTickRoundUp = TICKS_PER_SEC * 30 + 30;
+    const uint32_t qnotesPerTickFrac = (qnotesPerMinFrac + qnotesPerTickRoundUp) / ticksPerMin;
+    return qnotesPerTickFrac * partsPerQNote;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Compute the note to play for a voice (with the fractional part in the low 8 bits), taking into account the track pitch bend
+//------------------------------------------------------------------------------------------------------------------------------------------
+static uint16_t getVoicePitchBentNote(const VoiceStatus& voice, const TrackStatus& track) noexcept {
+    const int32_t pitchCntrl = track.pitchCntrl;
+
+    if (pitchCntrl == 0)
+        return (uint16_t)(voice.note << 8);
+
+    if (pitchCntrl >= 1) {
+        const uint32_t pitchShiftFrac = 32u + pitchCntrl * voice.pPatchVoice->pitchstepUp;
+        const uint32_t pitchShiftNote = pitchShiftFrac >> 13;
+        const uint32_t pitchShiftFine = (pitchShiftFrac & 0x1FFFu) >> 6;
+        return (uint16_t)(((voice.note + pitchShiftNote) << 8) | (pitchShiftFine & 0x7Fu));
+    } else {
+        const uint32_t pitchShiftFrac = 32u - pitchCntrl * voice.pPatchVoice->pitchstepDown;
+        const uint32_t pitchShiftNote = (pitchShiftFrac >> 13) + 1;
+        const uint32_t pitchShiftFine = 128u - ((pitchShiftFrac & 0x1FFFu) >> 6);
+        return (uint16_t)(((voice.note - pitchShiftNote) << 8) | (pitchShiftFine & 0x7Fu));
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Compute the sample rate to play a voice at, taking into account the track pitch bend
+//------------------------------------------------------------------------------------------------------------------------------------------
+static uint16_t getVoiceSampleRate(const VoiceStatus& voice, const TrackStatus& track) noexcept {
+    const PsxPatchVoice& patchVoice = *voice.pPatchVoice;
+    const uint16_t note = getVoicePitchBentNote(voice, track);
+    return noteToSampleRate(patchVoice.baseNote, patchVoice.baseNoteFrac, note >> 8, note & 0xFF);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Compute the left/right SPU volume for a voice, taking into account the voice, patch voice and track volume and pan
+//------------------------------------------------------------------------------------------------------------------------------------------
+static Spu::Volume getVoiceSpuVolume(const VoiceStatus& voice, const TrackStatus& track) noexcept {
+    const PsxPatchVoice& patchVoice = *voice.pPatchVoice;
+
+    const int32_t pan = std::clamp<int32_t>((int32_t) track.panCntrl + (int32_t) patchVoice.pan - PAN_CENTER, PAN_LEFT, PAN_RIGHT);
+    const int32_t vol = (int32_t)(((uint32_t) voice.volume * patchVoice.volume * track.volumeCntrl * MASTER_VOL) >> 21);
+
+    Spu::Volume spuVol = {};
+    spuVol.left = (int16_t)(((vol * 128 * (128 - pan)) / 128) & 0x7FFF);
+    spuVol.right = (int16_t)(((vol * 128 * (pan + 1)) / 128) & 0x7FFF);
+    return spuVol;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Free up the given voice so it can be used again.
+// Note: like the game, this does not key off the SPU voice; if it is still sounding it will continue to do so until reused.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void voiceParmOff(RenderState& rs, VoiceStatus& voice) noexcept {
+    TrackStatus& track = rs.tracks[voice.trackIdx];
+    track.numActiveVoices--;
+    rs.numActiveVoices--;
+    voice.bActive = false;
+    voice.bRelease = false;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Begin releasing a voice and figure out when it will finish fading out
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void voiceRelease(RenderState& rs, VoiceStatus& voice, const uint32_t voiceIdx) noexcept {
+    Spu::keyOff(rs.spu.pVoices[voiceIdx]);
+    voice.bRelease = true;
+    voice.onOffAbsTimeMs = rs.absTimeMs + voice.releaseTimeMs;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Trigger the given voice to play a note with the given patch voice
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void voiceOn(
+    RenderState& rs,
+    const uint32_t voiceIdx,
+    const uint32_t trackIdx,
+    const PsxPatchVoice& patchVoice,
+    const uint8_t note,
+    const uint8_t volume
+) noexcept {
+    TrackStatus& track = rs.tracks[trackIdx];
+    VoiceStatus& voice = rs.voices[voiceIdx];
+
+    voice.bActive = true;
+    voice.bRelease = false;
+    voice.note = note;
+    voice.volume = volume;
+    voice.priority = track.pTrack->priority;
+    voice.trackIdx = trackIdx;
+    voice.pPatchVoice = &patchVoice;
+    voice.onOffAbsTimeMs = rs.absTimeMs;
+
+    // Figure out how long it takes for the voice to fade out (same approximation as the game)
+    const uint32_t adsr2 = patchVoice.adsrBits >> 16;
+    const uint32_t maxReleaseTime = (adsr2 & 0x20) ? MAX_RELEASE_TIME_MS : MAX_FAST_RELEASE_TIME_MS;
+    voice.releaseTimeMs = maxReleaseTime >> (31 - (adsr2 % 32));
+
+    track.numActiveVoices++;
+    rs.numActiveVoices++;
+
+    // Setup the SPU voice and key it on
+    Spu::Voice& spuVoice = rs.spu.pVoices[voiceIdx];
+
+    static_assert(sizeof(spuVoice.env) == sizeof(patchVoice.adsrBits));
+    std::memcpy(&spuVoice.env, &patchVoice.adsrBits, sizeof(spuVoice.env));
+
+    spuVoice.adpcmStartAddr8 = rs.sampleSpuAddrs[patchVoice.sampleIdx] / 8;
+    spuVoice.sampleRate = getVoiceSampleRate(voice, track);
+    spuVoice.volume = getVoiceSpuVolume(voice, track);
+    Spu::keyOn(spuVoice);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Allocate a voice to play a note with, stealing one from lower or equal priority tracks if required (same rules as the game)
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void voiceNote(
+    RenderState& rs,
+    const uint32_t trackIdx,
+    const PsxPatchVoice& patchVoice,
+    const uint8_t note,
+    const uint8_t volume
+) noexcept {
+    const uint32_t trackPriority = rs.tracks[trackIdx].pTrack->priority;
+
+    int32_t stolenVoiceIdx = -1;
+    uint32_t stolenVoicePriority = 256;
+    uint32_t stolenVoiceOnOffAbsTime = UINT32_MAX;
+
+    for (uint32_t voiceIdx = 0; voiceIdx < rs.voices.size(); ++voiceIdx) {
+        VoiceStatus& voice = rs.voices[voiceIdx];
+
+        // If this voice is not in use then just use it
+        if (!voice.bActive) {
+            voiceOn(rs, voiceIdx, trackIdx, patchVoice, note, volume);
+            return;
+        }
+
+        // Only consider stealing the voice if the track is higher or equal priority to the voice
+        if (voice.priority > trackPriority)
+            continue;
+
+        bool bStealVoice = ((stolenVoiceIdx < 0) || (stolenVoicePriority > voice.priority));
+
+        if (!bStealVoice) {
+            const bool bStolenVoiceReleasing = rs.voices[stolenVoiceIdx].bRelease;
+
+            if (voice.bRelease) {
+                bStealVoice = ((voice.onOffAbsTimeMs < stolenVoiceOnOffAbsTime) || (!bStolenVoiceReleasing));
+            } else {
+                bStealVoice = ((voice.onOffAbsTimeMs < stolenVoiceOnOffAbsTime) && (!bStolenVoiceReleasing));
+            }
+        }
+
+        if (bStealVoice) {
+            stolenVoiceIdx = (int32_t) voiceIdx;
+            stolenVoicePriority = voice.priority;
+            stolenVoiceOnOffAbsTime = voice.onOffAbsTimeMs;
+        }
+    }
+
+    if (stolenVoiceIdx >= 0) {
+        voiceParmOff(rs, rs.voices[stolenVoiceIdx]);
+        voiceOn(rs, (uint32_t) stolenVoiceIdx, trackIdx, patchVoice, note, volume);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Play a note for a track using all the voices of the track's current patch
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void noteOn(RenderState& rs, const uint32_t trackIdx, const uint8_t note, const uint8_t volume) noexcept {
+    const PsxPatchGroup& patchGroup = rs.pModule->psxPatchGroup;
+    const uint16_t patchIdx = rs.tracks[trackIdx].patchIdx;
+
+    if (patchIdx >= patchGroup.patches.size())
+        return;
+
+    const PsxPatch& patch = patchGroup.patches[patchIdx];
+
+    for (uint32_t i = 0; i < patch.numVoices; ++i) {
+        const uint32_t patchVoiceIdx = (uint32_t) patch.firstVoiceIdx + i;
+
+        if (patchVoiceIdx >= patchGroup.patchVoices.size())
+            break;
+
+        // Only play the voice if its sample is loaded and the note is in range for the voice
+        const PsxPatchVoice& patchVoice = patchGroup.patchVoices[patchVoiceIdx];
+
+        if ((patchVoice.sampleIdx >= rs.sampleSpuAddrs.size()) || (rs.sampleSpuAddrs[patchVoice.sampleIdx] == 0))
+            continue;
+
+        if ((note >= patchVoice.noteMin) && (note <= patchVoice.noteMax)) {
+            voiceNote(rs, trackIdx, patchVoice, note, volume);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Release all voices playing the given note for a track
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void noteOff(RenderState& rs, const uint32_t trackIdx, const uint8_t note) noexcept {
+    for (uint32_t voiceIdx = 0; voiceIdx < rs.voices.size(); ++voiceIdx) {
+        VoiceStatus& voice = rs.voices[voiceIdx];
+
+        if (voice.bActive && (!voice.bRelease) && (voice.note == note) && (voice.trackIdx == trackIdx)) {
+            voiceRelease(rs, voice, voiceIdx);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Apply the current track pitch, volume and pan to all of its active voices
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void updateTrackVoicePitch(RenderState& rs, const uint32_t trackIdx) noexcept {
+    const TrackStatus& track = rs.tracks[trackIdx];
+
+    for (uint32_t voiceIdx = 0; voiceIdx < rs.voices.size(); ++voiceIdx) {
+        const VoiceStatus& voice = rs.voices[voiceIdx];
+
+        if (voice.bActive && (voice.trackIdx == trackIdx)) {
+            rs.spu.pVoices[voiceIdx].sampleRate = getVoiceSampleRate(voice, track);
+        }
+    }
+}
+
+static void updateTrackVoiceVolume(RenderState& rs, const uint32_t trackIdx) noexcept {
+    const TrackStatus& track = rs.tracks[trackIdx];
+
+    for (uint32_t voiceIdx = 0; voiceIdx < rs.voices.size(); ++voiceIdx) {
+        const VoiceStatus& voice = rs.voices[voiceIdx];
+
+        if (voice.bActive && (voice.trackIdx == trackIdx)) {
+            rs.spu.pVoices[voiceIdx].volume = getVoiceSpuVolume(voice, track);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Stop a track: quickly fade out all of its voices and execute no more commands for it
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void trackOff(RenderState& rs, const uint32_t trackIdx) noexcept {
+    for (uint32_t voiceIdx = 0; voiceIdx < rs.voices.size(); ++voiceIdx) {
+        VoiceStatus& voice = rs.voices[voiceIdx];
+
+        if (voice.bActive && (voice.trackIdx == trackIdx)) {
+            Spu::Voice& spuVoice = rs.spu.pVoices[voiceIdx];
+            spuVoice.env.releaseShift = rs.muteReleaseRate;
+            spuVoice.env.bReleaseExp = 1;
+
+            voice.releaseTimeMs = MAX_RELEASE_TIME_MS >> (31 - (rs.muteReleaseRate % 32));
+            voiceRelease(rs, voice, voiceIdx);
+        }
+    }
+
+    rs.tracks[trackIdx].bStopped = true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Execute the current command for a track and move onto the next command
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void execTrackCmd(RenderState& rs, const uint32_t trackIdx) noexcept {
+    TrackStatus& track = rs.tracks[trackIdx];
+    const Track& trackData = *track.pTrack;
+    const TrackCmd& cmd = trackData.cmds[track.cmdIdx];
+    const bool bIsPsxTrack = (trackData.driverId == WmdSoundDriverId::PSX);
+
+    // Goes to the given command and gets the delay until it executes.
+    // Note: jumps to labels skip the delay for the command jumped to, same as the game.
+    const auto gotoCmd = [&](const uint32_t cmdIdx, const bool bSkipDelay) noexcept {
+        track.cmdIdx = cmdIdx;
+
+        if (cmdIdx < trackData.cmds.size()) {
+            if (!bSkipDelay) {
+                track.qnpTillNextCmd = trackData.cmds[cmdIdx].delayQnp;
+            }
+        } else {
+            track.bStopped = true;  // Ran off the end of the track: there is nothing more to do
+        }
+    };
+
+    const auto getLabelCmdIdx = [&](const int32_t labelIdx, uint32_t& cmdIdxOut) noexcept {
+        if ((labelIdx < 0) || (labelIdx >= (int32_t) trackData.labels.size()))
+            return false;
+
+        cmdIdxOut = trackData.labels[labelIdx];
+        return true;
+    };
+
+    switch (cmd.type) {
+        case WmdTrackCmdType::PatchChg:
+            if (bIsPsxTrack) {
+                track.patchIdx = (uint16_t) cmd.arg1;
+            }
+            break;
+
+        case WmdTrackCmdType::PitchMod:
+            if (bIsPsxTrack && (track.pitchCntrl != (int16_t) cmd.arg1)) {
+                track.pitchCntrl = (int16_t) cmd.arg1;
+                updateTrackVoicePitch(rs, trackIdx);
+            }
+            break;
+
+        case WmdTrackCmdType::VolumeMod:
+            if (bIsPsxTrack) {
+                track.volumeCntrl = (uint8_t) cmd.arg1;
+                updateTrackVoiceVolume(rs, trackIdx);
+            }
+            break;
+
+        case WmdTrackCmdType::PanMod:
+            if (bIsPsxTrack) {
+                track.panCntrl = (uint8_t) cmd.arg1;
+                updateTrackVoiceVolume(rs, trackIdx);
+            }
+            break;
+
+        case WmdTrackCmdType::NoteOn:
+            if (bIsPsxTrack) {
+                noteOn(rs, trackIdx, (uint8_t) cmd.arg1, (uint8_t) cmd.arg2);
+            }
+            break;
+
+        case WmdTrackCmdType::NoteOff:
+            if (bIsPsxTrack) {
+                noteOff(rs, trackIdx, (uint8_t) cmd.arg1);
+            }
+            break;
+
+        case WmdTrackCmdType::TrkTempo:
+            track.tempoPpiFrac = calcPartsPerTick(trackData.initPpq, (uint16_t) cmd.arg1);
+            break;
+
+        case WmdTrackCmdType::TrkJump: {
+            uint32_t dstCmdIdx = {};
+
+            if (getLabelCmdIdx((int16_t) cmd.arg1, dstCmdIdx)) {
+                track.qnpTillNextCmd = 0;
+                gotoCmd(dstCmdIdx, true);
+                return;
+            }
+        }   break;
+
+        case WmdTrackCmdType::TrkGosub: {
+            // Note: the game doesn't reset the delay until the next command here
+            uint32_t dstCmdIdx = {};
+
+            if (getLabelCmdIdx((int16_t) cmd.arg1, dstCmdIdx)) {
+                track.locStack.push_back(track.cmdIdx + 1);
+                gotoCmd(dstCmdIdx, true);
+                return;
+            }
+        }   break;
+
+        case WmdTrackCmdType::TrkRet:
+            if (!track.locStack.empty()) {
+                const uint32_t retCmdIdx = track.locStack.back();
+                track.locStack.pop_back();
+                gotoCmd(retCmdIdx, false);
+                return;
+            }
+            break;
+
+        case WmdTrackCmdType::TrkEnd:
+        case WmdTrackCmdType::SeqEnd:
+            trackOff(rs, trackIdx);
+            return;
+
+        default:
+            break;
+    }
+
+    gotoCmd(track.cmdIdx + 1, false);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Do one 120 Hz sequencer tick: advance all tracks and run any commands that are due, then free voices that have finished.
+// Returns 'false' if the sequence has finished and all voices have gone silent.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool doSequencerTick(RenderState& rs) noexcept {
+    // Advance time
+    const uint32_t absTimeMsFrac = rs.absTimeMsFrac + MS_FRAC_STEP;
+    rs.absTimeMs += absTimeMsFrac >> 16;
+    rs.absTimeMsFrac = absTimeMsFrac & 0xFFFF;
+
+    // Advance all tracks and execute commands
+    bool bAnyTrackPlaying = false;
+
+    for (uint32_t trackIdx = 0; trackIdx < rs.tracks.size(); ++trackIdx) {
+        TrackStatus& track = rs.tracks[trackIdx];
+
+        if (track.bStopped)
+            continue;
+
+        track.deltaTimeQnpFrac += track.tempoPpiFrac;
+        track.absTimeQnp += track.deltaTimeQnpFrac >> 16;
+        track.deltaTimeQnp += track.deltaTimeQnpFrac >> 16;
+        track.deltaTimeQnpFrac &= 0xFFFF;
+
+        for (uint32_t numCmds = 0; (!track.bStopped) && (track.deltaTimeQnp >= track.qnpTillNextCmd); ++numCmds) {
+            if (numCmds >= MAX_CMDS_PER_TICK) {
+                std::printf("Warning: track %u executed too many commands in one tick! Stopping the track.\n", trackIdx);
+                trackOff(rs, trackIdx);
+                break;
+            }
+
+            track.deltaTimeQnp -= track.qnpTillNextCmd;
+            execTrackCmd(rs, trackIdx);
+        }
+
+        bAnyTrackPlaying |= (!track.bStopped);
+    }
+
+    // Free voices that have finished releasing or that the SPU has switched off
+    bool bAnySpuVoiceSounding = false;
+
+    for (uint32_t voiceIdx = 0; voiceIdx < rs.voices.size(); ++voiceIdx) {
+        VoiceStatus& voice = rs.voices[voiceIdx];
+        const bool bSpuVoiceOff = (rs.spu.pVoices[voiceIdx].envPhase == Spu::EnvPhase::Off);
+
+        if (voice.bActive) {
+            const bool bDoneReleasing = (voice.bRelease && (rs.absTimeMs > voice.onOffAbsTimeMs));
+
+            if (bDoneReleasing || bSpuVoiceOff) {
+                voiceParmOff(rs, voice);
+            }
+        }
+
+        bAnySpuVoiceSounding |= (!bSpuVoiceOff);
+    }
+
+    return (bAnyTrackPlaying || bAnySpuVoiceSounding);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Convert an SPU output sample to 16-bit
+//------------------------------------------------------------------------------------------------------------------------------------------
+static int16_t toInt16Sample(const Spu::Sample sample) noexcept {
+    #if SIMPLE_SPU_FLOAT_SPU
+        return Spu::toInt16Sample(sample.value);
+    #else
+        return sample.value;
+    #endif
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Load all of the samples in the given LCD files into SPU RAM and record their addresses.
+// If a sample is in multiple LCD files then the first one is used.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void loadSamples(RenderState& rs, const std::vector<Lcd>& lcds, const uint32_t hwVoiceLimit) noexcept {
+    const uint32_t numPatchSamples = (uint32_t) rs.pModule->psxPatchGroup.patchSamples.size();
+    rs.sampleSpuAddrs.assign(numPatchSamples, 0);
+
+    // Figure out where each sample goes and how much SPU RAM is needed
+    uint32_t spuRamSize = SPU_RAM_SAMPLES_START;
+
+    for (const Lcd& lcd : lcds) {
+        for (const LcdSample& sample : lcd.samples) {
+            if ((sample.patchSampleIdx >= numPatchSamples) || (rs.sampleSpuAddrs[sample.patchSampleIdx] != 0))
+                continue;
+
+            rs.sampleSpuAddrs[sample.patchSampleIdx] = spuRamSize;
+            spuRamSize += ((uint32_t) sample.adpcmData.size() + 7) & ~7u;
+        }
+    }
+
+    // Create the SPU with enough RAM and copy the samples in
+    Spu::initCore(rs.spu, std::max(spuRamSize, MIN_SPU_RAM_SIZE), hwVoiceLimit);
+    Spu::initAdpcmCache(rs.spu, SPU_ADPCM_CACHE_SIZE);
+
+    rs.spu.masterVol.left = Spu::MAX_MASTER_VOLUME;
+    rs.spu.masterVol.right = Spu::MAX_MASTER_VOLUME;
+    rs.spu.bUnmute = true;
+
+    for (const Lcd& lcd : lcds) {
+        for (const LcdSample& sample : lcd.samples) {
+            if (sample.patchSampleIdx >= numPatchSamples)
+                continue;
+
+            const uint32_t spuAddr = rs.sampleSpuAddrs[sample.patchSampleIdx];
+            std::memcpy(rs.spu.pRam + spuAddr, sample.adpcmData.data(), sample.adpcmData.size());
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Render the given sequence to interleaved 16-bit stereo samples at 44.1 KHz.
+// Rendering stops once the sequence has finished and all voices are silent, or when the maximum number of sample frames is reached.
+// Samples are taken from the given LCD files: notes using samples that are not in any of the LCD files are not played.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool renderSequence(
+    const Module& module,
+    const std::vector<Lcd>& lcds,
+    const uint32_t sequenceIdx,
+    const uint32_t maxSampleFrames,
+    std::vector<int16_t>& samplesOut,
+    RenderStats& statsOut,
+    std::string& errorMsgOut
+) noexcept {
+    samplesOut.clear();
+    statsOut = {};
+
+    if (sequenceIdx >= module.sequences.size()) {
+        errorMsgOut = "Invalid sequence index within the module specified!";
+        return false;
+    }
+
+    // Setup the SPU and load the samples
+    RenderState rs = {};
+    rs.pModule = &module;
+
+    const uint32_t hwVoiceLimit = (module.psxPatchGroup.hwVoiceLimit > 0) ? module.psxPatchGroup.hwVoiceLimit : DEFAULT_HW_VOICE_LIMIT;
+    loadSamples(rs, lcds, hwVoiceLimit);
+    rs.voices.assign(hwVoiceLimit, VoiceStatus{});
+
+    // Figure out the release rate for muted voices using the fade time that PSX Doom uses ('wess_set_mute_release')
+    {
+        uint32_t approxReleaseTimeMs = MAX_RELEASE_TIME_MS;
+        rs.muteReleaseRate = 31;
+
+        while ((approxReleaseTimeMs > MUTE_RELEASE_TIME_MS) && (rs.muteReleaseRate != 0)) {
+            approxReleaseTimeMs >>= 1;
+            rs.muteReleaseRate -= 1;
+        }
+    }
+
+    // Initialize all the tracks in the sequence
+    const Sequence& sequence = module.sequences[sequenceIdx];
+
+    for (const Track& trackData : sequence.tracks) {
+        TrackStatus& track = rs.tracks.emplace_back();
+        track.pTrack = &trackData;
+        track.bStopped = trackData.cmds.empty();
+        track.patchIdx = trackData.initPatchIdx;
+        track.pitchCntrl = trackData.initPitchCntrl;
+        track.volumeCntrl = trackData.initVolumeCntrl;
+        track.panCntrl = trackData.initPanCntrl;
+        track.tempoPpiFrac = calcPartsPerTick(trackData.initPpq, trackData.initQpm);
+        track.qnpTillNextCmd = (!trackData.cmds.empty()) ? trackData.cmds[0].delayQnp : 0;
+    }
+
+    // Render the audio, stepping the SPU for the duration of each sequencer tick
+    using clock_t = std::chrono::high_resolution_clock;
+    const clock_t::time_point renderStartTime = clock_t::now();
+
+    samplesOut.reserve((size_t) std::min<uint32_t>(maxSampleFrames, SAMPLE_RATE * 60 * 10) * 2);
+    std::vector<Spu::StereoSample> tickSamples;
+    uint32_t numSampleFrames = 0;
+    uint32_t numTicks = 0;
+
+    while (numSampleFrames < maxSampleFrames) {
+        if (!doSequencerTick(rs))
+            break;
+
+        numTicks++;
+        statsOut.peakActiveVoices = std::max(statsOut.peakActiveVoices, rs.numActiveVoices);
+
+        // Note: 44,100 Hz doesn't divide evenly into 120 Hz ticks, so figure out where this tick ends to avoid drift
+        const uint32_t tickEndFrame = (uint32_t) std::min<uint64_t>((uint64_t) numTicks * SAMPLE_RATE / TICKS_PER_SEC, maxSampleFrames);
+        const uint32_t numTickFrames = tickEndFrame - numSampleFrames;
+        tickSamples.resize(numTickFrames);
+        Spu::stepCoreBlock(rs.spu, tickSamples.data(), numTickFrames);
+
+        for (const Spu::StereoSample& sample : tickSamples) {
+            samplesOut.push_back(toInt16Sample(sample.left));
+            samplesOut.push_back(toInt16Sample(sample.right));
+        }
+
+        numSampleFrames = tickEndFrame;
+    }
+
+    statsOut.numSampleFrames = numSampleFrames;
+    statsOut.numTicks = numTicks;
+    statsOut.renderTimeSec = std::chrono::duration<double>(clock_t::now() - renderStartTime).count();
+
+    Spu::destroyCore(rs.spu);
+    return true;
+}
+
+END_NAMESPACE(SequenceRenderer)
+END_NAMESPACE(AudioTools)
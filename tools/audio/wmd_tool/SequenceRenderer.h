@@ -0,0 +1,39 @@
+#pragma once
+
+#include "Macros.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+BEGIN_NAMESPACE(AudioTools)
+
+struct Lcd;
+struct Module;
+
+BEGIN_NAMESPACE(SequenceRenderer)
+
+static constexpr uint32_t SAMPLE_RATE = 44100;      // Sample rate of rendered audio: the native rate of the PlayStation SPU
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Stats for a sequence render: how much audio was produced and how long it took
+//------------------------------------------------------------------------------------------------------------------------------------------
+struct RenderStats {
+    uint32_t    numSampleFrames;    // Number of stereo sample frames rendered
+    uint32_t    numTicks;           // Number of 120 Hz sequencer ticks executed
+    uint32_t    peakActiveVoices;   // The most voices that were active at any one time
+    double      renderTimeSec;      // How long the render took in seconds, excluding loading the samples into SPU RAM
+};
+
+bool renderSequence(
+    const Module& module,
+    const std::vector<Lcd>& lcds,
+    const uint32_t sequenceIdx,
+    const uint32_t maxSampleFrames,
+    std::vector<int16_t>& samplesOut,
+    RenderStats& statsOut,
+    std::string& errorMsgOut
+) noexcept;
+
+END_NAMESPACE(SequenceRenderer)
+END_NAMESPACE(AudioTools)
@@ -1,13 +1,16 @@
 //------------------------------------------------------------------------------------------------------------------------------------------
 // WmdTool:
 //      Utilities for converting .WMD files (Williams Module files) to JSON and visa versa.
-//      Also utilities for importing and exporting sequences from and to MIDI.
+//      Also utilities for importing and exporting sequences from and to MIDI, and for rendering sequences to audio.
 //------------------------------------------------------------------------------------------------------------------------------------------
+#include "Lcd.h"
 #include "MidiConvert.h"
 #include "MidiTypes.h"
 #include "MidiUtils.h"
 #include "Module.h"
 #include "ModuleFileUtils.h"
+#include "SequenceRenderer.h"
+#include "WavUtils.h"
 
 #include <algorithm>
 #include <filesystem>
@@ -94,6 +97,20 @@ Command switches and arguments:
         Example:
             WmdTool -copy-patches DOOMSND.WMD DOOMSND.json 0 1 2
             WmdTool -copy-patches DOOMSND.json DOOMSND.WMD 5
+
+    -render-sequence <INPUT JSON OR WMD FILE PATH> <SEQUENCE INDEX> <OUTPUT WAV FILE PATH> <MAX SECONDS> [LCD FILE PATH...]
+        Render a sequence in the given module to a 44.1 KHz stereo .wav file, using the PlayStation SPU emulation from PsyDoom.
+        Rendering runs as fast as possible and the time taken is reported, so this can also be used as a benchmark.
+        Notes:
+            (1) The sequence is specified by its index in the array of sequences in the module.
+            (2) The input module file can be in JSON or binary .WMD format.
+            (3) Sound samples are loaded from the given .LCD files. Notes using samples not found in any of the files are not played.
+                Music in PSX Doom normally requires the samples in 'DOOMSFX.LCD' as well as the samples for the music track.
+            (4) Rendering stops once the sequence ends and all voices have gone silent, or when the max time is reached.
+                Music sequences normally loop forever, so the max time determines their length.
+            (5) Reverb is not applied, since it is decided by the game rather than the module.
+        Example:
+            WmdTool -render-sequence DOOMSND.WMD 90 MAP01_MUSIC.WAV 120 DOOMSFX.LCD MUSLEV1.LCD
 )";
 
 static void printHelp() noexcept {
@@ -398,6 +415,70 @@ static bool copyPatchesOrSequences(
     return true;
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Render a sequence to a .wav file using the given LCD files for sound samples, and report how long the render took
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool renderSequence(
+    const char* const moduleFilePath,
+    const int sequenceIdx,
+    const char* const wavFileOut,
+    const double maxSeconds,
+    const std::vector<const char*>& lcdFilePaths
+) noexcept {
+    // Read the input module file firstly
+    Module module = {};
+    bool bIsJsonModule = {};
+
+    if (!readModuleFile(moduleFilePath, bIsJsonModule, module))
+        return false;
+
+    // Is the sequence index in range?
+    if ((sequenceIdx < 0) || (sequenceIdx >= (int) module.sequences.size())) {
+        std::printf("Invalid sequence index within the module specified! Valid range is 0-%zu!\n", module.sequences.size());
+        return false;
+    }
+
+    // Read all of the LCD files
+    std::vector<Lcd> lcds;
+    std::string errorMsg;
+
+    for (const char* const lcdFilePath : lcdFilePaths) {
+        if (!lcds.emplace_back().readFromLcdFile(lcdFilePath, module.psxPatchGroup, errorMsg)) {
+            std::printf("%s\n", errorMsg.c_str());
+            return false;
+        }
+    }
+
+    // Do the render
+    const uint32_t maxSampleFrames = (uint32_t) std::min(maxSeconds * SequenceRenderer::SAMPLE_RATE, (double) UINT32_MAX / 2);
+    std::vector<int16_t> samples;
+    SequenceRenderer::RenderStats stats = {};
+
+    if (!SequenceRenderer::renderSequence(module, lcds, (uint32_t) sequenceIdx, maxSampleFrames, samples, stats, errorMsg)) {
+        std::printf("%s\n", errorMsg.c_str());
+        return false;
+    }
+
+    if (samples.empty()) {
+        std::printf("Error! The sequence produced no audio!\n");
+        return false;
+    }
+
+    // Save the output .wav file
+    if (!WavUtils::writePcmSoundToWavFile(wavFileOut, samples.data(), (uint32_t) samples.size(), 2, SequenceRenderer::SAMPLE_RATE, 0, 0)) {
+        std::printf("Error! Failed to write to the output .wav file '%s'! Is that file path writable or is the disk full?\n", wavFileOut);
+        return false;
+    }
+
+    // Report the stats for the render
+    const double audioSeconds = (double) stats.numSampleFrames / SequenceRenderer::SAMPLE_RATE;
+    const double renderSeconds = std::max(stats.renderTimeSec, 1e-9);
+
+    std::printf("Rendered %.2f seconds of audio (%u sample frames, %u sequencer ticks, %u peak voices).\n", audioSeconds, stats.numSampleFrames, stats.numTicks, stats.peakActiveVoices);
+    std::printf("Render time: %.3f seconds, %.0f samples/sec, %.1fx realtime.\n", stats.renderTimeSec, stats.numSampleFrames / renderSeconds, audioSeconds / renderSeconds);
+    return true;
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Program entrypoint
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -499,6 +580,32 @@ int main(int argc, const char* const argv[]) noexcept {
             return (copyPatchesOrSequences(srcModuleFilePath, dstModuleFilePath, bCopySequences, elemIndexesToCopy)) ? 0 : 1;
         }
     }
+    else if (std::strcmp(cmdSwitch, "-render-sequence") == 0) {
+        if (argc >= 6) {
+            const char* const moduleFilePath = argv[2];
+            const char* const sequenceIdxStr = argv[3];
+            const char* const wavFilePath = argv[4];
+            const char* const maxSecondsStr = argv[5];
+            int sequenceIdx = {};
+            double maxSeconds = {};
+
+            try {
+                sequenceIdx = std::stoi(sequenceIdxStr);
+                maxSeconds = std::stod(maxSecondsStr);
+            } catch (...) {
+                printHelp();
+                return 1;
+            }
+
+            if (maxSeconds <= 0) {
+                printHelp();
+                return 1;
+            }
+
+            const std::vector<const char*> lcdFilePaths(argv + 6, argv + argc);
+            return (renderSequence(moduleFilePath, sequenceIdx, wavFilePath, maxSeconds, lcdFilePaths)) ? 0 : 1;
+        }
+    }
 
     printHelp();
     return 1;
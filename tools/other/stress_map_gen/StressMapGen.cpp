@@ -0,0 +1,1033 @@
+//------------------------------------------------------------------------------------------------------------------------------------------
+// StressMapGen:
+//      Generates synthetic PlayStation Doom format map WADs of a configurable size, for measuring how the engine scales with map data.
+//
+//      The map is a grid of square rooms (one sector and one subsector each) which are all open to each other, so a lot of the map is
+//      visible at once. Floor and ceiling heights alternate in a checker pattern so that upper and lower walls get drawn too. Room
+//      borders can be split into several collinear lines to raise the line count independently of the sector count. Since all lines are
+//      axis aligned and lie on the room borders, an exact BSP tree is built by recursively splitting the grid along room borders and no
+//      segs ever need to be split.
+//
+//      Optionally rooms can also contain monsters, perpetually moving platforms, repeating scripted actions and light effects. Moving
+//      platforms and scripted actions are driven by a generated 'SCRIPTS' lump, using the PsyDoom scripted sector special '300'.
+//
+//      If the map exceeds the limits of the original map format then the extended (32-bit index) map format is written, which requires
+//      a limit removing build of PsyDoom to load.
+//------------------------------------------------------------------------------------------------------------------------------------------
+#include "Endian.h"
+#include "FileUtils.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Help/usage printing
+//------------------------------------------------------------------------------------------------------------------------------------------
+static const char* const HELP_STR =
+R"(Usage: StressMapGen [OPTIONS] <OUTPUT WAD FILE PATH>
+
+Options:
+    -sectors <COUNT>
+        The number of sectors (rooms) to generate; rounded up to fill a rectangular grid. Default: 64.
+    -lines <COUNT>
+        The minimum number of lines to generate. Room borders are split into collinear lines to reach this count.
+    -monsters <COUNT>
+        The number of monsters to place, spread evenly among the rooms. Default: 0.
+    -monstertype <DOOMED NUMBER>
+        Which type of thing to use for monsters. Default: 3001 (Imp).
+    -movers <COUNT>
+        The number of rooms with a perpetually moving platform floor (driven by a scripted action). Default: 0.
+    -scripts <COUNT>
+        The number of rooms with a scripted action that repeats every game tick (scrolls the floor texture). Default: 0.
+    -lights <COUNT>
+        The number of rooms with a light effect (flicker, strobe, glow etc.). Default: 0.
+    -seed <NUMBER>
+        Seed used to choose which rooms get movers, scripts and lights. Default: 1.
+    -mapname <NAME>
+        The name of the map marker lump. Default: MAP01.
+    -walltex <NAME>, -steptex <NAME>
+        The textures used for walls on the edge of the map and for upper and lower walls. Defaults: MARBLE04, METAL01.
+    -floorflat <NAME>, -ceilflat <NAME>
+        The flats used for floors and ceilings. Defaults: BRN14, ROK02.
+
+The output is an original PSX Doom format map WAD (texture names, not Final Doom texture indexes). To play it, put it in a mod
+data directory in place of an existing map WAD (e.g 'MAP01.WAD').
+
+Example:
+    StressMapGen -sectors 4096 -lines 20000 -monsters 500 -movers 200 -scripts 100 -lights 300 MAP01.WAD
+)";
+
+static void printHelp() noexcept {
+    std::printf("%s\n", HELP_STR);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Constants
+//------------------------------------------------------------------------------------------------------------------------------------------
+static constexpr int32_t MAX_CELL_SIZE          = 256;          // Largest room size
+static constexpr int32_t MIN_CELL_SIZE          = 64;           // Smallest room size: must leave space for the player and monsters to move
+static constexpr int32_t MAX_MAP_HALF_EXTENT    = 32000;        // Map coordinates must fit in 16-bits
+static constexpr int32_t MAX_16BIT_INDEX        = 32767;        // Largest index allowed by the original map format
+static constexpr int32_t MIN_MONSTER_SPACING    = 48;           // Minimum distance between monsters placed in the same room
+static constexpr int32_t BLOCKMAP_CELL_SHIFT    = 7;            // Blockmap cells are 128x128 units
+static constexpr size_t  MAX_NICE_REJECT_SIZE   = 512 * 1024;   // Warn if the 'REJECT' lump is bigger than this
+static constexpr int32_t MAX_BLOCKMAP_CELLS     = 16384;        // Rooms are shrunk for big maps to keep the blockmap offsets table under this size
+
+static constexpr int32_t SCRIPT_ACTION_MOVER    = 1;            // Script action number (sector tag) that starts a perpetual platform
+static constexpr int32_t SCRIPT_ACTION_REPEAT   = 2;            // Script action number (sector tag) that starts a repeating action
+static constexpr int32_t SECTOR_SPECIAL_SCRIPT  = 300;          // PsyDoom 'Scripted Sector Special Spawn'
+
+static constexpr int16_t ML_BLOCKING            = 0x1;
+static constexpr int16_t ML_TWOSIDED            = 0x4;
+static constexpr int16_t MTF_ALL_SKILLS         = 0x7;
+
+// Sector light specials cycled through for rooms with light effects
+static constexpr int16_t LIGHT_SPECIALS[] = { 1, 2, 3, 8, 17, 200, 201, 202 };
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Generation settings
+//------------------------------------------------------------------------------------------------------------------------------------------
+struct Settings {
+    int32_t         numSectors = 64;
+    int32_t         minLines = 0;
+    int32_t         numMonsters = 0;
+    int32_t         monsterType = 3001;
+    int32_t         numMovers = 0;
+    int32_t         numScripts = 0;
+    int32_t         numLights = 0;
+    uint32_t        seed = 1;
+    std::string     mapName = "MAP01";
+    std::string     wallTex = "MARBLE04";
+    std::string     stepTex = "METAL01";
+    std::string     floorFlat = "BRN14";
+    std::string     ceilFlat = "ROK02";
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// The layout of the grid of rooms.
+//
+// Vertices are numbered with the room corners first, followed by the extra vertices along horizontal borders and then vertical borders.
+// Lines are numbered with all horizontal border lines first, followed by all vertical border lines.
+//------------------------------------------------------------------------------------------------------------------------------------------
+struct Grid {
+    int32_t     width;          // Number of rooms horizontally
+    int32_t     height;         // Number of rooms vertically
+    int32_t     cellSize;       // Size of each room in map units
+    int32_t     splits;         // How many lines each room border is split into
+    int32_t     originX;        // Bottom left corner of the map
+    int32_t     originY;
+
+    int32_t numCells() const noexcept { return width * height; }
+    int32_t numCorners() const noexcept { return (width + 1) * (height + 1); }
+    int32_t numHVertexes() const noexcept { return (height + 1) * width * (splits - 1); }
+    int32_t numVertexes() const noexcept { return numCorners() + numHVertexes() + (width + 1) * height * (splits - 1); }
+    int32_t numHLines() const noexcept { return (height + 1) * width * splits; }
+    int32_t numLines() const noexcept { return numHLines() + (width + 1) * height * splits; }
+    int32_t pieceSize() const noexcept { return cellSize / splits; }
+
+    int32_t cornerVertex(const int32_t x, const int32_t y) const noexcept {
+        return y * (width + 1) + x;
+    }
+
+    // Vertex 'piece' (0 to 'splits') along the horizontal border at row 'y', for the room at column 'x'
+    int32_t hVertex(const int32_t x, const int32_t y, const int32_t piece) const noexcept {
+        if (piece <= 0)
+            return cornerVertex(x, y);
+
+        if (piece >= splits)
+            return cornerVertex(x + 1, y);
+
+        return numCorners() + (y * width + x) * (splits - 1) + (piece - 1);
+    }
+
+    // Vertex 'piece' (0 to 'splits') along the vertical border at column 'x', for the room at row 'y'
+    int32_t vVertex(const int32_t x, const int32_t y, const int32_t piece) const noexcept {
+        if (piece <= 0)
+            return cornerVertex(x, y);
+
+        if (piece >= splits)
+            return cornerVertex(x, y + 1);
+
+        return numCorners() + numHVertexes() + (x * height + y) * (splits - 1) + (piece - 1);
+    }
+
+    int32_t hLine(const int32_t x, const int32_t y, const int32_t piece) const noexcept {
+        return (y * width + x) * splits + piece;
+    }
+
+    int32_t vLine(const int32_t x, const int32_t y, const int32_t piece) const noexcept {
+        return numHLines() + (x * height + y) * splits + piece;
+    }
+};
+
+// What special feature (if any) a room has
+enum class RoomType : uint8_t {
+    Plain,
+    Mover,
+    Script,
+    Light
+};
+
+// Map data which is needed to build more than one lump
+struct MapLine {
+    int32_t     vertex1;
+    int32_t     vertex2;
+    int32_t     sidenum[2];
+};
+
+struct Lump {
+    std::string             name;
+    std::vector<uint8_t>    data;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Helpers: write little endian values and fixed size names to a byte vector
+//------------------------------------------------------------------------------------------------------------------------------------------
+template <class T>
+static void writeValue(std::vector<uint8_t>& out, const T value) noexcept {
+    const T valueLE = Endian::hostToLittle(value);
+    const size_t oldSize = out.size();
+    out.resize(oldSize + sizeof(T));
+    std::memcpy(out.data() + oldSize, &valueLE, sizeof(T));
+}
+
+static void writeName8(std::vector<uint8_t>& out, const std::string& name) noexcept {
+    char chars[8] = {};
+    std::memcpy(chars, name.data(), std::min<size_t>(name.size(), 8));
+    out.insert(out.end(), chars, chars + 8);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Parses a non-negative integer command line argument, returning 'false' if invalid
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool parseCount(const char* const str, int32_t& valueOut) noexcept {
+    char* pEnd = nullptr;
+    const long value = std::strtol(str, &pEnd, 10);
+
+    if ((pEnd == str) || (*pEnd != 0) || (value < 0) || (value > INT32_MAX))
+        return false;
+
+    valueOut = (int32_t) value;
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Figures out the grid layout for the requested number of sectors and lines, returning 'false' if the map would be too big
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool makeGrid(const Settings& settings, Grid& grid) noexcept {
+    grid.width = std::max((int32_t) std::ceil(std::sqrt((double) std::max(settings.numSectors, 2))), 2);
+    grid.height = std::max((std::max(settings.numSectors, 2) + grid.width - 1) / grid.width, 1);
+    grid.cellSize = std::min(MAX_CELL_SIZE, (MAX_MAP_HALF_EXTENT * 2) / std::max(grid.width, grid.height));
+    grid.splits = 1;
+
+    if (grid.cellSize < MIN_CELL_SIZE) {
+        std::printf("Too many sectors: the map would not fit within the 16-bit coordinate limits of the map format!\n");
+        return false;
+    }
+
+    // If the rooms need to be shrunk to keep the blockmap small then use a power of two size, so that room borders don't straddle blockmap cells
+    const double maxBlockmapCellSize = std::sqrt((double) MAX_BLOCKMAP_CELLS / grid.numCells()) * (1 << BLOCKMAP_CELL_SHIFT);
+
+    if (grid.cellSize > maxBlockmapCellSize) {
+        int32_t shrunkCellSize = MAX_CELL_SIZE;
+
+        while ((shrunkCellSize > MIN_CELL_SIZE) && ((shrunkCellSize > grid.cellSize) || (shrunkCellSize > maxBlockmapCellSize))) {
+            shrunkCellSize /= 2;
+        }
+
+        grid.cellSize = shrunkCellSize;
+    }
+
+    // Split each room border into more lines if needed, keeping the room size a multiple of the line length
+    const int32_t baseNumLines = grid.numLines();
+
+    if (settings.minLines > baseNumLines) {
+        grid.splits = (settings.minLines + baseNumLines - 1) / baseNumLines;
+
+        if (grid.splits > grid.cellSize) {
+            std::printf("Too many lines for the number of sectors: room borders can't be split into lines that small!\n");
+            return false;
+        }
+
+        grid.cellSize -= grid.cellSize % grid.splits;
+    }
+
+    grid.originX = -(grid.width * grid.cellSize) / 2;
+    grid.originY = -(grid.height * grid.cellSize) / 2;
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Decides which rooms get movers, scripts and lights: picks rooms in a shuffled order, never using the room with the player start
+//------------------------------------------------------------------------------------------------------------------------------------------
+static std::vector<RoomType> makeRoomTypes(const Settings& settings, const int32_t numCells, const int32_t playerCell) noexcept {
+    std::vector<int32_t> cellOrder;
+    cellOrder.reserve((size_t) numCells);
+
+    for (int32_t cellIdx = 0; cellIdx < numCells; ++cellIdx) {
+        if (cellIdx != playerCell) {
+            cellOrder.push_back(cellIdx);
+        }
+    }
+
+    uint32_t rngState = (settings.seed != 0) ? settings.seed : 1;
+
+    for (size_t i = cellOrder.size(); i > 1; --i) {
+        rngState ^= rngState << 13;
+        rngState ^= rngState >> 17;
+        rngState ^= rngState << 5;
+        std::swap(cellOrder[i - 1], cellOrder[rngState % i]);
+    }
+
+    std::vector<RoomType> roomTypes((size_t) numCells, RoomType::Plain);
+    size_t orderIdx = 0;
+
+    const auto assignRooms = [&](const int32_t count, const RoomType type) noexcept {
+        for (int32_t i = 0; i < count; ++i, ++orderIdx) {
+            roomTypes[(size_t) cellOrder[orderIdx]] = type;
+        }
+    };
+
+    assignRooms(settings.numMovers, RoomType::Mover);
+    assignRooms(settings.numScripts, RoomType::Script);
+    assignRooms(settings.numLights, RoomType::Light);
+    return roomTypes;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Builds the 'VERTEXES' lump (16.16 fixed point coordinates)
+//------------------------------------------------------------------------------------------------------------------------------------------
+static std::vector<uint8_t> buildVertexes(const Grid& grid) noexcept {
+    std::vector<int32_t> coords((size_t) grid.numVertexes() * 2);
+
+    const auto setVertex = [&](const int32_t vertexIdx, const int32_t x, const int32_t y) noexcept {
+        coords[(size_t) vertexIdx * 2 + 0] = x * 65536;
+        coords[(size_t) vertexIdx * 2 + 1] = y * 65536;
+    };
+
+    for (int32_t y = 0; y <= grid.height; ++y) {
+        for (int32_t x = 0; x <= grid.width; ++x) {
+            const int32_t cornerX = grid.originX + x * grid.cellSize;
+            const int32_t cornerY = grid.originY + y * grid.cellSize;
+
+            for (int32_t piece = 1; piece < grid.splits; ++piece) {
+                if (x < grid.width) {
+                    setVertex(grid.hVertex(x, y, piece), cornerX + piece * grid.pieceSize(), cornerY);
+                }
+
+                if (y < grid.height) {
+                    setVertex(grid.vVertex(x, y, piece), cornerX, cornerY + piece * grid.pieceSize());
+                }
+            }
+
+            setVertex(grid.cornerVertex(x, y), cornerX, cornerY);
+        }
+    }
+
+    std::vector<uint8_t> out;
+    out.reserve(coords.size() * sizeof(int32_t));
+
+    for (const int32_t coord : coords) {
+        writeValue(out, coord);
+    }
+
+    return out;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Makes all the lines of the map and the sidedefs for them.
+//
+// The front (right hand) side of every line faces the room below or to the left of it, except for lines on the bottom and left edges of
+// the map which are reversed so that they face into the map. Each room's walls go clockwise around it, on the front side of the line if
+// the line belongs to the room above or right of it and on the back side otherwise.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void buildLines(
+    const Grid& grid,
+    const Settings& settings,
+    std::vector<MapLine>& linesOut,
+    std::vector<uint8_t>& sidedefsOut,
+    int32_t& numSidesOut
+) noexcept {
+    linesOut.resize((size_t) grid.numLines());
+    numSidesOut = 0;
+
+    const auto addSide = [&](const int32_t cellIdx, const bool bTwoSided) noexcept {
+        writeValue(sidedefsOut, (int16_t) 0);
+        writeValue(sidedefsOut, (int16_t) 0);
+        writeName8(sidedefsOut, (bTwoSided) ? settings.stepTex : "-");
+        writeName8(sidedefsOut, (bTwoSided) ? settings.stepTex : "-");
+        writeName8(sidedefsOut, (bTwoSided) ? "-" : settings.wallTex);
+        writeValue(sidedefsOut, (int16_t) cellIdx);
+        return numSidesOut++;
+    };
+
+    const auto makeLine = [&](const int32_t lineIdx, const int32_t v1, const int32_t v2, const int32_t frontCell, const int32_t backCell) noexcept {
+        MapLine& line = linesOut[(size_t) lineIdx];
+        line.vertex1 = v1;
+        line.vertex2 = v2;
+        line.sidenum[0] = addSide(frontCell, (backCell >= 0));
+        line.sidenum[1] = (backCell >= 0) ? addSide(backCell, true) : -1;
+    };
+
+    for (int32_t y = 0; y <= grid.height; ++y) {
+        for (int32_t x = 0; x < grid.width; ++x) {
+            for (int32_t piece = 0; piece < grid.splits; ++piece) {
+                const int32_t v1 = grid.hVertex(x, y, piece);
+                const int32_t v2 = grid.hVertex(x, y, piece + 1);
+                const int32_t lineIdx = grid.hLine(x, y, piece);
+
+                if (y == 0) {
+                    makeLine(lineIdx, v2, v1, x, -1);
+                } else if (y == grid.height) {
+                    makeLine(lineIdx, v1, v2, (y - 1) * grid.width + x, -1);
+                } else {
+                    makeLine(lineIdx, v1, v2, (y - 1) * grid.width + x, y * grid.width + x);
+                }
+            }
+        }
+    }
+
+    for (int32_t x = 0; x <= grid.width; ++x) {
+        for (int32_t y = 0; y < grid.height; ++y) {
+            for (int32_t piece = 0; piece < grid.splits; ++piece) {
+                const int32_t v1 = grid.vVertex(x, y, piece);
+                const int32_t v2 = grid.vVertex(x, y, piece + 1);
+                const int32_t lineIdx = grid.vLine(x, y, piece);
+
+                if (x == 0) {
+                    makeLine(lineIdx, v1, v2, y * grid.width, -1);
+                } else if (x == grid.width) {
+                    makeLine(lineIdx, v2, v1, y * grid.width + x - 1, -1);
+                } else {
+                    makeLine(lineIdx, v2, v1, y * grid.width + x - 1, y * grid.width + x);
+                }
+            }
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Builds the 'LINEDEFS' lump in either the original or extended map format
+//------------------------------------------------------------------------------------------------------------------------------------------
+static std::vector<uint8_t> buildLinedefs(const std::vector<MapLine>& lines, const bool bExtended) noexcept {
+    std::vector<uint8_t> out;
+
+    for (const MapLine& line : lines) {
+        const int16_t flags = (line.sidenum[1] >= 0) ? ML_TWOSIDED : ML_BLOCKING;
+
+        if (bExtended) {
+            writeValue(out, line.vertex1);
+            writeValue(out, line.vertex2);
+            writeValue(out, flags);
+            writeValue(out, (int16_t) 0);       // Special
+            writeValue(out, (int16_t) 0);       // Tag
+            writeValue(out, (int16_t) 0);       // Padding
+            writeValue(out, line.sidenum[0]);
+            writeValue(out, line.sidenum[1]);
+        } else {
+            writeValue(out, (int16_t) line.vertex1);
+            writeValue(out, (int16_t) line.vertex2);
+            writeValue(out, flags);
+            writeValue(out, (int16_t) 0);
+            writeValue(out, (int16_t) 0);
+            writeValue(out, (int16_t) line.sidenum[0]);
+            writeValue(out, (int16_t) line.sidenum[1]);
+        }
+    }
+
+    return out;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Builds the 'SEGS', 'SSECTORS' and 'LEAFS' lumps: one subsector per room, with its segs (and leaf edges) going clockwise around the room
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void buildSubsectors(
+    const Grid& grid,
+    const std::vector<MapLine>& lines,
+    const bool bExtended,
+    std::vector<uint8_t>& segsOut,
+    std::vector<uint8_t>& subsectorsOut,
+    std::vector<uint8_t>& leafsOut,
+    int32_t& numSegsOut
+) noexcept {
+    numSegsOut = 0;
+
+    for (int32_t y = 0; y < grid.height; ++y) {
+        for (int32_t x = 0; x < grid.width; ++x) {
+            const int32_t firstSeg = numSegsOut;
+            std::vector<int32_t> leafVertexes;
+
+            const auto addSeg = [&](const int32_t lineIdx, const int32_t side, const int16_t angle) noexcept {
+                const MapLine& line = lines[(size_t) lineIdx];
+                const int32_t v1 = (side == 0) ? line.vertex1 : line.vertex2;
+                const int32_t v2 = (side == 0) ? line.vertex2 : line.vertex1;
+
+                if (bExtended) {
+                    writeValue(segsOut, v1);
+                    writeValue(segsOut, v2);
+                    writeValue(segsOut, lineIdx);
+                    writeValue(segsOut, angle);
+                    writeValue(segsOut, (int16_t) side);
+                    writeValue(segsOut, (int16_t) 0);   // Offset
+                    writeValue(segsOut, (int16_t) 0);   // Padding
+                } else {
+                    writeValue(segsOut, (int16_t) v1);
+                    writeValue(segsOut, (int16_t) v2);
+                    writeValue(segsOut, angle);
+                    writeValue(segsOut, (int16_t) lineIdx);
+                    writeValue(segsOut, (int16_t) side);
+                    writeValue(segsOut, (int16_t) 0);
+                }
+
+                leafVertexes.push_back(v1);
+                numSegsOut++;
+            };
+
+            // Top, right, bottom and then left walls of the room (binary angles: east = 0, north = 0x4000 etc.)
+            for (int32_t piece = 0; piece < grid.splits; ++piece) {
+                addSeg(grid.hLine(x, y + 1, piece), 0, (int16_t) 0x0000);
+            }
+
+            for (int32_t piece = grid.splits - 1; piece >= 0; --piece) {
+                addSeg(grid.vLine(x + 1, y, piece), 0, (int16_t) 0xC000);
+            }
+
+            for (int32_t piece = grid.splits - 1; piece >= 0; --piece) {
+                addSeg(grid.hLine(x, y, piece), (y == 0) ? 0 : 1, (int16_t) 0x8000);
+            }
+
+            for (int32_t piece = 0; piece < grid.splits; ++piece) {
+                addSeg(grid.vLine(x, y, piece), (x == 0) ? 0 : 1, (int16_t) 0x4000);
+            }
+
+            // Subsector and leaf for the room: each leaf edge starts at the 1st vertex of its seg
+            const int32_t numSegs = numSegsOut - firstSeg;
+
+            if (bExtended) {
+                writeValue(subsectorsOut, numSegs);
+                writeValue(subsectorsOut, firstSeg);
+            } else {
+                writeValue(subsectorsOut, (int16_t) numSegs);
+                writeValue(subsectorsOut, (int16_t) firstSeg);
+            }
+
+            writeValue(leafsOut, (uint16_t) numSegs);
+
+            for (int32_t edgeIdx = 0; edgeIdx < numSegs; ++edgeIdx) {
+                if (bExtended) {
+                    writeValue(leafsOut, leafVertexes[(size_t) edgeIdx]);
+                    writeValue(leafsOut, firstSeg + edgeIdx);
+                } else {
+                    writeValue(leafsOut, (int16_t) leafVertexes[(size_t) edgeIdx]);
+                    writeValue(leafsOut, (int16_t)(firstSeg + edgeIdx));
+                }
+            }
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Builds the BSP node for the given range of rooms and returns its child number, writing the nodes in the order required: children first.
+// Ranges are split along a room border in the middle of the longest axis, so that the tree is balanced.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static uint32_t buildNode(
+    const Grid& grid,
+    const bool bExtended,
+    const int32_t x1,
+    const int32_t y1,
+    const int32_t x2,
+    const int32_t y2,
+    std::vector<uint8_t>& nodesOut,
+    int32_t& numNodesOut
+) noexcept {
+    const uint32_t subsectorFlag = (bExtended) ? 0x80000000u : 0x8000u;
+
+    if ((x2 - x1 == 1) && (y2 - y1 == 1))
+        return (uint32_t)(y1 * grid.width + x1) | subsectorFlag;
+
+    // Split vertically (partition pointing north) or horizontally (partition pointing east).
+    // Child '0' is on the front (right) side of the partition line: the east half or the south half.
+    const bool bSplitX = (x2 - x1 >= y2 - y1);
+    int32_t childRanges[2][4];
+    int16_t partition[4];
+
+    const auto setRange = [](int32_t range[4], const int32_t rx1, const int32_t ry1, const int32_t rx2, const int32_t ry2) noexcept {
+        range[0] = rx1;
+        range[1] = ry1;
+        range[2] = rx2;
+        range[3] = ry2;
+    };
+
+    if (bSplitX) {
+        const int32_t midX = (x1 + x2) / 2;
+        setRange(childRanges[0], midX, y1, x2, y2);
+        setRange(childRanges[1], x1, y1, midX, y2);
+        partition[0] = (int16_t)(grid.originX + midX * grid.cellSize);
+        partition[1] = (int16_t)(grid.originY + y1 * grid.cellSize);
+        partition[2] = 0;
+        partition[3] = (int16_t) grid.cellSize;
+    } else {
+        const int32_t midY = (y1 + y2) / 2;
+        setRange(childRanges[0], x1, y1, x2, midY);
+        setRange(childRanges[1], x1, midY, x2, y2);
+        partition[0] = (int16_t)(grid.originX + x1 * grid.cellSize);
+        partition[1] = (int16_t)(grid.originY + midY * grid.cellSize);
+        partition[2] = (int16_t) grid.cellSize;
+        partition[3] = 0;
+    }
+
+    uint32_t children[2];
+
+    for (int32_t childIdx = 0; childIdx < 2; ++childIdx) {
+        const int32_t* const range = childRanges[childIdx];
+        children[childIdx] = buildNode(grid, bExtended, range[0], range[1], range[2], range[3], nodesOut, numNodesOut);
+    }
+
+    for (const int16_t coord : partition) {
+        writeValue(nodesOut, coord);
+    }
+
+    // Child bounding boxes: top, bottom, left, right
+    for (int32_t childIdx = 0; childIdx < 2; ++childIdx) {
+        const int32_t* const range = childRanges[childIdx];
+        writeValue(nodesOut, (int16_t)(grid.originY + range[3] * grid.cellSize));
+        writeValue(nodesOut, (int16_t)(grid.originY + range[1] * grid.cellSize));
+        writeValue(nodesOut, (int16_t)(grid.originX + range[0] * grid.cellSize));
+        writeValue(nodesOut, (int16_t)(grid.originX + range[2] * grid.cellSize));
+    }
+
+    for (const uint32_t child : children) {
+        if (bExtended) {
+            writeValue(nodesOut, child);
+        } else {
+            writeValue(nodesOut, (uint16_t) child);
+        }
+    }
+
+    return (uint32_t) numNodesOut++;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Builds the 'SECTORS' lump. Floor and ceiling heights alternate in a checker pattern, so that upper and lower walls are drawn.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static std::vector<uint8_t> buildSectors(const Grid& grid, const Settings& settings, const std::vector<RoomType>& roomTypes) noexcept {
+    std::vector<uint8_t> out;
+    int32_t numLightRooms = 0;
+
+    for (int32_t y = 0; y < grid.height; ++y) {
+        for (int32_t x = 0; x < grid.width; ++x) {
+            const bool bRaised = (((x + y) & 1) != 0);
+            const RoomType roomType = roomTypes[(size_t)(y * grid.width + x)];
+            int16_t special = 0;
+            int16_t tag = 0;
+
+            if (roomType == RoomType::Mover) {
+                special = SECTOR_SPECIAL_SCRIPT;
+                tag = SCRIPT_ACTION_MOVER;
+            } else if (roomType == RoomType::Script) {
+                special = SECTOR_SPECIAL_SCRIPT;
+                tag = SCRIPT_ACTION_REPEAT;
+            } else if (roomType == RoomType::Light) {
+                special = LIGHT_SPECIALS[numLightRooms % (int32_t)(sizeof(LIGHT_SPECIALS) / sizeof(LIGHT_SPECIALS[0]))];
+                numLightRooms++;
+            }
+
+            writeValue(out, (int16_t)((bRaised) ? 16 : 0));         // Floor height
+            writeValue(out, (int16_t)((bRaised) ? 176 : 160));      // Ceiling height
+            writeName8(out, settings.floorFlat);
+            writeName8(out, settings.ceilFlat);
+            out.push_back((uint8_t)((bRaised) ? 192 : 160));         // Light level
+            out.push_back(0);                                       // Color id
+            writeValue(out, special);
+            writeValue(out, tag);
+            out.push_back(0);                                       // Flags
+            out.push_back(0);                                       // Ceiling color id
+        }
+    }
+
+    return out;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Builds the 'THINGS' lump: the player start in the given room followed by monsters, spread evenly among all the other rooms.
+// Returns 'false' if the monsters won't fit.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool buildThings(const Grid& grid, const Settings& settings, const int32_t playerCell, std::vector<uint8_t>& out) noexcept {
+    const auto addThing = [&](const int32_t x, const int32_t y, const int16_t angle, const int16_t type) noexcept {
+        writeValue(out, (int16_t) x);
+        writeValue(out, (int16_t) y);
+        writeValue(out, angle);
+        writeValue(out, type);
+        writeValue(out, MTF_ALL_SKILLS);
+    };
+
+    const int32_t halfCell = grid.cellSize / 2;
+    const int32_t playerX = grid.originX + (playerCell % grid.width) * grid.cellSize + halfCell;
+    const int32_t playerY = grid.originY + (playerCell / grid.width) * grid.cellSize + halfCell;
+    addThing(playerX, playerY, 0, 1);
+
+    if (settings.numMonsters <= 0)
+        return true;
+
+    // Arrange the monsters in each room on a small grid
+    const int32_t numMonsterRooms = grid.numCells() - 1;
+    const int32_t monstersPerRoom = (settings.numMonsters + numMonsterRooms - 1) / numMonsterRooms;
+    const int32_t roomGridSize = (int32_t) std::ceil(std::sqrt((double) monstersPerRoom));
+    const int32_t spacing = grid.cellSize / (roomGridSize + 1);
+
+    if (spacing < MIN_MONSTER_SPACING) {
+        std::printf("Too many monsters for the number of sectors: they would not fit in the rooms!\n");
+        return false;
+    }
+
+    int32_t monstersLeft = settings.numMonsters;
+
+    for (int32_t slot = 0; (slot < monstersPerRoom) && (monstersLeft > 0); ++slot) {
+        for (int32_t cellIdx = 0; (cellIdx < grid.numCells()) && (monstersLeft > 0); ++cellIdx) {
+            if (cellIdx == playerCell)
+                continue;
+
+            const int32_t x = grid.originX + (cellIdx % grid.width) * grid.cellSize + ((slot % roomGridSize) + 1) * spacing;
+            const int32_t y = grid.originY + (cellIdx / grid.width) * grid.cellSize + ((slot / roomGridSize) + 1) * spacing;
+            addThing(x, y, (int16_t)((cellIdx * 45) % 360), (int16_t) settings.monsterType);
+            monstersLeft--;
+        }
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Builds the 'BLOCKMAP' lump, returning 'false' if too big for the format (16-bit offsets and line numbers).
+// Lines on the border between blockmap cells are only included in the cell on the positive side of the border, which is enough since the
+// engine always expands the bounding box being checked by the max thing radius. All empty cells share the same (empty) line list.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool buildBlockmap(const Grid& grid, const std::vector<MapLine>& lines, std::vector<uint8_t>& out) noexcept {
+    const int32_t mapW = grid.width * grid.cellSize;
+    const int32_t mapH = grid.height * grid.cellSize;
+    const int32_t bmapW = (mapW >> BLOCKMAP_CELL_SHIFT) + 1;
+    const int32_t bmapH = (mapH >> BLOCKMAP_CELL_SHIFT) + 1;
+    std::vector<std::vector<int32_t>> cellLines((size_t) bmapW * bmapH);
+
+    const auto getVertexPos = [&](const int32_t vertexIdx, int32_t& x, int32_t& y) noexcept {
+        if (vertexIdx < grid.numCorners()) {
+            x = (vertexIdx % (grid.width + 1)) * grid.cellSize;
+            y = (vertexIdx / (grid.width + 1)) * grid.cellSize;
+        } else if (vertexIdx < grid.numCorners() + grid.numHVertexes()) {
+            const int32_t idx = vertexIdx - grid.numCorners();
+            const int32_t cellIdx = idx / (grid.splits - 1);
+            x = (cellIdx % grid.width) * grid.cellSize + (idx % (grid.splits - 1) + 1) * grid.pieceSize();
+            y = (cellIdx / grid.width) * grid.cellSize;
+        } else {
+            const int32_t idx = vertexIdx - grid.numCorners() - grid.numHVertexes();
+            const int32_t cellIdx = idx / (grid.splits - 1);
+            x = (cellIdx / grid.height) * grid.cellSize;
+            y = (cellIdx % grid.height) * grid.cellSize + (idx % (grid.splits - 1) + 1) * grid.pieceSize();
+        }
+    };
+
+    for (int32_t lineIdx = 0; lineIdx < (int32_t) lines.size(); ++lineIdx) {
+        int32_t x1, y1, x2, y2;
+        getVertexPos(lines[(size_t) lineIdx].vertex1, x1, y1);
+        getVertexPos(lines[(size_t) lineIdx].vertex2, x2, y2);
+
+        // All lines are axis aligned: the line end at the highest coordinate along the line is not included in the cells it touches
+        const int32_t bx1 = std::min(x1, x2) >> BLOCKMAP_CELL_SHIFT;
+        const int32_t by1 = std::min(y1, y2) >> BLOCKMAP_CELL_SHIFT;
+        const int32_t bx2 = std::max((std::max(x1, x2) - (x1 != x2)) >> BLOCKMAP_CELL_SHIFT, bx1);
+        const int32_t by2 = std::max((std::max(y1, y2) - (y1 != y2)) >> BLOCKMAP_CELL_SHIFT, by1);
+
+        for (int32_t by = by1; by <= by2; ++by) {
+            for (int32_t bx = bx1; bx <= bx2; ++bx) {
+                cellLines[(size_t)(by * bmapW + bx)].push_back(lineIdx);
+            }
+        }
+    }
+
+    // Header, then the offset (in 16-bit words) to each cell's list of lines, then the '-1' terminated line lists
+    writeValue(out, (int16_t) grid.originX);
+    writeValue(out, (int16_t) grid.originY);
+    writeValue(out, (int16_t) bmapW);
+    writeValue(out, (int16_t) bmapH);
+
+    const size_t emptyListOffset = 4 + cellLines.size();
+    size_t listOffset = emptyListOffset + 1;
+
+    for (const std::vector<int32_t>& cell : cellLines) {
+        if (cell.empty()) {
+            writeValue(out, (uint16_t) emptyListOffset);
+            continue;
+        }
+
+        if (listOffset > UINT16_MAX) {
+            std::printf("The blockmap is too big for the map format (16-bit offsets)! Try fewer lines.\n");
+            return false;
+        }
+
+        writeValue(out, (uint16_t) listOffset);
+        listOffset += cell.size() + 1;
+    }
+
+    writeValue(out, (int16_t) -1);
+
+    for (const std::vector<int32_t>& cell : cellLines) {
+        if (cell.empty())
+            continue;
+
+        for (const int32_t lineIdx : cell) {
+            writeValue(out, (int16_t) lineIdx);
+        }
+
+        writeValue(out, (int16_t) -1);
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Builds the 'SCRIPTS' lump which drives the moving platforms and repeating scripted actions
+//------------------------------------------------------------------------------------------------------------------------------------------
+static std::string buildScripts() noexcept {
+    char script[2048];
+    std::snprintf(script, sizeof(script),
+R"(-- Generated by StressMapGen
+
+-- Start a platform which moves up and down forever: restarts itself when finished
+SetAction(%d, function()
+    local sector = GetTriggeringSector()
+    local plat = CustomPlatDef.new()
+    plat.startstate = 1
+    plat.finishstate = -1
+    plat.minheight = sector.floorheight
+    plat.maxheight = sector.floorheight + 64
+    plat.speed = 2
+    plat.waittime = 15
+    plat.startsound = 0
+    plat.movesound = 0
+    plat.stopsound = 0
+    plat.dofinishscript = true
+    plat.finishscript_actionnum = %d
+    EV_DoCustomPlat(sector, plat)
+end)
+
+-- Start an action which repeats every tic for the sector, scrolling its floor texture
+SetAction(%d, function()
+    ScheduleRepeatingAction(%d, 0, -1, 0, 0, GetTriggeringSector().index)
+end)
+
+SetAction(%d, function()
+    local sector = GetSector(GetCurActionUserdata())
+
+    if sector then
+        sector.floor_tex_offset_x = sector.floor_tex_offset_x + 1
+    end
+end)
+)",
+        SCRIPT_ACTION_MOVER, SCRIPT_ACTION_MOVER,
+        SCRIPT_ACTION_REPEAT, SCRIPT_ACTION_REPEAT + 1,
+        SCRIPT_ACTION_REPEAT + 1
+    );
+
+    return script;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Writes the specified lumps (all uncompressed) to a WAD file and returns 'true' if successful
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool writeWad(const char* const filePath, const std::vector<Lump>& lumps) noexcept {
+    std::vector<uint8_t> out;
+    out.insert(out.end(), { 'I', 'W', 'A', 'D' });
+    writeValue(out, (int32_t) lumps.size());
+    writeValue(out, (int32_t) 0);       // Directory offset: filled in below
+
+    std::vector<int32_t> lumpOffsets;
+    lumpOffsets.reserve(lumps.size());
+
+    for (const Lump& lump : lumps) {
+        lumpOffsets.push_back((int32_t) out.size());
+        out.insert(out.end(), lump.data.begin(), lump.data.end());
+        out.resize((out.size() + 3) & ~size_t(3));
+    }
+
+    const int32_t dirOffsetLE = Endian::hostToLittle((int32_t) out.size());
+    std::memcpy(out.data() + 8, &dirOffsetLE, sizeof(int32_t));
+
+    for (size_t lumpIdx = 0; lumpIdx < lumps.size(); ++lumpIdx) {
+        writeValue(out, lumpOffsets[lumpIdx]);
+        writeValue(out, (int32_t) lumps[lumpIdx].data.size());
+        writeName8(out, lumps[lumpIdx].name);
+    }
+
+    if (!FileUtils::writeDataToFile(filePath, out.data(), out.size())) {
+        std::printf("Failed to write to the output file '%s'! Is the path writeable?\n", filePath);
+        return false;
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Program entrypoint
+//------------------------------------------------------------------------------------------------------------------------------------------
+int main(int argc, const char* const argv[]) noexcept {
+    // Parse the command line
+    Settings settings;
+    int argIdx = 1;
+
+    for (; argIdx + 1 < argc; argIdx += 2) {
+        const char* const arg = argv[argIdx];
+        const char* const value = argv[argIdx + 1];
+        int32_t seed = 0;
+        bool bValidValue = true;
+
+        if (std::strcmp(arg, "-sectors") == 0) {
+            bValidValue = parseCount(value, settings.numSectors);
+        } else if (std::strcmp(arg, "-lines") == 0) {
+            bValidValue = parseCount(value, settings.minLines);
+        } else if (std::strcmp(arg, "-monsters") == 0) {
+            bValidValue = parseCount(value, settings.numMonsters);
+        } else if (std::strcmp(arg, "-monstertype") == 0) {
+            bValidValue = parseCount(value, settings.monsterType);
+        } else if (std::strcmp(arg, "-movers") == 0) {
+            bValidValue = parseCount(value, settings.numMovers);
+        } else if (std::strcmp(arg, "-scripts") == 0) {
+            bValidValue = parseCount(value, settings.numScripts);
+        } else if (std::strcmp(arg, "-lights") == 0) {
+            bValidValue = parseCount(value, settings.numLights);
+        } else if (std::strcmp(arg, "-seed") == 0) {
+            bValidValue = parseCount(value, seed);
+            settings.seed = (uint32_t) seed;
+        } else if (std::strcmp(arg, "-mapname") == 0) {
+            settings.mapName = value;
+        } else if (std::strcmp(arg, "-walltex") == 0) {
+            settings.wallTex = value;
+        } else if (std::strcmp(arg, "-steptex") == 0) {
+            settings.stepTex = value;
+        } else if (std::strcmp(arg, "-floorflat") == 0) {
+            settings.floorFlat = value;
+        } else if (std::strcmp(arg, "-ceilflat") == 0) {
+            settings.ceilFlat = value;
+        } else {
+            break;
+        }
+
+        if (!bValidValue) {
+            std::printf("Invalid value '%s' for option '%s'!\n", value, arg);
+            return 1;
+        }
+    }
+
+    if (argc - argIdx != 1) {
+        printHelp();
+        return 1;
+    }
+
+    const char* const outFilePath = argv[argIdx];
+
+    // Figure out the layout of the map and check it is within the limits of the map format
+    Grid grid = {};
+
+    if (!makeGrid(settings, grid))
+        return 1;
+
+    const int32_t numCells = grid.numCells();
+    const int32_t playerCell = (grid.height / 2) * grid.width + (grid.width / 2);
+
+    if (numCells > MAX_16BIT_INDEX) {
+        std::printf("Too many sectors: sidedefs can only refer to %d sectors!\n", MAX_16BIT_INDEX + 1);
+        return 1;
+    }
+
+    if (grid.numLines() > MAX_16BIT_INDEX) {
+        std::printf("Too many lines: the blockmap can only refer to %d lines!\n", MAX_16BIT_INDEX + 1);
+        return 1;
+    }
+
+    if ((int64_t) settings.numMovers + settings.numScripts + settings.numLights > numCells - 1) {
+        std::printf("Too many movers, scripts and lights: each needs its own sector, and at most %d are available!\n", numCells - 1);
+        return 1;
+    }
+
+    // Build the lines first, since the number of sides determines (along with the seg count etc.) whether the extended map format is needed.
+    // Each room has one seg per line around it and the BSP tree has one less node than there are rooms.
+    std::vector<MapLine> lines;
+    std::vector<uint8_t> sidedefs;
+    int32_t numSides = 0;
+    buildLines(grid, settings, lines, sidedefs, numSides);
+
+    const int64_t numSegsNeeded = (int64_t) numCells * grid.splits * 4;
+    const int64_t maxIndexUsed = std::max<int64_t>({ grid.numVertexes(), numSides, numSegsNeeded, numCells });
+    const bool bExtended = (maxIndexUsed > MAX_16BIT_INDEX);
+
+    std::vector<uint8_t> segs;
+    std::vector<uint8_t> subsectors;
+    std::vector<uint8_t> leafs;
+    std::vector<uint8_t> nodes;
+    int32_t numSegs = 0;
+    int32_t numNodes = 0;
+    buildSubsectors(grid, lines, bExtended, segs, subsectors, leafs, numSegs);
+    buildNode(grid, bExtended, 0, 0, grid.width, grid.height, nodes, numNodes);
+
+    std::vector<uint8_t> things;
+    std::vector<uint8_t> blockmap;
+    const std::vector<RoomType> roomTypes = makeRoomTypes(settings, numCells, playerCell);
+
+    if (!buildThings(grid, settings, playerCell, things))
+        return 1;
+
+    if (!buildBlockmap(grid, lines, blockmap))
+        return 1;
+
+    // Assemble the lumps and write the WAD.
+    // Nothing is ever rejected from sight checks, but the reject table must still be the full size expected for the sector count.
+    const size_t rejectSize = ((size_t) numCells * numCells + 7) / 8;
+    std::vector<Lump> lumps;
+    lumps.push_back(Lump{ settings.mapName, {} });
+    lumps.push_back(Lump{ "THINGS", std::move(things) });
+    lumps.push_back(Lump{ "LINEDEFS", buildLinedefs(lines, bExtended) });
+    lumps.push_back(Lump{ "SIDEDEFS", std::move(sidedefs) });
+    lumps.push_back(Lump{ "VERTEXES", buildVertexes(grid) });
+    lumps.push_back(Lump{ "SEGS", std::move(segs) });
+    lumps.push_back(Lump{ "SSECTORS", std::move(subsectors) });
+    lumps.push_back(Lump{ "NODES", std::move(nodes) });
+    lumps.push_back(Lump{ "SECTORS", buildSectors(grid, settings, roomTypes) });
+    lumps.push_back(Lump{ "REJECT", std::vector<uint8_t>(rejectSize, 0) });
+    lumps.push_back(Lump{ "BLOCKMAP", std::move(blockmap) });
+    lumps.push_back(Lump{ "LEAFS", std::move(leafs) });
+
+    if ((settings.numMovers > 0) || (settings.numScripts > 0)) {
+        const std::string scripts = buildScripts();
+        lumps.push_back(Lump{ "SCRIPTS", std::vector<uint8_t>(scripts.begin(), scripts.end()) });
+    }
+
+    if (bExtended) {
+        lumps.push_back(Lump{ "EXTMAP32", {} });
+    }
+
+    if (!writeWad(outFilePath, lumps))
+        return 1;
+
+    // The reject table size grows with the square of the sector count and is loaded (in full) into the level memory zone
+    if (rejectSize > MAX_NICE_REJECT_SIZE) {
+        std::printf("Warning: the reject table is %zu KiB and may not fit in memory on builds which don't remove limits!\n", rejectSize / 1024);
+    }
+
+    std::printf("Generated '%s' in the %s map format:\n", outFilePath, (bExtended) ? "extended (needs a limit removing build)" : "original");
+    std::printf("  Sectors:     %d (%d x %d rooms of %d units)\n", numCells, grid.width, grid.height, grid.cellSize);
+    std::printf("  Lines:       %d\n", grid.numLines());
+    std::printf("  Sides:       %d\n", numSides);
+    std::printf("  Vertexes:    %d\n", grid.numVertexes());
+    std::printf("  Segs:        %d\n", numSegs);
+    std::printf("  Nodes:       %d\n", numNodes);
+    std::printf("  Monsters:    %d\n", settings.numMonsters);
+    std::printf("  Movers:      %d\n", settings.numMovers);
+    std::printf("  Scripts:     %d\n", settings.numScripts);
+    std::printf("  Lights:      %d\n", settings.numLights);
+    return 0;
+}
@@ -0,0 +1,847 @@
+//------------------------------------------------------------------------------------------------------------------------------------------
+// WadCooker:
+//      Converts PC format wall textures (and optionally sprites) in a WAD to the PlayStation Doom format ahead of time.
+//      The output WAD can be loaded by the engine without any of the runtime PC texture conversion work.
+//
+//      PC wall textures defined by 'TEXTURE1', 'TEXTURE2' and 'PNAMES' are composited from their patches into 8-bit PSX texture lumps,
+//      which are placed between 'T_START' and 'T_END' markers in the output. The texture definition lumps and the patches themselves are
+//      not needed after this and are left out of the output. All other lumps are copied as-is.
+//
+//      Cooked lumps are compressed using the PSX Doom LZSS lump compression, whenever that makes them smaller.
+//------------------------------------------------------------------------------------------------------------------------------------------
+#include "Endian.h"
+#include "FileUtils.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Help/usage printing
+//------------------------------------------------------------------------------------------------------------------------------------------
+static const char* const HELP_STR =
+R"(Usage: WadCooker [OPTIONS] <INPUT WAD FILE PATH> <OUTPUT WAD FILE PATH>
+
+Options:
+    -sprites
+        Also convert sprites between 'S_START' and 'S_END' (or 'SS_START' and 'SS_END') markers from the PC patch format to the
+        PSX sprite format. Only use this if the sprites in the WAD are in PC format!
+
+    -psxpal <PSX PLAYPAL FILE PATH>
+        Remap the colors of cooked lumps from the PC palette to the closest colors in the given PlayStation Doom format palette lump
+        (PLAYPAL, in T1B5G5R5 format). Only the first palette in the file is used. Palette index '0' is reserved for transparency.
+        The PC palette is taken from the 'PLAYPAL' lump in the input WAD, unless specified with '-pcpal'.
+
+    -pcpal <PC PLAYPAL FILE PATH>
+        Use the given PC format palette (PLAYPAL, in R8G8B8 format) as the source palette when remapping colors with '-psxpal'.
+
+    -nocompress
+        Don't compress cooked lumps.
+
+Example:
+    WadCooker -psxpal PSX_PLAYPAL.lmp MYMOD.WAD MYMOD_COOKED.WAD
+)";
+
+static void printHelp() noexcept {
+    std::printf("%s\n", HELP_STR);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// WAD file structures as stored on disk (little endian)
+//------------------------------------------------------------------------------------------------------------------------------------------
+struct WadHeader {
+    char        fileId[4];      // 'IWAD' or 'PWAD'
+    int32_t     numLumps;       // Number of lumps in the WAD
+    int32_t     dirOffset;      // Offset of the lump directory in the WAD
+};
+
+struct WadDirEntry {
+    int32_t     offset;         // Offset of the lump data in the WAD
+    int32_t     size;           // Uncompressed size of the lump
+    char        name[8];        // Name of the lump: for PSX WADs the high bit of the 1st character is set if the lump is compressed
+};
+
+static_assert(sizeof(WadHeader) == 12);
+static_assert(sizeof(WadDirEntry) == 16);
+
+// Header for a PSX texture or sprite lump, which is followed by 8-bit pixels in row major order
+struct PsxTexHeader {
+    int16_t     offsetX;
+    int16_t     offsetY;
+    int16_t     width;
+    int16_t     height;
+};
+
+static_assert(sizeof(PsxTexHeader) == 8);
+
+// A single lump in a WAD being read or written
+struct Lump {
+    std::string             name;               // Uppercase name of the lump (without the compression flag)
+    int32_t                 size;               // Uncompressed size of the lump
+    bool                    bIsCompressed;      // True if the data is compressed with the PSX LZSS compression
+    std::vector<uint8_t>    data;               // The lump data as it is stored in the WAD
+};
+
+// Palette used for transparency in PSX textures
+static constexpr uint8_t TRANSPARENT_COLOR_IDX = 0;
+
+// Maps from PC palette indexes to the palette indexes used in the output (identity unless remapping colors)
+static uint8_t gColorRemap[256];
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Helpers: read little endian values from possibly unaligned memory and write them to a byte vector
+//------------------------------------------------------------------------------------------------------------------------------------------
+static int16_t readI16(const uint8_t* const pData) noexcept {
+    int16_t value;
+    std::memcpy(&value, pData, sizeof(value));
+    return Endian::littleToHost(value);
+}
+
+static int32_t readI32(const uint8_t* const pData) noexcept {
+    int32_t value;
+    std::memcpy(&value, pData, sizeof(value));
+    return Endian::littleToHost(value);
+}
+
+template <class T>
+static void writeValue(std::vector<uint8_t>& out, const T value) noexcept {
+    const T valueLE = Endian::hostToLittle(value);
+    const size_t oldSize = out.size();
+    out.resize(oldSize + sizeof(T));
+    std::memcpy(out.data() + oldSize, &valueLE, sizeof(T));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Makes an uppercase string from a lump name of up to 8 characters, optionally clearing the PSX compression flag on the 1st character
+//------------------------------------------------------------------------------------------------------------------------------------------
+static std::string makeLumpName(const char* const name, const bool bClearCompressedFlag) noexcept {
+    std::string str;
+
+    for (uint32_t i = 0; (i < 8) && name[i]; ++i) {
+        char c = name[i];
+
+        if ((i == 0) && bClearCompressedFlag) {
+            c = (char)((uint8_t) c & 0x7Fu);
+        }
+
+        str.push_back((c >= 'a' && c <= 'z') ? (char)(c - 32) : c);
+    }
+
+    return str;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Reads all of the lumps in the specified WAD file and returns 'true' if successful
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool readWad(const char* const filePath, std::string& fileIdOut, std::vector<Lump>& lumpsOut) noexcept {
+    const FileData file = FileUtils::getContentsOfFile(filePath);
+
+    if (!file.bytes) {
+        std::printf("Failed to read input WAD file '%s'! Is the path correct?\n", filePath);
+        return false;
+    }
+
+    const uint8_t* const pFileBytes = (const uint8_t*) file.bytes.get();
+    const size_t fileSize = file.size;
+
+    if (fileSize < sizeof(WadHeader)) {
+        std::printf("Input file '%s' is not a valid WAD file!\n", filePath);
+        return false;
+    }
+
+    fileIdOut.assign((const char*) pFileBytes, 4);
+    const int32_t numLumps = readI32(pFileBytes + 4);
+    const int32_t dirOffset = readI32(pFileBytes + 8);
+    const bool bValidHeader = (
+        ((fileIdOut == "IWAD") || (fileIdOut == "PWAD")) &&
+        (numLumps >= 0) &&
+        (dirOffset >= 0) &&
+        ((size_t) dirOffset + (size_t) numLumps * sizeof(WadDirEntry) <= fileSize)
+    );
+
+    if (!bValidHeader) {
+        std::printf("Input file '%s' is not a valid WAD file!\n", filePath);
+        return false;
+    }
+
+    // Note: the stored size of compressed lumps is not the size in the file, so use the offset of the next lump to figure out the raw size.
+    // This assumes lumps are stored in directory order, which is the case for PSX WADs - the only WADs with compressed lumps.
+    lumpsOut.clear();
+    lumpsOut.resize((size_t) numLumps);
+
+    for (int32_t lumpIdx = 0; lumpIdx < numLumps; ++lumpIdx) {
+        WadDirEntry entry;
+        std::memcpy(&entry, pFileBytes + dirOffset + lumpIdx * sizeof(WadDirEntry), sizeof(WadDirEntry));
+        entry.offset = Endian::littleToHost(entry.offset);
+        entry.size = Endian::littleToHost(entry.size);
+
+        Lump& lump = lumpsOut[(size_t) lumpIdx];
+        lump.name = makeLumpName(entry.name, true);
+        lump.size = entry.size;
+        lump.bIsCompressed = ((uint8_t) entry.name[0] & 0x80u);
+
+        int32_t rawSize = entry.size;
+
+        if (lump.bIsCompressed) {
+            int32_t nextOffset = dirOffset;
+
+            if (lumpIdx + 1 < numLumps) {
+                nextOffset = readI32(pFileBytes + dirOffset + (lumpIdx + 1) * sizeof(WadDirEntry));
+            }
+
+            rawSize = nextOffset - entry.offset;
+        }
+
+        if ((entry.offset < 0) || (rawSize < 0) || ((size_t) entry.offset + (size_t) rawSize > fileSize)) {
+            std::printf("Lump '%s' in WAD file '%s' is out of bounds!\n", lump.name.c_str(), filePath);
+            return false;
+        }
+
+        lump.data.assign(pFileBytes + entry.offset, pFileBytes + entry.offset + rawSize);
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Writes the specified lumps to a WAD file and returns 'true' if successful
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool writeWad(const char* const filePath, const std::string& fileId, const std::vector<Lump>& lumps) noexcept {
+    std::vector<uint8_t> out;
+    out.insert(out.end(), fileId.begin(), fileId.end());
+    writeValue(out, (int32_t) lumps.size());
+    writeValue(out, (int32_t) 0);       // Directory offset: filled in below
+
+    // Write the lump data in directory order (required so the raw size of compressed lumps can be determined), keeping it 4 byte aligned
+    std::vector<int32_t> lumpOffsets;
+    lumpOffsets.reserve(lumps.size());
+
+    for (const Lump& lump : lumps) {
+        lumpOffsets.push_back((int32_t) out.size());
+        out.insert(out.end(), lump.data.begin(), lump.data.end());
+        out.resize((out.size() + 3) & ~size_t(3));
+    }
+
+    const int32_t dirOffsetLE = Endian::hostToLittle((int32_t) out.size());
+    std::memcpy(out.data() + 8, &dirOffsetLE, sizeof(int32_t));
+
+    for (size_t lumpIdx = 0; lumpIdx < lumps.size(); ++lumpIdx) {
+        const Lump& lump = lumps[lumpIdx];
+        writeValue(out, lumpOffsets[lumpIdx]);
+        writeValue(out, lump.size);
+
+        char name[8] = {};
+        std::memcpy(name, lump.name.data(), std::min<size_t>(lump.name.size(), 8));
+
+        if (lump.bIsCompressed) {
+            name[0] = (char)((uint8_t) name[0] | 0x80u);
+        }
+
+        out.insert(out.end(), name, name + 8);
+    }
+
+    if (!FileUtils::writeDataToFile(filePath, out.data(), out.size())) {
+        std::printf("Failed to write to the output file '%s'! Is the path writeable?\n", filePath);
+        return false;
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Decompresses PSX LZSS compressed lump data, for verifying the output of 'compressLump'.
+// Returns 'false' if the data is malformed or doesn't decompress to exactly the expected size.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool decompressLump(const std::vector<uint8_t>& src, std::vector<uint8_t>& dst, const size_t expectedSize) noexcept {
+    dst.clear();
+    dst.reserve(expectedSize);
+    size_t srcIdx = 0;
+
+    while (srcIdx < src.size()) {
+        uint32_t idByte = src[srcIdx++];
+
+        for (uint32_t itemIdx = 0; itemIdx < 8; ++itemIdx, idByte >>= 1) {
+            if (idByte & 1) {
+                if (srcIdx + 2 > src.size())
+                    return false;
+
+                const uint32_t srcOffset = (((uint32_t) src[srcIdx] << 4) | ((uint32_t) src[srcIdx + 1] >> 4)) + 1;
+                const uint32_t numRepeatedBytes = (src[srcIdx + 1] & 0xFu) + 1;
+                srcIdx += 2;
+
+                if (numRepeatedBytes == 1)
+                    return (dst.size() == expectedSize);
+
+                if ((srcOffset > dst.size()) || (dst.size() + numRepeatedBytes > expectedSize))
+                    return false;
+
+                for (uint32_t i = 0; i < numRepeatedBytes; ++i) {
+                    dst.push_back(dst[dst.size() - srcOffset]);
+                }
+            } else {
+                if ((srcIdx >= src.size()) || (dst.size() >= expectedSize))
+                    return false;
+
+                dst.push_back(src[srcIdx++]);
+            }
+        }
+    }
+
+    return false;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Compresses lump data using the form of LZSS used by PSX Doom.
+//
+// Each group of 8 items is preceded by an id byte: bit 'N' being set means item 'N' is a back reference, otherwise it's a literal byte.
+// Back references are 2 bytes: 12 bits of 'distance - 1' (1-4096) followed by 4 bits of 'length - 1' (2-16).
+// A back reference with a length of '1' marks the end of the data. Matches are found greedily using hash chains on 3 byte prefixes.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static std::vector<uint8_t> compressLump(const std::vector<uint8_t>& src) noexcept {
+    constexpr uint32_t WINDOW_SIZE = 4096;
+    constexpr uint32_t MIN_MATCH = 3;
+    constexpr uint32_t MAX_MATCH = 16;
+    constexpr uint32_t HASH_SIZE = 1u << 14;
+    constexpr uint32_t MAX_CHAIN = 256;
+
+    const uint32_t srcSize = (uint32_t) src.size();
+    std::vector<int32_t> hashHeads(HASH_SIZE, -1);
+    std::vector<int32_t> prevInChain(srcSize, -1);
+
+    const auto hashAt = [&](const uint32_t pos) noexcept {
+        const uint32_t key = ((uint32_t) src[pos] << 16) | ((uint32_t) src[pos + 1] << 8) | (uint32_t) src[pos + 2];
+        return (key * 2654435761u) >> (32 - 14);
+    };
+
+    const auto insertPos = [&](const uint32_t pos) noexcept {
+        if (pos + MIN_MATCH <= srcSize) {
+            const uint32_t hash = hashAt(pos);
+            prevInChain[pos] = hashHeads[hash];
+            hashHeads[hash] = (int32_t) pos;
+        }
+    };
+
+    std::vector<uint8_t> out;
+    out.reserve(srcSize + srcSize / 8 + 16);
+
+    size_t idBytePos = 0;
+    uint32_t numGroupItems = 8;
+
+    const auto beginItem = [&](const bool bIsBackRef) noexcept {
+        if (numGroupItems == 8) {
+            idBytePos = out.size();
+            out.push_back(0);
+            numGroupItems = 0;
+        }
+
+        if (bIsBackRef) {
+            out[idBytePos] |= (uint8_t)(1u << numGroupItems);
+        }
+
+        ++numGroupItems;
+    };
+
+    uint32_t pos = 0;
+
+    while (pos < srcSize) {
+        // Find the longest match within the window
+        uint32_t bestLen = 0;
+        uint32_t bestDist = 0;
+
+        if (pos + MIN_MATCH <= srcSize) {
+            const uint32_t maxLen = std::min(MAX_MATCH, srcSize - pos);
+            int32_t candidate = hashHeads[hashAt(pos)];
+
+            for (uint32_t chainLen = 0; (candidate >= 0) && (chainLen < MAX_CHAIN); ++chainLen) {
+                const uint32_t dist = pos - (uint32_t) candidate;
+
+                if (dist > WINDOW_SIZE)
+                    break;
+
+                uint32_t len = 0;
+
+                while ((len < maxLen) && (src[(uint32_t) candidate + len] == src[pos + len])) {
+                    ++len;
+                }
+
+                if (len > bestLen) {
+                    bestLen = len;
+                    bestDist = dist;
+
+                    if (len == maxLen)
+                        break;
+                }
+
+                candidate = prevInChain[(uint32_t) candidate];
+            }
+        }
+
+        // Emit either a back reference or a literal byte
+        if (bestLen >= MIN_MATCH) {
+            beginItem(true);
+            const uint32_t code = ((bestDist - 1) << 4) | (bestLen - 1);
+            out.push_back((uint8_t)(code >> 8));
+            out.push_back((uint8_t) code);
+
+            for (uint32_t i = 0; i < bestLen; ++i) {
+                insertPos(pos + i);
+            }
+
+            pos += bestLen;
+        } else {
+            beginItem(false);
+            out.push_back(src[pos]);
+            insertPos(pos);
+            ++pos;
+        }
+    }
+
+    // Terminate the stream: a back reference with a length of '1'
+    beginItem(true);
+    out.push_back(0);
+    out.push_back(0);
+    return out;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Makes a new cooked lump from the given uncompressed data, compressing it if that makes it smaller and compression is allowed
+//------------------------------------------------------------------------------------------------------------------------------------------
+static Lump makeCookedLump(const std::string& name, std::vector<uint8_t>&& data, const bool bAllowCompression) noexcept {
+    Lump lump = {};
+    lump.name = name;
+    lump.size = (int32_t) data.size();
+    lump.bIsCompressed = false;
+
+    if (bAllowCompression) {
+        std::vector<uint8_t> compressed = compressLump(data);
+        std::vector<uint8_t> verify;
+
+        if ((compressed.size() < data.size()) && decompressLump(compressed, verify, data.size()) && (verify == data)) {
+            lump.bIsCompressed = true;
+            lump.data = std::move(compressed);
+            return lump;
+        }
+    }
+
+    lump.data = std::move(data);
+    return lump;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Draws the columns of a PC format patch into the given 8-bit image, with the top left of the patch at the given position.
+// Returns 'false' if the patch data is malformed.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool drawPatch(
+    const std::vector<uint8_t>& patch,
+    const int32_t originX,
+    const int32_t originY,
+    uint8_t* const pPixels,
+    const int32_t imageW,
+    const int32_t imageH
+) noexcept {
+    const size_t patchSize = patch.size();
+
+    if (patchSize < 8)
+        return false;
+
+    const int32_t patchW = readI16(patch.data());
+
+    if ((patchW < 0) || (8 + (size_t) patchW * 4 > patchSize))
+        return false;
+
+    for (int32_t col = 0; col < patchW; ++col) {
+        const int32_t x = originX + col;
+        const int32_t colOffset = readI32(patch.data() + 8 + col * 4);
+
+        if ((colOffset < 0) || ((size_t) colOffset >= patchSize))
+            return false;
+
+        // Draw each post in the column, until the end of column marker
+        size_t postOffset = (size_t) colOffset;
+
+        while (true) {
+            if (postOffset >= patchSize)
+                return false;
+
+            const uint32_t topDelta = patch[postOffset];
+
+            if (topDelta == 0xFF)
+                break;
+
+            if (postOffset + 4 > patchSize)
+                return false;
+
+            const uint32_t length = patch[postOffset + 1];
+
+            if (postOffset + 4 + length > patchSize)
+                return false;
+
+            const uint8_t* const pPostPixels = patch.data() + postOffset + 3;       // Skip the top delta, length and padding byte
+
+            if ((x >= 0) && (x < imageW)) {
+                for (uint32_t i = 0; i < length; ++i) {
+                    const int32_t y = originY + (int32_t) topDelta + (int32_t) i;
+
+                    if ((y >= 0) && (y < imageH)) {
+                        pPixels[y * imageW + x] = gColorRemap[pPostPixels[i]];
+                    }
+                }
+            }
+
+            postOffset += length + 4;
+        }
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Makes a PSX texture or sprite lump from the given header info and 8-bit pixels
+//------------------------------------------------------------------------------------------------------------------------------------------
+static std::vector<uint8_t> makePsxTexLump(const PsxTexHeader& hdr, const std::vector<uint8_t>& pixels) noexcept {
+    std::vector<uint8_t> data;
+    data.reserve(sizeof(PsxTexHeader) + pixels.size());
+    writeValue(data, hdr.offsetX);
+    writeValue(data, hdr.offsetY);
+    writeValue(data, hdr.width);
+    writeValue(data, hdr.height);
+    data.insert(data.end(), pixels.begin(), pixels.end());
+    return data;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Helper: finds the last lump with the given name (later lumps override earlier ones), or returns '-1' if not found
+//------------------------------------------------------------------------------------------------------------------------------------------
+static int32_t findLump(const std::vector<Lump>& lumps, const std::string& name) noexcept {
+    for (int32_t i = (int32_t) lumps.size() - 1; i >= 0; --i) {
+        if (lumps[(size_t) i].name == name)
+            return i;
+    }
+
+    return -1;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Helper: tells if a lump is a marker for the start or end of a list of patches ('P_START', 'PP_END', 'P1_START' etc.)
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool isPatchListMarker(const std::string& name, const bool bStartMarker) noexcept {
+    const char* const suffix = (bStartMarker) ? "_START" : "_END";
+    const size_t suffixLen = std::strlen(suffix);
+
+    return (
+        (name.size() > suffixLen) &&
+        (name[0] == 'P') &&
+        (name.compare(name.size() - suffixLen, suffixLen, suffix) == 0)
+    );
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Composites all of the PC wall textures defined by the given 'TEXTURE1' or 'TEXTURE2' lump into PSX texture lumps.
+// Returns 'false' if the texture definitions are malformed.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool cookTextures(
+    const std::vector<Lump>& lumps,
+    const Lump& texDefsLump,
+    const std::vector<int32_t>& patchLumpIdxs,
+    const bool bAllowCompression,
+    std::vector<Lump>& texLumpsOut
+) noexcept {
+    if (texDefsLump.bIsCompressed) {
+        std::printf("Texture definitions lump '%s' is compressed, which is not supported!\n", texDefsLump.name.c_str());
+        return false;
+    }
+
+    const std::vector<uint8_t>& defs = texDefsLump.data;
+
+    if (defs.size() < 4)
+        return false;
+
+    const int32_t numTextures = readI32(defs.data());
+
+    if ((numTextures < 0) || (4 + (size_t) numTextures * 4 > defs.size()))
+        return false;
+
+    for (int32_t texIdx = 0; texIdx < numTextures; ++texIdx) {
+        // Read the texture definition: name (8), masked (4), width (2), height (2), column directory (4), patch count (2), patches...
+        const int32_t defOffset = readI32(defs.data() + 4 + texIdx * 4);
+
+        if ((defOffset < 0) || ((size_t) defOffset + 22 > defs.size()))
+            return false;
+
+        const uint8_t* const pDef = defs.data() + defOffset;
+        const std::string texName = makeLumpName((const char*) pDef, false);
+        const int16_t texW = readI16(pDef + 12);
+        const int16_t texH = readI16(pDef + 14);
+        const int16_t numPatches = readI16(pDef + 20);
+
+        if ((texW <= 0) || (texH <= 0) || (numPatches < 0) || ((size_t) defOffset + 22 + (size_t) numPatches * 10 > defs.size()))
+            return false;
+
+        // Composite the patches: each is origin x (2), origin y (2), patch index (2), step dir (2), colormap (2)
+        std::vector<uint8_t> pixels((size_t) texW * (size_t) texH, TRANSPARENT_COLOR_IDX);
+
+        for (int32_t patchNum = 0; patchNum < numPatches; ++patchNum) {
+            const uint8_t* const pPatchDef = pDef + 22 + patchNum * 10;
+            const int16_t originX = readI16(pPatchDef);
+            const int16_t originY = readI16(pPatchDef + 2);
+            const int16_t patchIdx = readI16(pPatchDef + 4);
+
+            if ((patchIdx < 0) || ((size_t) patchIdx >= patchLumpIdxs.size()) || (patchLumpIdxs[(size_t) patchIdx] < 0)) {
+                std::printf("Warning: texture '%s' uses missing patch #%d!\n", texName.c_str(), (int) patchIdx);
+                continue;
+            }
+
+            const Lump& patchLump = lumps[(size_t) patchLumpIdxs[(size_t) patchIdx]];
+
+            if (patchLump.bIsCompressed || (!drawPatch(patchLump.data, originX, originY, pixels.data(), texW, texH))) {
+                std::printf("Warning: texture '%s' uses patch '%s' which is not a valid PC patch!\n", texName.c_str(), patchLump.name.c_str());
+            }
+        }
+
+        const PsxTexHeader hdr = { 0, 0, texW, texH };
+        texLumpsOut.push_back(makeCookedLump(texName, makePsxTexLump(hdr, pixels), bAllowCompression));
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Converts a single PC format patch sprite into the PSX sprite format.
+// Returns 'false' if the lump is not a valid PC patch, in which case the lump is left alone.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool cookSprite(Lump& lump, const bool bAllowCompression) noexcept {
+    if (lump.bIsCompressed || (lump.data.size() < 8))
+        return false;
+
+    const int16_t spriteW = readI16(lump.data.data());
+    const int16_t spriteH = readI16(lump.data.data() + 2);
+    const int16_t leftOffset = readI16(lump.data.data() + 4);
+    const int16_t topOffset = readI16(lump.data.data() + 6);
+
+    if ((spriteW <= 0) || (spriteH <= 0))
+        return false;
+
+    std::vector<uint8_t> pixels((size_t) spriteW * (size_t) spriteH, TRANSPARENT_COLOR_IDX);
+
+    if (!drawPatch(lump.data, 0, 0, pixels.data(), spriteW, spriteH))
+        return false;
+
+    const PsxTexHeader hdr = { leftOffset, topOffset, spriteW, spriteH };
+    lump = makeCookedLump(lump.name, makePsxTexLump(hdr, pixels), bAllowCompression);
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Builds the table mapping PC palette indexes to the closest colors in the PSX palette.
+// Index '0' in the PSX palette is reserved for transparency, so colors are only ever mapped to indexes 1-255.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void buildColorRemap(const uint8_t* const pPcPalette, const uint8_t* const pPsxPalette) noexcept {
+    int32_t psxRgb[256][3];
+
+    for (uint32_t i = 0; i < 256; ++i) {
+        const uint32_t bits = (uint32_t) pPsxPalette[i * 2] | ((uint32_t) pPsxPalette[i * 2 + 1] << 8);
+        psxRgb[i][0] = (int32_t)(((bits >> 0 ) & 0x1Fu) << 3);
+        psxRgb[i][1] = (int32_t)(((bits >> 5 ) & 0x1Fu) << 3);
+        psxRgb[i][2] = (int32_t)(((bits >> 10) & 0x1Fu) << 3);
+    }
+
+    for (uint32_t pcIdx = 0; pcIdx < 256; ++pcIdx) {
+        const int32_t r = pPcPalette[pcIdx * 3 + 0];
+        const int32_t g = pPcPalette[pcIdx * 3 + 1];
+        const int32_t b = pPcPalette[pcIdx * 3 + 2];
+
+        // Weight the color channels roughly by how sensitive the eye is to each
+        int32_t bestDist = INT32_MAX;
+        uint32_t bestIdx = 1;
+
+        for (uint32_t psxIdx = 1; psxIdx < 256; ++psxIdx) {
+            const int32_t dr = r - psxRgb[psxIdx][0];
+            const int32_t dg = g - psxRgb[psxIdx][1];
+            const int32_t db = b - psxRgb[psxIdx][2];
+            const int32_t dist = 3 * dr * dr + 4 * dg * dg + 2 * db * db;
+
+            if (dist < bestDist) {
+                bestDist = dist;
+                bestIdx = psxIdx;
+            }
+        }
+
+        gColorRemap[pcIdx] = (uint8_t) bestIdx;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Program entrypoint
+//------------------------------------------------------------------------------------------------------------------------------------------
+int main(int argc, const char* const argv[]) noexcept {
+    // Parse the command line
+    bool bCookSprites = false;
+    bool bAllowCompression = true;
+    const char* psxPalPath = nullptr;
+    const char* pcPalPath = nullptr;
+    int argIdx = 1;
+
+    for (; argIdx < argc; ++argIdx) {
+        const char* const arg = argv[argIdx];
+
+        if (std::strcmp(arg, "-sprites") == 0) {
+            bCookSprites = true;
+        } else if (std::strcmp(arg, "-nocompress") == 0) {
+            bAllowCompression = false;
+        } else if ((std::strcmp(arg, "-psxpal") == 0) && (argIdx + 1 < argc)) {
+            psxPalPath = argv[++argIdx];
+        } else if ((std::strcmp(arg, "-pcpal") == 0) && (argIdx + 1 < argc)) {
+            pcPalPath = argv[++argIdx];
+        } else {
+            break;
+        }
+    }
+
+    if (argc - argIdx != 2) {
+        printHelp();
+        return 1;
+    }
+
+    const char* const inFilePath = argv[argIdx];
+    const char* const outFilePath = argv[argIdx + 1];
+
+    // Read the input WAD
+    std::string fileId;
+    std::vector<Lump> lumps;
+
+    if (!readWad(inFilePath, fileId, lumps))
+        return 1;
+
+    // Setup the color remapping, if wanted
+    for (uint32_t i = 0; i < 256; ++i) {
+        gColorRemap[i] = (uint8_t) i;
+    }
+
+    if (psxPalPath) {
+        const FileData psxPal = FileUtils::getContentsOfFile(psxPalPath);
+
+        if ((!psxPal.bytes) || (psxPal.size < 256 * 2)) {
+            std::printf("Failed to read the PSX palette file '%s' or it is too small!\n", psxPalPath);
+            return 1;
+        }
+
+        std::vector<uint8_t> pcPal;
+
+        if (pcPalPath) {
+            const FileData pcPalFile = FileUtils::getContentsOfFile(pcPalPath);
+
+            if (pcPalFile.bytes) {
+                pcPal.assign((const uint8_t*) pcPalFile.bytes.get(), (const uint8_t*) pcPalFile.bytes.get() + pcPalFile.size);
+            }
+        } else {
+            const int32_t playpalIdx = findLump(lumps, "PLAYPAL");
+
+            if ((playpalIdx >= 0) && (!lumps[(size_t) playpalIdx].bIsCompressed)) {
+                pcPal = lumps[(size_t) playpalIdx].data;
+            }
+        }
+
+        if (pcPal.size() < 256 * 3) {
+            std::printf("A valid PC palette is needed to remap colors: the input WAD has no 'PLAYPAL' lump, or the '-pcpal' file is invalid!\n");
+            return 1;
+        }
+
+        buildColorRemap(pcPal.data(), (const uint8_t*) psxPal.bytes.get());
+    }
+
+    // Figure out which lump each patch name refers to
+    std::vector<int32_t> patchLumpIdxs;
+    const int32_t pnamesIdx = findLump(lumps, "PNAMES");
+
+    if (pnamesIdx >= 0) {
+        const std::vector<uint8_t>& pnames = lumps[(size_t) pnamesIdx].data;
+        const int32_t numPatchNames = (pnames.size() >= 4) ? readI32(pnames.data()) : -1;
+
+        if ((numPatchNames < 0) || (4 + (size_t) numPatchNames * 8 > pnames.size()) || lumps[(size_t) pnamesIdx].bIsCompressed) {
+            std::printf("The 'PNAMES' lump is invalid!\n");
+            return 1;
+        }
+
+        for (int32_t i = 0; i < numPatchNames; ++i) {
+            char name[9] = {};
+            std::memcpy(name, pnames.data() + 4 + i * 8, 8);
+            patchLumpIdxs.push_back(findLump(lumps, makeLumpName(name, false)));
+        }
+    }
+
+    // Cook the wall textures
+    std::vector<Lump> texLumps;
+
+    for (const char* const texDefsName : { "TEXTURE1", "TEXTURE2" }) {
+        const int32_t texDefsIdx = findLump(lumps, texDefsName);
+
+        if (texDefsIdx < 0)
+            continue;
+
+        if (pnamesIdx < 0) {
+            std::printf("The input WAD has texture definitions but no 'PNAMES' lump!\n");
+            return 1;
+        }
+
+        if (!cookTextures(lumps, lumps[(size_t) texDefsIdx], patchLumpIdxs, bAllowCompression, texLumps)) {
+            std::printf("The texture definitions lump '%s' is invalid!\n", texDefsName);
+            return 1;
+        }
+    }
+
+    // Make up the output lump list: leave out the texture definitions and patches (unless there were no textures) and optionally cook sprites
+    std::vector<Lump> outLumps;
+    outLumps.reserve(lumps.size() + texLumps.size() + 2);
+
+    const bool bRemovePatches = (!texLumps.empty());
+    bool bInPatchList = false;
+    bool bInSpriteList = false;
+    uint32_t numSpritesCooked = 0;
+
+    for (Lump& lump : lumps) {
+        if (bRemovePatches && isPatchListMarker(lump.name, true)) {
+            bInPatchList = true;
+            continue;
+        }
+
+        if (bRemovePatches && isPatchListMarker(lump.name, false)) {
+            bInPatchList = false;
+            continue;
+        }
+
+        if ((lump.name == "S_START") || (lump.name == "SS_START")) {
+            bInSpriteList = true;
+        } else if ((lump.name == "S_END") || (lump.name == "SS_END")) {
+            bInSpriteList = false;
+        } else if (bInSpriteList && bCookSprites && (lump.size > 0)) {
+            numSpritesCooked += (cookSprite(lump, bAllowCompression)) ? 1 : 0;
+        }
+
+        const bool bIsTexDefs = ((lump.name == "PNAMES") || (lump.name == "TEXTURE1") || (lump.name == "TEXTURE2"));
+
+        if (bRemovePatches && (bInPatchList || bIsTexDefs))
+            continue;
+
+        outLumps.push_back(std::move(lump));
+    }
+
+    if (!texLumps.empty()) {
+        outLumps.push_back(Lump{ "T_START", 0, false, {} });
+
+        for (Lump& texLump : texLumps) {
+            outLumps.push_back(std::move(texLump));
+        }
+
+        outLumps.push_back(Lump{ "T_END", 0, false, {} });
+    }
+
+    // Write the output WAD and report what was done
+    if (!writeWad(outFilePath, fileId, outLumps))
+        return 1;
+
+    std::printf("Cooked %u texture(s) and %u sprite(s) into '%s'.\n", (unsigned) texLumps.size(), numSpritesCooked, outFilePath);
+    return 0;
+}
@@ -3,8 +3,13 @@
 #include "FileUtils.h"
 #include "FuncSignature.h"
 #include "PrintUtils.h"
+#include "SigMatcher.h"
 #include "TextIStream.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
 #include <fstream>
+#include <thread>
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Entry point for 'PSXExeSigMatcher'
@@ -13,13 +18,18 @@
 //
 //  Parses the PSX function signatures generated by 'PSXObjSigGen' and attempts to match those against code in a
 //  specified .EXE file. Outputs a list of potential matches to the specified file.
+//  The number of threads used for the search can optionally be specified, otherwise one thread per CPU core is used.
 //------------------------------------------------------------------------------------------------------------------------------------------
 
 int main(int argc, char* argv[]) noexcept {
-    if (argc != 4) {
-        FATAL_ERROR_F("Usage: %s <INPUT_SIGNATURES_FILE> <INPUT_EXE_FILE> <OUTPUT_MATCHES_FILE>\n", argv[0]);
+    if ((argc != 4) && (argc != 5)) {
+        FATAL_ERROR_F("Usage: %s <INPUT_SIGNATURES_FILE> <INPUT_EXE_FILE> <OUTPUT_MATCHES_FILE> [NUM_THREADS]\n", argv[0]);
     }
 
+    // Figure out how many threads to search with
+    uint32_t numThreads = (argc == 5) ? (uint32_t) std::strtoul(argv[4], nullptr, 10) : std::thread::hardware_concurrency();
+    numThreads = std::max(numThreads, 1u);
+
     // Read the function signatures file generated by the other tool previously mentioned
     std::vector<FuncSignature> funcSigs;
 
@@ -51,46 +61,22 @@ int main(int argc, char* argv[]) noexcept {
         exeInstructions.push_back(instruction);
     }
 
-    // Do brute force matching!
-    // Not a very smart way of doing things, but gets the job done.
+    // Find all the matches
+    std::printf("Searching for matches for %u signatures using %u thread(s)...\n", (unsigned) funcSigs.size(), (unsigned) numThreads);
+    std::vector<SigMatch> matches;
+    SigMatcher::findAllMatches(funcSigs, exeInstructions, numThreads, matches);
+
+    // Output the matches
     try {
         std::fstream out;
         out.open(argv[3], std::fstream::out);
 
-        for (const FuncSignature& sig : funcSigs) {
-            std::printf("Search for matches for '%s'...\n", sig.name.c_str());
-            const uint32_t numSigWords = (uint32_t) sig.instructions.size();
-
-            for (uint32_t startExeWordIdx = 0; startExeWordIdx < numExeWords; ++startExeWordIdx) {
-                // Are there enough words left in the exe for a match?
-                if (startExeWordIdx + numSigWords > numExeWords)
-                    break;
-
-                // Check if all instructions match, taking into account wildcard instructions.
-                // Wildcard instructions match only on instruction type!
-                bool bMatch = true;
-
-                for (uint32_t sigWordIdx = 0; sigWordIdx < numSigWords; ++sigWordIdx) {
-                    const CpuInstruction& i1 = exeInstructions[startExeWordIdx + sigWordIdx];
-                    const CpuInstruction& i2 = sig.instructions[sigWordIdx];
-
-                    if (i1 != i2) {
-                        if ((i1.opcode != i2.opcode) || (!sig.bInstructionIsPatched[sigWordIdx])) {
-                            bMatch = false;
-                            break;
-                        }
-                    }
-                }
-
-                // Did we find a match? If so then output it!
-                if (bMatch) {
-                    const uint32_t addr = exe.baseAddress + startExeWordIdx * 4;
-                    PrintUtils::printHexU32(addr, true, out);
-                    out << " matches function '";
-                    out << sig.name;
-                    out << "'\n";
-                }
-            }
+        for (const SigMatch& match : matches) {
+            const uint32_t addr = exe.baseAddress + match.exeWordIdx * 4;
+            PrintUtils::printHexU32(addr, true, out);
+            out << " matches function '";
+            out << funcSigs[match.sigIdx].name;
+            out << "'\n";
         }
     } catch (...) {
         FATAL_ERROR_F("An error occurred while outputting to file '%s'!\n", argv[3]);
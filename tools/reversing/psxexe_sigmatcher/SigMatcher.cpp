@@ -0,0 +1,212 @@
+#include "SigMatcher.h"
+
+#include "CpuInstruction.h"
+#include "FuncSignature.h"
+
+#include <algorithm>
+#include <thread>
+#include <unordered_map>
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Signature matching works by picking a single fixed (non wildcard) instruction from each signature to act as an 'anchor'.
+// The signatures are then indexed by their anchor instruction, so that for each word in the executable we can quickly look up the
+// signatures which could possibly match there, instead of testing every signature against every word. The anchor for a signature is
+// chosen to be the fixed instruction which occurs least often in the executable, to keep the number of candidates to verify low.
+//
+// Signatures with no fixed instructions at all can't be indexed and are tested against every word in the executable instead.
+// The executable is split into ranges of words which are searched in parallel on multiple threads.
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+// A signature which could match at a word in the executable, and where its anchor instruction is in the signature
+struct SigAnchor {
+    uint32_t    sigIdx;
+    uint32_t    anchorWordIdx;
+};
+
+typedef std::unordered_map<uint64_t, std::vector<SigAnchor>> SigAnchorIndex;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Makes a key which uniquely identifies a decoded instruction, for use in instruction lookups
+//------------------------------------------------------------------------------------------------------------------------------------------
+static uint64_t getInstructionKey(const CpuInstruction& instruction) noexcept {
+    return (
+        ((uint64_t) instruction.opcode << 56) |
+        ((uint64_t) instruction.regS << 48) |
+        ((uint64_t) instruction.regT << 40) |
+        ((uint64_t) instruction.regD << 32) |
+        (uint64_t) instruction.immediateVal
+    );
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Index the signatures by their anchor instructions and collect the signatures which have no anchor instruction
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void buildSigAnchorIndex(
+    const std::vector<FuncSignature>& sigs,
+    const std::vector<CpuInstruction>& exeInstructions,
+    SigAnchorIndex& anchorIndexOut,
+    std::vector<uint32_t>& unanchoredSigsOut
+) noexcept {
+    // Count how many times each instruction occurs in the executable, so we can pick the rarest instruction in each signature
+    std::unordered_map<uint64_t, uint32_t> exeInstructionCounts;
+    exeInstructionCounts.reserve(exeInstructions.size());
+
+    for (const CpuInstruction& instruction : exeInstructions) {
+        exeInstructionCounts[getInstructionKey(instruction)]++;
+    }
+
+    // Pick the anchor for each signature
+    const uint32_t numSigs = (uint32_t) sigs.size();
+
+    for (uint32_t sigIdx = 0; sigIdx < numSigs; ++sigIdx) {
+        const FuncSignature& sig = sigs[sigIdx];
+        const uint32_t numSigWords = (uint32_t) sig.instructions.size();
+
+        int32_t bestAnchorWordIdx = -1;
+        uint64_t bestAnchorKey = 0;
+        uint32_t bestAnchorCount = UINT32_MAX;
+
+        for (uint32_t sigWordIdx = 0; sigWordIdx < numSigWords; ++sigWordIdx) {
+            if (sig.bInstructionIsPatched[sigWordIdx])
+                continue;
+
+            const uint64_t key = getInstructionKey(sig.instructions[sigWordIdx]);
+            const auto countIter = exeInstructionCounts.find(key);
+            const uint32_t count = (countIter != exeInstructionCounts.end()) ? countIter->second : 0;
+
+            if ((bestAnchorWordIdx < 0) || (count < bestAnchorCount)) {
+                bestAnchorWordIdx = (int32_t) sigWordIdx;
+                bestAnchorKey = key;
+                bestAnchorCount = count;
+            }
+        }
+
+        // Note: an instruction which doesn't occur in the executable at all means the signature can never match, but add it to the index
+        // anyway for simplicity. It will simply never be looked up.
+        if (bestAnchorWordIdx >= 0) {
+            anchorIndexOut[bestAnchorKey].push_back(SigAnchor{ sigIdx, (uint32_t) bestAnchorWordIdx });
+        } else {
+            unanchoredSigsOut.push_back(sigIdx);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Finds all signature matches for the specified range of words in the executable
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void findMatchesInRange(
+    const std::vector<FuncSignature>& sigs,
+    const std::vector<CpuInstruction>& exeInstructions,
+    const SigAnchorIndex& anchorIndex,
+    const std::vector<uint32_t>& unanchoredSigs,
+    const uint32_t begExeWordIdx,
+    const uint32_t endExeWordIdx,
+    std::vector<SigMatch>& matchesOut
+) noexcept {
+    // Find matches for signatures with anchor instructions.
+    // Note: the range is for the anchor words rather than where the matches start; each match has exactly one anchor word so no match is
+    // found twice by different ranges.
+    for (uint32_t exeWordIdx = begExeWordIdx; exeWordIdx < endExeWordIdx; ++exeWordIdx) {
+        const auto anchorIter = anchorIndex.find(getInstructionKey(exeInstructions[exeWordIdx]));
+
+        if (anchorIter == anchorIndex.end())
+            continue;
+
+        for (const SigAnchor& anchor : anchorIter->second) {
+            if (anchor.anchorWordIdx > exeWordIdx)
+                continue;
+
+            const uint32_t startExeWordIdx = exeWordIdx - anchor.anchorWordIdx;
+
+            if (SigMatcher::doesSigMatchAt(sigs[anchor.sigIdx], exeInstructions, startExeWordIdx)) {
+                matchesOut.push_back(SigMatch{ anchor.sigIdx, startExeWordIdx });
+            }
+        }
+    }
+
+    // Brute force search for the signatures which could not be indexed
+    for (const uint32_t sigIdx : unanchoredSigs) {
+        for (uint32_t startExeWordIdx = begExeWordIdx; startExeWordIdx < endExeWordIdx; ++startExeWordIdx) {
+            if (SigMatcher::doesSigMatchAt(sigs[sigIdx], exeInstructions, startExeWordIdx)) {
+                matchesOut.push_back(SigMatch{ sigIdx, startExeWordIdx });
+            }
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tells if the given signature matches the code starting at the specified word in the executable.
+// Wildcard instructions (ones patched by the linker) match only on instruction type!
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool SigMatcher::doesSigMatchAt(
+    const FuncSignature& sig,
+    const std::vector<CpuInstruction>& exeInstructions,
+    const uint32_t startExeWordIdx
+) noexcept {
+    // Are there enough words left in the exe for a match?
+    const uint32_t numSigWords = (uint32_t) sig.instructions.size();
+    const uint32_t numExeWords = (uint32_t) exeInstructions.size();
+
+    if ((startExeWordIdx > numExeWords) || (numSigWords > numExeWords - startExeWordIdx))
+        return false;
+
+    // Check if all instructions match, taking into account wildcard instructions
+    for (uint32_t sigWordIdx = 0; sigWordIdx < numSigWords; ++sigWordIdx) {
+        const CpuInstruction& i1 = exeInstructions[startExeWordIdx + sigWordIdx];
+        const CpuInstruction& i2 = sig.instructions[sigWordIdx];
+
+        if (i1 != i2) {
+            if ((i1.opcode != i2.opcode) || (!sig.bInstructionIsPatched[sigWordIdx]))
+                return false;
+        }
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Finds all matches for the given signatures in the executable using the specified number of threads.
+// The matches are output sorted by signature index, then by location in the executable.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void SigMatcher::findAllMatches(
+    const std::vector<FuncSignature>& sigs,
+    const std::vector<CpuInstruction>& exeInstructions,
+    const uint32_t numThreads,
+    std::vector<SigMatch>& matchesOut
+) noexcept {
+    // Build the index of signatures first
+    SigAnchorIndex anchorIndex;
+    std::vector<uint32_t> unanchoredSigs;
+    buildSigAnchorIndex(sigs, exeInstructions, anchorIndex, unanchoredSigs);
+
+    // Split the executable into a range of words per thread and search each range in parallel
+    const uint32_t numExeWords = (uint32_t) exeInstructions.size();
+    const uint32_t numRanges = std::max(std::min(numThreads, numExeWords), 1u);
+    const uint32_t wordsPerRange = (numExeWords + numRanges - 1) / numRanges;
+
+    std::vector<std::vector<SigMatch>> rangeMatches(numRanges);
+    std::vector<std::thread> threads;
+    threads.reserve(numRanges);
+
+    for (uint32_t rangeIdx = 0; rangeIdx < numRanges; ++rangeIdx) {
+        const uint32_t begExeWordIdx = std::min(rangeIdx * wordsPerRange, numExeWords);
+        const uint32_t endExeWordIdx = std::min(begExeWordIdx + wordsPerRange, numExeWords);
+
+        threads.emplace_back(
+            [&, rangeIdx, begExeWordIdx, endExeWordIdx]() noexcept {
+                findMatchesInRange(sigs, exeInstructions, anchorIndex, unanchoredSigs, begExeWordIdx, endExeWordIdx, rangeMatches[rangeIdx]);
+            }
+        );
+    }
+
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    // Combine and sort the results
+    for (const std::vector<SigMatch>& matches : rangeMatches) {
+        matchesOut.insert(matchesOut.end(), matches.begin(), matches.end());
+    }
+
+    std::sort(matchesOut.begin(), matchesOut.end());
+}
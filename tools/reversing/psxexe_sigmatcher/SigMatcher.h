@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+struct CpuInstruction;
+struct FuncSignature;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// A match for a function signature found in an executable
+//------------------------------------------------------------------------------------------------------------------------------------------
+struct SigMatch {
+    uint32_t    sigIdx;         // Index of the signature which matched
+    uint32_t    exeWordIdx;     // Index of the word in the executable where the matching code starts
+
+    inline bool operator < (const SigMatch& other) const noexcept {
+        return (sigIdx != other.sigIdx) ? (sigIdx < other.sigIdx) : (exeWordIdx < other.exeWordIdx);
+    }
+};
+
+namespace SigMatcher {
+    bool doesSigMatchAt(const FuncSignature& sig, const std::vector<CpuInstruction>& exeInstructions, const uint32_t startExeWordIdx) noexcept;
+
+    void findAllMatches(
+        const std::vector<FuncSignature>& sigs,
+        const std::vector<CpuInstruction>& exeInstructions,
+        const uint32_t numThreads,
+        std::vector<SigMatch>& matchesOut
+    ) noexcept;
+}
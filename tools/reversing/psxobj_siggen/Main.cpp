@@ -3,8 +3,13 @@
 #include "FuncSignature.h"
 #include "ObjFileData.h"
 #include "ObjFileParser.h"
+#include <algorithm>
+#include <atomic>
 #include <cstdio>
+#include <filesystem>
 #include <fstream>
+#include <set>
+#include <thread>
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Entry point for 'PSXObjSigGen'
@@ -27,32 +32,204 @@
 //      (2) Invoke 'DUMPOBJ.EXE' on every SDK .OBJ file to produce the textual output that is an input to this tool.
 //      (3) Use this tool on all the dump output to build up the signature database.
 //      (4) Run pattern matching on the .EXE using the generated signature database to identify PsyQ functions in an EXE.
+//
+//  To speed up step (3) the input can also be a directory, in which case all files in the directory (and sub-directories) are used
+//  as inputs. A simple wildcard pattern for the file names can be given after the directory, for example 'DUMPS/*.TXT'. Multiple
+//  inputs are parsed in parallel and the signatures from all of them are output in order of input file path, with duplicate
+//  signatures (same name and same code) removed.
 //------------------------------------------------------------------------------------------------------------------------------------------
 
-int main(int argc, char* argv[]) noexcept {
-    if (argc != 3 && argc != 4) {        
-        FATAL_ERROR_F("Usage: %s <INPUT_OBJ_FILE_DUMP> <OUT_SIGNATURE_FILE> [OUT_DISASM_FILE]\n", argv[0]);
+// The results of parsing a single input file
+struct InputFileResult {
+    std::vector<FuncSignature>  signatures;
+    bool                        bReadOk;
+    bool                        bParseOk;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tells if a file name matches a simple wildcard pattern, where '*' matches any number of characters and '?' matches any one character
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool doesFileNameMatchPattern(const char* pName, const char* pPattern) noexcept {
+    while (*pPattern) {
+        if (*pPattern == '*') {
+            // Try matching the rest of the pattern against every possible remainder of the name
+            ++pPattern;
+
+            for (const char* pRestOfName = pName; ; ++pRestOfName) {
+                if (doesFileNameMatchPattern(pRestOfName, pPattern))
+                    return true;
+
+                if (*pRestOfName == 0)
+                    return false;
+            }
+        }
+
+        if ((*pName == 0) || ((*pPattern != '?') && (*pPattern != *pName)))
+            return false;
+
+        ++pName;
+        ++pPattern;
     }
 
-    // Read the input file
-    const char* const inputFilePath = argv[1];
-    std::string inputFileStr;
+    return (*pName == 0);
+}
 
-    if (!FileUtils::readFileAsString(inputFilePath, inputFileStr)) {
-        FATAL_ERROR_F("Failed to read input file '%s'!\n", inputFilePath);
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Gets the list of input files to process from the input path given on the command line, sorted by path.
+// The input path can be a single file, a directory or a directory followed by a file name wildcard pattern.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static std::vector<std::string> getInputFilePaths(const char* const inputPath) noexcept {
+    namespace fs = std::filesystem;
+    std::vector<std::string> inputFilePaths;
+    std::error_code errorCode;
+
+    // If the path is a single file then that is the only input
+    fs::path dirPath = inputPath;
+    std::string fileNamePattern;
+
+    if (!fs::is_directory(dirPath, errorCode)) {
+        const std::string fileName = dirPath.filename().string();
+        const bool bIsPattern = (fileName.find_first_of("*?") != std::string::npos);
+
+        if (!bIsPattern) {
+            inputFilePaths.push_back(inputPath);
+            return inputFilePaths;
+        }
+
+        fileNamePattern = fileName;
+        dirPath = dirPath.parent_path();
+
+        if (dirPath.empty()) {
+            dirPath = ".";
+        }
+    }
+
+    // Otherwise gather all of the matching files in the directory
+    for (fs::recursive_directory_iterator iter(dirPath, errorCode), endIter; (!errorCode) && (iter != endIter); iter.increment(errorCode)) {
+        if (!iter->is_regular_file(errorCode))
+            continue;
+
+        const std::string fileName = iter->path().filename().string();
+
+        if (fileNamePattern.empty() || doesFileNameMatchPattern(fileName.c_str(), fileNamePattern.c_str())) {
+            inputFilePaths.push_back(iter->path().string());
+        }
+    }
+
+    if (errorCode) {
+        FATAL_ERROR_F("Failed to list the input files in directory '%s'!\n", dirPath.string().c_str());
     }
 
-    // Parse the input file
+    std::sort(inputFilePaths.begin(), inputFilePaths.end());
+    return inputFilePaths;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Reads and parses the specified input file and builds the list of function signatures for it
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void processInputFile(const std::string& inputFilePath, InputFileResult& result) noexcept {
+    std::string inputFileStr;
+    result.bReadOk = FileUtils::readFileAsString(inputFilePath.c_str(), inputFileStr);
+
+    if (!result.bReadOk)
+        return;
+
     ObjFile objFile;
+    result.bParseOk = ObjFileParser::parseObjFileDumpFromStr(inputFileStr, objFile);
+
+    if (!result.bParseOk)
+        return;
 
-    if (!ObjFileParser::parseObjFileDumpFromStr(inputFileStr, objFile)) {
-        FATAL_ERROR_F("Failed to parse input file '%s'!\n", inputFilePath);
+    result.signatures.reserve(objFile.symbols.size());
+    FuncSignatureUtils::buildSigList(objFile, result.signatures);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Processes all of the specified input files in parallel, with one worker thread per CPU core.
+// Each worker grabs the next unprocessed file from the list until there are none left.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static std::vector<InputFileResult> processInputFiles(const std::vector<std::string>& inputFilePaths) noexcept {
+    const uint32_t numFiles = (uint32_t) inputFilePaths.size();
+    std::vector<InputFileResult> results(numFiles);
+    std::atomic<uint32_t> nextFileIdx = 0;
+
+    const auto doWork = [&]() noexcept {
+        for (uint32_t fileIdx = nextFileIdx++; fileIdx < numFiles; fileIdx = nextFileIdx++) {
+            processInputFile(inputFilePaths[fileIdx], results[fileIdx]);
+        }
+    };
+
+    const uint32_t numThreads = std::clamp(std::thread::hardware_concurrency(), 1u, std::max(numFiles, 1u));
+    std::vector<std::thread> threads;
+    threads.reserve(numThreads);
+
+    for (uint32_t threadIdx = 0; threadIdx < numThreads; ++threadIdx) {
+        threads.emplace_back(doWork);
+    }
+
+    for (std::thread& thread : threads) {
+        thread.join();
     }
 
-    // Build a list of function signatures for export
+    return results;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Merges the signatures from all the input files in order, removing signatures with the same name and code as one seen earlier
+//------------------------------------------------------------------------------------------------------------------------------------------
+static std::vector<FuncSignature> mergeSignatures(const std::vector<InputFileResult>& results) noexcept {
+    const auto compareSigs = [](const FuncSignature* const pSig1, const FuncSignature* const pSig2) noexcept {
+        if (pSig1->name != pSig2->name)
+            return (pSig1->name < pSig2->name);
+
+        if (pSig1->instructions != pSig2->instructions)
+            return (pSig1->instructions < pSig2->instructions);
+
+        return (pSig1->wildcardInstructionIndexes < pSig2->wildcardInstructionIndexes);
+    };
+
+    std::set<const FuncSignature*, decltype(compareSigs)> uniqueSigs(compareSigs);
     std::vector<FuncSignature> signatures;
-    signatures.reserve(objFile.symbols.size());
-    FuncSignatureUtils::buildSigList(objFile, signatures);
+
+    for (const InputFileResult& result : results) {
+        for (const FuncSignature& sig : result.signatures) {
+            if (uniqueSigs.insert(&sig).second) {
+                signatures.push_back(sig);
+            }
+        }
+    }
+
+    return signatures;
+}
+
+int main(int argc, char* argv[]) noexcept {
+    if (argc != 3 && argc != 4) {        
+        FATAL_ERROR_F("Usage: %s <INPUT_OBJ_FILE_DUMP | INPUT_DIR[/PATTERN]> <OUT_SIGNATURE_FILE> [OUT_DISASM_FILE]\n", argv[0]);
+    }
+
+    // Figure out what input files there are and read, parse and build signatures for all of them
+    const std::vector<std::string> inputFilePaths = getInputFilePaths(argv[1]);
+
+    if (inputFilePaths.empty()) {
+        FATAL_ERROR_F("No input files found for '%s'!\n", argv[1]);
+    }
+
+    const std::vector<InputFileResult> results = processInputFiles(inputFilePaths);
+
+    for (size_t fileIdx = 0; fileIdx < inputFilePaths.size(); ++fileIdx) {
+        const InputFileResult& result = results[fileIdx];
+
+        if (!result.bReadOk) {
+            FATAL_ERROR_F("Failed to read input file '%s'!\n", inputFilePaths[fileIdx].c_str());
+        }
+
+        if (!result.bParseOk) {
+            FATAL_ERROR_F("Failed to parse input file '%s'!\n", inputFilePaths[fileIdx].c_str());
+        }
+    }
+
+    // Build the final list of function signatures for export
+    const std::vector<FuncSignature> signatures = mergeSignatures(results);
 
     // Print the signatures to the specified file
     try {
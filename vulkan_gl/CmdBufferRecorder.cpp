@@ -8,6 +8,7 @@
 #include "LogicalDevice.h"
 #include "Pipeline.h"
 #include "PipelineLayout.h"
+#include "QueryPool.h"
 #include "RenderPass.h"
 #include "VkFuncs.h"
 
@@ -223,6 +224,20 @@ void CmdBufferRecorder::blitImage(
     mVkFuncs.vkCmdBlitImage(mVkCommandBuffer, srcImage, srcImageLayout, dstImage, dstImageLayout, regionCount, pRegions, filter);
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Recorded command: copy regions of an image to a buffer
+//------------------------------------------------------------------------------------------------------------------------------------------
+void CmdBufferRecorder::copyImageToBuffer(
+    const VkImage srcImage,
+    const VkImageLayout srcImageLayout,
+    const VkBuffer dstBuffer,
+    const uint32_t regionCount,
+    const VkBufferImageCopy* const pRegions
+) noexcept {
+    ASSERT(isRecording());
+    mVkFuncs.vkCmdCopyImageToBuffer(mVkCommandBuffer, srcImage, srcImageLayout, dstBuffer, regionCount, pRegions);
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Recorded command: insert a pipeline barrier to define execution or memory dependencies (or both)
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -394,4 +409,30 @@ void CmdBufferRecorder::dispatchWorkgroups(
     mVkFuncs.vkCmdDispatch(mVkCommandBuffer, numWorkgroupsX, numWorkgroupsY, numWorkgroupsZ);
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Recorded command: reset a range of queries in a query pool so they can be used again.
+// Note: this must be done outside of a render pass.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void CmdBufferRecorder::resetQueries(const QueryPool& queryPool, const uint32_t firstQuery, const uint32_t numQueries) noexcept {
+    ASSERT(isRecording());
+    ASSERT(queryPool.isValid());
+    ASSERT(firstQuery + numQueries <= queryPool.getNumQueries());
+    mVkFuncs.vkCmdResetQueryPool(mVkCommandBuffer, queryPool.getVkQueryPool(), firstQuery, numQueries);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Recorded command: write a GPU timestamp to the specified query once all previous commands have reached the given pipeline stage
+//------------------------------------------------------------------------------------------------------------------------------------------
+void CmdBufferRecorder::writeTimestamp(
+    const VkPipelineStageFlagBits pipelineStage,
+    const QueryPool& queryPool,
+    const uint32_t queryIdx
+) noexcept {
+    ASSERT(isRecording());
+    ASSERT(queryPool.isValid());
+    ASSERT(queryPool.getQueryType() == VK_QUERY_TYPE_TIMESTAMP);
+    ASSERT(queryIdx < queryPool.getNumQueries());
+    mVkFuncs.vkCmdWriteTimestamp(mVkCommandBuffer, pipelineStage, queryPool.getVkQueryPool(), queryIdx);
+}
+
 END_NAMESPACE(vgl)
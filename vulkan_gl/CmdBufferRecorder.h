@@ -12,6 +12,7 @@ class DescriptorSet;
 class Framebuffer;
 class Pipeline;
 class PipelineLayout;
+class QueryPool;
 class RenderPass;
 struct VkFuncs;
 
@@ -90,6 +91,14 @@ public:
         const VkFilter filter
     ) noexcept;
 
+    void copyImageToBuffer(
+        const VkImage srcImage,
+        const VkImageLayout srcImageLayout,
+        const VkBuffer dstBuffer,
+        const uint32_t regionCount,
+        const VkBufferImageCopy* const pRegions
+    ) noexcept;
+
     void addPipelineBarrier(
         const VkPipelineStageFlags srcStageMask,
         const VkPipelineStageFlags dstStageMask,
@@ -136,6 +145,9 @@ public:
         const uint32_t numWorkgroupsZ = 1
     ) noexcept;
 
+    void resetQueries(const QueryPool& queryPool, const uint32_t firstQuery, const uint32_t numQueries) noexcept;
+    void writeTimestamp(const VkPipelineStageFlagBits pipelineStage, const QueryPool& queryPool, const uint32_t queryIdx) noexcept;
+
 private:
     // Copy and move are disallowed
     CmdBufferRecorder(const CmdBufferRecorder& other) = delete;
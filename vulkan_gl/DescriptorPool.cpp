@@ -8,9 +8,13 @@
 #include "VkFuncs.h"
 
 #include <algorithm>
+#include <atomic>
 
 BEGIN_NAMESPACE(vgl)
 
+// Total number of descriptor sets allocated from all pools so far
+static std::atomic<uint32_t> gTotalNumSetAllocs;
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Creates an uninitialized descriptor pool
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -204,10 +208,19 @@ DescriptorSet* DescriptorPool::allocDescriptorSet(const DescriptorSetLayout& lay
     DescriptorSet& descriptorSet = mDescriptorSets[mFreeSetIndexes.back()];
     mFreeSetIndexes.pop_back();
     descriptorSet.init(*this, vkDescriptorSet);
+    gTotalNumSetAllocs.fetch_add(1, std::memory_order_relaxed);
 
     return &descriptorSet;
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Returns the total number of descriptor sets allocated from all pools so far.
+// Comparing this between frames shows how many allocations were made per frame; in the steady state it should not change.
+//------------------------------------------------------------------------------------------------------------------------------------------
+uint32_t DescriptorPool::getTotalNumSetAllocs() noexcept {
+    return gTotalNumSetAllocs.load(std::memory_order_relaxed);
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Free a single Vulkan descriptor set.
 // Note: the descriptor set should be valid and have been previously allocated from this pool.
@@ -38,6 +38,9 @@ public:
     DescriptorSet* allocDescriptorSet(const DescriptorSetLayout& layout) noexcept;
     void freeDescriptorSet(DescriptorSet& descriptorSet) noexcept;
 
+    // Total number of descriptor sets allocated from all pools so far: for performance stats, to help spot per-frame allocations
+    static uint32_t getTotalNumSetAllocs() noexcept;
+
 private:
     // Copy and move assign are disallowed
     DescriptorPool(const DescriptorPool& other) = delete;
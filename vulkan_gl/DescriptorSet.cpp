@@ -9,8 +9,13 @@
 #include "Sampler.h"
 #include "VkFuncs.h"
 
+#include <atomic>
+
 BEGIN_NAMESPACE(vgl)
 
+// Total number of descriptor updates done on all descriptor sets so far
+static std::atomic<uint32_t> gTotalNumUpdates;
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Creates an uninitialized descriptor set
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -103,6 +108,7 @@ void DescriptorSet::bindBufferBytes(
     // Do the descriptor update
     const VkFuncs& vkFuncs = device.getVkFuncs();
     vkFuncs.vkUpdateDescriptorSets(device.getVkDevice(), 1, &writeInfo, 0, nullptr);
+    gTotalNumUpdates.fetch_add(1, std::memory_order_relaxed);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -138,6 +144,7 @@ void DescriptorSet::bindTextureAndSampler(
     LogicalDevice& device = *mpParentPool->getDevice();
     const VkFuncs& vkFuncs = device.getVkFuncs();
     vkFuncs.vkUpdateDescriptorSets(device.getVkDevice(), 1, &writeInfo, 0, nullptr);
+    gTotalNumUpdates.fetch_add(1, std::memory_order_relaxed);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -160,6 +167,7 @@ void DescriptorSet::bindTextures(const uint32_t bindingNum, const VkDescriptorIm
     LogicalDevice& device = *mpParentPool->getDevice();
     const VkFuncs& vkFuncs = device.getVkFuncs();
     vkFuncs.vkUpdateDescriptorSets(device.getVkDevice(), 1, &writeInfo, 0, nullptr);
+    gTotalNumUpdates.fetch_add(1, std::memory_order_relaxed);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -189,6 +197,15 @@ void DescriptorSet::bindInputAttachment(const uint32_t bindingNum, const BaseTex
     LogicalDevice& device = *mpParentPool->getDevice();
     const VkFuncs& vkFuncs = device.getVkFuncs();
     vkFuncs.vkUpdateDescriptorSets(device.getVkDevice(), 1, &writeInfo, 0, nullptr);
+    gTotalNumUpdates.fetch_add(1, std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Returns the total number of descriptor updates done on all descriptor sets so far.
+// Comparing this between frames shows how many updates were made per frame; in the steady state it should not change.
+//------------------------------------------------------------------------------------------------------------------------------------------
+uint32_t DescriptorSet::getTotalNumUpdates() noexcept {
+    return gTotalNumUpdates.load(std::memory_order_relaxed);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
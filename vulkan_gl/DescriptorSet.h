@@ -57,6 +57,9 @@ public:
     void bindTextures(const uint32_t bindingNum, const VkDescriptorImageInfo* const pImageInfos, const uint32_t numImages) noexcept;
     void bindInputAttachment(const uint32_t bindingNum, const BaseTexture& attachTex) noexcept;
 
+    // Total number of descriptor updates done on all descriptor sets so far: for performance stats, to help spot per-frame updates
+    static uint32_t getTotalNumUpdates() noexcept;
+
 private:
     // Copy and move assign are disallowed
     DescriptorSet(const DescriptorSet& other) = delete;
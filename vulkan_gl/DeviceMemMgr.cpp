@@ -4,8 +4,12 @@
 #include "DeviceMemAlloc.h"
 #include "LogicalDevice.h"
 #include "PhysicalDevice.h"
+#include "RingbufferMgr.h"
 #include "VkFuncs.h"
 
+#include <algorithm>
+#include <cstdio>
+
 BEGIN_NAMESPACE(vgl)
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -93,9 +97,11 @@ void DeviceMemMgr::destroy(const bool bForceIfInvalid) noexcept {
             mVkFuncs.vkFreeMemory(vkDevice, vkDeviceMemory, nullptr);
         }
 
-        // Free all unpooled allocations
-        for (std::pair<const MemMgrIdT, DeviceMemAlloc>& allocKvp : mUnpooledAllocs) {
-            freeUnpooledAlloc(allocKvp.second);
+        // Free all unpooled allocations.
+        // Note: freeing removes the allocation from the map, so always free the first allocation until there are none left.
+        while (!mUnpooledAllocs.empty()) {
+            DeviceMemAlloc alloc = mUnpooledAllocs.begin()->second.alloc;
+            freeUnpooledAlloc(alloc);
         }
     }
 
@@ -163,6 +169,7 @@ uint64_t DeviceMemMgr::estimateAllocSize(const uint64_t numBytes) const noexcept
 //
 // Notes:
 //  (1) The app will terminate if allocation fails due to it being too big or if we are out of memory.
+//      Before giving up however, the memory manager will try to free any retired resources that the GPU is finished with and retry.
 //  (2) If a zero sized alloc is requested the call will succeed and not terminate with an out of memory
 //      error but the given alloc info out will be all zeroed out.
 //  (3) The alignment specified *SHOULD* be a power of two.
@@ -185,6 +192,33 @@ void DeviceMemMgr::alloc(
     if (numBytes <= 0)
         return;
 
+    // Try to do the alloc firstly with the memory we have.
+    // If that fails then try to free up memory held by retired resources which the GPU is finished with and retry.
+    // As a last resort wait for the GPU to finish all frames it is processing so all retired resources can be freed, and retry again.
+    if (tryAlloc(numBytes, allowedVkMemTypeBits, alignment, allocMode, allocInfoOut))
+        return;
+
+    if (reclaimRetiredMemory(false) && tryAlloc(numBytes, allowedVkMemTypeBits, alignment, allocMode, allocInfoOut))
+        return;
+
+    if (reclaimRetiredMemory(true) && tryAlloc(numBytes, allowedVkMemTypeBits, alignment, allocMode, allocInfoOut))
+        return;
+
+    // Out of memory!
+    FatalErrors::outOfMemory();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Attempts to do a pooled or unpooled alloc (as appropriate) for the 'alloc' function using the memory currently available.
+// Returns 'false' on failure, in which case the output alloc info is left cleared.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool DeviceMemMgr::tryAlloc(
+    const uint64_t numBytes,
+    const uint32_t allowedVkMemTypeBits,
+    const uint32_t alignment,
+    const DeviceMemAllocMode allocMode,
+    DeviceMemAlloc& allocInfoOut
+) noexcept {
     // Should we attempt a pooled or unpooled alloc?
     // Do an unpooled alloc if explicitly requested, or if the allocation or alignment requirements are too big.
     const bool bAllocUnpooled = (
@@ -193,20 +227,18 @@ void DeviceMemMgr::alloc(
         (alignment >= MAIN_POOL_SIZE)
     );
 
-    // Try to do the alloc and die with an out of memory error if it fails.
+    // Try to do the alloc.
     // Note that in the case of an unpooled alloc we don't need to worry about alignment, since the Vulkan spec states
     // that the memory returned by 'vkAllocateMemory' must meet any possible alignment requirement of the implementation.
-    if (bAllocUnpooled) {
-        if (!allocUnpooled(numBytes, allowedVkMemTypeBits, allocMode, allocInfoOut))
-            FatalErrors::outOfMemory();
-    } 
-    else {
-        if (!allocFromAllPools(numBytes, alignment, allowedVkMemTypeBits, allocMode, allocInfoOut))
-            FatalErrors::outOfMemory();
+    if (bAllocUnpooled)
+        return allocUnpooled(numBytes, allowedVkMemTypeBits, allocMode, allocInfoOut);
 
-        // Sanity check alignment requirements have been met before exiting
-        ASSERT((alignment == 0) || (allocInfoOut.offset % alignment == 0));
-    }
+    if (!allocFromAllPools(numBytes, alignment, allowedVkMemTypeBits, allocMode, allocInfoOut))
+        return false;
+
+    // Sanity check alignment requirements have been met before exiting
+    ASSERT((alignment == 0) || (allocInfoOut.offset % alignment == 0));
+    return true;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -326,6 +358,77 @@ void DeviceMemMgr::freeUnusedPools() noexcept {
     }
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Gathers statistics about memory usage for each Vulkan memory heap on the device, including how much of the budget for the heap is used.
+// Budget and usage info for heaps comes from the 'VK_EXT_memory_budget' extension if available, otherwise it is estimated.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void DeviceMemMgr::getStats(DeviceMemStats& statsOut) const noexcept {
+    statsOut = {};
+
+    if (!mpDevice)
+        return;
+
+    // Fill in the basic details for each heap
+    const PhysicalDevice* const pPhysicalDevice = mpDevice->getPhysicalDevice();
+    ASSERT(pPhysicalDevice);
+    const VkPhysicalDeviceMemoryProperties& memProps = pPhysicalDevice->getMemProps();
+    statsOut.numHeaps = memProps.memoryHeapCount;
+
+    for (uint32_t heapIdx = 0; heapIdx < memProps.memoryHeapCount; ++heapIdx) {
+        DeviceMemHeapStats& heapStats = statsOut.heaps[heapIdx];
+        heapStats.heapSize = memProps.memoryHeaps[heapIdx].size;
+        heapStats.bIsDeviceLocal = ((memProps.memoryHeaps[heapIdx].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0);
+    }
+
+    // Gather stats for all pools and their sub pools.
+    // Note that sub pools are allocations within their parent pool, so their space is only counted as used if allocated in the sub pool.
+    for (const std::pair<const MemMgrIdT, Pool>& poolKvp : mPools) {
+        const Pool& pool = poolKvp.second;
+        ASSERT(pool.vkMemoryHeapIdx < memProps.memoryHeapCount);
+        DeviceMemHeapStats& heapStats = statsOut.heaps[pool.vkMemoryHeapIdx];
+
+        heapStats.numPools++;
+        heapStats.numPoolBytes += pool.memMgr.getCapacityInBytes();
+        heapStats.numPoolBytesUsed += pool.memMgr.getNumBytesAllocated();
+        heapStats.numPoolBytesFree += pool.memMgr.getNumBytesFree();
+        heapStats.largestPoolFreeBlock = std::max<uint64_t>(heapStats.largestPoolFreeBlock, pool.memMgr.getMaxGuaranteedAllocInBytes());
+
+        for (const std::pair<const MemMgrIdT, SubPool>& subPoolKvp : pool.subPools) {
+            const SubPool& subPool = subPoolKvp.second;
+            heapStats.numPoolBytesUsed -= subPool.memMgr.getNumBytesFree();
+            heapStats.numPoolBytesFree += subPool.memMgr.getNumBytesFree();
+            heapStats.largestPoolFreeBlock = std::max<uint64_t>(heapStats.largestPoolFreeBlock, subPool.memMgr.getMaxGuaranteedAllocInBytes());
+        }
+    }
+
+    // Gather stats for all unpooled allocations
+    for (const std::pair<const MemMgrIdT, UnpooledAlloc>& allocKvp : mUnpooledAllocs) {
+        const UnpooledAlloc& unpooledAlloc = allocKvp.second;
+        ASSERT(unpooledAlloc.vkMemoryHeapIdx < memProps.memoryHeapCount);
+        DeviceMemHeapStats& heapStats = statsOut.heaps[unpooledAlloc.vkMemoryHeapIdx];
+
+        heapStats.numUnpooledAllocs++;
+        heapStats.numUnpooledBytes += unpooledAlloc.alloc.size;
+    }
+
+    // Get the budget and usage for each heap if possible, otherwise assume the entire heap is available and only we are using it
+    VkDeviceSize heapBudgets[VK_MAX_MEMORY_HEAPS] = {};
+    VkDeviceSize heapUsages[VK_MAX_MEMORY_HEAPS] = {};
+    statsOut.bHaveBudgetInfo = queryHeapBudgets(heapBudgets, heapUsages);
+
+    for (uint32_t heapIdx = 0; heapIdx < memProps.memoryHeapCount; ++heapIdx) {
+        DeviceMemHeapStats& heapStats = statsOut.heaps[heapIdx];
+
+        if (statsOut.bHaveBudgetInfo) {
+            heapStats.budget = heapBudgets[heapIdx];
+            heapStats.usage = heapUsages[heapIdx];
+        } else {
+            heapStats.budget = heapStats.heapSize;
+            heapStats.usage = heapStats.numPoolBytes + heapStats.numUnpooledBytes;
+        }
+    }
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Attempt to alloc from all pools using the given memory type.
 // If existing pools cannot satisfy the allocation request then a new one may be made.
@@ -378,7 +481,8 @@ bool DeviceMemMgr::allocFromAllPools(
                     ASSERT_FAIL("Expected allocation to succeed, and it didn't?!");
                 }
             } else {
-                // Gah! Out of device memory - we'll fall back to RAM instead :(
+                // Gah! Out of device memory (or over budget) - we'll fall back to RAM instead :(
+                std::printf("[VGL WARNING]: Device local memory exhausted! Falling back to host memory, performance may suffer...\n");
                 mbDeviceMemExhausted = true;
             }
         }
@@ -540,6 +644,13 @@ DeviceMemMgr::Pool* DeviceMemMgr::allocNewPool(
     if (vkMemoryTypeIndex >= VK_MAX_MEMORY_TYPES)
         return nullptr;
 
+    // If device local memory is required then don't exceed the budget for the heap, so the caller can fall back to host memory instead.
+    // Going over budget generally leads to poor performance or allocation failures later on.
+    const uint32_t vkMemoryHeapIdx = pPhysicalDevice->getMemProps().memoryTypes[vkMemoryTypeIndex].heapIndex;
+
+    if (bRequireDeviceLocalMem && (!isAllocWithinHeapBudget(vkMemoryHeapIdx, MAIN_POOL_SIZE)))
+        return nullptr;
+
     // Try to alloc a new id for this pool, if that fails then pool alloc fails
     const MemMgrIdT poolId = pickNewPoolId();
 
@@ -593,6 +704,7 @@ DeviceMemMgr::Pool* DeviceMemMgr::allocNewPool(
     pool.bIsHostVisible = bIsMemTypeHostVisible;
     pool.poolId = poolId;
     pool.vkMemoryTypeBit = 1 << vkMemoryTypeIndex;
+    pool.vkMemoryHeapIdx = vkMemoryHeapIdx;
     pool.vkDeviceMemory = vkDeviceMemory;
     pool.pMappedMemory = reinterpret_cast<std::byte*>(pMappedMemory);
 
@@ -693,6 +805,12 @@ bool DeviceMemMgr::allocUnpooled(
     if (vkMemoryTypeIndex >= VK_MAX_MEMORY_TYPES)
         return false;
 
+    // If device local memory is required then don't exceed the budget for the heap, so the caller can fall back to host memory instead
+    const uint32_t vkMemoryHeapIdx = pPhysicalDevice->getMemProps().memoryTypes[vkMemoryTypeIndex].heapIndex;
+
+    if (bRequireDeviceLocalMem && (!isAllocWithinHeapBudget(vkMemoryHeapIdx, numBytes)))
+        return false;
+
     // Allocate an id for the allocation and if that fails then the alloc itself fails
     const MemMgrIdT allocId = pickNewUnpooledAllocId();
 
@@ -741,7 +859,10 @@ bool DeviceMemMgr::allocUnpooled(
     }
 
     // Okay, all good! Save the allocation details:
-    DeviceMemAlloc& alloc = mUnpooledAllocs[allocId];
+    UnpooledAlloc& unpooledAlloc = mUnpooledAllocs[allocId];
+    unpooledAlloc.vkMemoryHeapIdx = vkMemoryHeapIdx;
+
+    DeviceMemAlloc& alloc = unpooledAlloc.alloc;
     alloc.vkDeviceMemory = vkDeviceMemory;
     alloc.offset = 0;
     alloc.size = numBytes;
@@ -780,6 +901,73 @@ void DeviceMemMgr::freeUnpooledAlloc(DeviceMemAlloc& alloc) noexcept {
     alloc = {};
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Queries the current budget and usage for each Vulkan memory heap using the 'VK_EXT_memory_budget' extension.
+// Returns 'false' if this information is not available.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool DeviceMemMgr::queryHeapBudgets(
+    VkDeviceSize heapBudgetsOut[VK_MAX_MEMORY_HEAPS],
+    VkDeviceSize heapUsagesOut[VK_MAX_MEMORY_HEAPS]
+) const noexcept {
+    if ((!mpDevice) || (!mpDevice->hasMemoryBudgetExt()))
+        return false;
+
+    const PhysicalDevice* const pPhysicalDevice = mpDevice->getPhysicalDevice();
+    ASSERT(pPhysicalDevice);
+    ASSERT(mVkFuncs.vkGetPhysicalDeviceMemoryProperties2KHR);
+
+    VkPhysicalDeviceMemoryBudgetPropertiesEXT budgetProps = {};
+    budgetProps.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+
+    VkPhysicalDeviceMemoryProperties2KHR memProps = {};
+    memProps.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2_KHR;
+    memProps.pNext = &budgetProps;
+
+    mVkFuncs.vkGetPhysicalDeviceMemoryProperties2KHR(pPhysicalDevice->getVkPhysicalDevice(), &memProps);
+    std::copy(budgetProps.heapBudget, budgetProps.heapBudget + VK_MAX_MEMORY_HEAPS, heapBudgetsOut);
+    std::copy(budgetProps.heapUsage, budgetProps.heapUsage + VK_MAX_MEMORY_HEAPS, heapUsagesOut);
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tells if allocating the specified number of bytes from the given Vulkan memory heap would keep the process within the heap's budget.
+// If no budget information is available then the allocation is assumed to be within budget; allocation will simply fail if it is not.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool DeviceMemMgr::isAllocWithinHeapBudget(const uint32_t vkMemoryHeapIdx, const uint64_t numBytes) const noexcept {
+    ASSERT(vkMemoryHeapIdx < VK_MAX_MEMORY_HEAPS);
+
+    VkDeviceSize heapBudgets[VK_MAX_MEMORY_HEAPS] = {};
+    VkDeviceSize heapUsages[VK_MAX_MEMORY_HEAPS] = {};
+
+    if (!queryHeapBudgets(heapBudgets, heapUsages))
+        return true;
+
+    return (heapUsages[vkMemoryHeapIdx] + numBytes <= heapBudgets[vkMemoryHeapIdx]);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tries to reclaim memory in preparation for retrying a failed allocation.
+// Frees retired resources for any ringbuffer slots which the GPU has finished processing and then frees any pools that are now unused.
+// If 'bWaitForGpu' is set then the GPU is waited on to finish all frames that it is processing first, so more resources can be freed.
+// Returns 'false' if reclaiming memory is not possible, in which case an allocation should not be retried.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool DeviceMemMgr::reclaimRetiredMemory(const bool bWaitForGpu) noexcept {
+    if ((!mbIsValid) || (!mpDevice))
+        return false;
+
+    RingbufferMgr& ringbufferMgr = mpDevice->getRingbufferMgr();
+
+    if (!ringbufferMgr.isValid())
+        return false;
+
+    ringbufferMgr.doCleanupForCompletedBufferSlots(bWaitForGpu);
+    freeUnusedPools();
+
+    // Budgets may have freed up also, so allow device local memory to be tried again
+    mbDeviceMemExhausted = false;
+    return true;
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Attempt to choose a new pool id within the memory manager
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -12,6 +12,38 @@ BEGIN_NAMESPACE(vgl)
 class LogicalDevice;
 struct VkFuncs;
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Statistics for one Vulkan memory heap, as reported by the device memory manager
+//------------------------------------------------------------------------------------------------------------------------------------------
+struct DeviceMemHeapStats {
+    uint64_t    heapSize;               // Total size of the heap, as reported by Vulkan
+    uint64_t    budget;                 // How much of the heap this process can use before problems may occur (just the heap size if budget info is unavailable)
+    uint64_t    usage;                  // How much of the heap this process is using (just what this manager allocated if budget info is unavailable)
+    uint64_t    numPoolBytes;           // How many bytes are allocated from Vulkan for pools on this heap
+    uint64_t    numPoolBytesUsed;       // How many bytes within pools on this heap are in use by allocations
+    uint64_t    numPoolBytesFree;       // How many bytes within pools on this heap are free
+    uint64_t    largestPoolFreeBlock;   // The largest allocation that is guaranteed to succeed in an existing pool on this heap, without allocating a new pool
+    uint64_t    numUnpooledBytes;       // How many bytes are allocated from Vulkan for unpooled allocations on this heap
+    uint32_t    numPools;               // How many pools are allocated on this heap
+    uint32_t    numUnpooledAllocs;      // How many unpooled allocations have been made on this heap
+    bool        bIsDeviceLocal;         // True if the heap is local to the device
+
+    // Get a measure of how fragmented the free space within pools on this heap is, from 0.0 (not fragmented at all) to 1.0.
+    // This is computed from the size of the largest contiguous free block relative to the total number of free bytes.
+    inline float getPoolFragmentation() const noexcept {
+        return (numPoolBytesFree > 0) ? 1.0f - (float)((double) largestPoolFreeBlock / (double) numPoolBytesFree) : 0.0f;
+    }
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Statistics for all of the memory heaps managed by the device memory manager
+//------------------------------------------------------------------------------------------------------------------------------------------
+struct DeviceMemStats {
+    uint32_t            numHeaps;                           // How many heaps the device has
+    bool                bHaveBudgetInfo;                    // True if the budget & usage info came from the 'VK_EXT_memory_budget' extension
+    DeviceMemHeapStats  heaps[VK_MAX_MEMORY_HEAPS];         // Stats for each heap
+};
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Manages vulkan device memory. Provides an interface to allocate both host visible/coherent memory (normally just RAM) as well as device
 // local memory (typically on-card GDDR RAM etc.) via 'vkAllocateMemory'. Allocates memory in large pools/chunks but also supports
@@ -22,7 +54,9 @@ struct VkFuncs;
 // of shared memory system, but you can check in the returned allocation details whether this is the case or not.
 //
 // Note that if on-device memory allocation fails, the memory manager will fall back to to using slower regular RAM where it can instead.
-// If that subsequent allocation fails then the app will terminate with an out of memory error.
+// If the 'VK_EXT_memory_budget' extension is available then this fallback also happens when on-device memory allocation would exceed the
+// budget for the heap. If all allocation attempts fail then the manager tries to release any retired resources which the GPU is finished
+// with (and the pools that frees up) before retrying. If that fails also then the app will terminate with an out of memory error.
 //------------------------------------------------------------------------------------------------------------------------------------------
 class DeviceMemMgr {
 public:
@@ -44,6 +78,7 @@ public:
 
     void dealloc(DeviceMemAlloc& allocInfo) noexcept;
     void freeUnusedPools() noexcept;
+    void getStats(DeviceMemStats& statsOut) const noexcept;
 
 private:
     // Copy and move are disallowed
@@ -102,6 +137,7 @@ private:
             , poolId(INVALID_MEM_MGR_ID)
             , nextNewSubPoolId(1)
             , vkMemoryTypeBit(0)
+            , vkMemoryHeapIdx(0)
             , vkDeviceMemory(VK_NULL_HANDLE)
             , pMappedMemory(nullptr)
             , subPools()
@@ -127,6 +163,9 @@ private:
         // if the allocation can be performed using this pool.
         uint32_t vkMemoryTypeBit;
 
+        // Which Vulkan memory heap the memory for this pool comes from
+        uint32_t vkMemoryHeapIdx;
+
         // Pointer to the Vulkan Device memory for this pool
         VkDeviceMemory vkDeviceMemory;
 
@@ -141,7 +180,15 @@ private:
         AbstractFixedQTreeMemMgr<MAIN_POOL_UNIT_SIZE, MAIN_POOL_NUM_TIERS> memMgr;
     };
 
-    bool allocFromAllPools(
+    //--------------------------------------------------------------------------------------------------------------------------------------
+    // Represents one unpooled allocation in the manager
+    //--------------------------------------------------------------------------------------------------------------------------------------
+    struct UnpooledAlloc {
+        DeviceMemAlloc  alloc;              // Details for the allocation
+        uint32_t        vkMemoryHeapIdx;    // Which Vulkan memory heap the allocation comes from
+    };
+
+    bool tryAlloc(
         const uint64_t numBytes,
         const uint32_t allowedVkMemTypeBits,
         const uint32_t alignment,
@@ -149,6 +196,14 @@ private:
         DeviceMemAlloc& allocInfoOut
     ) noexcept;
 
+    bool allocFromAllPools(
+        const uint64_t numBytes,
+        const uint32_t alignment,
+        const uint32_t allowedVkMemTypeBits,
+        const DeviceMemAllocMode allocMode,
+        DeviceMemAlloc& allocInfoOut
+    ) noexcept;
+
     bool allocFromPool(
         const uint64_t numBytes,
         const uint32_t alignment,
@@ -188,6 +243,9 @@ private:
     ) noexcept;
 
     void freeUnpooledAlloc(DeviceMemAlloc& alloc) noexcept;
+    bool queryHeapBudgets(VkDeviceSize heapBudgetsOut[VK_MAX_MEMORY_HEAPS], VkDeviceSize heapUsagesOut[VK_MAX_MEMORY_HEAPS]) const noexcept;
+    bool isAllocWithinHeapBudget(const uint32_t vkMemoryHeapIdx, const uint64_t numBytes) const noexcept;
+    bool reclaimRetiredMemory(const bool bWaitForGpu) noexcept;
 
     MemMgrIdT pickNewPoolId() noexcept;
     MemMgrIdT pickNewSubPoolId(Pool& parentPool) noexcept;
@@ -197,7 +255,7 @@ private:
     const VkFuncs&                          mVkFuncs;               // Pointer to Vulkan API functions
     LogicalDevice*                          mpDevice;               // Device this belongs to
     std::map<MemMgrIdT, Pool>               mPools;                 // Memory pools in the device memory manager
-    std::map<MemMgrIdT, DeviceMemAlloc>     mUnpooledAllocs;        // Unpooled allocations made
+    std::map<MemMgrIdT, UnpooledAlloc>      mUnpooledAllocs;        // Unpooled allocations made
     std::vector<MemMgrIdT>                  mDeviceLocalPools;      // A list of memory pools that are guaranteed local to the device. These probably won't be CPU/host visible unless there is a shared memory architecture.
     std::vector<MemMgrIdT>                  mHostVisiblePools;      // A list of memory pools that are guaranteed host visible. These probably won't be on the device unless there is a shared memory architecture.
     MemMgrIdT                               mNextNewPoolId;         // Use this id for the next memory pool to create
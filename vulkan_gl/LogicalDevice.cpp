@@ -28,6 +28,8 @@ LogicalDevice::LogicalDevice(VkFuncs& vkFuncs) noexcept
     : mVkFuncs(vkFuncs)
     , mbIsValid(false)
     , mbIsHeadless(false)
+    , mbHasMemoryBudgetExt(false)
+    , mbHasTimelineSemaphores(false)
     , mpVulkanInstance(nullptr)
     , mpPhysicalDevice(nullptr)
     , mpWindowSurface(nullptr)
@@ -36,6 +38,8 @@ LogicalDevice::LogicalDevice(VkFuncs& vkFuncs) noexcept
     , mWorkQueue(VK_NULL_HANDLE)
     , mPresentationQueueFamilyIdx(INVALID_QUEUE_FAMILY_IDX)
     , mPresentationQueue(VK_NULL_HANDLE)
+    , mTransferQueueFamilyIdx(INVALID_QUEUE_FAMILY_IDX)
+    , mTransferQueue(VK_NULL_HANDLE)
     , mCmdPool()
     , mDeviceMemMgr(vkFuncs)
     , mRingbufferMgr()
@@ -137,7 +141,7 @@ void LogicalDevice::destroy(const bool bForceIfInvalid) noexcept {
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Submit a single command buffer for execution to the device. 
+// Submit a single command buffer for execution to the device's work queue.
 // Can optionally be made to wait on the given command buffer wait conditions.
 // Can optionally signal a semaphore or fence, or both.
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -146,9 +150,61 @@ bool LogicalDevice::submitCmdBuffer(
     const std::vector<CmdBufferWaitCond>& waitConditions,
     const Semaphore* const pSignalSemaphore,
     const Fence* const pSignalFence
+) noexcept {
+    return submitCmdBufferToQueue(mWorkQueue, cmdBuffer, waitConditions, pSignalSemaphore, pSignalFence);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Submit a single command buffer for execution to the device's dedicated transfer queue; the device must have one to call this.
+// The command buffer must have been allocated from a command pool for the transfer queue family.
+// Can optionally be made to wait on the given command buffer wait conditions, and signal a semaphore or fence (or both).
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool LogicalDevice::submitTransferCmdBuffer(
+    const CmdBuffer& cmdBuffer,
+    const std::vector<CmdBufferWaitCond>& waitConditions,
+    const Semaphore* const pSignalSemaphore,
+    const Fence* const pSignalFence
+) noexcept {
+    ASSERT(hasDedicatedTransferQueue());
+    return submitCmdBufferToQueue(mTransferQueue, cmdBuffer, waitConditions, pSignalSemaphore, pSignalFence);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Waits for the device to be idle. All operations will complete after this.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void LogicalDevice::waitUntilDeviceIdle() noexcept {
+    // Note: no check for 'mbIsValid' since this function is invoked during the destructor.
+    // It's called when the device is not 100% in a valid state:
+    ASSERT(mVkDevice);
+
+    if (mTransferMgr.isValid()) {
+        // Finish up all transfers before we do the cleanup below
+        mTransferMgr.executePreFrameTransferTask();
+    }
+
+    mVkFuncs.vkDeviceWaitIdle(mVkDevice);
+
+    // Do cleanup for all ringbuffer slots if we can, since the device is now completely idle
+    if (mRingbufferMgr.isValid()) {
+        mRingbufferMgr.doCleanupForAllBufferSlots();
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Submit a single command buffer for execution to the specified queue of the device.
+// Can optionally be made to wait on the given command buffer wait conditions.
+// Can optionally signal a semaphore or fence, or both.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool LogicalDevice::submitCmdBufferToQueue(
+    const VkQueue vkQueue,
+    const CmdBuffer& cmdBuffer,
+    const std::vector<CmdBufferWaitCond>& waitConditions,
+    const Semaphore* const pSignalSemaphore,
+    const Fence* const pSignalFence
 ) noexcept {
     // Sanity checks
     ASSERT(mbIsValid);
+    ASSERT(vkQueue);
     ASSERT(cmdBuffer.isValid());
 
     // Prepare the list of semaphores that we will wait on:
@@ -171,19 +227,38 @@ bool LogicalDevice::submitCmdBuffer(
         }
     }
 
-    // The semaphore that will be signalled when done (if any)
-    VkSemaphore signalVkSemaphore;
-    uint32_t numSignalSemaphores;
+    // The semaphores that will be signalled when done (if any).
+    // If this submission signals the fence for the current ringbuffer slot then it also signals the current frame's timeline value,
+    // if there is a frame timeline semaphore. Note that binary semaphores ignore the timeline value given to them.
+    VkSemaphore signalVkSemaphores[2];
+    uint64_t signalTimelineValues[2];
+    uint32_t numSignalSemaphores = 0;
 
     if (pSignalSemaphore) {
         ASSERT(pSignalSemaphore->isValid());
-        signalVkSemaphore = pSignalSemaphore->getVkSemaphore();
-        numSignalSemaphores = 1;
-    } else {
-        signalVkSemaphore = VK_NULL_HANDLE;
-        numSignalSemaphores = 0;
+        signalVkSemaphores[numSignalSemaphores] = pSignalSemaphore->getVkSemaphore();
+        signalTimelineValues[numSignalSemaphores] = 0;
+        numSignalSemaphores++;
     }
 
+    const bool bSignalFrameTimeline = (
+        pSignalFence &&
+        mRingbufferMgr.isValid() &&
+        mRingbufferMgr.hasFrameTimeline() &&
+        (pSignalFence == &mRingbufferMgr.getCurrentBufferFence())
+    );
+
+    if (bSignalFrameTimeline) {
+        signalVkSemaphores[numSignalSemaphores] = mRingbufferMgr.getFrameTimeline().getVkSemaphore();
+        signalTimelineValues[numSignalSemaphores] = mRingbufferMgr.getFrameTimelineValue();
+        numSignalSemaphores++;
+    }
+
+    VkTimelineSemaphoreSubmitInfoKHR timelineSubmitInfo = {};
+    timelineSubmitInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR;
+    timelineSubmitInfo.signalSemaphoreValueCount = numSignalSemaphores;
+    timelineSubmitInfo.pSignalSemaphoreValues = signalTimelineValues;
+
     // The fence that will be signalled when done (if any) and the command buffer to submit
     const VkFence signalVkFence = (pSignalFence) ? pSignalFence->getVkFence() : VK_NULL_HANDLE;
     const VkCommandBuffer vkCommandBuffer = cmdBuffer.getVkCommandBuffer();
@@ -197,35 +272,18 @@ bool LogicalDevice::submitCmdBuffer(
     submitInfo.commandBufferCount = 1;
     submitInfo.pCommandBuffers = &vkCommandBuffer;
     submitInfo.signalSemaphoreCount = numSignalSemaphores;
-    submitInfo.pSignalSemaphores = &signalVkSemaphore;
+    submitInfo.pSignalSemaphores = signalVkSemaphores;
 
-    if (mVkFuncs.vkQueueSubmit(mWorkQueue, 1, &submitInfo, signalVkFence) != VK_SUCCESS) {
-        ASSERT_FAIL("Failed to submit the command buffer to the graphics queue for rendering!");
-        return false;
+    if (bSignalFrameTimeline) {
+        submitInfo.pNext = &timelineSubmitInfo;
     }
 
-    return true;
-}
-
-//------------------------------------------------------------------------------------------------------------------------------------------
-// Waits for the device to be idle. All operations will complete after this.
-//------------------------------------------------------------------------------------------------------------------------------------------
-void LogicalDevice::waitUntilDeviceIdle() noexcept {
-    // Note: no check for 'mbIsValid' since this function is invoked during the destructor.
-    // It's called when the device is not 100% in a valid state:
-    ASSERT(mVkDevice);
-
-    if (mTransferMgr.isValid()) {
-        // Finish up all transfers before we do the cleanup below
-        mTransferMgr.executePreFrameTransferTask();
+    if (mVkFuncs.vkQueueSubmit(vkQueue, 1, &submitInfo, signalVkFence) != VK_SUCCESS) {
+        ASSERT_FAIL("Failed to submit the command buffer to a device queue!");
+        return false;
     }
 
-    mVkFuncs.vkDeviceWaitIdle(mVkDevice);
-
-    // Do cleanup for all ringbuffer slots if we can, since the device is now completely idle
-    if (mRingbufferMgr.isValid()) {
-        mRingbufferMgr.doCleanupForAllBufferSlots();
-    }
+    return true;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -280,16 +338,28 @@ bool LogicalDevice::createDeviceAndQueues() noexcept {
         }
     }
 
+    // Use a dedicated transfer queue also if the device has one, so that transfers can overlap with other work
+    chooseDedicatedTransferQueueFamily();
+
     // Decide how many queues we need to create.
     // We create 1 for each unique queue family that we require.
-    constexpr const uint32_t MAX_QUEUE_FAMILIES = 2;
-    uint32_t requiredQueueFamilyIdxs[MAX_QUEUE_FAMILIES] = { mWorkQueueFamilyIdx, UINT32_MAX };
+    constexpr const uint32_t MAX_QUEUE_FAMILIES = 3;
+    uint32_t requiredQueueFamilyIdxs[MAX_QUEUE_FAMILIES] = { mWorkQueueFamilyIdx, UINT32_MAX, UINT32_MAX };
     uint32_t numQueuesToCreate = 1;
 
     if (!mbIsHeadless) {
         if (mPresentationQueueFamilyIdx != mWorkQueueFamilyIdx) {
-            requiredQueueFamilyIdxs[1] = mPresentationQueueFamilyIdx;
-            numQueuesToCreate = 2;
+            requiredQueueFamilyIdxs[numQueuesToCreate] = mPresentationQueueFamilyIdx;
+            numQueuesToCreate++;
+        }
+    }
+
+    if (mTransferQueueFamilyIdx != INVALID_QUEUE_FAMILY_IDX) {
+        const bool bIsPresentationQueueFamily = ((!mbIsHeadless) && (mTransferQueueFamilyIdx == mPresentationQueueFamilyIdx));
+
+        if (!bIsPresentationQueueFamily) {
+            requiredQueueFamilyIdxs[numQueuesToCreate] = mTransferQueueFamilyIdx;
+            numQueuesToCreate++;
         }
     }
 
@@ -325,6 +395,26 @@ bool LogicalDevice::createDeviceAndQueues() noexcept {
         std::vector<const char*> reqDeviceExts;
         reqDeviceExts.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
 
+        // Enable memory budget queries if possible, so the device memory manager can avoid going over budget.
+        // Note: querying the budget requires 'vkGetPhysicalDeviceMemoryProperties2KHR' from the 'VK_KHR_get_physical_device_properties2'
+        // instance extension, which is enabled whenever it is available.
+        if (mVkFuncs.vkGetPhysicalDeviceMemoryProperties2KHR &&
+            mpPhysicalDevice->getExtensions().hasExtension(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME)
+        ) {
+            reqDeviceExts.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+            mbHasMemoryBudgetExt = true;
+        }
+
+        // Enable timeline semaphores if possible, so retired resources can be freed as soon as the GPU is done with them
+        VkPhysicalDeviceTimelineSemaphoreFeaturesKHR timelineFeatures = {};
+        timelineFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR;
+
+        if (mpPhysicalDevice->supportsTimelineSemaphores()) {
+            reqDeviceExts.push_back(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME);
+            timelineFeatures.timelineSemaphore = VK_TRUE;
+            mbHasTimelineSemaphores = true;
+        }
+
         if (mpVulkanInstance->areValidationLayersEnabled()) {
             // Enable the portability subset also if available (on MacOS) to identify parts of Vulkan we can't use.
             // If we use something that isn't supported for MacOS then we'll get a validation layer error:
@@ -341,6 +431,10 @@ bool LogicalDevice::createDeviceAndQueues() noexcept {
         createInfo.ppEnabledExtensionNames = reqDeviceExts.data();
         createInfo.enabledExtensionCount = (uint32_t) reqDeviceExts.size();
 
+        if (mbHasTimelineSemaphores) {
+            createInfo.pNext = &timelineFeatures;
+        }
+
         if (mVkFuncs.vkCreateDevice(mpPhysicalDevice->getVkPhysicalDevice(), &createInfo, nullptr, &mVkDevice) != VK_SUCCESS) {
             ASSERT_FAIL("Failed to create a logical device!");
             return false;
@@ -368,6 +462,10 @@ void LogicalDevice::destroyDeviceAndQueues() noexcept {
     }
 
     // Note: queues get destroyed automatically with the device, so we only null out to cleanup the references
+    mTransferQueue = VK_NULL_HANDLE;
+    mTransferQueueFamilyIdx = INVALID_QUEUE_FAMILY_IDX;
+    mbHasMemoryBudgetExt = false;
+    mbHasTimelineSemaphores = false;
     mPresentationQueue = VK_NULL_HANDLE;
     mPresentationQueueFamilyIdx = INVALID_QUEUE_FAMILY_IDX;
     mWorkQueue = VK_NULL_HANDLE;
@@ -450,6 +548,37 @@ bool LogicalDevice::chooseOptimalPresentationQueueFamily(const std::vector<uint3
     return false;
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Looks for a queue family which only supports transfers (no graphics or compute), which typically corresponds to a dedicated DMA engine
+// on discrete GPUs. Transfers submitted to such a queue can execute in parallel with rendering. The queue family must also be able to
+// transfer to arbitrary texel offsets, so that it can handle any texture upload. Sets the transfer queue family to invalid if none found.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void LogicalDevice::chooseDedicatedTransferQueueFamily() noexcept {
+    ASSERT(mpPhysicalDevice);
+    mTransferQueueFamilyIdx = INVALID_QUEUE_FAMILY_IDX;
+
+    const std::vector<VkQueueFamilyProperties>& queueFamilyProps = mpPhysicalDevice->getQueueFamilyProps();
+    const std::vector<uint32_t>& transferQueueFamilies = mpPhysicalDevice->getTransferQueueFamilyIndexes();
+
+    for (const uint32_t queueFamilyIdx : transferQueueFamilies) {
+        if (queueFamilyIdx == mWorkQueueFamilyIdx)
+            continue;
+
+        const VkQueueFamilyProperties& props = queueFamilyProps[queueFamilyIdx];
+
+        if (props.queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT))
+            continue;
+
+        const VkExtent3D& granularity = props.minImageTransferGranularity;
+
+        if ((granularity.width != 1) || (granularity.height != 1) || (granularity.depth != 1))
+            continue;
+
+        mTransferQueueFamilyIdx = queueFamilyIdx;
+        return;
+    }
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Gather all queue handles for created queues after device creation. Returns false on failure.
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -478,6 +607,10 @@ bool LogicalDevice::gatherCreatedQueueHandles(
                         mPresentationQueue = queue;
                     }
                 }
+
+                if (queueFamilyIdx == mTransferQueueFamilyIdx) {
+                    mTransferQueue = queue;
+                }
             }
         }
 
@@ -497,6 +630,11 @@ bool LogicalDevice::gatherCreatedQueueHandles(
         }
     }
 
+    // Note: a missing dedicated transfer queue is not an error, just fallback to doing all transfers on the work queue
+    if (!mTransferQueue) {
+        mTransferQueueFamilyIdx = INVALID_QUEUE_FAMILY_IDX;
+    }
+
     // If we got to here then this all went well
     return true;
 }
@@ -35,6 +35,8 @@ public:
 
     inline bool isValid() const noexcept { return mbIsValid; }
     inline bool isHeadless() const noexcept { return mbIsHeadless; }
+    inline bool hasMemoryBudgetExt() const noexcept { return mbHasMemoryBudgetExt; }
+    inline bool hasTimelineSemaphores() const noexcept { return mbHasTimelineSemaphores; }
     inline const VulkanInstance* getVulkanInstance() const noexcept { return mpVulkanInstance; }
     inline const PhysicalDevice* getPhysicalDevice() const noexcept { return mpPhysicalDevice; }
     inline const WindowSurface* getWindowSurface() const noexcept { return mpWindowSurface; }
@@ -44,6 +46,9 @@ public:
     inline VkQueue getWorkQueue() const noexcept { return mWorkQueue; }
     inline uint32_t getPresentationQueueFamilyIdx() const noexcept { return mPresentationQueueFamilyIdx; }
     inline VkQueue getPresentationQueue() const noexcept { return mPresentationQueue; }
+    inline bool hasDedicatedTransferQueue() const noexcept { return (mTransferQueue != VK_NULL_HANDLE); }
+    inline uint32_t getTransferQueueFamilyIdx() const noexcept { return mTransferQueueFamilyIdx; }
+    inline VkQueue getTransferQueue() const noexcept { return mTransferQueue; }
     inline DeviceMemMgr& getDeviceMemMgr() noexcept { return mDeviceMemMgr; }
     inline RingbufferMgr& getRingbufferMgr() noexcept { return mRingbufferMgr; }
     inline RetirementMgr& getRetirementMgr() noexcept { return mRetirementMgr; }
@@ -57,6 +62,13 @@ public:
         const Fence* const pSignalFence
     ) noexcept;
 
+    bool submitTransferCmdBuffer(
+        const CmdBuffer& cmdBuffer,
+        const std::vector<CmdBufferWaitCond>& waitConditions,
+        const Semaphore* const pSignalSemaphore,
+        const Fence* const pSignalFence
+    ) noexcept;
+
     void waitUntilDeviceIdle() noexcept;
 
 private:
@@ -70,6 +82,15 @@ private:
     void destroyDeviceAndQueues() noexcept;
     bool chooseOptimalWorkQueueFamily(const std::vector<uint32_t>& validPresentationQueueFamilies) noexcept;
     bool chooseOptimalPresentationQueueFamily(const std::vector<uint32_t>& validPresentationQueueFamilies) noexcept;
+    void chooseDedicatedTransferQueueFamily() noexcept;
+
+    bool submitCmdBufferToQueue(
+        const VkQueue vkQueue,
+        const CmdBuffer& cmdBuffer,
+        const std::vector<CmdBufferWaitCond>& waitConditions,
+        const Semaphore* const pSignalSemaphore,
+        const Fence* const pSignalFence
+    ) noexcept;
 
     bool gatherCreatedQueueHandles(
         const VkDeviceQueueCreateInfo* const pQueueCreateInfos, 
@@ -79,6 +100,8 @@ private:
     VkFuncs&                mVkFuncs;                       // Pointers to Vulkan API functions
     bool                    mbIsValid;                      // True if the logical device was created & initialized successfully
     bool                    mbIsHeadless;                   // If true we are not presenting to a window surface, the device is in 'headless' mode
+    bool                    mbHasMemoryBudgetExt;           // If true then the 'VK_EXT_memory_budget' extension is enabled for the device
+    bool                    mbHasTimelineSemaphores;        // If true then the 'VK_KHR_timeline_semaphore' extension and feature are enabled for the device
     VulkanInstance*         mpVulkanInstance;               // Vulkan API instance used by the device
     const PhysicalDevice*   mpPhysicalDevice;               // The physical Vulkan device this logical device is based on
     const WindowSurface*    mpWindowSurface;                // The window surface to use for the logical device
@@ -87,6 +110,8 @@ private:
     VkQueue                 mWorkQueue;                     // Handle to the queue that supports graphics + compute + transfer operations
     uint32_t                mPresentationQueueFamilyIdx;    // The index of the queue family the presentation queue belongs to
     VkQueue                 mPresentationQueue;             // Handle to the presentation queue for the device
+    uint32_t                mTransferQueueFamilyIdx;        // The index of the queue family for the dedicated transfer queue (invalid if none)
+    VkQueue                 mTransferQueue;                 // Handle to a dedicated transfer only queue, if the device has one (null otherwise)
     CmdPool                 mCmdPool;                       // A command pool used by the transfer manager and possibly application code too
     DeviceMemMgr            mDeviceMemMgr;                  // Used for allocating Vulkan device memory
     RingbufferMgr           mRingbufferMgr;                 // Keeps track of which ringbuffer we are on and holds sync primitives for ringbuffers
@@ -43,6 +43,7 @@ PhysicalDevice::PhysicalDevice(const VkFuncs& vkFuncs, VulkanInstance& vulkanIns
     , mMemProps()
     , mDeviceMem(0)
     , mNonDeviceMem(0)
+    , mbSupportsTimelineSemaphores(false)
     , mQueueFamilyProps()
     , mGraphicsQueueFamilyIndexes()
     , mComputeQueueFamilyIndexes()
@@ -113,6 +114,20 @@ PhysicalDevice::PhysicalDevice(const VkFuncs& vkFuncs, VulkanInstance& vulkanIns
 
     // Query device extensions
     mExtensions.init(vkFuncs, vkPhysicalDevice);
+
+    // See if timeline semaphores are supported.
+    // Querying the feature requires the 'VK_KHR_get_physical_device_properties2' instance extension, which is enabled if available.
+    if (mVkFuncs.vkGetPhysicalDeviceFeatures2KHR && mExtensions.hasExtension(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME)) {
+        VkPhysicalDeviceTimelineSemaphoreFeaturesKHR timelineFeatures = {};
+        timelineFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR;
+
+        VkPhysicalDeviceFeatures2KHR features2 = {};
+        features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2_KHR;
+        features2.pNext = &timelineFeatures;
+
+        mVkFuncs.vkGetPhysicalDeviceFeatures2KHR(vkPhysicalDevice, &features2);
+        mbSupportsTimelineSemaphores = (timelineFeatures.timelineSemaphore == VK_TRUE);
+    }
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -29,6 +29,7 @@ public:
     inline const std::vector<uint32_t> getGraphicsQueueFamilyIndexes() const noexcept { return mGraphicsQueueFamilyIndexes; }
     inline const std::vector<uint32_t> getComputeQueueFamilyIndexes() const noexcept { return mComputeQueueFamilyIndexes; }
     inline const std::vector<uint32_t> getTransferQueueFamilyIndexes() const noexcept { return mTransferQueueFamilyIndexes; }
+    inline bool supportsTimelineSemaphores() const noexcept { return mbSupportsTimelineSemaphores; }
 
     // Gives the name of the device as a null terminated C-String
     inline const char* getName() const noexcept { return mProps.deviceName; }
@@ -98,6 +99,7 @@ private:
     VkPhysicalDeviceMemoryProperties        mMemProps;                      // Description of available memory for the physical device
     uint64_t                                mDeviceMem;                     // Number of bytes available for on-device memory
     uint64_t                                mNonDeviceMem;                  // Number of bytes available for general system memory
+    bool                                    mbSupportsTimelineSemaphores;   // True if the 'VK_KHR_timeline_semaphore' extension and feature are supported
     std::vector<VkQueueFamilyProperties>    mQueueFamilyProps;              // Properties for each queue family
     std::vector<uint32_t>                   mGraphicsQueueFamilyIndexes;    // Which queue families support graphics operations
     std::vector<uint32_t>                   mComputeQueueFamilyIndexes;     // Which queue families support compute operations
@@ -3,6 +3,7 @@
 #include "Finally.h"
 #include "LogicalDevice.h"
 #include "PhysicalDevice.h"
+#include "PipelineCache.h"
 #include "PipelineLayout.h"
 #include "RenderPass.h"
 #include "RetirementMgr.h"
@@ -48,7 +49,8 @@ Pipeline::~Pipeline() noexcept {
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Initializes a graphics pipeline with the specified settings and state
+// Initializes a graphics pipeline with the specified settings and state.
+// Optionally, a pipeline cache can be specified to speed up pipeline creation.
 //------------------------------------------------------------------------------------------------------------------------------------------
 bool Pipeline::initGraphicsPipeline(
     const PipelineLayout& pipelineLayout,
@@ -65,7 +67,8 @@ bool Pipeline::initGraphicsPipeline(
     const PipelineRasterizationState& rasterizationState,
     const PipelineMultisampleState& multisampleState,
     const PipelineColorBlendState& colorBlendState,
-    const PipelineDepthStencilState& depthStencilState
+    const PipelineDepthStencilState& depthStencilState,
+    const PipelineCache* const pPipelineCache
 ) noexcept {
     //------------------------------------------------------------------------------------------------------------------
     // The basics
@@ -258,8 +261,9 @@ bool Pipeline::initGraphicsPipeline(
     pipelineCI.basePipelineIndex = -1;                  // Used when creating derived pipelines
 
     const VkFuncs& vkFuncs = device.getVkFuncs();
+    const VkPipelineCache vkPipelineCache = (pPipelineCache) ? pPipelineCache->getVkPipelineCache() : VK_NULL_HANDLE;
 
-    if (vkFuncs.vkCreateGraphicsPipelines(device.getVkDevice(), VK_NULL_HANDLE, 1, &pipelineCI, nullptr, &mVkPipeline) != VK_SUCCESS) {
+    if (vkFuncs.vkCreateGraphicsPipelines(device.getVkDevice(), vkPipelineCache, 1, &pipelineCI, nullptr, &mVkPipeline) != VK_SUCCESS) {
         ASSERT_FAIL("Failed to create a graphics pipeline!");
         return false;
     }
@@ -272,12 +276,14 @@ bool Pipeline::initGraphicsPipeline(
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Initializes a compute pipeline with the specified settings and state
+// Initializes a compute pipeline with the specified settings and state.
+// Optionally, a pipeline cache can be specified to speed up pipeline creation.
 //------------------------------------------------------------------------------------------------------------------------------------------
 bool Pipeline::initComputePipeline(
     const VkPipelineLayout& pipelineLayout,
     const ShaderModule& shaderModule,
-    const VkSpecializationInfo* const pShaderSpecializationInfo
+    const VkSpecializationInfo* const pShaderSpecializationInfo,
+    const PipelineCache* const pPipelineCache
 ) noexcept {
     //------------------------------------------------------------------------------------------------------------------
     // The basics
@@ -319,8 +325,9 @@ bool Pipeline::initComputePipeline(
     pipelineCI.basePipelineIndex = -1;                  // Used when creating derived pipelines
 
     const VkFuncs& vkFuncs = device.getVkFuncs();
+    const VkPipelineCache vkPipelineCache = (pPipelineCache) ? pPipelineCache->getVkPipelineCache() : VK_NULL_HANDLE;
 
-    if (vkFuncs.vkCreateComputePipelines(device.getVkDevice(), VK_NULL_HANDLE, 1, &pipelineCI, nullptr, &mVkPipeline) != VK_SUCCESS) {
+    if (vkFuncs.vkCreateComputePipelines(device.getVkDevice(), vkPipelineCache, 1, &pipelineCI, nullptr, &mVkPipeline) != VK_SUCCESS) {
         ASSERT_FAIL("Failed to create a compute pipeline!");
         return false;
     }
@@ -7,6 +7,7 @@
 BEGIN_NAMESPACE(vgl)
 
 class LogicalDevice;
+class PipelineCache;
 class PipelineLayout;
 class RenderPass;
 class ShaderModule;
@@ -179,13 +180,15 @@ public:
         const PipelineRasterizationState& rasterizationState,
         const PipelineMultisampleState& multisampleState,
         const PipelineColorBlendState& colorBlendState,
-        const PipelineDepthStencilState& depthStencilState
+        const PipelineDepthStencilState& depthStencilState,
+        const PipelineCache* const pPipelineCache = nullptr
     ) noexcept;
 
     bool initComputePipeline(
         const VkPipelineLayout& pipelineLayout,
         const ShaderModule& shaderModule,
-        const VkSpecializationInfo* const pShaderSpecializationInfo
+        const VkSpecializationInfo* const pShaderSpecializationInfo,
+        const PipelineCache* const pPipelineCache = nullptr
     ) noexcept;
 
     void destroy(const bool bImmediately = false, const bool bForceIfInvalid = false) noexcept;
@@ -0,0 +1,222 @@
+#include "PipelineCache.h"
+
+#include "Finally.h"
+#include "LogicalDevice.h"
+#include "PhysicalDevice.h"
+#include "VkFuncs.h"
+
+#include <cstring>
+
+BEGIN_NAMESPACE(vgl)
+
+// Identifies serialized pipeline cache data, and the version of the wrapper header format
+static constexpr uint32_t CACHE_DATA_MAGIC = 0x43504756;    // 'VGPC' in little endian
+static constexpr uint32_t CACHE_DATA_VERSION = 1;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Header which precedes the data returned by Vulkan in serialized pipeline cache data.
+// Identifies the device and driver that the data was created with, since the data is useless (and potentially harmful) for others.
+//------------------------------------------------------------------------------------------------------------------------------------------
+struct CacheDataHdr {
+    uint32_t    magic;                                  // Should be 'CACHE_DATA_MAGIC'
+    uint32_t    version;                                // Should be 'CACHE_DATA_VERSION'
+    uint32_t    vendorId;                               // Vendor id of the physical device the data was created with
+    uint32_t    deviceId;                               // Device id of the physical device the data was created with
+    uint32_t    driverVersion;                          // Driver version the data was created with
+    uint32_t    vkDataSize;                             // Size of the Vulkan pipeline cache data following this header
+    uint8_t     pipelineCacheUuid[VK_UUID_SIZE];        // Pipeline cache UUID of the physical device the data was created with
+};
+
+static_assert(sizeof(CacheDataHdr) == 24 + VK_UUID_SIZE);
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Creates an uninitialized pipeline cache
+//------------------------------------------------------------------------------------------------------------------------------------------
+PipelineCache::PipelineCache() noexcept
+    : mbIsValid(false)
+    , mbWasInitializedFromData(false)
+    , mpDevice(nullptr)
+    , mVkPipelineCache(VK_NULL_HANDLE)
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Move constructor: relocate a pipeline cache to this object
+//------------------------------------------------------------------------------------------------------------------------------------------
+PipelineCache::PipelineCache(PipelineCache&& other) noexcept
+    : mbIsValid(other.mbIsValid)
+    , mbWasInitializedFromData(other.mbWasInitializedFromData)
+    , mpDevice(other.mpDevice)
+    , mVkPipelineCache(other.mVkPipelineCache)
+{
+    other.mbIsValid = false;
+    other.mbWasInitializedFromData = false;
+    other.mpDevice = nullptr;
+    other.mVkPipelineCache = VK_NULL_HANDLE;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Automatically destroys the pipeline cache
+//------------------------------------------------------------------------------------------------------------------------------------------
+PipelineCache::~PipelineCache() noexcept {
+    destroy();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Initializes the pipeline cache, optionally with serialized data previously retrieved via 'getData'.
+// If the initial data is not compatible with the device and driver then it is ignored, and the cache starts out empty.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool PipelineCache::init(LogicalDevice& device, const std::byte* const pInitialData, const size_t initialDataSize) noexcept {
+    // Preconditions
+    ASSERT_LOG((!mbIsValid), "Must call destroy() before re-initializing!");
+    ASSERT(device.getVkDevice());
+    ASSERT(device.getPhysicalDevice());
+
+    // If anything goes wrong, cleanup on exit - don't half initialize!
+    auto cleanupOnError = finally([&]{
+        if (!mbIsValid) {
+            destroy(true);
+        }
+    });
+
+    // Save for future reference
+    mpDevice = &device;
+
+    // Use the initial data only if it's for this device and driver
+    const bool bUseInitialData = (pInitialData && isDataCompatible(*device.getPhysicalDevice(), pInitialData, initialDataSize));
+
+    VkPipelineCacheCreateInfo createInfo = {};
+    createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+
+    if (bUseInitialData) {
+        createInfo.initialDataSize = initialDataSize - sizeof(CacheDataHdr);
+        createInfo.pInitialData = pInitialData + sizeof(CacheDataHdr);
+    }
+
+    const VkFuncs& vkFuncs = device.getVkFuncs();
+
+    if (vkFuncs.vkCreatePipelineCache(device.getVkDevice(), &createInfo, nullptr, &mVkPipelineCache) != VK_SUCCESS) {
+        ASSERT_FAIL("Failed to create a Vulkan pipeline cache!");
+        return false;
+    }
+
+    // Success!
+    mbWasInitializedFromData = bUseInitialData;
+    mbIsValid = true;
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Destroys the pipeline cache and releases its resources
+//------------------------------------------------------------------------------------------------------------------------------------------
+void PipelineCache::destroy(const bool bForceIfInvalid) noexcept {
+    // Only destroy if we need to
+    if ((!mbIsValid) && (!bForceIfInvalid))
+        return;
+
+    // Preconditions
+    ASSERT_LOG((!mpDevice) || mpDevice->getVkDevice(), "Parent device must still be valid if defined!");
+
+    // Cleanup and destroy the Vulkan pipeline cache.
+    // Note: no need to retire this gradually since the GPU never uses pipeline caches directly.
+    mbIsValid = false;
+
+    if (mVkPipelineCache) {
+        ASSERT(mpDevice && mpDevice->getVkDevice());
+        const VkFuncs& vkFuncs = mpDevice->getVkFuncs();
+        vkFuncs.vkDestroyPipelineCache(mpDevice->getVkDevice(), mVkPipelineCache, nullptr);
+        mVkPipelineCache = VK_NULL_HANDLE;
+    }
+
+    mbWasInitializedFromData = false;
+    mpDevice = nullptr;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Serializes the contents of the pipeline cache to the given byte vector, so it can be saved and used to initialize the cache later.
+// Returns 'false' on failure, in which case the output is left empty.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool PipelineCache::getData(std::vector<std::byte>& dataOut) const noexcept {
+    dataOut.clear();
+
+    if (!mbIsValid)
+        return false;
+
+    // Ask how much data there is first, then retrieve it after the wrapper header.
+    // Note: the size can be trimmed down by the 2nd call if the driver returns less data than it said it would.
+    const VkFuncs& vkFuncs = mpDevice->getVkFuncs();
+    const VkDevice vkDevice = mpDevice->getVkDevice();
+    size_t vkDataSize = 0;
+
+    if (vkFuncs.vkGetPipelineCacheData(vkDevice, mVkPipelineCache, &vkDataSize, nullptr) != VK_SUCCESS)
+        return false;
+
+    if ((vkDataSize == 0) || (vkDataSize > UINT32_MAX))
+        return false;
+
+    dataOut.resize(sizeof(CacheDataHdr) + vkDataSize);
+
+    if (vkFuncs.vkGetPipelineCacheData(vkDevice, mVkPipelineCache, &vkDataSize, dataOut.data() + sizeof(CacheDataHdr)) != VK_SUCCESS) {
+        dataOut.clear();
+        return false;
+    }
+
+    dataOut.resize(sizeof(CacheDataHdr) + vkDataSize);
+
+    // Fill in the wrapper header which identifies the device and driver
+    const VkPhysicalDeviceProperties& deviceProps = mpDevice->getPhysicalDevice()->getProps();
+
+    CacheDataHdr hdr = {};
+    hdr.magic = CACHE_DATA_MAGIC;
+    hdr.version = CACHE_DATA_VERSION;
+    hdr.vendorId = deviceProps.vendorID;
+    hdr.deviceId = deviceProps.deviceID;
+    hdr.driverVersion = deviceProps.driverVersion;
+    hdr.vkDataSize = (uint32_t) vkDataSize;
+    std::memcpy(hdr.pipelineCacheUuid, deviceProps.pipelineCacheUUID, VK_UUID_SIZE);
+    std::memcpy(dataOut.data(), &hdr, sizeof(hdr));
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tells if the given serialized pipeline cache data (from 'getData') can be used with the specified physical device and its driver.
+// Checks both the wrapper header and the Vulkan header that begins the pipeline cache data.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool PipelineCache::isDataCompatible(const PhysicalDevice& physicalDevice, const std::byte* const pData, const size_t dataSize) noexcept {
+    // Validate the wrapper header
+    if ((!pData) || (dataSize < sizeof(CacheDataHdr) + sizeof(VkPipelineCacheHeaderVersionOne)))
+        return false;
+
+    CacheDataHdr hdr;
+    std::memcpy(&hdr, pData, sizeof(hdr));
+
+    const VkPhysicalDeviceProperties& deviceProps = physicalDevice.getProps();
+
+    const bool bValidWrapperHdr = (
+        (hdr.magic == CACHE_DATA_MAGIC) &&
+        (hdr.version == CACHE_DATA_VERSION) &&
+        (hdr.vendorId == deviceProps.vendorID) &&
+        (hdr.deviceId == deviceProps.deviceID) &&
+        (hdr.driverVersion == deviceProps.driverVersion) &&
+        (hdr.vkDataSize == dataSize - sizeof(CacheDataHdr)) &&
+        (std::memcmp(hdr.pipelineCacheUuid, deviceProps.pipelineCacheUUID, VK_UUID_SIZE) == 0)
+    );
+
+    if (!bValidWrapperHdr)
+        return false;
+
+    // Validate the Vulkan pipeline cache header: drivers are not always robust against bad data, so it's worth double checking this
+    VkPipelineCacheHeaderVersionOne vkHdr;
+    std::memcpy(&vkHdr, pData + sizeof(CacheDataHdr), sizeof(vkHdr));
+
+    return (
+        (vkHdr.headerSize >= sizeof(VkPipelineCacheHeaderVersionOne)) &&
+        (vkHdr.headerSize <= hdr.vkDataSize) &&
+        (vkHdr.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE) &&
+        (vkHdr.vendorID == deviceProps.vendorID) &&
+        (vkHdr.deviceID == deviceProps.deviceID) &&
+        (std::memcmp(vkHdr.pipelineCacheUUID, deviceProps.pipelineCacheUUID, VK_UUID_SIZE) == 0)
+    );
+}
+
+END_NAMESPACE(vgl)
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "Macros.h"
+
+#include <cstddef>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+BEGIN_NAMESPACE(vgl)
+
+class LogicalDevice;
+class PhysicalDevice;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Represents a Vulkan pipeline cache.
+// Pipeline caches allow the results of pipeline compilation to be reused, both within the same run and across runs of the application.
+//
+// For reuse across runs, the cache contents can be retrieved with 'getData' and then saved somewhere like a file; that data can then be
+// used to initialize the cache the next time around. The serialized data is wrapped in a header identifying the device and driver that
+// it was created with, and is discarded on initialization if it does not match the current device and driver.
+//------------------------------------------------------------------------------------------------------------------------------------------
+class PipelineCache {
+public:
+    PipelineCache() noexcept;
+    PipelineCache(PipelineCache&& other) noexcept;
+    ~PipelineCache() noexcept;
+
+    bool init(LogicalDevice& device, const std::byte* const pInitialData = nullptr, const size_t initialDataSize = 0) noexcept;
+    void destroy(const bool bForceIfInvalid = false) noexcept;
+    bool getData(std::vector<std::byte>& dataOut) const noexcept;
+
+    static bool isDataCompatible(const PhysicalDevice& physicalDevice, const std::byte* const pData, const size_t dataSize) noexcept;
+
+    inline bool isValid() const noexcept { return mbIsValid; }
+    inline bool wasInitializedFromData() const noexcept { return mbWasInitializedFromData; }
+    inline LogicalDevice* getDevice() const noexcept { return mpDevice; }
+    inline VkPipelineCache getVkPipelineCache() const noexcept { return mVkPipelineCache; }
+
+private:
+    // Copy and move assign are disallowed
+    PipelineCache(const PipelineCache& other) = delete;
+    PipelineCache& operator = (const PipelineCache& other) = delete;
+    PipelineCache& operator = (PipelineCache&& other) = delete;
+
+    bool                mbIsValid;
+    bool                mbWasInitializedFromData;   // True if the cache was initialized with previously saved (and compatible) data
+    LogicalDevice*      mpDevice;
+    VkPipelineCache     mVkPipelineCache;
+};
+
+END_NAMESPACE(vgl)
@@ -0,0 +1,147 @@
+#include "QueryPool.h"
+
+#include "Finally.h"
+#include "LogicalDevice.h"
+#include "VkFuncs.h"
+
+BEGIN_NAMESPACE(vgl)
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Creates an uninitialized query pool
+//------------------------------------------------------------------------------------------------------------------------------------------
+QueryPool::QueryPool() noexcept
+    : mbIsValid(false)
+    , mQueryType(VK_QUERY_TYPE_TIMESTAMP)
+    , mNumQueries(0)
+    , mpDevice(nullptr)
+    , mVkQueryPool(VK_NULL_HANDLE)
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Move constructor: relocate a query pool to this object
+//------------------------------------------------------------------------------------------------------------------------------------------
+QueryPool::QueryPool(QueryPool&& other) noexcept
+    : mbIsValid(other.mbIsValid)
+    , mQueryType(other.mQueryType)
+    , mNumQueries(other.mNumQueries)
+    , mpDevice(other.mpDevice)
+    , mVkQueryPool(other.mVkQueryPool)
+{
+    other.mbIsValid = false;
+    other.mQueryType = VK_QUERY_TYPE_TIMESTAMP;
+    other.mNumQueries = 0;
+    other.mpDevice = nullptr;
+    other.mVkQueryPool = VK_NULL_HANDLE;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Automatically destroys the query pool
+//------------------------------------------------------------------------------------------------------------------------------------------
+QueryPool::~QueryPool() noexcept {
+    destroy();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Initializes the query pool with the specified number of queries of the given type.
+// Note: pipeline statistics queries are not supported by this wrapper, since they need extra creation parameters.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool QueryPool::init(LogicalDevice& device, const VkQueryType queryType, const uint32_t numQueries) noexcept {
+    // Preconditions
+    ASSERT_LOG((!mbIsValid), "Must call destroy() before re-initializing!");
+    ASSERT(device.getVkDevice());
+    ASSERT(queryType != VK_QUERY_TYPE_PIPELINE_STATISTICS);
+    ASSERT(numQueries > 0);
+
+    // If anything goes wrong, cleanup on exit - don't half initialize!
+    auto cleanupOnError = finally([&]{
+        if (!mbIsValid) {
+            destroy(true);
+        }
+    });
+
+    // Save for future reference
+    mpDevice = &device;
+
+    // Create the query pool
+    VkQueryPoolCreateInfo createInfo = {};
+    createInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    createInfo.queryType = queryType;
+    createInfo.queryCount = numQueries;
+
+    const VkFuncs& vkFuncs = device.getVkFuncs();
+
+    if (vkFuncs.vkCreateQueryPool(device.getVkDevice(), &createInfo, nullptr, &mVkQueryPool) != VK_SUCCESS) {
+        ASSERT_FAIL("Failed to create a Vulkan query pool!");
+        return false;
+    }
+
+    // Success!
+    mQueryType = queryType;
+    mNumQueries = numQueries;
+    mbIsValid = true;
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Destroys the query pool and releases its resources.
+// Note: the caller is responsible for ensuring the GPU is no longer using the pool.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void QueryPool::destroy(const bool bForceIfInvalid) noexcept {
+    // Only destroy if we need to
+    if ((!mbIsValid) && (!bForceIfInvalid))
+        return;
+
+    // Preconditions
+    ASSERT_LOG((!mpDevice) || mpDevice->getVkDevice(), "Parent device must still be valid if defined!");
+
+    // Cleanup and destroy the Vulkan query pool
+    mbIsValid = false;
+
+    if (mVkQueryPool) {
+        ASSERT(mpDevice && mpDevice->getVkDevice());
+        const VkFuncs& vkFuncs = mpDevice->getVkFuncs();
+        vkFuncs.vkDestroyQueryPool(mpDevice->getVkDevice(), mVkQueryPool, nullptr);
+        mVkQueryPool = VK_NULL_HANDLE;
+    }
+
+    mQueryType = VK_QUERY_TYPE_TIMESTAMP;
+    mNumQueries = 0;
+    mpDevice = nullptr;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Retrieves the 64-bit results for a range of queries in the pool and returns 'true' if they were all available.
+// If 'bWait' is set then the call blocks until the results are available, otherwise 'false' is returned if any are not yet ready.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool QueryPool::getResults(
+    const uint32_t firstQuery,
+    const uint32_t numQueries,
+    uint64_t* const pResultsOut,
+    const bool bWait
+) const noexcept {
+    ASSERT(mbIsValid);
+    ASSERT(firstQuery + numQueries <= mNumQueries);
+    ASSERT(pResultsOut || (numQueries == 0));
+
+    if (numQueries == 0)
+        return true;
+
+    const VkFuncs& vkFuncs = mpDevice->getVkFuncs();
+    const VkQueryResultFlags resultFlags = VK_QUERY_RESULT_64_BIT | ((bWait) ? VK_QUERY_RESULT_WAIT_BIT : 0);
+
+    const VkResult result = vkFuncs.vkGetQueryPoolResults(
+        mpDevice->getVkDevice(),
+        mVkQueryPool,
+        firstQuery,
+        numQueries,
+        sizeof(uint64_t) * numQueries,
+        pResultsOut,
+        sizeof(uint64_t),
+        resultFlags
+    );
+
+    return (result == VK_SUCCESS);
+}
+
+END_NAMESPACE(vgl)
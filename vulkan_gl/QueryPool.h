@@ -0,0 +1,47 @@
+#pragma once
+
+#include "Macros.h"
+
+#include <vulkan/vulkan.h>
+
+BEGIN_NAMESPACE(vgl)
+
+class LogicalDevice;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Represents a Vulkan query pool: a fixed size set of queries which the GPU writes results to during command buffer execution.
+// Currently used for GPU timestamps; results are 64-bit values which are read back by the host once the GPU has finished with them.
+//
+// Note: queries must be reset (via the command buffer recorder) before each use, and the pool must not be destroyed while GPU commands
+// which reference it are still executing.
+//------------------------------------------------------------------------------------------------------------------------------------------
+class QueryPool {
+public:
+    QueryPool() noexcept;
+    QueryPool(QueryPool&& other) noexcept;
+    ~QueryPool() noexcept;
+
+    bool init(LogicalDevice& device, const VkQueryType queryType, const uint32_t numQueries) noexcept;
+    void destroy(const bool bForceIfInvalid = false) noexcept;
+    bool getResults(const uint32_t firstQuery, const uint32_t numQueries, uint64_t* const pResultsOut, const bool bWait) const noexcept;
+
+    inline bool isValid() const noexcept { return mbIsValid; }
+    inline VkQueryType getQueryType() const noexcept { return mQueryType; }
+    inline uint32_t getNumQueries() const noexcept { return mNumQueries; }
+    inline LogicalDevice* getDevice() const noexcept { return mpDevice; }
+    inline VkQueryPool getVkQueryPool() const noexcept { return mVkQueryPool; }
+
+private:
+    // Copy and move assign are disallowed
+    QueryPool(const QueryPool& other) = delete;
+    QueryPool& operator = (const QueryPool& other) = delete;
+    QueryPool& operator = (QueryPool&& other) = delete;
+
+    bool            mbIsValid;
+    VkQueryType     mQueryType;
+    uint32_t        mNumQueries;
+    LogicalDevice*  mpDevice;
+    VkQueryPool     mVkQueryPool;
+};
+
+END_NAMESPACE(vgl)
@@ -29,6 +29,7 @@ RetirementMgr::RetirementMgr() noexcept
     , mpDevice(nullptr)
     , mpRingbufferMgr(nullptr)
     , mRetiredResourceSets()
+    , mTimelineRetiredResourceSets()
     , mExternalRetirementProviders()
 {
 }
@@ -80,6 +81,13 @@ void RetirementMgr::destroy(const bool bForceIfInvalid) noexcept {
         set.compact();
     }
 
+    for (TimelineRetiredResourceSet& timelineSet : mTimelineRetiredResourceSets) {
+        timelineSet.set.clear();
+    }
+
+    mTimelineRetiredResourceSets.clear();
+    mTimelineRetiredResourceSets.shrink_to_fit();
+
     #if ASSERTS_ENABLED == 1
         mbDebugIsDestroyingResources = false;
     #endif
@@ -125,6 +133,12 @@ void RetirementMgr::freeRetiredResourcesForAllRingbufferSlots() noexcept {
         set.clear();
     }
 
+    for (TimelineRetiredResourceSet& timelineSet : mTimelineRetiredResourceSets) {
+        timelineSet.set.clear();
+    }
+
+    mTimelineRetiredResourceSets.clear();
+
     #if ASSERTS_ENABLED == 1
         mbDebugIsDestroyingResources = false;
     #endif
@@ -153,9 +167,58 @@ void RetirementMgr::freeRetiredResourcesForRingbufferIndex(const uint8_t ringbuf
     #endif
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Free retired resources for all frames that the GPU has finished with, according to the ringbuffer manager's frame timeline.
+// Does nothing if there is no frame timeline, in which case resources are only freed per ringbuffer slot.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void RetirementMgr::freeRetiredResourcesForCompletedFrames() noexcept {
+    if ((!mbIsValid) || (!mpRingbufferMgr->hasFrameTimeline()))
+        return;
+
+    const uint64_t completedFrameTimelineValue = mpRingbufferMgr->getCompletedFrameTimelineValue();
+
+    #if ASSERTS_ENABLED == 1
+        mbDebugIsDestroyingResources = true;
+    #endif
+
+    while ((!mTimelineRetiredResourceSets.empty()) &&
+        (mTimelineRetiredResourceSets.front().frameTimelineValue <= completedFrameTimelineValue)
+    ) {
+        mTimelineRetiredResourceSets.front().set.clear();
+        mTimelineRetiredResourceSets.pop_front();
+    }
+
+    #if ASSERTS_ENABLED == 1
+        mbDebugIsDestroyingResources = false;
+    #endif
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Free retired resources for all frames when using the frame timeline, regardless of whether the GPU has finished with them.
+// Note that you should only call this if you know that all rendering operations have finished!
+//------------------------------------------------------------------------------------------------------------------------------------------
+void RetirementMgr::freeRetiredResourcesForAllFrames() noexcept {
+    if (!mbIsValid)
+        return;
+
+    #if ASSERTS_ENABLED == 1
+        mbDebugIsDestroyingResources = true;
+    #endif
+
+    for (TimelineRetiredResourceSet& timelineSet : mTimelineRetiredResourceSets) {
+        timelineSet.set.clear();
+    }
+
+    mTimelineRetiredResourceSets.clear();
+
+    #if ASSERTS_ENABLED == 1
+        mbDebugIsDestroyingResources = false;
+    #endif
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Retire resources of different types. The retired resources are placed in the retired resource list
-// for the current ringbuffer index defined by the ringbuffer manager.
+// for the current ringbuffer index defined by the ringbuffer manager, or for the current frame if using the frame timeline.
 //
 // Important:
 //      Retire is DISALLOWED while 'destroyAllResources' or 'destroyResourcesForRingbufferIndex' is being called!
@@ -299,9 +362,21 @@ void RetirementMgr::RetiredResourceSet::retireResourceToSet<DescriptorSet>(Descr
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Get the current retired resource set
+// Get the current retired resource set.
+// If using the frame timeline then this is the set for the current frame's timeline value, which is created if it doesn't exist yet.
 //------------------------------------------------------------------------------------------------------------------------------------------
 RetirementMgr::RetiredResourceSet& RetirementMgr::getCurrentRetiredResourceSet() noexcept {
+    if (mpRingbufferMgr->hasFrameTimeline()) {
+        const uint64_t frameTimelineValue = mpRingbufferMgr->getFrameTimelineValue();
+
+        if (mTimelineRetiredResourceSets.empty() || (mTimelineRetiredResourceSets.back().frameTimelineValue != frameTimelineValue)) {
+            TimelineRetiredResourceSet& timelineSet = mTimelineRetiredResourceSets.emplace_back();
+            timelineSet.frameTimelineValue = frameTimelineValue;
+        }
+
+        return mTimelineRetiredResourceSets.back().set;
+    }
+
     const uint8_t ringbufferIdx = mpRingbufferMgr->getBufferIndex();
     return mRetiredResourceSets[ringbufferIdx];
 }
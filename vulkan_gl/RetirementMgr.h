@@ -3,6 +3,7 @@
 #include "Asserts.h"
 #include "Defines.h"
 
+#include <deque>
 #include <set>
 #include <vector>
 
@@ -29,6 +30,9 @@ class Texture;
 //
 // Because resources may be used in a frame that is still rendering, we can't immediately delete them. Instead we transfer ownership to
 // the retirement manager and allow it to clean them up, but only after the frames which are potentially using the resources have completed.
+//
+// If the ringbuffer manager has a frame timeline semaphore then resources are tagged with the timeline value of the frame they were retired
+// in, and freed as soon as the GPU reaches that value. Otherwise they are freed when the ringbuffer slot they were retired in is next used.
 //------------------------------------------------------------------------------------------------------------------------------------------
 class RetirementMgr {
 public:
@@ -41,6 +45,8 @@ public:
     void unregisterRetirementProvider(IRetirementProvider& provider) noexcept;
     void freeRetiredResourcesForAllRingbufferSlots() noexcept;
     void freeRetiredResourcesForRingbufferIndex(const uint8_t ringbufferIndex) noexcept;
+    void freeRetiredResourcesForCompletedFrames() noexcept;
+    void freeRetiredResourcesForAllFrames() noexcept;
 
     void retire(CmdBuffer& cmdBuffer) noexcept;
     void retire(DescriptorPool& descriptorPool) noexcept;
@@ -93,6 +99,12 @@ private:
         void retireResourceToSet(ResourceType& resource) noexcept;
     };
 
+    // Holds a list of retired resources to be freed once the frame timeline reaches a particular value
+    struct TimelineRetiredResourceSet {
+        uint64_t            frameTimelineValue;
+        RetiredResourceSet  set;
+    };
+
     RetiredResourceSet& getCurrentRetiredResourceSet() noexcept;
 
     bool mbIsValid;
@@ -104,10 +116,11 @@ private:
         bool mbDebugIsDestroyingResources;
     #endif
 
-    LogicalDevice*                  mpDevice;
-    RingbufferMgr*                  mpRingbufferMgr;
-    RetiredResourceSet              mRetiredResourceSets[Defines::RINGBUFFER_SIZE];
-    std::set<IRetirementProvider*>  mExternalRetirementProviders;
+    LogicalDevice*                          mpDevice;
+    RingbufferMgr*                          mpRingbufferMgr;
+    RetiredResourceSet                      mRetiredResourceSets[Defines::RINGBUFFER_SIZE];
+    std::deque<TimelineRetiredResourceSet>  mTimelineRetiredResourceSets;   // Resources to free once frames complete, ordered by frame timeline value (if using the frame timeline)
+    std::set<IRetirementProvider*>          mExternalRetirementProviders;
 };
 
 //------------------------------------------------------------------------------------------------------------------------------------------
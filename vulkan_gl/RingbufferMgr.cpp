@@ -6,6 +6,8 @@
 #include "RetirementMgr.h"
 #include "TransferMgr.h"
 
+#include <algorithm>
+
 BEGIN_NAMESPACE(vgl)
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -14,8 +16,11 @@ BEGIN_NAMESPACE(vgl)
 RingbufferMgr::RingbufferMgr() noexcept
     : mbIsValid(false)
     , mBufferIndex(0)
+    , mMaxFramesInFlight(Defines::RINGBUFFER_SIZE)
     , mpDevice(nullptr)
     , mFences{}
+    , mFrameTimeline()
+    , mFrameTimelineValue(1)
 {
 }
 
@@ -63,6 +68,15 @@ bool RingbufferMgr::init(LogicalDevice& device) noexcept {
         }
     }
 
+    // Create the frame timeline semaphore if supported.
+    // Its value starts at '0' (no frames complete) and the first frame signals a value of '1' when it completes.
+    if (device.hasTimelineSemaphores()) {
+        if (!mFrameTimeline.init(device, true, 0))
+            return false;
+    }
+
+    mFrameTimelineValue = 1;
+
     // All went well if we got to here!
     mbIsValid = true;
     return true;
@@ -78,6 +92,7 @@ void RingbufferMgr::destroy(const bool bForceIfInvalid) noexcept {
 
     // Cleanup everything
     mbIsValid = false;
+    mFrameTimeline.destroy();
 
     {
         Fence* pCurFence = mFences;
@@ -91,6 +106,17 @@ void RingbufferMgr::destroy(const bool bForceIfInvalid) noexcept {
 
     mpDevice = nullptr;
     mBufferIndex = 0;
+    mMaxFramesInFlight = Defines::RINGBUFFER_SIZE;
+    mFrameTimelineValue = 1;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Sets the maximum number of frames that may be in flight (being recorded or processed by the GPU) at once, including the current frame.
+// By default this is the ringbuffer size, allowing maximum CPU/GPU parallelism. Lowering it reduces latency between the CPU preparing
+// a frame and that frame being displayed, at the cost of less parallelism. The value is clamped between 1 and the ringbuffer size.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void RingbufferMgr::setMaxFramesInFlight(const uint8_t maxFramesInFlight) noexcept {
+    mMaxFramesInFlight = std::clamp<uint8_t>(maxFramesInFlight, 1, Defines::RINGBUFFER_SIZE);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -102,6 +128,15 @@ Fence& RingbufferMgr::getCurrentBufferFence() noexcept {
     return mFences[mBufferIndex];
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Get the timeline value of the most recent frame which the GPU has finished processing, according to the frame timeline semaphore.
+// Returns '0' if there is no frame timeline semaphore.
+//------------------------------------------------------------------------------------------------------------------------------------------
+uint64_t RingbufferMgr::getCompletedFrameTimelineValue() const noexcept {
+    ASSERT(mbIsValid);
+    return mFrameTimeline.getTimelineValue();
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Move onto the next ring buffer and return it's index.
 // Acquires the fence for the next ring buffer and waits until it is signalled if neccessary.
@@ -110,6 +145,20 @@ Fence& RingbufferMgr::getCurrentBufferFence() noexcept {
 uint8_t RingbufferMgr::acquireNextBuffer() noexcept {
     ASSERT(mbIsValid);
 
+    // Free any retired resources for frames the GPU has already finished with, if tracking this via the frame timeline
+    RetirementMgr& retirementMgr = mpDevice->getRetirementMgr();
+
+    if (hasFrameTimeline() && retirementMgr.isValid()) {
+        retirementMgr.freeRetiredResourcesForCompletedFrames();
+    }
+
+    // If the number of frames in flight is being limited then also wait for the most recently submitted frames to finish.
+    // Note: the fences for these slots are always in use since the renderer submits work for the current slot before calling this.
+    for (uint8_t numWaits = Defines::RINGBUFFER_SIZE - mMaxFramesInFlight; numWaits > 0; --numWaits) {
+        const uint8_t bufferIdx = (mBufferIndex + Defines::RINGBUFFER_SIZE + 1 - numWaits) % Defines::RINGBUFFER_SIZE;
+        mFences[bufferIdx].waitUntilSignalled();
+    }
+
     // Wait for the fence for the next buffer to become signalled
     const uint8_t nextBufferIdx = (mBufferIndex + 1) % Defines::RINGBUFFER_SIZE;
     Fence& nextRingbufferFence = mFences[nextBufferIdx];
@@ -122,8 +171,9 @@ uint8_t RingbufferMgr::acquireNextBuffer() noexcept {
     // It will be signalled again once all operations have completed for this ringbuffer slot:
     nextRingbufferFence.resetSignal();
 
-    // Move onto the next ringbuffer slot
+    // Move onto the next ringbuffer slot and frame timeline value
     mBufferIndex = nextBufferIdx;
+    mFrameTimelineValue++;
     return nextBufferIdx;
 }
 
@@ -138,6 +188,47 @@ void RingbufferMgr::doCleanupForAllBufferSlots() noexcept {
     for (uint8_t bufferIdx = 0; bufferIdx < Defines::RINGBUFFER_SIZE; ++bufferIdx) {
         doCleanupForBufferIndex(bufferIdx);
     }
+
+    // Also free all retired resources tracked via the frame timeline
+    RetirementMgr& retirementMgr = mpDevice->getRetirementMgr();
+
+    if (hasFrameTimeline() && retirementMgr.isValid()) {
+        retirementMgr.freeRetiredResourcesForAllFrames();
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Does cleanup for all ringbuffer slots other than the current one, but only if the GPU has finished processing the slot.
+// This allows retired resources to be released ahead of when the slot is next acquired, which is useful when memory is running low.
+// If 'bWaitForCompletion' is set then the call waits for the GPU to finish processing each slot, so that all of them can be cleaned up.
+//
+// Note: the slots other than the current one are always either finished or have work submitted which will signal their fences, since
+// the renderer submits work for the current slot before moving onto the next one.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void RingbufferMgr::doCleanupForCompletedBufferSlots(const bool bWaitForCompletion) noexcept {
+    ASSERT(mbIsValid);
+
+    for (uint8_t bufferIdx = 0; bufferIdx < Defines::RINGBUFFER_SIZE; ++bufferIdx) {
+        if (bufferIdx == mBufferIndex)
+            continue;
+
+        Fence& fence = mFences[bufferIdx];
+
+        if (bWaitForCompletion) {
+            fence.waitUntilSignalled();
+        }
+
+        if (fence.isSignalled()) {
+            doCleanupForBufferIndex(bufferIdx);
+        }
+    }
+
+    // Also free retired resources for all completed frames, if tracking this via the frame timeline
+    RetirementMgr& retirementMgr = mpDevice->getRetirementMgr();
+
+    if (hasFrameTimeline() && retirementMgr.isValid()) {
+        retirementMgr.freeRetiredResourcesForCompletedFrames();
+    }
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
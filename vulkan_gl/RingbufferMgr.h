@@ -3,6 +3,7 @@
 #include "Asserts.h"
 #include "Defines.h"
 #include "Fence.h"
+#include "Semaphore.h"
 
 BEGIN_NAMESPACE(vgl)
 
@@ -17,6 +18,10 @@ class LogicalDevice;
 // This manager also holds fences that are used to signal the end each ringbuffer use, which should be triggered by the renderer once
 // it has completed it's rendering operations for the frame.
 //
+// If the device supports timeline semaphores then the manager also holds a 'frame timeline' semaphore. Each frame is assigned an
+// increasing timeline value, which is signalled along with the ringbuffer slot fence when the work for the frame completes. This allows
+// things like retired resources to be released as soon as the frame they were last used in completes.
+//
 // Note that a ringbuffer doesn't exist as one discrete thing per say, instead it is a series of resources scattered about the application
 // that are stored in arrays of the same length as the ring buffer. Each slot in these various resource arrays corresponds to one slot in
 // the ringbuffer. Example of things that are ring buffered include the main view depth buffers, per frame uniform and vertex buffers,
@@ -39,9 +44,21 @@ public:
         return mBufferIndex;
     }
 
+    // Gets the maximum number of frames that may be queued up for processing by the GPU
+    inline uint8_t getMaxFramesInFlight() const noexcept { return mMaxFramesInFlight; }
+
+    // Frame timeline related queries: whether there is a frame timeline semaphore, the semaphore itself and the value that will be
+    // signalled on the frame timeline when the current frame's work completes.
+    inline bool hasFrameTimeline() const noexcept { return mFrameTimeline.isValid(); }
+    inline const Semaphore& getFrameTimeline() const noexcept { return mFrameTimeline; }
+    inline uint64_t getFrameTimelineValue() const noexcept { return mFrameTimelineValue; }
+
+    void setMaxFramesInFlight(const uint8_t maxFramesInFlight) noexcept;
     Fence& getCurrentBufferFence() noexcept;
+    uint64_t getCompletedFrameTimelineValue() const noexcept;
     uint8_t acquireNextBuffer() noexcept;
     void doCleanupForAllBufferSlots() noexcept;
+    void doCleanupForCompletedBufferSlots(const bool bWaitForCompletion) noexcept;
 
 private:
     // Copy and move are disallowed
@@ -54,8 +71,11 @@ private:
 
     bool            mbIsValid;
     uint8_t         mBufferIndex;                           // Which ringbuffer we are currently on
+    uint8_t         mMaxFramesInFlight;                     // Max number of frames the GPU can be working on (between 1 and the ringbuffer size)
     LogicalDevice*  mpDevice;
     Fence           mFences[Defines::RINGBUFFER_SIZE];      // Fences used to signal the end of rendering for each ringbuffer
+    Semaphore       mFrameTimeline;                         // Timeline semaphore signalled with the frame's timeline value at the end of rendering (if supported)
+    uint64_t        mFrameTimelineValue;                    // Timeline value for the current frame: signalled once the frame's work completes
 };
 
 END_NAMESPACE(vgl)
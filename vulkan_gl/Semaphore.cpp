@@ -11,6 +11,7 @@ BEGIN_NAMESPACE(vgl)
 //------------------------------------------------------------------------------------------------------------------------------------------
 Semaphore::Semaphore() noexcept
     : mbIsValid(false)
+    , mbIsTimeline(false)
     , mpDevice(nullptr)
     , mVkSemaphore(VK_NULL_HANDLE)
 {
@@ -21,10 +22,12 @@ Semaphore::Semaphore() noexcept
 //------------------------------------------------------------------------------------------------------------------------------------------
 Semaphore::Semaphore(Semaphore&& other) noexcept
     : mbIsValid(other.mbIsValid)
+    , mbIsTimeline(other.mbIsTimeline)
     , mpDevice(other.mpDevice)
     , mVkSemaphore(other.mVkSemaphore)
 {
     other.mbIsValid = false;
+    other.mbIsTimeline = false;
     other.mpDevice = nullptr;
     other.mVkSemaphore = VK_NULL_HANDLE;
 }
@@ -37,12 +40,14 @@ Semaphore::~Semaphore() noexcept {
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Attempts to initialize the semaphore and returns 'true' if successful
+// Attempts to initialize the semaphore and returns 'true' if successful.
+// If 'bIsTimeline' is set then a timeline semaphore is created with the given initial value; the device must support timeline semaphores.
 //------------------------------------------------------------------------------------------------------------------------------------------
-bool Semaphore::init(LogicalDevice& device) noexcept {
+bool Semaphore::init(LogicalDevice& device, const bool bIsTimeline, const uint64_t initialTimelineValue) noexcept {
     // Preconditions
     ASSERT_LOG((!mbIsValid), "Must call destroy() before re-initializing!");
     ASSERT(device.getVkDevice());
+    ASSERT((!bIsTimeline) || device.hasTimelineSemaphores());
 
     // If anything goes wrong, cleanup on exit - don't half initialize!
     auto cleanupOnError = finally([&]{
@@ -60,12 +65,22 @@ bool Semaphore::init(LogicalDevice& device) noexcept {
     VkSemaphoreCreateInfo createInfo = {};
     createInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
 
+    VkSemaphoreTypeCreateInfoKHR typeCreateInfo = {};
+    typeCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO_KHR;
+    typeCreateInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE_KHR;
+    typeCreateInfo.initialValue = initialTimelineValue;
+
+    if (bIsTimeline) {
+        createInfo.pNext = &typeCreateInfo;
+    }
+
     if (vkFuncs.vkCreateSemaphore(device.getVkDevice(), &createInfo, nullptr, &mVkSemaphore) != VK_SUCCESS) {
         ASSERT_FAIL("Failed to create a Vulkan semaphore!");
         return false;
     }
 
     // Success!
+    mbIsTimeline = bIsTimeline;
     mbIsValid = true;
     return true;
 }
@@ -91,7 +106,28 @@ void Semaphore::destroy(const bool bForceIfInvalid) noexcept {
         mVkSemaphore = VK_NULL_HANDLE;
     }
 
+    mbIsTimeline = false;
     mpDevice = nullptr;
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Get the latest counter value reached by a timeline semaphore.
+// Returns '0' if the semaphore is not valid or is not a timeline semaphore, or if the query fails.
+//------------------------------------------------------------------------------------------------------------------------------------------
+uint64_t Semaphore::getTimelineValue() const noexcept {
+    if ((!mbIsValid) || (!mbIsTimeline))
+        return 0;
+
+    const VkFuncs& vkFuncs = mpDevice->getVkFuncs();
+    ASSERT(vkFuncs.vkGetSemaphoreCounterValueKHR);
+    uint64_t value = 0;
+
+    if (vkFuncs.vkGetSemaphoreCounterValueKHR(mpDevice->getVkDevice(), mVkSemaphore, &value) != VK_SUCCESS) {
+        ASSERT_FAIL("Failed to query the value of a Vulkan timeline semaphore!");
+        return 0;
+    }
+
+    return value;
+}
+
 END_NAMESPACE(vgl)
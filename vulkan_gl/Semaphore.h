@@ -12,6 +12,9 @@ class LogicalDevice;
 // Represents a vulkan semaphore used for synchronization between device calls.
 // The user cannot directly signal or block on a semaphore, instead it is done through the various API calls.
 // It used for GPU -> GPU synchronization, as opposed to a Fence which is for GPU -> CPU synchronization.
+//
+// Optionally the semaphore can be a timeline semaphore (requires 'VK_KHR_timeline_semaphore'), which has a 64-bit counter that only ever
+// increases. Submissions can signal the counter with specific values and the host can query the latest value reached by the GPU.
 //------------------------------------------------------------------------------------------------------------------------------------------
 class Semaphore {
 public:
@@ -19,10 +22,12 @@ public:
     Semaphore(Semaphore&& other) noexcept;
     ~Semaphore() noexcept;
 
-    bool init(LogicalDevice& device) noexcept;
+    bool init(LogicalDevice& device, const bool bIsTimeline = false, const uint64_t initialTimelineValue = 0) noexcept;
     void destroy(const bool bForceIfInvalid = false) noexcept;
+    uint64_t getTimelineValue() const noexcept;
 
     inline bool isValid() const noexcept { return mbIsValid; }
+    inline bool isTimeline() const noexcept { return mbIsTimeline; }
     inline LogicalDevice* getDevice() const noexcept { return mpDevice; }
     inline VkSemaphore getVkSemaphore() const noexcept { return mVkSemaphore; }
 
@@ -33,6 +38,7 @@ private:
     Semaphore& operator = (Semaphore&& other) = delete;
 
     bool            mbIsValid;
+    bool            mbIsTimeline;
     LogicalDevice*  mpDevice;
     VkSemaphore     mVkSemaphore;
 };
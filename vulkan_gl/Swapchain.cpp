@@ -3,6 +3,8 @@
 #include "DeviceSurfaceCaps.h"
 #include "Finally.h"
 #include "LogicalDevice.h"
+#include "RetirementMgr.h"
+#include "RingbufferMgr.h"
 #include "Semaphore.h"
 #include "Utils.h"
 #include "VkFuncs.h"
@@ -19,6 +21,7 @@ BEGIN_NAMESPACE(vgl)
 Swapchain::Swapchain() noexcept
     : mbIsValid(false)
     , mbNeedsRecreate(false)
+    , mbIsOffscreen(false)
     , mAcquiredImageIdx(INVALID_IMAGE_IDX)
     , mpDevice(nullptr)
     , mSurfaceFormat()
@@ -29,6 +32,10 @@ Swapchain::Swapchain() noexcept
     , mVkSwapchain(VK_NULL_HANDLE)
     , mVkImages()
     , mVkImageViews()
+    , mVkOldSwapchain(VK_NULL_HANDLE)
+    , mRetiredSwapchains()
+    , mOffscreenImages()
+    , mNextOffscreenImageIdx(0)
 {
 }
 
@@ -69,8 +76,10 @@ bool Swapchain::init(
     if (SDL_GetWindowFlags(winSurface.getSdlWindow()) & SDL_WINDOW_MINIMIZED)
         return false;
 
-    // Firstly query the device surface capabilities
+    // Firstly query the device surface capabilities.
+    // Also register with the retirement manager so that old swapchains can be destroyed after recreation.
     mpDevice = &device;
+    device.getRetirementMgr().registerRetirementProvider(*this);
 
     if (!mDeviceSurfaceCaps.query(*device.getPhysicalDevice(), winSurface)) {
         ASSERT_FAIL("Failed to query device surface capabilities!");
@@ -110,6 +119,100 @@ bool Swapchain::init(
     return true;
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Initializes the swapchain in offscreen mode, where there is no window surface to present to.
+// The given number of render textures are created to take the place of swapchain images and are cycled through in order when acquiring.
+// Returns 'true' if successful.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool Swapchain::initOffscreen(
+    LogicalDevice& device,
+    const VkFormat format,
+    const uint32_t width,
+    const uint32_t height,
+    const uint32_t length
+) noexcept {
+    // Preconditions
+    ASSERT_LOG((!mbIsValid), "Must call destroy() before re-initializing!");
+    ASSERT(device.getVkDevice());
+    ASSERT((width > 0) && (height > 0));
+    ASSERT(length > 0);
+
+    // If anything goes wrong, cleanup on exit - don't half initialize!
+    auto cleanupOnError = finally([&]{
+        if (!mbIsValid) {
+            destroy(true);
+        }
+    });
+
+    // Save basic swapchain details
+    mpDevice = &device;
+    mbIsOffscreen = true;
+    mSurfaceFormat.format = format;
+    mSurfaceFormat.colorSpace = VK_COLOR_SPACE_SRGB_NONLINEAR_KHR;
+    mPresentMode = VK_PRESENT_MODE_IMMEDIATE_KHR;
+    mSwapExtentW = width;
+    mSwapExtentH = height;
+    mLength = length;
+    mNextOffscreenImageIdx = 0;
+
+    // Create the images to render to: these need to be blit and copy destinations like swapchain images, and readable afterwards
+    mOffscreenImages.resize(length);
+    mVkImages.reserve(length);
+    mVkImageViews.reserve(length);
+
+    for (RenderTexture& image : mOffscreenImages) {
+        const VkImageUsageFlags usageFlags = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+
+        if (!image.initAsRenderTexture(device, true, format, usageFlags, width, height, 1)) {
+            ASSERT_FAIL("Failed to create an offscreen swapchain image!");
+            return false;
+        }
+
+        mVkImages.push_back(image.getVkImage());
+        mVkImageViews.push_back(image.getVkImageView());
+    }
+
+    // All went well if we got to here!
+    mbIsValid = true;
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Recreates the swapchain without waiting for the device to become idle, for when the window is resized or the present mode changes.
+// The current swapchain is handed off to the new one (as the 'old swapchain') and is then retired along with its image views.
+// These are destroyed once the ringbuffer slot for the current frame is next used, at which point the GPU is done with them.
+// Returns 'true' if successful; as with 'init' the swapchain may fail validly to be created if the window is minimized or zero sized.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool Swapchain::recreate(const SwapPresentMode wantedPresentMode) noexcept {
+    // Preconditions
+    ASSERT(mbIsValid);
+    ASSERT(mpDevice);
+    ASSERT_LOG((!mbIsOffscreen), "Offscreen swapchains never need recreation!");
+
+    // Retire the current swapchain and its image views
+    LogicalDevice& device = *mpDevice;
+    const VkSurfaceFormatKHR surfaceFormat = mSurfaceFormat;
+
+    RetiredSwapchain& retiredSwapchain = mRetiredSwapchains.emplace_back();
+    retiredSwapchain.vkSwapchain = mVkSwapchain;
+    retiredSwapchain.vkImageViews = std::move(mVkImageViews);
+    retiredSwapchain.ringbufferIdx = device.getRingbufferMgr().getBufferIndex();
+
+    mVkOldSwapchain = mVkSwapchain;
+    mVkSwapchain = VK_NULL_HANDLE;
+    mVkImageViews.clear();
+    mVkImages.clear();
+    mbIsValid = false;
+    mbNeedsRecreate = false;
+    mAcquiredImageIdx = INVALID_IMAGE_IDX;
+
+    // Create the new swapchain, handing off from the old one.
+    // Note: the old swapchain is considered 'retired' by Vulkan at this point whether creation succeeds or not.
+    const bool bCreatedSwapchain = init(device, surfaceFormat.format, surfaceFormat.colorSpace, wantedPresentMode);
+    mVkOldSwapchain = VK_NULL_HANDLE;
+    return bCreatedSwapchain;
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Destroys the swapchain and releases its resources
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -121,9 +224,31 @@ void Swapchain::destroy(const bool bForceIfInvalid) noexcept {
     // Preconditions
     ASSERT_LOG(((!mpDevice) || mpDevice->getVkDevice()), "Parent device must still be valid if defined!");
 
+    // Destroy any retired swapchains first, waiting for the GPU to finish with them (this should be rare).
+    // After that unregister from the retirement manager since there is nothing more to retire.
+    if (mpDevice) {
+        if (!mRetiredSwapchains.empty()) {
+            mpDevice->waitUntilDeviceIdle();
+            freeRetiredResourcesForAllRingbufferSlots();
+        }
+
+        mpDevice->getRetirementMgr().unregisterRetirementProvider(*this);
+    }
+
     // Destroy the swapchain
     mbIsValid = false;
 
+    // Offscreen mode: the images and views are owned by the offscreen images, so just destroy those.
+    // Note: the caller must ensure the GPU is done with them before destroying.
+    if (mbIsOffscreen) {
+        for (RenderTexture& image : mOffscreenImages) {
+            image.destroy(true);
+        }
+
+        mOffscreenImages.clear();
+        mVkImageViews.clear();
+    }
+
     for (const VkImageView imageView : mVkImageViews) {
         // Note: need to null check because if image view setup fails we could one or null image views in the list
         if (imageView) {
@@ -151,6 +276,8 @@ void Swapchain::destroy(const bool bForceIfInvalid) noexcept {
     mDeviceSurfaceCaps = {};
     mpDevice = nullptr;
     mAcquiredImageIdx = INVALID_IMAGE_IDX;
+    mNextOffscreenImageIdx = 0;
+    mbIsOffscreen = false;
     mbNeedsRecreate = false;
 }
 
@@ -174,6 +301,12 @@ bool Swapchain::presentAcquiredImage(const Semaphore& renderFinishedSemaphore) n
     ASSERT(mAcquiredImageIdx < mLength);
     ASSERT(renderFinishedSemaphore.isValid());
 
+    // Offscreen mode: there is nothing to present to
+    if (mbIsOffscreen) {
+        mAcquiredImageIdx = INVALID_IMAGE_IDX;
+        return true;
+    }
+
     // Do the present!
     const VkSemaphore waitSemaphores[] = { renderFinishedSemaphore.getVkSemaphore() };
     const VkSwapchainKHR swapChains[] = { mVkSwapchain };
@@ -209,6 +342,33 @@ bool Swapchain::presentAcquiredImage(const Semaphore& renderFinishedSemaphore) n
     return false;
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Destroys all retired swapchains, regardless of ringbuffer slot.
+// Note that this should only be called if it's known that the GPU is finished with them!
+//------------------------------------------------------------------------------------------------------------------------------------------
+void Swapchain::freeRetiredResourcesForAllRingbufferSlots() noexcept {
+    for (const RetiredSwapchain& retiredSwapchain : mRetiredSwapchains) {
+        destroyRetiredSwapchain(retiredSwapchain.vkSwapchain, retiredSwapchain.vkImageViews);
+    }
+
+    mRetiredSwapchains.clear();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Destroys any swapchains that were retired while the specified ringbuffer slot was in use.
+// Called by the retirement manager once the GPU has finished with that slot.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void Swapchain::freeRetiredResourcesForRingbufferIndex(const uint8_t ringbufferIndex) noexcept {
+    for (auto iter = mRetiredSwapchains.begin(); iter != mRetiredSwapchains.end();) {
+        if (iter->ringbufferIdx == ringbufferIndex) {
+            destroyRetiredSwapchain(iter->vkSwapchain, iter->vkImageViews);
+            iter = mRetiredSwapchains.erase(iter);
+        } else {
+            ++iter;
+        }
+    }
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Attempts to acquire a swap chain image for later presentation.
 // Returns UINT32_MAX on failure, if for example the swap chain needs recreation.
@@ -227,6 +387,14 @@ uint32_t Swapchain::acquireImage(Semaphore& imageReadySemaphore) noexcept {
     if (mbNeedsRecreate)
         return INVALID_IMAGE_IDX;
 
+    // Offscreen mode: just use the next image in the cycle, it's always available.
+    // Note: the semaphore is NOT signalled in this case, since there is no presentation engine to wait on.
+    if (mbIsOffscreen) {
+        mAcquiredImageIdx = mNextOffscreenImageIdx;
+        mNextOffscreenImageIdx = (mNextOffscreenImageIdx + 1) % mLength;
+        return mAcquiredImageIdx;
+    }
+
     // Try to accquire an image from the swap chain and wait for as long as required.
     // Note that upon acquiring it may still not be ready to use as it may be in the process of being presented.
     // Therefore the app should wait on the 'imageReadySemaphore' synchronization primitive.
@@ -252,6 +420,25 @@ uint32_t Swapchain::acquireImage(Semaphore& imageReadySemaphore) noexcept {
     }
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Destroys the given retired swapchain and its image views
+//------------------------------------------------------------------------------------------------------------------------------------------
+void Swapchain::destroyRetiredSwapchain(const VkSwapchainKHR vkSwapchain, const std::vector<VkImageView>& vkImageViews) noexcept {
+    ASSERT(mpDevice && mpDevice->getVkDevice());
+    const VkFuncs& vkFuncs = mpDevice->getVkFuncs();
+    const VkDevice vkDevice = mpDevice->getVkDevice();
+
+    for (const VkImageView imageView : vkImageViews) {
+        if (imageView) {
+            vkFuncs.vkDestroyImageView(vkDevice, imageView, nullptr);
+        }
+    }
+
+    if (vkSwapchain) {
+        vkFuncs.vkDestroySwapchainKHR(vkDevice, vkSwapchain, nullptr);
+    }
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Chooses a presentation mode for the swap chain
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -268,9 +455,11 @@ void Swapchain::choosePresentMode(const SwapPresentMode wantedPresentMode) noexc
         }
     }
 
-    // Prefer VK_PRESENT_MODE_MAILBOX_KHR if available when we want to do triple buffering. Whenever we submit new images
-    // to the queue in this mode and the queue is full then the current image in waiting will simply be replaced...
-    if ((wantedPresentMode == SwapPresentMode::TripleBuffer) && (mLength >= 3)) {
+    // Prefer VK_PRESENT_MODE_MAILBOX_KHR if available when we want to do triple buffering or low latency presentation. Whenever we submit
+    // new images to the queue in this mode and the queue is full then the current image in waiting will simply be replaced...
+    const bool bWantMailbox = ((wantedPresentMode == SwapPresentMode::TripleBuffer) || (wantedPresentMode == SwapPresentMode::LowLatency));
+
+    if (bWantMailbox && (mLength >= 3)) {
         if (Utils::containerContains(vkPresentModes, VK_PRESENT_MODE_MAILBOX_KHR)) {
             mPresentMode = VK_PRESENT_MODE_MAILBOX_KHR;
             return;
@@ -341,9 +530,17 @@ bool Swapchain::chooseSwapExtent() noexcept {
 // Choose how many images to use in the swap chain
 //------------------------------------------------------------------------------------------------------------------------------------------
 void Swapchain::chooseSwapchainLength(const SwapPresentMode wantedPresentMode) noexcept {
-    // If we are doing triple buffering ask for 3 images, otherwise 2
+    // If we are doing triple buffering ask for 3 images, otherwise 2.
+    // For low latency presentation 3 images are only requested if mailbox mode is available, since with FIFO presentation the extra image
+    // would just allow another frame to be queued up and increase latency.
     const VkSurfaceCapabilitiesKHR& vkSurfaceCaps = mDeviceSurfaceCaps.getVkSurfaceCapabilities();
-    mLength = (wantedPresentMode == SwapPresentMode::TripleBuffer) ? 3 : 2;
+
+    if (wantedPresentMode == SwapPresentMode::LowLatency) {
+        const std::vector<VkPresentModeKHR>& vkPresentModes = mDeviceSurfaceCaps.getVkPresentModes();
+        mLength = Utils::containerContains(vkPresentModes, VK_PRESENT_MODE_MAILBOX_KHR) ? 3 : 2;
+    } else {
+        mLength = (wantedPresentMode == SwapPresentMode::TripleBuffer) ? 3 : 2;
+    }
 
     if (vkSurfaceCaps.maxImageCount != 0) {
         mLength = std::min(mLength, vkSurfaceCaps.maxImageCount);
@@ -380,7 +577,7 @@ bool Swapchain::createSwapchain() noexcept {
     createInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
     createInfo.presentMode = mPresentMode;
     createInfo.clipped = VK_TRUE;
-    createInfo.oldSwapchain = VK_NULL_HANDLE;
+    createInfo.oldSwapchain = mVkOldSwapchain;
 
     // Specify how the images in the swap chain are shared across different queues.
     // If the present and work queue are the same then use the exclusive mode, which offers better performance.
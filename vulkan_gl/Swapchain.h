@@ -1,6 +1,8 @@
 #pragma once
 
 #include "DeviceSurfaceCaps.h"
+#include "IRetirementProvider.h"
+#include "RenderTexture.h"
 
 #include <vector>
 #include <vulkan/vulkan.h>
@@ -16,20 +18,28 @@ class Semaphore;
 enum SwapPresentMode : uint32_t {
     Immediate,      // Do double buffering but present immediately with no vsync
     DoubleBuffer,   // Do normal double buffering with vsync
-    TripleBuffer    // Do triple buffering with vsync
+    TripleBuffer,   // Do triple buffering with vsync
+    LowLatency      // Vsync with minimal latency: mailbox presentation (if supported) so the newest frame is always shown at vblank
 };
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Represents a Vulkan swapchain.
 // A swapchain describes the surface formats rendered to for the output device, how swaps are performed and so forth...
+//
+// When recreated (due to a window resize for example) the old swapchain is handed off to the new one and then retired, rather than
+// destroyed immediately. The retired swapchain and its image views are destroyed once the frames which might be using them are done.
+//
+// A swapchain can also be created in 'offscreen' mode, for rendering without a window surface. In this mode the swapchain images are just
+// ordinary render textures which are cycled through in order, and presentation does nothing. The images are left in the layout returned
+// by 'getPresentImageLayout' at the end of each frame, so they can be read back.
 //------------------------------------------------------------------------------------------------------------------------------------------
-class Swapchain {
+class Swapchain : public IRetirementProvider {
 public:
     // Constant for an invalid/non-existant swapchain image index
     static constexpr const uint32_t INVALID_IMAGE_IDX = UINT32_MAX;
 
     Swapchain() noexcept;
-    ~Swapchain() noexcept;
+    virtual ~Swapchain() noexcept override;
 
     bool init(
         LogicalDevice& device,
@@ -38,9 +48,19 @@ public:
         const SwapPresentMode wantedPresentMode
     ) noexcept;
 
+    bool recreate(const SwapPresentMode wantedPresentMode) noexcept;
+    bool initOffscreen(
+        LogicalDevice& device,
+        const VkFormat format,
+        const uint32_t width,
+        const uint32_t height,
+        const uint32_t length
+    ) noexcept;
+
     void destroy(const bool bForceIfInvalid = false) noexcept;
 
     inline bool isValid() const noexcept { return mbIsValid; }
+    inline bool isOffscreen() const noexcept { return mbIsOffscreen; }
     inline bool needsRecreate() const noexcept { return mbNeedsRecreate; }
     inline uint32_t getAcquiredImageIdx() const noexcept { return mAcquiredImageIdx; }
     inline LogicalDevice* getDevice() const noexcept { return mpDevice; }
@@ -53,10 +73,19 @@ public:
     inline const std::vector<VkImage>& getVkImages() const noexcept { return mVkImages; }
     inline const std::vector<VkImageView>& getVkImageViews() const noexcept { return mVkImageViews; }
 
+    // Which layout swapchain images should be transitioned to at the end of a frame: offscreen images are left ready for reading back
+    inline VkImageLayout getPresentImageLayout() const noexcept {
+        return (mbIsOffscreen) ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    }
+
     void setNeedsRecreate() noexcept;
     bool presentAcquiredImage(const Semaphore& renderFinishedSemaphore) noexcept;
     uint32_t acquireImage(Semaphore& imageReadySemaphore) noexcept;
 
+    // IRetirementProvider implementation: destroys retired swapchains
+    virtual void freeRetiredResourcesForAllRingbufferSlots() noexcept override;
+    virtual void freeRetiredResourcesForRingbufferIndex(const uint8_t ringbufferIndex) noexcept override;
+
 private:
     // Copy and move are disallowed
     Swapchain(const Swapchain& other) = delete;
@@ -69,9 +98,18 @@ private:
     void chooseSwapchainLength(const SwapPresentMode wantedPresentMode) noexcept;
     bool createSwapchain() noexcept;
     bool createSwapchainImageViews() noexcept;
+    void destroyRetiredSwapchain(const VkSwapchainKHR vkSwapchain, const std::vector<VkImageView>& vkImageViews) noexcept;
+
+    // An old swapchain that has been replaced and is waiting to be destroyed
+    struct RetiredSwapchain {
+        VkSwapchainKHR              vkSwapchain;        // The old swapchain itself
+        std::vector<VkImageView>    vkImageViews;       // Image views for the old swapchain's images
+        uint8_t                     ringbufferIdx;      // Which ringbuffer slot the swapchain was retired in: it's freed when the slot is next used
+    };
 
     bool                        mbIsValid;              // True if this object was created & initialized successfully
     bool                        mbNeedsRecreate;        // True if the swapchain needs recreation, due to window resizing for instance
+    bool                        mbIsOffscreen;          // True if this is an offscreen swapchain with no window surface
     uint32_t                    mAcquiredImageIdx;      // Currently acquired image index, or INVALID_IMAGE_IDX if not acquired.
     LogicalDevice*              mpDevice;               // The logical Vulkan device this swap chain is for
     DeviceSurfaceCaps           mDeviceSurfaceCaps;     // Capabilities of the device with respect to the window surface
@@ -83,6 +121,10 @@ private:
     VkSwapchainKHR              mVkSwapchain;           // Handle to the actual Vulkan swap chain
     std::vector<VkImage>        mVkImages;              // Handles to the Vulkan images in the swap chain
     std::vector<VkImageView>    mVkImageViews;          // Image views for images in the swap chain
+    VkSwapchainKHR              mVkOldSwapchain;        // The swapchain being replaced during recreation, if any: passed along when creating the new swapchain
+    std::vector<RetiredSwapchain> mRetiredSwapchains;   // Old swapchains waiting to be destroyed once the GPU is done with them
+    std::vector<RenderTexture>  mOffscreenImages;       // Offscreen mode only: the images that are rendered to in place of swapchain images
+    uint32_t                    mNextOffscreenImageIdx; // Offscreen mode only: which image will be 'acquired' next
 };
 
 END_NAMESPACE(vgl)
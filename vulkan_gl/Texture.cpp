@@ -360,6 +360,9 @@ void Texture::unlock(TransferTask* const pTransferTaskOverride) noexcept {
     const bool bLockedWholeImage = ((mLockedSizeX >= mWidth) && (mLockedSizeY >= mHeight) && (mLockedSizeZ >= mDepth));
     const VkImageLayout oldVkImageLayout = (mbDidATextureUpload && (!bLockedWholeImage)) ? VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_UNDEFINED;
 
+    // The first upload to the texture can be done on a dedicated transfer queue (if available), since the GPU has never used the image
+    const bool bCanTransferAsync = (!mbDidATextureUpload);
+
     // Schedule the data transfer for the image and image layout transitions
     TransferTask* pDstTask;
 
@@ -381,7 +384,8 @@ void Texture::unlock(TransferTask* const pTransferTaskOverride) noexcept {
         mLockedSizeX,
         mLockedSizeY,
         mLockedSizeZ,
-        mLockedNumLayers
+        mLockedNumLayers,
+        bCanTransferAsync
     );
 
     // Clear the lock details
@@ -401,4 +405,45 @@ void Texture::unlock(TransferTask* const pTransferTaskOverride) noexcept {
     mbDidATextureUpload = true;
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Schedules an upload of multiple 2D regions of the texture from a staging buffer (e.g one from 'TransferMgr::allocTempStagingBuffer').
+// All of the regions are uploaded with a single copy command, which is much cheaper than locking and unlocking each region separately.
+// This is only supported for 2D textures with a single mipmap level and array layer, and the texture must not be locked.
+// The staging buffer must remain valid until the transfer has been executed.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void Texture::uploadRegions(
+    const VkBuffer srcVkStagingBuffer,
+    const TextureRegionUpload* const pRegions,
+    const uint32_t numRegions,
+    TransferTask* const pTransferTaskOverride
+) noexcept {
+    // Preconditions
+    ASSERT(mbIsValid);
+    ASSERT(mpDevice && mpDevice->getVkDevice());
+    ASSERT_LOG(!isLocked(), "Can't upload regions while locked!");
+    ASSERT(srcVkStagingBuffer);
+    ASSERT((mDepth == 1) && (mNumLayers == 1) && (mNumMipLevels == 1) && (!mbIsCubemap));
+
+    #if ASSERTS_ENABLED
+        for (uint32_t i = 0; i < numRegions; ++i) {
+            const TextureRegionUpload& region = pRegions[i];
+            ASSERT((region.sizeX > 0) && (region.sizeY > 0));
+            ASSERT(region.offsetX + region.sizeX <= mWidth);
+            ASSERT(region.offsetY + region.sizeY <= mHeight);
+        }
+    #endif
+
+    if (numRegions == 0)
+        return;
+
+    // Schedule the data transfer for the regions and image layout transitions.
+    // The old image layout is shader read only optimal if there was a previous upload, otherwise it's undefined.
+    TransferTask* const pDstTask = (pTransferTaskOverride) ? pTransferTaskOverride : &mpDevice->getTransferMgr().getPreFrameTransferTask();
+    const VkImageLayout oldVkImageLayout = (mbDidATextureUpload) ? VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_UNDEFINED;
+    pDstTask->addTextureRegionsUpload(srcVkStagingBuffer, *this, oldVkImageLayout, pRegions, numRegions);
+
+    // We now did a texture upload
+    mbDidATextureUpload = true;
+}
+
 END_NAMESPACE(vgl)
@@ -7,6 +7,18 @@ BEGIN_NAMESPACE(vgl)
 
 class TransferTask;
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Describes a 2D region of a texture to be uploaded from a staging buffer via 'Texture::uploadRegions'.
+// The region data in the buffer is tightly packed and must start on a 4-byte (32-bit) boundary.
+//------------------------------------------------------------------------------------------------------------------------------------------
+struct TextureRegionUpload {
+    uint64_t    srcBufferOffset;    // Where the data for the region starts in the staging buffer
+    uint32_t    offsetX;            // Region to upload: offset x
+    uint32_t    offsetY;            // Region to upload: offset y
+    uint32_t    sizeX;              // Region to upload: size x
+    uint32_t    sizeY;              // Region to upload: size y
+};
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Represents a Vulkan texture used primarily as a read-only texture for rendering.
 //
@@ -84,6 +96,13 @@ public:
 
     void unlock(TransferTask* const pTransferTaskOverride = nullptr) noexcept;
 
+    void uploadRegions(
+        const VkBuffer srcVkStagingBuffer,
+        const TextureRegionUpload* const pRegions,
+        const uint32_t numRegions,
+        TransferTask* const pTransferTaskOverride = nullptr
+    ) noexcept;
+
     inline bool didATextureUpload() const noexcept { return mbDidATextureUpload; }
     inline std::byte* getLockedBytes() const noexcept { return mpLockedBytes; }
     inline uint64_t getLockedSizeInBytes() const noexcept { return mLockedSizeInBytes; }
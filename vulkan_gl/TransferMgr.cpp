@@ -20,6 +20,7 @@ TransferMgr::TransferMgr() noexcept
     , mpDevice(nullptr)
     , mpRingbufferMgr(nullptr)
     , mPreFrameTransferTask()
+    , mAsyncCmdPool()
     , mRingbufferSlots()
 {
 }
@@ -51,11 +52,27 @@ bool TransferMgr::init(LogicalDevice& device) noexcept {
         }
     });
 
+    // If there is a dedicated transfer queue then create a command pool for it, so async transfers can be done
+    const bool bUseAsyncTransfers = device.hasDedicatedTransferQueue();
+
+    if (bUseAsyncTransfers) {
+        if (!mAsyncCmdPool.init(device, device.getTransferQueueFamilyIdx(), true))
+            return false;
+    }
+
     // Initialize each of the ringbuffer slots
     for (RingbufferSlot& slot : mRingbufferSlots) {
         if (!slot.cmdBuffer.init(device.getCmdPool(), VK_COMMAND_BUFFER_LEVEL_PRIMARY))
             return false;
 
+        if (bUseAsyncTransfers) {
+            if (!slot.asyncCmdBuffer.init(mAsyncCmdPool, VK_COMMAND_BUFFER_LEVEL_PRIMARY))
+                return false;
+
+            if (!slot.asyncTransferDone.init(device))
+                return false;
+        }
+
         slot.tmpStagingBuffers.reserve(32);
     }
 
@@ -77,10 +94,13 @@ void TransferMgr::destroy(const bool bForceIfInvalid) noexcept {
 
     for (RingbufferSlot& slot : mRingbufferSlots) {
         slot.cmdBuffer.destroy();
+        slot.asyncCmdBuffer.destroy();
+        slot.asyncTransferDone.destroy();
         slot.tmpStagingBuffers.clear();
         slot.tmpStagingBuffers.shrink_to_fit();
     }
 
+    mAsyncCmdPool.destroy();
     mPreFrameTransferTask.clearCmds(true);
     mpRingbufferMgr = nullptr;
     mpDevice = nullptr;
@@ -133,6 +153,8 @@ TransferMgr::StagingBuffer TransferMgr::allocTempStagingBuffer(const uint64_t nu
 //  (1) This should only be called ONCE per frame.
 //  (2) Clears the pre-frame transfer task upon submitting to the GPU.
 //  (3) If there are no transfers to execute then this call is a no-op.
+//  (4) If there is a dedicated transfer queue, then transfers that can be done asynchronously are submitted to that queue instead.
+//      The command buffer submitted to the work queue waits for those transfers before any shader stages execute.
 //------------------------------------------------------------------------------------------------------------------------------------------
 bool TransferMgr::executePreFrameTransferTask() noexcept {
     // Preconditions: must be valid and device must be valid
@@ -151,13 +173,36 @@ bool TransferMgr::executePreFrameTransferTask() noexcept {
     if (!cmdRecorder.beginPrimaryCmdBuffer(cmdBuffer, VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT))
         return false;
 
+    // Record and submit whatever transfers we can to the dedicated transfer queue first, if there is one.
+    // The work queue command buffer receives the operations to acquire ownership of the resources transferred.
+    std::vector<CmdBufferWaitCond> waitConds;
+
+    if (mAsyncCmdPool.isValid() && mPreFrameTransferTask.hasAsyncCmds()) {
+        CmdBuffer& asyncCmdBuffer = ringbufferSlot.asyncCmdBuffer;
+        CmdBufferRecorder asyncCmdRecorder(mpDevice->getVkFuncs());
+
+        if (!asyncCmdRecorder.beginPrimaryCmdBuffer(asyncCmdBuffer, VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT))
+            return false;
+
+        mPreFrameTransferTask.submitAsyncCmdsToCmdBuffers(asyncCmdBuffer, cmdBuffer);
+
+        if (!asyncCmdRecorder.endCmdBuffer())
+            return false;
+
+        if (!mpDevice->submitTransferCmdBuffer(asyncCmdBuffer, {}, &ringbufferSlot.asyncTransferDone, nullptr))
+            return false;
+
+        waitConds.emplace_back(&ringbufferSlot.asyncTransferDone, TransferTask::ASYNC_TRANSFER_WAIT_STAGES);
+    }
+
+    // Record all other transfers to the work queue command buffer
     mPreFrameTransferTask.submitToCmdBuffer(cmdBuffer);
 
     if (!cmdRecorder.endCmdBuffer())
         return false;
 
     // Finally begin execution of the command buffer against the device
-    return mpDevice->submitCmdBuffer(cmdBuffer, {}, nullptr, nullptr);
+    return mpDevice->submitCmdBuffer(cmdBuffer, waitConds, nullptr, nullptr);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
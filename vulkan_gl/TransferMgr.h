@@ -1,7 +1,9 @@
 #pragma once
 
 #include "CmdBuffer.h"
+#include "CmdPool.h"
 #include "Defines.h"
+#include "Semaphore.h"
 #include "TransferTask.h"
 
 #include <cstddef>
@@ -15,6 +17,9 @@ class RingbufferMgr;
 //------------------------------------------------------------------------------------------------------------------------------------------
 // A manager that allows scheduling of data transfer from one buffer to another.
 // Used to schedule transferring from an in-RAM staging buffer to on-device/GPU memory.
+//
+// If the device has a dedicated transfer queue then transfers which can be done asynchronously (such as the first upload to a texture)
+// are executed on that queue, so they can overlap with rendering work. The work queue then waits on the transfers before shader access.
 //------------------------------------------------------------------------------------------------------------------------------------------
 class TransferMgr {
 public:
@@ -51,6 +56,8 @@ private:
     // Data structures for one of the ringbuffer slots
     struct RingbufferSlot {
         CmdBuffer               cmdBuffer;              // The command buffer which is submitted to the transfer queue to do transfer related commands
+        CmdBuffer               asyncCmdBuffer;         // The command buffer which is submitted to the dedicated transfer queue (if available)
+        Semaphore               asyncTransferDone;      // Signalled when the commands submitted to the dedicated transfer queue are done
         std::vector<RawBuffer>  tmpStagingBuffers;      // Temporary raw staging buffers that have been allocated by the manager for the purposes of doing transfers
     };
 
@@ -60,6 +67,7 @@ private:
     LogicalDevice*      mpDevice;
     RingbufferMgr*      mpRingbufferMgr;
     TransferTask        mPreFrameTransferTask;
+    CmdPool             mAsyncCmdPool;                  // Command pool for the dedicated transfer queue, only valid if the device has one
     RingbufferSlot      mRingbufferSlots[Defines::RINGBUFFER_SIZE];
 };
 
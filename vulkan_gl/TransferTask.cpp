@@ -19,6 +19,7 @@ BEGIN_NAMESPACE(vgl)
 enum class TransferCmdType {
     BUFFER_TO_BUFFER_TRANSFER,
     BUFFER_TO_TEXTURE_TRANSFER,
+    BUFFER_TO_TEXTURE_REGIONS_TRANSFER,
     RENDER_TEXTURE_DOWNLOAD
 };
 
@@ -48,6 +49,18 @@ struct BufToTexTransCmd {
     uint32_t        dstNumLayers;
     uint32_t        dstNumMipLevels;
     bool            bTexIsCubemap;
+    bool            bCanTransferAsync;      // If true the upload is allowed to happen on a dedicated transfer queue (the image has never been used)
+};
+
+// A buffer to texture transfer command for multiple 2D regions of a texture with a single mip level and array layer.
+// The copy operations for each region are stored separately by the transfer task.
+struct BufToTexRegionsTransCmd {
+    VkBuffer        srcVkBuffer;
+    VkImage         dstVkImage;
+    VkImageLayout   dstOldVkImageLayout;
+    VkFormat        texFormat;
+    uint32_t        firstRegionCopy;        // Index of the first region copy operation for the command in the transfer task
+    uint32_t        numRegionCopies;        // How many region copy operations there are for the command
 };
 
 // A render texture download command
@@ -73,6 +86,7 @@ struct TransferTask::TransferCmd {
     union {
         BufToBufTransCmd        bufToBufTransCmd;
         BufToTexTransCmd        bufToTexTransCmd;
+        BufToTexRegionsTransCmd bufToTexRegionsTransCmd;
         RenderTexDownloadCmd    renderTexDownloadCmd;
     };
 };
@@ -91,6 +105,178 @@ static void submitToCmdBufferImpl(CmdBuffer& cmdBuffer, const BufToBufTransCmd&
     vkFuncs.vkCmdCopyBuffer(cmdBuffer.getVkCommandBuffer(), cmd.srcVkBuffer, cmd.dstVkBuffer, 1, &copyInfo);
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Records an image barrier which gets the specified images of a texture into a layout that is optimal as a transfer destination,
+// after waiting for all other accesses to the texture to finish.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void recordPreTexUploadBarrier(
+    const VkFuncs& vkFuncs,
+    const VkCommandBuffer vkCmdBuffer,
+    const uint32_t workQueueFamilyIdx,
+    const VkImage vkImage,
+    const VkImageLayout oldVkImageLayout,
+    const uint32_t numMipLevels,
+    const uint32_t startTexImage,
+    const uint32_t numTexImages
+) noexcept {
+    VkImageMemoryBarrier barrier = {};
+
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;     // Wait for other access to finish
+    barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;     // Reads and writes are blocked on waiting for the other transfers to finish
+    barrier.oldLayout = oldVkImageLayout;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;           // Make the image be optimal as a transfer destination
+    barrier.srcQueueFamilyIndex = workQueueFamilyIdx;
+    barrier.dstQueueFamilyIndex = workQueueFamilyIdx;
+    barrier.image = vkImage;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;    // Only dealing with color buffers and not depth
+    barrier.subresourceRange.baseMipLevel = 0;                          // Include all mip levels
+    barrier.subresourceRange.levelCount = numMipLevels;                 // Include all mip levels
+    barrier.subresourceRange.baseArrayLayer = startTexImage;
+    barrier.subresourceRange.layerCount = numTexImages;
+
+    vkFuncs.vkCmdPipelineBarrier(
+        vkCmdBuffer,
+        VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,     // Src pipeline stage mask: wait for other stages to finish accessing
+        VK_PIPELINE_STAGE_TRANSFER_BIT,         // Dst pipeline stage mask: transfers waiting on transfers
+        0,                                      // Dependency flags
+        0,                                      // Memory barrier count
+        nullptr,                                // Memory barriers
+        0,                                      // Buffer memory barrier count
+        nullptr,                                // Buffer memory barriers
+        1,                                      // Image memory barrier count
+        &barrier                                // Image memory barrier
+    );
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Records an image barrier which waits for uploads to the specified images of a texture to finish, and which gets them into a layout
+// that is optimal for use in shaders.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void recordPostTexUploadBarrier(
+    const VkFuncs& vkFuncs,
+    const VkCommandBuffer vkCmdBuffer,
+    const uint32_t workQueueFamilyIdx,
+    const VkImage vkImage,
+    const VkFormat texFormat,
+    const uint32_t numMipLevels,
+    const uint32_t startTexImage,
+    const uint32_t numTexImages
+) noexcept {
+    VkImageMemoryBarrier barrier = {};
+
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;   // Waiting on transfer reads and writes to finish
+    barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;     // All types of reads and writes are blocked waiting for the writes
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;                           // The old layout was transfer optimal
+    barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;                       // The new layout will be shader use optimal
+    barrier.srcQueueFamilyIndex = workQueueFamilyIdx;
+    barrier.dstQueueFamilyIndex = workQueueFamilyIdx;
+    barrier.image = vkImage;
+    barrier.subresourceRange.aspectMask = VkFormatUtils::getVkImageAspectFlags(texFormat);
+    barrier.subresourceRange.baseMipLevel = 0;
+    barrier.subresourceRange.levelCount = numMipLevels;                     // Include all mip levels
+    barrier.subresourceRange.baseArrayLayer = startTexImage;
+    barrier.subresourceRange.layerCount = numTexImages;
+
+    vkFuncs.vkCmdPipelineBarrier(
+        vkCmdBuffer,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,         // Wait for the transfer stage to finish executing
+        VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,     // All stages are blocked waiting for the transfer to finish
+        0,                                      // Dependency flags
+        0,                                      // Memory barrier count
+        nullptr,                                // Memory barriers
+        0,                                      // Buffer memory barrier count
+        nullptr,                                // Buffer memory barriers
+        1,                                      // Image memory barrier count
+        &barrier                                // Image memory barrier
+    );
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Records the copy operations for a buffer to texture transfer command into the given command buffer.
+// The image is expected to be in the transfer destination optimal layout.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void recordBufToTexCopyOps(
+    const VkFuncs& vkFuncs,
+    const VkCommandBuffer vkCmdBuffer,
+    const BufToTexTransCmd& cmd,
+    const uint32_t startTexImage,
+    const uint32_t numTexImages
+) noexcept {
+    // Use this buffer to submit the copy operations
+    // TODO: preallocate this temporary buffer once and re-use
+    uint64_t bufferOffset = cmd.srcBufferOffset;
+    std::vector<VkBufferImageCopy> bufferImageCopyCmds;
+    bufferImageCopyCmds.reserve(16);
+
+    // Process the copy operations for every image and mipmap level in the texture
+    for (uint32_t curImage = 0; curImage < numTexImages; ++curImage) {
+        for (uint32_t curMipLevel = 0; curMipLevel < cmd.dstNumMipLevels; ++curMipLevel) {
+            // Figure out the dimensions for this mip level.
+            // Note that we do NOT round to the nearest block size for the copy command!
+            uint32_t mipLevelWidth = 0;
+            uint32_t mipLevelHeight = 0;
+            uint32_t mipLevelDepth = 0;
+
+            TextureUtils::getMipLevelDimensions(
+                cmd.dstSizeX,
+                cmd.dstSizeY,
+                cmd.dstSizeZ,
+                curMipLevel,
+                mipLevelWidth,
+                mipLevelHeight,
+                mipLevelDepth
+            );
+
+            ASSERT((mipLevelWidth > 0) && (mipLevelHeight > 0) && (mipLevelDepth > 0));
+
+            // Figure out the byte size for this mip level.
+            // Note that this WILL round to the nearest block size!
+            const uint64_t mipLevelByteSize = TextureUtils::getMipLevelByteSize(
+                cmd.texFormat,
+                mipLevelWidth,
+                mipLevelHeight,
+                mipLevelDepth
+            );
+
+            // Get the destination offset within this mipmap level
+            const uint32_t mipOffsetX = (cmd.dstOffsetX >> curMipLevel);
+            const uint32_t mipOffsetY = (cmd.dstOffsetY >> curMipLevel);
+            const uint32_t mipOffsetZ = (cmd.dstOffsetZ >> curMipLevel);
+
+            // Schedule the copy operation for this mip level
+            VkBufferImageCopy copyOp = {};
+            copyOp.bufferOffset = bufferOffset;
+            copyOp.bufferRowLength = 0;                                         // Tightly packed
+            copyOp.bufferImageHeight = 0;                                       // Tightly packed
+            copyOp.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;     // Just dealing with color buffer
+            copyOp.imageSubresource.mipLevel = curMipLevel;
+            copyOp.imageSubresource.baseArrayLayer = startTexImage + curImage;
+            copyOp.imageSubresource.layerCount = 1;
+            copyOp.imageOffset = { (int32_t) mipOffsetX, (int32_t) mipOffsetY, (int32_t) mipOffsetZ };
+            copyOp.imageExtent = { mipLevelWidth, mipLevelHeight, mipLevelDepth };
+
+            bufferImageCopyCmds.push_back(copyOp);
+
+            // Move onto the next mip level in the buffer.
+            // Note that as per the docs in 'Texture' this offset must be 32-bit (4 byte) aligned so if it's not aligned then align it now.
+            bufferOffset += mipLevelByteSize;
+            bufferOffset = Utils::ualignUp(bufferOffset, (uint64_t) Defines::MIN_IMAGE_ALIGNMENT);
+        }
+    }
+
+    // Issue the buffer image copy commands
+    vkFuncs.vkCmdCopyBufferToImage(
+        vkCmdBuffer,
+        cmd.srcVkBuffer,
+        cmd.dstVkImage,
+        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,                       // Dest image is in this format
+        static_cast<uint32_t>(bufferImageCopyCmds.size()),
+        bufferImageCopyCmds.data()
+    );
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Write a buffer to texture transfer command into the given command buffer
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -109,143 +295,160 @@ static void submitToCmdBufferImpl(CmdBuffer& cmdBuffer, const BufToTexTransCmd&
     const uint32_t startTexImage = TextureUtils::getNumTexImages(cmd.dstStartLayer, cmd.bTexIsCubemap);
     const uint32_t numTexImages = TextureUtils::getNumTexImages(cmd.dstNumLayers, cmd.bTexIsCubemap);
 
-    {
-        VkImageMemoryBarrier barrier = {};
+    recordPreTexUploadBarrier(
+        vkFuncs,
+        vkCmdBuffer,
+        workQueueFamilyIdx,
+        cmd.dstVkImage,
+        cmd.dstOldVkImageLayout,
+        cmd.dstNumMipLevels,
+        startTexImage,
+        numTexImages
+    );
 
-        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-        barrier.srcAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;     // Wait for other access to finish
-        barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;     // Reads and writes are blocked on waiting for the other transfers to finish
-        barrier.oldLayout = cmd.dstOldVkImageLayout;
-        barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;           // Make the image be optimal as a transfer destination
-        barrier.srcQueueFamilyIndex = workQueueFamilyIdx;
-        barrier.dstQueueFamilyIndex = workQueueFamilyIdx;
-        barrier.image = cmd.dstVkImage;
-        barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;    // Only dealing with color buffers and not depth
-        barrier.subresourceRange.baseMipLevel = 0;                          // Include all mip levels
-        barrier.subresourceRange.levelCount = cmd.dstNumMipLevels;          // Include all mip levels
-        barrier.subresourceRange.baseArrayLayer = startTexImage;
-        barrier.subresourceRange.layerCount = numTexImages;
+    // Next record the actual copy operations that will copy the data into the image
+    recordBufToTexCopyOps(vkFuncs, vkCmdBuffer, cmd, startTexImage, numTexImages);
+
+    // Need to insert an image barrier to get the image into a format that is optimal for use in shaders
+    recordPostTexUploadBarrier(
+        vkFuncs,
+        vkCmdBuffer,
+        workQueueFamilyIdx,
+        cmd.dstVkImage,
+        cmd.texFormat,
+        cmd.dstNumMipLevels,
+        startTexImage,
+        numTexImages
+    );
+}
 
-        vkFuncs.vkCmdPipelineBarrier(
-            vkCmdBuffer,
-            VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,     // Src pipeline stage mask: wait for other stages to finish accessing
-            VK_PIPELINE_STAGE_TRANSFER_BIT,         // Dst pipeline stage mask: transfers waiting on transfers
-            0,                                      // Dependency flags
-            0,                                      // Memory barrier count
-            nullptr,                                // Memory barriers
-            0,                                      // Buffer memory barrier count
-            nullptr,                                // Buffer memory barriers
-            1,                                      // Image memory barrier count
-            &barrier                                // Image memory barrier
-        );
-    }
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Write a buffer to texture regions transfer command into the given command buffer.
+// All of the regions are copied with a single copy command, surrounded by the usual layout transitions for the texture.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void submitToCmdBufferImpl(
+    CmdBuffer& cmdBuffer,
+    const BufToTexRegionsTransCmd& cmd,
+    const std::vector<VkBufferImageCopy>& regionCopies
+) noexcept {
+    ASSERT(cmd.numRegionCopies > 0);
+    ASSERT(cmd.firstRegionCopy + cmd.numRegionCopies <= regionCopies.size());
 
-    // Next record the actual copy operations that will copy the data into the image.
-    {
-        // Use this buffer to submit the copy operations
-        // TODO: preallocate this temporary buffer once and re-use
-        uint64_t bufferOffset = cmd.srcBufferOffset;
-        std::vector<VkBufferImageCopy> bufferImageCopyCmds;
-        bufferImageCopyCmds.reserve(16);
+    LogicalDevice& device = *cmdBuffer.getCmdPool()->getDevice();
+    const uint32_t workQueueFamilyIdx = device.getWorkQueueFamilyIdx();
+    const VkCommandBuffer vkCmdBuffer = cmdBuffer.getVkCommandBuffer();
+    const VkFuncs& vkFuncs = device.getVkFuncs();
 
-        // Process the copy operations for every image and mipmap level in the texture
-        for (uint32_t curImage = 0; curImage < numTexImages; ++curImage) {
-            for (uint32_t curMipLevel = 0; curMipLevel < cmd.dstNumMipLevels; ++curMipLevel) {
-                // Figure out the dimensions for this mip level.
-                // Note that we do NOT round to the nearest block size for the copy command!
-                uint32_t mipLevelWidth = 0;
-                uint32_t mipLevelHeight = 0;
-                uint32_t mipLevelDepth = 0;
-
-                TextureUtils::getMipLevelDimensions(
-                    cmd.dstSizeX,
-                    cmd.dstSizeY,
-                    cmd.dstSizeZ,
-                    curMipLevel,
-                    mipLevelWidth,
-                    mipLevelHeight,
-                    mipLevelDepth
-                );
-
-                ASSERT((mipLevelWidth > 0) && (mipLevelHeight > 0) && (mipLevelDepth > 0));
-
-                // Figure out the byte size for this mip level.
-                // Note that this WILL round to the nearest block size!
-                const uint64_t mipLevelByteSize = TextureUtils::getMipLevelByteSize(
-                    cmd.texFormat,
-                    mipLevelWidth,
-                    mipLevelHeight,
-                    mipLevelDepth
-                );
-
-                // Get the destination offset within this mipmap level
-                const uint32_t mipOffsetX = (cmd.dstOffsetX >> curMipLevel);
-                const uint32_t mipOffsetY = (cmd.dstOffsetY >> curMipLevel);
-                const uint32_t mipOffsetZ = (cmd.dstOffsetZ >> curMipLevel);
-
-                // Schedule the copy operation for this mip level
-                VkBufferImageCopy copyOp = {};
-                copyOp.bufferOffset = bufferOffset;
-                copyOp.bufferRowLength = 0;                                         // Tightly packed
-                copyOp.bufferImageHeight = 0;                                       // Tightly packed
-                copyOp.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;     // Just dealing with color buffer
-                copyOp.imageSubresource.mipLevel = curMipLevel;
-                copyOp.imageSubresource.baseArrayLayer = startTexImage + curImage;
-                copyOp.imageSubresource.layerCount = 1;
-                copyOp.imageOffset = { (int32_t) mipOffsetX, (int32_t) mipOffsetY, (int32_t) mipOffsetZ };
-                copyOp.imageExtent = { mipLevelWidth, mipLevelHeight, mipLevelDepth };
-
-                bufferImageCopyCmds.push_back(copyOp);
-
-                // Move onto the next mip level in the buffer.
-                // Note that as per the docs in 'Texture' this offset must be 32-bit (4 byte) aligned so if it's not aligned then align it now.
-                bufferOffset += mipLevelByteSize;
-                bufferOffset = Utils::ualignUp(bufferOffset, (uint64_t) Defines::MIN_IMAGE_ALIGNMENT);
-            }
-        }
+    recordPreTexUploadBarrier(vkFuncs, vkCmdBuffer, workQueueFamilyIdx, cmd.dstVkImage, cmd.dstOldVkImageLayout, 1, 0, 1);
 
-        // Issue the buffer image copy commands
-        vkFuncs.vkCmdCopyBufferToImage(
-            vkCmdBuffer,
-            cmd.srcVkBuffer,
-            cmd.dstVkImage,
-            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,                       // Dest image is in this format
-            static_cast<uint32_t>(bufferImageCopyCmds.size()),
-            bufferImageCopyCmds.data()
-        );
-    }
+    vkFuncs.vkCmdCopyBufferToImage(
+        vkCmdBuffer,
+        cmd.srcVkBuffer,
+        cmd.dstVkImage,
+        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        cmd.numRegionCopies,
+        regionCopies.data() + cmd.firstRegionCopy
+    );
 
-    // Need to insert an image barrier to get the image into a format that is optimal for use in shaders:
-    {
-        VkImageMemoryBarrier barrier = {};
+    recordPostTexUploadBarrier(vkFuncs, vkCmdBuffer, workQueueFamilyIdx, cmd.dstVkImage, cmd.texFormat, 1, 0, 1);
+}
 
-        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-        barrier.srcAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;   // Waiting on transfer reads and writes to finish
-        barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;     // All types of reads and writes are blocked waiting for the writes
-        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;                           // The old layout was transfer optimal
-        barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;                       // The new layout will be shader use optimal
-        barrier.srcQueueFamilyIndex = workQueueFamilyIdx;
-        barrier.dstQueueFamilyIndex = workQueueFamilyIdx;
-        barrier.image = cmd.dstVkImage;
-        barrier.subresourceRange.aspectMask = VkFormatUtils::getVkImageAspectFlags(cmd.texFormat);
-        barrier.subresourceRange.baseMipLevel = 0;
-        barrier.subresourceRange.levelCount = cmd.dstNumMipLevels;              // Include all mip levels
-        barrier.subresourceRange.baseArrayLayer = startTexImage;
-        barrier.subresourceRange.layerCount = numTexImages;
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Write a buffer to texture transfer command into a command buffer for the dedicated transfer queue.
+// Ownership of the image is released to the work queue family once the upload is done, and the matching acquire of ownership is recorded
+// into the given work queue command buffer. The work queue must wait for the transfer queue to finish before executing the acquire; the
+// stages waiting should be 'ASYNC_TRANSFER_WAIT_STAGES'.
+//
+// Note: no ownership acquire is needed on the transfer queue since the image contents are undefined, and it has never been used before.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void submitAsyncToCmdBuffersImpl(CmdBuffer& transferCmdBuffer, CmdBuffer& workCmdBuffer, const BufToTexTransCmd& cmd) noexcept {
+    // Preconditions
+    ASSERT(cmd.srcBufferOffset % Defines::MIN_IMAGE_ALIGNMENT == 0);
+    ASSERT(cmd.bCanTransferAsync);
+    ASSERT(cmd.dstOldVkImageLayout == VK_IMAGE_LAYOUT_UNDEFINED);
 
-        vkFuncs.vkCmdPipelineBarrier(
-            vkCmdBuffer,
-            VK_PIPELINE_STAGE_TRANSFER_BIT,         // Wait for the transfer stage to finish executing
-            VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,     // All stages are blocked waiting for the transfer to finish
-            0,                                      // Dependency flags
-            0,                                      // Memory barrier count
-            nullptr,                                // Memory barriers
-            0,                                      // Buffer memory barrier count
-            nullptr,                                // Buffer memory barriers
-            1,                                      // Image memory barrier count
-            &barrier                                // Image memory barrier
-        );
-    }
+    LogicalDevice& device = *transferCmdBuffer.getCmdPool()->getDevice();
+    const VkFuncs& vkFuncs = device.getVkFuncs();
+    const uint32_t workQueueFamilyIdx = device.getWorkQueueFamilyIdx();
+    const uint32_t transferQueueFamilyIdx = device.getTransferQueueFamilyIdx();
+    const VkCommandBuffer vkTransferCmdBuffer = transferCmdBuffer.getVkCommandBuffer();
+    const VkCommandBuffer vkWorkCmdBuffer = workCmdBuffer.getVkCommandBuffer();
+
+    const uint32_t startTexImage = TextureUtils::getNumTexImages(cmd.dstStartLayer, cmd.bTexIsCubemap);
+    const uint32_t numTexImages = TextureUtils::getNumTexImages(cmd.dstNumLayers, cmd.bTexIsCubemap);
+
+    VkImageMemoryBarrier barrier = {};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.image = cmd.dstVkImage;
+    barrier.subresourceRange.aspectMask = VkFormatUtils::getVkImageAspectFlags(cmd.texFormat);
+    barrier.subresourceRange.baseMipLevel = 0;
+    barrier.subresourceRange.levelCount = cmd.dstNumMipLevels;              // Include all mip levels
+    barrier.subresourceRange.baseArrayLayer = startTexImage;
+    barrier.subresourceRange.layerCount = numTexImages;
+
+    // Transfer queue: get the image in a format that is optimal as a transfer destination, discarding the old contents
+    barrier.srcAccessMask = 0;                                              // Nothing to wait on, the image has never been used
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;                   // Transfer writes are blocked on the layout change
+    barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+
+    vkFuncs.vkCmdPipelineBarrier(
+        vkTransferCmdBuffer,
+        VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,      // Src pipeline stage mask: nothing to wait on
+        VK_PIPELINE_STAGE_TRANSFER_BIT,         // Dst pipeline stage mask: transfers waiting on the layout change
+        0,                                      // Dependency flags
+        0,                                      // Memory barrier count
+        nullptr,                                // Memory barriers
+        0,                                      // Buffer memory barrier count
+        nullptr,                                // Buffer memory barriers
+        1,                                      // Image memory barrier count
+        &barrier                                // Image memory barrier
+    );
+
+    // Transfer queue: copy the data into the image
+    recordBufToTexCopyOps(vkFuncs, vkTransferCmdBuffer, cmd, startTexImage, numTexImages);
+
+    // Transfer queue: release ownership of the image to the work queue family, transitioning it to a layout optimal for use in shaders.
+    // Note: the destination stage and access masks are ignored for a release operation.
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;                   // Waiting on transfer writes to finish
+    barrier.dstAccessMask = 0;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier.srcQueueFamilyIndex = transferQueueFamilyIdx;
+    barrier.dstQueueFamilyIndex = workQueueFamilyIdx;
+
+    vkFuncs.vkCmdPipelineBarrier(
+        vkTransferCmdBuffer,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,         // Wait for the transfer stage to finish executing
+        VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,   // Nothing else on this queue is blocked
+        0,                                      // Dependency flags
+        0,                                      // Memory barrier count
+        nullptr,                                // Memory barriers
+        0,                                      // Buffer memory barrier count
+        nullptr,                                // Buffer memory barriers
+        1,                                      // Image memory barrier count
+        &barrier                                // Image memory barrier
+    );
+
+    // Work queue: acquire ownership of the image with the same layout transition as the release, after the transfer queue is finished.
+    // Note: the source stage mask matches the stages which wait on the transfer queue semaphore, so the dependency chains onto that wait.
+    barrier.srcAccessMask = 0;
+    barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;     // All types of reads and writes are blocked waiting for the writes
+
+    vkFuncs.vkCmdPipelineBarrier(
+        vkWorkCmdBuffer,
+        TransferTask::ASYNC_TRANSFER_WAIT_STAGES,   // Chain onto the wait for the transfer queue
+        TransferTask::ASYNC_TRANSFER_WAIT_STAGES,   // Shader stages are blocked until the image is acquired
+        0,                                      // Dependency flags
+        0,                                      // Memory barrier count
+        nullptr,                                // Memory barriers
+        0,                                      // Buffer memory barrier count
+        nullptr,                                // Buffer memory barriers
+        1,                                      // Image memory barrier count
+        &barrier                                // Image memory barrier
+    );
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -425,6 +628,7 @@ static void submitToCmdBufferImpl(CmdBuffer& cmdBuffer, const RenderTexDownloadC
 //------------------------------------------------------------------------------------------------------------------------------------------
 TransferTask::TransferTask() noexcept
     : mCmds(false)
+    , mTexRegionCopies()
 {
 }
 
@@ -444,9 +648,11 @@ void TransferTask::reserveCmds(const size_t numCmds) noexcept {
 //------------------------------------------------------------------------------------------------------------------------------------------
 void TransferTask::clearCmds(const bool bCompactCmdList) noexcept {
     mCmds.clear();
+    mTexRegionCopies.clear();
 
     if (bCompactCmdList) {
         mCmds.shrink_to_fit();
+        mTexRegionCopies.shrink_to_fit();
     }
 }
 
@@ -481,6 +687,10 @@ void TransferTask::submitToCmdBuffer(CmdBuffer& cmdBuffer) noexcept {
                 submitToCmdBufferImpl(cmdBuffer, cmd.bufToTexTransCmd);
                 break;
 
+            case TransferCmdType::BUFFER_TO_TEXTURE_REGIONS_TRANSFER:
+                submitToCmdBufferImpl(cmdBuffer, cmd.bufToTexRegionsTransCmd, mTexRegionCopies);
+                break;
+
             case TransferCmdType::RENDER_TEXTURE_DOWNLOAD:
                 submitToCmdBufferImpl(cmdBuffer, cmd.renderTexDownloadCmd);
                 break;
@@ -492,6 +702,78 @@ void TransferTask::submitToCmdBuffer(CmdBuffer& cmdBuffer) noexcept {
     }
 
     mCmds.clear();
+    mTexRegionCopies.clear();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tells if the task contains any commands that can be executed on a dedicated transfer queue via 'submitAsyncCmdsToCmdBuffers'
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool TransferTask::hasAsyncCmds() const noexcept {
+    for (size_t cmdIdx = 0; cmdIdx < mCmds.size(); ++cmdIdx) {
+        if (isAsyncCmd(cmdIdx))
+            return true;
+    }
+
+    return false;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Records all commands in the task which can be executed on a dedicated transfer queue into the given transfer queue command buffer, and
+// removes them from the task. The work queue command buffer receives operations to acquire ownership of the transferred resources, and
+// must execute after the transfer queue command buffer has finished (as far as the 'ASYNC_TRANSFER_WAIT_STAGES' stages are concerned).
+// All other commands remain in the task, and should be recorded afterwards to the work queue command buffer via 'submitToCmdBuffer'.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void TransferTask::submitAsyncCmdsToCmdBuffers(CmdBuffer& transferCmdBuffer, CmdBuffer& workCmdBuffer) noexcept {
+    ASSERT(transferCmdBuffer.isValid());
+    ASSERT(workCmdBuffer.isValid());
+
+    // Record the async commands and compact the list of remaining commands as we go
+    size_t numRemainingCmds = 0;
+
+    for (size_t cmdIdx = 0; cmdIdx < mCmds.size(); ++cmdIdx) {
+        if (isAsyncCmd(cmdIdx)) {
+            submitAsyncToCmdBuffersImpl(transferCmdBuffer, workCmdBuffer, mCmds[cmdIdx].bufToTexTransCmd);
+        } else {
+            mCmds[numRemainingCmds] = mCmds[cmdIdx];
+            numRemainingCmds++;
+        }
+    }
+
+    mCmds.resize(numRemainingCmds);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tells if the specified command is one that can be executed on a dedicated transfer queue.
+// This is only allowed for the first upload to a texture, and only if no other command in the task affects the same image - since
+// the commands executed on the dedicated transfer queue would happen in a different order to the others.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool TransferTask::isAsyncCmd(const size_t cmdIdx) const noexcept {
+    ASSERT(cmdIdx < mCmds.size());
+    const TransferCmd& cmd = mCmds[cmdIdx];
+
+    if ((cmd.type != TransferCmdType::BUFFER_TO_TEXTURE_TRANSFER) || (!cmd.bufToTexTransCmd.bCanTransferAsync))
+        return false;
+
+    const VkImage vkImage = cmd.bufToTexTransCmd.dstVkImage;
+
+    for (size_t otherCmdIdx = 0; otherCmdIdx < mCmds.size(); ++otherCmdIdx) {
+        if (otherCmdIdx == cmdIdx)
+            continue;
+
+        const TransferCmd& otherCmd = mCmds[otherCmdIdx];
+
+        const bool bAffectsSameImage = (
+            ((otherCmd.type == TransferCmdType::BUFFER_TO_TEXTURE_TRANSFER) && (otherCmd.bufToTexTransCmd.dstVkImage == vkImage)) ||
+            ((otherCmd.type == TransferCmdType::BUFFER_TO_TEXTURE_REGIONS_TRANSFER) && (otherCmd.bufToTexRegionsTransCmd.dstVkImage == vkImage)) ||
+            ((otherCmd.type == TransferCmdType::RENDER_TEXTURE_DOWNLOAD) && (otherCmd.renderTexDownloadCmd.srcVkImage == vkImage)) ||
+            ((otherCmd.type == TransferCmdType::RENDER_TEXTURE_DOWNLOAD) && (otherCmd.renderTexDownloadCmd.dstVkImage == vkImage))
+        );
+
+        if (bAffectsSameImage)
+            return false;
+    }
+
+    return true;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -526,6 +808,8 @@ void TransferTask::addBufferCopy(
 // Notes:
 //  (1) The buffer is assumed to be sized large enough to accomodate all of the image data and valid as a transfer source.
 //  (2) The image is put in a shader read optimal state after completion.
+//  (3) If 'bCanTransferAsync' is set then the upload may be done on a dedicated transfer queue (if available). This should only be
+//      set for the first upload to a texture, where the image has never been used by the GPU and the old layout is undefined.
 //------------------------------------------------------------------------------------------------------------------------------------------
 void TransferTask::addTextureUpload(
     const VkBuffer srcVkBuffer,
@@ -539,10 +823,12 @@ void TransferTask::addTextureUpload(
     const uint32_t dstSizeX,
     const uint32_t dstSizeY,
     const uint32_t dstSizeZ,
-    const uint32_t dstNumLayers
+    const uint32_t dstNumLayers,
+    const bool bCanTransferAsync
 ) noexcept {
     ASSERT(srcVkBuffer);
     ASSERT(dstTexture.isValid());
+    ASSERT((!bCanTransferAsync) || (dstOldVkImageLayout == VK_IMAGE_LAYOUT_UNDEFINED));
 
     TransferCmd& cmd = mCmds.emplace_back();
     cmd.type = TransferCmdType::BUFFER_TO_TEXTURE_TRANSFER;
@@ -563,6 +849,58 @@ void TransferTask::addTextureUpload(
     cmdDetails.dstNumLayers = dstNumLayers;
     cmdDetails.dstNumMipLevels = dstTexture.getNumMipLevels();
     cmdDetails.bTexIsCubemap = dstTexture.isCubemap();
+    cmdDetails.bCanTransferAsync = bCanTransferAsync;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Schedules uploads of multiple 2D regions of a texture from the given buffer, all done with a single copy command.
+// The texture must have only a single mipmap level and array layer.
+//
+// Notes:
+//  (1) The buffer is assumed to be sized large enough to accomodate all of the region data and valid as a transfer source.
+//  (2) The image is put in a shader read optimal state after completion.
+//  (3) Region uploads are never done on a dedicated transfer queue.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void TransferTask::addTextureRegionsUpload(
+    const VkBuffer srcVkBuffer,
+    const Texture& dstTexture,
+    const VkImageLayout dstOldVkImageLayout,
+    const TextureRegionUpload* const pRegions,
+    const uint32_t numRegions
+) noexcept {
+    ASSERT(srcVkBuffer);
+    ASSERT(dstTexture.isValid());
+    ASSERT(dstTexture.getNumMipLevels() == 1);
+    ASSERT(dstTexture.getNumLayers() == 1);
+    ASSERT(pRegions && (numRegions > 0));
+
+    TransferCmd& cmd = mCmds.emplace_back();
+    cmd.type = TransferCmdType::BUFFER_TO_TEXTURE_REGIONS_TRANSFER;
+
+    BufToTexRegionsTransCmd& cmdDetails = cmd.bufToTexRegionsTransCmd;
+    cmdDetails.srcVkBuffer = srcVkBuffer;
+    cmdDetails.dstVkImage = dstTexture.getVkImage();
+    cmdDetails.dstOldVkImageLayout = dstOldVkImageLayout;
+    cmdDetails.texFormat = dstTexture.getFormat();
+    cmdDetails.firstRegionCopy = (uint32_t) mTexRegionCopies.size();
+    cmdDetails.numRegionCopies = numRegions;
+
+    for (uint32_t i = 0; i < numRegions; ++i) {
+        const TextureRegionUpload& region = pRegions[i];
+        ASSERT(region.srcBufferOffset % Defines::MIN_IMAGE_ALIGNMENT == 0);
+
+        VkBufferImageCopy& copyOp = mTexRegionCopies.emplace_back();
+        copyOp = {};
+        copyOp.bufferOffset = region.srcBufferOffset;
+        copyOp.bufferRowLength = 0;                                         // Tightly packed
+        copyOp.bufferImageHeight = 0;                                       // Tightly packed
+        copyOp.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;     // Just dealing with color buffer
+        copyOp.imageSubresource.mipLevel = 0;
+        copyOp.imageSubresource.baseArrayLayer = 0;
+        copyOp.imageSubresource.layerCount = 1;
+        copyOp.imageOffset = { (int32_t) region.offsetX, (int32_t) region.offsetY, 0 };
+        copyOp.imageExtent = { region.sizeX, region.sizeY, 1 };
+    }
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
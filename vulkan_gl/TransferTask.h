@@ -11,6 +11,7 @@ class CmdBuffer;
 class MutableTexture;
 class RenderTexture;
 class Texture;
+struct TextureRegionUpload;
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Holds and collects transfer commands which can be submitted later to a command buffer.
@@ -22,6 +23,14 @@ class Texture;
 //------------------------------------------------------------------------------------------------------------------------------------------
 class TransferTask {
 public:
+    // Which pipeline stages on the work queue wait for transfers done on a dedicated transfer queue to finish.
+    // Textures uploaded asynchronously can only be accessed by shaders, so other work is free to start before the transfers complete.
+    static constexpr VkPipelineStageFlags ASYNC_TRANSFER_WAIT_STAGES = (
+        VK_PIPELINE_STAGE_VERTEX_SHADER_BIT |
+        VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT |
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT
+    );
+
     TransferTask() noexcept;
     ~TransferTask() noexcept;
 
@@ -30,6 +39,8 @@ public:
     bool isEmpty() const noexcept;
     size_t getNumCmds() const noexcept;
     void submitToCmdBuffer(CmdBuffer& cmdBuffer) noexcept;
+    bool hasAsyncCmds() const noexcept;
+    void submitAsyncCmdsToCmdBuffers(CmdBuffer& transferCmdBuffer, CmdBuffer& workCmdBuffer) noexcept;
 
 private:
     // Copy and move is disallowed
@@ -63,14 +74,26 @@ private:
         const uint32_t dstSizeX,
         const uint32_t dstSizeY,
         const uint32_t dstSizeZ,
-        const uint32_t dstNumLayers
+        const uint32_t dstNumLayers,
+        const bool bCanTransferAsync
     ) noexcept;
 
+    void addTextureRegionsUpload(
+        const VkBuffer srcVkBuffer,
+        const Texture& dstTexture,
+        const VkImageLayout dstOldVkImageLayout,
+        const TextureRegionUpload* const pRegions,
+        const uint32_t numRegions
+    ) noexcept;
+
+    bool isAsyncCmd(const size_t cmdIdx) const noexcept;
+
     void addRenderTextureDownload(RenderTexture& src, MutableTexture& dst) noexcept;
 
     // The list of transfer commands to execute
     struct TransferCmd;
-    std::vector<TransferCmd> mCmds;
+    std::vector<TransferCmd>            mCmds;
+    std::vector<VkBufferImageCopy>      mTexRegionCopies;   // Copy operations for all the texture region uploads in the task
 };
 
 END_NAMESPACE(vgl)
@@ -114,6 +114,7 @@ void VkFuncs::loadInstanceFuncs(const VkInstance vkInstance) noexcept {
     LOAD_INST_FUNC(vkCmdCopyBuffer);
     LOAD_INST_FUNC(vkCmdCopyBufferToImage);
     LOAD_INST_FUNC(vkCmdCopyImage);
+    LOAD_INST_FUNC(vkCmdCopyImageToBuffer);
     LOAD_INST_FUNC(vkCmdDispatch);
     LOAD_INST_FUNC(vkCmdDraw);
     LOAD_INST_FUNC(vkCmdDrawIndexed);
@@ -122,8 +123,10 @@ void VkFuncs::loadInstanceFuncs(const VkInstance vkInstance) noexcept {
     LOAD_INST_FUNC(vkCmdNextSubpass);
     LOAD_INST_FUNC(vkCmdPipelineBarrier);
     LOAD_INST_FUNC(vkCmdPushConstants);
+    LOAD_INST_FUNC(vkCmdResetQueryPool);
     LOAD_INST_FUNC(vkCmdSetScissor);
     LOAD_INST_FUNC(vkCmdSetViewport);
+    LOAD_INST_FUNC(vkCmdWriteTimestamp);
     LOAD_INST_FUNC(vkCreateDevice);
     LOAD_INST_FUNC(vkDestroyDevice);
     LOAD_INST_FUNC(vkDestroyInstance);
@@ -146,6 +149,8 @@ void VkFuncs::loadInstanceFuncs(const VkInstance vkInstance) noexcept {
     LOAD_OPT_INST_FUNC(vkCreateDebugUtilsMessengerEXT);
     LOAD_OPT_INST_FUNC(vkDestroyDebugReportCallbackEXT);
     LOAD_OPT_INST_FUNC(vkDestroyDebugUtilsMessengerEXT);
+    LOAD_OPT_INST_FUNC(vkGetPhysicalDeviceFeatures2KHR);
+    LOAD_OPT_INST_FUNC(vkGetPhysicalDeviceMemoryProperties2KHR);
 
     #undef LOAD_INST_FUNC
 }
@@ -164,6 +169,11 @@ void VkFuncs::loadDeviceFuncs(const VkDevice vkDevice) noexcept {
             loadDeviceFunc(NAME, #NAME, vkDevice, vkGetDeviceProcAddr, false);\
         } while (0)
 
+    #define LOAD_OPT_DEV_FUNC(NAME)\
+        do {\
+            loadDeviceFunc(NAME, #NAME, vkDevice, vkGetDeviceProcAddr, true);\
+        } while (0)
+
     LOAD_DEV_FUNC(vkAcquireNextImageKHR);
     LOAD_DEV_FUNC(vkAllocateCommandBuffers);
     LOAD_DEV_FUNC(vkAllocateDescriptorSets);
@@ -180,7 +190,9 @@ void VkFuncs::loadDeviceFuncs(const VkDevice vkDevice) noexcept {
     LOAD_DEV_FUNC(vkCreateGraphicsPipelines);
     LOAD_DEV_FUNC(vkCreateImage);
     LOAD_DEV_FUNC(vkCreateImageView);
+    LOAD_DEV_FUNC(vkCreatePipelineCache);
     LOAD_DEV_FUNC(vkCreatePipelineLayout);
+    LOAD_DEV_FUNC(vkCreateQueryPool);
     LOAD_DEV_FUNC(vkCreateRenderPass);
     LOAD_DEV_FUNC(vkCreateSampler);
     LOAD_DEV_FUNC(vkCreateSemaphore);
@@ -195,7 +207,9 @@ void VkFuncs::loadDeviceFuncs(const VkDevice vkDevice) noexcept {
     LOAD_DEV_FUNC(vkDestroyImage);
     LOAD_DEV_FUNC(vkDestroyImageView);
     LOAD_DEV_FUNC(vkDestroyPipeline);
+    LOAD_DEV_FUNC(vkDestroyPipelineCache);
     LOAD_DEV_FUNC(vkDestroyPipelineLayout);
+    LOAD_DEV_FUNC(vkDestroyQueryPool);
     LOAD_DEV_FUNC(vkDestroyRenderPass);
     LOAD_DEV_FUNC(vkDestroySampler);
     LOAD_DEV_FUNC(vkDestroySemaphore);
@@ -209,6 +223,8 @@ void VkFuncs::loadDeviceFuncs(const VkDevice vkDevice) noexcept {
     LOAD_DEV_FUNC(vkGetDeviceQueue);
     LOAD_DEV_FUNC(vkGetFenceStatus);
     LOAD_DEV_FUNC(vkGetImageMemoryRequirements);
+    LOAD_DEV_FUNC(vkGetPipelineCacheData);
+    LOAD_DEV_FUNC(vkGetQueryPoolResults);
     LOAD_DEV_FUNC(vkGetSwapchainImagesKHR);
     LOAD_DEV_FUNC(vkMapMemory);
     LOAD_DEV_FUNC(vkQueuePresentKHR);
@@ -220,6 +236,9 @@ void VkFuncs::loadDeviceFuncs(const VkDevice vkDevice) noexcept {
     LOAD_DEV_FUNC(vkUpdateDescriptorSets);
     LOAD_DEV_FUNC(vkWaitForFences);
 
+    LOAD_OPT_DEV_FUNC(vkGetSemaphoreCounterValueKHR);
+
+    #undef LOAD_OPT_DEV_FUNC
     #undef LOAD_DEV_FUNC
 }
 
@@ -37,6 +37,7 @@ struct VkFuncs {
     DEFINE_VK_FUNC(vkCmdCopyBuffer)
     DEFINE_VK_FUNC(vkCmdCopyBufferToImage)
     DEFINE_VK_FUNC(vkCmdCopyImage)
+    DEFINE_VK_FUNC(vkCmdCopyImageToBuffer)
     DEFINE_VK_FUNC(vkCmdDispatch)
     DEFINE_VK_FUNC(vkCmdDraw)
     DEFINE_VK_FUNC(vkCmdDrawIndexed)
@@ -45,8 +46,10 @@ struct VkFuncs {
     DEFINE_VK_FUNC(vkCmdNextSubpass)
     DEFINE_VK_FUNC(vkCmdPipelineBarrier)
     DEFINE_VK_FUNC(vkCmdPushConstants)
+    DEFINE_VK_FUNC(vkCmdResetQueryPool)
     DEFINE_VK_FUNC(vkCmdSetScissor)
     DEFINE_VK_FUNC(vkCmdSetViewport)
+    DEFINE_VK_FUNC(vkCmdWriteTimestamp)
     DEFINE_VK_FUNC(vkCreateDevice)
     DEFINE_VK_FUNC(vkDestroyDevice)
     DEFINE_VK_FUNC(vkDestroyInstance)
@@ -70,6 +73,8 @@ struct VkFuncs {
     DEFINE_VK_FUNC(vkCreateDebugUtilsMessengerEXT)
     DEFINE_VK_FUNC(vkDestroyDebugReportCallbackEXT)
     DEFINE_VK_FUNC(vkDestroyDebugUtilsMessengerEXT)
+    DEFINE_VK_FUNC(vkGetPhysicalDeviceFeatures2KHR)
+    DEFINE_VK_FUNC(vkGetPhysicalDeviceMemoryProperties2KHR)
 
     // Vulkan device level functions
     DEFINE_VK_FUNC(vkAcquireNextImageKHR)
@@ -88,7 +93,9 @@ struct VkFuncs {
     DEFINE_VK_FUNC(vkCreateGraphicsPipelines)
     DEFINE_VK_FUNC(vkCreateImage)
     DEFINE_VK_FUNC(vkCreateImageView)
+    DEFINE_VK_FUNC(vkCreatePipelineCache)
     DEFINE_VK_FUNC(vkCreatePipelineLayout)
+    DEFINE_VK_FUNC(vkCreateQueryPool)
     DEFINE_VK_FUNC(vkCreateRenderPass)
     DEFINE_VK_FUNC(vkCreateSampler)
     DEFINE_VK_FUNC(vkCreateSemaphore)
@@ -103,7 +110,9 @@ struct VkFuncs {
     DEFINE_VK_FUNC(vkDestroyImage)
     DEFINE_VK_FUNC(vkDestroyImageView)
     DEFINE_VK_FUNC(vkDestroyPipeline)
+    DEFINE_VK_FUNC(vkDestroyPipelineCache)
     DEFINE_VK_FUNC(vkDestroyPipelineLayout)
+    DEFINE_VK_FUNC(vkDestroyQueryPool)
     DEFINE_VK_FUNC(vkDestroyRenderPass)
     DEFINE_VK_FUNC(vkDestroySampler)
     DEFINE_VK_FUNC(vkDestroySemaphore)
@@ -117,6 +126,8 @@ struct VkFuncs {
     DEFINE_VK_FUNC(vkGetDeviceQueue)
     DEFINE_VK_FUNC(vkGetFenceStatus)
     DEFINE_VK_FUNC(vkGetImageMemoryRequirements)
+    DEFINE_VK_FUNC(vkGetPipelineCacheData)
+    DEFINE_VK_FUNC(vkGetQueryPoolResults)
     DEFINE_VK_FUNC(vkGetSwapchainImagesKHR)
     DEFINE_VK_FUNC(vkMapMemory)
     DEFINE_VK_FUNC(vkQueuePresentKHR)
@@ -128,6 +139,9 @@ struct VkFuncs {
     DEFINE_VK_FUNC(vkUpdateDescriptorSets)
     DEFINE_VK_FUNC(vkWaitForFences)
 
+    // Vulkan device level functions that are optional (may or may not be present, depending on extensions available)
+    DEFINE_VK_FUNC(vkGetSemaphoreCounterValueKHR)
+
     // Done with this macro
     #undef DEFINE_VK_FUNC
 };
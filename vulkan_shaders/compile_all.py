@@ -5,13 +5,20 @@
 # The SPIR-V generated is saved in the format of C header files which can then be embedded in the application.
 #
 # Requirements:
-#   (1) The Vulkan SDK 'glslangvalidator' tool must be invokable.
+#   (1) The Vulkan SDK 'glslc' tool must be invokable.
 #       Install the SDK and ensure this tool is on your current system's BIN path.
 #   (2) This script must be executed from the shaders directory.
+#
+# Usage:
+#   compile_all.py              Compiles all shaders, overwriting the headers in the 'compiled' directory
+#   compile_all.py --check      Compiles all shaders to temporary files and reports any headers in the 'compiled' directory which
+#                               differ from the compiler output (e.g because they are out of date or were edited by hand).
+#                               The exit code is '1' if any headers differ, or '0' otherwise.
 ############################################################################################################################################
 import os
 import subprocess
 import sys
+import tempfile
 
 # Job-specs for all the files to compile.
 # Corresponds to the 3 arguments of 'compile_shader'
@@ -56,8 +63,38 @@ def compile_shader(input_glsl_file, output_c_file, shader_stage, c_var_name):
         file.write(shader_code)
         file.write(";")
 
-# Main script logic: compiles all of the shaders
+# Compiles all of the shaders to a temporary directory and reports the headers which don't match the compiler output.
+# Returns 'True' if all of the headers match.
+def check_all_shaders():
+    num_mismatched = 0
+
+    with tempfile.TemporaryDirectory() as temp_dir:
+        for job_spec in files_to_compile:
+            temp_c_file = os.path.join(temp_dir, os.path.basename(job_spec[1]))
+            compile_shader(job_spec[0], temp_c_file, job_spec[2], job_spec[3])
+
+            with open(temp_c_file, "r") as file:
+                expected_code = file.read()
+
+            with open(job_spec[1], "r") as file:
+                actual_code = file.read()
+
+            if actual_code != expected_code:
+                print("Compiled header does not match the compiler output: {0:s}".format(job_spec[1]))
+                num_mismatched += 1
+
+    if num_mismatched > 0:
+        print("{0:d} compiled header(s) need to be regenerated!".format(num_mismatched))
+        return False
+
+    print("All compiled headers match the compiler output.")
+    return True
+
+# Main script logic: compiles all of the shaders, or checks the compiled shaders are up to date
 def main():
+    if "--check" in sys.argv[1:]:
+        sys.exit(0 if check_all_shaders() else 1)
+
     for job_spec in files_to_compile:
         compile_shader(job_spec[0], job_spec[1], job_spec[2], job_spec[3])
 